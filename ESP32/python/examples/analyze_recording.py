@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+
+import argparse
+import sys
+import time
+import numpy as np
+from tcam_analytics import alarm_events, analyze_recording, dwell_alarm
+from tcam_index import TCamJsonFile
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "analyze_recording"
+parser.description = f"{parser.prog} - an example program to run region, hot spot and dwell analytics over tCam files\n"
+parser.usage = "analyze_recording.py -i <input file> [<input file> ...] [-r r1,c1,r2,c2 ...] [-t degC] [-d secs]"
+parser.add_argument("-i", "--input", nargs="+", help="Files to analyze (.tjsn or .tmjsn)")
+parser.add_argument("-r", "--roi", nargs="*", default=[], help="Regions (r1,c1,r2,c2 inclusive, default the frame)")
+parser.add_argument("-t", "--threshold", type=float, default=50.0, help="Over-temperature threshold (default 50 C)")
+parser.add_argument("-d", "--dwell", type=float, default=5.0, help="Seconds over the threshold to alarm (default 5)")
+parser.add_argument("-y", "--hysteresis", type=float, default=1.0, help="Alarm hysteresis (default 1 C)")
+parser.add_argument("-m", "--min-pixels", type=int, default=4, help="Smallest hot spot (default 4 pixels)")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if not args.input:
+        print("An input file is necessary.")
+        sys.exit(-1)
+
+    rois = [tuple(int(v) for v in r.split(",")) for r in args.roi] or [(0, 0, 119, 159)]
+    hot_k = args.threshold + 273.15
+
+    for path in args.input:
+        t = time.perf_counter()
+        with TCamJsonFile(path) as f:
+            result = analyze_recording(f, rois, hot_k=hot_k, min_pixels=args.min_pixels)
+        elapsed = time.perf_counter() - t
+
+        ts = result["timestamps"]
+        print(f"{path}: {len(ts)} images analyzed in {elapsed:.2f} s")
+        alarm = dwell_alarm(result["roi"]["max"], ts, hot_k, args.dwell * 1e6, args.hysteresis)
+        for i, roi in enumerate(rois):
+            tmax = result["roi"]["max"][:, i] - 273.15
+            print(f"  roi {roi}: max {np.max(tmax):.1f} C, mean {np.mean(result['roi']['mean'][:, i]) - 273.15:.1f} C")
+            for start, end in alarm_events(alarm[:, i]):
+                print(f"    over {args.threshold} C for {args.dwell} s at image {start} ({end - start} images)")
+        tracks = result["tracks"]
+        print(f"  {len(result['spots'])} hot spots in {len(np.unique(tracks))} tracks")
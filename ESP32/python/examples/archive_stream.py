@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+
+import argparse
+import sys
+import time
+from tcam import FRAME_POLICY_BLOCK, TCam
+from tcam_archive import TCamArchiveWriter
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "archive_stream"
+parser.description = f"{parser.prog} - an example program to archive a tCam-mini stream into a compressed HDF5 file\n"
+parser.usage = "archive_stream.py --ip=<ip address of camera> -o <file.h5> [-t seconds] [-f image format]"
+parser.add_argument("-i", "--ip", help="IP address of the camera")
+parser.add_argument("-o", "--out", help="HDF5 file to write")
+parser.add_argument("-t", "--time", type=float, default=60, help="Seconds to stream (default 60)")
+parser.add_argument("-f", "--format", type=int, default=1, help="Image format (0: json, 1: binary, 2: compressed)")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if not args.ip or not args.out:
+        print("An IP address of the tCam and an output file are necessary.")
+        sys.exit(-1)
+
+    # Block instead of dropping frames so the archive has every image
+    cam = TCam(binaryFrames=True, framePolicy=FRAME_POLICY_BLOCK)
+    cam.connect(args.ip)
+    cam.set_image_format(args.format)
+    with TCamArchiveWriter(args.out) as archive:
+        cam.start_stream(key_interval=8 if args.format == 2 else 0)
+        end = time.monotonic() + args.time
+        while time.monotonic() < end:
+            frame = cam.get_frame()
+            if frame is None:
+                time.sleep(0.01)
+            else:
+                archive.add(frame)
+        cam.stop_stream()
+        while cam.frame_count():
+            archive.add(cam.get_frame())
+    print(f"Archived {archive.frames} images ({archive.skipped} skipped)")
+    cam.shutdown()
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+
+import argparse
+import asyncio
+import sys
+import time
+from tcam import get_binary_image_metadata
+from tcam_async import TCamPool
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "benchmark_client"
+parser.description = f"{parser.prog} - an example program to measure client throughput and latency (see emulate_cameras)\n"
+parser.usage = "benchmark_client.py -i <address> [-n cameras] [-p port] [-t seconds] [-f image format]"
+parser.add_argument("-i", "--ip", default="127.0.0.1", help="Address of the (first) emulated camera")
+parser.add_argument("-n", "--num", type=int, default=1, help="Number of cameras, on consecutive ports")
+parser.add_argument("-p", "--port", type=int, default=5001, help="Port of the first camera (default 5001)")
+parser.add_argument("-t", "--time", type=float, default=10, help="Seconds to stream (default 10)")
+parser.add_argument("-f", "--format", type=int, default=1, help="Image format (0: json, 1: binary, 2: compressed)")
+parser.add_argument("-k", "--key", type=int, default=0, help="Frames per keyframe for compressed images")
+parser.add_argument("--decode", action="store_true", help="Convert every image to a json image (as TCam does)")
+
+
+def capture_usec(frame):
+    if isinstance(frame, (bytes, bytearray)):
+        return get_binary_image_metadata(frame)[0]["Timestamp"]
+    return frame["metadata"]["Timestamp"]
+
+
+async def main(args):
+    # The emulator stamps each image with its capture time from the same clock so this is the true latency
+    pool = TCamPool(binaryFrames=not args.decode)
+    for n in range(args.num):
+        pool.add(f"cam{n}", args.ip, args.port + n)
+    for name, result in (await pool.connect()).items():
+        if isinstance(result, Exception):
+            print(f"{name}: {result}")
+    if not pool.connected():
+        return
+    await pool.call("set_image_format", args.format, names=pool.connected())
+
+    latency = []
+    start = time.monotonic()
+    async for name, frame in pool.stream(key_interval=args.key):
+        latency.append(time.time_ns() // 1000 - capture_usec(frame))
+        if time.monotonic() - start >= args.time:
+            break
+    elapsed = time.monotonic() - start
+    cameras = len(pool.connected())
+    stats = await pool.call("get_perf_stats")
+    await pool.disconnect()
+
+    latency.sort()
+    skipped = sum(s["perf_stats"].get("skipped", 0) for s in stats.values() if isinstance(s, dict))
+    print(f"{len(latency)} images from {cameras} cameras in {elapsed:.1f} s: {len(latency) / elapsed:.1f} images/s")
+    if latency:
+        p50, p90, p99 = (latency[min(len(latency) - 1, int(len(latency) * p))] / 1000 for p in (0.5, 0.9, 0.99))
+        print(f"latency mSec: p50 {p50:.1f}  p90 {p90:.1f}  p99 {p99:.1f}  max {latency[-1] / 1000:.1f}")
+    print(f"{pool.framesDropped} images dropped by the client, {skipped} skipped by the cameras")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if args.num < 1:
+        print("At least one camera is necessary.")
+        sys.exit(-1)
+
+    asyncio.run(main(args))
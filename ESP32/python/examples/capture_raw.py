@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+
+import argparse
+import sys
+import time
+from queue import Empty
+from tcam import TCam, PKT_HEADER, PKT_LEN, PKT_START, PKT_VERSION
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "capture_raw"
+parser.description = (
+    f"{parser.prog} - an example program to record a tCam-mini raw stream of VoSPI packets for vospi_sim/raw_asm\n"
+)
+parser.usage = "capture_raw.py --ip=<ip address of camera> -o <file> [-t seconds] [-u udp port]"
+parser.add_argument("-i", "--ip", help="IP address of the camera")
+parser.add_argument("-o", "--output", help="Capture file")
+parser.add_argument("-t", "--time", type=float, default=10, help="Seconds to record (default 10)")
+parser.add_argument("-u", "--udp", type=int, help="Stream over UDP to this port")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if not args.ip or not args.output:
+        print("An IP address of the tCam and an output file are necessary.")
+        sys.exit(-1)
+
+    cam = TCam()
+    cam.connect(args.ip)
+
+    batches = 0
+    packets = 0
+    lost = 0
+    next_pkt = None
+    with open(args.output, "wb") as f:
+        cam.start_stream(raw=True, udp_port=args.udp)
+        end = time.monotonic() + args.time
+        while time.monotonic() < end:
+            try:
+                rsp = cam.responseQueue.get(timeout=0.5)
+            except Empty:
+                continue
+            if "packet_batch" not in rsp:
+                continue
+            b = rsp["packet_batch"]
+            count = len(b["packets"]) // PKT_LEN
+            # The batches are saved as the camera sends them
+            f.write(
+                PKT_HEADER.pack(
+                    PKT_START, PKT_VERSION, PKT_HEADER.size, b["packet"], b["lepton"], count, PKT_LEN, b["read_usec"]
+                )
+            )
+            f.write(b["packets"])
+            if next_pkt is not None and b["packet"] != next_pkt:
+                lost += (b["packet"] - next_pkt) & 0xFFFFFFFF
+            next_pkt = (b["packet"] + count) & 0xFFFFFFFF
+            batches += 1
+            packets += count
+        cam.stop_stream()
+    cam.shutdown()
+
+    print(f"{batches} batches, {packets} packets, {lost} packets dropped by the camera")
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+
+import argparse
+import asyncio
+import sys
+import time
+from tcam import get_binary_image_metadata
+from tcam_async import AsyncTCam
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "command_stress"
+parser.description = (
+    f"{parser.prog} - an example program to measure command latency during a full rate stream from a camera or "
+    "emulate_cameras\n"
+)
+parser.usage = "command_stress.py -i <address> [-p port] [-t seconds] [-f image format] [-r rate] [-b burst] [--mode]"
+parser.add_argument("-i", "--ip", default="127.0.0.1", help="Address of the camera")
+parser.add_argument("-p", "--port", type=int, default=5001, help="Command port (default 5001)")
+parser.add_argument("-t", "--time", type=float, default=20, help="Seconds to stream in each mode (default 20)")
+parser.add_argument("-f", "--format", type=int, default=0, help="Image format (0: json, 1: binary, 2: compressed)")
+parser.add_argument("-r", "--rate", type=float, default=10, help="Command bursts per second (default 10)")
+parser.add_argument("-b", "--burst", type=int, default=3, help="Commands sent back to back in each burst (default 3)")
+parser.add_argument(
+    "-c",
+    "--cmds",
+    default="get_status,get_config,get_perf_stats",
+    help="Comma separated commands sent in turn (default get_status,get_config,get_perf_stats)",
+)
+parser.add_argument(
+    "--mode", choices=("fifo", "priority", "both"), default="both", help="Response scheduling (default both)"
+)
+parser.add_argument("--timeout", type=float, default=10, help="Seconds before a command counts as lost (default 10)")
+
+# perf_stats items reported from the camera (the emulator only has some of them)
+PERF_COUNTERS = ("frames_dropped", "frames_skipped", "responses_dropped", "skipped")
+
+
+def image_seq(frame):
+    if isinstance(frame, (bytes, bytearray)):
+        return get_binary_image_metadata(frame)[0].get("Seq")
+    return frame["metadata"].get("Seq")
+
+
+def percentiles(values):
+    values = sorted(values)
+    return [values[min(len(values) - 1, int(len(values) * p))] for p in (0.5, 0.9, 0.99)] + [values[-1]]
+
+
+async def receive(cam, stats):
+    last_seq = None
+    async for frame in cam.frames():
+        stats["images"] += 1
+        seq = image_seq(frame)
+        if seq is not None and last_seq is not None and seq > last_seq + 1:
+            stats["gaps"] += seq - last_seq - 1
+        last_seq = seq
+
+
+async def send_commands(cam, args, latency, stats):
+    names = args.cmds.split(",")
+
+    async def timed(name):
+        t = time.perf_counter()
+        try:
+            await cam.command(name, timeout=args.timeout)
+            latency.setdefault(name, []).append((time.perf_counter() - t) * 1000)
+        except asyncio.TimeoutError:
+            stats["lost"] += 1
+
+    n = 0
+    pending = []
+    end = time.monotonic() + args.time
+    while time.monotonic() < end:
+        for i in range(args.burst):
+            pending.append(asyncio.ensure_future(timed(names[n % len(names)])))
+            n += 1
+        await asyncio.sleep(1 / args.rate)
+    await asyncio.gather(*pending)
+
+
+async def run(args, priority):
+    # perf_stats are kept from power-on so the difference across the run is reported
+    cam = AsyncTCam(responseTimeout=args.timeout, binaryFrames=True)
+    await cam.connect(args.ip, args.port)
+    await cam.set_image_format(args.format)
+    before = (await cam.get_perf_stats())["perf_stats"]
+
+    latency = {}
+    stats = {"images": 0, "gaps": 0, "lost": 0}
+    cam.start_stream(cmd_priority=priority)
+    receiver = asyncio.ensure_future(receive(cam, stats))
+    start = time.monotonic()
+    await send_commands(cam, args, latency, stats)
+    elapsed = time.monotonic() - start
+    cam.stop_stream()
+    after = (await cam.get_perf_stats())["perf_stats"]
+    await cam.disconnect()
+    await receiver
+
+    print(f"{'priority' if priority else 'fifo'}: {stats['images'] / elapsed:.1f} images/s, {stats['gaps']} Seq gaps")
+    every = []
+    for name, values in latency.items():
+        every += values
+        p50, p90, p99, top = percentiles(values)
+        print(f"  {name:16s} {len(values):5d}  mSec p50 {p50:7.1f}  p90 {p90:7.1f}  p99 {p99:7.1f}  max {top:7.1f}")
+    if every:
+        p50, p90, p99, top = percentiles(every)
+        print(f"  {'all':16s} {len(every):5d}  mSec p50 {p50:7.1f}  p90 {p90:7.1f}  p99 {p99:7.1f}  max {top:7.1f}")
+    print(f"  {stats['lost']} commands without a response")
+    counts = [f"{k} {after[k] - before.get(k, 0)}" for k in PERF_COUNTERS if k in after]
+    if counts:
+        print("  camera: " + ", ".join(counts))
+    if "response_send" in after:
+        a, b = after["response_send"], before.get("response_send", {"count": 0, "avg": 0, "hist": []})
+        count = a["count"] - b["count"]
+        if count > 0:
+            avg = (a["avg"] * a["count"] - b["avg"] * b["count"]) / count
+            hist = [x - y for x, y in zip(a["hist"], b["hist"] or [0] * len(a["hist"]))]
+            print(f"  camera response_send uSec: {count} responses, avg {avg:.0f}  hist {hist}")
+
+
+async def main(args):
+    modes = {"fifo": (False,), "priority": (True,), "both": (False, True)}[args.mode]
+    for priority in modes:
+        await run(args, priority)
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if args.rate <= 0 or args.burst < 1:
+        print("The rate and burst must be positive.")
+        sys.exit(-1)
+
+    asyncio.run(main(args))
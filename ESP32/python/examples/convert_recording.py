@@ -0,0 +1,33 @@
+#!/usr/bin/env python3
+
+import argparse
+from tcam import TCamRecording, convert_json_file, write_json_file, BIN_ENC_RAW, BIN_ENC_RICE
+import sys
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "convert_recording"
+parser.description = f"{parser.prog} - an example program to convert tCam .tjsn/.tmjsn files to and from recordings\n"
+parser.usage = "convert_recording.py -i <input file> -o <output file> [-r] [-k key interval]"
+parser.add_argument("-i", "--input", help="File to convert (.tjsn, .tmjsn or .trec)")
+parser.add_argument("-o", "--out", help="Path and name of the output file (.trec, .tjsn or .tmjsn)")
+parser.add_argument("-r", "--raw", action="store_true", help="Store raw images instead of compressed images")
+parser.add_argument("-k", "--key", type=int, default=0, help="Frames per keyframe (0 = all keyframes)")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if not args.input or not args.out:
+        print("An input and output file are necessary.")
+        sys.exit(-1)
+
+    if args.input.endswith(".tjsn") or args.input.endswith(".tmjsn"):
+        encoding = BIN_ENC_RAW if args.raw else BIN_ENC_RICE
+        num_frames = convert_json_file(args.input, args.out, encoding, args.key)
+        print(f"Converted {num_frames} images to {args.out}")
+    else:
+        with TCamRecording(args.input) as recording:
+            print(f"Converting {len(recording)} images to {args.out}")
+            write_json_file(recording, args.out)
@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+
+import argparse
+import asyncio
+from tcam_emulator import CMD_PORT, DEFAULT_FPS, load_frames, prepare_compressed, run_cameras, synthetic_frames
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "emulate_cameras"
+parser.description = f"{parser.prog} - an example program to emulate tCam-minis for testing and benchmarking clients\n"
+parser.usage = "emulate_cameras.py [-i <file>] [-n cameras] [-p port] [--loopback] [--fps fps] [--jitter msec]"
+parser.add_argument("-i", "--input", help="Images to replay (.tjsn, .tmjsn or .trec, default synthetic frames)")
+parser.add_argument("-n", "--num", type=int, default=1, help="Number of cameras (default 1)")
+parser.add_argument("-a", "--addr", default="0.0.0.0", help="Address to listen on (default all)")
+parser.add_argument("-p", "--port", type=int, default=CMD_PORT, help="Port of the first camera (default 5001)")
+parser.add_argument("--loopback", action="store_true", help="Camera n listens on 127.0.0.<n+1> at the port instead")
+parser.add_argument("--fps", type=float, default=DEFAULT_FPS, help="Frame rate (default 8.7)")
+parser.add_argument("--jitter", type=float, default=0, help="Maximum random frame time offset in mSec")
+parser.add_argument("--seed", type=int, help="Jitter random seed for repeatable runs")
+parser.add_argument("--no-prepare", action="store_true", help="Don't compress the frames before starting")
+
+
+async def main(args):
+    frames = load_frames(args.input) if args.input else synthetic_frames()
+    if not args.no_prepare:
+        prepare_compressed(frames)
+    cameras, addrs = await run_cameras(
+        args.num, frames, args.addr, args.port, args.loopback, args.fps, args.jitter, args.seed
+    )
+    for cam, (addr, port) in zip(cameras, addrs):
+        print(f"{cam.name}: {addr}:{port}")
+    print(f"Replaying {len(frames)} frames at {args.fps} fps, ctrl-c to stop")
+    await asyncio.Event().wait()
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    try:
+        asyncio.run(main(args))
+    except KeyboardInterrupt:
+        pass
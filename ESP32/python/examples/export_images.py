@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+
+import argparse
+import os
+import sys
+from tcam_export import RANGE_FILE, RANGE_FIXED, RANGE_FRAME, export_file, export_files
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "export_images"
+parser.description = f"{parser.prog} - an example program to export tCam files as PNG images or videos\n"
+parser.usage = "export_images.py -i <input file> [<input file> ...] -o <output> [-p palette] [-s scale] [-r range]"
+parser.add_argument("-i", "--input", nargs="+", help="Files to export (.tjsn, .tmjsn or .trec)")
+parser.add_argument(
+    "-o",
+    "--out",
+    help="Output image, numbered image pattern (frame_{:05d}.png), video (.mp4) or, for several inputs, .png/.mp4 "
+    "to write one file next to each input",
+)
+parser.add_argument("-p", "--palette", default="ironblack", help="Palette name (default ironblack)")
+parser.add_argument("-s", "--scale", type=int, default=1, help="Integer upscale factor")
+parser.add_argument("--smooth", action="store_true", help="Bilinear upscaling instead of repeating pixels")
+parser.add_argument(
+    "-r", "--range", default=RANGE_FRAME, choices=[RANGE_FRAME, RANGE_FILE, RANGE_FIXED], help="Palette range"
+)
+parser.add_argument("--vmin", type=int, help="Low end of a fixed range (raw pixel value)")
+parser.add_argument("--vmax", type=int, help="High end of a fixed range (raw pixel value)")
+parser.add_argument("--fps", type=float, default=8.7, help="Video frame rate")
+parser.add_argument("-j", "--jobs", type=int, default=None, help="Worker processes (default one per CPU)")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if not args.input or not args.out:
+        print("An input and output file are necessary.")
+        sys.exit(-1)
+
+    settings = dict(
+        palette=args.palette,
+        range_mode=args.range,
+        vmin=args.vmin,
+        vmax=args.vmax,
+        scale=args.scale,
+        smooth=args.smooth,
+        fps=args.fps,
+    )
+
+    if len(args.input) == 1:
+        n = export_file(args.input[0], args.out, workers=args.jobs, **settings)
+        print(f"Exported {n} images to {args.out}")
+    else:
+        jobs = [(src, os.path.splitext(src)[0] + args.out) for src in args.input]
+        for src, n in export_files(jobs, workers=args.jobs, **settings):
+            print(f"Exported {n} images from {src}")
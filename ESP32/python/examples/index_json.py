@@ -0,0 +1,43 @@
+#!/usr/bin/env python3
+
+import argparse
+import sys
+import time
+import numpy as np
+from tcam_index import TCamJsonFile, index_json_file
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "index_json"
+parser.description = f"{parser.prog} - an example program to index tCam .tjsn/.tmjsn files for random access\n"
+parser.usage = "index_json.py -i <input file> [<input file> ...] [-f] [-n image]"
+parser.add_argument("-i", "--input", nargs="+", help="Files to index (.tjsn or .tmjsn)")
+parser.add_argument("-f", "--force", action="store_true", help="Rebuild indexes that are up to date")
+parser.add_argument("-n", "--image", type=int, help="Decode one image of each file and print its range")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if not args.input:
+        print("An input file is necessary.")
+        sys.exit(-1)
+
+    for path in args.input:
+        t = time.perf_counter()
+        records = index_json_file(path, args.force)
+        elapsed = time.perf_counter() - t
+        known = records["timestamp_usec"][records["timestamp_usec"] >= 0]
+        span = (known[-1] - known[0]) / 1e6 if len(known) else 0
+        print(f"{path}: {len(records)} images over {span:.1f} seconds (indexed in {elapsed:.2f} s)")
+
+        if args.image is not None and args.image < len(records):
+            with TCamJsonFile(path) as f:
+                t = time.perf_counter()
+                pixels, telem = f.image(args.image)
+                elapsed = time.perf_counter() - t
+                print(
+                    f"  image {args.image}: min {np.min(pixels)}, max {np.max(pixels)}, "
+                    f"{'with' if telem is not None else 'no'} telemetry (decoded in {elapsed * 1000:.1f} mSec)"
+                )
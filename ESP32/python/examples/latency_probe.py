@@ -0,0 +1,71 @@
+#!/usr/bin/env python3
+
+import argparse
+import sys
+import time
+from queue import Empty
+from tcam import TCam, TCamLatency, decode_binary_image
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "latency_probe"
+parser.description = f"{parser.prog} - an example program to measure the glass-to-glass latency of a tCam-mini stream\n"
+parser.usage = "latency_probe.py --ip=<ip address of camera> [-t seconds] [-f image format] [-u udp port]"
+parser.add_argument("-i", "--ip", help="IP address of the camera")
+parser.add_argument("-t", "--time", type=float, default=10, help="Seconds to stream (default 10)")
+parser.add_argument("-f", "--format", type=int, default=1, help="Image format (0: json, 1: binary, 2: compressed)")
+parser.add_argument("-u", "--udp", type=int, help="Stream over UDP to this port")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if not args.ip:
+        print("An IP address of the tCam is necessary.")
+        sys.exit(-1)
+
+    # The network and total times compare this computer's clock with the camera's so they are only meaningful when
+    # the camera's clock is set by SNTP (set_time only has a resolution of one second)
+    lat = TCamLatency()
+    ref = [None]
+
+    def on_frame(frame):
+        recv_usec = time.time_ns() // 1000
+        t = time.perf_counter()
+        if isinstance(frame, (bytes, bytearray)):
+            try:
+                _, ref[0] = decode_binary_image(frame, ref[0])
+            except ValueError:
+                return
+        else:
+            frame.get_data("radiometric")
+        lat.frame(frame, recv_usec, int((time.perf_counter() - t) * 1e6))
+
+    cam = TCam(binaryFrames=True)
+    cam.connect(args.ip)
+    cam.set_image_format(args.format)
+    cam.start_stream(callback=on_frame, udp_port=args.udp, key_interval=8 if args.format == 2 else 0, probe=True)
+
+    end = time.monotonic() + args.time
+    while time.monotonic() < end:
+        try:
+            rsp = cam.responseQueue.get(timeout=0.5)
+        except Empty:
+            continue
+        if "latency" in rsp:
+            lat.latency(rsp)
+    cam.stop_stream()
+    cam.shutdown()
+
+    p = lat.percentiles()
+    if not p:
+        print("No images were matched with their latency records (older firmware?)")
+        sys.exit(-1)
+    print(f"{len(lat.samples['total'])} images")
+    print("stage      p50 mSec  p99 mSec")
+    for stage in TCamLatency.STAGES:
+        if stage in p:
+            print(f"{stage:<10}{p[stage][0] / 1000:9.2f}{p[stage][1] / 1000:10.2f}")
+    if lat.unsynced:
+        print(f"{lat.unsynced} images were captured before the camera's clock was set (network and total are wrong)")
@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+
+import argparse
+import asyncio
+import sys
+import time
+from tcam_async import TCamPool
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "multi_camera"
+parser.description = f"{parser.prog} - an example program to stream from several tCam-minis from one event loop\n"
+parser.usage = "multi_camera.py --ip=<ip address> [--ip=<ip address> ...] [-t seconds] [-f image format]"
+parser.add_argument("-i", "--ip", action="append", help="IP address of a camera (repeat for each camera)")
+parser.add_argument("-t", "--time", type=float, default=10, help="Seconds to stream (default 10)")
+parser.add_argument("-f", "--format", type=int, default=1, help="Image format (0: json, 1: binary, 2: compressed)")
+
+
+async def main(args):
+    pool = TCamPool(binaryFrames=True)
+    for ip in args.ip:
+        pool.add(ip, ip)
+    for name, result in (await pool.connect()).items():
+        if isinstance(result, Exception):
+            print(f"{name}: {result}")
+    if not pool.connected():
+        return
+    await pool.call("set_image_format", args.format, names=pool.connected())
+
+    counts = dict.fromkeys(pool.connected(), 0)
+    end = time.monotonic() + args.time
+    async for name, frame in pool.stream(key_interval=8):
+        counts[name] += 1
+        if time.monotonic() >= end:
+            break
+    for name, count in counts.items():
+        print(f"{name}: {count / args.time:.1f} fps")
+    print(f"{pool.framesDropped} frames dropped")
+    await pool.disconnect()
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if not args.ip:
+        print("At least one camera IP address is necessary.")
+        sys.exit(-1)
+
+    asyncio.run(main(args))
@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+
+import argparse
+import asyncio
+import json
+import sys
+from tcam_hub import HUB_SOCKET_PATH, TCamHub, TCamHubClient, get_hub_metrics
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "run_hub"
+parser.description = f"{parser.prog} - an example program to serve the frames of many tCam-minis to local consumers\n"
+parser.usage = "run_hub.py --ip=<ip address> [--ip=<ip address> ...] [-f image format] [-j workers] [-m metrics port] | --metrics | --watch"
+parser.add_argument("-i", "--ip", action="append", help="IP address (or address:port) of a camera (repeat for each)")
+parser.add_argument("-f", "--format", type=int, default=2, help="Image format (0: json, 1: binary, 2: compressed)")
+parser.add_argument("-j", "--jobs", type=int, default=None, help="Decoder processes (default one per CPU)")
+parser.add_argument("-s", "--socket", default=HUB_SOCKET_PATH, help=f"Subscriber socket (default {HUB_SOCKET_PATH})")
+parser.add_argument("-m", "--metrics-port", type=int, default=None, help="Serve OpenMetrics on this HTTP port")
+parser.add_argument("--metrics", action="store_true", help="Print the metrics of a running hub")
+parser.add_argument("--watch", action="store_true", help="Subscribe to a running hub and print the frames received")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if args.metrics:
+        print(json.dumps(get_hub_metrics(args.socket), indent=2))
+    elif args.watch:
+        with TCamHubClient(socketPath=args.socket) as client:
+            for name, buf in client.frames():
+                print(f"{name}: {len(buf)} bytes")
+    elif args.ip:
+        hub = TCamHub(workers=args.jobs, imageFormat=args.format, socketPath=args.socket, metricsPort=args.metrics_port)
+        for ip in args.ip:
+            addr, _, port = ip.partition(":")
+            hub.add(ip, addr, int(port) if port else 5001)
+        try:
+            asyncio.run(hub.run())
+        except KeyboardInterrupt:
+            pass
+    else:
+        print("At least one camera IP address is necessary.")
+        sys.exit(-1)
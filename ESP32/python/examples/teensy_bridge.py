@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+
+import argparse
+import sys
+import time
+from tcam_frame import TCamFrameStream
+
+parser = argparse.ArgumentParser()
+
+parser.prog = "teensy_bridge"
+parser.description = (
+    f"{parser.prog} - an example program to receive the frames sent by the Teensy 4 USB bridge (teensy3/lep_bridge)\n"
+)
+parser.usage = "teensy_bridge.py --port=<serial port> [-t seconds] [-o file] [--ffc]"
+parser.add_argument("-p", "--port", help="Serial port of the Teensy (for example /dev/ttyACM0)")
+parser.add_argument("-t", "--time", type=float, default=10, help="Seconds to receive (default 10)")
+parser.add_argument("-o", "--output", help="Save the frames, back to back as they were received, to this file")
+parser.add_argument("--ffc", action="store_true", help="Run a FFC first")
+
+
+if __name__ == "__main__":
+
+    args = parser.parse_args()
+
+    if not args.port:
+        print("The serial port of the Teensy is necessary.")
+        sys.exit(-1)
+
+    import serial  # Only needed here
+
+    # The baud rate is ignored by the USB serial port.  Opening it (DTR) starts the stream.
+    port = serial.Serial(args.port, 115200, timeout=0.1)
+    if args.ffc:
+        port.write(b"f")
+
+    stream = TCamFrameStream()
+    out = open(args.output, "wb") if args.output else None
+    frames = 0
+    lost = 0
+    next_seq = None
+    spot = None
+    start = time.monotonic()
+    end = start + args.time
+    while time.monotonic() < end:
+        for frame in stream.feed(port.read(65536)):
+            if next_seq is not None and frame.seq != next_seq:
+                lost += (frame.seq - next_seq) & 0xFFFFFFFF
+            next_seq = (frame.seq + 1) & 0xFFFFFFFF
+            frames += 1
+            pixels = frame.pixels()
+            # TLinear pixels are Kelvin * 100
+            spot = int(pixels[frame.height // 2, frame.width // 2]) / 100 - 273.15
+            if out:
+                out.write(frame.buf)
+    port.close()
+    if out:
+        out.close()
+
+    secs = time.monotonic() - start
+    print(f"{frames} frames ({frames / secs:.1f}/sec), {lost} dropped by the Teensy, {stream.skipped} bytes skipped")
+    if spot is not None:
+        print(f"Center of the last frame: {spot:.2f} C")
@@ -1,31 +1,168 @@
-from .black_hot import black_hot_palette
-from .blue_red import blue_red_palette
-from .coldest import coldest_palette
-from .double_rainbow import double_rainbow_palette
-from .fusion import fusion_palette
-from .glowbow import glowbow_palette
-from .gray import gray_palette
-from .gray_red import gray_red_palette
-from .hottest import hottest_palette
-from .ironblack import ironblack_palette
-from .lava import lava_palette
-from .medical import medical_palette
-from .rainbow import rainbow_palette
-from .wheel2 import wheel2_palette
-
-palettes = {
-    "black_hot": black_hot_palette,
-    "blue_red": blue_red_palette,
-    "coldest": coldest_palette,
-    "double_rainbow": double_rainbow_palette,
-    "fusion": fusion_palette,
-    "glowbow": glowbow_palette,
-    "gray": gray_palette,
-    "gray_red": gray_red_palette,
-    "hottest": hottest_palette,
-    "ironblack": ironblack_palette,
-    "lava": lava_palette,
-    "medical": medical_palette,
-    "rainbow": rainbow_palette,
-    "wheel2": wheel2_palette,
-}
+"""
+  tCam colormaps for 8-bit LEP indexed data
+
+  All of the palettes are kept in one packed file, palettes.bin, that is only read the first time a palette is
+  used.  The same file is the source of the C RGB565 and RGBA32 tables used by the firmware and frame buffer
+  programs (python3 -m palettes writes them).
+
+  palettes.bin layout (little-endian):
+    "TPAL", uint16_t version (1), uint16_t number of palettes
+    per palette: 16 byte NUL padded name, 256 x [r, g, b] uint8
+
+  Copyright 2020-2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import os
+import struct
+from collections.abc import Mapping
+
+PALETTE_FILE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "palettes.bin")
+PALETTE_MAGIC = b"TPAL"
+PALETTE_VERSION = 1
+PALETTE_NAME_LEN = 16
+PALETTE_LEN = 256 * 3
+
+# name -> 768 bytes of r, g, b (read on first use)
+_raw = None
+
+# Converted palettes by (name, form)
+_cache = {}
+
+
+def _load():
+    global _raw
+    if _raw is None:
+        with open(PALETTE_FILE, "rb") as f:
+            data = f.read()
+        magic, version, count = struct.unpack_from("<4sHH", data)
+        if magic != PALETTE_MAGIC or version != PALETTE_VERSION:
+            raise ValueError(f"{PALETTE_FILE} is not a version {PALETTE_VERSION} palette file")
+        raw = {}
+        pos = 8
+        for _ in range(count):
+            name = data[pos : pos + PALETTE_NAME_LEN].rstrip(b"\0").decode()
+            pos += PALETTE_NAME_LEN
+            raw[name] = data[pos : pos + PALETTE_LEN]
+            pos += PALETTE_LEN
+        _raw = raw
+    return _raw
+
+
+def names():
+    """
+    names()
+
+    Returns the palette names in file order.
+    """
+    return list(_load())
+
+
+def raw(name):
+    """
+    raw()
+
+    Returns the 768 packed r, g, b bytes of a palette.  Raises KeyError for an unknown name.
+    """
+    return _load()[name]
+
+
+def rgb(name):
+    """
+    rgb()
+
+    Returns a palette as a list of 256 [r, g, b] values (the form the palettes used to be distributed in).
+    """
+    b = raw(name)
+    return [list(b[i : i + 3]) for i in range(0, PALETTE_LEN, 3)]
+
+
+def lut(name):
+    """
+    lut()
+
+    Returns a cached, read-only 256x3 uint8 numpy lookup table.
+    """
+    key = (name, "lut")
+    if key not in _cache:
+        import numpy as np
+
+        _cache[key] = np.frombuffer(raw(name), dtype=np.uint8).reshape(256, 3)
+    return _cache[key]
+
+
+def rgb565(name):
+    """
+    rgb565()
+
+    Returns a cached 256 entry uint16 numpy table of RGB565 values (rrrrrggggggbbbbb).
+    """
+    key = (name, "rgb565")
+    if key not in _cache:
+        import numpy as np
+
+        c = lut(name).astype(np.uint16)
+        t = ((c[:, 0] >> 3) << 11) | ((c[:, 1] >> 2) << 5) | (c[:, 2] >> 3)
+        t.flags.writeable = False
+        _cache[key] = t
+    return _cache[key]
+
+
+def rgba32(name):
+    """
+    rgba32()
+
+    Returns a cached 256 entry uint32 numpy table of opaque 0xAARRGGBB values (the byte order of 32-bit Linux
+    frame buffers and of ARGB8888 display buffers on little-endian processors).
+    """
+    key = (name, "rgba32")
+    if key not in _cache:
+        import numpy as np
+
+        c = lut(name).astype(np.uint32)
+        t = np.uint32(0xFF000000) | (c[:, 0] << 16) | (c[:, 1] << 8) | c[:, 2]
+        t.flags.writeable = False
+        _cache[key] = t
+    return _cache[key]
+
+
+class _Palettes(Mapping):
+    """
+    Read only name -> list of [r, g, b] mapping of all palettes
+    """
+
+    def __getitem__(self, name):
+        key = (name, "rgb")
+        if key not in _cache:
+            _cache[key] = rgb(name)
+        return _cache[key]
+
+    def __iter__(self):
+        return iter(_load())
+
+    def __len__(self):
+        return len(_load())
+
+
+palettes = _Palettes()
+
+
+def __getattr__(attr):
+    # Old per palette names (from palettes import ironblack_palette)
+    if attr.endswith("_palette") and attr[: -len("_palette")] in _load():
+        return palettes[attr[: -len("_palette")]]
+    raise AttributeError(f"module {__name__!r} has no attribute {attr!r}")
@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""
+  Write the C palette tables
+
+  python3 -m palettes [header]
+
+  Writes the RGB565 and RGBA32 tables of every palette in palettes.bin to a C header (by default
+  vospi_asm/tcam_palettes.h, shared by the firmware and the frame buffer programs).  Run it after changing
+  palettes.bin.
+"""
+
+import os
+import sys
+
+from . import PALETTE_FILE, names, raw
+
+DEFAULT_HEADER = os.path.join(os.path.dirname(PALETTE_FILE), "..", "..", "..", "vospi_asm", "tcam_palettes.h")
+
+
+def _table(ctype, name, values, fmt, per_line):
+    lines = [f"static const {ctype} {name}[256] = {{"]
+    for i in range(0, 256, per_line):
+        lines.append("\t" + " ".join(fmt.format(v) + "," for v in values[i : i + per_line]))
+    lines.append("};")
+    return lines
+
+
+def header_text():
+    out = [
+        "/*",
+        " * tCam palettes as RGB565 and RGBA32 (0xAARRGGBB) lookup tables indexed by 8-bit pixels",
+        " *",
+        " * Generated from ESP32/python/palettes/palettes.bin by python3 -m palettes.  Do not",
+        " * edit, change palettes.bin and run it again.",
+        " *",
+        " */",
+        "#ifndef TCAM_PALETTES_H",
+        "#define TCAM_PALETTES_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "#ifdef __cplusplus",
+        'extern "C" {',
+        "#endif",
+        "",
+        "",
+        "typedef struct {",
+        "\tconst char* name;",
+        "\tconst uint16_t* rgb565;",
+        "\tconst uint32_t* rgba32;",
+        "} tcam_palette_t;",
+        "",
+        f"#define TCAM_NUM_PALETTES {len(names())}",
+        "",
+    ]
+    for name in names():
+        c = raw(name)
+        rgb = [(c[i], c[i + 1], c[i + 2]) for i in range(0, len(c), 3)]
+        out += ["", "//", f"// {name}", "//"]
+        out += _table("uint16_t", f"tcam_{name}_rgb565", [(r >> 3) << 11 | (g >> 2) << 5 | b >> 3 for r, g, b in rgb],
+                      "0x{:04X}", 8)
+        out.append("")
+        out += _table("uint32_t", f"tcam_{name}_rgba32", [0xFF000000 | r << 16 | g << 8 | b for r, g, b in rgb],
+                      "0x{:08X}", 6)
+    out += ["", "", "static const tcam_palette_t tcam_palettes[TCAM_NUM_PALETTES] = {"]
+    out += [f'\t{{"{name}", tcam_{name}_rgb565, tcam_{name}_rgba32}},' for name in names()]
+    out += ["};", "", "", "#ifdef __cplusplus", "}", "#endif", "", "#endif /* TCAM_PALETTES_H */", ""]
+    return "\n".join(out)
+
+
+if __name__ == "__main__":
+    path = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_HEADER
+    with open(path, "w") as f:
+        f.write(header_text())
+    print(f"Wrote {len(names())} palettes to {os.path.normpath(path)}")
@@ -1,280 +0,0 @@
-"""
-  "Black Hot" colormap for 8-bit LEP indexed data
- 
-  Copyright 2020 Dan Julio, converted to python by Todd LaWall (bitreaper)
- 
-  This file is part of firecam.
- 
-  firecam is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
- 
-  firecam is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
- 
-  You should have received a copy of the GNU General Public License
-  along with firecam.  If not, see <https://www.gnu.org/licenses/>.
- 
-"""
-
-black_hot_palette = [
-    [235, 235, 235],
-    [234, 234, 234],
-    [233, 233, 233],
-    [232, 232, 232],
-    [231, 231, 231],
-    [230, 230, 230],
-    [229, 229, 229],
-    [228, 228, 228],
-    [227, 227, 227],
-    [226, 226, 226],
-    [225, 225, 225],
-    [224, 224, 224],
-    [223, 223, 223],
-    [222, 222, 222],
-    [221, 221, 221],
-    [220, 220, 220],
-    [219, 219, 219],
-    [218, 218, 218],
-    [217, 217, 217],
-    [216, 216, 216],
-    [215, 215, 215],
-    [214, 214, 214],
-    [213, 213, 213],
-    [212, 212, 212],
-    [211, 211, 211],
-    [210, 210, 210],
-    [209, 209, 209],
-    [209, 209, 209],
-    [208, 208, 208],
-    [207, 207, 207],
-    [206, 206, 206],
-    [205, 205, 205],
-    [204, 204, 204],
-    [203, 203, 203],
-    [202, 202, 202],
-    [201, 201, 201],
-    [200, 200, 200],
-    [199, 199, 199],
-    [198, 198, 198],
-    [197, 197, 197],
-    [196, 196, 196],
-    [195, 195, 195],
-    [194, 194, 194],
-    [193, 193, 193],
-    [192, 192, 192],
-    [191, 191, 191],
-    [190, 190, 190],
-    [189, 189, 189],
-    [188, 188, 188],
-    [187, 187, 187],
-    [186, 186, 186],
-    [185, 185, 185],
-    [184, 184, 184],
-    [183, 183, 183],
-    [182, 182, 182],
-    [181, 181, 181],
-    [180, 180, 180],
-    [179, 179, 179],
-    [178, 178, 178],
-    [177, 177, 177],
-    [176, 176, 176],
-    [175, 175, 175],
-    [174, 174, 174],
-    [173, 173, 173],
-    [172, 172, 172],
-    [171, 171, 171],
-    [170, 170, 170],
-    [169, 169, 169],
-    [168, 168, 168],
-    [167, 167, 167],
-    [166, 166, 166],
-    [165, 165, 165],
-    [164, 164, 164],
-    [163, 163, 163],
-    [162, 162, 162],
-    [161, 161, 161],
-    [160, 160, 160],
-    [159, 159, 159],
-    [158, 158, 158],
-    [157, 157, 157],
-    [156, 156, 156],
-    [155, 155, 155],
-    [154, 154, 154],
-    [154, 154, 154],
-    [153, 153, 153],
-    [152, 152, 152],
-    [151, 151, 151],
-    [150, 150, 150],
-    [149, 149, 149],
-    [148, 148, 148],
-    [147, 147, 147],
-    [146, 146, 146],
-    [145, 145, 145],
-    [144, 144, 144],
-    [143, 143, 143],
-    [142, 142, 142],
-    [141, 141, 141],
-    [140, 140, 140],
-    [139, 139, 139],
-    [138, 138, 138],
-    [137, 137, 137],
-    [136, 136, 136],
-    [135, 135, 135],
-    [134, 134, 134],
-    [133, 133, 133],
-    [132, 132, 132],
-    [131, 131, 131],
-    [130, 130, 130],
-    [129, 129, 129],
-    [128, 128, 128],
-    [127, 127, 127],
-    [126, 126, 126],
-    [125, 125, 125],
-    [124, 124, 124],
-    [123, 123, 123],
-    [122, 122, 122],
-    [121, 121, 121],
-    [120, 120, 120],
-    [119, 119, 119],
-    [118, 118, 118],
-    [117, 117, 117],
-    [116, 116, 116],
-    [115, 115, 115],
-    [114, 114, 114],
-    [113, 113, 113],
-    [112, 112, 112],
-    [111, 111, 111],
-    [110, 110, 110],
-    [109, 109, 109],
-    [108, 108, 108],
-    [107, 107, 107],
-    [106, 106, 106],
-    [105, 105, 105],
-    [104, 104, 104],
-    [103, 103, 103],
-    [102, 102, 102],
-    [101, 101, 101],
-    [100, 100, 100],
-    [99, 99, 99],
-    [99, 99, 99],
-    [98, 98, 98],
-    [97, 97, 97],
-    [96, 96, 96],
-    [95, 95, 95],
-    [94, 94, 94],
-    [93, 93, 93],
-    [92, 92, 92],
-    [91, 91, 91],
-    [90, 90, 90],
-    [89, 89, 89],
-    [88, 88, 88],
-    [87, 87, 87],
-    [86, 86, 86],
-    [85, 85, 85],
-    [84, 84, 84],
-    [83, 83, 83],
-    [82, 82, 82],
-    [81, 81, 81],
-    [80, 80, 80],
-    [79, 79, 79],
-    [78, 78, 78],
-    [77, 77, 77],
-    [76, 76, 76],
-    [75, 75, 75],
-    [74, 74, 74],
-    [73, 73, 73],
-    [72, 72, 72],
-    [71, 71, 71],
-    [70, 70, 70],
-    [69, 69, 69],
-    [68, 68, 68],
-    [67, 67, 67],
-    [66, 66, 66],
-    [65, 65, 65],
-    [64, 64, 64],
-    [63, 63, 63],
-    [62, 62, 62],
-    [61, 61, 61],
-    [60, 60, 60],
-    [59, 59, 59],
-    [58, 58, 58],
-    [57, 57, 57],
-    [56, 56, 56],
-    [55, 55, 55],
-    [54, 54, 54],
-    [53, 53, 53],
-    [52, 52, 52],
-    [51, 51, 51],
-    [50, 50, 50],
-    [49, 49, 49],
-    [48, 48, 48],
-    [47, 47, 47],
-    [46, 46, 46],
-    [45, 45, 45],
-    [44, 44, 44],
-    [44, 44, 44],
-    [43, 43, 43],
-    [42, 42, 42],
-    [41, 41, 41],
-    [40, 40, 40],
-    [39, 39, 39],
-    [38, 38, 38],
-    [37, 37, 37],
-    [36, 36, 36],
-    [35, 35, 35],
-    [34, 34, 34],
-    [33, 33, 33],
-    [32, 32, 32],
-    [31, 31, 31],
-    [30, 30, 30],
-    [29, 29, 29],
-    [28, 28, 28],
-    [27, 27, 27],
-    [26, 26, 26],
-    [25, 25, 25],
-    [24, 24, 24],
-    [23, 23, 23],
-    [22, 22, 22],
-    [21, 21, 21],
-    [20, 20, 20],
-    [19, 19, 19],
-    [18, 18, 18],
-    [17, 17, 17],
-    [16, 16, 16],
-    [19, 64, 206],
-    [18, 65, 209],
-    [18, 67, 210],
-    [19, 69, 212],
-    [18, 71, 215],
-    [19, 73, 217],
-    [18, 75, 218],
-    [18, 77, 219],
-    [19, 79, 223],
-    [19, 82, 225],
-    [19, 84, 226],
-    [18, 85, 227],
-    [19, 88, 229],
-    [21, 90, 229],
-    [22, 93, 231],
-    [21, 95, 230],
-    [22, 98, 232],
-    [22, 101, 232],
-    [22, 103, 232],
-    [23, 106, 234],
-    [23, 109, 234],
-    [24, 112, 236],
-    [23, 114, 235],
-    [25, 116, 235],
-    [25, 119, 237],
-    [27, 122, 238],
-    [26, 124, 237],
-    [27, 125, 236],
-    [27, 127, 235],
-    [27, 130, 236],
-    [29, 133, 234],
-    [30, 136, 234],
-]
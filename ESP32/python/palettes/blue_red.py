@@ -1,280 +0,0 @@
-"""
-  "Blue/Red" colormap for 8-bit LEP indexed data
- 
-  Copyright 2020 Dan Julio, converted to python by Todd LaWall (bitreaper)
- 
-  This file is part of firecam.
- 
-  firecam is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
- 
-  firecam is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
- 
-  You should have received a copy of the GNU General Public License
-  along with firecam.  If not, see <https://www.gnu.org/licenses/>.
- 
-"""
-
-blue_red_palette = [
-    [19, 64, 206],
-    [18, 65, 209],
-    [18, 67, 210],
-    [19, 69, 212],
-    [18, 71, 215],
-    [19, 73, 217],
-    [18, 75, 218],
-    [18, 77, 219],
-    [19, 79, 223],
-    [19, 82, 225],
-    [19, 84, 226],
-    [18, 85, 227],
-    [19, 88, 229],
-    [21, 90, 229],
-    [22, 93, 231],
-    [21, 95, 230],
-    [22, 98, 232],
-    [22, 101, 232],
-    [22, 103, 232],
-    [23, 106, 234],
-    [23, 109, 234],
-    [24, 112, 236],
-    [23, 114, 235],
-    [25, 116, 235],
-    [25, 119, 237],
-    [27, 122, 238],
-    [26, 124, 237],
-    [27, 125, 236],
-    [27, 127, 235],
-    [27, 130, 236],
-    [29, 133, 234],
-    [30, 136, 234],
-    [31, 139, 233],
-    [32, 141, 232],
-    [33, 145, 231],
-    [33, 147, 231],
-    [33, 150, 231],
-    [34, 154, 229],
-    [36, 156, 228],
-    [36, 158, 227],
-    [36, 162, 225],
-    [38, 165, 224],
-    [40, 167, 222],
-    [41, 171, 221],
-    [43, 174, 217],
-    [45, 176, 216],
-    [44, 178, 215],
-    [46, 181, 212],
-    [48, 184, 210],
-    [49, 188, 209],
-    [51, 190, 207],
-    [53, 193, 206],
-    [54, 195, 201],
-    [56, 198, 200],
-    [58, 200, 198],
-    [59, 202, 196],
-    [61, 205, 192],
-    [63, 206, 190],
-    [64, 208, 187],
-    [68, 210, 184],
-    [69, 212, 180],
-    [71, 215, 178],
-    [73, 216, 176],
-    [74, 217, 173],
-    [78, 220, 170],
-    [79, 222, 165],
-    [82, 224, 164],
-    [83, 225, 161],
-    [85, 227, 157],
-    [88, 228, 154],
-    [92, 228, 152],
-    [94, 229, 149],
-    [96, 230, 147],
-    [99, 231, 144],
-    [102, 230, 141],
-    [104, 231, 136],
-    [106, 232, 134],
-    [109, 233, 131],
-    [113, 234, 129],
-    [114, 234, 125],
-    [116, 235, 123],
-    [119, 236, 120],
-    [122, 235, 117],
-    [126, 233, 113],
-    [128, 234, 112],
-    [131, 233, 109],
-    [134, 232, 107],
-    [137, 231, 103],
-    [139, 230, 102],
-    [143, 231, 99],
-    [146, 230, 96],
-    [149, 229, 94],
-    [152, 228, 90],
-    [154, 227, 88],
-    [156, 227, 87],
-    [157, 226, 85],
-    [161, 224, 83],
-    [164, 223, 81],
-    [166, 221, 79],
-    [169, 220, 77],
-    [172, 217, 74],
-    [175, 216, 74],
-    [178, 213, 70],
-    [181, 212, 70],
-    [183, 210, 67],
-    [186, 207, 64],
-    [189, 206, 62],
-    [192, 205, 60],
-    [194, 201, 58],
-    [197, 200, 57],
-    [200, 197, 54],
-    [202, 195, 53],
-    [205, 191, 52],
-    [207, 189, 51],
-    [208, 187, 48],
-    [209, 183, 48],
-    [212, 180, 45],
-    [214, 178, 44],
-    [216, 175, 43],
-    [218, 173, 42],
-    [220, 169, 40],
-    [222, 166, 39],
-    [224, 164, 38],
-    [225, 162, 35],
-    [228, 157, 35],
-    [227, 153, 34],
-    [228, 149, 32],
-    [230, 147, 33],
-    [232, 144, 32],
-    [231, 141, 31],
-    [232, 138, 29],
-    [232, 136, 28],
-    [233, 132, 28],
-    [235, 130, 27],
-    [234, 127, 27],
-    [235, 123, 25],
-    [237, 120, 26],
-    [235, 118, 24],
-    [234, 115, 24],
-    [235, 113, 24],
-    [234, 110, 24],
-    [234, 108, 22],
-    [232, 105, 22],
-    [231, 102, 22],
-    [231, 100, 21],
-    [231, 97, 20],
-    [230, 94, 20],
-    [228, 92, 20],
-    [228, 89, 18],
-    [228, 87, 19],
-    [227, 84, 18],
-    [224, 82, 18],
-    [223, 81, 19],
-    [222, 78, 19],
-    [219, 76, 19],
-    [217, 74, 17],
-    [215, 72, 18],
-    [214, 71, 17],
-    [211, 69, 17],
-    [210, 66, 17],
-    [207, 64, 16],
-    [206, 63, 17],
-    [205, 62, 18],
-    [203, 60, 16],
-    [202, 58, 17],
-    [198, 57, 17],
-    [196, 54, 16],
-    [194, 54, 17],
-    [190, 53, 15],
-    [188, 50, 15],
-    [185, 50, 16],
-    [183, 48, 15],
-    [179, 46, 15],
-    [177, 46, 16],
-    [175, 43, 16],
-    [171, 42, 15],
-    [169, 41, 14],
-    [166, 40, 14],
-    [164, 37, 14],
-    [160, 38, 15],
-    [157, 37, 16],
-    [154, 35, 15],
-    [152, 35, 16],
-    [149, 34, 15],
-    [147, 34, 16],
-    [142, 33, 16],
-    [140, 33, 15],
-    [139, 31, 15],
-    [134, 30, 15],
-    [131, 30, 14],
-    [128, 28, 14],
-    [126, 28, 15],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [15, 15, 239],
-    [45, 45, 45],
-    [46, 46, 46],
-    [47, 47, 47],
-    [48, 48, 48],
-    [49, 49, 49],
-    [50, 50, 50],
-    [51, 51, 51],
-    [52, 52, 52],
-    [53, 53, 53],
-    [54, 54, 54],
-    [55, 55, 55],
-    [56, 56, 56],
-    [57, 57, 57],
-    [58, 58, 58],
-    [59, 59, 59],
-    [60, 60, 60],
-    [61, 61, 61],
-    [62, 62, 62],
-    [63, 63, 63],
-    [64, 64, 64],
-    [65, 65, 65],
-    [66, 66, 66],
-    [67, 67, 67],
-    [68, 68, 68],
-    [69, 69, 69],
-    [70, 70, 70],
-    [71, 71, 71],
-    [72, 72, 72],
-    [73, 73, 73],
-    [74, 74, 74],
-    [75, 75, 75],
-    [76, 76, 76],
-    [77, 77, 77],
-    [78, 78, 78],
-]
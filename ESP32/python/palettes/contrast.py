@@ -1,280 +0,0 @@
-"""
-  "Contrast" colormap for 8-bit LEP indexed data
- 
-  Copyright 2020 Dan Julio, converted to python by Todd LaWall (bitreaper)
- 
-  This file is part of firecam.
- 
-  firecam is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
- 
-  firecam is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
- 
-  You should have received a copy of the GNU General Public License
-  along with firecam.  If not, see <https://www.gnu.org/licenses/>.
- 
-"""
-
-contrast_palette = [
-    [16, 16, 16],
-    [23, 16, 22],
-    [30, 15, 30],
-    [37, 16, 37],
-    [46, 15, 45],
-    [53, 15, 52],
-    [60, 15, 60],
-    [67, 15, 67],
-    [75, 15, 75],
-    [82, 15, 81],
-    [89, 15, 90],
-    [98, 14, 96],
-    [105, 14, 105],
-    [112, 14, 111],
-    [120, 15, 121],
-    [127, 15, 127],
-    [135, 15, 135],
-    [143, 14, 142],
-    [150, 14, 150],
-    [158, 14, 157],
-    [165, 14, 165],
-    [172, 14, 172],
-    [179, 14, 180],
-    [186, 14, 187],
-    [195, 14, 195],
-    [202, 14, 201],
-    [209, 14, 210],
-    [217, 14, 216],
-    [209, 15, 214],
-    [202, 14, 211],
-    [194, 15, 209],
-    [187, 14, 206],
-    [179, 15, 204],
-    [172, 14, 201],
-    [165, 15, 199],
-    [157, 14, 196],
-    [150, 15, 194],
-    [141, 14, 191],
-    [135, 15, 189],
-    [126, 14, 186],
-    [120, 15, 184],
-    [112, 14, 181],
-    [105, 15, 179],
-    [97, 14, 176],
-    [91, 15, 174],
-    [82, 14, 171],
-    [74, 15, 169],
-    [67, 14, 166],
-    [60, 15, 164],
-    [52, 14, 161],
-    [45, 15, 159],
-    [38, 14, 156],
-    [30, 15, 154],
-    [23, 14, 151],
-    [15, 15, 149],
-    [16, 23, 152],
-    [14, 30, 155],
-    [15, 38, 156],
-    [15, 44, 158],
-    [14, 53, 162],
-    [14, 59, 164],
-    [15, 67, 165],
-    [13, 74, 168],
-    [14, 82, 171],
-    [15, 89, 174],
-    [13, 96, 176],
-    [14, 104, 178],
-    [14, 111, 180],
-    [13, 119, 183],
-    [13, 125, 185],
-    [14, 133, 187],
-    [12, 140, 189],
-    [13, 148, 192],
-    [14, 155, 195],
-    [12, 162, 198],
-    [13, 170, 199],
-    [13, 177, 201],
-    [12, 185, 205],
-    [12, 191, 207],
-    [13, 199, 208],
-    [11, 206, 211],
-    [12, 214, 214],
-    [12, 208, 206],
-    [12, 205, 200],
-    [12, 199, 192],
-    [12, 194, 185],
-    [12, 190, 176],
-    [12, 185, 169],
-    [14, 181, 162],
-    [12, 176, 155],
-    [13, 170, 147],
-    [14, 166, 141],
-    [13, 161, 133],
-    [13, 156, 125],
-    [14, 151, 119],
-    [13, 147, 110],
-    [14, 142, 103],
-    [14, 137, 96],
-    [13, 132, 88],
-    [14, 128, 81],
-    [14, 122, 74],
-    [13, 118, 66],
-    [14, 113, 60],
-    [15, 108, 52],
-    [14, 104, 44],
-    [15, 99, 36],
-    [15, 93, 29],
-    [15, 90, 22],
-    [15, 84, 15],
-    [23, 89, 14],
-    [28, 93, 13],
-    [36, 97, 15],
-    [42, 103, 14],
-    [49, 106, 13],
-    [55, 112, 13],
-    [63, 116, 12],
-    [69, 120, 13],
-    [76, 125, 12],
-    [84, 129, 12],
-    [90, 134, 11],
-    [97, 138, 10],
-    [104, 143, 12],
-    [111, 147, 11],
-    [117, 152, 10],
-    [124, 156, 9],
-    [130, 161, 10],
-    [138, 165, 10],
-    [144, 170, 9],
-    [151, 174, 9],
-    [159, 179, 8],
-    [165, 183, 9],
-    [172, 187, 8],
-    [179, 193, 8],
-    [186, 196, 7],
-    [192, 202, 6],
-    [200, 206, 8],
-    [205, 210, 7],
-    [213, 215, 6],
-    [209, 208, 7],
-    [207, 201, 7],
-    [204, 194, 7],
-    [200, 187, 7],
-    [196, 180, 8],
-    [194, 173, 8],
-    [191, 166, 8],
-    [187, 159, 9],
-    [183, 153, 9],
-    [181, 145, 9],
-    [178, 139, 10],
-    [174, 132, 10],
-    [172, 124, 10],
-    [168, 118, 11],
-    [166, 112, 10],
-    [162, 105, 10],
-    [160, 98, 11],
-    [156, 91, 11],
-    [153, 84, 11],
-    [150, 77, 12],
-    [147, 70, 12],
-    [143, 63, 12],
-    [140, 57, 13],
-    [137, 49, 13],
-    [134, 43, 13],
-    [130, 36, 14],
-    [127, 29, 14],
-    [124, 22, 14],
-    [121, 15, 15],
-    [124, 16, 17],
-    [128, 17, 19],
-    [130, 20, 19],
-    [133, 21, 21],
-    [135, 21, 22],
-    [139, 23, 24],
-    [141, 25, 24],
-    [144, 26, 26],
-    [148, 28, 28],
-    [151, 29, 30],
-    [153, 31, 30],
-    [156, 32, 32],
-    [160, 34, 34],
-    [163, 35, 36],
-    [164, 36, 36],
-    [168, 38, 38],
-    [171, 39, 40],
-    [174, 40, 42],
-    [176, 43, 42],
-    [180, 44, 44],
-    [183, 45, 46],
-    [187, 46, 48],
-    [189, 49, 48],
-    [191, 49, 49],
-    [194, 50, 51],
-    [198, 52, 53],
-    [200, 54, 53],
-    [203, 55, 55],
-    [204, 60, 61],
-    [205, 67, 68],
-    [206, 73, 72],
-    [207, 79, 79],
-    [208, 84, 84],
-    [209, 91, 91],
-    [210, 96, 97],
-    [211, 103, 104],
-    [212, 109, 108],
-    [213, 115, 114],
-    [214, 120, 120],
-    [215, 127, 127],
-    [216, 132, 133],
-    [217, 139, 139],
-    [218, 145, 143],
-    [219, 151, 150],
-    [220, 156, 156],
-    [221, 163, 163],
-    [222, 168, 169],
-    [223, 175, 175],
-    [224, 181, 179],
-    [225, 187, 186],
-    [226, 192, 192],
-    [227, 199, 199],
-    [228, 204, 204],
-    [229, 211, 211],
-    [230, 217, 215],
-    [231, 223, 222],
-    [232, 228, 228],
-    [18, 15, 18],
-    [25, 17, 26],
-    [34, 18, 32],
-    [43, 19, 39],
-    [52, 21, 48],
-    [60, 23, 55],
-    [69, 25, 62],
-    [77, 26, 70],
-    [86, 28, 75],
-    [95, 30, 84],
-    [103, 31, 91],
-    [112, 34, 98],
-    [120, 35, 106],
-    [129, 36, 111],
-    [138, 39, 120],
-    [146, 40, 128],
-    [155, 42, 136],
-    [150, 44, 140],
-    [145, 47, 146],
-    [139, 51, 151],
-    [134, 54, 157],
-    [130, 57, 161],
-    [124, 60, 168],
-    [119, 63, 172],
-    [115, 66, 179],
-    [109, 70, 183],
-    [104, 73, 189],
-    [99, 76, 194],
-    [93, 80, 200],
-    [89, 83, 205],
-    [84, 86, 211],
-    [78, 90, 216],
-]
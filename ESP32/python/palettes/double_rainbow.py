@@ -1,281 +0,0 @@
-"""
-  "DoubleRainbow" colormap for 8-bit LEP indexed data
- 
-  Copyright 2020 Dan Julio, converted to python by Todd LaWall (bitreaper)
- 
-  This file is part of firecam.
- 
-  firecam is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
- 
-  firecam is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
- 
-  You should have received a copy of the GNU General Public License
-  along with firecam.  If not, see <https://www.gnu.org/licenses/>.
- 
-"""
-
-
-double_rainbow_palette = [
-    [18, 15, 18],
-    [25, 17, 26],
-    [34, 18, 32],
-    [43, 19, 39],
-    [52, 21, 48],
-    [60, 23, 55],
-    [69, 25, 62],
-    [77, 26, 70],
-    [86, 28, 75],
-    [95, 30, 84],
-    [103, 31, 91],
-    [112, 34, 98],
-    [120, 35, 106],
-    [129, 36, 111],
-    [138, 39, 120],
-    [146, 40, 128],
-    [155, 42, 136],
-    [150, 44, 140],
-    [145, 47, 146],
-    [139, 51, 151],
-    [134, 54, 157],
-    [130, 57, 161],
-    [124, 60, 168],
-    [119, 63, 172],
-    [115, 66, 179],
-    [109, 70, 183],
-    [104, 73, 189],
-    [99, 76, 194],
-    [93, 80, 200],
-    [89, 83, 205],
-    [84, 86, 211],
-    [78, 90, 216],
-    [73, 92, 222],
-    [69, 96, 227],
-    [63, 99, 233],
-    [59, 103, 238],
-    [57, 104, 230],
-    [54, 107, 221],
-    [50, 109, 213],
-    [50, 113, 206],
-    [46, 115, 196],
-    [45, 117, 189],
-    [42, 120, 180],
-    [39, 123, 171],
-    [38, 125, 164],
-    [35, 127, 154],
-    [32, 130, 147],
-    [30, 133, 138],
-    [28, 135, 129],
-    [25, 138, 122],
-    [24, 140, 113],
-    [21, 144, 104],
-    [20, 146, 97],
-    [16, 148, 87],
-    [14, 152, 81],
-    [27, 153, 75],
-    [41, 157, 70],
-    [54, 160, 64],
-    [69, 164, 60],
-    [84, 166, 54],
-    [98, 170, 49],
-    [110, 173, 44],
-    [123, 176, 38],
-    [138, 180, 34],
-    [151, 182, 28],
-    [166, 186, 23],
-    [179, 189, 18],
-    [194, 193, 13],
-    [194, 189, 13],
-    [194, 186, 13],
-    [193, 183, 14],
-    [194, 180, 15],
-    [194, 177, 15],
-    [194, 174, 14],
-    [193, 171, 14],
-    [194, 169, 15],
-    [193, 165, 15],
-    [194, 161, 16],
-    [194, 160, 15],
-    [194, 156, 17],
-    [194, 154, 18],
-    [195, 150, 17],
-    [194, 147, 17],
-    [195, 145, 18],
-    [195, 142, 18],
-    [195, 138, 19],
-    [194, 135, 19],
-    [195, 133, 20],
-    [195, 129, 20],
-    [195, 126, 19],
-    [195, 124, 22],
-    [193, 118, 21],
-    [191, 114, 24],
-    [189, 109, 24],
-    [188, 104, 27],
-    [186, 100, 27],
-    [185, 95, 29],
-    [183, 91, 30],
-    [181, 86, 32],
-    [180, 82, 33],
-    [178, 77, 35],
-    [177, 73, 36],
-    [176, 67, 38],
-    [173, 63, 39],
-    [172, 59, 41],
-    [172, 54, 41],
-    [169, 50, 44],
-    [169, 45, 45],
-    [170, 53, 60],
-    [171, 61, 74],
-    [174, 68, 90],
-    [174, 76, 103],
-    [177, 83, 119],
-    [179, 92, 133],
-    [181, 99, 149],
-    [182, 107, 162],
-    [185, 114, 178],
-    [186, 123, 192],
-    [187, 131, 208],
-    [190, 139, 222],
-    [193, 146, 238],
-    [194, 149, 236],
-    [195, 153, 238],
-    [197, 158, 237],
-    [199, 160, 237],
-    [200, 165, 237],
-    [203, 168, 236],
-    [193, 169, 235],
-    [185, 168, 232],
-    [176, 168, 229],
-    [166, 168, 228],
-    [157, 168, 225],
-    [149, 168, 222],
-    [140, 170, 220],
-    [131, 169, 218],
-    [121, 170, 215],
-    [113, 170, 212],
-    [103, 170, 211],
-    [94, 170, 208],
-    [86, 171, 206],
-    [76, 171, 203],
-    [68, 171, 202],
-    [59, 171, 199],
-    [51, 170, 196],
-    [41, 171, 195],
-    [33, 172, 193],
-    [23, 172, 190],
-    [14, 172, 187],
-    [18, 173, 181],
-    [24, 174, 174],
-    [30, 175, 166],
-    [33, 176, 160],
-    [39, 177, 152],
-    [45, 178, 145],
-    [49, 179, 139],
-    [54, 180, 131],
-    [60, 181, 126],
-    [64, 182, 118],
-    [69, 183, 110],
-    [74, 183, 104],
-    [79, 185, 97],
-    [84, 186, 91],
-    [88, 187, 83],
-    [93, 187, 76],
-    [99, 189, 71],
-    [103, 190, 63],
-    [107, 191, 57],
-    [113, 192, 50],
-    [118, 193, 42],
-    [122, 194, 36],
-    [127, 195, 28],
-    [133, 195, 20],
-    [139, 196, 15],
-    [143, 199, 14],
-    [148, 200, 15],
-    [151, 202, 13],
-    [155, 204, 13],
-    [161, 206, 15],
-    [164, 208, 13],
-    [169, 209, 13],
-    [173, 211, 14],
-    [178, 213, 13],
-    [182, 214, 13],
-    [187, 216, 14],
-    [192, 217, 13],
-    [196, 219, 13],
-    [201, 221, 13],
-    [205, 223, 13],
-    [210, 224, 13],
-    [213, 226, 11],
-    [217, 228, 13],
-    [222, 229, 13],
-    [226, 231, 11],
-    [231, 233, 13],
-    [236, 234, 13],
-    [236, 229, 13],
-    [236, 224, 16],
-    [237, 219, 17],
-    [236, 214, 20],
-    [236, 209, 22],
-    [236, 203, 22],
-    [236, 198, 25],
-    [237, 193, 28],
-    [236, 188, 30],
-    [236, 183, 31],
-    [236, 177, 33],
-    [236, 172, 34],
-    [236, 167, 36],
-    [236, 162, 39],
-    [238, 156, 42],
-    [237, 151, 42],
-    [237, 146, 45],
-    [237, 140, 47],
-    [238, 136, 48],
-    [238, 131, 51],
-    [237, 125, 53],
-    [235, 118, 52],
-    [235, 113, 52],
-    [234, 105, 52],
-    [233, 99, 52],
-    [232, 93, 52],
-    [231, 86, 53],
-    [229, 80, 52],
-    [230, 73, 52],
-    [228, 67, 53],
-    [227, 61, 53],
-    [226, 54, 52],
-    [225, 48, 52],
-    [227, 56, 61],
-    [227, 64, 69],
-    [227, 73, 77],
-    [227, 80, 86],
-    [227, 88, 93],
-    [229, 96, 101],
-    [228, 105, 109],
-    [230, 113, 118],
-    [230, 121, 126],
-    [231, 130, 136],
-    [231, 138, 142],
-    [230, 146, 150],
-    [231, 154, 158],
-    [233, 162, 166],
-    [233, 170, 175],
-    [232, 175, 178],
-    [232, 179, 183],
-    [233, 184, 189],
-    [233, 189, 194],
-    [233, 195, 198],
-    [233, 199, 202],
-    [235, 204, 206],
-    [235, 208, 213],
-    [234, 213, 216],
-    [235, 218, 222],
-    [235, 222, 227],
-    [234, 227, 230],
-    [235, 232, 235],
-]
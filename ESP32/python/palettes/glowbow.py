@@ -1,281 +0,0 @@
-"""
-  "Glowbow" colormap for 8-bit LEP indexed data
- 
-  Copyright 2020 Dan Julio, converted to python by Todd LaWall (bitreaper)
- 
-  This file is part of firecam.
- 
-  firecam is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
- 
-  firecam is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
- 
-  You should have received a copy of the GNU General Public License
-  along with firecam.  If not, see <https://www.gnu.org/licenses/>.
- 
-"""
-
-
-glowbow_palette = [
-    [16, 16, 16],
-    [19, 17, 18],
-    [22, 16, 16],
-    [25, 17, 18],
-    [28, 17, 19],
-    [31, 17, 20],
-    [34, 17, 19],
-    [36, 18, 20],
-    [39, 18, 19],
-    [43, 19, 21],
-    [45, 18, 21],
-    [48, 20, 21],
-    [52, 19, 22],
-    [54, 20, 23],
-    [58, 20, 23],
-    [63, 21, 23],
-    [68, 21, 25],
-    [70, 21, 26],
-    [73, 22, 27],
-    [75, 22, 26],
-    [79, 22, 27],
-    [81, 22, 28],
-    [84, 23, 27],
-    [87, 22, 28],
-    [91, 24, 30],
-    [96, 23, 30],
-    [102, 24, 33],
-    [104, 25, 32],
-    [108, 25, 33],
-    [110, 25, 34],
-    [117, 25, 34],
-    [120, 27, 34],
-    [122, 27, 35],
-    [127, 28, 35],
-    [129, 27, 35],
-    [132, 29, 37],
-    [135, 27, 37],
-    [138, 29, 38],
-    [141, 29, 39],
-    [143, 29, 40],
-    [147, 29, 41],
-    [150, 31, 41],
-    [152, 30, 41],
-    [155, 29, 42],
-    [158, 30, 41],
-    [165, 31, 44],
-    [167, 32, 43],
-    [170, 32, 44],
-    [175, 33, 45],
-    [177, 33, 46],
-    [178, 32, 46],
-    [182, 32, 45],
-    [186, 33, 47],
-    [188, 34, 48],
-    [190, 34, 47],
-    [194, 34, 48],
-    [195, 35, 49],
-    [195, 35, 47],
-    [197, 38, 48],
-    [196, 39, 46],
-    [198, 39, 45],
-    [199, 41, 44],
-    [200, 42, 43],
-    [201, 43, 43],
-    [200, 44, 41],
-    [201, 45, 42],
-    [203, 46, 41],
-    [204, 47, 42],
-    [204, 47, 40],
-    [205, 49, 40],
-    [205, 49, 38],
-    [206, 52, 38],
-    [207, 52, 36],
-    [208, 53, 37],
-    [209, 54, 36],
-    [210, 55, 36],
-    [210, 58, 35],
-    [211, 59, 34],
-    [212, 60, 33],
-    [213, 60, 33],
-    [214, 61, 33],
-    [213, 62, 31],
-    [215, 64, 33],
-    [215, 64, 31],
-    [216, 66, 30],
-    [218, 66, 30],
-    [218, 66, 30],
-    [218, 68, 29],
-    [219, 70, 28],
-    [220, 69, 28],
-    [221, 72, 26],
-    [223, 73, 26],
-    [222, 74, 24],
-    [223, 75, 25],
-    [224, 76, 24],
-    [225, 78, 23],
-    [225, 78, 22],
-    [226, 79, 23],
-    [227, 80, 22],
-    [227, 81, 20],
-    [228, 82, 21],
-    [229, 83, 20],
-    [230, 83, 18],
-    [231, 86, 19],
-    [231, 86, 17],
-    [232, 87, 16],
-    [233, 88, 17],
-    [234, 90, 16],
-    [235, 91, 14],
-    [235, 91, 14],
-    [236, 93, 13],
-    [237, 94, 12],
-    [236, 96, 13],
-    [237, 97, 13],
-    [237, 99, 14],
-    [237, 101, 13],
-    [236, 103, 12],
-    [236, 105, 13],
-    [237, 106, 12],
-    [236, 108, 11],
-    [236, 112, 12],
-    [237, 113, 13],
-    [236, 115, 12],
-    [236, 117, 13],
-    [235, 119, 12],
-    [236, 122, 12],
-    [237, 123, 13],
-    [237, 125, 13],
-    [236, 127, 12],
-    [236, 129, 13],
-    [237, 130, 12],
-    [236, 132, 13],
-    [236, 134, 12],
-    [237, 135, 12],
-    [237, 137, 13],
-    [237, 142, 12],
-    [236, 144, 13],
-    [236, 146, 12],
-    [237, 147, 13],
-    [237, 149, 12],
-    [236, 151, 13],
-    [237, 152, 13],
-    [237, 154, 12],
-    [236, 156, 13],
-    [236, 158, 12],
-    [236, 160, 11],
-    [235, 161, 12],
-    [236, 163, 12],
-    [236, 165, 13],
-    [235, 167, 12],
-    [236, 170, 12],
-    [236, 172, 11],
-    [235, 173, 12],
-    [236, 176, 12],
-    [235, 179, 12],
-    [236, 180, 13],
-    [236, 182, 12],
-    [236, 184, 11],
-    [237, 185, 12],
-    [236, 187, 11],
-    [236, 188, 12],
-    [235, 190, 12],
-    [236, 191, 13],
-    [235, 194, 12],
-    [236, 196, 11],
-    [235, 199, 11],
-    [236, 201, 11],
-    [235, 202, 12],
-    [235, 204, 14],
-    [236, 204, 19],
-    [236, 205, 23],
-    [236, 204, 27],
-    [235, 206, 30],
-    [236, 206, 34],
-    [236, 207, 37],
-    [236, 207, 41],
-    [235, 208, 45],
-    [236, 208, 48],
-    [236, 209, 52],
-    [236, 209, 56],
-    [235, 211, 65],
-    [236, 212, 68],
-    [235, 212, 71],
-    [236, 212, 74],
-    [234, 212, 78],
-    [235, 213, 82],
-    [235, 214, 87],
-    [236, 214, 91],
-    [236, 215, 94],
-    [235, 217, 97],
-    [235, 216, 100],
-    [235, 217, 105],
-    [235, 216, 108],
-    [234, 218, 111],
-    [235, 218, 116],
-    [235, 219, 122],
-    [235, 220, 127],
-    [236, 220, 131],
-    [235, 221, 134],
-    [235, 221, 138],
-    [235, 222, 142],
-    [235, 221, 146],
-    [234, 222, 148],
-    [235, 223, 153],
-    [235, 224, 157],
-    [235, 225, 160],
-    [236, 225, 165],
-    [234, 225, 168],
-    [235, 226, 171],
-    [235, 225, 175],
-    [236, 227, 182],
-    [235, 228, 187],
-    [234, 228, 190],
-    [234, 229, 195],
-    [235, 230, 197],
-    [236, 230, 202],
-    [234, 230, 205],
-    [235, 231, 208],
-    [235, 232, 213],
-    [235, 231, 216],
-    [234, 232, 219],
-    [234, 234, 224],
-    [235, 234, 228],
-    [235, 235, 235],
-    [16, 16, 16],
-    [17, 17, 17],
-    [18, 18, 18],
-    [19, 19, 19],
-    [20, 20, 20],
-    [21, 21, 21],
-    [22, 22, 22],
-    [23, 23, 23],
-    [24, 24, 24],
-    [25, 25, 25],
-    [26, 26, 26],
-    [27, 27, 27],
-    [28, 28, 28],
-    [29, 29, 29],
-    [30, 30, 30],
-    [31, 31, 31],
-    [32, 32, 32],
-    [33, 33, 33],
-    [34, 34, 34],
-    [35, 35, 35],
-    [36, 36, 36],
-    [37, 37, 37],
-    [38, 38, 38],
-    [39, 39, 39],
-    [40, 40, 40],
-    [41, 41, 41],
-    [42, 42, 42],
-    [43, 43, 43],
-    [44, 44, 44],
-    [44, 44, 44],
-    [45, 45, 45],
-    [46, 46, 46],
-]
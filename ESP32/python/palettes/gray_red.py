@@ -1,280 +0,0 @@
-"""
-  "GrayRed" colormap for 8-bit LEP indexed data
- 
-  Copyright 2020 Dan Julio, converted to python by Todd LaWall (bitreaper)
- 
-  This file is part of firecam.
- 
-  firecam is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
- 
-  firecam is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
- 
-  You should have received a copy of the GNU General Public License
-  along with firecam.  If not, see <https://www.gnu.org/licenses/>.
- 
-"""
-
-gray_red_palette = [
-    [218, 186, 175],
-    [216, 186, 174],
-    [214, 186, 173],
-    [213, 185, 172],
-    [212, 184, 171],
-    [209, 183, 170],
-    [206, 182, 170],
-    [205, 181, 169],
-    [202, 180, 168],
-    [202, 180, 168],
-    [199, 179, 168],
-    [197, 178, 167],
-    [194, 178, 166],
-    [193, 177, 166],
-    [191, 177, 165],
-    [186, 176, 165],
-    [185, 175, 164],
-    [182, 173, 162],
-    [180, 174, 162],
-    [177, 172, 162],
-    [174, 172, 161],
-    [172, 170, 159],
-    [170, 170, 160],
-    [168, 169, 159],
-    [165, 169, 158],
-    [162, 167, 157],
-    [160, 168, 157],
-    [157, 167, 155],
-    [156, 166, 154],
-    [153, 165, 155],
-    [149, 164, 155],
-    [146, 164, 154],
-    [143, 163, 152],
-    [140, 162, 153],
-    [137, 161, 151],
-    [136, 160, 150],
-    [134, 159, 149],
-    [131, 159, 150],
-    [128, 157, 148],
-    [126, 158, 148],
-    [124, 156, 147],
-    [122, 156, 146],
-    [120, 155, 147],
-    [117, 155, 146],
-    [115, 154, 145],
-    [110, 152, 144],
-    [109, 152, 144],
-    [106, 151, 142],
-    [105, 150, 141],
-    [101, 149, 141],
-    [100, 149, 141],
-    [99, 148, 140],
-    [96, 148, 139],
-    [93, 146, 138],
-    [92, 147, 138],
-    [91, 146, 137],
-    [90, 145, 138],
-    [86, 143, 136],
-    [85, 142, 135],
-    [83, 142, 134],
-    [80, 142, 133],
-    [77, 140, 133],
-    [76, 139, 132],
-    [75, 138, 131],
-    [74, 137, 130],
-    [72, 137, 129],
-    [71, 136, 130],
-    [69, 137, 128],
-    [68, 136, 127],
-    [67, 134, 128],
-    [66, 133, 127],
-    [65, 134, 127],
-    [64, 133, 126],
-    [63, 132, 125],
-    [62, 131, 124],
-    [61, 130, 123],
-    [60, 129, 122],
-    [59, 128, 121],
-    [59, 128, 121],
-    [58, 127, 120],
-    [58, 125, 119],
-    [58, 125, 119],
-    [57, 124, 118],
-    [58, 123, 117],
-    [58, 123, 117],
-    [58, 123, 117],
-    [57, 122, 116],
-    [56, 121, 115],
-    [56, 121, 115],
-    [57, 120, 115],
-    [58, 117, 111],
-    [58, 117, 111],
-    [59, 116, 111],
-    [59, 116, 111],
-    [60, 114, 110],
-    [60, 115, 108],
-    [61, 114, 108],
-    [61, 112, 107],
-    [61, 112, 107],
-    [63, 112, 107],
-    [63, 112, 107],
-    [63, 110, 104],
-    [65, 109, 104],
-    [66, 109, 104],
-    [67, 108, 104],
-    [69, 106, 102],
-    [72, 107, 101],
-    [72, 105, 100],
-    [73, 104, 100],
-    [75, 103, 100],
-    [78, 102, 98],
-    [77, 101, 97],
-    [79, 102, 98],
-    [82, 101, 96],
-    [83, 100, 96],
-    [85, 99, 96],
-    [86, 99, 95],
-    [89, 98, 93],
-    [90, 97, 93],
-    [92, 95, 92],
-    [96, 94, 91],
-    [97, 94, 91],
-    [100, 93, 89],
-    [103, 93, 90],
-    [104, 93, 88],
-    [107, 91, 88],
-    [107, 90, 86],
-    [111, 89, 87],
-    [112, 89, 87],
-    [114, 88, 85],
-    [117, 87, 83],
-    [120, 87, 84],
-    [122, 86, 84],
-    [125, 85, 82],
-    [126, 84, 82],
-    [130, 82, 81],
-    [134, 82, 80],
-    [135, 82, 78],
-    [138, 81, 78],
-    [140, 80, 78],
-    [143, 80, 77],
-    [145, 79, 77],
-    [148, 78, 75],
-    [150, 77, 75],
-    [153, 77, 75],
-    [154, 77, 73],
-    [157, 75, 73],
-    [159, 73, 72],
-    [163, 73, 71],
-    [164, 72, 71],
-    [168, 70, 69],
-    [171, 71, 69],
-    [173, 70, 69],
-    [176, 68, 67],
-    [178, 68, 67],
-    [180, 67, 65],
-    [182, 66, 65],
-    [184, 66, 66],
-    [187, 65, 64],
-    [188, 64, 64],
-    [191, 63, 63],
-    [193, 63, 63],
-    [194, 62, 61],
-    [197, 61, 61],
-    [198, 60, 61],
-    [202, 59, 57],
-    [204, 58, 57],
-    [205, 57, 57],
-    [208, 58, 56],
-    [209, 57, 56],
-    [212, 56, 56],
-    [213, 55, 55],
-    [214, 54, 54],
-    [216, 53, 52],
-    [218, 52, 52],
-    [219, 51, 52],
-    [221, 51, 50],
-    [222, 50, 50],
-    [223, 49, 50],
-    [225, 49, 48],
-    [227, 47, 47],
-    [228, 48, 48],
-    [228, 46, 47],
-    [229, 45, 46],
-    [231, 45, 46],
-    [231, 45, 46],
-    [232, 44, 46],
-    [233, 43, 43],
-    [234, 42, 43],
-    [234, 40, 42],
-    [234, 40, 42],
-    [236, 40, 42],
-    [236, 38, 41],
-    [236, 38, 39],
-    [238, 37, 39],
-    [236, 35, 37],
-    [237, 35, 35],
-    [237, 35, 35],
-    [236, 34, 36],
-    [238, 33, 34],
-    [237, 32, 35],
-    [238, 31, 35],
-    [237, 31, 32],
-    [236, 30, 31],
-    [235, 29, 30],
-    [235, 29, 30],
-    [235, 29, 30],
-    [234, 28, 29],
-    [234, 26, 28],
-    [233, 25, 27],
-    [232, 24, 26],
-    [232, 24, 26],
-    [231, 23, 25],
-    [231, 23, 25],
-    [230, 22, 24],
-    [232, 21, 24],
-    [231, 20, 23],
-    [230, 19, 22],
-    [229, 18, 21],
-    [230, 18, 21],
-    [229, 17, 20],
-    [229, 17, 20],
-    [228, 16, 19],
-    [227, 15, 18],
-    [16, 16, 16],
-    [19, 17, 18],
-    [22, 16, 16],
-    [25, 17, 18],
-    [28, 17, 19],
-    [31, 17, 20],
-    [34, 17, 19],
-    [36, 18, 20],
-    [39, 18, 19],
-    [43, 19, 21],
-    [45, 18, 21],
-    [48, 20, 21],
-    [52, 19, 22],
-    [54, 20, 23],
-    [58, 20, 23],
-    [63, 21, 23],
-    [68, 21, 25],
-    [70, 21, 26],
-    [73, 22, 27],
-    [75, 22, 26],
-    [79, 22, 27],
-    [81, 22, 28],
-    [84, 23, 27],
-    [87, 22, 28],
-    [91, 24, 30],
-    [96, 23, 30],
-    [102, 24, 33],
-    [104, 25, 32],
-    [108, 25, 33],
-    [110, 25, 34],
-    [117, 25, 34],
-    [120, 27, 34],
-]
@@ -1,280 +0,0 @@
-"""
-  "Lava" colormap for 8-bit LEP indexed data
- 
-  Copyright 2020 Dan Julio, converted to python by Todd LaWall (bitreaper)
- 
-  This file is part of firecam.
- 
-  firecam is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
- 
-  firecam is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
- 
-  You should have received a copy of the GNU General Public License
-  along with firecam.  If not, see <https://www.gnu.org/licenses/>.
- 
-"""
-
-lava_palette = [
-    [16, 16, 16],
-    [17, 19, 22],
-    [19, 21, 30],
-    [20, 24, 37],
-    [22, 27, 43],
-    [22, 31, 50],
-    [24, 32, 57],
-    [25, 37, 65],
-    [26, 39, 70],
-    [28, 43, 78],
-    [29, 44, 85],
-    [31, 47, 94],
-    [32, 50, 100],
-    [34, 53, 107],
-    [34, 57, 113],
-    [37, 59, 122],
-    [37, 63, 128],
-    [39, 66, 135],
-    [40, 69, 141],
-    [42, 71, 149],
-    [44, 74, 156],
-    [41, 76, 156],
-    [41, 76, 156],
-    [39, 78, 157],
-    [36, 80, 155],
-    [36, 82, 156],
-    [34, 82, 156],
-    [33, 85, 157],
-    [31, 86, 157],
-    [30, 86, 157],
-    [29, 88, 156],
-    [28, 91, 157],
-    [26, 91, 157],
-    [26, 93, 158],
-    [23, 95, 158],
-    [21, 97, 159],
-    [20, 98, 159],
-    [18, 99, 158],
-    [17, 101, 160],
-    [15, 102, 159],
-    [15, 104, 160],
-    [13, 105, 158],
-    [13, 105, 158],
-    [14, 106, 157],
-    [13, 107, 157],
-    [14, 108, 156],
-    [14, 110, 156],
-    [14, 111, 154],
-    [15, 112, 155],
-    [13, 113, 153],
-    [13, 113, 151],
-    [14, 114, 152],
-    [14, 114, 151],
-    [14, 116, 152],
-    [14, 116, 150],
-    [13, 118, 149],
-    [13, 119, 147],
-    [14, 120, 148],
-    [13, 121, 146],
-    [14, 122, 146],
-    [14, 122, 146],
-    [14, 124, 145],
-    [14, 125, 143],
-    [15, 126, 144],
-    [14, 125, 143],
-    [15, 126, 142],
-    [13, 127, 142],
-    [14, 128, 142],
-    [14, 128, 140],
-    [14, 130, 139],
-    [14, 130, 139],
-    [14, 130, 139],
-    [14, 131, 137],
-    [13, 133, 136],
-    [13, 133, 135],
-    [14, 134, 136],
-    [13, 135, 134],
-    [13, 135, 134],
-    [13, 135, 134],
-    [14, 137, 133],
-    [14, 137, 131],
-    [19, 133, 130],
-    [24, 130, 132],
-    [30, 125, 131],
-    [35, 121, 130],
-    [39, 118, 129],
-    [46, 114, 129],
-    [50, 109, 127],
-    [56, 106, 127],
-    [62, 101, 128],
-    [67, 99, 126],
-    [73, 94, 125],
-    [78, 90, 126],
-    [84, 85, 125],
-    [89, 82, 124],
-    [93, 78, 123],
-    [99, 73, 122],
-    [105, 70, 122],
-    [109, 66, 121],
-    [115, 62, 122],
-    [120, 58, 121],
-    [123, 57, 119],
-    [124, 57, 115],
-    [127, 56, 114],
-    [130, 54, 112],
-    [133, 54, 108],
-    [134, 53, 108],
-    [136, 51, 104],
-    [137, 51, 102],
-    [140, 50, 100],
-    [144, 50, 98],
-    [145, 50, 96],
-    [148, 49, 94],
-    [148, 47, 91],
-    [151, 46, 90],
-    [154, 45, 88],
-    [155, 45, 84],
-    [158, 44, 84],
-    [161, 43, 81],
-    [162, 42, 79],
-    [165, 41, 77],
-    [167, 41, 75],
-    [168, 41, 74],
-    [169, 40, 72],
-    [171, 40, 72],
-    [172, 39, 70],
-    [174, 39, 67],
-    [175, 38, 67],
-    [176, 38, 65],
-    [178, 38, 63],
-    [180, 38, 62],
-    [182, 38, 60],
-    [183, 37, 60],
-    [184, 37, 59],
-    [186, 37, 57],
-    [187, 36, 55],
-    [189, 36, 53],
-    [190, 35, 53],
-    [191, 35, 52],
-    [193, 34, 50],
-    [194, 34, 48],
-    [196, 36, 48],
-    [199, 37, 48],
-    [201, 39, 48],
-    [203, 40, 47],
-    [205, 41, 46],
-    [207, 43, 48],
-    [210, 43, 47],
-    [212, 46, 48],
-    [213, 47, 47],
-    [215, 47, 46],
-    [219, 49, 46],
-    [220, 50, 46],
-    [222, 53, 46],
-    [224, 53, 47],
-    [227, 55, 47],
-    [228, 56, 46],
-    [229, 57, 45],
-    [233, 59, 46],
-    [235, 60, 45],
-    [237, 62, 45],
-    [238, 63, 44],
-    [237, 65, 41],
-    [236, 67, 40],
-    [237, 68, 39],
-    [236, 70, 36],
-    [237, 71, 35],
-    [237, 73, 34],
-    [238, 74, 33],
-    [237, 77, 31],
-    [237, 79, 30],
-    [237, 79, 27],
-    [237, 83, 25],
-    [236, 84, 23],
-    [237, 86, 21],
-    [237, 88, 20],
-    [237, 88, 16],
-    [236, 90, 16],
-    [237, 92, 15],
-    [237, 94, 12],
-    [237, 97, 13],
-    [237, 99, 12],
-    [236, 103, 12],
-    [237, 106, 12],
-    [236, 110, 12],
-    [237, 113, 13],
-    [237, 116, 13],
-    [236, 120, 13],
-    [237, 123, 13],
-    [236, 127, 14],
-    [237, 130, 14],
-    [236, 132, 13],
-    [236, 135, 13],
-    [236, 139, 12],
-    [235, 143, 12],
-    [236, 146, 12],
-    [237, 149, 12],
-    [236, 153, 13],
-    [235, 155, 12],
-    [236, 158, 12],
-    [237, 161, 12],
-    [236, 163, 12],
-    [236, 165, 13],
-    [235, 167, 12],
-    [236, 170, 12],
-    [236, 172, 11],
-    [235, 173, 12],
-    [236, 176, 12],
-    [235, 179, 12],
-    [235, 181, 11],
-    [236, 183, 13],
-    [235, 185, 12],
-    [235, 187, 11],
-    [236, 189, 11],
-    [236, 191, 13],
-    [235, 194, 12],
-    [236, 196, 11],
-    [236, 199, 11],
-    [236, 200, 12],
-    [235, 202, 12],
-    [236, 205, 23],
-    [235, 207, 34],
-    [235, 208, 45],
-    [236, 209, 56],
-    [235, 211, 67],
-    [234, 212, 78],
-    [236, 214, 90],
-    [235, 216, 100],
-    [234, 218, 111],
-    [236, 220, 123],
-    [234, 220, 133],
-    [235, 221, 146],
-    [235, 224, 157],
-    [236, 225, 167],
-    [235, 226, 179],
-    [235, 229, 191],
-    [235, 229, 201],
-    [235, 232, 213],
-    [235, 233, 224],
-    [235, 235, 235],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-]
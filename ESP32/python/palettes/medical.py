@@ -1,280 +0,0 @@
-"""
-  "Medical" colormap for 8-bit LEP indexed data
- 
-  Copyright 2020 Dan Julio, converted to python by Todd LaWall (bitreaper)
- 
-  This file is part of firecam.
- 
-  firecam is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
- 
-  firecam is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
- 
-  You should have received a copy of the GNU General Public License
-  along with firecam.  If not, see <https://www.gnu.org/licenses/>.
- 
-"""
-
-medical_palette = [
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [36, 36, 198],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [70, 71, 238],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [25, 172, 193],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [14, 158, 13],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [15, 15, 123],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [237, 65, 197],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [238, 28, 28],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [236, 152, 93],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [230, 125, 12],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [236, 196, 37],
-    [17, 14, 17],
-    [16, 23, 17],
-    [17, 32, 17],
-    [16, 40, 16],
-    [16, 49, 16],
-    [15, 58, 16],
-    [15, 65, 16],
-    [14, 74, 16],
-    [15, 82, 16],
-    [15, 91, 15],
-    [14, 100, 15],
-    [15, 108, 15],
-    [14, 117, 14],
-    [15, 125, 16],
-    [14, 134, 15],
-    [14, 143, 15],
-    [15, 151, 15],
-    [14, 160, 14],
-    [15, 168, 14],
-    [14, 177, 14],
-    [14, 186, 13],
-    [13, 192, 14],
-    [13, 201, 14],
-    [14, 209, 13],
-    [14, 219, 14],
-    [13, 228, 14],
-    [14, 236, 13],
-    [22, 227, 22],
-    [28, 219, 29],
-    [37, 212, 37],
-    [46, 204, 46],
-    [52, 196, 53],
-]
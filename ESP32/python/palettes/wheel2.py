@@ -1,280 +0,0 @@
-"""
-  "Wheel2" colormap for 8-bit LEP indexed data
- 
-  Copyright 2020 Dan Julio, converted to python by Todd LaWall (bitreaper)
- 
-  This file is part of firecam.
- 
-  firecam is free software: you can redistribute it and/or modify
-  it under the terms of the GNU General Public License as published by
-  the Free Software Foundation, either version 3 of the License, or
-  (at your option) any later version.
- 
-  firecam is distributed in the hope that it will be useful,
-  but WITHOUT ANY WARRANTY; without even the implied warranty of
-  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-  GNU General Public License for more details.
- 
-  You should have received a copy of the GNU General Public License
-  along with firecam.  If not, see <https://www.gnu.org/licenses/>.
- 
-"""
-
-wheel2_palette = [
-    [17, 14, 17],
-    [16, 23, 17],
-    [17, 32, 17],
-    [16, 40, 16],
-    [16, 49, 16],
-    [15, 58, 16],
-    [15, 65, 16],
-    [14, 74, 16],
-    [15, 82, 16],
-    [15, 91, 15],
-    [14, 100, 15],
-    [15, 108, 15],
-    [14, 117, 14],
-    [15, 125, 16],
-    [14, 134, 15],
-    [14, 143, 15],
-    [15, 151, 15],
-    [14, 160, 14],
-    [15, 168, 14],
-    [14, 177, 14],
-    [14, 186, 13],
-    [13, 192, 14],
-    [13, 201, 14],
-    [14, 209, 13],
-    [14, 219, 14],
-    [13, 228, 14],
-    [14, 236, 13],
-    [22, 227, 22],
-    [28, 219, 29],
-    [37, 212, 37],
-    [46, 204, 46],
-    [52, 196, 53],
-    [61, 188, 61],
-    [69, 181, 69],
-    [76, 172, 76],
-    [85, 164, 85],
-    [94, 156, 95],
-    [102, 147, 102],
-    [109, 140, 110],
-    [117, 132, 117],
-    [126, 123, 126],
-    [133, 116, 134],
-    [141, 108, 141],
-    [149, 101, 149],
-    [157, 93, 157],
-    [165, 84, 165],
-    [174, 76, 175],
-    [183, 68, 183],
-    [189, 60, 190],
-    [198, 52, 198],
-    [205, 45, 205],
-    [213, 36, 214],
-    [222, 29, 222],
-    [228, 21, 229],
-    [238, 14, 239],
-    [233, 17, 238],
-    [229, 22, 238],
-    [223, 27, 239],
-    [218, 31, 238],
-    [213, 37, 238],
-    [209, 41, 238],
-    [204, 45, 239],
-    [199, 51, 239],
-    [195, 55, 238],
-    [191, 60, 238],
-    [185, 65, 237],
-    [180, 69, 238],
-    [177, 74, 239],
-    [171, 79, 238],
-    [167, 84, 238],
-    [161, 89, 239],
-    [157, 93, 238],
-    [153, 98, 239],
-    [147, 101, 237],
-    [142, 107, 237],
-    [138, 111, 238],
-    [133, 115, 237],
-    [128, 121, 238],
-    [123, 125, 237],
-    [118, 131, 237],
-    [114, 135, 238],
-    [109, 139, 237],
-    [104, 145, 237],
-    [100, 149, 238],
-    [96, 154, 239],
-    [91, 159, 238],
-    [85, 163, 237],
-    [82, 169, 237],
-    [76, 173, 238],
-    [71, 177, 238],
-    [67, 182, 237],
-    [61, 187, 236],
-    [57, 192, 236],
-    [52, 196, 237],
-    [47, 201, 237],
-    [43, 206, 237],
-    [37, 210, 238],
-    [33, 215, 238],
-    [29, 220, 237],
-    [23, 226, 237],
-    [19, 230, 237],
-    [15, 235, 237],
-    [19, 229, 232],
-    [24, 226, 228],
-    [28, 221, 224],
-    [33, 216, 218],
-    [36, 212, 214],
-    [42, 208, 210],
-    [46, 203, 206],
-    [49, 199, 201],
-    [54, 194, 197],
-    [59, 191, 192],
-    [64, 185, 188],
-    [68, 181, 183],
-    [73, 176, 179],
-    [76, 172, 175],
-    [81, 168, 171],
-    [86, 163, 167],
-    [91, 158, 162],
-    [95, 155, 157],
-    [100, 150, 153],
-    [104, 146, 148],
-    [108, 141, 144],
-    [114, 137, 139],
-    [117, 133, 136],
-    [121, 129, 130],
-    [126, 123, 126],
-    [131, 118, 123],
-    [136, 115, 118],
-    [139, 111, 114],
-    [144, 106, 109],
-    [148, 101, 105],
-    [154, 97, 100],
-    [157, 93, 97],
-    [161, 89, 91],
-    [167, 85, 86],
-    [172, 79, 83],
-    [176, 75, 77],
-    [179, 71, 73],
-    [184, 66, 70],
-    [189, 61, 64],
-    [194, 57, 61],
-    [197, 53, 56],
-    [202, 48, 52],
-    [207, 45, 47],
-    [212, 39, 44],
-    [216, 35, 38],
-    [219, 31, 34],
-    [225, 27, 30],
-    [229, 22, 26],
-    [234, 17, 20],
-    [239, 14, 18],
-    [233, 14, 22],
-    [230, 13, 26],
-    [224, 14, 31],
-    [219, 14, 35],
-    [214, 14, 39],
-    [210, 13, 45],
-    [206, 14, 49],
-    [201, 14, 55],
-    [195, 14, 59],
-    [190, 14, 64],
-    [186, 14, 68],
-    [181, 14, 72],
-    [176, 14, 77],
-    [173, 14, 84],
-    [168, 14, 88],
-    [163, 14, 92],
-    [158, 14, 97],
-    [152, 14, 101],
-    [147, 14, 107],
-    [143, 14, 111],
-    [139, 15, 117],
-    [133, 14, 120],
-    [130, 14, 125],
-    [125, 14, 131],
-    [120, 14, 136],
-    [115, 14, 140],
-    [109, 14, 144],
-    [106, 14, 149],
-    [100, 13, 155],
-    [96, 15, 158],
-    [91, 15, 164],
-    [87, 14, 169],
-    [82, 14, 173],
-    [77, 14, 177],
-    [72, 14, 182],
-    [66, 14, 186],
-    [64, 14, 193],
-    [58, 15, 197],
-    [53, 15, 202],
-    [48, 15, 206],
-    [44, 14, 210],
-    [39, 14, 216],
-    [34, 14, 221],
-    [30, 13, 225],
-    [24, 15, 230],
-    [20, 15, 235],
-    [15, 14, 241],
-    [20, 18, 237],
-    [23, 21, 232],
-    [27, 26, 228],
-    [30, 29, 223],
-    [36, 33, 220],
-    [38, 37, 215],
-    [42, 41, 211],
-    [45, 45, 207],
-    [50, 49, 203],
-    [54, 52, 199],
-    [58, 56, 195],
-    [61, 60, 192],
-    [66, 64, 188],
-    [69, 68, 184],
-    [73, 72, 180],
-    [78, 75, 176],
-    [82, 79, 172],
-    [84, 82, 167],
-    [89, 87, 164],
-    [91, 90, 159],
-    [97, 95, 156],
-    [100, 98, 151],
-    [104, 103, 147],
-    [108, 105, 144],
-    [112, 109, 140],
-    [115, 113, 136],
-    [120, 117, 132],
-    [124, 121, 128],
-    [127, 125, 124],
-    [131, 129, 120],
-    [134, 133, 116],
-    [139, 137, 111],
-    [143, 140, 107],
-    [148, 144, 105],
-    [151, 148, 101],
-    [155, 152, 97],
-    [158, 156, 93],
-    [162, 160, 89],
-    [167, 164, 85],
-    [169, 167, 80],
-    [173, 171, 75],
-    [176, 175, 71],
-    [181, 179, 67],
-    [185, 182, 63],
-    [189, 186, 61],
-    [192, 190, 57],
-    [197, 194, 53],
-    [200, 198, 49],
-    [204, 202, 45],
-    [209, 205, 40],
-    [213, 209, 36],
-    [216, 213, 32],
-    [220, 217, 28],
-    [223, 221, 24],
-    [228, 225, 20],
-    [232, 229, 16],
-    [235, 233, 14],
-]
@@ -19,19 +19,1704 @@
   along with tCam.  If not, see <https://www.gnu.org/licenses/>.
 """
 
+import base64
+import binascii
+import bisect
+import calendar
+import http.client
+import ipaddress
+import mmap
+import os
+import select
 import socket
-from queue import Queue
+import struct
+import time
+import traceback
+from collections import namedtuple
+from collections.abc import Mapping
+from queue import Full, Queue
 from threading import Thread, Event
 import json
 from json import JSONDecodeError
 
 
+# Binary image format (see the tCam-Mini readme)
+BIN_IMAGE_START = 0x01
+BIN_IMAGE_VERSION = 1
+BIN_IMAGE_HEADER = struct.Struct("<BBHIHHHH")
+BIN_TLV_STRINGS = {1: "Camera", 3: "Version", 4: "Time", 5: "Date"}
+BIN_TLV_MODEL = 2
+BIN_TLV_MIN_MAX = 6
+BIN_TLV_ENCODING = 7
+BIN_TLV_TIMESTAMP = 8
+BIN_TLV_JSON_META = 9
+BIN_TLV_CAPTURE_USEC = 10
+BIN_TLV_TIME_SYNC = 11
+BIN_TLV_SEQ = 12
+BIN_TLV_TELEM_FIELDS = 13
+BIN_TLV_AVERAGE = 14
+BIN_TLV_SYNC_TICK = 15
+BIN_TLV_HISTOGRAM = 16
+BIN_HIST_BINS = 64
+BIN_ENC_RAW = 0
+BIN_ENC_RICE = 1
+BIN_ENC_RICE_DELTA = 2
+BIN_ENC_PNG = 3
+BIN_ENC_JPEG = 4
+BIN_ENC_AGC8 = 5
+BIN_ENC_SPARSE = 6
+
+# Telemetry fields sent with streamed images instead of the telemetry (set_image_format telem mask)
+TELEM_FRAME_CNT = 0x01
+TELEM_FPA_TEMP = 0x02
+TELEM_AUX_TEMP = 0x04
+TELEM_FFC = 0x08
+TELEM_GAIN = 0x10
+TELEM_TLIN = 0x20
+TELEM_ALL = 0x3F
+
+# UDP stream datagram header: start, version, frame number, packet index, packet count, image offset
+UDP_PKT_START = 0x04
+UDP_PKT_HEADER = struct.Struct("<BBHHHI")
+
+# Low latency stream segment header: start, version, header length, frame number, segment, pixel offset, pixel
+# count, binary image header length, telemetry length
+SEG_START = 0x07
+SEG_HEADER = struct.Struct("<BBHIBxHHHH")
+SEG_COUNT = 4
+
+# Raw stream packet batch header: start, version, header length, number of the first packet, Lepton, number of
+# packets, packet length, low 32 bits of the camera's uSec read time of the first packet
+PKT_START = 0x08
+PKT_VERSION = 1
+PKT_HEADER = struct.Struct("<BBHIBBHI")
+PKT_LEN = 164
+
+# Recording data response header: start, version, header length, offset, data length
+REC_CHUNK_START = 0x05
+REC_CHUNK_HEADER = struct.Struct("<BBHII")
+REC_CHUNK_LEN = 4096
+
+# Recording container (see rec_task.h in the firmware): magic, version, encoding, header length, key interval,
+# frame delay, index offset, index entries, records length, number of records, frame index length
+REC_FILE_MAGIC = b"tREC"
+REC_FILE_VERSION = 2
+REC_FILE_HEADER = struct.Struct("<4sBBHIIHH12xQII")
+REC_HEADER_LEN = 4096
+REC_INDEX_OFFSET = 64
+REC_INDEX_ENTRY = struct.Struct("<IQ")
+REC_INDEX_ENTRIES = (REC_HEADER_LEN - REC_INDEX_OFFSET) // REC_INDEX_ENTRY.size
+REC_ERASED_LEN = 0xFFFFFFFFFFFFFFFF
+
+# Recording frame index: start, version, header length, number of entries, entry length.  Each entry: record
+# offset, timestamp, record length, encoding
+REC_FRAME_INDEX_START = 0x06
+REC_FRAME_INDEX_VERSION = 1
+REC_FRAME_INDEX_HEADER = struct.Struct("<BBHIH6x")
+REC_FRAME_INDEX_ENTRY = struct.Struct("<QQIB3x")
+RecordFrame = namedtuple("RecordFrame", "offset timestamp length encoding")
+
+# Event log data response (the same header as recording data) and the event log (see evlog_utilities.h in the
+# firmware).  Each sector starts with a header: magic, version, record length, boot number, sequence number.  Each
+# record: type, a, b, mSec since boot, v1, v2
+LOG_CHUNK_START = 0x09
+LOG_MAGIC = b"tLOG"
+LOG_VERSION = 1
+LOG_SECTOR_LEN = 4096
+LOG_SECTOR_HEADER = struct.Struct("<4sBBHI4x")
+LOG_RECORD = struct.Struct("<BBHIII")
+LOG_EVENTS = {
+    1: "boot",
+    2: "time",
+    3: "fault",
+    4: "recovery",
+    5: "ffc",
+    6: "send_fail",
+    7: "send_stall",
+    8: "minute",
+    9: "suppressed",
+}
+LogRecord = namedtuple("LogRecord", "boot msec event a b v1 v2")
+
+# ESP-NOW gateway serial frame (see gw_task.h in the firmware): sync, packet length, camera MAC address, packet,
+# checksum.  Each packet (see now_task.h): start, version, message type, message number, fragment, fragment count
+GW_FRAME_SYNC = b"\xa5\x5a"
+GW_FRAME_OVERHEAD = 10
+NOW_PKT_START = 0xA7
+NOW_PKT_VERSION = 1
+NOW_PKT_HEADER = struct.Struct("<BBBxHHH")
+NOW_MSG_STATS = 1
+NOW_MSG_IMAGE = 2
+NOW_MODE_OFF = 0
+NOW_MODE_STATS = 1
+NOW_MODE_IMAGE = 2
+
+# Wired serial connection (see ser_task.h in the firmware): COBS encoded packets, each followed by a 0 delimiter.
+# Each packet: type, sequence number, payload, CRC-16/CCITT of the rest (little-endian).  A session is opened at the
+# console rate and the camera closes it after SER_IDLE_SEC without a packet
+SER_CONSOLE_BAUD = 115200
+SER_DEFAULT_BAUD = 3000000
+SER_PKT_OPEN = 1
+SER_PKT_OPENED = 2
+SER_PKT_DATA = 3
+SER_PKT_PING = 4
+SER_PKT_CLOSE = 5
+SER_PKT_ERROR = 6
+SER_MAX_PAYLOAD = 1024
+SER_PKT_OVERHEAD = 4
+SER_IDLE_SEC = 5
+SER_PING_SEC = 1
+SER_OPEN_RETRY_SEC = 0.5
+
+# Connection receive buffer (grown to hold a complete response if necessary) and the minimum free space for a read
+RX_BUF_LEN = 262144
+RX_MIN_READ = 65536
+
+# Frame queue policies when the queue is full: drop the oldest frame, keep only the latest frame or block the
+# manager thread (and so the connection, slowing the camera) until there is room
+FRAME_POLICY_DROP_OLDEST = "drop_oldest"
+FRAME_POLICY_LATEST = "latest"
+FRAME_POLICY_BLOCK = "block"
+FRAME_QUEUE_LEN = 32
+
+# Rice coded image parameters (see rice_codec.h in the firmware)
+RICE_BLOCK_LEN = 32
+RICE_ESCAPE = 16
+
+# Sparse image header and span header: threshold, number of spans / first pixel, number of pixels (see
+# sparse_codec.h in the firmware)
+SPARSE_HEADER = struct.Struct("<HH")
+
+
+def rice_decode_image(data, width, height, ref=None):
+    """
+    rice_decode_image()
+
+    Decode a lossless compressed image into a list of 16-bit pixel values.  Pixels are predicted using the
+    LOCO-I median edge detector (or the reference image pixels for a delta image) and the zig-zag mapped
+    prediction residuals are Rice coded in blocks of RICE_BLOCK_LEN with a 4-bit Rice parameter per block.
+    """
+    num_pixels = width * height
+    pixels = [0] * num_pixels
+    acc = 0
+    nbits = 0
+    pos = 0
+
+    def get_bits(n):
+        nonlocal acc, nbits, pos
+        while nbits < n:
+            acc = (acc << 8) | (data[pos] if pos < len(data) else 0)
+            pos += 1
+            nbits += 8
+        nbits -= n
+        v = acc >> nbits
+        acc &= (1 << nbits) - 1
+        return v
+
+    idx = 0
+    while idx < num_pixels:
+        k = get_bits(4)
+        for _ in range(min(RICE_BLOCK_LEN, num_pixels - idx)):
+            q = 0
+            while q < RICE_ESCAPE and get_bits(1):
+                q += 1
+            if q == RICE_ESCAPE:
+                u = get_bits(16)
+            else:
+                u = (q << k) | get_bits(k) if k else q
+            d = (u >> 1) ^ -(u & 1)
+
+            y, x = divmod(idx, width)
+            if ref is not None:
+                pred = ref[idx]
+            elif y == 0:
+                pred = pixels[idx - 1] if x else 0
+            elif x == 0:
+                pred = pixels[idx - width]
+            else:
+                a = pixels[idx - 1]
+                b = pixels[idx - width]
+                c = pixels[idx - width - 1]
+                if c >= max(a, b):
+                    pred = min(a, b)
+                elif c <= min(a, b):
+                    pred = max(a, b)
+                else:
+                    pred = a + b - c
+            pixels[idx] = (pred + d) & 0xFFFF
+            idx += 1
+    return pixels
+
+
+def rice_encode_image(pixels, width, height, ref=None):
+    """
+    rice_encode_image()
+
+    Encode a list of 16-bit pixel values the same way as the camera (see rice_decode_image()).  The image is
+    encoded as a delta image against ref, the pixel list of the previous image, if ref is not None.
+    """
+    out = bytearray()
+    acc = 0
+    nbits = 0
+
+    def put_bits(v, n):
+        nonlocal acc, nbits
+        acc = (acc << n) | v
+        nbits += n
+        while nbits >= 8:
+            nbits -= 8
+            out.append((acc >> nbits) & 0xFF)
+        acc &= (1 << nbits) - 1
+
+    num_pixels = width * height
+    for start in range(0, num_pixels, RICE_BLOCK_LEN):
+        block = []
+        for idx in range(start, min(start + RICE_BLOCK_LEN, num_pixels)):
+            if ref is not None:
+                pred = ref[idx]
+            else:
+                y, x = divmod(idx, width)
+                if y == 0:
+                    pred = pixels[idx - 1] if x else 0
+                elif x == 0:
+                    pred = pixels[idx - width]
+                else:
+                    a = pixels[idx - 1]
+                    b = pixels[idx - width]
+                    c = pixels[idx - width - 1]
+                    if c >= max(a, b):
+                        pred = min(a, b)
+                    elif c <= min(a, b):
+                        pred = max(a, b)
+                    else:
+                        pred = a + b - c
+            d = (pixels[idx] - pred) & 0xFFFF
+            if d & 0x8000:
+                d -= 0x10000
+            block.append(((d << 1) ^ (d >> 15)) & 0xFFFF)
+
+        n = len(block)
+        total = sum(block)
+        k = 0
+        while k < 15 and (n << k) < total:
+            k += 1
+        put_bits(k, 4)
+        for u in block:
+            q = u >> k
+            if q < RICE_ESCAPE:
+                put_bits(((1 << q) - 1) << 1, q + 1)
+                if k:
+                    put_bits(u & ((1 << k) - 1), k)
+            else:
+                put_bits((1 << RICE_ESCAPE) - 1, RICE_ESCAPE)
+                put_bits(u, 16)
+    if nbits:
+        put_bits(0, 8 - nbits)
+    return bytes(out)
+
+
+def cobs_encode(data):
+    """
+    cobs_encode()
+
+    COBS encode data (without the 0 delimiter).
+    """
+    out = bytearray()
+    for chunk in bytes(data).split(b"\x00"):
+        while len(chunk) >= 254:
+            out.append(0xFF)
+            out += chunk[:254]
+            chunk = chunk[254:]
+        out.append(len(chunk) + 1)
+        out += chunk
+    return bytes(out)
+
+
+def cobs_decode(data):
+    """
+    cobs_decode()
+
+    Decode COBS encoded data (without the 0 delimiter).  Returns None if it isn't valid.
+    """
+    out = bytearray()
+    pos = 0
+    while pos < len(data):
+        code = data[pos]
+        if code == 0 or pos + code > len(data):
+            return None
+        out += data[pos + 1 : pos + code]
+        pos += code
+        if code != 0xFF and pos < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def json_timestamp(meta):
+    """
+    json_timestamp()
+
+    Returns the mSec since 1970 for the camera's "Date" ("M/D/YY") and "Time" ("H:MM:SS.ms") metadata strings,
+    the same value as the binary image timestamp TLV, or None if they aren't valid.
+    """
+    try:
+        month, day, year = (int(v) for v in meta["Date"].split("/"))
+        hms, ms = meta["Time"].split(".")
+        hour, minute, second = (int(v) for v in hms.split(":"))
+        secs = calendar.timegm((2000 + year, month, day, hour, minute, second))
+        return secs * 1000 + int(ms)
+    except (KeyError, AttributeError, TypeError, ValueError, OverflowError):
+        return None
+
+
+def get_binary_image_tlvs(buf, pos=0):
+    """
+    get_binary_image_tlvs()
+
+    Returns a dict of the metadata TLV values (indexed by type) of the binary image starting at pos in buf.
+    """
+    _, _, hdr_len, _, _, _, meta_len, _ = BIN_IMAGE_HEADER.unpack_from(buf, pos)
+    tlvs = {}
+    pos += hdr_len
+    meta_end = pos + meta_len
+    while pos + 2 <= meta_end:
+        tlv_type, tlv_len = buf[pos], buf[pos + 1]
+        tlvs[tlv_type] = bytes(buf[pos + 2 : pos + 2 + tlv_len])
+        pos += 2 + tlv_len
+    return tlvs
+
+
+def get_binary_image_metadata(buf):
+    """
+    get_binary_image_metadata()
+
+    Returns the metadata dict (the same as a json image's metadata) and the image encoding of a binary image.
+    """
+    meta = {}
+    encoding = BIN_ENC_RAW
+    tlvs = get_binary_image_tlvs(buf)
+    for tlv_type, value in tlvs.items():
+        if tlv_type in BIN_TLV_STRINGS:
+            meta[BIN_TLV_STRINGS[tlv_type]] = value.decode()
+        elif tlv_type == BIN_TLV_MODEL:
+            meta["Model"] = value[0]
+        elif tlv_type == BIN_TLV_ENCODING:
+            encoding = value[0]
+        elif tlv_type == BIN_TLV_CAPTURE_USEC:
+            meta["Timestamp"] = struct.unpack("<Q", value)[0]
+        elif tlv_type == BIN_TLV_TIME_SYNC:
+            meta["TimeSync"] = value[0] != 0
+        elif tlv_type == BIN_TLV_SEQ:
+            meta["Seq"] = struct.unpack("<I", value)[0]
+        elif tlv_type == BIN_TLV_TELEM_FIELDS:
+            meta["Telem"] = decode_telem_fields(value)
+        elif tlv_type == BIN_TLV_AVERAGE:
+            meta["AvgFrames"], meta["AvgFracBits"] = value[0], value[1]
+        elif tlv_type == BIN_TLV_SYNC_TICK:
+            meta["SyncTick"] = struct.unpack("<Q", value)[0]
+        elif tlv_type == BIN_TLV_HISTOGRAM and BIN_TLV_MIN_MAX in tlvs:
+            values = struct.unpack(f"<{len(value) // 2}H", value)
+            lo, hi = struct.unpack("<HH", tlvs[BIN_TLV_MIN_MAX])
+            meta["Histogram"] = {
+                "Min": lo,
+                "Max": hi,
+                "P1": values[0],
+                "P50": values[1],
+                "P99": values[2],
+                "Bins": list(values[3:]),
+            }
+        elif tlv_type == BIN_TLV_JSON_META:
+            meta.update(json.loads(value))
+    return meta, encoding
+
+
+def decode_telem_fields(value):
+    """
+    decode_telem_fields()
+
+    Returns the telemetry fields dict (the same as a json image's "Telem" metadata) of a BIN_TLV_TELEM_FIELDS value.
+    """
+    mask = value[0]
+    pos = 1
+    telem = {}
+    if mask & TELEM_FRAME_CNT:
+        telem["FrameCount"] = struct.unpack_from("<I", value, pos)[0]
+        pos += 4
+    if mask & TELEM_FPA_TEMP:
+        telem["FpaTemp"] = struct.unpack_from("<H", value, pos)[0]
+        pos += 2
+    if mask & TELEM_AUX_TEMP:
+        telem["AuxTemp"] = struct.unpack_from("<H", value, pos)[0]
+        pos += 2
+    if mask & TELEM_FFC:
+        telem["FfcState"] = value[pos] & 0x03
+        telem["FfcDesired"] = (value[pos] & 0x04) != 0
+        pos += 1
+    if mask & TELEM_GAIN:
+        telem["GainMode"] = value[pos]
+        pos += 1
+    if mask & TELEM_TLIN:
+        telem["TLinear"] = (value[pos] & 0x01) != 0
+        telem["TLinRes"] = (value[pos] >> 1) & 0x01
+    return telem
+
+
+def encode_telem_fields(telem):
+    """
+    encode_telem_fields()
+
+    Returns the BIN_TLV_TELEM_FIELDS value of a telemetry fields dict (json image "Telem" metadata).
+    """
+    mask = 0
+    data = b""
+    if "FrameCount" in telem:
+        mask |= TELEM_FRAME_CNT
+        data += struct.pack("<I", telem["FrameCount"])
+    if "FpaTemp" in telem:
+        mask |= TELEM_FPA_TEMP
+        data += struct.pack("<H", telem["FpaTemp"])
+    if "AuxTemp" in telem:
+        mask |= TELEM_AUX_TEMP
+        data += struct.pack("<H", telem["AuxTemp"])
+    if "FfcState" in telem:
+        mask |= TELEM_FFC
+        data += bytes([(telem["FfcState"] & 0x03) | (0x04 if telem.get("FfcDesired") else 0)])
+    if "GainMode" in telem:
+        mask |= TELEM_GAIN
+        data += bytes([telem["GainMode"]])
+    if "TLinear" in telem:
+        mask |= TELEM_TLIN
+        data += bytes([(0x01 if telem["TLinear"] else 0) | ((telem.get("TLinRes", 0) & 0x01) << 1)])
+    return bytes([mask]) + data
+
+
+def decode_binary_image(buf, ref=None):
+    """
+    decode_binary_image()
+
+    Convert a binary image response into the same form as a json image response (metadata dict and base64
+    encoded radiometric and telemetry data) so applications work with either image format.  8-bit AGC images
+    are expanded to 16-bit pixels.  Delta images are decoded against ref, the pixel list of the previous image.
+    Returns the image and its pixel list.  Preview images have no radiometric data; the image holds the base64
+    encoded PNG ("png") or JPEG ("jpeg") file instead and the pixel list is None.  Sparse images have 0 for the
+    pixels below their threshold, which is added to the metadata as "Threshold".  Raises ValueError for a delta
+    image without a reference.
+    """
+    _, _, hdr_len, payload_len, width, height, meta_len, telem_len = BIN_IMAGE_HEADER.unpack_from(buf)
+    meta, encoding = get_binary_image_metadata(buf)
+
+    meta_end = hdr_len + meta_len
+    img_end = hdr_len + payload_len - telem_len
+    img = buf[meta_end:img_end]
+    if encoding == BIN_ENC_RICE_DELTA:
+        if ref is None:
+            raise ValueError("delta image without a reference image")
+        pixels = rice_decode_image(img, width, height, ref)
+        img = struct.pack(f"<{width * height}H", *pixels)
+    elif encoding == BIN_ENC_RICE:
+        pixels = rice_decode_image(img, width, height)
+        img = struct.pack(f"<{width * height}H", *pixels)
+    elif encoding == BIN_ENC_AGC8:
+        pixels = list(img)
+        img = struct.pack(f"<{width * height}H", *pixels)
+    elif encoding == BIN_ENC_SPARSE:
+        pixels, meta["Threshold"] = sparse_decode_image(img, width, height)
+        img = struct.pack(f"<{width * height}H", *pixels)
+    elif encoding in (BIN_ENC_PNG, BIN_ENC_JPEG):
+        pixels = None
+    else:
+        pixels = list(struct.unpack(f"<{width * height}H", img))
+
+    if pixels is None:
+        key = "png" if encoding == BIN_ENC_PNG else "jpeg"
+        image = {"metadata": meta, key: base64.b64encode(img).decode()}
+    else:
+        image = {"metadata": meta, "radiometric": base64.b64encode(img).decode()}
+    if telem_len:
+        image["telemetry"] = base64.b64encode(buf[img_end : img_end + telem_len]).decode()
+    return image, pixels
+
+
+def sparse_decode_image(data, width, height):
+    """
+    sparse_decode_image()
+
+    Decode a sparse image into a list of 16-bit pixel values and its threshold.  Only the pixels in its spans
+    (those at or above the threshold and short gaps between them) were sent, the rest are 0.
+    """
+    threshold, spans = SPARSE_HEADER.unpack_from(data)
+    pixels = [0] * (width * height)
+    pos = SPARSE_HEADER.size
+    for _ in range(spans):
+        start, count = SPARSE_HEADER.unpack_from(data, pos)
+        pos += SPARSE_HEADER.size
+        pixels[start : start + count] = struct.unpack_from(f"<{count}H", data, pos)
+        pos += count * 2
+    return pixels, threshold
+
+
+def image_format_args(format, palette=None, range=None, agc8=False, telem=0, hist=False, threshold=None):
+    """
+    image_format_args()
+
+    Build the set_image_format command arguments.
+    """
+    args = {"format": format}
+    if palette is not None:
+        args["palette"] = palette
+    if range is not None:
+        args["range"] = [int(range[0]), int(range[1])]
+    if agc8:
+        args["agc8"] = 1
+    if telem:
+        args["telem"] = telem
+    if hist:
+        args["hist"] = 1
+    if threshold is not None:
+        args["threshold"] = int(threshold)
+    return args
+
+
+def expand_agc8(img):
+    """
+    expand_agc8()
+
+    Returns the 16-bit pixel data of the 8-bit pixels of an AGC8 json image (metadata "AGC8" is true).
+    """
+    return struct.pack(f"<{len(img)}H", *img)
+
+
+def encode_binary_image(image, encoding=BIN_ENC_RAW, ref=None, timestamp=None, width=160, height=120):
+    """
+    encode_binary_image()
+
+    Convert a json image (or an image returned by decode_binary_image()) into a binary image the same way as the
+    camera.  Metadata items without a TLV are kept in a BIN_TLV_JSON_META TLV so decode_binary_image() returns the
+    same image.  The timestamp (mSec since 1970) is taken from the Date and Time metadata if not specified.  Delta
+    images are encoded against ref, the pixel list of the previous image.  A compressed image is stored raw if it
+    would be larger.  Returns the binary image and its pixel list.  Raises ValueError if the image can't be stored.
+    """
+    img = base64.b64decode(image["radiometric"])
+    if image.get("metadata", {}).get("AGC8"):
+        img = expand_agc8(img)
+    if len(img) != width * height * 2:
+        raise ValueError("image is not the specified size")
+    pixels = list(struct.unpack(f"<{width * height}H", img))
+    telem = base64.b64decode(image["telemetry"]) if "telemetry" in image else b""
+
+    if encoding == BIN_ENC_RICE_DELTA:
+        if ref is None:
+            raise ValueError("delta image without a reference image")
+        data = rice_encode_image(pixels, width, height, ref)
+    elif encoding == BIN_ENC_RICE:
+        data = rice_encode_image(pixels, width, height)
+    else:
+        data = img
+    if len(data) > len(img):
+        data = img
+        encoding = BIN_ENC_RAW
+
+    meta = dict(image.get("metadata", {}))
+    meta.pop("AGC8", None)
+    if timestamp is None:
+        timestamp = json_timestamp(meta)
+    tlvs = []
+    for tlv_type, name in sorted(BIN_TLV_STRINGS.items()):
+        value = meta.get(name)
+        if isinstance(value, str) and len(value.encode()) < 256:
+            tlvs.append((tlv_type, value.encode()))
+            del meta[name]
+    model = meta.get("Model")
+    if type(model) is int and 0 <= model < 256:
+        tlvs.append((BIN_TLV_MODEL, bytes([model])))
+        del meta["Model"]
+    capture_usec = meta.get("Timestamp")
+    if type(capture_usec) is int and 0 <= capture_usec < (1 << 64):
+        tlvs.append((BIN_TLV_CAPTURE_USEC, struct.pack("<Q", capture_usec)))
+        del meta["Timestamp"]
+    if type(meta.get("TimeSync")) is bool:
+        tlvs.append((BIN_TLV_TIME_SYNC, bytes([1 if meta.pop("TimeSync") else 0])))
+    seq = meta.get("Seq")
+    if type(seq) is int and 0 <= seq < (1 << 32):
+        tlvs.append((BIN_TLV_SEQ, struct.pack("<I", seq)))
+        del meta["Seq"]
+    if isinstance(meta.get("Telem"), dict):
+        tlvs.append((BIN_TLV_TELEM_FIELDS, encode_telem_fields(meta.pop("Telem"))))
+    if type(meta.get("AvgFrames")) is int and type(meta.get("AvgFracBits")) is int:
+        tlvs.append((BIN_TLV_AVERAGE, bytes([meta.pop("AvgFrames"), meta.pop("AvgFracBits")])))
+    sync_tick = meta.get("SyncTick")
+    if type(sync_tick) is int and 0 < sync_tick < (1 << 64):
+        tlvs.append((BIN_TLV_SYNC_TICK, struct.pack("<Q", sync_tick)))
+        del meta["SyncTick"]
+    hist = meta.get("Histogram")
+    if isinstance(hist, dict) and len(hist.get("Bins", ())) == BIN_HIST_BINS:
+        values = [hist["P1"], hist["P50"], hist["P99"]] + list(hist["Bins"])
+        tlvs.append((BIN_TLV_HISTOGRAM, struct.pack(f"<{len(values)}H", *values)))
+        del meta["Histogram"]
+    tlvs.append((BIN_TLV_MIN_MAX, struct.pack("<HH", min(pixels), max(pixels))))
+    if encoding != BIN_ENC_RAW:
+        tlvs.append((BIN_TLV_ENCODING, bytes([encoding])))
+    if timestamp is not None:
+        tlvs.append((BIN_TLV_TIMESTAMP, struct.pack("<Q", timestamp)))
+    if meta:
+        tlvs.append((BIN_TLV_JSON_META, json.dumps(meta, separators=(",", ":"), sort_keys=True).encode()))
+    tlvs.sort()
+
+    meta_data = b""
+    for tlv_type, value in tlvs:
+        if len(value) > 255:
+            raise ValueError("metadata too long for a binary image")
+        meta_data += bytes([tlv_type, len(value)]) + value
+
+    payload_len = len(meta_data) + len(data) + len(telem)
+    hdr = BIN_IMAGE_HEADER.pack(
+        BIN_IMAGE_START,
+        BIN_IMAGE_VERSION,
+        BIN_IMAGE_HEADER.size,
+        payload_len,
+        width,
+        height,
+        len(meta_data),
+        len(telem),
+    )
+    return hdr + meta_data + data + telem, pixels
+
+
+def read_json_objects(path):
+    """
+    read_json_objects()
+
+    Generate the undecoded json text (bytes) of each object in a .tjsn image file or .tmjsn movie file (images
+    followed by a video_info object, each terminated by 0x03) without loading the whole file.
+    """
+    with open(path, "rb") as f:
+        buf = b""
+        while True:
+            data = f.read(1 << 20)
+            buf += data
+            objs = buf.split(b"\x03")
+            buf = objs.pop()
+            for obj in objs:
+                if obj.strip():
+                    yield obj
+            if not data:
+                break
+        if buf.strip():
+            yield buf
+
+
+def read_json_file(path):
+    """
+    read_json_file()
+
+    Generate the json objects in a .tjsn image file or .tmjsn movie file without loading the whole file.
+    """
+    for obj in read_json_objects(path):
+        yield json.loads(obj)
+
+
+def convert_json_file(src, dst, encoding=BIN_ENC_RICE, key_interval=0):
+    """
+    convert_json_file()
+
+    Convert a .tjsn or .tmjsn file into a recording file.  The conversion is lossless, write_json_file() makes a
+    copy of the original file.  Returns the number of images.
+    """
+    with TCamRecordingWriter(dst, encoding, key_interval) as writer:
+        for obj in read_json_file(src):
+            if "radiometric" in obj:
+                writer.add_image(obj)
+        return len(writer.frames)
+
+
+def write_json_file(recording, dst):
+    """
+    write_json_file()
+
+    Write the images in a recording (a TCamRecording, file name or recording data) into a .tjsn file (the first
+    image) or a .tmjsn file (all images and the video_info object) as the Desktop application does.
+    """
+    if not isinstance(recording, TCamRecording):
+        recording = TCamRecording(recording)
+    with open(dst, "wb") as f:
+        if str(dst).endswith(".tjsn"):
+            f.write(json.dumps(recording[0], separators=(",", ":"), sort_keys=True).encode())
+            return
+        first = last = {}
+        for image in recording:
+            if not first:
+                first = image["metadata"]
+            last = image["metadata"]
+            f.write(json.dumps(image, separators=(",", ":"), sort_keys=True).encode() + b"\x03")
+        info = {
+            "end_date": last.get("Date"),
+            "end_time": last.get("Time"),
+            "num_frames": len(recording),
+            "start_date": first.get("Date"),
+            "start_time": first.get("Time"),
+            "version": 1,
+        }
+        f.write(json.dumps({"video_info": info}, separators=(",", ":"), sort_keys=True).encode() + b"\x03")
+
+
+def read_recording(buf):
+    """
+    read_recording()
+
+    Generate the images in a recording downloaded from the camera (see TCam.download_recording) in the same
+    form as image responses.  Delta images are decoded against the previous image.  Returns the keyframe index
+    as a list of (image number, offset) pairs in the first value generated, followed by the images.  Use
+    TCamRecording for random access.
+    """
+    recording = TCamRecording(buf)
+    yield recording.keyframes
+    yield from recording
+
+
+def read_event_log(buf):
+    """
+    read_event_log()
+
+    Returns the records in an event log downloaded from the camera (see TCam.download_log) as a list of LogRecords,
+    oldest first.  boot is the number of the boot that logged the record and msec the time since that boot.  The
+    other fields are described for each event in evlog_utilities.h.  The time of day in a boot's time records
+    converts its times.
+    """
+    sectors = []
+    for offset in range(0, len(buf) - LOG_SECTOR_LEN + 1, LOG_SECTOR_LEN):
+        magic, version, rec_len, boot, seq = LOG_SECTOR_HEADER.unpack_from(buf, offset)
+        if magic == LOG_MAGIC and version == LOG_VERSION and rec_len == LOG_RECORD.size:
+            sectors.append((seq, boot, offset))
+    records = []
+    for _, boot, offset in sorted(sectors):
+        for pos in range(offset + LOG_SECTOR_HEADER.size, offset + LOG_SECTOR_LEN, LOG_RECORD.size):
+            event, a, b, msec, v1, v2 = LOG_RECORD.unpack_from(buf, pos)
+            if event not in LOG_EVENTS:
+                # Unused or only partly written when the camera lost power
+                continue
+            if event == 1:
+                boot = v1 & 0xFFFF
+            records.append(LogRecord(boot, msec, LOG_EVENTS[event], a, b, v1, v2))
+    return records
+
+
+class TCamRecording:
+    """
+    TCamRecording - Random access to the images in a recording downloaded from the camera, written by
+    TCamRecordingWriter or converted from a .tjsn/.tmjsn file (see convert_json_file()).
+
+    src is a file name or the recording data.  Files are memory mapped so only the records used are read.  The
+    frame index (or, for a recording without one, a walk of the records) gives the location, timestamp and
+    encoding of every image so getting an image only decodes back to the keyframe before it.  Images read in
+    order decode each record once.
+
+    frames == List of RecordFrame (offset, timestamp, length, encoding), one per image
+    keyframes == The (image number, offset) index in the header block
+    """
+
+    def __init__(self, src):
+        self.file = None
+        if isinstance(src, (str, os.PathLike)):
+            self.file = open(src, "rb")
+            self.buf = mmap.mmap(self.file.fileno(), 0, access=mmap.ACCESS_READ)
+        else:
+            self.buf = src
+        (
+            magic,
+            version,
+            self.encoding,
+            hdr_len,
+            self.key_interval,
+            self.delay_msec,
+            index_offset,
+            index_entries,
+            length,
+            _,
+            index_len,
+        ) = REC_FILE_HEADER.unpack_from(self.buf)
+        if magic != REC_FILE_MAGIC:
+            raise ValueError("not a tCam recording")
+        if version != REC_FILE_VERSION:
+            raise ValueError(f"unsupported tCam recording version {version}")
+
+        self.keyframes = []
+        for i in range(index_entries):
+            num, offset = REC_INDEX_ENTRY.unpack_from(self.buf, index_offset + i * REC_INDEX_ENTRY.size)
+            if num == 0xFFFFFFFF:
+                break
+            self.keyframes.append((num, offset))
+
+        if length != REC_ERASED_LEN and index_len != 0 and self.buf[length] == REC_FRAME_INDEX_START:
+            _, _, findex_hdr_len, entries, entry_len = REC_FRAME_INDEX_HEADER.unpack_from(self.buf, length)
+            pos = length + findex_hdr_len
+            self.frames = [
+                RecordFrame(*REC_FRAME_INDEX_ENTRY.unpack_from(self.buf, pos + i * entry_len)) for i in range(entries)
+            ]
+        else:
+            self.frames = self._walk(hdr_len)
+        self.timestamps = [frame.timestamp for frame in self.frames]
+        self.cached = (-1, None, None)
+
+    def _walk(self, pos):
+        # Build the frame index for a recording that was interrupted or is still being recorded
+        frames = []
+        while pos + BIN_IMAGE_HEADER.size <= len(self.buf) and self.buf[pos] == BIN_IMAGE_START:
+            hdr = BIN_IMAGE_HEADER.unpack_from(self.buf, pos)
+            img_len = hdr[2] + hdr[3]
+            if pos + img_len > len(self.buf):
+                break
+            tlvs = get_binary_image_tlvs(self.buf, pos)
+            encoding = tlvs[BIN_TLV_ENCODING][0] if BIN_TLV_ENCODING in tlvs else BIN_ENC_RAW
+            timestamp = struct.unpack("<Q", tlvs[BIN_TLV_TIMESTAMP])[0] if BIN_TLV_TIMESTAMP in tlvs else 0
+            frames.append(RecordFrame(pos, timestamp, img_len, encoding))
+            pos += img_len
+        return frames
+
+    def __len__(self):
+        return len(self.frames)
+
+    def __getitem__(self, n):
+        return self.get_image(n)[0]
+
+    def __iter__(self):
+        for n in range(len(self.frames)):
+            yield self.get_image(n)[0]
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def close(self):
+        if self.file:
+            self.buf.close()
+            self.file.close()
+            self.file = None
+
+    def get_record(self, n):
+        """
+        get_record()
+
+        Returns image n as it is stored in the recording (a binary image).
+        """
+        frame = self.frames[n]
+        return bytes(self.buf[frame.offset : frame.offset + frame.length])
+
+    def get_image(self, n):
+        """
+        get_image()
+
+        Returns image n in the same form as an image response and its pixel list.  A delta image is decoded
+        starting at the keyframe before it (or the last image returned if that is closer).
+        """
+        if n < 0:
+            n += len(self.frames)
+        if not 0 <= n < len(self.frames):
+            raise IndexError("image number out of range")
+        cached_n, image, pixels = self.cached
+        if cached_n == n:
+            return image, pixels
+
+        start = n
+        while start > 0 and self.frames[start].encoding == BIN_ENC_RICE_DELTA:
+            start -= 1
+        if start <= cached_n < n:
+            start = cached_n + 1
+        else:
+            pixels = None
+        for i in range(start, n + 1):
+            image, pixels = decode_binary_image(self.get_record(i), pixels)
+        self.cached = (n, image, pixels)
+        return image, pixels
+
+    def find_time(self, timestamp):
+        """
+        find_time()
+
+        Returns the number of the last image taken at or before timestamp (mSec since 1970), or 0 if they were all
+        taken after it.
+        """
+        return max(bisect.bisect_right(self.timestamps, timestamp) - 1, 0)
+
+
+class TCamRecordingWriter:
+    """
+    TCamRecordingWriter - Write images into a recording file using the same container as the camera's recorder.
+
+    encoding == BIN_ENC_RAW: raw images, BIN_ENC_RICE: lossless compressed images
+    key_interval == Frames per keyframe for compressed recordings.  The frames in between are recorded as delta
+    images.  Set to 0 to record only keyframes.
+
+    The frame index and header are written by close().  A file that wasn't closed can still be read by TCamRecording.
+    """
+
+    def __init__(self, path, encoding=BIN_ENC_RICE, key_interval=0, delay_msec=0):
+        self.file = open(path, "wb")
+        self.encoding = encoding
+        self.key_interval = key_interval
+        self.delay_msec = delay_msec
+        self.frames = []
+        self.offset = REC_HEADER_LEN
+        self.ref = None
+        self.framesSinceKey = 0
+        self.file.write(self._header(REC_ERASED_LEN, 0xFFFFFFFF, 0xFFFFFFFF, []))
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def _header(self, length, records, index_len, keyframes):
+        hdr = REC_FILE_HEADER.pack(
+            REC_FILE_MAGIC,
+            REC_FILE_VERSION,
+            self.encoding,
+            REC_HEADER_LEN,
+            self.key_interval,
+            self.delay_msec,
+            REC_INDEX_OFFSET,
+            REC_INDEX_ENTRIES,
+            length,
+            records,
+            index_len,
+        )
+        hdr += bytes(REC_INDEX_OFFSET - len(hdr))
+        for num, offset in keyframes:
+            hdr += REC_INDEX_ENTRY.pack(num, offset)
+        return hdr + b"\xff" * (REC_HEADER_LEN - len(hdr))
+
+    def add_image(self, image, timestamp=None):
+        """
+        add_image()
+
+        Add a json image (or an image from TCamRecording or the camera).  The timestamp (mSec since 1970) is taken
+        from the image's Date and Time metadata if not specified.
+        """
+        key = self.key_interval == 0 or self.framesSinceKey + 1 >= self.key_interval or self.ref is None
+        encoding = self.encoding
+        if encoding == BIN_ENC_RICE and not key:
+            encoding = BIN_ENC_RICE_DELTA
+        buf, pixels = encode_binary_image(image, encoding, self.ref, timestamp)
+        self.add_binary_image(buf)
+        if self.encoding == BIN_ENC_RICE and self.key_interval != 0:
+            self.framesSinceKey = 0 if self.frames[-1].encoding != BIN_ENC_RICE_DELTA else self.framesSinceKey + 1
+            self.ref = pixels
+
+    def add_binary_image(self, buf):
+        """
+        add_binary_image()
+
+        Add a binary image as it is.  A delta image must follow the image it was encoded against.
+        """
+        tlvs = get_binary_image_tlvs(buf)
+        encoding = tlvs[BIN_TLV_ENCODING][0] if BIN_TLV_ENCODING in tlvs else BIN_ENC_RAW
+        timestamp = struct.unpack("<Q", tlvs[BIN_TLV_TIMESTAMP])[0] if BIN_TLV_TIMESTAMP in tlvs else 0
+        self.file.write(buf)
+        self.frames.append(RecordFrame(self.offset, timestamp, len(buf), encoding))
+        self.offset += len(buf)
+
+    def close(self):
+        """
+        close()
+
+        Write the frame index and the header block (with keyframes spaced through the recording in its index).
+        """
+        if self.file is None:
+            return
+        records = len(self.frames)
+        findex = REC_FRAME_INDEX_HEADER.pack(
+            REC_FRAME_INDEX_START,
+            REC_FRAME_INDEX_VERSION,
+            REC_FRAME_INDEX_HEADER.size,
+            records,
+            REC_FRAME_INDEX_ENTRY.size,
+        )
+        findex += b"".join(REC_FRAME_INDEX_ENTRY.pack(*frame) for frame in self.frames)
+        self.file.write(findex)
+
+        keys = [(n, frame.offset) for n, frame in enumerate(self.frames) if frame.encoding != BIN_ENC_RICE_DELTA]
+        if len(keys) > REC_INDEX_ENTRIES:
+            keys = [keys[i * len(keys) // REC_INDEX_ENTRIES] for i in range(REC_INDEX_ENTRIES)]
+        self.file.seek(0)
+        self.file.write(self._header(self.offset, records, len(findex), keys))
+        self.file.close()
+        self.file = None
+
+
+class TCamGateway:
+    """
+    TCamGateway - Read the messages cameras send over ESP-NOW (see TCam.set_espnow) from the serial port of an
+    ESP-NOW gateway (the firmware built with CONFIG_TCAM_ESPNOW_GATEWAY).
+
+    stream is anything with a read(n) method returning bytes, for example a pyserial Serial opened at 921600 baud
+    or a file holding a capture of the serial port.  Each camera's packets are put back together into messages.
+    A message is dropped if any of its packets are lost.  Bytes that aren't part of a valid frame (for example
+    the gateway's boot messages) are skipped.
+
+    dropped == The number of incomplete messages
+    """
+
+    def __init__(self, stream):
+        self.stream = stream
+        self.buf = bytearray()
+        self.partial = {}
+        self.dropped = 0
+
+    def __iter__(self):
+        while True:
+            msg = self.read_message()
+            if msg is None:
+                return
+            yield msg
+
+    def read_message(self):
+        """
+        read_message()
+
+        Return the next complete message as (camera MAC address, message type, message) or None when the stream
+        ends (or a read times out).  Stats messages (NOW_MSG_STATS) are the analytics stats dict and images
+        (NOW_MSG_IMAGE) are in the same form as image responses (see decode_binary_image()).
+        """
+        while True:
+            pkt = self._read_packet()
+            if pkt is None:
+                return None
+            msg = self._add_packet(*pkt)
+            if msg is not None:
+                return msg
+
+    def _read_packet(self):
+        # Only read the bytes needed to complete a frame so a serial port doesn't wait for more
+        while True:
+            pos = self.buf.find(GW_FRAME_SYNC)
+            if pos < 0:
+                del self.buf[: max(len(self.buf) - 1, 0)]
+                need = 1
+            else:
+                del self.buf[:pos]
+                need = 3 - len(self.buf)
+                if need <= 0:
+                    flen = self.buf[2] + GW_FRAME_OVERHEAD
+                    need = flen - len(self.buf)
+                    if need <= 0:
+                        frame = bytes(self.buf[:flen])
+                        if (sum(frame[2:-1]) & 0xFF) == frame[-1]:
+                            del self.buf[:flen]
+                            return frame[3:9], frame[9:-1]
+                        del self.buf[:1]
+                        continue
+            data = self.stream.read(need)
+            if not data:
+                return None
+            self.buf += data
+
+    def _add_packet(self, mac, pkt):
+        if len(pkt) < NOW_PKT_HEADER.size:
+            return None
+        start, version, mtype, num, frag, count = NOW_PKT_HEADER.unpack_from(pkt)
+        if start != NOW_PKT_START or version != NOW_PKT_VERSION or frag >= count:
+            return None
+
+        camera = ":".join(f"{b:02X}" for b in mac)
+        msg = self.partial.get(camera)
+        if msg is None or msg[0] != num:
+            if msg is not None:
+                self.dropped += 1
+            msg = self.partial[camera] = (num, {})
+        msg[1][frag] = pkt[NOW_PKT_HEADER.size :]
+        if len(msg[1]) < count:
+            return None
+        del self.partial[camera]
+
+        data = b"".join(msg[1][i] for i in range(count))
+        if mtype == NOW_MSG_STATS:
+            return camera, mtype, json.loads(data.strip(b"\x00\x02\x03").decode())
+        if mtype == NOW_MSG_IMAGE:
+            return camera, mtype, decode_binary_image(data)[0]
+        return camera, mtype, data
+
+
+class TCamSerialRestart(Exception):
+    """
+    Raised by TCamSerialLink.recv_into() when the session was restarted after losing data.
+    """
+
+
+class TCamSerialLink:
+    """
+    TCamSerialLink - A wired connection to a tCam-Mini over its USB serial port (see ser_task.h in the firmware),
+    used by TCamManagerThread in place of a socket.  Needs pyserial.
+
+    Commands and responses are carried in COBS encoded packets with a CRC at up to 3 Mbaud.  A packet with a bad
+    CRC or a sequence number gap means data was lost so the session is restarted on a new connection to the camera
+    and recv_into() raises TCamSerialRestart (the manager starts its parser over and sends the image format and
+    stream commands again).  Opening waits for a session an earlier program left open at another rate to time out.
+
+    errors == The number of times data was lost
+    """
+
+    def __init__(self, port, baud=SER_DEFAULT_BAUD, timeout=1):
+        import serial  # Only needed for wired connections
+
+        self.serial = serial.Serial(port, SER_CONSOLE_BAUD, timeout=timeout)
+        self.baud = baud
+        self.rxBuf = bytearray()
+        self.data = bytearray()
+        self.txSeq = 0
+        self.rxSeq = 0
+        self.lastTx = 0
+        self.errors = 0
+        try:
+            self.open()
+        except Exception:
+            self.serial.close()
+            raise
+
+    def open(self):
+        """
+        open()
+
+        Open or restart the session.  OPEN is tried at the session rate (restarting an open session) and then the
+        console rate until the camera answers (raises TimeoutError after SER_IDLE_SEC plus a few retries).
+        """
+        deadline = time.monotonic() + SER_IDLE_SEC + 4 * SER_OPEN_RETRY_SEC
+        while time.monotonic() < deadline:
+            for rate in (self.baud, SER_CONSOLE_BAUD):
+                self.serial.baudrate = rate
+                self.serial.reset_input_buffer()
+                self.rxBuf.clear()
+                # The leading delimiter ends any partial packet the camera has
+                self.serial.write(b"\x00")
+                self.sendPacket(SER_PKT_OPEN, 0, struct.pack("<I", self.baud))
+                retry = time.monotonic() + SER_OPEN_RETRY_SEC
+                while time.monotonic() < retry:
+                    for pkt in self.readPackets():
+                        if pkt and pkt[0] == SER_PKT_OPENED:
+                            self.serial.baudrate = self.baud
+                            self.rxBuf.clear()
+                            self.data.clear()
+                            self.txSeq = self.rxSeq = 0
+                            return
+        raise TimeoutError("no answer from the camera")
+
+    def close(self):
+        try:
+            self.sendPacket(SER_PKT_CLOSE)
+            self.serial.flush()
+        finally:
+            self.serial.close()
+
+    def send(self, buf):
+        for pos in range(0, len(buf), SER_MAX_PAYLOAD):
+            self.sendPacket(SER_PKT_DATA, self.txSeq, buf[pos : pos + SER_MAX_PAYLOAD])
+            self.txSeq = (self.txSeq + 1) & 0xFF
+        return len(buf)
+
+    def recv_into(self, view):
+        """
+        recv_into()
+
+        Read received data into view like a socket.  Raises socket.timeout if nothing arrives within the timeout.
+        """
+        while not self.data:
+            if time.monotonic() - self.lastTx >= SER_PING_SEC:
+                self.sendPacket(SER_PKT_PING)
+            pkts = self.readPackets()
+            if not pkts:
+                raise socket.timeout()
+            for pkt in pkts:
+                if pkt is None or pkt[0] in (SER_PKT_ERROR, SER_PKT_CLOSE) or (
+                    pkt[0] == SER_PKT_DATA and pkt[1] != self.rxSeq
+                ):
+                    self.errors += 1
+                    self.open()
+                    raise TCamSerialRestart()
+                if pkt[0] == SER_PKT_DATA:
+                    self.rxSeq = (self.rxSeq + 1) & 0xFF
+                    self.data += pkt[2:-2]
+        n = min(len(view), len(self.data))
+        view[:n] = self.data[:n]
+        del self.data[:n]
+        return n
+
+    def sendPacket(self, ptype, seq=0, payload=b""):
+        pkt = bytes((ptype, seq)) + bytes(payload)
+        pkt += struct.pack("<H", binascii.crc_hqx(pkt, 0xFFFF))
+        self.serial.write(cobs_encode(pkt) + b"\x00")
+        self.lastTx = time.monotonic()
+
+    def readPackets(self):
+        """
+        readPackets()
+
+        Read what has arrived (waiting up to the timeout for the first byte) and return the complete packets,
+        None for each that doesn't decode or has a bad CRC.
+        """
+        self.rxBuf += self.serial.read(max(1, self.serial.in_waiting))
+        pkts = []
+        while True:
+            end = self.rxBuf.find(b"\x00")
+            if end < 0:
+                return pkts
+            if end > 0:
+                pkt = cobs_decode(self.rxBuf[:end])
+                if (
+                    pkt is None
+                    or len(pkt) < SER_PKT_OVERHEAD
+                    or binascii.crc_hqx(pkt[:-2], 0xFFFF) != struct.unpack_from("<H", pkt, len(pkt) - 2)[0]
+                ):
+                    pkt = None
+                pkts.append(pkt)
+            del self.rxBuf[: end + 1]
+
+
+class JsonImage(Mapping):
+    """
+    JsonImage - A json image response that is only parsed when it is first used.  It is used as the dict the json
+    text describes.  get_data() decodes the base64 encoded radiometric or telemetry data without parsing the json
+    text (expanding the radiometric data of AGC8 images to 16-bit pixels).
+    """
+
+    def __init__(self, text):
+        self.text = text
+        self.obj = None
+
+    def parse(self):
+        if self.obj is None:
+            self.obj = json.loads(self.text)
+        return self.obj
+
+    def __getitem__(self, key):
+        return self.parse()[key]
+
+    def __iter__(self):
+        return iter(self.parse())
+
+    def __len__(self):
+        return len(self.parse())
+
+    def __repr__(self):
+        return repr(self.parse())
+
+    def get_data(self, name):
+        """
+        get_data()
+
+        Returns the decoded "radiometric" or "telemetry" data.
+        """
+        if self.obj is not None:
+            data = base64.b64decode(self.obj[name])
+            agc8 = self.obj.get("metadata", {}).get("AGC8")
+        else:
+            key = f'"{name}":'.encode()
+            pos = self.text.find(key)
+            if pos == -1:
+                raise KeyError(name)
+            start = self.text.index(b'"', pos + len(key)) + 1
+            end = self.text.index(b'"', start)
+            data = base64.b64decode(memoryview(self.text)[start:end])
+            agc8 = b'"AGC8":' in self.text
+        if name == "radiometric" and agc8:
+            data = expand_agc8(data)
+        return data
+
+
+class TCamResponseParser:
+    """
+    TCamResponseParser - Split the data received from a tCam into responses.
+
+    Data is read or fed into a receive buffer and parse() passes each complete response on in the order it was
+    received: frames to onFrame (json images as JsonImage objects, binary images as json images or, if binaryFrames,
+    as received) and the other responses to onResponse.  The segments of a low latency stream are joined into raw
+    binary images and a frame missing a segment is dropped.  onResync is called when a delta image arrives without
+    its reference image so the caller can send stream_resync.  Used by TCamManagerThread and AsyncTCam.
+    """
+
+    def __init__(self, onFrame, onResponse, onResync, binaryFrames=False):
+        self.onFrame = onFrame
+        self.onResponse = onResponse
+        self.onResync = onResync
+        self.binaryFrames = binaryFrames
+        self.refPixels = None
+        self.rxBuf = bytearray(RX_BUF_LEN)
+        self.rxView = memoryview(self.rxBuf)
+        self.rxStart = 0
+        self.rxEnd = 0
+        self.rxScan = 0
+        self.segFrame = None
+        self.segParts = []
+
+    def reset(self):
+        """
+        reset()
+
+        Discard any partial response and the delta image reference (for a new connection).
+        """
+        self.refPixels = None
+        self.rxStart = self.rxEnd = self.rxScan = 0
+        self.segFrame = None
+        self.segParts = []
+
+    def reserve(self, length=RX_MIN_READ):
+        """
+        reserve()
+
+        Make room for length bytes at the end of the receive buffer.  The unparsed data (part of a response) is
+        moved to the start of the buffer when the free space gets low and the buffer is grown if a response
+        doesn't fit.
+        """
+        if self.rxStart == self.rxEnd:
+            self.rxStart = self.rxEnd = self.rxScan = 0
+        if len(self.rxBuf) - self.rxEnd < length:
+            n = self.rxEnd - self.rxStart
+            if self.rxStart != 0:
+                self.rxBuf[:n] = self.rxView[self.rxStart : self.rxEnd]
+                self.rxScan -= self.rxStart
+                self.rxStart = 0
+                self.rxEnd = n
+            if len(self.rxBuf) - self.rxEnd < length:
+                self.rxView.release()
+                self.rxBuf.extend(bytes(max(len(self.rxBuf), length)))
+                self.rxView = memoryview(self.rxBuf)
+
+    def recv(self, sock):
+        """
+        recv()
+
+        Read from a connected socket into the receive buffer.  Returns the number of bytes read (0 if the
+        connection was closed).
+        """
+        self.reserve()
+        n = sock.recv_into(self.rxView[self.rxEnd :])
+        self.rxEnd += n
+        return n
+
+    def feed(self, data):
+        """
+        feed()
+
+        Copy data received some other way (for example by an asyncio protocol) into the receive buffer.
+        """
+        self.reserve(len(data))
+        self.rxBuf[self.rxEnd : self.rxEnd + len(data)] = data
+        self.rxEnd += len(data)
+
+    def parse(self):
+        """
+        parse()
+
+        Pass on the complete responses in the receive buffer.
+        """
+        self.rxStart, self.rxScan = self.parseResponses(self.rxBuf, self.rxStart, self.rxEnd, self.rxScan)
+
+    def parseBuffer(self, buf):
+        """
+        parseBuffer()
+
+        Pass on the responses in a buffer holding complete responses (a frame reassembled from UDP datagrams).
+        Returns any remainder.
+        """
+        pos, _ = self.parseResponses(buf, 0, len(buf))
+        return buf[pos:]
+
+    def parseResponses(self, buf, pos, end, scan=0):
+        """
+        parseResponses()
+
+        This is how packets are stitched together across reads of the socket.  If you are streaming
+        and you have a high enough frame rate, you may end up with more than one response in your buffer.  You may
+        also have one stretched across reads.  This function extracts the complete responses between pos and end
+        and returns the start of the incomplete response that follows them and where the search for its end should
+        resume (scan) so each byte is only examined once.  Binary responses are framed by their headers.  json
+        image responses are passed on as JsonImage objects so their text is only parsed if it is used.
+        """
+        with memoryview(buf) as view:
+            while pos < end:
+                if buf[pos] == BIN_IMAGE_START:
+                    # Binary image - complete when we have the header and the payload it describes
+                    if end - pos < BIN_IMAGE_HEADER.size:
+                        break
+                    hdr = BIN_IMAGE_HEADER.unpack_from(buf, pos)
+                    img_len = hdr[2] + hdr[3]
+                    if end - pos < img_len:
+                        break
+                    self.handleBinaryImage(bytes(view[pos : pos + img_len]))
+                    pos += img_len
+                elif buf[pos] == SEG_START:
+                    # Stream segment - complete when we have the header and the data it describes
+                    if end - pos < SEG_HEADER.size:
+                        break
+                    _, _, hdr_len, frame, seg, offset, count, img_hdr_len, telem_len = SEG_HEADER.unpack_from(buf, pos)
+                    seg_len = hdr_len + count * 2 + img_hdr_len + telem_len
+                    if end - pos < seg_len:
+                        break
+                    self.handleSegment(frame, seg, offset, view[pos + hdr_len : pos + seg_len], count * 2, img_hdr_len)
+                    pos += seg_len
+                elif buf[pos] == REC_CHUNK_START or buf[pos] == LOG_CHUNK_START:
+                    # Recording or event log data - complete when we have the header and the data it describes
+                    if end - pos < REC_CHUNK_HEADER.size:
+                        break
+                    start, _, hdr_len, offset, data_len = REC_CHUNK_HEADER.unpack_from(buf, pos)
+                    if end - pos < hdr_len + data_len:
+                        break
+                    data = bytes(view[pos + hdr_len : pos + hdr_len + data_len])
+                    key = "record_data" if start == REC_CHUNK_START else "log_data"
+                    self.onResponse({key: {"offset": offset, "data": data}})
+                    pos += hdr_len + data_len
+                elif buf[pos] == PKT_START:
+                    # Raw stream packet batch - complete when we have the header and its packets
+                    if end - pos < PKT_HEADER.size:
+                        break
+                    _, _, hdr_len, pkt_num, lepton, count, pkt_len, read_usec = PKT_HEADER.unpack_from(buf, pos)
+                    if end - pos < hdr_len + count * pkt_len:
+                        break
+                    packets = bytes(view[pos + hdr_len : pos + hdr_len + count * pkt_len])
+                    self.onResponse(
+                        {"packet_batch": {"packet": pkt_num, "lepton": lepton, "read_usec": read_usec, "packets": packets}}
+                    )
+                    pos += hdr_len + count * pkt_len
+                else:
+                    idx = buf.find(3, max(scan, pos), end)
+                    if idx == -1:
+                        scan = end
+                        break
+                    start = pos + 1 if buf[pos] == 2 else pos
+                    self.handleJson(bytes(view[start:idx]))
+                    pos = idx + 1
+        return pos, scan
+
+    def handleBinaryImage(self, buf):
+        try:
+            if self.binaryFrames:
+                # Pass on the image as received, only tracking if a delta image has its reference
+                encoding = get_binary_image_metadata(buf)[1]
+                if encoding == BIN_ENC_RICE_DELTA and self.refPixels is None:
+                    raise ValueError("delta image without a reference image")
+                self.refPixels = True
+                self.onFrame(buf)
+            else:
+                image, pixels = decode_binary_image(buf, self.refPixels)
+                # Sparse images aren't a reference for delta images
+                if "Threshold" not in image["metadata"]:
+                    self.refPixels = pixels
+                self.onFrame(image)
+        except ValueError:
+            # Lost the delta image reference, ask the camera for a keyframe
+            self.onResync()
+
+    def handleSegment(self, frame, seg, offset, data, pixels_len, img_hdr_len):
+        # Segments of a frame arrive in order, each continuing the pixels of the previous one.  The last segment
+        # holds the binary image header and telemetry of the frame.
+        if seg == 1:
+            self.segFrame = frame
+            self.segParts = []
+        if frame != self.segFrame or seg != len(self.segParts) + 1 or offset * 2 != sum(map(len, self.segParts)):
+            self.segFrame = None
+            return
+        self.segParts.append(bytes(data[:pixels_len]))
+        if seg == SEG_COUNT:
+            img = b"".join(self.segParts)
+            self.segFrame = None
+            self.segParts = []
+            if img_hdr_len:
+                hdr = bytes(data[pixels_len : pixels_len + img_hdr_len])
+                self.handleBinaryImage(hdr + img + bytes(data[pixels_len + img_hdr_len :]))
+
+    def handleJson(self, text):
+        # get_status responses also contain "radiometric" (in their Lepton object)
+        if b'"radiometric"' in text and not text.lstrip()[1:].lstrip().startswith(b'"status"'):
+            self.onFrame(JsonImage(text))
+            return
+        try:
+            self.onResponse(json.loads(text))
+        except (JSONDecodeError, UnicodeDecodeError):
+            respObj = {
+                "error": "malformed json payload, json parser threw exception processing it",
+                "payload": text.decode(errors="replace"),
+            }
+            self.onResponse(respObj)
+
+
+class TCamFrameQueue(Queue):
+    """
+    TCamFrameQueue - A bounded frame queue with a policy for when it's full (FRAME_POLICY_xxx).  dropped counts
+    the frames discarded to make room.  The latest policy holds one frame regardless of maxsize.
+    """
+
+    def __init__(self, maxsize=FRAME_QUEUE_LEN, policy=FRAME_POLICY_DROP_OLDEST):
+        if policy not in (FRAME_POLICY_DROP_OLDEST, FRAME_POLICY_LATEST, FRAME_POLICY_BLOCK):
+            raise ValueError(f"unknown frame queue policy {policy}")
+        if policy == FRAME_POLICY_LATEST:
+            maxsize = 1
+        super().__init__(max(maxsize, 1))
+        self.policy = policy
+        self.dropped = 0
+
+    def put(self, item, block=True, timeout=None):
+        """
+        put()
+
+        Add a frame, dropping the oldest frame if the queue is full unless the policy is block.  Raises queue.Full
+        if a blocking put times out.
+        """
+        if self.policy == FRAME_POLICY_BLOCK:
+            super().put(item, block, timeout)
+            return
+        with self.not_full:
+            if self._qsize() >= self.maxsize:
+                self._get()
+                self.dropped += 1
+            self._put(item)
+            self.unfinished_tasks += 1
+            self.not_empty.notify()
+
+
+class TCamFrameGaps:
+    """
+    TCamFrameGaps - Counts the frames missing from a stream of images using the capture sequence number (the "Seq"
+    metadata) the camera adds to each image.  A gap includes frames the camera dropped or skipped because the client
+    wasn't ready for them, frames the camera lost before reading them and images lost on the network.  received
+    counts the images, missing the frames missing between them and gaps the number of places frames were missing.
+    Images without a sequence number (older firmware) are counted but can't show gaps.
+    """
+
+    def __init__(self):
+        self.reset()
+
+    def reset(self):
+        self.last = None
+        self.received = 0
+        self.missing = 0
+        self.gaps = 0
+
+    def update(self, image):
+        """
+        update()
+
+        Account for image (a json image or a binary image) and return the number of frames missing before it.  A
+        sequence number that goes backwards (the camera restarted) starts a new sequence.
+        """
+        if isinstance(image, (bytes, bytearray)):
+            meta, _ = get_binary_image_metadata(image)
+        else:
+            meta = image.get("metadata", {})
+        seq = meta.get("Seq")
+        self.received += 1
+        n = 0
+        if type(seq) is int:
+            if self.last is not None and seq > self.last + 1:
+                n = seq - self.last - 1
+                self.missing += n
+                self.gaps += 1
+            self.last = seq
+        return n
+
+
+class TCamLatency:
+    """
+    TCamLatency - Collects the glass-to-glass latency of a stream started with probe=True.  The camera follows each
+    image with a latency response giving the time from the frame's vsync to the end of its readout (capture), the
+    time spent encoding it and when it was queued to and accepted by the connection.  frame() stamps each image as
+    it is received (and optionally how long the client took to decode it) and latency() adds the camera's record,
+    the two matched by the capture sequence number in whichever order they arrive (a UDP stream's records come
+    over the connection).  The receive times are only comparable to the camera's capture
+    timestamp when its clock is set (the image's "TimeSync" metadata, see set_time()).
+    """
+
+    STAGES = ("capture", "encode", "queue", "send", "network", "decode", "total")
+
+    def __init__(self, depth=64):
+        self.depth = depth
+        self.reset()
+
+    def reset(self):
+        self.frames = {}
+        self.records = {}
+        self.samples = {stage: [] for stage in self.STAGES}
+        self.unsynced = 0
+
+    def frame(self, image, recv_usec=None, decode_usec=0):
+        """
+        frame()
+
+        Note the arrival of image (a json image or a binary image) at recv_usec (uSec since 1970, now by default).
+        """
+        if recv_usec is None:
+            recv_usec = time.time_ns() // 1000
+        if isinstance(image, (bytes, bytearray)):
+            meta, _ = get_binary_image_metadata(image)
+        else:
+            meta = image.get("metadata", {})
+        seq = meta.get("Seq")
+        if type(seq) is not int:
+            return
+        if not meta.get("TimeSync", False):
+            self.unsynced += 1
+        self.frames[seq] = (recv_usec, decode_usec)
+        self._trim(self.frames)
+        return self._match(seq)
+
+    def latency(self, response):
+        """
+        latency()
+
+        Add a camera latency response ({"latency": {...}}) to the image it follows.  Returns the stage times in uSec
+        or None if the image hasn't been seen (yet).
+        """
+        l = response.get("latency", response)
+        seq = l.get("seq")
+        if type(seq) is not int:
+            return None
+        self.records[seq] = l
+        self._trim(self.records)
+        return self._match(seq)
+
+    def _trim(self, d):
+        while len(d) > self.depth:
+            del d[next(iter(d))]
+
+    def _match(self, seq):
+        if seq not in self.frames or seq not in self.records:
+            return None
+        recv_usec, decode_usec = self.frames.pop(seq)
+        l = self.records.pop(seq)
+        send_end = l["send_end_usec"]
+        total = recv_usec - l["timestamp"]
+        stages = {
+            "capture": l["capture_usec"],
+            "encode": l["encode_usec"],
+            "queue": l["send_start_usec"] - l["capture_usec"] - l["encode_usec"],
+            "send": send_end - l["send_start_usec"],
+            "network": total - send_end,
+            "decode": decode_usec,
+            "total": total + decode_usec,
+        }
+        for stage, usec in stages.items():
+            self.samples[stage].append(usec)
+        return stages
+
+    def percentiles(self, points=(0.5, 0.99)):
+        """
+        percentiles()
+
+        Returns {stage: [uSec at each point]} over the images matched so far.
+        """
+        result = {}
+        for stage, samples in self.samples.items():
+            s = sorted(samples)
+            if s:
+                result[stage] = [s[min(len(s) - 1, int(len(s) * p))] for p in points]
+        return result
+
+
 class TCamManagerThread(Thread):
     """
     TCamManagerThread - The background thread that manages the socket communication and the three queues.
 
     Commands come in on the cmdQueue, responses to commands go to the responseQueue, and any frames that
-    come from get_image or set_stream_on commands go into frameQueue.
+    come from get_image or set_stream_on commands go into frameQueue or, while streaming with a callback, are
+    passed to the callback on this thread.
 
     This thread has a run loop that does 3 things:
      - Reads the command queue and sends any commands it finds
@@ -46,13 +1731,23 @@ class TCamManagerThread(Thread):
 
     """
 
-    def __init__(self, cmdQueue, responseQueue, frameQueue, timeout):
+    def __init__(self, cmdQueue, responseQueue, frameQueue, timeout, binaryFrames=False):
         self.cmdQueue = cmdQueue
         self.responseQueue = responseQueue
         self.frameQueue = frameQueue
+        self.frameCallback = None
         self.timeout = timeout
+        self.binaryFrames = binaryFrames
         self.running = False
         self.event = Event()
+        self.parser = TCamResponseParser(
+            onFrame=self.deliverFrame, onResponse=responseQueue.put, onResync=self.resync, binaryFrames=binaryFrames
+        )
+        self.tcamSocket = None
+        self.udpSocket = None
+        self.udpFrame = None
+        self.udpParts = {}
+        self.sessionCmds = {}
         super().__init__()
 
     def start(self):
@@ -68,14 +1763,37 @@ class TCamManagerThread(Thread):
         tmpSock.settimeout(self.timeout)
         return tmpSock
 
+    def createUdpSocket(self, port, addr=None):
+        """
+        createUdpSocket()
+
+        Open the socket streamed images are received on when streaming over UDP, joining the multicast group if
+        addr is a multicast address.
+        """
+        self.closeUdpSocket()
+        tmpSock = socket.socket(family=socket.AF_INET, type=socket.SOCK_DGRAM)
+        tmpSock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        tmpSock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+        tmpSock.bind(("", port))
+        if addr and ipaddress.ip_address(addr).is_multicast:
+            mreq = struct.pack("4s4s", socket.inet_aton(addr), socket.inet_aton("0.0.0.0"))
+            tmpSock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+        self.udpSocket = tmpSock
+        self.udpFrame = None
+        self.udpParts = {}
+
+    def closeUdpSocket(self):
+        if self.udpSocket:
+            self.udpSocket.close()
+            self.udpSocket = None
+
     def run(self):
         """
         run( )
         Check cmdQueue for any new commands to send down, read the socket for any response coming back, split
         data into responses and deserialize them into python objects from JSON.
         """
-        tcamSocket = None
-        scratch = b""
+        self.tcamSocket = None
 
         while self.running:
             # The send part of the cycle
@@ -83,75 +1801,153 @@ class TCamManagerThread(Thread):
                 cmd = self.cmdQueue.get()
                 cmdType = cmd.get("cmd")
                 if cmdType == "connect":
-                    tcamSocket = self.createSocket()
-                    tcamSocket.connect((cmd["ipaddress"], cmd["port"]))
+                    self.tcamSocket = self.createSocket()
+                    self.tcamSocket.connect((cmd["ipaddress"], cmd["port"]))
+                    self.parser.reset()
+                    self.sessionCmds = {}
+                    self.responseQueue.put({"status": "connected"})
+                elif cmdType == "connect_serial":
+                    self.tcamSocket = TCamSerialLink(cmd["port"], cmd["baud"], self.timeout)
+                    self.parser.reset()
+                    self.sessionCmds = {}
                     self.responseQueue.put({"status": "connected"})
                 elif cmdType == "disconnect":
-                    tcamSocket.close()
-                    tcamSocket = None
+                    self.closeUdpSocket()
+                    self.tcamSocket.close()
+                    self.tcamSocket = None
                     self.responseQueue.put({"status": "disconnected"})
                     continue
                 elif cmdType == "raw":
-                    tcamSocket.send(cmd["payload"])
+                    self.tcamSocket.send(cmd["payload"])
                 else:
+                    # RTP streams are for other receivers (video players and management systems)
+                    args = cmd.get("args", {})
+                    if cmdType == "stream_on" and "udp_port" in args and not args.get("rtp"):
+                        self.createUdpSocket(args["udp_port"], args.get("udp_addr"))
                     # format the string with the start and stop chars, and encode as a byte string before sending
                     buf = f"\x02{json.dumps(cmd)}\x03".encode()
-                    tcamSocket.send(buf)
+                    self.tcamSocket.send(buf)
+                    # Sent again on a restarted serial session
+                    if cmdType in ("set_image_format", "stream_on"):
+                        self.sessionCmds[cmdType] = buf
+                    elif cmdType == "stream_off":
+                        self.sessionCmds.pop("stream_on", None)
 
             # The recv part of the cycle
-            if tcamSocket:
-                try:
-                    rbuf = tcamSocket.recv(65536)
-                    scratch += rbuf
-                except socket.timeout as e:
-                    pass
-                scratch = self.findResponses(scratch)
+            if self.tcamSocket:
+                if self.udpSocket:
+                    # Wait on both the connection and the UDP stream
+                    readable, _, _ = select.select([self.tcamSocket, self.udpSocket], [], [], self.timeout)
+                    if self.udpSocket in readable:
+                        self.readDatagrams()
+                    if self.tcamSocket in readable:
+                        self.receive()
+                else:
+                    try:
+                        self.receive()
+                    except socket.timeout as e:
+                        pass
+                    except TCamSerialRestart:
+                        self.restart()
+                self.parser.parse()
             else:
                 # If we're not connected we won't have a socket to timeout on.  Let's use an event to wait on instead.
                 # Why event.wait instead of time.sleep?  Because event.wait can be interrupted unlike time.sleep.
                 self.event.wait(self.timeout)
                 self.event.clear()
 
+    def readDatagrams(self):
+        """
+        readDatagrams()
+
+        Reassemble images streamed over UDP.  A packet from a new frame drops any partially received frame
+        so a lost datagram costs one image instead of stalling the stream.
+        """
+        while True:
+            try:
+                pkt = self.udpSocket.recv(65536, socket.MSG_DONTWAIT)
+            except (BlockingIOError, socket.timeout):
+                return
+            if len(pkt) < UDP_PKT_HEADER.size or pkt[0] != UDP_PKT_START:
+                continue
+            _, _, frame, index, count, offset = UDP_PKT_HEADER.unpack_from(pkt)
+            if frame != self.udpFrame:
+                self.udpFrame = frame
+                self.udpParts = {}
+            self.udpParts[index] = pkt[UDP_PKT_HEADER.size :]
+            if len(self.udpParts) == count:
+                buf = b"".join(self.udpParts[i] for i in range(count))
+                self.udpFrame = None
+                self.udpParts = {}
+                self.findResponses(buf)
+
+    def receive(self):
+        self.parser.recv(self.tcamSocket)
+
     def findResponses(self, buf):
         """
         findResponses()
 
-        This is how the manager thread stitches together packets across reads of the socket.  If you are streaming
-        and you have a high enough frame rate, you may end up with more than one response in your buffer.  You may
-        also have one stretched across reads.  This function attempts to extract complete ones and returns the
-        remainder to be added to by the next read.
+        Extract the responses from a buffer holding complete responses (a frame reassembled from UDP datagrams).
+        Returns any remainder.
         """
+        return self.parser.parseBuffer(buf)
 
-        pkts = []
-        idx = buf.find(3)
-        while idx != -1:
-            pkts.append(buf[: idx + 1])
-            buf = buf[idx + 1 :]
-            idx = buf.find(3)
+    def deliverFrame(self, frame):
+        """
+        deliverFrame()
 
-        for response in pkts:
+        Pass a frame to the stream callback or queue it.  A full queue with the block policy holds up this thread,
+        and so the reads of the connection, until the consumer catches up or the thread is stopped.
+        """
+        callback = self.frameCallback
+        if callback:
             try:
-                respObj = json.loads(response.strip(b"\x02\x03").decode())
-                if "radiometric" in respObj:
-                    self.frameQueue.put(respObj)
-                else:
-                    self.responseQueue.put(respObj)
-            except JSONDecodeError:
-                respObj = {
-                    "error": "malformed json payload, json parser threw exception processing it",
-                    "payload": response.decode(),
-                }
-                self.responseQueue.put(respObj)
-        return buf
+                callback(frame)
+            except Exception:
+                traceback.print_exc()
+            return
+        while self.running:
+            try:
+                self.frameQueue.put(frame, timeout=self.timeout)
+                return
+            except Full:
+                pass
+
+    def restart(self):
+        # The serial session was restarted on a new connection after losing data: start over with the image format
+        # and stream of the old one (responses to other commands in flight are lost)
+        self.parser.reset()
+        for name in ("set_image_format", "stream_on"):
+            if name in self.sessionCmds:
+                self.tcamSocket.send(self.sessionCmds[name])
+
+    def resync(self):
+        # Lost the delta image reference, ask the camera for a keyframe
+        if self.tcamSocket:
+            self.tcamSocket.send(f"\x02{json.dumps({'cmd': 'stream_resync'})}\x03".encode())
 
 
 class TCam:
     """
     TCam - Interface object for managing a tCam device.
+
+    binaryFrames == False: frames are returned as json images (binary images are converted), True: binary images
+    are returned as received (bytes) so they can be decoded without conversion (see tcam_numpy.py)
+    maxFrames == Frames held for a consumer that falls behind
+    framePolicy == What to do when maxFrames are waiting (FRAME_POLICY_DROP_OLDEST, FRAME_POLICY_LATEST or
+    FRAME_POLICY_BLOCK, see TCamFrameQueue).  frames_dropped() counts the frames discarded.
     """
 
-    def __init__(self, timeout=1, responseTimeout=10):
-        self.frameQueue = Queue()
+    def __init__(
+        self,
+        timeout=1,
+        responseTimeout=10,
+        binaryFrames=False,
+        maxFrames=FRAME_QUEUE_LEN,
+        framePolicy=FRAME_POLICY_DROP_OLDEST,
+    ):
+        self.frameQueue = TCamFrameQueue(maxFrames, framePolicy)
         self.cmdQueue = Queue()
         self.responseQueue = Queue()
         self.responseTimeout = responseTimeout
@@ -161,6 +1957,7 @@ class TCam:
             cmdQueue=self.cmdQueue,
             frameQueue=self.frameQueue,
             timeout=self.timeout,
+            binaryFrames=binaryFrames,
         )
         self.managerThread.start()
 
@@ -172,6 +1969,17 @@ class TCam:
         self.cmdQueue.put(cmd)
         return self.responseQueue.get(block=True, timeout=self.responseTimeout)
 
+    def connect_serial(self, port, baud=SER_DEFAULT_BAUD):
+        """
+        connect_serial()
+
+        Connect over a tCam-Mini's USB serial port (for example "/dev/ttyUSB0" or "COM3") instead of WiFi, at up to
+        3 Mbaud (see TCamSerialLink).  The commands are the same but UDP streams aren't received over it.
+        """
+        cmd = {"cmd": "connect_serial", "port": port, "baud": baud}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=self.responseTimeout)
+
     def disconnect(self):
         """
         disconnect()
@@ -194,24 +2002,172 @@ class TCam:
 
     ##########################################################################################
     # Image/sensor array commands
-    def start_stream(self, delay_msec=0, num_frames=0, callback=None):
-        cmd = {
-            "cmd": "stream_on",
-            "args": {"delay_msec": delay_msec, "num_frames": num_frames},
-        }
+    def start_stream(
+        self,
+        delay_msec=0,
+        num_frames=0,
+        callback=None,
+        key_interval=0,
+        udp_port=None,
+        udp_addr=None,
+        roi=None,
+        bin=1,
+        segments=False,
+        raw=False,
+        stats=False,
+        rtp=False,
+        motion=None,
+        adapt=0,
+        probe=False,
+        sync=False,
+        cmd_priority=False,
+    ):
+        """
+        start_stream()
+
+        callback == Optional function called on the manager thread with each frame instead of queueing it until
+        stop_stream().  It must return quickly (frames and responses aren't read while it runs).
+        key_interval == Frames per keyframe when streaming compressed binary images (set_image_format(2)).
+        The frames in between are sent as delta images.  Set to 0 to send only keyframes.
+        udp_port == Stream images as UDP datagrams to this port instead of over the connection.
+        udp_addr == Optional UDP destination address (for example a multicast group).  Defaults to this computer.
+        roi == Optional (r1, c1, r2, c2) region of the frame to send in binary images.
+        bin == Binning factor for binary images (1, 2 or 4).  Each bin x bin block of pixels is averaged.
+        segments == Low latency stream.  Each quarter of a frame is sent as soon as the camera has read it and the
+        frames are reassembled into raw binary images (the image format, delay_msec, key_interval, roi and bin are
+        ignored).
+        raw == Raw stream of the VoSPI packets the camera reads (discard packets left out) instead of images for
+        assembly here, for example by vospi_sim/raw_asm.  Each batch of packets is put in the response queue as a
+        packet_batch response (the image format, delay_msec, key_interval, roi, bin, motion and adapt are ignored).
+        rtp == Send the UDP stream as RTP/JPEG packets of preview images for a video player or video management
+        system listening at udp_port instead of to this computer.  The images aren't received here.
+        stats == Stream the analytics configured with set_analytics() instead of images (1 or True) or along with
+        the images (2).  An ana_stats response with each region's statistics is put in the response queue for each
+        frame along with an ana_event response whenever an alarm becomes active or clears.
+        motion == Optional dict with "threshold" (required), "blocks", "hold_msec" and "heartbeat_msec" items to only
+        send images when the scene changes.  delay_msec sets the rate while it is changing.
+        adapt == Optional image latency target in mSec.  The camera compresses, bins and then slows the stream while
+        the connection can't keep up and restores it when the connection recovers (get_status reports its state).
+        probe == Follow each image with a latency response (put in the response queue) for TCamLatency.
+        sync == Send the frame nearest each multiple of delay_msec since 1970 tagged with the tick in its "SyncTick"
+        metadata so the images of cameras with SNTP synchronized clocks can be matched by tick.
+        cmd_priority == Hold images back while a command response is waiting to be sent so commands are answered
+        promptly during a full rate stream (at the cost of skipped images).
+        """
+        args = {"delay_msec": delay_msec, "num_frames": num_frames, "key_interval": key_interval}
+        if segments:
+            args["segments"] = 1
+        if raw:
+            args["raw"] = 1
+        if stats:
+            args["stats"] = int(stats)
+        if udp_port:
+            args["udp_port"] = udp_port
+            if udp_addr:
+                args["udp_addr"] = udp_addr
+            if rtp:
+                args["rtp"] = 1
+        if roi:
+            args["roi"] = dict(zip(("r1", "c1", "r2", "c2"), roi))
+        if bin != 1:
+            args["bin"] = bin
+        if motion:
+            args["motion"] = motion
+        if adapt:
+            args["adapt"] = adapt
+        if probe:
+            args["probe"] = 1
+        if sync:
+            args["sync"] = 1
+        if cmd_priority:
+            args["cmd_priority"] = 1
+        self.managerThread.frameCallback = callback
+        cmd = {"cmd": "stream_on", "args": args}
+        self.cmdQueue.put(cmd)
+
+    def stream_resync(self):
+        """
+        stream_resync()
+
+        Request a keyframe be sent next while streaming delta images.  This is done automatically when a delta
+        image is received without a reference image.
+        """
+        cmd = {"cmd": "stream_resync"}
         self.cmdQueue.put(cmd)
 
     def stop_stream(self):
         cmd = {"cmd": "stream_off"}
         self.cmdQueue.put(cmd)
+        self.managerThread.frameCallback = None
+
+    def get_image(self, timeout=None, average=1, max_age_msec=0):
+        """
+        get_image()
 
-    def get_image(self, timeout=None):
+        Returns the next image.  average == Optional number of frames (up to 64) the camera averages into the image.
+        Averaged images have "AvgFrames" and "AvgFracBits" metadata: each pixel divided by 2 ** AvgFracBits is the
+        mean raw value.  The default timeout allows for the time taken to capture the frames.
+        max_age_msec == Optionally return the newest frame the camera already has if it is no older than this
+        instead of waiting for the next one (ignored with average).
+        """
         cmd = {"cmd": "get_image"}
+        args = {}
+        if average > 1:
+            args["average"] = average
+        elif max_age_msec > 0:
+            args["max_age_msec"] = max_age_msec
+        if args:
+            cmd["args"] = args
         self.cmdQueue.put(cmd)
         if not timeout:
-            timeout = self.responseTimeout
+            timeout = self.responseTimeout + average / 8
         return self.frameQueue.get(block=True, timeout=timeout)
 
+    def set_image_format(self, format=1, palette=None, range=None, agc8=False, telem=0, hist=False, threshold=None):
+        """
+        set_image_format()
+
+        format == 0: json images (default), 1: binary images, 2: binary images with lossless compression,
+        3: PNG preview images, 4: JPEG preview images (preview images are mapped through a palette on the camera),
+        5: sparse images (streams only send the pixels at or above threshold, with a compressed keyframe every
+        set_stream_on key_interval images)
+        palette == Optional preview image palette name (see palettes).  Defaults to ironblack.
+        range == Optional (lo, hi) preview image temperature range in K * 100.  Defaults to the range of each image.
+        agc8 == True to send json and raw binary images of AGC output frames with 8-bit pixels (half the size).
+        telem == Optional mask of TELEM_xxx fields sent as "Telem" metadata with streamed images instead of the
+        complete telemetry.  Defaults to 0 (complete telemetry).  get_image() always includes the complete telemetry.
+        hist == True to include each image's "Histogram" metadata: its Min and Max, the P1, P50 and P99 percentile
+        values and 64 Bins counting the pixels in equal bins from Min to Max.  P1 - P99 is an auto-range that
+        ignores a few hot or cold pixels.
+        threshold == Raw pixel value sparse images send pixels at or above (required for format 5).
+        Returns the camera's image_format response (or raises queue.Empty if the camera doesn't support it).
+        Images are returned in the same form regardless of format except preview images which have a base64 encoded
+        PNG ("png") or JPEG ("jpeg") file instead of radiometric data.
+        """
+        cmd = {
+            "cmd": "set_image_format",
+            "args": image_format_args(format, palette, range, agc8, telem, hist, threshold),
+        }
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=self.responseTimeout)
+
+    def set_interval_capture(self, interval_msec=0, num_frames=1, settle_msec=3000):
+        """
+        set_interval_capture()
+
+        Capture num_frames every interval_msec mSec (0 for continuous operation), powering the Lepton down between
+        captures for long intervals.  Frames are discarded for settle_msec after the Lepton wakes.  Streams,
+        get_image and recordings only see the captured frames.  Returns the camera's interval_capture response
+        including the estimated Lepton operating time (awake_msec) and average power (lepton_mw) and the time it
+        is woken before each capture (latency_msec).
+        """
+        cmd = {
+            "cmd": "set_interval_capture",
+            "args": {"interval_msec": interval_msec, "num_frames": num_frames, "settle_msec": settle_msec},
+        }
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=self.responseTimeout)
+
     def get_frame(self):
         if not self.frameQueue.empty():
             return self.frameQueue.get()
@@ -221,6 +2177,309 @@ class TCam:
     def frame_count(self):
         return self.frameQueue.qsize()
 
+    def frames_dropped(self):
+        return self.frameQueue.dropped
+
+    ##########################################################################################
+    # On-camera recording
+    def start_recording(self, encoding=1, delay_msec=0, num_frames=0, key_interval=0):
+        """
+        start_recording()
+
+        Record images into the camera's flash until stop_recording(), num_frames have been recorded or the flash
+        is full.  A new recording replaces the previous one.
+
+        encoding == 0: raw images, 1: lossless compressed images
+        key_interval == Frames per keyframe for compressed recordings.  The frames in between are recorded as
+        delta images.  Set to 0 to record only keyframes.
+        """
+        args = {"encoding": encoding, "delay_msec": delay_msec, "num_frames": num_frames, "key_interval": key_interval}
+        cmd = {"cmd": "record_on", "args": args}
+        self.cmdQueue.put(cmd)
+
+    def stop_recording(self):
+        cmd = {"cmd": "record_off"}
+        self.cmdQueue.put(cmd)
+
+    def get_record_info(self, timeout=None):
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "get_record_info"}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)
+
+    def get_record(self, offset, length=REC_CHUNK_LEN, timeout=None):
+        """
+        get_record()
+
+        Returns up to length bytes (at most 4096) of the recording starting at offset.  Returns an empty string
+        at the end of the recording.
+        """
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "get_record", "args": {"offset": offset, "length": length}}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)["record_data"]["data"]
+
+    def download_recording(self, timeout=None):
+        """
+        download_recording()
+
+        Returns the recording written so far.  Use TCamRecording or read_recording() to get the images in it.
+        """
+        length = self.get_record_info(timeout)["record_info"]["length"]
+        buf = b""
+        while len(buf) < length:
+            data = self.get_record(len(buf), min(REC_CHUNK_LEN, length - len(buf)), timeout)
+            if not data:
+                break
+            buf += data
+        return buf
+
+    ##########################################################################################
+    # Event log
+    def get_log_info(self, timeout=None):
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "get_log_info"}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)
+
+    def get_log(self, offset, length=REC_CHUNK_LEN, timeout=None):
+        """
+        get_log()
+
+        Returns up to length bytes (at most 4096) of the event log partition starting at offset.  Returns an empty
+        string at the end of the partition.
+        """
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "get_log", "args": {"offset": offset, "length": length}}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)["log_data"]["data"]
+
+    def download_log(self, timeout=None):
+        """
+        download_log()
+
+        Returns the camera's event log partition (empty if the firmware has no event log).  Use read_event_log() to
+        get the records in it.
+        """
+        size = self.get_log_info(timeout)["log_info"]["size"]
+        buf = b""
+        while len(buf) < size:
+            data = self.get_log(len(buf), min(REC_CHUNK_LEN, size - len(buf)), timeout)
+            if not data:
+                break
+            buf += data
+        return buf
+
+    ##########################################################################################
+    # Pre-event history
+    def set_history(self, seconds=10):
+        """
+        set_history()
+
+        Keep the last seconds (up to 30) of compressed frames in the camera's memory so they can be sent with
+        dump_history().  Set to 0 to stop (the default when the camera starts).
+        """
+        cmd = {"cmd": "set_history", "args": {"seconds": seconds}}
+        self.cmdQueue.put(cmd)
+
+    def dump_history(self, timeout=None):
+        """
+        dump_history()
+
+        Request the frames in the camera's history.  Returns the history response with the number of records that
+        follow.  They arrive, oldest first, as compressed binary images in the frame queue (or the stream callback)
+        and may be told apart from streamed images by their timestamps.
+        """
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "dump_history"}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)
+
+    def dump_history_on_alarm(self, enable=True):
+        """
+        dump_history_on_alarm()
+
+        Have the camera send its history whenever an analytics alarm (set_analytics()) is raised.  Each dump starts
+        with a history response in the response queue.  The frames are analyzed while this is enabled even if
+        stats aren't being streamed.
+        """
+        cmd = {"cmd": "dump_history", "args": {"on_alarm": 1 if enable else 0}}
+        self.cmdQueue.put(cmd)
+
+    def burst_capture(self, num_frames, encoding=1, timeout=None):
+        """
+        burst_capture()
+
+        Capture num_frames consecutive frames (up to 512) into the camera's memory at the full frame rate and then
+        receive them.  encoding == 0: raw images, 1: lossless compressed images.  Returns the burst response, sent
+        once the frames have been captured, with the number of records that follow.  They arrive, oldest first, as
+        binary images in the frame queue (or the stream callback) with their capture sequence numbers.
+        """
+        if not timeout:
+            # Frames arrive at about 8.7 Hz
+            timeout = self.responseTimeout + num_frames / 8
+        cmd = {"cmd": "burst_capture", "args": {"num_frames": num_frames, "encoding": encoding}}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)
+
+    def set_espnow(self, mode=NOW_MODE_STATS, peer=None, interval_msec=1000):
+        """
+        set_espnow()
+
+        Send analytics stats (NOW_MODE_STATS) or compressed images (NOW_MODE_IMAGE) over ESP-NOW every
+        interval_msec (0 for every frame) to the gateway with the MAC address peer ("XX:XX:XX:XX:XX:XX", broadcast
+        if None) or stop (NOW_MODE_OFF).  Read them from the gateway's serial port with TCamGateway.
+        """
+        args = {"mode": mode, "interval_msec": interval_msec}
+        if peer is not None:
+            args["peer"] = peer
+        cmd = {"cmd": "set_espnow", "args": args}
+        self.cmdQueue.put(cmd)
+
+    def set_lepton(self, lepton=0):
+        """
+        set_lepton()
+
+        Select the Lepton (0 or 1) this connection's images and image streams come from on a camera built with
+        two Leptons.
+        """
+        cmd = {"cmd": "set_lepton", "args": {"lepton": lepton}}
+        self.cmdQueue.put(cmd)
+
+    def set_ffc(self, mode=2, drift=150, motion=50, quiet_msec=2000, min_msec=60000, max_wait_msec=600000):
+        """
+        set_ffc()
+
+        Configure the camera's FFC scheduler.  mode == 0: Lepton automatic FFC, 1: manual FFC, 2: smart FFC that
+        runs once the FPA has drifted by drift (0.01 K) or the Lepton wants a FFC, waiting for quiet_msec of still
+        scene (no 8x8 block changing by more than motion) for up to max_wait_msec.  Returns the camera's ffc
+        response.
+        """
+        args = {
+            "mode": mode,
+            "drift": drift,
+            "motion": motion,
+            "quiet_msec": quiet_msec,
+            "min_msec": min_msec,
+            "max_wait_msec": max_wait_msec,
+        }
+        cmd = {"cmd": "set_ffc", "args": args}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=self.responseTimeout)
+
+    def run_ffc(self):
+        """
+        run_ffc()
+
+        Run a FFC now when the camera is in manual or smart FFC mode.
+        """
+        cmd = {"cmd": "run_ffc"}
+        self.cmdQueue.put(cmd)
+
+    def calibrate_spi(self):
+        """
+        calibrate_spi()
+
+        Have the camera find and store the fastest stable SPI clock for its Lepton.  Progress and the result are in
+        get_sys_stats().
+        """
+        cmd = {"cmd": "calibrate_spi"}
+        self.cmdQueue.put(cmd)
+
+    def batch(self, cmds, timeout=None):
+        """
+        batch()
+
+        Executes a list of commands (dicts with "cmd" and optional "args" like {"cmd": "get_status"}) on the camera
+        and returns the batch response combining their responses.  Commands without a response return nothing.
+        """
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "batch", "args": {"cmds": cmds}}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)
+
+    def subscribe_status(self, interval_msec=0, on_change=False, metrics=False):
+        """
+        subscribe_status()
+
+        Has the camera push compact status responses every interval_msec (100 - 3600000, 0 for none) and/or when the
+        status changes (on_change).  The camera sends status immediately.  metrics follows each status response with
+        a metrics response (see tcam_metrics.py).  The responses are put in the response queue like ana_stats
+        responses.  subscribe_status() without arguments ends the subscription.
+        """
+        cmd = {"cmd": "subscribe_status"}
+        if interval_msec or on_change:
+            cmd["args"] = {"interval_msec": interval_msec, "on_change": 1 if on_change else 0}
+            if metrics:
+                cmd["args"]["metrics"] = 1
+        self.cmdQueue.put(cmd)
+
+    def scan_wifi(self, start=False, timeout=None):
+        """
+        scan_wifi()
+
+        Returns the camera's wifi_scan response with the networks its background scan has found.  start begins a
+        new scan (the camera must be in client mode and connected).  Poll until complete is 1.  Streaming continues
+        while the camera scans.
+        """
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "scan_wifi"}
+        if start:
+            cmd["args"] = {"start": 1}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)
+
+    def plan_ap_channel(self):
+        """
+        plan_ap_channel()
+
+        Has the camera (in AP mode) scan for the least congested channel and restart its AP on it.  The connection
+        is lost, reconnect after a few seconds.  get_wifi reports the new channel.
+        """
+        cmd = {"cmd": "scan_wifi", "args": {"plan_ap": 1}}
+        self.cmdQueue.put(cmd)
+
+    def get_ota_info(self, timeout=None):
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "get_ota_info"}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)
+
+    def ota_update(self, path, ipaddress="192.168.4.1", timeout=600):
+        """
+        ota_update()
+
+        Sends the firmware image at path to the camera at ipaddress over its own HTTP connection (POST /ota) and
+        returns the HTTP status once the camera has written and verified it (200 when the update is ready).  The
+        camera keeps running during the update, which takes a few minutes.  Call ota_reboot() to run the update.
+        """
+        with open(path, "rb") as f:
+            image = f.read()
+        conn = http.client.HTTPConnection(ipaddress, 80, timeout=timeout)
+        try:
+            conn.request("POST", "/ota", body=image, headers={"Content-Type": "application/octet-stream"})
+            return conn.getresponse().status
+        finally:
+            conn.close()
+
+    def ota_reboot(self):
+        """
+        ota_reboot()
+
+        Restarts the camera into a firmware update that get_ota_info() reports ready (state 2).  The connection
+        closes when the camera restarts.
+        """
+        cmd = {"cmd": "ota_reboot"}
+        self.cmdQueue.put(cmd)
+
     ##########################################################################################
     # all of the set and get functions
     def get_status(self, timeout=None):
@@ -230,6 +2489,29 @@ class TCam:
         self.cmdQueue.put(cmd)
         return self.responseQueue.get(block=True, timeout=timeout)
 
+    def get_perf_stats(self, timeout=None):
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "get_perf_stats"}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)
+
+    def get_sys_stats(self, enable=None, timeout=None):
+        """
+        get_sys_stats()
+
+        Returns the camera's sys_stats response with the heap usage and, once the task profiler has been enabled,
+        the CPU load, per-task CPU use and stack high water marks over the last second.  enable starts (True) or
+        stops (False) the profiler before the statistics are read.
+        """
+        if not timeout:
+            timeout = self.responseTimeout
+        cmd = {"cmd": "get_sys_stats"}
+        if enable is not None:
+            cmd["args"] = {"enable": 1 if enable else 0}
+        self.cmdQueue.put(cmd)
+        return self.responseQueue.get(block=True, timeout=timeout)
+
     def set_time(
         self,
         hour=None,
@@ -260,7 +2542,13 @@ class TCam:
         self.cmdQueue.put(cmd)
         return self.responseQueue.get(block=True, timeout=self.responseTimeout)
 
-    def set_config(self, agc_enabled=1, emissivity=98, gain_mode=2):
+    def set_config(self, agc_enabled=1, emissivity=98, gain_mode=2, temporal_filter=None):
+        """
+        set_config()
+
+        temporal_filter == Optional temporal noise filter level 0 (off) - 4 (strongest), left unchanged when
+        not specified.
+        """
         cmd = {
             "cmd": "set_config",
             "args": {
@@ -269,6 +2557,26 @@ class TCam:
                 "gain_mode": gain_mode,
             },
         }
+        if temporal_filter is not None:
+            cmd["args"]["temporal_filter"] = temporal_filter
+        self.cmdQueue.put(cmd)
+
+    def set_analytics(self, rois=None, hysteresis=None):
+        """
+        set_analytics()
+
+        rois == Optional list of up to 16 regions, each a dict with the "r1", "c1", "r2" and "c2" coordinates
+        (all four like set_spotmeter(), the entire frame when omitted) or a "points" list of 3 to 8 (row, column)
+        polygon vertices and optional "high" and "low" alarm thresholds in K * 100.  The entire frame is analyzed
+        when rois isn't specified.
+        hysteresis == Distance (K * 100) back inside a threshold before its alarm clears (camera default 50).
+        """
+        args = {}
+        if rois:
+            args["rois"] = rois
+        if hysteresis is not None:
+            args["hysteresis"] = hysteresis
+        cmd = {"cmd": "set_analytics", "args": args}
         self.cmdQueue.put(cmd)
 
     def set_spotmeter(self, c1=79, c2=80, r1=59, r2=60):
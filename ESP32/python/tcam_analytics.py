@@ -0,0 +1,393 @@
+"""
+  tCam analytics
+
+  Vectorized analytics of stacks of radiometric frames (N x height x width arrays from tcam_numpy, TCamJsonFile or
+  TCamArchive) without per-pixel or per-frame Python loops: batched temperature conversion, region of interest
+  statistics, hot spot (connected component) detection and tracking, over-temperature dwell alarms and rolling
+  statistics of the results.  analyze_recording() runs them over a whole recording a chunk of frames at a time.
+
+  Hot spots are labelled with numba when it is installed and otherwise with a numpy label propagation that handles
+  every frame of a stack at once.  Both label each component with the flat index of its first pixel in the stack.
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import numpy as np
+
+try:
+    from .tcam_numpy import TELEMETRY_DTYPE, TLINEAR_RESOLUTION
+except ImportError:
+    from tcam_numpy import TELEMETRY_DTYPE, TLINEAR_RESOLUTION
+
+try:
+    import numba
+except ImportError:
+    numba = None
+
+
+# Region statistics (one record per frame and region)
+ROI_STATS = ("min", "max", "mean", "std")
+
+# Hot spot records: frame in the stack, pixel count, maximum and mean value, centroid and bounding box (inclusive)
+SPOT_DTYPE = np.dtype(
+    [
+        ("frame", "<i8"),
+        ("pixels", "<i4"),
+        ("max", "<f4"),
+        ("mean", "<f4"),
+        ("row", "<f4"),
+        ("col", "<f4"),
+        ("r1", "<i2"),
+        ("c1", "<i2"),
+        ("r2", "<i2"),
+        ("c2", "<i2"),
+    ]
+)
+
+
+def _telemetry_records(telem):
+    """
+    Returns telem (None, a TELEMETRY_DTYPE array or N x 240 telemetry words) as a TELEMETRY_DTYPE array or None.
+    """
+    if telem is None:
+        return None
+    telem = np.asarray(telem)
+    if telem.dtype != TELEMETRY_DTYPE:
+        telem = np.ascontiguousarray(telem, dtype="<u2").reshape(-1, TELEMETRY_DTYPE.itemsize // 2)
+        telem = telem.view(TELEMETRY_DTYPE).reshape(-1)
+    return telem
+
+
+def pixel_resolutions(n, telem=None, has_telem=None):
+    """
+    pixel_resolutions()
+
+    Returns the Kelvin per radiometric pixel count of each of n frames from their telemetry (a TELEMETRY_DTYPE array
+    or N x 240 words, see TCamJsonFile.images()).  Frames without telemetry (has_telem False) use 0.01 K.
+    """
+    res = np.full(n, TLINEAR_RESOLUTION[1], dtype=np.float32)
+    telem = _telemetry_records(telem)
+    if telem is None:
+        return res
+    valid = telem["tlinear_enable"] != 0
+    if has_telem is not None:
+        valid &= np.asarray(has_telem, dtype=bool)
+    lut = np.array(TLINEAR_RESOLUTION, dtype=np.float32)
+    res[valid] = lut[telem["tlinear_resolution"][valid] & 1]
+    return res
+
+
+def stack_kelvin(pixels, telem=None, has_telem=None):
+    """
+    stack_kelvin()
+
+    Returns a float32 array of the temperatures (K) of a stack of radiometric frames (N x height x width), each
+    converted with its own telemetry's resolution.
+    """
+    pixels = np.asarray(pixels)
+    res = pixel_resolutions(len(pixels), telem, has_telem)
+    return np.multiply(pixels, res.reshape((-1,) + (1,) * (pixels.ndim - 1)), dtype=np.float32)
+
+
+def stack_celsius(pixels, telem=None, has_telem=None):
+    """
+    stack_celsius()
+    """
+    return stack_kelvin(pixels, telem, has_telem) - np.float32(273.15)
+
+
+def roi_stats(frames, rois):
+    """
+    roi_stats()
+
+    Returns a dict of N x R float32 arrays ("min", "max", "mean" and "std") of the values of each of R regions
+    (r1, c1, r2, c2 inclusive, like set_spotmeter) in each frame of a stack.  Each region is reduced across the whole
+    stack at once.
+    """
+    frames = np.asarray(frames)
+    n = len(frames)
+    out = {k: np.empty((n, len(rois)), dtype=np.float32) for k in ROI_STATS}
+    for i, (r1, c1, r2, c2) in enumerate(rois):
+        block = frames[:, r1 : r2 + 1, c1 : c2 + 1].reshape(n, -1)
+        out["min"][:, i] = block.min(axis=1)
+        out["max"][:, i] = block.max(axis=1)
+        mean = block.mean(axis=1, dtype=np.float64)
+        out["mean"][:, i] = mean
+        out["std"][:, i] = np.sqrt(np.maximum(np.mean(np.square(block, dtype=np.float64), axis=1) - mean * mean, 0))
+    return out
+
+
+if numba is not None:
+
+    @numba.njit(cache=True)
+    def _find(parent, i):
+        while parent[i] != i:
+            parent[i] = parent[parent[i]]
+            i = parent[i]
+        return i
+
+    @numba.njit(cache=True)
+    def _label_numba(mask, labels):
+        n, h, w = mask.shape
+        flat = mask.ravel()
+        for f in range(n):
+            base = f * h * w
+            for r in range(h):
+                for c in range(w):
+                    i = base + r * w + c
+                    if not flat[i]:
+                        continue
+                    labels[i] = i
+                    # Union with the left and upper neighbours (the root is always the lowest index)
+                    if c > 0 and flat[i - 1]:
+                        a = _find(labels, i - 1)
+                        b = _find(labels, i)
+                        if a < b:
+                            labels[b] = a
+                        elif b < a:
+                            labels[a] = b
+                    if r > 0 and flat[i - w]:
+                        a = _find(labels, i - w)
+                        b = _find(labels, i)
+                        if a < b:
+                            labels[b] = a
+                        elif b < a:
+                            labels[a] = b
+            for i in range(base, base + h * w):
+                if flat[i]:
+                    labels[i] = _find(labels, i)
+
+
+def _label_numpy(mask):
+    """
+    Label the 4-connected components of every frame of a mask stack at once: each pixel takes the lowest label of
+    its neighbours and then of the pixel its label points at until nothing changes.
+    """
+    size = mask.size
+    idx = np.arange(size, dtype=np.int64).reshape(mask.shape)
+    lab = np.where(mask, idx, size)
+    while True:
+        new = lab.copy()
+        np.minimum(new[:, 1:, :], lab[:, :-1, :], out=new[:, 1:, :])
+        np.minimum(new[:, :-1, :], lab[:, 1:, :], out=new[:, :-1, :])
+        np.minimum(new[:, :, 1:], lab[:, :, :-1], out=new[:, :, 1:])
+        np.minimum(new[:, :, :-1], lab[:, :, 1:], out=new[:, :, :-1])
+        new[~mask] = size
+        # Pointer jumping (a label is the index of a pixel in the same component)
+        ext = np.append(new.ravel(), size)
+        new = ext[ext[new]]
+        if np.array_equal(new, lab):
+            return lab
+        lab = new
+
+
+def label_components(mask, backend="auto"):
+    """
+    label_components()
+
+    Returns an int64 array the shape of a stack of boolean masks (N x height x width) with each 4-connected
+    component of each frame labelled with the flat index of its first pixel (pixels outside the mask are
+    undefined).  backend is "numba", "numpy" or "auto" (numba when it is installed).
+    """
+    mask = np.ascontiguousarray(mask, dtype=bool)
+    if mask.ndim == 2:
+        mask = mask[np.newaxis]
+    if backend == "numba" or (backend == "auto" and numba is not None):
+        if numba is None:
+            raise RuntimeError("numba is not installed")
+        labels = np.empty(mask.size, dtype=np.int64)
+        _label_numba(mask, labels)
+        return labels.reshape(mask.shape)
+    return _label_numpy(mask)
+
+
+def hot_spots(frames, threshold, min_pixels=1, backend="auto"):
+    """
+    hot_spots()
+
+    Returns a SPOT_DTYPE array of the connected regions of each frame of a stack at or above threshold (in the units
+    of frames, for example stack_kelvin() output) with at least min_pixels pixels, ordered by frame and then by
+    their first pixel.
+    """
+    frames = np.asarray(frames)
+    if frames.ndim == 2:
+        frames = frames[np.newaxis]
+    mask = frames >= threshold
+    if not mask.any():
+        return np.zeros(0, dtype=SPOT_DTYPE)
+    labels = label_components(mask, backend)
+
+    f, r, c = np.nonzero(mask)
+    vals = frames[mask].astype(np.float64)
+    uniq, inv = np.unique(labels[mask], return_inverse=True)
+    count = np.bincount(inv)
+
+    # Per component reductions over the pixels grouped by component
+    order = np.argsort(inv, kind="stable")
+    starts = np.concatenate(([0], np.cumsum(count)[:-1]))
+
+    spots = np.empty(len(uniq), dtype=SPOT_DTYPE)
+    spots["frame"] = uniq // (frames.shape[1] * frames.shape[2])
+    spots["pixels"] = count
+    spots["max"] = np.maximum.reduceat(vals[order], starts)
+    spots["mean"] = np.bincount(inv, weights=vals) / count
+    spots["row"] = np.bincount(inv, weights=r) / count
+    spots["col"] = np.bincount(inv, weights=c) / count
+    spots["r1"] = np.minimum.reduceat(r[order], starts)
+    spots["c1"] = np.minimum.reduceat(c[order], starts)
+    spots["r2"] = np.maximum.reduceat(r[order], starts)
+    spots["c2"] = np.maximum.reduceat(c[order], starts)
+    return spots[spots["pixels"] >= min_pixels]
+
+
+def track_hot_spots(spots, max_dist=8.0, max_missed=0):
+    """
+    track_hot_spots()
+
+    Returns an int array of the track number of each hot spot (hot_spots() output, ordered by frame).  A spot
+    continues the nearest track seen within max_missed frames whose last centroid is within max_dist pixels (the
+    closest pairs are matched first) and otherwise starts a new track.
+    """
+    tracks = np.empty(len(spots), dtype=np.int64)
+    if len(spots) == 0:
+        return tracks
+    frame = spots["frame"]
+    pos = np.stack((spots["row"], spots["col"]), axis=1).astype(np.float64)
+    bounds = np.flatnonzero(np.diff(frame)) + 1
+    starts = np.concatenate(([0], bounds))
+    ends = np.concatenate((bounds, [len(spots)]))
+
+    next_track = 0
+    act_id = np.zeros(0, dtype=np.int64)
+    act_pos = np.zeros((0, 2))
+    act_frame = np.zeros(0, dtype=np.int64)
+    for s, e in zip(starts, ends):
+        fnum = frame[s]
+        keep = act_frame >= fnum - 1 - max_missed
+        act_id, act_pos, act_frame = act_id[keep], act_pos[keep], act_frame[keep]
+        ids = np.full(e - s, -1, dtype=np.int64)
+        if len(act_id):
+            d = np.linalg.norm(pos[s:e, np.newaxis, :] - act_pos[np.newaxis, :, :], axis=2)
+            for k in np.argsort(d, axis=None):
+                i, j = divmod(int(k), len(act_id))
+                if d[i, j] > max_dist:
+                    break
+                if ids[i] < 0 and act_frame[j] != fnum:
+                    ids[i] = act_id[j]
+                    act_pos[j] = pos[s + i]
+                    act_frame[j] = fnum
+        new = ids < 0
+        ids[new] = np.arange(next_track, next_track + np.count_nonzero(new))
+        next_track += np.count_nonzero(new)
+        act_id = np.concatenate((act_id, ids[new]))
+        act_pos = np.concatenate((act_pos, pos[s:e][new]))
+        act_frame = np.concatenate((act_frame, np.full(np.count_nonzero(new), fnum)))
+        tracks[s:e] = ids
+    return tracks
+
+
+def dwell_alarm(values, timestamps_usec, threshold, dwell_usec, hysteresis=0.0, above=True):
+    """
+    dwell_alarm()
+
+    Returns a boolean array (the shape of values, N or N x R) that is set while the values have been over threshold
+    (under it if above is False) for at least dwell_usec.  A value crossing threshold starts the dwell timer and it
+    only stops once the value is back past threshold by hysteresis.  timestamps_usec holds the N sample times.
+    """
+    v = np.asarray(values, dtype=np.float64)
+    t = np.asarray(timestamps_usec, dtype=np.int64).reshape((-1,) + (1,) * (v.ndim - 1))
+    if above:
+        set_ev, clr_ev = v >= threshold, v < threshold - hysteresis
+    else:
+        set_ev, clr_ev = v <= threshold, v > threshold + hysteresis
+    n = len(v)
+    idx = np.arange(n).reshape(t.shape)
+
+    # The state is the latest event and a dwell starts at the first set after the last clear
+    last_set = np.maximum.accumulate(np.where(set_ev, idx, -1), axis=0)
+    last_clr = np.maximum.accumulate(np.where(clr_ev, idx, -1), axis=0)
+    on = last_set > last_clr
+    next_set = np.flip(np.minimum.accumulate(np.flip(np.where(set_ev, idx, n), axis=0), axis=0), axis=0)
+    next_set = np.concatenate((next_set, np.full((1,) + v.shape[1:], n)), axis=0)
+    start = np.take_along_axis(next_set, last_clr + 1, axis=0)
+    t_ext = np.concatenate((t.reshape(-1), [np.iinfo(np.int64).max]))
+    return on & ((t - t_ext[np.minimum(start, n)]) >= dwell_usec)
+
+
+def alarm_events(alarm):
+    """
+    alarm_events()
+
+    Returns the (start, end) sample indices (end exclusive) of each run of a 1-D boolean alarm array.
+    """
+    a = np.concatenate(([False], np.asarray(alarm, dtype=bool), [False]))
+    edges = np.flatnonzero(a[1:] != a[:-1])
+    return edges.reshape(-1, 2)
+
+
+def rolling_stats(values, window):
+    """
+    rolling_stats()
+
+    Returns a dict of float arrays ("mean", "std", "min" and "max") the shape of values (N or N x R) with each
+    sample's statistics over the trailing window samples (fewer for the first window - 1 samples).
+    """
+    v = np.asarray(values, dtype=np.float64)
+    n = len(v)
+    shape = (-1,) + (1,) * (v.ndim - 1)
+    count = np.minimum(np.arange(1, n + 1), window).reshape(shape)
+    zero = np.zeros((1,) + v.shape[1:])
+    s1 = np.concatenate((zero, np.cumsum(v, axis=0)))
+    s2 = np.concatenate((zero, np.cumsum(v * v, axis=0)))
+    lo = np.maximum(np.arange(1, n + 1) - window, 0)
+    mean = (s1[1:] - s1[lo]) / count
+    var = (s2[1:] - s2[lo]) / count - mean * mean
+
+    pad = np.full((window - 1,) + v.shape[1:], np.nan)
+    win = np.lib.stride_tricks.sliding_window_view(np.concatenate((pad, v)), window, axis=0)
+    return {"mean": mean, "std": np.sqrt(np.maximum(var, 0)), "min": np.nanmin(win, axis=-1), "max": np.nanmax(win, axis=-1)}
+
+
+def analyze_recording(source, rois=(), hot_k=None, min_pixels=4, chunk=1024, backend="auto"):
+    """
+    analyze_recording()
+
+    Run the region statistics (Kelvin) and hot spot detection over every image of a TCamJsonFile (or any source
+    with timestamps, len() and images(start, end, telemetry)) a chunk of images at a time.  Returns a dict with the
+    timestamps, the roi_stats() arrays and, when hot_k is given, the SPOT_DTYPE hot spots at or above hot_k Kelvin
+    (frame is the image number) and their tracks.
+    """
+    n = len(source)
+    stats = {k: np.empty((n, len(rois)), dtype=np.float32) for k in ROI_STATS}
+    spots = []
+    for start in range(0, n, chunk):
+        end = min(start + chunk, n)
+        pixels, telem, has_telem = source.images(start, end, telemetry=True)
+        kelvin = stack_kelvin(pixels, telem, has_telem)
+        if rois:
+            for k, v in roi_stats(kelvin, rois).items():
+                stats[k][start:end] = v
+        if hot_k is not None:
+            s = hot_spots(kelvin, hot_k, min_pixels, backend)
+            s["frame"] += start
+            spots.append(s)
+    result = {"timestamps": np.asarray(source.timestamps)[:n], "roi": stats}
+    if hot_k is not None:
+        result["spots"] = np.concatenate(spots) if spots else np.zeros(0, dtype=SPOT_DTYPE)
+        result["tracks"] = track_hot_spots(result["spots"])
+    return result
@@ -0,0 +1,298 @@
+"""
+  tCam HDF5 archive
+
+  Long-term storage of streamed images as chunked, compressed HDF5 datasets (h5py) instead of .tmjsn files.  The
+  pixels are a time x height x width uint16 dataset with per-image telemetry and an index of timestamps alongside
+  so a time range is read by slicing instead of reading the whole file.  Chunks hold chunkFrames consecutive
+  images and are compressed with the shuffle filter and gzip, which shrinks radiometric images several times more
+  than json and base64.
+
+  TCamArchiveWriter decodes and writes the images in a background thread so the thread receiving from the camera
+  only queues them.  Images are written a chunk at a time (or after flushSec without a full chunk).
+
+  Archive layout:
+    radiometric        N x height x width uint16 pixels
+    telemetry          N x 240 uint16 Lepton telemetry words (zeros for images without telemetry, see has_telemetry)
+    has_telemetry      N uint8
+    timestamp_usec     N int64 camera capture time (usec, the binary image Timestamp or the json Date and Time),
+                       -1 if unknown
+    host_time          N float64 time.time() when the image was added
+    seq                N uint32 capture sequence number (0xFFFFFFFF if the image doesn't have one)
+    attributes         Camera, Model and Version of the first image
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import time
+from queue import Empty, Queue
+from threading import Thread
+
+import numpy as np
+
+try:
+    from .tcam import json_timestamp
+    from .tcam_numpy import TELEMETRY_DTYPE, FrameDecoder
+except ImportError:
+    from tcam import json_timestamp
+    from tcam_numpy import TELEMETRY_DTYPE, FrameDecoder
+
+
+# Images per chunk (about 2.4 MB uncompressed for 64 160x120 images)
+ARCHIVE_CHUNK_FRAMES = 64
+
+# Seconds a partial chunk waits for more images before it is written
+ARCHIVE_FLUSH_SEC = 1.0
+
+# Images waiting for the writer thread before add() blocks
+ARCHIVE_QUEUE_LEN = 1024
+
+# Telemetry words per image
+ARCHIVE_TELEM_WORDS = TELEMETRY_DTYPE.itemsize // 2
+
+ARCHIVE_NO_SEQ = 0xFFFFFFFF
+
+
+def _h5py():
+    try:
+        import h5py
+    except ImportError:
+        raise ImportError("tcam_archive needs h5py (pip install h5py)")
+    return h5py
+
+
+class TCamArchiveWriter:
+    """
+    TCamArchiveWriter - Write the images from a camera (json images from TCam.get_frame() or binary images with
+    binaryFrames) into an HDF5 archive.  Add every image in the order received so delta images are decoded.
+
+    chunkFrames == Images per chunk (also the images written at a time)
+    compression == h5py compression filter ("gzip", "lzf" or None)
+    compressionLevel == gzip level (1 - 9)
+
+    An error in the writer thread is raised by the next add() or close().  Images that can't be decoded (a delta
+    image before its keyframe) are counted in skipped.
+    """
+
+    def __init__(
+        self,
+        path,
+        chunkFrames=ARCHIVE_CHUNK_FRAMES,
+        compression="gzip",
+        compressionLevel=4,
+        flushSec=ARCHIVE_FLUSH_SEC,
+        maxQueued=ARCHIVE_QUEUE_LEN,
+    ):
+        self.file = _h5py().File(path, "w")
+        self.chunkFrames = chunkFrames
+        self.compression = compression
+        self.compressionLevel = compressionLevel if compression == "gzip" else None
+        self.flushSec = flushSec
+        self.queue = Queue(maxQueued)
+        self.decoder = FrameDecoder()
+        self.frames = 0
+        self.skipped = 0
+        self.error = None
+        self.pixels = None
+        self.thread = Thread(target=self._run, name="TCamArchiveWriter", daemon=True)
+        self.thread.start()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def add(self, frame):
+        """
+        add()
+
+        Queue an image to be written (blocks if the writer thread is maxQueued images behind).
+        """
+        if self.error is not None:
+            raise self.error
+        self.queue.put((frame, time.time()))
+
+    def close(self):
+        """
+        close()
+
+        Write the queued images and close the file.
+        """
+        if self.thread is not None:
+            self.queue.put(None)
+            self.thread.join()
+            self.thread = None
+            self.file.close()
+        if self.error is not None:
+            raise self.error
+
+    def _run(self):
+        batch = []
+        done = False
+        while not done:
+            try:
+                item = self.queue.get(timeout=self.flushSec)
+            except Empty:
+                item = False
+            if item is None:
+                done = True
+            elif item is not False and self.error is None:
+                try:
+                    batch.append(self._decode(*item))
+                except ValueError:
+                    self.skipped += 1
+                except Exception as e:
+                    self.error = e
+            if batch and (done or item is False or len(batch) == self.chunkFrames):
+                try:
+                    self._write(batch)
+                except Exception as e:
+                    self.error = e
+                batch = []
+
+    def _decode(self, frame, host_time):
+        pixels, telem, meta = self.decoder.decode(frame)
+        timestamp = meta.get("Timestamp")
+        if timestamp is None:
+            ms = json_timestamp(meta)
+            timestamp = ms * 1000 if ms is not None else -1
+        if self.pixels is None:
+            self._create(pixels.shape, meta)
+        telem_words = None
+        if telem is not None:
+            telem_words = np.frombuffer(telem.tobytes(), dtype="<u2")
+        return pixels, telem_words, timestamp, host_time, meta.get("Seq", ARCHIVE_NO_SEQ)
+
+    def _create(self, shape, meta):
+        height, width = shape
+        f = self.file
+
+        def dataset(name, item_shape, dtype):
+            return f.create_dataset(
+                name,
+                shape=(0,) + item_shape,
+                maxshape=(None,) + item_shape,
+                dtype=dtype,
+                chunks=(self.chunkFrames,) + item_shape,
+                compression=self.compression,
+                compression_opts=self.compressionLevel,
+                shuffle=self.compression is not None,
+            )
+
+        self.pixels = dataset("radiometric", (height, width), "<u2")
+        self.telem = dataset("telemetry", (ARCHIVE_TELEM_WORDS,), "<u2")
+        self.hasTelem = dataset("has_telemetry", (), "u1")
+        self.timestamps = dataset("timestamp_usec", (), "<i8")
+        self.hostTimes = dataset("host_time", (), "<f8")
+        self.seqs = dataset("seq", (), "<u4")
+        for key in ("Camera", "Model", "Version"):
+            if key in meta:
+                f.attrs[key] = meta[key]
+
+    def _write(self, batch):
+        n = len(batch)
+        start = self.frames
+        end = start + n
+        if any(b[0].shape != self.pixels.shape[1:] for b in batch):
+            raise ValueError("image size changed during the archive")
+
+        telem = np.zeros((n, ARCHIVE_TELEM_WORDS), dtype="<u2")
+        has_telem = np.zeros(n, dtype=np.uint8)
+        for i, b in enumerate(batch):
+            if b[1] is not None:
+                telem[i] = b[1]
+                has_telem[i] = 1
+
+        columns = (
+            (self.pixels, np.stack([b[0] for b in batch])),
+            (self.telem, telem),
+            (self.hasTelem, has_telem),
+            (self.timestamps, np.array([b[2] for b in batch], dtype="<i8")),
+            (self.hostTimes, np.array([b[3] for b in batch], dtype="<f8")),
+            (self.seqs, np.array([b[4] for b in batch], dtype="<u4")),
+        )
+        for ds, data in columns:
+            ds.resize(end, axis=0)
+            ds[start:end] = data
+        self.frames = end
+        self.file.flush()
+
+
+class TCamArchive:
+    """
+    TCamArchive - Read an archive written by TCamArchiveWriter.  The timestamp index is read when the archive is
+    opened.  Pixels and telemetry are only read (one chunk at a time) for the images asked for.
+
+    timestamps == Capture time of each image (usec, -1 if unknown)
+    """
+
+    def __init__(self, path):
+        self.file = _h5py().File(path, "r")
+        self.attrs = dict(self.file.attrs)
+        if "radiometric" in self.file:
+            self.pixels = self.file["radiometric"]
+            self.timestamps = self.file["timestamp_usec"][:]
+        else:
+            self.pixels = None
+            self.timestamps = np.zeros(0, dtype="<i8")
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __len__(self):
+        return len(self.timestamps)
+
+    def close(self):
+        self.file.close()
+
+    def image(self, n):
+        """
+        image()
+
+        Returns the pixel array and telemetry record (None if the image has no telemetry) of image n.
+        """
+        telem = None
+        if self.file["has_telemetry"][n]:
+            telem = np.frombuffer(self.file["telemetry"][n].tobytes(), dtype=TELEMETRY_DTYPE)[0]
+        return self.pixels[n], telem
+
+    def time_range(self, start_usec, end_usec):
+        """
+        time_range()
+
+        Returns the (start, end) image numbers captured from start_usec up to end_usec.  Assumes the camera clock
+        didn't go backwards during the archive.
+        """
+        start = int(np.searchsorted(self.timestamps, start_usec, side="left"))
+        end = int(np.searchsorted(self.timestamps, end_usec, side="left"))
+        return start, end
+
+    def slice(self, start_usec, end_usec):
+        """
+        slice()
+
+        Returns the timestamps, pixels (N x height x width) and telemetry words (N x 240) of the images captured
+        from start_usec up to end_usec, reading only the chunks that hold them.
+        """
+        start, end = self.time_range(start_usec, end_usec)
+        if self.pixels is None or start == end:
+            return self.timestamps[start:end], np.zeros((0, 0, 0), dtype="<u2"), np.zeros((0, 0), dtype="<u2")
+        return self.timestamps[start:end], self.pixels[start:end], self.file["telemetry"][start:end]
@@ -0,0 +1,595 @@
+"""
+  tCam asyncio client
+
+  Drive one or many cameras from an asyncio event loop without a thread per camera.  AsyncTCam is the asyncio
+  version of TCam and TCamPool runs commands on, and merges the frames from, a set of cameras.  Responses are
+  split out of the received data by the same TCamResponseParser TCam uses so frames are returned in the same
+  forms (see TCam binaryFrames).  Streaming over UDP is only supported by TCam.
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import asyncio
+import json
+from collections import deque
+
+try:
+    from .tcam import REC_CHUNK_LEN, TCamResponseParser, image_format_args
+except ImportError:
+    from tcam import REC_CHUNK_LEN, TCamResponseParser, image_format_args
+
+
+# The key of the response object to each command that has a response (get_record responses are also matched by
+# their offset and get_image is answered by the next frame)
+RESPONSE_KEYS = {
+    "get_status": "status",
+    "get_config": "config",
+    "get_wifi": "wifi",
+    "get_perf_stats": "perf_stats",
+    "get_sys_stats": "sys_stats",
+    "set_image_format": "image_format",
+    "get_record_info": "record_info",
+    "get_log_info": "log_info",
+    "set_interval_capture": "interval_capture",
+}
+
+# Frames held for a slow consumer before the oldest is dropped
+FRAME_QUEUE_LEN = 32
+
+
+class AsyncTCam(asyncio.Protocol):
+    """
+    AsyncTCam - asyncio interface object for managing a tCam device.
+
+    Commands with a response are coroutines returning the response.  The camera doesn't tag its responses so each
+    is matched to the oldest waiting command expecting that response.  A response arriving after its command
+    timed out is passed to the next command waiting for the same response, or to the response queue if there
+    isn't one, along with any response no command is waiting for.  Commands without a response return immediately.
+
+    Frames go to any get_image() waiting for one and otherwise to frameCallback or the frame queue, which drops
+    its oldest frame (counted in framesDropped) when more than maxFrames are waiting.  Use frames() or stream() to
+    iterate over them.  frameCallback (and the frame queue) is passed None when the connection is closed.
+    Responses no command is waiting for (like pushed status) go to responseCallback instead of the response queue
+    when it is set.
+    """
+
+    def __init__(
+        self,
+        responseTimeout=10,
+        binaryFrames=False,
+        maxFrames=FRAME_QUEUE_LEN,
+        frameCallback=None,
+        responseCallback=None,
+    ):
+        self.responseTimeout = responseTimeout
+        self.frameCallback = frameCallback
+        self.responseCallback = responseCallback
+        self.frameQueue = asyncio.Queue(maxFrames)
+        self.responseQueue = asyncio.Queue()
+        self.framesDropped = 0
+        self.transport = None
+        self.closed = None
+        self.pending = {}
+        self.imageWaiters = deque()
+        self.parser = TCamResponseParser(
+            onFrame=self.handleFrame,
+            onResponse=self.handleResponse,
+            onResync=self.stream_resync,
+            binaryFrames=binaryFrames,
+        )
+
+    async def __aenter__(self):
+        return self
+
+    async def __aexit__(self, *exc):
+        await self.disconnect()
+
+    async def connect(self, ipaddress="192.168.4.1", port=5001):
+        """
+        connect()
+        """
+        loop = asyncio.get_running_loop()
+        await asyncio.wait_for(loop.create_connection(lambda: self, ipaddress, port), self.responseTimeout)
+        return {"status": "connected"}
+
+    async def disconnect(self):
+        """
+        disconnect()
+        """
+        if self.transport:
+            self.transport.close()
+            await self.closed.wait()
+        return {"status": "disconnected"}
+
+    def connected(self):
+        return self.transport is not None
+
+    ##########################################################################################
+    # asyncio.Protocol
+    def connection_made(self, transport):
+        self.transport = transport
+        self.closed = asyncio.Event()
+        self.parser.reset()
+
+    def data_received(self, data):
+        self.parser.feed(data)
+        self.parser.parse()
+
+    def connection_lost(self, exc):
+        self.transport = None
+        err = ConnectionError("connection to the camera closed")
+        for waiters in list(self.pending.values()) + [self.imageWaiters]:
+            for fut in waiters:
+                if not fut.done():
+                    fut.set_exception(err)
+            waiters.clear()
+        self.putFrame(None)
+        self.closed.set()
+
+    ##########################################################################################
+    # Response handling
+    def handleFrame(self, frame):
+        while self.imageWaiters:
+            fut = self.imageWaiters.popleft()
+            if not fut.done():
+                fut.set_result(frame)
+                return
+        self.putFrame(frame)
+
+    def putFrame(self, frame):
+        if self.frameCallback:
+            self.frameCallback(frame)
+            return
+        if self.frameQueue.full():
+            self.frameQueue.get_nowait()
+            self.framesDropped += 1
+        self.frameQueue.put_nowait(frame)
+
+    def handleResponse(self, response):
+        key = next(iter(response), None)
+        if key == "record_data" or key == "log_data":
+            key = (key, response[key]["offset"])
+        waiters = self.pending.get(key)
+        while waiters:
+            fut = waiters.popleft()
+            if not fut.done():
+                fut.set_result(response)
+                return
+        if self.responseCallback:
+            self.responseCallback(response)
+            return
+        self.responseQueue.put_nowait(response)
+
+    def send(self, cmd):
+        """
+        send()
+
+        Send a command without waiting for a response.  Raises ConnectionError if not connected.
+        """
+        if not self.transport:
+            raise ConnectionError("not connected to a camera")
+        self.transport.write(f"\x02{json.dumps(cmd)}\x03".encode())
+
+    async def request(self, cmd, key, timeout=None):
+        """
+        request()
+
+        Send a command and return the response with key.  Raises asyncio.TimeoutError if the response doesn't
+        arrive within timeout seconds (responseTimeout by default).
+        """
+        self.send(cmd)
+        fut = asyncio.get_running_loop().create_future()
+        self.pending.setdefault(key, deque()).append(fut)
+        return await asyncio.wait_for(fut, timeout or self.responseTimeout)
+
+    async def command(self, name, args=None, timeout=None):
+        """
+        command()
+
+        Send any command, returning its response (see RESPONSE_KEYS) or None for commands without one.
+        """
+        cmd = {"cmd": name}
+        if args is not None:
+            cmd["args"] = args
+        if name in RESPONSE_KEYS:
+            return await self.request(cmd, RESPONSE_KEYS[name], timeout)
+        self.send(cmd)
+        return None
+
+    ##########################################################################################
+    # Image/sensor array commands
+    def start_stream(
+        self, delay_msec=0, num_frames=0, key_interval=0, roi=None, bin=1, segments=False, stats=False, cmd_priority=False
+    ):
+        """
+        start_stream()
+
+        See TCam.start_stream().
+        """
+        args = {"delay_msec": delay_msec, "num_frames": num_frames, "key_interval": key_interval}
+        if segments:
+            args["segments"] = 1
+        if cmd_priority:
+            args["cmd_priority"] = 1
+        if stats:
+            args["stats"] = int(stats)
+        if roi:
+            args["roi"] = dict(zip(("r1", "c1", "r2", "c2"), roi))
+        if bin != 1:
+            args["bin"] = bin
+        self.send({"cmd": "stream_on", "args": args})
+
+    def set_analytics(self, rois=None, hysteresis=None):
+        """
+        set_analytics()
+
+        See TCam.set_analytics().  The ana_stats and ana_event responses go to the response queue.
+        """
+        args = {}
+        if rois:
+            args["rois"] = rois
+        if hysteresis is not None:
+            args["hysteresis"] = hysteresis
+        self.send({"cmd": "set_analytics", "args": args})
+
+    def stream_resync(self):
+        """
+        stream_resync()
+
+        Request a keyframe be sent next while streaming delta images.  This is done automatically when a delta
+        image is received without a reference image.
+        """
+        if self.transport:
+            self.send({"cmd": "stream_resync"})
+
+    def stop_stream(self):
+        self.send({"cmd": "stream_off"})
+
+    async def get_image(self, timeout=None, max_age_msec=0):
+        """
+        get_image()
+
+        Returns the next frame received.  max_age_msec == See TCam.get_image().
+        """
+        cmd = {"cmd": "get_image"}
+        if max_age_msec > 0:
+            cmd["args"] = {"max_age_msec": max_age_msec}
+        self.send(cmd)
+        fut = asyncio.get_running_loop().create_future()
+        self.imageWaiters.append(fut)
+        return await asyncio.wait_for(fut, timeout or self.responseTimeout)
+
+    async def set_image_format(self, format=1, palette=None, range=None, timeout=None):
+        """
+        set_image_format()
+
+        See TCam.set_image_format().
+        """
+        return await self.command("set_image_format", image_format_args(format, palette, range), timeout)
+
+    async def set_interval_capture(self, interval_msec=0, num_frames=1, settle_msec=3000, timeout=None):
+        """
+        set_interval_capture()
+
+        See TCam.set_interval_capture().
+        """
+        args = {"interval_msec": interval_msec, "num_frames": num_frames, "settle_msec": settle_msec}
+        return await self.command("set_interval_capture", args, timeout)
+
+    async def frames(self):
+        """
+        frames()
+
+        Iterate over the frames in the frame queue (not used with a frameCallback) until the connection is closed.
+        """
+        while True:
+            frame = await self.frameQueue.get()
+            if frame is None:
+                return
+            yield frame
+
+    async def stream(self, delay_msec=0, num_frames=0, key_interval=0, roi=None, bin=1, segments=False):
+        """
+        stream()
+
+        Start streaming and iterate over the frames, stopping the stream when the iteration ends.  Ends after
+        num_frames frames if non-zero.
+        """
+        self.start_stream(delay_msec, num_frames, key_interval, roi, bin, segments)
+        count = 0
+        try:
+            async for frame in self.frames():
+                yield frame
+                count += 1
+                if count == num_frames:
+                    return
+        finally:
+            if self.transport:
+                self.stop_stream()
+
+    ##########################################################################################
+    # On-camera recording
+    def start_recording(self, encoding=1, delay_msec=0, num_frames=0, key_interval=0):
+        """
+        start_recording()
+
+        See TCam.start_recording().
+        """
+        args = {"encoding": encoding, "delay_msec": delay_msec, "num_frames": num_frames, "key_interval": key_interval}
+        self.send({"cmd": "record_on", "args": args})
+
+    def stop_recording(self):
+        self.send({"cmd": "record_off"})
+
+    async def get_record_info(self, timeout=None):
+        return await self.command("get_record_info", timeout=timeout)
+
+    async def get_record(self, offset, length=REC_CHUNK_LEN, timeout=None):
+        """
+        get_record()
+
+        See TCam.get_record().
+        """
+        cmd = {"cmd": "get_record", "args": {"offset": offset, "length": length}}
+        return (await self.request(cmd, ("record_data", offset), timeout))["record_data"]["data"]
+
+    async def download_recording(self, timeout=None):
+        """
+        download_recording()
+
+        See TCam.download_recording().
+        """
+        length = (await self.get_record_info(timeout))["record_info"]["length"]
+        buf = bytearray()
+        while len(buf) < length:
+            data = await self.get_record(len(buf), min(REC_CHUNK_LEN, length - len(buf)), timeout)
+            if not data:
+                break
+            buf += data
+        return bytes(buf)
+
+    ##########################################################################################
+    # Event log
+    async def get_log_info(self, timeout=None):
+        return await self.command("get_log_info", timeout=timeout)
+
+    async def get_log(self, offset, length=REC_CHUNK_LEN, timeout=None):
+        """
+        get_log()
+
+        See TCam.get_log().
+        """
+        cmd = {"cmd": "get_log", "args": {"offset": offset, "length": length}}
+        return (await self.request(cmd, ("log_data", offset), timeout))["log_data"]["data"]
+
+    async def download_log(self, timeout=None):
+        """
+        download_log()
+
+        See TCam.download_log().
+        """
+        size = (await self.get_log_info(timeout))["log_info"]["size"]
+        buf = bytearray()
+        while len(buf) < size:
+            data = await self.get_log(len(buf), min(REC_CHUNK_LEN, size - len(buf)), timeout)
+            if not data:
+                break
+            buf += data
+        return bytes(buf)
+
+    ##########################################################################################
+    # all of the set and get functions
+    async def get_status(self, timeout=None):
+        return await self.command("get_status", timeout=timeout)
+
+    async def get_perf_stats(self, timeout=None):
+        return await self.command("get_perf_stats", timeout=timeout)
+
+    async def get_sys_stats(self, enable=None, timeout=None):
+        """
+        get_sys_stats()
+
+        See TCam.get_sys_stats().
+        """
+        args = None if enable is None else {"enable": 1 if enable else 0}
+        return await self.command("get_sys_stats", args, timeout)
+
+    async def get_config(self, timeout=None):
+        return await self.command("get_config", timeout=timeout)
+
+    async def get_wifi(self, timeout=None):
+        return await self.command("get_wifi", timeout=timeout)
+
+    def subscribe_status(self, interval_msec=0, on_change=False, metrics=False):
+        """
+        subscribe_status()
+
+        See TCam.subscribe_status().  The status (and metrics) responses go to responseCallback or the response
+        queue.
+        """
+        cmd = {"cmd": "subscribe_status"}
+        if interval_msec or on_change:
+            cmd["args"] = {"interval_msec": interval_msec, "on_change": 1 if on_change else 0}
+            if metrics:
+                cmd["args"]["metrics"] = 1
+        self.send(cmd)
+
+    async def get_response(self):
+        """
+        get_response()
+
+        Returns the next response no command was waiting for.
+        """
+        return await self.responseQueue.get()
+
+    def set_time(self, hour=None, minute=None, second=None, dow=None, day=None, month=None, year=None):
+        args = {"sec": second, "min": minute, "hour": hour, "dow": dow, "day": day, "mon": month, "year": year}
+        self.send({"cmd": "set_time", "args": args})
+
+    def set_config(self, agc_enabled=1, emissivity=98, gain_mode=2):
+        args = {"agc_enabled": agc_enabled, "emissivity": emissivity, "gain_mode": gain_mode}
+        self.send({"cmd": "set_config", "args": args})
+
+    def set_spotmeter(self, c1=79, c2=80, r1=59, r2=60):
+        """
+        set_spotmeter()
+
+        See TCam.set_spotmeter().
+        """
+        self.send({"cmd": "set_spotmeter", "args": {"c1": c1, "c2": c2, "r1": r1, "r2": r2}})
+
+    def set_wifi(
+        self,
+        ap_ssid="ApSSID",
+        ap_pw="ApPassword",
+        ap_ip_addr="192.168.4.1",
+        flags=145,
+        sta_ssid="AHomeNetwork",
+        sta_pw="anotherpassword",
+        sta_ip_addr="192.168.0.2",
+        sta_netmask="255.255.255.0",
+    ):
+        """
+        set_wifi()
+        """
+        args = {
+            "ap_ssid": ap_ssid,
+            "ap_pw": ap_pw,
+            "ap_ip_addr": ap_ip_addr,
+            "flags": flags,
+            "sta_ssid": sta_ssid,
+            "sta_pw": sta_pw,
+            "sta_ip_addr": sta_ip_addr,
+            "sta_netmask": sta_netmask,
+        }
+        self.send({"cmd": "set_wifi", "args": args})
+
+
+class TCamPool:
+    """
+    TCamPool - Manage a set of cameras, by name, from one event loop.
+
+    call() runs an AsyncTCam method on all (or some) of the cameras concurrently and returns a dict of the results
+    by name.  An exception (for example a timeout) is returned as the camera's result instead of being raised so
+    one camera can't fail the others.  Frames from all the cameras are merged into one queue of (name, frame)
+    tuples, which drops its oldest frame when more than maxFrames are waiting.
+    """
+
+    def __init__(self, responseTimeout=10, binaryFrames=False, maxFrames=FRAME_QUEUE_LEN):
+        self.responseTimeout = responseTimeout
+        self.binaryFrames = binaryFrames
+        self.cams = {}
+        self.addresses = {}
+        self.frameQueue = asyncio.Queue(maxFrames)
+        self.framesDropped = 0
+
+    def __getitem__(self, name):
+        return self.cams[name]
+
+    def __iter__(self):
+        return iter(self.cams)
+
+    def __len__(self):
+        return len(self.cams)
+
+    def add(self, name, ipaddress, port=5001):
+        """
+        add()
+
+        Add a camera (connected by connect()).  Returns its AsyncTCam.
+        """
+        cam = AsyncTCam(
+            responseTimeout=self.responseTimeout,
+            binaryFrames=self.binaryFrames,
+            frameCallback=lambda frame: self.putFrame(name, frame),
+        )
+        self.cams[name] = cam
+        self.addresses[name] = (ipaddress, port)
+        return cam
+
+    def putFrame(self, name, frame):
+        if self.frameQueue.full():
+            self.frameQueue.get_nowait()
+            self.framesDropped += 1
+        self.frameQueue.put_nowait((name, frame))
+
+    async def call(self, method, *args, names=None, **kwargs):
+        """
+        call()
+
+        Call an AsyncTCam method with the same arguments on each camera.
+        """
+        if names is None:
+            names = list(self.cams)
+
+        async def run(cam):
+            result = getattr(cam, method)(*args, **kwargs)
+            if asyncio.iscoroutine(result):
+                result = await result
+            return result
+
+        results = await asyncio.gather(*(run(self.cams[name]) for name in names), return_exceptions=True)
+        return dict(zip(names, results))
+
+    async def connect(self, names=None):
+        """
+        connect()
+
+        Connect to the cameras that aren't connected.
+        """
+        if names is None:
+            names = [name for name, cam in self.cams.items() if not cam.connected()]
+        results = await asyncio.gather(
+            *(self.cams[name].connect(*self.addresses[name]) for name in names), return_exceptions=True
+        )
+        return dict(zip(names, results))
+
+    async def disconnect(self):
+        return await self.call("disconnect")
+
+    def connected(self):
+        return [name for name, cam in self.cams.items() if cam.connected()]
+
+    async def frames(self):
+        """
+        frames()
+
+        Iterate over the (name, frame) tuples from all the cameras until none are connected.
+        """
+        while True:
+            name, frame = await self.frameQueue.get()
+            if frame is None:
+                if not self.connected():
+                    return
+                continue
+            yield name, frame
+
+    async def stream(self, delay_msec=0, num_frames=0, key_interval=0, roi=None, bin=1, segments=False):
+        """
+        stream()
+
+        Start streaming on the connected cameras and iterate over the (name, frame) tuples, stopping the streams
+        when the iteration ends.
+        """
+        names = self.connected()
+        await self.call("start_stream", delay_msec, num_frames, key_interval, roi, bin, segments, names=names)
+        try:
+            async for item in self.frames():
+                yield item
+        finally:
+            await self.call("stop_stream", names=self.connected())
@@ -0,0 +1,585 @@
+"""
+  tCam camera emulator
+
+  Serves the tCam-Mini command interface (delimited json commands on port 5001) from replayed .tjsn/.tmjsn
+  images, recordings or synthetic frames so clients and ingest pipelines can be tested and benchmarked without
+  cameras.  One process emulates any number of cameras, each on its own port (or loopback address), from a single
+  asyncio event loop.
+
+  Each camera has a frame clock running at fps with an optional random jitter.  A frame's metadata Timestamp (and
+  the binary capture time TLV) is the time of its frame clock tick, taken from the host's clock with TimeSync true,
+  so a client on the same host gets the ground truth latency of every image by subtracting it from the time the
+  image arrived.  Seq increases by one per tick so gaps count skipped images.
+
+  Implemented: get_status, get_image, set_time, get_config, stream_on (delay_msec, num_frames, key_interval,
+  cmd_priority), stream_off, stream_resync, set_image_format (formats 0 - 2), get_perf_stats (the emulator's counters)
+  and subscribe_status (interval_msec and metrics, with the emulator's counters in the metrics).  Like the camera, a
+  connection that can't keep up skips images and other commands are ignored.
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import asyncio
+import base64
+import json
+import math
+import random
+import struct
+import time
+
+try:
+    from .tcam import (
+        BIN_ENC_RAW,
+        BIN_ENC_RICE,
+        BIN_ENC_RICE_DELTA,
+        BIN_IMAGE_HEADER,
+        BIN_IMAGE_START,
+        BIN_IMAGE_VERSION,
+        BIN_TLV_CAPTURE_USEC,
+        BIN_TLV_ENCODING,
+        BIN_TLV_MIN_MAX,
+        BIN_TLV_MODEL,
+        BIN_TLV_SEQ,
+        BIN_TLV_TIME_SYNC,
+        BIN_TLV_TIMESTAMP,
+        TCamRecording,
+        expand_agc8,
+        read_json_file,
+        rice_encode_image,
+    )
+except ImportError:
+    from tcam import (
+        BIN_ENC_RAW,
+        BIN_ENC_RICE,
+        BIN_ENC_RICE_DELTA,
+        BIN_IMAGE_HEADER,
+        BIN_IMAGE_START,
+        BIN_IMAGE_VERSION,
+        BIN_TLV_CAPTURE_USEC,
+        BIN_TLV_ENCODING,
+        BIN_TLV_MIN_MAX,
+        BIN_TLV_MODEL,
+        BIN_TLV_SEQ,
+        BIN_TLV_TIME_SYNC,
+        BIN_TLV_TIMESTAMP,
+        TCamRecording,
+        expand_agc8,
+        read_json_file,
+        rice_encode_image,
+    )
+
+
+CMD_PORT = 5001
+
+# Firmware version reported by the emulated cameras
+TCAM_VERSION = "3.0"
+
+# Lepton frame rate
+DEFAULT_FPS = 8.7
+
+# Bytes a connection may have waiting to be sent before it skips images (about two raw binary images)
+SEND_BUF_LIMIT = 81920
+
+# Commands longer than this are discarded (the camera's limit)
+CMD_MAX_LEN = 256
+
+# set_stream_on delay_msec values up to this send every frame
+MIN_DELAY_MSEC = 250
+
+# subscribe_status interval_msec range
+STATUS_MIN_MSEC = 100
+STATUS_MAX_MSEC = 3600000
+
+# Metrics response stages and counters (the camera's PERF_STAGE and PERF_CNT order)
+METRICS_STAGES = 11
+METRICS_COUNTERS = 19
+METRICS_CNT_FRAMES = 1
+METRICS_CNT_FRAMES_SKIPPED = 4
+METRICS_CNT_IMAGES_ENCODED = 15
+METRICS_CNT_IMAGES_SENT = 16
+
+# Synthetic frames: a warm spot circling over a gradient, radiometric 0.01 K (about 20 - 40 C)
+SYNTH_FRAMES = 87
+SYNTH_BASE = 29315
+SYNTH_SPAN = 2000
+
+# Telemetry word holding the frame counter (see TELEMETRY_FIELDS in tcam_numpy.py)
+TELEM_FRAME_COUNTER_WORD = 20
+
+FRAME_WIDTH = 160
+FRAME_HEIGHT = 120
+
+
+class EmulatorFrame:
+    """
+    A source frame: 16-bit little-endian pixels and 480 bytes of telemetry, base64 encoded once for json images.
+    Compressed images are encoded as they are first used and kept for every camera replaying the frame.
+    """
+
+    __slots__ = ("pixels", "telemetry", "b64_pixels", "b64_telemetry", "min_max", "compressed")
+
+    def __init__(self, pixels, telemetry):
+        self.pixels = pixels
+        self.telemetry = telemetry
+        self.b64_pixels = base64.b64encode(pixels).decode()
+        self.b64_telemetry = base64.b64encode(telemetry).decode()
+        values = struct.unpack(f"<{len(pixels) // 2}H", pixels)
+        self.min_max = struct.pack("<HH", min(values), max(values))
+        # Compressed image data by reference frame (None for keyframes)
+        self.compressed = {}
+
+    def values(self):
+        return list(struct.unpack(f"<{len(self.pixels) // 2}H", self.pixels))
+
+    def compress(self, ref=None):
+        """
+        Returns the encoding and data of the compressed image (a delta image against the EmulatorFrame ref).
+        Stored raw, like the camera, if compression doesn't make it smaller.
+        """
+        key = id(ref) if ref is not None else None
+        if key not in self.compressed:
+            data = rice_encode_image(self.values(), FRAME_WIDTH, FRAME_HEIGHT, ref.values() if ref else None)
+            if len(data) > len(self.pixels):
+                self.compressed[key] = (BIN_ENC_RAW, self.pixels)
+            else:
+                self.compressed[key] = (BIN_ENC_RICE_DELTA if ref is not None else BIN_ENC_RICE, data)
+        return self.compressed[key]
+
+
+def load_frames(src):
+    """
+    load_frames()
+
+    Returns the images of a .tjsn or .tmjsn file or a recording as a list of EmulatorFrame.
+    """
+    if str(src).endswith((".tjsn", ".tmjsn")):
+        images = read_json_file(src)
+    else:
+        with TCamRecording(src) as recording:
+            images = list(recording)
+    frames = []
+    for image in images:
+        if "radiometric" not in image:
+            continue
+        pixels = base64.b64decode(image["radiometric"])
+        if image.get("metadata", {}).get("AGC8"):
+            pixels = expand_agc8(pixels)
+        telem = base64.b64decode(image["telemetry"]) if "telemetry" in image else bytes(480)
+        frames.append(EmulatorFrame(pixels, telem))
+    if not frames:
+        raise ValueError(f"no images in {src}")
+    return frames
+
+
+def synthetic_frames(num_frames=SYNTH_FRAMES, width=FRAME_WIDTH, height=FRAME_HEIGHT):
+    """
+    synthetic_frames()
+
+    Returns num_frames EmulatorFrame of a warm spot circling once over a vertical gradient.
+    """
+    frames = []
+    gradient = [SYNTH_BASE + (SYNTH_SPAN // 4) * y // height for y in range(height)]
+    for n in range(num_frames):
+        a = 2 * math.pi * n / num_frames
+        cx = width / 2 + width / 4 * math.cos(a)
+        cy = height / 2 + height / 4 * math.sin(a)
+        pixels = []
+        for y in range(height):
+            dy2 = (y - cy) ** 2
+            for x in range(width):
+                d2 = (x - cx) ** 2 + dy2
+                pixels.append(gradient[y] + (SYNTH_SPAN * 3 // 4 if d2 < 100 else int(SYNTH_SPAN * 75 / (d2 + 4))))
+        telem = bytearray(480)
+        struct.pack_into("<I", telem, TELEM_FRAME_COUNTER_WORD * 2, n)
+        frames.append(EmulatorFrame(struct.pack(f"<{width * height}H", *pixels), bytes(telem)))
+    return frames
+
+
+def prepare_compressed(frames):
+    """
+    prepare_compressed()
+
+    Encode the compressed keyframe and the delta image against the previous frame of each frame up front so
+    compressed streams don't encode them (slowly, in python) while the first replay is timed.
+    """
+    for n, frame in enumerate(frames):
+        frame.compress()
+        frame.compress(frames[n - 1])
+
+
+def _time_strings(usec):
+    t = time.localtime(usec // 1000000)
+    ms = (usec // 1000) % 1000
+    return f"{t.tm_hour:02d}:{t.tm_min:02d}:{t.tm_sec:02d}.{ms:03d}", f"{t.tm_mon}/{t.tm_mday}/{t.tm_year % 100:02d}"
+
+
+class _Connection:
+    """
+    The state of one client connection (each has its own image format and stream, as on the camera)
+    """
+
+    def __init__(self, camera, reader, writer):
+        self.camera = camera
+        self.reader = reader
+        self.writer = writer
+        self.format = 0
+        self.streaming = False
+        self.want_image = False
+        self.delay_usec = 0
+        self.next_usec = 0
+        self.frames_left = 0
+        self.key_interval = 0
+        self.since_key = 0
+        self.cmd_priority = False
+        self.rsp_sending = False
+        self.ref = None
+        self.sent = 0
+        self.skipped = 0
+        self.status_usec = 0
+        self.status_metrics = False
+        self.status_next_usec = 0
+
+    async def run(self):
+        buf = bytearray()
+        try:
+            while True:
+                data = await self.reader.read(4096)
+                if not data:
+                    break
+                buf += data
+                while True:
+                    end = buf.find(3)
+                    if end == -1:
+                        if len(buf) > CMD_MAX_LEN:
+                            buf.clear()
+                        break
+                    start = buf.rfind(2, 0, end)
+                    text = bytes(buf[start + 1 : end]) if start != -1 else b""
+                    del buf[: end + 1]
+                    try:
+                        cmd = json.loads(text) if 0 < len(text) <= CMD_MAX_LEN else None
+                    except ValueError:
+                        cmd = None
+                    if isinstance(cmd, dict):
+                        self.command(cmd.get("cmd"), cmd.get("args") or {})
+        except ConnectionError:
+            pass
+        finally:
+            self.camera.connections.discard(self)
+            self.writer.close()
+
+    def send_json(self, obj):
+        self.rsp_sending = True
+        self.writer.write(b"\x02" + json.dumps(obj, separators=(",", ":")).encode() + b"\x03")
+
+    def command(self, name, args):
+        cam = self.camera
+        if name == "get_status":
+            self.send_json({"status": cam.status()})
+        elif name == "get_image":
+            self.want_image = True
+        elif name == "get_config":
+            self.send_json({"config": cam.config})
+        elif name == "set_config":
+            cam.config.update({k: v for k, v in args.items() if k in cam.config})
+        elif name == "stream_on":
+            delay = int(args.get("delay_msec", 0))
+            self.delay_usec = delay * 1000 if delay > MIN_DELAY_MSEC else 0
+            self.next_usec = 0
+            self.frames_left = int(args.get("num_frames", 0))
+            self.key_interval = int(args.get("key_interval", 0))
+            self.cmd_priority = bool(args.get("cmd_priority", 0))
+            self.ref = None
+            self.streaming = True
+        elif name == "stream_off":
+            self.streaming = False
+        elif name == "stream_resync":
+            self.ref = None
+        elif name == "set_image_format":
+            fmt = args.get("format")
+            if fmt in (0, 1, 2):
+                self.format = fmt
+                self.ref = None
+                self.send_json({"image_format": {"format": fmt, "agc8": 0, "telem": 0}})
+        elif name == "get_perf_stats":
+            self.send_json({"perf_stats": cam.perf_stats(self)})
+        elif name == "subscribe_status":
+            interval = int(args.get("interval_msec", 0))
+            if interval and not STATUS_MIN_MSEC <= interval <= STATUS_MAX_MSEC:
+                return
+            # The emulated status doesn't change so on_change only sends the first status packet
+            self.status_usec = interval * 1000
+            self.status_metrics = bool(args.get("metrics", 0))
+            self.push_status(time.time_ns() // 1000)
+
+    def push_status(self, usec):
+        """
+        Send the compact status (and metrics) of a status subscription
+        """
+        status = self.camera.status()
+        for key in ("Camera", "Model", "Version", "Date"):
+            del status[key]
+        self.send_json({"status": status})
+        if self.status_metrics:
+            self.send_json({"metrics": self.camera.metrics(self)})
+        self.status_next_usec = usec + self.status_usec
+
+    def service_status(self, usec):
+        if self.status_usec and usec >= self.status_next_usec:
+            self.push_status(usec)
+
+    def offer(self, n, seq, usec):
+        """
+        Send frame n (captured at usec) if the stream or a get_image wants it
+        """
+        single = self.want_image
+        if not single:
+            if not self.streaming or usec < self.next_usec:
+                return
+        buffered = self.writer.transport.get_write_buffer_size()
+        if buffered == 0:
+            self.rsp_sending = False
+        if buffered > SEND_BUF_LIMIT or (not single and self.cmd_priority and self.rsp_sending):
+            # Can't keep up (or a command response is still being sent): skip it (a delta stream needs a new
+            # keyframe)
+            self.skipped += 1
+            self.ref = None
+            return
+
+        if single:
+            self.want_image = False
+            self.writer.write(self.camera.encode(n, seq, usec, self.format, None))
+        else:
+            ref = None
+            if self.format == 2 and self.key_interval and self.ref is not None and self.since_key < self.key_interval:
+                ref = self.ref
+            self.since_key = self.since_key + 1 if ref is not None else 1
+            self.ref = n
+            self.writer.write(self.camera.encode(n, seq, usec, self.format, ref))
+            if self.delay_usec:
+                if self.next_usec and self.next_usec + self.delay_usec > usec:
+                    self.next_usec += self.delay_usec
+                else:
+                    self.next_usec = usec + self.delay_usec
+            if self.frames_left:
+                self.frames_left -= 1
+                if self.frames_left == 0:
+                    self.streaming = False
+        self.sent += 1
+
+
+class EmulatedCamera:
+    """
+    EmulatedCamera - one emulated tCam-Mini.
+
+    frames == list of EmulatorFrame replayed in a loop (see load_frames() and synthetic_frames())
+    fps, jitter_msec == frame clock rate and the maximum random offset of each tick
+    seed == jitter random seed, for repeatable runs
+    """
+
+    def __init__(self, frames, name="tCam-Mini-EMU0", fps=DEFAULT_FPS, jitter_msec=0, seed=None):
+        self.frames = frames
+        self.name = name
+        self.fps = fps
+        self.jitter_msec = jitter_msec
+        self.random = random.Random(seed)
+        self.connections = set()
+        self.config = {"agc_enabled": 0, "emissivity": 98, "gain_mode": 0}
+        self.seq = 0
+        self.start_usec = time.time_ns() // 1000
+        self.last_usec = 0
+        self.ticks = 0
+        self.late_ticks = 0
+        self.server = None
+        self.clock = None
+
+    async def start(self, host="0.0.0.0", port=CMD_PORT):
+        """
+        start()
+
+        Start listening for connections and the frame clock.
+        """
+        self.server = await asyncio.start_server(self._connected, host, port)
+        self.clock = asyncio.ensure_future(self._run_clock())
+
+    async def stop(self):
+        """
+        stop()
+
+        Stop the frame clock and close the server and its connections.
+        """
+        self.clock.cancel()
+        self.server.close()
+        for c in list(self.connections):
+            c.writer.close()
+        await self.server.wait_closed()
+
+    async def _connected(self, reader, writer):
+        c = _Connection(self, reader, writer)
+        self.connections.add(c)
+        await c.run()
+
+    async def _run_clock(self):
+        loop = asyncio.get_running_loop()
+        period = 1.0 / self.fps
+        start = loop.time()
+        n = 0
+        while True:
+            n += 1
+            offset = self.random.uniform(-self.jitter_msec, self.jitter_msec) / 1000 if self.jitter_msec else 0
+            delay = start + n * period + offset - loop.time()
+            if delay > 0:
+                await asyncio.sleep(delay)
+            elif delay < -period:
+                self.late_ticks += 1
+            self.tick()
+
+    def tick(self):
+        """
+        tick()
+
+        Capture the next frame and offer it to each connection.
+        """
+        usec = time.time_ns() // 1000
+        self.last_usec = usec
+        self.seq += 1
+        self.ticks += 1
+        n = (self.seq - 1) % len(self.frames)
+        for c in list(self.connections):
+            c.service_status(usec)
+            c.offer(n, self.seq, usec)
+
+    def metadata(self, seq, usec):
+        t, d = _time_strings(usec)
+        return {
+            "Camera": self.name,
+            "Model": 2,
+            "Version": TCAM_VERSION,
+            "Time": t,
+            "Date": d,
+            "Timestamp": usec,
+            "TimeSync": True,
+            "Seq": seq,
+        }
+
+    def status(self):
+        usec = time.time_ns() // 1000
+        t, d = _time_strings(usec)
+        return {
+            "Camera": self.name,
+            "Model": 2,
+            "Version": TCAM_VERSION,
+            "Time": t,
+            "Date": d,
+            "Lepton": {
+                "frame": self.seq,
+                "age_msec": (usec - self.last_usec) // 1000 if self.last_usec else 0,
+                "fpa_t": 30000,
+                "aux_t": 30000,
+                "ffc_state": 3,
+                "gain_mode": 0,
+                "radiometric": 1,
+            },
+        }
+
+    def perf_stats(self, c):
+        return {"emulator": 1, "frames": self.ticks, "late_ticks": self.late_ticks, "sent": c.sent, "skipped": c.skipped}
+
+    def metrics(self, c):
+        """
+        The metrics response of connection c.  The emulator doesn't time its stages, only its counters are filled in.
+        """
+        counters = [0] * METRICS_COUNTERS
+        counters[METRICS_CNT_FRAMES] = self.ticks
+        counters[METRICS_CNT_FRAMES_SKIPPED] = c.skipped
+        counters[METRICS_CNT_IMAGES_ENCODED] = c.sent
+        counters[METRICS_CNT_IMAGES_SENT] = c.sent
+        return {
+            "uptime_msec": (time.time_ns() // 1000 - self.start_usec) // 1000,
+            "stages": [[0] * 10 for _ in range(METRICS_STAGES)],
+            "counters": counters,
+            "heap": [0, 0, 0, 0],
+            "queue": [0, c.writer.transport.get_write_buffer_size()],
+        }
+
+    def encode(self, n, seq, usec, fmt, ref):
+        """
+        encode()
+
+        Returns the bytes sent for frame n in image format fmt (a delta image against frame ref for format 2).
+        """
+        frame = self.frames[n]
+        if fmt == 0:
+            meta = json.dumps(self.metadata(seq, usec), separators=(",", ":"))
+            text = f'{{"metadata":{meta},"radiometric":"{frame.b64_pixels}","telemetry":"{frame.b64_telemetry}"}}'
+            return b"\x02" + text.encode() + b"\x03"
+
+        # Binary image with the TLVs the camera sends (see encode_binary_image() in tcam.py)
+        if fmt == 1:
+            encoding, data = BIN_ENC_RAW, frame.pixels
+        else:
+            encoding, data = frame.compress(self.frames[ref] if ref is not None else None)
+        t, d = _time_strings(usec)
+        tlvs = [
+            (1, self.name.encode()),
+            (BIN_TLV_MODEL, b"\x02"),
+            (3, TCAM_VERSION.encode()),
+            (4, t.encode()),
+            (5, d.encode()),
+            (BIN_TLV_MIN_MAX, frame.min_max),
+        ]
+        if encoding != BIN_ENC_RAW:
+            tlvs.append((BIN_TLV_ENCODING, bytes([encoding])))
+        tlvs += [
+            (BIN_TLV_TIMESTAMP, struct.pack("<Q", usec // 1000)),
+            (BIN_TLV_CAPTURE_USEC, struct.pack("<Q", usec)),
+            (BIN_TLV_TIME_SYNC, b"\x01"),
+            (BIN_TLV_SEQ, struct.pack("<I", seq & 0xFFFFFFFF)),
+        ]
+        meta = b"".join(bytes([tlv_type, len(value)]) + value for tlv_type, value in tlvs)
+        hdr = BIN_IMAGE_HEADER.pack(
+            BIN_IMAGE_START,
+            BIN_IMAGE_VERSION,
+            BIN_IMAGE_HEADER.size,
+            len(meta) + len(data) + len(frame.telemetry),
+            FRAME_WIDTH,
+            FRAME_HEIGHT,
+            len(meta),
+            len(frame.telemetry),
+        )
+        return b"".join((hdr, meta, data, frame.telemetry))
+
+
+async def run_cameras(
+    count, frames, host="0.0.0.0", port=CMD_PORT, loopback=False, fps=DEFAULT_FPS, jitter_msec=0, seed=None
+):
+    """
+    run_cameras()
+
+    Start count emulated cameras replaying frames.  Camera n listens on port + n or, with loopback, on port at
+    127.0.0.(n + 1) so clients can use the normal port.  Returns the cameras and their (address, port).
+    """
+    cameras = []
+    addrs = []
+    for n in range(count):
+        cam = EmulatedCamera(frames, f"tCam-Mini-EMU{n}", fps, jitter_msec, None if seed is None else seed + n)
+        addr = (f"127.0.0.{n + 1}", port) if loopback else (host, port + n)
+        await cam.start(*addr)
+        cameras.append(cam)
+        addrs.append(addr)
+    return cameras, addrs
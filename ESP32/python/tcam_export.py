@@ -0,0 +1,287 @@
+"""
+  tCam image export
+
+  Convert .tjsn images, .tmjsn movies and recordings into palette mapped PNG images or video files (MP4 or any
+  other container ffmpeg writes).  Files are read one image at a time so long movies are never loaded into memory.
+  Decoding (json, base64), range finding, palette mapping and upscaling are numpy operations and run in a pool of
+  worker processes.  The main process only splits the file into images and, for videos, pipes the frames to
+  ffmpeg in order.
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import json
+import os
+import shutil
+import subprocess
+from multiprocessing import Pool
+
+import numpy as np
+
+try:
+    from .tcam import TCamRecording, read_json_objects
+    from .tcam_numpy import apply_palette, image_array
+except ImportError:
+    from tcam import TCamRecording, read_json_objects
+    from tcam_numpy import apply_palette, image_array
+
+
+# Range modes: each image scaled over its own range, all images over the range of the whole file (an extra
+# decoding pass, no brightness flicker in videos) or a fixed vmin - vmax range
+RANGE_FRAME = "frame"
+RANGE_FILE = "file"
+RANGE_FIXED = "fixed"
+
+# File extensions written as images (anything else is a video written by ffmpeg)
+IMAGE_EXTENSIONS = (".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff")
+
+# Images handed to the workers at a time (bounds memory while keeping them busy)
+BATCH_PER_WORKER = 16
+
+# Frame rate of the Lepton for videos
+DEFAULT_FPS = 8.7
+
+# Settings used by the worker processes (set by _init_worker)
+_settings = {}
+
+
+def _init_worker(settings):
+    _settings.update(settings)
+
+
+class _SerialPool:
+    """
+    Runs the work in this process for one worker (and in export_files() workers, which can't start pools)
+    """
+
+    def __init__(self, initializer=None, initargs=()):
+        if initializer:
+            initializer(*initargs)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        pass
+
+    def imap(self, fn, items, chunksize=1):
+        return map(fn, items)
+
+    imap_unordered = imap
+
+
+def _pool(workers, initializer=None, initargs=()):
+    if workers > 1:
+        return Pool(workers, initializer, initargs)
+    return _SerialPool(initializer, initargs)
+
+
+def _decode(obj):
+    """
+    Returns the pixel array of a json image (undecoded json text or a dict) or None for other objects.
+    """
+    if isinstance(obj, (bytes, bytearray)):
+        if b'"radiometric"' not in obj:
+            return None
+        obj = json.loads(obj)
+    if "radiometric" not in obj:
+        return None
+    pixels, _ = image_array(obj)
+    return pixels
+
+
+def render(pixels, palette="ironblack", vmin=None, vmax=None, scale=1, smooth=False):
+    """
+    render()
+
+    Returns a (120 * scale) x (160 * scale) x 3 uint8 RGB image of a pixel array mapped over vmin - vmax (the
+    image range by default).  Pixels are repeated (or with smooth, bilinear interpolated) to scale up.
+    """
+    rgb = apply_palette(pixels, palette, vmin, vmax)
+    if scale > 1:
+        if smooth:
+            from PIL import Image
+
+            h, w = rgb.shape[:2]
+            rgb = np.asarray(Image.fromarray(rgb, "RGB").resize((w * scale, h * scale), Image.BILINEAR))
+        else:
+            rgb = rgb.repeat(scale, axis=0).repeat(scale, axis=1)
+    return rgb
+
+
+def _render_obj(obj):
+    pixels = _decode(obj)
+    if pixels is None:
+        return None
+    s = _settings
+    return render(pixels, s["palette"], s["vmin"], s["vmax"], s["scale"], s["smooth"])
+
+
+def _range_obj(obj):
+    pixels = _decode(obj)
+    if pixels is None:
+        return None
+    return int(pixels.min()), int(pixels.max())
+
+
+def _write_obj(item):
+    n, obj = item
+    rgb = _render_obj(obj)
+    if rgb is None:
+        return None
+    from PIL import Image
+
+    path = _settings["pattern"].format(n)
+    Image.fromarray(rgb, "RGB").save(path)
+    return path
+
+
+def read_images(src):
+    """
+    read_images()
+
+    Generate the images in a .tjsn or .tmjsn file (as undecoded json text) or in a recording (as image dicts)
+    one at a time.
+    """
+    if str(src).endswith((".tjsn", ".tmjsn")):
+        yield from read_json_objects(src)
+    else:
+        with TCamRecording(src) as recording:
+            yield from recording
+
+
+def _batches(items, size):
+    batch = []
+    for item in items:
+        batch.append(item)
+        if len(batch) == size:
+            yield batch
+            batch = []
+    if batch:
+        yield batch
+
+
+def _pool_map(pool, fn, src, workers):
+    """
+    Generate the results of fn for each image of src, in order, a batch at a time so the whole file is never
+    queued.
+    """
+    for batch in _batches(read_images(src), workers * BATCH_PER_WORKER):
+        yield from pool.imap(fn, batch, chunksize=max(1, len(batch) // (workers * 4)))
+
+
+def file_range(src, workers=None):
+    """
+    file_range()
+
+    Returns the minimum and maximum pixel of all of the images in a file.
+    """
+    workers = workers or os.cpu_count() or 1
+    vmin, vmax = None, None
+    with _pool(workers) as pool:
+        for r in _pool_map(pool, _range_obj, src, workers):
+            if r is not None:
+                vmin = r[0] if vmin is None else min(vmin, r[0])
+                vmax = r[1] if vmax is None else max(vmax, r[1])
+    return vmin, vmax
+
+
+def export_file(
+    src,
+    dst,
+    palette="ironblack",
+    range_mode=RANGE_FRAME,
+    vmin=None,
+    vmax=None,
+    scale=1,
+    smooth=False,
+    fps=DEFAULT_FPS,
+    workers=None,
+    ffmpeg_args=("-c:v", "libx264", "-pix_fmt", "yuv420p", "-crf", "18"),
+):
+    """
+    export_file()
+
+    Convert the images in src (.tjsn, .tmjsn or a recording) into dst.  dst is an image file name, a pattern with
+    one format field for the image number ("frame_{:05d}.png") when src has more than one image, or a video file
+    written by ffmpeg at fps.  range_mode is RANGE_FRAME, RANGE_FILE or RANGE_FIXED (with vmin and vmax).
+    Returns the number of images written.
+    """
+    workers = workers or os.cpu_count() or 1
+    if range_mode == RANGE_FILE:
+        vmin, vmax = file_range(src, workers)
+    elif range_mode == RANGE_FRAME:
+        vmin, vmax = None, None
+    elif vmin is None or vmax is None:
+        raise ValueError("a fixed range needs vmin and vmax")
+
+    settings = {"palette": palette, "vmin": vmin, "vmax": vmax, "scale": scale, "smooth": smooth, "pattern": dst}
+    is_image = str(dst).lower().endswith(IMAGE_EXTENSIONS)
+    if is_image and "{" not in str(dst):
+        # A single image: the first image of src
+        _init_worker(settings)
+        for obj in read_images(src):
+            rgb = _render_obj(obj)
+            if rgb is not None:
+                from PIL import Image
+
+                Image.fromarray(rgb, "RGB").save(dst)
+                return 1
+        return 0
+    if not is_image and shutil.which("ffmpeg") is None:
+        raise RuntimeError("ffmpeg is needed to write videos")
+
+    n = 0
+    with _pool(workers, _init_worker, (settings,)) as pool:
+        if is_image:
+            for batch in _batches(enumerate(read_images(src)), workers * BATCH_PER_WORKER):
+                for path in pool.imap_unordered(_write_obj, batch, chunksize=BATCH_PER_WORKER // 4):
+                    n += path is not None
+            return n
+
+        h, w = 120 * scale, 160 * scale
+        cmd = ["ffmpeg", "-loglevel", "error", "-y", "-f", "rawvideo", "-pix_fmt", "rgb24", "-s", f"{w}x{h}"]
+        cmd += ["-r", str(fps), "-i", "-", *ffmpeg_args, str(dst)]
+        proc = subprocess.Popen(cmd, stdin=subprocess.PIPE)
+        try:
+            for rgb in _pool_map(pool, _render_obj, src, workers):
+                if rgb is not None:
+                    proc.stdin.write(rgb.tobytes())
+                    n += 1
+        finally:
+            proc.stdin.close()
+            if proc.wait() != 0:
+                raise RuntimeError(f"ffmpeg failed writing {dst}")
+    return n
+
+
+def _export_job(job):
+    src, dst, kwargs = job
+    return src, export_file(src, dst, workers=1, **kwargs)
+
+
+def export_files(jobs, workers=None, **kwargs):
+    """
+    export_files()
+
+    Convert a list of (src, dst) pairs with export_file() settings kwargs, one file per worker process.  Generates
+    (src, images written) as each file is finished.
+    """
+    workers = workers or os.cpu_count() or 1
+    with Pool(workers) as pool:
+        yield from pool.imap_unordered(_export_job, [(src, dst, kwargs) for src, dst in jobs])
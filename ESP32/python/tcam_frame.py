@@ -0,0 +1,329 @@
+"""
+  tCam shared frame format
+
+  Read and write frames in the binary frame format shared by the programs in this repository (vospi_asm/tcam_frame.h):
+  the Raspberry Pi and BeagleBone capture programs' ZMQ messages and shared memory frame bus slots.  A frame is a
+  fixed 64 byte header (geometry, pixel format, bit depth, sequence number, timestamps, the commonly used telemetry
+  values and the compression) followed by the pixels and, optionally, the Lepton's telemetry.
+
+  TCamFrame reads a frame in place: the header is a numpy record and the pixels and little-endian telemetry are
+  views of the buffer the frame was received into.  tcam_numpy.FrameDecoder decodes these frames along with the
+  camera's json and binary images.  TCamFrameStream splits a byte stream of back to back frames (the Teensy USB
+  bridge's serial port) into frames.
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import numpy as np
+
+try:
+    from .tcam import rice_decode_image
+except ImportError:
+    from tcam import rice_decode_image
+
+
+TCAM_FRAME_MAGIC = 0x52464354
+TCAM_FRAME_VERSION = 1
+
+# Pixel formats
+TCAM_FRAME_FMT_8 = 0
+TCAM_FRAME_FMT_16LE = 1
+TCAM_FRAME_FMT_16BE = 2
+
+# Compression (the same values as the binary image BIN_ENC_xxx encodings)
+TCAM_FRAME_COMP_RAW = 0
+TCAM_FRAME_COMP_RICE = 1
+TCAM_FRAME_COMP_RICE_DELTA = 2
+TCAM_FRAME_COMP_PNG = 3
+TCAM_FRAME_COMP_JPEG = 4
+
+# Flags
+TCAM_FRAME_FLAG_TLINEAR = 0x0001
+TCAM_FRAME_FLAG_TELEM_BE = 0x0002
+TCAM_FRAME_FLAG_WALL = 0x0004
+
+# Telemetry values in the header (the same bits as the binary image telemetry field mask)
+TCAM_FRAME_TEL_FRAME_CNT = 0x01
+TCAM_FRAME_TEL_FPA_TEMP = 0x02
+TCAM_FRAME_TEL_AUX_TEMP = 0x04
+TCAM_FRAME_TEL_FFC = 0x08
+TCAM_FRAME_TEL_GAIN = 0x10
+TCAM_FRAME_TEL_TLIN = 0x20
+
+TCAM_FRAME_HEADER_DTYPE = np.dtype(
+    [
+        ("magic", "<u4"),
+        ("version", "<u2"),
+        ("header_len", "<u2"),
+        ("width", "<u2"),
+        ("height", "<u2"),
+        ("bits", "u1"),
+        ("format", "u1"),
+        ("compression", "u1"),
+        ("telem_fields", "u1"),
+        ("flags", "<u2"),
+        ("telem_len", "<u2"),
+        ("pixel_len", "<u4"),
+        ("seq", "<u4"),
+        ("timestamp_usec", "<i8"),
+        ("wall_usec", "<i8"),
+        ("lep_frame_count", "<u4"),
+        ("fpa_temp_k100", "<u2"),
+        ("aux_temp_k100", "<u2"),
+        ("ffc", "u1"),
+        ("gain_mode", "u1"),
+        ("tlinear", "u1"),
+        ("reserved", "u1", 9),
+    ]
+)
+TCAM_FRAME_HEADER_LEN = TCAM_FRAME_HEADER_DTYPE.itemsize
+
+_PIXEL_DTYPES = {TCAM_FRAME_FMT_8: np.uint8, TCAM_FRAME_FMT_16LE: "<u2", TCAM_FRAME_FMT_16BE: ">u2"}
+
+
+def is_tcam_frame(buf):
+    """
+    is_tcam_frame()
+
+    Returns True if buf starts with a frame header (as opposed to a camera's binary image).
+    """
+    return len(buf) >= 4 and int.from_bytes(bytes(buf[:4]), "little") == TCAM_FRAME_MAGIC
+
+
+class TCamFrame:
+    """
+    TCamFrame - A frame read in place from buf (bytes, bytearray, memoryview or a numpy array) starting at offset.
+    Raises ValueError if buf doesn't hold a complete frame.
+
+    header == The header as a TCAM_FRAME_HEADER_DTYPE record (a view of buf)
+    """
+
+    def __init__(self, buf, offset=0):
+        if len(buf) - offset < TCAM_FRAME_HEADER_LEN:
+            raise ValueError("too short for a frame header")
+        hdr = np.frombuffer(buf, dtype=TCAM_FRAME_HEADER_DTYPE, count=1, offset=offset)[0]
+        if hdr["magic"] != TCAM_FRAME_MAGIC or hdr["version"] < 1 or hdr["header_len"] < TCAM_FRAME_HEADER_LEN:
+            raise ValueError("not a frame")
+        self.buf = buf
+        self.offset = offset
+        self.header = hdr
+        self.pixelOffset = offset + int(hdr["header_len"])
+        self.telemOffset = self.pixelOffset + int(hdr["pixel_len"])
+        if self.telemOffset + int(hdr["telem_len"]) > len(buf):
+            raise ValueError("frame is truncated")
+
+    def __len__(self):
+        return self.telemOffset + int(self.header["telem_len"]) - self.offset
+
+    @property
+    def width(self):
+        return int(self.header["width"])
+
+    @property
+    def height(self):
+        return int(self.header["height"])
+
+    @property
+    def seq(self):
+        return int(self.header["seq"])
+
+    def pixel_view(self):
+        """
+        pixel_view()
+
+        Returns the raw pixels as a height x width array of the frame's pixel format (uint8, little or big-endian
+        uint16) viewing buf.  Raises ValueError for a compressed frame.
+        """
+        hdr = self.header
+        if hdr["compression"] != TCAM_FRAME_COMP_RAW:
+            raise ValueError("compressed frame")
+        if hdr["format"] not in _PIXEL_DTYPES:
+            raise ValueError(f"unknown pixel format {hdr['format']}")
+        pixels = np.frombuffer(
+            self.buf, dtype=_PIXEL_DTYPES[hdr["format"]], count=self.width * self.height, offset=self.pixelOffset
+        )
+        return pixels.reshape(self.height, self.width)
+
+    def pixels(self, ref=None):
+        """
+        pixels()
+
+        Returns the pixels as a height x width 16-bit array.  16-bit raw pixels are a view of buf (big-endian pixels
+        are viewed as a big-endian array).  8-bit pixels are expanded and rice compressed pixels decoded, delta frames
+        against ref, the pixel array of the previous frame.  Raises ValueError if they can't be decoded.
+        """
+        hdr = self.header
+        comp = hdr["compression"]
+        if comp == TCAM_FRAME_COMP_RAW:
+            pixels = self.pixel_view()
+            return pixels.astype(np.uint16) if hdr["format"] == TCAM_FRAME_FMT_8 else pixels
+        if comp == TCAM_FRAME_COMP_RICE_DELTA and ref is None:
+            raise ValueError("delta frame without a reference frame")
+        if comp in (TCAM_FRAME_COMP_RICE, TCAM_FRAME_COMP_RICE_DELTA):
+            if comp == TCAM_FRAME_COMP_RICE_DELTA:
+                ref = np.asarray(ref).ravel().tolist()
+            else:
+                ref = None
+            data = bytes(self.buf[self.pixelOffset : self.telemOffset])
+            pixels = rice_decode_image(data, self.width, self.height, ref)
+            return np.array(pixels, dtype=np.uint16).reshape(self.height, self.width)
+        raise ValueError(f"unknown frame compression {comp}")
+
+    def telemetry_words(self):
+        """
+        telemetry_words()
+
+        Returns the telemetry as an array of little-endian 16-bit words (a view of buf unless the frame carries the
+        big-endian words sent by the Lepton, which are swapped into a copy) or None if the frame doesn't include it.
+        """
+        n = int(self.header["telem_len"]) // 2
+        if n == 0:
+            return None
+        if self.header["flags"] & TCAM_FRAME_FLAG_TELEM_BE:
+            return np.frombuffer(self.buf, dtype=">u2", count=n, offset=self.telemOffset).astype("<u2")
+        return np.frombuffer(self.buf, dtype="<u2", count=n, offset=self.telemOffset)
+
+    def metadata(self):
+        """
+        metadata()
+
+        Returns the header as a metadata dict using the same names as a binary image's metadata.  Timestamp is the
+        capture time in uSec since 1970 when the producer knows it (otherwise the producer's clock, which is also
+        in CaptureUsec).
+        """
+        hdr = self.header
+        flags = int(hdr["flags"])
+        fields = int(hdr["telem_fields"])
+        meta = {
+            "Seq": self.seq,
+            "CaptureUsec": int(hdr["timestamp_usec"]),
+            "Timestamp": int(hdr["wall_usec"] if flags & TCAM_FRAME_FLAG_WALL else hdr["timestamp_usec"]),
+            "TimeSync": bool(flags & TCAM_FRAME_FLAG_WALL),
+            "Bits": int(hdr["bits"]),
+        }
+        if flags & TCAM_FRAME_FLAG_TLINEAR:
+            meta["TLinear"] = True
+        telem = {}
+        if fields & TCAM_FRAME_TEL_FRAME_CNT:
+            telem["FrameCount"] = int(hdr["lep_frame_count"])
+        if fields & TCAM_FRAME_TEL_FPA_TEMP:
+            telem["FpaTemp"] = int(hdr["fpa_temp_k100"])
+        if fields & TCAM_FRAME_TEL_AUX_TEMP:
+            telem["AuxTemp"] = int(hdr["aux_temp_k100"])
+        if fields & TCAM_FRAME_TEL_FFC:
+            telem["FfcState"] = int(hdr["ffc"]) & 0x03
+            telem["FfcDesired"] = (int(hdr["ffc"]) & 0x04) != 0
+        if fields & TCAM_FRAME_TEL_GAIN:
+            telem["GainMode"] = int(hdr["gain_mode"])
+        if fields & TCAM_FRAME_TEL_TLIN:
+            telem["TLinear"] = (int(hdr["tlinear"]) & 0x01) != 0
+            telem["TLinRes"] = (int(hdr["tlinear"]) >> 1) & 0x01
+        if telem:
+            meta["Telem"] = telem
+        return meta
+
+
+class TCamFrameStream:
+    """
+    TCamFrameStream - Splits a byte stream of back to back frames into frames.  Data that isn't a frame (a frame cut
+    short, or the middle of one when the stream is joined) is skipped up to the next frame's magic and counted.
+
+    skipped == Bytes skipped
+    """
+
+    MAX_FRAME_LEN = 1 << 20
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.skipped = 0
+
+    def feed(self, data):
+        """
+        feed()
+
+        Adds data received from the stream and returns the list of the TCamFrames it completed (each in its own
+        buffer).
+        """
+        self.buf += data
+        frames = []
+        magic = TCAM_FRAME_MAGIC.to_bytes(4, "little")
+        while True:
+            start = self.buf.find(magic)
+            if start < 0:
+                # Keep the bytes that could be the start of a split magic
+                keep = min(len(self.buf), 3)
+                self.skipped += len(self.buf) - keep
+                del self.buf[: len(self.buf) - keep]
+                return frames
+            if start > 0:
+                self.skipped += start
+                del self.buf[:start]
+            if len(self.buf) < TCAM_FRAME_HEADER_LEN:
+                return frames
+            hdr = np.frombuffer(self.buf, dtype=TCAM_FRAME_HEADER_DTYPE, count=1)[0]
+            n = int(hdr["header_len"]) + int(hdr["pixel_len"]) + int(hdr["telem_len"])
+            if hdr["header_len"] < TCAM_FRAME_HEADER_LEN or n > self.MAX_FRAME_LEN:
+                # Not a real header, look for the next magic
+                self.skipped += 1
+                del self.buf[:1]
+                continue
+            # A frame cut short is followed by the next frame's magic
+            nxt = self.buf.find(magic, 4, n)
+            if nxt > 0:
+                self.skipped += nxt
+                del self.buf[:nxt]
+                continue
+            if len(self.buf) < n:
+                return frames
+            frames.append(TCamFrame(bytes(self.buf[:n])))
+            del self.buf[:n]
+
+
+def pack_frame(pixels, seq=0, timestamp_usec=0, wall_usec=None, bits=None, telem=None, tlinear=False):
+    """
+    pack_frame()
+
+    Returns a raw frame of a height x width pixel array (uint8 pixels are sent as 8-bit pixels, anything else as
+    little-endian 16-bit pixels) with the optional telemetry words.  bits defaults to 8 or 14.
+    """
+    pixels = np.asarray(pixels)
+    height, width = pixels.shape
+    if pixels.dtype == np.uint8:
+        fmt, data = TCAM_FRAME_FMT_8, pixels.tobytes()
+    else:
+        fmt, data = TCAM_FRAME_FMT_16LE, pixels.astype("<u2").tobytes()
+    telem_data = b"" if telem is None else np.asarray(telem).astype("<u2").tobytes()
+
+    hdr = np.zeros(1, dtype=TCAM_FRAME_HEADER_DTYPE)
+    h = hdr[0]
+    h["magic"] = TCAM_FRAME_MAGIC
+    h["version"] = TCAM_FRAME_VERSION
+    h["header_len"] = TCAM_FRAME_HEADER_LEN
+    h["width"], h["height"] = width, height
+    h["bits"] = bits if bits is not None else (8 if fmt == TCAM_FRAME_FMT_8 else 14)
+    h["format"] = fmt
+    h["pixel_len"] = len(data)
+    h["telem_len"] = len(telem_data)
+    h["seq"] = seq
+    h["timestamp_usec"] = timestamp_usec
+    if wall_usec is not None:
+        h["wall_usec"] = wall_usec
+        h["flags"] |= TCAM_FRAME_FLAG_WALL
+    if tlinear:
+        h["flags"] |= TCAM_FRAME_FLAG_TLINEAR
+    return hdr.tobytes() + data + telem_data
@@ -0,0 +1,470 @@
+"""
+  tCam hub
+
+  One process that owns the connections to a fleet of cameras and shares their frames with any number of local
+  consumers so each camera is streamed, and each image decoded, once however many applications use it.
+
+    - TCamHub keeps one AsyncTCam connection per camera on one event loop and reconnects (and restarts the
+      stream) when a camera drops.
+    - Compressed and json images are decoded into raw binary images (set_image_format 1) by a pool of worker
+      processes.  Each camera is assigned to one worker, which keeps the reference image its delta images are
+      decoded against, so a camera's images are decoded in order while the cameras are spread over the CPUs.  Raw
+      images are passed on as received.
+    - Subscribers connect to a Unix domain socket and receive the raw binary images of the cameras they asked
+      for.  tcam_numpy.binary_image_array() views the pixels and telemetry of a raw image in place so the
+      consumers don't decode anything.  A subscriber that falls more than maxBuffered bytes behind skips images
+      (counted in its metrics) instead of slowing the hub.
+    - get_metrics() (also sent to a subscriber that asks for it) reports the frame rate, decode time and errors
+      of each camera and the images sent to and skipped by each subscriber.
+    - With a metricsPort the hub subscribes to each camera's metrics (see tcam_metrics.py) and serves them, with
+      its own counters, on an HTTP /metrics endpoint in the OpenMetrics format.
+
+  Subscriber protocol: the subscriber sends one json line, {"cameras": [<names>]} (null or missing for all
+  cameras) or {"metrics": 1}.  The hub replies with one json line, {"cameras": [<names of all cameras>]} or the
+  metrics, and then sends each frame as HUB_FRAME_HEADER (HUB_FRAME_START, camera name length, 0, image length),
+  the camera name and the raw binary image.  TCamHubClient implements the subscriber side.
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import asyncio
+import json
+import os
+import socket
+import struct
+import time
+from concurrent.futures import ProcessPoolExecutor
+
+try:
+    from .tcam import (
+        BIN_ENC_RICE,
+        BIN_ENC_RICE_DELTA,
+        BIN_IMAGE_HEADER,
+        BIN_IMAGE_START,
+        BIN_TLV_ENCODING,
+        JsonImage,
+        encode_binary_image,
+        get_binary_image_tlvs,
+        rice_decode_image,
+    )
+    from .tcam_async import AsyncTCam
+    from .tcam_metrics import METRICS_INTERVAL_MSEC, CameraMetrics, MetricsText, serve_metrics
+except ImportError:
+    from tcam import (
+        BIN_ENC_RICE,
+        BIN_ENC_RICE_DELTA,
+        BIN_IMAGE_HEADER,
+        BIN_IMAGE_START,
+        BIN_TLV_ENCODING,
+        JsonImage,
+        encode_binary_image,
+        get_binary_image_tlvs,
+        rice_decode_image,
+    )
+    from tcam_async import AsyncTCam
+    from tcam_metrics import METRICS_INTERVAL_MSEC, CameraMetrics, MetricsText, serve_metrics
+
+
+HUB_SOCKET_PATH = "/tmp/tcam_hub.sock"
+
+# Frame sent to subscribers: start, camera name length, reserved, image length
+HUB_FRAME_START = 0x08
+HUB_FRAME_HEADER = struct.Struct("<BBHI")
+
+# Frames waiting to be decoded for a camera before the oldest is dropped
+HUB_DECODE_QUEUE_LEN = 16
+
+# Bytes a subscriber may fall behind before it skips images
+HUB_MAX_BUFFERED = 1 << 20
+
+# Seconds between attempts to reconnect to cameras that dropped
+HUB_RECONNECT_SEC = 5
+
+
+##########################################################################################
+# Worker process decoder
+#
+# Reference pixel lists of the delta images of each camera assigned to this worker
+_refs = {}
+
+
+def _decode_frame(name, frame):
+    """
+    Returns a camera's image as a raw binary image and the decode time in uSec.  frame is a binary image or the
+    text of a json image.  Raises ValueError for a delta image without its reference.
+    """
+    t = time.perf_counter()
+    if frame[0] != BIN_IMAGE_START:
+        buf, _refs[name] = encode_binary_image(json.loads(frame))
+        return buf, int((time.perf_counter() - t) * 1e6)
+
+    _, version, hdr_len, payload_len, width, height, meta_len, telem_len = BIN_IMAGE_HEADER.unpack_from(frame)
+    tlvs = get_binary_image_tlvs(frame)
+    encoding = tlvs.get(BIN_TLV_ENCODING, b"\x00")[0]
+    if encoding not in (BIN_ENC_RICE, BIN_ENC_RICE_DELTA):
+        # Raw, AGC8 or preview images are passed on as they are
+        return frame, int((time.perf_counter() - t) * 1e6)
+
+    img_start = hdr_len + meta_len
+    img_end = hdr_len + payload_len - telem_len
+    ref = None
+    if encoding == BIN_ENC_RICE_DELTA:
+        ref = _refs.get(name)
+        if ref is None:
+            raise ValueError("delta image without a reference image")
+    pixels = rice_decode_image(frame[img_start:img_end], width, height, ref)
+    _refs[name] = pixels
+
+    del tlvs[BIN_TLV_ENCODING]
+    meta = b"".join(bytes([tlv_type, len(value)]) + value for tlv_type, value in sorted(tlvs.items()))
+    data = struct.pack(f"<{width * height}H", *pixels)
+    telem = frame[img_end : img_end + telem_len]
+    hdr = BIN_IMAGE_HEADER.pack(
+        BIN_IMAGE_START,
+        version,
+        BIN_IMAGE_HEADER.size,
+        len(meta) + len(data) + len(telem),
+        width,
+        height,
+        len(meta),
+        len(telem),
+    )
+    return hdr + meta + data + telem, int((time.perf_counter() - t) * 1e6)
+
+
+def _reset_ref(name):
+    _refs.pop(name, None)
+
+
+class HubCamera:
+    """
+    HubCamera - The connection to one camera and its counters
+    """
+
+    def __init__(self, name, ipaddress, port, worker, metricsIntervalMsec):
+        self.name = name
+        self.address = (ipaddress, port)
+        self.worker = worker
+        self.metrics = CameraMetrics(name, metricsIntervalMsec)
+        self.queue = None
+        self.cam = None
+        self.frames = 0
+        self.dropped = 0
+        self.decodeErrors = 0
+        self.decodeUsec = 0
+        self.connects = 0
+        self.rateFrames = 0
+        self.rateTime = time.monotonic()
+        self.fps = 0.0
+
+
+class HubSubscriber:
+    """
+    HubSubscriber - A connected consumer and its counters
+    """
+
+    def __init__(self, writer, cameras):
+        self.writer = writer
+        self.cameras = cameras
+        self.sent = 0
+        self.skipped = 0
+
+
+class TCamHub:
+    """
+    TCamHub - Stream from a set of cameras and serve their frames to local subscribers.
+
+    workers == Decoder processes (default one per CPU, at most one per camera)
+    imageFormat == set_image_format format the cameras stream in (2: compressed uses the least WiFi bandwidth)
+    keyInterval == Frames per keyframe for compressed images
+    socketPath == Unix domain socket subscribers connect to
+    maxBuffered == Bytes a subscriber may fall behind before it skips images
+    metricsPort == HTTP port of the /metrics endpoint (None for none)
+    metricsIntervalMsec == Time between the metrics pushed by each camera
+
+    Use run() from an asyncio event loop (or asyncio.run(hub.run())).
+    """
+
+    def __init__(
+        self,
+        workers=None,
+        imageFormat=2,
+        keyInterval=8,
+        delayMsec=0,
+        socketPath=HUB_SOCKET_PATH,
+        maxBuffered=HUB_MAX_BUFFERED,
+        responseTimeout=10,
+        metricsPort=None,
+        metricsIntervalMsec=METRICS_INTERVAL_MSEC,
+    ):
+        self.numWorkers = workers or os.cpu_count() or 1
+        self.imageFormat = imageFormat
+        self.keyInterval = keyInterval
+        self.delayMsec = delayMsec
+        self.socketPath = socketPath
+        self.maxBuffered = maxBuffered
+        self.responseTimeout = responseTimeout
+        self.metricsPort = metricsPort
+        self.metricsIntervalMsec = metricsIntervalMsec
+        self.cameras = {}
+        self.subscribers = []
+        self.executors = []
+        self.server = None
+        self.metricsServer = None
+
+    def add(self, name, ipaddress, port=5001):
+        """
+        add()
+
+        Add a camera (before run()).
+        """
+        self.cameras[name] = HubCamera(name, ipaddress, port, len(self.cameras), self.metricsIntervalMsec)
+
+    async def run(self):
+        """
+        run()
+
+        Connect to the cameras, stream from them and serve the subscribers until cancelled.
+        """
+        n = min(self.numWorkers, max(len(self.cameras), 1))
+        self.executors = [ProcessPoolExecutor(max_workers=1) for _ in range(n)]
+        for c in self.cameras.values():
+            c.worker %= n
+            c.queue = asyncio.Queue(HUB_DECODE_QUEUE_LEN)
+        if os.path.exists(self.socketPath):
+            os.unlink(self.socketPath)
+        self.server = await asyncio.start_unix_server(self.serveSubscriber, path=self.socketPath)
+        if self.metricsPort:
+            self.metricsServer = await serve_metrics(self.metricsPort, self.get_openmetrics)
+        tasks = [asyncio.create_task(self.pump(c)) for c in self.cameras.values()]
+        try:
+            while True:
+                await asyncio.gather(*(self.connect(c) for c in self.cameras.values() if not self.connected(c)))
+                await asyncio.sleep(HUB_RECONNECT_SEC)
+                self.updateRates()
+        finally:
+            for t in tasks:
+                t.cancel()
+            self.server.close()
+            if self.metricsServer:
+                self.metricsServer.close()
+            for c in self.cameras.values():
+                if self.connected(c):
+                    await c.cam.disconnect()
+            for e in self.executors:
+                e.shutdown(wait=False)
+            if os.path.exists(self.socketPath):
+                os.unlink(self.socketPath)
+
+    def connected(self, c):
+        return c.cam is not None and c.cam.connected()
+
+    async def connect(self, c):
+        c.cam = AsyncTCam(
+            responseTimeout=self.responseTimeout,
+            binaryFrames=True,
+            frameCallback=lambda frame: self.putFrame(c, frame),
+            responseCallback=c.metrics.update,
+        )
+        try:
+            await c.cam.connect(*c.address)
+            await c.cam.set_image_format(self.imageFormat)
+        except (OSError, asyncio.TimeoutError, ConnectionError):
+            c.cam = None
+            return
+        c.connects += 1
+        if self.metricsPort:
+            c.cam.subscribe_status(self.metricsIntervalMsec, metrics=True)
+        await asyncio.get_running_loop().run_in_executor(self.executors[c.worker], _reset_ref, c.name)
+        c.cam.start_stream(delay_msec=self.delayMsec, key_interval=self.keyInterval if self.imageFormat == 2 else 0)
+
+    def putFrame(self, c, frame):
+        if frame is None:
+            return
+        if isinstance(frame, JsonImage):
+            frame = frame.text
+        if c.queue.full():
+            c.queue.get_nowait()
+            c.dropped += 1
+        c.queue.put_nowait(frame)
+
+    async def pump(self, c):
+        """
+        Decode a camera's frames in order on its worker and send them to the subscribers
+        """
+        loop = asyncio.get_running_loop()
+        while True:
+            frame = await c.queue.get()
+            try:
+                buf, usec = await loop.run_in_executor(self.executors[c.worker], _decode_frame, c.name, frame)
+            except ValueError:
+                c.decodeErrors += 1
+                if self.connected(c):
+                    c.cam.stream_resync()
+                continue
+            c.frames += 1
+            c.rateFrames += 1
+            c.decodeUsec += usec
+            self.publish(c.name, buf)
+
+    def publish(self, name, buf):
+        hdr = None
+        for s in self.subscribers:
+            if s.cameras is not None and name not in s.cameras:
+                continue
+            if s.writer.transport.get_write_buffer_size() > self.maxBuffered:
+                s.skipped += 1
+                continue
+            if hdr is None:
+                name_data = name.encode()
+                hdr = HUB_FRAME_HEADER.pack(HUB_FRAME_START, len(name_data), 0, len(buf)) + name_data
+            s.writer.write(hdr)
+            s.writer.write(buf)
+            s.sent += 1
+
+    async def serveSubscriber(self, reader, writer):
+        try:
+            req = json.loads(await reader.readline() or b"{}")
+            if req.get("metrics"):
+                writer.write(json.dumps(self.get_metrics()).encode() + b"\n")
+                await writer.drain()
+                return
+            cameras = req.get("cameras")
+            s = HubSubscriber(writer, set(cameras) if cameras else None)
+            writer.write(json.dumps({"cameras": list(self.cameras)}).encode() + b"\n")
+            self.subscribers.append(s)
+            try:
+                # Subscribers don't send anything else, this returns when they close
+                await reader.read()
+            finally:
+                self.subscribers.remove(s)
+        except (ValueError, AttributeError, ConnectionError):
+            pass
+        finally:
+            writer.close()
+
+    def updateRates(self):
+        now = time.monotonic()
+        for c in self.cameras.values():
+            c.fps = c.rateFrames / max(now - c.rateTime, 1e-3)
+            c.rateFrames = 0
+            c.rateTime = now
+
+    def get_metrics(self):
+        """
+        get_metrics()
+
+        Returns a dict of the counters of each camera and subscriber.  fps is measured over the last
+        HUB_RECONNECT_SEC.
+        """
+        cameras = {}
+        for c in self.cameras.values():
+            cameras[c.name] = {
+                "connected": self.connected(c),
+                "connects": c.connects,
+                "frames": c.frames,
+                "fps": round(c.fps, 2),
+                "dropped": c.dropped,
+                "decode_errors": c.decodeErrors,
+                "decode_usec": c.decodeUsec // c.frames if c.frames else 0,
+                "worker": c.worker,
+            }
+        subscribers = [
+            {"cameras": sorted(s.cameras) if s.cameras is not None else None, "sent": s.sent, "skipped": s.skipped}
+            for s in self.subscribers
+        ]
+        return {"cameras": cameras, "subscribers": subscribers}
+
+    def get_openmetrics(self):
+        """
+        get_openmetrics()
+
+        Returns the OpenMetrics text of the cameras' metrics and the hub's counters.
+        """
+        text = MetricsText()
+        for c in self.cameras.values():
+            c.metrics.connected = self.connected(c)
+            c.metrics.connects = c.connects
+            c.metrics.add_to(text)
+            cam = {"camera": c.name}
+            text.counter("tcam_hub_frames", "Frames the hub received and passed on", cam, c.frames)
+            text.gauge("tcam_hub_fps", "Frames per second the hub received", cam, c.fps)
+            text.counter("tcam_hub_dropped", "Frames dropped waiting to be decoded", cam, c.dropped)
+            text.counter("tcam_hub_decode_errors", "Frames that couldn't be decoded", cam, c.decodeErrors)
+            text.counter("tcam_hub_decode_seconds", "Time spent decoding", cam, c.decodeUsec / 1e6)
+        for n, s in enumerate(self.subscribers):
+            sub = {"subscriber": n}
+            text.counter("tcam_hub_subscriber_sent", "Frames sent to the subscriber", sub, s.sent)
+            text.counter("tcam_hub_subscriber_skipped", "Frames the subscriber skipped", sub, s.skipped)
+        text.gauge("tcam_hub_subscribers", "Connected subscribers", {}, len(self.subscribers))
+        return text.text()
+
+
+class TCamHubClient:
+    """
+    TCamHubClient - Receive raw binary images from a TCamHub.
+
+    cameras == Names of the cameras to receive (None for all)
+
+    frames() yields (camera name, raw binary image) tuples.  Use tcam_numpy.binary_image_array() to view the
+    pixels and telemetry without decoding.
+    """
+
+    def __init__(self, cameras=None, socketPath=HUB_SOCKET_PATH):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(socketPath)
+        self.file = self.sock.makefile("rb")
+        self.sock.sendall(json.dumps({"cameras": cameras}).encode() + b"\n")
+        self.cameras = json.loads(self.file.readline())["cameras"]
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def close(self):
+        self.file.close()
+        self.sock.close()
+
+    def frames(self):
+        while True:
+            hdr = self.file.read(HUB_FRAME_HEADER.size)
+            if len(hdr) < HUB_FRAME_HEADER.size:
+                return
+            start, name_len, _, length = HUB_FRAME_HEADER.unpack(hdr)
+            if start != HUB_FRAME_START:
+                raise ValueError("lost sync with the hub")
+            name = self.file.read(name_len).decode()
+            buf = self.file.read(length)
+            if len(buf) < length:
+                return
+            yield name, buf
+
+
+def get_hub_metrics(socketPath=HUB_SOCKET_PATH):
+    """
+    get_hub_metrics()
+
+    Returns the metrics of a running TCamHub.
+    """
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+        sock.connect(socketPath)
+        sock.sendall(b'{"metrics": 1}\n')
+        with sock.makefile("rb") as f:
+            return json.loads(f.readline())
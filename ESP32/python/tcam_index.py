@@ -0,0 +1,342 @@
+"""
+  tCam json file index
+
+  Random access into .tjsn image files and .tmjsn movie files without converting them.  A .tmjsn file is a series of
+  json images (each terminated by 0x03) so reading image n otherwise means parsing every image before it.
+  index_json_file() scans a file once and writes a sidecar (the file name with .tidx appended) holding the byte
+  offset, length, capture time and sequence number of each image.  TCamJsonFile memory maps the file and uses the
+  sidecar to decode only the images asked for, straight from the mapped file into numpy arrays.
+
+  Sidecar layout (little-endian):
+    header             TIDX_HEADER: magic, version, record size, number of images and the size and modification
+                       time (nSec) of the file it indexes (a sidecar that doesn't match its file is rebuilt)
+    records            N TIDX_RECORD_DTYPE records:
+                         offset            byte offset of the image's json text
+                         length            length of the json text (without the 0x03)
+                         timestamp_usec    capture time from the Date and Time metadata (usec since 1970, mSec
+                                           resolution), -1 if unknown
+                         seq               capture sequence number (0xFFFFFFFF if the image doesn't have one)
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import binascii
+import json
+import mmap
+import os
+import struct
+
+import numpy as np
+
+try:
+    from .tcam import json_timestamp
+    from .tcam_numpy import TELEMETRY_DTYPE
+except ImportError:
+    from tcam import json_timestamp
+    from tcam_numpy import TELEMETRY_DTYPE
+
+
+TIDX_MAGIC = b"TIDX"
+TIDX_VERSION = 1
+TIDX_SUFFIX = ".tidx"
+
+# magic, version, record size, number of records, indexed file size, indexed file mtime (nSec)
+TIDX_HEADER = struct.Struct("<4sHHIQq")
+
+TIDX_RECORD_DTYPE = np.dtype([("offset", "<u8"), ("length", "<u4"), ("timestamp_usec", "<i8"), ("seq", "<u4")])
+
+JSON_OBJECT_END = 0x03
+
+# Bytes of each object searched for its metadata (it is the first item the camera and Desktop application write)
+_META_SEARCH_LEN = 4096
+
+_json_decoder = json.JSONDecoder()
+
+
+def index_path(path):
+    """
+    index_path()
+
+    Returns the name of the sidecar index of a .tjsn or .tmjsn file.
+    """
+    return str(path) + TIDX_SUFFIX
+
+
+def _find_value(buf, start, end, name):
+    """
+    Returns the offset of the value of the json item name (the character after its ':') between start and end in buf,
+    or -1.
+    """
+    pos = buf.find(b'"' + name + b'":', start, end)
+    if pos < 0:
+        return -1
+    return pos + len(name) + 3
+
+
+def _find_string(buf, start, end, name):
+    """
+    Returns the (start, end) offsets of the text of the json string item name between start and end in buf, or None.
+    Base64 text has no escaped characters so the string ends at the next quote.
+    """
+    pos = _find_value(buf, start, end, name)
+    if pos < 0:
+        return None
+    pos = buf.find(b'"', pos, end)
+    if pos < 0:
+        return None
+    stop = buf.find(b'"', pos + 1, end)
+    if stop < 0:
+        return None
+    return pos + 1, stop
+
+
+def _object_metadata(buf, start, end):
+    """
+    Returns the metadata dict of the json image between start and end in buf without parsing the rest of it, or None
+    if it has none.
+    """
+    pos = _find_value(buf, start, min(end, start + _META_SEARCH_LEN), b"metadata")
+    if pos < 0:
+        pos = _find_value(buf, start, end, b"metadata")
+        if pos < 0:
+            return None
+    # The metadata object is only decoded as far as its closing brace
+    text = bytes(buf[pos : min(end, pos + _META_SEARCH_LEN)]).decode("utf-8", "replace")
+    try:
+        meta, _ = _json_decoder.raw_decode(text.lstrip())
+    except ValueError:
+        meta, _ = _json_decoder.raw_decode(bytes(buf[pos:end]).decode("utf-8", "replace").lstrip())
+    return meta if isinstance(meta, dict) else None
+
+
+def _scan(buf):
+    """
+    Returns the TIDX_RECORD_DTYPE records of the images in buf (objects without radiometric data, like the movie's
+    video_info object, are skipped).
+    """
+    records = []
+    start = 0
+    size = len(buf)
+    while start < size:
+        end = buf.find(bytes((JSON_OBJECT_END,)), start)
+        if end < 0:
+            end = size
+        # Skip the whitespace between objects
+        while start < end and buf[start] in b" \t\r\n":
+            start += 1
+        if start < end and _find_value(buf, start, end, b"radiometric") >= 0:
+            meta = _object_metadata(buf, start, end) or {}
+            ms = json_timestamp(meta)
+            seq = meta.get("Seq")
+            records.append(
+                (start, end - start, -1 if ms is None else ms * 1000, 0xFFFFFFFF if seq is None else seq & 0xFFFFFFFF)
+            )
+        start = end + 1
+    return np.array(records, dtype=TIDX_RECORD_DTYPE)
+
+
+def _file_id(path):
+    st = os.stat(path)
+    return st.st_size, st.st_mtime_ns
+
+
+def index_json_file(path, force=False):
+    """
+    index_json_file()
+
+    Scan a .tjsn or .tmjsn file and write its sidecar index.  An existing index that matches the file is read
+    instead unless force is set.  Returns the TIDX_RECORD_DTYPE records.
+    """
+    if not force:
+        records = read_index(path)
+        if records is not None:
+            return records
+
+    size, mtime = _file_id(path)
+    with open(path, "rb") as f:
+        if size == 0:
+            records = np.zeros(0, dtype=TIDX_RECORD_DTYPE)
+        else:
+            with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as buf:
+                records = _scan(buf)
+
+    tmp = index_path(path) + ".tmp"
+    with open(tmp, "wb") as f:
+        f.write(TIDX_HEADER.pack(TIDX_MAGIC, TIDX_VERSION, TIDX_RECORD_DTYPE.itemsize, len(records), size, mtime))
+        f.write(records.tobytes())
+    os.replace(tmp, index_path(path))
+    return records
+
+
+def read_index(path):
+    """
+    read_index()
+
+    Returns the TIDX_RECORD_DTYPE records of the sidecar index of a .tjsn or .tmjsn file or None if it doesn't exist
+    or doesn't match the file (it was changed after it was indexed).
+    """
+    try:
+        with open(index_path(path), "rb") as f:
+            hdr = f.read(TIDX_HEADER.size)
+            if len(hdr) < TIDX_HEADER.size:
+                return None
+            magic, version, rec_size, num, size, mtime = TIDX_HEADER.unpack(hdr)
+            if magic != TIDX_MAGIC or version != TIDX_VERSION or rec_size != TIDX_RECORD_DTYPE.itemsize:
+                return None
+            if (size, mtime) != _file_id(path):
+                return None
+            records = np.fromfile(f, dtype=TIDX_RECORD_DTYPE, count=num)
+    except OSError:
+        return None
+    return records if len(records) == num else None
+
+
+class TCamJsonFile:
+    """
+    TCamJsonFile - A .tjsn or .tmjsn file memory mapped for random access.  The file is indexed (see
+    index_json_file()) the first time it is opened.  Only the images asked for are decoded.
+
+    timestamps == Capture time of each image (usec, -1 if unknown)
+    seqs       == Capture sequence number of each image (0xFFFFFFFF if unknown)
+    """
+
+    def __init__(self, path):
+        self.path = str(path)
+        self.records = index_json_file(self.path)
+        self.timestamps = self.records["timestamp_usec"]
+        self.seqs = self.records["seq"]
+        self.file = open(self.path, "rb")
+        self.buf = None
+        if len(self.records):
+            self.buf = mmap.mmap(self.file.fileno(), 0, access=mmap.ACCESS_READ)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __len__(self):
+        return len(self.records)
+
+    def close(self):
+        if self.buf is not None:
+            self.buf.close()
+            self.buf = None
+        self.file.close()
+
+    def _span(self, n):
+        rec = self.records[n]
+        start = int(rec["offset"])
+        return start, start + int(rec["length"])
+
+    def _decode_into(self, n, pixels, telem):
+        """
+        Decode the radiometric data (and telemetry words if telem isn't None) of image n into the arrays pixels and
+        telem.  Returns True if the image had telemetry.
+        """
+        start, end = self._span(n)
+        span = _find_string(self.buf, start, end, b"radiometric")
+        if span is None:
+            raise ValueError(f"image {n} has no radiometric data")
+        data = binascii.a2b_base64(memoryview(self.buf)[span[0] : span[1]])
+        if len(data) == pixels.size:
+            # AGC8 images have 8-bit pixels
+            pixels[...] = np.frombuffer(data, dtype=np.uint8).reshape(pixels.shape)
+        else:
+            pixels[...] = np.frombuffer(data, dtype="<u2").reshape(pixels.shape)
+        if telem is None:
+            return False
+        span = _find_string(self.buf, start, end, b"telemetry")
+        if span is None:
+            telem[...] = 0
+            return False
+        telem[...] = np.frombuffer(binascii.a2b_base64(memoryview(self.buf)[span[0] : span[1]]), dtype="<u2")
+        return True
+
+    def metadata(self, n):
+        """
+        metadata()
+
+        Returns the metadata dict of image n.
+        """
+        start, end = self._span(n)
+        return _object_metadata(self.buf, start, end) or {}
+
+    def image_json(self, n):
+        """
+        image_json()
+
+        Returns the json text (bytes) of image n.
+        """
+        start, end = self._span(n)
+        return self.buf[start:end]
+
+    def image(self, n):
+        """
+        image()
+
+        Returns the pixels of image n as a 120x160 uint16 array and the telemetry as a TELEMETRY_DTYPE record (None
+        if the image doesn't include it).
+        """
+        pixels = np.empty((120, 160), dtype="<u2")
+        words = np.empty(240, dtype="<u2")
+        if not self._decode_into(n, pixels, words):
+            return pixels, None
+        return pixels, words.view(TELEMETRY_DTYPE)[0]
+
+    def images(self, start, end, telemetry=True):
+        """
+        images()
+
+        Returns the pixels (N x 120 x 160 uint16) of images start up to end and, if telemetry is set, their telemetry
+        words (N x 240 uint16, zeros for images without telemetry) and a has_telemetry array.  Otherwise the
+        telemetry arrays are None.
+        """
+        start, end, _ = slice(start, end).indices(len(self))
+        count = max(0, end - start)
+        pixels = np.empty((count, 120, 160), dtype="<u2")
+        telem = np.zeros((count, 240), dtype="<u2") if telemetry else None
+        has_telem = np.zeros(count, dtype=bool) if telemetry else None
+        for i in range(count):
+            has = self._decode_into(start + i, pixels[i], None if telem is None else telem[i])
+            if has_telem is not None:
+                has_telem[i] = has
+        return pixels, telem, has_telem
+
+    def time_range(self, start_usec, end_usec):
+        """
+        time_range()
+
+        Returns the (start, end) image numbers captured from start_usec up to end_usec.  Assumes the camera clock
+        didn't go backwards during the file.
+        """
+        start = int(np.searchsorted(self.timestamps, start_usec, side="left"))
+        end = int(np.searchsorted(self.timestamps, end_usec, side="left"))
+        return start, end
+
+    def slice(self, start_usec, end_usec, telemetry=True):
+        """
+        slice()
+
+        Returns the timestamps, pixels and telemetry (see images()) of the images captured from start_usec up to
+        end_usec, decoding only those images.
+        """
+        start, end = self.time_range(start_usec, end_usec)
+        pixels, telem, has_telem = self.images(start, end, telemetry)
+        return self.timestamps[start:end], pixels, telem, has_telem
@@ -0,0 +1,429 @@
+"""
+  tCam metrics exporter
+
+  Collects the performance statistics of a fleet of cameras and serves them in the OpenMetrics text format on an
+  HTTP /metrics endpoint so Prometheus (or any OpenMetrics scraper) can chart them, alert on regressions and plan
+  capacity from the cameras in the field.
+
+    - Each camera is polled through a status subscription (subscribe_status with metrics) rather than by command:
+      every interval the camera pushes its status followed by a compact metrics response on the connection that
+      is already open, so collecting costs no round trips and a camera that stops answering is noticed.
+    - The stage times of get_perf_stats become histograms (tcam_stage_seconds{stage=...}), the pipeline counters
+      become counters (the frames captured and sent per second are rate(tcam_frames_total) and
+      rate(tcam_images_sent_total)) and the heap, queue depths, RSSI, Lepton temperatures and adaptive stream
+      level become gauges.  Every sample has a camera label.  tcam_fps_captured and tcam_fps_sent are also
+      exported, measured between the last two metrics responses, for scrapers that don't compute rates.
+    - TCamExporter connects to the cameras with AsyncTCam on one event loop and reconnects to cameras that drop.
+      TCamHub serves the same metrics for its cameras, along with its own, when given a metricsPort.
+    - CameraMetrics, MetricsText and serve_metrics() can be used to export metrics from another program.
+
+  Run as a program: python3 tcam_metrics.py [-p port] [-i interval_msec] [name=]address[:port] ...
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import argparse
+import asyncio
+import math
+import time
+
+try:
+    from .tcam_async import AsyncTCam
+except ImportError:
+    from tcam_async import AsyncTCam
+
+
+# HTTP port of the /metrics endpoint
+METRICS_PORT = 9105
+
+# Time between the metrics pushed by each camera
+METRICS_INTERVAL_MSEC = 5000
+
+# A camera is reported down when its metrics are this many intervals old
+METRICS_STALE_INTERVALS = 3
+
+# Seconds between attempts to reconnect to cameras that dropped
+METRICS_RECONNECT_SEC = 5
+
+METRICS_CONTENT_TYPE = "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+# The stages and counters of the metrics response, in the camera's order (see get_perf_stats).  The four
+# crc_failures counters are the segments of a frame.
+PERF_STAGES = (
+    "segment",
+    "frame_copy",
+    "json_encode",
+    "rice_encode",
+    "send",
+    "recovery",
+    "record_write",
+    "segment_send",
+    "png_encode",
+    "jpeg_encode",
+    "response_send",
+)
+
+PERF_COUNTERS = (
+    ("segment_retries", "Lepton segments read again after an error"),
+    ("frames", "Frames captured from the Lepton"),
+    ("frames_reclaimed", "Frame buffers reclaimed from a slow consumer"),
+    ("frames_dropped", "Frames dropped because no buffer was free"),
+    ("frames_skipped", "Frames not sent because the connection was busy"),
+    ("send_failures", "Socket sends that failed"),
+    ("crc_failures", "VoSPI packets with a bad CRC"),
+    ("crc_failures", "VoSPI packets with a bad CRC"),
+    ("crc_failures", "VoSPI packets with a bad CRC"),
+    ("crc_failures", "VoSPI packets with a bad CRC"),
+    ("realigns", "VoSPI segment realignments"),
+    ("resyncs", "VoSPI resynchronizations"),
+    ("resets", "Lepton resets"),
+    ("segments_dropped", "Lepton segments dropped"),
+    ("frames_lost", "Frames lost by the VoSPI task"),
+    ("images_encoded", "Images encoded"),
+    ("images_sent", "Images sent"),
+    ("responses_dropped", "Responses dropped because the connection was busy"),
+    ("packets_dropped", "Raw packet batches dropped"),
+    ("frames_held", "Frames dropped because every other frame buffer was held"),
+)
+
+# Counters the frame rates are measured from
+PERF_CNT_FRAMES = 1
+PERF_CNT_IMAGES_SENT = 16
+
+# Upper bounds of the stage histogram buckets in uSec (the last bucket is everything longer)
+PERF_BUCKETS_USEC = (64, 256, 1024, 4096, 16384, 65536, 262144)
+
+
+def _escape(value):
+    return str(value).replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n")
+
+
+def _number(value):
+    if isinstance(value, float):
+        if math.isinf(value):
+            return "+Inf" if value > 0 else "-Inf"
+        return repr(round(value, 6))
+    return str(value)
+
+
+class MetricsText:
+    """
+    MetricsText - Builds an OpenMetrics text exposition.  Samples may be added in any order; they are grouped
+    into their metric families when the text is made.
+    """
+
+    def __init__(self):
+        self.families = {}
+
+    def family(self, name, mtype, helpText, unit=None):
+        if name not in self.families:
+            self.families[name] = (mtype, helpText, unit, [])
+        return self.families[name][3]
+
+    def sample(self, name, mtype, helpText, labels, value, suffix="", unit=None):
+        """
+        sample()
+
+        Add a sample of metric family name.  labels is a dict.  Counters are given the _total suffix.
+        """
+        if mtype == "counter" and not suffix:
+            suffix = "_total"
+        self.family(name, mtype, helpText, unit).append((suffix, labels, value))
+
+    def gauge(self, name, helpText, labels, value, unit=None):
+        self.sample(name, "gauge", helpText, labels, value, unit=unit)
+
+    def counter(self, name, helpText, labels, value):
+        self.sample(name, "counter", helpText, labels, value)
+
+    def histogram(self, name, helpText, labels, bounds, buckets, total, unit=None):
+        """
+        histogram()
+
+        Add a histogram.  buckets holds the count of each bucket (one more than bounds, the last is +Inf) and
+        total the sum of the observations.
+        """
+        samples = self.family(name, "histogram", helpText, unit)
+        count = 0
+        for bound, n in zip(tuple(bounds) + (math.inf,), buckets):
+            count += n
+            samples.append(("_bucket", dict(labels, le=_number(float(bound))), count))
+        samples.append(("_count", labels, count))
+        samples.append(("_sum", labels, total))
+
+    def text(self):
+        lines = []
+        for name, (mtype, helpText, unit, samples) in self.families.items():
+            lines.append(f"# TYPE {name} {mtype}")
+            if unit:
+                lines.append(f"# UNIT {name} {unit}")
+            lines.append(f"# HELP {name} {_escape(helpText)}")
+            for suffix, labels, value in samples:
+                if labels:
+                    label_text = ",".join(f'{k}="{_escape(v)}"' for k, v in labels.items())
+                    lines.append(f"{name}{suffix}{{{label_text}}} {_number(value)}")
+                else:
+                    lines.append(f"{name}{suffix} {_number(value)}")
+        lines.append("# EOF")
+        return "\n".join(lines) + "\n"
+
+
+class CameraMetrics:
+    """
+    CameraMetrics - The last status and metrics pushed by one camera.  update() is the AsyncTCam
+    responseCallback of its connection.
+    """
+
+    def __init__(self, name, intervalMsec=METRICS_INTERVAL_MSEC):
+        self.name = name
+        self.intervalMsec = intervalMsec
+        self.status = None
+        self.metrics = None
+        self.updated = 0
+        self.connected = False
+        self.connects = 0
+        self.fpsCaptured = 0.0
+        self.fpsSent = 0.0
+
+    def update(self, response):
+        if "status" in response:
+            self.status = response["status"]
+        elif "metrics" in response:
+            m = response["metrics"]
+            now = time.monotonic()
+            if self.metrics and m.get("uptime_msec", 0) > self.metrics.get("uptime_msec", 0):
+                dt = (m["uptime_msec"] - self.metrics["uptime_msec"]) / 1000
+                self.fpsCaptured = self._delta(m, PERF_CNT_FRAMES) / dt
+                self.fpsSent = self._delta(m, PERF_CNT_IMAGES_SENT) / dt
+            self.metrics = m
+            self.updated = now
+
+    def _delta(self, m, n):
+        new = m.get("counters", [])
+        old = self.metrics.get("counters", [])
+        return max(new[n] - old[n], 0) if n < len(new) and n < len(old) else 0
+
+    def up(self):
+        if not self.connected or self.metrics is None:
+            return False
+        return time.monotonic() - self.updated < METRICS_STALE_INTERVALS * self.intervalMsec / 1000
+
+    def add_to(self, text):
+        """
+        add_to()
+
+        Add this camera's samples to a MetricsText.
+        """
+        cam = {"camera": self.name}
+        text.gauge("tcam_up", "The camera is connected and pushing metrics", cam, 1 if self.up() else 0)
+        text.counter("tcam_connects", "Connections made to the camera", cam, self.connects)
+        m = self.metrics
+        if m is None:
+            return
+
+        text.gauge("tcam_uptime_seconds", "Time since the camera started", cam, m.get("uptime_msec", 0) / 1000)
+        text.gauge(
+            "tcam_metrics_age_seconds", "Time since the camera last pushed its metrics", cam,
+            time.monotonic() - self.updated,
+        )
+        text.gauge("tcam_fps_captured", "Frames captured per second", cam, self.fpsCaptured)
+        text.gauge("tcam_fps_sent", "Images sent per second", cam, self.fpsSent)
+
+        for stage, values in zip(PERF_STAGES, m.get("stages", [])):
+            if len(values) < 2 + len(PERF_BUCKETS_USEC) + 1:
+                continue
+            text.histogram(
+                "tcam_stage_seconds", "Time taken by each stage of the camera's pipeline",
+                dict(cam, stage=stage), [b / 1e6 for b in PERF_BUCKETS_USEC], values[2:], values[1] / 1000,
+                unit="seconds",
+            )
+
+        crc_segment = 0
+        for (name, helpText), value in zip(PERF_COUNTERS, m.get("counters", [])):
+            labels = cam
+            if name == "crc_failures":
+                crc_segment += 1
+                labels = dict(cam, segment=crc_segment)
+            text.counter(f"tcam_{name}", helpText, labels, value)
+
+        heap = m.get("heap", [])
+        for n, region in enumerate(("internal", "spiram")):
+            if len(heap) >= 2 * n + 2:
+                labels = dict(cam, region=region)
+                text.gauge("tcam_heap_free_bytes", "Free heap", labels, heap[2 * n], unit="bytes")
+                text.gauge("tcam_heap_min_free_bytes", "Least free heap since start", labels, heap[2 * n + 1],
+                           unit="bytes")
+
+        queue = m.get("queue", [])
+        if len(queue) >= 2:
+            text.gauge("tcam_tx_queue_items", "Transmissions queued for the connection's socket", cam, queue[0])
+            text.gauge("tcam_response_queue_bytes", "Bytes of responses waiting to be sent", cam, queue[1],
+                       unit="bytes")
+        if "rssi" in m:
+            text.gauge("tcam_wifi_rssi_dbm", "Signal strength of the AP", cam, m["rssi"])
+
+        lepton = (self.status or {}).get("Lepton")
+        if lepton:
+            text.gauge("tcam_lepton_fpa_kelvin", "Lepton FPA temperature", cam, lepton.get("fpa_t", 0) / 100,
+                       unit="kelvin")
+            text.gauge("tcam_lepton_aux_kelvin", "Lepton housing temperature", cam, lepton.get("aux_t", 0) / 100,
+                       unit="kelvin")
+            text.gauge("tcam_lepton_ffc_state", "Lepton FFC state", cam, lepton.get("ffc_state", 0))
+            text.gauge("tcam_lepton_frame_age_seconds", "Age of the last frame", cam,
+                       lepton.get("age_msec", 0) / 1000, unit="seconds")
+        adapt = (self.status or {}).get("Adapt")
+        if adapt:
+            text.gauge("tcam_adapt_level", "Adaptive stream level", cam, adapt.get("level", 0))
+            text.gauge("tcam_adapt_latency_seconds", "Adaptive stream latency", cam,
+                       adapt.get("latency_msec", 0) / 1000, unit="seconds")
+
+
+async def serve_metrics(port, textFunc, host=""):
+    """
+    serve_metrics()
+
+    Start an HTTP server answering GET /metrics with the text returned by textFunc().  Returns the asyncio server.
+    """
+
+    async def handle(reader, writer):
+        try:
+            request = await asyncio.wait_for(reader.readuntil(b"\r\n\r\n"), 10)
+            parts = request.split(b"\r\n", 1)[0].split()
+            if len(parts) >= 2 and parts[0] in (b"GET", b"HEAD") and parts[1].split(b"?")[0] == b"/metrics":
+                status, ctype, body = "200 OK", METRICS_CONTENT_TYPE, textFunc().encode()
+            else:
+                status, ctype, body = "404 Not Found", "text/plain", b"Not Found\n"
+            writer.write(
+                f"HTTP/1.1 {status}\r\nContent-Type: {ctype}\r\nContent-Length: {len(body)}\r\n"
+                "Connection: close\r\n\r\n".encode()
+            )
+            if parts and parts[0] != b"HEAD":
+                writer.write(body)
+            await writer.drain()
+        except (asyncio.IncompleteReadError, asyncio.LimitOverrunError, asyncio.TimeoutError, ConnectionError):
+            pass
+        finally:
+            writer.close()
+
+    return await asyncio.start_server(handle, host, port)
+
+
+class ExporterCamera:
+    """
+    ExporterCamera - The connection to one camera and its metrics
+    """
+
+    def __init__(self, name, ipaddress, port, intervalMsec):
+        self.address = (ipaddress, port)
+        self.metrics = CameraMetrics(name, intervalMsec)
+        self.cam = None
+
+
+class TCamExporter:
+    """
+    TCamExporter - Collect the metrics of a set of cameras and serve them on an HTTP /metrics endpoint.
+
+    port, host == Address of the /metrics endpoint
+    intervalMsec == Time between the metrics pushed by each camera (100 - 3600000)
+
+    Use run() from an asyncio event loop (or asyncio.run(exporter.run())).
+    """
+
+    def __init__(self, port=METRICS_PORT, host="", intervalMsec=METRICS_INTERVAL_MSEC, responseTimeout=10):
+        self.port = port
+        self.host = host
+        self.intervalMsec = intervalMsec
+        self.responseTimeout = responseTimeout
+        self.cameras = {}
+        self.server = None
+
+    def add(self, name, ipaddress, port=5001):
+        """
+        add()
+
+        Add a camera (before run()).
+        """
+        self.cameras[name] = ExporterCamera(name, ipaddress, port, self.intervalMsec)
+
+    async def run(self):
+        """
+        run()
+
+        Serve the metrics and keep the cameras connected until cancelled.
+        """
+        self.server = await serve_metrics(self.port, self.text, self.host)
+        try:
+            while True:
+                await asyncio.gather(*(self.connect(c) for c in self.cameras.values() if not self.connected(c)))
+                await asyncio.sleep(METRICS_RECONNECT_SEC)
+        finally:
+            self.server.close()
+            for c in self.cameras.values():
+                if self.connected(c):
+                    await c.cam.disconnect()
+
+    def connected(self, c):
+        c.metrics.connected = c.cam is not None and c.cam.connected()
+        return c.metrics.connected
+
+    async def connect(self, c):
+        c.cam = AsyncTCam(responseTimeout=self.responseTimeout, responseCallback=c.metrics.update)
+        try:
+            await c.cam.connect(*c.address)
+            c.cam.subscribe_status(self.intervalMsec, metrics=True)
+        except (OSError, asyncio.TimeoutError, ConnectionError):
+            c.cam = None
+            return
+        c.metrics.connected = True
+        c.metrics.connects += 1
+
+    def text(self):
+        """
+        text()
+
+        Returns the OpenMetrics text of all the cameras.
+        """
+        text = MetricsText()
+        for c in self.cameras.values():
+            self.connected(c)
+            c.metrics.add_to(text)
+        return text.text()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Serve the metrics of a set of cameras for Prometheus")
+    parser.add_argument("-p", "--port", type=int, default=METRICS_PORT, help="/metrics HTTP port")
+    parser.add_argument(
+        "-i", "--interval", type=int, default=METRICS_INTERVAL_MSEC, help="mSec between each camera's metrics"
+    )
+    parser.add_argument("cameras", nargs="+", help="[name=]address[:port] of each camera")
+    args = parser.parse_args()
+
+    exporter = TCamExporter(args.port, intervalMsec=args.interval)
+    for spec in args.cameras:
+        name, _, addr = spec.rpartition("=")
+        host, _, port = addr.partition(":")
+        exporter.add(name or addr, host, int(port) if port else 5001)
+    try:
+        asyncio.run(exporter.run())
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
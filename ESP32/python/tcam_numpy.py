@@ -0,0 +1,293 @@
+"""
+  tCam NumPy support
+
+  Decode tCam images into numpy arrays and convert them to temperatures or palette mapped RGB images without
+  per-pixel Python code.  Images are the json form returned by TCam.get_frame(), TCamRecording and
+  decode_binary_image(), binary images as received (see TCam binaryFrames) or frames in the shared frame format
+  sent by the Raspberry Pi and BeagleBone capture programs (see tcam_frame.py).  Raw images are viewed in place
+  and never copied.  Compressed images still use the Python decoder in tcam.py so applications handling many
+  cameras should use raw binary images (set_image_format 1).
+
+  Copyright 2021 Dan Julio and Todd LaWall (bitreaper)
+
+  This file is part of tCam.
+
+  tCam is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  tCam is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+"""
+
+import base64
+import numpy as np
+
+try:
+    from .tcam import (
+        BIN_IMAGE_HEADER,
+        BIN_ENC_RAW,
+        BIN_ENC_RICE,
+        BIN_ENC_RICE_DELTA,
+        BIN_ENC_AGC8,
+        BIN_ENC_SPARSE,
+        SPARSE_HEADER,
+        JsonImage,
+        get_binary_image_metadata,
+        rice_decode_image,
+    )
+    from . import palettes
+    from .tcam_frame import TCamFrame, is_tcam_frame
+except ImportError:
+    from tcam import (
+        BIN_IMAGE_HEADER,
+        BIN_ENC_RAW,
+        BIN_ENC_RICE,
+        BIN_ENC_RICE_DELTA,
+        BIN_ENC_AGC8,
+        BIN_ENC_SPARSE,
+        SPARSE_HEADER,
+        JsonImage,
+        get_binary_image_metadata,
+        rice_decode_image,
+    )
+    import palettes
+    from tcam_frame import TCamFrame, is_tcam_frame
+
+
+# Lepton telemetry (240 little-endian 16-bit words) fields: name, word (see lepton_utilities.h in the firmware and
+# the Lepton datasheet), format.  Temperatures are in units of 0.01 K.
+TELEMETRY_FIELDS = [
+    ("revision", 0, "<u2"),
+    ("uptime_ms", 1, "<u4"),
+    ("status", 3, "<u4"),
+    ("frame_counter", 20, "<u4"),
+    ("frame_mean", 22, "<u2"),
+    ("fpa_temp_counts", 23, "<u2"),
+    ("fpa_temp_k100", 24, "<u2"),
+    ("housing_temp_counts", 25, "<u2"),
+    ("housing_temp_k100", 26, "<u2"),
+    ("last_ffc_fpa_temp_k100", 29, "<u2"),
+    ("last_ffc_ms", 30, "<u4"),
+    ("last_ffc_housing_temp_k100", 32, "<u2"),
+    ("agc_roi", 34, ("<u2", 4)),
+    ("video_format", 72, "<u4"),
+    ("emissivity", 99, "<u2"),
+    ("background_temp_k100", 100, "<u2"),
+    ("atm_transmission", 101, "<u2"),
+    ("atm_temp_k100", 102, "<u2"),
+    ("window_transmission", 103, "<u2"),
+    ("window_reflection", 104, "<u2"),
+    ("window_temp_k100", 105, "<u2"),
+    ("window_refl_temp_k100", 106, "<u2"),
+    ("gain_mode", 165, "<u2"),
+    ("effective_gain_mode", 166, "<u2"),
+    ("tlinear_enable", 208, "<u2"),
+    ("tlinear_resolution", 209, "<u2"),
+    ("spot_mean", 210, "<u2"),
+    ("spot_max", 211, "<u2"),
+    ("spot_min", 212, "<u2"),
+    ("spot_population", 213, "<u2"),
+    ("spot_roi", 214, ("<u2", 4)),
+]
+TELEMETRY_DTYPE = np.dtype(
+    {
+        "names": [f[0] for f in TELEMETRY_FIELDS],
+        "formats": [f[2] for f in TELEMETRY_FIELDS],
+        "offsets": [f[1] * 2 for f in TELEMETRY_FIELDS],
+        "itemsize": 480,
+    }
+)
+
+# Telemetry status bits
+TEL_STATUS_FFC_DESIRED = 0x00000008
+TEL_STATUS_FFC_STATE = 0x00000030
+TEL_STATUS_AGC_STATE = 0x00001000
+
+# Radiometric (TLinear) pixel resolution for the tlinear_resolution telemetry field
+TLINEAR_RESOLUTION = (0.1, 0.01)
+
+
+def image_array(image):
+    """
+    image_array()
+
+    Returns the pixels of a json image as a 120x160 uint16 array and the telemetry as a TELEMETRY_DTYPE record
+    (None if the image doesn't include it).  Both are views of the base64 decoded data (except the pixels of AGC8
+    images which are expanded from 8-bit pixels).  The json text of a JsonImage from TCam is not parsed.
+    """
+    if isinstance(image, JsonImage):
+        img = image.get_data("radiometric")
+        try:
+            telem_data = image.get_data("telemetry")
+        except KeyError:
+            telem_data = None
+    else:
+        img = base64.b64decode(image["radiometric"])
+        telem_data = base64.b64decode(image["telemetry"]) if "telemetry" in image else None
+        if image.get("metadata", {}).get("AGC8"):
+            img = np.frombuffer(img, dtype=np.uint8).astype("<u2").tobytes()
+    pixels = np.frombuffer(img, dtype="<u2").reshape(120, 160)
+    telem = None
+    if telem_data is not None:
+        telem = np.frombuffer(telem_data, dtype=TELEMETRY_DTYPE)[0]
+    return pixels, telem
+
+
+def binary_image_array(buf, ref=None):
+    """
+    binary_image_array()
+
+    Returns the pixels of a binary image as a height x width uint16 array, the telemetry as a TELEMETRY_DTYPE
+    record (None if the image doesn't include it) and the metadata dict.  A raw image and the telemetry are views
+    of buf.  Delta images are decoded against ref, the pixel array of the previous image.  Sparse images have 0 for
+    the pixels below their threshold (metadata "Threshold").  Raises ValueError for a delta image without a
+    reference.
+    """
+    _, _, hdr_len, payload_len, width, height, meta_len, telem_len = BIN_IMAGE_HEADER.unpack_from(buf)
+    meta, encoding = get_binary_image_metadata(buf)
+    img_start = hdr_len + meta_len
+    img_end = hdr_len + payload_len - telem_len
+
+    if encoding == BIN_ENC_RAW:
+        pixels = np.frombuffer(buf, dtype="<u2", count=width * height, offset=img_start)
+    elif encoding == BIN_ENC_AGC8:
+        pixels = np.frombuffer(buf, dtype=np.uint8, count=width * height, offset=img_start).astype(np.uint16)
+    elif encoding == BIN_ENC_RICE:
+        pixels = np.array(rice_decode_image(buf[img_start:img_end], width, height), dtype=np.uint16)
+    elif encoding == BIN_ENC_RICE_DELTA:
+        if ref is None:
+            raise ValueError("delta image without a reference image")
+        ref = np.asarray(ref).ravel().tolist()
+        pixels = np.array(rice_decode_image(buf[img_start:img_end], width, height, ref), dtype=np.uint16)
+    elif encoding == BIN_ENC_SPARSE:
+        meta["Threshold"], spans = SPARSE_HEADER.unpack_from(buf, img_start)
+        pixels = np.zeros(width * height, dtype=np.uint16)
+        pos = img_start + SPARSE_HEADER.size
+        for _ in range(spans):
+            start, count = SPARSE_HEADER.unpack_from(buf, pos)
+            pos += SPARSE_HEADER.size
+            pixels[start : start + count] = np.frombuffer(buf, dtype="<u2", count=count, offset=pos)
+            pos += count * 2
+    else:
+        raise ValueError(f"unknown image encoding {encoding}")
+
+    telem = None
+    if telem_len == TELEMETRY_DTYPE.itemsize:
+        telem = np.frombuffer(buf, dtype=TELEMETRY_DTYPE, count=1, offset=img_end)[0]
+    return pixels.reshape(height, width), telem, meta
+
+
+def tcam_frame_array(buf, ref=None):
+    """
+    tcam_frame_array()
+
+    Returns the pixels of a tcam_frame.py frame as a height x width 16-bit array, the telemetry as a TELEMETRY_DTYPE
+    record (None if the frame doesn't include it) and the metadata dict.  Raw 16-bit pixels and little-endian
+    telemetry are views of buf.  Raises ValueError if the frame can't be decoded.
+    """
+    frame = TCamFrame(buf)
+    pixels = frame.pixels(ref)
+    telem = None
+    words = frame.telemetry_words()
+    if words is not None and words.nbytes >= TELEMETRY_DTYPE.itemsize:
+        telem = words[: TELEMETRY_DTYPE.itemsize // 2].view(TELEMETRY_DTYPE)[0]
+    return pixels, telem, frame.metadata()
+
+
+class FrameDecoder:
+    """
+    FrameDecoder - Decode the frames from a camera (json images, binary images or tcam_frame.py frames) into numpy
+    arrays, keeping the reference for delta images.  Use one decoder per camera and decode every frame in the order received.
+    """
+
+    def __init__(self):
+        self.ref = None
+
+    def decode(self, frame):
+        """
+        decode()
+
+        Returns the pixel array, telemetry record (or None) and metadata dict of a frame.  Raises ValueError for a
+        delta image without a reference (call TCam.stream_resync()).
+        """
+        if isinstance(frame, (bytes, bytearray, memoryview)) and is_tcam_frame(frame):
+            pixels, telem, meta = tcam_frame_array(frame, self.ref)
+        elif isinstance(frame, (bytes, bytearray, memoryview)):
+            pixels, telem, meta = binary_image_array(frame, self.ref)
+        else:
+            pixels, telem = image_array(frame)
+            meta = frame.get("metadata", {})
+        self.ref = pixels
+        return pixels, telem, meta
+
+
+def pixel_resolution(telem=None):
+    """
+    pixel_resolution()
+
+    Returns the Kelvin per radiometric pixel count from the telemetry (0.01 K if it isn't available).
+    """
+    if telem is None or not telem["tlinear_enable"]:
+        return TLINEAR_RESOLUTION[1]
+    return TLINEAR_RESOLUTION[telem["tlinear_resolution"] & 1]
+
+
+def to_kelvin(pixels, telem=None):
+    """
+    to_kelvin()
+
+    Returns a float32 array of the temperatures (K) of a radiometric pixel array (or any array of pixel values,
+    for example a spotmeter value).
+    """
+    return np.multiply(pixels, pixel_resolution(telem), dtype=np.float32)
+
+
+def to_celsius(pixels, telem=None):
+    """
+    to_celsius()
+    """
+    return to_kelvin(pixels, telem) - np.float32(273.15)
+
+
+def to_fahrenheit(pixels, telem=None):
+    """
+    to_fahrenheit()
+    """
+    return to_celsius(pixels, telem) * np.float32(1.8) + np.float32(32)
+
+
+def palette_lut(palette):
+    """
+    palette_lut()
+
+    Returns a 256x3 uint8 lookup table for a palette name (see palettes) or a list of 256 [r, g, b] values.
+    """
+    if not isinstance(palette, str):
+        return np.asarray(palette, dtype=np.uint8)
+    return palettes.lut(palette)
+
+
+def apply_palette(pixels, palette="ironblack", vmin=None, vmax=None):
+    """
+    apply_palette()
+
+    Returns a height x width x 3 uint8 RGB image of a pixel array.  Pixel values from vmin to vmax (the image
+    minimum and maximum by default) are linearly mapped to the 256 palette entries and values outside the range
+    are clipped.  Use vmin=0 and vmax=255 for AGC images.
+    """
+    lut = palette_lut(palette)
+    pixels = np.asarray(pixels)
+    if vmin is None:
+        vmin = int(pixels.min())
+    if vmax is None:
+        vmax = int(pixels.max())
+    span = max(vmax - vmin, 1)
+    idx = (pixels.astype(np.int32) - vmin) * 255 // span
+    return lut[np.clip(idx, 0, 255)]
@@ -25,6 +25,8 @@
 #include "time_utilities.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/apps/sntp.h"
 #include "system_config.h"
 #include <stdlib.h>
 #include <time.h>
@@ -87,11 +89,16 @@ static const uint8_t monthDays[] = {31,28,31,30,31,30,31,31,30,31,30,31};
 //
 static const char* TAG = "time_utilities";
 
+// SNTP state (synced is set by the SNTP callback in the lwip task)
+static bool sntp_started = false;
+static volatile bool sntp_synced = false;
+
 
 //
 // Forward declarations for internal functions
 //
 time_t rtc_makeTime(const tmElements_t tm);
+static void time_sync_cb(struct timeval* tv);
 
 
  
@@ -154,17 +161,25 @@ void time_set(tmElements_t te)
  */
 void time_get(tmElements_t* te)
 {
-	time_t now;
 	struct timeval tv;
-	struct tm timeinfo;
 	
-	// Get the time and convert into our simplified tmElements format
 	(void) gettimeofday(&tv, NULL);
-	//time(&now);
-	now = tv.tv_sec;
+	time_get_at(((int64_t) tv.tv_sec * 1000000) + tv.tv_usec, te);
+}
+
+
+/**
+ * Convert a system time in uSec since 1970 into our simplified tmElements format
+ */
+void time_get_at(int64_t usec, tmElements_t* te)
+{
+	time_t now;
+	struct tm timeinfo;
+	
+	now = (time_t) (usec / 1000000);
     localtime_r(&now, &timeinfo);  // Get the unix formatted timeinfo
     mktime(&timeinfo);             // Fill in the DOW and DOY fields
-    te->Millisecond = (uint16_t) (tv.tv_usec / 1000);
+    te->Millisecond = (uint16_t) ((usec % 1000000) / 1000);
     te->Second = (uint8_t) timeinfo.tm_sec;
     te->Minute = (uint8_t) timeinfo.tm_min;
     te->Hour = (uint8_t) timeinfo.tm_hour;
@@ -175,6 +190,49 @@ void time_get(tmElements_t* te)
 }
 
 
+/**
+ * Return the system time (uSec since 1970) at an earlier esp_timer time.  The interval
+ * is measured on the esp_timer so a disciplined clock only affects the offset.
+ */
+int64_t time_timer_to_usec(int64_t timer_usec)
+{
+	struct timeval tv;
+	int64_t now_timer;
+	
+	(void) gettimeofday(&tv, NULL);
+	now_timer = esp_timer_get_time();
+	
+	return (((int64_t) tv.tv_sec * 1000000) + tv.tv_usec) - (now_timer - timer_usec);
+}
+
+
+/**
+ * Start disciplining the system time with SNTP.  Called each time a network
+ * connection is made as a client (SNTP is only started once and keeps polling).
+ */
+void time_start_sync()
+{
+	if (sntp_started) return;
+	sntp_started = true;
+	
+	ESP_LOGI(TAG, "Start SNTP with %s", TIME_SNTP_SERVER);
+	sntp_setoperatingmode(SNTP_OPMODE_POLL);
+	sntp_setservername(0, (char*) TIME_SNTP_SERVER);
+	sntp_set_sync_mode(SNTP_SYNC_MODE_SMOOTH);
+	sntp_set_time_sync_notification_cb(time_sync_cb);
+	sntp_init();
+}
+
+
+/**
+ * True once SNTP has set the system time
+ */
+bool time_is_synced()
+{
+	return sntp_synced;
+}
+
+
 /**
  * Return true if the system time (in seconds) has changed from the last time
  * this function returned true. Each calling task must maintain its own prev_time
@@ -268,10 +326,43 @@ void time_get_hhmm_string(tmElements_t te, char* buf)
 }
 
 
+/**
+ * Return te as mSec since 1970 (a timestamp for the same instant as the time & date
+ * strings generated from te)
+ */
+uint64_t time_get_msec(tmElements_t te)
+{
+	return ((uint64_t) rtc_makeTime(te) * 1000) + te.Millisecond;
+}
+
+
 
 //
 // Internal functions
 //
+
+/**
+ * SNTP has updated the system time - keep the RTC close to it
+ */
+static void time_sync_cb(struct timeval* tv)
+{
+	char buf[26];
+	tmElements_t te;
+	
+	time_get(&te);
+	time_get_disp_string(te, buf);
+	if (!sntp_synced) {
+		ESP_LOGI(TAG, "SNTP time: %s", buf);
+	}
+	sntp_synced = true;
+	
+#ifdef HAS_HW_RTC
+	if (write_rtc_time(te) != 0) {
+		ESP_LOGE(TAG, "Update RTC failed");
+	}
+#endif
+}
+
 time_t rtc_makeTime(const tmElements_t tm)
 {  
 	int i;
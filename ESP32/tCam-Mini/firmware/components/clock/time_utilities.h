@@ -4,6 +4,11 @@
  * Contains functions to interface the RTC to the system timekeeping
  * capabilities and provide application access to the system time.
  *
+ * When connected to a network as a client the system time is disciplined by SNTP
+ * (slewed rather than stepped once it is close) and the RTC is updated from it.
+ * esp_timer timestamps taken when events happen (for example the vsync that
+ * completed a frame) can be converted to system time later.
+ *
  * Copyright 2020 Dan Julio
  *
  * This file is part of tCam.
@@ -25,19 +30,33 @@
 #ifndef TIME_UTILITIES_H
 #define TIME_UTILITIES_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "ds3232.h"
 
 
+//
+// Time Utilities constants
+//
+
+// SNTP server used when connected to a network as a client
+#define TIME_SNTP_SERVER "pool.ntp.org"
+
+
 //
 // Time Utilities API
 //
 void time_init();
 void time_set(tmElements_t te);
 void time_get(tmElements_t* te);
+void time_get_at(int64_t usec, tmElements_t* te);
+int64_t time_timer_to_usec(int64_t timer_usec);
+void time_start_sync();
+bool time_is_synced();
 bool time_changed(tmElements_t* te, time_t* prev_time);
 void time_get_disp_string(tmElements_t te, char* buf);
 void time_get_short_string(tmElements_t te, char* buf);
 void time_get_hhmm_string(tmElements_t te, char* buf);
+uint64_t time_get_msec(tmElements_t te);
 
 #endif /* TIME_UTILITIES_H */
\ No newline at end of file
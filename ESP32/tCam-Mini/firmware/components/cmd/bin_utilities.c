@@ -0,0 +1,234 @@
+/*
+ * Binary image related utilities
+ *
+ * Contains functions to generate the compact binary image format negotiated with the
+ * set_image_format command as an alternative to the json/base64 image string.  See
+ * bin_utilities.h for the format.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "bin_utilities.h"
+#include "lepton_utilities.h"
+#include "system_config.h"
+#include "time_utilities.h"
+#include "wifi_utilities.h"
+#include "vospi.h"
+#include "esp_system.h"
+#include "esp_ota_ops.h"
+#include <stdio.h>
+#include <string.h>
+
+
+
+//
+// Binary Utilities Forward Declarations for internal functions
+//
+static uint8_t* bin_put_u16(uint8_t* p, uint16_t v);
+static uint8_t* bin_put_u32(uint8_t* p, uint32_t v);
+static uint8_t* bin_put_u64(uint8_t* p, uint64_t v);
+static uint8_t* bin_put_tlv(uint8_t* p, uint8_t* end, uint8_t type, const void* value, int len);
+static uint8_t* bin_put_tlv_string(uint8_t* p, uint8_t* end, uint8_t type, const char* s);
+static uint32_t bin_put_telem_fields(uint8_t* buf, uint16_t* tel_buf, uint8_t mask);
+
+
+
+//
+// Binary Utilities API
+//
+
+/**
+ * Load buf (at least BIN_MAX_IMAGE_HEADER_LEN bytes) with the header and metadata
+ * TLVs for a lepton image buffer holding a width x height image (the full frame or a
+ * cropped/binned view of it).  The image (image_len bytes using encoding) and
+ * telemetry (when bin_get_image_telem_len() is non-zero) follow.  A non-zero
+ * telem_mask (LEP_TEL_FLD_xxx) sends the selected telemetry fields in a TLV instead of
+ * the telemetry.  The time metadata is the time the frame was captured.  Returns the
+ * length of the data in buf.
+ */
+uint32_t bin_get_image_header(uint8_t* buf, lep_buffer_t* lep_buffer, uint16_t width, uint16_t height, uint8_t encoding, uint32_t image_len, uint8_t telem_mask)
+{
+	char s[80];
+	uint8_t* p;
+	uint8_t* end = buf + BIN_MAX_IMAGE_HEADER_LEN;
+	uint8_t t8;
+	uint8_t range[4];
+	uint8_t ts[8];
+	uint8_t fields[16];
+	uint8_t hist[(3 + LEP_HIST_BINS) * 2];
+	uint8_t* hp;
+	int i;
+	uint32_t meta_len;
+	uint32_t telem_len;
+	int64_t capture_usec;
+	const esp_app_desc_t* app_desc;
+	wifi_info_t* wifi_info;
+	tmElements_t te;
+
+	// Get system information and the time the frame was captured
+	app_desc = esp_ota_get_app_description();
+	wifi_info = wifi_get_info();
+	capture_usec = time_timer_to_usec(lep_buffer->vsync_usec);
+	time_get_at(capture_usec, &te);
+
+	// Metadata TLVs following the fixed length header
+	p = buf + BIN_IMAGE_HEADER_LEN;
+	p = bin_put_tlv_string(p, end, BIN_TLV_CAMERA, wifi_info->ap_ssid);
+	t8 = CAMERA_MODEL_NUM;
+	p = bin_put_tlv(p, end, BIN_TLV_MODEL, &t8, 1);
+	p = bin_put_tlv_string(p, end, BIN_TLV_VERSION, app_desc->version);
+	sprintf(s, "%d:%02d:%02d.%d", te.Hour, te.Minute, te.Second, te.Millisecond);
+	p = bin_put_tlv_string(p, end, BIN_TLV_TIME, s);
+	sprintf(s, "%d/%d/%02d", te.Month, te.Day, te.Year-30);  // Year starts at 1970
+	p = bin_put_tlv_string(p, end, BIN_TLV_DATE, s);
+	(void) bin_put_u64(ts, time_get_msec(te));
+	p = bin_put_tlv(p, end, BIN_TLV_TIMESTAMP, ts, 8);
+	(void) bin_put_u64(ts, (uint64_t) capture_usec);
+	p = bin_put_tlv(p, end, BIN_TLV_CAPTURE_USEC, ts, 8);
+	t8 = time_is_synced() ? 1 : 0;
+	p = bin_put_tlv(p, end, BIN_TLV_TIME_SYNC, &t8, 1);
+	(void) bin_put_u32(ts, lep_buffer->seq);
+	p = bin_put_tlv(p, end, BIN_TLV_SEQ, ts, 4);
+	(void) bin_put_u16(&range[0], lep_buffer->lep_min_val);
+	(void) bin_put_u16(&range[2], lep_buffer->lep_max_val);
+	p = bin_put_tlv(p, end, BIN_TLV_MIN_MAX, range, 4);
+	if (encoding != BIN_ENC_RAW) {
+		p = bin_put_tlv(p, end, BIN_TLV_ENCODING, &encoding, 1);
+	}
+	if ((telem_mask != 0) && lep_buffer->telem_valid) {
+		p = bin_put_tlv(p, end, BIN_TLV_TELEM_FIELDS, fields, bin_put_telem_fields(fields, lep_buffer->lep_telemP, telem_mask));
+	}
+	if (lep_buffer->avg_frames != 0) {
+		range[0] = lep_buffer->avg_frames;
+		range[1] = lep_buffer->avg_frac_bits;
+		p = bin_put_tlv(p, end, BIN_TLV_AVERAGE, range, 2);
+	}
+	if (lep_buffer->sync_tick_usec != 0) {
+		(void) bin_put_u64(ts, (uint64_t) lep_buffer->sync_tick_usec);
+		p = bin_put_tlv(p, end, BIN_TLV_SYNC_TICK, ts, 8);
+	}
+	if (lep_buffer->histP != NULL) {
+		hp = bin_put_u16(hist, lep_buffer->histP->p1);
+		hp = bin_put_u16(hp, lep_buffer->histP->p50);
+		hp = bin_put_u16(hp, lep_buffer->histP->p99);
+		for (i=0; i<LEP_HIST_BINS; i++) {
+			hp = bin_put_u16(hp, lep_buffer->histP->bins[i]);
+		}
+		p = bin_put_tlv(p, end, BIN_TLV_HISTOGRAM, hist, sizeof(hist));
+	}
+	meta_len = p - (buf + BIN_IMAGE_HEADER_LEN);
+
+	// Fixed length header
+	telem_len = bin_get_image_telem_len(lep_buffer, telem_mask);
+	p = buf;
+	*p++ = BIN_IMAGE_START;
+	*p++ = BIN_IMAGE_VERSION;
+	p = bin_put_u16(p, BIN_IMAGE_HEADER_LEN);
+	p = bin_put_u32(p, meta_len + image_len + telem_len);
+	p = bin_put_u16(p, width);
+	p = bin_put_u16(p, height);
+	p = bin_put_u16(p, meta_len);
+	(void) bin_put_u16(p, telem_len);
+
+	return BIN_IMAGE_HEADER_LEN + meta_len;
+}
+
+
+/**
+ * Return the number of telemetry bytes included with a binary image (none when only
+ * the telem_mask fields are sent)
+ */
+uint32_t bin_get_image_telem_len(lep_buffer_t* lep_buffer, uint8_t telem_mask)
+{
+	return (lep_buffer->telem_valid && (telem_mask == 0)) ? LEP_TEL_WORDS*2 : 0;
+}
+
+
+
+//
+// Binary Utilities internal functions
+//
+
+/**
+ * Store values little-endian, returning the next location
+ */
+static uint8_t* bin_put_u16(uint8_t* p, uint16_t v)
+{
+	*p++ = v & 0xFF;
+	*p++ = v >> 8;
+
+	return p;
+}
+
+
+static uint8_t* bin_put_u32(uint8_t* p, uint32_t v)
+{
+	p = bin_put_u16(p, v & 0xFFFF);
+	return bin_put_u16(p, v >> 16);
+}
+
+
+static uint8_t* bin_put_u64(uint8_t* p, uint64_t v)
+{
+	p = bin_put_u32(p, v & 0xFFFFFFFF);
+	return bin_put_u32(p, v >> 32);
+}
+
+
+/**
+ * Store a TLV if it fits, returning the next location
+ */
+static uint8_t* bin_put_tlv(uint8_t* p, uint8_t* end, uint8_t type, const void* value, int len)
+{
+	if ((len > 255) || ((p + 2 + len) > end)) return p;
+
+	*p++ = type;
+	*p++ = (uint8_t) len;
+	memcpy(p, value, len);
+
+	return p + len;
+}
+
+
+static uint8_t* bin_put_tlv_string(uint8_t* p, uint8_t* end, uint8_t type, const char* s)
+{
+	return bin_put_tlv(p, end, type, s, strlen(s));
+}
+
+
+/**
+ * Load buf with the BIN_TLV_TELEM_FIELDS value for the fields in mask, returning its
+ * length
+ */
+static uint32_t bin_put_telem_fields(uint8_t* buf, uint16_t* tel_buf, uint8_t mask)
+{
+	lep_tel_fields_t f;
+	uint8_t* p = buf;
+	
+	lepton_get_tel_fields(tel_buf, &f);
+	
+	*p++ = mask & LEP_TEL_FLD_ALL;
+	if (mask & LEP_TEL_FLD_FRAME_CNT) p = bin_put_u32(p, f.frame_cnt);
+	if (mask & LEP_TEL_FLD_FPA_TEMP)  p = bin_put_u16(p, f.fpa_t_k100);
+	if (mask & LEP_TEL_FLD_AUX_TEMP)  p = bin_put_u16(p, f.aux_t_k100);
+	if (mask & LEP_TEL_FLD_FFC)       *p++ = f.ffc_state | ((f.ffc_desired) ? 0x04 : 0);
+	if (mask & LEP_TEL_FLD_GAIN)      *p++ = f.gain_mode;
+	if (mask & LEP_TEL_FLD_TLIN)      *p++ = ((f.tlin_enabled) ? 0x01 : 0) | (f.tlin_res << 1);
+	
+	return p - buf;
+}
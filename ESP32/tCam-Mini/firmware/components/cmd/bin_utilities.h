@@ -0,0 +1,115 @@
+/*
+ * Binary image related utilities
+ *
+ * Contains functions to generate the compact binary image format negotiated with the
+ * set_image_format command as an alternative to the json/base64 image string.  A
+ * binary image consists of a fixed header followed by a payload containing metadata
+ * TLVs, the raw lepton image and, optionally, the raw lepton telemetry (or just the
+ * telemetry fields selected by a mask in a BIN_TLV_TELEM_FIELDS TLV).  The image and
+ * telemetry are sent directly from the shared lepton buffer so only the header and
+ * metadata are generated here.
+ *
+ * Binary image header (all multi-byte values little-endian)
+ *    0     : BIN_IMAGE_START
+ *    1     : BIN_IMAGE_VERSION
+ *    2 -  3: Header length (BIN_IMAGE_HEADER_LEN)
+ *    4 -  7: Payload length (bytes following the header)
+ *    8 -  9: Image width (pixels, less than LEP_WIDTH for cropped/binned streams)
+ *   10 - 11: Image height (pixels)
+ *   12 - 13: Metadata TLV length (bytes)
+ *   14 - 15: Telemetry length (bytes, 0 if not included)
+ *
+ * Payload
+ *   Metadata TLVs: Type (1 byte), Length (1 byte), Value (Length bytes)
+ *   Image: width * height 16-bit pixels or the encoded image specified by the
+ *          BIN_TLV_ENCODING TLV (image length is payload - metadata - telemetry
+ *          length)
+ *   Telemetry: 16-bit words
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef BIN_UTILITIES_H
+#define BIN_UTILITIES_H
+
+#include "sys_utilities.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+
+
+//
+// Binary Utilities constants
+//
+
+// Header
+#define BIN_IMAGE_START       0x01
+#define BIN_IMAGE_VERSION     1
+#define BIN_IMAGE_HEADER_LEN  16
+
+// Maximum header + metadata length
+#define BIN_MAX_IMAGE_HEADER_LEN 512
+
+// Metadata TLV types
+#define BIN_TLV_CAMERA        1     // String
+#define BIN_TLV_MODEL         2     // uint8_t
+#define BIN_TLV_VERSION       3     // String
+#define BIN_TLV_TIME          4     // String "H:MM:SS.ms"
+#define BIN_TLV_DATE          5     // String "M/D/YY"
+#define BIN_TLV_MIN_MAX       6     // uint16_t min, uint16_t max image value
+#define BIN_TLV_ENCODING      7     // uint8_t image encoding (raw if not included)
+#define BIN_TLV_TIMESTAMP     8     // uint64_t mSec since 1970 (same instant as TIME and DATE)
+#define BIN_TLV_JSON_META     9     // String: JSON object of any other metadata items (not
+                                    // generated by the camera, used by file converters)
+#define BIN_TLV_CAPTURE_USEC  10    // uint64_t uSec since 1970 of the vsync that completed the frame
+#define BIN_TLV_TIME_SYNC     11    // uint8_t 1 when the camera time is disciplined by SNTP, 0 otherwise
+#define BIN_TLV_SEQ           12    // uint32_t capture sequence number (gaps are frames never read)
+#define BIN_TLV_TELEM_FIELDS  13    // uint8_t LEP_TEL_FLD_xxx mask followed by the selected fields
+                                    // in bit order (sent instead of the telemetry):
+                                    //   FRAME_CNT: uint32_t Lepton frame counter
+                                    //   FPA_TEMP:  uint16_t K * 100
+                                    //   AUX_TEMP:  uint16_t K * 100
+                                    //   FFC:       uint8_t state (bits 1:0), desired (bit 2)
+                                    //   GAIN:      uint8_t effective gain mode (0: High, 1: Low)
+                                    //   TLIN:      uint8_t enabled (bit 0), 0.01 K resolution (bit 1)
+#define BIN_TLV_AVERAGE       14    // uint8_t frames averaged, uint8_t fractional bits (only included
+                                    // for averaged images: pixel / 2^bits is the mean raw value)
+#define BIN_TLV_SYNC_TICK     15    // uint64_t uSec since 1970 of the synchronized stream tick the image
+                                    // was selected for (only included for synchronized streams)
+#define BIN_TLV_HISTOGRAM     16    // uint16_t p1, p50, p99 pixel values followed by LEP_HIST_BINS
+                                    // uint16_t pixel counts of equal bins spanning the MIN_MAX
+                                    // range (only included with set_image_format hist)
+
+// Image encodings
+#define BIN_ENC_RAW           0
+#define BIN_ENC_RICE          1     // See rice_codec.h
+#define BIN_ENC_RICE_DELTA    2     // Delta against the previous image sent, see rice_codec.h
+#define BIN_ENC_PNG           3     // PNG file of the palette mapped image, see png_codec.h
+#define BIN_ENC_JPEG          4     // JPEG file of the palette mapped image, see jpeg_codec.h
+#define BIN_ENC_AGC8          5     // One byte per pixel (Lepton AGC output that fits in 8 bits)
+#define BIN_ENC_SPARSE        6     // Only the pixels at or above a threshold, see sparse_codec.h
+
+
+
+//
+// Binary Utilities API
+//
+uint32_t bin_get_image_header(uint8_t* buf, lep_buffer_t* lep_buffer, uint16_t width, uint16_t height, uint8_t encoding, uint32_t image_len, uint8_t telem_mask);
+uint32_t bin_get_image_telem_len(lep_buffer_t* lep_buffer, uint8_t telem_mask);
+
+#endif /* BIN_UTILITIES_H */
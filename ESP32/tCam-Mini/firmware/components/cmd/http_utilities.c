@@ -0,0 +1,360 @@
+/*
+ * HTTP and WebSocket related utilities
+ *
+ * Contains functions to parse the HTTP requests accepted on HTTP_PORT and generate
+ * the response headers and WebSocket framing for the HTTP endpoints.  See
+ * http_utilities.h for the endpoints.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "http_utilities.h"
+#include "mbedtls/base64.h"
+#include "mbedtls/sha1.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+
+
+//
+// HTTP Utilities constants
+//
+
+// Appended to the client's key to generate Sec-WebSocket-Accept (RFC 6455)
+#define WS_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+
+
+//
+// HTTP Utilities Forward Declarations for internal functions
+//
+static const char* http_status_text(int status);
+static int http_copy_token(char* dst, int dst_len, const char* src, const char* end);
+static const char* http_skip_spaces(const char* p, const char* end);
+
+
+
+//
+// HTTP Utilities API
+//
+
+/**
+ * Returns the length of the request header in buf including the blank line that ends
+ * it, 0 if the blank line hasn't been received yet
+ */
+int http_find_header_end(const char* buf, int len)
+{
+	int i;
+
+	for (i=3; i<len; i++) {
+		if ((buf[i] == '\n') && (buf[i-1] == '\r') && (buf[i-2] == '\n') && (buf[i-3] == '\r')) {
+			return i + 1;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * Parse the request line and the headers we use from a request header.  Returns
+ * false for a malformed request or one whose path or query is too long.
+ */
+bool http_parse_request(char* buf, int header_len, http_request_t* req)
+{
+	bool upgrade = false;
+	const char* p = buf;
+	const char* end = buf + header_len;
+	const char* line_end;
+	const char* target_end;
+	const char* q;
+	const char* v;
+	int n;
+
+	req->method = HTTP_METHOD_UNKNOWN;
+	req->path[0] = 0;
+	req->query[0] = 0;
+	req->ws_upgrade = false;
+	req->ws_key[0] = 0;
+	req->content_length = 0;
+
+	// Request line: method SP target SP version
+	if ((header_len > 4) && (strncmp(p, "GET ", 4) == 0)) {
+		req->method = HTTP_METHOD_GET;
+		p += 4;
+	} else if ((header_len > 5) && (strncmp(p, "POST ", 5) == 0)) {
+		req->method = HTTP_METHOD_POST;
+		p += 5;
+	} else {
+		while ((p < end) && (*p != ' ')) p++;
+		p = http_skip_spaces(p, end);
+	}
+
+	target_end = p;
+	while ((target_end < end) && (*target_end != ' ') && (*target_end != '\r')) target_end++;
+	q = p;
+	while ((q < target_end) && (*q != '?')) q++;
+	if (http_copy_token(req->path, HTTP_MAX_PATH_LEN, p, q) < 0) return false;
+	if (q < target_end) {
+		if (http_copy_token(req->query, HTTP_MAX_QUERY_LEN, q + 1, target_end) < 0) return false;
+	}
+	if (req->path[0] != '/') return false;
+
+	// Headers (names are case-insensitive)
+	while ((p < end) && (*p != '\n')) p++;
+	while (++p < end) {
+		line_end = p;
+		while ((line_end < end) && (*line_end != '\r') && (*line_end != '\n')) line_end++;
+
+		v = p;
+		while ((v < line_end) && (*v != ':')) v++;
+		n = v - p;
+		if (v < line_end) {
+			v = http_skip_spaces(v + 1, line_end);
+			if ((n == 7) && (strncasecmp(p, "Upgrade", 7) == 0)) {
+				upgrade = ((line_end - v) >= 9) && (strncasecmp(v, "websocket", 9) == 0);
+			} else if ((n == 17) && (strncasecmp(p, "Sec-WebSocket-Key", 17) == 0)) {
+				if (http_copy_token(req->ws_key, WS_KEY_LEN+1, v, line_end) < 0) return false;
+			} else if ((n == 14) && (strncasecmp(p, "Content-Length", 14) == 0)) {
+				req->content_length = atoi(v);
+				if (req->content_length < 0) return false;
+			}
+		}
+
+		p = line_end;
+		if ((p < end) && (*p == '\r')) p++;
+	}
+
+	req->ws_upgrade = upgrade && (req->ws_key[0] != 0);
+
+	return (req->method != HTTP_METHOD_UNKNOWN);
+}
+
+
+/**
+ * Copy the value of a query parameter (name=value pairs separated by '&') into val.
+ * Returns false if the parameter isn't included or its value doesn't fit.  Values
+ * aren't decoded since none of our values need escapes.
+ */
+bool http_get_query_param(const char* query, const char* name, char* val, int val_len)
+{
+	const char* p = query;
+	const char* e;
+	int n = strlen(name);
+
+	while (*p != 0) {
+		e = p;
+		while ((*e != 0) && (*e != '&')) e++;
+		if ((strncmp(p, name, n) == 0) && (p[n] == '=')) {
+			return (http_copy_token(val, val_len, p + n + 1, e) >= 0);
+		}
+		p = (*e == '&') ? e + 1 : e;
+	}
+
+	return false;
+}
+
+
+/**
+ * Load buf (at least HTTP_MAX_HEADER_LEN bytes) with a response header for a response
+ * that closes the connection.  content_type may be NULL when there is no body.
+ * Returns the header length.
+ */
+int http_get_response_header(char* buf, int status, const char* content_type, int content_len)
+{
+	int n;
+
+	n = snprintf(buf, HTTP_MAX_HEADER_LEN, "HTTP/1.1 %d %s\r\n", status, http_status_text(status));
+	if (content_type != NULL) {
+		n += snprintf(buf + n, HTTP_MAX_HEADER_LEN - n, "Content-Type: %s\r\n", content_type);
+	}
+	n += snprintf(buf + n, HTTP_MAX_HEADER_LEN - n, "Content-Length: %d\r\n"
+	              "Access-Control-Allow-Origin: *\r\nConnection: close\r\n\r\n", content_len);
+
+	return n;
+}
+
+
+/**
+ * Load buf (at least HTTP_MAX_HEADER_LEN bytes) with the response header starting the
+ * mjpeg stream.  Returns the header length.
+ */
+int http_get_mjpeg_header(char* buf)
+{
+	return snprintf(buf, HTTP_MAX_HEADER_LEN, "HTTP/1.1 200 OK\r\n"
+	                "Content-Type: multipart/x-mixed-replace; boundary=" HTTP_MJPEG_BOUNDARY "\r\n"
+	                "Cache-Control: no-cache\r\nConnection: close\r\n\r\n");
+}
+
+
+/**
+ * Load buf (at least HTTP_MAX_HEADER_LEN bytes) with the boundary and header of one
+ * image of the mjpeg stream.  The boundary starts with the line break ending the
+ * previous image.  Returns the header length.
+ */
+int http_get_mjpeg_part_header(char* buf, const char* content_type, uint32_t len)
+{
+	return snprintf(buf, HTTP_MAX_HEADER_LEN, "\r\n--" HTTP_MJPEG_BOUNDARY "\r\n"
+	                "Content-Type: %s\r\nContent-Length: %u\r\n\r\n", content_type, (unsigned int) len);
+}
+
+
+/**
+ * Load buf (at least HTTP_MAX_HEADER_LEN bytes) with the response header accepting a
+ * WebSocket upgrade for ws_key.  Returns the header length, 0 if the accept key can't
+ * be generated.
+ */
+int http_get_ws_accept_header(char* buf, const char* ws_key)
+{
+	char key[WS_KEY_LEN + sizeof(WS_GUID)];
+	unsigned char sha[20];
+	unsigned char accept[WS_ACCEPT_LEN+1];
+	size_t len;
+
+	strcpy(key, ws_key);
+	strcat(key, WS_GUID);
+	if (mbedtls_sha1_ret((const unsigned char*) key, strlen(key), sha) != 0) return 0;
+	if (mbedtls_base64_encode(accept, sizeof(accept), &len, sha, sizeof(sha)) != 0) return 0;
+	accept[len] = 0;
+
+	return snprintf(buf, HTTP_MAX_HEADER_LEN, "HTTP/1.1 101 Switching Protocols\r\n"
+	                "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+	                "Sec-WebSocket-Accept: %s\r\n\r\n", (char*) accept);
+}
+
+
+/**
+ * Parse a WebSocket frame header from the first len bytes of buf.  Returns the header
+ * length, 0 if more bytes are needed or -1 for a payload too long for us.
+ */
+int ws_parse_header(const uint8_t* buf, int len, ws_frame_t* f)
+{
+	int i;
+	int need = WS_MIN_HEADER_LEN;
+	uint8_t plen;
+	const uint8_t* p;
+
+	if (len < WS_MIN_HEADER_LEN) return 0;
+
+	plen = buf[1] & 0x7F;
+	if (plen == 126) {
+		need += 2;
+	} else if (plen == 127) {
+		need += 8;
+	}
+	if ((buf[1] & 0x80) != 0) need += 4;
+	if (len < need) return 0;
+
+	f->fin = ((buf[0] & 0x80) != 0);
+	f->opcode = buf[0] & 0x0F;
+	f->masked = ((buf[1] & 0x80) != 0);
+	p = &buf[2];
+	if (plen == 126) {
+		f->payload_len = (p[0] << 8) | p[1];
+		p += 2;
+	} else if (plen == 127) {
+		if ((p[0] | p[1] | p[2] | p[3]) != 0) return -1;
+		f->payload_len = (p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7];
+		p += 8;
+	} else {
+		f->payload_len = plen;
+	}
+	for (i=0; i<4; i++) {
+		f->mask[i] = (f->masked) ? *p++ : 0;
+	}
+
+	return need;
+}
+
+
+/**
+ * Load buf (at least WS_MAX_TX_HEADER_LEN bytes) with the header for an unmasked,
+ * unfragmented frame.  Returns the header length.
+ */
+int ws_put_header(uint8_t* buf, uint8_t opcode, uint32_t len)
+{
+	buf[0] = 0x80 | opcode;
+	if (len < 126) {
+		buf[1] = len;
+		return 2;
+	} else if (len < 65536) {
+		buf[1] = 126;
+		buf[2] = len >> 8;
+		buf[3] = len & 0xFF;
+		return 4;
+	} else {
+		buf[1] = 127;
+		buf[2] = 0;
+		buf[3] = 0;
+		buf[4] = 0;
+		buf[5] = 0;
+		buf[6] = len >> 24;
+		buf[7] = (len >> 16) & 0xFF;
+		buf[8] = (len >> 8) & 0xFF;
+		buf[9] = len & 0xFF;
+		return 10;
+	}
+}
+
+
+
+//
+// HTTP Utilities internal functions
+//
+static const char* http_status_text(int status)
+{
+	switch (status) {
+		case 200: return "OK";
+		case 204: return "No Content";
+		case 400: return "Bad Request";
+		case 404: return "Not Found";
+		case 405: return "Method Not Allowed";
+		case 409: return "Conflict";
+		case 413: return "Payload Too Large";
+		case 500: return "Internal Server Error";
+		case 503: return "Service Unavailable";
+		default:  return "Error";
+	}
+}
+
+
+/**
+ * Copy the text from src to end into dst as a string.  Returns the length or -1 if it
+ * doesn't fit.
+ */
+static int http_copy_token(char* dst, int dst_len, const char* src, const char* end)
+{
+	int n = end - src;
+
+	while ((n > 0) && (src[n-1] == ' ')) n--;
+	if (n >= dst_len) return -1;
+	memcpy(dst, src, n);
+	dst[n] = 0;
+
+	return n;
+}
+
+
+static const char* http_skip_spaces(const char* p, const char* end)
+{
+	while ((p < end) && ((*p == ' ') || (*p == '\t'))) p++;
+
+	return p;
+}
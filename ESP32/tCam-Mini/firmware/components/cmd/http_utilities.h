@@ -0,0 +1,124 @@
+/*
+ * HTTP and WebSocket related utilities
+ *
+ * Contains functions to parse the HTTP requests accepted on HTTP_PORT and generate
+ * the response headers for the three endpoints.
+ *
+ *   /mjpeg       multipart/x-mixed-replace stream of JPEG preview images (optional
+ *                query parameters palette=<name> and delay_msec=<n>)
+ *   /ws          WebSocket carrying the same commands (text messages, without the
+ *                delimitors), responses (text messages) and binary images, recording
+ *                data and segments (binary messages) as the command port
+ *   /api/<cmd>   REST mirror of the command set.  GET or POST with the command's
+ *                arguments as the json request body.  The response is the command's
+ *                json response (200) or no content (204).
+ *
+ * Only what the endpoints need is handled: one request per connection, no chunked
+ * request bodies and unfragmented WebSocket messages from the camera.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef HTTP_UTILITIES_H
+#define HTTP_UTILITIES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+
+//
+// HTTP Utilities constants
+//
+
+// Request methods
+#define HTTP_METHOD_UNKNOWN 0
+#define HTTP_METHOD_GET     1
+#define HTTP_METHOD_POST    2
+
+// Endpoints
+#define HTTP_PATH_MJPEG     "/mjpeg"
+#define HTTP_PATH_WS        "/ws"
+#define HTTP_PATH_API       "/api/"
+#define HTTP_PATH_OTA       "/ota"
+
+// Maximum request path and query lengths
+#define HTTP_MAX_PATH_LEN   48
+#define HTTP_MAX_QUERY_LEN  64
+
+// Maximum generated response header length
+#define HTTP_MAX_HEADER_LEN 160
+
+// Multipart boundary for the mjpeg stream
+#define HTTP_MJPEG_BOUNDARY "tcamframe"
+
+// WebSocket key lengths (base64 of 16 random bytes and of a SHA-1 hash)
+#define WS_KEY_LEN          24
+#define WS_ACCEPT_LEN       28
+
+// WebSocket opcodes
+#define WS_OP_CONT          0x0
+#define WS_OP_TEXT          0x1
+#define WS_OP_BIN           0x2
+#define WS_OP_CLOSE         0x8
+#define WS_OP_PING          0x9
+#define WS_OP_PONG          0xA
+
+// WebSocket frame header lengths (received frames are masked, sent frames aren't)
+#define WS_MIN_HEADER_LEN   2
+#define WS_MAX_RX_HEADER_LEN 14
+#define WS_MAX_TX_HEADER_LEN 10
+
+
+
+//
+// HTTP Utilities typedefs
+//
+typedef struct {
+	int method;
+	char path[HTTP_MAX_PATH_LEN];
+	char query[HTTP_MAX_QUERY_LEN];
+	bool ws_upgrade;                 // Upgrade: websocket with a key
+	char ws_key[WS_KEY_LEN+1];
+	int content_length;              // Request body length (0 if none)
+} http_request_t;
+
+typedef struct {
+	uint8_t opcode;
+	bool fin;
+	bool masked;
+	uint8_t mask[4];
+	uint32_t payload_len;
+} ws_frame_t;
+
+
+
+//
+// HTTP Utilities API
+//
+int http_find_header_end(const char* buf, int len);
+bool http_parse_request(char* buf, int header_len, http_request_t* req);
+bool http_get_query_param(const char* query, const char* name, char* val, int val_len);
+int http_get_response_header(char* buf, int status, const char* content_type, int content_len);
+int http_get_mjpeg_header(char* buf);
+int http_get_mjpeg_part_header(char* buf, const char* content_type, uint32_t len);
+int http_get_ws_accept_header(char* buf, const char* ws_key);
+int ws_parse_header(const uint8_t* buf, int len, ws_frame_t* f);
+int ws_put_header(uint8_t* buf, uint8_t opcode, uint32_t len);
+
+#endif /* HTTP_UTILITIES_H */
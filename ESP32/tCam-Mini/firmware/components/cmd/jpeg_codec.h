@@ -0,0 +1,66 @@
+/*
+ * Palette mapped baseline JPEG image codec
+ *
+ * Contains an encoder for preview images: 16-bit lepton images are linearly scaled
+ * into 8-bit palette indices (the same scaling as png_codec) and each index is
+ * converted to YCbCr through the palette.  The file is a baseline JFIF with the
+ * layout RTP/JPEG (RFC 2435) type 0 describes so the scan can be sent without its
+ * headers and rebuilt by any receiver from the quality alone.
+ *
+ *   Layout
+ *     YCbCr 4:2:2 (Y 2x1, Cb 1x1, Cr 1x1), 16x8 pixel MCUs, no restart markers
+ *     Quantization tables: Annex K tables scaled by quality (RFC 2435 Appendix A)
+ *     Huffman tables: the Annex K standard tables
+ *
+ *   File
+ *     SOI, APP0 (JFIF), DQT (2 tables), SOF0, DHT (4 tables), SOS, scan, EOI
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef JPEG_CODEC_H
+#define JPEG_CODEC_H
+
+#include <stdint.h>
+
+
+
+//
+// JPEG Codec constants
+//
+
+// Quality (1 - 99, also the RTP/JPEG Q value)
+#define JPEG_MIN_QUALITY  1
+#define JPEG_MAX_QUALITY  99
+#define JPEG_DEF_QUALITY  80
+
+// Image dimensions must be multiples of the MCU size
+#define JPEG_MCU_WIDTH    16
+#define JPEG_MCU_HEIGHT   8
+
+// RTP/JPEG type for the layout
+#define JPEG_RTP_TYPE     0
+
+
+
+//
+// JPEG Codec API
+//
+uint32_t jpeg_encode_image(const uint16_t* img, int width, int height, const uint8_t* palette, uint16_t lo, uint16_t hi, int quality, uint8_t* out, uint32_t max_len, uint32_t* scan_offset);
+
+#endif /* JPEG_CODEC_H */
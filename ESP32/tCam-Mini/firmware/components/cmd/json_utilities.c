@@ -7,7 +7,9 @@
  *
  * This module uses two pre-allocated buffers for the json text objects.  One for image
  * data (that can be stored as a file or sent to the host) and one for smaller responses
- * to the host.
+ * to the host.  The cJSON objects built while a command is processed are allocated
+ * from a pre-allocated arena that is emptied after the command (cJSON is only used by
+ * cmd_task).
  *
  * Be sure to read the requirements about freeing allocated buffers or objects in
  * the function description.  Or BOOM.
@@ -34,14 +36,28 @@
 #include "ps_utilities.h"
 #include "system_config.h"
 #include "lepton_utilities.h"
+#include "evlog_utilities.h"
+#include "ota_utilities.h"
+#include "perf_utilities.h"
 #include "time_utilities.h"
+#include "bin_utilities.h"
+#include "palette_utilities.h"
+#include "ana_task.h"
 #include "cmd_task.h"
+#include "hist_task.h"
+#include "lep_task.h"
+#include "mon_task.h"
+#include "now_task.h"
+#include "rec_task.h"
+#include "rsp_task.h"
 #include "vospi.h"
 #include "mbedtls/base64.h"
 #include "esp_system.h"
 #include "esp_ota_ops.h"
 #include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -67,34 +83,99 @@ const cmd_name_t command_list[CMD_NUM] = {
 	{CMD_STREAM_OFF_S, CMD_STREAM_OFF},
 	{CMD_RECORD_ON_S, CMD_RECORD_ON},
 	{CMD_RECORD_OFF_S, CMD_RECORD_OFF},
-	{CMD_POWEROFF_S, CMD_POWEROFF}
+	{CMD_POWEROFF_S, CMD_POWEROFF},
+	{CMD_SET_IMG_FMT_S, CMD_SET_IMG_FMT},
+	{CMD_STREAM_RESYNC_S, CMD_STREAM_RESYNC},
+	{CMD_GET_PERF_STATS_S, CMD_GET_PERF_STATS},
+	{CMD_GET_RECORD_INFO_S, CMD_GET_RECORD_INFO},
+	{CMD_GET_RECORD_S, CMD_GET_RECORD},
+	{CMD_SET_INTERVAL_S, CMD_SET_INTERVAL},
+	{CMD_GET_SYS_STATS_S, CMD_GET_SYS_STATS},
+	{CMD_SET_ANALYTICS_S, CMD_SET_ANALYTICS},
+	{CMD_SET_HISTORY_S, CMD_SET_HISTORY},
+	{CMD_DUMP_HISTORY_S, CMD_DUMP_HISTORY},
+	{CMD_SET_ESPNOW_S, CMD_SET_ESPNOW},
+	{CMD_SET_LEPTON_S, CMD_SET_LEPTON},
+	{CMD_SET_FFC_S, CMD_SET_FFC},
+	{CMD_RUN_FFC_S, CMD_RUN_FFC},
+	{CMD_CALIBRATE_SPI_S, CMD_CALIBRATE_SPI},
+	{CMD_SCAN_WIFI_S, CMD_SCAN_WIFI},
+	{CMD_BATCH_S, CMD_BATCH},
+	{CMD_SUBSCRIBE_STATUS_S, CMD_SUBSCRIBE_STATUS},
+	{CMD_GET_OTA_INFO_S, CMD_GET_OTA_INFO},
+	{CMD_OTA_REBOOT_S, CMD_OTA_REBOOT},
+	{CMD_GET_LOG_INFO_S, CMD_GET_LOG_INFO},
+	{CMD_GET_LOG_S, CMD_GET_LOG},
+	{CMD_BURST_CAPTURE_S, CMD_BURST_CAPTURE}
 };
 
 
 
+//
+// JSON Utilities macros
+//
+// s must be a string literal (concatenating it with "" fails to compile for a pointer,
+// whose sizeof would not be the text's length)
+#define json_put_literal(p, end, s) json_put_text(p, end, "" s, sizeof(s) - 1)
+
+// Image json record text between the radiometric and telemetry data and at the end
+#define JSON_IMAGE_TELEM_START "\",\n\t\"telemetry\":\t\""
+#define JSON_IMAGE_END         "\"\n}"
+
+
+
 //
 // JSON Utilities variables
 //
 static const char* TAG = "json_utilities";
 
-static char* json_image_text;       // Loaded for combined image data
 static char* json_response_text;    // Loaded for response data
 
-static unsigned char* base64_lep_data;
-static unsigned char* base64_lep_telem_data;
+// Combined response of a batch command being assembled
+static char* json_batch_text;
+static uint32_t json_batch_len;
+static int json_batch_count;
+
+// cJSON allocation arena (see json_arena_reset)
+static uint8_t* json_arena;
+static uint32_t json_arena_used;
+static uint32_t json_arena_max;        // High water mark
+static uint32_t json_arena_overflows;  // Allocations that didn't fit and used the heap
+
+// Cached image metadata text that doesn't change between images (rebuilt if the
+// camera name changes) - the start of the image json record up to the time
+static char json_image_meta_prefix[JSON_MAX_IMAGE_META_PREFIX_LEN];
+static int json_image_meta_prefix_len;
+static char json_image_meta_ssid[PS_SSID_MAX_LEN+1];
 
 
 
 //
 // JSON Utilities Forward Declarations for internal functions
 //
-static bool json_add_lep_image_object(cJSON* parent, lep_buffer_t* lep_buffer);
-static void json_free_lep_base64_image();
-static bool json_add_lep_telem_object(cJSON* parent, lep_buffer_t* lep_buffer);
-static void json_free_lep_base64_telem();
-static bool json_add_metadata_object(cJSON* parent);
+static void json_update_image_meta_prefix();
+static char* json_put_image_head(char* p, char* end, lep_buffer_t* lep_buffer, bool agc8, uint8_t telem_mask);
+static char* json_put_image_tail(char* p, char* end, lep_buffer_t* lep_buffer, uint8_t telem_mask);
+static char* json_put_telem_fields(char* p, char* end, uint16_t* tel_buf, uint8_t mask);
+static char* json_put_hist(char* p, char* end, lep_buffer_t* lep_buffer);
+static char* json_put_text(char* p, char* end, const char* s, int len);
+static char* json_put_escaped_string(char* p, char* end, const char* s);
+static char* json_put_uint(char* p, char* end, uint32_t v, int min_digits);
+static char* json_put_bool(char* p, char* end, bool v);
+static char* json_put_uint64(char* p, char* end, uint64_t v);
+static char* json_put_base64(char* p, char* end, const void* data, int len);
+static const char* json_scan_token(const char* p, const char* end, const char* s, int len);
+static char* json_start_response(char** end);
+static char* json_finish_response(char* p, uint32_t* len);
+static char* json_start_buf(char* buf, uint32_t max_len, char** end);
+static uint32_t json_finish_buf(char* buf, char* p);
+static void json_add_perf_stage(cJSON* parent, const char* name, int stage, bool inc_hist);
+static void json_add_heap_caps(cJSON* parent, const char* name, uint32_t caps);
+static void* json_arena_malloc(size_t sz);
+static void json_arena_free(void* p);
 static int json_generate_response_string(cJSON* root);
 static bool json_ip_string_to_array(uint8_t* ip_array, char* ip_string);
+static bool json_mac_string_to_array(uint8_t* mac_array, char* mac_string);
 
 
 
@@ -107,23 +188,46 @@ static bool json_ip_string_to_array(uint8_t* ip_array, char* ip_string);
  */
 bool json_init()
 {
-	// Get memory for the json text output strings
-	json_image_text = heap_caps_malloc(JSON_MAX_IMAGE_TEXT_LEN, MALLOC_CAP_8BIT);
-	if (json_image_text == NULL) {
-		ESP_LOGE(TAG, "Could not allocate json_image_text buffer");
+	// Get memory for the json text output string
+	json_response_text = system_buffer_alloc("json response", 0, JSON_MAX_RSP_TEXT_LEN, SYS_BUF_INTERNAL);
+	if (json_response_text == NULL) {
+		ESP_LOGE(TAG, "Could not allocate json_response_text buffer");
+		return false;
+	}
+	json_batch_text = system_buffer_alloc("json batch", 0, JSON_MAX_RSP_TEXT_LEN, SYS_BUF_INTERNAL);
+	if (json_batch_text == NULL) {
+		ESP_LOGE(TAG, "Could not allocate json_batch_text buffer");
 		return false;
 	}
 	
-	json_response_text = heap_caps_malloc(JSON_MAX_RSP_TEXT_LEN, MALLOC_CAP_8BIT);
-	if (json_response_text == NULL) {
-		ESP_LOGE(TAG, "Could not allocate json_response_text buffer");
+	// Get memory for the cJSON objects and install the allocator that uses it
+	json_arena = system_buffer_alloc("json arena", 0, JSON_ARENA_LEN, SYS_BUF_INTERNAL);
+	if (json_arena == NULL) {
+		ESP_LOGE(TAG, "Could not allocate json_arena buffer");
 		return false;
 	}
+	json_arena_reset();
+	
+	cJSON_Hooks hooks = {
+		.malloc_fn = json_arena_malloc,
+		.free_fn = json_arena_free
+	};
+	cJSON_InitHooks(&hooks);
 	
 	return true;
 }
 
 
+/**
+ * Empty the cJSON allocation arena.  Called after each command is processed when none
+ * of the cJSON objects allocated for it exist any longer.
+ */
+void json_arena_reset()
+{
+	json_arena_used = 0;
+}
+
+
 /**
  * Create a json command object from a string, returns NULL if it fails.  The object
  * will need to be freed using json_free_cmd when it is no longer necessary.
@@ -134,6 +238,52 @@ cJSON* json_get_cmd_object(char* json_string)
 }
 
 
+/**
+ * Recognize a command without arguments ({"cmd":"<name>"} with any whitespace) without
+ * building a cJSON object.  Returns true and the command number (CMD_UNKNOWN for an
+ * unknown name) if json_string is in that form, false if it has to be parsed with
+ * json_get_cmd_object.
+ */
+bool json_scan_cmd(const char* json_string, int len, int* cmd)
+{
+	const char* p = json_string;
+	const char* end = json_string + len;
+	const char* name;
+	int name_len;
+	int i;
+	
+	p = json_scan_token(p, end, "{", 1);
+	p = json_scan_token(p, end, "\"cmd\"", 5);
+	p = json_scan_token(p, end, ":", 1);
+	p = json_scan_token(p, end, "\"", 1);
+	if (p == NULL) return false;
+	
+	// Command names never contain escapes
+	name = p;
+	while ((p < end) && (*p != '"')) {
+		if (*p++ == '\\') return false;
+	}
+	name_len = p - name;
+	
+	p = json_scan_token(p, end, "\"", 1);
+	p = json_scan_token(p, end, "}", 1);
+	if (p == NULL) return false;
+	while ((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n'))) p++;
+	if (p != end) return false;
+	
+	*cmd = CMD_UNKNOWN;
+	for (i=0; i<CMD_NUM; i++) {
+		if ((strncmp(name, command_list[i].cmd_name, name_len) == 0) &&
+		    (command_list[i].cmd_name[name_len] == 0)) {
+			*cmd = command_list[i].cmd_index;
+			break;
+		}
+	}
+	
+	return true;
+}
+
+
 /**
  * Update a formatted json string in a pre-allocated json text image buffer containing
  * three json objects for a lepton image buffer.  Returns a non-zero length for a successful
@@ -142,48 +292,80 @@ cJSON* json_get_cmd_object(char* json_string)
  *   - Base64 encoded raw image from the Lepton
  *   - Base64 encoded telemetry from the Lepton
  *
- * This function handles its own memory management.
+ * The record is written directly into json_image_text (which must hold at least
+ * JSON_MAX_IMAGE_TEXT_LEN-2 bytes, leaving room for delimitors) in the same layout
+ * cJSON_Print generates.  Nothing is allocated.
  */
 uint32_t json_get_image_file_string(char* json_image_text, lep_buffer_t* lep_buffer)
 {
-	bool success;
-	int len = 0;
-	cJSON* root;
-	
-	root = cJSON_CreateObject();
-	if (root == NULL) return 0;
+	char* p = json_image_text;
+	char* end = json_image_text + JSON_MAX_IMAGE_TEXT_LEN - 2;
 	
-	// Construct the json object
-	success = json_add_metadata_object(root);
-	if (success) {
-		success = json_add_lep_image_object(root, lep_buffer);
-		if (success) {
-			success = json_add_lep_telem_object(root, lep_buffer);
-			if (!success) {
-				// Free lep_image that was already allocated
-				json_free_lep_base64_image();
-			}
-		}
-	}
+	p = json_put_image_head(p, end, lep_buffer, false, 0);
+	p = json_put_base64(p, end, lep_buffer->lep_bufferP, LEP_NUM_PIXELS*2);
+	p = json_put_image_tail(p, end, lep_buffer, 0);
 	
-	// Pretty-print the object to our buffer
-	if (success) {
-		if (cJSON_PrintPreallocated(root, json_image_text, JSON_MAX_IMAGE_TEXT_LEN, true) == 0) {
-			len = 0;
-		} else {
-			len = strlen(json_image_text);
-		}
-		
-		// Free the base-64 converted image strings
-		json_free_lep_base64_image();
-		json_free_lep_base64_telem();
-	} else {
+	if (p == NULL) {
 		ESP_LOGE(TAG, "failed to create json image text");
+		return 0;
 	}
+	*p = 0;
 	
-	cJSON_Delete(root);
+	return p - json_image_text;
+}
+
+
+/**
+ * Routines to generate the image json record in pieces so it can be sent while it is
+ * encoded.  The record is the head (the metadata up to the start of the radiometric
+ * data), the base64 encoded image in one or more pieces (each a multiple of 3 bytes
+ * except the last so they join into one base64 string) and the tail (the telemetry and
+ * the end of the record).  Nothing is null-terminated.  Each returns the length written
+ * into buf or 0 if it doesn't fit in max_len bytes.  The head of an image sent with
+ * 8-bit pixels (agc8) says so in its metadata.  A non-zero telem_mask (LEP_TEL_FLD_xxx)
+ * puts the selected telemetry fields in the metadata and leaves the telemetry out of
+ * the tail.
+ */
+uint32_t json_get_image_head(char* buf, uint32_t max_len, lep_buffer_t* lep_buffer, bool agc8, uint8_t telem_mask)
+{
+	char* p = json_put_image_head(buf, buf + max_len, lep_buffer, agc8, telem_mask);
 	
-	return len;
+	return (p == NULL) ? 0 : (p - buf);
+}
+
+
+uint32_t json_get_image_base64(char* buf, uint32_t max_len, const void* data, uint32_t len)
+{
+	char* p;
+	
+	// json_put_base64 needs room for mbedtls' terminating null
+	if (max_len == 0) return 0;
+	p = json_put_base64(buf, buf + max_len - 1, data, len);
+	
+	return (p == NULL) ? 0 : (p - buf);
+}
+
+
+uint32_t json_get_image_tail(char* buf, uint32_t max_len, lep_buffer_t* lep_buffer, uint8_t telem_mask)
+{
+	char* p;
+	
+	if (max_len == 0) return 0;
+	p = json_put_image_tail(buf, buf + max_len - 1, lep_buffer, telem_mask);
+	
+	return (p == NULL) ? 0 : (p - buf);
+}
+
+
+/**
+ * Returns the length of the image json record tail (which doesn't depend on the
+ * telemetry values)
+ */
+uint32_t json_get_image_tail_len(uint8_t telem_mask)
+{
+	if (telem_mask != 0) return sizeof(JSON_IMAGE_END) - 1;
+	
+	return (sizeof(JSON_IMAGE_TELEM_START) - 1) + (((LEP_TEL_WORDS*2 + 2) / 3) * 4) + (sizeof(JSON_IMAGE_END) - 1);
 }
 
 
@@ -191,32 +373,31 @@ uint32_t json_get_image_file_string(char* json_image_text, lep_buffer_t* lep_buf
  * Return a formatted json string containing the camera's operating parameters in
  * response to the get_config commmand.  Include the delimitors since this string
  * will be sent via the socket interface
+ *
+ * The schema is fixed so the text is written directly into the response buffer in
+ * the same layout cJSON_PrintPreallocated generates.
  */
 char* json_get_config(uint32_t* len)
 {
-	cJSON* root;
-	cJSON* config;
+	char* p;
+	char* end;
 	json_config_t* lep_stP;
 	
 	// Get state
 	lep_stP = system_get_lep_st();
 	
-	// Create and add to the config object
-	root=cJSON_CreateObject();
-	if (root == NULL) return NULL;
-	
-	cJSON_AddItemToObject(root, "config", config=cJSON_CreateObject());
-	
-	cJSON_AddNumberToObject(config, "agc_enabled", (const double) lep_stP->agc_set_enabled);
-	cJSON_AddNumberToObject(config, "emissivity", (const double) lep_stP->emissivity);
-	cJSON_AddNumberToObject(config, "gain_mode", (const double) lep_stP->gain_mode);
-	
-	// Tightly print the object into our buffer with delimitors
-	*len = json_generate_response_string(root);
-	
-	cJSON_Delete(root);
-	
-	return json_response_text;
+	p = json_start_response(&end);
+	p = json_put_literal(p, end, "{\"config\":{\"agc_enabled\":");
+	p = json_put_uint(p, end, lep_stP->agc_set_enabled ? 1 : 0, 1);
+	p = json_put_literal(p, end, ",\"emissivity\":");
+	p = json_put_uint(p, end, lep_stP->emissivity, 1);
+	p = json_put_literal(p, end, ",\"gain_mode\":");
+	p = json_put_uint(p, end, lep_stP->gain_mode, 1);
+	p = json_put_literal(p, end, ",\"temporal_filter\":");
+	p = json_put_uint(p, end, lep_stP->temporal_filter, 1);
+	p = json_put_literal(p, end, "}}");
+	
+	return json_finish_response(p, len);
 }
 
 
@@ -224,37 +405,423 @@ char* json_get_config(uint32_t* len)
  * Return a formatted json string containing the system status in response to the
  * get_status command.  Include the delimitors since this string will be sent via
  * the socket interface.
+ *
+ * Like get_config the text is written directly into the response buffer.  The Lepton
+ * state comes from the telemetry cached by lep_task so status requests never wait
+ * for the I2C bus.  The requesting client's adaptive stream state is included when it
+ * has one.  Compact status (pushed to subscribe_status clients) leaves out the items
+ * that don't change (Camera, Model and Version) and the Date.
  */
-char* json_get_status(uint32_t* len)
+char* json_get_status(const rsp_adapt_status_t* adapt, bool compact, uint32_t* len)
 {
-	char buf[80];
-	cJSON* root;
-	cJSON* status;
+	char* p;
+	char* end;
 	wifi_info_t* wifi_infoP;
 	const esp_app_desc_t* app_desc;
 	tmElements_t te;
+	lep_tel_cache_t tel;
 	
 	// Get system information
 	app_desc = esp_ota_get_app_description();	
 	time_get(&te);
+	wifi_infoP = wifi_get_info();
+	lep_get_tel_cache(&tel);
+	
+	p = json_start_response(&end);
+	p = json_put_literal(p, end, "{\"status\":{");
+	if (!compact) {
+		p = json_put_literal(p, end, "\"Camera\":");
+		p = json_put_escaped_string(p, end, wifi_infoP->ap_ssid);
+		p = json_put_literal(p, end, ",\"Model\":");
+		p = json_put_uint(p, end, CAMERA_MODEL_NUM, 1);
+		p = json_put_literal(p, end, ",\"Version\":");
+		p = json_put_escaped_string(p, end, app_desc->version);
+		p = json_put_literal(p, end, ",");
+	}
 	
-	// Create and add to the metadata object
-	root=cJSON_CreateObject();
-	if (root == NULL) return NULL;
+	p = json_put_literal(p, end, "\"Time\":\"");
+	p = json_put_uint(p, end, te.Hour, 1);
+	p = json_put_literal(p, end, ":");
+	p = json_put_uint(p, end, te.Minute, 2);
+	p = json_put_literal(p, end, ":");
+	p = json_put_uint(p, end, te.Second, 2);
+	p = json_put_literal(p, end, ".");
+	p = json_put_uint(p, end, te.Millisecond, 1);
+	p = json_put_literal(p, end, "\"");
+	
+	if (!compact) {
+		p = json_put_literal(p, end, ",\"Date\":\"");
+		p = json_put_uint(p, end, te.Month, 1);
+		p = json_put_literal(p, end, "/");
+		p = json_put_uint(p, end, te.Day, 1);
+		p = json_put_literal(p, end, "/");
+		p = json_put_uint(p, end, tmYearToY2k(te.Year), 2);   // Year starts at 1970
+		p = json_put_literal(p, end, "\"");
+	}
+	
+	if (tel.valid) {
+		p = json_put_literal(p, end, ",\"Lepton\":{\"frame\":");
+		p = json_put_uint(p, end, tel.frame, 1);
+		p = json_put_literal(p, end, ",\"age_msec\":");
+		p = json_put_uint(p, end, (uint32_t) ((esp_timer_get_time() - tel.usec) / 1000), 1);
+		p = json_put_literal(p, end, ",\"fpa_t\":");
+		p = json_put_uint(p, end, tel.fpa_t_k100, 1);
+		p = json_put_literal(p, end, ",\"aux_t\":");
+		p = json_put_uint(p, end, tel.aux_t_k100, 1);
+		p = json_put_literal(p, end, ",\"ffc_state\":");
+		p = json_put_uint(p, end, (tel.status & LEP_STATUS_FFC_STATE) >> 4, 1);
+		p = json_put_literal(p, end, ",\"gain_mode\":");
+		p = json_put_uint(p, end, tel.gain_mode, 1);
+		p = json_put_literal(p, end, ",\"radiometric\":");
+		p = json_put_uint(p, end, tel.tlin_enabled ? 1 : 0, 1);
+		p = json_put_literal(p, end, "}");
+	}
 	
-	cJSON_AddItemToObject(root, "status", status=cJSON_CreateObject());
+	if (adapt->target_ms != 0) {
+		p = json_put_literal(p, end, ",\"Adapt\":{\"target_msec\":");
+		p = json_put_uint(p, end, adapt->target_ms, 1);
+		p = json_put_literal(p, end, ",\"latency_msec\":");
+		p = json_put_uint(p, end, adapt->latency_ms, 1);
+		p = json_put_literal(p, end, ",\"level\":");
+		p = json_put_uint(p, end, adapt->level, 1);
+		p = json_put_literal(p, end, ",\"max_level\":");
+		p = json_put_uint(p, end, adapt->max_level, 1);
+		p = json_put_literal(p, end, ",\"compress\":");
+		p = json_put_uint(p, end, adapt->compress ? 1 : 0, 1);
+		p = json_put_literal(p, end, ",\"bin\":");
+		p = json_put_uint(p, end, adapt->bin, 1);
+		p = json_put_literal(p, end, ",\"delay_msec\":");
+		p = json_put_uint(p, end, adapt->delay_ms, 1);
+		p = json_put_literal(p, end, "}");
+	}
+	p = json_put_literal(p, end, "}}");
 	
-	wifi_infoP = wifi_get_info();
-	cJSON_AddStringToObject(status, "Camera", wifi_infoP->ap_ssid);
+	return json_finish_response(p, len);
+}
+
+
+/**
+ * Return a formatted json string containing the metrics pushed after the status to
+ * subscribe_status clients that asked for them.  Include the delimitors since this
+ * string will be sent via the socket interface.
+ *
+ * Written directly into the response buffer, compactly so that it fits: the stages
+ * (count, total mSec and histogram) and counters are arrays in the PERF_STAGE_xxx and
+ * PERF_CNT_xxx order, the heap is the internal and SPI RAM free and minimum free
+ * bytes and the queue is the client's queued transmissions and response bytes.  The
+ * RSSI is only included when connected as a client.
+ */
+char* json_get_metrics(const rsp_queue_status_t* q, uint32_t* len)
+{
+	char* p;
+	char* end;
+	int i, j;
+	int rssi;
+	perf_stage_t s;
+	
+	p = json_start_response(&end);
+	p = json_put_literal(p, end, "{\"metrics\":{\"uptime_msec\":");
+	p = json_put_uint64(p, end, esp_timer_get_time() / 1000);
+	
+	p = json_put_literal(p, end, ",\"stages\":[");
+	for (i=0; i<PERF_NUM_STAGES; i++) {
+		perf_get_stage(i, &s);
+		if (i != 0) p = json_put_literal(p, end, ",");
+		p = json_put_literal(p, end, "[");
+		p = json_put_uint(p, end, s.count, 1);
+		p = json_put_literal(p, end, ",");
+		p = json_put_uint64(p, end, s.total_usec / 1000);
+		for (j=0; j<PERF_HIST_BUCKETS; j++) {
+			p = json_put_literal(p, end, ",");
+			p = json_put_uint(p, end, s.hist[j], 1);
+		}
+		p = json_put_literal(p, end, "]");
+	}
+	
+	p = json_put_literal(p, end, "],\"counters\":[");
+	for (i=0; i<PERF_NUM_COUNTERS; i++) {
+		if (i != 0) p = json_put_literal(p, end, ",");
+		p = json_put_uint(p, end, perf_get_counter(i), 1);
+	}
+	
+	p = json_put_literal(p, end, "],\"heap\":[");
+	p = json_put_uint(p, end, heap_caps_get_free_size(MALLOC_CAP_INTERNAL), 1);
+	p = json_put_literal(p, end, ",");
+	p = json_put_uint(p, end, heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL), 1);
+	p = json_put_literal(p, end, ",");
+	p = json_put_uint(p, end, heap_caps_get_free_size(MALLOC_CAP_SPIRAM), 1);
+	p = json_put_literal(p, end, ",");
+	p = json_put_uint(p, end, heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM), 1);
+	
+	p = json_put_literal(p, end, "],\"queue\":[");
+	p = json_put_uint(p, end, q->tx_items, 1);
+	p = json_put_literal(p, end, ",");
+	p = json_put_uint(p, end, q->rsp_bytes, 1);
+	p = json_put_literal(p, end, "]");
+	
+	if (wifi_get_rssi(&rssi)) {
+		p = json_put_literal(p, end, ",\"rssi\":");
+		if (rssi < 0) {
+			p = json_put_literal(p, end, "-");
+			rssi = -rssi;
+		}
+		p = json_put_uint(p, end, rssi, 1);
+	}
+	p = json_put_literal(p, end, "}}");
+	
+	return json_finish_response(p, len);
+}
+
+
+/**
+ * Start assembling the combined response of a batch command:
+ * {"batch":[<response>,<response>...]}
+ */
+void json_batch_start()
+{
+	json_batch_text[0] = CMD_JSON_STRING_START;
+	memcpy(&json_batch_text[1], "{\"batch\":[", 10);
+	json_batch_len = 11;
+	json_batch_count = 0;
+}
+
+
+/**
+ * Add a delimited response to the batch response.  Returns false if it doesn't fit.
+ */
+bool json_batch_add(const char* buf, uint32_t len)
+{
+	uint32_t n;
+	
+	if (len < 2) return true;
+	
+	// Responses are added without their delimitors, leaving room for the separator,
+	// the end of the batch, the stop delimitor and terminating null
+	n = len - 2;
+	if ((json_batch_len + 1 + n + 4) > JSON_MAX_RSP_TEXT_LEN) return false;
 	
-	cJSON_AddNumberToObject(status, "Model", CAMERA_MODEL_NUM);
+	if (json_batch_count++ != 0) {
+		json_batch_text[json_batch_len++] = ',';
+	}
+	memcpy(&json_batch_text[json_batch_len], &buf[1], n);
+	json_batch_len += n;
+	
+	return true;
+}
+
+
+/**
+ * Finish the batch response and set len to its length (0 if no responses were added).
+ * Returns the delimited response.
+ */
+char* json_batch_finish(uint32_t* len)
+{
+	if (json_batch_count == 0) {
+		*len = 0;
+	} else {
+		json_batch_text[json_batch_len++] = ']';
+		json_batch_text[json_batch_len++] = '}';
+		json_batch_text[json_batch_len++] = CMD_JSON_STRING_STOP;
+		json_batch_text[json_batch_len] = 0;
+		*len = json_batch_len;
+	}
+	
+	return json_batch_text;
+}
+
+
+/**
+ * Write a delimited ana_stats response for one frame's analytics into buf.  Each
+ * region is a compact [min, max, mean, hot row, hot column, alarms] array so all
+ * ANA_MAX_ROIS fit in one response.  Returns the length or 0 if it doesn't fit.
+ */
+uint32_t json_get_ana_stats(char* buf, uint32_t max_len, ana_stats_t* s)
+{
+	char* p;
+	char* end;
+	int i;
+	
+	p = json_start_buf(buf, max_len, &end);
+	p = json_put_literal(p, end, "{\"ana_stats\":{\"frame\":");
+	p = json_put_uint(p, end, s->frame, 1);
+	p = json_put_literal(p, end, ",\"radiometric\":");
+	p = json_put_uint(p, end, s->radiometric ? 1 : 0, 1);
+	p = json_put_literal(p, end, ",\"rois\":[");
+	for (i=0; i<s->num_rois; i++) {
+		if (i != 0) p = json_put_literal(p, end, ",");
+		p = json_put_literal(p, end, "[");
+		p = json_put_uint(p, end, s->roi[i].min, 1);
+		p = json_put_literal(p, end, ",");
+		p = json_put_uint(p, end, s->roi[i].max, 1);
+		p = json_put_literal(p, end, ",");
+		p = json_put_uint(p, end, s->roi[i].mean, 1);
+		p = json_put_literal(p, end, ",");
+		p = json_put_uint(p, end, s->roi[i].hot_r, 1);
+		p = json_put_literal(p, end, ",");
+		p = json_put_uint(p, end, s->roi[i].hot_c, 1);
+		p = json_put_literal(p, end, ",");
+		p = json_put_uint(p, end, s->roi[i].alarms, 1);
+		p = json_put_literal(p, end, "]");
+	}
+	p = json_put_literal(p, end, "]}}");
+	
+	return json_finish_buf(buf, p);
+}
+
+
+/**
+ * Write a delimited ana_event response for an alarm that became active or cleared
+ * into buf.  Returns the length or 0 if it doesn't fit.
+ */
+uint32_t json_get_ana_event(char* buf, uint32_t max_len, uint32_t frame, int roi, int alarm, bool active, uint32_t value)
+{
+	char* p;
+	char* end;
+	
+	p = json_start_buf(buf, max_len, &end);
+	p = json_put_literal(p, end, "{\"ana_event\":{\"frame\":");
+	p = json_put_uint(p, end, frame, 1);
+	p = json_put_literal(p, end, ",\"roi\":");
+	p = json_put_uint(p, end, roi, 1);
+	if (alarm == ANA_ALARM_HIGH) {
+		p = json_put_literal(p, end, ",\"alarm\":\"high\",\"active\":");
+	} else {
+		p = json_put_literal(p, end, ",\"alarm\":\"low\",\"active\":");
+	}
+	p = json_put_uint(p, end, active ? 1 : 0, 1);
+	p = json_put_literal(p, end, ",\"value\":");
+	p = json_put_uint(p, end, value, 1);
+	p = json_put_literal(p, end, "}}");
+	
+	return json_finish_buf(buf, p);
+}
+
+
+/**
+ * Write a delimited latency record into buf for an image sent to a client with a
+ * latency probe.  Returns the length or 0 if it doesn't fit.
+ */
+uint32_t json_get_latency(char* buf, uint32_t max_len, const rsp_latency_t* l)
+{
+	char* p;
+	char* end;
+	
+	p = json_start_buf(buf, max_len, &end);
+	p = json_put_literal(p, end, "{\"latency\":{\"seq\":");
+	p = json_put_uint(p, end, l->seq, 1);
+	p = json_put_literal(p, end, ",\"timestamp\":");
+	p = json_put_uint64(p, end, l->timestamp);
+	p = json_put_literal(p, end, ",\"capture_usec\":");
+	p = json_put_uint(p, end, l->capture_usec, 1);
+	p = json_put_literal(p, end, ",\"encode_usec\":");
+	p = json_put_uint(p, end, l->encode_usec, 1);
+	p = json_put_literal(p, end, ",\"send_start_usec\":");
+	p = json_put_uint(p, end, l->send_start_usec, 1);
+	p = json_put_literal(p, end, ",\"send_end_usec\":");
+	p = json_put_uint(p, end, l->send_end_usec, 1);
+	p = json_put_literal(p, end, "}}");
+	
+	return json_finish_buf(buf, p);
+}
+
+
+/**
+ * Write a delimited history response into buf announcing the number of binary images
+ * (records) and bytes of a history dump that follow.  Returns the length or 0 if it
+ * doesn't fit.
+ */
+uint32_t json_get_history_dump(char* buf, uint32_t max_len, uint32_t records, uint32_t length)
+{
+	char* p;
+	char* end;
+	
+	p = json_start_buf(buf, max_len, &end);
+	p = json_put_literal(p, end, "{\"history\":{\"records\":");
+	p = json_put_uint(p, end, records, 1);
+	p = json_put_literal(p, end, ",\"length\":");
+	p = json_put_uint(p, end, length, 1);
+	p = json_put_literal(p, end, ",\"seconds\":");
+	p = json_put_uint(p, end, hist_get_seconds(), 1);
+	p = json_put_literal(p, end, "}}");
+	
+	return json_finish_buf(buf, p);
+}
+
+
+/**
+ * Load buf with the delimited burst response announcing the records of a burst that
+ * follow it (records is 0 if the burst couldn't start).  Returns the length (0 if it
+ * doesn't fit).
+ */
+uint32_t json_get_burst_dump(char* buf, uint32_t max_len, uint32_t records, uint32_t length, uint32_t missed, bool complete)
+{
+	char* p;
+	char* end;
+	
+	p = json_start_buf(buf, max_len, &end);
+	p = json_put_literal(p, end, "{\"burst\":{\"records\":");
+	p = json_put_uint(p, end, records, 1);
+	p = json_put_literal(p, end, ",\"length\":");
+	p = json_put_uint(p, end, length, 1);
+	p = json_put_literal(p, end, ",\"missed\":");
+	p = json_put_uint(p, end, missed, 1);
+	p = json_put_literal(p, end, ",\"complete\":");
+	p = json_put_uint(p, end, complete ? 1 : 0, 1);
+	p = json_put_literal(p, end, "}}");
+	
+	return json_finish_buf(buf, p);
+}
+
+
+/**
+ * Return a formatted json string containing the pipeline performance statistics in
+ * response to the get_perf_stats command.  Include the delimitors since this string
+ * will be sent via the socket interface.
+ */
+char* json_get_perf_stats(uint32_t* len)
+{
+	int i;
+	cJSON* root;
+	cJSON* perf;
+	cJSON* crc;
 	
-	cJSON_AddStringToObject(status, "Version", app_desc->version);
+	root=cJSON_CreateObject();
+	if (root == NULL) return NULL;
 	
-	sprintf(buf, "%d:%02d:%02d.%d", te.Hour, te.Minute, te.Second, te.Millisecond);
-	cJSON_AddStringToObject(status, "Time", buf);
-	sprintf(buf, "%d/%d/%02d", te.Month, te.Day, te.Year-30); // Year starts at 1970
-	cJSON_AddStringToObject(status, "Date", buf);
+	cJSON_AddItemToObject(root, "perf_stats", perf=cJSON_CreateObject());
+	
+	json_add_perf_stage(perf, "segment", PERF_STAGE_SEGMENT, true);
+	json_add_perf_stage(perf, "frame_copy", PERF_STAGE_FRAME_COPY, true);
+	json_add_perf_stage(perf, "json_encode", PERF_STAGE_JSON_ENC, true);
+	json_add_perf_stage(perf, "rice_encode", PERF_STAGE_RICE_ENC, true);
+	json_add_perf_stage(perf, "send", PERF_STAGE_SEND, true);
+	json_add_perf_stage(perf, "recovery", PERF_STAGE_RECOVER, false);
+	json_add_perf_stage(perf, "record_write", PERF_STAGE_REC_WRITE, true);
+	json_add_perf_stage(perf, "segment_send", PERF_STAGE_SEG_SEND, true);
+	json_add_perf_stage(perf, "png_encode", PERF_STAGE_PNG_ENC, true);
+	json_add_perf_stage(perf, "jpeg_encode", PERF_STAGE_JPEG_ENC, true);
+	json_add_perf_stage(perf, "response_send", PERF_STAGE_CMD_RSP, true);
+	
+	cJSON_AddNumberToObject(perf, "segment_retries", perf_get_counter(PERF_CNT_SEG_RETRY));
+	cJSON_AddNumberToObject(perf, "frames", perf_get_counter(PERF_CNT_FRAMES));
+	cJSON_AddNumberToObject(perf, "frames_reclaimed", perf_get_counter(PERF_CNT_FRAME_RECLAIM));
+	cJSON_AddNumberToObject(perf, "frames_dropped", perf_get_counter(PERF_CNT_FRAME_DROP));
+	cJSON_AddNumberToObject(perf, "frames_skipped", perf_get_counter(PERF_CNT_FRAME_SKIP));
+	cJSON_AddNumberToObject(perf, "send_failures", perf_get_counter(PERF_CNT_SEND_FAIL));
+	cJSON_AddItemToObject(perf, "crc_failures", crc=cJSON_CreateArray());
+	for (i=0; i<4; i++) {
+		cJSON_AddItemToArray(crc, cJSON_CreateNumber(perf_get_counter(PERF_CNT_CRC_FAIL_SEG1 + i)));
+	}
+	cJSON_AddNumberToObject(perf, "realigns", perf_get_counter(PERF_CNT_REALIGN));
+	cJSON_AddNumberToObject(perf, "resyncs", perf_get_counter(PERF_CNT_RESYNC));
+	cJSON_AddNumberToObject(perf, "resets", perf_get_counter(PERF_CNT_LEP_RESET));
+	cJSON_AddNumberToObject(perf, "segments_dropped", perf_get_counter(PERF_CNT_SEG_DROP));
+	cJSON_AddNumberToObject(perf, "frames_lost", perf_get_counter(PERF_CNT_FRAME_LOST));
+	cJSON_AddNumberToObject(perf, "images_encoded", perf_get_counter(PERF_CNT_IMAGES_ENC));
+	cJSON_AddNumberToObject(perf, "images_sent", perf_get_counter(PERF_CNT_IMAGES_SENT));
+	cJSON_AddNumberToObject(perf, "responses_dropped", perf_get_counter(PERF_CNT_RSP_DROP));
+	cJSON_AddNumberToObject(perf, "packets_dropped", perf_get_counter(PERF_CNT_PKT_DROP));
+	cJSON_AddNumberToObject(perf, "frames_held", perf_get_counter(PERF_CNT_FRAME_HELD));
 	
 	// Tightly print the object into our buffer with delimitors
 	*len = json_generate_response_string(root);
@@ -314,6 +881,9 @@ char* json_get_wifi(uint32_t* len)
 			                          wifi_infoP->cur_ip_addr[0]);
 	cJSON_AddStringToObject(wifi, "cur_ip_addr", ip_string);
 	
+	cJSON_AddNumberToObject(wifi, "ap_channel", (const double) wifi_get_ap_channel());
+	cJSON_AddNumberToObject(wifi, "ap_ht40", (const double) (wifi_get_ap_ht40() ? 1 : 0));
+	
 	// Tightly print the object into our buffer with delimitors
 	*len = json_generate_response_string(root);
 	
@@ -324,52 +894,402 @@ char* json_get_wifi(uint32_t* len)
 
 
 /**
- * Parse a top level command object, returning the command number and a pointer to 
- * a json object containing "args".  The pointer is set to NULL if there are no args.
+ * Return a formatted json string containing the image format selected for this
+ * connection in response to the set_image_format command so the host knows the
+ * camera supports the selected format.  PNG and JPEG images also include their palette
+ * and fixed range (if set).  JSON and raw binary images include agc8.  telem is the
+ * telemetry field mask for streamed images (0 = all the telemetry) and hist is set when
+ * images include their histogram.  Include the
+ * delimitors since this string will be sent via the socket interface.
  */
-bool json_parse_cmd(cJSON* cmd_obj, int* cmd, cJSON** cmd_args)
+char* json_get_image_format(int format, int palette, uint16_t lo, uint16_t hi, bool agc8, uint8_t telem_mask, bool hist, uint16_t threshold, uint32_t* len)
 {
-	 cJSON *cmd_type = cJSON_GetObjectItem(cmd_obj, "cmd");
-	 char* cmd_name;
-	 int i;
-	 
-	 if (cmd_type != NULL) {
-	 	cmd_name = cJSON_GetStringValue(cmd_type);
+	cJSON* root;
+	cJSON* image_format;
+	cJSON* range;
+	
+	root=cJSON_CreateObject();
+	if (root == NULL) return NULL;
+	
+	cJSON_AddItemToObject(root, "image_format", image_format=cJSON_CreateObject());
+	
+	cJSON_AddNumberToObject(image_format, "format", (const double) format);
+	
+	if ((format == RSP_IMG_FMT_PNG) || (format == RSP_IMG_FMT_JPEG)) {
+		cJSON_AddStringToObject(image_format, "palette", palette_get_name(palette));
+		if (hi != 0) {
+			cJSON_AddItemToObject(image_format, "range", range=cJSON_CreateArray());
+			cJSON_AddItemToArray(range, cJSON_CreateNumber((const double) lo));
+			cJSON_AddItemToArray(range, cJSON_CreateNumber((const double) hi));
+		}
+	} else if ((format == RSP_IMG_FMT_JSON) || (format == RSP_IMG_FMT_BIN)) {
+		cJSON_AddNumberToObject(image_format, "agc8", (const double) ((agc8) ? 1 : 0));
+	} else if (format == RSP_IMG_FMT_SPARSE) {
+		cJSON_AddNumberToObject(image_format, "threshold", (const double) threshold);
+	}
+	cJSON_AddNumberToObject(image_format, "telem", (const double) telem_mask);
+	cJSON_AddNumberToObject(image_format, "hist", (const double) ((hist) ? 1 : 0));
+	
+	// Tightly print the object into our buffer with delimitors
+	*len = json_generate_response_string(root);
+	
+	cJSON_Delete(root);
+	
+	return json_response_text;
+}
 
-	 	if (cmd_name != NULL) {
-	 		*cmd = CMD_UNKNOWN;
-	 		
-	 		for (i=0; i<CMD_NUM; i++) {
-	 			if (strcmp(cmd_name, command_list[i].cmd_name) == 0) {
-	 				*cmd = command_list[i].cmd_index;
-	 				break;
-	 			}
-	 		}
-	 		
-	 		*cmd_args = cJSON_GetObjectItem(cmd_obj, "args");
-	 		
-	 		return true;
-	 	}
-	 }
 
-	 return false;
+/**
+ * Return a formatted json string containing the recorder status in response to the
+ * get_record_info command.  Include the delimitors since this string will be sent via
+ * the socket interface.
+ */
+char* json_get_record_info(uint32_t* len)
+{
+	cJSON* root;
+	cJSON* record_info;
+	rec_info_t info;
+	
+	rec_get_info(&info);
+	
+	root=cJSON_CreateObject();
+	if (root == NULL) return NULL;
+	
+	cJSON_AddItemToObject(root, "record_info", record_info=cJSON_CreateObject());
+	
+	cJSON_AddNumberToObject(record_info, "recording", (const double) ((info.state == REC_STATE_RECORDING) ? 1 : 0));
+	cJSON_AddNumberToObject(record_info, "encoding", (const double) info.encoding);
+	cJSON_AddNumberToObject(record_info, "key_interval", (const double) info.key_interval);
+	cJSON_AddNumberToObject(record_info, "length", (const double) info.length);
+	cJSON_AddNumberToObject(record_info, "records", (const double) info.records);
+	cJSON_AddNumberToObject(record_info, "skipped", (const double) info.skipped);
+	cJSON_AddNumberToObject(record_info, "capacity", (const double) info.capacity);
+	
+	// Tightly print the object into our buffer with delimitors
+	*len = json_generate_response_string(root);
+	
+	cJSON_Delete(root);
+	
+	return json_response_text;
 }
 
 
 /**
- * Fill in a json_config_t struct with arguments from a set_config command, preserving
- * unmodified elements
+ * Return a formatted json string containing the event log status in response to the
+ * get_log_info command.  Include the delimitors since this string will be sent via
+ * the socket interface.
  */
-bool json_parse_set_config(cJSON* cmd_args, json_config_t* new_st)
+char* json_get_log_info(uint32_t* len)
 {
-	int item_count = 0;
-	json_config_t* lep_stP;
+	cJSON* root;
+	cJSON* log_info;
+	evlog_info_t info;
+	
+	evlog_get_info(&info);
+	
+	root=cJSON_CreateObject();
+	if (root == NULL) return NULL;
+	
+	cJSON_AddItemToObject(root, "log_info", log_info=cJSON_CreateObject());
+	
+	cJSON_AddNumberToObject(log_info, "size", (const double) info.size);
+	cJSON_AddNumberToObject(log_info, "sector_len", (const double) EVLOG_SECTOR_LEN);
+	cJSON_AddNumberToObject(log_info, "record_len", (const double) EVLOG_RECORD_LEN);
+	cJSON_AddNumberToObject(log_info, "boot", (const double) info.boot);
+	cJSON_AddNumberToObject(log_info, "sector", (const double) info.sector);
+	cJSON_AddNumberToObject(log_info, "written", (const double) info.written);
+	cJSON_AddNumberToObject(log_info, "queued", (const double) info.queued);
+	cJSON_AddNumberToObject(log_info, "suppressed", (const double) info.suppressed);
+	
+	// Tightly print the object into our buffer with delimitors
+	*len = json_generate_response_string(root);
+	
+	cJSON_Delete(root);
+	
+	return json_response_text;
+}
+
+
+/**
+ * Return a formatted json string containing the state of a network firmware update in
+ * response to the get_ota_info command.  Include the delimitors since this string will
+ * be sent via the socket interface.
+ */
+char* json_get_ota_info(uint32_t* len)
+{
+	cJSON* root;
+	cJSON* ota_info;
+	ota_info_t info;
+	const esp_app_desc_t* app_desc;
+	
+	ota_get_info(&info);
+	app_desc = esp_ota_get_app_description();
+	
+	root=cJSON_CreateObject();
+	if (root == NULL) return NULL;
+	
+	cJSON_AddItemToObject(root, "ota_info", ota_info=cJSON_CreateObject());
+	
+	cJSON_AddNumberToObject(ota_info, "state", (const double) info.state);
+	cJSON_AddNumberToObject(ota_info, "error", (const double) info.err);
+	cJSON_AddNumberToObject(ota_info, "size", (const double) info.size);
+	cJSON_AddNumberToObject(ota_info, "received", (const double) info.received);
+	cJSON_AddNumberToObject(ota_info, "written", (const double) info.written);
+	cJSON_AddNumberToObject(ota_info, "capacity", (const double) info.max_size);
+	cJSON_AddStringToObject(ota_info, "running", app_desc->version);
+	cJSON_AddStringToObject(ota_info, "update", info.version);
+	
+	// Tightly print the object into our buffer with delimitors
+	*len = json_generate_response_string(root);
+	
+	cJSON_Delete(root);
+	
+	return json_response_text;
+}
+
+
+/**
+ * Return a formatted json string containing the interval capture settings and their
+ * estimated Lepton power and latency trade-off in response to the set_interval_capture
+ * command.  Include the delimitors since this string will be sent via the socket
+ * interface.
+ */
+char* json_get_interval_capture(uint32_t* len)
+{
+	cJSON* root;
+	cJSON* interval_capture;
+	lep_interval_t info;
+	
+	lep_get_interval_capture(&info);
+	
+	root=cJSON_CreateObject();
+	if (root == NULL) return NULL;
+	
+	cJSON_AddItemToObject(root, "interval_capture", interval_capture=cJSON_CreateObject());
+	
+	cJSON_AddNumberToObject(interval_capture, "interval_msec", (const double) info.interval_msec);
+	cJSON_AddNumberToObject(interval_capture, "num_frames", (const double) info.num_frames);
+	cJSON_AddNumberToObject(interval_capture, "settle_msec", (const double) info.settle_msec);
+	cJSON_AddNumberToObject(interval_capture, "power_down", (const double) (info.power_down ? 1 : 0));
+	cJSON_AddNumberToObject(interval_capture, "awake_msec", (const double) info.awake_msec);
+	cJSON_AddNumberToObject(interval_capture, "latency_msec", (const double) info.latency_msec);
+	cJSON_AddNumberToObject(interval_capture, "lepton_mw", (const double) info.avg_power_mw);
+	
+	// Tightly print the object into our buffer with delimitors
+	*len = json_generate_response_string(root);
+	
+	cJSON_Delete(root);
+	
+	return json_response_text;
+}
+
+
+/**
+ * Return a formatted json string containing the FFC scheduler settings and state in
+ * response to the set_ffc command.  Include the delimitors since this string will be
+ * sent via the socket interface.
+ */
+char* json_get_ffc_schedule(uint32_t* len)
+{
+	cJSON* root;
+	cJSON* ffc;
+	lep_ffc_sched_t sched;
+	lep_ffc_status_t status;
+	
+	lep_get_ffc_schedule(&sched, &status);
+	
+	root=cJSON_CreateObject();
+	if (root == NULL) return NULL;
+	
+	cJSON_AddItemToObject(root, "ffc", ffc=cJSON_CreateObject());
+	
+	cJSON_AddNumberToObject(ffc, "mode", (const double) sched.mode);
+	cJSON_AddNumberToObject(ffc, "drift", (const double) sched.drift_k100);
+	cJSON_AddNumberToObject(ffc, "motion", (const double) sched.motion);
+	cJSON_AddNumberToObject(ffc, "quiet_msec", (const double) sched.quiet_msec);
+	cJSON_AddNumberToObject(ffc, "min_msec", (const double) sched.min_msec);
+	cJSON_AddNumberToObject(ffc, "max_wait_msec", (const double) sched.max_wait_msec);
+	cJSON_AddNumberToObject(ffc, "manual", (const double) (status.manual ? 1 : 0));
+	cJSON_AddNumberToObject(ffc, "due", (const double) (status.due ? 1 : 0));
+	cJSON_AddNumberToObject(ffc, "fpa_drift", (const double) status.drift_k100);
+	cJSON_AddNumberToObject(ffc, "since_ffc_msec", (const double) status.since_ffc_msec);
+	cJSON_AddNumberToObject(ffc, "num_quiet", (const double) status.num_quiet);
+	cJSON_AddNumberToObject(ffc, "num_forced", (const double) status.num_forced);
+	cJSON_AddNumberToObject(ffc, "num_approved", (const double) status.num_approved);
+	
+	// Tightly print the object into our buffer with delimitors
+	*len = json_generate_response_string(root);
+	
+	cJSON_Delete(root);
+	
+	return json_response_text;
+}
+
+
+/**
+ * Return a formatted json string containing the APs found by the background WiFi scan
+ * in response to the scan_wifi command.  Include the delimitors since this string will
+ * be sent via the socket interface.
+ */
+char* json_get_wifi_scan(uint32_t* len)
+{
+	char bssid[18];
+	int i, n;
+	cJSON* root;
+	cJSON* scan;
+	cJSON* aps;
+	cJSON* obj;
+	wifi_ap_record_t* ap;
+	
+	n = wifi_get_scan_records(&ap);
+	
+	root=cJSON_CreateObject();
+	if (root == NULL) return NULL;
+	
+	cJSON_AddItemToObject(root, "wifi_scan", scan=cJSON_CreateObject());
+	
+	cJSON_AddNumberToObject(scan, "complete", (const double) (wifi_scan_is_complete() ? 1 : 0));
+	cJSON_AddNumberToObject(scan, "channel", (const double) wifi_get_bg_scan_channel());
+	cJSON_AddItemToObject(scan, "aps", aps=cJSON_CreateArray());
+	for (i=0; i<n; i++) {
+		cJSON_AddItemToArray(aps, obj=cJSON_CreateObject());
+		cJSON_AddStringToObject(obj, "ssid", (const char*) ap[i].ssid);
+		sprintf(bssid, MACSTR, MAC2STR(ap[i].bssid));
+		cJSON_AddStringToObject(obj, "bssid", bssid);
+		cJSON_AddNumberToObject(obj, "channel", (const double) ap[i].primary);
+		cJSON_AddNumberToObject(obj, "rssi", (const double) ap[i].rssi);
+		cJSON_AddNumberToObject(obj, "auth", (const double) ap[i].authmode);
+	}
+	
+	// Tightly print the object into our buffer with delimitors
+	*len = json_generate_response_string(root);
+	
+	cJSON_Delete(root);
+	
+	return json_response_text;
+}
+
+
+/**
+ * Return a formatted json string containing the task profiler statistics and heap
+ * usage in response to the get_sys_stats command.  Include the delimitors since this
+ * string will be sent via the socket interface.
+ */
+char* json_get_sys_stats(uint32_t* len)
+{
+	int i;
+	cJSON* root;
+	cJSON* sys;
+	cJSON* obj;
+	cJSON* cores;
+	cJSON* tasks;
+	cJSON* hz;
+	cJSON* cal;
+	static mon_stats_t s;     // Too big for cmd_task's stack
+	
+	mon_get_stats(&s);
+	
+	root=cJSON_CreateObject();
+	if (root == NULL) return NULL;
+	
+	cJSON_AddItemToObject(root, "sys_stats", sys=cJSON_CreateObject());
+	
+	cJSON_AddNumberToObject(sys, "enabled", (const double) (s.enabled ? 1 : 0));
+	cJSON_AddNumberToObject(sys, "window_msec", (const double) (s.window_usec / 1000));
+	if (s.window_usec != 0) {
+		cJSON_AddItemToObject(sys, "cores", cores=cJSON_CreateArray());
+		for (i=0; i<portNUM_PROCESSORS; i++) {
+			cJSON_AddItemToArray(cores, cJSON_CreateNumber(s.core_load[i]));
+		}
+		
+		cJSON_AddItemToObject(sys, "tasks", tasks=cJSON_CreateObject());
+		for (i=0; i<s.num_tasks; i++) {
+			cJSON_AddItemToObject(tasks, s.tasks[i].name, obj=cJSON_CreateObject());
+			cJSON_AddNumberToObject(obj, "cpu", (const double) s.tasks[i].cpu);
+			cJSON_AddNumberToObject(obj, "stack", (const double) s.tasks[i].stack_free);
+		}
+		
+		cJSON_AddItemToObject(sys, "isr", obj=cJSON_CreateObject());
+		cJSON_AddNumberToObject(obj, "vsync_count", (const double) s.isr_count);
+		cJSON_AddNumberToObject(obj, "vsync_usec", (const double) s.isr_usec);
+	}
+	
+	cJSON_AddItemToObject(sys, "heap", obj=cJSON_CreateObject());
+	json_add_heap_caps(obj, "internal", MALLOC_CAP_INTERNAL);
+	json_add_heap_caps(obj, "dma", MALLOC_CAP_DMA);
+	json_add_heap_caps(obj, "spiram", MALLOC_CAP_SPIRAM);
+	
+	cJSON_AddItemToObject(sys, "json_arena", obj=cJSON_CreateObject());
+	cJSON_AddNumberToObject(obj, "size", (const double) JSON_ARENA_LEN);
+	cJSON_AddNumberToObject(obj, "max", (const double) json_arena_max);
+	cJSON_AddNumberToObject(obj, "overflows", (const double) json_arena_overflows);
+	
+	cJSON_AddItemToObject(sys, "spi", obj=cJSON_CreateObject());
+	cJSON_AddNumberToObject(obj, "calibrating", (const double) (lep_spi_cal_running() ? 1 : 0));
+	cJSON_AddItemToObject(obj, "hz", hz=cJSON_CreateArray());
+	cJSON_AddItemToObject(obj, "calibrated", cal=cJSON_CreateArray());
+	for (i=0; i<LEP_NUM_LEPTONS; i++) {
+		cJSON_AddItemToArray(hz, cJSON_CreateNumber(vospi_get_spi_freq(i)));
+		cJSON_AddItemToArray(cal, cJSON_CreateNumber((ps_get_spi_freq(i) != 0) ? 1 : 0));
+	}
+	
+	// Tightly print the object into our buffer with delimitors
+	*len = json_generate_response_string(root);
+	
+	cJSON_Delete(root);
+	
+	return json_response_text;
+}
+
+
+/**
+ * Parse a top level command object, returning the command number and a pointer to 
+ * a json object containing "args".  The pointer is set to NULL if there are no args.
+ */
+bool json_parse_cmd(cJSON* cmd_obj, int* cmd, cJSON** cmd_args)
+{
+	 cJSON *cmd_type = cJSON_GetObjectItem(cmd_obj, "cmd");
+	 char* cmd_name;
+	 int i;
+	 
+	 if (cmd_type != NULL) {
+	 	cmd_name = cJSON_GetStringValue(cmd_type);
+
+	 	if (cmd_name != NULL) {
+	 		*cmd = CMD_UNKNOWN;
+	 		
+	 		for (i=0; i<CMD_NUM; i++) {
+	 			if (strcmp(cmd_name, command_list[i].cmd_name) == 0) {
+	 				*cmd = command_list[i].cmd_index;
+	 				break;
+	 			}
+	 		}
+	 		
+	 		*cmd_args = cJSON_GetObjectItem(cmd_obj, "args");
+	 		
+	 		return true;
+	 	}
+	 }
+
+	 return false;
+}
+
+
+/**
+ * Fill in a json_config_t struct with arguments from a set_config command, preserving
+ * unmodified elements
+ */
+bool json_parse_set_config(cJSON* cmd_args, json_config_t* new_st)
+{
+	int item_count = 0;
+	json_config_t* lep_stP;
 	
 	// Get existing settings to be possibly overwritten by the command
 	lep_stP = system_get_lep_st();
 	new_st->agc_set_enabled = lep_stP->agc_set_enabled;
 	new_st->emissivity = lep_stP->emissivity;
 	new_st->gain_mode = lep_stP->gain_mode;
+	new_st->temporal_filter = lep_stP->temporal_filter;
 	
 	if (cmd_args != NULL) {
 		if (cJSON_HasObjectItem(cmd_args, "agc_enabled")) {
@@ -390,6 +1310,13 @@ bool json_parse_set_config(cJSON* cmd_args, json_config_t* new_st)
 			item_count++;
 		}
 		
+		if (cJSON_HasObjectItem(cmd_args, "temporal_filter")) {
+			new_st->temporal_filter = cJSON_GetObjectItem(cmd_args, "temporal_filter")->valueint;
+			if (new_st->temporal_filter < 0) new_st->temporal_filter = 0;
+			if (new_st->temporal_filter > LEP_TF_MAX_LEVEL) new_st->temporal_filter = LEP_TF_MAX_LEVEL;
+			item_count++;
+		}
+		
 		return (item_count > 0);
 	}
 	
@@ -445,6 +1372,96 @@ bool json_parse_set_spotmeter(cJSON* cmd_args, uint16_t* r1, uint16_t* c1, uint1
 }
 
 
+/**
+ * Get the set_image_format arguments.  palette and the range (lo, hi in K * 100) are
+ * used by PNG and JPEG images and default to PALETTE_DEFAULT and the range of each
+ * image (hi = 0).  agc8 (default off) is used by JSON and raw binary images.
+ * telem_mask selects the telemetry fields (LEP_TEL_FLD_xxx) sent with streamed images
+ * instead of the complete telemetry (default 0 sends the complete telemetry).  hist
+ * (default off) adds each image's histogram to its metadata.
+ */
+bool json_parse_set_image_format(cJSON* cmd_args, int* format, int* palette, uint16_t* lo, uint16_t* hi, bool* agc8, uint8_t* telem_mask, bool* hist, uint16_t* threshold)
+{
+	int i, l, h;
+	cJSON* range;
+	
+	*palette = PALETTE_DEFAULT;
+	*lo = 0;
+	*hi = 0;
+	*agc8 = false;
+	*telem_mask = 0;
+	*hist = false;
+	*threshold = 0;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "palette")) {
+			i = palette_find(cJSON_GetObjectItem(cmd_args, "palette")->valuestring);
+			if (i < 0) {
+				ESP_LOGE(TAG, "Unknown set_image_format palette");
+				return false;
+			}
+			*palette = i;
+		}
+		
+		range = cJSON_GetObjectItem(cmd_args, "range");
+		if (range != NULL) {
+			if (!cJSON_IsArray(range) || (cJSON_GetArraySize(range) != 2)) {
+				ESP_LOGE(TAG, "Illegal set_image_format range");
+				return false;
+			}
+			l = cJSON_GetArrayItem(range, 0)->valueint;
+			h = cJSON_GetArrayItem(range, 1)->valueint;
+			if ((l < 0) || (h <= l) || (h > 0xFFFF)) {
+				ESP_LOGE(TAG, "Illegal set_image_format range: %d %d", l, h);
+				return false;
+			}
+			*lo = l;
+			*hi = h;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "agc8")) {
+			*agc8 = (cJSON_GetObjectItem(cmd_args, "agc8")->valueint != 0);
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "telem")) {
+			i = cJSON_GetObjectItem(cmd_args, "telem")->valueint;
+			if ((i < 0) || ((i & ~LEP_TEL_FLD_ALL) != 0)) {
+				ESP_LOGE(TAG, "Illegal set_image_format telem: %d", i);
+				return false;
+			}
+			*telem_mask = (uint8_t) i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "hist")) {
+			*hist = (cJSON_GetObjectItem(cmd_args, "hist")->valueint != 0);
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "threshold")) {
+			i = cJSON_GetObjectItem(cmd_args, "threshold")->valueint;
+			if ((i <= 0) || (i > 0xFFFF)) {
+				ESP_LOGE(TAG, "Illegal set_image_format threshold: %d", i);
+				return false;
+			}
+			*threshold = (uint16_t) i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "format")) {
+			i = cJSON_GetObjectItem(cmd_args, "format")->valueint;
+			if ((i == RSP_IMG_FMT_SPARSE) && (*threshold == 0)) {
+				ESP_LOGE(TAG, "set_image_format sparse images need a threshold");
+				return false;
+			}
+			if ((i >= RSP_IMG_FMT_JSON) && (i <= RSP_IMG_FMT_SPARSE)) {
+				*format = i;
+				return true;
+			}
+		}
+	}
+	
+	return false;
+}
+
+
 /**
  * Fill in a tmElements object with arguments from a set_time command
  */
@@ -616,12 +1633,48 @@ bool json_parse_set_wifi(cJSON* cmd_args, wifi_info_t* new_wifi_info)
 
 
 /**
- * Get the stream_on arguments
+ * Get the stream_on arguments.  roi is loaded with the region of interest (r1, c1, r2,
+ * c2) and bin with the binning factor for binary images.  segments is set for a low
+ * latency stream of frame segments and raw for a stream of raw VoSPI packets.  rtp is
+ * set to send a UDP stream as RTP/JPEG packets.  trig is loaded with the optional motion trigger (threshold 0 if none).
+ * stats is set to 1 for a stream of analytics results instead of images or 2 for
+ * analytics results along with the images.  adapt_ms is loaded with the optional
+ * adaptive stream latency target (0 if none).  probe is set to follow each image with
+ * its latency record.  sync is set for a synchronized stream of the frames nearest
+ * each multiple of delay_ms since 1970.  cmd_priority is set to hold images back while
+ * a command response is waiting to be sent.
  */
-bool json_parse_stream_on(cJSON* cmd_args, uint32_t* delay_ms, uint32_t* num_frames)
+bool json_parse_stream_on(cJSON* cmd_args, uint32_t* delay_ms, uint32_t* num_frames, uint32_t* key_interval, uint16_t* udp_port, uint8_t* udp_addr, uint16_t* roi, int* bin, bool* segments, bool* raw, bool* rtp, rsp_trigger_t* trig, int* stats, uint32_t* adapt_ms, bool* probe, bool* sync, bool* cmd_priority)
 {
+	cJSON* obj;
+	char* s;
 	int i;
 	
+	// TCP stream to the connected client unless the optional UDP destination is specified
+	*udp_port = 0;
+	for (i=0; i<4; i++) udp_addr[i] = 0;
+	
+	// Full resolution images of the entire frame unless the optional roi or bin is specified
+	roi[0] = 0;
+	roi[1] = 0;
+	roi[2] = LEP_HEIGHT - 1;
+	roi[3] = LEP_WIDTH - 1;
+	*bin = 1;
+	*segments = false;
+	*raw = false;
+	*rtp = false;
+	*stats = 0;
+	*adapt_ms = 0;
+	*probe = false;
+	*sync = false;
+	*cmd_priority = false;
+	
+	// Every frame at the stream rate unless the optional motion trigger is specified
+	trig->threshold = 0;
+	trig->min_blocks = RSP_TRIG_DEF_BLOCKS;
+	trig->hold_ms = RSP_TRIG_DEF_HOLD_MSEC;
+	trig->heartbeat_ms = RSP_TRIG_DEF_HEARTBEAT_MSEC;
+	
 	if (cmd_args != NULL) {
 		if (cJSON_HasObjectItem(cmd_args, "delay_msec")) {
 			i = cJSON_GetObjectItem(cmd_args, "delay_msec")->valueint;
@@ -638,10 +1691,641 @@ bool json_parse_stream_on(cJSON* cmd_args, uint32_t* delay_ms, uint32_t* num_fra
 		} else {
 			*num_frames = 0;
 		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "key_interval")) {
+			i = cJSON_GetObjectItem(cmd_args, "key_interval")->valueint;
+			if (i < 0) i = 0;
+			*key_interval = i;
+		} else {
+			*key_interval = 0;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "udp_port")) {
+			i = cJSON_GetObjectItem(cmd_args, "udp_port")->valueint;
+			if ((i < 1) || (i > 65535)) {
+				ESP_LOGE(TAG, "Illegal stream_on udp_port: %d", i);
+				return false;
+			}
+			*udp_port = i;
+			
+			if (cJSON_HasObjectItem(cmd_args, "udp_addr")) {
+				s = cJSON_GetObjectItem(cmd_args, "udp_addr")->valuestring;
+				if ((s == NULL) || !json_ip_string_to_array(udp_addr, s)) {
+					ESP_LOGE(TAG, "Illegal stream_on udp_addr");
+					return false;
+				}
+			}
+			
+			if (cJSON_HasObjectItem(cmd_args, "rtp")) {
+				*rtp = (cJSON_GetObjectItem(cmd_args, "rtp")->valueint != 0);
+			}
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "roi")) {
+			// Same form as the set_spotmeter arguments
+			if (!json_parse_set_spotmeter(cJSON_GetObjectItem(cmd_args, "roi"), &roi[0], &roi[1], &roi[2], &roi[3])) {
+				ESP_LOGE(TAG, "Illegal stream_on roi");
+				return false;
+			}
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "bin")) {
+			i = cJSON_GetObjectItem(cmd_args, "bin")->valueint;
+			if (((i != 1) && (i != 2) && (i != 4)) || ((roi[2] - roi[0] + 1) < i) || ((roi[3] - roi[1] + 1) < i)) {
+				ESP_LOGE(TAG, "Illegal stream_on bin: %d", i);
+				return false;
+			}
+			*bin = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "segments")) {
+			*segments = (cJSON_GetObjectItem(cmd_args, "segments")->valueint != 0);
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "raw")) {
+			*raw = (cJSON_GetObjectItem(cmd_args, "raw")->valueint != 0);
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "stats")) {
+			i = cJSON_GetObjectItem(cmd_args, "stats")->valueint;
+			if ((i < 0) || (i > 2)) {
+				ESP_LOGE(TAG, "Illegal stream_on stats: %d", i);
+				return false;
+			}
+			*stats = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "adapt")) {
+			i = cJSON_GetObjectItem(cmd_args, "adapt")->valueint;
+			if ((i < 0) || (i > RSP_ADAPT_MAX_TARGET_MSEC)) {
+				ESP_LOGE(TAG, "Illegal stream_on adapt: %d", i);
+				return false;
+			}
+			*adapt_ms = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "probe")) {
+			*probe = (cJSON_GetObjectItem(cmd_args, "probe")->valueint != 0);
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "sync")) {
+			*sync = (cJSON_GetObjectItem(cmd_args, "sync")->valueint != 0);
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "cmd_priority")) {
+			*cmd_priority = (cJSON_GetObjectItem(cmd_args, "cmd_priority")->valueint != 0);
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "motion")) {
+			obj = cJSON_GetObjectItem(cmd_args, "motion");
+			if (cJSON_HasObjectItem(obj, "threshold")) {
+				i = cJSON_GetObjectItem(obj, "threshold")->valueint;
+				if ((i < 1) || (i > 65535)) {
+					ESP_LOGE(TAG, "Illegal stream_on motion threshold: %d", i);
+					return false;
+				}
+				trig->threshold = i;
+			} else {
+				ESP_LOGE(TAG, "stream_on motion missing threshold");
+				return false;
+			}
+			
+			if (cJSON_HasObjectItem(obj, "blocks")) {
+				i = cJSON_GetObjectItem(obj, "blocks")->valueint;
+				if ((i < 1) || (i > RSP_TRIG_NUM_BLOCKS)) {
+					ESP_LOGE(TAG, "Illegal stream_on motion blocks: %d", i);
+					return false;
+				}
+				trig->min_blocks = i;
+			}
+			
+			if (cJSON_HasObjectItem(obj, "hold_msec")) {
+				i = cJSON_GetObjectItem(obj, "hold_msec")->valueint;
+				if (i < 0) i = 0;
+				trig->hold_ms = i;
+			}
+			
+			if (cJSON_HasObjectItem(obj, "heartbeat_msec")) {
+				i = cJSON_GetObjectItem(obj, "heartbeat_msec")->valueint;
+				if (i < 0) i = 0;
+				trig->heartbeat_ms = i;
+			}
+		}
+		
+		// Synchronized streams select their own frames on the ticks delay_msec apart
+		if (*sync && ((*delay_ms == 0) || *segments || (trig->threshold != 0))) {
+			ESP_LOGE(TAG, "stream_on sync needs delay_msec without segments or motion");
+			return false;
+		}
 	} else {
 		// Assume old-style command and setup fastest possible streaming
 		*delay_ms = 0;
 		*num_frames = 0;
+		*key_interval = 0;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Get the record_on arguments.  Missing arguments select compressed keyframes recorded
+ * as fast as possible until the partition is full.
+ */
+bool json_parse_record_on(cJSON* cmd_args, int* encoding, uint32_t* delay_ms, uint32_t* num_frames, uint32_t* key_interval)
+{
+	int i;
+	
+	*encoding = BIN_ENC_RICE;
+	*delay_ms = 0;
+	*num_frames = 0;
+	*key_interval = 0;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "encoding")) {
+			i = cJSON_GetObjectItem(cmd_args, "encoding")->valueint;
+			if ((i != BIN_ENC_RAW) && (i != BIN_ENC_RICE)) {
+				ESP_LOGE(TAG, "Illegal record_on encoding: %d", i);
+				return false;
+			}
+			*encoding = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "delay_msec")) {
+			i = cJSON_GetObjectItem(cmd_args, "delay_msec")->valueint;
+			if (i < 0) i = 0;
+			*delay_ms = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "num_frames")) {
+			i = cJSON_GetObjectItem(cmd_args, "num_frames")->valueint;
+			if (i < 0) i = 0;
+			*num_frames = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "key_interval")) {
+			i = cJSON_GetObjectItem(cmd_args, "key_interval")->valueint;
+			if (i < 0) i = 0;
+			*key_interval = i;
+		}
+	}
+	
+	return true;
+}
+
+
+/**
+ * Get the set_interval_capture arguments.  A missing or 0 interval_msec returns to
+ * continuous operation.
+ */
+bool json_parse_set_interval_capture(cJSON* cmd_args, uint32_t* interval_ms, uint32_t* num_frames, uint32_t* settle_ms)
+{
+	int i;
+	
+	*interval_ms = 0;
+	*num_frames = 1;
+	*settle_ms = LEP_INTERVAL_SETTLE_MSEC;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "interval_msec")) {
+			i = cJSON_GetObjectItem(cmd_args, "interval_msec")->valueint;
+			if (i < 0) i = 0;
+			*interval_ms = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "num_frames")) {
+			i = cJSON_GetObjectItem(cmd_args, "num_frames")->valueint;
+			if (i < 1) i = 1;
+			*num_frames = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "settle_msec")) {
+			i = cJSON_GetObjectItem(cmd_args, "settle_msec")->valueint;
+			if (i < 0) i = 0;
+			*settle_ms = i;
+		}
+	}
+	
+	return true;
+}
+
+
+/**
+ * Get the set_analytics arguments.  Each entry in the optional "rois" array covers
+ * the entire frame unless it includes the set_spotmeter coordinates or a "points"
+ * array of 3 to ANA_MAX_POINTS [row, column] polygon vertices and may include
+ * "high" and "low" alarm thresholds (K * 100).  A single full frame region is used
+ * when no rois are specified.
+ */
+bool json_parse_set_analytics(cJSON* cmd_args, ana_config_t* cfg)
+{
+	cJSON* rois;
+	cJSON* item;
+	cJSON* points;
+	cJSON* pt;
+	ana_roi_t* r;
+	int i, row, col;
+	
+	cfg->num_rois = 0;
+	cfg->hysteresis = ANA_DEF_HYSTERESIS;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "hysteresis")) {
+			i = cJSON_GetObjectItem(cmd_args, "hysteresis")->valueint;
+			if (i < 0) i = 0;
+			cfg->hysteresis = i;
+		}
+		
+		rois = cJSON_GetObjectItem(cmd_args, "rois");
+		if (rois != NULL) {
+			if (!cJSON_IsArray(rois) || (cJSON_GetArraySize(rois) > ANA_MAX_ROIS)) {
+				ESP_LOGE(TAG, "Illegal set_analytics rois");
+				return false;
+			}
+			
+			cJSON_ArrayForEach(item, rois) {
+				r = &cfg->roi[cfg->num_rois];
+				r->r1 = 0;
+				r->c1 = 0;
+				r->r2 = LEP_HEIGHT - 1;
+				r->c2 = LEP_WIDTH - 1;
+				r->num_points = 0;
+				r->high = 0;
+				r->low = 0;
+				
+				points = cJSON_GetObjectItem(item, "points");
+				if (points != NULL) {
+					if (!cJSON_IsArray(points) || (cJSON_GetArraySize(points) < 3) ||
+					    (cJSON_GetArraySize(points) > ANA_MAX_POINTS)) {
+						ESP_LOGE(TAG, "Illegal set_analytics roi %d points", cfg->num_rois);
+						return false;
+					}
+					
+					cJSON_ArrayForEach(pt, points) {
+						if (!cJSON_IsArray(pt) || (cJSON_GetArraySize(pt) != 2)) {
+							ESP_LOGE(TAG, "Illegal set_analytics roi %d point", cfg->num_rois);
+							return false;
+						}
+						row = cJSON_GetArrayItem(pt, 0)->valueint;
+						col = cJSON_GetArrayItem(pt, 1)->valueint;
+						if (row < 0) row = 0;
+						if (row > (LEP_HEIGHT-1)) row = LEP_HEIGHT - 1;
+						if (col < 0) col = 0;
+						if (col > (LEP_WIDTH-1)) col = LEP_WIDTH - 1;
+						r->points[r->num_points][0] = row;
+						r->points[r->num_points][1] = col;
+						r->num_points++;
+					}
+				} else if (cJSON_HasObjectItem(item, "r1")) {
+					if (!json_parse_set_spotmeter(item, &r->r1, &r->c1, &r->r2, &r->c2)) {
+						ESP_LOGE(TAG, "Illegal set_analytics roi %d", cfg->num_rois);
+						return false;
+					}
+				}
+				
+				if (cJSON_HasObjectItem(item, "high")) {
+					i = cJSON_GetObjectItem(item, "high")->valueint;
+					if (i < 0) i = 0;
+					r->high = i;
+				}
+				
+				if (cJSON_HasObjectItem(item, "low")) {
+					i = cJSON_GetObjectItem(item, "low")->valueint;
+					if (i < 0) i = 0;
+					r->low = i;
+				}
+				
+				cfg->num_rois++;
+			}
+		}
+	}
+	
+	if (cfg->num_rois == 0) {
+		r = &cfg->roi[0];
+		r->r1 = 0;
+		r->c1 = 0;
+		r->r2 = LEP_HEIGHT - 1;
+		r->c2 = LEP_WIDTH - 1;
+		r->num_points = 0;
+		r->high = 0;
+		r->low = 0;
+		cfg->num_rois = 1;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Get the get_sys_stats argument.  Returns false if it doesn't include "enable".
+ */
+bool json_parse_get_sys_stats(cJSON* cmd_args, bool* enable)
+{
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "enable")) {
+			*enable = cJSON_GetObjectItem(cmd_args, "enable")->valueint != 0;
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+
+/**
+ * Get the dump_history arguments.  on_alarm is set to -1 to dump the history now or
+ * to 0 or 1 to disarm or arm dumps when an analytics alarm becomes active.
+ */
+bool json_parse_dump_history(cJSON* cmd_args, int* on_alarm)
+{
+	*on_alarm = -1;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "on_alarm")) {
+			*on_alarm = (cJSON_GetObjectItem(cmd_args, "on_alarm")->valueint != 0) ? 1 : 0;
+		}
+	}
+	
+	return true;
+}
+
+
+/**
+ * Get the burst_capture arguments.  The encoding defaults to compressed.
+ */
+bool json_parse_burst_capture(cJSON* cmd_args, uint32_t* num_frames, int* encoding)
+{
+	int i;
+	
+	*encoding = HIST_BURST_RICE;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "encoding")) {
+			i = cJSON_GetObjectItem(cmd_args, "encoding")->valueint;
+			if ((i != HIST_BURST_RAW) && (i != HIST_BURST_RICE)) {
+				ESP_LOGE(TAG, "Illegal burst_capture encoding: %d", i);
+				return false;
+			}
+			*encoding = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "num_frames")) {
+			i = cJSON_GetObjectItem(cmd_args, "num_frames")->valueint;
+			if ((i < 1) || (i > HIST_MAX_RECORDS)) {
+				ESP_LOGE(TAG, "Illegal burst_capture num_frames: %d", i);
+				return false;
+			}
+			*num_frames = i;
+			return true;
+		}
+	}
+	
+	ESP_LOGE(TAG, "burst_capture missing num_frames");
+	return false;
+}
+
+
+/**
+ * Get the set_history arguments
+ */
+bool json_parse_set_history(cJSON* cmd_args, uint32_t* seconds)
+{
+	int i;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "seconds")) {
+			i = cJSON_GetObjectItem(cmd_args, "seconds")->valueint;
+			if ((i < 0) || (i > HIST_MAX_SECONDS)) {
+				ESP_LOGE(TAG, "Illegal set_history seconds: %d", i);
+				return false;
+			}
+			*seconds = i;
+			return true;
+		}
+	}
+	
+	ESP_LOGE(TAG, "set_history missing seconds");
+	return false;
+}
+
+
+/**
+ * Get the set_espnow arguments.  The gateway defaults to the broadcast address and the
+ * interval to NOW_DEF_INTERVAL_MSEC.
+ */
+bool json_parse_set_espnow(cJSON* cmd_args, now_config_t* cfg)
+{
+	char* s;
+	int i;
+	
+	memset(cfg->peer, 0xFF, sizeof(cfg->peer));
+	cfg->interval_ms = NOW_DEF_INTERVAL_MSEC;
+	
+	if ((cmd_args == NULL) || !cJSON_HasObjectItem(cmd_args, "mode")) {
+		ESP_LOGE(TAG, "set_espnow missing mode");
+		return false;
+	}
+	
+	i = cJSON_GetObjectItem(cmd_args, "mode")->valueint;
+	if ((i < NOW_MODE_OFF) || (i > NOW_MODE_IMAGE)) {
+		ESP_LOGE(TAG, "Illegal set_espnow mode: %d", i);
+		return false;
+	}
+	cfg->mode = i;
+	
+	if (cJSON_HasObjectItem(cmd_args, "peer")) {
+		s = cJSON_GetObjectItem(cmd_args, "peer")->valuestring;
+		if ((s == NULL) || !json_mac_string_to_array(cfg->peer, s)) {
+			ESP_LOGE(TAG, "Illegal set_espnow peer");
+			return false;
+		}
+	}
+	
+	if (cJSON_HasObjectItem(cmd_args, "interval_msec")) {
+		i = cJSON_GetObjectItem(cmd_args, "interval_msec")->valueint;
+		if ((i < 0) || (i > NOW_MAX_INTERVAL_MSEC)) {
+			ESP_LOGE(TAG, "Illegal set_espnow interval_msec: %d", i);
+			return false;
+		}
+		cfg->interval_ms = i;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Get the optional set_ffc arguments.  sched is loaded with the current settings and
+ * the arguments included change them.
+ */
+bool json_parse_set_ffc(cJSON* cmd_args, lep_ffc_sched_t* sched)
+{
+	int i;
+	lep_ffc_status_t status;
+	
+	lep_get_ffc_schedule(sched, &status);
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "mode")) {
+			i = cJSON_GetObjectItem(cmd_args, "mode")->valueint;
+			if ((i < LEP_FFC_MODE_AUTO) || (i > LEP_FFC_MODE_SMART)) {
+				ESP_LOGE(TAG, "Illegal set_ffc mode: %d", i);
+				return false;
+			}
+			sched->mode = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "drift")) {
+			i = cJSON_GetObjectItem(cmd_args, "drift")->valueint;
+			if (i < 0) i = 0;
+			sched->drift_k100 = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "motion")) {
+			i = cJSON_GetObjectItem(cmd_args, "motion")->valueint;
+			if (i < 1) i = 1;
+			sched->motion = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "quiet_msec")) {
+			i = cJSON_GetObjectItem(cmd_args, "quiet_msec")->valueint;
+			if (i < 0) i = 0;
+			sched->quiet_msec = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "min_msec")) {
+			i = cJSON_GetObjectItem(cmd_args, "min_msec")->valueint;
+			if (i < 0) i = 0;
+			sched->min_msec = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "max_wait_msec")) {
+			i = cJSON_GetObjectItem(cmd_args, "max_wait_msec")->valueint;
+			if (i < 0) i = 0;
+			sched->max_wait_msec = i;
+		}
+	}
+	
+	return true;
+}
+
+
+/**
+ * Get the set_lepton argument
+ */
+bool json_parse_set_lepton(cJSON* cmd_args, int* lepton)
+{
+	int i;
+	
+	if ((cmd_args == NULL) || !cJSON_HasObjectItem(cmd_args, "lepton")) {
+		ESP_LOGE(TAG, "set_lepton missing lepton");
+		return false;
+	}
+	
+	i = cJSON_GetObjectItem(cmd_args, "lepton")->valueint;
+	if ((i < 0) || (i >= LEP_NUM_LEPTONS)) {
+		ESP_LOGE(TAG, "Illegal set_lepton lepton: %d", i);
+		return false;
+	}
+	*lepton = i;
+	
+	return true;
+}
+
+
+/**
+ * Get the optional get_image arguments.  avg_frames is loaded with the number of
+ * frames to average (1 for a single frame) and max_age_ms with the age of a frame
+ * already captured that may be sent instead of the next one (0 to wait for the next).
+ */
+bool json_parse_get_image(cJSON* cmd_args, uint32_t* avg_frames, uint32_t* max_age_ms)
+{
+	int i;
+	
+	*avg_frames = 1;
+	*max_age_ms = 0;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "average")) {
+			i = cJSON_GetObjectItem(cmd_args, "average")->valueint;
+			if ((i < 1) || (i > RSP_MAX_AVG_FRAMES)) {
+				ESP_LOGE(TAG, "Illegal get_image average: %d", i);
+				return false;
+			}
+			*avg_frames = i;
+		}
+		
+		if (cJSON_HasObjectItem(cmd_args, "max_age_msec")) {
+			i = cJSON_GetObjectItem(cmd_args, "max_age_msec")->valueint;
+			*max_age_ms = (i > 0) ? i : 0;
+		}
+	}
+	
+	return true;
+}
+
+
+/**
+ * Get the get_record (and get_log) arguments.  The length is limited to
+ * RSP_MAX_REC_CHUNK_LEN.
+ */
+bool json_parse_get_record(cJSON* cmd_args, uint32_t* offset, uint32_t* length)
+{
+	double d;
+	int i;
+	
+	*length = RSP_MAX_REC_CHUNK_LEN;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "offset")) {
+			// Offsets may exceed the range of valueint
+			d = cJSON_GetObjectItem(cmd_args, "offset")->valuedouble;
+			if (d < 0) d = 0;
+			*offset = (uint32_t) d;
+			
+			if (cJSON_HasObjectItem(cmd_args, "length")) {
+				i = cJSON_GetObjectItem(cmd_args, "length")->valueint;
+				if (i < 0) i = 0;
+				if (i > RSP_MAX_REC_CHUNK_LEN) i = RSP_MAX_REC_CHUNK_LEN;
+				*length = i;
+			}
+			
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+
+/**
+ * Get the subscribe_status arguments.  interval_ms is the time between status pushes,
+ * on_change pushes status when it changes and metrics follows each status push with
+ * the metrics.  They are all cleared, ending the subscription, without arguments.
+ */
+bool json_parse_subscribe_status(cJSON* cmd_args, uint32_t* interval_ms, bool* on_change, bool* metrics)
+{
+	int i;
+	
+	*interval_ms = 0;
+	*on_change = false;
+	*metrics = false;
+	
+	if (cmd_args != NULL) {
+		if (cJSON_HasObjectItem(cmd_args, "interval_msec")) {
+			i = cJSON_GetObjectItem(cmd_args, "interval_msec")->valueint;
+			if ((i != 0) && ((i < CMD_STATUS_CHECK_MSEC) || (i > CMD_STATUS_MAX_MSEC))) {
+				ESP_LOGE(TAG, "Illegal subscribe_status interval_msec: %d", i);
+				return false;
+			}
+			*interval_ms = i;
+		}
+		if (cJSON_HasObjectItem(cmd_args, "on_change")) {
+			*on_change = cJSON_GetObjectItem(cmd_args, "on_change")->valueint != 0;
+		}
+		if (cJSON_HasObjectItem(cmd_args, "metrics")) {
+			*metrics = cJSON_GetObjectItem(cmd_args, "metrics")->valueint != 0;
+		}
 	}
 	
 	return true;
@@ -675,137 +2359,457 @@ const char* json_get_cmd_name(int cmd)
 }
 
 
+/**
+ * Return the cmd for a command name, CMD_UNKNOWN if it isn't one
+ */
+int json_get_cmd_index(const char* name)
+{
+	int i;
+	
+	for (i=0; i<CMD_NUM; i++) {
+		if (strcmp(name, command_list[i].cmd_name) == 0) {
+			return command_list[i].cmd_index;
+		}
+	}
+	
+	return CMD_UNKNOWN;
+}
+
+
 
 //
 // JSON Utilities internal functions
 //
 
 /**
- * Add a child object containing base64 encoded lepton image from the shared buffer
- *
- * Note: The encoded image string is held in an array that must be freed with
- * json_free_lep_base64_image() after the json object is converted to a string.
- */
-static bool json_add_lep_image_object(cJSON* parent, lep_buffer_t* lep_buffer)
-{
-	size_t base64_obj_len;
-	
-	// Get the necessary length and allocate a buffer
-	(void) mbedtls_base64_encode(base64_lep_data, 0, &base64_obj_len, 
-								 (const unsigned char *) lep_buffer->lep_bufferP, LEP_NUM_PIXELS*2);
-	base64_lep_data = heap_caps_malloc(base64_obj_len, MALLOC_CAP_SPIRAM);
-	
-	if (base64_lep_data != NULL) {
-		// Base-64 encode the camera data
-		if (mbedtls_base64_encode(base64_lep_data, base64_obj_len, &base64_obj_len, 
-							      (const unsigned char *) lep_buffer->lep_bufferP,
-	    	                       LEP_NUM_PIXELS*2) != 0) {
-	                           
-			ESP_LOGE(TAG, "failed to encode lepton image base64 text");
-			free(base64_lep_data);
-			return false;
-		}
-	} else {
-		ESP_LOGE(TAG, "failed to allocate %d bytes for lepton image base64 text", base64_obj_len);
-		return false;
+ * Rebuild the cached start of the image json record if necessary
+ */
+static void json_update_image_meta_prefix()
+{
+	char* p;
+	char* end;
+	const esp_app_desc_t* app_desc;
+	wifi_info_t* wifi_info;
+	
+	wifi_info = wifi_get_info();
+	if ((json_image_meta_prefix_len != 0) && (strcmp(json_image_meta_ssid, wifi_info->ap_ssid) == 0)) {
+		return;
 	}
 	
-	// Add the encoded data as a reference since we're managing the buffer
-	cJSON_AddItemToObject(parent, "radiometric", cJSON_CreateStringReference((char*) base64_lep_data));
+	app_desc = esp_ota_get_app_description();
 	
-	return true;
+	p = json_image_meta_prefix;
+	end = json_image_meta_prefix + JSON_MAX_IMAGE_META_PREFIX_LEN;
+	p = json_put_literal(p, end, "{\n\t\"metadata\":\t{\n\t\t\"Camera\":\t");
+	p = json_put_escaped_string(p, end, wifi_info->ap_ssid);
+	p = json_put_literal(p, end, ",\n\t\t\"Model\":\t");
+	p = json_put_uint(p, end, CAMERA_MODEL_NUM, 1);
+	p = json_put_literal(p, end, ",\n\t\t\"Version\":\t");
+	p = json_put_escaped_string(p, end, app_desc->version);
+	p = json_put_literal(p, end, ",\n");
+	
+	if (p == NULL) {
+		// Shouldn't happen - fall back to no identification
+		p = json_put_literal(json_image_meta_prefix, end, "{\n\t\"metadata\":\t{\n");
+	}
+	json_image_meta_prefix_len = p - json_image_meta_prefix;
+	strncpy(json_image_meta_ssid, wifi_info->ap_ssid, PS_SSID_MAX_LEN);
+	json_image_meta_ssid[PS_SSID_MAX_LEN] = 0;
 }
 
 
 /**
- * Free the base64-encoded Lepton image.  Call this routine after printing the 
- * image json object.
+ * Write the start of an image json record through the opening quote of the radiometric
+ * data.  The time metadata is the time the frame was captured.
  */
-static void json_free_lep_base64_image()
+static char* json_put_image_head(char* p, char* end, lep_buffer_t* lep_buffer, bool agc8, uint8_t telem_mask)
 {
-	free(base64_lep_data);
+	int64_t capture_usec;
+	tmElements_t te;
+	
+	capture_usec = time_timer_to_usec(lep_buffer->vsync_usec);
+	time_get_at(capture_usec, &te);
+	json_update_image_meta_prefix();
+	
+	// Metadata
+	p = json_put_text(p, end, json_image_meta_prefix, json_image_meta_prefix_len);
+	p = json_put_literal(p, end, "\t\t\"Time\":\t\"");
+	p = json_put_uint(p, end, te.Hour, 1);
+	p = json_put_literal(p, end, ":");
+	p = json_put_uint(p, end, te.Minute, 2);
+	p = json_put_literal(p, end, ":");
+	p = json_put_uint(p, end, te.Second, 2);
+	p = json_put_literal(p, end, ".");
+	p = json_put_uint(p, end, te.Millisecond, 1);
+	p = json_put_literal(p, end, "\",\n\t\t\"Date\":\t\"");
+	p = json_put_uint(p, end, te.Month, 1);
+	p = json_put_literal(p, end, "/");
+	p = json_put_uint(p, end, te.Day, 1);
+	p = json_put_literal(p, end, "/");
+	p = json_put_uint(p, end, te.Year-30, 2);  // Year starts at 1970
+	p = json_put_literal(p, end, "\",\n\t\t\"Timestamp\":\t");
+	p = json_put_uint64(p, end, (uint64_t) capture_usec);
+	p = json_put_literal(p, end, ",\n\t\t\"TimeSync\":\t");
+	p = json_put_bool(p, end, time_is_synced());
+	p = json_put_literal(p, end, ",\n\t\t\"Seq\":\t");
+	p = json_put_uint(p, end, lep_buffer->seq, 1);
+	if (agc8) {
+		p = json_put_literal(p, end, ",\n\t\t\"AGC8\":\ttrue");
+	}
+	if (lep_buffer->avg_frames != 0) {
+		p = json_put_literal(p, end, ",\n\t\t\"AvgFrames\":\t");
+		p = json_put_uint(p, end, lep_buffer->avg_frames, 1);
+		p = json_put_literal(p, end, ",\n\t\t\"AvgFracBits\":\t");
+		p = json_put_uint(p, end, lep_buffer->avg_frac_bits, 1);
+	}
+	if (lep_buffer->sync_tick_usec != 0) {
+		p = json_put_literal(p, end, ",\n\t\t\"SyncTick\":\t");
+		p = json_put_uint64(p, end, (uint64_t) lep_buffer->sync_tick_usec);
+	}
+	if ((telem_mask != 0) && lep_buffer->telem_valid) {
+		p = json_put_telem_fields(p, end, lep_buffer->lep_telemP, telem_mask);
+	}
+	if (lep_buffer->histP != NULL) {
+		p = json_put_hist(p, end, lep_buffer);
+	}
+	p = json_put_literal(p, end, "\n\t},\n");
+	
+	// Image
+	return json_put_literal(p, end, "\t\"radiometric\":\t\"");
 }
 
 
 /**
- * Add a child object containing base64 encoded lepton telemetry array from the shared buffer
- *
- * Note: The encoded telemetry string is held in an array that must be freed with
- * json_free_lep_base64_telem() after the json object is converted to a string.
+ * Write the end of an image json record following the radiometric data (without the
+ * telemetry when only the telem_mask fields are sent)
  */
-static bool json_add_lep_telem_object(cJSON* parent, lep_buffer_t* lep_buffer)
+static char* json_put_image_tail(char* p, char* end, lep_buffer_t* lep_buffer, uint8_t telem_mask)
 {
-	size_t base64_obj_len;
+	if (telem_mask == 0) {
+		p = json_put_literal(p, end, JSON_IMAGE_TELEM_START);
+		p = json_put_base64(p, end, lep_buffer->lep_telemP, LEP_TEL_WORDS*2);
+	}
+	return json_put_literal(p, end, JSON_IMAGE_END);
+}
+
+
+/**
+ * Write the image metadata "Telem" object holding the telemetry fields in mask
+ */
+static char* json_put_telem_fields(char* p, char* end, uint16_t* tel_buf, uint8_t mask)
+{
+	lep_tel_fields_t f;
+	const char* sep = "\n";
+	
+	lepton_get_tel_fields(tel_buf, &f);
 	
-	// Get the necessary length and allocate a buffer
-	(void) mbedtls_base64_encode(base64_lep_telem_data, 0, &base64_obj_len, 
-								 (const unsigned char *) lep_buffer->lep_telemP, LEP_TEL_WORDS*2);
-	base64_lep_telem_data = heap_caps_malloc(base64_obj_len, MALLOC_CAP_SPIRAM);
+	p = json_put_literal(p, end, ",\n\t\t\"Telem\":\t{");
+	if (mask & LEP_TEL_FLD_FRAME_CNT) {
+		p = json_put_text(p, end, sep, strlen(sep));
+		p = json_put_literal(p, end, "\t\t\t\"FrameCount\":\t");
+		p = json_put_uint(p, end, f.frame_cnt, 1);
+		sep = ",\n";
+	}
+	if (mask & LEP_TEL_FLD_FPA_TEMP) {
+		p = json_put_text(p, end, sep, strlen(sep));
+		p = json_put_literal(p, end, "\t\t\t\"FpaTemp\":\t");
+		p = json_put_uint(p, end, f.fpa_t_k100, 1);
+		sep = ",\n";
+	}
+	if (mask & LEP_TEL_FLD_AUX_TEMP) {
+		p = json_put_text(p, end, sep, strlen(sep));
+		p = json_put_literal(p, end, "\t\t\t\"AuxTemp\":\t");
+		p = json_put_uint(p, end, f.aux_t_k100, 1);
+		sep = ",\n";
+	}
+	if (mask & LEP_TEL_FLD_FFC) {
+		p = json_put_text(p, end, sep, strlen(sep));
+		p = json_put_literal(p, end, "\t\t\t\"FfcState\":\t");
+		p = json_put_uint(p, end, f.ffc_state, 1);
+		p = json_put_literal(p, end, ",\n\t\t\t\"FfcDesired\":\t");
+		p = json_put_bool(p, end, f.ffc_desired);
+		sep = ",\n";
+	}
+	if (mask & LEP_TEL_FLD_GAIN) {
+		p = json_put_text(p, end, sep, strlen(sep));
+		p = json_put_literal(p, end, "\t\t\t\"GainMode\":\t");
+		p = json_put_uint(p, end, f.gain_mode, 1);
+		sep = ",\n";
+	}
+	if (mask & LEP_TEL_FLD_TLIN) {
+		p = json_put_text(p, end, sep, strlen(sep));
+		p = json_put_literal(p, end, "\t\t\t\"TLinear\":\t");
+		p = json_put_bool(p, end, f.tlin_enabled);
+		p = json_put_literal(p, end, ",\n\t\t\t\"TLinRes\":\t");
+		p = json_put_uint(p, end, f.tlin_res, 1);
+	}
+	return json_put_literal(p, end, "\n\t\t}");
+}
+
+
+/**
+ * Write a Histogram metadata object with the image's range, percentiles and bins
+ */
+static char* json_put_hist(char* p, char* end, lep_buffer_t* lep_buffer)
+{
+	int i;
 	
+	p = json_put_literal(p, end, ",\n\t\t\"Histogram\":\t{\n\t\t\t\"Min\":\t");
+	p = json_put_uint(p, end, lep_buffer->lep_min_val, 1);
+	p = json_put_literal(p, end, ",\n\t\t\t\"Max\":\t");
+	p = json_put_uint(p, end, lep_buffer->lep_max_val, 1);
+	p = json_put_literal(p, end, ",\n\t\t\t\"P1\":\t");
+	p = json_put_uint(p, end, lep_buffer->histP->p1, 1);
+	p = json_put_literal(p, end, ",\n\t\t\t\"P50\":\t");
+	p = json_put_uint(p, end, lep_buffer->histP->p50, 1);
+	p = json_put_literal(p, end, ",\n\t\t\t\"P99\":\t");
+	p = json_put_uint(p, end, lep_buffer->histP->p99, 1);
+	p = json_put_literal(p, end, ",\n\t\t\t\"Bins\":\t[");
+	for (i=0; i<LEP_HIST_BINS; i++) {
+		if (i != 0) p = json_put_literal(p, end, ",");
+		p = json_put_uint(p, end, lep_buffer->histP->bins[i], 1);
+	}
+	return json_put_literal(p, end, "]\n\t\t}");
+}
+
+
+/**
+ * Routines to write json text into a buffer ending at end.  They return the next
+ * location or NULL if the text doesn't fit (and pass NULL through so a sequence of
+ * calls only has to be checked at the end).
+ */
+static char* json_put_text(char* p, char* end, const char* s, int len)
+{
+	if ((p == NULL) || ((p + len) > end)) return NULL;
 	
-	if (base64_lep_data != NULL) {
-		// Base-64 encode the telemetry array
-		if (mbedtls_base64_encode(base64_lep_telem_data, base64_obj_len, &base64_obj_len, 
-							      (const unsigned char *) lep_buffer->lep_telemP,
-	    	                       LEP_TEL_WORDS*2) != 0) {
-	                           
-			ESP_LOGE(TAG, "failed to encode lepton telemetry base64 text");
-			free(base64_lep_telem_data);
-			return false;
+	memcpy(p, s, len);
+	return p + len;
+}
+
+
+static char* json_put_escaped_string(char* p, char* end, const char* s)
+{
+	char c;
+	
+	p = json_put_literal(p, end, "\"");
+	while ((p != NULL) && ((c = *s++) != 0)) {
+		if ((c == '"') || (c == '\\')) {
+			p = json_put_literal(p, end, "\\");
+			p = json_put_text(p, end, &c, 1);
+		} else if ((unsigned char) c >= ' ') {
+			p = json_put_text(p, end, &c, 1);
 		}
+	}
+	return json_put_literal(p, end, "\"");
+}
+
+
+static char* json_put_uint(char* p, char* end, uint32_t v, int min_digits)
+{
+	char buf[10];
+	int n = 0;
+	
+	do {
+		buf[n++] = '0' + (v % 10);
+		v = v / 10;
+	} while ((v != 0) || (n < min_digits));
+	
+	if ((p == NULL) || ((p + n) > end)) return NULL;
+	while (n != 0) {
+		*p++ = buf[--n];
+	}
+	return p;
+}
+
+
+static char* json_put_bool(char* p, char* end, bool v)
+{
+	if (v) {
+		return json_put_literal(p, end, "true");
 	} else {
-		ESP_LOGE(TAG, "failed to allocate %d bytes for lepton telemetry base64 text", base64_obj_len);
-		return false;
+		return json_put_literal(p, end, "false");
 	}
+}
+
+
+static char* json_put_uint64(char* p, char* end, uint64_t v)
+{
+	char buf[20];
+	int n = 0;
 	
-	// Add the encoded data as a reference since we're managing the buffer
-	cJSON_AddItemToObject(parent, "telemetry", cJSON_CreateStringReference((char*) base64_lep_telem_data));
+	do {
+		buf[n++] = '0' + (v % 10);
+		v = v / 10;
+	} while (v != 0);
 	
-	return true;
+	if ((p == NULL) || ((p + n) > end)) return NULL;
+	while (n != 0) {
+		*p++ = buf[--n];
+	}
+	return p;
+}
+
+
+static char* json_put_base64(char* p, char* end, const void* data, int len)
+{
+	size_t olen;
+	
+	// mbedtls adds a terminating null so needs one extra byte
+	if ((p == NULL) || (mbedtls_base64_encode((unsigned char*) p, end - p + 1, &olen,
+	                                          (const unsigned char*) data, len) != 0)) {
+		return NULL;
+	}
+	return p + olen;
 }
 
 
 /**
- * Free the base64-encoded Lepton telemetry string.  Call this routine after printing the 
- * telemetry json object.
+ * Skip whitespace and match len bytes of s at p.  Returns the location following them
+ * or NULL if they don't match (and passes NULL through like json_put_text).
  */
-static void json_free_lep_base64_telem()
+static const char* json_scan_token(const char* p, const char* end, const char* s, int len)
 {
-	free(base64_lep_telem_data);
+	if (p == NULL) return NULL;
+	
+	while ((p < end) && ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n'))) p++;
+	if (((end - p) < len) || (memcmp(p, s, len) != 0)) return NULL;
+	return p + len;
 }
 
 
 /**
- * Add a child object containing image metadata to the parent.
+ * Start a directly written response in json_response_text with the start delimitor.
+ * Returns the location to write the response at and sets end leaving room for the
+ * stop delimitor and terminating null.
  */
-static bool json_add_metadata_object(cJSON* parent)
+static char* json_start_response(char** end)
 {
-	char buf[80];
-	cJSON* meta;
-	wifi_info_t* wifi_info;
-	const esp_app_desc_t* app_desc;
-	tmElements_t te;
-	
-	// Get system information
-	app_desc = esp_ota_get_app_description();
-	time_get(&te);
-	
-	// Create and add to the metadata object
-	cJSON_AddItemToObject(parent, "metadata", meta=cJSON_CreateObject());
+	json_response_text[0] = CMD_JSON_STRING_START;
+	*end = json_response_text + JSON_MAX_RSP_TEXT_LEN - 2;
+	return &json_response_text[1];
+}
+
+
+/**
+ * Finish a directly written response with the stop delimitor and set len to its length
+ * (0 if it didn't fit).  Returns json_response_text.
+ */
+static char* json_finish_response(char* p, uint32_t* len)
+{
+	if (p == NULL) {
+		ESP_LOGE(TAG, "failed to create json response text");
+		*len = 0;
+	} else {
+		*p++ = CMD_JSON_STRING_STOP;
+		*p = 0;
+		*len = p - json_response_text;
+	}
 	
-	wifi_info = wifi_get_info();
-	cJSON_AddStringToObject(meta, "Camera", wifi_info->ap_ssid);
+	return json_response_text;
+}
+
+
+/**
+ * Start a directly written response in buf with the start delimitor.  Returns the
+ * location to write the response at and sets end leaving room for the stop delimitor
+ * and terminating null.  Returns NULL, with end set to buf, if buf is too small.
+ */
+static char* json_start_buf(char* buf, uint32_t max_len, char** end)
+{
+	if (max_len < 3) {
+		*end = buf;
+		return NULL;
+	}
 	
-	cJSON_AddNumberToObject(meta, "Model", CAMERA_MODEL_NUM);
+	buf[0] = CMD_JSON_STRING_START;
+	*end = buf + max_len - 2;
+	return &buf[1];
+}
+
+
+/**
+ * Finish a directly written response in buf with the stop delimitor.  Returns its
+ * length (0 if it didn't fit).
+ */
+static uint32_t json_finish_buf(char* buf, char* p)
+{
+	if (p == NULL) return 0;
 	
-	cJSON_AddStringToObject(meta, "Version", app_desc->version);
+	*p++ = CMD_JSON_STRING_STOP;
+	*p = 0;
+	return p - buf;
+}
+
+
+/**
+ * Add an object with a stage's timing statistics (uSec) and optionally its histogram
+ */
+static void json_add_perf_stage(cJSON* parent, const char* name, int stage, bool inc_hist)
+{
+	int i;
+	cJSON* obj;
+	cJSON* hist;
+	perf_stage_t s;
+	
+	perf_get_stage(stage, &s);
+	
+	cJSON_AddItemToObject(parent, name, obj=cJSON_CreateObject());
+	cJSON_AddNumberToObject(obj, "count", s.count);
+	cJSON_AddNumberToObject(obj, "avg", (s.count == 0) ? 0 : (uint32_t) (s.total_usec / s.count));
+	cJSON_AddNumberToObject(obj, "min", s.min_usec);
+	cJSON_AddNumberToObject(obj, "max", s.max_usec);
+	if (inc_hist) {
+		cJSON_AddItemToObject(obj, "hist", hist=cJSON_CreateArray());
+		for (i=0; i<PERF_HIST_BUCKETS; i++) {
+			cJSON_AddItemToArray(hist, cJSON_CreateNumber(s.hist[i]));
+		}
+	}
+}
+
+
+/**
+ * Add an object with the free, minimum free and largest free block sizes of the heap
+ * regions with caps
+ */
+static void json_add_heap_caps(cJSON* parent, const char* name, uint32_t caps)
+{
+	cJSON* obj;
 	
-	sprintf(buf, "%d:%02d:%02d.%d", te.Hour, te.Minute, te.Second, te.Millisecond);
-	cJSON_AddStringToObject(meta, "Time", buf);
-	sprintf(buf, "%d/%d/%02d", te.Month, te.Day, te.Year-30);  // Year starts at 1970
-	cJSON_AddStringToObject(meta, "Date", buf);
+	cJSON_AddItemToObject(parent, name, obj=cJSON_CreateObject());
+	cJSON_AddNumberToObject(obj, "free", (const double) heap_caps_get_free_size(caps));
+	cJSON_AddNumberToObject(obj, "min", (const double) heap_caps_get_minimum_free_size(caps));
+	cJSON_AddNumberToObject(obj, "largest", (const double) heap_caps_get_largest_free_block(caps));
+}
+
+
+/**
+ * cJSON allocator: bump allocate from the arena, falling back to the heap when it is full
+ */
+static void* json_arena_malloc(size_t sz)
+{
+	void* p;
+	
+	sz = (sz + 3) & ~3;
+	if (sz <= (JSON_ARENA_LEN - json_arena_used)) {
+		p = json_arena + json_arena_used;
+		json_arena_used += sz;
+		if (json_arena_used > json_arena_max) json_arena_max = json_arena_used;
+		return p;
+	}
 	
-	return true;
+	json_arena_overflows++;
+	return malloc(sz);
+}
+
+
+/**
+ * cJSON deallocator: arena allocations are released together by json_arena_reset
+ */
+static void json_arena_free(void* p)
+{
+	if (((uint8_t*) p < json_arena) || ((uint8_t*) p >= (json_arena + JSON_ARENA_LEN))) {
+		free(p);
+	}
 }
 
 
@@ -860,3 +2864,38 @@ static bool json_ip_string_to_array(uint8_t* ip_array, char* ip_string)
 	
 	return true;
 }
+
+
+/**
+ * Convert a "XX:XX:XX:XX:XX:XX" hex MAC address string into a 6-byte array, most
+ * significant byte first
+ */
+static bool json_mac_string_to_array(uint8_t* mac_array, char* mac_string)
+{
+	char c;
+	int i = 0;
+	int digits = 0;
+	
+	mac_array[0] = 0;
+	while ((c = *mac_string++) != 0) {
+		if (c == ':') {
+			if ((i == 5) || (digits == 0)) {
+				return false;
+			}
+			mac_array[++i] = 0;
+			digits = 0;
+		} else if (digits == 2) {
+			return false;
+		} else if ((c >= '0') && (c <= '9')) {
+			mac_array[i] = (mac_array[i] << 4) | (c - '0');
+			digits++;
+		} else if (((c | 0x20) >= 'a') && ((c | 0x20) <= 'f')) {
+			mac_array[i] = (mac_array[i] << 4) | ((c | 0x20) - 'a' + 10);
+			digits++;
+		} else {
+			return false;
+		}
+	}
+	
+	return ((i == 5) && (digits != 0));
+}
@@ -33,6 +33,10 @@
 #ifndef JSON_UTILITIES_H
 #define JSON_UTILITIES_H
 
+#include "ana_task.h"
+#include "lep_task.h"
+#include "now_task.h"
+#include "rsp_task.h"
 #include "ds3232.h"
 #include "sys_utilities.h"
 #include "wifi_utilities.h"
@@ -46,17 +50,56 @@
 // JSON Utilities API
 //
 bool json_init();
+void json_arena_reset();
 cJSON* json_get_cmd_object(char* json_string);
+bool json_scan_cmd(const char* json_string, int len, int* cmd);
 uint32_t json_get_image_file_string(char* json_image_text, lep_buffer_t* lep_buffer);
+uint32_t json_get_image_head(char* buf, uint32_t max_len, lep_buffer_t* lep_buffer, bool agc8, uint8_t telem_mask);
+uint32_t json_get_image_base64(char* buf, uint32_t max_len, const void* data, uint32_t len);
+uint32_t json_get_image_tail(char* buf, uint32_t max_len, lep_buffer_t* lep_buffer, uint8_t telem_mask);
+uint32_t json_get_image_tail_len(uint8_t telem_mask);
 char* json_get_config(uint32_t* len);
-char* json_get_status(uint32_t* len);
+char* json_get_status(const rsp_adapt_status_t* adapt, bool compact, uint32_t* len);
+char* json_get_perf_stats(uint32_t* len);
+char* json_get_metrics(const rsp_queue_status_t* q, uint32_t* len);
 char* json_get_wifi(uint32_t* len);
+char* json_get_image_format(int format, int palette, uint16_t lo, uint16_t hi, bool agc8, uint8_t telem_mask, bool hist, uint16_t threshold, uint32_t* len);
+char* json_get_record_info(uint32_t* len);
+char* json_get_log_info(uint32_t* len);
+char* json_get_ota_info(uint32_t* len);
+char* json_get_interval_capture(uint32_t* len);
+char* json_get_ffc_schedule(uint32_t* len);
+char* json_get_wifi_scan(uint32_t* len);
+char* json_get_sys_stats(uint32_t* len);
+void json_batch_start();
+bool json_batch_add(const char* buf, uint32_t len);
+char* json_batch_finish(uint32_t* len);
+uint32_t json_get_ana_stats(char* buf, uint32_t max_len, ana_stats_t* s);
+uint32_t json_get_ana_event(char* buf, uint32_t max_len, uint32_t frame, int roi, int alarm, bool active, uint32_t value);
+uint32_t json_get_history_dump(char* buf, uint32_t max_len, uint32_t records, uint32_t length);
+uint32_t json_get_burst_dump(char* buf, uint32_t max_len, uint32_t records, uint32_t length, uint32_t missed, bool complete);
+uint32_t json_get_latency(char* buf, uint32_t max_len, const rsp_latency_t* l);
+bool json_parse_burst_capture(cJSON* cmd_args, uint32_t* num_frames, int* encoding);
 bool json_parse_cmd(cJSON* cmd_obj, int* cmd, cJSON** cmd_args);
+bool json_parse_dump_history(cJSON* cmd_args, int* on_alarm);
+bool json_parse_get_image(cJSON* cmd_args, uint32_t* avg_frames, uint32_t* max_age_ms);
+bool json_parse_get_record(cJSON* cmd_args, uint32_t* offset, uint32_t* length);
+bool json_parse_get_sys_stats(cJSON* cmd_args, bool* enable);
+bool json_parse_record_on(cJSON* cmd_args, int* encoding, uint32_t* delay_ms, uint32_t* num_frames, uint32_t* key_interval);
+bool json_parse_set_interval_capture(cJSON* cmd_args, uint32_t* interval_ms, uint32_t* num_frames, uint32_t* settle_ms);
+bool json_parse_set_analytics(cJSON* cmd_args, ana_config_t* cfg);
 bool json_parse_set_config(cJSON* cmd_args, json_config_t* new_st);
+bool json_parse_set_espnow(cJSON* cmd_args, now_config_t* cfg);
+bool json_parse_set_ffc(cJSON* cmd_args, lep_ffc_sched_t* sched);
+bool json_parse_set_lepton(cJSON* cmd_args, int* lepton);
+bool json_parse_set_history(cJSON* cmd_args, uint32_t* seconds);
+bool json_parse_set_image_format(cJSON* cmd_args, int* format, int* palette, uint16_t* lo, uint16_t* hi, bool* agc8, uint8_t* telem_mask, bool* hist, uint16_t* threshold);
 bool json_parse_set_spotmeter(cJSON* cmd_args, uint16_t* r1, uint16_t* c1, uint16_t* r2, uint16_t* c2);
 bool json_parse_set_time(cJSON* cmd_args, tmElements_t* te);
 bool json_parse_set_wifi(cJSON* cmd_args, wifi_info_t* new_wifi_info);
-bool json_parse_stream_on(cJSON* cmd_args, uint32_t* delay_ms, uint32_t* num_frames);
+bool json_parse_stream_on(cJSON* cmd_args, uint32_t* delay_ms, uint32_t* num_frames, uint32_t* key_interval, uint16_t* udp_port, uint8_t* udp_addr, uint16_t* roi, int* bin, bool* segments, bool* raw, bool* rtp, rsp_trigger_t* trig, int* stats, uint32_t* adapt_ms, bool* probe, bool* sync, bool* cmd_priority);
+bool json_parse_subscribe_status(cJSON* cmd_args, uint32_t* interval_ms, bool* on_change, bool* metrics);
 void json_free_cmd(cJSON* cmd);
 const char* json_get_cmd_name(int cmd);
+int json_get_cmd_index(const char* name);
 #endif /* JSON_UTILITIES_H */
\ No newline at end of file
@@ -0,0 +1,1032 @@
+/*
+ * Palette Utilities
+ *
+ * Contains the 256 entry RGB palettes used to colorize preview images.  They are the
+ * same palettes as ESP32/python/palettes.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "palette_utilities.h"
+#include <string.h>
+
+
+
+//
+// Palette Utilities variables
+//
+static const uint8_t black_hot_palette[PALETTE_LEN] = {
+	235, 235, 235, 234, 234, 234, 233, 233, 233, 232, 232, 232,
+	231, 231, 231, 230, 230, 230, 229, 229, 229, 228, 228, 228,
+	227, 227, 227, 226, 226, 226, 225, 225, 225, 224, 224, 224,
+	223, 223, 223, 222, 222, 222, 221, 221, 221, 220, 220, 220,
+	219, 219, 219, 218, 218, 218, 217, 217, 217, 216, 216, 216,
+	215, 215, 215, 214, 214, 214, 213, 213, 213, 212, 212, 212,
+	211, 211, 211, 210, 210, 210, 209, 209, 209, 209, 209, 209,
+	208, 208, 208, 207, 207, 207, 206, 206, 206, 205, 205, 205,
+	204, 204, 204, 203, 203, 203, 202, 202, 202, 201, 201, 201,
+	200, 200, 200, 199, 199, 199, 198, 198, 198, 197, 197, 197,
+	196, 196, 196, 195, 195, 195, 194, 194, 194, 193, 193, 193,
+	192, 192, 192, 191, 191, 191, 190, 190, 190, 189, 189, 189,
+	188, 188, 188, 187, 187, 187, 186, 186, 186, 185, 185, 185,
+	184, 184, 184, 183, 183, 183, 182, 182, 182, 181, 181, 181,
+	180, 180, 180, 179, 179, 179, 178, 178, 178, 177, 177, 177,
+	176, 176, 176, 175, 175, 175, 174, 174, 174, 173, 173, 173,
+	172, 172, 172, 171, 171, 171, 170, 170, 170, 169, 169, 169,
+	168, 168, 168, 167, 167, 167, 166, 166, 166, 165, 165, 165,
+	164, 164, 164, 163, 163, 163, 162, 162, 162, 161, 161, 161,
+	160, 160, 160, 159, 159, 159, 158, 158, 158, 157, 157, 157,
+	156, 156, 156, 155, 155, 155, 154, 154, 154, 154, 154, 154,
+	153, 153, 153, 152, 152, 152, 151, 151, 151, 150, 150, 150,
+	149, 149, 149, 148, 148, 148, 147, 147, 147, 146, 146, 146,
+	145, 145, 145, 144, 144, 144, 143, 143, 143, 142, 142, 142,
+	141, 141, 141, 140, 140, 140, 139, 139, 139, 138, 138, 138,
+	137, 137, 137, 136, 136, 136, 135, 135, 135, 134, 134, 134,
+	133, 133, 133, 132, 132, 132, 131, 131, 131, 130, 130, 130,
+	129, 129, 129, 128, 128, 128, 127, 127, 127, 126, 126, 126,
+	125, 125, 125, 124, 124, 124, 123, 123, 123, 122, 122, 122,
+	121, 121, 121, 120, 120, 120, 119, 119, 119, 118, 118, 118,
+	117, 117, 117, 116, 116, 116, 115, 115, 115, 114, 114, 114,
+	113, 113, 113, 112, 112, 112, 111, 111, 111, 110, 110, 110,
+	109, 109, 109, 108, 108, 108, 107, 107, 107, 106, 106, 106,
+	105, 105, 105, 104, 104, 104, 103, 103, 103, 102, 102, 102,
+	101, 101, 101, 100, 100, 100,  99,  99,  99,  99,  99,  99,
+	 98,  98,  98,  97,  97,  97,  96,  96,  96,  95,  95,  95,
+	 94,  94,  94,  93,  93,  93,  92,  92,  92,  91,  91,  91,
+	 90,  90,  90,  89,  89,  89,  88,  88,  88,  87,  87,  87,
+	 86,  86,  86,  85,  85,  85,  84,  84,  84,  83,  83,  83,
+	 82,  82,  82,  81,  81,  81,  80,  80,  80,  79,  79,  79,
+	 78,  78,  78,  77,  77,  77,  76,  76,  76,  75,  75,  75,
+	 74,  74,  74,  73,  73,  73,  72,  72,  72,  71,  71,  71,
+	 70,  70,  70,  69,  69,  69,  68,  68,  68,  67,  67,  67,
+	 66,  66,  66,  65,  65,  65,  64,  64,  64,  63,  63,  63,
+	 62,  62,  62,  61,  61,  61,  60,  60,  60,  59,  59,  59,
+	 58,  58,  58,  57,  57,  57,  56,  56,  56,  55,  55,  55,
+	 54,  54,  54,  53,  53,  53,  52,  52,  52,  51,  51,  51,
+	 50,  50,  50,  49,  49,  49,  48,  48,  48,  47,  47,  47,
+	 46,  46,  46,  45,  45,  45,  44,  44,  44,  44,  44,  44,
+	 43,  43,  43,  42,  42,  42,  41,  41,  41,  40,  40,  40,
+	 39,  39,  39,  38,  38,  38,  37,  37,  37,  36,  36,  36,
+	 35,  35,  35,  34,  34,  34,  33,  33,  33,  32,  32,  32,
+	 31,  31,  31,  30,  30,  30,  29,  29,  29,  28,  28,  28,
+	 27,  27,  27,  26,  26,  26,  25,  25,  25,  24,  24,  24,
+	 23,  23,  23,  22,  22,  22,  21,  21,  21,  20,  20,  20,
+	 19,  19,  19,  18,  18,  18,  17,  17,  17,  16,  16,  16,
+	 19,  64, 206,  18,  65, 209,  18,  67, 210,  19,  69, 212,
+	 18,  71, 215,  19,  73, 217,  18,  75, 218,  18,  77, 219,
+	 19,  79, 223,  19,  82, 225,  19,  84, 226,  18,  85, 227,
+	 19,  88, 229,  21,  90, 229,  22,  93, 231,  21,  95, 230,
+	 22,  98, 232,  22, 101, 232,  22, 103, 232,  23, 106, 234,
+	 23, 109, 234,  24, 112, 236,  23, 114, 235,  25, 116, 235,
+	 25, 119, 237,  27, 122, 238,  26, 124, 237,  27, 125, 236,
+	 27, 127, 235,  27, 130, 236,  29, 133, 234,  30, 136, 234,
+};
+
+static const uint8_t blue_red_palette[PALETTE_LEN] = {
+	 19,  64, 206,  18,  65, 209,  18,  67, 210,  19,  69, 212,
+	 18,  71, 215,  19,  73, 217,  18,  75, 218,  18,  77, 219,
+	 19,  79, 223,  19,  82, 225,  19,  84, 226,  18,  85, 227,
+	 19,  88, 229,  21,  90, 229,  22,  93, 231,  21,  95, 230,
+	 22,  98, 232,  22, 101, 232,  22, 103, 232,  23, 106, 234,
+	 23, 109, 234,  24, 112, 236,  23, 114, 235,  25, 116, 235,
+	 25, 119, 237,  27, 122, 238,  26, 124, 237,  27, 125, 236,
+	 27, 127, 235,  27, 130, 236,  29, 133, 234,  30, 136, 234,
+	 31, 139, 233,  32, 141, 232,  33, 145, 231,  33, 147, 231,
+	 33, 150, 231,  34, 154, 229,  36, 156, 228,  36, 158, 227,
+	 36, 162, 225,  38, 165, 224,  40, 167, 222,  41, 171, 221,
+	 43, 174, 217,  45, 176, 216,  44, 178, 215,  46, 181, 212,
+	 48, 184, 210,  49, 188, 209,  51, 190, 207,  53, 193, 206,
+	 54, 195, 201,  56, 198, 200,  58, 200, 198,  59, 202, 196,
+	 61, 205, 192,  63, 206, 190,  64, 208, 187,  68, 210, 184,
+	 69, 212, 180,  71, 215, 178,  73, 216, 176,  74, 217, 173,
+	 78, 220, 170,  79, 222, 165,  82, 224, 164,  83, 225, 161,
+	 85, 227, 157,  88, 228, 154,  92, 228, 152,  94, 229, 149,
+	 96, 230, 147,  99, 231, 144, 102, 230, 141, 104, 231, 136,
+	106, 232, 134, 109, 233, 131, 113, 234, 129, 114, 234, 125,
+	116, 235, 123, 119, 236, 120, 122, 235, 117, 126, 233, 113,
+	128, 234, 112, 131, 233, 109, 134, 232, 107, 137, 231, 103,
+	139, 230, 102, 143, 231,  99, 146, 230,  96, 149, 229,  94,
+	152, 228,  90, 154, 227,  88, 156, 227,  87, 157, 226,  85,
+	161, 224,  83, 164, 223,  81, 166, 221,  79, 169, 220,  77,
+	172, 217,  74, 175, 216,  74, 178, 213,  70, 181, 212,  70,
+	183, 210,  67, 186, 207,  64, 189, 206,  62, 192, 205,  60,
+	194, 201,  58, 197, 200,  57, 200, 197,  54, 202, 195,  53,
+	205, 191,  52, 207, 189,  51, 208, 187,  48, 209, 183,  48,
+	212, 180,  45, 214, 178,  44, 216, 175,  43, 218, 173,  42,
+	220, 169,  40, 222, 166,  39, 224, 164,  38, 225, 162,  35,
+	228, 157,  35, 227, 153,  34, 228, 149,  32, 230, 147,  33,
+	232, 144,  32, 231, 141,  31, 232, 138,  29, 232, 136,  28,
+	233, 132,  28, 235, 130,  27, 234, 127,  27, 235, 123,  25,
+	237, 120,  26, 235, 118,  24, 234, 115,  24, 235, 113,  24,
+	234, 110,  24, 234, 108,  22, 232, 105,  22, 231, 102,  22,
+	231, 100,  21, 231,  97,  20, 230,  94,  20, 228,  92,  20,
+	228,  89,  18, 228,  87,  19, 227,  84,  18, 224,  82,  18,
+	223,  81,  19, 222,  78,  19, 219,  76,  19, 217,  74,  17,
+	215,  72,  18, 214,  71,  17, 211,  69,  17, 210,  66,  17,
+	207,  64,  16, 206,  63,  17, 205,  62,  18, 203,  60,  16,
+	202,  58,  17, 198,  57,  17, 196,  54,  16, 194,  54,  17,
+	190,  53,  15, 188,  50,  15, 185,  50,  16, 183,  48,  15,
+	179,  46,  15, 177,  46,  16, 175,  43,  16, 171,  42,  15,
+	169,  41,  14, 166,  40,  14, 164,  37,  14, 160,  38,  15,
+	157,  37,  16, 154,  35,  15, 152,  35,  16, 149,  34,  15,
+	147,  34,  16, 142,  33,  16, 140,  33,  15, 139,  31,  15,
+	134,  30,  15, 131,  30,  14, 128,  28,  14, 126,  28,  15,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  45,  45,  45,  46,  46,  46,
+	 47,  47,  47,  48,  48,  48,  49,  49,  49,  50,  50,  50,
+	 51,  51,  51,  52,  52,  52,  53,  53,  53,  54,  54,  54,
+	 55,  55,  55,  56,  56,  56,  57,  57,  57,  58,  58,  58,
+	 59,  59,  59,  60,  60,  60,  61,  61,  61,  62,  62,  62,
+	 63,  63,  63,  64,  64,  64,  65,  65,  65,  66,  66,  66,
+	 67,  67,  67,  68,  68,  68,  69,  69,  69,  70,  70,  70,
+	 71,  71,  71,  72,  72,  72,  73,  73,  73,  74,  74,  74,
+	 75,  75,  75,  76,  76,  76,  77,  77,  77,  78,  78,  78,
+};
+
+static const uint8_t coldest_palette[PALETTE_LEN] = {
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  15,  15, 239,  15,  15, 239,
+	 15,  15, 239,  15,  15, 239,  45,  45,  45,  46,  46,  46,
+	 47,  47,  47,  48,  48,  48,  49,  49,  49,  50,  50,  50,
+	 51,  51,  51,  52,  52,  52,  53,  53,  53,  54,  54,  54,
+	 55,  55,  55,  56,  56,  56,  57,  57,  57,  58,  58,  58,
+	 59,  59,  59,  60,  60,  60,  61,  61,  61,  62,  62,  62,
+	 63,  63,  63,  64,  64,  64,  65,  65,  65,  66,  66,  66,
+	 67,  67,  67,  68,  68,  68,  69,  69,  69,  70,  70,  70,
+	 71,  71,  71,  72,  72,  72,  73,  73,  73,  74,  74,  74,
+	 75,  75,  75,  76,  76,  76,  77,  77,  77,  78,  78,  78,
+	 79,  79,  79,  80,  80,  80,  81,  81,  81,  82,  82,  82,
+	 83,  83,  83,  84,  84,  84,  85,  85,  85,  86,  86,  86,
+	 87,  87,  87,  88,  88,  88,  89,  89,  89,  90,  90,  90,
+	 91,  91,  91,  92,  92,  92,  93,  93,  93,  94,  94,  94,
+	 95,  95,  95,  96,  96,  96,  97,  97,  97,  98,  98,  98,
+	 99,  99,  99,  99,  99,  99, 100, 100, 100, 101, 101, 101,
+	102, 102, 102, 103, 103, 103, 104, 104, 104, 105, 105, 105,
+	106, 106, 106, 107, 107, 107, 108, 108, 108, 109, 109, 109,
+	110, 110, 110, 111, 111, 111, 112, 112, 112, 113, 113, 113,
+	114, 114, 114, 115, 115, 115, 116, 116, 116, 117, 117, 117,
+	118, 118, 118, 119, 119, 119, 120, 120, 120, 121, 121, 121,
+	122, 122, 122, 123, 123, 123, 124, 124, 124, 125, 125, 125,
+	126, 126, 126, 127, 127, 127, 128, 128, 128, 129, 129, 129,
+	130, 130, 130, 131, 131, 131, 132, 132, 132, 133, 133, 133,
+	134, 134, 134, 135, 135, 135, 136, 136, 136, 137, 137, 137,
+	138, 138, 138, 139, 139, 139, 140, 140, 140, 141, 141, 141,
+	142, 142, 142, 143, 143, 143, 144, 144, 144, 145, 145, 145,
+	146, 146, 146, 147, 147, 147, 148, 148, 148, 149, 149, 149,
+	150, 150, 150, 151, 151, 151, 152, 152, 152, 153, 153, 153,
+	154, 154, 154, 154, 154, 154, 155, 155, 155, 156, 156, 156,
+	157, 157, 157, 158, 158, 158, 159, 159, 159, 160, 160, 160,
+	161, 161, 161, 162, 162, 162, 163, 163, 163, 164, 164, 164,
+	165, 165, 165, 166, 166, 166, 167, 167, 167, 168, 168, 168,
+	169, 169, 169, 170, 170, 170, 171, 171, 171, 172, 172, 172,
+	173, 173, 173, 174, 174, 174, 175, 175, 175, 176, 176, 176,
+	177, 177, 177, 178, 178, 178, 179, 179, 179, 180, 180, 180,
+	181, 181, 181, 182, 182, 182, 183, 183, 183, 184, 184, 184,
+	185, 185, 185, 186, 186, 186, 187, 187, 187, 188, 188, 188,
+	189, 189, 189, 190, 190, 190, 191, 191, 191, 192, 192, 192,
+	193, 193, 193, 194, 194, 194, 195, 195, 195, 196, 196, 196,
+	197, 197, 197, 198, 198, 198, 199, 199, 199, 200, 200, 200,
+	201, 201, 201, 202, 202, 202, 203, 203, 203, 204, 204, 204,
+	205, 205, 205, 206, 206, 206, 207, 207, 207, 208, 208, 208,
+	209, 209, 209, 209, 209, 209, 210, 210, 210, 211, 211, 211,
+	212, 212, 212, 213, 213, 213, 214, 214, 214, 215, 215, 215,
+	216, 216, 216, 217, 217, 217, 218, 218, 218, 219, 219, 219,
+	220, 220, 220, 221, 221, 221, 222, 222, 222, 223, 223, 223,
+	224, 224, 224, 225, 225, 225, 226, 226, 226, 227, 227, 227,
+	228, 228, 228, 229, 229, 229, 230, 230, 230, 231, 231, 231,
+	232, 232, 232, 233, 233, 233, 234, 234, 234, 235, 235, 235,
+	 16,  16,  16,  23,  16,  22,  30,  15,  30,  37,  16,  37,
+	 46,  15,  45,  53,  15,  52,  60,  15,  60,  67,  15,  67,
+	 75,  15,  75,  82,  15,  81,  89,  15,  90,  98,  14,  96,
+	105,  14, 105, 112,  14, 111, 120,  15, 121, 127,  15, 127,
+	135,  15, 135, 143,  14, 142, 150,  14, 150, 158,  14, 157,
+	165,  14, 165, 172,  14, 172, 179,  14, 180, 186,  14, 187,
+	195,  14, 195, 202,  14, 201, 209,  14, 210, 217,  14, 216,
+	209,  15, 214, 202,  14, 211, 194,  15, 209, 187,  14, 206,
+};
+
+static const uint8_t double_rainbow_palette[PALETTE_LEN] = {
+	 18,  15,  18,  25,  17,  26,  34,  18,  32,  43,  19,  39,
+	 52,  21,  48,  60,  23,  55,  69,  25,  62,  77,  26,  70,
+	 86,  28,  75,  95,  30,  84, 103,  31,  91, 112,  34,  98,
+	120,  35, 106, 129,  36, 111, 138,  39, 120, 146,  40, 128,
+	155,  42, 136, 150,  44, 140, 145,  47, 146, 139,  51, 151,
+	134,  54, 157, 130,  57, 161, 124,  60, 168, 119,  63, 172,
+	115,  66, 179, 109,  70, 183, 104,  73, 189,  99,  76, 194,
+	 93,  80, 200,  89,  83, 205,  84,  86, 211,  78,  90, 216,
+	 73,  92, 222,  69,  96, 227,  63,  99, 233,  59, 103, 238,
+	 57, 104, 230,  54, 107, 221,  50, 109, 213,  50, 113, 206,
+	 46, 115, 196,  45, 117, 189,  42, 120, 180,  39, 123, 171,
+	 38, 125, 164,  35, 127, 154,  32, 130, 147,  30, 133, 138,
+	 28, 135, 129,  25, 138, 122,  24, 140, 113,  21, 144, 104,
+	 20, 146,  97,  16, 148,  87,  14, 152,  81,  27, 153,  75,
+	 41, 157,  70,  54, 160,  64,  69, 164,  60,  84, 166,  54,
+	 98, 170,  49, 110, 173,  44, 123, 176,  38, 138, 180,  34,
+	151, 182,  28, 166, 186,  23, 179, 189,  18, 194, 193,  13,
+	194, 189,  13, 194, 186,  13, 193, 183,  14, 194, 180,  15,
+	194, 177,  15, 194, 174,  14, 193, 171,  14, 194, 169,  15,
+	193, 165,  15, 194, 161,  16, 194, 160,  15, 194, 156,  17,
+	194, 154,  18, 195, 150,  17, 194, 147,  17, 195, 145,  18,
+	195, 142,  18, 195, 138,  19, 194, 135,  19, 195, 133,  20,
+	195, 129,  20, 195, 126,  19, 195, 124,  22, 193, 118,  21,
+	191, 114,  24, 189, 109,  24, 188, 104,  27, 186, 100,  27,
+	185,  95,  29, 183,  91,  30, 181,  86,  32, 180,  82,  33,
+	178,  77,  35, 177,  73,  36, 176,  67,  38, 173,  63,  39,
+	172,  59,  41, 172,  54,  41, 169,  50,  44, 169,  45,  45,
+	170,  53,  60, 171,  61,  74, 174,  68,  90, 174,  76, 103,
+	177,  83, 119, 179,  92, 133, 181,  99, 149, 182, 107, 162,
+	185, 114, 178, 186, 123, 192, 187, 131, 208, 190, 139, 222,
+	193, 146, 238, 194, 149, 236, 195, 153, 238, 197, 158, 237,
+	199, 160, 237, 200, 165, 237, 203, 168, 236, 193, 169, 235,
+	185, 168, 232, 176, 168, 229, 166, 168, 228, 157, 168, 225,
+	149, 168, 222, 140, 170, 220, 131, 169, 218, 121, 170, 215,
+	113, 170, 212, 103, 170, 211,  94, 170, 208,  86, 171, 206,
+	 76, 171, 203,  68, 171, 202,  59, 171, 199,  51, 170, 196,
+	 41, 171, 195,  33, 172, 193,  23, 172, 190,  14, 172, 187,
+	 18, 173, 181,  24, 174, 174,  30, 175, 166,  33, 176, 160,
+	 39, 177, 152,  45, 178, 145,  49, 179, 139,  54, 180, 131,
+	 60, 181, 126,  64, 182, 118,  69, 183, 110,  74, 183, 104,
+	 79, 185,  97,  84, 186,  91,  88, 187,  83,  93, 187,  76,
+	 99, 189,  71, 103, 190,  63, 107, 191,  57, 113, 192,  50,
+	118, 193,  42, 122, 194,  36, 127, 195,  28, 133, 195,  20,
+	139, 196,  15, 143, 199,  14, 148, 200,  15, 151, 202,  13,
+	155, 204,  13, 161, 206,  15, 164, 208,  13, 169, 209,  13,
+	173, 211,  14, 178, 213,  13, 182, 214,  13, 187, 216,  14,
+	192, 217,  13, 196, 219,  13, 201, 221,  13, 205, 223,  13,
+	210, 224,  13, 213, 226,  11, 217, 228,  13, 222, 229,  13,
+	226, 231,  11, 231, 233,  13, 236, 234,  13, 236, 229,  13,
+	236, 224,  16, 237, 219,  17, 236, 214,  20, 236, 209,  22,
+	236, 203,  22, 236, 198,  25, 237, 193,  28, 236, 188,  30,
+	236, 183,  31, 236, 177,  33, 236, 172,  34, 236, 167,  36,
+	236, 162,  39, 238, 156,  42, 237, 151,  42, 237, 146,  45,
+	237, 140,  47, 238, 136,  48, 238, 131,  51, 237, 125,  53,
+	235, 118,  52, 235, 113,  52, 234, 105,  52, 233,  99,  52,
+	232,  93,  52, 231,  86,  53, 229,  80,  52, 230,  73,  52,
+	228,  67,  53, 227,  61,  53, 226,  54,  52, 225,  48,  52,
+	227,  56,  61, 227,  64,  69, 227,  73,  77, 227,  80,  86,
+	227,  88,  93, 229,  96, 101, 228, 105, 109, 230, 113, 118,
+	230, 121, 126, 231, 130, 136, 231, 138, 142, 230, 146, 150,
+	231, 154, 158, 233, 162, 166, 233, 170, 175, 232, 175, 178,
+	232, 179, 183, 233, 184, 189, 233, 189, 194, 233, 195, 198,
+	233, 199, 202, 235, 204, 206, 235, 208, 213, 234, 213, 216,
+	235, 218, 222, 235, 222, 227, 234, 227, 230, 235, 232, 235,
+};
+
+static const uint8_t fusion_palette[PALETTE_LEN] = {
+	  0,   2,  36,   1,   2,  37,   3,   3,  38,   3,   3,  39,
+	  5,   3,  41,   6,   3,  42,   8,   4,  44,   8,   4,  46,
+	 10,   4,  47,  12,   5,  49,  14,   5,  51,  15,   5,  53,
+	 17,   6,  56,  18,   6,  58,  20,   7,  61,  22,   6,  62,
+	 24,   7,  66,  26,   7,  68,  28,   8,  70,  30,   8,  73,
+	 32,   9,  75,  35,   9,  78,  36,   9,  81,  39,  10,  84,
+	 41,  10,  86,  43,  11,  89,  46,  11,  91,  47,  11,  95,
+	 50,  13,  97,  52,  13, 101,  55,  13, 103,  57,  13, 106,
+	 59,  14, 109,  61,  14, 111,  64,  16, 114,  66,  16, 116,
+	 68,  16, 119,  71,  16, 121,  74,  18, 123,  76,  18, 127,
+	 79,  18, 129,  81,  19, 131,  83,  20, 134,  86,  21, 135,
+	 88,  21, 137,  90,  22, 139,  93,  22, 141,  95,  23, 143,
+	 97,  24, 145, 100,  24, 147, 102,  25, 147, 104,  26, 149,
+	107,  26, 151, 109,  27, 151, 111,  28, 152, 114,  29, 153,
+	116,  29, 154, 117,  30, 155, 120,  31, 155, 122,  32, 155,
+	124,  33, 155, 126,  34, 155, 128,  34, 155, 130,  36, 155,
+	133,  36, 154, 134,  37, 153, 137,  38, 152, 139,  39, 151,
+	141,  40, 150, 144,  41, 148, 145,  42, 147, 147,  42, 145,
+	150,  43, 142, 152,  44, 141, 154,  45, 139, 156,  46, 136,
+	158,  47, 134, 161,  48, 131, 163,  49, 129, 166,  51, 126,
+	168,  51, 124, 170,  52, 121, 172,  53, 118, 175,  54, 115,
+	177,  55, 111, 179,  56, 108, 182,  58, 105, 184,  59, 102,
+	186,  60,  99, 188,  61,  95, 191,  62,  92, 192,  63,  89,
+	195,  64,  86, 197,  66,  82, 200,  67,  79, 202,  68,  75,
+	203,  69,  72, 206,  70,  69, 207,  71,  66, 210,  72,  62,
+	211,  74,  59, 214,  75,  56, 216,  76,  52, 218,  77,  49,
+	219,  79,  47, 222,  80,  44, 223,  82,  41, 225,  82,  37,
+	227,  85,  34, 229,  86,  32, 231,  87,  29, 232,  89,  27,
+	234,  90,  25, 236,  92,  22, 236,  93,  20, 239,  94,  18,
+	240,  95,  16, 241,  98,  14, 243,  99,  12, 244, 100,  10,
+	245, 102,   9, 246, 103,   8, 247, 105,   6, 248, 107,   6,
+	249, 107,   6, 250, 110,   6, 251, 111,   6, 251, 112,   6,
+	252, 114,   6, 253, 115,   6, 253, 117,   6, 253, 119,   6,
+	253, 120,   6, 253, 122,   6, 253, 124,   6, 253, 125,   6,
+	253, 127,   6, 253, 129,   6, 253, 130,   6, 253, 133,   6,
+	253, 134,   6, 253, 136,   6, 253, 138,   6, 253, 140,   6,
+	253, 141,   6, 253, 144,   6, 253, 146,   6, 253, 147,   6,
+	253, 149,   6, 253, 151,   6, 253, 154,   6, 253, 156,   6,
+	253, 158,   6, 253, 160,   6, 253, 162,   6, 253, 164,   6,
+	253, 166,   6, 253, 168,   6, 253, 170,   6, 253, 171,   6,
+	253, 174,   6, 253, 175,   6, 253, 178,   6, 253, 180,   6,
+	253, 181,   6, 253, 184,   7, 253, 186,   7, 253, 187,   8,
+	253, 189,  10, 253, 191,  10, 253, 193,  11, 253, 195,  12,
+	253, 196,  13, 253, 199,  14, 253, 200,  15, 253, 202,  16,
+	253, 204,  18, 253, 205,  19, 253, 207,  20, 253, 209,  22,
+	253, 210,  22, 253, 211,  24, 253, 214,  25, 253, 215,  26,
+	253, 216,  28, 253, 218,  29, 253, 219,  31, 253, 221,  31,
+	253, 223,  33, 253, 223,  35, 253, 225,  36, 253, 225,  38,
+	253, 227,  39, 253, 229,  42, 253, 230,  43, 253, 230,  44,
+	253, 232,  47, 253, 233,  49, 253, 233,  52, 253, 235,  54,
+	253, 236,  57, 254, 236,  60, 253, 237,  62, 253, 239,  65,
+	253, 239,  68, 254, 240,  72, 253, 241,  75, 254, 242,  78,
+	254, 242,  82, 253, 243,  86, 253, 244,  89, 253, 244,  93,
+	253, 245,  96, 254, 245, 100, 253, 246, 104, 254, 247, 108,
+	254, 247, 112, 254, 248, 115, 254, 248, 119, 254, 248, 124,
+	254, 248, 128, 254, 249, 132, 254, 249, 136, 253, 250, 141,
+	253, 250, 144, 254, 250, 149, 254, 250, 153, 254, 251, 157,
+	254, 251, 161, 254, 251, 165, 254, 251, 169, 253, 252, 173,
+	254, 252, 177, 254, 252, 181, 254, 252, 185, 254, 252, 189,
+	254, 252, 192, 254, 252, 196, 254, 253, 200, 254, 252, 204,
+	254, 253, 207, 254, 253, 211, 254, 253, 215, 254, 253, 218,
+	254, 253, 221, 254, 253, 224, 254, 254, 227, 254, 254, 230,
+	254, 254, 233, 254, 254, 236, 254, 254, 238, 254, 254, 240,
+	254, 255, 243, 254, 255, 245, 254, 254, 248, 255, 255, 255,
+};
+
+static const uint8_t glowbow_palette[PALETTE_LEN] = {
+	 16,  16,  16,  19,  17,  18,  22,  16,  16,  25,  17,  18,
+	 28,  17,  19,  31,  17,  20,  34,  17,  19,  36,  18,  20,
+	 39,  18,  19,  43,  19,  21,  45,  18,  21,  48,  20,  21,
+	 52,  19,  22,  54,  20,  23,  58,  20,  23,  63,  21,  23,
+	 68,  21,  25,  70,  21,  26,  73,  22,  27,  75,  22,  26,
+	 79,  22,  27,  81,  22,  28,  84,  23,  27,  87,  22,  28,
+	 91,  24,  30,  96,  23,  30, 102,  24,  33, 104,  25,  32,
+	108,  25,  33, 110,  25,  34, 117,  25,  34, 120,  27,  34,
+	122,  27,  35, 127,  28,  35, 129,  27,  35, 132,  29,  37,
+	135,  27,  37, 138,  29,  38, 141,  29,  39, 143,  29,  40,
+	147,  29,  41, 150,  31,  41, 152,  30,  41, 155,  29,  42,
+	158,  30,  41, 165,  31,  44, 167,  32,  43, 170,  32,  44,
+	175,  33,  45, 177,  33,  46, 178,  32,  46, 182,  32,  45,
+	186,  33,  47, 188,  34,  48, 190,  34,  47, 194,  34,  48,
+	195,  35,  49, 195,  35,  47, 197,  38,  48, 196,  39,  46,
+	198,  39,  45, 199,  41,  44, 200,  42,  43, 201,  43,  43,
+	200,  44,  41, 201,  45,  42, 203,  46,  41, 204,  47,  42,
+	204,  47,  40, 205,  49,  40, 205,  49,  38, 206,  52,  38,
+	207,  52,  36, 208,  53,  37, 209,  54,  36, 210,  55,  36,
+	210,  58,  35, 211,  59,  34, 212,  60,  33, 213,  60,  33,
+	214,  61,  33, 213,  62,  31, 215,  64,  33, 215,  64,  31,
+	216,  66,  30, 218,  66,  30, 218,  66,  30, 218,  68,  29,
+	219,  70,  28, 220,  69,  28, 221,  72,  26, 223,  73,  26,
+	222,  74,  24, 223,  75,  25, 224,  76,  24, 225,  78,  23,
+	225,  78,  22, 226,  79,  23, 227,  80,  22, 227,  81,  20,
+	228,  82,  21, 229,  83,  20, 230,  83,  18, 231,  86,  19,
+	231,  86,  17, 232,  87,  16, 233,  88,  17, 234,  90,  16,
+	235,  91,  14, 235,  91,  14, 236,  93,  13, 237,  94,  12,
+	236,  96,  13, 237,  97,  13, 237,  99,  14, 237, 101,  13,
+	236, 103,  12, 236, 105,  13, 237, 106,  12, 236, 108,  11,
+	236, 112,  12, 237, 113,  13, 236, 115,  12, 236, 117,  13,
+	235, 119,  12, 236, 122,  12, 237, 123,  13, 237, 125,  13,
+	236, 127,  12, 236, 129,  13, 237, 130,  12, 236, 132,  13,
+	236, 134,  12, 237, 135,  12, 237, 137,  13, 237, 142,  12,
+	236, 144,  13, 236, 146,  12, 237, 147,  13, 237, 149,  12,
+	236, 151,  13, 237, 152,  13, 237, 154,  12, 236, 156,  13,
+	236, 158,  12, 236, 160,  11, 235, 161,  12, 236, 163,  12,
+	236, 165,  13, 235, 167,  12, 236, 170,  12, 236, 172,  11,
+	235, 173,  12, 236, 176,  12, 235, 179,  12, 236, 180,  13,
+	236, 182,  12, 236, 184,  11, 237, 185,  12, 236, 187,  11,
+	236, 188,  12, 235, 190,  12, 236, 191,  13, 235, 194,  12,
+	236, 196,  11, 235, 199,  11, 236, 201,  11, 235, 202,  12,
+	235, 204,  14, 236, 204,  19, 236, 205,  23, 236, 204,  27,
+	235, 206,  30, 236, 206,  34, 236, 207,  37, 236, 207,  41,
+	235, 208,  45, 236, 208,  48, 236, 209,  52, 236, 209,  56,
+	235, 211,  65, 236, 212,  68, 235, 212,  71, 236, 212,  74,
+	234, 212,  78, 235, 213,  82, 235, 214,  87, 236, 214,  91,
+	236, 215,  94, 235, 217,  97, 235, 216, 100, 235, 217, 105,
+	235, 216, 108, 234, 218, 111, 235, 218, 116, 235, 219, 122,
+	235, 220, 127, 236, 220, 131, 235, 221, 134, 235, 221, 138,
+	235, 222, 142, 235, 221, 146, 234, 222, 148, 235, 223, 153,
+	235, 224, 157, 235, 225, 160, 236, 225, 165, 234, 225, 168,
+	235, 226, 171, 235, 225, 175, 236, 227, 182, 235, 228, 187,
+	234, 228, 190, 234, 229, 195, 235, 230, 197, 236, 230, 202,
+	234, 230, 205, 235, 231, 208, 235, 232, 213, 235, 231, 216,
+	234, 232, 219, 234, 234, 224, 235, 234, 228, 235, 235, 235,
+	 16,  16,  16,  17,  17,  17,  18,  18,  18,  19,  19,  19,
+	 20,  20,  20,  21,  21,  21,  22,  22,  22,  23,  23,  23,
+	 24,  24,  24,  25,  25,  25,  26,  26,  26,  27,  27,  27,
+	 28,  28,  28,  29,  29,  29,  30,  30,  30,  31,  31,  31,
+	 32,  32,  32,  33,  33,  33,  34,  34,  34,  35,  35,  35,
+	 36,  36,  36,  37,  37,  37,  38,  38,  38,  39,  39,  39,
+	 40,  40,  40,  41,  41,  41,  42,  42,  42,  43,  43,  43,
+	 44,  44,  44,  44,  44,  44,  45,  45,  45,  46,  46,  46,
+};
+
+static const uint8_t gray_palette[PALETTE_LEN] = {
+	  0,   0,   0,   1,   1,   1,   2,   2,   2,   3,   3,   3,
+	  4,   4,   4,   5,   5,   5,   6,   6,   6,   7,   7,   7,
+	  8,   8,   8,   9,   9,   9,  10,  10,  10,  11,  11,  11,
+	 12,  12,  12,  13,  13,  13,  14,  14,  14,  15,  15,  15,
+	 16,  16,  16,  17,  17,  17,  18,  18,  18,  19,  19,  19,
+	 20,  20,  20,  21,  21,  21,  22,  22,  22,  23,  23,  23,
+	 24,  24,  24,  25,  25,  25,  26,  26,  26,  27,  27,  27,
+	 28,  28,  28,  29,  29,  29,  30,  30,  30,  31,  31,  31,
+	 32,  32,  32,  33,  33,  33,  34,  34,  34,  35,  35,  35,
+	 36,  36,  36,  37,  37,  37,  38,  38,  38,  39,  39,  39,
+	 40,  40,  40,  41,  41,  41,  42,  42,  42,  43,  43,  43,
+	 44,  44,  44,  45,  45,  45,  46,  46,  46,  47,  47,  47,
+	 48,  48,  48,  49,  49,  49,  50,  50,  50,  51,  51,  51,
+	 52,  52,  52,  53,  53,  53,  54,  54,  54,  55,  55,  55,
+	 56,  56,  56,  57,  57,  57,  58,  58,  58,  59,  59,  59,
+	 60,  60,  60,  61,  61,  61,  62,  62,  62,  63,  63,  63,
+	 64,  64,  64,  65,  65,  65,  66,  66,  66,  67,  67,  67,
+	 68,  68,  68,  69,  69,  69,  70,  70,  70,  71,  71,  71,
+	 72,  72,  72,  73,  73,  73,  74,  74,  74,  75,  75,  75,
+	 76,  76,  76,  77,  77,  77,  78,  78,  78,  79,  79,  79,
+	 80,  80,  80,  81,  81,  81,  82,  82,  82,  83,  83,  83,
+	 84,  84,  84,  85,  85,  85,  86,  86,  86,  87,  87,  87,
+	 88,  88,  88,  89,  89,  89,  90,  90,  90,  91,  91,  91,
+	 92,  92,  92,  93,  93,  93,  94,  94,  94,  95,  95,  95,
+	 96,  96,  96,  97,  97,  97,  98,  98,  98,  99,  99,  99,
+	100, 100, 100, 101, 101, 101, 102, 102, 102, 103, 103, 103,
+	104, 104, 104, 105, 105, 105, 106, 106, 106, 107, 107, 107,
+	108, 108, 108, 109, 109, 109, 110, 110, 110, 111, 111, 111,
+	112, 112, 112, 113, 113, 113, 114, 114, 114, 115, 115, 115,
+	116, 116, 116, 117, 117, 117, 118, 118, 118, 119, 119, 119,
+	120, 120, 120, 121, 121, 121, 122, 122, 122, 123, 123, 123,
+	124, 124, 124, 125, 125, 125, 126, 126, 126, 127, 127, 127,
+	128, 128, 128, 129, 129, 129, 130, 130, 130, 131, 131, 131,
+	132, 132, 132, 133, 133, 133, 134, 134, 134, 135, 135, 135,
+	136, 136, 136, 137, 137, 137, 138, 138, 138, 139, 139, 139,
+	140, 140, 140, 141, 141, 141, 142, 142, 142, 143, 143, 143,
+	144, 144, 144, 145, 145, 145, 146, 146, 146, 147, 147, 147,
+	148, 148, 148, 149, 149, 149, 150, 150, 150, 151, 151, 151,
+	152, 152, 152, 153, 153, 153, 154, 154, 154, 155, 155, 155,
+	156, 156, 156, 157, 157, 157, 158, 158, 158, 159, 159, 159,
+	160, 160, 160, 161, 161, 161, 162, 162, 162, 163, 163, 163,
+	164, 164, 164, 165, 165, 165, 166, 166, 166, 167, 167, 167,
+	168, 168, 168, 169, 169, 169, 170, 170, 170, 171, 171, 171,
+	172, 172, 172, 173, 173, 173, 174, 174, 174, 175, 175, 175,
+	176, 176, 176, 177, 177, 177, 178, 178, 178, 179, 179, 179,
+	180, 180, 180, 181, 181, 181, 182, 182, 182, 183, 183, 183,
+	184, 184, 184, 185, 185, 185, 186, 186, 186, 187, 187, 187,
+	188, 188, 188, 189, 189, 189, 190, 190, 190, 191, 191, 191,
+	192, 192, 192, 193, 193, 193, 194, 194, 194, 195, 195, 195,
+	196, 196, 196, 197, 197, 197, 198, 198, 198, 199, 199, 199,
+	200, 200, 200, 201, 201, 201, 202, 202, 202, 203, 203, 203,
+	204, 204, 204, 205, 205, 205, 206, 206, 206, 207, 207, 207,
+	208, 208, 208, 209, 209, 209, 210, 210, 210, 211, 211, 211,
+	212, 212, 212, 213, 213, 213, 214, 214, 214, 215, 215, 215,
+	216, 216, 216, 217, 217, 217, 218, 218, 218, 219, 219, 219,
+	220, 220, 220, 221, 221, 221, 222, 222, 222, 223, 223, 223,
+	224, 224, 224, 225, 225, 225, 226, 226, 226, 227, 227, 227,
+	228, 228, 228, 229, 229, 229, 230, 230, 230, 231, 231, 231,
+	232, 232, 232, 233, 233, 233, 234, 234, 234, 235, 235, 235,
+	236, 236, 236, 237, 237, 237, 238, 238, 238, 239, 239, 239,
+	240, 240, 240, 241, 241, 241, 242, 242, 242, 243, 243, 243,
+	244, 244, 244, 245, 245, 245, 246, 246, 246, 247, 247, 247,
+	248, 248, 248, 249, 249, 249, 250, 250, 250, 251, 251, 251,
+	252, 252, 252, 253, 253, 253, 254, 254, 254, 255, 255, 255,
+};
+
+static const uint8_t gray_red_palette[PALETTE_LEN] = {
+	218, 186, 175, 216, 186, 174, 214, 186, 173, 213, 185, 172,
+	212, 184, 171, 209, 183, 170, 206, 182, 170, 205, 181, 169,
+	202, 180, 168, 202, 180, 168, 199, 179, 168, 197, 178, 167,
+	194, 178, 166, 193, 177, 166, 191, 177, 165, 186, 176, 165,
+	185, 175, 164, 182, 173, 162, 180, 174, 162, 177, 172, 162,
+	174, 172, 161, 172, 170, 159, 170, 170, 160, 168, 169, 159,
+	165, 169, 158, 162, 167, 157, 160, 168, 157, 157, 167, 155,
+	156, 166, 154, 153, 165, 155, 149, 164, 155, 146, 164, 154,
+	143, 163, 152, 140, 162, 153, 137, 161, 151, 136, 160, 150,
+	134, 159, 149, 131, 159, 150, 128, 157, 148, 126, 158, 148,
+	124, 156, 147, 122, 156, 146, 120, 155, 147, 117, 155, 146,
+	115, 154, 145, 110, 152, 144, 109, 152, 144, 106, 151, 142,
+	105, 150, 141, 101, 149, 141, 100, 149, 141,  99, 148, 140,
+	 96, 148, 139,  93, 146, 138,  92, 147, 138,  91, 146, 137,
+	 90, 145, 138,  86, 143, 136,  85, 142, 135,  83, 142, 134,
+	 80, 142, 133,  77, 140, 133,  76, 139, 132,  75, 138, 131,
+	 74, 137, 130,  72, 137, 129,  71, 136, 130,  69, 137, 128,
+	 68, 136, 127,  67, 134, 128,  66, 133, 127,  65, 134, 127,
+	 64, 133, 126,  63, 132, 125,  62, 131, 124,  61, 130, 123,
+	 60, 129, 122,  59, 128, 121,  59, 128, 121,  58, 127, 120,
+	 58, 125, 119,  58, 125, 119,  57, 124, 118,  58, 123, 117,
+	 58, 123, 117,  58, 123, 117,  57, 122, 116,  56, 121, 115,
+	 56, 121, 115,  57, 120, 115,  58, 117, 111,  58, 117, 111,
+	 59, 116, 111,  59, 116, 111,  60, 114, 110,  60, 115, 108,
+	 61, 114, 108,  61, 112, 107,  61, 112, 107,  63, 112, 107,
+	 63, 112, 107,  63, 110, 104,  65, 109, 104,  66, 109, 104,
+	 67, 108, 104,  69, 106, 102,  72, 107, 101,  72, 105, 100,
+	 73, 104, 100,  75, 103, 100,  78, 102,  98,  77, 101,  97,
+	 79, 102,  98,  82, 101,  96,  83, 100,  96,  85,  99,  96,
+	 86,  99,  95,  89,  98,  93,  90,  97,  93,  92,  95,  92,
+	 96,  94,  91,  97,  94,  91, 100,  93,  89, 103,  93,  90,
+	104,  93,  88, 107,  91,  88, 107,  90,  86, 111,  89,  87,
+	112,  89,  87, 114,  88,  85, 117,  87,  83, 120,  87,  84,
+	122,  86,  84, 125,  85,  82, 126,  84,  82, 130,  82,  81,
+	134,  82,  80, 135,  82,  78, 138,  81,  78, 140,  80,  78,
+	143,  80,  77, 145,  79,  77, 148,  78,  75, 150,  77,  75,
+	153,  77,  75, 154,  77,  73, 157,  75,  73, 159,  73,  72,
+	163,  73,  71, 164,  72,  71, 168,  70,  69, 171,  71,  69,
+	173,  70,  69, 176,  68,  67, 178,  68,  67, 180,  67,  65,
+	182,  66,  65, 184,  66,  66, 187,  65,  64, 188,  64,  64,
+	191,  63,  63, 193,  63,  63, 194,  62,  61, 197,  61,  61,
+	198,  60,  61, 202,  59,  57, 204,  58,  57, 205,  57,  57,
+	208,  58,  56, 209,  57,  56, 212,  56,  56, 213,  55,  55,
+	214,  54,  54, 216,  53,  52, 218,  52,  52, 219,  51,  52,
+	221,  51,  50, 222,  50,  50, 223,  49,  50, 225,  49,  48,
+	227,  47,  47, 228,  48,  48, 228,  46,  47, 229,  45,  46,
+	231,  45,  46, 231,  45,  46, 232,  44,  46, 233,  43,  43,
+	234,  42,  43, 234,  40,  42, 234,  40,  42, 236,  40,  42,
+	236,  38,  41, 236,  38,  39, 238,  37,  39, 236,  35,  37,
+	237,  35,  35, 237,  35,  35, 236,  34,  36, 238,  33,  34,
+	237,  32,  35, 238,  31,  35, 237,  31,  32, 236,  30,  31,
+	235,  29,  30, 235,  29,  30, 235,  29,  30, 234,  28,  29,
+	234,  26,  28, 233,  25,  27, 232,  24,  26, 232,  24,  26,
+	231,  23,  25, 231,  23,  25, 230,  22,  24, 232,  21,  24,
+	231,  20,  23, 230,  19,  22, 229,  18,  21, 230,  18,  21,
+	229,  17,  20, 229,  17,  20, 228,  16,  19, 227,  15,  18,
+	 16,  16,  16,  19,  17,  18,  22,  16,  16,  25,  17,  18,
+	 28,  17,  19,  31,  17,  20,  34,  17,  19,  36,  18,  20,
+	 39,  18,  19,  43,  19,  21,  45,  18,  21,  48,  20,  21,
+	 52,  19,  22,  54,  20,  23,  58,  20,  23,  63,  21,  23,
+	 68,  21,  25,  70,  21,  26,  73,  22,  27,  75,  22,  26,
+	 79,  22,  27,  81,  22,  28,  84,  23,  27,  87,  22,  28,
+	 91,  24,  30,  96,  23,  30, 102,  24,  33, 104,  25,  32,
+	108,  25,  33, 110,  25,  34, 117,  25,  34, 120,  27,  34,
+};
+
+static const uint8_t hottest_palette[PALETTE_LEN] = {
+	 16,  16,  16,  17,  17,  17,  18,  18,  18,  19,  19,  19,
+	 20,  20,  20,  21,  21,  21,  22,  22,  22,  23,  23,  23,
+	 24,  24,  24,  25,  25,  25,  26,  26,  26,  27,  27,  27,
+	 28,  28,  28,  29,  29,  29,  30,  30,  30,  31,  31,  31,
+	 32,  32,  32,  33,  33,  33,  34,  34,  34,  35,  35,  35,
+	 36,  36,  36,  37,  37,  37,  38,  38,  38,  39,  39,  39,
+	 40,  40,  40,  41,  41,  41,  42,  42,  42,  43,  43,  43,
+	 44,  44,  44,  44,  44,  44,  45,  45,  45,  46,  46,  46,
+	 47,  47,  47,  48,  48,  48,  49,  49,  49,  50,  50,  50,
+	 51,  51,  51,  52,  52,  52,  53,  53,  53,  54,  54,  54,
+	 55,  55,  55,  56,  56,  56,  57,  57,  57,  58,  58,  58,
+	 59,  59,  59,  60,  60,  60,  61,  61,  61,  62,  62,  62,
+	 63,  63,  63,  64,  64,  64,  65,  65,  65,  66,  66,  66,
+	 67,  67,  67,  68,  68,  68,  69,  69,  69,  70,  70,  70,
+	 71,  71,  71,  72,  72,  72,  73,  73,  73,  74,  74,  74,
+	 75,  75,  75,  76,  76,  76,  77,  77,  77,  78,  78,  78,
+	 79,  79,  79,  80,  80,  80,  81,  81,  81,  82,  82,  82,
+	 83,  83,  83,  84,  84,  84,  85,  85,  85,  86,  86,  86,
+	 87,  87,  87,  88,  88,  88,  89,  89,  89,  90,  90,  90,
+	 91,  91,  91,  92,  92,  92,  93,  93,  93,  94,  94,  94,
+	 95,  95,  95,  96,  96,  96,  97,  97,  97,  98,  98,  98,
+	 99,  99,  99,  99,  99,  99, 100, 100, 100, 101, 101, 101,
+	102, 102, 102, 103, 103, 103, 104, 104, 104, 105, 105, 105,
+	106, 106, 106, 107, 107, 107, 108, 108, 108, 109, 109, 109,
+	110, 110, 110, 111, 111, 111, 112, 112, 112, 113, 113, 113,
+	114, 114, 114, 115, 115, 115, 116, 116, 116, 117, 117, 117,
+	118, 118, 118, 119, 119, 119, 120, 120, 120, 121, 121, 121,
+	122, 122, 122, 123, 123, 123, 124, 124, 124, 125, 125, 125,
+	126, 126, 126, 127, 127, 127, 128, 128, 128, 129, 129, 129,
+	130, 130, 130, 131, 131, 131, 132, 132, 132, 133, 133, 133,
+	134, 134, 134, 135, 135, 135, 136, 136, 136, 137, 137, 137,
+	138, 138, 138, 139, 139, 139, 140, 140, 140, 141, 141, 141,
+	142, 142, 142, 143, 143, 143, 144, 144, 144, 145, 145, 145,
+	146, 146, 146, 147, 147, 147, 148, 148, 148, 149, 149, 149,
+	150, 150, 150, 151, 151, 151, 152, 152, 152, 153, 153, 153,
+	154, 154, 154, 154, 154, 154, 155, 155, 155, 156, 156, 156,
+	157, 157, 157, 158, 158, 158, 159, 159, 159, 160, 160, 160,
+	161, 161, 161, 162, 162, 162, 163, 163, 163, 164, 164, 164,
+	165, 165, 165, 166, 166, 166, 167, 167, 167, 168, 168, 168,
+	169, 169, 169, 170, 170, 170, 171, 171, 171, 172, 172, 172,
+	173, 173, 173, 174, 174, 174, 175, 175, 175, 176, 176, 176,
+	177, 177, 177, 178, 178, 178, 179, 179, 179, 180, 180, 180,
+	181, 181, 181, 182, 182, 182, 183, 183, 183, 184, 184, 184,
+	185, 185, 185, 186, 186, 186, 187, 187, 187, 188, 188, 188,
+	189, 189, 189, 190, 190, 190, 191, 191, 191, 192, 192, 192,
+	193, 193, 193, 194, 194, 194, 195, 195, 195, 196, 196, 196,
+	197, 197, 197, 198, 198, 198, 199, 199, 199, 200, 200, 200,
+	201, 201, 201, 202, 202, 202, 203, 203, 203, 204, 204, 204,
+	205, 205, 205, 206, 206, 206, 190,  14,  13, 190,  14,  13,
+	190,  14,  13, 190,  14,  13, 190,  14,  13, 190,  14,  13,
+	190,  14,  13, 190,  14,  13, 190,  14,  13, 190,  14,  13,
+	190,  14,  13, 190,  14,  13, 190,  14,  13, 190,  14,  13,
+	190,  14,  13, 190,  14,  13, 190,  14,  13, 190,  14,  13,
+	190,  14,  13, 190,  14,  13, 190,  14,  13, 190,  14,  13,
+	190,  14,  13, 190,  14,  13, 190,  14,  13, 190,  14,  13,
+	190,  14,  13, 190,  14,  13, 190,  14,  13, 190,  14,  13,
+	 16,  16,  16,  17,  19,  22,  19,  21,  30,  20,  24,  37,
+	 22,  27,  43,  22,  31,  50,  24,  32,  57,  25,  37,  65,
+	 26,  39,  70,  28,  43,  78,  29,  44,  85,  31,  47,  94,
+	 32,  50, 100,  34,  53, 107,  34,  57, 113,  37,  59, 122,
+	 37,  63, 128,  39,  66, 135,  40,  69, 141,  42,  71, 149,
+	 44,  74, 156,  41,  76, 156,  41,  76, 156,  39,  78, 157,
+	 36,  80, 155,  36,  82, 156,  34,  82, 156,  33,  85, 157,
+	 31,  86, 157,  30,  86, 157,  29,  88, 156,  28,  91, 157,
+};
+
+static const uint8_t ironblack_palette[PALETTE_LEN] = {
+	255, 255, 255, 253, 253, 253, 251, 251, 251, 249, 249, 249,
+	247, 247, 247, 245, 245, 245, 243, 243, 243, 241, 241, 241,
+	239, 239, 239, 237, 237, 237, 235, 235, 235, 233, 233, 233,
+	231, 231, 231, 229, 229, 229, 227, 227, 227, 225, 225, 225,
+	223, 223, 223, 221, 221, 221, 219, 219, 219, 217, 217, 217,
+	215, 215, 215, 213, 213, 213, 211, 211, 211, 209, 209, 209,
+	207, 207, 207, 205, 205, 205, 203, 203, 203, 201, 201, 201,
+	199, 199, 199, 197, 197, 197, 195, 195, 195, 193, 193, 193,
+	191, 191, 191, 189, 189, 189, 187, 187, 187, 185, 185, 185,
+	183, 183, 183, 181, 181, 181, 179, 179, 179, 177, 177, 177,
+	175, 175, 175, 173, 173, 173, 171, 171, 171, 169, 169, 169,
+	167, 167, 167, 165, 165, 165, 163, 163, 163, 161, 161, 161,
+	159, 159, 159, 157, 157, 157, 155, 155, 155, 153, 153, 153,
+	151, 151, 151, 149, 149, 149, 147, 147, 147, 145, 145, 145,
+	143, 143, 143, 141, 141, 141, 139, 139, 139, 137, 137, 137,
+	135, 135, 135, 133, 133, 133, 131, 131, 131, 129, 129, 129,
+	126, 126, 126, 124, 124, 124, 122, 122, 122, 120, 120, 120,
+	118, 118, 118, 116, 116, 116, 114, 114, 114, 112, 112, 112,
+	110, 110, 110, 108, 108, 108, 106, 106, 106, 104, 104, 104,
+	102, 102, 102, 100, 100, 100,  98,  98,  98,  96,  96,  96,
+	 94,  94,  94,  92,  92,  92,  90,  90,  90,  88,  88,  88,
+	 86,  86,  86,  84,  84,  84,  82,  82,  82,  80,  80,  80,
+	 78,  78,  78,  76,  76,  76,  74,  74,  74,  72,  72,  72,
+	 70,  70,  70,  68,  68,  68,  66,  66,  66,  64,  64,  64,
+	 62,  62,  62,  60,  60,  60,  58,  58,  58,  56,  56,  56,
+	 54,  54,  54,  52,  52,  52,  50,  50,  50,  48,  48,  48,
+	 46,  46,  46,  44,  44,  44,  42,  42,  42,  40,  40,  40,
+	 38,  38,  38,  36,  36,  36,  34,  34,  34,  32,  32,  32,
+	 30,  30,  30,  28,  28,  28,  26,  26,  26,  24,  24,  24,
+	 22,  22,  22,  20,  20,  20,  18,  18,  18,  16,  16,  16,
+	 14,  14,  14,  12,  12,  12,  10,  10,  10,   8,   8,   8,
+	  6,   6,   6,   4,   4,   4,   2,   2,   2,   0,   0,   0,
+	  0,   0,   9,   2,   0,  16,   4,   0,  24,   6,   0,  31,
+	  8,   0,  38,  10,   0,  45,  12,   0,  53,  14,   0,  60,
+	 17,   0,  67,  19,   0,  74,  21,   0,  82,  23,   0,  89,
+	 25,   0,  96,  27,   0, 103,  29,   0, 111,  31,   0, 118,
+	 36,   0, 120,  41,   0, 121,  46,   0, 122,  51,   0, 123,
+	 56,   0, 124,  61,   0, 125,  66,   0, 126,  71,   0, 127,
+	 76,   1, 128,  81,   1, 129,  86,   1, 130,  91,   1, 131,
+	 96,   1, 132, 101,   1, 133, 106,   1, 134, 111,   1, 135,
+	116,   1, 136, 121,   1, 136, 125,   2, 137, 130,   2, 137,
+	135,   3, 137, 139,   3, 138, 144,   3, 138, 149,   4, 138,
+	153,   4, 139, 158,   5, 139, 163,   5, 139, 167,   5, 140,
+	172,   6, 140, 177,   6, 140, 181,   7, 141, 186,   7, 141,
+	189,  10, 137, 191,  13, 132, 194,  16, 127, 196,  19, 121,
+	198,  22, 116, 200,  25, 111, 203,  28, 106, 205,  31, 101,
+	207,  34,  95, 209,  37,  90, 212,  40,  85, 214,  43,  80,
+	216,  46,  75, 218,  49,  69, 221,  52,  64, 223,  55,  59,
+	224,  57,  49, 225,  60,  47, 226,  64,  44, 227,  67,  42,
+	228,  71,  39, 229,  74,  37, 230,  78,  34, 231,  81,  32,
+	231,  85,  29, 232,  88,  27, 233,  92,  24, 234,  95,  22,
+	235,  99,  19, 236, 102,  17, 237, 106,  14, 238, 109,  12,
+	239, 112,  12, 240, 116,  12, 240, 119,  12, 241, 123,  12,
+	241, 127,  12, 242, 130,  12, 242, 134,  12, 243, 138,  12,
+	243, 141,  13, 244, 145,  13, 244, 149,  13, 245, 152,  13,
+	245, 156,  13, 246, 160,  13, 246, 163,  13, 247, 167,  13,
+	247, 171,  13, 248, 175,  14, 248, 178,  15, 249, 182,  16,
+	249, 185,  18, 250, 189,  19, 250, 192,  20, 251, 196,  21,
+	251, 199,  22, 252, 203,  23, 252, 206,  24, 253, 210,  25,
+	253, 213,  27, 254, 217,  28, 254, 220,  29, 255, 224,  30,
+	255, 227,  39, 255, 229,  53, 255, 231,  67, 255, 233,  81,
+	255, 234,  95, 255, 236, 109, 255, 238, 123, 255, 240, 137,
+	255, 242, 151, 255, 244, 165, 255, 246, 179, 255, 248, 193,
+	255, 249, 207, 255, 251, 221, 255, 253, 235, 255, 255,  24,
+};
+
+static const uint8_t lava_palette[PALETTE_LEN] = {
+	 16,  16,  16,  17,  19,  22,  19,  21,  30,  20,  24,  37,
+	 22,  27,  43,  22,  31,  50,  24,  32,  57,  25,  37,  65,
+	 26,  39,  70,  28,  43,  78,  29,  44,  85,  31,  47,  94,
+	 32,  50, 100,  34,  53, 107,  34,  57, 113,  37,  59, 122,
+	 37,  63, 128,  39,  66, 135,  40,  69, 141,  42,  71, 149,
+	 44,  74, 156,  41,  76, 156,  41,  76, 156,  39,  78, 157,
+	 36,  80, 155,  36,  82, 156,  34,  82, 156,  33,  85, 157,
+	 31,  86, 157,  30,  86, 157,  29,  88, 156,  28,  91, 157,
+	 26,  91, 157,  26,  93, 158,  23,  95, 158,  21,  97, 159,
+	 20,  98, 159,  18,  99, 158,  17, 101, 160,  15, 102, 159,
+	 15, 104, 160,  13, 105, 158,  13, 105, 158,  14, 106, 157,
+	 13, 107, 157,  14, 108, 156,  14, 110, 156,  14, 111, 154,
+	 15, 112, 155,  13, 113, 153,  13, 113, 151,  14, 114, 152,
+	 14, 114, 151,  14, 116, 152,  14, 116, 150,  13, 118, 149,
+	 13, 119, 147,  14, 120, 148,  13, 121, 146,  14, 122, 146,
+	 14, 122, 146,  14, 124, 145,  14, 125, 143,  15, 126, 144,
+	 14, 125, 143,  15, 126, 142,  13, 127, 142,  14, 128, 142,
+	 14, 128, 140,  14, 130, 139,  14, 130, 139,  14, 130, 139,
+	 14, 131, 137,  13, 133, 136,  13, 133, 135,  14, 134, 136,
+	 13, 135, 134,  13, 135, 134,  13, 135, 134,  14, 137, 133,
+	 14, 137, 131,  19, 133, 130,  24, 130, 132,  30, 125, 131,
+	 35, 121, 130,  39, 118, 129,  46, 114, 129,  50, 109, 127,
+	 56, 106, 127,  62, 101, 128,  67,  99, 126,  73,  94, 125,
+	 78,  90, 126,  84,  85, 125,  89,  82, 124,  93,  78, 123,
+	 99,  73, 122, 105,  70, 122, 109,  66, 121, 115,  62, 122,
+	120,  58, 121, 123,  57, 119, 124,  57, 115, 127,  56, 114,
+	130,  54, 112, 133,  54, 108, 134,  53, 108, 136,  51, 104,
+	137,  51, 102, 140,  50, 100, 144,  50,  98, 145,  50,  96,
+	148,  49,  94, 148,  47,  91, 151,  46,  90, 154,  45,  88,
+	155,  45,  84, 158,  44,  84, 161,  43,  81, 162,  42,  79,
+	165,  41,  77, 167,  41,  75, 168,  41,  74, 169,  40,  72,
+	171,  40,  72, 172,  39,  70, 174,  39,  67, 175,  38,  67,
+	176,  38,  65, 178,  38,  63, 180,  38,  62, 182,  38,  60,
+	183,  37,  60, 184,  37,  59, 186,  37,  57, 187,  36,  55,
+	189,  36,  53, 190,  35,  53, 191,  35,  52, 193,  34,  50,
+	194,  34,  48, 196,  36,  48, 199,  37,  48, 201,  39,  48,
+	203,  40,  47, 205,  41,  46, 207,  43,  48, 210,  43,  47,
+	212,  46,  48, 213,  47,  47, 215,  47,  46, 219,  49,  46,
+	220,  50,  46, 222,  53,  46, 224,  53,  47, 227,  55,  47,
+	228,  56,  46, 229,  57,  45, 233,  59,  46, 235,  60,  45,
+	237,  62,  45, 238,  63,  44, 237,  65,  41, 236,  67,  40,
+	237,  68,  39, 236,  70,  36, 237,  71,  35, 237,  73,  34,
+	238,  74,  33, 237,  77,  31, 237,  79,  30, 237,  79,  27,
+	237,  83,  25, 236,  84,  23, 237,  86,  21, 237,  88,  20,
+	237,  88,  16, 236,  90,  16, 237,  92,  15, 237,  94,  12,
+	237,  97,  13, 237,  99,  12, 236, 103,  12, 237, 106,  12,
+	236, 110,  12, 237, 113,  13, 237, 116,  13, 236, 120,  13,
+	237, 123,  13, 236, 127,  14, 237, 130,  14, 236, 132,  13,
+	236, 135,  13, 236, 139,  12, 235, 143,  12, 236, 146,  12,
+	237, 149,  12, 236, 153,  13, 235, 155,  12, 236, 158,  12,
+	237, 161,  12, 236, 163,  12, 236, 165,  13, 235, 167,  12,
+	236, 170,  12, 236, 172,  11, 235, 173,  12, 236, 176,  12,
+	235, 179,  12, 235, 181,  11, 236, 183,  13, 235, 185,  12,
+	235, 187,  11, 236, 189,  11, 236, 191,  13, 235, 194,  12,
+	236, 196,  11, 236, 199,  11, 236, 200,  12, 235, 202,  12,
+	236, 205,  23, 235, 207,  34, 235, 208,  45, 236, 209,  56,
+	235, 211,  67, 234, 212,  78, 236, 214,  90, 235, 216, 100,
+	234, 218, 111, 236, 220, 123, 234, 220, 133, 235, 221, 146,
+	235, 224, 157, 236, 225, 167, 235, 226, 179, 235, 229, 191,
+	235, 229, 201, 235, 232, 213, 235, 233, 224, 235, 235, 235,
+	 36,  36, 198,  36,  36, 198,  36,  36, 198,  36,  36, 198,
+	 36,  36, 198,  36,  36, 198,  36,  36, 198,  36,  36, 198,
+	 36,  36, 198,  36,  36, 198,  36,  36, 198,  36,  36, 198,
+	 36,  36, 198,  36,  36, 198,  36,  36, 198,  36,  36, 198,
+};
+
+static const uint8_t medical_palette[PALETTE_LEN] = {
+	 36,  36, 198,  36,  36, 198,  36,  36, 198,  36,  36, 198,
+	 36,  36, 198,  36,  36, 198,  36,  36, 198,  36,  36, 198,
+	 36,  36, 198,  36,  36, 198,  36,  36, 198,  36,  36, 198,
+	 36,  36, 198,  36,  36, 198,  36,  36, 198,  36,  36, 198,
+	 36,  36, 198,  36,  36, 198,  36,  36, 198,  36,  36, 198,
+	 36,  36, 198,  36,  36, 198,  70,  71, 238,  70,  71, 238,
+	 70,  71, 238,  70,  71, 238,  70,  71, 238,  70,  71, 238,
+	 70,  71, 238,  70,  71, 238,  70,  71, 238,  70,  71, 238,
+	 70,  71, 238,  70,  71, 238,  70,  71, 238,  70,  71, 238,
+	 70,  71, 238,  70,  71, 238,  70,  71, 238,  70,  71, 238,
+	 70,  71, 238,  70,  71, 238,  70,  71, 238,  70,  71, 238,
+	 70,  71, 238,  25, 172, 193,  25, 172, 193,  25, 172, 193,
+	 25, 172, 193,  25, 172, 193,  25, 172, 193,  25, 172, 193,
+	 25, 172, 193,  25, 172, 193,  25, 172, 193,  25, 172, 193,
+	 25, 172, 193,  25, 172, 193,  25, 172, 193,  25, 172, 193,
+	 25, 172, 193,  25, 172, 193,  25, 172, 193,  25, 172, 193,
+	 25, 172, 193,  25, 172, 193,  25, 172, 193,  14, 158,  13,
+	 14, 158,  13,  14, 158,  13,  14, 158,  13,  14, 158,  13,
+	 14, 158,  13,  14, 158,  13,  14, 158,  13,  14, 158,  13,
+	 14, 158,  13,  14, 158,  13,  14, 158,  13,  14, 158,  13,
+	 14, 158,  13,  14, 158,  13,  14, 158,  13,  14, 158,  13,
+	 14, 158,  13,  14, 158,  13,  14, 158,  13,  14, 158,  13,
+	 14, 158,  13,  14, 158,  13,  15,  15, 123,  15,  15, 123,
+	 15,  15, 123,  15,  15, 123,  15,  15, 123,  15,  15, 123,
+	 15,  15, 123,  15,  15, 123,  15,  15, 123,  15,  15, 123,
+	 15,  15, 123,  15,  15, 123,  15,  15, 123,  15,  15, 123,
+	 15,  15, 123,  15,  15, 123,  15,  15, 123,  15,  15, 123,
+	 15,  15, 123,  15,  15, 123,  15,  15, 123,  15,  15, 123,
+	237,  65, 197, 237,  65, 197, 237,  65, 197, 237,  65, 197,
+	237,  65, 197, 237,  65, 197, 237,  65, 197, 237,  65, 197,
+	237,  65, 197, 237,  65, 197, 237,  65, 197, 237,  65, 197,
+	237,  65, 197, 237,  65, 197, 237,  65, 197, 237,  65, 197,
+	237,  65, 197, 237,  65, 197, 237,  65, 197, 237,  65, 197,
+	237,  65, 197, 237,  65, 197, 237,  65, 197, 238,  28,  28,
+	238,  28,  28, 238,  28,  28, 238,  28,  28, 238,  28,  28,
+	238,  28,  28, 238,  28,  28, 238,  28,  28, 238,  28,  28,
+	238,  28,  28, 238,  28,  28, 238,  28,  28, 238,  28,  28,
+	238,  28,  28, 238,  28,  28, 238,  28,  28, 238,  28,  28,
+	238,  28,  28, 238,  28,  28, 238,  28,  28, 238,  28,  28,
+	238,  28,  28, 236, 152,  93, 236, 152,  93, 236, 152,  93,
+	236, 152,  93, 236, 152,  93, 236, 152,  93, 236, 152,  93,
+	236, 152,  93, 236, 152,  93, 236, 152,  93, 236, 152,  93,
+	236, 152,  93, 236, 152,  93, 236, 152,  93, 236, 152,  93,
+	236, 152,  93, 236, 152,  93, 236, 152,  93, 236, 152,  93,
+	236, 152,  93, 236, 152,  93, 236, 152,  93, 236, 152,  93,
+	230, 125,  12, 230, 125,  12, 230, 125,  12, 230, 125,  12,
+	230, 125,  12, 230, 125,  12, 230, 125,  12, 230, 125,  12,
+	230, 125,  12, 230, 125,  12, 230, 125,  12, 230, 125,  12,
+	230, 125,  12, 230, 125,  12, 230, 125,  12, 230, 125,  12,
+	230, 125,  12, 230, 125,  12, 230, 125,  12, 230, 125,  12,
+	230, 125,  12, 230, 125,  12, 236, 196,  37, 236, 196,  37,
+	236, 196,  37, 236, 196,  37, 236, 196,  37, 236, 196,  37,
+	236, 196,  37, 236, 196,  37, 236, 196,  37, 236, 196,  37,
+	236, 196,  37, 236, 196,  37, 236, 196,  37, 236, 196,  37,
+	236, 196,  37, 236, 196,  37, 236, 196,  37, 236, 196,  37,
+	236, 196,  37, 236, 196,  37, 236, 196,  37, 236, 196,  37,
+	 17,  14,  17,  16,  23,  17,  17,  32,  17,  16,  40,  16,
+	 16,  49,  16,  15,  58,  16,  15,  65,  16,  14,  74,  16,
+	 15,  82,  16,  15,  91,  15,  14, 100,  15,  15, 108,  15,
+	 14, 117,  14,  15, 125,  16,  14, 134,  15,  14, 143,  15,
+	 15, 151,  15,  14, 160,  14,  15, 168,  14,  14, 177,  14,
+	 14, 186,  13,  13, 192,  14,  13, 201,  14,  14, 209,  13,
+	 14, 219,  14,  13, 228,  14,  14, 236,  13,  22, 227,  22,
+	 28, 219,  29,  37, 212,  37,  46, 204,  46,  52, 196,  53,
+};
+
+static const uint8_t rainbow_palette[PALETTE_LEN] = {
+	  1,   3,  74,   0,   3,  74,   0,   3,  75,   0,   3,  75,
+	  0,   3,  76,   0,   3,  76,   0,   3,  77,   0,   3,  79,
+	  0,   3,  82,   0,   5,  85,   0,   7,  88,   0,  10,  91,
+	  0,  14,  94,   0,  19,  98,   0,  22, 100,   0,  25, 103,
+	  0,  28, 106,   0,  32, 109,   0,  35, 112,   0,  38, 116,
+	  0,  40, 119,   0,  42, 123,   0,  45, 128,   0,  49, 133,
+	  0,  50, 134,   0,  51, 136,   0,  52, 137,   0,  53, 139,
+	  0,  54, 142,   0,  55, 144,   0,  56, 145,   0,  58, 149,
+	  0,  61, 154,   0,  63, 156,   0,  65, 159,   0,  66, 161,
+	  0,  68, 164,   0,  69, 167,   0,  71, 170,   0,  73, 174,
+	  0,  75, 179,   0,  76, 181,   0,  78, 184,   0,  79, 187,
+	  0,  80, 188,   0,  81, 190,   0,  84, 194,   0,  87, 198,
+	  0,  88, 200,   0,  90, 203,   0,  92, 205,   0,  94, 207,
+	  0,  94, 208,   0,  95, 209,   0,  96, 210,   0,  97, 211,
+	  0,  99, 214,   0, 102, 217,   0, 103, 218,   0, 104, 219,
+	  0, 105, 220,   0, 107, 221,   0, 109, 223,   0, 111, 223,
+	  0, 113, 223,   0, 115, 222,   0, 117, 221,   0, 118, 220,
+	  1, 120, 219,   1, 122, 217,   2, 124, 216,   2, 126, 214,
+	  3, 129, 212,   3, 131, 207,   4, 132, 205,   4, 133, 202,
+	  4, 134, 197,   5, 136, 192,   6, 138, 185,   7, 141, 178,
+	  8, 142, 172,  10, 144, 166,  10, 144, 162,  11, 145, 158,
+	 12, 146, 153,  13, 147, 149,  15, 149, 140,  17, 151, 132,
+	 22, 153, 120,  25, 154, 115,  28, 156, 109,  34, 158, 101,
+	 40, 160,  94,  45, 162,  86,  51, 164,  79,  59, 167,  69,
+	 67, 171,  60,  72, 173,  54,  78, 175,  48,  83, 177,  43,
+	 89, 179,  39,  93, 181,  35,  98, 183,  31, 105, 185,  26,
+	109, 187,  23, 113, 188,  21, 118, 189,  19, 123, 191,  17,
+	128, 193,  14, 134, 195,  12, 138, 196,  10, 142, 197,   8,
+	146, 198,   6, 151, 200,   5, 155, 201,   4, 160, 203,   3,
+	164, 204,   2, 169, 205,   2, 173, 206,   1, 175, 207,   1,
+	178, 207,   1, 184, 208,   0, 190, 210,   0, 193, 211,   0,
+	196, 212,   0, 199, 212,   0, 202, 213,   1, 207, 214,   2,
+	212, 215,   3, 215, 214,   3, 218, 214,   3, 220, 213,   3,
+	222, 213,   4, 224, 212,   4, 225, 212,   5, 226, 212,   5,
+	229, 211,   5, 232, 211,   6, 232, 211,   6, 233, 211,   6,
+	234, 210,   6, 235, 210,   7, 236, 209,   7, 237, 208,   8,
+	239, 206,   8, 241, 204,   9, 242, 203,   9, 244, 202,  10,
+	244, 201,  10, 245, 200,  10, 245, 199,  11, 246, 198,  11,
+	247, 197,  12, 248, 194,  13, 249, 191,  14, 250, 189,  14,
+	251, 187,  15, 251, 185,  16, 252, 183,  17, 252, 178,  18,
+	253, 174,  19, 253, 171,  19, 254, 168,  20, 254, 165,  21,
+	254, 164,  21, 255, 163,  22, 255, 161,  22, 255, 159,  23,
+	255, 157,  23, 255, 155,  24, 255, 149,  25, 255, 143,  27,
+	255, 139,  28, 255, 135,  30, 255, 131,  31, 255, 127,  32,
+	255, 118,  34, 255, 110,  36, 255, 104,  37, 255, 101,  38,
+	255,  99,  39, 255,  93,  40, 255,  88,  42, 254,  82,  43,
+	254,  77,  45, 254,  69,  47, 254,  62,  49, 253,  57,  50,
+	253,  53,  52, 252,  49,  53, 252,  45,  55, 251,  39,  57,
+	251,  33,  59, 251,  32,  60, 251,  31,  60, 251,  30,  61,
+	251,  29,  61, 251,  28,  62, 250,  27,  63, 250,  27,  65,
+	249,  26,  66, 249,  26,  68, 248,  25,  70, 248,  24,  73,
+	247,  24,  75, 247,  25,  77, 247,  25,  79, 247,  26,  81,
+	247,  32,  83, 247,  35,  85, 247,  38,  86, 247,  42,  88,
+	247,  46,  90, 247,  50,  92, 248,  55,  94, 248,  59,  96,
+	248,  64,  98, 248,  72, 101, 249,  81, 104, 249,  87, 106,
+	250,  93, 108, 250,  95, 109, 250,  98, 110, 250, 100, 111,
+	251, 101, 112, 251, 102, 113, 251, 109, 117, 252, 116, 121,
+	252, 121, 123, 253, 126, 126, 253, 130, 128, 254, 135, 131,
+	254, 139, 133, 254, 144, 136, 254, 151, 140, 255, 158, 144,
+	255, 163, 146, 255, 168, 149, 255, 173, 152, 255, 176, 153,
+	255, 178, 155, 255, 184, 160, 255, 191, 165, 255, 195, 168,
+	255, 199, 172, 255, 203, 175, 255, 207, 179, 255, 211, 182,
+	255, 216, 185, 255, 218, 190, 255, 220, 196, 255, 222, 200,
+	255, 225, 202, 255, 227, 204, 255, 230, 206, 255, 233, 208,
+};
+
+static const uint8_t wheel2_palette[PALETTE_LEN] = {
+	 17,  14,  17,  16,  23,  17,  17,  32,  17,  16,  40,  16,
+	 16,  49,  16,  15,  58,  16,  15,  65,  16,  14,  74,  16,
+	 15,  82,  16,  15,  91,  15,  14, 100,  15,  15, 108,  15,
+	 14, 117,  14,  15, 125,  16,  14, 134,  15,  14, 143,  15,
+	 15, 151,  15,  14, 160,  14,  15, 168,  14,  14, 177,  14,
+	 14, 186,  13,  13, 192,  14,  13, 201,  14,  14, 209,  13,
+	 14, 219,  14,  13, 228,  14,  14, 236,  13,  22, 227,  22,
+	 28, 219,  29,  37, 212,  37,  46, 204,  46,  52, 196,  53,
+	 61, 188,  61,  69, 181,  69,  76, 172,  76,  85, 164,  85,
+	 94, 156,  95, 102, 147, 102, 109, 140, 110, 117, 132, 117,
+	126, 123, 126, 133, 116, 134, 141, 108, 141, 149, 101, 149,
+	157,  93, 157, 165,  84, 165, 174,  76, 175, 183,  68, 183,
+	189,  60, 190, 198,  52, 198, 205,  45, 205, 213,  36, 214,
+	222,  29, 222, 228,  21, 229, 238,  14, 239, 233,  17, 238,
+	229,  22, 238, 223,  27, 239, 218,  31, 238, 213,  37, 238,
+	209,  41, 238, 204,  45, 239, 199,  51, 239, 195,  55, 238,
+	191,  60, 238, 185,  65, 237, 180,  69, 238, 177,  74, 239,
+	171,  79, 238, 167,  84, 238, 161,  89, 239, 157,  93, 238,
+	153,  98, 239, 147, 101, 237, 142, 107, 237, 138, 111, 238,
+	133, 115, 237, 128, 121, 238, 123, 125, 237, 118, 131, 237,
+	114, 135, 238, 109, 139, 237, 104, 145, 237, 100, 149, 238,
+	 96, 154, 239,  91, 159, 238,  85, 163, 237,  82, 169, 237,
+	 76, 173, 238,  71, 177, 238,  67, 182, 237,  61, 187, 236,
+	 57, 192, 236,  52, 196, 237,  47, 201, 237,  43, 206, 237,
+	 37, 210, 238,  33, 215, 238,  29, 220, 237,  23, 226, 237,
+	 19, 230, 237,  15, 235, 237,  19, 229, 232,  24, 226, 228,
+	 28, 221, 224,  33, 216, 218,  36, 212, 214,  42, 208, 210,
+	 46, 203, 206,  49, 199, 201,  54, 194, 197,  59, 191, 192,
+	 64, 185, 188,  68, 181, 183,  73, 176, 179,  76, 172, 175,
+	 81, 168, 171,  86, 163, 167,  91, 158, 162,  95, 155, 157,
+	100, 150, 153, 104, 146, 148, 108, 141, 144, 114, 137, 139,
+	117, 133, 136, 121, 129, 130, 126, 123, 126, 131, 118, 123,
+	136, 115, 118, 139, 111, 114, 144, 106, 109, 148, 101, 105,
+	154,  97, 100, 157,  93,  97, 161,  89,  91, 167,  85,  86,
+	172,  79,  83, 176,  75,  77, 179,  71,  73, 184,  66,  70,
+	189,  61,  64, 194,  57,  61, 197,  53,  56, 202,  48,  52,
+	207,  45,  47, 212,  39,  44, 216,  35,  38, 219,  31,  34,
+	225,  27,  30, 229,  22,  26, 234,  17,  20, 239,  14,  18,
+	233,  14,  22, 230,  13,  26, 224,  14,  31, 219,  14,  35,
+	214,  14,  39, 210,  13,  45, 206,  14,  49, 201,  14,  55,
+	195,  14,  59, 190,  14,  64, 186,  14,  68, 181,  14,  72,
+	176,  14,  77, 173,  14,  84, 168,  14,  88, 163,  14,  92,
+	158,  14,  97, 152,  14, 101, 147,  14, 107, 143,  14, 111,
+	139,  15, 117, 133,  14, 120, 130,  14, 125, 125,  14, 131,
+	120,  14, 136, 115,  14, 140, 109,  14, 144, 106,  14, 149,
+	100,  13, 155,  96,  15, 158,  91,  15, 164,  87,  14, 169,
+	 82,  14, 173,  77,  14, 177,  72,  14, 182,  66,  14, 186,
+	 64,  14, 193,  58,  15, 197,  53,  15, 202,  48,  15, 206,
+	 44,  14, 210,  39,  14, 216,  34,  14, 221,  30,  13, 225,
+	 24,  15, 230,  20,  15, 235,  15,  14, 241,  20,  18, 237,
+	 23,  21, 232,  27,  26, 228,  30,  29, 223,  36,  33, 220,
+	 38,  37, 215,  42,  41, 211,  45,  45, 207,  50,  49, 203,
+	 54,  52, 199,  58,  56, 195,  61,  60, 192,  66,  64, 188,
+	 69,  68, 184,  73,  72, 180,  78,  75, 176,  82,  79, 172,
+	 84,  82, 167,  89,  87, 164,  91,  90, 159,  97,  95, 156,
+	100,  98, 151, 104, 103, 147, 108, 105, 144, 112, 109, 140,
+	115, 113, 136, 120, 117, 132, 124, 121, 128, 127, 125, 124,
+	131, 129, 120, 134, 133, 116, 139, 137, 111, 143, 140, 107,
+	148, 144, 105, 151, 148, 101, 155, 152,  97, 158, 156,  93,
+	162, 160,  89, 167, 164,  85, 169, 167,  80, 173, 171,  75,
+	176, 175,  71, 181, 179,  67, 185, 182,  63, 189, 186,  61,
+	192, 190,  57, 197, 194,  53, 200, 198,  49, 204, 202,  45,
+	209, 205,  40, 213, 209,  36, 216, 213,  32, 220, 217,  28,
+	223, 221,  24, 228, 225,  20, 232, 229,  16, 235, 233,  14,
+};
+
+// Indexed by PALETTE_xxx
+static const palette_t palette_list[PALETTE_NUM] = {
+	{"black_hot", black_hot_palette},
+	{"blue_red", blue_red_palette},
+	{"coldest", coldest_palette},
+	{"double_rainbow", double_rainbow_palette},
+	{"fusion", fusion_palette},
+	{"glowbow", glowbow_palette},
+	{"gray", gray_palette},
+	{"gray_red", gray_red_palette},
+	{"hottest", hottest_palette},
+	{"ironblack", ironblack_palette},
+	{"lava", lava_palette},
+	{"medical", medical_palette},
+	{"rainbow", rainbow_palette},
+	{"wheel2", wheel2_palette},
+};
+
+
+
+//
+// Palette Utilities API
+//
+
+/**
+ * Returns the palette index for a name or -1 if there isn't one
+ */
+int palette_find(const char* name)
+{
+	int i;
+	
+	if (name == NULL) return -1;
+	
+	for (i=0; i<PALETTE_NUM; i++) {
+		if (strcmp(name, palette_list[i].name) == 0) return i;
+	}
+	
+	return -1;
+}
+
+
+/**
+ * Returns a palette's name (the default palette for an illegal index)
+ */
+const char* palette_get_name(int index)
+{
+	if ((index < 0) || (index >= PALETTE_NUM)) index = PALETTE_DEFAULT;
+	
+	return palette_list[index].name;
+}
+
+
+/**
+ * Returns a palette's PALETTE_LEN bytes of R, G, B entries (the default palette for
+ * an illegal index)
+ */
+const uint8_t* palette_get(int index)
+{
+	if ((index < 0) || (index >= PALETTE_NUM)) index = PALETTE_DEFAULT;
+	
+	return palette_list[index].rgb;
+}
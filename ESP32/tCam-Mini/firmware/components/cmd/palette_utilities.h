@@ -0,0 +1,76 @@
+/*
+ * Palette Utilities
+ *
+ * Contains the 256 entry RGB palettes used to colorize preview images.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef PALETTE_UTILITIES_H
+#define PALETTE_UTILITIES_H
+
+#include <stdint.h>
+
+
+
+//
+// Palette Utilities constants
+//
+
+// Palette size (256 R, G, B entries)
+#define PALETTE_LEN 768
+
+// Palettes
+#define PALETTE_BLACK_HOT       0
+#define PALETTE_BLUE_RED        1
+#define PALETTE_COLDEST         2
+#define PALETTE_DOUBLE_RAINBOW  3
+#define PALETTE_FUSION          4
+#define PALETTE_GLOWBOW         5
+#define PALETTE_GRAY            6
+#define PALETTE_GRAY_RED        7
+#define PALETTE_HOTTEST         8
+#define PALETTE_IRONBLACK       9
+#define PALETTE_LAVA            10
+#define PALETTE_MEDICAL         11
+#define PALETTE_RAINBOW         12
+#define PALETTE_WHEEL2          13
+#define PALETTE_NUM             14
+
+#define PALETTE_DEFAULT PALETTE_IRONBLACK
+
+
+
+//
+// Palette Utilities typedefs
+//
+typedef struct {
+	const char* name;
+	const uint8_t* rgb;
+} palette_t;
+
+
+
+//
+// Palette Utilities API
+//
+int palette_find(const char* name);
+const char* palette_get_name(int index);
+const uint8_t* palette_get(int index);
+
+#endif /* PALETTE_UTILITIES_H */
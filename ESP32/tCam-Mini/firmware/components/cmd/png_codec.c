@@ -0,0 +1,426 @@
+/*
+ * Palette mapped PNG image codec
+ *
+ * Contains an encoder for preview images.  See png_codec.h for the format.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "png_codec.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+
+
+//
+// PNG Codec constants
+//
+
+// Deflate match limits
+#define MIN_MATCH 3
+#define MAX_MATCH 258
+#define MAX_DIST  32768
+
+// Hash table entry without a position
+#define HASH_EMPTY 0xFFFF
+
+// Everything except the compressed scanlines: signature, IHDR, PLTE, IDAT chunk
+// overhead, zlib header and checksum and IEND
+#define PNG_FIXED_LEN (8 + 25 + (12 + 768) + 12 + 6 + 12)
+
+// Length after the compressed scanlines: zlib checksum, IDAT CRC and IEND
+#define PNG_TAIL_LEN (4 + 4 + 12)
+
+
+
+//
+// PNG Codec variables
+//
+static const uint8_t png_signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+// Deflate length (codes 257 - 285) and distance code bases and extra bits
+static const uint16_t len_base[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t len_extra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t dist_base[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t dist_extra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// CRC-32 (PNG chunks) computed 4 bits at a time
+static const uint32_t crc_table[16] = {
+	0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+	0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+// Bit writer state (deflate bits are packed starting with the LSB of each byte)
+static uint8_t* bw_bufP;
+static uint8_t* bw_endP;
+static uint32_t bw_acc;
+static int bw_bits;
+static bool bw_overflow;
+
+
+
+//
+// PNG Codec Forward Declarations for internal functions
+//
+static uint8_t* put_chunk_start(uint8_t* p, uint32_t len, const char* type);
+static uint8_t* put_chunk_end(uint8_t* typeP, uint8_t* p);
+static void put_u32(uint8_t* p, uint32_t v);
+static void deflate_scanlines(const uint8_t* raw, int raw_len, int stride, uint16_t* hash);
+static inline uint32_t hash3(const uint8_t* p);
+static inline int match_len(const uint8_t* a, const uint8_t* b, int max);
+static void put_litlen(int v);
+static void put_match(int len, int dist);
+static inline void put_code(uint32_t code, int n);
+static inline void put_bits(uint32_t v, int n);
+static void flush_bits();
+static uint32_t crc32_update(uint32_t crc, const uint8_t* p, uint32_t len);
+static uint32_t adler32(const uint8_t* p, uint32_t len);
+
+
+
+//
+// PNG Codec API
+//
+
+/**
+ * Encode a width x height image into out as a PNG file, scaling pixels between lo and
+ * hi into indices of the 256 entry RGB palette.  work must hold PNG_WORK_LEN(width,
+ * height) bytes.  Returns the file length or 0 if it would be longer than max_len
+ * bytes.
+ */
+uint32_t png_encode_image(const uint16_t* img, int width, int height, const uint8_t* palette, uint16_t lo, uint16_t hi, uint8_t* work, uint8_t* out, uint32_t max_len)
+{
+	const uint16_t* ip = img;
+	uint16_t* hash = (uint16_t*) work;
+	uint8_t* raw = work + (PNG_HASH_LEN * 2);
+	uint8_t* rp = raw;
+	uint8_t* p;
+	uint8_t* typeP;
+	int raw_len = (width + 1) * height;
+	int x, y;
+	uint32_t mult, v;
+
+	// Hash table positions are 16 bits
+	if ((max_len < PNG_FIXED_LEN) || (raw_len >= HASH_EMPTY)) return 0;
+
+	// Scale the pixels into scanlines, each starting with filter type 0 (none)
+	if (hi <= lo) hi = lo + 1;
+	mult = (255 << 16) / (hi - lo);
+	for (y=0; y<height; y++) {
+		*rp++ = 0;
+		for (x=0; x<width; x++) {
+			v = *ip++;
+			if (v <= lo) {
+				*rp++ = 0;
+			} else if (v >= hi) {
+				*rp++ = 255;
+			} else {
+				*rp++ = (uint8_t) (((v - lo) * mult) >> 16);
+			}
+		}
+	}
+
+	// Signature and header
+	p = out;
+	memcpy(p, png_signature, sizeof(png_signature));
+	p += sizeof(png_signature);
+
+	typeP = put_chunk_start(p, 13, "IHDR");
+	p = typeP + 4;
+	put_u32(p, width);
+	put_u32(p + 4, height);
+	p += 8;
+	*p++ = 8;         // Bit depth
+	*p++ = 3;         // Indexed color
+	*p++ = 0;         // Deflate compression
+	*p++ = 0;         // Adaptive filtering
+	*p++ = 0;         // No interlace
+	p = put_chunk_end(typeP, p);
+
+	typeP = put_chunk_start(p, 768, "PLTE");
+	p = typeP + 4;
+	memcpy(p, palette, 768);
+	p = put_chunk_end(typeP, p + 768);
+
+	// Compressed scanlines (the chunk length is set when it is known)
+	typeP = put_chunk_start(p, 0, "IDAT");
+	p = typeP + 4;
+	*p++ = 0x78;      // Deflate with a 32K window
+	*p++ = 0x01;      // Fastest compression, check bits
+
+	bw_bufP = p;
+	bw_endP = out + max_len - PNG_TAIL_LEN;
+	bw_acc = 0;
+	bw_bits = 0;
+	bw_overflow = false;
+	deflate_scanlines(raw, raw_len, width + 1, hash);
+	if (bw_overflow) return 0;
+	p = bw_bufP;
+
+	put_u32(p, adler32(raw, raw_len));
+	p += 4;
+	put_u32(typeP - 4, p - (typeP + 4));
+	p = put_chunk_end(typeP, p);
+
+	typeP = put_chunk_start(p, 0, "IEND");
+	p = put_chunk_end(typeP, typeP + 4);
+
+	return p - out;
+}
+
+
+
+//
+// PNG Codec internal functions
+//
+
+/**
+ * Write a chunk's length and type.  Returns the location of the type.
+ */
+static uint8_t* put_chunk_start(uint8_t* p, uint32_t len, const char* type)
+{
+	put_u32(p, len);
+	memcpy(p + 4, type, 4);
+
+	return p + 4;
+}
+
+
+/**
+ * Write the CRC of the chunk type and data between typeP and p.  Returns the location
+ * after the chunk.
+ */
+static uint8_t* put_chunk_end(uint8_t* typeP, uint8_t* p)
+{
+	put_u32(p, crc32_update(0xFFFFFFFF, typeP, p - typeP) ^ 0xFFFFFFFF);
+
+	return p + 4;
+}
+
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+	*p++ = v >> 24;
+	*p++ = v >> 16;
+	*p++ = v >> 8;
+	*p = v;
+}
+
+
+/**
+ * Compress the scanlines as one final deflate block with the fixed Huffman codes.
+ * Each position is matched against the last position with the same next 3 bytes
+ * and the same position in the previous scanline (which usually matches in thermal
+ * images) and the longer match is used.
+ */
+static void deflate_scanlines(const uint8_t* raw, int raw_len, int stride, uint16_t* hash)
+{
+	int i, n, max;
+	int cand, len;
+	int best_len, best_dist;
+	uint32_t h;
+
+	for (i=0; i<PNG_HASH_LEN; i++) hash[i] = HASH_EMPTY;
+
+	put_bits(1, 1);   // BFINAL
+	put_bits(1, 2);   // BTYPE fixed Huffman codes
+
+	i = 0;
+	while ((i < raw_len) && !bw_overflow) {
+		best_len = 0;
+		best_dist = 0;
+
+		if ((i + MIN_MATCH) <= raw_len) {
+			max = raw_len - i;
+			if (max > MAX_MATCH) max = MAX_MATCH;
+
+			h = hash3(&raw[i]);
+			cand = hash[h];
+			hash[h] = i;
+			if ((cand != HASH_EMPTY) && ((i - cand) <= MAX_DIST)) {
+				best_len = match_len(&raw[cand], &raw[i], max);
+				best_dist = i - cand;
+			}
+
+			if ((i >= stride) && (stride <= MAX_DIST)) {
+				len = match_len(&raw[i - stride], &raw[i], max);
+				if (len > best_len) {
+					best_len = len;
+					best_dist = stride;
+				}
+			}
+		}
+
+		if (best_len >= MIN_MATCH) {
+			put_match(best_len, best_dist);
+
+			// Add the matched positions to the hash table
+			for (n=1; n<best_len; n++) {
+				if ((i + n + MIN_MATCH) <= raw_len) {
+					hash[hash3(&raw[i + n])] = i + n;
+				}
+			}
+			i += best_len;
+		} else {
+			put_litlen(raw[i]);
+			i++;
+		}
+	}
+
+	put_litlen(256);  // End of block
+	flush_bits();
+}
+
+
+static inline uint32_t hash3(const uint8_t* p)
+{
+	uint32_t v = (p[0] << 16) | (p[1] << 8) | p[2];
+
+	return (v * 2654435761U) >> (32 - PNG_HASH_BITS);
+}
+
+
+static inline int match_len(const uint8_t* a, const uint8_t* b, int max)
+{
+	int n = 0;
+
+	while ((n < max) && (a[n] == b[n])) n++;
+
+	return n;
+}
+
+
+/**
+ * Write a literal/length symbol with its fixed Huffman code
+ */
+static void put_litlen(int v)
+{
+	if (v < 144) {
+		put_code(0x30 + v, 8);
+	} else if (v < 256) {
+		put_code(0x190 + (v - 144), 9);
+	} else if (v < 280) {
+		put_code(v - 256, 7);
+	} else {
+		put_code(0xC0 + (v - 280), 8);
+	}
+}
+
+
+/**
+ * Write a match as its length and distance codes and extra bits
+ */
+static void put_match(int len, int dist)
+{
+	int i;
+
+	for (i=28; len_base[i] > len; i--) {}
+	put_litlen(257 + i);
+	if (len_extra[i] != 0) put_bits(len - len_base[i], len_extra[i]);
+
+	for (i=29; dist_base[i] > dist; i--) {}
+	put_code(i, 5);
+	if (dist_extra[i] != 0) put_bits(dist - dist_base[i], dist_extra[i]);
+}
+
+
+/**
+ * Write a n-bit Huffman code (they are packed starting with their MSB)
+ */
+static inline void put_code(uint32_t code, int n)
+{
+	uint32_t r = 0;
+	int i;
+
+	for (i=0; i<n; i++) {
+		r = (r << 1) | (code & 0x1);
+		code >>= 1;
+	}
+	put_bits(r, n);
+}
+
+
+static inline void put_bits(uint32_t v, int n)
+{
+	bw_acc |= v << bw_bits;
+	bw_bits += n;
+	while (bw_bits >= 8) {
+		if (bw_bufP < bw_endP) {
+			*bw_bufP++ = (uint8_t) bw_acc;
+		} else {
+			bw_overflow = true;
+		}
+		bw_acc >>= 8;
+		bw_bits -= 8;
+	}
+}
+
+
+static void flush_bits()
+{
+	if (bw_bits > 0) {
+		put_bits(0, 8 - bw_bits);
+	}
+}
+
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* p, uint32_t len)
+{
+	while (len--) {
+		crc ^= *p++;
+		crc = (crc >> 4) ^ crc_table[crc & 0xF];
+		crc = (crc >> 4) ^ crc_table[crc & 0xF];
+	}
+
+	return crc;
+}
+
+
+static uint32_t adler32(const uint8_t* p, uint32_t len)
+{
+	uint32_t s1 = 1;
+	uint32_t s2 = 0;
+	uint32_t n;
+
+	// 5552 is the most bytes that can be summed before s2 could overflow
+	while (len > 0) {
+		n = (len > 5552) ? 5552 : len;
+		len -= n;
+		while (n--) {
+			s1 += *p++;
+			s2 += s1;
+		}
+		s1 %= 65521;
+		s2 %= 65521;
+	}
+
+	return (s2 << 16) | s1;
+}
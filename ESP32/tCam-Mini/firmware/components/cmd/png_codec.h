@@ -0,0 +1,62 @@
+/*
+ * Palette mapped PNG image codec
+ *
+ * Contains an encoder for preview images: 16-bit lepton images are linearly scaled
+ * into 8-bit palette indices and stored as an 8-bit indexed-color PNG file with the
+ * palette.  The scanlines (each with filter type 0) are compressed as one deflate
+ * block with the fixed Huffman codes.  Matches are found with a hash of the next 3
+ * bytes and by comparing against the same position in the previous row.
+ *
+ *   Index scaling
+ *     pixel <= lo: 0
+ *     pixel >= hi: 255
+ *     otherwise: (pixel - lo) * 255 / (hi - lo)
+ *
+ *   File
+ *     PNG signature, IHDR (color type 3, 8-bit depth), PLTE (256 entries), IDAT
+ *     (zlib stream), IEND
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef PNG_CODEC_H
+#define PNG_CODEC_H
+
+#include <stdint.h>
+
+
+
+//
+// PNG Codec constants
+//
+
+// Match hash table size (entries)
+#define PNG_HASH_BITS  11
+#define PNG_HASH_LEN   (1 << PNG_HASH_BITS)
+
+// Work buffer length for a width x height image (match hash table and scanlines)
+#define PNG_WORK_LEN(w, h)  ((PNG_HASH_LEN * 2) + (((w) + 1) * (h)))
+
+
+
+//
+// PNG Codec API
+//
+uint32_t png_encode_image(const uint16_t* img, int width, int height, const uint8_t* palette, uint16_t lo, uint16_t hi, uint8_t* work, uint8_t* out, uint32_t max_len);
+
+#endif /* PNG_CODEC_H */
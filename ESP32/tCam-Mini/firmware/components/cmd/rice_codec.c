@@ -0,0 +1,240 @@
+/*
+ * Lossless image codec
+ *
+ * Contains a lossless encoder for 16-bit lepton images used for compressed binary
+ * images.  See rice_codec.h for the format.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "rice_codec.h"
+#include <stddef.h>
+#include <string.h>
+
+
+
+//
+// Rice Codec Forward Declarations for internal functions
+//
+static inline uint16_t predict(const uint16_t* p, int x, int y, int width);
+static void encode_block(rice_enc_t* e, int n);
+static inline void put_bits(rice_enc_t* e, uint32_t v, int n);
+
+
+
+//
+// Rice Codec API
+//
+
+/**
+ * Encode a width x height image into out.  The image is encoded as a delta image
+ * against ref if ref is not NULL.  Returns the encoded length or 0 if the encoded
+ * image would be longer than max_len bytes.
+ */
+uint32_t rice_encode_image(const uint16_t* img, const uint16_t* ref, int width, int height, uint8_t* out, uint32_t max_len)
+{
+	rice_enc_t e;
+
+	rice_encode_start(&e, out, max_len);
+	rice_encode_pixels(&e, img, ref, width, 0, width*height);
+	return rice_encode_finish(&e);
+}
+
+
+/**
+ * Start an encoder writing into out
+ */
+void rice_encode_start(rice_enc_t* e, uint8_t* out, uint32_t max_len)
+{
+	e->startP = out;
+	e->bufP = out;
+	e->endP = out + max_len;
+	e->acc = 0;
+	e->bits = 0;
+	e->overflow = false;
+}
+
+
+/**
+ * Encode pixels start to end - 1 of an image width pixels wide (and ref for a delta
+ * image).  start must be a multiple of RICE_BLOCK_LEN and only the last part of an
+ * image may end within a block.
+ */
+void rice_encode_pixels(rice_enc_t* e, const uint16_t* img, const uint16_t* ref, int width, uint32_t start, uint32_t end)
+{
+	const uint16_t* p = img + start;
+	const uint16_t* r = (ref != NULL) ? ref + start : NULL;
+	uint32_t i;
+	int n = 0;
+	int x = start % width;
+	int y = start / width;
+	int16_t d;
+
+	for (i=start; i<end; i++) {
+		if (r != NULL) {
+			d = (int16_t) (*p - *r++);
+		} else {
+			d = (int16_t) (*p - predict(p, x, y, width));
+		}
+		e->res_block[n++] = (uint16_t) ((d << 1) ^ (d >> 15));
+		p++;
+		if (++x == width) {
+			x = 0;
+			y++;
+		}
+
+		if (n == RICE_BLOCK_LEN) {
+			encode_block(e, n);
+			n = 0;
+			if (e->overflow) return;
+		}
+	}
+	if (n != 0) {
+		encode_block(e, n);
+	}
+}
+
+
+/**
+ * Append the bitstream of the encoder for the following part of the image.  The part
+ * may have been written into the free end of this encoder's buffer (the data is moved
+ * down as it is appended).
+ */
+void rice_encode_append(rice_enc_t* e, rice_enc_t* part)
+{
+	uint8_t* p = part->startP;
+	uint32_t len = part->bufP - part->startP;
+
+	if (part->overflow || ((e->bufP + len) > e->endP)) {
+		e->overflow = true;
+		return;
+	}
+
+	if (e->bits == 0) {
+		// Byte aligned
+		memmove(e->bufP, p, len);
+		e->bufP += len;
+	} else {
+		// Each byte pushes out exactly one byte with the same number of bits left over
+		while (p < part->bufP) {
+			e->acc = (e->acc << 8) | *p++;
+			*e->bufP++ = (uint8_t) (e->acc >> e->bits);
+		}
+	}
+	if (part->bits != 0) {
+		put_bits(e, part->acc, part->bits);
+	}
+}
+
+
+/**
+ * Write any remaining bits padded with 0-bits.  Returns the encoded length or 0 if it
+ * didn't fit.
+ */
+uint32_t rice_encode_finish(rice_enc_t* e)
+{
+	if (e->bits > 0) {
+		put_bits(e, 0, 8 - e->bits);
+	}
+
+	return (e->overflow) ? 0 : (uint32_t) (e->bufP - e->startP);
+}
+
+
+
+//
+// Rice Codec internal functions
+//
+
+/**
+ * LOCO-I median edge detector prediction for the pixel at p
+ */
+static inline uint16_t predict(const uint16_t* p, int x, int y, int width)
+{
+	uint16_t a, b, c;
+
+	if (y == 0) {
+		return (x == 0) ? 0 : *(p - 1);
+	}
+	if (x == 0) {
+		return *(p - width);
+	}
+
+	a = *(p - 1);
+	b = *(p - width);
+	c = *(p - width - 1);
+	if (c >= ((a > b) ? a : b)) {
+		return (a < b) ? a : b;
+	} else if (c <= ((a < b) ? a : b)) {
+		return (a > b) ? a : b;
+	} else {
+		return (uint16_t) (a + b - c);
+	}
+}
+
+
+/**
+ * Select a Rice parameter for the residual block and encode it
+ */
+static void encode_block(rice_enc_t* e, int n)
+{
+	int i, k;
+	uint32_t q;
+	uint32_t sum = 0;
+
+	for (i=0; i<n; i++) {
+		sum += e->res_block[i];
+	}
+	k = 0;
+	while ((k < 15) && (((uint32_t) n << k) < sum)) {
+		k++;
+	}
+
+	put_bits(e, k, 4);
+	for (i=0; i<n; i++) {
+		q = e->res_block[i] >> k;
+		if (q < RICE_ESCAPE) {
+			// q 1-bits followed by a 0-bit and the low k bits
+			put_bits(e, ((1 << q) - 1) << 1, q + 1);
+			if (k != 0) {
+				put_bits(e, e->res_block[i] & ((1 << k) - 1), k);
+			}
+		} else {
+			put_bits(e, (1 << RICE_ESCAPE) - 1, RICE_ESCAPE);
+			put_bits(e, e->res_block[i], 16);
+		}
+	}
+}
+
+
+/**
+ * Append the low n bits (n <= 24) of v to the output
+ */
+static inline void put_bits(rice_enc_t* e, uint32_t v, int n)
+{
+	e->acc = (e->acc << n) | (v & ((1 << n) - 1));
+	e->bits += n;
+	while (e->bits >= 8) {
+		e->bits -= 8;
+		if (e->bufP < e->endP) {
+			*e->bufP++ = (uint8_t) (e->acc >> e->bits);
+		} else {
+			e->overflow = true;
+		}
+	}
+}
@@ -0,0 +1,92 @@
+/*
+ * Lossless image codec
+ *
+ * Contains a lossless encoder for 16-bit lepton images used for compressed binary
+ * images.  Each pixel is predicted from its neighbors using the LOCO-I median edge
+ * detector (or from the same pixel in a reference image for delta images) and the
+ * prediction residual is Rice coded.
+ *
+ *   Delta image prediction: reference pixel
+ *
+ *   Image prediction (a = left, b = above, c = above-left pixel)
+ *     First pixel: 0
+ *     First row: a
+ *     First column: b
+ *     Otherwise: min(a,b) if c >= max(a,b), max(a,b) if c <= min(a,b), else a + b - c
+ *
+ *   Residual
+ *     d = (pixel - prediction) modulo 65536 taken as a signed 16-bit value
+ *     u = zig-zag mapped d: (d << 1) ^ (d >> 15) (0, -1, 1, -2, 2...)
+ *
+ *   Bitstream (MSB first) consists of RICE_BLOCK_LEN residual blocks
+ *     4-bit Rice parameter k for the block
+ *     For each residual: q = u >> k
+ *       q < RICE_ESCAPE: q 1-bits, a 0-bit, the low k bits of u
+ *       otherwise: RICE_ESCAPE 1-bits, 16-bit u
+ *     The final byte is padded with 0-bits
+ *
+ * Each encoder has its own state so images can be encoded by different tasks.  An
+ * image can also be encoded in parts (each starting on a block boundary) by different
+ * encoders at the same time and the parts appended into one bitstream identical to
+ * encoding it in one pass.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef RICE_CODEC_H
+#define RICE_CODEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+
+//
+// Rice Codec constants
+//
+#define RICE_BLOCK_LEN 32
+#define RICE_ESCAPE    16
+
+
+
+//
+// Rice Codec typedefs
+//
+typedef struct {
+	uint8_t* startP;                 // Output buffer
+	uint8_t* bufP;                   // Next output byte
+	uint8_t* endP;
+	uint32_t acc;                    // Bits not yet written
+	int bits;
+	bool overflow;
+	uint16_t res_block[RICE_BLOCK_LEN];
+} rice_enc_t;
+
+
+
+//
+// Rice Codec API
+//
+uint32_t rice_encode_image(const uint16_t* img, const uint16_t* ref, int width, int height, uint8_t* out, uint32_t max_len);
+
+void rice_encode_start(rice_enc_t* e, uint8_t* out, uint32_t max_len);
+void rice_encode_pixels(rice_enc_t* e, const uint16_t* img, const uint16_t* ref, int width, uint32_t start, uint32_t end);
+void rice_encode_append(rice_enc_t* e, rice_enc_t* part);
+uint32_t rice_encode_finish(rice_enc_t* e);
+
+#endif /* RICE_CODEC_H */
@@ -0,0 +1,107 @@
+/*
+ * Sparse image codec
+ *
+ * Contains an encoder for sparse binary images that only carry the pixels at or
+ * above a threshold.  See sparse_codec.h for the format.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "sparse_codec.h"
+#include <stddef.h>
+
+
+
+//
+// Sparse Codec Forward Declarations for internal functions
+//
+static inline uint8_t* put_u16(uint8_t* p, uint16_t v);
+
+
+
+//
+// Sparse Codec API
+//
+
+/**
+ * Encode the pixels of a width x height image at or above threshold into out in one
+ * pass.  Returns the encoded length or 0 if it would be longer than max_len bytes.
+ */
+uint32_t sparse_encode_image(const uint16_t* img, int width, int height, uint16_t threshold, uint8_t* out, uint32_t max_len)
+{
+	uint8_t* p = out + SPARSE_HEADER_LEN;
+	uint8_t* end = out + max_len;
+	uint8_t* spanP = NULL;           // Header of the open span
+	uint32_t start = 0;              // First and last pixel at or above threshold in it
+	uint32_t last = 0;
+	uint32_t i;
+	uint32_t n = width * height;
+	uint16_t spans = 0;
+	
+	if (max_len < SPARSE_HEADER_LEN) return 0;
+	
+	for (i=0; i<n; i++) {
+		if (img[i] >= threshold) {
+			if (spanP == NULL) {
+				if ((end - p) < SPARSE_SPAN_HEADER_LEN) return 0;
+				spanP = p;
+				p += SPARSE_SPAN_HEADER_LEN;
+				start = i;
+			}
+			last = i;
+		} else if (spanP == NULL) {
+			continue;
+		} else if ((i - last) > SPARSE_MAX_GAP) {
+			// Close the span after its last pixel at or above the threshold (dropping
+			// the gap pixels written after it)
+			p = spanP + SPARSE_SPAN_HEADER_LEN + (last - start + 1)*2;
+			spanP = put_u16(spanP, (uint16_t) start);
+			(void) put_u16(spanP, (uint16_t) (last - start + 1));
+			spanP = NULL;
+			spans++;
+			continue;
+		}
+		
+		// Pixels in a span, including gap pixels it may end up keeping
+		if ((end - p) < 2) return 0;
+		p = put_u16(p, img[i]);
+	}
+	
+	if (spanP != NULL) {
+		p = spanP + SPARSE_SPAN_HEADER_LEN + (last - start + 1)*2;
+		spanP = put_u16(spanP, (uint16_t) start);
+		(void) put_u16(spanP, (uint16_t) (last - start + 1));
+		spans++;
+	}
+	
+	(void) put_u16(put_u16(out, threshold), spans);
+	
+	return (uint32_t) (p - out);
+}
+
+
+
+//
+// Sparse Codec internal functions
+//
+static inline uint8_t* put_u16(uint8_t* p, uint16_t v)
+{
+	*p++ = v & 0xFF;
+	*p++ = v >> 8;
+	return p;
+}
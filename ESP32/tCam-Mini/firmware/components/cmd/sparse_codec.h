@@ -0,0 +1,59 @@
+/*
+ * Sparse image codec
+ *
+ * Contains an encoder for sparse binary images, which only carry the pixels at or
+ * above a threshold, for streams that only care about hot areas (alarm monitoring).
+ * Pixels at or above the threshold are sent in spans of consecutive pixels (in pixel
+ * order so a span may continue onto the next row).  A span includes gaps of up to
+ * SPARSE_MAX_GAP pixels below the threshold since they cost less to send than a new
+ * span.  Pixels outside the spans were below the threshold.
+ *
+ *   Header (all multi-byte values little-endian)
+ *     0 - 1: Threshold (raw pixel value)
+ *     2 - 3: Number of spans
+ *
+ *   Each span
+ *     0 - 1: Index of the span's first pixel (row * width + column)
+ *     2 - 3: Number of pixels n
+ *     4 -  : n 16-bit pixels
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SPARSE_CODEC_H
+#define SPARSE_CODEC_H
+
+#include <stdint.h>
+
+
+
+//
+// Sparse Codec constants
+//
+#define SPARSE_HEADER_LEN      4
+#define SPARSE_SPAN_HEADER_LEN 4
+#define SPARSE_MAX_GAP         2
+
+
+
+//
+// Sparse Codec API
+//
+uint32_t sparse_encode_image(const uint16_t* img, int width, int height, uint16_t threshold, uint8_t* out, uint32_t max_len);
+
+#endif /* SPARSE_CODEC_H */
@@ -2,7 +2,9 @@
  * I2C Module
  *
  * Provides I2C Access routines for other modules/tasks.  Provides a locking mechanism
- * since the underlying ESP IDF routines are not thread safe.
+ * since the underlying ESP IDF routines are not thread safe.  The lock may be held
+ * across a sequence of transfers (it is recursive), for example to talk to a device on
+ * the second port (CONFIG_TCAM_DUAL_LEPTON) selected with i2c_select_port().
  *
  * Copyright 2020 Dan Julio
  *
@@ -34,6 +36,16 @@
 //
 static SemaphoreHandle_t i2c_mutex;
 
+// Port transfers use
+static int i2c_port = I2C_MASTER_NUM;
+
+
+
+//
+// I2C Forward Declarations for internal functions
+//
+static esp_err_t init_port(int port, int sda_io, int scl_io);
+
 
 
 //
@@ -45,23 +57,18 @@ static SemaphoreHandle_t i2c_mutex;
  */
 esp_err_t i2c_master_init()
 {
-    int i2c_master_port = I2C_MASTER_NUM;
-    i2c_config_t conf;
+    esp_err_t ret;
     
-    i2c_mutex = xSemaphoreCreateMutex();
+    i2c_mutex = xSemaphoreCreateRecursiveMutex();
     
-    conf.mode = I2C_MODE_MASTER;
-    conf.sda_io_num = I2C_MASTER_SDA_IO;
-    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
-    conf.scl_io_num = I2C_MASTER_SCL_IO;
-    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
-    conf.master.clk_speed = I2C_MASTER_FREQ_HZ;
-    
-    i2c_param_config(i2c_master_port, &conf);
+    ret = init_port(I2C_MASTER_NUM, I2C_MASTER_SDA_IO, I2C_MASTER_SCL_IO);
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+    if (ret == ESP_OK) {
+        ret = init_port(LEP2_I2C_NUM, LEP2_I2C_SDA_IO, LEP2_I2C_SCL_IO);
+    }
+#endif
     
-    return i2c_driver_install(i2c_master_port, conf.mode,
-                              I2C_MASTER_RX_BUF_LEN,
-                              I2C_MASTER_TX_BUF_LEN, 0);
+    return ret;
 }
 
 
@@ -70,7 +77,7 @@ esp_err_t i2c_master_init()
  */
 void i2c_lock()
 {
-	xSemaphoreTake(i2c_mutex, portMAX_DELAY);
+	xSemaphoreTakeRecursive(i2c_mutex, portMAX_DELAY);
 }
 
 
@@ -79,7 +86,17 @@ void i2c_lock()
  */
 void i2c_unlock()
 {
-	xSemaphoreGive(i2c_mutex);
+	xSemaphoreGiveRecursive(i2c_mutex);
+}
+
+
+/**
+ * Select the port used by subsequent transfers.  Must be called holding the lock and
+ * the default port (I2C_MASTER_NUM) restored before releasing it.
+ */
+void i2c_select_port(int port)
+{
+	i2c_port = port;
 }
 
 
@@ -104,7 +121,7 @@ esp_err_t i2c_master_read_slave(uint8_t addr7, uint8_t *data_rd, size_t size)
     }
     i2c_master_read_byte(cmd, data_rd + size - 1, NACK_VAL);
     i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_MODE_MASTER, cmd, 1000 / portTICK_RATE_MS);
+    esp_err_t ret = i2c_master_cmd_begin(i2c_port, cmd, 1000 / portTICK_RATE_MS);
     i2c_cmd_link_delete(cmd);
     return ret;
 }
@@ -125,7 +142,34 @@ esp_err_t i2c_master_write_slave(uint8_t addr7, uint8_t *data_wr, size_t size)
     i2c_master_write_byte(cmd, (addr7 << 1) | I2C_MASTER_WRITE, ACK_CHECK_EN);
     i2c_master_write(cmd, data_wr, size, ACK_CHECK_EN);
     i2c_master_stop(cmd);
-    esp_err_t ret = i2c_master_cmd_begin(I2C_MODE_MASTER, cmd, 1000 / portTICK_RATE_MS);
+    esp_err_t ret = i2c_master_cmd_begin(i2c_port, cmd, 1000 / portTICK_RATE_MS);
     i2c_cmd_link_delete(cmd);
     return ret;
 }
+
+
+
+//
+// I2C internal functions
+//
+
+/**
+ * Configure a port as a master and install its driver
+ */
+static esp_err_t init_port(int port, int sda_io, int scl_io)
+{
+    i2c_config_t conf;
+    
+    conf.mode = I2C_MODE_MASTER;
+    conf.sda_io_num = sda_io;
+    conf.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.scl_io_num = scl_io;
+    conf.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    conf.master.clk_speed = I2C_MASTER_FREQ_HZ;
+    
+    i2c_param_config(port, &conf);
+    
+    return i2c_driver_install(port, conf.mode,
+                              I2C_MASTER_RX_BUF_LEN,
+                              I2C_MASTER_TX_BUF_LEN, 0);
+}
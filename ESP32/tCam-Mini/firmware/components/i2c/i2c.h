@@ -48,6 +48,7 @@
 esp_err_t i2c_master_init();
 void i2c_lock();
 void i2c_unlock();
+void i2c_select_port(int port);
 esp_err_t i2c_master_read_slave(uint8_t addr7, uint8_t *data_rd, size_t size);
 esp_err_t i2c_master_write_slave(uint8_t addr7, uint8_t *data_wr, size_t size);
 
@@ -24,9 +24,11 @@
 #include "cci.h"
 #include "i2c.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <stdbool.h>
+#include <string.h>
 
 
 
@@ -39,6 +41,14 @@ static bool cci_last_status_error;
 
 
 
+//
+// CCI Forward Declarations for internal functions
+//
+static void cci_set_command(uint16_t cmd, uint16_t* data, int num_words, char* name);
+static bool cci_get_command(uint16_t cmd, uint16_t* data, int num_words, char* name);
+
+
+
 //
 // CCI API
 //
@@ -59,18 +69,50 @@ int cci_init()
  */
 int cci_write_register(uint16_t reg, uint16_t value)
 {
-	// Write the register address and value
-	uint8_t write_buf[4] = {
-		reg >> 8 & 0xff,
-		reg & 0xff,
-		value >> 8 & 0xff,
-		value & 0xff
-	};
+	return cci_write_burst(reg, &value, 1);
+}
+
+
+/**
+ * Read a CCI register.
+ * Updates cci_last_read_count to indicate how many bytes were read from the CCI.
+ * This should be checked by calling code after calling cci_read_register().
+ */
+uint16_t cci_read_register(uint16_t reg)
+{
+	uint16_t value;
+	
+	if (!cci_read_burst(reg, &value, 1)) {
+		return -1;
+	}
+	
+	return value;
+}
+
+
+/**
+ * Write num_words (up to CCI_MAX_BURST_WORDS) consecutive CCI registers starting at
+ * reg in one I2C transaction (the CCI auto-increments the register address).
+ */
+int cci_write_burst(uint16_t reg, uint16_t* values, int num_words)
+{
+	int i;
+	uint8_t write_buf[2 + CCI_MAX_BURST_WORDS*2];
+	
+	if (num_words > CCI_MAX_BURST_WORDS) num_words = CCI_MAX_BURST_WORDS;
+	
+	// Register address followed by the values
+	write_buf[0] = reg >> 8 & 0xff;
+	write_buf[1] = reg & 0xff;
+	for (i=0; i<num_words; i++) {
+		write_buf[2 + i*2] = values[i] >> 8 & 0xff;
+		write_buf[3 + i*2] = values[i] & 0xff;
+	}
 
 	i2c_lock();
-	if (i2c_master_write_slave(CCI_ADDRESS, write_buf, sizeof(write_buf)) != ESP_OK) {
+	if (i2c_master_write_slave(CCI_ADDRESS, write_buf, 2 + num_words*2) != ESP_OK) {
 		i2c_unlock();
-		ESP_LOGE(TAG, "failed to write CCI register %02x with value %02x", reg, value);
+		ESP_LOGE(TAG, "failed to write %d CCI registers at %02x", num_words, reg);
 		return -1;
 	};
 	i2c_unlock();
@@ -80,71 +122,105 @@ int cci_write_register(uint16_t reg, uint16_t value)
 
 
 /**
- * Read a CCI register.
+ * Read num_words (up to CCI_MAX_BURST_WORDS) consecutive CCI registers starting at
+ * reg in one I2C transaction.  Returns false for a communication failure.
  * Updates cci_last_read_count to indicate how many bytes were read from the CCI.
- * This should be checked by calling code after calling cci_read_register().
  */
-uint16_t cci_read_register(uint16_t reg)
+bool cci_read_burst(uint16_t reg, uint16_t* values, int num_words)
 {
-	uint8_t buf[2] = {0, 0};
+	int i;
+	uint8_t buf[CCI_MAX_BURST_WORDS*2];
+	
+	if (num_words > CCI_MAX_BURST_WORDS) num_words = CCI_MAX_BURST_WORDS;
 
 	// Write the register address
 	buf[0] = reg >> 8;
 	buf[1] = reg & 0xff;
   
 	i2c_lock();
-	if (i2c_master_write_slave(CCI_ADDRESS, buf, sizeof(buf)) != ESP_OK) {
+	if (i2c_master_write_slave(CCI_ADDRESS, buf, 2) != ESP_OK) {
 		i2c_unlock();
 		ESP_LOGE(TAG, "failed to write CCI register %02x", reg);
-		return -1;
+		return false;
 	}
 
 	// Read
-	if (i2c_master_read_slave(CCI_ADDRESS, buf, sizeof(buf)) != ESP_OK) {
+	if (i2c_master_read_slave(CCI_ADDRESS, buf, num_words*2) != ESP_OK) {
+		i2c_unlock();
 		ESP_LOGE(TAG, "failed to read from CCI register %02x (read %d)", reg, cci_last_read_count);
 		cci_last_read_count = 0;
+		return false;
 	}
 	i2c_unlock();
+	cci_last_read_count = num_words*2;
+	
+	for (i=0; i<num_words; i++) {
+		values[i] = buf[i*2] << 8 | buf[i*2 + 1];
+	}
 
-	return buf[0] << 8 | buf[1];
+	return true;
 }
 
 
 /**
  * Wait for busy to be clear in the status register
  *   Returns the 16-bit STATUS
- *   Returns 0x00010000 if there is a communication failure
+ *   Returns 0x00010000 if there is a communication failure or the camera stays busy
+ *   for CCI_BUSY_TIMEOUT_MSEC
+ *
+ * The first CCI_BUSY_FAST_POLLS reads are back-to-back and then the task sleeps a
+ * tick between reads so a long command doesn't monopolize the I2C bus or the CPU.
  */
 uint32_t cci_wait_busy_clear()
 {
-	bool err = false;
-	uint8_t buf[2] = {0x00, 0x07};
+	int polls = 0;
+	int64_t start_usec = esp_timer_get_time();
+	uint16_t status;
 
 	// Wait for booted, not busy
-	while (((buf[1] & 0x07) != 0x06) && !err) {
-		// Write STATUS register address
-		buf[0] = 0x00;
-		buf[1] = 0x02;
-		
-		i2c_lock();
-		if (i2c_master_write_slave(CCI_ADDRESS, buf, sizeof(buf)) != ESP_OK) {
-			ESP_LOGE(TAG, "failed to set STATUS register");
-			err = true;
-		};
-
-		// Read register - low bits in buf[1]
-		if (i2c_master_read_slave(CCI_ADDRESS, buf, sizeof(buf)) != ESP_OK) {
+	while (true) {
+		if (!cci_read_burst(CCI_REG_STATUS, &status, 1)) {
 			ESP_LOGE(TAG, "failed to read STATUS register");
-			err = true;
+			return 0x00010000;
+		}
+		if ((status & 0x07) == 0x06) {
+			return status;
+		}
+		
+		if ((esp_timer_get_time() - start_usec) > (CCI_BUSY_TIMEOUT_MSEC * 1000)) {
+			ESP_LOGE(TAG, "timeout waiting for busy clear (STATUS %04x)", status);
+			return 0x00010000;
+		}
+		if (++polls > CCI_BUSY_FAST_POLLS) {
+			vTaskDelay(1);
 		}
-		i2c_unlock();
 	}
+}
+
+
+/**
+ * Return true if the camera has finished booting and is not busy.  Used to poll the
+ * camera after a reset so it quietly returns false if the camera isn't responding yet.
+ */
+bool cci_booted()
+{
+	uint8_t buf[2];
 	
-	if (err) {
-		return 0x00010000;
-	} else {
-		return (buf[0] << 8) | buf[1];
+	buf[0] = CCI_REG_STATUS >> 8;
+	buf[1] = CCI_REG_STATUS & 0xff;
+	
+	i2c_lock();
+	if (i2c_master_write_slave(CCI_ADDRESS, buf, 2) != ESP_OK) {
+		i2c_unlock();
+		return false;
 	}
+	if (i2c_master_read_slave(CCI_ADDRESS, buf, 2) != ESP_OK) {
+		i2c_unlock();
+		return false;
+	}
+	i2c_unlock();
+	
+	return ((buf[1] & (CCI_STATUS_BOOTED | CCI_STATUS_BUSY)) == CCI_STATUS_BOOTED);
 }
 
 
@@ -182,6 +258,35 @@ bool cci_command_success()
 }
 
 
+/**
+ * Run a command that sets a 32-bit value (least significant word first).  Success is
+ * available from cci_command_success().
+ */
+void cci_set_u32(uint16_t cmd, uint32_t value, char* name)
+{
+	uint16_t data[2];
+	
+	data[0] = value & 0xffff;
+	data[1] = value >> 16 & 0xffff;
+	cci_set_command(cmd, data, 2, name);
+}
+
+
+/**
+ * Run a command that gets a 32-bit value (least significant word first).  Success is
+ * available from cci_command_success() (the value is 0 for a communication failure).
+ */
+uint32_t cci_get_u32(uint16_t cmd, char* name)
+{
+	uint16_t data[2];
+	
+	if (!cci_get_command(cmd, data, 2, name)) {
+		cci_last_status_error = true;
+	}
+	return data[1] << 16 | data[0];
+}
+
+
 /**
  * Ping the camera.
  *   Returns 0 for a successful ping
@@ -221,18 +326,62 @@ void cci_run_ffc()
 }
 
 
+/**
+ * Set the FFC shutter mode object
+ */
+void cci_set_ffc_shutter_mode(cci_ffc_shutter_mode_obj_t* obj)
+{
+	uint16_t data[16];
+	
+	data[0] = obj->shutterMode & 0xffff;
+	data[1] = obj->shutterMode >> 16 & 0xffff;
+	data[2] = obj->tempLockoutState & 0xffff;
+	data[3] = obj->tempLockoutState >> 16 & 0xffff;
+	data[4] = obj->videoFreezeDuringFFC & 0xffff;
+	data[5] = obj->videoFreezeDuringFFC >> 16 & 0xffff;
+	data[6] = obj->ffcDesired & 0xffff;
+	data[7] = obj->ffcDesired >> 16 & 0xffff;
+	data[8] = obj->elapsedTimeSinceLastFfc & 0xffff;
+	data[9] = obj->elapsedTimeSinceLastFfc >> 16 & 0xffff;
+	data[10] = obj->desiredFfcPeriod & 0xffff;
+	data[11] = obj->desiredFfcPeriod >> 16 & 0xffff;
+	data[12] = obj->explicitCmdToOpen & 0xffff;
+	data[13] = obj->explicitCmdToOpen >> 16 & 0xffff;
+	data[14] = obj->desiredFfcTempDelta;
+	data[15] = obj->imminentDelay;
+	cci_set_command(CCI_CMD_SYS_SET_FFC_SHUTTER_MODE, data, 16, "CCI_CMD_SYS_SET_FFC_SHUTTER_MODE");
+}
+
+
+/**
+ * Get the FFC shutter mode object
+ */
+bool cci_get_ffc_shutter_mode(cci_ffc_shutter_mode_obj_t* obj)
+{
+	bool success;
+	uint16_t data[16];
+	
+	success = cci_get_command(CCI_CMD_SYS_GET_FFC_SHUTTER_MODE, data, 16, "CCI_CMD_SYS_GET_FFC_SHUTTER_MODE");
+	obj->shutterMode = data[1] << 16 | data[0];
+	obj->tempLockoutState = data[3] << 16 | data[2];
+	obj->videoFreezeDuringFFC = data[5] << 16 | data[4];
+	obj->ffcDesired = data[7] << 16 | data[6];
+	obj->elapsedTimeSinceLastFfc = data[9] << 16 | data[8];
+	obj->desiredFfcPeriod = data[11] << 16 | data[10];
+	obj->explicitCmdToOpen = data[13] << 16 | data[12];
+	obj->desiredFfcTempDelta = data[14];
+	obj->imminentDelay = data[15];
+	
+	return success;
+}
+
+
 /**
  * Get the system uptime.
  */
 uint32_t cci_get_uptime()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_SYS_GET_UPTIME);
-	cci_wait_busy_clear_check("CCI_CMD_SYS_GET_UPTIME");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_SYS_GET_UPTIME, "CCI_CMD_SYS_GET_UPTIME");
 }
 
 
@@ -241,13 +390,7 @@ uint32_t cci_get_uptime()
  */
 uint32_t cci_get_aux_temp()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_SYS_GET_AUX_TEMP);
-	cci_wait_busy_clear_check("CCI_CMD_SYS_GET_AUX_TEMP");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_SYS_GET_AUX_TEMP, "CCI_CMD_SYS_GET_AUX_TEMP");
 }
 
 
@@ -256,13 +399,7 @@ uint32_t cci_get_aux_temp()
  */
 uint32_t cci_get_fpa_temp()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_SYS_GET_FPA_TEMP);
-	cci_wait_busy_clear_check("CCI_CMD_SYS_GET_FPA_TEMP");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_SYS_GET_FPA_TEMP, "CCI_CMD_SYS_GET_FPA_TEMP");
 }
 
 
@@ -271,13 +408,7 @@ uint32_t cci_get_fpa_temp()
  */
 void cci_set_telemetry_enable_state(cci_telemetry_enable_state_t state)
 {
-	uint32_t value = state;
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, value & 0xffff);
-	cci_write_register(CCI_REG_DATA_1, value >> 16 & 0xffff);
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_SYS_SET_TELEMETRY_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_SYS_SET_TELEMETRY_ENABLE_STATE");
+	cci_set_u32(CCI_CMD_SYS_SET_TELEMETRY_ENABLE_STATE, state, "CCI_CMD_SYS_SET_TELEMETRY_ENABLE_STATE");
 }
 
 
@@ -286,13 +417,7 @@ void cci_set_telemetry_enable_state(cci_telemetry_enable_state_t state)
  */
 uint32_t cci_get_telemetry_enable_state()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_SYS_GET_TELEMETRY_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_SYS_GET_TELEMETRY_ENABLE_STATE");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_SYS_GET_TELEMETRY_ENABLE_STATE, "CCI_CMD_SYS_GET_TELEMETRY_ENABLE_STATE");
 }
 
 
@@ -301,13 +426,7 @@ uint32_t cci_get_telemetry_enable_state()
  */
 void cci_set_telemetry_location(cci_telemetry_location_t location)
 {
-	uint32_t value = location;
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, value & 0xffff);
-	cci_write_register(CCI_REG_DATA_1, value >> 16 & 0xffff);
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_SYS_SET_TELEMETRY_LOCATION);
-	cci_wait_busy_clear_check("CCI_CMD_SYS_SET_TELEMETRY_LOCATION");
+	cci_set_u32(CCI_CMD_SYS_SET_TELEMETRY_LOCATION, location, "CCI_CMD_SYS_SET_TELEMETRY_LOCATION");
 }
 
 
@@ -316,37 +435,19 @@ void cci_set_telemetry_location(cci_telemetry_location_t location)
  */
 uint32_t cci_get_telemetry_location()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_SYS_GET_TELEMETRY_LOCATION);
-	cci_wait_busy_clear_check("CCI_CMD_SYS_GET_TELEMETRY_LOCATION");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_SYS_GET_TELEMETRY_LOCATION, "CCI_CMD_SYS_GET_TELEMETRY_LOCATION");
 }
 
 
 void cci_set_gain_mode(cc_gain_mode_t mode)
 {
-	uint32_t value = mode;
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, value & 0xffff);
-	cci_write_register(CCI_REG_DATA_1, value >> 16 & 0xffff);
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_SYS_SET_GAIN_MODE);
-	cci_wait_busy_clear_check("CCI_CMD_SYS_SET_GAIN_MODE");
+	cci_set_u32(CCI_CMD_SYS_SET_GAIN_MODE, mode, "CCI_CMD_SYS_SET_GAIN_MODE");
 }
 
 
 uint32_t cci_get_gain_mode()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_SYS_GET_GAIN_MODE);
-	cci_wait_busy_clear_check("CCI_CMD_SYS_GET_GAIN_MODE");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_SYS_GET_GAIN_MODE, "CCI_CMD_SYS_GET_GAIN_MODE");
 }
 
 
@@ -355,13 +456,7 @@ uint32_t cci_get_gain_mode()
  */
 void cci_set_radiometry_enable_state(cci_radiometry_enable_state_t state)
 {
-	uint32_t value = state;
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, value & 0xffff);
-	cci_write_register(CCI_REG_DATA_1, value >> 16 & 0xffff);
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_SET_RADIOMETRY_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_SET_RADIOMETRY_ENABLE_STATE");
+	cci_set_u32(CCI_CMD_RAD_SET_RADIOMETRY_ENABLE_STATE, state, "CCI_CMD_RAD_SET_RADIOMETRY_ENABLE_STATE");
 }
 
 
@@ -370,13 +465,7 @@ void cci_set_radiometry_enable_state(cci_radiometry_enable_state_t state)
  */
 uint32_t cci_get_radiometry_enable_state()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_GET_RADIOMETRY_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_GET_RADIOMETRY_ENABLE_STATE");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_RAD_GET_RADIOMETRY_ENABLE_STATE, "CCI_CMD_RAD_GET_RADIOMETRY_ENABLE_STATE");
 }
 
 
@@ -385,18 +474,17 @@ uint32_t cci_get_radiometry_enable_state()
  */
 void cci_set_radiometry_flux_linear_params(cci_rad_flux_linear_params_t* params)
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, params->sceneEmissivity);
-	cci_write_register(CCI_REG_DATA_1, params->TBkgK);
-	cci_write_register(CCI_REG_DATA_2, params->tauWindow);
-	cci_write_register(CCI_REG_DATA_3, params->TWindowK);
-	cci_write_register(CCI_REG_DATA_4, params->tauAtm);
-	cci_write_register(CCI_REG_DATA_5, params->TAtmK);
-	cci_write_register(CCI_REG_DATA_6, params->reflWindow);
-	cci_write_register(CCI_REG_DATA_7, params->TReflK);
-	cci_write_register(CCI_REG_DATA_LENGTH, 8);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_SET_RADIOMETRY_FLUX_LINEAR_PARAMS);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_SET_RADIOMETRY_FLUX_LINEAR_PARAMS");
+	uint16_t data[8];
+	
+	data[0] = params->sceneEmissivity;
+	data[1] = params->TBkgK;
+	data[2] = params->tauWindow;
+	data[3] = params->TWindowK;
+	data[4] = params->tauAtm;
+	data[5] = params->TAtmK;
+	data[6] = params->reflWindow;
+	data[7] = params->TReflK;
+	cci_set_command(CCI_CMD_RAD_SET_RADIOMETRY_FLUX_LINEAR_PARAMS, data, 8, "CCI_CMD_RAD_SET_RADIOMETRY_FLUX_LINEAR_PARAMS");
 }
 
 
@@ -405,20 +493,20 @@ void cci_set_radiometry_flux_linear_params(cci_rad_flux_linear_params_t* params)
  */
 bool cci_get_radiometry_flux_linear_params(cci_rad_flux_linear_params_t* params)
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 8);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_GET_RADIOMETRY_FLUX_LINEAR_PARAMS);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_GET_RADIOMETRY_FLUX_LINEAR_PARAMS");
-	params->sceneEmissivity = cci_read_register(CCI_REG_DATA_0);
-	params->TBkgK = cci_read_register(CCI_REG_DATA_1);
-	params->tauWindow = cci_read_register(CCI_REG_DATA_2);
-	params->TWindowK = cci_read_register(CCI_REG_DATA_3);
-	params->tauAtm = cci_read_register(CCI_REG_DATA_4);
-	params->TAtmK = cci_read_register(CCI_REG_DATA_5);
-	params->reflWindow = cci_read_register(CCI_REG_DATA_6);
-	params->TReflK = cci_read_register(CCI_REG_DATA_7);
+	bool success;
+	uint16_t data[8];
 	
-	return !cci_last_status_error;
+	success = cci_get_command(CCI_CMD_RAD_GET_RADIOMETRY_FLUX_LINEAR_PARAMS, data, 8, "CCI_CMD_RAD_GET_RADIOMETRY_FLUX_LINEAR_PARAMS");
+	params->sceneEmissivity = data[0];
+	params->TBkgK = data[1];
+	params->tauWindow = data[2];
+	params->TWindowK = data[3];
+	params->tauAtm = data[4];
+	params->TAtmK = data[5];
+	params->reflWindow = data[6];
+	params->TReflK = data[7];
+	
+	return success;
 }
 
 
@@ -427,13 +515,7 @@ bool cci_get_radiometry_flux_linear_params(cci_rad_flux_linear_params_t* params)
  */
 void cci_set_radiometry_tlinear_enable_state(cci_radiometry_tlinear_enable_state_t state)
 {
-	uint32_t value = state;
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, value & 0xffff);
-	cci_write_register(CCI_REG_DATA_1, value >> 16 & 0xffff);
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_ENABLE_STATE");
+	cci_set_u32(CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_ENABLE_STATE, state, "CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_ENABLE_STATE");
 }
 
 
@@ -442,13 +524,7 @@ void cci_set_radiometry_tlinear_enable_state(cci_radiometry_tlinear_enable_state
  */
 uint32_t cci_get_radiometry_tlinear_enable_state()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_ENABLE_STATE");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_ENABLE_STATE, "CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_ENABLE_STATE");
 }
 
 
@@ -457,13 +533,7 @@ uint32_t cci_get_radiometry_tlinear_enable_state()
  */
 void cci_set_radiometry_tlinear_auto_res(cci_radiometry_tlinear_auto_res_state_t state)
 {
-	uint32_t value = state;
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, value & 0xffff);
-	cci_write_register(CCI_REG_DATA_1, value >> 16 & 0xffff);
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_AUTO_RES);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_AUTO_RES");
+	cci_set_u32(CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_AUTO_RES, state, "CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_AUTO_RES");
 }
 
 
@@ -472,13 +542,7 @@ void cci_set_radiometry_tlinear_auto_res(cci_radiometry_tlinear_auto_res_state_t
  */
 uint32_t cci_get_radiometry_tlinear_auto_res()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_AUTO_RES);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_AUTO_RES");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_AUTO_RES, "CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_AUTO_RES");
 }
 
 
@@ -487,14 +551,9 @@ uint32_t cci_get_radiometry_tlinear_auto_res()
  */
 void cci_set_radiometry_spotmeter(uint16_t r1, uint16_t c1, uint16_t r2, uint16_t c2)
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, r1);
-	cci_write_register(CCI_REG_DATA_1, c1);
-	cci_write_register(CCI_REG_DATA_2, r2);
-	cci_write_register(CCI_REG_DATA_3, c2);
-	cci_write_register(CCI_REG_DATA_LENGTH, 4);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_SET_RADIOMETRY_SPOT_ROI);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_SET_RADIOMETRY_SPOT_ROI");
+	uint16_t data[4] = {r1, c1, r2, c2};
+	
+	cci_set_command(CCI_CMD_RAD_SET_RADIOMETRY_SPOT_ROI, data, 4, "CCI_CMD_RAD_SET_RADIOMETRY_SPOT_ROI");
 }
 
 
@@ -503,16 +562,16 @@ void cci_set_radiometry_spotmeter(uint16_t r1, uint16_t c1, uint16_t r2, uint16_
  */
 bool cci_get_radiometry_spotmeter(uint16_t* r1, uint16_t* c1, uint16_t* r2, uint16_t* c2)
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 4);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_RAD_GET_RADIOMETRY_SPOT_ROI);
-	cci_wait_busy_clear_check("CCI_CMD_RAD_GET_RADIOMETRY_SPOT_ROI");
-	*r1 = cci_read_register(CCI_REG_DATA_0);
-	*c1 = cci_read_register(CCI_REG_DATA_1);
-	*r2 = cci_read_register(CCI_REG_DATA_2);
-	*c2 = cci_read_register(CCI_REG_DATA_3);
+	bool success;
+	uint16_t data[4];
 	
-	return !cci_last_status_error;
+	success = cci_get_command(CCI_CMD_RAD_GET_RADIOMETRY_SPOT_ROI, data, 4, "CCI_CMD_RAD_GET_RADIOMETRY_SPOT_ROI");
+	*r1 = data[0];
+	*c1 = data[1];
+	*r2 = data[2];
+	*c2 = data[3];
+	
+	return success;
 }
 
 
@@ -521,13 +580,7 @@ bool cci_get_radiometry_spotmeter(uint16_t* r1, uint16_t* c1, uint16_t* r2, uint
  */
 uint32_t cci_get_agc_enable_state()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_AGC_GET_AGC_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_AGC_GET_AGC_ENABLE_STATE");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_AGC_GET_AGC_ENABLE_STATE, "CCI_CMD_AGC_GET_AGC_ENABLE_STATE");
 }
 
 
@@ -536,13 +589,7 @@ uint32_t cci_get_agc_enable_state()
  */
 void cci_set_agc_enable_state(cci_agc_enable_state_t state)
 {
-	uint32_t value = state;
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, value & 0xffff);
-	cci_write_register(CCI_REG_DATA_1, value >> 16 & 0xffff);
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_AGC_SET_AGC_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_AGC_SET_AGC_ENABLE_STATE");
+	cci_set_u32(CCI_CMD_AGC_SET_AGC_ENABLE_STATE, state, "CCI_CMD_AGC_SET_AGC_ENABLE_STATE");
 }
 
 
@@ -551,13 +598,7 @@ void cci_set_agc_enable_state(cci_agc_enable_state_t state)
  */
 uint32_t cci_get_agc_calc_enable_state()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_AGC_GET_CALC_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_AGC_GET_CALC_ENABLE_STATE");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_AGC_GET_CALC_ENABLE_STATE, "CCI_CMD_AGC_GET_CALC_ENABLE_STATE");
 }
 
 
@@ -566,15 +607,21 @@ uint32_t cci_get_agc_calc_enable_state()
  */
 void cci_set_agc_calc_enable_state(cci_agc_enable_state_t state)
 {
-	uint32_t value = state;
+	cci_set_u32(CCI_CMD_AGC_SET_CALC_ENABLE_STATE, state, "CCI_CMD_AGC_SET_CALC_ENABLE_STATE");
+}
+
+/**
+ * Run the Power Down command.  The camera stops responding to the CCI once it is
+ * powered down so this doesn't wait for the command to complete.  It is woken with
+ * a hardware reset.
+ */
+void cci_run_oem_power_down()
+{
 	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, value & 0xffff);
-	cci_write_register(CCI_REG_DATA_1, value >> 16 & 0xffff);
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_AGC_SET_CALC_ENABLE_STATE);
-	cci_wait_busy_clear_check("CCI_CMD_AGC_SET_CALC_ENABLE_STATE");
+	cci_write_register(CCI_REG_COMMAND, CCI_CMD_OEM_RUN_POWER_DOWN);
 }
 
+
 /**
  * Run the Reboot command
  */
@@ -588,18 +635,34 @@ void cc_run_oem_reboot()
 }
 
 
+/**
+ * Get the OEM part number ("500-0771-01") as a string of up to len - 1 characters.
+ * Returns false if the command failed.
+ */
+bool cci_get_part_number(char* part, int len)
+{
+	uint16_t data[16];
+	bool ret;
+	int i;
+	
+	ret = cci_get_command(CCI_CMD_OEM_GET_PART_NUMBER, data, 16, "CCI_CMD_OEM_GET_PART_NUMBER");
+	
+	// Characters are packed low byte first
+	for (i=0; (i<len-1) && (i<32); i++) {
+		part[i] = (i & 1) ? data[i/2] >> 8 : data[i/2] & 0xFF;
+	}
+	part[i] = 0;
+	
+	return ret;
+}
+
+
 /**
  * Get the GPIO mode.
  */
 uint32_t cci_get_gpio_mode()
 {
-	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
- 	cci_write_register(CCI_REG_COMMAND, CCI_CMD_OEM_SET_GPIO_MODE);
-	cci_wait_busy_clear_check("CCI_CMD_OEM_SET_GPIO_MODE");
-	uint16_t ls_word = cci_read_register(CCI_REG_DATA_0);
-	uint16_t ms_word = cci_read_register(CCI_REG_DATA_1);
-	return ms_word << 16 | ls_word;
+	return cci_get_u32(CCI_CMD_OEM_GET_GPIO_MODE, "CCI_CMD_OEM_GET_GPIO_MODE");
 }
 
 
@@ -608,11 +671,42 @@ uint32_t cci_get_gpio_mode()
  */
 void cci_set_gpio_mode(cci_gpio_mode_t mode)
 {
-	uint32_t value = mode;
+	cci_set_u32(CCI_CMD_OEM_SET_GPIO_MODE, mode, "CCI_CMD_OEM_SET_GPIO_MODE");
+}
+
+
+
+//
+// CCI internal functions
+//
+
+/**
+ * Run a command that sets num_words of data (loaded in one burst)
+ */
+static void cci_set_command(uint16_t cmd, uint16_t* data, int num_words, char* name)
+{
 	cci_wait_busy_clear();
-	cci_write_register(CCI_REG_DATA_0, value & 0xffff);
-	cci_write_register(CCI_REG_DATA_1, value >> 16 & 0xffff);
-	cci_write_register(CCI_REG_DATA_LENGTH, 2);
-	cci_write_register(CCI_REG_COMMAND, CCI_CMD_OEM_SET_GPIO_MODE);
-	cci_wait_busy_clear_check("CCI_CMD_OEM_SET_GPIO_MODE");
+	cci_write_burst(CCI_REG_DATA_0, data, num_words);
+	cci_write_register(CCI_REG_DATA_LENGTH, num_words);
+	cci_write_register(CCI_REG_COMMAND, cmd);
+	cci_wait_busy_clear_check(name);
+}
+
+
+/**
+ * Run a command that gets num_words of data (read in one burst).  Returns false if
+ * the command or the read failed.
+ */
+static bool cci_get_command(uint16_t cmd, uint16_t* data, int num_words, char* name)
+{
+	cci_wait_busy_clear();
+	cci_write_register(CCI_REG_DATA_LENGTH, num_words);
+	cci_write_register(CCI_REG_COMMAND, cmd);
+	cci_wait_busy_clear_check(name);
+	if (!cci_read_burst(CCI_REG_DATA_0, data, num_words)) {
+		memset(data, 0, num_words*2);
+		return false;
+	}
+	
+	return !cci_last_status_error;
 }
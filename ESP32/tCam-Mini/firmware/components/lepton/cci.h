@@ -37,6 +37,20 @@
 #define CCI_WORD_LENGTH 0x02
 #define CCI_ADDRESS 0x2A
 
+// Maximum number of 16-bit words in one burst register access (CCI_REG_DATA_0 -
+// CCI_REG_DATA_15)
+#define CCI_MAX_BURST_WORDS 16
+
+// Busy wait pacing: the STATUS register is polled back-to-back CCI_BUSY_FAST_POLLS
+// times (most commands complete in a few mSec) and then once per tick until
+// CCI_BUSY_TIMEOUT_MSEC
+#define CCI_BUSY_FAST_POLLS   8
+#define CCI_BUSY_TIMEOUT_MSEC 2000
+
+// STATUS register bits
+#define CCI_STATUS_BUSY   0x0001
+#define CCI_STATUS_BOOTED 0x0004
+
 // CCI register locations
 #define CCI_REG_STATUS 0x0002
 #define CCI_REG_COMMAND 0x0004
@@ -67,6 +81,8 @@
 #define CCI_CMD_SYS_SET_TELEMETRY_ENABLE_STATE 0x0219
 #define CCI_CMD_SYS_GET_TELEMETRY_LOCATION 0x021C
 #define CCI_CMD_SYS_SET_TELEMETRY_LOCATION 0x021D
+#define CCI_CMD_SYS_GET_FFC_SHUTTER_MODE 0x023C
+#define CCI_CMD_SYS_SET_FFC_SHUTTER_MODE 0x023D
 #define CCI_CMD_SYS_RUN_FFC 0x0242
 #define CCI_CMD_SYS_GET_GAIN_MODE 0x0248
 #define CCI_CMD_SYS_SET_GAIN_MODE 0x0249
@@ -87,8 +103,11 @@
 #define CCI_CMD_AGC_GET_CALC_ENABLE_STATE 0x0148
 #define CCI_CMD_AGC_SET_CALC_ENABLE_STATE 0x0149
 
+#define CCI_CMD_OEM_RUN_POWER_DOWN 0x4802
 #define CCI_CMD_OEM_RUN_REBOOT 0x4842
 
+#define CCI_CMD_OEM_GET_PART_NUMBER 0x481C
+
 #define CCI_CMD_OEM_GET_GPIO_MODE 0x4854
 #define CCI_CMD_OEM_SET_GPIO_MODE 0x4855
 
@@ -114,6 +133,13 @@ typedef enum {
 	CCI_TELEMETRY_LOCATION_FOOTER
 } cci_telemetry_location_t;
 
+// FFC Shutter Modes for use with CCI_CMD_SYS_SET_FFC_SHUTTER_MODE
+typedef enum {
+	CCI_FFC_SHUTTER_MODE_MANUAL,
+	CCI_FFC_SHUTTER_MODE_AUTO,
+	CCI_FFC_SHUTTER_MODE_EXTERNAL
+} cci_ffc_shutter_mode_t;
+
 // Gain Modes for use with CCI_CMD_SYS_SET_GAIN_MODE */
 typedef enum {
 	LEP_SYS_GAIN_MODE_HIGH,
@@ -165,6 +191,19 @@ typedef struct {
 	uint16_t TReflK;
 } cci_rad_flux_linear_params_t;
 
+// FFC Shutter Mode Object
+typedef struct {
+	uint32_t shutterMode;             // cci_ffc_shutter_mode_t
+	uint32_t tempLockoutState;
+	uint32_t videoFreezeDuringFFC;
+	uint32_t ffcDesired;
+	uint32_t elapsedTimeSinceLastFfc; // mSec
+	uint32_t desiredFfcPeriod;        // mSec
+	uint32_t explicitCmdToOpen;
+	uint16_t desiredFfcTempDelta;     // K * 100
+	uint16_t imminentDelay;           // Frames
+} cci_ffc_shutter_mode_obj_t;
+
 
 
 //
@@ -177,13 +216,22 @@ int cci_init();
 // Primative methods
 int cci_write_register(uint16_t reg, uint16_t value);
 uint16_t cci_read_register(uint16_t reg);
+int cci_write_burst(uint16_t reg, uint16_t* values, int num_words);
+bool cci_read_burst(uint16_t reg, uint16_t* values, int num_words);
 uint32_t cci_wait_busy_clear();
+bool cci_booted();
 void cci_wait_busy_clear_check(char* cmd);
 bool cci_command_success();
 
+// Generic 32-bit attributes (each SET command is its GET command + 1)
+void cci_set_u32(uint16_t cmd, uint32_t value, char* name);
+uint32_t cci_get_u32(uint16_t cmd, char* name);
+
 // Module: SYS
 uint32_t cci_run_ping();
 void cci_run_ffc();
+void cci_set_ffc_shutter_mode(cci_ffc_shutter_mode_obj_t* obj);
+bool cci_get_ffc_shutter_mode(cci_ffc_shutter_mode_obj_t* obj);
 uint32_t cci_get_uptime();
 uint32_t cci_get_aux_temp();
 uint32_t cci_get_fpa_temp();
@@ -213,7 +261,9 @@ void cci_set_agc_calc_enable_state(cci_agc_enable_state_t state);
 uint32_t cci_get_agc_calc_enable_state();
 
 // Module: OEM
+void cci_run_oem_power_down();
 void cc_run_oem_reboot();
+bool cci_get_part_number(char* part, int len);
 uint32_t cci_get_gpio_mode();
 void cci_set_gpio_mode(cci_gpio_mode_t mode);
 
@@ -1,2 +1,2 @@
 COMPONENT_SRCDIRS := . 
-COMPONENT_ADD_INCLUDEDIRS := . ../../main
\ No newline at end of file
+COMPONENT_ADD_INCLUDEDIRS := . ../../main ../../../../../vospi_asm
\ No newline at end of file
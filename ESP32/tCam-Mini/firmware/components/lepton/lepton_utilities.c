@@ -25,13 +25,17 @@
  * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
  *
  */
+#include <string.h>
 #include "lepton_utilities.h"
 #include "cci.h"
 #include "i2c.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
 #include "sys_utilities.h"
 #include "vospi.h"
+#include "vospi_asm.h"
 #include "system_config.h"
 
 
@@ -41,15 +45,139 @@
 //
 static const char* TAG = "lepton_utilities";
 
+// Time the last FFC was commanded (mSec, 32-bits so it may be read from other tasks)
+static volatile uint32_t ffc_cmd_msec;
+static volatile bool ffc_cmd_seen = false;
+
+// Time the last hardware reset was released
+static int64_t reset_usec;
+
+// Set while the Lepton is powered down (until the next reset).  Configuration changes
+// are only stored (in lep_st or below) and applied by lepton_init() when it is woken.
+static volatile bool lep_standby = false;
+
+// Spotmeter region (applied again after a reset)
+static bool spot_set = false;
+static uint16_t spot_r1, spot_c1, spot_r2, spot_c2;
+
+// Set by lepton_warm_start() when the Lepton kept running through an MCU reset (until
+// the next hardware reset)
+static bool lep_warm = false;
+
+// lepton_init() settings
+#define LEP_MAX_SETTINGS 9
+
+typedef struct {
+	uint16_t get_cmd;                // The SET command is get_cmd + 1
+	uint32_t val;
+	const char* name;
+} lep_setting_t;
+
+
+
+//
+// Lepton Utilities Forward Declarations for internal functions
+//
+static int lepton_get_settings(json_config_t* lep_stP, lep_setting_t* settings);
+static void lepton_flux_params(uint16_t e, cci_rad_flux_linear_params_t* params);
+static bool lepton_settings_match(lep_setting_t* settings, int n, cci_rad_flux_linear_params_t* flux);
+static bool lepton_verify_settings(lep_setting_t* settings, int n, cci_rad_flux_linear_params_t* flux);
+
 
 
 //
 // Lepton Utilities API
 //
 
+/**
+ * Pulse the Lepton hardware reset.  The reset GPIO must already be configured as an
+ * output.  The Lepton then takes up to LEP_BOOT_MAX_MSEC to boot during which time
+ * the caller is free to do other things before calling lepton_wait_boot().
+ */
+void lepton_reset()
+{
+	gpio_set_level(LEP_RESET_IO, 1);
+	vTaskDelay(pdMS_TO_TICKS(10));
+	gpio_set_level(LEP_RESET_IO, 0);
+	reset_usec = esp_timer_get_time();
+	lep_standby = false;
+	lep_warm = false;
+}
+
+
+/**
+ * Used in place of lepton_reset() at start-up.  After a software restart, panic or
+ * watchdog reset the Lepton kept its power and, usually, the configuration it was
+ * given before so it is left running for lepton_init() to check instead of being
+ * reset and configured again.  Returns true if the Lepton was not reset.
+ */
+bool lepton_warm_start()
+{
+	switch (esp_reset_reason()) {
+		case ESP_RST_SW:
+		case ESP_RST_PANIC:
+		case ESP_RST_INT_WDT:
+		case ESP_RST_TASK_WDT:
+		case ESP_RST_WDT:
+			gpio_set_level(LEP_RESET_IO, 0);
+			reset_usec = esp_timer_get_time();
+			lep_standby = false;
+			lep_warm = true;
+			ESP_LOGI(TAG, "Warm start: Lepton not reset");
+			return true;
+		default:
+			lepton_reset();
+			return false;
+	}
+}
+
+
+/**
+ * Returns true between lepton_warm_start() and the next lepton_reset()
+ */
+bool lepton_is_warm()
+{
+	return lep_warm;
+}
+
+
+/**
+ * Wait for the Lepton to finish booting after lepton_reset() by polling the CCI
+ * STATUS register.  Returns false if it did not boot within LEP_BOOT_MAX_MSEC of the
+ * reset.
+ */
+bool lepton_wait_boot()
+{
+	while (!cci_booted()) {
+		if ((esp_timer_get_time() - reset_usec) > (LEP_BOOT_MAX_MSEC * 1000)) {
+			ESP_LOGE(TAG, "Lepton did not boot");
+			return false;
+		}
+		vTaskDelay(pdMS_TO_TICKS(10));
+	}
+	
+	ESP_LOGI(TAG, "Lepton booted in %d mSec", (int) ((esp_timer_get_time() - reset_usec) / 1000));
+	return true;
+}
+
+
+/**
+ * Configure the Lepton from lep_st after lepton_wait_boot().  The settings are sent
+ * back to back and checked by the response code each command leaves in STATUS (read
+ * anyway while waiting for it to complete).  Only if one of them reports an error are
+ * they read back, and any that didn't take are set once more.  After
+ * lepton_warm_start() the Lepton's existing settings are only read and compared
+ * instead.  It returns false if they don't match so the caller can reset the Lepton
+ * and initialize it normally.
+ */
 bool lepton_init()
 {
-	uint32_t val, rsp;
+	int i, n;
+	uint32_t rsp;
+	bool success;
+	char part[33];
+	lep_setting_t settings[LEP_MAX_SETTINGS];
+	cci_rad_flux_linear_params_t flux;
 	json_config_t* lep_stP = system_get_lep_st();
   
   	// Attempt to ping the Lepton to validate communication
@@ -60,108 +188,109 @@ bool lepton_init()
   		return false;
 	}
 	
-	// Configure Radiometry for TLinear enabled, auto-resolution
-	cci_set_radiometry_enable_state(CCI_RADIOMETRY_ENABLED);
-	rsp = cci_get_radiometry_enable_state();
-	ESP_LOGI(TAG, "Lepton Radiometry = %d", rsp);
-	if (rsp != CCI_RADIOMETRY_ENABLED) {
-		// Make one more effort
-		vTaskDelay(pdMS_TO_TICKS(10));
-		ESP_LOGI(TAG, "Retry Set Lepton Radiometry");
-		cci_set_radiometry_enable_state(CCI_RADIOMETRY_ENABLED);
-		rsp = cci_get_radiometry_enable_state();
-		ESP_LOGI(TAG, "Lepton Radiometry = %d", rsp);
-		if (rsp != CCI_RADIOMETRY_ENABLED) {
-			ESP_LOGE(TAG, "Lepton communication failed (%d)", rsp);
+	// The firmware's images are LEP_WIDTH x LEP_HEIGHT so an 80x60 Lepton can't be used
+	if (cci_get_part_number(part, sizeof(part))) {
+		ESP_LOGI(TAG, "Lepton Part Number = %s", part);
+		if (vospi_asm_part_lepton(part) == VOSPI_ASM_PART_LEPTON2) {
+			ESP_LOGE(TAG, "Lepton 2.x (80x60) is not supported");
 			return false;
 		}
 	}
-
-	// TLinear depends on AGC
-	val = (lep_stP->agc_set_enabled) ? CCI_RADIOMETRY_TLINEAR_DISABLED : CCI_RADIOMETRY_TLINEAR_ENABLED;
-	cci_set_radiometry_tlinear_enable_state(val);
-	rsp = cci_get_radiometry_tlinear_enable_state();
-	ESP_LOGI(TAG, "Lepton Radiometry TLinear = %d", rsp);
-	if (rsp != val) {
-		ESP_LOGE(TAG, "Lepton communication failed (%d)", rsp);
-  		return false;
-	}
 	
-	cci_set_radiometry_tlinear_auto_res(CCI_RADIOMETRY_AUTO_RES_ENABLED);
-	rsp = cci_get_radiometry_tlinear_auto_res();
-	ESP_LOGI(TAG, "Lepton Radiometry Auto Resolution = %d", rsp);
-	if (rsp != CCI_RADIOMETRY_AUTO_RES_ENABLED) {
-		ESP_LOGE(TAG, "Lepton communication failed (%d)", rsp);
-  		return false;
-	}
+	n = lepton_get_settings(lep_stP, settings);
+	lepton_flux_params(lep_stP->emissivity, &flux);
 	
-	// Enable AGC calcs for a smooth transition between modes
-	cci_set_agc_calc_enable_state(CCI_AGC_ENABLED);
-	rsp = cci_get_agc_calc_enable_state();
-	ESP_LOGI(TAG, "Lepton AGC Calcs = %d", rsp);
-	if (rsp != CCI_AGC_ENABLED) {
-		ESP_LOGE(TAG, "Lepton communication failed (%d)", rsp);
-  		return false;
+	if (lep_warm) {
+		if (!lepton_settings_match(settings, n, &flux)) {
+			ESP_LOGI(TAG, "Lepton configuration differs after warm start");
+			return false;
+		}
+		ESP_LOGI(TAG, "Lepton already configured");
+	} else {
+		// Everything in one sequence, noting any error response
+		success = true;
+		for (i=0; i<n; i++) {
+			cci_set_u32(settings[i].get_cmd + 1, settings[i].val, (char*) settings[i].name);
+			success &= cci_command_success();
+		}
+		cci_set_radiometry_flux_linear_params(&flux);
+		success &= cci_command_success();
+		
+		if (!success && !lepton_verify_settings(settings, n, &flux)) {
+			return false;
+		}
+		ESP_LOGI(TAG, "Lepton configured (AGC %d, Gain Mode %d, Emissivity %d%%)",
+			lep_stP->agc_set_enabled, lep_stP->gain_mode, lep_stP->emissivity);
 	}
 	
-	// AGC
-	val = (lep_stP->agc_set_enabled) ? CCI_AGC_ENABLED : CCI_AGC_DISABLED;
-	cci_set_agc_enable_state(val);
-	rsp = cci_get_agc_enable_state();
-	ESP_LOGI(TAG, "Lepton AGC = %d", rsp);
-	if (rsp != val) {
-		ESP_LOGE(TAG, "Lepton communication failed (%d)", rsp);
-  		return false;
+	// Local telemetry and filter state
+#ifdef LEP_TELEM_HEADER
+	vospi_include_telem(0, true, true);
+#else
+	vospi_include_telem(0, true, false);
+#endif
+	for (i=0; i<LEP_NUM_LEPTONS; i++) {
+		vospi_set_temporal_filter(i, lep_stP->temporal_filter);
 	}
+	ESP_LOGI(TAG, "Temporal filter = %d", lep_stP->temporal_filter);
 	
-	// Enable telemetry
-	cci_set_telemetry_enable_state(CCI_TELEMETRY_ENABLED);
-	rsp = cci_get_telemetry_enable_state();
-	ESP_LOGI(TAG, "Lepton Telemetry = %d", rsp);
-	if (rsp != CCI_TELEMETRY_ENABLED) {
-		ESP_LOGE(TAG, "Lepton communication failed (%d)", rsp);
-  		return false;
+	// Spotmeter if one was set
+	if (spot_set) {
+		cci_set_radiometry_spotmeter(spot_r1, spot_c1, spot_r2, spot_c2);
 	}
-	vospi_include_telem(true);
 	
-	// GAIN
-	switch (lep_stP->gain_mode) {
-		case SYS_GAIN_HIGH:
-			val = LEP_SYS_GAIN_MODE_HIGH;
-			break;
-		case SYS_GAIN_LOW:
-			val = LEP_SYS_GAIN_MODE_LOW;
-			break;
-		default:
-			val = LEP_SYS_GAIN_MODE_AUTO;
-	}
-	cci_set_gain_mode(val);
-	rsp = cci_get_gain_mode();
-	ESP_LOGI(TAG, "Lepton Gain Mode = %d", rsp);
-	if (rsp != val) {
-		ESP_LOGE(TAG, "Lepton communication failed (%d)", rsp);
-  		return false;
-	}
+	return true;
+}
+
+
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+/**
+ * Wait for the second Lepton to boot and enable VSYNC on its GPIO3 through its own I2C
+ * port.  It shares the reset so this follows lepton_init() after each reset.  Its other
+ * settings are left at their power-on values.
+ */
+bool lepton_init_second()
+{
+	uint32_t rsp;
+	bool success = false;
 	
-	// Emissivity
-	lepton_emissivity(lep_stP->emissivity);
-	ESP_LOGI(TAG, "Lepton Emissivity = %d%%", lep_stP->emissivity);
-  	
-	// Finally enable VSYNC on Lepton GPIO3
-	cci_set_gpio_mode(LEP_OEM_GPIO_MODE_VSYNC);
-	rsp = cci_get_gpio_mode();
-	ESP_LOGI(TAG, "Lepton GPIO Mode = %d", rsp);
-	if (rsp != LEP_OEM_GPIO_MODE_VSYNC) {
-		ESP_LOGE(TAG, "Lepton communication failed (%d)", rsp);
-  		return false;
+	// Other tasks wait for the first Lepton's port while the second port is selected
+	i2c_lock();
+	i2c_select_port(LEP2_I2C_NUM);
+	if (lepton_wait_boot()) {
+		rsp = cci_run_ping();
+		if (rsp != 0) {
+			ESP_LOGE(TAG, "Second Lepton communication failed (%d)", rsp);
+		} else {
+			cci_set_gpio_mode(LEP_OEM_GPIO_MODE_VSYNC);
+			rsp = cci_get_gpio_mode();
+			ESP_LOGI(TAG, "Second Lepton GPIO Mode = %d", rsp);
+			success = (rsp == LEP_OEM_GPIO_MODE_VSYNC);
+		}
 	}
+	i2c_select_port(I2C_MASTER_NUM);
+	i2c_unlock();
 	
-	return true;
+	return success;
+}
+#endif
+
+
+/**
+ * Power down the Lepton.  It is woken with lepton_reset() followed by lepton_wait_boot()
+ * and lepton_init().
+ */
+void lepton_power_down()
+{
+	cci_run_oem_power_down();
+	lep_standby = true;
 }
 
 
 void lepton_agc(bool en)
 {
+	if (lep_standby) return;
+	
 	if (en) {
 		cci_set_radiometry_tlinear_enable_state(CCI_RADIOMETRY_TLINEAR_DISABLED);
 		cci_set_agc_enable_state(CCI_AGC_ENABLED);
@@ -174,7 +303,43 @@ void lepton_agc(bool en)
 
 void lepton_ffc()
 {
+	if (lep_standby) return;
+	
 	cci_run_ffc();
+	ffc_cmd_msec = (uint32_t) (esp_timer_get_time() / 1000);
+	ffc_cmd_seen = true;
+}
+
+
+/**
+ * Select whether the Lepton only runs a FFC when commanded (manual) or decides itself
+ * (automatic, its default after a reset).  The rest of its FFC settings are kept.
+ * Returns false if the mode couldn't be set.
+ */
+bool lepton_ffc_manual(bool en)
+{
+	cci_ffc_shutter_mode_obj_t obj;
+	
+	if (lep_standby) return false;
+	
+	if (!cci_get_ffc_shutter_mode(&obj)) {
+		return false;
+	}
+	obj.shutterMode = (en) ? CCI_FFC_SHUTTER_MODE_MANUAL : CCI_FFC_SHUTTER_MODE_AUTO;
+	cci_set_ffc_shutter_mode(&obj);
+	
+	return cci_command_success();
+}
+
+
+/**
+ * Returns true if lepton_ffc() was called within the last within_msec mSec
+ */
+bool lepton_ffc_commanded(uint32_t within_msec)
+{
+	uint32_t t = (uint32_t) (esp_timer_get_time() / 1000);
+	
+	return (ffc_cmd_seen && ((t - ffc_cmd_msec) < within_msec));
 }
 
 
@@ -182,6 +347,8 @@ void lepton_gain_mode(uint8_t mode)
 {
 	cc_gain_mode_t gain_mode;
 	
+	if (lep_standby) return;
+	
 	switch (mode) {
 		case SYS_GAIN_HIGH:
 			gain_mode = LEP_SYS_GAIN_MODE_HIGH;
@@ -198,6 +365,14 @@ void lepton_gain_mode(uint8_t mode)
 
 void lepton_spotmeter(uint16_t r1, uint16_t c1, uint16_t r2, uint16_t c2)
 {
+	spot_r1 = r1;
+	spot_c1 = c1;
+	spot_r2 = r2;
+	spot_c2 = c2;
+	spot_set = true;
+	
+	if (lep_standby) return;
+	
 	cci_set_radiometry_spotmeter(r1, c1, r2, c2);
 }
 
@@ -206,20 +381,9 @@ void lepton_emissivity(uint16_t e)
 {
 	cci_rad_flux_linear_params_t set_flux_values;
 	
-	// Scale percentage e into Lepton scene emissivity values (1-100% -> 82-8192)
-	if (e < 1) e = 1;
-	if (e > 100) e = 100;
-	set_flux_values.sceneEmissivity = e * 8192 / 100;
-	
-	// Set default (no lens) values for the remaining parameters
-	set_flux_values.TBkgK      = 29515;
-	set_flux_values.tauWindow  = 8192;
-	set_flux_values.TWindowK   = 29515;
-	set_flux_values.tauAtm     = 8192;
-	set_flux_values.TAtmK      = 29515;
-	set_flux_values.reflWindow = 0;
-	set_flux_values.TReflK     = 29515;
+	if (lep_standby) return;
 	
+	lepton_flux_params(e, &set_flux_values);
 	cci_set_radiometry_flux_linear_params(&set_flux_values);
 }
 
@@ -230,6 +394,46 @@ uint32_t lepton_get_tel_status(uint16_t* tel_buf)
 }
 
 
+/**
+ * Returns true if the telemetry status indicates a FFC is imminent or running
+ */
+bool lepton_tel_ffc_active(uint16_t* tel_buf)
+{
+	uint32_t state = lepton_get_tel_status(tel_buf) & LEP_STATUS_FFC_STATE;
+	
+	return ((state == LEP_FFC_STATE_IMM) || (state == LEP_FFC_STATE_RUN));
+}
+
+
+/**
+ * Returns the scale (LEP_TLIN_SCALE_xxx) that converts the pixels of a frame with
+ * TLinear enabled to K * 100 from its telemetry
+ */
+uint32_t lepton_tel_tlin_scale(uint16_t* tel_buf)
+{
+	// TLinear resolution 0 is 0.1 K and 1 is 0.01 K
+	return ((tel_buf[LEP_TEL_TLIN_RES] & 0x1) == 0) ? LEP_TLIN_SCALE_0_1K : LEP_TLIN_SCALE_0_01K;
+}
+
+
+/**
+ * Extract the fields that can be sent instead of the complete telemetry
+ */
+void lepton_get_tel_fields(uint16_t* tel_buf, lep_tel_fields_t* fields)
+{
+	uint32_t status = lepton_get_tel_status(tel_buf);
+	
+	fields->frame_cnt = (tel_buf[LEP_TEL_FC_HIGH] << 16) | tel_buf[LEP_TEL_FC_LOW];
+	fields->fpa_t_k100 = tel_buf[LEP_TEL_FPA_T_K100];
+	fields->aux_t_k100 = tel_buf[LEP_TEL_HSE_T_K100];
+	fields->ffc_state = (status & LEP_STATUS_FFC_STATE) >> 4;
+	fields->ffc_desired = (status & LEP_STATUS_FFC_DESIRED) != 0;
+	fields->gain_mode = tel_buf[LEP_TEL_EFF_GAIN_MODE] & 0x1;
+	fields->tlin_enabled = (tel_buf[LEP_TEL_TLIN_ENABLE] != 0);
+	fields->tlin_res = tel_buf[LEP_TEL_TLIN_RES] & 0x1;
+}
+
+
 /**
  * Convert a temperature reading from the lepton (in units of K * 100) to C
  */
@@ -237,3 +441,220 @@ float lepton_kelvin_to_C(uint32_t k, float lep_res)
 {
 	return (((float) k) * lep_res) - 273.15;
 }
+
+
+/**
+ * Convert a TLinear pixel to C * 100 in fixed point
+ */
+int32_t lepton_tlin_to_c100(uint16_t pixel, uint32_t scale)
+{
+	return (int32_t) (pixel * scale) - LEP_K100_AT_0C;
+}
+
+
+/**
+ * Convert n TLinear pixels to C * 100.  src and dst may be anywhere in a frame (for
+ * example one row of a region) and pixels are read in pairs from aligned 32-bit
+ * words to halve the (usually PSRAM) reads.
+ */
+void lepton_tlin_frame_to_c100(const uint16_t* src, int32_t* dst, int n, uint32_t scale)
+{
+	const uint32_t* wP;
+	uint32_t v;
+	
+	if ((n > 0) && ((((uint32_t) src) & 0x2) != 0)) {
+		*dst++ = (int32_t) (*src++ * scale) - LEP_K100_AT_0C;
+		n--;
+	}
+	
+	wP = (const uint32_t*) src;
+	while (n >= 2) {
+		v = *wP++;
+		*dst++ = (int32_t) ((v & 0xFFFF) * scale) - LEP_K100_AT_0C;
+		*dst++ = (int32_t) ((v >> 16) * scale) - LEP_K100_AT_0C;
+		n -= 2;
+	}
+	
+	if (n > 0) {
+		*dst = (int32_t) (*((const uint16_t*) wP) * scale) - LEP_K100_AT_0C;
+	}
+}
+
+
+/**
+ * Convert n TLinear pixels to K * 100 independent of the TLinear resolution
+ */
+void lepton_tlin_frame_to_k100(const uint16_t* src, uint32_t* dst, int n, uint32_t scale)
+{
+	const uint32_t* wP;
+	uint32_t v;
+	
+	if ((n > 0) && ((((uint32_t) src) & 0x2) != 0)) {
+		*dst++ = *src++ * scale;
+		n--;
+	}
+	
+	wP = (const uint32_t*) src;
+	while (n >= 2) {
+		v = *wP++;
+		*dst++ = (v & 0xFFFF) * scale;
+		*dst++ = (v >> 16) * scale;
+		n -= 2;
+	}
+	
+	if (n > 0) {
+		*dst = *((const uint16_t*) wP) * scale;
+	}
+}
+
+
+
+//
+// Lepton Utilities internal functions
+//
+
+/**
+ * Load the attributes lepton_init() sets from the configuration, in the order they
+ * are set (radiometry before TLinear, VSYNC last).  Returns the number loaded.
+ */
+static int lepton_get_settings(json_config_t* lep_stP, lep_setting_t* settings)
+{
+	int n = 0;
+	
+	// Radiometry with TLinear (depends on AGC) and auto-resolution
+	settings[n++] = (lep_setting_t) {CCI_CMD_RAD_GET_RADIOMETRY_ENABLE_STATE, CCI_RADIOMETRY_ENABLED, "Radiometry"};
+	settings[n++] = (lep_setting_t) {CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_ENABLE_STATE,
+		(lep_stP->agc_set_enabled) ? CCI_RADIOMETRY_TLINEAR_DISABLED : CCI_RADIOMETRY_TLINEAR_ENABLED, "Radiometry TLinear"};
+	settings[n++] = (lep_setting_t) {CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_AUTO_RES, CCI_RADIOMETRY_AUTO_RES_ENABLED,
+		"Radiometry Auto Resolution"};
+	
+	// AGC calcs enabled for a smooth transition between modes
+	settings[n++] = (lep_setting_t) {CCI_CMD_AGC_GET_CALC_ENABLE_STATE, CCI_AGC_ENABLED, "AGC Calcs"};
+	settings[n++] = (lep_setting_t) {CCI_CMD_AGC_GET_AGC_ENABLE_STATE,
+		(lep_stP->agc_set_enabled) ? CCI_AGC_ENABLED : CCI_AGC_DISABLED, "AGC"};
+	
+	// Telemetry
+#ifdef LEP_TELEM_HEADER
+	settings[n++] = (lep_setting_t) {CCI_CMD_SYS_GET_TELEMETRY_LOCATION, CCI_TELEMETRY_LOCATION_HEADER, "Telemetry Location"};
+#else
+	settings[n++] = (lep_setting_t) {CCI_CMD_SYS_GET_TELEMETRY_LOCATION, CCI_TELEMETRY_LOCATION_FOOTER, "Telemetry Location"};
+#endif
+	settings[n++] = (lep_setting_t) {CCI_CMD_SYS_GET_TELEMETRY_ENABLE_STATE, CCI_TELEMETRY_ENABLED, "Telemetry"};
+	
+	// Gain
+	switch (lep_stP->gain_mode) {
+		case SYS_GAIN_HIGH:
+			settings[n++] = (lep_setting_t) {CCI_CMD_SYS_GET_GAIN_MODE, LEP_SYS_GAIN_MODE_HIGH, "Gain Mode"};
+			break;
+		case SYS_GAIN_LOW:
+			settings[n++] = (lep_setting_t) {CCI_CMD_SYS_GET_GAIN_MODE, LEP_SYS_GAIN_MODE_LOW, "Gain Mode"};
+			break;
+		default:
+			settings[n++] = (lep_setting_t) {CCI_CMD_SYS_GET_GAIN_MODE, LEP_SYS_GAIN_MODE_AUTO, "Gain Mode"};
+	}
+	
+	// Finally VSYNC on Lepton GPIO3
+	settings[n++] = (lep_setting_t) {CCI_CMD_OEM_GET_GPIO_MODE, LEP_OEM_GPIO_MODE_VSYNC, "GPIO Mode"};
+	
+	return n;
+}
+
+
+/**
+ * Load the radiometry flux linear parameters for emissivity percentage e
+ */
+static void lepton_flux_params(uint16_t e, cci_rad_flux_linear_params_t* params)
+{
+	// Scale percentage e into Lepton scene emissivity values (1-100% -> 82-8192)
+	if (e < 1) e = 1;
+	if (e > 100) e = 100;
+	params->sceneEmissivity = e * 8192 / 100;
+	
+	// Set default (no lens) values for the remaining parameters
+	params->TBkgK      = 29515;
+	params->tauWindow  = 8192;
+	params->TWindowK   = 29515;
+	params->tauAtm     = 8192;
+	params->TAtmK      = 29515;
+	params->reflWindow = 0;
+	params->TReflK     = 29515;
+}
+
+
+/**
+ * Read the Lepton's current settings and return true if they are what lepton_init()
+ * would set, it is in automatic FFC mode and its spotmeter is at the boot default
+ * (the state the rest of the firmware assumes after a reset)
+ */
+static bool lepton_settings_match(lep_setting_t* settings, int n, cci_rad_flux_linear_params_t* flux)
+{
+	int i;
+	uint32_t rsp;
+	uint16_t r1, c1, r2, c2;
+	cci_rad_flux_linear_params_t cur_flux;
+	cci_ffc_shutter_mode_obj_t ffc;
+	
+	for (i=0; i<n; i++) {
+		rsp = cci_get_u32(settings[i].get_cmd, (char*) settings[i].name);
+		if (!cci_command_success() || (rsp != settings[i].val)) {
+			ESP_LOGI(TAG, "Lepton %s = %d (not %d)", settings[i].name, rsp, settings[i].val);
+			return false;
+		}
+	}
+	
+	if (!cci_get_radiometry_flux_linear_params(&cur_flux) ||
+	    (memcmp(&cur_flux, flux, sizeof(cci_rad_flux_linear_params_t)) != 0)) {
+		ESP_LOGI(TAG, "Lepton emissivity differs");
+		return false;
+	}
+	
+	if (!cci_get_ffc_shutter_mode(&ffc) || (ffc.shutterMode != CCI_FFC_SHUTTER_MODE_AUTO)) {
+		ESP_LOGI(TAG, "Lepton is not in automatic FFC mode");
+		return false;
+	}
+	
+	// Default spotmeter for a 160x120 Lepton
+	if (!cci_get_radiometry_spotmeter(&r1, &c1, &r2, &c2) ||
+	    (r1 != 59) || (c1 != 79) || (r2 != 60) || (c2 != 80)) {
+		ESP_LOGI(TAG, "Lepton spotmeter differs");
+		return false;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Read each setting back after one reported an error, setting any that didn't take
+ * one more time (the first commands after a boot occasionally fail).  Returns false
+ * if a setting still doesn't match.
+ */
+static bool lepton_verify_settings(lep_setting_t* settings, int n, cci_rad_flux_linear_params_t* flux)
+{
+	int i;
+	uint32_t rsp;
+	cci_rad_flux_linear_params_t cur_flux;
+	
+	for (i=0; i<n; i++) {
+		rsp = cci_get_u32(settings[i].get_cmd, (char*) settings[i].name);
+		if (rsp != settings[i].val) {
+			vTaskDelay(pdMS_TO_TICKS(10));
+			ESP_LOGI(TAG, "Retry Set Lepton %s", settings[i].name);
+			cci_set_u32(settings[i].get_cmd + 1, settings[i].val, (char*) settings[i].name);
+			rsp = cci_get_u32(settings[i].get_cmd, (char*) settings[i].name);
+		}
+		ESP_LOGI(TAG, "Lepton %s = %d", settings[i].name, rsp);
+		if (rsp != settings[i].val) {
+			ESP_LOGE(TAG, "Lepton communication failed (%d)", rsp);
+			return false;
+		}
+	}
+	
+	if (!cci_get_radiometry_flux_linear_params(&cur_flux) ||
+	    (memcmp(&cur_flux, flux, sizeof(cci_rad_flux_linear_params_t)) != 0)) {
+		ESP_LOGI(TAG, "Retry Set Lepton Emissivity");
+		cci_set_radiometry_flux_linear_params(flux);
+	}
+	
+	return true;
+}
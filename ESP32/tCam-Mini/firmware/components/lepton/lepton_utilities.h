@@ -31,6 +31,10 @@
 // Lepton Utilities Constants
 //
 
+// Maximum time from the end of a hardware reset until the Lepton reports it has
+// booted (datasheet specifies a maximum of 950 mSec)
+#define LEP_BOOT_MAX_MSEC    1000
+
 //
 // Telemetry words
 //
@@ -127,19 +131,74 @@
 #define LEP_FFC_STATE_RUN      0x00000020
 #define LEP_FFC_STATE_CMPL     0x00000030
 
+//
+// Radiometric (TLinear) conversion
+//   Pixels are multiplied by the scale for the TLinear resolution to get K * 100.  The
+//   Lepton has already applied the emissivity set by lepton_emissivity() (its flux
+//   linear parameters) so the conversion is just a scale and offset.
+//
+#define LEP_TLIN_SCALE_0_01K   1
+#define LEP_TLIN_SCALE_0_1K    10
+#define LEP_K100_AT_0C         27315
+
+//
+// Telemetry fields (bit mask) - a small subset of the telemetry that can be sent with
+// each frame instead of the complete telemetry
+//
+#define LEP_TEL_FLD_FRAME_CNT  0x01
+#define LEP_TEL_FLD_FPA_TEMP   0x02
+#define LEP_TEL_FLD_AUX_TEMP   0x04
+#define LEP_TEL_FLD_FFC        0x08
+#define LEP_TEL_FLD_GAIN       0x10
+#define LEP_TEL_FLD_TLIN       0x20
+#define LEP_TEL_FLD_ALL        0x3F
+
+
+
+//
+// Lepton Utilities typedefs
+//
+typedef struct {
+	uint32_t frame_cnt;              // Lepton frame counter
+	uint16_t fpa_t_k100;             // FPA temperature (K * 100)
+	uint16_t aux_t_k100;             // Housing (AUX) temperature (K * 100)
+	uint8_t ffc_state;               // LEP_FFC_STATE_xxx >> 4
+	bool ffc_desired;
+	uint8_t gain_mode;               // Effective gain mode (0: High, 1: Low)
+	bool tlin_enabled;
+	uint8_t tlin_res;                // 0: 0.1 K, 1: 0.01 K
+} lep_tel_fields_t;
+
 
 //
 // Lepton Utilities API
 //
+void lepton_reset();
+bool lepton_warm_start();
+bool lepton_is_warm();
+bool lepton_wait_boot();
 bool lepton_init();
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+bool lepton_init_second();
+#endif
+void lepton_power_down();
 void lepton_agc(bool en);
 void lepton_ffc();
+bool lepton_ffc_manual(bool en);
 void lepton_gain_mode(uint8_t mode);
 void lepton_spotmeter(uint16_t r1, uint16_t c1, uint16_t r2, uint16_t c2);
 void lepton_emissivity(uint16_t e);
 
+bool lepton_ffc_commanded(uint32_t within_msec);
+
 uint32_t lepton_get_tel_status(uint16_t* tel_buf);
+bool lepton_tel_ffc_active(uint16_t* tel_buf);
+uint32_t lepton_tel_tlin_scale(uint16_t* tel_buf);
+void lepton_get_tel_fields(uint16_t* tel_buf, lep_tel_fields_t* fields);
 
 float lepton_kelvin_to_C(uint32_t k, float lep_res);
+int32_t lepton_tlin_to_c100(uint16_t pixel, uint32_t scale);
+void lepton_tlin_frame_to_c100(const uint16_t* src, int32_t* dst, int n, uint32_t scale);
+void lepton_tlin_frame_to_k100(const uint16_t* src, uint32_t* dst, int n, uint32_t scale);
 
 #endif /* LEPTON_UTILITIES_H */
\ No newline at end of file
@@ -2,8 +2,11 @@
  * Lepton VoSPI Module
  *
  * Contains the functions to get frames from a Lepton 3.5 via its SPI port.
- * Optionally supports collecting telemetry when enabled as a footer (does not
- * support telemetry enabled as a header).
+ * Optionally supports collecting telemetry when enabled as either a header or a
+ * footer.  Segments are assembled by the shared VoSPI segment assembler
+ * (vospi_asm/vospi_asm.h at the top of the repository).  Each Lepton has its own
+ * capture context so a second Lepton on another SPI host can be read alongside the
+ * first.
  *
  * Copyright 2020 Dan Julio
  *
@@ -35,36 +38,77 @@
 #include "freertos/task.h"
 #include "driver/spi_master.h"
 #include "system_config.h"
+#include "perf_utilities.h"
 #include "vospi.h"
+#include "vospi_asm.h"
+#include "vospi_tf.h"
 
 
 
 //
-// VoSPI Variables
+// VoSPI typedefs
 //
 
-// Logging support
-static const char* TAG = "vospi";
+// Capture context of one Lepton
+typedef struct {
+	// SPI Interface (spiFreq is 0 until set for LEP_SPI_FREQ_HZ)
+	spi_device_handle_t spi;
+	spi_transaction_t spiTrans;
+	uint32_t spiFreq;
+	
+	// Link counters since they were last reset (for SPI clock calibration)
+	vospi_cal_count_t linkCnt;
+	
+	// Pointer to allocated array to store a burst of Lepton packets (DMA capable)
+	uint8_t* packetP;
+	
+	// Packet tap (NULL when none)
+	vospi_pkt_tap_t tap;
+	
+	// Shared frame buffer currently being loaded (16-bit image and telemetry values)
+	lep_buffer_t* bufP;
+	
+	// Segment assembler and the hooks it reads this Lepton's segments with
+	vospi_asm_t segAsm;
+	vospi_asm_hooks_t hooks;
+	
+	// VSYNC detection time of the segment being read
+	uint64_t segVsyncUsec;
+	
+	// Image range computed while unpacking packets: for the segment being read and for
+	// the completed segments of the frame being loaded
+	uint16_t segMin, segMax;
+	uint16_t frameMin, frameMax;
+	
+	// Image packets stored for the segment being read and the last segment completed
+	// (0 when the last read didn't complete a segment)
+	uint16_t segFirstPkt, segLastPkt;
+	int doneSeg;
+	uint16_t doneSegFirstPkt, doneSegNumPkts;
+	
+	// Temporal filter applied to each segment as it completes.  The level is set from
+	// other tasks and takes effect at the start of the next frame.
+	vospi_tf_t tf;
+	uint32_t* tfAccP;
+	volatile int tfLevel;
+	int tfCurLevel;
+} vospi_ctx_t;
+
 
-// SPI Interface
-static spi_device_handle_t spi;
-static spi_transaction_t lep_spi_trans;
 
-// Pointer to allocated array to store one Lepton packet (DMA capable)
-static uint8_t* lepPacketP;
+//
+// VoSPI Variables
+//
 
-// Lepton Frame buffer (16-bit values)
-static uint16_t lepBuffer[LEP_NUM_PIXELS];
+// Logging support
+static const char* TAG = "vospi";
 
-// Lepton Telemetry buffer (16-bit values)
-static uint16_t lepTelem[LEP_TEL_WORDS];
+// Per-Lepton capture contexts
+static vospi_ctx_t lepCtx[LEP_NUM_LEPTONS];
 
-// Processing State
-static int curSegment = 1;
-static int curLinesPerSeg = LEP_NOTEL_PKTS_PER_SEG;
-static int curWordsPerSeg = LEP_NOTEL_WORDS_PER_SEG;
-static bool validSegmentRegion = false;
-static bool includeTelemetry = false;
+// SPI host and chip select of each Lepton
+static const spi_host_device_t lepSpiHost[] = {LEP_SPI_HOST, LEP2_SPI_HOST};
+static const int lepCsnIo[] = {LEP_CSN_IO, LEP2_CSN_IO};
 
 
 
@@ -72,9 +116,13 @@ static bool includeTelemetry = false;
 //
 // VoSPI Forward Declarations for internal functions
 //
-static bool transfer_packet(uint8_t* line, uint8_t* seg);
-static void copy_packet_to_lepton_buffer(uint8_t line);
-static void copy_packet_to_telem_buffer(uint8_t line);
+static esp_err_t add_spi_device(int lep);
+static const uint8_t* transfer_packets(void* ctx, int numPkts);
+static bool segment_expired(void* ctx);
+static void store_packet(void* ctx, const vospi_asm_t* a, const uint8_t* pktP, int rsp);
+static void copy_packet_to_lepton_buffer(vospi_ctx_t* v, const uint8_t* pktP, int pkt);
+static void copy_packet_to_telem_buffer(vospi_ctx_t* v, const uint8_t* pktP, int row);
+static inline uint32_t swap_words(uint32_t w);
 
 
 
@@ -83,34 +131,39 @@ static void copy_packet_to_telem_buffer(uint8_t line);
 //
 
 /**
- * Initialise the VoSPI interface.
+ * Initialise the VoSPI interface of Lepton lep (0 - LEP_NUM_LEPTONS-1).
  */
-int vospi_init()
+int vospi_init(int lep)
 {
 	esp_err_t ret;
-  
-	spi_device_interface_config_t devcfg = {
-		.command_bits = 0,
-		.address_bits = 0,
-		.clock_speed_hz = LEP_SPI_FREQ_HZ,
-		.mode = 3,
-		.spics_io_num = LEP_CSN_IO,
-		.queue_size = 1,
-		.flags = SPI_DEVICE_HALFDUPLEX,
-		.cs_ena_pretrans = 10
-	};
+	vospi_ctx_t* v = &lepCtx[lep];
 
-	if ((ret=spi_bus_add_device(LEP_SPI_HOST, &devcfg, &spi)) != ESP_OK) {
-		ESP_LOGE(TAG, "failed to add lepton spi device");
-	} else {
-		// Allocate DMA capable memory for the lepton packet
-		lepPacketP = (uint8_t*) heap_caps_malloc(LEP_PKT_LENGTH, MALLOC_CAP_DMA);
-		if (lepPacketP != NULL) {
+	// Configure the assembler for no telemetry unless vospi_include_telem() already has
+	if (v->segAsm.linesPerSeg == 0) {
+		vospi_include_telem(lep, false, false);
+	}
+	
+	v->hooks.transfer = transfer_packets;
+	v->hooks.expired = segment_expired;
+	v->hooks.store = store_packet;
+	v->hooks.ctx = v;
+	v->hooks.maxPkts = LEP_SPI_BURST_PKTS;
+
+	if ((ret=add_spi_device(lep)) == ESP_OK) {
+		// Allocate DMA capable memory for a burst of lepton packets
+		v->packetP = (uint8_t*) heap_caps_malloc(LEP_SPI_BURST_PKTS*LEP_PKT_LENGTH, MALLOC_CAP_DMA);
+		if (v->packetP != NULL) {
 			ret = ESP_OK;
 		} else {
-			ESP_LOGE(TAG, "failed to allocate lepton DMA packet buffer");
+			ESP_LOGE(TAG, "failed to allocate lepton %d DMA packet buffer", lep);
 			ret = ESP_FAIL;
 		}
+		
+		// Temporal filter accumulator (the filter is unavailable without it, as it is in
+		// the low memory build)
+#ifndef CONFIG_TCAM_NO_PSRAM
+		v->tfAccP = (uint32_t*) system_buffer_alloc("temporal filter", lep, LEP_NUM_PIXELS*4, SYS_BUF_SPIRAM);
+#endif
 	}
 
 	return ret;
@@ -118,124 +171,231 @@ int vospi_init()
 
 
 /**
- * Attempt to read a complete segment from the Lepton
- *  - Data loaded into lepBuffer
+ * Attempt to read a complete segment from Lepton lep
+ *  - Data loaded into the buffer set by vospi_set_frame_buffer()
  *  - Returns true when last successful segment read, false otherwise
+ *  - Packets are read one at a time until the first valid packet of a segment is
+ *    seen and then the rest of the segment is read in bursts of up to
+ *    LEP_SPI_BURST_PKTS packets per DMA transaction
+ *  - Reads that end without seeing the end of a segment are counted as retries
+ *  - A packet with a bad CRC ends the read and restarts frame acquisition
  */
-bool vospi_transfer_segment(uint64_t vsyncDetectedUsec)
+bool vospi_transfer_segment(int lep, uint64_t vsyncDetectedUsec)
 {
-	uint8_t line, prevLine;
-	uint8_t segment;
-	bool done = false;
-	bool beforeValidData = true;
-	bool success = false;
-
-	prevLine = 255;
-
-	while (!done) {
-		if (transfer_packet(&line, &segment)) {
-			// Saw a valid packet
-			if (line == prevLine) {
-			// This is garbage data since line numbers should always increment
-			done = true;
-			} else {
-				// Check for termination or completion conditions
-				if (line == 20) {
-					// Check segment
-					if (!validSegmentRegion) {
-						// Look for start of valid segment data
-						if (segment == 1) {
-							beforeValidData = false;
-							validSegmentRegion = true;
-						}
-					} else if ((segment < 2) || (segment > 4)) {
-						// Hold/Reset in starting position (always collecting in segment 1 buffer locations)
-						validSegmentRegion = false;  // In case it was set
-						curSegment = 1;
-					}
-				}
-        
-				// Copy the data to the lepton frame buffer or telemetry buffer
-				//  - beforeValidData is used to collect data before we know if the current segment (1) is valid
-				//  - then we use validSegmentRegion for remaining data once we know we're seeing valid data
-				if (includeTelemetry && validSegmentRegion && (curSegment == 4) && (line >= 57)) {
-					copy_packet_to_telem_buffer(line - 57);
-				}
-				else if ((beforeValidData || validSegmentRegion) && (line < curLinesPerSeg)) {
-					copy_packet_to_lepton_buffer(line);
-				}
-	
-				if (line == (curLinesPerSeg-1)) {
-					// Saw a complete segment, move to next segment or complete frame aquisition if possible
-					if (validSegmentRegion) {
-						if (curSegment < 4) {
-							// Setup to get next segment
-							curSegment++;
-						} else {
-							// Got frame
-							success = true;
-
-							// Setup to get the next frame
-							curSegment = 1;
-							validSegmentRegion = false;
-						}
-					}
-					done = true;
-				}
+	int rsp;
+	vospi_ctx_t* v = &lepCtx[lep];
+
+	if (v->bufP == NULL) return false;
+
+	v->segVsyncUsec = vsyncDetectedUsec;
+	v->segMin = 0xFFFF;
+	v->segMax = 0x0000;
+	v->segFirstPkt = VOSPI_ASM_IMG_PKTS;
+	v->segLastPkt = 0;
+	v->doneSeg = 0;
+
+	rsp = vospi_asm_read_segment(&v->segAsm, &v->hooks);
+
+	v->linkCnt.reads++;
+	if (rsp & VOSPI_ASM_CRC_ERROR) {
+		perf_count(PERF_CNT_CRC_FAIL_SEG1 + v->segAsm.seg - 1);
+		v->linkCnt.crc_errors++;
+	}
+
+	if (rsp & VOSPI_ASM_SEGMENT) {
+		perf_record(PERF_STAGE_SEGMENT, vsyncDetectedUsec);
+		
+		// Filter the segment in place, replacing its range with the filtered range
+		if ((v->segAsm.seg == 1) && (v->tfLevel != v->tfCurLevel)) {
+			v->tfCurLevel = v->tfLevel;
+			if (v->tfCurLevel != 0) {
+				vospi_tf_init(&v->tf, v->tfAccP, v->tfCurLevel, LEP_TF_MOTION);
 			}
-			prevLine = line;
-		} else if ((esp_timer_get_time() - vsyncDetectedUsec) > LEP_MAX_FRAME_XFER_WAIT_USEC) {
-			// Did not see a valid packet within this segment interval
-      		done = true;
-    	}
+		}
+		if ((v->tfCurLevel != 0) && (v->segFirstPkt <= v->segLastPkt)) {
+			vospi_tf_filter16(&v->tf, v->bufP->lep_bufferP + v->segFirstPkt*(LEP_WIDTH/2), v->segFirstPkt*(LEP_WIDTH/2),
+			                  (v->segLastPkt - v->segFirstPkt + 1)*(LEP_WIDTH/2), &v->segMin, &v->segMax);
+			if (rsp & VOSPI_ASM_FRAME) vospi_tf_end_frame(&v->tf);
+		}
+
+		// Fold this segment's range into the frame's (segment 1 starts a frame)
+		if ((v->segAsm.seg == 1) || (v->segMin < v->frameMin)) v->frameMin = v->segMin;
+		if ((v->segAsm.seg == 1) || (v->segMax > v->frameMax)) v->frameMax = v->segMax;
+
+		// Note the part of the image this segment loaded
+		if (v->segFirstPkt <= v->segLastPkt) {
+			v->doneSeg = v->segAsm.seg;
+			v->doneSegFirstPkt = v->segFirstPkt;
+			v->doneSegNumPkts = v->segLastPkt - v->segFirstPkt + 1;
+		}
 	}
+
+	if (rsp & VOSPI_ASM_SEG_END) {
+		v->linkCnt.seg_ends++;
+	} else {
+		perf_count(PERF_CNT_SEG_RETRY);
+	}
+
+	return ((rsp & VOSPI_ASM_FRAME) != 0);
+}
+
+
+/**
+ * Set the shared frame buffer subsequent segments from Lepton lep are loaded directly
+ * into.  This should only be changed between frames (after vospi_transfer_segment()
+ * returns true) or before the first frame.
+ */
+void vospi_set_frame_buffer(int lep, lep_buffer_t* sys_bufP)
+{
+	lepCtx[lep].bufP = sys_bufP;
+}
+
+
+/**
+ * Finish a frame from Lepton lep loaded into the shared frame buffer by setting its
+ * metadata.  The image range was computed as the frame's packets were unpacked.
+ */
+void vospi_finish_frame(int lep, lep_buffer_t* sys_bufP)
+{
+	sys_bufP->lep_min_val = lepCtx[lep].frameMin;
+	sys_bufP->lep_max_val = lepCtx[lep].frameMax;
+	sys_bufP->lepton = (uint8_t) lep;
 	
-  	return success;
+	// Telemetry was loaded along with the image if enabled
+	sys_bufP->telem_valid = (lepCtx[lep].segAsm.flags & VOSPI_ASM_TELEM) != 0;
 }
 
 
 /**
- * Load the a system buffer from our buffers for another task
+ * Abandon the frame being loaded from Lepton lep and start looking for the start of a
+ * new frame
  */
-void vospi_get_frame(lep_buffer_t* sys_bufP)
+void vospi_resync(int lep)
 {
-	uint16_t* sptr = sys_bufP->lep_bufferP;
-	uint16_t* lptr = &lepBuffer[0];
-	uint16_t min = 0xFFFF;
-	uint16_t max = 0x0000;
-	uint16_t t16;
-
-	// Load lepton image data
-	while (lptr < &lepBuffer[LEP_NUM_PIXELS]) {
-		t16 = *lptr++;
-		if (t16 < min) min = t16;
-		if (t16 > max) max = t16;
-		*sptr++ = t16;
+	vospi_asm_resync(&lepCtx[lep].segAsm);
+}
+
+
+/**
+ * Configure the pipeline of Lepton lep to include telemetry or not and where the Lepton
+ * has been configured to send it (header set for the start of segment 1, clear for the
+ * end of segment 4).  This should be done during initialization
+ */
+void vospi_include_telem(int lep, bool en, bool header)
+{
+	uint8_t flags = 0;
+
+	if (en) {
+		flags = VOSPI_ASM_TELEM | ((header) ? VOSPI_ASM_TELEM_HEADER : 0);
 	}
-	sys_bufP->lep_min_val = min;
-	sys_bufP->lep_max_val = max;
+#ifdef LEP_CHECK_CRC
+	flags |= VOSPI_ASM_CHECK_CRC;
+#endif
+	vospi_asm_init(&lepCtx[lep].segAsm, flags);
+}
+
+
+/**
+ * Set the temporal noise filter level of Lepton lep (0: off, 1 - LEP_TF_MAX_LEVEL:
+ * stronger filtering, see vospi_tf.h).  Safe to call from other tasks.  The filter
+ * restarts with the next frame.
+ */
+void vospi_set_temporal_filter(int lep, int level)
+{
+	if ((level < 0) || (lepCtx[lep].tfAccP == NULL)) level = 0;
+	if (level > LEP_TF_MAX_LEVEL) level = LEP_TF_MAX_LEVEL;
+	lepCtx[lep].tfLevel = level;
+}
+
+
+/**
+ * Returns the segment (1-4) completed by vospi_transfer_segment() for Lepton lep since
+ * the last call or 0 if none.  start and len are loaded with the first pixel and the
+ * number of pixels the segment loaded into the shared frame buffer.  Segments are
+ * loaded in order so a returned segment 1 starts a new frame.
+ */
+int vospi_get_segment(int lep, uint16_t* start, uint16_t* len)
+{
+	vospi_ctx_t* v = &lepCtx[lep];
+	int seg = v->doneSeg;
+
+	if (seg != 0) {
+		*start = v->doneSegFirstPkt * (LEP_WIDTH/2);
+		*len = v->doneSegNumPkts * (LEP_WIDTH/2);
+		v->doneSeg = 0;
+	}
+
+	return seg;
+}
+
+
+/**
+ * Set the SPI clock of Lepton lep (0 for LEP_SPI_FREQ_HZ).  Before vospi_init() this
+ * only sets the rate it uses.  Afterwards the SPI device is replaced so it must be
+ * called from the task reading the Lepton.  The partial frame is dropped.
+ */
+int vospi_set_spi_freq(int lep, uint32_t hz)
+{
+	esp_err_t ret;
+	vospi_ctx_t* v = &lepCtx[lep];
 	
-	// Optionally load telemetry
-	sys_bufP->telem_valid = includeTelemetry;
-	if (includeTelemetry) {
-		sptr = sys_bufP->lep_telemP;
-		lptr = &lepTelem[0];
-		while (lptr < &lepTelem[LEP_TEL_WORDS]) {
-			*sptr++ = *lptr++;
-		}
+	v->spiFreq = hz;
+	if (v->spi == NULL) return ESP_OK;
+	
+	if ((ret=spi_bus_remove_device(v->spi)) != ESP_OK) {
+		ESP_LOGE(TAG, "failed to remove lepton %d spi device", lep);
+		return ret;
 	}
+	v->spi = NULL;
+	
+	ret = add_spi_device(lep);
+	vospi_asm_resync(&v->segAsm);
+	return ret;
 }
 
 
 /**
- * Configure the pipeline to include telemetry or not.
- * This should be done during initialization
+ * Returns the SPI clock requested for Lepton lep
  */
-void vospi_include_telem(bool en)
+uint32_t vospi_get_spi_freq(int lep)
 {
-	includeTelemetry = en;
-	curLinesPerSeg = (en) ? LEP_TEL_PKTS_PER_SEG : LEP_NOTEL_PKTS_PER_SEG;
-	curWordsPerSeg = (en) ? LEP_TEL_WORDS_PER_SEG : LEP_NOTEL_WORDS_PER_SEG;
+	return (lepCtx[lep].spiFreq != 0) ? lepCtx[lep].spiFreq : LEP_SPI_FREQ_HZ;
+}
+
+
+/**
+ * Load cnt with the link counters of Lepton lep, optionally resetting them
+ */
+void vospi_get_link_counts(int lep, vospi_cal_count_t* cnt, bool reset)
+{
+	vospi_ctx_t* v = &lepCtx[lep];
+	
+	*cnt = v->linkCnt;
+	if (reset) {
+		memset(&v->linkCnt, 0, sizeof(vospi_cal_count_t));
+	}
+}
+
+
+/**
+ * Set the packet tap of Lepton lep (NULL for none).  Must be called from the task reading
+ * the Lepton.
+ */
+void vospi_set_packet_tap(int lep, vospi_pkt_tap_t tap)
+{
+	lepCtx[lep].tap = tap;
+}
+
+
+/**
+ * Returns true when the telemetry for the frame currently being loaded from Lepton lep
+ * is already in the shared frame buffer.  This is the case once the first segment has
+ * been read when telemetry is a header so it may be examined a frame before the frame
+ * is complete.
+ */
+bool vospi_telem_ready(int lep)
+{
+	return vospi_asm_telem_header_ready(&lepCtx[lep].segAsm);
 }
 
 
@@ -245,88 +405,152 @@ void vospi_include_telem(bool en)
 //
 
 /**
- * Attempt to read one packet from the lepton
- *  - Return false for discard packets
- *  - Return true otherwise
- *    - line contains the packet line number for all valid packets
- *    - seg contains the packet segment number if the line number is 20
+ * Add the SPI device of Lepton lep at its current clock rate
  */
-static bool transfer_packet(uint8_t* line, uint8_t* seg)
+static esp_err_t add_spi_device(int lep)
 {
-	bool valid = false;
 	esp_err_t ret;
+	vospi_ctx_t* v = &lepCtx[lep];
+	
+	spi_device_interface_config_t devcfg = {
+		.command_bits = 0,
+		.address_bits = 0,
+		.clock_speed_hz = vospi_get_spi_freq(lep),
+		.mode = 3,
+		.spics_io_num = lepCsnIo[lep],
+		.queue_size = 1,
+		.flags = SPI_DEVICE_HALFDUPLEX,
+		.cs_ena_pretrans = 10
+	};
+
+	if ((ret=spi_bus_add_device(lepSpiHost[lep], &devcfg, &v->spi)) != ESP_OK) {
+		ESP_LOGE(TAG, "failed to add lepton %d spi device", lep);
+	}
+	
+	return ret;
+}
+
 
-	// *seg will be set if possible
-	*seg = 0;
+/**
+ * Read one or more packets from the lepton into the DMA buffer in a single
+ * transaction (segment assembler transfer hook)
+ */
+static const uint8_t* transfer_packets(void* ctx, int numPkts)
+{
+	esp_err_t ret;
+	vospi_ctx_t* v = (vospi_ctx_t*) ctx;
 
 	// Setup our SPI transaction
-	memset(&lep_spi_trans, 0, sizeof(spi_transaction_t));
-	lep_spi_trans.tx_buffer = NULL;
-	lep_spi_trans.rx_buffer = lepPacketP;
-	lep_spi_trans.rxlength = LEP_PKT_LENGTH*8;
+	memset(&v->spiTrans, 0, sizeof(spi_transaction_t));
+	v->spiTrans.tx_buffer = NULL;
+	v->spiTrans.rx_buffer = v->packetP;
+	v->spiTrans.rxlength = numPkts*LEP_PKT_LENGTH*8;
 
 	/************************************************************************************/
     /* Note: queued transactions cause a panic when a task yields and I can't figure    */
-    /* it out.  Disabling queuing gets rid of the panic at some performance hit.        */
+    /* it out.  Disabling queuing gets rid of the panic at some performance hit.  The   */
+    /* hit is mitigated by reading multiple packets in one transaction.                 */
     /************************************************************************************/
-	// Get a packet using the interrupt method and DMA engine to free the CPU some
-	//ret = spi_device_polling_transmit(spi, &lep_spi_trans);
-	ret = spi_device_transmit(spi, &lep_spi_trans);
+	// Get packets using the interrupt method and DMA engine to free the CPU some
+	//ret = spi_device_polling_transmit(v->spi, &v->spiTrans);
+	ret = spi_device_transmit(v->spi, &v->spiTrans);
 	ESP_ERROR_CHECK(ret);
-  
-	// Repeat as long as the frame is not valid, equals sync
-	if ((*lepPacketP & 0x0F) == 0x0F) {
-		valid = false;
-	} else {
-		*line = *(lepPacketP + 1);
+	
+	if (v->tap != NULL) {
+		v->tap((int) (v - lepCtx), v->packetP, numPkts);
+	}
 
-		// Get segment when possible
-		if (*line == 20) {
-			*seg = (*lepPacketP >> 4);
-		}
+	return v->packetP;
+}
 
-		valid = true;
-	}
 
-	return(valid);
+/**
+ * Returns true when there is no longer time to read the segment (segment assembler
+ * timing hook)
+ */
+static bool segment_expired(void* ctx)
+{
+	vospi_ctx_t* v = (vospi_ctx_t*) ctx;
+	
+	return ((esp_timer_get_time() - v->segVsyncUsec) > LEP_MAX_FRAME_XFER_WAIT_USEC);
 }
 
 
 /**
- * Copy the lepton packet to the raw lepton frame
- *   - line specifies packet line number
+ * Store a packet in the shared frame buffer (segment assembler store hook)
  */
-static void copy_packet_to_lepton_buffer(uint8_t line)
+static void store_packet(void* ctx, const vospi_asm_t* a, const uint8_t* pktP, int rsp)
 {
-	uint8_t* lepPopPtr = lepPacketP + 4;
-	uint16_t* acqPushPtr = &lepBuffer[((curSegment-1) * curWordsPerSeg) + (line * (LEP_WIDTH/2))];
-	uint16_t t;
+	vospi_ctx_t* v = (vospi_ctx_t*) ctx;
+	
+	if (rsp & VOSPI_ASM_STORE_TELEM) {
+		copy_packet_to_telem_buffer(v, pktP, a->dst);
+	} else {
+		copy_packet_to_lepton_buffer(v, pktP, a->dst);
+		if (a->dst < v->segFirstPkt) v->segFirstPkt = a->dst;
+		if (a->dst > v->segLastPkt) v->segLastPkt = a->dst;
+	}
+}
 
-	while (lepPopPtr <= (lepPacketP + (LEP_PKT_LENGTH-1))) {
-		t = *lepPopPtr++ << 8;
-		t |= *lepPopPtr++;
+
+/**
+ * Copy the lepton packet to the raw lepton frame, updating the segment's range
+ *   - pktP points to the packet in the DMA buffer
+ *   - pkt specifies the image packet (80 pixels) from the segment assembler
+ *   - Packets (LEP_PKT_LENGTH is a multiple of 4 bytes) and frame lines are 32-bit
+ *     aligned so the big-endian pixels are converted two at a time
+ */
+static void copy_packet_to_lepton_buffer(vospi_ctx_t* v, const uint8_t* pktP, int pkt)
+{
+	const uint32_t* lepPopPtr = (const uint32_t*) (pktP + 4);
+	const uint32_t* lepEndPtr = (const uint32_t*) (pktP + LEP_PKT_LENGTH);
+	uint32_t* acqPushPtr = (uint32_t*) (v->bufP->lep_bufferP + (pkt * (LEP_WIDTH/2)));
+	uint32_t t;
+	uint16_t p0, p1;
+	uint16_t min = v->segMin;
+	uint16_t max = v->segMax;
+
+	while (lepPopPtr < lepEndPtr) {
+		t = swap_words(*lepPopPtr++);
 		*acqPushPtr++ = t;
+		
+		p0 = t & 0xFFFF;
+		p1 = t >> 16;
+		if (p0 < min) min = p0;
+		if (p0 > max) max = p0;
+		if (p1 < min) min = p1;
+		if (p1 > max) max = p1;
 	}
+	
+	v->segMin = min;
+	v->segMax = max;
 }
 
 
 /**
  * Copy the lepton packet to the telemetry buffer
- *   - line specifies packet line number (only 0-2 are valid, do not call with line 3)
+ *   - pktP points to the packet in the DMA buffer
+ *   - row specifies the telemetry row (0-2)
  */
-static void copy_packet_to_telem_buffer(uint8_t line)
+static void copy_packet_to_telem_buffer(vospi_ctx_t* v, const uint8_t* pktP, int row)
 {
-	uint8_t* lepPopPtr = lepPacketP + 4;
-	uint16_t* telPushPtr = &lepTelem[line * (LEP_WIDTH/2)];
-	uint16_t t;
-	
-	if (line > 2) return;
-	
-	while (lepPopPtr <= (lepPacketP + (LEP_PKT_LENGTH-1))) {
-		t = *lepPopPtr++ << 8;
-		t |= *lepPopPtr++;
-		*telPushPtr++ = t;
+	const uint32_t* lepPopPtr = (const uint32_t*) (pktP + 4);
+	const uint32_t* lepEndPtr = (const uint32_t*) (pktP + LEP_PKT_LENGTH);
+	uint32_t* telPushPtr = (uint32_t*) (v->bufP->lep_telemP + (row * (LEP_WIDTH/2)));
+
+
+	while (lepPopPtr < lepEndPtr) {
+		*telPushPtr++ = swap_words(*lepPopPtr++);
 	}
 }
 
 
+/**
+ * Convert two big-endian 16-bit values loaded as a little-endian 32-bit word into two
+ * native 16-bit values (first value in the low half)
+ */
+static inline uint32_t swap_words(uint32_t w)
+{
+	return ((w & 0x00FF00FF) << 8) | ((w >> 8) & 0x00FF00FF);
+}
+
@@ -2,8 +2,8 @@
  * Lepton VoSPI Module
  *
  * Contains the functions to get frames from a Lepton 3.5 via its SPI port.
- * Optionally supports collecting telemetry when enabled as a footer (does not
- * support telemetry enabled as a header). 
+ * Optionally supports collecting telemetry when enabled as either a header or a
+ * footer.  Functions take the Lepton (0 - LEP_NUM_LEPTONS-1) they operate on.
  *
  * Copyright 2020 Dan Julio
  *
@@ -29,6 +29,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include "sys_utilities.h"
+#include "vospi_cal.h"
 
 
 //
@@ -53,12 +54,25 @@
 #define LEP_TEL_PKT_LEN (LEP_PKT_LENGTH - 4)
 #define LEP_TEL_WORDS   (LEP_TEL_PACKETS * LEP_TEL_PKT_LEN / 2)
 
+// Telemetry packets in a frame (3 telemetry packets and a reserved packet) found at
+// the start of segment 1 as a header or the end of segment 4 as a footer
+#define LEP_TEL_SEG_LINES 4
+
 // Dynamic values depending if telemetry is included or not
 #define LEP_TEL_PKTS_PER_SEG     61
 #define LEP_NOTEL_PKTS_PER_SEG   60
 #define LEP_TEL_WORDS_PER_SEG    (LEP_TEL_PKTS_PER_SEG * LEP_WIDTH / 2)
 #define LEP_NOTEL_WORDS_PER_SEG  (LEP_NOTEL_PKTS_PER_SEG * LEP_WIDTH / 2)
 
+// Temporal filter levels (0 disables the filter) and the difference in pixel counts
+// treated as motion
+#define LEP_TF_MAX_LEVEL 4
+#define LEP_TF_MOTION    16
+
+// Packet tap: called with every burst of packets read from a Lepton (discard packets
+// included), in the task reading the Lepton, before the segment assembler sees them
+typedef void (*vospi_pkt_tap_t)(int lep, const uint8_t* pktP, int numPkts);
+
 /* Lepton frame error return */
 enum LeptonReadError {
   NONE, DISCARD, SEGMENT_ERROR, ROW_ERROR, SEGMENT_INVALID
@@ -69,9 +83,18 @@ enum LeptonReadError {
 //
 // VoSPI API
 //
-int vospi_init();
-bool vospi_transfer_segment(uint64_t vsyncDetectedUsec);
-void vospi_get_frame(lep_buffer_t* sys_bufP);
-void vospi_include_telem(bool en);
+int vospi_init(int lep);
+bool vospi_transfer_segment(int lep, uint64_t vsyncDetectedUsec);
+void vospi_set_frame_buffer(int lep, lep_buffer_t* sys_bufP);
+void vospi_finish_frame(int lep, lep_buffer_t* sys_bufP);
+void vospi_resync(int lep);
+void vospi_include_telem(int lep, bool en, bool header);
+void vospi_set_temporal_filter(int lep, int level);
+bool vospi_telem_ready(int lep);
+int vospi_get_segment(int lep, uint16_t* start, uint16_t* len);
+int vospi_set_spi_freq(int lep, uint32_t hz);
+uint32_t vospi_get_spi_freq(int lep);
+void vospi_get_link_counts(int lep, vospi_cal_count_t* cnt, bool reset);
+void vospi_set_packet_tap(int lep, vospi_pkt_tap_t tap);
 
 #endif /* VOSPI_H */
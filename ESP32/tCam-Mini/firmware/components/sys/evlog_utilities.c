@@ -0,0 +1,495 @@
+/*
+ * Event log
+ *
+ * Persistent log of faults, recoveries and performance for post-mortem analysis of
+ * cameras in the field.  See evlog_utilities.h for the record and sector formats.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "evlog_utilities.h"
+#include "perf_utilities.h"
+#include "wifi_utilities.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <sys/time.h>
+
+
+
+//
+// Event Log Utilities variables
+//
+static const char* TAG = "evlog_utilities";
+
+// Log partition (NULL if the partition table has none)
+static const esp_partition_t* evlog_part;
+static uint32_t evlog_num_sectors;
+
+// Serializes flash access between mon_task and the tasks reading the log
+static SemaphoreHandle_t evlog_mutex;
+
+// Log status and the offset of the next record in the sector being written
+static evlog_info_t evlog_info;
+static uint32_t evlog_offset;
+
+// Records waiting to be written (protected by evlog_mux)
+static portMUX_TYPE evlog_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t evlog_queue[EVLOG_QUEUE_LEN * EVLOG_RECORD_LEN];
+static int evlog_queue_count;
+static int64_t evlog_oldest_usec;
+
+// Rate limits for the current minute (protected by evlog_mux).  Records lost to a
+// full queue are counted in evlog_suppressed[0].
+static uint8_t evlog_type_count[EVLOG_NUM_TYPES];
+static uint16_t evlog_suppressed[EVLOG_NUM_TYPES];
+
+// Records being written (protected by evlog_mutex)
+static uint8_t evlog_wr_buf[EVLOG_QUEUE_LEN * EVLOG_RECORD_LEN];
+
+// evlog_service() state
+static int evlog_secs;
+static int64_t evlog_time_usec;
+static uint32_t evlog_prev_recovery[3];
+static uint32_t evlog_prev_send_fail;
+static uint32_t evlog_prev_stalls;
+static uint32_t evlog_prev_frames;
+static uint32_t evlog_prev_sent;
+
+static const int recovery_counters[3] = {PERF_CNT_REALIGN, PERF_CNT_RESYNC, PERF_CNT_LEP_RESET};
+
+
+
+//
+// Event Log Utilities Forward Declarations for internal functions
+//
+static void find_head();
+static bool start_sector(uint32_t sector, uint32_t seq);
+static void queue_record(int64_t usec, uint8_t type, uint8_t a, uint16_t b, uint32_t v1, uint32_t v2, bool limit);
+static void log_counter(uint32_t n, uint32_t* prev, uint8_t type, uint8_t a, uint32_t v1);
+static void log_minute();
+static void log_time();
+static uint16_t clamp_u16(uint32_t n);
+static uint8_t* put_u32(uint8_t* p, uint32_t n);
+static uint32_t get_u32(const uint8_t* p);
+
+
+
+//
+// Event Log Utilities API
+//
+
+/**
+ * Find the log partition and the end of the log in it and log the boot.  Called before
+ * the tasks are started.  Returns false if the log couldn't be initialized (a missing
+ * partition, for example on a camera updated over the network with the partition table
+ * it was built with, just disables the log).
+ */
+bool evlog_init()
+{
+	evlog_mutex = xSemaphoreCreateMutex();
+	if (evlog_mutex == NULL) {
+		ESP_LOGE(TAG, "create log mutex failed");
+		return false;
+	}
+
+	memset(&evlog_info, 0, sizeof(evlog_info_t));
+
+	evlog_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, EVLOG_PARTITION_SUBTYPE, EVLOG_PARTITION_NAME);
+	if (evlog_part == NULL) {
+		ESP_LOGE(TAG, "No evlog partition - event log disabled");
+		return true;
+	}
+	evlog_num_sectors = evlog_part->size / EVLOG_SECTOR_LEN;
+	if (evlog_num_sectors < 2) {
+		ESP_LOGE(TAG, "evlog partition too small - event log disabled");
+		evlog_part = NULL;
+		return true;
+	}
+	evlog_info.size = evlog_num_sectors * EVLOG_SECTOR_LEN;
+
+	find_head();
+	if (evlog_part == NULL) return true;
+	evlog_info.enabled = true;
+	ESP_LOGI(TAG, "Boot %d, logging to sector %d at %d", evlog_info.boot, evlog_info.sector, evlog_offset);
+
+	// Written now so a camera that keeps restarting still logs each boot
+	evlog_event(EVLOG_EVT_BOOT, (uint8_t) esp_reset_reason(), 0, evlog_info.boot, 0);
+	evlog_flush();
+
+	return true;
+}
+
+
+/**
+ * Queue a record.  Records beyond EVLOG_MAX_PER_MIN of a type in a minute, or that don't
+ * fit in the queue, are counted instead.
+ */
+void evlog_event(uint8_t type, uint8_t a, uint16_t b, uint32_t v1, uint32_t v2)
+{
+	int64_t usec = esp_timer_get_time();
+
+	if ((evlog_part == NULL) || (type == 0) || (type >= EVLOG_NUM_TYPES)) return;
+
+	portENTER_CRITICAL(&evlog_mux);
+	queue_record(usec, type, a, b, v1, v2, true);
+	portEXIT_CRITICAL(&evlog_mux);
+}
+
+
+/**
+ * Log the events found in the performance counters since the last call, the time of
+ * day and the minute summary, and write the queued records when it is time.  Called once
+ * a second by mon_task.
+ */
+void evlog_service()
+{
+	perf_stage_t s;
+	int64_t usec;
+	uint32_t n;
+	bool flush;
+	int i;
+
+	if (evlog_part == NULL) return;
+
+	for (i=0; i<3; i++) {
+		n = perf_get_counter(recovery_counters[i]);
+		log_counter(n, &evlog_prev_recovery[i], EVLOG_EVT_RECOVERY, i, n);
+	}
+	n = perf_get_counter(PERF_CNT_SEND_FAIL);
+	log_counter(n, &evlog_prev_send_fail, EVLOG_EVT_SEND_FAIL, 0, n);
+
+	// The last send histogram bucket holds the sends that took at least EVLOG_STALL_USEC
+	perf_get_stage(PERF_STAGE_SEND, &s);
+	log_counter(s.hist[PERF_HIST_BUCKETS-1], &evlog_prev_stalls, EVLOG_EVT_SEND_STALL, 0, s.max_usec);
+
+	log_time();
+
+	if (++evlog_secs >= 60) {
+		evlog_secs = 0;
+		log_minute();
+	}
+
+	usec = esp_timer_get_time();
+	portENTER_CRITICAL(&evlog_mux);
+	flush = (evlog_queue_count >= EVLOG_FLUSH_RECORDS) ||
+	        ((evlog_queue_count != 0) && ((usec - evlog_oldest_usec) >= ((int64_t) EVLOG_FLUSH_SEC * 1000000)));
+	portEXIT_CRITICAL(&evlog_mux);
+
+	if (flush) evlog_flush();
+}
+
+
+/**
+ * Write the queued records, starting a new sector (erasing the oldest) when the one
+ * being written fills
+ */
+void evlog_flush()
+{
+	uint8_t* p = evlog_wr_buf;
+	uint32_t len, n;
+
+	if (evlog_part == NULL) return;
+
+	xSemaphoreTake(evlog_mutex, portMAX_DELAY);
+
+	portENTER_CRITICAL(&evlog_mux);
+	len = evlog_queue_count * EVLOG_RECORD_LEN;
+	memcpy(evlog_wr_buf, evlog_queue, len);
+	evlog_queue_count = 0;
+	portEXIT_CRITICAL(&evlog_mux);
+
+	while (len != 0) {
+		if (evlog_offset >= EVLOG_SECTOR_LEN) {
+			if (!start_sector((evlog_info.sector + 1) % evlog_num_sectors, evlog_info.seq + 1)) break;
+		}
+		n = EVLOG_SECTOR_LEN - evlog_offset;
+		if (n > len) n = len;
+		if (esp_partition_write(evlog_part, evlog_info.sector * EVLOG_SECTOR_LEN + evlog_offset, p, n) != ESP_OK) {
+			ESP_LOGE(TAG, "Log write failed");
+			break;
+		}
+		evlog_offset += n;
+		evlog_info.written += n / EVLOG_RECORD_LEN;
+		p += n;
+		len -= n;
+	}
+
+	xSemaphoreGive(evlog_mutex);
+}
+
+
+/**
+ * Get the log status
+ */
+void evlog_get_info(evlog_info_t* info)
+{
+	xSemaphoreTake(evlog_mutex, portMAX_DELAY);
+	*info = evlog_info;
+	xSemaphoreGive(evlog_mutex);
+
+	portENTER_CRITICAL(&evlog_mux);
+	info->queued = evlog_queue_count;
+	portEXIT_CRITICAL(&evlog_mux);
+}
+
+
+/**
+ * Called by rsp_task to read up to len bytes of the log partition starting at offset.
+ * Returns the number of bytes loaded into buf (0 at or past the end of the partition).
+ */
+uint32_t evlog_read(uint32_t offset, uint8_t* buf, uint32_t len)
+{
+	bool ok;
+
+	if (evlog_part == NULL) return 0;
+
+	if (offset >= evlog_info.size) return 0;
+	if (len > (evlog_info.size - offset)) len = evlog_info.size - offset;
+
+	xSemaphoreTake(evlog_mutex, portMAX_DELAY);
+	ok = (esp_partition_read(evlog_part, offset, buf, len) == ESP_OK);
+	xSemaphoreGive(evlog_mutex);
+
+	if (!ok) {
+		ESP_LOGE(TAG, "Log read failed");
+		return 0;
+	}
+
+	return len;
+}
+
+
+
+//
+// Event Log Utilities internal functions
+//
+
+/**
+ * Find the newest sector (the highest sequence number) and the end of the records in
+ * it, and set this boot's number.  A partition without a valid sector is started.
+ * Records that were being written when the power failed are skipped.
+ */
+static void find_head()
+{
+	uint8_t* hdr = evlog_wr_buf;
+	uint8_t* r;
+	uint32_t i, j, seq, offset;
+	uint32_t head_seq = 0;
+	uint16_t boot = 0;
+	bool found = false;
+
+	for (i=0; i<evlog_num_sectors; i++) {
+		if (esp_partition_read(evlog_part, i * EVLOG_SECTOR_LEN, hdr, EVLOG_SECTOR_HEADER_LEN) != ESP_OK) continue;
+		if ((get_u32(hdr) != EVLOG_MAGIC) || (hdr[4] != EVLOG_VERSION) || (hdr[5] != EVLOG_RECORD_LEN)) continue;
+		seq = get_u32(&hdr[8]);
+		if (!found || (seq > head_seq)) {
+			found = true;
+			head_seq = seq;
+			evlog_info.sector = i;
+			boot = hdr[6] | (hdr[7] << 8);
+		}
+	}
+
+	if (!found) {
+		ESP_LOGI(TAG, "Starting the event log");
+		evlog_info.boot = 1;
+		if (!start_sector(0, 0)) {
+			evlog_part = NULL;
+		}
+		return;
+	}
+	evlog_info.seq = head_seq;
+
+	// A sector holds records from the boot that started it and the boots logged in it
+	evlog_offset = EVLOG_SECTOR_HEADER_LEN;
+	for (offset=EVLOG_SECTOR_HEADER_LEN; offset<EVLOG_SECTOR_LEN; offset += sizeof(evlog_wr_buf)) {
+		if (esp_partition_read(evlog_part, evlog_info.sector * EVLOG_SECTOR_LEN + offset, evlog_wr_buf,
+		                       sizeof(evlog_wr_buf)) != ESP_OK) {
+			// Don't risk writing over records
+			evlog_offset = EVLOG_SECTOR_LEN;
+			break;
+		}
+		for (i=0; (i < sizeof(evlog_wr_buf)) && ((offset + i) < EVLOG_SECTOR_LEN); i += EVLOG_RECORD_LEN) {
+			r = &evlog_wr_buf[i];
+			for (j=0; j<EVLOG_RECORD_LEN; j++) {
+				if (r[j] != 0xFF) break;
+			}
+			if (j == EVLOG_RECORD_LEN) continue;
+			evlog_offset = offset + i + EVLOG_RECORD_LEN;
+			if (r[0] == EVLOG_EVT_BOOT) boot = (uint16_t) get_u32(&r[8]);
+		}
+	}
+	evlog_info.boot = boot + 1;
+}
+
+
+/**
+ * Erase a sector and write its header.  A sector that can't be written is skipped so
+ * a worn out sector doesn't stop the log.
+ */
+static bool start_sector(uint32_t sector, uint32_t seq)
+{
+	uint8_t hdr[EVLOG_SECTOR_HEADER_LEN];
+	uint8_t* p = hdr;
+
+	p = put_u32(p, EVLOG_MAGIC);
+	*p++ = EVLOG_VERSION;
+	*p++ = EVLOG_RECORD_LEN;
+	*p++ = evlog_info.boot & 0xFF;
+	*p++ = evlog_info.boot >> 8;
+	p = put_u32(p, seq);
+	(void) put_u32(p, 0xFFFFFFFF);
+
+	evlog_info.sector = sector;
+	evlog_info.seq = seq;
+	evlog_offset = EVLOG_SECTOR_LEN;
+	if ((esp_partition_erase_range(evlog_part, sector * EVLOG_SECTOR_LEN, EVLOG_SECTOR_LEN) != ESP_OK) ||
+	    (esp_partition_write(evlog_part, sector * EVLOG_SECTOR_LEN, hdr, EVLOG_SECTOR_HEADER_LEN) != ESP_OK)) {
+		ESP_LOGE(TAG, "Log sector %d erase or write failed", sector);
+		return false;
+	}
+	evlog_offset = EVLOG_SECTOR_HEADER_LEN;
+
+	return true;
+}
+
+
+/**
+ * Add a record to the queue, applying the rate limit if limit is set.  Called with
+ * evlog_mux held.
+ */
+static void queue_record(int64_t usec, uint8_t type, uint8_t a, uint16_t b, uint32_t v1, uint32_t v2, bool limit)
+{
+	uint8_t* p;
+
+	if (limit) {
+		if (evlog_type_count[type] >= EVLOG_MAX_PER_MIN) {
+			if (evlog_suppressed[type] != 0xFFFF) evlog_suppressed[type]++;
+			evlog_info.suppressed++;
+			return;
+		}
+		evlog_type_count[type]++;
+	}
+	if (evlog_queue_count >= EVLOG_QUEUE_LEN) {
+		if (evlog_suppressed[0] != 0xFFFF) evlog_suppressed[0]++;
+		evlog_info.suppressed++;
+		return;
+	}
+
+	if (evlog_queue_count == 0) evlog_oldest_usec = usec;
+	p = &evlog_queue[evlog_queue_count++ * EVLOG_RECORD_LEN];
+	*p++ = type;
+	*p++ = a;
+	*p++ = b & 0xFF;
+	*p++ = b >> 8;
+	p = put_u32(p, (uint32_t) (usec / 1000));
+	p = put_u32(p, v1);
+	(void) put_u32(p, v2);
+}
+
+
+/**
+ * Log an event for a counter that has increased since the last call
+ */
+static void log_counter(uint32_t n, uint32_t* prev, uint8_t type, uint8_t a, uint32_t v1)
+{
+	if (n != *prev) {
+		evlog_event(type, a, clamp_u16(n - *prev), v1, 0);
+		*prev = n;
+	}
+}
+
+
+/**
+ * Log the minute summary and the records each rate limit suppressed, then reset the
+ * rate limits
+ */
+static void log_minute()
+{
+	int64_t usec = esp_timer_get_time();
+	uint32_t frames = perf_get_counter(PERF_CNT_FRAMES);
+	uint32_t sent = perf_get_counter(PERF_CNT_IMAGES_SENT);
+	uint32_t heap = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+	int rssi;
+	int i;
+
+	if (!wifi_get_rssi(&rssi)) rssi = 0;
+
+	portENTER_CRITICAL(&evlog_mux);
+	queue_record(usec, EVLOG_EVT_MINUTE, (uint8_t) ((int8_t) rssi), clamp_u16(frames - evlog_prev_frames),
+	             sent - evlog_prev_sent, heap, false);
+	for (i=0; i<EVLOG_NUM_TYPES; i++) {
+		if (evlog_suppressed[i] != 0) {
+			queue_record(usec, EVLOG_EVT_SUPPRESSED, i, evlog_suppressed[i], 0, 0, false);
+			evlog_suppressed[i] = 0;
+		}
+		evlog_type_count[i] = 0;
+	}
+	portEXIT_CRITICAL(&evlog_mux);
+
+	evlog_prev_frames = frames;
+	evlog_prev_sent = sent;
+}
+
+
+/**
+ * Log the time of day once it has been set and then every EVLOG_TIME_SEC so the
+ * timestamps (time since boot) can be converted to the time of day
+ */
+static void log_time()
+{
+	struct timeval tv;
+	int64_t usec = esp_timer_get_time();
+
+	if ((evlog_time_usec != 0) && ((usec - evlog_time_usec) < ((int64_t) EVLOG_TIME_SEC * 1000000))) return;
+
+	// Not set from the RTC, SNTP or set_time yet (before 2020)
+	(void) gettimeofday(&tv, NULL);
+	if (tv.tv_sec < 1577836800) return;
+
+	evlog_time_usec = usec;
+	evlog_event(EVLOG_EVT_TIME, 0, 0, (uint32_t) tv.tv_sec, (uint32_t) tv.tv_usec);
+}
+
+
+static uint16_t clamp_u16(uint32_t n)
+{
+	return (n > 0xFFFF) ? 0xFFFF : n;
+}
+
+
+static uint8_t* put_u32(uint8_t* p, uint32_t n)
+{
+	*p++ = n & 0xFF;
+	*p++ = (n >> 8) & 0xFF;
+	*p++ = (n >> 16) & 0xFF;
+	*p++ = n >> 24;
+	return p;
+}
+
+
+static uint32_t get_u32(const uint8_t* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
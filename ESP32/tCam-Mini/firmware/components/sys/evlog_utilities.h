@@ -0,0 +1,149 @@
+/*
+ * Event log
+ *
+ * Persistent log of faults, recoveries and performance for post-mortem analysis of
+ * cameras in the field.  Fixed length binary records are kept in a ring of flash
+ * sectors (the evlog partition) that survives resets and power loss and is read with
+ * the get_log command.
+ *
+ * Records are queued in memory by evlog_event(), which may be called from any task
+ * and never touches the flash, and written by evlog_service(), called once a second
+ * by mon_task.  evlog_service() also turns the performance counters into events (VoSPI
+ * recoveries, send failures and stalls) and writes a summary record each minute.
+ * Each event type is limited to EVLOG_MAX_PER_MIN records a minute, the rest are
+ * counted and reported in a suppressed record so a fault that repeats can't fill the
+ * log or wear the flash.
+ *
+ * Records are only appended to erased flash.  Queued records are written together once
+ * EVLOG_FLUSH_RECORDS have accumulated or EVLOG_FLUSH_SEC after the oldest was queued.
+ * Boots and faults are written at once with evlog_flush().  A sector is erased when
+ * the ring wraps onto it so each sector is erased once per trip around the ring (a
+ * 32 sector log logging a record a minute erases each sector about every 5 days).
+ *
+ * Sector layout (all multi-byte values little-endian)
+ *    0 -  3: EVLOG_MAGIC
+ *    4     : EVLOG_VERSION
+ *    5     : Record length (EVLOG_RECORD_LEN)
+ *    6 -  7: Boot number when the sector was started
+ *    8 - 11: Sequence number (one more than the previous sector, the oldest sector has
+ *            the lowest)
+ *   12 - 15: Reserved (0xFFFFFFFF)
+ *   16 -   : Records, erased (all 0xFF) after the last one
+ *
+ * Record
+ *    0     : Type (EVLOG_EVT_xxx)
+ *    1     : a (see the types)
+ *    2 -  3: b
+ *    4 -  7: Milliseconds since boot
+ *    8 - 11: v1
+ *   12 - 15: v2
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef EVLOG_UTILITIES_H
+#define EVLOG_UTILITIES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+
+//
+// Event Log Utilities constants
+//
+
+// Partition (partitions.csv)
+#define EVLOG_PARTITION_NAME    "evlog"
+#define EVLOG_PARTITION_SUBTYPE 0x41
+
+// Layout
+#define EVLOG_MAGIC             0x474F4C74      // "tLOG"
+#define EVLOG_VERSION           1
+#define EVLOG_SECTOR_LEN        4096
+#define EVLOG_SECTOR_HEADER_LEN 16
+#define EVLOG_RECORD_LEN        16
+#define EVLOG_SECTOR_RECORDS    ((EVLOG_SECTOR_LEN - EVLOG_SECTOR_HEADER_LEN) / EVLOG_RECORD_LEN)
+
+// Queue and write policy
+#define EVLOG_QUEUE_LEN         64
+#define EVLOG_FLUSH_RECORDS     16
+#define EVLOG_FLUSH_SEC         60
+#define EVLOG_MAX_PER_MIN       10
+#define EVLOG_TIME_SEC          3600
+
+// Send times at least this long are stalls (the last send histogram bucket)
+#define EVLOG_STALL_USEC        262144
+
+// Record types
+//   BOOT        a: esp_reset_reason()  v1: boot number
+//   TIME        v1: time of day (seconds since 1970)  v2: microseconds
+//   FAULT       a: CTRL_FAULT_xxx (CTRL_FAULT_NONE when cleared)
+//   RECOVERY    a: EVLOG_REC_xxx  b: recoveries in the last second  v1: total since boot
+//   FFC         b: duration (mSec)  v1: FPA temperature (K * 100) at the end
+//   SEND_FAIL   b: images lost to a socket error in the last second  v1: total since boot
+//   SEND_STALL  b: sends that took at least EVLOG_STALL_USEC in the last second
+//               v1: longest send time since boot (uSec)
+//   MINUTE      a: RSSI (dBm, int8_t, 0 if not connected)  b: frames captured
+//               v1: images sent  v2: minimum free internal heap since boot (bytes)
+//   SUPPRESSED  a: type of the records not logged (0 for queue overflow)  b: count
+#define EVLOG_EVT_BOOT          1
+#define EVLOG_EVT_TIME          2
+#define EVLOG_EVT_FAULT         3
+#define EVLOG_EVT_RECOVERY      4
+#define EVLOG_EVT_FFC           5
+#define EVLOG_EVT_SEND_FAIL     6
+#define EVLOG_EVT_SEND_STALL    7
+#define EVLOG_EVT_MINUTE        8
+#define EVLOG_EVT_SUPPRESSED    9
+#define EVLOG_NUM_TYPES         10
+
+// Recovery types
+#define EVLOG_REC_REALIGN       0
+#define EVLOG_REC_RESYNC        1
+#define EVLOG_REC_LEP_RESET     2
+
+
+
+//
+// Event Log Utilities typedefs
+//
+typedef struct {
+	bool enabled;                 // False if there is no evlog partition
+	uint32_t size;                // Partition size (whole sectors)
+	uint16_t boot;                // This boot's number
+	uint32_t sector;              // Sector being written
+	uint32_t seq;                 // Its sequence number
+	uint32_t written;             // Records written since boot
+	uint32_t queued;              // Records waiting to be written
+	uint32_t suppressed;          // Records not logged since boot (rate limited or queue full)
+} evlog_info_t;
+
+
+
+//
+// Event Log Utilities API
+//
+bool evlog_init();
+void evlog_event(uint8_t type, uint8_t a, uint16_t b, uint32_t v1, uint32_t v2);
+void evlog_service();
+void evlog_flush();
+void evlog_get_info(evlog_info_t* info);
+uint32_t evlog_read(uint32_t offset, uint8_t* buf, uint32_t len);
+
+#endif /* EVLOG_UTILITIES_H */
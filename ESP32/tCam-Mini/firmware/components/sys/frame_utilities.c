@@ -0,0 +1,756 @@
+/*
+ * Lepton frame buffer broker
+ *
+ * Manages the pool of shared lepton frame buffers.  Each buffer is loaded by lep_task,
+ * published with a sequence number and then reference counted while subscribers
+ * use it.  The buffer state is protected by a spinlock since it is changed by
+ * several tasks (only for a few instructions at a time).
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "frame_utilities.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "perf_utilities.h"
+#include "soc/soc_memory_layout.h"
+#include "vospi.h"
+
+
+
+//
+// Frame Utilities typedefs
+//
+typedef struct {
+	lep_buffer_t buf;
+	int refs;                    // Subscriber references
+	uint32_t seq;                // Publish sequence number, 0 if not published
+	uint32_t num;                // Publish number among the frames from its Lepton
+	bool loading;                // Set while owned by lep_task
+	bool taken;                  // Set when acquired by at least one subscriber
+	bool internal;               // Image buffer is in internal DRAM
+} frame_t;
+
+typedef struct {
+	TaskHandle_t task;
+	uint32_t notify_mask;
+	int lepton;                  // Lepton the subscriber gets frames from
+	uint32_t last_num;           // Publish number of the last frame acquired or skipped
+} frame_sub_t;
+
+typedef struct {
+	lep_segment_t seg;
+	int refs;                    // Subscriber references (including while queued)
+	bool loading;                // Set while owned by lep_task
+} frame_seg_t;
+
+typedef struct {
+	lep_pkt_batch_t batch;
+	int refs;                    // Subscriber references (including while queued)
+	bool loading;                // Set while owned by lep_task
+} frame_pkt_t;
+
+
+
+//
+// Frame Utilities variables
+//
+static const char* TAG = "frame_utilities";
+
+static portMUX_TYPE frame_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static frame_t frames[LEP_FRAME_POOL_SIZE];
+static uint32_t pub_seq = 0;
+static uint32_t pub_num[LEP_NUM_LEPTONS];
+
+static frame_sub_t subs[FRAME_MAX_SUBSCRIBERS];
+static int num_subs = 0;
+
+// Segment pool and the published segments waiting for the segment subscriber (oldest
+// first)
+static frame_seg_t segs[LEP_SEG_POOL_SIZE];
+static frame_seg_t* seg_queue[LEP_SEG_POOL_SIZE];
+static int seg_queue_num = 0;
+static bool seg_enable = false;
+static TaskHandle_t seg_task = NULL;
+static uint32_t seg_notify_mask;
+
+// Raw packet batch pool and the published batches waiting for the batch subscriber
+// (oldest first)
+static frame_pkt_t pkts[LEP_PKT_POOL_SIZE];
+static frame_pkt_t* pkt_queue[LEP_PKT_POOL_SIZE];
+static int pkt_queue_num = 0;
+static bool pkt_enable = false;
+static TaskHandle_t pkt_task = NULL;
+static uint32_t pkt_notify_mask;
+
+
+
+//
+// Frame Utilities Forward Declarations for internal functions
+//
+static frame_t* find_frame(lep_buffer_t* bufP);
+static frame_seg_t* find_seg(lep_segment_t* segP);
+static frame_pkt_t* find_pkt(lep_pkt_batch_t* batchP);
+static frame_t* newest_frame(int lepton);
+static bool is_newest(frame_t* f);
+static bool better_frame(frame_t* f, frame_t* cur);
+
+
+
+//
+// Frame Utilities API
+//
+
+/**
+ * Allocate the frame buffers.  The first LEP_FRAME_POOL_INTERNAL image buffers and the
+ * telemetry buffers are placed in internal DRAM if there is room.  The rest, and the
+ * segment and packet batch buffers, are in the external RAM.
+ */
+bool frame_init()
+{
+	int i;
+	int placement;
+	
+	for (i=0; i<LEP_FRAME_POOL_SIZE; i++) {
+		placement = (i < LEP_FRAME_POOL_INTERNAL) ? SYS_BUF_INTERNAL : SYS_BUF_SPIRAM;
+		frames[i].buf.lep_bufferP = system_buffer_alloc("frame", i, LEP_NUM_PIXELS*2, placement);
+		if (frames[i].buf.lep_bufferP == NULL) {
+			ESP_LOGE(TAG, "malloc lepton shared image buffer %d failed", i);
+			return false;
+		}
+		frames[i].internal = esp_ptr_internal(frames[i].buf.lep_bufferP);
+		frames[i].buf.lep_telemP = system_buffer_alloc("frame telem", i, LEP_TEL_WORDS*2, SYS_BUF_INTERNAL);
+		if (frames[i].buf.lep_telemP == NULL) {
+			ESP_LOGE(TAG, "malloc lepton shared telemetry buffer %d failed", i);
+			return false;
+		}
+		frames[i].buf.avg_frames = 0;
+		frames[i].buf.avg_frac_bits = 0;
+		frames[i].buf.sync_tick_usec = 0;
+		frames[i].buf.histP = NULL;
+		frames[i].refs = 0;
+		frames[i].seq = 0;
+		frames[i].loading = false;
+		frames[i].taken = false;
+	}
+	
+	for (i=0; i<LEP_SEG_POOL_SIZE; i++) {
+		segs[i].seg.buf.lep_bufferP = system_buffer_alloc("segment", i, LEP_TEL_WORDS_PER_SEG*2, SYS_BUF_SPIRAM);
+		segs[i].seg.buf.lep_telemP = system_buffer_alloc("segment telem", i, LEP_TEL_WORDS*2, SYS_BUF_SPIRAM);
+		if ((segs[i].seg.buf.lep_bufferP == NULL) || (segs[i].seg.buf.lep_telemP == NULL)) {
+			ESP_LOGE(TAG, "malloc lepton segment buffer %d failed", i);
+			return false;
+		}
+		segs[i].seg.buf.avg_frames = 0;
+		segs[i].seg.buf.avg_frac_bits = 0;
+		segs[i].seg.buf.sync_tick_usec = 0;
+		segs[i].seg.buf.histP = NULL;
+		segs[i].refs = 0;
+		segs[i].loading = false;
+	}
+	
+	for (i=0; i<LEP_PKT_POOL_SIZE; i++) {
+		pkts[i].batch.pktP = system_buffer_alloc("packet batch", i, LEP_PKT_BATCH_PKTS*LEP_PKT_LENGTH, SYS_BUF_SPIRAM);
+		if (pkts[i].batch.pktP == NULL) {
+			ESP_LOGE(TAG, "malloc lepton packet batch buffer %d failed", i);
+			return false;
+		}
+		pkts[i].refs = 0;
+		pkts[i].loading = false;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Get a buffer for lep_task to load.  Blocks while every buffer is held so it is only
+ * used at startup, before there are any subscribers.
+ */
+lep_buffer_t* frame_get_free()
+{
+	lep_buffer_t* bufP;
+	
+	while ((bufP = frame_try_get_free()) == NULL) {
+		// Subscribers are holding all the buffers
+		vTaskDelay(pdMS_TO_TICKS(1));
+	}
+	
+	return bufP;
+}
+
+
+/**
+ * Get a buffer for lep_task to load or NULL if every other buffer is held by a
+ * subscriber.  Buffers in internal DRAM are taken first so the frames being loaded and
+ * encoded are usually there, then unused buffers, then the oldest published frame no
+ * subscriber holds (the newest frame of a Lepton only as a last resort).  lep_task gets
+ * the next buffer before publishing the one it loaded so it never waits on a
+ * subscriber: without a free buffer it drops the frame and reloads its own buffer.
+ */
+lep_buffer_t* frame_try_get_free()
+{
+	int i;
+	bool reclaimed = false;
+	frame_t* f = NULL;
+	frame_t* newestP;
+	
+	portENTER_CRITICAL(&frame_mux);
+	for (i=0; i<LEP_FRAME_POOL_SIZE; i++) {
+		if (frames[i].loading || (frames[i].refs != 0) || is_newest(&frames[i])) continue;
+		if (better_frame(&frames[i], f)) {
+			f = &frames[i];
+		}
+	}
+	for (i=0; (i<LEP_NUM_LEPTONS) && (f == NULL); i++) {
+		newestP = newest_frame(i);
+		if ((newestP != NULL) && !newestP->loading && (newestP->refs == 0)) {
+			f = newestP;
+		}
+	}
+	if (f != NULL) {
+		reclaimed = (f->seq != 0) && !f->taken;
+		f->seq = 0;
+		f->loading = true;
+		f->taken = false;
+	}
+	portEXIT_CRITICAL(&frame_mux);
+	
+	if (f == NULL) {
+		return NULL;
+	}
+	
+	if (reclaimed) {
+		// No subscriber ever used this frame
+		perf_count(PERF_CNT_FRAME_RECLAIM);
+	}
+	return &f->buf;
+}
+
+
+/**
+ * Publish a frame loaded by lep_task as the newest frame from its Lepton (set in the
+ * buffer) and notify that Lepton's subscribers
+ */
+void frame_publish(lep_buffer_t* bufP)
+{
+	int i;
+	frame_t* f = find_frame(bufP);
+	
+	if ((f == NULL) || (bufP->lepton >= LEP_NUM_LEPTONS)) return;
+	
+	portENTER_CRITICAL(&frame_mux);
+	f->seq = ++pub_seq;
+	f->num = ++pub_num[bufP->lepton];
+	f->loading = false;
+	portEXIT_CRITICAL(&frame_mux);
+	
+	for (i=0; i<num_subs; i++) {
+		if (subs[i].lepton == bufP->lepton) {
+			xTaskNotify(subs[i].task, subs[i].notify_mask, eSetBits);
+		}
+	}
+}
+
+
+/**
+ * Register a task to be notified with notify_mask each time a frame from the first
+ * Lepton is published.  Returns the subscriber id or -1 if there are too many
+ * subscribers.  Subscriptions should be made during task initialization.
+ */
+int frame_subscribe(TaskHandle_t task, uint32_t notify_mask)
+{
+	return frame_subscribe_lepton(task, notify_mask, 0);
+}
+
+
+/**
+ * Register a task to be notified with notify_mask each time a frame from Lepton lepton
+ * is published.  A task subscribes separately to each Lepton it wants frames from.
+ */
+int frame_subscribe_lepton(TaskHandle_t task, uint32_t notify_mask, int lepton)
+{
+	int sub;
+	
+	portENTER_CRITICAL(&frame_mux);
+	if ((num_subs < FRAME_MAX_SUBSCRIBERS) && (lepton >= 0) && (lepton < LEP_NUM_LEPTONS)) {
+		sub = num_subs;
+		subs[sub].task = task;
+		subs[sub].notify_mask = notify_mask;
+		subs[sub].lepton = lepton;
+		subs[sub].last_num = pub_num[lepton];
+		num_subs++;
+	} else {
+		sub = -1;
+	}
+	portEXIT_CRITICAL(&frame_mux);
+	
+	if (sub < 0) {
+		ESP_LOGE(TAG, "Too many frame subscribers");
+	}
+	
+	return sub;
+}
+
+
+/**
+ * Acquire a reference to the newest frame from the subscriber's Lepton if the
+ * subscriber hasn't seen it.  Returns
+ * NULL if there is no new frame.  missed is set to the number of frames published
+ * since the subscriber last acquired or skipped frames that it will never see.
+ * The frame must be released with frame_release() when the subscriber is done.
+ */
+lep_buffer_t* frame_acquire(int sub, uint32_t* missed)
+{
+	frame_t* f;
+	
+	*missed = 0;
+	
+	portENTER_CRITICAL(&frame_mux);
+	f = newest_frame(subs[sub].lepton);
+	if ((f != NULL) && (f->num > subs[sub].last_num)) {
+		*missed = f->num - subs[sub].last_num - 1;
+		subs[sub].last_num = f->num;
+		f->refs++;
+		f->taken = true;
+	} else {
+		f = NULL;
+	}
+	portEXIT_CRITICAL(&frame_mux);
+	
+	return (f != NULL) ? &f->buf : NULL;
+}
+
+
+/**
+ * Acquire a reference to the newest frame from the subscriber's Lepton that the
+ * subscriber has already acquired or skipped (a frame it hasn't seen is left for
+ * frame_acquire()).  Returns NULL if there is no such frame.  The frame must be
+ * released with frame_release() when the subscriber is done.
+ */
+lep_buffer_t* frame_acquire_newest(int sub)
+{
+	frame_t* f;
+	
+	portENTER_CRITICAL(&frame_mux);
+	f = newest_frame(subs[sub].lepton);
+	if ((f != NULL) && (f->num <= subs[sub].last_num)) {
+		f->refs++;
+		f->taken = true;
+	} else {
+		f = NULL;
+	}
+	portEXIT_CRITICAL(&frame_mux);
+	
+	return (f != NULL) ? &f->buf : NULL;
+}
+
+
+/**
+ * Skip all frames published since the subscriber last acquired or skipped frames.
+ * Returns the number of frames skipped.
+ */
+uint32_t frame_skip(int sub)
+{
+	uint32_t n;
+	
+	portENTER_CRITICAL(&frame_mux);
+	n = pub_num[subs[sub].lepton] - subs[sub].last_num;
+	subs[sub].last_num = pub_num[subs[sub].lepton];
+	portEXIT_CRITICAL(&frame_mux);
+	
+	return n;
+}
+
+
+/**
+ * Release a reference to a frame acquired with frame_acquire() or frame_acquire_newest()
+ */
+void frame_release(lep_buffer_t* bufP)
+{
+	frame_t* f = find_frame(bufP);
+	
+	if (f == NULL) return;
+	
+	portENTER_CRITICAL(&frame_mux);
+	if (f->refs > 0) f->refs--;
+	portEXIT_CRITICAL(&frame_mux);
+}
+
+
+
+/**
+ * Get a segment buffer for lep_task to load.  Returns NULL if every buffer is held
+ * (the segment is dropped).
+ */
+lep_segment_t* frame_seg_get_free()
+{
+	int i;
+	frame_seg_t* s = NULL;
+	
+	portENTER_CRITICAL(&frame_mux);
+	for (i=0; i<LEP_SEG_POOL_SIZE; i++) {
+		if (!segs[i].loading && (segs[i].refs == 0)) {
+			s = &segs[i];
+			s->loading = true;
+			break;
+		}
+	}
+	portEXIT_CRITICAL(&frame_mux);
+	
+	return (s != NULL) ? &s->seg : NULL;
+}
+
+
+/**
+ * Queue a segment loaded by lep_task for the segment subscriber and notify it
+ */
+void frame_seg_publish(lep_segment_t* segP)
+{
+	frame_seg_t* s = find_seg(segP);
+	
+	if (s == NULL) return;
+	
+	segP->ready_usec = esp_timer_get_time();
+	
+	portENTER_CRITICAL(&frame_mux);
+	s->loading = false;
+	s->refs = 1;
+	seg_queue[seg_queue_num++] = s;
+	portEXIT_CRITICAL(&frame_mux);
+	
+	if (seg_task != NULL) {
+		xTaskNotify(seg_task, seg_notify_mask, eSetBits);
+	}
+}
+
+
+/**
+ * Returns true when the segment subscriber wants segments
+ */
+bool frame_seg_enabled()
+{
+	return seg_enable;
+}
+
+
+/**
+ * Register the task notified with notify_mask each time a segment is published.  There
+ * is only one segment subscriber.  It should subscribe during task initialization.
+ */
+void frame_seg_subscribe(TaskHandle_t task, uint32_t notify_mask)
+{
+	seg_notify_mask = notify_mask;
+	seg_task = task;
+}
+
+
+/**
+ * Start or stop lep_task publishing segments
+ */
+void frame_seg_enable(bool en)
+{
+	seg_enable = en;
+}
+
+
+/**
+ * Take the oldest published segment, NULL if none.  The subscriber holds a reference
+ * to the segment and must release it with frame_seg_release() when done.
+ */
+lep_segment_t* frame_seg_acquire()
+{
+	int i;
+	frame_seg_t* s = NULL;
+	
+	portENTER_CRITICAL(&frame_mux);
+	if (seg_queue_num != 0) {
+		s = seg_queue[0];
+		for (i=1; i<seg_queue_num; i++) {
+			seg_queue[i-1] = seg_queue[i];
+		}
+		seg_queue_num--;
+	}
+	portEXIT_CRITICAL(&frame_mux);
+	
+	return (s != NULL) ? &s->seg : NULL;
+}
+
+
+/**
+ * Add a reference to an acquired segment (for each additional user of it)
+ */
+void frame_seg_hold(lep_segment_t* segP)
+{
+	frame_seg_t* s = find_seg(segP);
+	
+	if (s == NULL) return;
+	
+	portENTER_CRITICAL(&frame_mux);
+	s->refs++;
+	portEXIT_CRITICAL(&frame_mux);
+}
+
+
+/**
+ * Release a reference to a segment
+ */
+void frame_seg_release(lep_segment_t* segP)
+{
+	frame_seg_t* s = find_seg(segP);
+	
+	if (s == NULL) return;
+	
+	portENTER_CRITICAL(&frame_mux);
+	if (s->refs > 0) s->refs--;
+	portEXIT_CRITICAL(&frame_mux);
+}
+
+
+
+/**
+ * Get a packet batch buffer for lep_task to load.  Returns NULL if every buffer is held
+ * (the packets are dropped).
+ */
+lep_pkt_batch_t* frame_pkt_get_free()
+{
+	int i;
+	frame_pkt_t* p = NULL;
+	
+	portENTER_CRITICAL(&frame_mux);
+	for (i=0; i<LEP_PKT_POOL_SIZE; i++) {
+		if (!pkts[i].loading && (pkts[i].refs == 0)) {
+			p = &pkts[i];
+			p->loading = true;
+			break;
+		}
+	}
+	portEXIT_CRITICAL(&frame_mux);
+	
+	return (p != NULL) ? &p->batch : NULL;
+}
+
+
+/**
+ * Queue a packet batch loaded by lep_task for the batch subscriber and notify it
+ */
+void frame_pkt_publish(lep_pkt_batch_t* batchP)
+{
+	frame_pkt_t* p = find_pkt(batchP);
+	
+	if (p == NULL) return;
+	
+	batchP->ready_usec = esp_timer_get_time();
+	
+	portENTER_CRITICAL(&frame_mux);
+	p->loading = false;
+	p->refs = 1;
+	pkt_queue[pkt_queue_num++] = p;
+	portEXIT_CRITICAL(&frame_mux);
+	
+	if (pkt_task != NULL) {
+		xTaskNotify(pkt_task, pkt_notify_mask, eSetBits);
+	}
+}
+
+
+/**
+ * Returns true when the batch subscriber wants raw packets
+ */
+bool frame_pkt_enabled()
+{
+	return pkt_enable;
+}
+
+
+/**
+ * Register the task notified with notify_mask each time a packet batch is published.
+ * There is only one batch subscriber.  It should subscribe during task initialization.
+ */
+void frame_pkt_subscribe(TaskHandle_t task, uint32_t notify_mask)
+{
+	pkt_notify_mask = notify_mask;
+	pkt_task = task;
+}
+
+
+/**
+ * Start or stop lep_task publishing raw packets
+ */
+void frame_pkt_enable(bool en)
+{
+	pkt_enable = en;
+}
+
+
+/**
+ * Take the oldest published packet batch, NULL if none.  The subscriber holds a
+ * reference to the batch and must release it with frame_pkt_release() when done.
+ */
+lep_pkt_batch_t* frame_pkt_acquire()
+{
+	int i;
+	frame_pkt_t* p = NULL;
+	
+	portENTER_CRITICAL(&frame_mux);
+	if (pkt_queue_num != 0) {
+		p = pkt_queue[0];
+		for (i=1; i<pkt_queue_num; i++) {
+			pkt_queue[i-1] = pkt_queue[i];
+		}
+		pkt_queue_num--;
+	}
+	portEXIT_CRITICAL(&frame_mux);
+	
+	return (p != NULL) ? &p->batch : NULL;
+}
+
+
+/**
+ * Returns true when a published packet batch is waiting to be acquired
+ */
+bool frame_pkt_available()
+{
+	return (pkt_queue_num != 0);
+}
+
+
+/**
+ * Add a reference to an acquired packet batch (for each additional user of it)
+ */
+void frame_pkt_hold(lep_pkt_batch_t* batchP)
+{
+	frame_pkt_t* p = find_pkt(batchP);
+	
+	if (p == NULL) return;
+	
+	portENTER_CRITICAL(&frame_mux);
+	p->refs++;
+	portEXIT_CRITICAL(&frame_mux);
+}
+
+
+/**
+ * Release a reference to a packet batch
+ */
+void frame_pkt_release(lep_pkt_batch_t* batchP)
+{
+	frame_pkt_t* p = find_pkt(batchP);
+	
+	if (p == NULL) return;
+	
+	portENTER_CRITICAL(&frame_mux);
+	if (p->refs > 0) p->refs--;
+	portEXIT_CRITICAL(&frame_mux);
+}
+
+
+
+//
+// Frame Utilities internal functions
+//
+
+/**
+ * Return the pool entry for a buffer, NULL if it isn't one of ours
+ */
+static frame_t* find_frame(lep_buffer_t* bufP)
+{
+	int i;
+	
+	for (i=0; i<LEP_FRAME_POOL_SIZE; i++) {
+		if (&frames[i].buf == bufP) return &frames[i];
+	}
+	
+	return NULL;
+}
+
+
+/**
+ * Return the pool entry for a segment, NULL if it isn't one of ours
+ */
+static frame_seg_t* find_seg(lep_segment_t* segP)
+{
+	int i;
+	
+	for (i=0; i<LEP_SEG_POOL_SIZE; i++) {
+		if (&segs[i].seg == segP) return &segs[i];
+	}
+	
+	return NULL;
+}
+
+
+/**
+ * Return the pool entry for a packet batch, NULL if it isn't one of ours
+ */
+static frame_pkt_t* find_pkt(lep_pkt_batch_t* batchP)
+{
+	int i;
+	
+	for (i=0; i<LEP_PKT_POOL_SIZE; i++) {
+		if (&pkts[i].batch == batchP) return &pkts[i];
+	}
+	
+	return NULL;
+}
+
+
+/**
+ * Return the most recently published frame from a Lepton, NULL if none (call with
+ * frame_mux held)
+ */
+static frame_t* newest_frame(int lepton)
+{
+	int i;
+	frame_t* f = NULL;
+	
+	for (i=0; i<LEP_FRAME_POOL_SIZE; i++) {
+		if ((frames[i].seq != 0) && (frames[i].buf.lepton == lepton) &&
+		    ((f == NULL) || (frames[i].seq > f->seq))) {
+			f = &frames[i];
+		}
+	}
+	
+	return f;
+}
+
+
+/**
+ * Returns true if f is the most recently published frame from its Lepton (call with
+ * frame_mux held)
+ */
+static bool is_newest(frame_t* f)
+{
+	return (f->seq != 0) && (f == newest_frame(f->buf.lepton));
+}
+
+
+/**
+ * Returns true if f is a better buffer for lep_task to load than cur (which may be NULL)
+ */
+static bool better_frame(frame_t* f, frame_t* cur)
+{
+	if (cur == NULL) return true;
+	
+	if (f->internal != cur->internal) return f->internal;
+	if ((f->seq == 0) != (cur->seq == 0)) return (f->seq == 0);
+	return (f->seq < cur->seq);
+}
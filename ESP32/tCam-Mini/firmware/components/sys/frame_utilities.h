@@ -0,0 +1,120 @@
+/*
+ * Lepton frame buffer broker
+ *
+ * Manages the pool of shared lepton frame buffers.  lep_task loads a free buffer and
+ * publishes it once as the newest frame.  Any number of subscriber tasks (up to
+ * FRAME_MAX_SUBSCRIBERS) are notified of each new frame and may acquire read-only
+ * access to it until they release it.  A published frame is recycled for loading
+ * when no subscriber holds a reference to it, oldest first.  With a second Lepton each
+ * frame is tagged with the Lepton it came from and subscribers get the newest frame
+ * from the Lepton they subscribed to.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef FRAME_UTILITIES_H
+#define FRAME_UTILITIES_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sys_utilities.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+
+
+//
+// Frame Utilities constants
+//
+
+// Maximum number of tasks that can subscribe to frames (rsp_task subscribes to each
+// Lepton)
+#define FRAME_MAX_SUBSCRIBERS (5 + LEP_NUM_LEPTONS - 1)
+
+
+
+//
+// Frame Utilities typedefs
+//
+
+// A segment of a frame copied for low latency streams.  lep_bufferP holds the segment's
+// pixels.  The image range and telemetry are only valid in the last segment of a frame.
+typedef struct {
+	lep_buffer_t buf;
+	uint32_t frame_num;          // Frame the segment is part of
+	uint8_t seg;                 // Segment (1-4)
+	uint16_t start;              // First pixel of the segment in the frame
+	uint16_t len;                // Number of pixels
+	int64_t ready_usec;          // When the segment was published
+} lep_segment_t;
+
+// A batch of raw VoSPI packets for passthrough streams, exactly as read from the Lepton
+// (discard packets are left out)
+typedef struct {
+	uint8_t* pktP;               // num_pkts packets of LEP_PKT_LENGTH bytes
+	uint32_t pkt_num;            // Number of the first packet (counts every packet, so
+	                             // packets dropped before the batch show as a gap)
+	uint8_t lepton;              // Lepton the packets were read from
+	uint8_t num_pkts;
+	int64_t read_usec;           // When the first packet was read
+	int64_t ready_usec;          // When the batch was published
+} lep_pkt_batch_t;
+
+
+
+//
+// Frame Utilities API
+//
+bool frame_init();
+
+// Producer (lep_task)
+lep_buffer_t* frame_get_free();
+lep_buffer_t* frame_try_get_free();
+void frame_publish(lep_buffer_t* bufP);
+
+// Subscribers
+int frame_subscribe(TaskHandle_t task, uint32_t notify_mask);
+int frame_subscribe_lepton(TaskHandle_t task, uint32_t notify_mask, int lepton);
+lep_buffer_t* frame_acquire(int sub, uint32_t* missed);
+lep_buffer_t* frame_acquire_newest(int sub);
+uint32_t frame_skip(int sub);
+void frame_release(lep_buffer_t* bufP);
+
+// Segments for low latency streams (produced by lep_task while enabled by the subscriber)
+lep_segment_t* frame_seg_get_free();
+void frame_seg_publish(lep_segment_t* segP);
+bool frame_seg_enabled();
+void frame_seg_subscribe(TaskHandle_t task, uint32_t notify_mask);
+void frame_seg_enable(bool en);
+lep_segment_t* frame_seg_acquire();
+void frame_seg_hold(lep_segment_t* segP);
+void frame_seg_release(lep_segment_t* segP);
+
+// Raw packet batches for passthrough streams (produced by lep_task while enabled by the
+// subscriber)
+lep_pkt_batch_t* frame_pkt_get_free();
+void frame_pkt_publish(lep_pkt_batch_t* batchP);
+bool frame_pkt_enabled();
+void frame_pkt_subscribe(TaskHandle_t task, uint32_t notify_mask);
+void frame_pkt_enable(bool en);
+lep_pkt_batch_t* frame_pkt_acquire();
+bool frame_pkt_available();
+void frame_pkt_hold(lep_pkt_batch_t* batchP);
+void frame_pkt_release(lep_pkt_batch_t* batchP);
+
+#endif /* FRAME_UTILITIES_H */
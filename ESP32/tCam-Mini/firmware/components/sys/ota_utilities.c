@@ -0,0 +1,282 @@
+/*
+ * Network firmware update
+ *
+ * Writes a firmware image into the inactive app partition a sector at a time.  The
+ * partition is erased as it is written, instead of all at once by esp_ota_begin(),
+ * so no flash operation stalls the other tasks for longer than one sector erase.
+ * esp_ota_set_boot_partition() verifies the complete image before selecting it.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "ota_utilities.h"
+#include "sys_utilities.h"
+#include "system_config.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#include "esp_image_format.h"
+#include <string.h>
+
+
+
+//
+// OTA Utilities variables
+//
+static const char* TAG = "ota_utilities";
+
+// Partition being updated (NULL if the partition table has no second app partition)
+static const esp_partition_t* ota_part;
+
+static ota_info_t ota_info;
+
+// Sector being received
+static uint8_t* ota_buf;
+static uint32_t ota_buf_len;
+
+// Earliest time the next sector may be written
+static int64_t ota_next_usec;
+
+
+
+//
+// OTA Utilities Forward Declarations for internal functions
+//
+static bool write_sector();
+static void finish_update();
+
+
+
+//
+// OTA Utilities API
+//
+
+/**
+ * Find the partition updates are written to and allocate the receive buffer.  The
+ * camera runs without network updates if there is no second app partition.
+ */
+bool ota_init()
+{
+	memset(&ota_info, 0, sizeof(ota_info_t));
+	ota_info.state = OTA_STATE_IDLE;
+
+	ota_part = esp_ota_get_next_update_partition(NULL);
+	if (ota_part == NULL) {
+		ESP_LOGE(TAG, "No OTA partition - network updates disabled");
+		return true;
+	}
+	ota_info.max_size = ota_part->size;
+
+	ota_buf = system_buffer_alloc("ota", 0, OTA_BUF_LEN, SYS_BUF_SPIRAM);
+	if (ota_buf == NULL) {
+		ESP_LOGE(TAG, "Could not allocate ota buffer");
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * Largest image that can be received (0 if updates are disabled)
+ */
+uint32_t ota_get_max_size()
+{
+	return ota_info.max_size;
+}
+
+
+/**
+ * Start receiving an image of size bytes, replacing a previous update that hasn't
+ * been booted.  Returns false if an update is already being received.
+ */
+bool ota_start(uint32_t size)
+{
+	if ((ota_part == NULL) || (size == 0) || (size > ota_info.max_size) ||
+	    (ota_info.state == OTA_STATE_RECEIVING)) {
+		return false;
+	}
+
+	// The partition is about to be overwritten so a previous update can't be booted
+	if (ota_info.state == OTA_STATE_READY) {
+		(void) esp_ota_set_boot_partition(esp_ota_get_running_partition());
+	}
+
+	ESP_LOGI(TAG, "Receiving %d byte image for %s", size, ota_part->label);
+	ota_info.state = OTA_STATE_RECEIVING;
+	ota_info.err = OTA_ERR_NONE;
+	ota_info.size = size;
+	ota_info.received = 0;
+	ota_info.written = 0;
+	ota_info.version[0] = 0;
+	ota_buf_len = 0;
+	ota_next_usec = 0;
+
+	return true;
+}
+
+
+/**
+ * Where to receive the next part of the image.  Returns how many bytes may be received
+ * (0 while the sector buffer waits to be written).
+ */
+uint32_t ota_get_rx_space(uint8_t** buf)
+{
+	uint32_t n;
+
+	if (ota_info.state != OTA_STATE_RECEIVING) return 0;
+
+	n = OTA_BUF_LEN - ota_buf_len;
+	if (n > (ota_info.size - ota_info.received)) {
+		n = ota_info.size - ota_info.received;
+	}
+	if (buf != NULL) {
+		*buf = ota_buf + ota_buf_len;
+	}
+
+	return n;
+}
+
+
+/**
+ * Note len bytes were received at the location from ota_get_rx_space()
+ */
+void ota_rx_done(uint32_t len)
+{
+	ota_buf_len += len;
+	ota_info.received += len;
+}
+
+
+/**
+ * Write the sector buffer once it is full (or holds the end of the image) and it is
+ * time for the next sector.  Returns true when the update has just finished (check
+ * ota_get_info).
+ */
+bool ota_service()
+{
+	if (ota_info.state != OTA_STATE_RECEIVING) return false;
+	if ((ota_buf_len < OTA_BUF_LEN) && (ota_info.received < ota_info.size)) return false;
+	if (esp_timer_get_time() < ota_next_usec) return false;
+
+	if (!write_sector()) {
+		ota_info.state = OTA_STATE_FAILED;
+		return true;
+	}
+	ota_next_usec = esp_timer_get_time() + OTA_SECTOR_MSEC * 1000;
+
+	if (ota_info.written == ota_info.size) {
+		finish_update();
+		return true;
+	}
+
+	return false;
+}
+
+
+/**
+ * Stop receiving an image (its connection closed)
+ */
+void ota_abort()
+{
+	if (ota_info.state == OTA_STATE_RECEIVING) {
+		ESP_LOGE(TAG, "Update aborted after %d bytes", ota_info.received);
+		ota_info.state = OTA_STATE_FAILED;
+		ota_info.err = OTA_ERR_ABORTED;
+	}
+}
+
+
+bool ota_in_progress()
+{
+	return (ota_info.state == OTA_STATE_RECEIVING);
+}
+
+
+/**
+ * True when an update is ready to run the next time the camera restarts
+ */
+bool ota_ready()
+{
+	return (ota_info.state == OTA_STATE_READY);
+}
+
+
+void ota_get_info(ota_info_t* info)
+{
+	*info = ota_info;
+}
+
+
+
+//
+// OTA Utilities internal functions
+//
+
+/**
+ * Erase the next sector of the partition and write the sector buffer into it.  The
+ * first sector must start like an app image.
+ */
+static bool write_sector()
+{
+	if ((ota_info.written == 0) && (ota_buf[0] != ESP_IMAGE_HEADER_MAGIC)) {
+		ESP_LOGE(TAG, "Not an app image");
+		ota_info.err = OTA_ERR_IMAGE;
+		return false;
+	}
+
+	if (esp_partition_erase_range(ota_part, ota_info.written, OTA_BUF_LEN) != ESP_OK) {
+		ESP_LOGE(TAG, "Erase at %d failed", ota_info.written);
+		ota_info.err = OTA_ERR_FLASH;
+		return false;
+	}
+	if (esp_partition_write(ota_part, ota_info.written, ota_buf, ota_buf_len) != ESP_OK) {
+		ESP_LOGE(TAG, "Write at %d failed", ota_info.written);
+		ota_info.err = OTA_ERR_FLASH;
+		return false;
+	}
+
+	ota_info.written += ota_buf_len;
+	ota_buf_len = 0;
+	return true;
+}
+
+
+/**
+ * Verify the complete image and select it to boot
+ */
+static void finish_update()
+{
+	esp_app_desc_t desc;
+
+	if (esp_ota_set_boot_partition(ota_part) != ESP_OK) {
+		ESP_LOGE(TAG, "Image verification failed");
+		ota_info.state = OTA_STATE_FAILED;
+		ota_info.err = OTA_ERR_IMAGE;
+		return;
+	}
+
+	if (esp_ota_get_partition_description(ota_part, &desc) == ESP_OK) {
+		strncpy(ota_info.version, desc.version, OTA_MAX_VERSION_LEN - 1);
+		ota_info.version[OTA_MAX_VERSION_LEN - 1] = 0;
+	}
+	ESP_LOGI(TAG, "Update %s ready in %s", ota_info.version, ota_part->label);
+	ota_info.state = OTA_STATE_READY;
+}
@@ -0,0 +1,93 @@
+/*
+ * Network firmware update
+ *
+ * Writes a firmware image received over the network into the inactive app partition
+ * while the camera keeps running.  The image is received into a sector buffer that is
+ * erased and written to the flash at most every OTA_SECTOR_MSEC so the flash operations,
+ * which stall the other tasks, only briefly interrupt image capture.  The receiver stops
+ * reading from its connection while the buffer waits to be written (TCP flow control
+ * paces the sender).  A complete image is verified and selected to boot the next time
+ * the camera restarts, which is left to the client.
+ *
+ * Only called by cmd_task.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef OTA_UTILITIES_H
+#define OTA_UTILITIES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+
+//
+// OTA Utilities constants
+//
+
+// Receive buffer (one flash sector)
+#define OTA_BUF_LEN          4096
+
+// States
+#define OTA_STATE_IDLE       0
+#define OTA_STATE_RECEIVING  1
+#define OTA_STATE_READY      2     // Verified and selected to boot
+#define OTA_STATE_FAILED     3
+
+// Errors
+#define OTA_ERR_NONE         0
+#define OTA_ERR_ABORTED      1     // The connection closed before the image was received
+#define OTA_ERR_FLASH        2     // Flash erase or write failed
+#define OTA_ERR_IMAGE        3     // Not a valid app image
+
+// Maximum version string length
+#define OTA_MAX_VERSION_LEN  32
+
+
+
+//
+// OTA Utilities typedefs
+//
+typedef struct {
+	int state;
+	int err;                            // OTA_ERR_xxx when state is OTA_STATE_FAILED
+	uint32_t size;                      // Image size
+	uint32_t received;                  // Bytes received
+	uint32_t written;                   // Bytes written to the flash
+	uint32_t max_size;                  // Size of the inactive app partition (0 if none)
+	char version[OTA_MAX_VERSION_LEN];  // Version of the image once it is verified
+} ota_info_t;
+
+
+
+//
+// OTA Utilities API
+//
+bool ota_init();
+uint32_t ota_get_max_size();
+bool ota_start(uint32_t size);
+uint32_t ota_get_rx_space(uint8_t** buf);
+void ota_rx_done(uint32_t len);
+bool ota_service();
+void ota_abort();
+bool ota_in_progress();
+bool ota_ready();
+void ota_get_info(ota_info_t* info);
+
+#endif /* OTA_UTILITIES_H */
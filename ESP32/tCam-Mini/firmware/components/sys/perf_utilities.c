@@ -0,0 +1,113 @@
+/*
+ * Performance statistics
+ *
+ * Contains always-on, low overhead timing histograms and event counters for the
+ * image pipeline stages.  Each stage is only recorded by one task but the statistics
+ * are read by another so updates are protected by a spinlock.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "perf_utilities.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+
+
+//
+// Performance Utilities variables
+//
+static portMUX_TYPE perf_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static perf_stage_t perf_stages[PERF_NUM_STAGES];
+static uint32_t perf_counters[PERF_NUM_COUNTERS];
+
+
+
+//
+// Performance Utilities API
+//
+
+/**
+ * Record the time from start_usec (taken with esp_timer_get_time()) until now for
+ * a stage
+ */
+void perf_record(int stage, int64_t start_usec)
+{
+	int n = 0;
+	uint32_t t;
+	uint32_t limit = PERF_HIST_MIN_USEC;
+	perf_stage_t* s = &perf_stages[stage];
+
+	t = (uint32_t) (esp_timer_get_time() - start_usec);
+	while ((t >= limit) && (n < (PERF_HIST_BUCKETS-1))) {
+		limit <<= 2;
+		n++;
+	}
+
+	portENTER_CRITICAL(&perf_mux);
+	if ((s->count == 0) || (t < s->min_usec)) s->min_usec = t;
+	if (t > s->max_usec) s->max_usec = t;
+	s->count++;
+	s->total_usec += t;
+	s->hist[n]++;
+	portEXIT_CRITICAL(&perf_mux);
+}
+
+
+/**
+ * Increment an event counter
+ */
+void perf_count(int counter)
+{
+	portENTER_CRITICAL(&perf_mux);
+	perf_counters[counter]++;
+	portEXIT_CRITICAL(&perf_mux);
+}
+
+
+/**
+ * Add n to an event counter
+ */
+void perf_add(int counter, uint32_t n)
+{
+	portENTER_CRITICAL(&perf_mux);
+	perf_counters[counter] += n;
+	portEXIT_CRITICAL(&perf_mux);
+}
+
+
+/**
+ * Get a consistent copy of a stage's statistics
+ */
+void perf_get_stage(int stage, perf_stage_t* s)
+{
+	portENTER_CRITICAL(&perf_mux);
+	*s = perf_stages[stage];
+	portEXIT_CRITICAL(&perf_mux);
+}
+
+
+/**
+ * Get an event counter
+ */
+uint32_t perf_get_counter(int counter)
+{
+	return perf_counters[counter];
+}
@@ -0,0 +1,104 @@
+/*
+ * Performance statistics
+ *
+ * Contains always-on, low overhead timing histograms and event counters for the
+ * image pipeline stages so frame loss and latency can be measured in the field
+ * using the get_perf_stats command.  Stage times are recorded in microseconds into
+ * PERF_HIST_BUCKETS buckets with bucket n containing times less than
+ * PERF_HIST_MIN_USEC << (2 * n) (the last bucket contains everything longer).
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef PERF_UTILITIES_H
+#define PERF_UTILITIES_H
+
+#include <stdint.h>
+
+
+
+//
+// Performance Utilities constants
+//
+
+// Timed stages
+#define PERF_STAGE_SEGMENT     0     // vsync to a complete VoSPI segment
+#define PERF_STAGE_FRAME_COPY  1     // Copy of a frame to a client's delta reference
+#define PERF_STAGE_JSON_ENC    2     // Json image encode
+#define PERF_STAGE_RICE_ENC    3     // Compressed image encode
+#define PERF_STAGE_SEND        4     // Image queued to last byte taken by the socket
+#define PERF_STAGE_RECOVER     5     // Last good frame to first good frame after a VoSPI recovery
+#define PERF_STAGE_REC_WRITE   6     // Flash erase and write of a recorded frame
+#define PERF_STAGE_SEG_SEND    7     // Segment published to last byte taken by the socket
+#define PERF_STAGE_PNG_ENC     8     // Palette mapped PNG image encode
+#define PERF_STAGE_JPEG_ENC    9     // Palette mapped JPEG image encode
+#define PERF_STAGE_CMD_RSP     10    // Command response pushed to last byte taken by the socket
+#define PERF_NUM_STAGES        11
+
+// Event counters
+#define PERF_CNT_SEG_RETRY     0     // Segment reads that did not complete a valid segment
+#define PERF_CNT_FRAMES        1     // Frames acquired by lep_task
+#define PERF_CNT_FRAME_RECLAIM 2     // Frames recycled by lep_task before any subscriber took them
+#define PERF_CNT_FRAME_DROP    3     // Frames discarded because no client had an image pending
+#define PERF_CNT_FRAME_SKIP    4     // Frames replaced by a newer frame before dispatch
+#define PERF_CNT_SEND_FAIL     5     // Images lost to a socket error
+#define PERF_CNT_CRC_FAIL_SEG1 6     // VoSPI packet CRC failures while reading segment 1
+#define PERF_CNT_CRC_FAIL_SEG2 7     //   2
+#define PERF_CNT_CRC_FAIL_SEG3 8     //   3
+#define PERF_CNT_CRC_FAIL_SEG4 9     //   4
+#define PERF_CNT_REALIGN       10    // Recoveries by re-aligning with the segment phase
+#define PERF_CNT_RESYNC        11    // Recoveries by a CS de-asserted resynchronization
+#define PERF_CNT_LEP_RESET     12    // Recoveries by a Lepton hardware reset
+#define PERF_CNT_SEG_DROP      13    // Segments not sent to a low latency stream
+#define PERF_CNT_FRAME_LOST    14    // Lepton frames never read (capture sequence gaps)
+#define PERF_CNT_IMAGES_ENC    15    // Images encoded for clients
+#define PERF_CNT_IMAGES_SENT   16    // Images completely taken by the network stack
+#define PERF_CNT_RSP_DROP      17    // Command responses dropped because the response buffer was full
+#define PERF_CNT_PKT_DROP      18    // Raw packets not sent to a passthrough stream
+#define PERF_CNT_FRAME_HELD    19    // Frames dropped by lep_task because subscribers held every other buffer
+#define PERF_NUM_COUNTERS      20
+
+// Histogram (buckets: <64, <256, <1024 uSec ... >= 262144 uSec)
+#define PERF_HIST_BUCKETS      8
+#define PERF_HIST_MIN_USEC     64
+
+
+
+//
+// Performance Utilities typedefs
+//
+typedef struct {
+	uint32_t count;
+	uint64_t total_usec;
+	uint32_t min_usec;
+	uint32_t max_usec;
+	uint32_t hist[PERF_HIST_BUCKETS];
+} perf_stage_t;
+
+
+
+//
+// Performance Utilities API
+//
+void perf_record(int stage, int64_t start_usec);
+void perf_count(int counter);
+void perf_add(int counter, uint32_t n);
+void perf_get_stage(int stage, perf_stage_t* s);
+uint32_t perf_get_counter(int counter);
+
+#endif /* PERF_UTILITIES_H */
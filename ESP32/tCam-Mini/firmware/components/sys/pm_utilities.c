@@ -0,0 +1,123 @@
+/*
+ * Power management
+ *
+ * Dynamic CPU frequency scaling using ESP-IDF power management locks.  Holding and
+ * releasing are idempotent so a task may release before every wait and hold after
+ * every wake without tracking its own state.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "pm_utilities.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#ifdef CONFIG_TCAM_PM_DFS
+#include "esp_pm.h"
+#endif
+
+
+//
+// Power Management Utilities variables
+//
+static const char* TAG = "pm_utilities";
+
+#ifdef CONFIG_TCAM_PM_DFS
+static const char* lock_names[PM_NUM_LOCKS] = {"lep", "rsp", "enc"};
+
+static esp_pm_lock_handle_t cpu_lock[PM_NUM_LOCKS];
+static esp_pm_lock_handle_t apb_lock;
+#endif
+
+static bool pm_enabled = false;
+static bool lock_held[PM_NUM_LOCKS];
+
+
+
+//
+// Power Management Utilities API
+//
+
+/**
+ * Configure frequency scaling and create the locks.  Must be called before the tasks
+ * that use them start.  Failing leaves the CPUs at their configured frequency.
+ */
+bool pm_init()
+{
+#ifdef CONFIG_TCAM_PM_DFS
+	int i;
+	esp_pm_config_esp32_t pm_config = {
+		.max_freq_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+		.min_freq_mhz = PM_MIN_CPU_MHZ,
+		.light_sleep_enable = false
+	};
+	
+	for (i=0; i<PM_NUM_LOCKS; i++) {
+		if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, lock_names[i], &cpu_lock[i]) != ESP_OK) {
+			ESP_LOGE(TAG, "Could not create %s lock", lock_names[i]);
+			return false;
+		}
+	}
+	if (esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "lep_spi", &apb_lock) != ESP_OK) {
+		ESP_LOGE(TAG, "Could not create SPI lock");
+		return false;
+	}
+	
+	if (esp_pm_configure(&pm_config) != ESP_OK) {
+		ESP_LOGE(TAG, "Could not configure frequency scaling");
+		return false;
+	}
+	
+	pm_enabled = true;
+	ESP_LOGI(TAG, "CPU frequency %d - %d MHz", PM_MIN_CPU_MHZ, CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ);
+#endif
+	return true;
+}
+
+
+/**
+ * Run the CPUs at full speed until the owner releases its lock
+ */
+void pm_hold(int owner)
+{
+	if (!pm_enabled || lock_held[owner]) return;
+	
+#ifdef CONFIG_TCAM_PM_DFS
+	if (owner == PM_LOCK_LEP) {
+		(void) esp_pm_lock_acquire(apb_lock);
+	}
+	(void) esp_pm_lock_acquire(cpu_lock[owner]);
+#endif
+	lock_held[owner] = true;
+}
+
+
+/**
+ * Let the CPUs drop to the idle frequency if no other owner holds its lock
+ */
+void pm_release(int owner)
+{
+	if (!pm_enabled || !lock_held[owner]) return;
+	
+#ifdef CONFIG_TCAM_PM_DFS
+	(void) esp_pm_lock_release(cpu_lock[owner]);
+	if (owner == PM_LOCK_LEP) {
+		(void) esp_pm_lock_release(apb_lock);
+	}
+#endif
+	lock_held[owner] = false;
+}
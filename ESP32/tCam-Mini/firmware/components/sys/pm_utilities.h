@@ -0,0 +1,60 @@
+/*
+ * Power management
+ *
+ * Dynamic CPU frequency scaling (CONFIG_TCAM_PM_DFS).  The CPUs run at the configured
+ * CPU frequency only while a task holds its lock: lep_task while it reads and publishes
+ * a VoSPI segment, rsp_task while it encodes and sends and enc_task while it encodes its
+ * half of an image.  Otherwise both cores drop to PM_MIN_CPU_MHZ.  The APB clock stays
+ * at 80 MHz at that frequency so the SPI clock, the vsync ISR and esp_timer are
+ * unaffected.  Light sleep isn't used: a vsync arrives every segment period and the
+ * Lepton's SPI interface must be serviced soon after it, leaving no idle time worth
+ * sleeping through.  Without CONFIG_TCAM_PM_DFS the locks do nothing.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef PM_UTILITIES_H
+#define PM_UTILITIES_H
+
+#include <stdbool.h>
+
+
+
+//
+// Power Management Utilities constants
+//
+
+// Idle CPU frequency (the lowest that keeps the APB clock at 80 MHz)
+#define PM_MIN_CPU_MHZ   80
+
+// Lock owners (each is only used by one task)
+#define PM_LOCK_LEP      0     // lep_task segment reads (also holds the APB frequency for SPI)
+#define PM_LOCK_RSP      1     // rsp_task encodes and sends
+#define PM_LOCK_ENC      2     // enc_task encodes
+#define PM_NUM_LOCKS     3
+
+
+
+//
+// Power Management Utilities API
+//
+bool pm_init();
+void pm_hold(int owner);
+void pm_release(int owner);
+
+#endif /* PM_UTILITIES_H */
@@ -4,7 +4,8 @@
  * Manage the persistent storage kept in the ESP32 NVS and provide access
  * routines to it.
  *
- * NOTE: It is assumed that only one task will access persistent storage at a time.
+ * NOTE: It is assumed that only one task will set persistent storage at a time.
+ *       ps_update() may be called from another task.
  *
  * Copyright 2020 Dan Julio
  *
@@ -27,6 +28,8 @@
 #include "ps_utilities.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include "system_config.h"
@@ -44,6 +47,10 @@
 // Lepton state boolean flags
 #define PS_LEP_AGC_EN_MASK     0x01
 
+// Temporal filter level stored in the Lepton state flags
+#define PS_LEP_TF_MASK         0x0E
+#define PS_LEP_TF_SHIFT        1
+
 // Stored Wifi Flags bitmask
 #define PS_WIFI_FLAG_MASK      (WIFI_INFO_FLAG_STARTUP_ENABLE | WIFI_INFO_FLAG_CL_STATIC_IP | WIFI_INFO_FLAG_CLIENT_MODE)
 
@@ -63,15 +70,24 @@
 //
 
 // Stored Lepton parameters
-typedef struct ps_lep_state_t {
+typedef struct __attribute__((packed)) ps_lep_state_t {
 	uint8_t flags;
 	uint8_t emissivity;
 	uint8_t gain_mode;
 } ps_lep_state_t;
 
 
+// Stored Lepton parameter record.  Written alternately to the key for the low bit of
+// version so the previous record survives a failed write.  check covers the other bytes.
+typedef struct __attribute__((packed)) ps_lep_rec_t {
+	uint16_t version;
+	ps_lep_state_t state;
+	uint8_t check;
+} ps_lep_rec_t;
+
+
 // Stored Wifi Parameters (strings are null-terminated)
-typedef struct ps_wifi_info_t {
+typedef struct __attribute__((packed)) ps_wifi_info_t {
 	char ap_ssid[PS_SSID_MAX_LEN+1];
 	char sta_ssid[PS_SSID_MAX_LEN+1];
 	char ap_pw[PS_PW_MAX_LEN+1];
@@ -89,14 +105,26 @@ typedef struct ps_wifi_info_t {
 //
 static const char* TAG = "ps_utilities";
 
-// NVS Keys
+// NVS Keys (lep_info_key holds the Lepton parameters from before they were versioned)
 static const char* lep_info_key = "lep_state";
+static const char* lep_rec_key[2] = {"lep_rec0", "lep_rec1"};
 static const char* wifi_info_key = "wifi_info";
+static const char* lep_spi_key[2] = {"lep_spi0", "lep_spi1"};
 
 // Local copies
 static ps_lep_state_t ps_lep_state;
 static ps_wifi_info_t ps_wifi_info;
 
+// Calibrated SPI clock of each Lepton (0 when it hasn't been calibrated)
+static uint32_t ps_spi_hz[LEP_NUM_LEPTONS];
+
+// Lepton state cache - version of the last record in NVS and when the local copy was
+// changed if it hasn't been committed yet
+static uint16_t ps_lep_version;
+static bool ps_lep_dirty = false;
+static int64_t ps_lep_change_usec;
+static portMUX_TYPE ps_lep_mux = portMUX_INITIALIZER_UNLOCKED;
+
 // NVS namespace handle
 static nvs_handle_t ps_handle;
 
@@ -107,10 +135,13 @@ static nvs_handle_t ps_handle;
 //
 static void ps_default_lep_info();
 static void ps_default_wifi_info();
-static bool ps_write_lep_info();
-static bool ps_read_lep_info();
+static bool ps_write_lep_info(const ps_lep_state_t* state);
+static bool ps_load_lep_info();
+static bool ps_read_lep_rec(int slot, ps_lep_rec_t* rec);
+static bool ps_read_legacy_lep_info();
+static uint8_t ps_lep_rec_check(const ps_lep_rec_t* rec);
 static bool ps_write_wifi_info();
-static bool ps_read_wifi_info();
+static void ps_load_spi_freq();
 static void ps_store_string(char* dst, char* src, uint8_t max_len);
 static char ps_nibble_to_ascii(uint8_t n);
 
@@ -164,38 +195,34 @@ bool ps_init()
 	
 	//
 	// Initialize our local copies
-	//   - Attempt to find the entry in NVS storage and initialize our local copy from that
+	//   - Attempt to read each entry from NVS storage directly into our local copy
 	//   - Initialize our local copy with default values and use those to initialize NVS
 	//     storage if it does not exist or is invalid.
 	//
 	
 	// Lepton Info
-	err = nvs_get_blob(ps_handle, lep_info_key, NULL, &required_size);
-	if ((err != ESP_OK) && (err != ESP_ERR_NVS_NOT_FOUND)) {
-		ESP_LOGE(TAG, "NVS get_blob lep size failed with err %d", err);
-		return false;
-	}
-	if ((required_size == 0) || (required_size != sizeof(ps_lep_state_t))) {
-		if (required_size == 0) {
-			ESP_LOGI(TAG, "Initializing NVS lep info");
+	if (ps_load_lep_info()) {
+		ESP_LOGI(TAG, "Read NVS lep info version %d", ps_lep_version);
+	} else {
+		ps_lep_version = 0;
+		if (ps_read_legacy_lep_info()) {
+			// Convert to a versioned record (committed along with the new record)
+			ESP_LOGI(TAG, "Converting NVS lep info");
+			(void) nvs_erase_key(ps_handle, lep_info_key);
 		} else {
-			ESP_LOGI(TAG, "Re-initializing NVS lep info");
+			ESP_LOGI(TAG, "Initializing NVS lep info");
+			ps_default_lep_info();
 		}
-		ps_default_lep_info();
-		success &= ps_write_lep_info();
-	} else {
-		ESP_LOGI(TAG, "Reading NVS lep info");
-		success &= ps_read_lep_info();
+		success &= ps_write_lep_info(&ps_lep_state);
 	}
 	
 	// Wifi Info
-	err = nvs_get_blob(ps_handle, wifi_info_key, NULL, &required_size);
-	if ((err != ESP_OK) && (err != ESP_ERR_NVS_NOT_FOUND)) {
-		ESP_LOGE(TAG, "NVS get_blob wifi size failed with err %d", err);
-		return false;
-	}
-	if ((required_size == 0) || (required_size != sizeof(ps_wifi_info_t))) {
-		if (required_size == 0) {
+	required_size = sizeof(ps_wifi_info_t);
+	err = nvs_get_blob(ps_handle, wifi_info_key, &ps_wifi_info, &required_size);
+	if ((err == ESP_OK) && (required_size == sizeof(ps_wifi_info_t))) {
+		ESP_LOGI(TAG, "Read NVS wifi info");
+	} else if ((err == ESP_OK) || (err == ESP_ERR_NVS_NOT_FOUND) || (err == ESP_ERR_NVS_INVALID_LENGTH)) {
+		if (err == ESP_ERR_NVS_NOT_FOUND) {
 			ESP_LOGI(TAG, "Initializing NVS wifi info");
 		} else {
 			ESP_LOGI(TAG, "Re-initializing NVS wifi info");
@@ -203,9 +230,12 @@ bool ps_init()
 		ps_default_wifi_info();
 		success &= ps_write_wifi_info();
 	} else {
-		ESP_LOGI(TAG, "Reading NVS wifi info");
-		success &= ps_read_wifi_info();
+		ESP_LOGE(TAG, "NVS get_blob wifi failed with err %d", err);
+		return false;
 	}
+	
+	// Calibrated SPI clocks (left uncalibrated if missing)
+	ps_load_spi_freq();
 		
 	return success;
 }
@@ -213,22 +243,41 @@ bool ps_init()
 
 void ps_get_lep_state(json_config_t* state)
 {
+	ps_lep_state_t st;
+	
 	// Get from our local copy
-	state->agc_set_enabled = (ps_lep_state.flags & PS_LEP_AGC_EN_MASK) != 0;	
-	state->emissivity = (int) ps_lep_state.emissivity;
-	state->gain_mode = (int) ps_lep_state.gain_mode;
+	portENTER_CRITICAL(&ps_lep_mux);
+	st = ps_lep_state;
+	portEXIT_CRITICAL(&ps_lep_mux);
+	
+	state->agc_set_enabled = (st.flags & PS_LEP_AGC_EN_MASK) != 0;	
+	state->emissivity = (int) st.emissivity;
+	state->gain_mode = (int) st.gain_mode;
+	state->temporal_filter = (st.flags & PS_LEP_TF_MASK) >> PS_LEP_TF_SHIFT;
 }
 
 
+/**
+ * Update our local copy.  A change is committed to NVS by ps_update() once the state
+ * has stopped changing.
+ */
 void ps_set_lep_state(const json_config_t* state)
 {
-	ps_lep_state.flags = (state->agc_set_enabled ? PS_LEP_AGC_EN_MASK : 0);	             
-	ps_lep_state.emissivity = (uint8_t) state->emissivity;
-	ps_lep_state.gain_mode = (uint8_t) state->gain_mode;
-	
-	if (!ps_write_lep_info()) {
-		ESP_LOGE(TAG, "Failed to save lep data to NVS Storage");
+	ps_lep_state_t st;
+	int64_t t = esp_timer_get_time();
+	
+	st.flags = (state->agc_set_enabled ? PS_LEP_AGC_EN_MASK : 0);	             
+	st.flags |= (state->temporal_filter << PS_LEP_TF_SHIFT) & PS_LEP_TF_MASK;
+	st.emissivity = (uint8_t) state->emissivity;
+	st.gain_mode = (uint8_t) state->gain_mode;
+	
+	portENTER_CRITICAL(&ps_lep_mux);
+	if (memcmp(&st, &ps_lep_state, sizeof(ps_lep_state_t)) != 0) {
+		ps_lep_state = st;
+		ps_lep_dirty = true;
+		ps_lep_change_usec = t;
 	}
+	portEXIT_CRITICAL(&ps_lep_mux);
 }
 
 
@@ -288,6 +337,72 @@ bool ps_reinit_wifi()
 }
 
 
+/**
+ * Commit the Lepton state to NVS if it has changed and not changed again for
+ * PS_COMMIT_DELAY_MSEC.  Designed to be called periodically.
+ */
+void ps_update()
+{
+	ps_lep_state_t st;
+	bool commit = false;
+	int64_t t = esp_timer_get_time();
+	
+	portENTER_CRITICAL(&ps_lep_mux);
+	if (ps_lep_dirty && ((t - ps_lep_change_usec) >= (PS_COMMIT_DELAY_MSEC * 1000))) {
+		st = ps_lep_state;
+		ps_lep_dirty = false;
+		commit = true;
+	}
+	portEXIT_CRITICAL(&ps_lep_mux);
+	
+	if (commit && !ps_write_lep_info(&st)) {
+		ESP_LOGE(TAG, "Failed to save lep data to NVS Storage");
+		
+		// Try again after another delay unless it has changed since
+		portENTER_CRITICAL(&ps_lep_mux);
+		if (!ps_lep_dirty) {
+			ps_lep_dirty = true;
+			ps_lep_change_usec = t;
+		}
+		portEXIT_CRITICAL(&ps_lep_mux);
+	}
+}
+
+
+
+/**
+ * Returns the calibrated SPI clock of Lepton lep or 0 if it hasn't been calibrated
+ */
+uint32_t ps_get_spi_freq(int lep)
+{
+	return ps_spi_hz[lep];
+}
+
+
+/**
+ * Store the calibrated SPI clock of Lepton lep (0 clears the calibration).  Committed
+ * immediately since it only changes when the link is calibrated.
+ */
+void ps_set_spi_freq(int lep, uint32_t hz)
+{
+	esp_err_t err;
+	
+	ps_spi_hz[lep] = hz;
+	if (hz == 0) {
+		err = nvs_erase_key(ps_handle, lep_spi_key[lep]);
+		if (err == ESP_ERR_NVS_NOT_FOUND) err = ESP_OK;
+	} else {
+		err = nvs_set_u32(ps_handle, lep_spi_key[lep], hz);
+	}
+	if (err == ESP_OK) {
+		err = nvs_commit(ps_handle);
+	}
+	if (err != ESP_OK) {
+		ESP_LOGE(TAG, "Failed to save lep %d spi clock with %d", lep, err);
+	}
+}
+
+
 
 //
 // PS Utilities internal functions
@@ -344,13 +459,18 @@ static void ps_default_wifi_info()
 }
 
 
-static bool ps_write_lep_info()
+/**
+ * Write state as a record with the next version into the slot for that version
+ */
+static bool ps_write_lep_info(const ps_lep_state_t* state)
 {
-	size_t required_size;
+	ps_lep_rec_t rec;
 	esp_err_t err;
 	
-	required_size = sizeof(ps_lep_state_t);
-	err = nvs_set_blob(ps_handle, lep_info_key, &ps_lep_state, required_size);
+	rec.version = ps_lep_version + 1;
+	rec.state = *state;
+	rec.check = ps_lep_rec_check(&rec);
+	err = nvs_set_blob(ps_handle, lep_rec_key[rec.version & 1], &rec, sizeof(ps_lep_rec_t));
 	if (err != ESP_OK) {
 		ESP_LOGE(TAG, "Set lep info blob failed with %d", err);
 		return false;
@@ -362,23 +482,55 @@ static bool ps_write_lep_info()
 		return false;
 	}
 	
+	ps_lep_version = rec.version;
 	return true;
 }
 
 
-static bool ps_read_lep_info()
+/**
+ * Load our local copy from the newest valid record
+ */
+static bool ps_load_lep_info()
+{
+	ps_lep_rec_t rec[2];
+	bool valid[2];
+	int n;
+	
+	valid[0] = ps_read_lep_rec(0, &rec[0]);
+	valid[1] = ps_read_lep_rec(1, &rec[1]);
+	
+	if (valid[0] && valid[1]) {
+		// Versions wrap
+		n = ((int16_t) (rec[1].version - rec[0].version) > 0) ? 1 : 0;
+	} else if (valid[0]) {
+		n = 0;
+	} else if (valid[1]) {
+		n = 1;
+	} else {
+		return false;
+	}
+	
+	ps_lep_state = rec[n].state;
+	ps_lep_version = rec[n].version;
+	return true;
+}
+
+
+static bool ps_read_lep_rec(int slot, ps_lep_rec_t* rec)
 {
 	size_t required_size;
 	esp_err_t err;
 	
-	required_size = sizeof(ps_lep_state_t);
-	err = nvs_get_blob(ps_handle, lep_info_key, &ps_lep_state, &required_size);
+	required_size = sizeof(ps_lep_rec_t);
+	err = nvs_get_blob(ps_handle, lep_rec_key[slot], rec, &required_size);
 	if (err != ESP_OK) {
-		ESP_LOGE(TAG, "Get lep info blob failed with %d", err);
+		if (err != ESP_ERR_NVS_NOT_FOUND) {
+			ESP_LOGE(TAG, "Get lep info record %d failed with %d", slot, err);
+		}
 		return false;
 	}
-	if (required_size != sizeof(ps_lep_state_t)) {
-		ESP_LOGE(TAG, "Get lep info blob incorrect size %d (expected %d)", required_size, sizeof(ps_wifi_info_t));
+	if ((required_size != sizeof(ps_lep_rec_t)) || (rec->check != ps_lep_rec_check(rec))) {
+		ESP_LOGE(TAG, "Lep info record %d invalid", slot);
 		return false;
 	}
 	
@@ -386,6 +538,39 @@ static bool ps_read_lep_info()
 }
 
 
+/**
+ * Read the Lepton parameters stored before they were versioned
+ */
+static bool ps_read_legacy_lep_info()
+{
+	size_t required_size;
+	esp_err_t err;
+	
+	required_size = sizeof(ps_lep_state_t);
+	err = nvs_get_blob(ps_handle, lep_info_key, &ps_lep_state, &required_size);
+	
+	return ((err == ESP_OK) && (required_size == sizeof(ps_lep_state_t)));
+}
+
+
+/**
+ * Compute the check byte over a record's other bytes (seeded so an all-zero record
+ * is invalid)
+ */
+static uint8_t ps_lep_rec_check(const ps_lep_rec_t* rec)
+{
+	const uint8_t* p = (const uint8_t*) rec;
+	uint8_t c = 0xA5;
+	int i;
+	
+	for (i=0; i<sizeof(ps_lep_rec_t)-1; i++) {
+		c = ((c << 1) | (c >> 7)) ^ p[i];
+	}
+	
+	return c;
+}
+
+
 static bool ps_write_wifi_info()
 {
 	size_t required_size;
@@ -408,23 +593,22 @@ static bool ps_write_wifi_info()
 }
 
 
-static bool ps_read_wifi_info()
+static void ps_load_spi_freq()
 {
-	size_t required_size;
 	esp_err_t err;
+	int i;
 	
-	required_size = sizeof(ps_wifi_info_t);
-	err = nvs_get_blob(ps_handle, wifi_info_key, &ps_wifi_info, &required_size);
-	if (err != ESP_OK) {
-		ESP_LOGE(TAG, "Get wifi info blob failed with %d", err);
-		return false;
-	}
-	if (required_size != sizeof(ps_wifi_info_t)) {
-		ESP_LOGE(TAG, "Get wifi info blob incorrect size %d (expected %d)", required_size, sizeof(ps_wifi_info_t));
-		return false;
+	for (i=0; i<LEP_NUM_LEPTONS; i++) {
+		err = nvs_get_u32(ps_handle, lep_spi_key[i], &ps_spi_hz[i]);
+		if (err == ESP_OK) {
+			ESP_LOGI(TAG, "Read NVS lep %d spi clock %u Hz", i, ps_spi_hz[i]);
+		} else {
+			if (err != ESP_ERR_NVS_NOT_FOUND) {
+				ESP_LOGE(TAG, "Get lep %d spi clock failed with %d", i, err);
+			}
+			ps_spi_hz[i] = 0;
+		}
 	}
-	
-	return true;
 }
 
 
@@ -4,7 +4,16 @@
  * Manage the persistent storage kept in the ESP32 NVS and provide access
  * routines to it.
  *
- * NOTE: It is assumed that only task will access persistent storage at a time.
+ * Lepton state changes are made to a RAM cache and committed to NVS by ps_update()
+ * once they have stopped changing for PS_COMMIT_DELAY_MSEC so a burst of set_config
+ * commands results in one flash write.  The Lepton state is stored as a small packed
+ * record with a version count and a check byte, written alternately to one of two
+ * keys.  At boot the newest valid record is used so a record lost in a power failure
+ * during a write only loses the latest change.  Wifi changes are written immediately
+ * since they are rare and usually followed by a WiFi restart.
+ *
+ * NOTE: It is assumed that only one task will set persistent storage at a time.
+ *       ps_update() may be called from another task.
  *
  * Copyright 2020 Dan Julio
  *
@@ -46,6 +55,9 @@
 #define PS_SSID_MAX_LEN     32
 #define PS_PW_MAX_LEN       32
 
+// Time the Lepton state must be unchanged before it is committed to NVS
+#define PS_COMMIT_DELAY_MSEC 5000
+
 
 
 //
@@ -57,5 +69,8 @@ void ps_set_lep_state(const json_config_t* state);
 void ps_get_wifi_info(wifi_info_t* info);
 void ps_set_wifi_info(const wifi_info_t* info);
 bool ps_reinit_wifi();
+void ps_update();
+uint32_t ps_get_spi_freq(int lep);
+void ps_set_spi_freq(int lep, uint32_t hz);
 
 #endif /* PS_UTILITIES_H */
\ No newline at end of file
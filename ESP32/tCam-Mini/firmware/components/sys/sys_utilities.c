@@ -29,8 +29,11 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "driver/spi_master.h"
+#include "frame_utilities.h"
 #include "json_utilities.h"
+#include "lepton_utilities.h"
 #include "ps_utilities.h"
+#include "rsp_task.h"
 #include "sys_utilities.h"
 #include "time_utilities.h"
 #include "wifi_utilities.h"
@@ -44,17 +47,24 @@
 //
 static const char* TAG = "sys";
 
+// Buffers allocated by system_buffer_alloc() for placement reporting
+static sys_buf_info_t sys_buffers[SYS_MAX_BUFFERS];
+static int sys_num_buffers = 0;
+
 
 //
 // Task handle externs for use by tasks to communicate with each other
 //
+TaskHandle_t task_handle_ana;
 TaskHandle_t task_handle_cmd;
 TaskHandle_t task_handle_ctrl;
+TaskHandle_t task_handle_enc;
+TaskHandle_t task_handle_hist;
 TaskHandle_t task_handle_lep;
+TaskHandle_t task_handle_now;
+TaskHandle_t task_handle_rec;
 TaskHandle_t task_handle_rsp;
-#ifdef INCLUDE_SYS_MON
 TaskHandle_t task_handle_mon;
-#endif
 
 
 //
@@ -64,17 +74,33 @@ json_config_t lep_st;
 
 
 //
-// Global buffer pointers for memory allocated in the external SPIRAM
+// Global buffer pointers for memory allocated by system_buffer_init()
 //
 
 // Shared memory data structures
-lep_buffer_t rsp_lep_buffer[2];   // Ping-pong buffer loaded by lep_task for rsp_task
+QueueHandle_t sys_rsp_event_queue;   // Client commands from cmd_task for rsp_task
 
-// Big buffers
+// Big buffers (one per client)
 json_image_string_t sys_image_file_buffer;   // Used by file_task for json formatted image data
-json_image_string_t sys_image_rsp_buffer;    // Used by rsp_task for json formatted image data
+json_image_string_t sys_image_rsp_buffer[CMD_MAX_CLIENTS];    // Used by rsp_task for encoded image data
+
+uint16_t* sys_rsp_ref_bufferP[CMD_MAX_CLIENTS];    // Used by rsp_task to hold the last image sent for delta images
+
+uint16_t* sys_rsp_view_bufferP[CMD_MAX_CLIENTS];   // Used by rsp_task for cropped/binned images
 
-json_cmd_response_queue_t sys_cmd_response_buffer; // Loaded by cmd_task with json formatted response data
+json_cmd_response_queue_t sys_cmd_response_buffer[CMD_MAX_CLIENTS]; // Loaded by cmd_task with json formatted response data
+
+uint8_t* sys_rsp_rec_bufferP[CMD_MAX_CLIENTS];     // Used by rsp_task for recording data sent to a client
+char* sys_rsp_json_bufferP[CMD_MAX_CLIENTS][2];    // Used by rsp_task for json image chunks sent to a client
+
+// Recorder buffers
+uint8_t* sys_rec_image_bufferP;   // Used by rec_task for compressed images
+uint16_t* sys_rec_ref_bufferP;    // Used by rec_task to hold the last image recorded for delta images
+
+// Averaged image buffers
+uint32_t* sys_rsp_avg_sumP;        // Used by rsp_task to sum the frames of an averaged image
+uint16_t* sys_rsp_avg_bufferP;     // Used by rsp_task for the averaged image
+uint16_t* sys_rsp_avg_telemP;      // Used by rsp_task for the averaged image's telemetry
 
 
 
@@ -100,7 +126,7 @@ bool system_esp_io_init()
 		.miso_io_num=LEP_MISO_IO,
 		.mosi_io_num=-1,
 		.sclk_io_num=LEP_SCK_IO,
-		.max_transfer_sz=LEP_PKT_LENGTH,
+		.max_transfer_sz=LEP_SPI_BURST_PKTS*LEP_PKT_LENGTH,
 		.quadwp_io_num=-1,
 		.quadhd_io_num=-1
 	};
@@ -109,6 +135,22 @@ bool system_esp_io_init()
 		return false;
 	}
 	
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+	// Attempt to initialize the SPI Master used by the second Lepton
+	spi_bus_config_t spi_buscfg2 = {
+		.miso_io_num=LEP2_MISO_IO,
+		.mosi_io_num=-1,
+		.sclk_io_num=LEP2_SCK_IO,
+		.max_transfer_sz=LEP_SPI_BURST_PKTS*LEP_PKT_LENGTH,
+		.quadwp_io_num=-1,
+		.quadhd_io_num=-1
+	};
+	if (spi_bus_initialize(LEP2_SPI_HOST, &spi_buscfg2, LEP2_DMA_NUM) != ESP_OK) {
+		ESP_LOGE(TAG, "Second Lepton Master initialization failed");
+		return false;
+	}
+#endif
+	
 	return true;
 }
 
@@ -122,6 +164,17 @@ bool system_peripheral_init()
 	
 	time_init();
 	
+	// Initialize the Lepton GPIO and then reset the Lepton first so it boots while
+	// the rest of the system initializes (reset also handles potential external
+	// crystal oscillator slow start-up).  A Lepton that kept running through a warm
+	// MCU reset is left running (lep_task resets it if its configuration differs).
+	gpio_set_direction(LEP_VSYNC_IO, GPIO_MODE_INPUT);
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+	gpio_set_direction(LEP2_VSYNC_IO, GPIO_MODE_INPUT);
+#endif
+	gpio_set_direction(LEP_RESET_IO, GPIO_MODE_OUTPUT);
+	(void) lepton_warm_start();
+	
 	if (!ps_init()) {
 		ESP_LOGE(TAG, "Persistent Storage initialization failed");
 		return false;
@@ -135,84 +188,201 @@ bool system_peripheral_init()
 		return false;
 	}
 	
-	// Initialize the Lepton GPIO and then reset the Lepton
-	// (reset handles potential external crystal oscillator slow start-up)
-	gpio_set_direction(LEP_VSYNC_IO, GPIO_MODE_INPUT);
-	gpio_set_direction(LEP_RESET_IO, GPIO_MODE_OUTPUT);
-	gpio_set_level(LEP_RESET_IO, 1);
-	vTaskDelay(pdMS_TO_TICKS(10));
-	gpio_set_level(LEP_RESET_IO, 0);
-	
 	return true;
 }
 
 
 /**
- * Allocate shared buffers for use by tasks for image data in the external RAM
+ * Allocate shared buffers for use by tasks.  The hottest working buffers (frames being
+ * loaded and encoded, telemetry and command responses) are placed in internal DRAM when
+ * there is room and the bulk image buffers in the external RAM.  The low memory build
+ * (CONFIG_TCAM_NO_PSRAM) leaves out the buffers of the image formats, recordings and
+ * averages it doesn't support.
  */
 bool system_buffer_init()
 {
+	int i, j;
+	
 	ESP_LOGI(TAG, "Buffer Allocation");
 	
-	// Allocate the LEP/RSP task lepton frame and telemetry ping-pong buffers
-	rsp_lep_buffer[0].lep_bufferP = heap_caps_malloc(LEP_NUM_PIXELS*2, MALLOC_CAP_SPIRAM);
-	if (rsp_lep_buffer[0].lep_bufferP == NULL) {
-		ESP_LOGE(TAG, "malloc RSP lepton shared image buffer 0 failed");
+	// Allocate the shared lepton frame and telemetry buffers
+	if (!frame_init()) {
+		ESP_LOGE(TAG, "malloc lepton frame buffers failed");
 		return false;
 	}
-	rsp_lep_buffer[0].lep_telemP = heap_caps_malloc(LEP_TEL_WORDS*2, MALLOC_CAP_SPIRAM);
-	if (rsp_lep_buffer[0].lep_telemP == NULL) {
-		ESP_LOGE(TAG, "malloc RSP lepton shared telemetry buffer 0 failed");
+	
+	// Allocate the json buffers
+	if (!json_init()) {
+		ESP_LOGE(TAG, "malloc json buffers failed");
 		return false;
 	}
-	rsp_lep_buffer[1].lep_bufferP = heap_caps_malloc(LEP_NUM_PIXELS*2, MALLOC_CAP_SPIRAM);
-	if (rsp_lep_buffer[1].lep_bufferP == NULL) {
-		ESP_LOGE(TAG, "malloc RSP lepton shared image buffer 1 failed");
+	
+	// Create the client command event queue
+	sys_rsp_event_queue = xQueueCreate(RSP_EVENT_QUEUE_LEN, sizeof(rsp_cmd_event_t));
+	if (sys_rsp_event_queue == NULL) {
+		ESP_LOGE(TAG, "create rsp event queue failed");
 		return false;
 	}
-	rsp_lep_buffer[1].lep_telemP = heap_caps_malloc(LEP_TEL_WORDS*2, MALLOC_CAP_SPIRAM);
-	if (rsp_lep_buffer[1].lep_telemP == NULL) {
-		ESP_LOGE(TAG, "malloc RSP lepton shared telemetry buffer 1 failed");
-		return false;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		// Allocate the outgoing command response json buffer
+		sys_cmd_response_buffer[i].mutex = xSemaphoreCreateMutex();
+		sys_cmd_response_buffer[i].bufferP = system_buffer_alloc("cmd response", i, CMD_RESPONSE_BUFFER_LEN, SYS_BUF_INTERNAL);
+		if (sys_cmd_response_buffer[i].bufferP == NULL) {
+			ESP_LOGE(TAG, "malloc cmd response buffer %d failed", i);
+			return false;
+		}
+		sys_cmd_response_buffer[i].push_index = 0;
+		sys_cmd_response_buffer[i].pop_index = 0;
+		sys_cmd_response_buffer[i].length = 0;
+		
+		// Allocate the encoded image buffer
+		sys_image_rsp_buffer[i].bufferP = system_buffer_alloc("image enc", i, RSP_IMAGE_ENC_LEN, SYS_BUF_SPIRAM);
+		if (sys_image_rsp_buffer[i].bufferP == NULL) {
+			ESP_LOGE(TAG, "malloc shared encoded image response buffer %d failed", i);
+			return false;
+		}
+		
+		// Allocate the json image chunk buffers
+		for (j=0; j<2; j++) {
+			sys_rsp_json_bufferP[i][j] = system_buffer_alloc("json chunk", i*2 + j, RSP_JSON_CHUNK_BUF_LEN, SYS_BUF_INTERNAL);
+			if (sys_rsp_json_bufferP[i][j] == NULL) {
+				ESP_LOGE(TAG, "malloc json image chunk buffer %d failed", i*2 + j);
+				return false;
+			}
+		}
+		
+#ifndef CONFIG_TCAM_NO_PSRAM
+		// Allocate the delta image reference buffer
+		sys_rsp_ref_bufferP[i] = system_buffer_alloc("delta ref", i, LEP_NUM_PIXELS*2, SYS_BUF_SPIRAM);
+		if (sys_rsp_ref_bufferP[i] == NULL) {
+			ESP_LOGE(TAG, "malloc delta image reference buffer %d failed", i);
+			return false;
+		}
+		
+		// Allocate the cropped/binned image buffer
+		sys_rsp_view_bufferP[i] = system_buffer_alloc("image view", i, LEP_NUM_PIXELS*2, SYS_BUF_SPIRAM);
+		if (sys_rsp_view_bufferP[i] == NULL) {
+			ESP_LOGE(TAG, "malloc image view buffer %d failed", i);
+			return false;
+		}
+#endif
+		
+		// Allocate the recording data buffer
+		sys_rsp_rec_bufferP[i] = system_buffer_alloc("record data", i, RSP_REC_CHUNK_HEADER_LEN + RSP_MAX_REC_CHUNK_LEN, SYS_BUF_SPIRAM);
+		if (sys_rsp_rec_bufferP[i] == NULL) {
+			ESP_LOGE(TAG, "malloc recording data buffer %d failed", i);
+			return false;
+		}
 	}
 	
-	// Create the ping-pong buffer access mutexes
-	rsp_lep_buffer[0].lep_mutex = xSemaphoreCreateMutex();
-	if (rsp_lep_buffer[0].lep_mutex == NULL) {
-		ESP_LOGE(TAG, "create RSP lepton mutex 0 failed");
+#ifndef CONFIG_TCAM_NO_PSRAM
+	// Allocate the recorder buffers
+	sys_rec_image_bufferP = system_buffer_alloc("rec image", 0, LEP_NUM_PIXELS*2, SYS_BUF_SPIRAM);
+	if (sys_rec_image_bufferP == NULL) {
+		ESP_LOGE(TAG, "malloc recorder image buffer failed");
 		return false;
 	}
-	rsp_lep_buffer[1].lep_mutex = xSemaphoreCreateMutex();
-	if (rsp_lep_buffer[1].lep_mutex == NULL) {
-		ESP_LOGE(TAG, "create RSP lepton mutex 1 failed");
+	
+	sys_rec_ref_bufferP = system_buffer_alloc("rec ref", 0, LEP_NUM_PIXELS*2, SYS_BUF_SPIRAM);
+	if (sys_rec_ref_bufferP == NULL) {
+		ESP_LOGE(TAG, "malloc recorder reference buffer failed");
 		return false;
 	}
 	
-	// Allocate the json buffers
-	if (!json_init()) {
-		ESP_LOGE(TAG, "malloc json buffers failed");
+	// Allocate the averaged image buffers
+	sys_rsp_avg_sumP = system_buffer_alloc("avg sum", 0, LEP_NUM_PIXELS*4, SYS_BUF_SPIRAM);
+	sys_rsp_avg_bufferP = system_buffer_alloc("avg image", 0, LEP_NUM_PIXELS*2, SYS_BUF_SPIRAM);
+	sys_rsp_avg_telemP = system_buffer_alloc("avg telem", 0, LEP_TEL_WORDS*2, SYS_BUF_SPIRAM);
+	if ((sys_rsp_avg_sumP == NULL) || (sys_rsp_avg_bufferP == NULL) || (sys_rsp_avg_telemP == NULL)) {
+		ESP_LOGE(TAG, "malloc averaged image buffers failed");
 		return false;
 	}
+#endif
 	
-	// Allocate the outgoing command response json buffer
-	sys_cmd_response_buffer.mutex = xSemaphoreCreateMutex();
-	sys_cmd_response_buffer.bufferP = heap_caps_malloc(CMD_RESPONSE_BUFFER_LEN, MALLOC_CAP_SPIRAM);
-	if (sys_cmd_response_buffer.bufferP == NULL) {
-		ESP_LOGE(TAG, "malloc cmd response buffer failed");
-		return false;
+	return true;
+}
+
+
+/**
+ * Allocate a buffer with the requested placement.  SYS_BUF_INTERNAL buffers are placed
+ * in internal DRAM only if SYS_BUF_INTERNAL_RESERVE bytes remain free for the WiFi and
+ * network stacks afterwards, and otherwise in the external RAM.  The low memory build
+ * places every buffer in internal DRAM under the same condition.  The buffer is recorded
+ * so its placement can be reported.  Returns NULL if the allocation failed.
+ */
+void* system_buffer_alloc(const char* name, int index, uint32_t len, int placement)
+{
+	bool internal = false;
+	void* bufP = NULL;
+	
+#ifdef CONFIG_TCAM_NO_PSRAM
+	placement = SYS_BUF_INTERNAL;
+#endif
+	if ((placement == SYS_BUF_INTERNAL) &&
+	    (heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) >= (len + SYS_BUF_INTERNAL_RESERVE)) &&
+	    (heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT) >= len)) {
+		bufP = heap_caps_malloc(len, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+		internal = (bufP != NULL);
+	}
+#ifdef CONFIG_TCAM_NO_PSRAM
+	if (bufP == NULL) {
+		ESP_LOGE(TAG, "no room for %s buffer %d (%u bytes)", name, index, len);
+	}
+#else
+	if (bufP == NULL) {
+		bufP = heap_caps_malloc(len, MALLOC_CAP_SPIRAM);
+		if (placement == SYS_BUF_INTERNAL) {
+			ESP_LOGW(TAG, "%s buffer %d placed in PSRAM", name, index);
+		}
 	}
-	sys_cmd_response_buffer.pushP = sys_cmd_response_buffer.bufferP;
-	sys_cmd_response_buffer.popP = sys_cmd_response_buffer.bufferP;
-	sys_cmd_response_buffer.length = 0;
+#endif
 	
-	// Allocate the json image text buffer               
-	sys_image_rsp_buffer.bufferP = heap_caps_malloc(JSON_MAX_IMAGE_TEXT_LEN, MALLOC_CAP_SPIRAM);
-	if (sys_image_rsp_buffer.bufferP == NULL) {
-		ESP_LOGE(TAG, "malloc shared json image text response buffer failed");
-		return false;
+	if ((bufP != NULL) && (sys_num_buffers < SYS_MAX_BUFFERS)) {
+		sys_buffers[sys_num_buffers].name = name;
+		sys_buffers[sys_num_buffers].index = index;
+		sys_buffers[sys_num_buffers].bufP = bufP;
+		sys_buffers[sys_num_buffers].len = len;
+		sys_buffers[sys_num_buffers].placement = placement;
+		sys_buffers[sys_num_buffers].internal = internal;
+		sys_num_buffers++;
 	}
 	
-	return true;
+	return bufP;
+}
+
+
+/**
+ * Log the memory used by the buffers allocated so far and the memory left.  Called
+ * once the buffers allocated before the tasks start have been.
+ */
+void system_buffer_report()
+{
+	int i;
+	uint32_t internal_len = 0;
+	uint32_t spiram_len = 0;
+	
+	for (i=0; i<sys_num_buffers; i++) {
+		if (sys_buffers[i].internal) {
+			internal_len += sys_buffers[i].len;
+		} else {
+			spiram_len += sys_buffers[i].len;
+		}
+	}
+	
+	ESP_LOGI(TAG, "%d buffers: %u bytes internal, %u bytes PSRAM", sys_num_buffers, internal_len, spiram_len);
+	ESP_LOGI(TAG, "Free internal %u bytes (largest block %u), free PSRAM %u bytes",
+	         heap_caps_get_free_size(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+	         heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT),
+	         heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
 }
 
 
+/**
+ * Return a pointer to the allocated buffer records and the number of records
+ */
+int system_get_buffer_info(const sys_buf_info_t** info)
+{
+	*info = sys_buffers;
+	return sys_num_buffers;
+}
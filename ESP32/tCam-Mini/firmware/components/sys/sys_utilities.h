@@ -28,6 +28,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "system_config.h"
 #include <stdbool.h>
 #include <stdint.h>
@@ -42,18 +43,48 @@
 #define SYS_GAIN_LOW  1
 #define SYS_GAIN_AUTO 2
 
+// Buffer placement (see system_buffer_alloc)
+//   SYS_BUF_INTERNAL - Hot working buffers: internal DRAM if there is room, PSRAM otherwise
+//   SYS_BUF_SPIRAM   - Bulk buffers: PSRAM
+#define SYS_BUF_INTERNAL 0
+#define SYS_BUF_SPIRAM   1
+
+// Internal DRAM left free for WiFi, lwIP and task stacks when placing hot buffers
+#define SYS_BUF_INTERNAL_RESERVE (80 * 1024)
+
+// Maximum number of buffers recorded for placement reporting
+#define SYS_MAX_BUFFERS 64
+
 
 
 //
 // System Utilities typedefs
 //
+
+// Coarse histogram of an image's pixels for auto-ranging (set_image_format hist).  Pixel
+// v of an image with range min - max is counted in bin (v - min) * LEP_HIST_BINS /
+// (max - min + 1).
+#define LEP_HIST_BINS 64
+
+typedef struct {
+	uint16_t p1, p50, p99;           // Pixel values at the 1st, 50th and 99th percentiles
+	uint16_t bins[LEP_HIST_BINS];    // Pixels in each bin
+} lep_hist_t;
+
 typedef struct {
 	bool telem_valid;
 	uint16_t lep_min_val;
 	uint16_t lep_max_val;
+	int64_t vsync_usec;          // esp_timer time of the vsync that completed the frame
+	int64_t ready_usec;          // esp_timer time lep_task finished reading the frame
+	uint32_t seq;                // Capture sequence number (gaps are frames never read)
+	int64_t sync_tick_usec;      // Synchronized stream tick (uSec since 1970) the image is for (0 = none)
+	lep_hist_t* histP;           // Histogram sent with the image (NULL for none)
+	uint8_t avg_frames;          // Frames averaged into the image (0 for a single frame)
+	uint8_t avg_frac_bits;       // Fractional bits of the averaged pixels
+	uint8_t lepton;              // Lepton the frame came from (0 - LEP_NUM_LEPTONS-1)
 	uint16_t* lep_bufferP;
 	uint16_t* lep_telemP;
-	SemaphoreHandle_t lep_mutex;
 } lep_buffer_t;
 
 typedef struct {
@@ -61,20 +92,37 @@ typedef struct {
 	char* bufferP;
 } json_image_string_t;
 
+// Ring of command responses, each stored as a 16-bit length followed by the response
 typedef struct {
-	int length;
-	char* pushP;
-	char* popP;
+	volatile uint32_t length;    // Bytes in use (including the lengths)
+	uint32_t push_index;
+	uint32_t pop_index;
 	char* bufferP;
-	SemaphoreHandle_t mutex;
+	SemaphoreHandle_t mutex;     // Serializes pushes and the pop index update
 } json_cmd_response_queue_t;
 
+typedef struct {
+	int client;                  // Index of the client the event is for
+	int event;                   // RSP_EVT_xxx (see rsp_task.h)
+	uint32_t args[8];            // Event specific arguments
+} rsp_cmd_event_t;
+
 typedef struct {
 	bool agc_set_enabled;        // Set when agc_enabled
 	int emissivity;              // Integer percent 1 - 100
 	int gain_mode;               // SYS_GAIN_HIGH / SYS_GAIN_LOW / SYS_GAIN_AUTO
+	int temporal_filter;         // Temporal filter level 0 (off) - LEP_TF_MAX_LEVEL
 } json_config_t;
 
+typedef struct {
+	const char* name;
+	int index;                   // Instance (client or frame) number
+	void* bufP;
+	uint32_t len;
+	uint8_t placement;           // Requested SYS_BUF_xxx
+	bool internal;               // Allocated in internal DRAM
+} sys_buf_info_t;
+
 
 
 //
@@ -87,13 +135,16 @@ typedef struct {
 //
 // Task handle externs for use by tasks to communicate with each other
 //
+extern TaskHandle_t task_handle_ana;
 extern TaskHandle_t task_handle_cmd;
 extern TaskHandle_t task_handle_ctrl;
+extern TaskHandle_t task_handle_enc;
+extern TaskHandle_t task_handle_hist;
 extern TaskHandle_t task_handle_lep;
+extern TaskHandle_t task_handle_now;
+extern TaskHandle_t task_handle_rec;
 extern TaskHandle_t task_handle_rsp;
-#ifdef INCLUDE_SYS_MON
 extern TaskHandle_t task_handle_mon;
-#endif
 
 //
 // Lepton configuration state
@@ -105,14 +156,30 @@ extern json_config_t lep_st;
 //
 
 // Shared memory data structures
-extern lep_buffer_t rsp_lep_buffer[2];   // Ping-pong buffer loaded by lep_task for rsp_task
+//   Lepton frame buffers are managed by the frame broker (frame_utilities.h).  Tasks
+//   that use frames subscribe to it instead of keeping their own copies.
+extern QueueHandle_t sys_rsp_event_queue;   // Client commands from cmd_task for rsp_task
+
+// Big buffers (one per client)
+extern json_image_string_t sys_image_rsp_buffer[CMD_MAX_CLIENTS];    // Used by rsp_task for encoded image data
+
+extern uint16_t* sys_rsp_ref_bufferP[CMD_MAX_CLIENTS];    // Used by rsp_task to hold the last image sent for delta images
+
+extern uint16_t* sys_rsp_view_bufferP[CMD_MAX_CLIENTS];   // Used by rsp_task for cropped/binned images
+
+extern json_cmd_response_queue_t sys_cmd_response_buffer[CMD_MAX_CLIENTS]; // Loaded by cmd_task with json formatted response data
 
-// Big buffers
-extern json_image_string_t sys_image_rsp_buffer;    // Used by rsp_task for json formatted image data
+extern uint8_t* sys_rsp_rec_bufferP[CMD_MAX_CLIENTS];     // Used by rsp_task for recording data sent to a client
+extern char* sys_rsp_json_bufferP[CMD_MAX_CLIENTS][2];    // Used by rsp_task for json image chunks sent to a client
 
-extern json_cmd_response_queue_t sys_cmd_response_buffer; // Loaded by cmd_task with json formatted response data
+// Recorder buffers
+extern uint8_t* sys_rec_image_bufferP;   // Used by rec_task for compressed images
+extern uint16_t* sys_rec_ref_bufferP;    // Used by rec_task to hold the last image recorded for delta images
 
-extern uint16_t* gui_lep_bufferP;    // Loaded by gui_task for its own use
+// Averaged image buffers
+extern uint32_t* sys_rsp_avg_sumP;        // Used by rsp_task to sum the frames of an averaged image
+extern uint16_t* sys_rsp_avg_bufferP;     // Used by rsp_task for the averaged image
+extern uint16_t* sys_rsp_avg_telemP;      // Used by rsp_task for the averaged image's telemetry
 
 
 //
@@ -121,6 +188,9 @@ extern uint16_t* gui_lep_bufferP;    // Loaded by gui_task for its own use
 bool system_esp_io_init();
 bool system_peripheral_init();
 bool system_buffer_init();
+void* system_buffer_alloc(const char* name, int index, uint32_t len, int placement);
+void system_buffer_report();
+int system_get_buffer_info(const sys_buf_info_t** info);
 
 #define system_get_lep_st() (&lep_st)
  
@@ -27,13 +27,16 @@
  */
 #include "wifi_utilities.h"
 #include "ps_utilities.h"
+#include "time_utilities.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_event_loop.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
 #include "nvs_flash.h"
 #include <lwip/sockets.h>
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -63,11 +66,40 @@ static wifi_info_t wifi_info = {
 static bool sta_connected = false; // Set when we connect to an AP so we can disconnect if we restart
 static int sta_retry_num = 0;
 
+// Last AP joined in client mode.  Reconnects go straight to it first.
+static bool sta_ap_cached = false;
+static uint8_t sta_ap_bssid[6];
+static uint8_t sta_ap_channel;
+static bool sta_cfg_cached = false;   // Set while the station is configured for the cached AP
+
+// Connection state for clients of the camera
+static uint32_t down_msec = 0;        // When the connection was lost (0 while connected)
+static uint32_t addr_gen = 0;         // Incremented each time the station address changes
+static wifi_ps_type_t sta_ps = WIFI_PS_MIN_MODEM; // Driver default when the station starts
+
 static wifi_ap_record_t ap_info[WIFI_MAX_SCAN_LIST_SIZE];
 static bool scan_in_progress = false;
 static bool got_scan_done_event = false; // Set when an AP Scan is complete
 
-// FreeRTOS event group to signal when we are connected
+// Background scan state - the channel being scanned (0 when not scanning), if a scan
+// of it has been started and is done and the number of APs merged into ap_info
+// (bg_ap_count is -1 when ap_info doesn't hold background scan records)
+static portMUX_TYPE bg_scan_mux = portMUX_INITIALIZER_UNLOCKED;
+static int bg_scan_channel = 0;
+static bool bg_scan_busy = false;
+static volatile bool bg_scan_done = false;
+static int bg_ap_count = -1;
+static wifi_ap_record_t bg_ap_rec[WIFI_MAX_SCAN_LIST_SIZE];
+
+// AP channel planner state - the AP's channel and if it is 40 MHz wide (with its
+// secondary channel) and when a scan for the planner is running
+static int ap_channel = (CONFIG_TCAM_AP_CHANNEL == 0) ? 1 : CONFIG_TCAM_AP_CHANNEL;
+static bool ap_ht40 = false;
+static wifi_second_chan_t ap_second = WIFI_SECOND_CHAN_NONE;
+static volatile bool ap_plan_busy = false;
+
+// FreeRTOS event group to signal when we are connected and when the planner's scan is done
+#define WIFI_AP_PLAN_SCAN_BIT BIT0
 static EventGroupHandle_t wifi_event_group;
 
 
@@ -78,6 +110,11 @@ static EventGroupHandle_t wifi_event_group;
 static bool init_esp_wifi();
 static bool enable_esp_wifi_ap();
 static bool enable_esp_wifi_client();
+static esp_err_t set_sta_config(bool cached_ap);
+static void note_connected(bool connected);
+static void merge_bg_scan_records();
+static void plan_ap_channel();
+static void add_ap_plan_score(int* score, int center, int weight);
 static esp_err_t sys_event_handler(void *ctx, system_event_t* event);
 
 
@@ -231,6 +268,11 @@ bool wifi_setup_scan()
 	
 	got_scan_done_event = false;
 	
+	// End any background scan (its records are replaced)
+	bg_scan_channel = 0;
+	bg_scan_busy = false;
+	bg_ap_count = -1;
+	
 	// Attempt to disconnect from an AP if we were previously connected
 	if (sta_connected) {
 		ESP_LOGI(TAG, "Attempting to disconnect from AP");
@@ -296,6 +338,9 @@ void wifi_stop_scan()
 	(void) esp_wifi_scan_stop();
 	scan_in_progress = false;
 	got_scan_done_event = false;
+	bg_scan_channel = 0;
+	bg_scan_busy = false;
+	bg_ap_count = -1;
 }
 
 
@@ -308,12 +353,36 @@ bool wifi_is_connected()
 }
 
 
+/**
+ * Return the mSec since the connection (client mode) or the last station (AP mode) was
+ * lost, 0 while connected
+ */
+uint32_t wifi_get_down_msec()
+{
+	uint32_t t = down_msec;
+	
+	if (t == 0) return 0;
+	
+	return (uint32_t) (esp_timer_get_time() / 1000) - t;
+}
+
+
+/**
+ * Return a count that changes each time the camera gets a different address in client
+ * mode.  Connections made to the previous address can't be resumed.
+ */
+uint32_t wifi_get_addr_gen()
+{
+	return addr_gen;
+}
+
+
 /**
  * Return scan completion status
  */
 bool wifi_scan_is_complete()
 {
-	return got_scan_done_event;
+	return got_scan_done_event || ((bg_ap_count >= 0) && (bg_scan_channel == 0));
 }
 
 
@@ -326,6 +395,88 @@ wifi_info_t* wifi_get_info()
 }
 
 
+/**
+ * Set the modem power save mode in client mode (the Soft AP never sleeps).  The
+ * driver is only called when the mode changes.
+ */
+void wifi_set_power_save(wifi_ps_type_t ps)
+{
+	esp_err_t ret;
+	
+	if ((wifi_info.flags & (WIFI_INFO_FLAG_CLIENT_MODE | WIFI_INFO_FLAG_ENABLED)) !=
+	    (WIFI_INFO_FLAG_CLIENT_MODE | WIFI_INFO_FLAG_ENABLED)) {
+		return;
+	}
+	if (ps == sta_ps) return;
+	
+	ret = esp_wifi_set_ps(ps);
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "Could not set power save mode %d (%d)", ps, ret);
+		return;
+	}
+	sta_ps = ps;
+}
+
+
+/**
+ * Pick the AP's channel again and restart the AP on it.  Its client is disconnected.
+ * Returns false when not in AP mode or if the AP couldn't be restarted.
+ */
+bool wifi_replan_ap_channel()
+{
+	if ((wifi_info.flags & (WIFI_INFO_FLAG_CLIENT_MODE | WIFI_INFO_FLAG_ENABLED)) !=
+	    WIFI_INFO_FLAG_ENABLED) {
+		return false;
+	}
+	
+	ESP_LOGI(TAG, "WiFi AP stopping to pick a new channel");
+	esp_wifi_stop();
+	wifi_info.flags &= ~(WIFI_INFO_FLAG_ENABLED | WIFI_INFO_FLAG_CONNECTED);
+	
+	if (!enable_esp_wifi_ap()) {
+		return false;
+	}
+	wifi_info.flags |= WIFI_INFO_FLAG_ENABLED;
+	ESP_LOGI(TAG, "WiFi AP %s enabled", wifi_info.ap_ssid);
+	
+	return true;
+}
+
+
+/**
+ * Return the AP's channel and if it is 40 MHz wide (only meaningful in AP mode)
+ */
+int wifi_get_ap_channel()
+{
+	return ap_channel;
+}
+
+
+bool wifi_get_ap_ht40()
+{
+	return ap_ht40;
+}
+
+
+/**
+ * Get the signal strength (dBm) of the AP we're connected to.  Returns false when not
+ * connected in client mode.
+ */
+bool wifi_get_rssi(int* rssi)
+{
+	wifi_ap_record_t ap;
+	
+	if (((wifi_info.flags & WIFI_INFO_FLAG_CLIENT_MODE) == 0) || !wifi_is_connected()) {
+		return false;
+	}
+	if (esp_wifi_sta_get_ap_info(&ap) != ESP_OK) {
+		return false;
+	}
+	*rssi = ap.rssi;
+	return true;
+}
+
+
 /**
  * Return a pointer to an array of wifi_ap_record_t structures
  */
@@ -337,7 +488,10 @@ int wifi_get_scan_records(wifi_ap_record_t **ap)
 	
 	*ap = &ap_info[0];
 	
-	if (got_scan_done_event) {
+	if (bg_ap_count >= 0) {
+		// Background scan records found so far
+		return bg_ap_count;
+	} else if (got_scan_done_event) {
     	memset(ap_info, 0, sizeof(ap_info));
     	ret = esp_wifi_scan_get_ap_records(&number, ap_info);
     	if (ret != ESP_OK) {
@@ -359,6 +513,95 @@ int wifi_get_scan_records(wifi_ap_record_t **ap)
 }
 
 
+/**
+ * Start a background scan in client mode that doesn't disconnect from the AP.  One
+ * channel is scanned at a time in the gaps between frames found by
+ * wifi_bg_scan_service().  The APs found are merged into the records returned by
+ * wifi_get_scan_records() after each channel (keeping the strongest
+ * WIFI_MAX_SCAN_LIST_SIZE) and wifi_scan_is_complete() is true once every channel
+ * has been scanned.  Returns false when not in client mode.
+ */
+bool wifi_start_bg_scan()
+{
+	if ((wifi_info.flags & (WIFI_INFO_FLAG_CLIENT_MODE | WIFI_INFO_FLAG_ENABLED)) !=
+	    (WIFI_INFO_FLAG_CLIENT_MODE | WIFI_INFO_FLAG_ENABLED)) {
+		return false;
+	}
+	
+	if (bg_scan_channel == 0) {
+		ESP_LOGI(TAG, "Start background scan");
+		portENTER_CRITICAL(&bg_scan_mux);
+		memset(ap_info, 0, sizeof(ap_info));
+		bg_ap_count = 0;
+		portEXIT_CRITICAL(&bg_scan_mux);
+		got_scan_done_event = false;
+		bg_scan_busy = false;
+		bg_scan_channel = 1;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Return the channel a background scan is on (0 when one isn't running)
+ */
+int wifi_get_bg_scan_channel()
+{
+	return bg_scan_channel;
+}
+
+
+/**
+ * Advance a background scan.  Designed to be called often by the task sending images
+ * with gap true when there will be no traffic for at least WIFI_BG_SCAN_SLOT_USEC so
+ * the next channel's off-channel dwell doesn't delay an image.
+ */
+void wifi_bg_scan_service(bool gap)
+{
+	esp_err_t ret;
+	wifi_scan_config_t scan_config = {
+		.ssid = NULL,
+		.bssid = NULL,
+		.channel = 0,
+		.show_hidden = false,
+		.scan_type = WIFI_SCAN_TYPE_ACTIVE,
+		.scan_time.active.min = WIFI_BG_SCAN_DWELL_MSEC,
+		.scan_time.active.max = WIFI_BG_SCAN_DWELL_MSEC
+	};
+	
+	if (bg_scan_channel == 0) return;
+	
+	if (bg_scan_busy) {
+		if (!bg_scan_done) return;
+		
+		merge_bg_scan_records();
+		bg_scan_busy = false;
+		if (++bg_scan_channel > WIFI_BG_SCAN_CHANNELS) {
+			ESP_LOGI(TAG, "Background scan done, %d APs", bg_ap_count);
+			bg_scan_channel = 0;
+			return;
+		}
+	}
+	
+	// Only scan while associated (reconnecting uses the radio) and traffic allows
+	if (!gap || !wifi_is_connected()) return;
+	
+	scan_config.channel = bg_scan_channel;
+	bg_scan_done = false;
+	ret = esp_wifi_scan_start(&scan_config, false);
+	if (ret == ESP_OK) {
+		bg_scan_busy = true;
+	} else {
+		ESP_LOGE(TAG, "Could not scan channel %d (%d)", bg_scan_channel, ret);
+		if (++bg_scan_channel > WIFI_BG_SCAN_CHANNELS) {
+			bg_scan_channel = 0;
+		}
+	}
+}
+
+
+
 //
 // WiFi Utilities internal functions
 //
@@ -411,6 +654,12 @@ static bool enable_esp_wifi_ap()
         wifi_config.ap.authmode = WIFI_AUTH_OPEN;
     }
     
+    // Pick the least congested channel unless it is fixed
+    if (CONFIG_TCAM_AP_CHANNEL == 0) {
+    	plan_ap_channel();
+    }
+    wifi_config.ap.channel = ap_channel;
+    
     ret = esp_wifi_set_mode(WIFI_MODE_AP);
     if (ret != ESP_OK) {
     	ESP_LOGE(TAG, "Could not set Soft AP mode (%d)", ret);
@@ -423,12 +672,26 @@ static bool enable_esp_wifi_ap()
     	return false;
     }
     
+    ret = esp_wifi_set_bandwidth(ESP_IF_WIFI_AP, ap_ht40 ? WIFI_BW_HT40 : WIFI_BW_HT20);
+    if (ret != ESP_OK) {
+    	ESP_LOGW(TAG, "Could not set Soft AP bandwidth (%d)", ret);
+    	ap_ht40 = false;
+    }
+    
     ret = esp_wifi_start();
     if (ret != ESP_OK) {
     	ESP_LOGE(TAG, "Could not start Soft AP (%d)", ret);
     	return false;
     }
     
+    if (ap_ht40) {
+    	ret = esp_wifi_set_channel(ap_channel, ap_second);
+    	if (ret != ESP_OK) {
+    		ESP_LOGW(TAG, "Could not set Soft AP secondary channel (%d)", ret);
+    	}
+    }
+    ESP_LOGI(TAG, "Soft AP on channel %d%s", ap_channel, ap_ht40 ? " (40 MHz)" : "");
+    
     // For now, since we are using the default IP address, copy it to the current here
     for (i=0; i<4; i++) {
     	wifi_info.cur_ip_addr[i] = wifi_info.ap_ip_addr[i];
@@ -471,30 +734,15 @@ static bool enable_esp_wifi_client()
     	}
 	}
 	
-	// Enable the Client
-	wifi_config_t wifi_config = {
-		.sta = {
-			.scan_method = WIFI_FAST_SCAN,
-			.bssid_set = 0,
-			.channel = 0,
-			.listen_interval = 0,
-			.sort_method = WIFI_CONNECT_AP_BY_SIGNAL			
-		}
-	};	
-    strcpy((char*) wifi_config.sta.ssid, wifi_info.sta_ssid);
-    if (strlen(wifi_info.sta_pw) == 0) {
-        strcpy((char*) wifi_config.sta.password, "");
-    } else {
-    	strcpy((char*) wifi_config.sta.password, wifi_info.sta_pw);
-    }
-    
+	// Enable the Client (the SSID may have changed so the last AP is forgotten)
+	sta_ap_cached = false;
     ret = esp_wifi_set_mode(WIFI_MODE_STA);
     if (ret != ESP_OK) {
     	ESP_LOGE(TAG, "Could not set Station mode (%d)", ret);
     	return false;
     }
     
-    ret = esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
+    ret = set_sta_config(false);
     if (ret != ESP_OK) {
     	ESP_LOGE(TAG, "Could not set Station configuration (%d)", ret);
     	return false;
@@ -505,11 +753,62 @@ static bool enable_esp_wifi_client()
     	ESP_LOGE(TAG, "Could not start Station (%d)", ret);
     	return false;
     }
+    sta_ps = WIFI_PS_MIN_MODEM;
     
     return true;
 }
 
 
+/**
+ * Configure the station to join the SSID, scanning for its AP, or to join the cached AP
+ * directly on its channel
+ */
+static esp_err_t set_sta_config(bool cached_ap)
+{
+	wifi_config_t wifi_config = {
+		.sta = {
+			.scan_method = WIFI_FAST_SCAN,
+			.bssid_set = 0,
+			.channel = 0,
+			.listen_interval = WIFI_PS_LISTEN_INTERVAL,
+			.sort_method = WIFI_CONNECT_AP_BY_SIGNAL			
+		}
+	};	
+    strcpy((char*) wifi_config.sta.ssid, wifi_info.sta_ssid);
+    if (strlen(wifi_info.sta_pw) == 0) {
+        strcpy((char*) wifi_config.sta.password, "");
+    } else {
+    	strcpy((char*) wifi_config.sta.password, wifi_info.sta_pw);
+    }
+    if (cached_ap) {
+    	wifi_config.sta.bssid_set = 1;
+    	memcpy(wifi_config.sta.bssid, sta_ap_bssid, 6);
+    	wifi_config.sta.channel = sta_ap_channel;
+    }
+    sta_cfg_cached = cached_ap;
+    
+    return esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config);
+}
+
+
+/**
+ * Update the connected flag, noting when the connection is lost
+ */
+static void note_connected(bool connected)
+{
+	if (connected) {
+		wifi_info.flags |= WIFI_INFO_FLAG_CONNECTED;
+		down_msec = 0;
+	} else {
+		if (wifi_is_connected()) {
+			down_msec = (uint32_t) (esp_timer_get_time() / 1000);
+			if (down_msec == 0) down_msec = 1;
+		}
+		wifi_info.flags &= ~WIFI_INFO_FLAG_CONNECTED;
+	}
+}
+
+
 /**
  * Handle system events that we care about from the WiFi task
  */
@@ -517,21 +816,23 @@ static esp_err_t sys_event_handler(void *ctx, system_event_t* event)
 {
 	switch(event->event_id) {
 		case SYSTEM_EVENT_AP_STACONNECTED:
-			wifi_info.flags |= WIFI_INFO_FLAG_CONNECTED;
+			note_connected(true);
 			ESP_LOGI(TAG, "station:"MACSTR" join, AID=%d",
                  MAC2STR(event->event_info.sta_connected.mac),
                  event->event_info.sta_connected.aid);
 			break;
 		
 		case SYSTEM_EVENT_AP_STADISCONNECTED:
-			wifi_info.flags &= ~WIFI_INFO_FLAG_CONNECTED;
+			note_connected(false);
 			ESP_LOGI(TAG, "station:"MACSTR" leave, AID=%d",
                  MAC2STR(event->event_info.sta_disconnected.mac),
                  event->event_info.sta_disconnected.aid);
 			break;
 			
 		case SYSTEM_EVENT_STA_START:
-			if (scan_in_progress) {
+			if (ap_plan_busy) {
+				ESP_LOGI(TAG, "Station started for AP channel scan");
+			} else if (scan_in_progress) {
 				ESP_LOGI(TAG, "Station started for scan");
 			} else {
 				ESP_LOGI(TAG, "Station started, trying to connect to %s", wifi_info.sta_ssid);
@@ -544,21 +845,43 @@ static esp_err_t sys_event_handler(void *ctx, system_event_t* event)
         	ESP_LOGI(TAG, "Station stopped");
         	break;
         	
+        case SYSTEM_EVENT_STA_CONNECTED:
+        	// Remember the AP so a reconnect doesn't have to scan for it
+        	memcpy(sta_ap_bssid, event->event_info.connected.bssid, 6);
+        	sta_ap_channel = event->event_info.connected.channel;
+        	sta_ap_cached = true;
+        	ESP_LOGI(TAG, "Associated with "MACSTR" on channel %d", MAC2STR(sta_ap_bssid), sta_ap_channel);
+        	break;
+        	
         case SYSTEM_EVENT_STA_GOT_IP:
-        	wifi_info.flags |= WIFI_INFO_FLAG_CONNECTED;
+        	note_connected(true);
         	uint32_t ip = event->event_info.got_ip.ip_info.ip.addr;
         	ESP_LOGI(TAG, "Connected. Got ip: %s", ip4addr_ntoa(&event->event_info.got_ip.ip_info.ip));
+        	if ((wifi_info.cur_ip_addr[3] != (ip & 0xFF)) || (wifi_info.cur_ip_addr[2] != ((ip >> 8) & 0xFF)) ||
+        	    (wifi_info.cur_ip_addr[1] != ((ip >> 16) & 0xFF)) || (wifi_info.cur_ip_addr[0] != ((ip >> 24) & 0xFF))) {
+        		addr_gen++;
+        	}
         	wifi_info.cur_ip_addr[3] = ip & 0xFF;
         	wifi_info.cur_ip_addr[2] = (ip >> 8) & 0xFF;
         	wifi_info.cur_ip_addr[1] = (ip >> 16) & 0xFF;
 			wifi_info.cur_ip_addr[0] = (ip >> 24) & 0xFF;
 			sta_connected = true;
         	sta_retry_num = 0;
+        	time_start_sync();
         	break;
         	
         case SYSTEM_EVENT_STA_DISCONNECTED:
-        	wifi_info.flags &= ~WIFI_INFO_FLAG_CONNECTED;
-        	if (!scan_in_progress) {
+        	note_connected(false);
+        	if (!scan_in_progress && !ap_plan_busy) {
+        		// Try the last AP on its channel first, then scan for the SSID (the AP
+        		// may be gone or the camera may have to roam to another one)
+        		if (sta_ap_cached && (sta_retry_num < WIFI_CACHED_AP_ATTEMPTS) &&
+        		    (event->event_info.disconnected.reason != WIFI_REASON_NO_AP_FOUND)) {
+        			if (!sta_cfg_cached) (void) set_sta_config(true);
+        		} else if (sta_cfg_cached) {
+        			(void) set_sta_config(false);
+        		}
+        		
         		if (sta_retry_num > WIFI_FAST_RECONNECT_ATTEMPTS) {
         			vTaskDelay(pdMS_TO_TICKS(1000));
         		} else {
@@ -570,9 +893,16 @@ static esp_err_t sys_event_handler(void *ctx, system_event_t* event)
         	break;
         
         case SYSTEM_EVENT_SCAN_DONE:
-        	ESP_LOGI(TAG, "Scan done");
-        	scan_in_progress = false;
-        	got_scan_done_event = true;
+        	if (ap_plan_busy) {
+        		xEventGroupSetBits(wifi_event_group, WIFI_AP_PLAN_SCAN_BIT);
+        	} else if (bg_scan_busy) {
+        		// One channel of a background scan
+        		bg_scan_done = true;
+        	} else {
+        		ESP_LOGI(TAG, "Scan done");
+        		scan_in_progress = false;
+        		got_scan_done_event = true;
+        	}
         	break;
         
 		default:
@@ -581,3 +911,147 @@ static esp_err_t sys_event_handler(void *ctx, system_event_t* event)
 	
 	return ESP_OK;
 }
+
+
+/**
+ * Merge the APs found on one channel of a background scan into ap_info, updating APs
+ * already seen and replacing the weakest AP when it is full
+ */
+static void merge_bg_scan_records()
+{
+	int i, j, weakest;
+	uint16_t number = WIFI_MAX_SCAN_LIST_SIZE;
+	
+	if (esp_wifi_scan_get_ap_records(&number, bg_ap_rec) != ESP_OK) {
+		return;
+	}
+	
+	portENTER_CRITICAL(&bg_scan_mux);
+	for (i=0; i<number; i++) {
+		weakest = 0;
+		for (j=0; j<bg_ap_count; j++) {
+			if (memcmp(ap_info[j].bssid, bg_ap_rec[i].bssid, 6) == 0) break;
+			if (ap_info[j].rssi < ap_info[weakest].rssi) weakest = j;
+		}
+		
+		if (j < bg_ap_count) {
+			ap_info[j] = bg_ap_rec[i];
+		} else if (bg_ap_count < WIFI_MAX_SCAN_LIST_SIZE) {
+			ap_info[bg_ap_count++] = bg_ap_rec[i];
+		} else if (bg_ap_rec[i].rssi > ap_info[weakest].rssi) {
+			ap_info[weakest] = bg_ap_rec[i];
+		}
+	}
+	portEXIT_CRITICAL(&bg_scan_mux);
+}
+
+
+/**
+ * Pick the least congested channel for the AP from a quick scan of every channel.
+ * Each AP heard adds to the score of the channels its signal overlaps (see
+ * WIFI_AP_PLAN_xxx) and the lowest scoring channel the AP may use is picked
+ * (preferring the non-overlapping channels 1, 6 and 11 on a tie).  With
+ * CONFIG_TCAM_AP_HT40 the channel is 40 MHz wide when no AP was heard near it or the
+ * secondary channel.  The channel is left as it was if the scan fails.  WiFi is
+ * stopped on return.
+ */
+static void plan_ap_channel()
+{
+	esp_err_t ret;
+	int c, i, best, weight;
+	int score[WIFI_AP_PLAN_CHANNELS + 1];
+	uint16_t number = WIFI_AP_PLAN_MAX_APS;
+	wifi_ap_record_t* recP;
+	wifi_scan_config_t scan_config = {
+		.ssid = NULL,
+		.bssid = NULL,
+		.channel = 0,
+		.show_hidden = true,
+		.scan_type = WIFI_SCAN_TYPE_ACTIVE,
+		.scan_time.active.min = WIFI_AP_PLAN_DWELL_MSEC,
+		.scan_time.active.max = WIFI_AP_PLAN_DWELL_MSEC
+	};
+	
+	recP = malloc(WIFI_AP_PLAN_MAX_APS * sizeof(wifi_ap_record_t));
+	if (recP == NULL) {
+		ESP_LOGE(TAG, "Could not allocate AP channel scan records");
+		return;
+	}
+	
+	// Scan in STA mode (the event handler doesn't connect while ap_plan_busy is set)
+	ap_plan_busy = true;
+	xEventGroupClearBits(wifi_event_group, WIFI_AP_PLAN_SCAN_BIT);
+	ret = esp_wifi_set_mode(WIFI_MODE_STA);
+	if (ret == ESP_OK) ret = esp_wifi_start();
+	if (ret == ESP_OK) ret = esp_wifi_scan_start(&scan_config, false);
+	if (ret == ESP_OK) {
+		if ((xEventGroupWaitBits(wifi_event_group, WIFI_AP_PLAN_SCAN_BIT, pdTRUE, pdTRUE,
+		                         pdMS_TO_TICKS(WIFI_AP_PLAN_TIMEOUT_MSEC)) & WIFI_AP_PLAN_SCAN_BIT) == 0) {
+			(void) esp_wifi_scan_stop();
+			ret = ESP_ERR_TIMEOUT;
+		}
+	}
+	if (ret == ESP_OK) ret = esp_wifi_scan_get_ap_records(&number, recP);
+	(void) esp_wifi_stop();
+	ap_plan_busy = false;
+	
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "AP channel scan failed (%d), staying on channel %d", ret, ap_channel);
+		free(recP);
+		return;
+	}
+	
+	// Score each channel (HT40 APs also occupy their secondary channel)
+	memset(score, 0, sizeof(score));
+	for (i=0; i<number; i++) {
+		weight = WIFI_AP_PLAN_AP_WEIGHT;
+		if (recP[i].rssi > WIFI_AP_PLAN_MIN_RSSI) {
+			weight += recP[i].rssi - WIFI_AP_PLAN_MIN_RSSI;
+		}
+		add_ap_plan_score(score, recP[i].primary, weight);
+		if (recP[i].second == WIFI_SECOND_CHAN_ABOVE) {
+			add_ap_plan_score(score, recP[i].primary + 4, weight);
+		} else if (recP[i].second == WIFI_SECOND_CHAN_BELOW) {
+			add_ap_plan_score(score, recP[i].primary - 4, weight);
+		}
+	}
+	free(recP);
+	
+	best = 1;
+	if (score[6] < score[best]) best = 6;
+	if (score[11] < score[best]) best = 11;
+	for (c=1; c<=WIFI_AP_PLAN_CHANNELS; c++) {
+		if (score[c] < score[best]) best = c;
+	}
+	ap_channel = best;
+	
+	// A 40 MHz channel only when the band around both halves is clear
+	ap_ht40 = false;
+	ap_second = WIFI_SECOND_CHAN_NONE;
+#ifdef CONFIG_TCAM_AP_HT40
+	c = (best <= WIFI_AP_PLAN_CHANNELS - 4) ? best + 4 : best - 4;
+	if ((score[best] == 0) && (score[c] == 0)) {
+		ap_ht40 = true;
+		ap_second = (c > best) ? WIFI_SECOND_CHAN_ABOVE : WIFI_SECOND_CHAN_BELOW;
+	}
+#endif
+	
+	ESP_LOGI(TAG, "AP channel scan found %u APs, picked channel %d (score %d)", number, best, score[best]);
+}
+
+
+/**
+ * Add the score of an AP whose 20 MHz signal is centered on channel center to the
+ * channels it overlaps (channels 5 or more apart don't overlap)
+ */
+static void add_ap_plan_score(int* score, int center, int weight)
+{
+	int c, d;
+	
+	for (c=1; c<=WIFI_AP_PLAN_CHANNELS; c++) {
+		d = abs(c - center);
+		if (d < 5) {
+			score[c] += weight * (5 - d) / 5;
+		}
+	}
+}
@@ -44,9 +44,35 @@
 // Maximum attempts to reconnect to an AP in client mode before starting to wait
 #define WIFI_FAST_RECONNECT_ATTEMPTS   5
 
+// Attempts to rejoin the last AP directly on its BSSID and channel (without scanning for
+// the SSID) after the connection is lost before scanning all channels again
+#define WIFI_CACHED_AP_ATTEMPTS        2
+
 // Maximum number of AP stations to record when scanning
 #define WIFI_MAX_SCAN_LIST_SIZE       10
 
+// Background scan (see wifi_start_bg_scan) - channels scanned and the time spent
+// listening on each.  WIFI_BG_SCAN_SLOT_USEC is the gap in traffic one channel scan
+// needs, including leaving and returning to the AP's channel.
+#define WIFI_BG_SCAN_CHANNELS         13
+#define WIFI_BG_SCAN_DWELL_MSEC       30
+#define WIFI_BG_SCAN_SLOT_USEC        60000
+
+// AP channel planner (see wifi_replan_ap_channel) - channels the AP may use (allowed
+// in every region), the time spent listening on each channel of its scan, the time
+// allowed for the whole scan and the most APs it scores.  Each AP heard adds
+// WIFI_AP_PLAN_AP_WEIGHT plus its RSSI above WIFI_AP_PLAN_MIN_RSSI to the channels
+// its 20 MHz signal overlaps (within 4 channels), scaled by how much they overlap.
+#define WIFI_AP_PLAN_CHANNELS         11
+#define WIFI_AP_PLAN_DWELL_MSEC       50
+#define WIFI_AP_PLAN_TIMEOUT_MSEC     2000
+#define WIFI_AP_PLAN_MAX_APS          32
+#define WIFI_AP_PLAN_AP_WEIGHT        20
+#define WIFI_AP_PLAN_MIN_RSSI         -100
+
+// Beacon intervals the station sleeps between beacons in WIFI_PS_MAX_MODEM
+#define WIFI_PS_LISTEN_INTERVAL       10
+
 
 //
 // WiFi Utilities Data structures
@@ -72,8 +98,18 @@ bool wifi_reinit();
 bool wifi_setup_scan();
 void wifi_stop_scan();
 bool wifi_is_connected();
+uint32_t wifi_get_down_msec();
+uint32_t wifi_get_addr_gen();
 bool wifi_scan_is_complete();
 int wifi_get_scan_records(wifi_ap_record_t **ap);
+bool wifi_start_bg_scan();
+int wifi_get_bg_scan_channel();
+void wifi_bg_scan_service(bool gap);
 wifi_info_t* wifi_get_info();
+void wifi_set_power_save(wifi_ps_type_t ps);
+bool wifi_replan_ap_channel();
+int wifi_get_ap_channel();
+bool wifi_get_ap_ht40();
+bool wifi_get_rssi(int* rssi);
 
 #endif /* WIFI_UTILITIES_H */
\ No newline at end of file
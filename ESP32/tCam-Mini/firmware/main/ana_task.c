@@ -0,0 +1,621 @@
+/*
+ * Analytics Task
+ *
+ * Compute radiometric statistics on the camera.  Frames are taken from the frame broker
+ * while a client is streaming stats and each region of interest is scanned once for
+ * its minimum, maximum, mean and hottest pixel.  Alarm thresholds are checked every
+ * frame and an event is sent to the streaming clients when an alarm is raised or
+ * cleared.  Stats messages are sent at each client's stream rate.  Messages are
+ * compact json objects sent like command responses.  Frames are also analyzed when
+ * now_task is due to send a stats message over ESP-NOW.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "ana_task.h"
+#include "frame_utilities.h"
+#include "json_utilities.h"
+#include "lepton_utilities.h"
+#include "now_task.h"
+#include "rsp_task.h"
+#include "sys_utilities.h"
+#include "system_config.h"
+#include "vospi.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+
+
+//
+// ANA Task typedefs
+//
+
+// Columns c1 to c1+n-1 of a row belong to region roi
+typedef struct {
+	uint8_t roi;
+	uint8_t c1;
+	uint16_t n;
+} ana_span_t;
+
+// Running statistics of a region during a frame
+typedef struct {
+	uint32_t min;
+	uint32_t max;
+	uint32_t sum;
+	uint16_t* hotP;
+} ana_acc_t;
+
+// Stats stream state for each client
+typedef struct {
+	bool stream_on;
+	uint32_t delay_usec;
+	uint32_t num_frames;
+	uint32_t remaining_frames;
+	int64_t ready_usec;
+	bool dump_on_alarm;          // Send the client the history when an alarm is raised
+} ana_client_t;
+
+
+
+//
+// ANA Task variables
+//
+static const char* TAG = "ana_task";
+
+// Configuration and clients (shared with cmd_task)
+static SemaphoreHandle_t ana_mutex;
+static ana_config_t ana_config;
+static bool ana_config_changed;
+static ana_client_t ana_clients[CMD_MAX_CLIENTS];
+
+// Analysis of the current frame (alarms persist between frames)
+static ana_config_t cur_config;
+static ana_stats_t ana_stats;
+
+// Row span table for cur_config.  The spans of row r are row_span[r] up to
+// row_span[r+1].  roi_pixels holds the number of pixels in each region.
+static ana_span_t* spans;
+static uint16_t row_span[LEP_HEIGHT + 1];
+static uint32_t roi_pixels[ANA_MAX_ROIS];
+
+// Message text
+static char ana_text[JSON_MAX_RSP_TEXT_LEN];
+
+// Frame broker subscriber id
+static int frame_sub;
+
+
+
+//
+// ANA Task Forward Declarations for internal functions
+//
+static bool update_config();
+static int build_spans(ana_config_t* cfg, bool load);
+static int roi_row_spans(ana_roi_t* rP, int r, int* c1, int* c2);
+static void analyze_frame(lep_buffer_t* lep_bufP);
+static void scan_span(uint16_t* p, int n, ana_acc_t* aP);
+static void check_alarms();
+static void send_event(int roi, int alarm, bool active, uint32_t value);
+static void send_stats();
+
+
+
+//
+// ANA Task API
+//
+
+/**
+ * Initialize the analytics state.  Called before the tasks are started.  The
+ * default configuration is one region covering the whole frame without alarms.
+ */
+bool ana_init()
+{
+	ana_mutex = xSemaphoreCreateMutex();
+	if (ana_mutex == NULL) {
+		ESP_LOGE(TAG, "create analytics mutex failed");
+		return false;
+	}
+
+	// The span table is read for every pixel analyzed
+	spans = system_buffer_alloc("ana spans", 0, ANA_MAX_SPANS * sizeof(ana_span_t), SYS_BUF_INTERNAL);
+	if (spans == NULL) {
+		ESP_LOGE(TAG, "malloc span table failed");
+		return false;
+	}
+
+	memset(ana_clients, 0, sizeof(ana_clients));
+	memset(&ana_config, 0, sizeof(ana_config_t));
+	ana_config.num_rois = 1;
+	ana_config.roi[0].r2 = LEP_HEIGHT - 1;
+	ana_config.roi[0].c2 = LEP_WIDTH - 1;
+	ana_config.hysteresis = ANA_DEF_HYSTERESIS;
+	ana_config_changed = true;
+
+	return true;
+}
+
+
+void ana_task()
+{
+	uint32_t notification_value;
+	uint32_t missed;
+	lep_buffer_t* lep_bufP;
+
+	ESP_LOGI(TAG, "Start task");
+
+	frame_sub = frame_subscribe(xTaskGetCurrentTaskHandle(), ANA_NOTIFY_LEP_FRAME_MASK);
+
+	while (1) {
+		notification_value = 0;
+		if (xTaskNotifyWait(0x00, 0xFFFFFFFF, &notification_value, pdMS_TO_TICKS(ANA_TASK_MAX_WAIT_MSEC))) {
+			// Handle lep_task notifications
+			if (Notification(notification_value, ANA_NOTIFY_LEP_FRAME_MASK)) {
+				if (update_config()) {
+					lep_bufP = frame_acquire(frame_sub, &missed);
+					if (lep_bufP != NULL) {
+						analyze_frame(lep_bufP);
+						frame_release(lep_bufP);
+
+						xSemaphoreTake(ana_mutex, portMAX_DELAY);
+						check_alarms();
+						send_stats();
+						xSemaphoreGive(ana_mutex);
+					}
+				} else {
+					(void) frame_skip(frame_sub);
+				}
+			}
+		}
+	}
+}
+
+
+// Called by cmd_task to set the regions and alarms (clears active alarms).  Returns
+// false if the regions need more than ANA_MAX_SPANS row spans.
+bool ana_set_config(ana_config_t* cfg)
+{
+	if (build_spans(cfg, false) > ANA_MAX_SPANS) {
+		ESP_LOGE(TAG, "Regions need more than %d spans", ANA_MAX_SPANS);
+		return false;
+	}
+
+	xSemaphoreTake(ana_mutex, portMAX_DELAY);
+	ana_config = *cfg;
+	ana_config_changed = true;
+	xSemaphoreGive(ana_mutex);
+
+	return true;
+}
+
+
+// Called by cmd_task to start streaming stats to a client.  A stats message is sent
+// every delay_ms (0 for every frame), num_frames times (0 for continuous).
+void ana_stream_on(int client, uint32_t delay_ms, uint32_t num_frames)
+{
+	ana_client_t* c;
+
+	if ((client < 0) || (client >= CMD_MAX_CLIENTS)) return;
+	c = &ana_clients[client];
+
+	xSemaphoreTake(ana_mutex, portMAX_DELAY);
+	c->delay_usec = delay_ms * 1000;
+	c->num_frames = num_frames;
+	c->remaining_frames = num_frames;
+	c->ready_usec = esp_timer_get_time();
+	c->stream_on = true;
+	xSemaphoreGive(ana_mutex);
+}
+
+
+// Called by cmd_task to stop streaming stats to a client (and when it disconnects)
+void ana_stream_off(int client)
+{
+	if ((client < 0) || (client >= CMD_MAX_CLIENTS)) return;
+
+	xSemaphoreTake(ana_mutex, portMAX_DELAY);
+	ana_clients[client].stream_on = false;
+	xSemaphoreGive(ana_mutex);
+}
+
+
+// Called by cmd_task to have the history ring dumped to a client each time an alarm
+// is raised.  Frames are analyzed while any client is armed even if it isn't streaming
+// stats.
+void ana_set_alarm_dump(int client, bool en)
+{
+	if ((client < 0) || (client >= CMD_MAX_CLIENTS)) return;
+
+	xSemaphoreTake(ana_mutex, portMAX_DELAY);
+	ana_clients[client].dump_on_alarm = en;
+	xSemaphoreGive(ana_mutex);
+}
+
+
+
+//
+// ANA Task internal functions
+//
+
+/**
+ * Take a new configuration and return true if any client is streaming stats or
+ * waiting for alarms to dump the history or an ESP-NOW stats message is due
+ */
+static bool update_config()
+{
+	int i;
+	bool streaming = false;
+
+	xSemaphoreTake(ana_mutex, portMAX_DELAY);
+	if (ana_config_changed) {
+		cur_config = ana_config;
+		(void) build_spans(&cur_config, true);
+		ana_config_changed = false;
+		for (i=0; i<ANA_MAX_ROIS; i++) {
+			ana_stats.roi[i].alarms = 0;
+		}
+	}
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (ana_clients[i].stream_on || ana_clients[i].dump_on_alarm) streaming = true;
+	}
+	if (now_stats_due()) streaming = true;
+	xSemaphoreGive(ana_mutex);
+
+	return streaming;
+}
+
+
+/**
+ * Count the row spans of a configuration and, if load is set and they fit, load the
+ * span table and pixel counts.  Returns the number of spans.
+ */
+static int build_spans(ana_config_t* cfg, bool load)
+{
+	int c1[ANA_MAX_POINTS/2];
+	int c2[ANA_MAX_POINTS/2];
+	int i, j, n, r;
+	int num_spans = 0;
+	ana_span_t* sP;
+
+	if (load) {
+		for (i=0; i<ANA_MAX_ROIS; i++) roi_pixels[i] = 0;
+	}
+
+	// Spans are ordered by row so a frame is scanned from top to bottom
+	for (r=0; r<LEP_HEIGHT; r++) {
+		if (load) row_span[r] = num_spans;
+		for (i=0; i<cfg->num_rois; i++) {
+			n = roi_row_spans(&cfg->roi[i], r, c1, c2);
+			for (j=0; j<n; j++) {
+				if (load && (num_spans < ANA_MAX_SPANS)) {
+					sP = &spans[num_spans];
+					sP->roi = i;
+					sP->c1 = c1[j];
+					sP->n = c2[j] - c1[j] + 1;
+					roi_pixels[i] += sP->n;
+				}
+				num_spans++;
+			}
+		}
+	}
+	if (load) {
+		row_span[LEP_HEIGHT] = (num_spans < ANA_MAX_SPANS) ? num_spans : ANA_MAX_SPANS;
+	}
+
+	return num_spans;
+}
+
+
+/**
+ * Find the spans of a region in row r.  A polygon includes the pixels whose centers
+ * are within half a pixel of its inside along the row (sampled at the row center, or
+ * just inside the last row).  Returns the number of spans loaded into c1 and c2.
+ */
+static int roi_row_spans(ana_roi_t* rP, int r, int* c1, int* c2)
+{
+	float x[ANA_MAX_POINTS];
+	float t, y;
+	float r0, r1;
+	int i, j, n, num_x;
+	int rmin = LEP_HEIGHT;
+	int rmax = -1;
+
+	if (rP->num_points < 3) {
+		if ((r < rP->r1) || (r > rP->r2)) return 0;
+		c1[0] = rP->c1;
+		c2[0] = rP->c2;
+		return 1;
+	}
+
+	for (i=0; i<rP->num_points; i++) {
+		if (rP->points[i][0] < rmin) rmin = rP->points[i][0];
+		if (rP->points[i][0] > rmax) rmax = rP->points[i][0];
+	}
+	if ((r < rmin) || (r > rmax)) return 0;
+	y = (r == rmax) ? (r - 0.01f) : r;
+
+	// Sorted crossings of the row with the (half-open) edges
+	num_x = 0;
+	for (i=0; i<rP->num_points; i++) {
+		j = (i + 1) % rP->num_points;
+		r0 = rP->points[i][0];
+		r1 = rP->points[j][0];
+		if (((r0 <= y) && (y < r1)) || ((r1 <= y) && (y < r0))) {
+			t = rP->points[i][1] + (y - r0) * (rP->points[j][1] - rP->points[i][1]) / (r1 - r0);
+			for (n=num_x; (n > 0) && (x[n-1] > t); n--) x[n] = x[n-1];
+			x[n] = t;
+			num_x++;
+		}
+	}
+
+	// Pairs of crossings bound the inside, merging spans that meet after rounding
+	n = 0;
+	for (i=0; (i+1)<num_x; i+=2) {
+		j = (int) (x[i] + 0.5f);
+		if ((n != 0) && (j <= (c2[n-1] + 1))) {
+			c2[n-1] = (int) (x[i+1] + 0.5f);
+		} else {
+			c1[n] = j;
+			c2[n] = (int) (x[i+1] + 0.5f);
+			n++;
+		}
+	}
+
+	for (i=0; i<n; i++) {
+		if (c1[i] < 0) c1[i] = 0;
+		if (c2[i] > (LEP_WIDTH - 1)) c2[i] = LEP_WIDTH - 1;
+	}
+
+	return n;
+}
+
+
+/**
+ * Compute the statistics of every region in one pass down a frame
+ */
+static void analyze_frame(lep_buffer_t* lep_bufP)
+{
+	int i, r;
+	uint32_t off;
+	uint32_t scale = LEP_TLIN_SCALE_0_01K;
+	uint16_t* imgP = lep_bufP->lep_bufferP;
+	uint16_t* telP = lep_bufP->lep_telemP;
+	ana_acc_t acc[ANA_MAX_ROIS];
+	ana_span_t* sP;
+	ana_roi_stats_t* rsP;
+
+	if (lep_bufP->telem_valid) {
+		ana_stats.frame = telP[LEP_TEL_FC_LOW] | (telP[LEP_TEL_FC_HIGH] << 16);
+		ana_stats.radiometric = (telP[LEP_TEL_TLIN_ENABLE] != 0);
+		if (ana_stats.radiometric) {
+			scale = lepton_tel_tlin_scale(telP);
+		}
+	} else {
+		ana_stats.frame = 0;
+		ana_stats.radiometric = !system_get_lep_st()->agc_set_enabled;
+	}
+
+	for (i=0; i<cur_config.num_rois; i++) {
+		acc[i].min = 0xFFFF;
+		acc[i].max = 0;
+		acc[i].sum = 0;
+		acc[i].hotP = imgP;
+	}
+
+	// Overlapping regions read the same row again while it is still in the cache
+	for (r=0; r<LEP_HEIGHT; r++) {
+		for (i=row_span[r]; i<row_span[r+1]; i++) {
+			sP = &spans[i];
+			scan_span(imgP + r*LEP_WIDTH + sP->c1, sP->n, &acc[sP->roi]);
+		}
+	}
+
+	ana_stats.num_rois = cur_config.num_rois;
+	for (i=0; i<cur_config.num_rois; i++) {
+		rsP = &ana_stats.roi[i];
+		if (roi_pixels[i] == 0) {
+			rsP->min = 0;
+			rsP->max = 0;
+			rsP->mean = 0;
+			rsP->hot_r = 0;
+			rsP->hot_c = 0;
+			continue;
+		}
+		off = acc[i].hotP - imgP;
+		rsP->hot_r = off / LEP_WIDTH;
+		rsP->hot_c = off % LEP_WIDTH;
+		rsP->min = acc[i].min * scale;
+		rsP->max = acc[i].max * scale;
+		rsP->mean = (acc[i].sum / roi_pixels[i]) * scale;
+	}
+}
+
+
+/**
+ * Add n pixels starting at p to a region's statistics.  Pixels are read in pairs
+ * from aligned 32-bit words to halve the (usually PSRAM) reads.
+ */
+static void scan_span(uint16_t* p, int n, ana_acc_t* aP)
+{
+	uint32_t* wP;
+	uint32_t a, b, v;
+	uint32_t min = aP->min;
+	uint32_t max = aP->max;
+	uint32_t sum = aP->sum;
+	uint16_t* hotP = aP->hotP;
+
+	// Leading pixel that isn't word aligned
+	if ((((uint32_t) p) & 0x2) != 0) {
+		a = *p;
+		sum += a;
+		if (a < min) min = a;
+		if (a > max) {max = a; hotP = p;}
+		p++;
+		n--;
+	}
+
+	wP = (uint32_t*) p;
+	while (n >= 2) {
+		v = *wP;
+		a = v & 0xFFFF;          // Little-endian: first pixel in the low half
+		b = v >> 16;
+		sum += a + b;
+		if (a < min) min = a;
+		if (b < min) min = b;
+		if (a > max) {max = a; hotP = (uint16_t*) wP;}
+		if (b > max) {max = b; hotP = ((uint16_t*) wP) + 1;}
+		wP++;
+		n -= 2;
+	}
+
+	// Trailing pixel
+	if (n > 0) {
+		p = (uint16_t*) wP;
+		a = *p;
+		sum += a;
+		if (a < min) min = a;
+		if (a > max) {max = a; hotP = p;}
+	}
+
+	aP->min = min;
+	aP->max = max;
+	aP->sum = sum;
+	aP->hotP = hotP;
+}
+
+
+/**
+ * Raise and clear the alarms of each region, sending an event for each change.  Called
+ * holding ana_mutex.
+ */
+static void check_alarms()
+{
+	int i;
+	ana_roi_t* rP;
+	ana_roi_stats_t* sP;
+	uint32_t hys = cur_config.hysteresis;
+
+	for (i=0; i<ana_stats.num_rois; i++) {
+		rP = &cur_config.roi[i];
+		sP = &ana_stats.roi[i];
+
+		if (!ana_stats.radiometric || (roi_pixels[i] == 0)) {
+			// Thresholds are meaningless for AGC images and empty regions
+			sP->alarms = 0;
+			continue;
+		}
+
+		if (rP->high != 0) {
+			if (((sP->alarms & ANA_ALARM_HIGH) == 0) && (sP->max > rP->high)) {
+				sP->alarms |= ANA_ALARM_HIGH;
+				send_event(i, ANA_ALARM_HIGH, true, sP->max);
+			} else if (((sP->alarms & ANA_ALARM_HIGH) != 0) && ((sP->max + hys) < rP->high)) {
+				sP->alarms &= ~ANA_ALARM_HIGH;
+				send_event(i, ANA_ALARM_HIGH, false, sP->max);
+			}
+		}
+
+		if (rP->low != 0) {
+			if (((sP->alarms & ANA_ALARM_LOW) == 0) && (sP->min < rP->low)) {
+				sP->alarms |= ANA_ALARM_LOW;
+				send_event(i, ANA_ALARM_LOW, true, sP->min);
+			} else if (((sP->alarms & ANA_ALARM_LOW) != 0) && (sP->min > (rP->low + hys))) {
+				sP->alarms &= ~ANA_ALARM_LOW;
+				send_event(i, ANA_ALARM_LOW, false, sP->min);
+			}
+		}
+	}
+}
+
+
+/**
+ * Send an alarm event to every client streaming stats and start a history dump to the
+ * clients armed for a raised alarm.  Called holding ana_mutex.
+ */
+static void send_event(int roi, int alarm, bool active, uint32_t value)
+{
+	int i;
+	uint32_t len;
+
+	len = json_get_ana_event(ana_text, sizeof(ana_text), ana_stats.frame, roi, alarm, active, value);
+	if (len == 0) return;
+
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (ana_clients[i].stream_on) {
+			rsp_push_response(i, ana_text, len);
+		}
+		if (active && ana_clients[i].dump_on_alarm) {
+			rsp_dump_history(i);
+		}
+	}
+}
+
+
+/**
+ * Send the statistics to each client whose next stats message is due and to now_task
+ * if its message is due.  Called holding ana_mutex.
+ */
+static void send_stats()
+{
+	int i;
+	int64_t cur_usec;
+	uint32_t len = 0;
+	ana_client_t* c;
+
+	cur_usec = esp_timer_get_time();
+
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		c = &ana_clients[i];
+		if (!c->stream_on) continue;
+
+		if (c->delay_usec != 0) {
+			if (cur_usec < c->ready_usec) continue;
+
+			// Don't let the schedule fall behind
+			c->ready_usec += c->delay_usec;
+			if (c->ready_usec < cur_usec) {
+				c->ready_usec = cur_usec + c->delay_usec;
+			}
+		}
+
+		// Only generate the message text once per frame
+		if (len == 0) {
+			len = json_get_ana_stats(ana_text, sizeof(ana_text), &ana_stats);
+			if (len == 0) return;
+		}
+		rsp_push_response(i, ana_text, len);
+
+		if (c->num_frames != 0) {
+			if (--c->remaining_frames == 0) {
+				c->stream_on = false;
+			}
+		}
+	}
+
+	if (now_stats_due()) {
+		if (len == 0) {
+			len = json_get_ana_stats(ana_text, sizeof(ana_text), &ana_stats);
+			if (len == 0) return;
+		}
+		now_push_stats(ana_text, len);
+	}
+}
@@ -0,0 +1,121 @@
+/*
+ * Analytics Task
+ *
+ * Compute radiometric statistics on the camera so a client can receive compact stats
+ * and alarm messages instead of images.  Each frame is analyzed while at least one
+ * client is streaming stats.  For each region of interest the minimum, maximum and
+ * mean temperature and the location of the hottest pixel are found and optional high
+ * and low alarm thresholds are checked.
+ *
+ * Regions are rectangles or polygons.  They are converted into a table of the column
+ * spans each region covers in each row when the configuration is set so all regions
+ * are computed in one pass down the frame.
+ *
+ * Temperatures are in units of K * 100 (the Lepton's TLinear units at 0.01 K
+ * resolution) independent of the Lepton's TLinear resolution.  Values are Lepton
+ * pixel counts and alarms are not checked when TLinear is disabled (AGC enabled).
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef ANA_TASK_H
+#define ANA_TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//
+// ANA Task Constants
+//
+
+// Maximum time to block waiting for a notification
+#define ANA_TASK_MAX_WAIT_MSEC 1000
+
+// Maximum number of regions of interest
+#define ANA_MAX_ROIS 16
+
+// Maximum number of polygon vertices
+#define ANA_MAX_POINTS 8
+
+// Size of the row span table (a rectangle uses one span for each of its rows and a
+// polygon up to ANA_MAX_POINTS/2)
+#define ANA_MAX_SPANS 2048
+
+// Default alarm hysteresis (K * 100) - an alarm clears once the temperature is this
+// far back inside its threshold
+#define ANA_DEF_HYSTERESIS 50
+
+// Alarm bits (ana_roi_stats_t alarms)
+#define ANA_ALARM_HIGH 0x01
+#define ANA_ALARM_LOW  0x02
+
+// Analytics Task notifications
+#define ANA_NOTIFY_LEP_FRAME_MASK  0x00000010
+
+
+
+//
+// ANA Task typedefs
+//
+typedef struct {
+	uint16_t r1;                 // Rectangle (inclusive, like the spotmeter)
+	uint16_t c1;
+	uint16_t r2;
+	uint16_t c2;
+	int num_points;              // Polygon instead of the rectangle when 3 or more
+	uint8_t points[ANA_MAX_POINTS][2];  // Polygon vertices (row, column)
+	uint32_t high;               // Alarm when the maximum exceeds this (0 = off)
+	uint32_t low;                // Alarm when the minimum falls below this (0 = off)
+} ana_roi_t;
+
+typedef struct {
+	int num_rois;
+	ana_roi_t roi[ANA_MAX_ROIS];
+	uint32_t hysteresis;
+} ana_config_t;
+
+typedef struct {
+	uint32_t min;
+	uint32_t max;
+	uint32_t mean;
+	uint16_t hot_r;              // Location of the (first) hottest pixel
+	uint16_t hot_c;
+	uint8_t alarms;              // ANA_ALARM_xxx bits currently active
+} ana_roi_stats_t;
+
+typedef struct {
+	uint32_t frame;              // Lepton frame counter (0 without telemetry)
+	bool radiometric;            // Values are K * 100
+	int num_rois;
+	ana_roi_stats_t roi[ANA_MAX_ROIS];
+} ana_stats_t;
+
+
+
+//
+// ANA Task API
+//
+bool ana_init();
+void ana_task();
+bool ana_set_config(ana_config_t* cfg);
+void ana_stream_on(int client, uint32_t delay_ms, uint32_t num_frames);
+void ana_stream_off(int client);
+void ana_set_alarm_dump(int client, bool en);
+
+#endif /* ANA_TASK_H */
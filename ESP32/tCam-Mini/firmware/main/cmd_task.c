@@ -3,6 +3,22 @@
  *
  * Implement the command processing module including management of the WiFi interface.
  *
+ * Clients connect to the command port or to the HTTP endpoints (see http_utilities.h).
+ * HTTP requests are received in the client's command buffer.  The mjpeg and WebSocket
+ * endpoints send their response header before the connection is handed to rsp_task
+ * and REST requests are executed like a command received on the command port.
+ *
+ * A batch command executes several commands and combines their responses into one
+ * response.  Clients that subscribe to status are pushed compact status periodically
+ * and/or when the cached Lepton or adaptive stream state changes instead of polling
+ * get_status.
+ *
+ * A peer that vanished without closing its connection (a phone that went to sleep, a
+ * NAT entry that timed out) is found by TCP keepalive while the connection is idle and
+ * by rsp_task when its sends stop making progress.  With CMD_CLIENT_TAKEOVER a new
+ * connection that finds every client slot in use takes over the quietest one instead
+ * of being refused.
+ *
  * Copyright 2020-2021 Dan Julio
  *
  * This file is part of tCam.
@@ -22,17 +38,29 @@
  *
  */
 #include "cmd_task.h"
+#include "ana_task.h"
 #include "ctrl_task.h"
+#include "hist_task.h"
+#include "lep_task.h"
+#include "mon_task.h"
+#include "now_task.h"
+#include "rec_task.h"
 #include "rsp_task.h"
+#include "http_utilities.h"
 #include "json_utilities.h"
+#include "evlog_utilities.h"
 #include "lepton_utilities.h"
+#include "ota_utilities.h"
+#include "palette_utilities.h"
 #include "ps_utilities.h"
 #include "sys_utilities.h"
 #include "time_utilities.h"
 #include "wifi_utilities.h"
 #include "system_config.h"
+#include "vospi.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
@@ -40,41 +68,163 @@
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
 #include <lwip/netdb.h>
+#include <stdlib.h>
+#include <string.h>
+
+//
+// CMD Task constants
+//
+
+// Client states
+#define CMD_CLIENT_FREE    0
+#define CMD_CLIENT_ACTIVE  1
+#define CMD_CLIENT_CLOSING 2     // Waiting for rsp_task to close the socket
+
+// Client protocols
+#define CMD_PROTO_SOCKET    0    // Delimited json commands on CMD_PORT
+#define CMD_PROTO_HTTP      1    // Receiving an HTTP request on HTTP_PORT
+#define CMD_PROTO_WS        2    // WebSocket text messages with json commands
+#define CMD_PROTO_HTTP_DONE 3    // HTTP request handled (anything received is discarded)
+#define CMD_PROTO_OTA       4    // Receiving a firmware image for /ota
+
+
+
+//
+// CMD Task typedefs
+//
+
+// State reported in a pushed status a change of which pushes a new one
+typedef struct {
+	bool tel_valid;
+	uint8_t ffc_state;
+	uint16_t gain_mode;
+	bool tlin_enabled;
+	uint16_t fpa_t_k100;
+	uint16_t aux_t_k100;
+	uint32_t adapt_target_ms;
+	int adapt_level;
+} cmd_status_key_t;
+
+typedef struct {
+	int state;
+	int sock;
+	int proto;
+	bool rsp_connected;     // Set once the connection has been handed to rsp_task
+	bool local;             // Connected over the loopback interface (ser_task)
+	bool stalled;           // Set by rsp_task when sends to the client stopped making progress
+	int64_t rx_usec;        // When data was last received (a takeover picks the oldest)
+
+	// Command being received (without delimitors), cmd_len is -1 between commands.
+	// Also holds an HTTP request as it is received.
+	char cmd_text[JSON_MAX_CMD_TEXT_LEN];
+	int cmd_len;
+	bool cmd_overflow;
+	
+	// WebSocket frame being received
+	bool ws_in_payload;
+	uint8_t ws_hdr[WS_MAX_RX_HEADER_LEN];
+	int ws_hdr_len;
+	ws_frame_t ws_frame;
+	uint32_t ws_remaining;
+	uint32_t ws_index;
+	
+	// Status subscription
+	uint32_t status_interval_ms;   // Time between periodic status pushes (0 = none)
+	bool status_on_change;         // Push status when it changes
+	bool status_metrics;           // Follow each status push with the metrics
+	int64_t status_next_usec;      // Time of the next periodic push
+	int64_t status_last_usec;      // Time of the last push
+	cmd_status_key_t status_key;   // State in the last push
+} cmd_client_t;
+
+
 
 //
 // CMD Task variables
 //
 static const char* TAG = "cmd_task";
 
-// Client socket
-static int client_sock = -1;
+// Clients (state is also written by rsp_task when it closes a client)
+static cmd_client_t clients[CMD_MAX_CLIENTS];
 
-// Connected status
-static bool connected = false;
+// Client whose command is being processed
+static int cur_client;
 
-// Main receive buffer for incoming packets
-static char rx_circular_buffer[CMD_MAX_TCP_RX_BUFFER_LEN];
-static int rx_circular_push_index;
-static int rx_circular_pop_index;
+// Set when the command pushed a response
+static bool rsp_pushed;
 
-// json command string buffer
-static char json_cmd_string[JSON_MAX_CMD_TEXT_LEN];
+// Set while the commands in a batch are executed so their responses are combined
+static bool batching;
+
+// Client sending a firmware update (-1 if none)
+static int ota_client = -1;
+
+// WiFi address generation the clients connected with
+static uint32_t client_addr_gen;
+
+// New connection waiting for the client it took over to be closed (-1 if none)
+static int takeover_sock = -1;
+static int takeover_proto;
+static bool takeover_local;
 
 
 //
 // CMD Task Forward Declarations for internal functions
 //
-static void init_command_processor();
-static void push_rx_data(char* data, int len);
-static bool process_rx_data();
-static void process_rx_packet();
+static int open_listen_socket(uint16_t port);
+static void init_command_processor(int client);
+static void accept_client(int listen_sock, int proto);
+static bool install_client(int sock, int proto, bool local);
+static void set_keepalive(int sock);
+static bool start_takeover(int sock, int proto, bool local);
+static void service_takeover();
+static void close_client(int client);
+static void check_stalled();
+static bool handle_client_rx(int client);
+static bool receive_ota(int client);
+static void check_wifi();
+static void process_rx_data(cmd_client_t* c, char* data, int len);
+static void process_http_data(int client, char* data, int len);
+static void start_ws(int client, http_request_t* req);
+static void start_mjpeg(int client, http_request_t* req);
+static void process_rest(int client, http_request_t* req, int header_len);
+static void start_ota(int client, http_request_t* req, int header_len);
+static void service_ota();
+static void http_reply(int client, int status);
+static bool send_http(int sock, char* buf, int len);
+static bool process_ws_data(cmd_client_t* c, char* data, int len);
+static bool process_rx_packet(char* cmd_string, int len);
+static void process_cmd(int cmd, cJSON* cmd_args, char* cmd_string);
+static bool cmd_needs_stream(int cmd);
 static void push_response(char* buf, uint32_t len);
+static void push_batch();
+static void process_get_image(cJSON* cmd_args);
 static void process_set_config(cJSON* cmd_args);
 static void process_set_spotmeter(cJSON* cmd_args);
 static void process_stream_on(cJSON* cmd_args);
 static void process_set_time(cJSON* cmd_args);
 static void process_set_wifi(cJSON* cmd_args);
-static int in_buffer(char c);
+static void process_set_image_format(cJSON* cmd_args);
+static void process_record_on(cJSON* cmd_args);
+static void process_get_record(cJSON* cmd_args);
+static void process_get_log(cJSON* cmd_args);
+static void process_burst_capture(cJSON* cmd_args);
+static void process_set_interval_capture(cJSON* cmd_args);
+static void process_get_sys_stats(cJSON* cmd_args);
+static void process_set_analytics(cJSON* cmd_args);
+static void process_set_history(cJSON* cmd_args);
+static void process_dump_history(cJSON* cmd_args);
+static void process_set_espnow(cJSON* cmd_args);
+static void process_set_lepton(cJSON* cmd_args);
+static void process_set_ffc(cJSON* cmd_args);
+static void process_scan_wifi(cJSON* cmd_args);
+static void process_batch(cJSON* cmd_args, char* cmd_string);
+static void process_subscribe_status(cJSON* cmd_args);
+static bool status_subscribed();
+static void service_status();
+static void push_status(int client, int64_t t);
+static void get_status_key(int client, rsp_adapt_status_t* adapt, cmd_status_key_t* key);
+static bool status_changed(const cmd_status_key_t* prev, const cmd_status_key_t* cur);
 
 
 
@@ -83,108 +233,91 @@ static int in_buffer(char c);
 //
 void cmd_task()
 {
-	char rx_buffer[128];
-    char addr_str[16];
     int err;
-    int flag;
-    int len;
+    int i;
     int listen_sock;
-    struct sockaddr_in destAddr;
-    struct sockaddr_in sourceAddr;
-    uint32_t addrLen;
-    
+    int http_listen_sock;
+    int max_sock;
+    fd_set rx_fds;
+    struct timeval rx_timeout;
+
 	ESP_LOGI(TAG, "Start task");
-	
-	// Loop to setup socket, wait for connection, handle connection.  Terminates
-	// when client disconnects
-	
+
+	// Setup socket then loop waiting for connections and handling connected clients
+
 	// Wait until WiFi is connected
 	if (!wifi_is_connected()) {
 		vTaskDelay(pdMS_TO_TICKS(500));
 	}
 
-	// Config IPV4
-    destAddr.sin_addr.s_addr = htonl(INADDR_ANY);
-    destAddr.sin_family = AF_INET;
-    destAddr.sin_port = htons(CMD_PORT);
-    inet_ntoa_r(destAddr.sin_addr, addr_str, sizeof(addr_str) - 1);
-        
-    // socket - bind - listen - accept
-    listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
-    if (listen_sock < 0) {
-        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
-        goto error;
-    }
-    ESP_LOGI(TAG, "Socket created");
+	// Command port and HTTP endpoints
+	listen_sock = open_listen_socket(CMD_PORT);
+	if (listen_sock < 0) goto error;
+	http_listen_sock = open_listen_socket(HTTP_PORT);
+	if (http_listen_sock < 0) goto error;
 
-	flag = 1;
-  	setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
-    err = bind(listen_sock, (struct sockaddr *)&destAddr, sizeof(destAddr));
-    if (err != 0) {
-        ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
-         goto error;
+    for (i=0; i<CMD_MAX_CLIENTS; i++) {
+    	clients[i].state = CMD_CLIENT_FREE;
+    	clients[i].sock = -1;
     }
-    ESP_LOGI(TAG, "Socket bound");
-    
+    client_addr_gen = wifi_get_addr_gen();
+
 	while (1) {
-		init_command_processor();
-			
-        err = listen(listen_sock, 1);
-        if (err != 0) {
-            ESP_LOGE(TAG, "Error occured during listen: errno %d", errno);
-            break;
-        }
-        ESP_LOGI(TAG, "Socket listening");
-		
-        addrLen = sizeof(sourceAddr);
-        client_sock = accept(listen_sock, (struct sockaddr *)&sourceAddr, &addrLen);
-        if (client_sock < 0) {
-            ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
-            break;
-        }
-        ESP_LOGI(TAG, "Socket accepted");
-        connected = 1;
-		
-        // Handle communication with client
-        while (1) {
-        	len = recv(client_sock, rx_buffer, sizeof(rx_buffer) - 1, MSG_DONTWAIT);
-            // Error occured during receiving
-            if (len < 0) {
-            	if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
-            		if (wifi_is_connected()) {
-            			// Nothing there to receive, so just wait before calling recv again
-            			vTaskDelay(pdMS_TO_TICKS(50));
-            		} else {
-            			ESP_LOGI(TAG, "Closing connection");
-            			break;
-            		}
-            	} else {
-                	ESP_LOGE(TAG, "recv failed: errno %d", errno);
-                	break;
-                }
-            }
-            // Connection closed
-            else if (len == 0) {
-                ESP_LOGI(TAG, "Connection closed");
-                break;
-            }
-            // Data received
-            else {
-            	// Store new data
-            	push_rx_data(rx_buffer, len);
-        	
-            	// Look for and handle commands
-            	while (process_rx_data()) {}
-            }
-        }
-        
-        // Close this session
-        connected = false;
-        if (client_sock != -1) {
-            ESP_LOGI(TAG, "Shutting down socket and restarting...");
-            shutdown(client_sock, 0);
-            close(client_sock);
-        }
+		// Block until there is a connection, data from a client or it's time to check
+		// the WiFi connection (or the status subscriptions)
+		FD_ZERO(&rx_fds);
+		FD_SET(listen_sock, &rx_fds);
+		FD_SET(http_listen_sock, &rx_fds);
+		max_sock = (listen_sock > http_listen_sock) ? listen_sock : http_listen_sock;
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			// A firmware update isn't read while its sector buffer waits to be written
+			if ((clients[i].state == CMD_CLIENT_ACTIVE) &&
+			    ((clients[i].proto != CMD_PROTO_OTA) || (ota_get_rx_space(NULL) != 0))) {
+				FD_SET(clients[i].sock, &rx_fds);
+				if (clients[i].sock > max_sock) max_sock = clients[i].sock;
+			}
+		}
+		if (ota_in_progress()) {
+			rx_timeout.tv_sec = 0;
+			rx_timeout.tv_usec = CMD_OTA_CHECK_MSEC * 1000;
+		} else if (takeover_sock >= 0) {
+			rx_timeout.tv_sec = 0;
+			rx_timeout.tv_usec = CMD_TAKEOVER_CHECK_MSEC * 1000;
+		} else if (status_subscribed()) {
+			rx_timeout.tv_sec = 0;
+			rx_timeout.tv_usec = CMD_STATUS_CHECK_MSEC * 1000;
+		} else {
+			rx_timeout.tv_sec = CMD_WIFI_CHECK_MSEC / 1000;
+			rx_timeout.tv_usec = (CMD_WIFI_CHECK_MSEC % 1000) * 1000;
+		}
+		err = select(max_sock + 1, &rx_fds, NULL, NULL, &rx_timeout);
+		if (err < 0) {
+			ESP_LOGE(TAG, "select failed: errno %d", errno);
+			break;
+		}
+		check_wifi();
+		check_stalled();
+		service_takeover();
+		service_status();
+		service_ota();
+		if (err == 0) continue;
+
+		// Handle communication with clients
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			if ((clients[i].state == CMD_CLIENT_ACTIVE) && FD_ISSET(clients[i].sock, &rx_fds)) {
+				if (!handle_client_rx(i)) {
+					close_client(i);
+				}
+			}
+		}
+
+		// Handle new connections
+		if (FD_ISSET(listen_sock, &rx_fds)) {
+			accept_client(listen_sock, CMD_PROTO_SOCKET);
+		}
+		if (FD_ISSET(http_listen_sock, &rx_fds)) {
+			accept_client(http_listen_sock, CMD_PROTO_HTTP);
+		}
 	}
 
 error:
@@ -196,20 +329,37 @@ error:
 
 
 /**
- * True when connected to a client
+ * True when connected to at least one client
  */
 bool cmd_connected()
 {
-	return connected;
+	int i;
+
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (clients[i].state == CMD_CLIENT_ACTIVE) return true;
+	}
+
+	return false;
+}
+
+
+/**
+ * Called by rsp_task when sends to a client have made no progress for
+ * RSP_SEND_STALL_MSEC so the client is closed
+ */
+void cmd_client_stalled(int client)
+{
+	clients[client].stalled = true;
 }
 
 
 /**
- * Return socket descriptor
+ * Called by rsp_task after it has closed a client's socket so the client can be reused
  */
-int cmd_get_socket()
+void cmd_client_closed(int client)
 {
-	return client_sock;
+	clients[client].sock = -1;
+	clients[client].state = CMD_CLIENT_FREE;
 }
 
 
@@ -219,279 +369,1509 @@ int cmd_get_socket()
 //
 
 /**
- * Initialize variables associated with receiving and processing commands
+ * Create a socket listening for connections on port.  Returns -1 if it fails.
  */
-static void init_command_processor()
+static int open_listen_socket(uint16_t port)
 {
-	rx_circular_push_index = 0;
-	rx_circular_pop_index = 0;
+    char addr_str[16];
+    int err;
+    int flag;
+    int sock;
+    struct sockaddr_in destAddr;
+
+	// Config IPV4
+    destAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    destAddr.sin_family = AF_INET;
+    destAddr.sin_port = htons(port);
+    inet_ntoa_r(destAddr.sin_addr, addr_str, sizeof(addr_str) - 1);
+
+    // socket - bind - listen - accept
+    sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        return -1;
+    }
+    ESP_LOGI(TAG, "Socket created for port %d", port);
+
+	flag = 1;
+  	setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(flag));
+    err = bind(sock, (struct sockaddr *)&destAddr, sizeof(destAddr));
+    if (err != 0) {
+        ESP_LOGE(TAG, "Socket unable to bind: errno %d", errno);
+        close(sock);
+        return -1;
+    }
+    ESP_LOGI(TAG, "Socket bound");
+
+    err = listen(sock, CMD_MAX_CLIENTS);
+    if (err != 0) {
+        ESP_LOGE(TAG, "Error occured during listen: errno %d", errno);
+        close(sock);
+        return -1;
+    }
+    ESP_LOGI(TAG, "Socket listening");
+
+    return sock;
 }
 
 
 /**
- * Push received data into our circular buffer
+ * Initialize variables associated with receiving and processing commands for a client
  */
-static void push_rx_data(char* data, int len)
-{	
-	// Push the received data into the circular buffer
-	while (len-- > 0) {
-		rx_circular_buffer[rx_circular_push_index] = *data++;
-		if (++rx_circular_push_index >= CMD_MAX_TCP_RX_BUFFER_LEN) rx_circular_push_index = 0;
+static void init_command_processor(int client)
+{
+	clients[client].cmd_len = (clients[client].proto == CMD_PROTO_HTTP) ? 0 : -1;
+	clients[client].cmd_overflow = false;
+	clients[client].ws_in_payload = false;
+	clients[client].ws_hdr_len = 0;
+}
+
+
+/**
+ * Accept a new connection if there is a free client slot (or, with CMD_CLIENT_TAKEOVER,
+ * a client it can take over).  Command port connections are handed to rsp_task
+ * immediately and HTTP connections once their request has been received.
+ */
+static void accept_client(int listen_sock, int proto)
+{
+	bool local;
+	int sock;
+	struct sockaddr_in sourceAddr;
+	uint32_t addrLen;
+
+	addrLen = sizeof(sourceAddr);
+	sock = accept(listen_sock, (struct sockaddr *)&sourceAddr, &addrLen);
+	if (sock < 0) {
+		ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
+		return;
+	}
+	
+	local = (sourceAddr.sin_addr.s_addr == htonl(INADDR_LOOPBACK));
+	if (!local) {
+		set_keepalive(sock);
 	}
+
+	if (install_client(sock, proto, local)) return;
+#ifdef CMD_CLIENT_TAKEOVER
+	if (start_takeover(sock, proto, local)) return;
+#endif
+
+	ESP_LOGE(TAG, "Too many clients - closing new connection");
+	shutdown(sock, 0);
+	close(sock);
 }
 
 
 /**
- * See if we can find a complete json string to process
+ * Set up a free client slot for a connection.  Returns false if there is none.
  */
-static bool process_rx_data() {
-	bool valid_string = false;
-	int begin, end, i;
+static bool install_client(int sock, int proto, bool local)
+{
+	int i;
 	
-	// See if we can find an entire json string
-	end = in_buffer(CMD_JSON_STRING_STOP);
-	if (end >= 0) {
-		// Found end of packet, look for beginning
-		begin = in_buffer(CMD_JSON_STRING_START);
-		if (begin >= 0) {
-			// Found packet - copy it, without delimiters to json_cmd_string
-			//
-			// Skip past start
-			while (rx_circular_pop_index != begin) {
-				if (++rx_circular_pop_index >= CMD_MAX_TCP_RX_BUFFER_LEN) rx_circular_pop_index = 0;
-			}
-			
-			// Copy up to end
-			i = 0;
-			while ((rx_circular_pop_index != end) && (i < CMD_MAX_TCP_RX_BUFFER_LEN)) {
-				if (i < JSON_MAX_CMD_TEXT_LEN) {
-					json_cmd_string[i] = rx_circular_buffer[rx_circular_pop_index];
-				}
-				i++;
-				if (++rx_circular_pop_index >= CMD_MAX_TCP_RX_BUFFER_LEN) rx_circular_pop_index = 0;
-			}
-			json_cmd_string[i] = 0;               // Make sure this is a null-terminated string
-			
-			// Skip past end
-			if (++rx_circular_pop_index >= CMD_MAX_TCP_RX_BUFFER_LEN) rx_circular_pop_index = 0;
-			
-			if (i < JSON_MAX_CMD_TEXT_LEN+1) {
-				// Process json command string
-				process_rx_packet();
-				valid_string = true;
-			}
-		} else {
-			// Unexpected end without start - skip it
-			while (rx_circular_pop_index != end) {
-				if (++rx_circular_pop_index >= CMD_MAX_TCP_RX_BUFFER_LEN) rx_circular_pop_index = 0;
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (clients[i].state == CMD_CLIENT_FREE) {
+			ESP_LOGI(TAG, "Socket accepted for client %d", i);
+			clients[i].proto = proto;
+			init_command_processor(i);
+			clients[i].sock = sock;
+			clients[i].state = CMD_CLIENT_ACTIVE;
+			clients[i].local = local;
+			clients[i].stalled = false;
+			clients[i].rx_usec = esp_timer_get_time();
+			clients[i].rsp_connected = (proto == CMD_PROTO_SOCKET);
+			clients[i].status_interval_ms = 0;
+			clients[i].status_on_change = false;
+			clients[i].status_metrics = false;
+
+			// Each new connection starts with json formatted images
+			if (clients[i].rsp_connected) {
+				rsp_client_connected(i, sock, RSP_TRANSPORT_SOCKET);
 			}
+			return true;
 		}
 	}
 	
-	return valid_string;
+	return false;
 }
 
 
-static void process_rx_packet()
+/**
+ * Enable TCP keepalive on a client connection so a peer that vanished while the
+ * connection was idle fails the socket after a few seconds
+ */
+static void set_keepalive(int sock)
 {
-	cJSON* json_obj;
-	cJSON* cmd_args;
-	int cmd;
-	static char* response_buffer;
-	static uint32_t response_length;
+	int v;
 	
-	// Create a json object to parse
-	json_obj = json_get_cmd_object(json_cmd_string);
-	if (json_obj != NULL) {
-		if (json_parse_cmd(json_obj, &cmd, &cmd_args)) {
-			switch (cmd) {
-				case CMD_GET_STATUS:
-					response_buffer = json_get_status(&response_length);
-					push_response(response_buffer, response_length);
-					break;
-					
-				case CMD_GET_IMAGE:
-					xTaskNotify(task_handle_rsp, RSP_NOTIFY_CMD_GET_IMG_MASK, eSetBits);
-					break;
-					
-				case CMD_SET_TIME:					
-					process_set_time(cmd_args);
-					break;
-				
-				case CMD_GET_WIFI:
-					response_buffer = json_get_wifi(&response_length);
-					push_response(response_buffer, response_length);
-					break;
-					
-				case CMD_SET_WIFI:
-					process_set_wifi(cmd_args);
-					break;
-				
-				case CMD_GET_CONFIG:
-					response_buffer = json_get_config(&response_length);
-					push_response(response_buffer, response_length);
-					break;
-					
-				case CMD_SET_CONFIG:
-					process_set_config(cmd_args);
-					break;
-				
-				case CMD_SET_SPOT:
-					process_set_spotmeter(cmd_args);
-					break;
-				
-				case CMD_STREAM_ON:
-					process_stream_on(cmd_args);
-					break;
-				
-				case CMD_STREAM_OFF:
-					xTaskNotify(task_handle_rsp, RSP_NOTIFY_CMD_STREAM_OFF_MASK, eSetBits);
-					break;
-						
-				case CMD_RECORD_ON:			
-				case CMD_RECORD_OFF:
-				case CMD_POWEROFF:
-					ESP_LOGE(TAG, "Unsupported command in json string: %s", json_cmd_string);
-					break;
-				
-				default:
-					ESP_LOGE(TAG, "Unknown command in json string: %s", json_cmd_string);
+	v = 1;
+	setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &v, sizeof(v));
+	v = CMD_KEEPALIVE_IDLE_SEC;
+	setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &v, sizeof(v));
+	v = CMD_KEEPALIVE_INTVL_SEC;
+	setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &v, sizeof(v));
+	v = CMD_KEEPALIVE_COUNT;
+	setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &v, sizeof(v));
+}
+
+
+/**
+ * Make room for a new connection when every client slot is in use by closing the
+ * remote client that has gone longest without sending anything.  A firmware update and
+ * the serial bridge's connection are never taken over.  The new connection waits in
+ * takeover_sock until rsp_task has closed the old one.  A connection already waiting
+ * is closed instead (the newest connection wins).  Returns false if no client can be
+ * taken over.
+ */
+static bool start_takeover(int sock, int proto, bool local)
+{
+	int i;
+	int victim = -1;
+	
+	if (takeover_sock >= 0) {
+		ESP_LOGI(TAG, "Closing the connection waiting for a takeover");
+		shutdown(takeover_sock, 0);
+		close(takeover_sock);
+	} else {
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			if ((clients[i].state == CMD_CLIENT_ACTIVE) && !clients[i].local && (i != ota_client)) {
+				if ((victim < 0) || (clients[i].rx_usec < clients[victim].rx_usec)) {
+					victim = i;
+				}
 			}
-		} else {
-			ESP_LOGE(TAG, "Unknown type of json string: %s", json_cmd_string);
 		}
+		if (victim < 0) return false;
 		
-		json_free_cmd(json_obj);
-	} else {
-		ESP_LOGE(TAG, "Couldn't convert json string: %s", json_cmd_string);
+		ESP_LOGI(TAG, "New connection taking over client %d", victim);
+		close_client(victim);
+	}
+	
+	takeover_sock = sock;
+	takeover_proto = proto;
+	takeover_local = local;
+	return true;
+}
+
+
+/**
+ * Install the connection waiting for a takeover once a client slot is free
+ */
+static void service_takeover()
+{
+	if ((takeover_sock >= 0) && install_client(takeover_sock, takeover_proto, takeover_local)) {
+		takeover_sock = -1;
 	}
 }
 
 
 /**
- * Push a response into the cmd_task_response_buffer if there is room, otherwise
- * just drop it (up to the external host to make sure this doesn't happen)
+ * Stop receiving from a client and hand its socket to rsp_task to close after it
+ * has stopped sending to it
  */
-static void push_response(char* buf, uint32_t len)
+static void close_client(int client)
 {
-	int i;
+	ESP_LOGI(TAG, "Shutting down client %d", client);
 	
-	// Atomically load cmd_task_response_buffer
-	xSemaphoreTake(sys_cmd_response_buffer.mutex, portMAX_DELAY);
+	if (client == ota_client) {
+		ota_abort();
+		ota_client = -1;
+	}
 	
-	// Only load if there's room for this response
-	if (len <= (CMD_RESPONSE_BUFFER_LEN - sys_cmd_response_buffer.length)) {
-		for (i=0; i<len; i++) {
-			// Push data
-			*sys_cmd_response_buffer.pushP = *(buf+i);
-			
-			// Increment push pointer
-			if (++sys_cmd_response_buffer.pushP >= (sys_cmd_response_buffer.bufferP + CMD_RESPONSE_BUFFER_LEN)) {
-				sys_cmd_response_buffer.pushP = sys_cmd_response_buffer.bufferP;
-			}
-		}
-		
-		sys_cmd_response_buffer.length += len;
+	// An HTTP connection rsp_task never saw is closed here
+	if (!clients[client].rsp_connected) {
+		shutdown(clients[client].sock, 0);
+		close(clients[client].sock);
+		cmd_client_closed(client);
+		return;
 	}
 	
-	xSemaphoreGive(sys_cmd_response_buffer.mutex);
+	clients[client].state = CMD_CLIENT_CLOSING;
+	clients[client].status_interval_ms = 0;
+	clients[client].status_on_change = false;
+	clients[client].status_metrics = false;
+	shutdown(clients[client].sock, 0);
+	ana_stream_off(client);
+	ana_set_alarm_dump(client, false);
+	rsp_client_disconnected(client);
 }
 
 
 /**
- * Routines to process commands
+ * Close the clients rsp_task found stalled
  */
-static void process_set_config(cJSON* cmd_args)
+static void check_stalled()
 {
-	json_config_t new_config_st;
+	int i;
 	
-	if (json_parse_set_config(cmd_args, &new_config_st)) {
-		// Look for changed items that require updating other modules
-		if (new_config_st.agc_set_enabled != lep_st.agc_set_enabled) {
-			lepton_agc(new_config_st.agc_set_enabled);
-			lep_st.agc_set_enabled = new_config_st.agc_set_enabled;
-		}
-		if (new_config_st.emissivity != lep_st.emissivity) {
-			lepton_emissivity(new_config_st.emissivity);
-			lep_st.emissivity = new_config_st.emissivity;
-		}
-		if (new_config_st.gain_mode != lep_st.gain_mode) {
-			lepton_gain_mode(new_config_st.gain_mode);
-			lep_st.gain_mode = new_config_st.gain_mode;
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if ((clients[i].state == CMD_CLIENT_ACTIVE) && clients[i].stalled) {
+			ESP_LOGI(TAG, "Closing stalled connection %d", i);
+			close_client(i);
 		}
-		ps_set_lep_state(&lep_st);
 	}
 }
 
 
-static void process_set_spotmeter(cJSON* cmd_args)
+/**
+ * Close the clients once the WiFi connection has been lost for CMD_WIFI_LOST_MSEC or
+ * the camera rejoined the network with a different address.  Clients ride out shorter
+ * drops: their sockets don't fail while the address is unchanged.  The serial bridge's
+ * loopback connection doesn't depend on the WiFi connection.
+ */
+static void check_wifi()
 {
-	uint16_t r1, c1, r2, c2;
+	int i;
+	uint32_t gen = wifi_get_addr_gen();
 	
-	if (json_parse_set_spotmeter(cmd_args, &r1, &c1, &r2, &c2)) {
-		lepton_spotmeter(r1, c1, r2, c2);
+	if ((gen == client_addr_gen) && (wifi_is_connected() || (wifi_get_down_msec() < CMD_WIFI_LOST_MSEC))) {
+		return;
+	}
+	client_addr_gen = gen;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if ((clients[i].state == CMD_CLIENT_ACTIVE) && !clients[i].local) {
+			ESP_LOGI(TAG, "Closing connection %d", i);
+			close_client(i);
+		}
 	}
 }
 
 
-static void process_stream_on(cJSON* cmd_args)
+/**
+ * Receive and process data from a client.  Returns false if the connection has
+ * closed.
+ */
+static bool handle_client_rx(int client)
+{
+	char rx_buffer[128];
+	int len;
+
+	if (clients[client].proto == CMD_PROTO_OTA) {
+		return receive_ota(client);
+	}
+
+	len = recv(clients[client].sock, rx_buffer, sizeof(rx_buffer) - 1, MSG_DONTWAIT);
+	// Error occured during receiving
+	if (len < 0) {
+		if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+			return true;
+		} else {
+			ESP_LOGE(TAG, "recv failed: errno %d", errno);
+			return false;
+		}
+	}
+	// Connection closed
+	else if (len == 0) {
+		ESP_LOGI(TAG, "Connection closed");
+		return false;
+	}
+	// Data received
+	else {
+		clients[client].rx_usec = esp_timer_get_time();
+		
+		// Look for and handle commands
+		cur_client = client;
+		switch (clients[client].proto) {
+			case CMD_PROTO_SOCKET:
+				process_rx_data(&clients[client], rx_buffer, len);
+				break;
+			
+			case CMD_PROTO_HTTP:
+				process_http_data(client, rx_buffer, len);
+				break;
+			
+			case CMD_PROTO_WS:
+				return process_ws_data(&clients[client], rx_buffer, len);
+		}
+		return true;
+	}
+}
+
+
+/**
+ * Receive the next part of a firmware image directly into the update's sector buffer.
+ * Returns false if the connection has closed.
+ */
+static bool receive_ota(int client)
 {
-	uint32_t delay_ms, num_frames;
+	uint8_t* buf;
+	uint32_t n;
+	int len;
 	
-	if (json_parse_stream_on(cmd_args, &delay_ms, &num_frames)) {
-		rsp_set_stream_parameters(delay_ms, num_frames);
-		xTaskNotify(task_handle_rsp, RSP_NOTIFY_CMD_STREAM_ON_MASK, eSetBits);
+	n = ota_get_rx_space(&buf);
+	if (n == 0) return true;
+	
+	len = recv(clients[client].sock, buf, n, MSG_DONTWAIT);
+	if (len < 0) {
+		if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+			return true;
+		} else {
+			ESP_LOGE(TAG, "recv failed: errno %d", errno);
+			return false;
+		}
+	} else if (len == 0) {
+		ESP_LOGI(TAG, "Connection closed");
+		return false;
 	}
+	
+	ota_rx_done(len);
+	return true;
 }
 
 
-static void process_set_time(cJSON* cmd_args)
+/**
+ * Assemble commands from received data, executing each as its stop delimitor arrives.
+ * Each byte is looked at once and commands may span several receives.  Data outside
+ * delimitors and commands too long for cmd_text are discarded.
+ */
+static void process_rx_data(cmd_client_t* c, char* data, int len)
 {
-	tmElements_t te;
+	char d;
 	
-	if (json_parse_set_time(cmd_args, &te)) {
-		time_set(te);
+	while (len-- > 0) {
+		d = *data++;
+		if (d == CMD_JSON_STRING_START) {
+			c->cmd_len = 0;
+			c->cmd_overflow = false;
+		} else if (d == CMD_JSON_STRING_STOP) {
+			if ((c->cmd_len >= 0) && !c->cmd_overflow) {
+				c->cmd_text[c->cmd_len] = 0;
+				process_rx_packet(c->cmd_text, c->cmd_len);
+			}
+			c->cmd_len = -1;
+		} else if (c->cmd_len >= 0) {
+			if (c->cmd_len < (JSON_MAX_CMD_TEXT_LEN - 1)) {
+				c->cmd_text[c->cmd_len++] = d;
+			} else {
+				c->cmd_overflow = true;
+			}
+		}
 	}
 }
 
 
-static void process_set_wifi(cJSON* cmd_args)
+/**
+ * Add received data to an HTTP request and handle the request once its header and
+ * body are complete.  Every request is answered with an error or handed to one of the
+ * endpoints.
+ */
+static void process_http_data(int client, char* data, int len)
 {
-	char ap_ssid[PS_SSID_MAX_LEN+1];
-	char sta_ssid[PS_SSID_MAX_LEN+1];
-	char ap_pw[PS_PW_MAX_LEN+1];
-	char sta_pw[PS_PW_MAX_LEN+1];
-	wifi_info_t new_wifi_info;
+	cmd_client_t* c = &clients[client];
+	http_request_t req;
+	int header_len;
 	
-	new_wifi_info.ap_ssid = ap_ssid;
-	new_wifi_info.sta_ssid = sta_ssid;
-	new_wifi_info.ap_pw = ap_pw;
-	new_wifi_info.sta_pw = sta_pw;
+	if ((c->cmd_len + len) > (JSON_MAX_CMD_TEXT_LEN - 1)) {
+		http_reply(client, 413);
+		return;
+	}
+	memcpy(&c->cmd_text[c->cmd_len], data, len);
+	c->cmd_len += len;
 	
-	if (json_parse_set_wifi(cmd_args, &new_wifi_info)) {
-		ps_set_wifi_info(&new_wifi_info);
-		if (!wifi_reinit()) {
-			ESP_LOGE(TAG, "Could not restart WiFi with the new configuration");
-		}
+	header_len = http_find_header_end(c->cmd_text, c->cmd_len);
+	if (header_len == 0) return;
+	
+	if (!http_parse_request(c->cmd_text, header_len, &req)) {
+		http_reply(client, 400);
+		return;
+	}
+	if (strcmp(req.path, HTTP_PATH_OTA) == 0) {
+		// The image is received into the update instead of cmd_text
+		start_ota(client, &req, header_len);
+		return;
+	}
+	if ((header_len + req.content_length) > (JSON_MAX_CMD_TEXT_LEN - 1)) {
+		http_reply(client, 413);
+		return;
+	}
+	if (c->cmd_len < (header_len + req.content_length)) {
+		// Wait for the rest of the body
+		return;
+	}
+	
+	if (strcmp(req.path, HTTP_PATH_WS) == 0) {
+		start_ws(client, &req);
+	} else if (strcmp(req.path, HTTP_PATH_MJPEG) == 0) {
+		start_mjpeg(client, &req);
+	} else if (strncmp(req.path, HTTP_PATH_API, strlen(HTTP_PATH_API)) == 0) {
+		process_rest(client, &req, header_len);
+	} else {
+		http_reply(client, 404);
 	}
 }
 
 
 /**
- * Look for c in the rx_circular_buffer and return its location if found, -1 otherwise
+ * Accept a WebSocket upgrade and hand the connection to rsp_task
  */
-static int in_buffer(char c)
+static void start_ws(int client, http_request_t* req)
 {
-	int i;
+	cmd_client_t* c = &clients[client];
+	char buf[HTTP_MAX_HEADER_LEN];
+	int len;
 	
-	i = rx_circular_pop_index;
-	while (i != rx_circular_push_index) {
-		if (c == rx_circular_buffer[i]) {
-			return i;
-		} else {
-			if (i++ >= CMD_MAX_TCP_RX_BUFFER_LEN) i = 0;
-		}
+	if ((req->method != HTTP_METHOD_GET) || !req->ws_upgrade) {
+		http_reply(client, 400);
+		return;
 	}
 	
-	return -1;
+	len = http_get_ws_accept_header(buf, req->ws_key);
+	if (len == 0) {
+		http_reply(client, 503);
+		return;
+	}
+	if (send_http(c->sock, buf, len)) {
+		c->proto = CMD_PROTO_WS;
+		init_command_processor(client);
+		c->rsp_connected = true;
+		rsp_client_connected(client, c->sock, RSP_TRANSPORT_WS);
+	}
+}
+
+
+/**
+ * Start an mjpeg stream of JPEG preview images of the full frame using the palette
+ * and rate from the query parameters
+ */
+static void start_mjpeg(int client, http_request_t* req)
+{
+	cmd_client_t* c = &clients[client];
+	char buf[HTTP_MAX_HEADER_LEN];
+	char val[16];
+	int len;
+	int palette = PALETTE_DEFAULT;
+	uint16_t roi[4] = {0, 0, LEP_HEIGHT - 1, LEP_WIDTH - 1};
+	uint32_t delay_ms = 0;
+	
+	if (req->method != HTTP_METHOD_GET) {
+		http_reply(client, 405);
+		return;
+	}
+	
+	if (http_get_query_param(req->query, "palette", val, sizeof(val))) {
+		palette = palette_find(val);
+		if (palette < 0) {
+			http_reply(client, 400);
+			return;
+		}
+	}
+	if (http_get_query_param(req->query, "delay_msec", val, sizeof(val))) {
+		delay_ms = atoi(val);
+	}
+	
+	len = http_get_mjpeg_header(buf);
+	if (send_http(c->sock, buf, len)) {
+		c->proto = CMD_PROTO_HTTP_DONE;
+		c->rsp_connected = true;
+		rsp_client_connected(client, c->sock, RSP_TRANSPORT_MJPEG);
+		rsp_set_image_format(client, RSP_IMG_FMT_JPEG, palette, 0, 0, false, 0, false, 0);
+		rsp_stream_on(client, delay_ms, 0, 0, 0, 0, roi, 1, false, false, false, false, false, false, NULL, 0);
+	}
+}
+
+
+/**
+ * Execute a REST request (/api/<cmd> with the arguments as the body) as a command.
+ * The command's response is sent by rsp_task, commands without a response are
+ * answered here.  Commands that send images or recording data need a stream
+ * connection (the command port or WebSocket endpoint).  A batch request gets its
+ * combined response (responses that didn't fit in it are not sent).
+ */
+static void process_rest(int client, http_request_t* req, int header_len)
+{
+	cmd_client_t* c = &clients[client];
+	char* name = req->path + strlen(HTTP_PATH_API);
+	char prefix[HTTP_MAX_PATH_LEN + 16];
+	int cmd;
+	int len, prefix_len;
+	
+	cmd = json_get_cmd_index(name);
+	if (cmd == CMD_UNKNOWN) {
+		http_reply(client, 404);
+		return;
+	}
+	if (cmd_needs_stream(cmd)) {
+		http_reply(client, 400);
+		return;
+	}
+	
+	// Replace the request header with the command: {"cmd":"<name>","args":<body>}
+	if (req->content_length != 0) {
+		prefix_len = sprintf(prefix, "{\"cmd\":\"%s\",\"args\":", name);
+	} else {
+		prefix_len = sprintf(prefix, "{\"cmd\":\"%s\"", name);
+	}
+	len = prefix_len + req->content_length + 1;
+	if (len > (JSON_MAX_CMD_TEXT_LEN - 1)) {
+		http_reply(client, 413);
+		return;
+	}
+	memmove(&c->cmd_text[prefix_len], &c->cmd_text[header_len], req->content_length);
+	memcpy(c->cmd_text, prefix, prefix_len);
+	c->cmd_text[len - 1] = '}';
+	c->cmd_text[len] = 0;
+	
+	c->proto = CMD_PROTO_HTTP_DONE;
+	c->rsp_connected = true;
+	rsp_client_connected(client, c->sock, RSP_TRANSPORT_REST);
+	
+	rsp_pushed = false;
+	if (!process_rx_packet(c->cmd_text, len)) {
+		http_reply(client, 400);
+	} else if (!rsp_pushed) {
+		http_reply(client, 204);
+	}
+}
+
+
+/**
+ * Start receiving a firmware image (the body of a POST to /ota) into the inactive app
+ * partition.  The request is answered when the image has been written and verified.
+ * Updates are refused while recording (both write the flash).
+ */
+static void start_ota(int client, http_request_t* req, int header_len)
+{
+	cmd_client_t* c = &clients[client];
+	rec_info_t rec_info;
+	uint8_t* buf;
+	uint32_t n;
+	int len;
+	
+	if (req->method != HTTP_METHOD_POST) {
+		http_reply(client, 405);
+		return;
+	}
+	if (req->content_length == 0) {
+		http_reply(client, 400);
+		return;
+	}
+	if (ota_get_max_size() == 0) {
+		http_reply(client, 503);
+		return;
+	}
+	if (req->content_length > ota_get_max_size()) {
+		http_reply(client, 413);
+		return;
+	}
+	rec_get_info(&rec_info);
+	if ((rec_info.state == REC_STATE_RECORDING) || !ota_start(req->content_length)) {
+		http_reply(client, 409);
+		return;
+	}
+	
+	c->proto = CMD_PROTO_OTA;
+	ota_client = client;
+	
+	// Part of the image may have arrived with the header
+	len = c->cmd_len - header_len;
+	n = ota_get_rx_space(&buf);
+	if (len > (int) n) len = n;
+	if (len > 0) {
+		memcpy(buf, &c->cmd_text[header_len], len);
+		ota_rx_done(len);
+	}
+}
+
+
+/**
+ * Write the next sector of a firmware update when it's time and answer its request
+ * when it finishes
+ */
+static void service_ota()
+{
+	ota_info_t info;
+	
+	if (!ota_service()) return;
+	
+	ota_get_info(&info);
+	if (ota_client >= 0) {
+		if (info.state == OTA_STATE_READY) {
+			http_reply(ota_client, 200);
+		} else {
+			http_reply(ota_client, (info.err == OTA_ERR_FLASH) ? 500 : 400);
+		}
+		ota_client = -1;
+	}
+}
+
+
+/**
+ * Answer an HTTP request with a status and no body and finish with the connection
+ * (the host closes it)
+ */
+static void http_reply(int client, int status)
+{
+	cmd_client_t* c = &clients[client];
+	char buf[HTTP_MAX_HEADER_LEN];
+	int len;
+	
+	len = http_get_response_header(buf, status, NULL, 0);
+	(void) send_http(c->sock, buf, len);
+	shutdown(c->sock, SHUT_WR);
+	c->proto = CMD_PROTO_HTTP_DONE;
+}
+
+
+/**
+ * Send an HTTP response header on a connection rsp_task isn't sending to.  Returns
+ * false if it couldn't be sent.
+ */
+static bool send_http(int sock, char* buf, int len)
+{
+	int err;
+	
+	while (len > 0) {
+		err = send(sock, buf, len, 0);
+		if (err < 0) {
+			ESP_LOGE(TAG, "Error in http send: errno %d", errno);
+			return false;
+		}
+		buf += err;
+		len -= err;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Decode WebSocket frames, executing each complete text message as a command.  Other
+ * messages are discarded.  Returns false when the host closes the WebSocket or sends
+ * a frame we can't handle.
+ */
+static bool process_ws_data(cmd_client_t* c, char* data, int len)
+{
+	char d;
+	int n;
+	ws_frame_t* f = &c->ws_frame;
+	
+	while (len > 0) {
+		if (!c->ws_in_payload) {
+			c->ws_hdr[c->ws_hdr_len++] = *data++;
+			len--;
+			n = ws_parse_header(c->ws_hdr, c->ws_hdr_len, f);
+			if (n < 0) return false;
+			if (n == 0) {
+				if (c->ws_hdr_len >= WS_MAX_RX_HEADER_LEN) return false;
+				continue;
+			}
+			c->ws_hdr_len = 0;
+			if (f->opcode == WS_OP_CLOSE) return false;
+			
+			// A text message starts a command and continuation frames add to it
+			if (f->opcode == WS_OP_TEXT) {
+				c->cmd_len = 0;
+				c->cmd_overflow = false;
+			} else if (f->opcode == WS_OP_BIN) {
+				c->cmd_len = -1;
+			}
+			c->ws_remaining = f->payload_len;
+			c->ws_index = 0;
+			c->ws_in_payload = true;
+		} else {
+			d = *data++ ^ f->mask[c->ws_index++ & 0x3];
+			len--;
+			c->ws_remaining--;
+			if (((f->opcode == WS_OP_TEXT) || (f->opcode == WS_OP_CONT)) && (c->cmd_len >= 0)) {
+				if (c->cmd_len < (JSON_MAX_CMD_TEXT_LEN - 1)) {
+					c->cmd_text[c->cmd_len++] = d;
+				} else {
+					c->cmd_overflow = true;
+				}
+			}
+		}
+		
+		if (c->ws_in_payload && (c->ws_remaining == 0)) {
+			c->ws_in_payload = false;
+			if (f->fin && ((f->opcode == WS_OP_TEXT) || (f->opcode == WS_OP_CONT)) && (c->cmd_len >= 0)) {
+				if (!c->cmd_overflow) {
+					c->cmd_text[c->cmd_len] = 0;
+					(void) process_rx_packet(c->cmd_text, c->cmd_len);
+				}
+				c->cmd_len = -1;
+			}
+		}
+	}
+	
+	return true;
+}
+
+
+/**
+ * Execute a command string.  Returns false if it isn't a command.
+ */
+static bool process_rx_packet(char* cmd_string, int len)
+{
+	bool ret = true;
+	cJSON* json_obj;
+	cJSON* cmd_args;
+	int cmd;
+	
+	// Commands without arguments (get_status, stream_off...) don't need a cJSON object
+	if (json_scan_cmd(cmd_string, len, &cmd)) {
+		process_cmd(cmd, NULL, cmd_string);
+		json_arena_reset();
+		return true;
+	}
+	
+	// Create a json object to parse
+	json_obj = json_get_cmd_object(cmd_string);
+	if (json_obj != NULL) {
+		if (json_parse_cmd(json_obj, &cmd, &cmd_args)) {
+			process_cmd(cmd, cmd_args, cmd_string);
+		} else {
+			ESP_LOGE(TAG, "Unknown type of json string: %s", cmd_string);
+			ret = false;
+		}
+		
+		json_free_cmd(json_obj);
+	} else {
+		ESP_LOGE(TAG, "Couldn't convert json string: %s", cmd_string);
+		ret = false;
+	}
+	
+	// All of the command's cJSON objects have been freed
+	json_arena_reset();
+	
+	return ret;
+}
+
+
+/**
+ * Execute a command.  cmd_args is NULL if the command has no arguments.
+ */
+static void process_cmd(int cmd, cJSON* cmd_args, char* cmd_string)
+{
+	static char* response_buffer;
+	static uint32_t response_length;
+	rsp_adapt_status_t adapt_status;
+	
+	switch (cmd) {
+		case CMD_GET_STATUS:
+			rsp_get_adapt_status(cur_client, &adapt_status);
+			response_buffer = json_get_status(&adapt_status, false, &response_length);
+			push_response(response_buffer, response_length);
+			break;
+			
+		case CMD_GET_PERF_STATS:
+			response_buffer = json_get_perf_stats(&response_length);
+			push_response(response_buffer, response_length);
+			break;
+		
+		case CMD_GET_IMAGE:
+			process_get_image(cmd_args);
+			break;
+			
+		case CMD_SET_TIME:					
+			process_set_time(cmd_args);
+			break;
+		
+		case CMD_GET_WIFI:
+			response_buffer = json_get_wifi(&response_length);
+			push_response(response_buffer, response_length);
+			break;
+			
+		case CMD_SET_WIFI:
+			process_set_wifi(cmd_args);
+			break;
+		
+		case CMD_GET_CONFIG:
+			response_buffer = json_get_config(&response_length);
+			push_response(response_buffer, response_length);
+			break;
+			
+		case CMD_SET_CONFIG:
+			process_set_config(cmd_args);
+			break;
+		
+		case CMD_SET_SPOT:
+			process_set_spotmeter(cmd_args);
+			break;
+		
+		case CMD_STREAM_ON:
+			process_stream_on(cmd_args);
+			break;
+		
+		case CMD_STREAM_OFF:
+			rsp_stream_off(cur_client);
+			ana_stream_off(cur_client);
+			break;
+				
+		case CMD_STREAM_RESYNC:
+			rsp_stream_resync(cur_client);
+			break;
+		
+		case CMD_SET_IMG_FMT:
+			process_set_image_format(cmd_args);
+			break;
+		
+		case CMD_RECORD_ON:
+			process_record_on(cmd_args);
+			break;
+		
+		case CMD_RECORD_OFF:
+			rec_stop();
+			break;
+		
+		case CMD_GET_RECORD_INFO:
+			response_buffer = json_get_record_info(&response_length);
+			push_response(response_buffer, response_length);
+			break;
+		
+		case CMD_GET_RECORD:
+			process_get_record(cmd_args);
+			break;
+		
+		case CMD_SET_INTERVAL:
+			process_set_interval_capture(cmd_args);
+			break;
+		
+		case CMD_GET_SYS_STATS:
+			process_get_sys_stats(cmd_args);
+			break;
+		
+		case CMD_SET_ANALYTICS:
+			process_set_analytics(cmd_args);
+			break;
+		
+		case CMD_SET_HISTORY:
+			process_set_history(cmd_args);
+			break;
+		
+		case CMD_DUMP_HISTORY:
+			process_dump_history(cmd_args);
+			break;
+		
+		case CMD_SET_ESPNOW:
+			process_set_espnow(cmd_args);
+			break;
+		
+		case CMD_SET_LEPTON:
+			process_set_lepton(cmd_args);
+			break;
+		
+		case CMD_SET_FFC:
+			process_set_ffc(cmd_args);
+			break;
+		
+		case CMD_RUN_FFC:
+			lep_approve_ffc();
+			break;
+		
+		case CMD_CALIBRATE_SPI:
+			lep_calibrate_spi();
+			break;
+		
+		case CMD_SCAN_WIFI:
+			process_scan_wifi(cmd_args);
+			break;
+		
+		case CMD_BATCH:
+			if (batching) {
+				ESP_LOGE(TAG, "Nested batch command in json string: %s", cmd_string);
+			} else {
+				process_batch(cmd_args, cmd_string);
+			}
+			break;
+		
+		case CMD_SUBSCRIBE_STATUS:
+			process_subscribe_status(cmd_args);
+			break;
+		
+		case CMD_GET_OTA_INFO:
+			response_buffer = json_get_ota_info(&response_length);
+			push_response(response_buffer, response_length);
+			break;
+		
+		case CMD_OTA_REBOOT:
+			if (ota_ready()) {
+				ESP_LOGI(TAG, "Restarting into the firmware update");
+				esp_restart();
+			} else {
+				ESP_LOGE(TAG, "No firmware update to restart into");
+			}
+			break;
+		
+		case CMD_GET_LOG_INFO:
+			// Write the queued records so they are included in a download that follows
+			evlog_flush();
+			response_buffer = json_get_log_info(&response_length);
+			push_response(response_buffer, response_length);
+			break;
+		
+		case CMD_GET_LOG:
+			process_get_log(cmd_args);
+			break;
+		
+		case CMD_BURST_CAPTURE:
+			process_burst_capture(cmd_args);
+			break;
+		
+		case CMD_POWEROFF:
+			ESP_LOGE(TAG, "Unsupported command in json string: %s", cmd_string);
+			break;
+		
+		default:
+			ESP_LOGE(TAG, "Unknown command in json string: %s", cmd_string);
+	}
+}
+
+
+/**
+ * True for commands that send images, recording data or status over time that need a
+ * stream connection (not a REST request)
+ */
+static bool cmd_needs_stream(int cmd)
+{
+	return ((cmd == CMD_GET_IMAGE) || (cmd == CMD_STREAM_ON) || (cmd == CMD_STREAM_OFF) ||
+	        (cmd == CMD_STREAM_RESYNC) || (cmd == CMD_SET_IMG_FMT) || (cmd == CMD_GET_RECORD) ||
+	        (cmd == CMD_DUMP_HISTORY) || (cmd == CMD_SUBSCRIBE_STATUS) || (cmd == CMD_GET_LOG) ||
+	        (cmd == CMD_BURST_CAPTURE));
+}
+
+
+/**
+ * Push a response into the current client's command response buffer.  While a batch
+ * is executed the response is added to the batch response instead, which is pushed
+ * first if it is full.
+ */
+static void push_response(char* buf, uint32_t len)
+{
+	rsp_pushed = true;
+	if (batching) {
+		if (json_batch_add(buf, len)) return;
+		push_batch();
+		if (json_batch_add(buf, len)) return;
+	}
+	rsp_push_response(cur_client, buf, len);
+}
+
+
+/**
+ * Push the batch response assembled so far, if any, and start a new one
+ */
+static void push_batch()
+{
+	char* response_buffer;
+	uint32_t response_length;
+	
+	response_buffer = json_batch_finish(&response_length);
+	if (response_length != 0) {
+		rsp_push_response(cur_client, response_buffer, response_length);
+	}
+	json_batch_start();
+}
+
+
+/**
+ * Routines to process commands
+ */
+static void process_get_image(cJSON* cmd_args)
+{
+	uint32_t avg_frames;
+	uint32_t max_age_ms;
+	
+	if (json_parse_get_image(cmd_args, &avg_frames, &max_age_ms)) {
+		rsp_get_image(cur_client, avg_frames, max_age_ms);
+	}
+}
+
+
+static void process_set_config(cJSON* cmd_args)
+{
+	int i;
+	json_config_t new_config_st;
+	
+	if (json_parse_set_config(cmd_args, &new_config_st)) {
+		// Look for changed items that require updating other modules
+		if (new_config_st.agc_set_enabled != lep_st.agc_set_enabled) {
+			lepton_agc(new_config_st.agc_set_enabled);
+			lep_st.agc_set_enabled = new_config_st.agc_set_enabled;
+		}
+		if (new_config_st.emissivity != lep_st.emissivity) {
+			lepton_emissivity(new_config_st.emissivity);
+			lep_st.emissivity = new_config_st.emissivity;
+		}
+		if (new_config_st.gain_mode != lep_st.gain_mode) {
+			lepton_gain_mode(new_config_st.gain_mode);
+			lep_st.gain_mode = new_config_st.gain_mode;
+		}
+		if (new_config_st.temporal_filter != lep_st.temporal_filter) {
+			for (i=0; i<LEP_NUM_LEPTONS; i++) {
+				vospi_set_temporal_filter(i, new_config_st.temporal_filter);
+			}
+			lep_st.temporal_filter = new_config_st.temporal_filter;
+		}
+		ps_set_lep_state(&lep_st);
+	}
+}
+
+
+static void process_set_spotmeter(cJSON* cmd_args)
+{
+	uint16_t r1, c1, r2, c2;
+	
+	if (json_parse_set_spotmeter(cmd_args, &r1, &c1, &r2, &c2)) {
+		lepton_spotmeter(r1, c1, r2, c2);
+	}
+}
+
+
+static void process_stream_on(cJSON* cmd_args)
+{
+	int bin;
+	bool segments;
+	bool raw;
+	bool rtp;
+	bool probe;
+	bool sync;
+	bool cmd_priority;
+	int stats;
+	rsp_trigger_t trig;
+	uint8_t udp_addr[4];
+	uint16_t udp_port;
+	uint16_t roi[4];
+	uint32_t delay_ms, num_frames, key_interval;
+	uint32_t addr, adapt_ms;
+	
+	if (json_parse_stream_on(cmd_args, &delay_ms, &num_frames, &key_interval, &udp_port, udp_addr, roi, &bin, &segments, &raw, &rtp, &trig, &stats, &adapt_ms, &probe, &sync, &cmd_priority)) {
+		if (stats == 1) {
+			// Stats replace the client's image stream
+			rsp_stream_off(cur_client);
+		} else {
+			// udp_addr is stored most significant byte last (like wifi_info_t)
+			addr = (udp_addr[3] << 24) | (udp_addr[2] << 16) | (udp_addr[1] << 8) | udp_addr[0];
+			rsp_stream_on(cur_client, delay_ms, num_frames, key_interval, udp_port, addr, roi, bin, segments, raw, rtp, probe, sync, cmd_priority, &trig, adapt_ms);
+		}
+		
+		if (stats != 0) {
+			ana_stream_on(cur_client, delay_ms, num_frames);
+		} else {
+			ana_stream_off(cur_client);
+		}
+	}
+}
+
+
+static void process_set_time(cJSON* cmd_args)
+{
+	tmElements_t te;
+	
+	if (json_parse_set_time(cmd_args, &te)) {
+		time_set(te);
+	}
+}
+
+
+static void process_set_wifi(cJSON* cmd_args)
+{
+	char ap_ssid[PS_SSID_MAX_LEN+1];
+	char sta_ssid[PS_SSID_MAX_LEN+1];
+	char ap_pw[PS_PW_MAX_LEN+1];
+	char sta_pw[PS_PW_MAX_LEN+1];
+	wifi_info_t new_wifi_info;
+	
+	new_wifi_info.ap_ssid = ap_ssid;
+	new_wifi_info.sta_ssid = sta_ssid;
+	new_wifi_info.ap_pw = ap_pw;
+	new_wifi_info.sta_pw = sta_pw;
+	
+	if (json_parse_set_wifi(cmd_args, &new_wifi_info)) {
+		ps_set_wifi_info(&new_wifi_info);
+		if (!wifi_reinit()) {
+			ESP_LOGE(TAG, "Could not restart WiFi with the new configuration");
+		}
+	}
+}
+
+
+static void process_set_image_format(cJSON* cmd_args)
+{
+	char* response_buffer;
+	int format;
+	int palette;
+	uint16_t lo, hi;
+	bool agc8;
+	bool hist;
+	uint8_t telem_mask;
+	uint16_t threshold;
+	uint32_t response_length;
+	
+	if (json_parse_set_image_format(cmd_args, &format, &palette, &lo, &hi, &agc8, &telem_mask, &hist, &threshold)) {
+		// WebSocket clients get binary images instead of json images
+		if ((clients[cur_client].proto == CMD_PROTO_WS) && (format == RSP_IMG_FMT_JSON)) {
+			format = RSP_IMG_FMT_BIN;
+		}
+		rsp_set_image_format(cur_client, format, palette, lo, hi, agc8, telem_mask, hist, threshold);
+		
+		// Acknowledge the format so the host knows it is supported
+		response_buffer = json_get_image_format(format, palette, lo, hi, agc8, telem_mask, hist, threshold, &response_length);
+		push_response(response_buffer, response_length);
+	}
+}
+
+
+static void process_record_on(cJSON* cmd_args)
+{
+	int encoding;
+	uint32_t delay_ms, num_frames, key_interval;
+	
+	if (ota_in_progress()) {
+		ESP_LOGE(TAG, "Can't record during a firmware update");
+		return;
+	}
+	
+	if (json_parse_record_on(cmd_args, &encoding, &delay_ms, &num_frames, &key_interval)) {
+		rec_start(encoding, delay_ms, num_frames, key_interval);
+	}
+}
+
+
+static void process_get_record(cJSON* cmd_args)
+{
+	uint32_t offset, length;
+	
+	if (json_parse_get_record(cmd_args, &offset, &length)) {
+		rsp_get_record(cur_client, offset, length);
+	}
+}
+
+
+static void process_get_log(cJSON* cmd_args)
+{
+	uint32_t offset, length;
+	
+	if (json_parse_get_record(cmd_args, &offset, &length)) {
+		rsp_get_log(cur_client, offset, length);
+	}
+}
+
+
+static void process_burst_capture(cJSON* cmd_args)
+{
+	char buf[96];
+	uint32_t num_frames, len;
+	int encoding;
+	
+	if (json_parse_burst_capture(cmd_args, &num_frames, &encoding)) {
+		// The burst response is sent by rsp_task when the burst is complete
+		if (!hist_start_burst(cur_client, num_frames, encoding)) {
+			ESP_LOGE(TAG, "Can't start a burst while a burst or history dump is in progress");
+			len = json_get_burst_dump(buf, sizeof(buf), 0, 0, 0, false);
+			if (len != 0) {
+				push_response(buf, len);
+			}
+		}
+	}
+}
+
+
+static void process_set_interval_capture(cJSON* cmd_args)
+{
+	char* response_buffer;
+	uint32_t interval_ms, num_frames, settle_ms;
+	uint32_t response_length;
+	
+	if (json_parse_set_interval_capture(cmd_args, &interval_ms, &num_frames, &settle_ms)) {
+		lep_set_interval_capture(interval_ms, num_frames, settle_ms);
+		
+		// Report the settings and their expected power and latency
+		response_buffer = json_get_interval_capture(&response_length);
+		push_response(response_buffer, response_length);
+	}
+}
+
+
+static void process_get_sys_stats(cJSON* cmd_args)
+{
+	bool enable;
+	char* response_buffer;
+	uint32_t response_length;
+	
+	// Optionally start or stop the profiler before reporting
+	if (json_parse_get_sys_stats(cmd_args, &enable)) {
+		mon_set_profiling(enable);
+	}
+	
+	response_buffer = json_get_sys_stats(&response_length);
+	push_response(response_buffer, response_length);
+}
+
+
+static void process_set_analytics(cJSON* cmd_args)
+{
+	ana_config_t cfg;
+	
+	if (json_parse_set_analytics(cmd_args, &cfg)) {
+		(void) ana_set_config(&cfg);
+	}
+}
+
+
+static void process_set_history(cJSON* cmd_args)
+{
+	uint32_t seconds;
+	
+	if (json_parse_set_history(cmd_args, &seconds)) {
+		hist_set_seconds(seconds);
+	}
+}
+
+
+static void process_dump_history(cJSON* cmd_args)
+{
+	int on_alarm;
+	
+	if (json_parse_dump_history(cmd_args, &on_alarm)) {
+		if (on_alarm < 0) {
+			rsp_dump_history(cur_client);
+		} else {
+			ana_set_alarm_dump(cur_client, on_alarm != 0);
+		}
+	}
+}
+
+
+static void process_set_espnow(cJSON* cmd_args)
+{
+	now_config_t cfg;
+	
+	if (json_parse_set_espnow(cmd_args, &cfg)) {
+		now_set_config(&cfg);
+	}
+}
+
+
+static void process_set_lepton(cJSON* cmd_args)
+{
+	int lepton;
+	
+	if (json_parse_set_lepton(cmd_args, &lepton)) {
+		rsp_set_lepton(cur_client, lepton);
+	}
+}
+
+
+static void process_set_ffc(cJSON* cmd_args)
+{
+	char* response_buffer;
+	lep_ffc_sched_t sched;
+	uint32_t response_length;
+	
+	if (json_parse_set_ffc(cmd_args, &sched)) {
+		lep_set_ffc_schedule(&sched);
+		
+		// Report the settings and the scheduler's state
+		response_buffer = json_get_ffc_schedule(&response_length);
+		push_response(response_buffer, response_length);
+	}
+}
+
+
+static void process_scan_wifi(cJSON* cmd_args)
+{
+	char* response_buffer;
+	uint32_t response_length;
+	
+	// Pick a new AP channel and restart the AP on it if requested (only possible in AP
+	// mode).  The client is disconnected so there's no response.
+	if ((cmd_args != NULL) && cJSON_HasObjectItem(cmd_args, "plan_ap") &&
+	    (cJSON_GetObjectItem(cmd_args, "plan_ap")->valueint != 0)) {
+		if (!wifi_replan_ap_channel()) {
+			ESP_LOGE(TAG, "scan_wifi plan_ap requires AP mode");
+		} else {
+			return;
+		}
+	}
+	
+	// Start a new background scan if requested (only possible in client mode)
+	if ((cmd_args != NULL) && cJSON_HasObjectItem(cmd_args, "start") &&
+	    (cJSON_GetObjectItem(cmd_args, "start")->valueint != 0)) {
+		if (!wifi_start_bg_scan()) {
+			ESP_LOGE(TAG, "scan_wifi requires client mode");
+		}
+	}
+	
+	// Report the APs found so far
+	response_buffer = json_get_wifi_scan(&response_length);
+	push_response(response_buffer, response_length);
+}
+
+
+static void process_batch(cJSON* cmd_args, char* cmd_string)
+{
+	bool rest;
+	cJSON* cmds;
+	cJSON* item;
+	cJSON* args;
+	int cmd;
+	int n = 0;
+	
+	cmds = (cmd_args != NULL) ? cJSON_GetObjectItem(cmd_args, "cmds") : NULL;
+	if (!cJSON_IsArray(cmds)) {
+		ESP_LOGE(TAG, "batch missing cmds");
+		return;
+	}
+	rest = (clients[cur_client].proto == CMD_PROTO_HTTP_DONE);
+	
+	// Execute the commands in order combining their responses
+	json_batch_start();
+	batching = true;
+	cJSON_ArrayForEach(item, cmds) {
+		if (n++ == CMD_BATCH_MAX_CMDS) {
+			ESP_LOGE(TAG, "batch has more than %d cmds", CMD_BATCH_MAX_CMDS);
+			break;
+		}
+		if (!json_parse_cmd(item, &cmd, &args)) {
+			ESP_LOGE(TAG, "Unknown type of batch cmd %d", n - 1);
+			continue;
+		}
+		if (rest && cmd_needs_stream(cmd)) {
+			ESP_LOGE(TAG, "batch cmd %s needs a stream connection", json_get_cmd_name(cmd));
+			continue;
+		}
+		process_cmd(cmd, args, cmd_string);
+	}
+	batching = false;
+	push_batch();
+}
+
+
+static void process_subscribe_status(cJSON* cmd_args)
+{
+	bool on_change;
+	bool metrics;
+	uint32_t interval_ms;
+	cmd_client_t* c = &clients[cur_client];
+	
+	if (json_parse_subscribe_status(cmd_args, &interval_ms, &on_change, &metrics)) {
+		c->status_interval_ms = interval_ms;
+		c->status_on_change = on_change;
+		c->status_metrics = metrics;
+		
+		// Subscribers start with the current status
+		if ((interval_ms != 0) || on_change) {
+			push_status(cur_client, esp_timer_get_time());
+		}
+	}
+}
+
+
+/**
+ * True when any client is subscribed to status
+ */
+static bool status_subscribed()
+{
+	int i;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if ((clients[i].state == CMD_CLIENT_ACTIVE) &&
+		    ((clients[i].status_interval_ms != 0) || clients[i].status_on_change)) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+
+/**
+ * Push status to the subscribed clients whose interval has passed or, no more often
+ * than every CMD_STATUS_CHECK_MSEC, whose status has changed
+ */
+static void service_status()
+{
+	bool due;
+	int i;
+	int64_t t;
+	cmd_client_t* c;
+	cmd_status_key_t key;
+	rsp_adapt_status_t adapt;
+	
+	t = esp_timer_get_time();
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		c = &clients[i];
+		if ((c->state != CMD_CLIENT_ACTIVE) || ((c->status_interval_ms == 0) && !c->status_on_change)) {
+			continue;
+		}
+		
+		due = (c->status_interval_ms != 0) && (t >= c->status_next_usec);
+		if (!due && c->status_on_change && (t >= (c->status_last_usec + CMD_STATUS_CHECK_MSEC * 1000))) {
+			get_status_key(i, &adapt, &key);
+			due = status_changed(&c->status_key, &key);
+		}
+		if (due) {
+			push_status(i, t);
+		}
+	}
+}
+
+
+/**
+ * Push compact status, and the metrics if the client asked for them, to a client and
+ * note what it reported
+ */
+static void push_status(int client, int64_t t)
+{
+	char* response_buffer;
+	uint32_t response_length;
+	cmd_client_t* c = &clients[client];
+	rsp_adapt_status_t adapt;
+	rsp_queue_status_t queue;
+	
+	get_status_key(client, &adapt, &c->status_key);
+	c->status_last_usec = t;
+	c->status_next_usec = t + (int64_t) c->status_interval_ms * 1000;
+	
+	response_buffer = json_get_status(&adapt, true, &response_length);
+	if (client == cur_client) {
+		push_response(response_buffer, response_length);
+	} else {
+		rsp_push_response(client, response_buffer, response_length);
+	}
+	
+	if (c->status_metrics) {
+		rsp_get_queue_status(client, &queue);
+		response_buffer = json_get_metrics(&queue, &response_length);
+		if (client == cur_client) {
+			push_response(response_buffer, response_length);
+		} else {
+			rsp_push_response(client, response_buffer, response_length);
+		}
+	}
+}
+
+
+/**
+ * Get the state status changes are detected in from the Lepton telemetry cached by
+ * lep_task and the client's adaptive stream state
+ */
+static void get_status_key(int client, rsp_adapt_status_t* adapt, cmd_status_key_t* key)
+{
+	lep_tel_cache_t tel;
+	
+	lep_get_tel_cache(&tel);
+	rsp_get_adapt_status(client, adapt);
+	
+	key->tel_valid = tel.valid;
+	key->ffc_state = (tel.status & LEP_STATUS_FFC_STATE) >> 4;
+	key->gain_mode = tel.gain_mode;
+	key->tlin_enabled = tel.tlin_enabled;
+	key->fpa_t_k100 = tel.fpa_t_k100;
+	key->aux_t_k100 = tel.aux_t_k100;
+	key->adapt_target_ms = adapt->target_ms;
+	key->adapt_level = (adapt->target_ms != 0) ? adapt->level : 0;
+}
+
+
+static bool status_changed(const cmd_status_key_t* prev, const cmd_status_key_t* cur)
+{
+	return ((prev->tel_valid != cur->tel_valid) ||
+	        (prev->ffc_state != cur->ffc_state) ||
+	        (prev->gain_mode != cur->gain_mode) ||
+	        (prev->tlin_enabled != cur->tlin_enabled) ||
+	        (abs((int) prev->fpa_t_k100 - (int) cur->fpa_t_k100) >= CMD_STATUS_TEMP_K100) ||
+	        (abs((int) prev->aux_t_k100 - (int) cur->aux_t_k100) >= CMD_STATUS_TEMP_K100) ||
+	        (prev->adapt_target_ms != cur->adapt_target_ms) ||
+	        (prev->adapt_level != cur->adapt_level));
 }
@@ -47,8 +47,31 @@
 #define CMD_RECORD_ON  10
 #define CMD_RECORD_OFF 11
 #define CMD_POWEROFF   12
-#define CMD_UNKNOWN    13
-#define CMD_NUM        13
+#define CMD_SET_IMG_FMT 13
+#define CMD_STREAM_RESYNC 14
+#define CMD_GET_PERF_STATS 15
+#define CMD_GET_RECORD_INFO 16
+#define CMD_GET_RECORD 17
+#define CMD_SET_INTERVAL 18
+#define CMD_GET_SYS_STATS 19
+#define CMD_SET_ANALYTICS 20
+#define CMD_SET_HISTORY 21
+#define CMD_DUMP_HISTORY 22
+#define CMD_SET_ESPNOW 23
+#define CMD_SET_LEPTON 24
+#define CMD_SET_FFC    25
+#define CMD_RUN_FFC    26
+#define CMD_CALIBRATE_SPI 27
+#define CMD_SCAN_WIFI  28
+#define CMD_BATCH      29
+#define CMD_SUBSCRIBE_STATUS 30
+#define CMD_GET_OTA_INFO 31
+#define CMD_OTA_REBOOT 32
+#define CMD_GET_LOG_INFO 33
+#define CMD_GET_LOG    34
+#define CMD_BURST_CAPTURE 35
+#define CMD_UNKNOWN    36
+#define CMD_NUM        36
 
 // Command strings
 #define CMD_GET_STATUS_S "get_status"
@@ -64,6 +87,61 @@
 #define CMD_RECORD_ON_S  "record_on"
 #define CMD_RECORD_OFF_S "record_off"
 #define CMD_POWEROFF_S   "poweroff"
+#define CMD_SET_IMG_FMT_S "set_image_format"
+#define CMD_STREAM_RESYNC_S "stream_resync"
+#define CMD_GET_PERF_STATS_S "get_perf_stats"
+#define CMD_GET_RECORD_INFO_S "get_record_info"
+#define CMD_GET_RECORD_S "get_record"
+#define CMD_SET_INTERVAL_S "set_interval_capture"
+#define CMD_GET_SYS_STATS_S "get_sys_stats"
+#define CMD_SET_ANALYTICS_S "set_analytics"
+#define CMD_SET_HISTORY_S "set_history"
+#define CMD_DUMP_HISTORY_S "dump_history"
+#define CMD_SET_ESPNOW_S "set_espnow"
+#define CMD_SET_LEPTON_S "set_lepton"
+#define CMD_SET_FFC_S    "set_ffc"
+#define CMD_RUN_FFC_S    "run_ffc"
+#define CMD_CALIBRATE_SPI_S "calibrate_spi"
+#define CMD_SCAN_WIFI_S  "scan_wifi"
+#define CMD_BATCH_S      "batch"
+#define CMD_SUBSCRIBE_STATUS_S "subscribe_status"
+#define CMD_GET_OTA_INFO_S "get_ota_info"
+#define CMD_OTA_REBOOT_S "ota_reboot"
+#define CMD_GET_LOG_INFO_S "get_log_info"
+#define CMD_GET_LOG_S    "get_log"
+#define CMD_BURST_CAPTURE_S "burst_capture"
+
+// Interval to check the WiFi connection while waiting for data from the client
+#define CMD_WIFI_CHECK_MSEC 500
+
+// Time the WiFi connection can be lost before the client connections are closed.  Over
+// a shorter drop the connections are kept and resume when the camera rejoins the
+// network with the same address.
+#define CMD_WIFI_LOST_MSEC 5000
+
+// TCP keepalive on client connections: a peer that vanished while its connection was
+// idle is closed after about CMD_KEEPALIVE_IDLE_SEC + CMD_KEEPALIVE_COUNT *
+// CMD_KEEPALIVE_INTVL_SEC seconds
+#define CMD_KEEPALIVE_IDLE_SEC  2
+#define CMD_KEEPALIVE_INTVL_SEC 1
+#define CMD_KEEPALIVE_COUNT     3
+
+// Interval to check if the client a new connection took over has been closed
+#define CMD_TAKEOVER_CHECK_MSEC 20
+
+// Maximum number of commands in a batch command
+#define CMD_BATCH_MAX_CMDS 8
+
+// subscribe_status limits.  Subscribed clients are checked for a status change every
+// CMD_STATUS_CHECK_MSEC (also the shortest interval) and a change of the FPA or housing
+// temperature of at least CMD_STATUS_TEMP_K100 (K * 100) counts as a change.
+#define CMD_STATUS_CHECK_MSEC 100
+#define CMD_STATUS_MAX_MSEC   3600000
+#define CMD_STATUS_TEMP_K100  50
+
+// Interval to check if the next sector of a firmware update can be written while one
+// is received
+#define CMD_OTA_CHECK_MSEC 50
 
 // Delimiters used to wrap json strings sent over the network
 #define CMD_JSON_STRING_START 0x02
@@ -79,6 +157,7 @@
 //
 void cmd_task();
 bool cmd_connected();
-int cmd_get_socket();
+void cmd_client_stalled(int client);
+void cmd_client_closed(int client);
 
 #endif /* CMD_TASK_H */
\ No newline at end of file
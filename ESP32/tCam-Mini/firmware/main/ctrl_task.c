@@ -31,6 +31,7 @@
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "evlog_utilities.h"
 #include "ps_utilities.h"
 #include "system_config.h"
 #include "sys_utilities.h"
@@ -112,6 +113,7 @@ void ctrl_task()
 		ctrl_handle_notifications();
 		ctrl_eval_led_sm();
 		ctrl_eval_sm();
+		ps_update();
 	}
 }
 
@@ -119,6 +121,11 @@ void ctrl_task()
 // Not protected by semaphore since it won't be accessed until after subsequent notification
 void ctrl_set_fault_type(int f)
 {
+	if (f != ctrl_fault_type) {
+		// Written at once since the camera may not recover from a fault
+		evlog_event(EVLOG_EVT_FAULT, f, 0, 0, 0);
+		evlog_flush();
+	}
 	ctrl_fault_type = f;
 	
 	if (f == CTRL_FAULT_NONE) {
@@ -0,0 +1,134 @@
+/*
+ * Encoder Task
+ *
+ * Worker on the core lep_task uses that encodes the second half of each compressed
+ * image while rsp_task encodes the first half.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "enc_task.h"
+#include "pm_utilities.h"
+#include "rice_codec.h"
+#include "sys_utilities.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <stddef.h>
+
+
+
+//
+// Encoder Task internal variables
+//
+static const char* TAG = "enc_task";
+
+// Set once enc_task is waiting for work
+static volatile bool enc_running = false;
+
+// Given by enc_task when it has encoded its part
+static SemaphoreHandle_t enc_done_sem;
+
+// The part of the image enc_task encodes
+static rice_enc_t part_enc;
+static const uint16_t* part_img;
+static const uint16_t* part_ref;
+static int part_width;
+static uint32_t part_start;
+static uint32_t part_end;
+
+// The part of the image the caller encodes
+static rice_enc_t main_enc;
+
+
+
+//
+// Encoder Task API
+//
+
+/**
+ * Create the completion semaphore before the tasks that use it start
+ */
+bool enc_init()
+{
+	enc_done_sem = xSemaphoreCreateBinary();
+	if (enc_done_sem == NULL) {
+		ESP_LOGE(TAG, "Could not create semaphore");
+		return false;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Wait to be notified that a part is ready to encode and encode it
+ */
+void enc_task()
+{
+	ESP_LOGI(TAG, "Start task");
+	
+	enc_running = true;
+	
+	while (1) {
+		(void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		pm_hold(PM_LOCK_ENC);
+		rice_encode_pixels(&part_enc, part_img, part_ref, part_width, part_start, part_end);
+		pm_release(PM_LOCK_ENC);
+		xSemaphoreGive(enc_done_sem);
+	}
+}
+
+
+/**
+ * Encode an image the same as rice_encode_image(), with enc_task encoding the second
+ * half.  Only one task (rsp_task) may call this.  The second half is written into the
+ * end of out and moved down as it is appended to the first half, so each half must
+ * fit in half of out (an image that doesn't would hardly be smaller than raw).
+ */
+uint32_t enc_rice_encode_image(const uint16_t* img, const uint16_t* ref, int width, int height, uint8_t* out, uint32_t max_len)
+{
+	uint32_t n = width * height;
+	uint32_t split = ((n / 2) / RICE_BLOCK_LEN) * RICE_BLOCK_LEN;
+	uint32_t half = max_len / 2;
+	
+	if (!enc_running || (n < ENC_MIN_SPLIT_PIXELS)) {
+		return rice_encode_image(img, ref, width, height, out, max_len);
+	}
+	
+	// Start enc_task on the second half
+	rice_encode_start(&part_enc, out + half, max_len - half);
+	part_img = img;
+	part_ref = ref;
+	part_width = width;
+	part_start = split;
+	part_end = n;
+	xTaskNotifyGive(task_handle_enc);
+	
+	// Encode the first half
+	rice_encode_start(&main_enc, out, half);
+	rice_encode_pixels(&main_enc, img, ref, width, 0, split);
+	
+	// Join them
+	(void) xSemaphoreTake(enc_done_sem, portMAX_DELAY);
+	main_enc.endP = out + max_len;
+	rice_encode_append(&main_enc, &part_enc);
+	
+	return rice_encode_finish(&main_enc);
+}
@@ -0,0 +1,54 @@
+/*
+ * Encoder Task
+ *
+ * Worker on the core lep_task uses that encodes the second half of each compressed
+ * image while rsp_task encodes the first half so image encoding mostly stays off the
+ * core shared with WiFi and lwIP.  It runs below lep_task so it only uses the time
+ * lep_task spends waiting for the next segment.  The halves are joined into the same
+ * bitstream as encoding the image in one pass.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef ENC_TASK_H
+#define ENC_TASK_H
+
+#include "system_config.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//
+// Encoder Task Constants
+//
+
+// Images smaller than this are encoded in one pass (splitting them costs more than it
+// saves)
+#define ENC_MIN_SPLIT_PIXELS 2048
+
+
+
+//
+// Encoder Task API
+//
+bool enc_init();
+void enc_task();
+
+uint32_t enc_rice_encode_image(const uint16_t* img, const uint16_t* ref, int width, int height, uint8_t* out, uint32_t max_len);
+
+#endif /* ENC_TASK_H */
@@ -0,0 +1,204 @@
+/*
+ * ESP-NOW Gateway Task
+ *
+ * Start WiFi as a station on the gateway channel without connecting to an AP, receive
+ * ESP-NOW packets from any camera and write them as serial frames (see gw_task.h).
+ * The receive callback runs in the WiFi task so it only queues packets.  Packets that
+ * arrive while the queue is full are dropped.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "gw_task.h"
+#include "now_task.h"
+#include "driver/uart.h"
+#include "esp_event.h"
+#include "esp_now.h"
+#include "esp_system.h"
+#include "esp_wifi.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "tcpip_adapter.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include <string.h>
+
+
+// Only built into the gateway firmware
+#ifdef CONFIG_TCAM_ESPNOW_GATEWAY
+
+//
+// GW Task typedefs
+//
+typedef struct {
+	uint8_t mac[6];
+	uint8_t len;
+	uint8_t data[NOW_MAX_PKT_LEN];
+} gw_pkt_t;
+
+
+
+//
+// GW Task variables
+//
+static const char* TAG = "gw_task";
+
+static QueueHandle_t gw_queue;
+
+static uint8_t gw_frame[NOW_MAX_PKT_LEN + GW_FRAME_OVERHEAD];
+
+
+
+//
+// GW Task Forward Declarations for internal functions
+//
+static bool init_gateway();
+static void write_frame(gw_pkt_t* pP);
+static void recv_cb(const uint8_t* mac_addr, const uint8_t* data, int len);
+
+
+
+//
+// GW Task API
+//
+void gw_task()
+{
+	gw_pkt_t pkt;
+
+	ESP_LOGI(TAG, "Start task");
+
+	if (!init_gateway()) {
+		ESP_LOGE(TAG, "Gateway init failed");
+		while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
+	}
+
+	ESP_LOGI(TAG, "Listening on channel %d", CONFIG_TCAM_ESPNOW_CHANNEL);
+	esp_log_level_set("*", ESP_LOG_NONE);
+	(void) uart_set_baudrate(UART_NUM_0, GW_UART_BAUD);
+
+	while (1) {
+		if (xQueueReceive(gw_queue, &pkt, portMAX_DELAY) == pdTRUE) {
+			write_frame(&pkt);
+		}
+	}
+}
+
+
+
+//
+// GW Task internal functions
+//
+
+/**
+ * Start the serial port driver, WiFi on the gateway channel and ESP-NOW
+ */
+static bool init_gateway()
+{
+	esp_err_t ret;
+	wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+
+	gw_queue = xQueueCreate(GW_QUEUE_LEN, sizeof(gw_pkt_t));
+	if (gw_queue == NULL) {
+		ESP_LOGE(TAG, "create packet queue failed");
+		return false;
+	}
+
+	// Frames are written by the driver so they aren't changed by the console's line
+	// ending conversion
+	ret = uart_driver_install(UART_NUM_0, 256, sizeof(gw_frame) * 8, 0, NULL, 0);
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "uart_driver_install failed (%d)", ret);
+		return false;
+	}
+
+	ret = nvs_flash_init();
+	if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+		(void) nvs_flash_erase();
+		ret = nvs_flash_init();
+	}
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "nvs_flash_init failed (%d)", ret);
+		return false;
+	}
+
+	tcpip_adapter_init();
+	ret = esp_event_loop_create_default();
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "Could not create event loop (%d)", ret);
+		return false;
+	}
+
+	ret = esp_wifi_init(&cfg);
+	if (ret == ESP_OK) ret = esp_wifi_set_storage(WIFI_STORAGE_RAM);
+	if (ret == ESP_OK) ret = esp_wifi_set_mode(WIFI_MODE_STA);
+	if (ret == ESP_OK) ret = esp_wifi_start();
+	if (ret == ESP_OK) ret = esp_wifi_set_ps(WIFI_PS_NONE);
+	if (ret == ESP_OK) ret = esp_wifi_set_channel(CONFIG_TCAM_ESPNOW_CHANNEL, WIFI_SECOND_CHAN_NONE);
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "Could not start WiFi (%d)", ret);
+		return false;
+	}
+
+	ret = esp_now_init();
+	if (ret == ESP_OK) ret = esp_now_register_recv_cb(recv_cb);
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "Could not start ESP-NOW (%d)", ret);
+		return false;
+	}
+
+	return true;
+}
+
+
+static void write_frame(gw_pkt_t* pP)
+{
+	int i, n;
+	uint8_t sum = 0;
+
+	gw_frame[0] = GW_FRAME_SYNC0;
+	gw_frame[1] = GW_FRAME_SYNC1;
+	gw_frame[2] = pP->len;
+	memcpy(&gw_frame[3], pP->mac, 6);
+	memcpy(&gw_frame[9], pP->data, pP->len);
+	n = 9 + pP->len;
+	for (i=2; i<n; i++) {
+		sum += gw_frame[i];
+	}
+	gw_frame[n++] = sum;
+
+	(void) uart_write_bytes(UART_NUM_0, (const char*) gw_frame, n);
+}
+
+
+/**
+ * Called by the WiFi driver for each packet received
+ */
+static void recv_cb(const uint8_t* mac_addr, const uint8_t* data, int len)
+{
+	gw_pkt_t pkt;
+
+	if ((len <= 0) || (len > NOW_MAX_PKT_LEN)) return;
+
+	memcpy(pkt.mac, mac_addr, 6);
+	pkt.len = len;
+	memcpy(pkt.data, data, len);
+	(void) xQueueSend(gw_queue, &pkt, 0);
+}
+
+#endif /* CONFIG_TCAM_ESPNOW_GATEWAY */
@@ -0,0 +1,64 @@
+/*
+ * ESP-NOW Gateway Task
+ *
+ * The only task in the gateway firmware (CONFIG_TCAM_ESPNOW_GATEWAY).  Receive the
+ * ESP-NOW packets sent by any number of cameras (see now_task.h) on one channel and
+ * forward each, wrapped in a serial frame with the camera's MAC address, over the USB
+ * serial port.  Packets are not reassembled so the gateway needs no per-camera state;
+ * the host puts each camera's messages back together.  Logging is turned off once the
+ * gateway is running so the serial port only carries frames.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GW_TASK_H
+#define GW_TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//
+// GW Task Constants
+//
+
+// Serial port baud rate.  The boot messages are sent at the console baud rate before
+// the gateway switches to this rate.
+#define GW_UART_BAUD 921600
+
+// Number of received packets that can be queued for the serial port
+#define GW_QUEUE_LEN 64
+
+// Serial frame format
+//   0-1    GW_FRAME_SYNC0, GW_FRAME_SYNC1
+//   2      Packet length (n)
+//   3-8    Camera MAC address
+//   9...   Packet (n bytes, see now_task.h)
+//   9+n    Checksum: 8-bit sum of bytes 2 to 8+n
+#define GW_FRAME_SYNC0    0xA5
+#define GW_FRAME_SYNC1    0x5A
+#define GW_FRAME_OVERHEAD 10
+
+
+
+//
+// GW Task API
+//
+void gw_task();
+
+#endif /* GW_TASK_H */
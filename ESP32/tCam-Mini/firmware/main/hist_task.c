@@ -0,0 +1,504 @@
+/*
+ * History Task
+ *
+ * Store each frame in the history ring while a history length is set (see hist_task.h).
+ * Frames are compressed as keyframes so any record can start a dump.  The ring has a
+ * table of record locations, oldest first.  Records older than the history length
+ * are dropped and the oldest records are dropped to make room for a new one, unless
+ * they are held for a dump.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "hist_task.h"
+#include "bin_utilities.h"
+#include "frame_utilities.h"
+#include "perf_utilities.h"
+#include "rsp_task.h"
+#include "rice_codec.h"
+#include "sys_utilities.h"
+#include "system_config.h"
+#include "vospi.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+
+
+//
+// HIST Task typedefs
+//
+
+// Location of a record in the ring
+typedef struct {
+	uint32_t offset;
+	uint32_t len;
+	int64_t usec;                // When the frame was read
+} hist_rec_t;
+
+
+
+//
+// HIST Task variables
+//
+static const char* TAG = "hist_task";
+
+// Ring and record table (shared with rsp_task)
+static SemaphoreHandle_t hist_mutex;
+static uint8_t* hist_bufP;
+static hist_rec_t* hist_recs;
+static uint32_t hist_first;            // Sequence number of the oldest record
+static uint32_t hist_num;              // Number of records
+static uint32_t hist_write;            // Offset of the next record
+static uint32_t hist_seconds;
+
+// Dumps in progress.  Records from hist_hold_seq on can't be dropped while any are.
+static int hist_holds;
+static uint32_t hist_hold_seq;
+
+// Compressed image buffer and the frames skipped because the ring was held full
+static uint8_t* hist_imageP;
+static uint32_t hist_skipped;
+
+// Burst state (the burst's records are held from hist_burst.dump.first on).  A burst
+// requested by cmd_task starts in hist_task, the only task that writes the ring.
+#define BURST_IDLE    0
+#define BURST_START   1
+#define BURST_CAPTURE 2
+#define BURST_SENDING 3
+static int hist_burst_state;
+static uint32_t hist_burst_frames;
+static int hist_burst_encoding;
+static hist_burst_t hist_burst;
+
+static uint8_t hist_header[BIN_MAX_IMAGE_HEADER_LEN];
+
+// Frame broker subscriber id
+static int frame_sub;
+
+
+
+//
+// HIST Task Forward Declarations for internal functions
+//
+static void begin_burst();
+static void capture_burst_frame();
+static bool store_frame(lep_buffer_t* lep_bufP, bool compress);
+static bool make_room(uint32_t len, int64_t t);
+static bool drop_oldest();
+static bool overlaps(hist_rec_t* rP, uint32_t offset, uint32_t len);
+
+
+
+//
+// HIST Task API
+//
+
+/**
+ * Allocate the ring.  Called before the tasks are started.  The low memory build has no
+ * room for it so the history is never enabled.
+ */
+bool hist_init()
+{
+	hist_mutex = xSemaphoreCreateMutex();
+	if (hist_mutex == NULL) {
+		ESP_LOGE(TAG, "create history mutex failed");
+		return false;
+	}
+
+#ifndef CONFIG_TCAM_NO_PSRAM
+	hist_bufP = system_buffer_alloc("history", 0, HIST_BUF_LEN, SYS_BUF_SPIRAM);
+	hist_recs = system_buffer_alloc("history index", 0, HIST_MAX_RECORDS * sizeof(hist_rec_t), SYS_BUF_SPIRAM);
+	hist_imageP = system_buffer_alloc("history image", 0, LEP_NUM_PIXELS*2, SYS_BUF_SPIRAM);
+	if ((hist_bufP == NULL) || (hist_recs == NULL) || (hist_imageP == NULL)) {
+		ESP_LOGE(TAG, "malloc history buffers failed");
+		return false;
+	}
+#endif
+
+	hist_first = 0;
+	hist_num = 0;
+	hist_write = 0;
+	hist_seconds = HIST_DEF_SECONDS;
+	hist_holds = 0;
+	hist_skipped = 0;
+	hist_burst_state = BURST_IDLE;
+
+	return true;
+}
+
+
+void hist_task()
+{
+	uint32_t notification_value;
+	uint32_t missed;
+	lep_buffer_t* lep_bufP;
+
+	ESP_LOGI(TAG, "Start task");
+
+	frame_sub = frame_subscribe(xTaskGetCurrentTaskHandle(), HIST_NOTIFY_LEP_FRAME_MASK);
+
+	while (1) {
+		notification_value = 0;
+		if (xTaskNotifyWait(0x00, 0xFFFFFFFF, &notification_value, pdMS_TO_TICKS(HIST_TASK_MAX_WAIT_MSEC))) {
+			// Start a burst requested by cmd_task between frames
+			if (Notification(notification_value, HIST_NOTIFY_BURST_MASK)) {
+				begin_burst();
+			}
+
+			// Handle lep_task notifications
+			if (Notification(notification_value, HIST_NOTIFY_LEP_FRAME_MASK)) {
+				if (hist_burst_state == BURST_CAPTURE) {
+					capture_burst_frame();
+				} else if (hist_get_seconds() != 0) {
+					lep_bufP = frame_acquire(frame_sub, &missed);
+					if (lep_bufP != NULL) {
+						(void) store_frame(lep_bufP, true);
+						frame_release(lep_bufP);
+					}
+				} else {
+					(void) frame_skip(frame_sub);
+				}
+			}
+		}
+	}
+}
+
+
+// Called by cmd_task to set the history length (0 to stop storing frames).  Records
+// past a shorter length are dropped with the next frame.
+void hist_set_seconds(uint32_t seconds)
+{
+	if (seconds > HIST_MAX_SECONDS) seconds = HIST_MAX_SECONDS;
+#ifdef CONFIG_TCAM_NO_PSRAM
+	seconds = 0;
+#endif
+
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	hist_seconds = seconds;
+	if ((seconds == 0) && (hist_holds == 0)) {
+		hist_num = 0;
+	}
+	xSemaphoreGive(hist_mutex);
+}
+
+
+uint32_t hist_get_seconds()
+{
+	uint32_t seconds;
+
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	seconds = hist_seconds;
+	xSemaphoreGive(hist_mutex);
+
+	return seconds;
+}
+
+
+// Called by rsp_task to start a dump.  The records in the ring are held until
+// hist_release() and dump is loaded with them.  Returns false if there are none (or
+// the ring holds a burst).
+bool hist_hold(hist_dump_t* dump)
+{
+	uint32_t i;
+
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	dump->first = hist_first;
+	dump->num = (hist_burst_state == BURST_IDLE) ? hist_num : 0;
+	dump->length = 0;
+	for (i=0; i<dump->num; i++) {
+		dump->length += hist_recs[(hist_first + i) % HIST_MAX_RECORDS].len;
+	}
+	if (dump->num != 0) {
+		if (hist_holds++ == 0) {
+			hist_hold_seq = hist_first;
+		}
+	}
+	xSemaphoreGive(hist_mutex);
+
+	return (dump->num != 0);
+}
+
+
+// Called by rsp_task to get a held record.  The record may be sent straight from the
+// ring until the hold is released.  Returns false if seq isn't in the ring.
+bool hist_get_record(uint32_t seq, uint8_t** bufP, uint32_t* len)
+{
+	bool valid;
+	hist_rec_t* rP;
+
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	valid = ((seq - hist_first) < hist_num);
+	if (valid) {
+		rP = &hist_recs[seq % HIST_MAX_RECORDS];
+		*bufP = hist_bufP + rP->offset;
+		*len = rP->len;
+	}
+	xSemaphoreGive(hist_mutex);
+
+	return valid;
+}
+
+
+// Called by rsp_task when a dump is done (or its client disconnected)
+void hist_release()
+{
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	if (hist_holds > 0) {
+		hist_holds--;
+	}
+	xSemaphoreGive(hist_mutex);
+}
+
+
+// Called by cmd_task to capture the next num_frames frames (up to HIST_MAX_RECORDS)
+// for a client.  hist_task discards the frames in the history and starts the burst
+// with the next frame published.  Returns false if a burst or dump is in progress (or
+// there is no ring).
+bool hist_start_burst(int client, uint32_t num_frames, int encoding)
+{
+	bool started = false;
+
+	if (hist_bufP == NULL) return false;
+	if (num_frames > HIST_MAX_RECORDS) num_frames = HIST_MAX_RECORDS;
+
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	if ((hist_burst_state == BURST_IDLE) && (hist_holds == 0) && (num_frames != 0)) {
+		// Holding the ring keeps dumps from starting until the burst has been sent
+		hist_holds = 1;
+		hist_burst_frames = num_frames;
+		hist_burst_encoding = encoding;
+		memset(&hist_burst, 0, sizeof(hist_burst_t));
+		hist_burst.client = client;
+		hist_burst_state = BURST_START;
+		started = true;
+	}
+	xSemaphoreGive(hist_mutex);
+
+	if (started) {
+		vTaskPrioritySet(task_handle_hist, TASK_HIST_BURST_PRIO);
+		xTaskNotify(task_handle_hist, HIST_NOTIFY_BURST_MASK, eSetBits);
+	}
+
+	return started;
+}
+
+
+// Called by rsp_task to get the completed burst it was told to send.  The records are
+// held until hist_end_burst().  Returns false if there is no completed burst.
+bool hist_get_burst(hist_burst_t* burst)
+{
+	bool valid;
+
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	valid = (hist_burst_state == BURST_SENDING);
+	if (valid) {
+		*burst = hist_burst;
+	}
+	xSemaphoreGive(hist_mutex);
+
+	return valid;
+}
+
+
+// Called by rsp_task when a burst has been sent (or couldn't be) to release its records
+void hist_end_burst()
+{
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	if (hist_burst_state == BURST_SENDING) {
+		hist_burst_state = BURST_IDLE;
+		if (hist_holds > 0) {
+			hist_holds--;
+		}
+	}
+	xSemaphoreGive(hist_mutex);
+}
+
+
+
+//
+// Internal functions
+//
+
+/**
+ * Empty the ring for a requested burst.  Frames published before the burst started
+ * aren't part of it.
+ */
+static void begin_burst()
+{
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	if (hist_burst_state == BURST_START) {
+		hist_first += hist_num;
+		hist_num = 0;
+		hist_write = 0;
+		hist_hold_seq = hist_first;
+		hist_burst.dump.first = hist_first;
+		hist_burst_state = BURST_CAPTURE;
+	}
+	xSemaphoreGive(hist_mutex);
+
+	(void) frame_skip(frame_sub);
+}
+
+
+/**
+ * Store the next frame of a burst and, once num_frames have been stored or the ring is
+ * full, hand the burst to rsp_task for its client
+ */
+static void capture_burst_frame()
+{
+	lep_buffer_t* lep_bufP;
+	uint32_t missed;
+	uint32_t i;
+	bool stored;
+	bool done = false;
+
+	lep_bufP = frame_acquire(frame_sub, &missed);
+	if (lep_bufP == NULL) return;
+	stored = store_frame(lep_bufP, hist_burst_encoding == HIST_BURST_RICE);
+	frame_release(lep_bufP);
+
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	hist_burst.missed += missed;
+	if (!stored || (hist_num >= hist_burst_frames)) {
+		hist_burst.complete = stored;
+		hist_burst.dump.num = hist_num;
+		for (i=0; i<hist_num; i++) {
+			hist_burst.dump.length += hist_recs[(hist_first + i) % HIST_MAX_RECORDS].len;
+		}
+		hist_burst_state = BURST_SENDING;
+		done = true;
+	}
+	xSemaphoreGive(hist_mutex);
+
+	if (done) {
+		vTaskPrioritySet(NULL, TASK_HIST_PRIO);
+		ESP_LOGI(TAG, "Burst of %d frames (%d missed) for client %d", hist_burst.dump.num, hist_burst.missed,
+		         hist_burst.client);
+		rsp_dump_burst(hist_burst.client);
+	}
+}
+
+
+/**
+ * Add a frame to the ring, compressed if compress is set.  Returns false if there is
+ * no room for it.
+ */
+static bool store_frame(lep_buffer_t* lep_bufP, bool compress)
+{
+	uint8_t encoding = BIN_ENC_RICE;
+	uint8_t* imgP = hist_imageP;
+	uint8_t* dstP;
+	uint32_t offset;
+	uint32_t img_len, hdr_len, telem_len, len;
+	int64_t tb;
+
+	if (compress) {
+		tb = esp_timer_get_time();
+		img_len = rice_encode_image(lep_bufP->lep_bufferP, NULL, LEP_WIDTH, LEP_HEIGHT, hist_imageP, LEP_NUM_PIXELS*2);
+		perf_record(PERF_STAGE_RICE_ENC, tb);
+	} else {
+		img_len = 0;
+	}
+	if (img_len == 0) {
+		// Incompressible frames are stored raw
+		encoding = BIN_ENC_RAW;
+		imgP = (uint8_t*) lep_bufP->lep_bufferP;
+		img_len = LEP_NUM_PIXELS*2;
+	}
+
+	hdr_len = bin_get_image_header(hist_header, lep_bufP, LEP_WIDTH, LEP_HEIGHT, encoding, img_len, 0);
+	telem_len = bin_get_image_telem_len(lep_bufP, 0);
+	len = hdr_len + img_len + telem_len;
+
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	if (!make_room(len, lep_bufP->vsync_usec)) {
+		hist_skipped++;
+		xSemaphoreGive(hist_mutex);
+		return false;
+	}
+	offset = hist_write;
+	dstP = hist_bufP + offset;
+	xSemaphoreGive(hist_mutex);
+
+	// The new record isn't visible to rsp_task until it is in the table
+	memcpy(dstP, hist_header, hdr_len);
+	memcpy(dstP + hdr_len, imgP, img_len);
+	if (telem_len != 0) {
+		memcpy(dstP + hdr_len + img_len, lep_bufP->lep_telemP, telem_len);
+	}
+
+	xSemaphoreTake(hist_mutex, portMAX_DELAY);
+	hist_recs[(hist_first + hist_num) % HIST_MAX_RECORDS].offset = offset;
+	hist_recs[(hist_first + hist_num) % HIST_MAX_RECORDS].len = len;
+	hist_recs[(hist_first + hist_num) % HIST_MAX_RECORDS].usec = lep_bufP->vsync_usec;
+	hist_num++;
+	hist_write = offset + len;
+	xSemaphoreGive(hist_mutex);
+
+	return true;
+}
+
+
+/**
+ * Drop records older than the history length and the records in the way of a new
+ * record of len bytes, wrapping to the start of the ring if it doesn't fit at the end.
+ * Returns false if a held record is in the way.  Called holding hist_mutex.
+ */
+static bool make_room(uint32_t len, int64_t t)
+{
+	while ((hist_num != 0) && ((t - hist_recs[hist_first % HIST_MAX_RECORDS].usec) > ((int64_t) hist_seconds * 1000000))) {
+		if (!drop_oldest()) break;
+	}
+
+	if (hist_num == HIST_MAX_RECORDS) {
+		if (!drop_oldest()) return false;
+	}
+
+	if ((HIST_BUF_LEN - hist_write) < len) {
+		hist_write = 0;
+	}
+	while ((hist_num != 0) && overlaps(&hist_recs[hist_first % HIST_MAX_RECORDS], hist_write, len)) {
+		if (!drop_oldest()) return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * Drop the oldest record unless it is held.  Called holding hist_mutex.
+ */
+static bool drop_oldest()
+{
+	if ((hist_holds != 0) && ((hist_first - hist_hold_seq) < 0x80000000)) return false;
+
+	hist_first++;
+	hist_num--;
+
+	return true;
+}
+
+
+static bool overlaps(hist_rec_t* rP, uint32_t offset, uint32_t len)
+{
+	return ((rP->offset < (offset + len)) && ((rP->offset + rP->len) > offset));
+}
@@ -0,0 +1,110 @@
+/*
+ * History Task
+ *
+ * Keep the last few seconds of frames in a PSRAM ring so the moments before an event
+ * can be sent to a client after it happens.  Each frame is taken from the frame broker,
+ * compressed and stored as a binary image (see bin_utilities.h) exactly as it would be
+ * sent to a client using the compressed binary image format, including its
+ * BIN_TLV_TIMESTAMP.  Records are contiguous in the ring (the ring wraps before a
+ * record that might not fit) so one can be sent straight from the ring.
+ *
+ * A dump (the dump_history command or an analytics alarm) holds the records in the
+ * ring when it starts while rsp_task sends them.  Held records are not overwritten.
+ * Frames keep being stored in the free part of the ring and are skipped, once it is
+ * full, until the dump is done.
+ *
+ * A burst (the burst_capture command) empties the ring and stores the next num_frames
+ * consecutive frames, held from the start, with the task raised above rsp_task so
+ * sending to clients can't make it miss frames.  When the burst is complete (or the
+ * ring is full) rsp_task sends it to the client that asked for it as fast as the link
+ * allows and the history resumes once it has been sent.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef HIST_TASK_H
+#define HIST_TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//
+// HIST Task Constants
+//
+
+// Maximum time to block waiting for a notification
+#define HIST_TASK_MAX_WAIT_MSEC 1000
+
+// Ring size (PSRAM) and the maximum number of records it holds.  Compressed frames
+// are typically 15-25 kB so the ring holds about 10 seconds of a radiometric stream
+// at the Lepton's full frame rate.
+#define HIST_BUF_LEN       (2 * 1024 * 1024)
+#define HIST_MAX_RECORDS   512
+
+// Longest history that may be configured (seconds) and the power-on setting (0 =
+// disabled)
+#define HIST_MAX_SECONDS   30
+#define HIST_DEF_SECONDS   0
+
+// Burst encodings
+#define HIST_BURST_RAW     0
+#define HIST_BURST_RICE    1
+
+// History Task notifications
+#define HIST_NOTIFY_LEP_FRAME_MASK  0x00000010
+#define HIST_NOTIFY_BURST_MASK      0x00000020
+
+
+
+//
+// HIST Task typedefs
+//
+
+// Records held for a dump
+typedef struct {
+	uint32_t first;              // Sequence number of the oldest record
+	uint32_t num;                // Number of records
+	uint32_t length;             // Total bytes
+} hist_dump_t;
+
+// Completed burst
+typedef struct {
+	hist_dump_t dump;
+	int client;
+	uint32_t missed;             // Frames the task missed during the burst
+	bool complete;               // False if the ring filled before num_frames were stored
+} hist_burst_t;
+
+
+
+//
+// HIST Task API
+//
+bool hist_init();
+void hist_task();
+void hist_set_seconds(uint32_t seconds);
+uint32_t hist_get_seconds();
+bool hist_hold(hist_dump_t* dump);
+bool hist_get_record(uint32_t seq, uint8_t** bufP, uint32_t* len);
+void hist_release();
+bool hist_start_burst(int client, uint32_t num_frames, int encoding);
+bool hist_get_burst(hist_burst_t* burst);
+void hist_end_burst();
+
+#endif /* HIST_TASK_H */
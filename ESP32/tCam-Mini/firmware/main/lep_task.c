@@ -3,7 +3,9 @@
  *
  * Contains functions to initialize the Lepton and then sampling images from it,
  * making those available to other tasks through a shared buffer and event
- * interface.
+ * interface.  A second Lepton (CONFIG_TCAM_DUAL_LEPTON) is read by the same task:
+ * segments are read in the order the vsyncs of the two Leptons occurred so both
+ * reads fit in the shared segment periods.
  *
  * Copyright 2020 Dan Julio
  *
@@ -24,19 +26,27 @@
  *
  */
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
 #include "ctrl_task.h"
 #include "esp_system.h"
 #include "esp_log.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
 #include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "lep_task.h"
-#include "rsp_task.h"
 #include "lepton_utilities.h"
 #include "cci.h"
 #include "vospi.h"
+#include "evlog_utilities.h"
+#include "frame_utilities.h"
+#include "perf_utilities.h"
+#include "pm_utilities.h"
+#include "ps_utilities.h"
 #include "sys_utilities.h"
 #include "system_config.h"
 
@@ -45,14 +55,13 @@
 // LEP Task constants
 //
 
-// Uncomment to log image acquisition timestamps
-//#define LOG_ACQ_TIMESTAMP
-
 // States
 #define STATE_INIT      0
 #define STATE_RUN       1
 #define STATE_RE_INIT   2
 #define STATE_ERROR     3
+#define STATE_FFC_WAIT  4
+#define STATE_SLEEP     5
 
 
 //
@@ -60,6 +69,132 @@
 //
 static const char* TAG = "lep_task";
 
+// Timestamp of the most recent vsync edge of each Lepton and if it hasn't been read
+// yet (written by vsync_isr)
+static portMUX_TYPE vsync_mux = portMUX_INITIALIZER_UNLOCKED;
+static int64_t vsync_edge_usec[LEP_NUM_LEPTONS];
+static bool vsync_pending[LEP_NUM_LEPTONS];
+static uint32_t vsync_isr_count;
+static uint32_t vsync_isr_usec;
+
+// vsync GPIO of each Lepton
+static const int vsync_io[] = {LEP_VSYNC_IO, LEP2_VSYNC_IO};
+
+// When wait_vsync() last returned a vsync from the first Lepton (or gave up on one)
+static int64_t vsync_wait_usec;
+
+// Time a FFC was last seen in telemetry and when the current one was first seen (0 if
+// none is running)
+static int64_t ffc_seen_usec;
+static int64_t ffc_start_usec;
+
+// Telemetry of the most recent frame (read by other tasks)
+static portMUX_TYPE tel_mux = portMUX_INITIALIZER_UNLOCKED;
+static lep_tel_cache_t tel_cache;
+
+// Interval capture settings (written by other tasks)
+static portMUX_TYPE interval_mux = portMUX_INITIALIZER_UNLOCKED;
+static lep_interval_t interval_req;
+static bool interval_updated = false;
+
+// Interval capture state (lep_task only)
+static lep_interval_t interval;
+static int64_t next_capture_usec;
+static int64_t settle_until_usec;
+static uint32_t capture_count;
+
+// Frame number for low latency stream segments
+static uint32_t seg_frame_num;
+
+// Raw packet batch being loaded for passthrough streams and the number of the next
+// packet tapped
+static lep_pkt_batch_t* pkt_batchP = NULL;
+static uint32_t pkt_num;
+
+// Capture sequence state - the last sequence number and the telemetry frame counter
+// of that frame (fc_valid is cleared when the Lepton restarts its counter)
+static uint32_t frame_seq;
+static uint32_t seq_last_fc;
+static uint32_t seq_fc_step;
+static bool seq_fc_valid = false;
+
+// FFC scheduler settings and state shared with other tasks
+static portMUX_TYPE ffc_mux = portMUX_INITIALIZER_UNLOCKED;
+static lep_ffc_sched_t ffc_req = {
+	LEP_FFC_MODE_AUTO,
+	LEP_FFC_DEF_DRIFT_K100,
+	LEP_FFC_DEF_MOTION,
+	LEP_FFC_DEF_QUIET_MSEC,
+	LEP_FFC_DEF_MIN_MSEC,
+	LEP_FFC_DEF_MAX_WAIT_MSEC
+};
+static bool ffc_updated = false;
+static bool ffc_approved = false;
+static lep_ffc_status_t ffc_status;
+
+// FFC scheduler state used by this task (ffc_mode_set is cleared when the Lepton is
+// initialized so its FFC mode is set again)
+static lep_ffc_sched_t ffc_sched = {LEP_FFC_MODE_AUTO};
+static bool ffc_mode_set = true;
+static int64_t ffc_due_usec;
+static int64_t ffc_still_usec;
+static int64_t ffc_run_usec;
+static bool ffc_ref_valid;
+static uint16_t ffc_blocks[LEP_FFC_NUM_BLOCKS];
+static uint16_t ffc_ref[LEP_FFC_NUM_BLOCKS];
+
+// SPI clock calibration request (written by other tasks) and state - the Lepton being
+// calibrated and when the measurement of its current step starts (after settling)
+static portMUX_TYPE spi_cal_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool spi_cal_requested = false;
+static volatile bool spi_cal_running = false;
+static int spi_cal_lep;
+static vospi_cal_t spi_cal;
+static int64_t spi_cal_start_usec;
+
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+// Second Lepton capture state - the buffer being loaded, vsyncs since its last frame
+// and its last sequence number
+static lep_buffer_t* lep2_bufP;
+static int lep2_vsync_count;
+static uint32_t lep2_frame_seq;
+#endif
+
+
+//
+// LEP Task Forward Declarations for internal functions
+//
+static bool init_leptons();
+static bool reset_init_leptons();
+static bool vsync_intr_init();
+static void vsync_isr(void* arg);
+static bool wait_vsync(int* lep, int64_t* vsync_usec);
+static void drop_vsync();
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+static void read_second_lepton(int64_t vsync_usec);
+#endif
+static void note_ffc_state(lep_buffer_t* bufP);
+static void update_tel_cache(lep_buffer_t* bufP);
+static void set_frame_seq(lep_buffer_t* bufP);
+static bool ffc_in_progress();
+static void publish_segment(lep_buffer_t* bufP);
+static void tap_packets(int lep, const uint8_t* pktP, int numPkts);
+static void flush_packets();
+static int resync_delay_msec(int attempt);
+static void interval_check_update();
+static bool interval_keep_frame();
+static void interval_note_capture();
+static bool interval_capture_done();
+static bool interval_wake_due();
+static void interval_estimate(lep_interval_t* info);
+static void ffc_check_update();
+static void ffc_schedule_frame(lep_buffer_t* bufP);
+static bool ffc_scene_still(lep_buffer_t* bufP, int64_t t);
+static void ffc_run(int64_t t, uint32_t* counter);
+static void spi_cal_check();
+static void spi_cal_start_lepton(int64_t t);
+static bool spi_cal_set_step(int64_t t);
+
 
 
 //
@@ -72,27 +207,56 @@ static const char* TAG = "lep_task";
  */
 void lep_task()
 {
+	int i;
 	int task_state = STATE_INIT;
-	int rsp_buf_index = 0;
+	lep_buffer_t* cur_bufP;
+	lep_buffer_t* next_bufP;
+	bool got_vsync;
+	int vsync_lep;
 	int vsync_count = 0;
 	int sync_fail_count = 0;
+	int realign_count = 0;
 	int reset_fail_count = 0;
+	bool recovering = false;
 	int64_t vsyncDetectedUsec;
+	int64_t last_frame_usec = 0;
 	
 	ESP_LOGI(TAG, "Start task");
 	
-	// Attempt to initialize the VoSPI interface
-	if (vospi_init() != ESP_OK) {
-		ESP_LOGE(TAG, "Lepton VoSPI initialization failed");
+	// Attempt to initialize the VoSPI interfaces (at their calibrated SPI clocks)
+	for (i=0; i<LEP_NUM_LEPTONS; i++) {
+		(void) vospi_set_spi_freq(i, ps_get_spi_freq(i));
+		if (vospi_init(i) != ESP_OK) {
+			ESP_LOGE(TAG, "Lepton %d VoSPI initialization failed", i);
+			ctrl_set_fault_type(CTRL_FAULT_LEP_VOSPI);
+			vTaskDelete(NULL);
+		}
+		vospi_set_packet_tap(i, tap_packets);
+	}
+	
+	// Setup the vsync interrupt (serviced on this core)
+	if (!vsync_intr_init()) {
+		ESP_LOGE(TAG, "Lepton vsync interrupt initialization failed");
 		ctrl_set_fault_type(CTRL_FAULT_LEP_VOSPI);
 		vTaskDelete(NULL);
 	}
+	
+	// Get the first buffers to load
+	cur_bufP = frame_get_free();
+	vospi_set_frame_buffer(0, cur_bufP);
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+	lep2_bufP = frame_get_free();
+	vospi_set_frame_buffer(1, lep2_bufP);
+#endif
 
 	while (true) {
 		switch (task_state) {
 			case STATE_INIT:  // After power-on reset
-				if (lepton_init()) {
+				// Wait for the Lepton to finish booting from the reset in system_peripheral_init
+				// or, after a warm start, check it is still configured (resetting it if not)
+				if (init_leptons() || (lepton_is_warm() && reset_init_leptons())) {
 					task_state = STATE_RUN;
+					drop_vsync();
 				} else {
 					ESP_LOGE(TAG, "Lepton CCI initialization failed");
 					ctrl_set_fault_type(CTRL_FAULT_LEP_CCI);
@@ -103,69 +267,149 @@ void lep_task()
 				}
 				break;
 			
-			case STATE_RUN:   // Initialized and running
-				// Spin waiting for vsync to be asserted
-				while (gpio_get_level(LEP_VSYNC_IO) == 0) {
-					vTaskDelay(pdMS_TO_TICKS(9));
-				}
-				vsyncDetectedUsec = esp_timer_get_time();
+			case STATE_RUN:       // Initialized and running
+			case STATE_FFC_WAIT:  // Running but the Lepton is performing a FFC
+				// Publish the last raw packets of the previous segment read and step any
+				// SPI clock calibration between segment reads
+				flush_packets();
+				spi_cal_check();
 				
-				// Attempt to process a segment
-				if (vospi_transfer_segment(vsyncDetectedUsec)) {
+				// Wait for vsync and attempt to process a segment (a missing vsync is
+				// handled like a failed segment so the resync logic below still runs).
+				// Segments from a second Lepton are read as their vsyncs come up.  The CPUs
+				// only run at full speed from a vsync until the next wait.
+				pm_release(PM_LOCK_LEP);
+				got_vsync = wait_vsync(&vsync_lep, &vsyncDetectedUsec);
+				if (got_vsync) pm_hold(PM_LOCK_LEP);
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+				if (got_vsync && (vsync_lep != 0)) {
+					read_second_lepton(vsyncDetectedUsec);
+					break;
+				}
+#endif
+				if (got_vsync && vospi_transfer_segment(0, vsyncDetectedUsec)) {
 					// Got image
 					vsync_count = 0;
+					if (task_state == STATE_FFC_WAIT) {
+						ESP_LOGI(TAG, "FFC done");
+						task_state = STATE_RUN;
+					}
 					
-					// Copy the frame to the current half of the shared buffer and let rsp_task know
-					xSemaphoreTake(rsp_lep_buffer[rsp_buf_index].lep_mutex, portMAX_DELAY);
-					vospi_get_frame(&rsp_lep_buffer[rsp_buf_index]);
-					xSemaphoreGive(rsp_lep_buffer[rsp_buf_index].lep_mutex);
-#ifdef LOG_ACQ_TIMESTAMP
-					ESP_LOGI(TAG, "Push into buf %d", rsp_buf_index);
-#endif
-					if (rsp_buf_index == 0) {
-						xTaskNotify(task_handle_rsp, RSP_NOTIFY_LEP_FRAME_MASK_0, eSetBits);
-						rsp_buf_index = 1;
-					} else {
-						xTaskNotify(task_handle_rsp, RSP_NOTIFY_LEP_FRAME_MASK_1, eSetBits);
-						rsp_buf_index = 0;
+					// Publish the frame (loaded in place) to its subscribers and start loading another
+					// buffer.  Frames outside an interval capture, or while subscribers hold every other
+					// buffer, are dropped and their buffer reused so lep_task never waits for one.
+					vospi_finish_frame(0, cur_bufP);
+					cur_bufP->vsync_usec = vsyncDetectedUsec;
+					cur_bufP->ready_usec = esp_timer_get_time();
+					set_frame_seq(cur_bufP);
+					if (cur_bufP->telem_valid) {
+						note_ffc_state(cur_bufP);
+						update_tel_cache(cur_bufP);
+					}
+					ffc_schedule_frame(cur_bufP);
+					publish_segment(cur_bufP);
+					interval_check_update();
+					if (interval_keep_frame()) {
+						if ((next_bufP = frame_try_get_free()) != NULL) {
+							frame_publish(cur_bufP);
+							perf_count(PERF_CNT_FRAMES);
+							interval_note_capture();
+							cur_bufP = next_bufP;
+						} else {
+							// Not counted as an interval capture so the next frame is tried instead
+							perf_count(PERF_CNT_FRAME_HELD);
+						}
 					}
+					vospi_set_frame_buffer(0, cur_bufP);
 					
 					// Clear the resynchronization fault indication if necessary (since we are working again)
 					if (sync_fail_count >= LEP_SYNC_FAIL_FAULT_LIMIT) {
 						ctrl_set_fault_type(CTRL_FAULT_NONE);
 					}
+					// Note how long it took to recover if necessary
+					if (recovering && (last_frame_usec != 0)) {
+						perf_record(PERF_STAGE_RECOVER, last_frame_usec);
+					}
+					recovering = false;
+					last_frame_usec = esp_timer_get_time();
+					
 					// Hold fault counters reset while operating
 					sync_fail_count = 0;
+					realign_count = 0;
 					reset_fail_count = 0;
+					
+					// Power down the Lepton until the next interval capture
+					if (interval_capture_done()) {
+						ESP_LOGI(TAG, "Power down Lepton");
+						lepton_power_down();
+						seq_fc_valid = false;
+						task_state = STATE_SLEEP;
+					}
 				} else {
+					publish_segment(cur_bufP);
+					
+					// Telemetry sent as a header is available after the first segment so
+					// a FFC starting is seen a frame earlier
+					if (vospi_telem_ready(0)) {
+						note_ffc_state(cur_bufP);
+					}
+					
 					// We should see a valid frame every 12 vsync interrupts (one frame period).
 					// However, since we may be resynchronizing with the VoSPI stream and our task
 					// may be interrupted by other tasks, we give the lepton extra frame periods
-					// to start correctly streaming data.  We may still fail when the lepton runs
-					// a FFC since that takes a long time.
-					if (++vsync_count == 36) {
+					// to start correctly streaming data.  The lepton stops sending valid frames
+					// while it runs a FFC so we just quietly wait for it to finish.
+					if (ffc_in_progress()) {
 						vsync_count = 0;
-						ESP_LOGI(TAG, "Could not get lepton image");
-						
-						// Pause to allow resynchronization
-						// (Lepton 3.5 data sheet section 4.2.3.3.1 "Establishing/Re-Establishing Sync")
-						vTaskDelay(pdMS_TO_TICKS(185));
+						if (task_state != STATE_FFC_WAIT) {
+							ESP_LOGI(TAG, "Waiting for FFC");
+							task_state = STATE_FFC_WAIT;
+						}
+					} else {
+						if (task_state == STATE_FFC_WAIT) {
+							ESP_LOGI(TAG, "FFC wait expired");
+							task_state = STATE_RUN;
+						}
 						
-						// Check for too many consecutive resynchronization failures.
-						// This should only occur if something has gone wrong.
-						if (sync_fail_count++ == LEP_SYNC_FAIL_FAULT_LIMIT) {
-							ctrl_set_fault_type(CTRL_FAULT_LEP_SYNC);
-							if (reset_fail_count == 0) {
-								// Reset the first time
-								task_state = STATE_RE_INIT;
-							} else {
-								ESP_LOGE(TAG, "Could not sync to VoSPI after task reset");
-								
-								// Possibly permanent error condition
-								task_state = STATE_ERROR;
-								
-								// Use reset_fail_count as a timer
-								reset_fail_count = LEP_RESET_FAIL_RETRY_SECS;
+						if (++vsync_count == 36) {
+							vsync_count = 0;
+							ESP_LOGI(TAG, "Could not get lepton image");
+							recovering = true;
+							
+							if (realign_count < LEP_REALIGN_ATTEMPTS) {
+								// First try to re-align with the segment phase by dropping the partial
+								// frame and any pending vsync and start reading again on the next vsync
+								realign_count++;
+								perf_count(PERF_CNT_REALIGN);
+								vospi_resync(0);
+								drop_vsync();
+								break;
+							}
+							
+							// Pause with CS de-asserted to allow resynchronization, backing off as
+							// attempts fail
+							// (Lepton 3.5 data sheet section 4.2.3.3.1 "Establishing/Re-Establishing Sync")
+							perf_count(PERF_CNT_RESYNC);
+							vTaskDelay(pdMS_TO_TICKS(resync_delay_msec(sync_fail_count)));
+							vospi_resync(0);
+							drop_vsync();
+							
+							// Check for too many consecutive resynchronization failures.
+							// This should only occur if something has gone wrong.
+							if (sync_fail_count++ == LEP_SYNC_FAIL_FAULT_LIMIT) {
+								ctrl_set_fault_type(CTRL_FAULT_LEP_SYNC);
+								if (reset_fail_count == 0) {
+									// Reset the first time
+									task_state = STATE_RE_INIT;
+								} else {
+									ESP_LOGE(TAG, "Could not sync to VoSPI after task reset");
+									
+									// Possibly permanent error condition
+									task_state = STATE_ERROR;
+									
+									// Use reset_fail_count as a timer
+									reset_fail_count = LEP_RESET_FAIL_RETRY_SECS;
+								}
 							}
 						}
 					}
@@ -174,18 +418,18 @@ void lep_task()
 			
 			case STATE_RE_INIT:  // Reset and re-init
 				ESP_LOGI(TAG,  "Reset Lepton");
+				perf_count(PERF_CNT_LEP_RESET);
+				recovering = true;
 				
-				// Assert hardware reset
-				gpio_set_level(LEP_RESET_IO, 1);
-				vTaskDelay(pdMS_TO_TICKS(10));
-				gpio_set_level(LEP_RESET_IO, 0);
-				
-				// Delay for Lepton internal initialization (max 950 mSec)
-    			vTaskDelay(pdMS_TO_TICKS(1000));
+				// Assert hardware reset and wait for the Lepton to boot
+				lepton_reset();
+				seq_fc_valid = false;
     			
     			// Attempt to re-initialize the Lepton
-    			if (lepton_init()) {
+    			if (init_leptons()) {
 					task_state = STATE_RUN;
+					vospi_resync(0);
+					drop_vsync();
 					
 					// Note the reset
     				reset_fail_count = 1;
@@ -199,6 +443,35 @@ void lep_task()
 				}
 				break;
 			
+			case STATE_SLEEP:  // Lepton powered down between interval captures
+				interval_check_update();
+				if (!interval_wake_due()) {
+					vTaskDelay(pdMS_TO_TICKS(LEP_INTERVAL_POLL_MSEC));
+					break;
+				}
+				
+				// Wake the Lepton early enough for it to boot and settle before the capture
+				ESP_LOGI(TAG, "Wake Lepton");
+				lepton_reset();
+				seq_fc_valid = false;
+				if (init_leptons()) {
+					// Start looking for a frame, ignoring any vsync seen during boot
+					vospi_resync(0);
+					drop_vsync();
+					settle_until_usec = esp_timer_get_time() + ((int64_t) interval.settle_msec * 1000);
+					last_frame_usec = 0;
+					vsync_count = 0;
+					task_state = STATE_RUN;
+				} else {
+					ESP_LOGE(TAG, "Lepton CCI initialization failed");
+					ctrl_set_fault_type(CTRL_FAULT_LEP_CCI);
+					
+					task_state = STATE_ERROR;
+					// Use reset_fail_count as a timer
+					reset_fail_count = LEP_RESET_FAIL_RETRY_SECS;
+				}
+				break;
+			
 			case STATE_ERROR:  // Initialization or re-init failed
 				// Do nothing for a good long while
 				vTaskDelay(pdMS_TO_TICKS(1000));
@@ -213,3 +486,922 @@ void lep_task()
 		}
 	}
 }
+
+
+
+/**
+ * Configure interval capture: capture num_frames (1 - LEP_INTERVAL_MAX_FRAMES) every
+ * interval_ms mSec, discarding frames for settle_ms mSec after the Lepton wakes.  The
+ * Lepton is powered down between captures for intervals of at least
+ * LEP_INTERVAL_MIN_MSEC that are long enough for it to wake, settle and capture in less
+ * than half the interval.  An interval_ms of 0 returns to continuous operation.  The
+ * first capture starts immediately (after settling if the Lepton was powered down).
+ */
+void lep_set_interval_capture(uint32_t interval_ms, uint32_t num_frames, uint32_t settle_ms)
+{
+	if (num_frames < 1) num_frames = 1;
+	if (num_frames > LEP_INTERVAL_MAX_FRAMES) num_frames = LEP_INTERVAL_MAX_FRAMES;
+	if (interval_ms > LEP_INTERVAL_MAX_MSEC) interval_ms = LEP_INTERVAL_MAX_MSEC;
+	if (settle_ms > LEP_INTERVAL_MAX_MSEC) settle_ms = LEP_INTERVAL_MAX_MSEC;
+	
+	portENTER_CRITICAL(&interval_mux);
+	interval_req.interval_msec = interval_ms;
+	interval_req.num_frames = num_frames;
+	interval_req.settle_msec = settle_ms;
+	interval_updated = true;
+	portEXIT_CRITICAL(&interval_mux);
+	
+	ESP_LOGI(TAG, "Interval capture %d mSec, %d frames, %d mSec settle", interval_ms, num_frames, settle_ms);
+}
+
+
+/**
+ * Get the most recently requested interval capture settings and the estimated power and
+ * latency trade-off for them
+ */
+void lep_get_interval_capture(lep_interval_t* info)
+{
+	portENTER_CRITICAL(&interval_mux);
+	*info = interval_req;
+	portEXIT_CRITICAL(&interval_mux);
+	
+	interval_estimate(info);
+}
+
+
+/**
+ * Get the number of vsync interrupts and the total time spent in the handler since
+ * power-on (both wrap)
+ */
+void lep_get_isr_stats(uint32_t* count, uint32_t* usec)
+{
+	portENTER_CRITICAL(&vsync_mux);
+	*count = vsync_isr_count;
+	*usec = vsync_isr_usec;
+	portEXIT_CRITICAL(&vsync_mux);
+}
+
+
+/**
+ * Configure FFC scheduling (see LEP_FFC_MODE_xxx).  The Lepton's FFC mode is changed,
+ * and kept after it is reset, starting with the next frame.
+ */
+void lep_set_ffc_schedule(const lep_ffc_sched_t* sched)
+{
+	lep_ffc_sched_t s = *sched;
+	
+	if ((s.mode < LEP_FFC_MODE_AUTO) || (s.mode > LEP_FFC_MODE_SMART)) s.mode = LEP_FFC_MODE_AUTO;
+	if (s.quiet_msec > LEP_FFC_MAX_MSEC) s.quiet_msec = LEP_FFC_MAX_MSEC;
+	if (s.min_msec > LEP_FFC_MAX_MSEC) s.min_msec = LEP_FFC_MAX_MSEC;
+	if (s.max_wait_msec > LEP_FFC_MAX_MSEC) s.max_wait_msec = LEP_FFC_MAX_MSEC;
+	if (s.motion < 1) s.motion = 1;
+	
+	portENTER_CRITICAL(&ffc_mux);
+	ffc_req = s;
+	ffc_updated = true;
+	portEXIT_CRITICAL(&ffc_mux);
+	
+	ESP_LOGI(TAG, "FFC mode %d, drift %d, motion %d, quiet %d mSec, min %d mSec, max wait %d mSec",
+		s.mode, s.drift_k100, s.motion, s.quiet_msec, s.min_msec, s.max_wait_msec);
+}
+
+
+/**
+ * Get the most recently requested FFC scheduling settings and the scheduler's state
+ */
+void lep_get_ffc_schedule(lep_ffc_sched_t* sched, lep_ffc_status_t* status)
+{
+	portENTER_CRITICAL(&ffc_mux);
+	*sched = ffc_req;
+	*status = ffc_status;
+	portEXIT_CRITICAL(&ffc_mux);
+}
+
+
+/**
+ * Approve a FFC: one runs with the next frame, whatever the mode and the scene
+ */
+void lep_approve_ffc()
+{
+	portENTER_CRITICAL(&ffc_mux);
+	ffc_approved = true;
+	portEXIT_CRITICAL(&ffc_mux);
+}
+
+
+/**
+ * Request a calibration of the SPI clock of each Lepton.  The rates in
+ * LEP_SPI_CAL_STEPS are measured in turn while frames continue to be captured (see
+ * vospi_cal.h) and the chosen rate is stored in NVS and used from then on.  Ignored
+ * while a calibration is running.
+ */
+void lep_calibrate_spi()
+{
+	portENTER_CRITICAL(&spi_cal_mux);
+	spi_cal_requested = true;
+	portEXIT_CRITICAL(&spi_cal_mux);
+}
+
+
+/**
+ * Returns true while the SPI clock is being calibrated
+ */
+bool lep_spi_cal_running()
+{
+	return spi_cal_running;
+}
+
+
+/**
+ * Get the Lepton state from the telemetry of the most recent frame (valid is false
+ * until a frame with telemetry has been read)
+ */
+void lep_get_tel_cache(lep_tel_cache_t* tel)
+{
+	portENTER_CRITICAL(&tel_mux);
+	*tel = tel_cache;
+	portEXIT_CRITICAL(&tel_mux);
+}
+
+
+
+//
+// LEP Task internal functions
+//
+
+/**
+ * Wait for the Lepton to boot after a reset and initialize it.  A second Lepton, which
+ * shares the reset, is initialized next.  Its frames are missing if that fails but the
+ * first Lepton keeps running.
+ */
+static bool init_leptons()
+{
+	if (!lepton_wait_boot() || !lepton_init()) {
+		return false;
+	}
+	
+	// The Lepton boots in automatic FFC mode
+	ffc_mode_set = (ffc_sched.mode == LEP_FFC_MODE_AUTO);
+	ffc_due_usec = 0;
+	
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+	if (!lepton_init_second()) {
+		ESP_LOGE(TAG, "Second Lepton CCI initialization failed");
+	}
+	vospi_resync(1);
+#endif
+	
+	return true;
+}
+
+
+/**
+ * Reset the Lepton after a warm start found it wasn't configured as expected (or not
+ * responding) and initialize it normally
+ */
+static bool reset_init_leptons()
+{
+	ESP_LOGI(TAG, "Reset Lepton after warm start");
+	lepton_reset();
+	seq_fc_valid = false;
+	return init_leptons();
+}
+
+
+/**
+ * Configure an interrupt on the rising edge of each Lepton's vsync
+ */
+static bool vsync_intr_init()
+{
+	int i;
+	esp_err_t ret;
+	
+	// The service may have already been installed by another module
+	ret = gpio_install_isr_service(0);
+	if ((ret != ESP_OK) && (ret != ESP_ERR_INVALID_STATE)) {
+		return false;
+	}
+	
+	for (i=0; i<LEP_NUM_LEPTONS; i++) {
+		gpio_set_intr_type(vsync_io[i], GPIO_INTR_POSEDGE);
+		if (gpio_isr_handler_add(vsync_io[i], vsync_isr, (void*) i) != ESP_OK) {
+			return false;
+		}
+	}
+	
+	return true;
+}
+
+
+/**
+ * Timestamp a vsync edge of the Lepton in arg and wake lep_task
+ */
+static void IRAM_ATTR vsync_isr(void* arg)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+	int lep = (int) arg;
+	int64_t t;
+	
+	t = esp_timer_get_time();
+	portENTER_CRITICAL_ISR(&vsync_mux);
+	vsync_edge_usec[lep] = t;
+	vsync_pending[lep] = true;
+	portEXIT_CRITICAL_ISR(&vsync_mux);
+	
+	vTaskNotifyGiveFromISR(task_handle_lep, &xHigherPriorityTaskWoken);
+	
+	// Handler time for mon_task (FreeRTOS charges it to the interrupted task)
+	portENTER_CRITICAL_ISR(&vsync_mux);
+	vsync_isr_count++;
+	vsync_isr_usec += (uint32_t) (esp_timer_get_time() - t);
+	portEXIT_CRITICAL_ISR(&vsync_mux);
+	
+	if (xHigherPriorityTaskWoken == pdTRUE) {
+		portYIELD_FROM_ISR();
+	}
+}
+
+
+/**
+ * Block until a vsync edge, returning the Lepton it came from and its timestamp.  The
+ * oldest pending edge is returned first so a second Lepton's segment is read right
+ * after one that started just before it.  Returns false (for the first Lepton) if its
+ * vsync did not occur within LEP_VSYNC_WAIT_MSEC.  An edge that is already a segment
+ * period old (for example one that occurred during a resync delay or while the other
+ * Lepton was read) is skipped so the segment read always starts just after vsync.
+ */
+static bool wait_vsync(int* lep, int64_t* vsync_usec)
+{
+	int i;
+	int64_t t;
+	
+	while (true) {
+		*lep = -1;
+		portENTER_CRITICAL(&vsync_mux);
+		for (i=0; i<LEP_NUM_LEPTONS; i++) {
+			if (vsync_pending[i] && ((*lep < 0) || (vsync_edge_usec[i] < *vsync_usec))) {
+				*lep = i;
+				*vsync_usec = vsync_edge_usec[i];
+			}
+		}
+		if (*lep >= 0) {
+			vsync_pending[*lep] = false;
+		}
+		portEXIT_CRITICAL(&vsync_mux);
+		
+		t = esp_timer_get_time();
+		if (*lep >= 0) {
+			if (*lep == 0) {
+				vsync_wait_usec = t;
+			}
+			if ((t - *vsync_usec) < LEP_FRAME_USEC) {
+				return true;
+			}
+		} else {
+			if ((t - vsync_wait_usec) >= ((int64_t) LEP_VSYNC_WAIT_MSEC * 1000)) {
+				*lep = 0;
+				vsync_wait_usec = t;
+				return false;
+			}
+			(void) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LEP_VSYNC_WAIT_MSEC - (t - vsync_wait_usec)/1000) + 1);
+		}
+	}
+}
+
+
+/**
+ * Ignore the first Lepton's pending vsync and start the wait for its next one from now
+ */
+static void drop_vsync()
+{
+	portENTER_CRITICAL(&vsync_mux);
+	vsync_pending[0] = false;
+	portEXIT_CRITICAL(&vsync_mux);
+	
+	vsync_wait_usec = esp_timer_get_time();
+}
+
+
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+/**
+ * Read a segment from the second Lepton, publishing each frame it completes.  Without
+ * CCI there is no telemetry or FFC state so its frames are numbered consecutively and
+ * it is only realigned with its segment phase when it stops sending frames.  It isn't
+ * part of interval captures or low latency streams.
+ */
+static void read_second_lepton(int64_t vsync_usec)
+{
+	lep_buffer_t* next_bufP;
+	
+	if (vospi_transfer_segment(1, vsync_usec)) {
+		lep2_vsync_count = 0;
+		vospi_finish_frame(1, lep2_bufP);
+		lep2_bufP->vsync_usec = vsync_usec;
+		lep2_bufP->ready_usec = esp_timer_get_time();
+		lep2_bufP->seq = ++lep2_frame_seq;
+		if ((next_bufP = frame_try_get_free()) != NULL) {
+			frame_publish(lep2_bufP);
+			lep2_bufP = next_bufP;
+		} else {
+			perf_count(PERF_CNT_FRAME_HELD);
+		}
+		vospi_set_frame_buffer(1, lep2_bufP);
+	} else if (++lep2_vsync_count == 36) {
+		lep2_vsync_count = 0;
+		perf_count(PERF_CNT_REALIGN);
+		vospi_resync(1);
+	}
+}
+#endif
+
+
+/**
+ * Note when the telemetry in a buffer shows a FFC is imminent or running and log how
+ * long each one took
+ */
+static void note_ffc_state(lep_buffer_t* bufP)
+{
+	uint32_t msec;
+	
+	if (lepton_tel_ffc_active(bufP->lep_telemP)) {
+		ffc_seen_usec = esp_timer_get_time();
+		if (ffc_start_usec == 0) ffc_start_usec = ffc_seen_usec;
+	} else if (ffc_start_usec != 0) {
+		msec = (uint32_t) ((esp_timer_get_time() - ffc_start_usec) / 1000);
+		evlog_event(EVLOG_EVT_FFC, 0, (msec > 0xFFFF) ? 0xFFFF : msec, bufP->lep_telemP[LEP_TEL_FPA_T_K100], 0);
+		ffc_start_usec = 0;
+	}
+}
+
+
+/**
+ * Save the state reported in a frame's telemetry for lep_get_tel_cache()
+ */
+static void update_tel_cache(lep_buffer_t* bufP)
+{
+	uint16_t* telP = bufP->lep_telemP;
+	lep_tel_cache_t t;
+	
+	t.valid = true;
+	t.usec = esp_timer_get_time();
+	t.frame = telP[LEP_TEL_FC_LOW] | (telP[LEP_TEL_FC_HIGH] << 16);
+	t.status = lepton_get_tel_status(telP);
+	t.fpa_t_k100 = telP[LEP_TEL_FPA_T_K100];
+	t.aux_t_k100 = telP[LEP_TEL_HSE_T_K100];
+	t.gain_mode = telP[LEP_TEL_EFF_GAIN_MODE];
+	t.tlin_enabled = (telP[LEP_TEL_TLIN_ENABLE] != 0);
+	
+	portENTER_CRITICAL(&tel_mux);
+	tel_cache = t;
+	portEXIT_CRITICAL(&tel_mux);
+}
+
+
+/**
+ * Assign the next capture sequence number to a frame.  When telemetry is available the
+ * sequence advances by the number of Lepton output frames since the previous frame so
+ * frames lost while the VoSPI stream was recovered leave gaps.  The telemetry frame
+ * counter also counts frames the Lepton doesn't output, so its smallest step between
+ * frames is taken as one output frame.
+ */
+static void set_frame_seq(lep_buffer_t* bufP)
+{
+	uint16_t* telP = bufP->lep_telemP;
+	uint32_t fc, delta;
+	uint32_t n = 1;
+	
+	if (bufP->telem_valid) {
+		fc = telP[LEP_TEL_FC_LOW] | (telP[LEP_TEL_FC_HIGH] << 16);
+		if (seq_fc_valid && (fc > seq_last_fc)) {
+			delta = fc - seq_last_fc;
+			if ((seq_fc_step == 0) || (delta < seq_fc_step)) {
+				seq_fc_step = delta;
+			}
+			n = (delta + seq_fc_step/2) / seq_fc_step;
+		}
+		seq_last_fc = fc;
+		seq_fc_valid = true;
+	} else {
+		seq_fc_valid = false;
+	}
+	
+	if (n > 1) {
+		perf_add(PERF_CNT_FRAME_LOST, n - 1);
+	}
+	frame_seq += n;
+	bufP->seq = frame_seq;
+}
+
+
+/**
+ * Returns true while missing frames should be attributed to a FFC: within
+ * LEP_FFC_WAIT_MSEC of a FFC last being seen in telemetry or being commanded
+ */
+static bool ffc_in_progress()
+{
+	if ((ffc_seen_usec != 0) && ((esp_timer_get_time() - ffc_seen_usec) < (LEP_FFC_WAIT_MSEC * 1000))) {
+		return true;
+	}
+	
+	return lepton_ffc_commanded(LEP_FFC_WAIT_MSEC);
+}
+
+
+/**
+ * Returns the CS de-asserted time for a resynchronization attempt (starting with 0),
+ * doubling for each attempt up to LEP_RESYNC_MAX_MSEC
+ */
+static int resync_delay_msec(int attempt)
+{
+	int msec = LEP_RESYNC_MSEC;
+	
+	while ((attempt-- > 0) && (msec < LEP_RESYNC_MAX_MSEC)) {
+		msec *= 2;
+	}
+	
+	return (msec > LEP_RESYNC_MAX_MSEC) ? LEP_RESYNC_MAX_MSEC : msec;
+}
+
+
+/**
+ * Load new interval capture settings and start a capture immediately
+ */
+static void interval_check_update()
+{
+	bool updated;
+	
+	portENTER_CRITICAL(&interval_mux);
+	updated = interval_updated;
+	if (updated) {
+		interval = interval_req;
+		interval_updated = false;
+	}
+	portEXIT_CRITICAL(&interval_mux);
+	
+	if (updated) {
+		interval_estimate(&interval);
+		next_capture_usec = esp_timer_get_time();
+		capture_count = 0;
+	}
+}
+
+
+/**
+ * Returns true if a frame should be published: always during continuous operation or
+ * once the capture time has come, the Lepton has settled and no FFC is running while
+ * interval capturing
+ */
+static bool interval_keep_frame()
+{
+	int64_t t;
+	
+	if (interval.interval_msec == 0) return true;
+	
+	t = esp_timer_get_time();
+	if ((t < next_capture_usec) || (t < settle_until_usec) || ffc_in_progress()) {
+		return false;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Count a frame published during an interval capture (only published frames count
+ * toward the capture's num_frames)
+ */
+static void interval_note_capture()
+{
+	if (interval.interval_msec != 0) {
+		capture_count++;
+	}
+}
+
+
+/**
+ * Schedule the next capture after the last frame of a capture has been published.
+ * Returns true if the Lepton should be powered down until then.
+ */
+static bool interval_capture_done()
+{
+	int64_t t;
+	
+	if ((interval.interval_msec == 0) || (capture_count < interval.num_frames)) {
+		return false;
+	}
+	
+	// Skip captures that were missed (for example because of a FFC or resync)
+	capture_count = 0;
+	t = esp_timer_get_time();
+	next_capture_usec += (int64_t) interval.interval_msec * 1000;
+	if (next_capture_usec < t) {
+		next_capture_usec = t + ((int64_t) interval.interval_msec * 1000);
+	}
+	
+	return interval.power_down;
+}
+
+
+/**
+ * Returns true when the Lepton should be woken: continuous operation was requested or
+ * it is time to boot and settle before the next capture
+ */
+static bool interval_wake_due()
+{
+	int64_t lead_usec;
+	
+	if (!interval.power_down) return true;
+	
+	lead_usec = (int64_t) interval.latency_msec * 1000;
+	return (esp_timer_get_time() >= (next_capture_usec - lead_usec));
+}
+
+
+/**
+ * Load new FFC scheduler settings and set the Lepton's FFC mode if necessary
+ */
+static void ffc_check_update()
+{
+	bool updated, manual;
+	
+	portENTER_CRITICAL(&ffc_mux);
+	updated = ffc_updated;
+	if (updated) {
+		manual = (ffc_sched.mode != LEP_FFC_MODE_AUTO);
+		ffc_sched = ffc_req;
+		ffc_updated = false;
+		if ((ffc_sched.mode != LEP_FFC_MODE_AUTO) != manual) {
+			ffc_mode_set = false;
+		}
+	}
+	portEXIT_CRITICAL(&ffc_mux);
+	
+	if (updated) {
+		ffc_due_usec = 0;
+	}
+	
+	if (!ffc_mode_set) {
+		manual = (ffc_sched.mode != LEP_FFC_MODE_AUTO);
+		if (lepton_ffc_manual(manual)) {
+			ESP_LOGI(TAG, "Lepton FFC %s", manual ? "manual" : "automatic");
+			ffc_mode_set = true;
+			portENTER_CRITICAL(&ffc_mux);
+			ffc_status.manual = manual;
+			portEXIT_CRITICAL(&ffc_mux);
+		} else {
+			ESP_LOGE(TAG, "Set Lepton FFC mode failed");
+		}
+	}
+}
+
+
+/**
+ * Run the FFC scheduler for a frame: run an approved FFC or, in LEP_FFC_MODE_SMART,
+ * decide from the frame's telemetry if a FFC is due and run it once the scene is still
+ * (or it has waited too long).  A FFC is never due while one is running or within
+ * LEP_FFC_WAIT_MSEC of commanding one (before its telemetry has been updated).
+ */
+static void ffc_schedule_frame(lep_buffer_t* bufP)
+{
+	uint16_t* telP = bufP->lep_telemP;
+	bool approved, due = false;
+	uint32_t drift = 0, since = 0, uptime, ffc_uptime;
+	int64_t t = esp_timer_get_time();
+	
+	ffc_check_update();
+	
+	portENTER_CRITICAL(&ffc_mux);
+	approved = ffc_approved;
+	ffc_approved = false;
+	portEXIT_CRITICAL(&ffc_mux);
+	
+	if (approved) {
+		ffc_run(t, &ffc_status.num_approved);
+		return;
+	}
+	
+	if (bufP->telem_valid) {
+		drift = (telP[LEP_TEL_FPA_T_K100] > telP[LEP_TEL_LAST_FPA_T]) ?
+			telP[LEP_TEL_FPA_T_K100] - telP[LEP_TEL_LAST_FPA_T] :
+			telP[LEP_TEL_LAST_FPA_T] - telP[LEP_TEL_FPA_T_K100];
+		uptime = telP[LEP_TEL_TC_LOW] | (telP[LEP_TEL_TC_HIGH] << 16);
+		ffc_uptime = telP[LEP_TEL_LAST_TC_LOW] | (telP[LEP_TEL_LAST_TC_HIGH] << 16);
+		since = uptime - ffc_uptime;
+		
+		if ((ffc_sched.mode == LEP_FFC_MODE_SMART) && ffc_mode_set && !ffc_in_progress() &&
+		    ((ffc_run_usec == 0) || ((t - ffc_run_usec) >= ((int64_t) LEP_FFC_WAIT_MSEC * 1000))) &&
+		    (since >= ffc_sched.min_msec)) {
+			due = (drift >= ffc_sched.drift_k100) ||
+			      ((lepton_get_tel_status(telP) & LEP_STATUS_FFC_DESIRED) != 0);
+		}
+	}
+	
+	if (due) {
+		if (ffc_due_usec == 0) {
+			ffc_due_usec = t;
+			ffc_ref_valid = false;
+		}
+		if (ffc_scene_still(bufP, t)) {
+			ffc_run(t, &ffc_status.num_quiet);
+			return;
+		}
+		if ((ffc_sched.max_wait_msec != 0) && ((t - ffc_due_usec) >= ((int64_t) ffc_sched.max_wait_msec * 1000))) {
+			ffc_run(t, &ffc_status.num_forced);
+			return;
+		}
+	} else {
+		ffc_due_usec = 0;
+	}
+	
+	portENTER_CRITICAL(&ffc_mux);
+	ffc_status.due = due;
+	ffc_status.drift_k100 = drift;
+	ffc_status.since_ffc_msec = since;
+	portEXIT_CRITICAL(&ffc_mux);
+}
+
+
+/**
+ * Returns true once the scene has been still for quiet_msec.  The frame's block means
+ * are compared with the blocks of the frame the scene last moved in.
+ */
+static bool ffc_scene_still(lep_buffer_t* bufP, int64_t t)
+{
+	int bx, by, x, y, i;
+	uint32_t sums[LEP_FFC_BLOCKS_X];
+	uint16_t* p = bufP->lep_bufferP;
+	bool moved = false;
+	
+	for (by=0; by<LEP_FFC_BLOCKS_Y; by++) {
+		memset(sums, 0, sizeof(sums));
+		for (y=0; y<LEP_FFC_BLOCK_SIZE; y++) {
+			for (bx=0; bx<LEP_FFC_BLOCKS_X; bx++) {
+				for (x=0; x<LEP_FFC_BLOCK_SIZE; x++) {
+					sums[bx] += *p++;
+				}
+			}
+		}
+		for (bx=0; bx<LEP_FFC_BLOCKS_X; bx++) {
+			i = by*LEP_FFC_BLOCKS_X + bx;
+			ffc_blocks[i] = sums[bx] / (LEP_FFC_BLOCK_SIZE*LEP_FFC_BLOCK_SIZE);
+			if (ffc_ref_valid && !moved) {
+				moved = (abs((int) ffc_blocks[i] - (int) ffc_ref[i]) >= (int) ffc_sched.motion);
+			}
+		}
+	}
+	
+	if (!ffc_ref_valid || moved) {
+		memcpy(ffc_ref, ffc_blocks, sizeof(ffc_ref));
+		ffc_ref_valid = true;
+		ffc_still_usec = t;
+		return false;
+	}
+	
+	return ((t - ffc_still_usec) >= ((int64_t) ffc_sched.quiet_msec * 1000));
+}
+
+
+/**
+ * Command a FFC, counting it in one of the ffc_status counters
+ */
+static void ffc_run(int64_t t, uint32_t* counter)
+{
+	ESP_LOGI(TAG, "Run FFC");
+	lepton_ffc();
+	ffc_run_usec = t;
+	ffc_due_usec = 0;
+	
+	portENTER_CRITICAL(&ffc_mux);
+	(*counter)++;
+	ffc_status.due = false;
+	portEXIT_CRITICAL(&ffc_mux);
+}
+
+
+/**
+ * Copy a segment just loaded into the frame buffer for low latency streams while they
+ * are enabled (and not during interval captures).  The last segment of a frame also
+ * holds the frame's range and telemetry so it must be published after the frame is
+ * finished.  A segment is dropped when all segment buffers are held.
+ */
+static void publish_segment(lep_buffer_t* bufP)
+{
+	int seg;
+	uint16_t start, len;
+	lep_segment_t* segP;
+	
+	seg = vospi_get_segment(0, &start, &len);
+	if ((seg == 0) || !frame_seg_enabled() || (interval.interval_msec != 0)) return;
+	
+	if (seg == 1) {
+		seg_frame_num++;
+	}
+	
+	segP = frame_seg_get_free();
+	if (segP == NULL) {
+		perf_count(PERF_CNT_SEG_DROP);
+		return;
+	}
+	
+	segP->frame_num = seg_frame_num;
+	segP->seg = (uint8_t) seg;
+	segP->start = start;
+	segP->len = len;
+	memcpy(segP->buf.lep_bufferP, bufP->lep_bufferP + start, len*2);
+	if (seg == 4) {
+		segP->buf.lep_min_val = bufP->lep_min_val;
+		segP->buf.lep_max_val = bufP->lep_max_val;
+		segP->buf.telem_valid = bufP->telem_valid;
+		segP->buf.vsync_usec = bufP->vsync_usec;
+		segP->buf.seq = bufP->seq;
+		if (bufP->telem_valid) {
+			memcpy(segP->buf.lep_telemP, bufP->lep_telemP, LEP_TEL_WORDS*2);
+		}
+	} else {
+		segP->buf.telem_valid = false;
+	}
+	
+	frame_seg_publish(segP);
+}
+
+
+/**
+ * VoSPI packet tap: copy the packets just read into raw packet batches for passthrough
+ * streams while they are enabled.  Discard packets are left out.  A full batch is
+ * published immediately and the rest of a segment read's packets when the read is done
+ * (flush_packets).  Packets are dropped (and counted) when all batch buffers are held.
+ */
+static void tap_packets(int lep, const uint8_t* pktP, int numPkts)
+{
+	int i;
+	
+	if (!frame_pkt_enabled()) return;
+	
+	for (i=0; i<numPkts; i++, pktP += LEP_PKT_LENGTH) {
+		if ((*pktP & 0x0F) == 0x0F) continue;
+		
+		if ((pkt_batchP != NULL) && (pkt_batchP->lepton != lep)) {
+			flush_packets();
+		}
+		if (pkt_batchP == NULL) {
+			if ((pkt_batchP = frame_pkt_get_free()) == NULL) {
+				perf_count(PERF_CNT_PKT_DROP);
+				pkt_num++;
+				continue;
+			}
+			pkt_batchP->pkt_num = pkt_num;
+			pkt_batchP->lepton = (uint8_t) lep;
+			pkt_batchP->num_pkts = 0;
+			pkt_batchP->read_usec = esp_timer_get_time();
+		}
+		
+		memcpy(pkt_batchP->pktP + pkt_batchP->num_pkts*LEP_PKT_LENGTH, pktP, LEP_PKT_LENGTH);
+		pkt_num++;
+		if (++pkt_batchP->num_pkts == LEP_PKT_BATCH_PKTS) {
+			flush_packets();
+		}
+	}
+}
+
+
+/**
+ * Publish the raw packet batch being loaded, if any
+ */
+static void flush_packets()
+{
+	if (pkt_batchP != NULL) {
+		frame_pkt_publish(pkt_batchP);
+		pkt_batchP = NULL;
+	}
+}
+
+
+/**
+ * Estimate how long the Lepton operates each interval and its average power for a set
+ * of interval capture settings
+ */
+static void interval_estimate(lep_interval_t* info)
+{
+	uint32_t awake_msec;
+	
+	info->latency_msec = LEP_BOOT_MAX_MSEC + info->settle_msec;
+	awake_msec = info->latency_msec + (info->num_frames * LEP_INTERVAL_FRAME_MSEC);
+	
+	info->power_down = (info->interval_msec >= LEP_INTERVAL_MIN_MSEC) &&
+	                   (info->interval_msec >= (2 * awake_msec));
+	
+	if (info->power_down) {
+		info->awake_msec = awake_msec;
+		info->avg_power_mw = (uint32_t) (((uint64_t) LEP_OPER_POWER_MW * awake_msec +
+		                     (uint64_t) LEP_STANDBY_POWER_MW * (info->interval_msec - awake_msec)) /
+		                     info->interval_msec);
+	} else {
+		info->awake_msec = info->interval_msec;
+		info->latency_msec = 0;
+		info->avg_power_mw = LEP_OPER_POWER_MW;
+	}
+}
+
+
+/**
+ * Run the SPI clock calibration requested by lep_calibrate_spi().  Called between
+ * segment reads.  Each step's link counters are collected for LEP_SPI_CAL_MSEC after
+ * LEP_SPI_CAL_SETTLE_MSEC, restarting after a FFC (when the Lepton sends no valid
+ * segments) and ending early once the step can no longer be stable.
+ */
+static void spi_cal_check()
+{
+	vospi_cal_count_t cnt;
+	bool start;
+	uint32_t hz;
+	int64_t t = esp_timer_get_time();
+	
+	if (!spi_cal_running) {
+		portENTER_CRITICAL(&spi_cal_mux);
+		start = spi_cal_requested;
+		spi_cal_requested = false;
+		portEXIT_CRITICAL(&spi_cal_mux);
+		
+		if (start) {
+			ESP_LOGI(TAG, "Calibrate SPI clock");
+			spi_cal_running = true;
+			spi_cal_lep = 0;
+			spi_cal_start_lepton(t);
+		}
+		return;
+	}
+	
+	if (ffc_in_progress()) {
+		spi_cal_start_usec = t + (LEP_SPI_CAL_SETTLE_MSEC * 1000);
+	}
+	if (t < spi_cal_start_usec) {
+		vospi_get_link_counts(spi_cal_lep, &cnt, true);
+		return;
+	}
+	
+	vospi_get_link_counts(spi_cal_lep, &cnt, false);
+	if (((t - spi_cal_start_usec) < (LEP_SPI_CAL_MSEC * 1000)) &&
+	    !vospi_cal_failing(&cnt, (LEP_SPI_CAL_MSEC * 1000) / LEP_FRAME_USEC)) {
+		return;
+	}
+	
+	ESP_LOGI(TAG, "Lepton %d SPI %d Hz: %d reads, %d incomplete, %d CRC errors", spi_cal_lep,
+	         vospi_cal_freq(&spi_cal), cnt.reads, cnt.reads - cnt.seg_ends, cnt.crc_errors);
+	if (!vospi_cal_next(&spi_cal, vospi_cal_stable(&cnt))) {
+		(void) spi_cal_set_step(t);
+		return;
+	}
+	
+	// Use and store the result (an unstable link keeps the default)
+	hz = vospi_cal_result(&spi_cal);
+	if (hz == 0) {
+		ESP_LOGE(TAG, "Lepton %d SPI unstable at %d Hz, using %d Hz", spi_cal_lep, vospi_cal_freq(&spi_cal),
+		         LEP_SPI_FREQ_HZ);
+	} else {
+		ESP_LOGI(TAG, "Lepton %d SPI calibrated to %d Hz", spi_cal_lep, hz);
+	}
+	if (vospi_set_spi_freq(spi_cal_lep, hz) != ESP_OK) {
+		ctrl_set_fault_type(CTRL_FAULT_LEP_VOSPI);
+	}
+	ps_set_spi_freq(spi_cal_lep, hz);
+	
+	if (++spi_cal_lep < LEP_NUM_LEPTONS) {
+		spi_cal_start_lepton(t);
+	} else {
+		spi_cal_running = false;
+	}
+}
+
+
+/**
+ * Start calibrating the current Lepton at the slowest rate
+ */
+static void spi_cal_start_lepton(int64_t t)
+{
+	static const uint32_t steps[] = LEP_SPI_CAL_STEPS;
+	
+	vospi_cal_init(&spi_cal, steps, sizeof(steps) / sizeof(steps[0]));
+	if (!spi_cal_set_step(t)) {
+		spi_cal_running = false;
+	}
+}
+
+
+/**
+ * Switch the current Lepton to the rate of the calibration step, returning to its
+ * stored rate and ending the calibration if that fails
+ */
+static bool spi_cal_set_step(int64_t t)
+{
+	if (vospi_set_spi_freq(spi_cal_lep, vospi_cal_freq(&spi_cal)) != ESP_OK) {
+		ESP_LOGE(TAG, "Lepton %d SPI calibration failed", spi_cal_lep);
+		if (vospi_set_spi_freq(spi_cal_lep, ps_get_spi_freq(spi_cal_lep)) != ESP_OK) {
+			ctrl_set_fault_type(CTRL_FAULT_LEP_VOSPI);
+		}
+		spi_cal_running = false;
+		return false;
+	}
+	
+	spi_cal_start_usec = t + (LEP_SPI_CAL_SETTLE_MSEC * 1000);
+	return true;
+}
@@ -27,6 +27,7 @@
 #ifndef LEP_TASK_H
 #define LEP_TASK_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 
@@ -38,14 +39,137 @@
 // Number of consecutive VoSPI resynchronization attempts before attempting to reset
 #define LEP_SYNC_FAIL_FAULT_LIMIT 10
 
+// Recovery ladder when frames stop arriving
+//   1. LEP_REALIGN_ATTEMPTS re-alignments with the segment phase (no delay)
+//   2. CS de-asserted resynchronizations, the delay starting at LEP_RESYNC_MSEC (the
+//      minimum from the Lepton 3.5 data sheet) and doubling up to LEP_RESYNC_MAX_MSEC
+//   3. A hardware reset after LEP_SYNC_FAIL_FAULT_LIMIT resynchronizations
+#define LEP_REALIGN_ATTEMPTS      2
+#define LEP_RESYNC_MSEC           185
+#define LEP_RESYNC_MAX_MSEC       370
+
 // Reset fail delay before attempting a re-init (seconds)
 #define LEP_RESET_FAIL_RETRY_SECS 60
 
+// Maximum time to wait for a vsync interrupt before counting a missed vsync (vsync
+// normally occurs every segment period, LEP_FRAME_USEC)
+#define LEP_VSYNC_WAIT_MSEC 20
+
+// Time to quietly wait for valid frames after telemetry shows a FFC is imminent or
+// running or a FFC is commanded before treating missing frames as a sync failure
+// (the camera stops sending valid frames for about 1.5 seconds during a FFC)
+#define LEP_FFC_WAIT_MSEC 2500
+
+// Interval capture (see lep_set_interval_capture)
+//   LEP_INTERVAL_MIN_MSEC    - Shortest interval the Lepton is powered down between captures
+//                              (it is left running and frames are only kept at the interval
+//                              for shorter intervals)
+//   LEP_INTERVAL_SETTLE_MSEC - Default time frames are discarded after the Lepton wakes to
+//                              let the sensor stabilize and the FFC it runs after boot finish
+//   LEP_INTERVAL_MAX_FRAMES  - Maximum frames captured each interval
+//   LEP_INTERVAL_MAX_MSEC    - Maximum interval and settling time
+//   LEP_INTERVAL_POLL_MSEC   - Interval settings are checked this often while powered down
+//   LEP_INTERVAL_FRAME_MSEC  - Period of unique frames from the Lepton
+#define LEP_INTERVAL_MIN_MSEC    10000
+#define LEP_INTERVAL_SETTLE_MSEC 3000
+#define LEP_INTERVAL_MAX_FRAMES  100
+#define LEP_INTERVAL_MAX_MSEC    86400000
+#define LEP_INTERVAL_POLL_MSEC   100
+#define LEP_INTERVAL_FRAME_MSEC  115
+
+// FFC scheduling (see lep_set_ffc_schedule)
+//   LEP_FFC_MODE_AUTO   - The Lepton runs a FFC whenever it decides (its default)
+//   LEP_FFC_MODE_MANUAL - The Lepton is in manual FFC mode and a FFC only runs when a
+//                         client approves one (lep_approve_ffc)
+//   LEP_FFC_MODE_SMART  - The Lepton is in manual FFC mode and a FFC is due when its FPA
+//                         temperature has drifted drift_k100 from the last FFC or its
+//                         telemetry says it desires one.  A due FFC runs once the scene has
+//                         been still for quiet_msec (or after max_wait_msec if it never is)
+//                         but not within min_msec of the last FFC.
+#define LEP_FFC_MODE_AUTO   0
+#define LEP_FFC_MODE_MANUAL 1
+#define LEP_FFC_MODE_SMART  2
+
+// FFC scheduler defaults and limits.  The scene is still while no block of
+// LEP_FFC_BLOCK_SIZE x LEP_FFC_BLOCK_SIZE pixels has a mean motion counts (0.5 K for
+// TLinear 0.01 K frames) from its mean when the scene last moved.
+#define LEP_FFC_DEF_DRIFT_K100    150
+#define LEP_FFC_DEF_MOTION        50
+#define LEP_FFC_DEF_QUIET_MSEC    2000
+#define LEP_FFC_DEF_MIN_MSEC      60000
+#define LEP_FFC_DEF_MAX_WAIT_MSEC 600000
+#define LEP_FFC_MAX_MSEC          86400000
+#define LEP_FFC_BLOCK_SIZE        8
+#define LEP_FFC_BLOCKS_X          (160 / LEP_FFC_BLOCK_SIZE)
+#define LEP_FFC_BLOCKS_Y          (120 / LEP_FFC_BLOCK_SIZE)
+#define LEP_FFC_NUM_BLOCKS        (LEP_FFC_BLOCKS_X * LEP_FFC_BLOCKS_Y)
+
+// Typical Lepton 3.5 power (mW) from the datasheet (operating without a shutter event
+// and powered down) used to estimate the average power of interval capture
+#define LEP_OPER_POWER_MW        150
+#define LEP_STANDBY_POWER_MW     5
+
+
+
+//
+// LEP Task typedefs
+//
+typedef struct {
+	uint32_t interval_msec;    // 0 = interval capture disabled (continuous operation)
+	uint32_t num_frames;       // Frames captured each interval
+	uint32_t settle_msec;      // Frames discarded for this long after waking
+	uint32_t awake_msec;       // Estimated time the Lepton operates each interval
+	uint32_t latency_msec;     // Time from waking the Lepton until the first capture
+	uint32_t avg_power_mw;     // Estimated average Lepton power
+	bool power_down;           // Lepton is powered down between captures
+} lep_interval_t;
+
+typedef struct {
+	int mode;                  // LEP_FFC_MODE_xxx
+	uint32_t drift_k100;       // FPA temperature change from the last FFC making one due
+	uint32_t motion;           // Block mean change (counts) that is motion
+	uint32_t quiet_msec;       // Time the scene must be still before a due FFC runs
+	uint32_t min_msec;         // Minimum time between scheduled FFCs
+	uint32_t max_wait_msec;    // A due FFC runs after this long even with motion (0: never)
+} lep_ffc_sched_t;
+
+typedef struct {
+	bool manual;               // The Lepton is in manual FFC mode
+	bool due;                  // A scheduled FFC is waiting for a still scene
+	uint32_t drift_k100;       // FPA temperature change since the last FFC
+	uint32_t since_ffc_msec;   // Time since the last FFC
+	uint32_t num_quiet;        // Scheduled FFCs run in a still scene
+	uint32_t num_forced;       // Scheduled FFCs run after max_wait_msec
+	uint32_t num_approved;     // FFCs approved by a client
+} lep_ffc_status_t;
+
+// Lepton state from the telemetry of the most recent frame so other tasks can report
+// it without going to the Lepton over I2C
+typedef struct {
+	bool valid;                // A frame with telemetry has been read
+	int64_t usec;              // Time the frame was read
+	uint32_t frame;            // Lepton frame counter
+	uint32_t status;           // Lepton status word (LEP_STATUS_xxx)
+	uint16_t fpa_t_k100;       // FPA temperature (K * 100)
+	uint16_t aux_t_k100;       // Housing (AUX) temperature (K * 100)
+	uint16_t gain_mode;        // Effective gain mode (0: High, 1: Low)
+	bool tlin_enabled;         // Radiometric (TLinear) output
+} lep_tel_cache_t;
+
 
 
 //
 // LEP Task API
 //
 void lep_task();
+void lep_set_interval_capture(uint32_t interval_ms, uint32_t num_frames, uint32_t settle_ms);
+void lep_get_interval_capture(lep_interval_t* info);
+void lep_get_isr_stats(uint32_t* count, uint32_t* usec);
+void lep_get_tel_cache(lep_tel_cache_t* tel);
+void lep_set_ffc_schedule(const lep_ffc_sched_t* sched);
+void lep_get_ffc_schedule(lep_ffc_sched_t* sched, lep_ffc_status_t* status);
+void lep_approve_ffc();
+void lep_calibrate_spi();
+bool lep_spi_cal_running();
 
 #endif /* LEP_TASK_H */
\ No newline at end of file
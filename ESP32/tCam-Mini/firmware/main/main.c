@@ -23,12 +23,22 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "ana_task.h"
 #include "cmd_task.h"
 #include "ctrl_task.h"
+#include "enc_task.h"
+#include "gw_task.h"
+#include "hist_task.h"
 #include "lep_task.h"
 #include "mon_task.h"
+#include "now_task.h"
+#include "rec_task.h"
 #include "rsp_task.h"
+#include "ser_task.h"
 #include "system_config.h"
+#include "evlog_utilities.h"
+#include "ota_utilities.h"
+#include "pm_utilities.h"
 #include "sys_utilities.h"
 
 
@@ -37,10 +47,24 @@ static const char* TAG = "main";
 
 void app_main(void)
 {
+#ifdef CONFIG_TCAM_ESPNOW_GATEWAY
+    // The gateway firmware only bridges ESP-NOW messages from cameras to the serial port
+    ESP_LOGI(TAG, "tCam ESP-NOW gateway startup");
+    xTaskCreatePinnedToCore(&gw_task, "gw_task", TASK_GW_STACK, NULL, TASK_GW_PRIO, NULL, TASK_GW_CORE);
+    return;
+#endif
+
     ESP_LOGI(TAG, "tCam Mini startup");
     
     // Start the control task to light the red light immediately
-    xTaskCreatePinnedToCore(&ctrl_task, "ctrl_task", 2048, NULL, 1, &task_handle_ctrl, 0);
+    xTaskCreatePinnedToCore(&ctrl_task, "ctrl_task", TASK_CTRL_STACK, NULL, TASK_CTRL_PRIO, &task_handle_ctrl, TASK_CTRL_CORE);
+    
+    // Find the end of the event log and log this boot (first so init faults are logged)
+    if (!evlog_init()) {
+    	ESP_LOGE(TAG, "tCam Mini event log init failed");
+    	ctrl_set_fault_type(CTRL_FAULT_MEM_INIT);
+    	while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
+    }
     
     // Initialize the SPI and I2C drivers
     if (!system_esp_io_init()) {
@@ -63,20 +87,72 @@ void app_main(void)
     	while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
     }
     
-    // Delay for Lepton internal initialization on power-on (max 950 mSec)
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    // Find the recorder's flash partition (closes a recording interrupted by a power loss)
+    if (!rec_init()) {
+    	ESP_LOGE(TAG, "tCam Mini recorder init failed");
+    	ctrl_set_fault_type(CTRL_FAULT_MEM_INIT);
+    	while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
+    }
+    
+    // Find the inactive app partition for network firmware updates
+    if (!ota_init()) {
+    	ESP_LOGE(TAG, "tCam Mini update init failed");
+    	ctrl_set_fault_type(CTRL_FAULT_MEM_INIT);
+    	while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
+    }
+    
+    // Encoder worker state (used by rsp_task)
+    if (!enc_init()) {
+    	ESP_LOGE(TAG, "tCam Mini encoder init failed");
+    	ctrl_set_fault_type(CTRL_FAULT_MEM_INIT);
+    	while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
+    }
+    
+    // Analytics state (set by cmd_task)
+    if (!ana_init()) {
+    	ESP_LOGE(TAG, "tCam Mini analytics init failed");
+    	ctrl_set_fault_type(CTRL_FAULT_MEM_INIT);
+    	while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
+    }
+    
+    // History ring (PSRAM)
+    if (!hist_init()) {
+    	ESP_LOGE(TAG, "tCam Mini history init failed");
+    	ctrl_set_fault_type(CTRL_FAULT_MEM_INIT);
+    	while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
+    }
+    
+    // ESP-NOW message buffers (PSRAM)
+    if (!now_init()) {
+    	ESP_LOGE(TAG, "tCam Mini ESP-NOW init failed");
+    	ctrl_set_fault_type(CTRL_FAULT_MEM_INIT);
+    	while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
+    }
+    system_buffer_report();
+    
+    // CPU frequency scaling (the locks are used by the tasks below).  The CPUs simply
+    // stay at full speed if this fails.
+    if (!pm_init()) {
+    	ESP_LOGE(TAG, "tCam Mini power management init failed");
+    }
     
     // Notify control task that we've successfully started up
     xTaskNotify(task_handle_ctrl, CTRL_NOTIFY_STARTUP_DONE, eSetBits);
     
-    // Start tasks
-    //  Core 0 : PRO - everything but lepton task
-    //  Core 1 : APP - lepton task
-    xTaskCreatePinnedToCore(&cmd_task, "cmd_task",  3072, NULL, 1, &task_handle_cmd,  0);
-    xTaskCreatePinnedToCore(&rsp_task, "rsp_task",  3072, NULL, 2, &task_handle_rsp,  0);
-    xTaskCreatePinnedToCore(&lep_task, "lep_task",  2048, NULL, 19, &task_handle_lep,  1);
-
-#ifdef INCLUDE_SYS_MON
-	xTaskCreatePinnedToCore(&mon_task, "mon_task",  2048, NULL, 1, &task_handle_mon,  0);
+    // Start tasks (see system_config.h for their placement)
+    //  Core 0 : PRO - everything but lepton task and the encoder worker
+    //  Core 1 : APP - lepton task, encoder worker
+    xTaskCreatePinnedToCore(&cmd_task, "cmd_task",  TASK_CMD_STACK, NULL, TASK_CMD_PRIO, &task_handle_cmd,  TASK_CMD_CORE);
+    xTaskCreatePinnedToCore(&rsp_task, "rsp_task",  TASK_RSP_STACK, NULL, TASK_RSP_PRIO, &task_handle_rsp,  TASK_RSP_CORE);
+    xTaskCreatePinnedToCore(&rec_task, "rec_task",  TASK_REC_STACK, NULL, TASK_REC_PRIO, &task_handle_rec,  TASK_REC_CORE);
+    xTaskCreatePinnedToCore(&ana_task, "ana_task",  TASK_ANA_STACK, NULL, TASK_ANA_PRIO, &task_handle_ana,  TASK_ANA_CORE);
+    xTaskCreatePinnedToCore(&hist_task, "hist_task", TASK_HIST_STACK, NULL, TASK_HIST_PRIO, &task_handle_hist, TASK_HIST_CORE);
+    xTaskCreatePinnedToCore(&now_task, "now_task",  TASK_NOW_STACK, NULL, TASK_NOW_PRIO, &task_handle_now,  TASK_NOW_CORE);
+    xTaskCreatePinnedToCore(&lep_task, "lep_task",  TASK_LEP_STACK, NULL, TASK_LEP_PRIO, &task_handle_lep,  TASK_LEP_CORE);
+    xTaskCreatePinnedToCore(&ser_task, "ser_task",  TASK_SER_STACK, NULL, TASK_SER_PRIO, NULL,              TASK_SER_CORE);
+#ifdef RSP_PARALLEL_ENCODE
+    xTaskCreatePinnedToCore(&enc_task, "enc_task",  TASK_ENC_STACK, NULL, TASK_ENC_PRIO, &task_handle_enc,  TASK_ENC_CORE);
 #endif
+
+	xTaskCreatePinnedToCore(&mon_task, "mon_task",  TASK_MON_STACK, NULL, TASK_MON_PRIO, &task_handle_mon,  TASK_MON_CORE);
 }
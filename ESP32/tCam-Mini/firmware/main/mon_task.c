@@ -2,7 +2,9 @@
  * Mon Task
  *
  * Monitor system CPU and memory utilization for debugging and application turning.
- * This task should only be included during development.
+ * The task profiler is switched on and its statistics read at run time with the
+ * get_sys_stats command.  Periodic log output should only be included during
+ * development (INCLUDE_SYS_MON).  The event log is serviced each pass.
  *
  * Copyright 2020 Dan Julio
  *
@@ -23,12 +25,18 @@
  *
  */
 #include "mon_task.h"
+#include "lep_task.h"
+#include "evlog_utilities.h"
+#include "sys_utilities.h"
 #include "esp_system.h"
+#include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 
 //
@@ -39,14 +47,26 @@ static const char* TAG = "mon_task";
 static TaskStatus_t* start_task_sample_array;
 static TaskStatus_t* end_task_sample_array;
 
+// Latest profiler window (copied out under stats_mux)
+static mon_stats_t stats;
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool profiling = false;
+
+#ifdef MON_MEM
+static uint32_t* bw_test_bufP;
+#endif
+
 
 
 //
 // Mon Task Forward Declarations for internal functions
 //
 static bool init_mon_task();
+static void sample_tasks();
 #ifdef MON_MEM
 static void print_memory_stats();
+static void print_buffer_placement();
+static void print_psram_bandwidth();
 #endif
 #ifdef MON_TASKS
 static void print_task_stats();
@@ -59,6 +79,10 @@ static void print_task_stats();
 //
 void mon_task()
 {
+#ifdef INCLUDE_SYS_MON
+	int log_count = 0;
+#endif
+	
 	ESP_LOGI(TAG, "Start task");
 	
 	// Allocate memory for our statistics in the external SPI SRAM (least impact)
@@ -67,25 +91,76 @@ void mon_task()
 		vTaskDelete(NULL);
 	}
 	
+#ifdef INCLUDE_SYS_MON
 	// Let the system start up
 	vTaskDelay(pdMS_TO_TICKS(5000));
 	
+	// The log output includes the profiler statistics
+	profiling = true;
+#endif
+	
+#ifdef MON_MEM
+	print_buffer_placement();
+#endif
+	
 	while (1) {
-		// This shouldn't happen, but we check to protect from overrunning our sample arrays
-		if (uxTaskGetNumberOfTasks() > MON_MAX_TASKS) {
-			ESP_LOGE(TAG, "More than MON_MAX_TASKS tasks (%d) - bailing", uxTaskGetNumberOfTasks());
-			vTaskDelete(NULL);
+		if (profiling) {
+			// This shouldn't happen, but we check to protect from overrunning our sample arrays
+			if (uxTaskGetNumberOfTasks() > MON_MAX_TASKS) {
+				ESP_LOGE(TAG, "More than MON_MAX_TASKS tasks (%d) - disabling profiler", uxTaskGetNumberOfTasks());
+				profiling = false;
+			} else {
+				// Takes MON_PROFILE_MSEC
+				sample_tasks();
+			}
+		} else {
+			vTaskDelay(pdMS_TO_TICKS(MON_PROFILE_MSEC));
 		}
 		
+		// Once a second
+		evlog_service();
+		
+#ifdef INCLUDE_SYS_MON
+		if (++log_count >= (MON_SAMPLE_MSEC / MON_PROFILE_MSEC)) {
+			log_count = 0;
 #ifdef MON_MEM
-		print_memory_stats();
+			print_memory_stats();
+			print_psram_bandwidth();
 #endif
 #ifdef MON_TASKS
-		print_task_stats();
+			print_task_stats();
 #endif
+		}
+#endif
+	}
+}
+
 
-		vTaskDelay(pdMS_TO_TICKS(MON_SAMPLE_MSEC));
+/**
+ * Start or stop the task profiler.  Statistics are available after its first
+ * MON_PROFILE_MSEC window.
+ */
+void mon_set_profiling(bool enable)
+{
+	if (enable && !profiling) {
+		portENTER_CRITICAL(&stats_mux);
+		stats.window_usec = 0;
+		stats.num_tasks = 0;
+		portEXIT_CRITICAL(&stats_mux);
 	}
+	profiling = enable;
+}
+
+
+/**
+ * Get the statistics from the latest profiler window
+ */
+void mon_get_stats(mon_stats_t* s)
+{
+	portENTER_CRITICAL(&stats_mux);
+	memcpy(s, &stats, sizeof(mon_stats_t));
+	portEXIT_CRITICAL(&stats_mux);
+	s->enabled = profiling;
 }
 
 
@@ -95,20 +170,95 @@ void mon_task()
 //
 static bool init_mon_task()
 {
-	start_task_sample_array = heap_caps_malloc(sizeof(TaskStatus_t) * MON_MAX_TASKS, MALLOC_CAP_SPIRAM);
+	start_task_sample_array = system_buffer_alloc("mon start tasks", 0, sizeof(TaskStatus_t) * MON_MAX_TASKS, SYS_BUF_SPIRAM);
 	if (start_task_sample_array == NULL) {
 		return false;
 	}
 	
-	end_task_sample_array = heap_caps_malloc(sizeof(TaskStatus_t) * MON_MAX_TASKS, MALLOC_CAP_SPIRAM);
+	end_task_sample_array = system_buffer_alloc("mon end tasks", 0, sizeof(TaskStatus_t) * MON_MAX_TASKS, SYS_BUF_SPIRAM);
 	if (end_task_sample_array == NULL) {
 		return false;
 	}
 	
+#ifdef MON_MEM
+	bw_test_bufP = system_buffer_alloc("mon bandwidth", 0, MON_BW_TEST_LEN, SYS_BUF_SPIRAM);
+	if (bw_test_bufP == NULL) {
+		return false;
+	}
+#endif
+	
 	return true;
 }
 
 
+/**
+ * Sample the tasks over a MON_PROFILE_MSEC window and compute the per-task and per-core
+ * CPU utilization from the change in their run time counters.  FreeRTOS charges time
+ * in an interrupt to the task it interrupted so the vsync interrupt handler, the only
+ * one this firmware installs, is timed separately.
+ */
+static void sample_tasks()
+{
+	int i, j, k, n;
+	uint32_t start_run_time, end_run_time;
+	uint32_t total_elapsed_time;
+	uint32_t task_elapsed_time;
+	uint32_t start_isr_count, start_isr_usec;
+	uint32_t end_isr_count, end_isr_usec;
+	UBaseType_t start_array_size, end_array_size;
+	TaskHandle_t idle_handle[portNUM_PROCESSORS];
+	mon_task_stat_t* tP;
+	
+	for (i=0; i<portNUM_PROCESSORS; i++) {
+		idle_handle[i] = xTaskGetIdleTaskHandleForCPU(i);
+	}
+	
+	lep_get_isr_stats(&start_isr_count, &start_isr_usec);
+	start_array_size = uxTaskGetSystemState(start_task_sample_array, MON_MAX_TASKS, &start_run_time);
+	vTaskDelay(pdMS_TO_TICKS(MON_PROFILE_MSEC));
+	end_array_size = uxTaskGetSystemState(end_task_sample_array, MON_MAX_TASKS, &end_run_time);
+	lep_get_isr_stats(&end_isr_count, &end_isr_usec);
+	
+	total_elapsed_time = end_run_time - start_run_time;
+	if (total_elapsed_time == 0) return;
+	
+	portENTER_CRITICAL(&stats_mux);
+	stats.window_usec = total_elapsed_time;
+	stats.isr_count = end_isr_count - start_isr_count;
+	stats.isr_usec = end_isr_usec - start_isr_usec;
+	for (i=0; i<portNUM_PROCESSORS; i++) {
+		stats.core_load[i] = 100;
+	}
+	
+	// Tasks created or deleted during the window aren't included
+	n = 0;
+	for (i=0; i<start_array_size; i++) {
+		for (j=0; j<end_array_size; j++) {
+			if (start_task_sample_array[i].xHandle == end_task_sample_array[j].xHandle) {
+				task_elapsed_time = end_task_sample_array[j].ulRunTimeCounter - start_task_sample_array[i].ulRunTimeCounter;
+				if (task_elapsed_time > total_elapsed_time) task_elapsed_time = total_elapsed_time;
+				
+				tP = &stats.tasks[n++];
+				strncpy(tP->name, end_task_sample_array[j].pcTaskName, configMAX_TASK_NAME_LEN - 1);
+				tP->name[configMAX_TASK_NAME_LEN - 1] = 0;
+				tP->priority = end_task_sample_array[j].uxCurrentPriority;
+				tP->cpu = (uint64_t) task_elapsed_time * 100 / total_elapsed_time;
+				tP->stack_free = end_task_sample_array[j].usStackHighWaterMark;
+				
+				for (k=0; k<portNUM_PROCESSORS; k++) {
+					if (end_task_sample_array[j].xHandle == idle_handle[k]) {
+						stats.core_load[k] = 100 - tP->cpu;
+					}
+				}
+				break;
+			}
+		}
+	}
+	stats.num_tasks = n;
+	portEXIT_CRITICAL(&stats_mux);
+}
+
+
 #ifdef MON_MEM
 static void print_memory_stats()
 {
@@ -124,63 +274,90 @@ static void print_memory_stats()
 #endif
 	heap_caps_check_integrity_all(true);
 }
+
+
+/**
+ * Print where each buffer allocated by system_buffer_alloc() was placed
+ */
+static void print_buffer_placement()
+{
+	const sys_buf_info_t* info;
+	int i, n;
+	uint32_t int_len = 0;
+	uint32_t ext_len = 0;
+	
+	n = system_get_buffer_info(&info);
+	
+	ESP_LOGI(TAG, "Buffer Placement:");
+	printf("\tBuffer\t\t\tLength\tPlaced\n");
+	for (i=0; i<n; i++) {
+		printf("\t%16s %d\t%d\t%s%s\n", info[i].name, info[i].index, info[i].len,
+		       info[i].internal ? "DRAM" : "PSRAM",
+		       ((info[i].placement == SYS_BUF_INTERNAL) && !info[i].internal) ? " (wanted DRAM)" : "");
+		if (info[i].internal) {
+			int_len += info[i].len;
+		} else {
+			ext_len += info[i].len;
+		}
+	}
+	printf("\tTotal: DRAM %d, PSRAM %d\n", int_len, ext_len);
+}
+
+
+/**
+ * Measure the PSRAM read and write bandwidth available to this task (in competition
+ * with the other tasks using it) by streaming through a buffer larger than the cache
+ */
+static void print_psram_bandwidth()
+{
+	int i, n;
+	int64_t t, rd_usec, wr_usec;
+	int64_t rd_best = 0;
+	int64_t wr_best = 0;
+	volatile uint32_t sum = 0;
+	uint32_t* p;
+	
+	for (n=0; n<MON_BW_TEST_RUNS; n++) {
+		t = esp_timer_get_time();
+		memset(bw_test_bufP, n, MON_BW_TEST_LEN);
+		wr_usec = esp_timer_get_time() - t;
+		
+		// Read from the start which the end of the write has pushed out of the cache
+		p = bw_test_bufP;
+		t = esp_timer_get_time();
+		for (i=0; i<(MON_BW_TEST_LEN / 4); i++) {
+			sum += *p++;
+		}
+		rd_usec = esp_timer_get_time() - t;
+		
+		if ((wr_best == 0) || (wr_usec < wr_best)) wr_best = wr_usec;
+		if ((rd_best == 0) || (rd_usec < rd_best)) rd_best = rd_usec;
+	}
+	
+	if ((rd_best != 0) && (wr_best != 0)) {
+		ESP_LOGI(TAG, "PSRAM bandwidth: read %d KB/sec / write %d KB/sec",
+		         (int) ((int64_t) MON_BW_TEST_LEN * 1000 / rd_best),
+		         (int) ((int64_t) MON_BW_TEST_LEN * 1000 / wr_best));
+	}
+}
 #endif
 
 
 #ifdef MON_TASKS
 static void print_task_stats()
 {
-	uint32_t start_run_time, end_run_time;
-	uint32_t total_elapsed_time;
-	uint32_t task_elapsed_time;
-	uint32_t percentage_time;
-	UBaseType_t start_array_size, end_array_size;
-    
-    // Sample the tasks over a 1 second period so we can compute some stats
-    start_array_size = uxTaskGetSystemState(start_task_sample_array, MON_MAX_TASKS, &start_run_time);
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    end_array_size = uxTaskGetSystemState(end_task_sample_array, MON_MAX_TASKS, &end_run_time);
-
-    // Compute and display stats
-    total_elapsed_time = end_run_time - start_run_time;
-    if (total_elapsed_time != 0) {
-    	ESP_LOGI(TAG, "Task Statistics:");
-    	printf("\tTask\t\tRun Time\t%%\tPri\tStack Highwater\n");
-    	
-    	// Match each task in start_array to those in the end_array
-    	for (int i = 0; i < start_array_size; i++) {
-        	int k = -1;
-        	for (int j = 0; j < end_array_size; j++) {
-            	if (start_task_sample_array[i].xHandle == end_task_sample_array[j].xHandle) {
-               	 k = j;
-                	// Mark that task have been matched by overwriting their handles
-                	start_task_sample_array[i].xHandle = NULL;
-                	end_task_sample_array[j].xHandle = NULL;
-                	break;
-            	}
-        	}
-        	// Check if matching task found
-        	if (k >= 0) {
-            	task_elapsed_time = end_task_sample_array[k].ulRunTimeCounter - start_task_sample_array[i].ulRunTimeCounter;
-            	percentage_time = (task_elapsed_time * 100UL) / (total_elapsed_time * portNUM_PROCESSORS);
-            	printf("\t%16s\t%d\t%d%%\t%d\t%d\n", start_task_sample_array[i].pcTaskName,
-            	       task_elapsed_time, percentage_time,
-            	       start_task_sample_array[i].uxCurrentPriority,
-            	       start_task_sample_array[i].usStackHighWaterMark);
-        	}
-    	}
-    
-    	// Print unmatched tasks
-    	for (int i = 0; i < start_array_size; i++) {
-        	if (start_task_sample_array[i].xHandle != NULL) {
-           	 ESP_LOGI(TAG, "Task %s deleted\n", start_task_sample_array[i].pcTaskName);
-        	}
-    	}
-    	for (int i = 0; i < end_array_size; i++) {
-       	 if (end_task_sample_array[i].xHandle != NULL) {
-            	ESP_LOGI(TAG, "Task %s created\n", end_task_sample_array[i].pcTaskName);
-        	}
-    	}
-    }
+	int i;
+	
+	portENTER_CRITICAL(&stats_mux);
+	if (stats.window_usec != 0) {
+		ESP_LOGI(TAG, "Task Statistics:");
+		printf("\tTask\t\t%%\tPri\tStack Highwater\n");
+		for (i=0; i<stats.num_tasks; i++) {
+			printf("\t%16s\t%d%%\t%d\t%d\n", stats.tasks[i].name, stats.tasks[i].cpu,
+			       stats.tasks[i].priority, stats.tasks[i].stack_free);
+		}
+		printf("\tVsync ISR: %d in %d uSec\n", stats.isr_count, stats.isr_usec);
+	}
+	portEXIT_CRITICAL(&stats_mux);
 }
 #endif
@@ -2,7 +2,9 @@
  * Mon Task
  *
  * Monitor system CPU and memory utilization for debugging and application turning.
- * This task should only be included during development.
+ * The task profiler is switched on and its statistics read at run time with the
+ * get_sys_stats command.  Periodic log output should only be included during
+ * development (INCLUDE_SYS_MON).
  *
  * Copyright 2020 Dan Julio
  *
@@ -25,25 +27,66 @@
 #ifndef MON_TASK_H
 #define MON_TASK_H
 
+#include "system_config.h"
+#include "freertos/FreeRTOS.h"
+#include <stdbool.h>
+#include <stdint.h>
+
 
 //
 // Mon Task Constants
 //
-#define MON_SAMPLE_MSEC 5000
+// Log output interval (INCLUDE_SYS_MON) and task profiler sample window
+#define MON_SAMPLE_MSEC  5000
+#define MON_PROFILE_MSEC 1000
+
 #define MON_MAX_TASKS   20
 
-// Uncomment to enable monitoring of memory and/or tasks
+// Length of the PSRAM region read and written to measure PSRAM bandwidth (larger than
+// the 32 KB cache so it measures the external RAM itself) and the number of
+// measurements (the fastest is reported since other tasks may preempt mon_task)
+#define MON_BW_TEST_LEN  (64 * 1024)
+#define MON_BW_TEST_RUNS 3
+
+// Uncomment to enable logging of memory (including buffer placement and PSRAM
+// bandwidth) and/or tasks when INCLUDE_SYS_MON is defined
+#ifdef INCLUDE_SYS_MON
 #define MON_MEM
 #define MON_TASKS
+#endif
 
 // Uncomment for a more verbose memory monitoring output
 //#define MON_MEM_VERBOSE
 
 
 
+//
+// Mon Task typedefs
+//
+typedef struct {
+	char name[configMAX_TASK_NAME_LEN];
+	uint8_t priority;
+	uint8_t cpu;                          // Percent of one core during the window
+	uint32_t stack_free;                  // Stack high water mark (bytes never used)
+} mon_task_stat_t;
+
+typedef struct {
+	bool enabled;
+	uint32_t window_usec;                 // 0 until the first window is complete
+	uint8_t core_load[portNUM_PROCESSORS];// Percent of each core not idle
+	uint32_t isr_count;                   // Vsync interrupts during the window
+	uint32_t isr_usec;                    // Time in the vsync interrupt handler
+	int num_tasks;
+	mon_task_stat_t tasks[MON_MAX_TASKS];
+} mon_stats_t;
+
+
+
 //
 // Mon Task API
 //
 void mon_task();
+void mon_set_profiling(bool enable);
+void mon_get_stats(mon_stats_t* stats);
 
 #endif /* MON_TASK_H */
\ No newline at end of file
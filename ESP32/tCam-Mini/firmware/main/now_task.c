@@ -0,0 +1,410 @@
+/*
+ * ESP-NOW Task
+ *
+ * Send stats or compressed images to the gateway over ESP-NOW at the configured
+ * interval (see now_task.h).  The link is started the first time a message is sent and
+ * the gateway peer is updated when it, or the WiFi interface, changes.  Images are
+ * taken from the frame broker.  Stats are loaded by ana_task, which analyzes frames
+ * while a stats message is due.  One message is held at a time and packets are sent one
+ * at a time, each after the driver has finished with the previous one, so a camera
+ * never holds the channel for longer than a packet.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "now_task.h"
+#include "bin_utilities.h"
+#include "frame_utilities.h"
+#include "rice_codec.h"
+#include "sys_utilities.h"
+#include "system_config.h"
+#include "vospi.h"
+#include "wifi_utilities.h"
+#include "esp_now.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+
+
+//
+// NOW Task constants
+//
+
+// Largest message: a raw image with its header and telemetry (the low memory build
+// only sends stats messages)
+#ifdef CONFIG_TCAM_NO_PSRAM
+#define NOW_MAX_MSG_LEN JSON_MAX_RSP_TEXT_LEN
+#else
+#define NOW_MAX_MSG_LEN (BIN_MAX_IMAGE_HEADER_LEN + LEP_NUM_PIXELS*2 + LEP_TEL_WORDS*2)
+#endif
+
+
+
+//
+// NOW Task variables
+//
+static const char* TAG = "now_task";
+
+// Configuration and message schedule (shared with cmd_task and ana_task)
+static SemaphoreHandle_t now_mutex;
+static now_config_t now_config;
+static int64_t now_ready_usec;
+
+// Message being sent.  now_busy is set while it is loaded or sent.
+static bool now_busy;
+static int now_msg_type;
+static uint32_t now_msg_len;
+static uint8_t* now_msgP;
+static uint8_t* now_imageP;
+static uint16_t now_msg_num;
+
+// Link state
+static bool now_running = false;
+static bool now_peer_added = false;
+static uint8_t now_peer[6];
+static wifi_interface_t now_ifidx;
+
+// Set by the send callback for each packet
+static SemaphoreHandle_t now_sent_sem;
+static volatile bool now_send_ok;
+
+static uint8_t now_pkt[NOW_MAX_PKT_LEN];
+
+// Frame broker subscriber id
+static int frame_sub;
+
+
+
+//
+// NOW Task Forward Declarations for internal functions
+//
+static bool claim_msg(int mode);
+static void free_msg();
+static void load_image(lep_buffer_t* lep_bufP);
+static void send_msg();
+static bool start_link();
+static void send_cb(const uint8_t* mac_addr, esp_now_send_status_t status);
+
+
+
+//
+// NOW Task API
+//
+
+/**
+ * Allocate the message buffers.  Called before the tasks are started.  ESP-NOW is off
+ * at power-on.
+ */
+bool now_init()
+{
+	now_mutex = xSemaphoreCreateMutex();
+	now_sent_sem = xSemaphoreCreateBinary();
+	if ((now_mutex == NULL) || (now_sent_sem == NULL)) {
+		ESP_LOGE(TAG, "create ESP-NOW semaphores failed");
+		return false;
+	}
+
+	now_msgP = system_buffer_alloc("espnow msg", 0, NOW_MAX_MSG_LEN, SYS_BUF_SPIRAM);
+#ifdef CONFIG_TCAM_NO_PSRAM
+	if (now_msgP == NULL) {
+#else
+	now_imageP = system_buffer_alloc("espnow image", 0, LEP_NUM_PIXELS*2, SYS_BUF_SPIRAM);
+	if ((now_msgP == NULL) || (now_imageP == NULL)) {
+#endif
+		ESP_LOGE(TAG, "malloc ESP-NOW buffers failed");
+		return false;
+	}
+
+	now_config.mode = NOW_MODE_OFF;
+	memset(now_config.peer, 0xFF, sizeof(now_config.peer));
+	now_config.interval_ms = NOW_DEF_INTERVAL_MSEC;
+	now_busy = false;
+	now_msg_num = 0;
+
+	return true;
+}
+
+
+void now_task()
+{
+	uint32_t notification_value;
+	uint32_t missed;
+	lep_buffer_t* lep_bufP;
+
+	ESP_LOGI(TAG, "Start task");
+
+	frame_sub = frame_subscribe(xTaskGetCurrentTaskHandle(), NOW_NOTIFY_LEP_FRAME_MASK);
+
+	while (1) {
+		notification_value = 0;
+		if (xTaskNotifyWait(0x00, 0xFFFFFFFF, &notification_value, pdMS_TO_TICKS(NOW_TASK_MAX_WAIT_MSEC))) {
+			// Handle lep_task notifications
+			if (Notification(notification_value, NOW_NOTIFY_LEP_FRAME_MASK)) {
+				if (claim_msg(NOW_MODE_IMAGE)) {
+					lep_bufP = frame_acquire(frame_sub, &missed);
+					if (lep_bufP != NULL) {
+						load_image(lep_bufP);
+						frame_release(lep_bufP);
+						send_msg();
+					} else {
+						free_msg();
+					}
+				} else {
+					(void) frame_skip(frame_sub);
+				}
+			}
+
+			// Handle ana_task notifications
+			if (Notification(notification_value, NOW_NOTIFY_STATS_MASK)) {
+				send_msg();
+			}
+		}
+	}
+}
+
+
+// Called by cmd_task to set the mode, gateway and interval.  The first message is due
+// now.
+void now_set_config(now_config_t* cfg)
+{
+	xSemaphoreTake(now_mutex, portMAX_DELAY);
+	now_config = *cfg;
+#ifdef CONFIG_TCAM_NO_PSRAM
+	// There is no buffer to compress images into
+	if (now_config.mode == NOW_MODE_IMAGE) {
+		now_config.mode = NOW_MODE_OFF;
+	}
+#endif
+	if (now_config.interval_ms > NOW_MAX_INTERVAL_MSEC) {
+		now_config.interval_ms = NOW_MAX_INTERVAL_MSEC;
+	}
+	now_ready_usec = esp_timer_get_time();
+	xSemaphoreGive(now_mutex);
+}
+
+
+// Called by ana_task to find out if it should analyze the frame for a stats message
+bool now_stats_due()
+{
+	bool due;
+
+	xSemaphoreTake(now_mutex, portMAX_DELAY);
+	due = (now_config.mode == NOW_MODE_STATS) && !now_busy && (esp_timer_get_time() >= now_ready_usec);
+	xSemaphoreGive(now_mutex);
+
+	return due;
+}
+
+
+// Called by ana_task with the stats text for a frame.  It is sent if a stats message is
+// still due.
+void now_push_stats(char* text, uint32_t len)
+{
+	if ((len > NOW_MAX_MSG_LEN) || !claim_msg(NOW_MODE_STATS)) return;
+
+	memcpy(now_msgP, text, len);
+	now_msg_type = NOW_MSG_STATS;
+	now_msg_len = len;
+	xTaskNotify(task_handle_now, NOW_NOTIFY_STATS_MASK, eSetBits);
+}
+
+
+
+//
+// NOW Task internal functions
+//
+
+/**
+ * Take the message buffer and advance the schedule if a message of mode is due
+ */
+static bool claim_msg(int mode)
+{
+	bool due;
+	int64_t cur_usec;
+
+	xSemaphoreTake(now_mutex, portMAX_DELAY);
+	cur_usec = esp_timer_get_time();
+	due = (now_config.mode == mode) && !now_busy && (cur_usec >= now_ready_usec);
+	if (due) {
+		now_busy = true;
+
+		// Don't let the schedule fall behind
+		now_ready_usec += (int64_t) now_config.interval_ms * 1000;
+		if (now_ready_usec < cur_usec) {
+			now_ready_usec = cur_usec + (int64_t) now_config.interval_ms * 1000;
+		}
+	}
+	xSemaphoreGive(now_mutex);
+
+	return due;
+}
+
+
+static void free_msg()
+{
+	xSemaphoreTake(now_mutex, portMAX_DELAY);
+	now_busy = false;
+	xSemaphoreGive(now_mutex);
+}
+
+
+/**
+ * Load the message buffer with a frame compressed as a keyframe binary image
+ */
+static void load_image(lep_buffer_t* lep_bufP)
+{
+	uint8_t encoding = BIN_ENC_RICE;
+	uint8_t* imgP = now_imageP;
+	uint32_t img_len, hdr_len, telem_len;
+
+	img_len = rice_encode_image(lep_bufP->lep_bufferP, NULL, LEP_WIDTH, LEP_HEIGHT, now_imageP, LEP_NUM_PIXELS*2);
+	if (img_len == 0) {
+		// Incompressible frames are sent raw
+		encoding = BIN_ENC_RAW;
+		imgP = (uint8_t*) lep_bufP->lep_bufferP;
+		img_len = LEP_NUM_PIXELS*2;
+	}
+
+	hdr_len = bin_get_image_header(now_msgP, lep_bufP, LEP_WIDTH, LEP_HEIGHT, encoding, img_len, 0);
+	telem_len = bin_get_image_telem_len(lep_bufP, 0);
+	memcpy(now_msgP + hdr_len, imgP, img_len);
+	if (telem_len != 0) {
+		memcpy(now_msgP + hdr_len + img_len, lep_bufP->lep_telemP, telem_len);
+	}
+
+	now_msg_type = NOW_MSG_IMAGE;
+	now_msg_len = hdr_len + img_len + telem_len;
+}
+
+
+/**
+ * Send the message in the buffer, one packet at a time, and free the buffer.  The rest
+ * of the message is dropped if a packet isn't delivered.
+ */
+static void send_msg()
+{
+	uint32_t frag, num_frags, len, offset;
+	esp_err_t ret;
+
+	if (start_link()) {
+		num_frags = (now_msg_len + NOW_MAX_FRAG_LEN - 1) / NOW_MAX_FRAG_LEN;
+		now_pkt[0] = NOW_PKT_START;
+		now_pkt[1] = NOW_PKT_VERSION;
+		now_pkt[2] = now_msg_type;
+		now_pkt[3] = 0;
+		now_pkt[4] = now_msg_num & 0xFF;
+		now_pkt[5] = now_msg_num >> 8;
+		now_pkt[8] = num_frags & 0xFF;
+		now_pkt[9] = num_frags >> 8;
+
+		for (frag=0; frag<num_frags; frag++) {
+			offset = frag * NOW_MAX_FRAG_LEN;
+			len = now_msg_len - offset;
+			if (len > NOW_MAX_FRAG_LEN) len = NOW_MAX_FRAG_LEN;
+			now_pkt[6] = frag & 0xFF;
+			now_pkt[7] = frag >> 8;
+			memcpy(&now_pkt[NOW_PKT_HEADER_LEN], now_msgP + offset, len);
+
+			// Discard a late callback for a packet that timed out
+			(void) xSemaphoreTake(now_sent_sem, 0);
+			ret = esp_now_send(now_peer, now_pkt, NOW_PKT_HEADER_LEN + len);
+			if (ret != ESP_OK) {
+				ESP_LOGE(TAG, "esp_now_send failed (%d)", ret);
+				break;
+			}
+			if ((xSemaphoreTake(now_sent_sem, pdMS_TO_TICKS(NOW_SEND_TIMEOUT_MSEC)) != pdTRUE) || !now_send_ok) {
+				ESP_LOGE(TAG, "Message %d not delivered", now_msg_num);
+				break;
+			}
+		}
+		now_msg_num++;
+	}
+
+	free_msg();
+}
+
+
+/**
+ * Start ESP-NOW and register the gateway on the current WiFi interface if necessary.
+ * Returns false if WiFi isn't running or the link can't be started.
+ */
+static bool start_link()
+{
+	esp_err_t ret;
+	esp_now_peer_info_t peer_info;
+	wifi_info_t* wifi_infoP = wifi_get_info();
+	wifi_interface_t ifidx;
+	uint8_t peer[6];
+
+	if ((wifi_infoP->flags & WIFI_INFO_FLAG_ENABLED) == 0) return false;
+	ifidx = ((wifi_infoP->flags & WIFI_INFO_FLAG_CLIENT_MODE) != 0) ? ESP_IF_WIFI_STA : ESP_IF_WIFI_AP;
+
+	if (!now_running) {
+		ret = esp_now_init();
+		if (ret != ESP_OK) {
+			ESP_LOGE(TAG, "esp_now_init failed (%d)", ret);
+			return false;
+		}
+		(void) esp_now_register_send_cb(send_cb);
+		now_running = true;
+	}
+
+	xSemaphoreTake(now_mutex, portMAX_DELAY);
+	memcpy(peer, now_config.peer, sizeof(peer));
+	xSemaphoreGive(now_mutex);
+
+	if (!now_peer_added || (memcmp(peer, now_peer, sizeof(peer)) != 0) || (ifidx != now_ifidx)) {
+		if (now_peer_added) {
+			(void) esp_now_del_peer(now_peer);
+			now_peer_added = false;
+		}
+
+		// The packets are sent on the interface's current channel
+		memset(&peer_info, 0, sizeof(peer_info));
+		memcpy(peer_info.peer_addr, peer, sizeof(peer));
+		peer_info.channel = 0;
+		peer_info.ifidx = ifidx;
+		peer_info.encrypt = false;
+		ret = esp_now_add_peer(&peer_info);
+		if (ret != ESP_OK) {
+			ESP_LOGE(TAG, "esp_now_add_peer failed (%d)", ret);
+			return false;
+		}
+		memcpy(now_peer, peer, sizeof(peer));
+		now_ifidx = ifidx;
+		now_peer_added = true;
+		ESP_LOGI(TAG, "Sending to "MACSTR, MAC2STR(now_peer));
+	}
+
+	return true;
+}
+
+
+/**
+ * Called by the WiFi driver when it is done with a packet
+ */
+static void send_cb(const uint8_t* mac_addr, esp_now_send_status_t status)
+{
+	now_send_ok = (status == ESP_NOW_SEND_SUCCESS);
+	xSemaphoreGive(now_sent_sem);
+}
@@ -0,0 +1,107 @@
+/*
+ * ESP-NOW Task
+ *
+ * Send analytics stats or compressed images to a gateway (see gw_task.h) over ESP-NOW
+ * instead of a TCP connection.  ESP-NOW is connectionless so many cameras near one
+ * gateway can share the channel without a client connection or AP association between
+ * them and the gateway.  The camera sends on the channel its WiFi interface is using
+ * (its own AP's channel in AP mode, the AP's channel in client mode) so the gateway
+ * must be built for that channel.
+ *
+ * Each message is a json stats object (see json_get_ana_stats) or a binary image (see
+ * bin_utilities.h) compressed as a keyframe, exactly as it would be sent to a client,
+ * split into packets that fit in an ESP-NOW frame.  Unicast packets are retried by the
+ * WiFi driver until the gateway acknowledges them.  Broadcast packets are not, so a
+ * message is lost if any of its packets are.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef NOW_TASK_H
+#define NOW_TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//
+// NOW Task Constants
+//
+
+// Maximum time to block waiting for a notification
+#define NOW_TASK_MAX_WAIT_MSEC 1000
+
+// Maximum time to wait for the driver to finish sending a packet (including its retries)
+#define NOW_SEND_TIMEOUT_MSEC  100
+
+// Modes
+#define NOW_MODE_OFF   0
+#define NOW_MODE_STATS 1
+#define NOW_MODE_IMAGE 2
+
+// Message interval (0 = every frame) limits and power-on setting.  A compressed image
+// takes about 100 packets.
+#define NOW_MAX_INTERVAL_MSEC 3600000
+#define NOW_DEF_INTERVAL_MSEC 1000
+
+// Packet format.  Each packet starts with a NOW_PKT_HEADER_LEN byte header followed by
+// up to NOW_MAX_FRAG_LEN bytes of the message.  Multi-byte values are little-endian.
+//   0   NOW_PKT_START
+//   1   NOW_PKT_VERSION
+//   2   Message type (NOW_MSG_xxx)
+//   3   Reserved (0)
+//   4-5 Message number (increments with each message)
+//   6-7 Fragment number (0 to count - 1)
+//   8-9 Fragment count
+#define NOW_PKT_START      0xA7
+#define NOW_PKT_VERSION    1
+#define NOW_PKT_HEADER_LEN 10
+#define NOW_MAX_PKT_LEN    250
+#define NOW_MAX_FRAG_LEN   (NOW_MAX_PKT_LEN - NOW_PKT_HEADER_LEN)
+
+// Message types
+#define NOW_MSG_STATS 1
+#define NOW_MSG_IMAGE 2
+
+// NOW Task notifications
+#define NOW_NOTIFY_LEP_FRAME_MASK  0x00000010
+#define NOW_NOTIFY_STATS_MASK      0x00000020
+
+
+
+//
+// NOW Task typedefs
+//
+typedef struct {
+	int mode;                    // NOW_MODE_xxx
+	uint8_t peer[6];             // Gateway MAC address (all 0xFF to broadcast)
+	uint32_t interval_ms;
+} now_config_t;
+
+
+
+//
+// NOW Task API
+//
+bool now_init();
+void now_task();
+void now_set_config(now_config_t* cfg);
+bool now_stats_due();
+void now_push_stats(char* text, uint32_t len);
+
+#endif /* NOW_TASK_H */
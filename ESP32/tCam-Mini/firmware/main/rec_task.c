@@ -0,0 +1,680 @@
+/*
+ * Record Task
+ *
+ * Implement the on-camera recorder.  Frames are taken from the frame broker while a
+ * recording is running, encoded as binary images and appended to the record flash
+ * partition (see rec_task.h for the container format).  Flash is erased in blocks
+ * ahead of the records so each record is simply written.  Frames that arrive while
+ * the task is busy writing (or erasing) are skipped so the recording rate is limited
+ * by the flash, not the lepton.  The frame index is built when the recording is
+ * closed by walking the records so no per-frame state is kept in memory.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "rec_task.h"
+#include "bin_utilities.h"
+#include "frame_utilities.h"
+#include "perf_utilities.h"
+#include "rice_codec.h"
+#include "sys_utilities.h"
+#include "system_config.h"
+#include "vospi.h"
+#include "esp_system.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+
+
+
+//
+// REC Task typedefs
+//
+
+// Recording parameters from cmd_task
+typedef struct {
+	int encoding;
+	uint32_t delay_ms;
+	uint32_t num_frames;
+	uint32_t key_interval;
+} rec_request_t;
+
+
+
+//
+// REC Task variables
+//
+static const char* TAG = "rec_task";
+
+static const esp_partition_t* rec_part;
+static uint32_t rec_capacity;          // Usable partition size (whole erase blocks)
+
+// Recorder status (shared with cmd_task and rsp_task)
+static SemaphoreHandle_t rec_mutex;
+static rec_info_t rec_info;
+static rec_request_t rec_request;
+
+// Recording state
+static uint32_t rec_frame_delay_usec;
+static uint32_t rec_frame_num;
+static uint32_t rec_remaining_frames;
+static uint32_t rec_frames_since_key;
+static int64_t rec_ready_usec;
+static uint32_t rec_offset;            // Location of the next record
+static uint32_t rec_erase_end;         // End of the erased flash
+static uint32_t rec_records;
+static int rec_index_num;              // Index entries written
+static uint32_t rec_index_next;        // Offset the next indexed keyframe must be past
+static uint32_t rec_index_spacing;
+
+static uint8_t rec_header[BIN_MAX_IMAGE_HEADER_LEN];
+
+// Frame broker subscriber id
+static int frame_sub;
+
+
+
+//
+// REC Task Forward Declarations for internal functions
+//
+static void recover_recording();
+static void open_recording();
+static void close_recording(bool recovered);
+static uint32_t write_frame_index(bool check_erased);
+static bool is_erased(uint32_t offset, uint32_t len);
+static bool frame_wanted();
+static bool write_frame(lep_buffer_t* lep_bufP);
+static bool erase_to(uint32_t end);
+static void add_index(uint32_t record, uint32_t offset);
+static void set_progress();
+static uint8_t* put_u16(uint8_t* p, uint16_t v);
+static uint8_t* put_u32(uint8_t* p, uint32_t v);
+static uint32_t get_u32(uint8_t* p);
+
+
+
+//
+// REC Task API
+//
+
+/**
+ * Find the record partition and load the status of the recording in it.  Called
+ * before the tasks are started.  Returns false if the recorder couldn't be
+ * initialized (a missing partition just disables recording).
+ */
+bool rec_init()
+{
+	rec_mutex = xSemaphoreCreateMutex();
+	if (rec_mutex == NULL) {
+		ESP_LOGE(TAG, "create record mutex failed");
+		return false;
+	}
+
+	memset(&rec_info, 0, sizeof(rec_info_t));
+	rec_info.state = REC_STATE_NONE;
+
+	rec_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, REC_PARTITION_SUBTYPE, REC_PARTITION_NAME);
+	if (rec_part == NULL) {
+		ESP_LOGE(TAG, "No record partition - recording disabled");
+		return true;
+	}
+	rec_capacity = (rec_part->size / REC_ERASE_BLOCK_LEN) * REC_ERASE_BLOCK_LEN;
+	if (rec_capacity <= REC_ERASE_BLOCK_LEN) {
+		ESP_LOGE(TAG, "Record partition too small - recording disabled");
+		rec_part = NULL;
+		return true;
+	}
+	rec_index_spacing = (rec_capacity - REC_HEADER_LEN) / REC_INDEX_ENTRIES;
+
+	recover_recording();
+
+	return true;
+}
+
+
+void rec_task()
+{
+	uint32_t notification_value;
+	uint32_t missed;
+	lep_buffer_t* lep_bufP;
+
+	ESP_LOGI(TAG, "Start task");
+
+	frame_sub = frame_subscribe(xTaskGetCurrentTaskHandle(), REC_NOTIFY_LEP_FRAME_MASK);
+
+	while (1) {
+		notification_value = 0;
+		if (xTaskNotifyWait(0x00, 0xFFFFFFFF, &notification_value, pdMS_TO_TICKS(REC_TASK_MAX_WAIT_MSEC))) {
+			// Handle cmd_task notifications (a new recording replaces the current one)
+			if (Notification(notification_value, REC_NOTIFY_STOP_MASK)) {
+				if (rec_info.state == REC_STATE_RECORDING) {
+					close_recording(false);
+				}
+			}
+
+			if (Notification(notification_value, REC_NOTIFY_START_MASK)) {
+				if (rec_info.state == REC_STATE_RECORDING) {
+					close_recording(false);
+				}
+				if (rec_info.state == REC_STATE_IDLE) {
+					open_recording();
+				}
+			}
+
+			// Handle lep_task notifications
+			if (Notification(notification_value, REC_NOTIFY_LEP_FRAME_MASK)) {
+				if ((rec_info.state == REC_STATE_RECORDING) && frame_wanted()) {
+					lep_bufP = frame_acquire(frame_sub, &missed);
+					if (lep_bufP != NULL) {
+						// Frames missed were published while we were writing
+						xSemaphoreTake(rec_mutex, portMAX_DELAY);
+						rec_info.skipped += missed;
+						xSemaphoreGive(rec_mutex);
+
+						if (!write_frame(lep_bufP)) {
+							close_recording(false);
+						}
+						frame_release(lep_bufP);
+					}
+				} else {
+					(void) frame_skip(frame_sub);
+				}
+			}
+		}
+	}
+}
+
+
+// Called by cmd_task to start a new recording (the low memory build has no buffers to
+// compress images so it always records raw images)
+void rec_start(int encoding, uint32_t delay_ms, uint32_t num_frames, uint32_t key_interval)
+{
+#ifdef CONFIG_TCAM_NO_PSRAM
+	encoding = BIN_ENC_RAW;
+#endif
+	xSemaphoreTake(rec_mutex, portMAX_DELAY);
+	rec_request.encoding = encoding;
+	rec_request.delay_ms = delay_ms;
+	rec_request.num_frames = num_frames;
+	rec_request.key_interval = key_interval;
+	xSemaphoreGive(rec_mutex);
+
+	xTaskNotify(task_handle_rec, REC_NOTIFY_START_MASK, eSetBits);
+}
+
+
+// Called by cmd_task to stop recording
+void rec_stop()
+{
+	xTaskNotify(task_handle_rec, REC_NOTIFY_STOP_MASK, eSetBits);
+}
+
+
+// Called by cmd_task to get the recorder status
+void rec_get_info(rec_info_t* info)
+{
+	xSemaphoreTake(rec_mutex, portMAX_DELAY);
+	*info = rec_info;
+	xSemaphoreGive(rec_mutex);
+}
+
+
+// Called by rsp_task to read up to len bytes of the recording starting at offset.
+// Only the part of the recording already written is read.  Returns the number of
+// bytes loaded into buf.
+uint32_t rec_read(uint32_t offset, uint8_t* buf, uint32_t len)
+{
+	uint32_t length;
+
+	if (rec_part == NULL) return 0;
+
+	xSemaphoreTake(rec_mutex, portMAX_DELAY);
+	length = rec_info.length;
+	xSemaphoreGive(rec_mutex);
+
+	if (offset >= length) return 0;
+	if (len > (length - offset)) len = length - offset;
+
+	if (esp_partition_read(rec_part, offset, buf, len) != ESP_OK) {
+		ESP_LOGE(TAG, "Record partition read failed");
+		return 0;
+	}
+
+	return len;
+}
+
+
+
+//
+// Internal functions
+//
+
+/**
+ * Load the status of the recording in the partition, closing it if it was interrupted
+ * (before the other tasks are running)
+ */
+static void recover_recording()
+{
+	uint8_t buf[REC_INDEX_OFFSET];
+	uint32_t length, records, offset, index_len;
+	int i;
+
+	rec_info.state = REC_STATE_IDLE;
+	rec_info.capacity = rec_capacity;
+
+	if (esp_partition_read(rec_part, 0, buf, REC_INDEX_OFFSET) != ESP_OK) return;
+	if ((memcmp(buf, REC_FILE_MAGIC, 4) != 0) || (buf[4] != REC_FILE_VERSION)) return;
+
+	length = get_u32(&buf[REC_HDR_LENGTH]);
+	records = get_u32(&buf[REC_HDR_RECORDS]);
+	index_len = get_u32(&buf[REC_HDR_FRAME_INDEX_LEN]);
+	rec_info.encoding = buf[REC_HDR_ENCODING];
+	rec_info.key_interval = get_u32(&buf[8]);
+
+	if (length == 0xFFFFFFFF) {
+		// Start from the last keyframe in the index
+		records = 0;
+		offset = REC_HEADER_LEN;
+		for (i=0; i<REC_INDEX_ENTRIES; i++) {
+			if (esp_partition_read(rec_part, REC_INDEX_OFFSET + i*REC_INDEX_ENTRY_LEN, buf, REC_INDEX_ENTRY_LEN) != ESP_OK) break;
+			if (get_u32(&buf[4]) == 0xFFFFFFFF) break;
+			records = get_u32(&buf[0]);
+			offset = get_u32(&buf[4]);
+		}
+
+		// Walk the complete records that follow it
+		while ((offset + BIN_IMAGE_HEADER_LEN) <= rec_capacity) {
+			if (esp_partition_read(rec_part, offset, buf, BIN_IMAGE_HEADER_LEN) != ESP_OK) break;
+			if (buf[0] != BIN_IMAGE_START) break;
+			length = (buf[2] | (buf[3] << 8)) + get_u32(&buf[4]);
+			if ((offset + length) > rec_capacity) break;
+			offset += length;
+			records++;
+		}
+
+		ESP_LOGI(TAG, "Closing interrupted recording");
+		rec_offset = offset;
+		rec_records = records;
+		set_progress();
+		close_recording(true);
+	} else if ((length + index_len) <= rec_capacity) {
+		// A recording made with a larger partition is discarded
+		rec_info.length = length + index_len;
+		rec_info.records = records;
+	}
+}
+
+
+/**
+ * Erase the start of the partition and write the header block for a new recording
+ */
+static void open_recording()
+{
+	uint8_t buf[REC_INDEX_OFFSET];
+	uint8_t* p;
+	rec_request_t req;
+
+	xSemaphoreTake(rec_mutex, portMAX_DELAY);
+	req = rec_request;
+	xSemaphoreGive(rec_mutex);
+
+	rec_erase_end = 0;
+	if (!erase_to(REC_HEADER_LEN)) return;
+
+	memset(buf, 0, REC_INDEX_OFFSET);
+	memcpy(buf, REC_FILE_MAGIC, 4);
+	buf[4] = REC_FILE_VERSION;
+	buf[REC_HDR_ENCODING] = (uint8_t) req.encoding;
+	p = put_u16(&buf[6], REC_HEADER_LEN);
+	p = put_u32(p, req.key_interval);
+	p = put_u32(p, req.delay_ms);
+	p = put_u16(p, REC_INDEX_OFFSET);
+	(void) put_u16(p, REC_INDEX_ENTRIES);
+	memset(&buf[REC_HDR_LENGTH], 0xFF, 16);
+	if (esp_partition_write(rec_part, 0, buf, REC_INDEX_OFFSET) != ESP_OK) {
+		ESP_LOGE(TAG, "Record header write failed");
+		return;
+	}
+
+	rec_frame_delay_usec = req.delay_ms * 1000;
+	rec_frame_num = req.num_frames;
+	rec_remaining_frames = req.num_frames;
+	rec_frames_since_key = 0;
+	rec_ready_usec = esp_timer_get_time();
+	rec_offset = REC_HEADER_LEN;
+	rec_records = 0;
+	rec_index_num = 0;
+	rec_index_next = REC_HEADER_LEN;
+
+	xSemaphoreTake(rec_mutex, portMAX_DELAY);
+	rec_info.state = REC_STATE_RECORDING;
+	rec_info.encoding = (uint8_t) req.encoding;
+	rec_info.key_interval = req.key_interval;
+	rec_info.length = REC_HEADER_LEN;
+	rec_info.records = 0;
+	rec_info.skipped = 0;
+	xSemaphoreGive(rec_mutex);
+
+	ESP_LOGI(TAG, "Start recording");
+}
+
+
+/**
+ * Write the frame index and then the recording length, number of records and frame
+ * index length into the header block.  A recording recovered at boot only gets a
+ * frame index if the flash following its records is still erased (an interrupted
+ * write may have left data there).
+ */
+static void close_recording(bool recovered)
+{
+	uint8_t buf[16];
+	uint8_t* p;
+	uint32_t index_len;
+
+	index_len = write_frame_index(recovered);
+
+	p = put_u32(put_u32(buf, rec_offset), 0);
+	(void) put_u32(put_u32(p, rec_records), index_len);
+	if (esp_partition_write(rec_part, REC_HDR_LENGTH, buf, 16) != ESP_OK) {
+		ESP_LOGE(TAG, "Record header write failed");
+	}
+
+	xSemaphoreTake(rec_mutex, portMAX_DELAY);
+	rec_info.state = REC_STATE_IDLE;
+	rec_info.length = rec_offset + index_len;
+	xSemaphoreGive(rec_mutex);
+
+	ESP_LOGI(TAG, "Stop recording: %u records, %u bytes", rec_records, rec_offset + index_len);
+}
+
+
+/**
+ * Walk the records writing a frame index entry for each one following them.  Returns
+ * the frame index length or 0 if it couldn't be written.
+ */
+static uint32_t write_frame_index(bool check_erased)
+{
+	uint8_t buf[REC_FRAME_INDEX_ENTRY_LEN];
+	uint8_t encoding;
+	uint8_t* p;
+	uint8_t* end;
+	uint32_t i, offset, hdr_len, meta_len, read_len, len;
+	uint32_t index_len = REC_FRAME_INDEX_HEADER_LEN + rec_records*REC_FRAME_INDEX_ENTRY_LEN;
+	uint32_t lo, hi;
+
+	if ((rec_offset + index_len) > rec_capacity) return 0;
+	if (check_erased) {
+		if (!is_erased(rec_offset, index_len)) {
+			ESP_LOGE(TAG, "Recording closed without a frame index");
+			return 0;
+		}
+	} else if (!erase_to(rec_offset + index_len)) {
+		return 0;
+	}
+
+	memset(buf, 0, REC_FRAME_INDEX_ENTRY_LEN);
+	buf[0] = REC_FRAME_INDEX_START;
+	buf[1] = REC_FRAME_INDEX_VERSION;
+	p = put_u16(&buf[2], REC_FRAME_INDEX_HEADER_LEN);
+	p = put_u32(p, rec_records);
+	(void) put_u16(p, REC_FRAME_INDEX_ENTRY_LEN);
+	if (esp_partition_write(rec_part, rec_offset, buf, REC_FRAME_INDEX_HEADER_LEN) != ESP_OK) {
+		ESP_LOGE(TAG, "Record frame index write failed");
+		return 0;
+	}
+
+	offset = REC_HEADER_LEN;
+	for (i=0; i<rec_records; i++) {
+		// Get the encoding and timestamp from the record's metadata TLVs
+		read_len = rec_offset - offset;
+		if (read_len > BIN_MAX_IMAGE_HEADER_LEN) read_len = BIN_MAX_IMAGE_HEADER_LEN;
+		if (esp_partition_read(rec_part, offset, rec_header, read_len) != ESP_OK) return 0;
+		hdr_len = rec_header[2] | (rec_header[3] << 8);
+		meta_len = rec_header[12] | (rec_header[13] << 8);
+		len = hdr_len + get_u32(&rec_header[4]);
+
+		encoding = BIN_ENC_RAW;
+		lo = 0;
+		hi = 0;
+		p = &rec_header[hdr_len];
+		end = p + meta_len;
+		if (end > &rec_header[read_len]) end = &rec_header[read_len];
+		while ((p + 2) <= end) {
+			if ((p + 2 + p[1]) > end) break;
+			if ((p[0] == BIN_TLV_ENCODING) && (p[1] == 1)) {
+				encoding = p[2];
+			} else if ((p[0] == BIN_TLV_TIMESTAMP) && (p[1] == 8)) {
+				lo = get_u32(&p[2]);
+				hi = get_u32(&p[6]);
+			}
+			p += 2 + p[1];
+		}
+
+		memset(buf, 0, REC_FRAME_INDEX_ENTRY_LEN);
+		p = put_u32(put_u32(buf, offset), 0);
+		p = put_u32(put_u32(p, lo), hi);
+		p = put_u32(p, len);
+		*p = encoding;
+		if (esp_partition_write(rec_part, rec_offset + REC_FRAME_INDEX_HEADER_LEN + i*REC_FRAME_INDEX_ENTRY_LEN,
+		                        buf, REC_FRAME_INDEX_ENTRY_LEN) != ESP_OK) {
+			ESP_LOGE(TAG, "Record frame index write failed");
+			return 0;
+		}
+
+		offset += len;
+	}
+
+	return index_len;
+}
+
+
+/**
+ * Return true if len bytes of flash starting at offset are erased
+ */
+static bool is_erased(uint32_t offset, uint32_t len)
+{
+	uint32_t i, n;
+
+	while (len != 0) {
+		n = (len > BIN_MAX_IMAGE_HEADER_LEN) ? BIN_MAX_IMAGE_HEADER_LEN : len;
+		if (esp_partition_read(rec_part, offset, rec_header, n) != ESP_OK) return false;
+		for (i=0; i<n; i++) {
+			if (rec_header[i] != 0xFF) return false;
+		}
+		offset += n;
+		len -= n;
+	}
+
+	return true;
+}
+
+
+/**
+ * Evaluate the recording rate to see if the next frame should be recorded
+ */
+static bool frame_wanted()
+{
+	int64_t cur_usec;
+
+	if (rec_frame_delay_usec == 0) return true;
+
+	cur_usec = esp_timer_get_time();
+	if (cur_usec >= rec_ready_usec) {
+		rec_ready_usec = rec_ready_usec + rec_frame_delay_usec;
+		if (rec_ready_usec < cur_usec) {
+			// Don't try to catch up after a slow write
+			rec_ready_usec = cur_usec + rec_frame_delay_usec;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+
+/**
+ * Encode a frame and append it to the recording.  Returns false when the recording
+ * can't continue (the partition is full, a flash error or the requested number of
+ * frames has been recorded).
+ */
+static bool write_frame(lep_buffer_t* lep_bufP)
+{
+	bool key;
+	uint8_t encoding = BIN_ENC_RAW;
+	uint8_t* imgP = (uint8_t*) lep_bufP->lep_bufferP;
+	uint32_t img_len = LEP_NUM_PIXELS*2;
+	uint32_t hdr_len, telem_len, len;
+	int64_t tb;
+
+	// Compressed recordings with a key interval record delta images against the
+	// previous frame between keyframes
+	key = (rec_info.key_interval == 0) || ((rec_frames_since_key + 1) >= rec_info.key_interval) ||
+	      (rec_records == 0);
+	if (rec_info.encoding == BIN_ENC_RICE) {
+		tb = esp_timer_get_time();
+		len = rice_encode_image(lep_bufP->lep_bufferP, key ? NULL : sys_rec_ref_bufferP,
+		                        LEP_WIDTH, LEP_HEIGHT, sys_rec_image_bufferP, img_len);
+		perf_record(PERF_STAGE_RICE_ENC, tb);
+		if (len != 0) {
+			imgP = sys_rec_image_bufferP;
+			img_len = len;
+			encoding = key ? BIN_ENC_RICE : BIN_ENC_RICE_DELTA;
+		}
+	}
+	key = (encoding != BIN_ENC_RICE_DELTA);
+
+	hdr_len = bin_get_image_header(rec_header, lep_bufP, LEP_WIDTH, LEP_HEIGHT, encoding, img_len, 0);
+	telem_len = bin_get_image_telem_len(lep_bufP, 0);
+	len = hdr_len + img_len + telem_len;
+
+	// Leave room for the frame index
+	if ((rec_offset + len + REC_FRAME_INDEX_HEADER_LEN + (rec_records + 1)*REC_FRAME_INDEX_ENTRY_LEN) > rec_capacity) {
+		ESP_LOGI(TAG, "Record partition full");
+		return false;
+	}
+
+	// Write the header last so an interrupted write doesn't leave a partial record
+	tb = esp_timer_get_time();
+	if (!erase_to(rec_offset + len)) return false;
+	if ((esp_partition_write(rec_part, rec_offset + hdr_len, imgP, img_len) != ESP_OK) ||
+	    ((telem_len != 0) &&
+	     (esp_partition_write(rec_part, rec_offset + hdr_len + img_len, lep_bufP->lep_telemP, telem_len) != ESP_OK)) ||
+	    (esp_partition_write(rec_part, rec_offset, rec_header, hdr_len) != ESP_OK)) {
+		ESP_LOGE(TAG, "Record write failed");
+		return false;
+	}
+	perf_record(PERF_STAGE_REC_WRITE, tb);
+
+	if (key) {
+		add_index(rec_records, rec_offset);
+	}
+
+	// Update the delta image state and reference
+	if ((rec_info.encoding == BIN_ENC_RICE) && (rec_info.key_interval != 0)) {
+		rec_frames_since_key = key ? 0 : rec_frames_since_key + 1;
+		memcpy(sys_rec_ref_bufferP, lep_bufP->lep_bufferP, LEP_NUM_PIXELS*2);
+	}
+
+	rec_offset += len;
+	rec_records++;
+	set_progress();
+
+	if (rec_frame_num != 0) {
+		if (--rec_remaining_frames == 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+/**
+ * Erase flash blocks until the erased region extends past end so the recording is
+ * always followed by erased flash (and not an older recording)
+ */
+static bool erase_to(uint32_t end)
+{
+	while ((rec_erase_end <= end) && (rec_erase_end < rec_capacity)) {
+		if (esp_partition_erase_range(rec_part, rec_erase_end, REC_ERASE_BLOCK_LEN) != ESP_OK) {
+			ESP_LOGE(TAG, "Record partition erase failed");
+			return false;
+		}
+		rec_erase_end += REC_ERASE_BLOCK_LEN;
+	}
+
+	return true;
+}
+
+
+/**
+ * Add a keyframe to the index if there is still room.  Entries are spaced so the
+ * index covers the whole partition.
+ */
+static void add_index(uint32_t record, uint32_t offset)
+{
+	uint8_t buf[REC_INDEX_ENTRY_LEN];
+
+	if ((rec_index_num >= REC_INDEX_ENTRIES) || (offset < rec_index_next)) return;
+
+	(void) put_u32(put_u32(put_u32(buf, record), offset), 0);
+	if (esp_partition_write(rec_part, REC_INDEX_OFFSET + rec_index_num*REC_INDEX_ENTRY_LEN, buf, REC_INDEX_ENTRY_LEN) == ESP_OK) {
+		rec_index_num++;
+		rec_index_next = offset + rec_index_spacing;
+	}
+}
+
+
+/**
+ * Publish the recording progress
+ */
+static void set_progress()
+{
+	xSemaphoreTake(rec_mutex, portMAX_DELAY);
+	rec_info.length = rec_offset;
+	rec_info.records = rec_records;
+	xSemaphoreGive(rec_mutex);
+}
+
+
+/**
+ * Store and load values little-endian
+ */
+static uint8_t* put_u16(uint8_t* p, uint16_t v)
+{
+	*p++ = v & 0xFF;
+	*p++ = v >> 8;
+
+	return p;
+}
+
+
+static uint8_t* put_u32(uint8_t* p, uint32_t v)
+{
+	p = put_u16(p, v & 0xFFFF);
+	return put_u16(p, v >> 16);
+}
+
+
+static uint32_t get_u32(uint8_t* p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
@@ -0,0 +1,153 @@
+/*
+ * Record Task
+ *
+ * Implement the on-camera recorder.  Records lepton frames into the "record" flash
+ * partition so a recording can be made without streaming every frame over WiFi and
+ * downloaded later in chunks with the get_record command.
+ *
+ * A recording is an append-only container.  It starts with a header block (one flash
+ * sector) holding the recording parameters and an index of keyframe locations
+ * followed by records and, once the recording is closed, a frame index.  Each record
+ * is a binary image (see bin_utilities.h) exactly as sent to a client using the binary
+ * image format, including its BIN_TLV_TIMESTAMP.  The flash following the last record
+ * is erased so a reader stops at the first byte that isn't BIN_IMAGE_START.
+ *
+ * Header block (all multi-byte values little-endian)
+ *    0 -  3: REC_FILE_MAGIC ("tREC")
+ *    4     : REC_FILE_VERSION
+ *    5     : Image encoding (BIN_ENC_RAW or BIN_ENC_RICE, with BIN_ENC_RICE_DELTA
+ *            records between keyframes if the key interval is non-zero)
+ *    6 -  7: Header length (REC_HEADER_LEN, offset of the first record)
+ *    8 - 11: Key interval (records per keyframe, 0 = all keyframes)
+ *   12 - 15: Frame delay (mSec between recorded frames, 0 = every frame)
+ *   16 - 17: Index entry offset (REC_INDEX_OFFSET)
+ *   18 - 19: Number of index entries (REC_INDEX_ENTRIES)
+ *   20 - 31: Reserved (0)
+ *   32 - 39: Records length (bytes including the header block, offset of the frame
+ *            index)
+ *   40 - 43: Number of records
+ *   44 - 47: Frame index length (bytes, 0 if the recording has no frame index)
+ *   48 - 63: Reserved (0)
+ *   64 -   : Index entries: record number (4 bytes), record offset (8 bytes)
+ *
+ * Frame index (one entry per record)
+ *    0     : REC_FRAME_INDEX_START
+ *    1     : REC_FRAME_INDEX_VERSION
+ *    2 -  3: Header length (REC_FRAME_INDEX_HEADER_LEN)
+ *    4 -  7: Number of entries
+ *    8 -  9: Entry length (REC_FRAME_INDEX_ENTRY_LEN)
+ *   10 - 15: Reserved (0)
+ *   16 -   : Entries
+ *              0 -  7: Record offset
+ *              8 - 15: Timestamp (mSec since 1970, 0 if not known)
+ *             16 - 19: Record length
+ *             20     : Image encoding
+ *             21 - 23: Reserved (0)
+ *
+ * The records length, number of records and frame index length are erased while
+ * recording and written, after the frame index, when the recording is closed.  Index
+ * entries are written as keyframes are recorded, spaced through the partition, and
+ * unused entries are erased.  A record's binary image header is written after the
+ * rest of the record so a recording interrupted by a power loss can be closed at the
+ * next boot by walking the records following the last index entry.  A recording
+ * interrupted while its frame index was being written is closed without one.
+ *
+ * Copyright 2020-2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef REC_TASK_H
+#define REC_TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//
+// REC Task Constants
+//
+
+// Maximum time to block waiting for a notification
+#define REC_TASK_MAX_WAIT_MSEC 1000
+
+// Container
+#define REC_FILE_MAGIC     "tREC"
+#define REC_FILE_VERSION   2
+#define REC_HEADER_LEN     4096
+#define REC_INDEX_OFFSET   64
+#define REC_INDEX_ENTRY_LEN 12
+#define REC_INDEX_ENTRIES  ((REC_HEADER_LEN - REC_INDEX_OFFSET) / REC_INDEX_ENTRY_LEN)
+
+// Header offsets
+#define REC_HDR_ENCODING   5
+#define REC_HDR_LENGTH     32
+#define REC_HDR_RECORDS    40
+#define REC_HDR_FRAME_INDEX_LEN 44
+
+// Frame index
+#define REC_FRAME_INDEX_START      0x06
+#define REC_FRAME_INDEX_VERSION    1
+#define REC_FRAME_INDEX_HEADER_LEN 16
+#define REC_FRAME_INDEX_ENTRY_LEN  24
+
+// Flash is erased ahead of the records in blocks of this size (a multiple of the
+// flash sector size)
+#define REC_ERASE_BLOCK_LEN (64 * 1024)
+
+// Partition subtype (a custom data partition named "record" in partitions.csv)
+#define REC_PARTITION_SUBTYPE 0x40
+#define REC_PARTITION_NAME    "record"
+
+// Recorder states
+#define REC_STATE_NONE        0     // No record partition
+#define REC_STATE_IDLE        1
+#define REC_STATE_RECORDING   2
+
+// Record Task notifications
+#define REC_NOTIFY_LEP_FRAME_MASK  0x00000010
+#define REC_NOTIFY_START_MASK      0x00000020
+#define REC_NOTIFY_STOP_MASK       0x00000040
+
+
+
+//
+// REC Task typedefs
+//
+typedef struct {
+	int state;                   // REC_STATE_xxx
+	uint8_t encoding;            // BIN_ENC_RAW or BIN_ENC_RICE
+	uint32_t key_interval;
+	uint32_t length;             // Bytes recorded (including the header block and the
+	                             // frame index once closed)
+	uint32_t records;            // Frames recorded
+	uint32_t skipped;            // Frames not recorded because the flash was busy
+	uint32_t capacity;           // Partition size
+} rec_info_t;
+
+
+
+//
+// REC Task API
+//
+bool rec_init();
+void rec_task();
+void rec_start(int encoding, uint32_t delay_ms, uint32_t num_frames, uint32_t key_interval);
+void rec_stop();
+void rec_get_info(rec_info_t* info);
+uint32_t rec_read(uint32_t offset, uint8_t* buf, uint32_t len);
+
+#endif /* REC_TASK_H */
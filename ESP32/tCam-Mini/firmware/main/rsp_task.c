@@ -2,9 +2,41 @@
  * Response Task
  *
  * Implement the response transmission module under control of the command module.
- * Responsible for sending responses to the connected client.  Sources of responses
+ * Responsible for sending responses to the connected clients.  Sources of responses
  * include the command task, lepton task and file task.
  *
+ * Each lepton frame is encoded once per image format in use and the encoded image is
+ * shared by all clients using that format.  Json images share their metadata and are
+ * base64 encoded from the frame a chunk at a time as they are sent to each client so
+ * a full json record is never held in memory.  Clients are sent data from their own
+ * transmit queue using non-blocking sends so a slow client only reduces its own frame
+ * rate (it skips frames that arrive while it is still sending a previous image)
+ * instead of stalling the other clients.  The queued items are gathered into one
+ * sendmsg() so lwIP copies a whole socket buffer's worth of headers and image data
+ * straight from the shared buffers in one call into the network stack.
+ *
+ * Low latency streams send each segment of a frame as soon as lep_task has read it
+ * instead of waiting for the complete frame.  A client still sending a segment when the
+ * next one arrives skips the rest of that frame.  Raw (passthrough) streams send the
+ * VoSPI packets lep_task read, in batches, for a host to assemble into frames itself.
+ *
+ * Recording data requested with get_record is read from the recorder's flash partition
+ * into a per-client buffer and queued like a command response.  A history dump sends
+ * the records held in hist_task's ring one after another, straight from the ring.
+ *
+ * Clients connected to the HTTP endpoints use the same queues with each response, image,
+ * segment or recording data item preceded by a WebSocket frame header or an HTTP header.
+ *
+ * Streams may optionally be sent as UDP datagrams (unicast or multicast) instead of
+ * over the client's TCP connection.  Every datagram is sent immediately so a lost
+ * datagram costs the receiver one image instead of stalling the stream waiting for a
+ * retransmission.  UDP streams may instead be sent as RTP/JPEG packets of preview
+ * images for video management systems and players.
+ *
+ * Adaptive TCP streams watch how long each image takes to get through the client's
+ * socket and step down to compressed, binned or less frequent images when a slow
+ * link backs up, stepping back up when it recovers.
+ *
  * Copyright 2020-2021 Dan Julio
  *
  * This file is part of tCam.
@@ -25,30 +57,253 @@
  */
 #include "cmd_task.h"
 #include "ctrl_task.h"
+#include "enc_task.h"
+#include "hist_task.h"
 #include "lep_task.h"
+#include "rec_task.h"
 #include "rsp_task.h"
+#include "bin_utilities.h"
+#include "evlog_utilities.h"
+#include "frame_utilities.h"
+#include "http_utilities.h"
+#include "jpeg_codec.h"
 #include "json_utilities.h"
+#include "lepton_utilities.h"
+#include "palette_utilities.h"
+#include "perf_utilities.h"
+#include "pm_utilities.h"
+#include "png_codec.h"
+#include "rice_codec.h"
+#include "sparse_codec.h"
 #include "sys_utilities.h"
 #include "system_config.h"
+#include "time_utilities.h"
+#include "vospi.h"
+#include "wifi_utilities.h"
 #include "esp_system.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "lwip/err.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
 #include <lwip/netdb.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 //
 // RSP Task constants
 //
 
-// Uncomment to log various image processing timestamps
-//#define LOG_IMG_TIMESTAMP
-//#define LOG_PROC_TIMESTAMP
-//#define LOG_SEND_TIMESTAMP
+// Encoded image keys - clients sharing a key share the encoded image for a frame.
+// Delta images are relative to each client's reference so they are never shared.
+// PNG and JPEG images are shared by clients using the same palette and range.  The
+// AGC8 keys pack AGC output frames into 8-bit pixels (other frames are sent normally).
+// Sparse images use each client's threshold so they are never shared either.
+#define RSP_KEY_JSON     0
+#define RSP_KEY_BIN      1
+#define RSP_KEY_RICE     2
+#define RSP_KEY_DELTA    3     // + client index
+#define RSP_KEY_PNG      (RSP_KEY_DELTA + CMD_MAX_CLIENTS)
+#define RSP_KEY_JPEG     (RSP_KEY_PNG + 1)
+#define RSP_KEY_JSON8    (RSP_KEY_JPEG + 1)
+#define RSP_KEY_BIN8     (RSP_KEY_JSON8 + 1)
+#define RSP_KEY_SPARSE   (RSP_KEY_BIN8 + 1)     // + client index
+
+// Image histograms count pixels in RSP_HIST_FINE_BINS bins (exact values for image
+// ranges up to that) summed into the LEP_HIST_BINS bins sent and used for percentiles
+#define RSP_HIST_FINE_BINS 1024
+
+
+
+//
+// RSP Task typedefs
+//
+
+// Region of the frame (inclusive rows r1-r2, columns c1-c2) and the binning factor
+// used for binary images
+typedef struct {
+	uint8_t r1, c1, r2, c2;
+	uint8_t bin;                     // 1, 2 or 4
+} rsp_view_t;
+
+// An encoded image shared by the clients sending it
+typedef struct {
+	int refs;                        // Number of clients sending this image (0 = free)
+	int key;                         // RSP_KEY_xxx the image was encoded with
+	rsp_view_t view;                 // View of the frame the image was encoded with
+	uint8_t encoding;                // BIN_ENC_xxx (json images: raw or AGC8)
+	uint8_t telem_mask;              // LEP_TEL_FLD_xxx fields sent instead of the telemetry (0 = all)
+	bool hist;                       // Histogram included in the metadata
+	int preview_palette;             // Palette and range preview images were encoded with
+	uint16_t preview_lo;
+	uint16_t preview_hi;
+	uint16_t scale_lo;               // Raw values mapped to the first and last palette entry
+	uint16_t scale_hi;
+	uint16_t scale_res;              // Raw value * scale_res = K * 100 (0 = not radiometric)
+	uint32_t scan_offset;            // Offset of the JPEG scan in the image
+	int64_t sync_tick_usec;          // Synchronized stream tick the image is tagged with (0 = none)
+	uint32_t enc_usec;               // Time spent encoding (json images: the metadata)
+	lep_buffer_t* lep_bufP;          // Frame held while the image is sent, NULL otherwise
+	lep_buffer_t src;                // Binary image pixels (the frame or a reduced view of it)
+	uint16_t width;                  // Binary image dimensions
+	uint16_t height;
+	uint16_t* viewP;                 // Buffer for reduced views
+	json_image_string_t* encP;       // Buffer for json metadata or compressed images
+	char* imgP;                      // Image to send (json image metadata)
+	uint32_t img_len;
+	uint32_t hdr_len;                // Binary header length (0 for json images)
+	uint32_t telem_len;              // Binary telemetry length
+	uint8_t header[BIN_MAX_IMAGE_HEADER_LEN];
+} rsp_image_t;
+
+// A pending transmission
+typedef struct {
+	char* bufP;
+	uint32_t len;
+	bool img_end;                    // Set for the last part of an image
+	bool json_chunk;                 // Set for the client's json image chunks
+	bool seg_end;                    // Set for the last part of a segment
+	bool pkt_end;                    // Set for the last part of a raw packet batch
+	bool hist_end;                   // Set for a history record
+} rsp_tx_item_t;
+
+// Per-client state
+typedef struct {
+	bool connected;
+	int sock;
+	int transport;                   // RSP_TRANSPORT_xxx
+	int image_format;                // Image format for this connection
+	int lepton;                      // Lepton the client's images come from
+	bool agc8;                       // Pack AGC output frames into 8-bit pixels
+	uint8_t telem_mask;              // Telemetry fields sent with streamed images (0 = all)
+	bool hist;                       // Send each image's histogram in its metadata
+	int preview_palette;             // Preview (PNG and JPEG) images palette
+	uint16_t preview_lo;             // Preview images range (K * 100), hi = 0 for the image's range
+	uint16_t preview_hi;
+	uint16_t sparse_threshold;       // Sparse images send pixels at or above this raw value
+	rsp_view_t view;                 // Streamed binary image view
+	
+	// State
+	bool stream_on;
+	bool image_pending;
+	uint32_t avg_frames;             // Frames averaged into the pending image (0 = one frame)
+	uint32_t image_max_age_usec;     // Oldest frame the pending image may be (0 = the next frame)
+	
+	// Stream rate/duration control
+	uint32_t stream_frame_delay_usec;   // uSec between images; 0 = fast as possible
+	uint32_t stream_frame_num;          // Number of frames to stream; 0 = infinite
+	uint32_t stream_remaining_frames;   // Remaining frames to stream
+	uint32_t stream_key_interval;       // Frames per keyframe; 0 = delta images disabled
+	uint32_t stream_frames_since_key;   // Delta (or sparse) images sent since the last keyframe
+	bool stream_force_key;              // Set to send a keyframe next (resync)
+	int64_t stream_ready_usec;          // Next ESP32 uSec timestamp to send image
+	
+	// Low latency stream of frame segments
+	bool stream_seg;                    // Set to stream segments instead of images
+	uint32_t seg_frame_num;             // Frame being sent
+	int seg_next;                       // Next segment to send, 0 to wait for a new frame
+	
+	// Raw stream of VoSPI packet batches
+	bool stream_raw;                    // Set to stream raw packets instead of images
+	
+	// Latency probe (each image is followed by its latency record)
+	bool stream_probe;
+	
+	// Synchronized stream (images are the frames nearest each tick)
+	bool stream_sync;
+	int64_t sync_tick_usec;             // Tick of the last image selected (uSec since 1970)
+	
+	// Command priority (images wait while a command response is waiting or being sent)
+	bool stream_cmd_priority;
+	
+	// UDP stream transport
+	bool stream_udp;                    // Set to send streamed images as UDP datagrams
+	struct sockaddr_in udp_dest;
+	uint16_t udp_frame_num;
+	bool stream_rtp;                    // Set to send the UDP stream as RTP/JPEG packets
+	uint16_t rtp_seq;
+	uint32_t rtp_ssrc;
+	
+	// Change triggered stream (trig.threshold is 0 when disabled)
+	rsp_trigger_t trig;
+	bool trig_active;                   // Scene changing, images sent at the stream rate
+	bool trig_ref_valid;                // Set when trig_ref holds the last image sent
+	int64_t trig_change_usec;           // When the scene last changed
+	int64_t trig_sent_usec;             // When the last image was sent
+	uint16_t trig_ref[RSP_TRIG_NUM_BLOCKS];
+	
+	// Adaptive stream (adapt_target_usec is 0 when disabled)
+	uint32_t adapt_target_usec;         // Image latency target
+	int adapt_level;                    // Current level (0 = the stream as requested)
+	bool adapt_compress;                // Compress raw binary images
+	uint8_t adapt_bin;                  // Binary image binning factor (0 = the view's)
+	uint32_t adapt_delay_usec;          // Minimum uSec between images (0 = none)
+	uint32_t adapt_latency_usec;        // Smoothed image latency (0 = no image sent yet)
+	int adapt_images;                   // Images sent since the level changed
+	int64_t adapt_good_usec;            // Start of the images well under target (0 = none)
+	
+	// Transmit queue
+	rsp_image_t* imageP;             // Image being sent, NULL when none
+	int64_t image_queued_usec;       // When imageP was queued (for PERF_STAGE_SEND)
+	int64_t image_vsync_usec;        // Vsync of imageP's frame (for adaptive streams)
+	rsp_tx_item_t tx_items[RSP_MAX_TX_ITEMS];
+	int tx_num;
+	uint32_t tx_offset;              // Bytes of tx_items[0] already sent
+	int64_t tx_stall_usec;           // When sends stopped making progress (0 = they haven't)
+	bool tx_stalled;                 // Set once cmd_task has been told the client stalled
+	
+	// Segment being sent (NULL when none)
+	lep_segment_t* segP;
+	uint8_t seg_header[RSP_SEG_HEADER_LEN];
+	uint8_t seg_img_header[BIN_MAX_IMAGE_HEADER_LEN];
+	
+	// Raw packet batch being sent (NULL when none)
+	lep_pkt_batch_t* pktP;
+	uint8_t pkt_header[RSP_PKT_HEADER_LEN];
+	
+	// Json image chunks
+	char* json_bufP[2];              // Chunk buffers
+	uint32_t json_len[2];            // Length of the chunk in each buffer (0 = empty)
+	int json_cur;                    // Buffer being sent
+	uint32_t json_offset;            // Next byte of the frame to encode
+	uint32_t json_src_len;           // Bytes of pixel data (1 per pixel for AGC8 images)
+	uint8_t json_telem_mask;         // Telemetry fields in the metadata (0 = telemetry in the tail)
+	bool json_tail_done;             // Set when the end of the record has been encoded
+	int64_t json_enc_usec;           // Time spent encoding the image's chunks
+	
+	// Command Response buffer (holds single responses from the cmd_task)
+	bool rsp_busy;                   // Set while rsp_text is queued for transmission
+	int64_t rsp_queued_usec;         // Time cmd_task pushed the response in rsp_text
+	char rsp_text[JSON_MAX_RSP_TEXT_LEN];
+	
+	// WebSocket frame and HTTP headers for the queued items
+	uint8_t rsp_wrap[HTTP_MAX_HEADER_LEN];
+	uint8_t img_wrap[HTTP_MAX_HEADER_LEN];
+	uint8_t seg_wrap[WS_MAX_TX_HEADER_LEN];
+	uint8_t pkt_wrap[WS_MAX_TX_HEADER_LEN];
+	uint8_t rec_wrap[WS_MAX_TX_HEADER_LEN];
+	uint8_t hist_wrap[WS_MAX_TX_HEADER_LEN];
+	
+	// Recording or event log data (one get_record or get_log request is held while the
+	// previous one is sent)
+	bool rec_pending;
+	bool rec_busy;                   // Set while rec_bufP is queued for transmission
+	bool rec_log;                    // The pending request is for the event log
+	uint32_t rec_offset;
+	uint32_t rec_length;
+	uint8_t* rec_bufP;
+	
+	// History or burst dump (records hist_next up to hist_end held in hist_task's ring)
+	bool hist_on;
+	bool hist_busy;                  // Set while a record is queued for transmission
+	bool hist_burst;                 // The records are a burst (released with hist_end_burst())
+	uint32_t hist_next;
+	uint32_t hist_end;
+} rsp_client_t;
 
 
 
@@ -57,22 +312,58 @@
 //
 static const char* TAG = "rsp_task";
 
-// State
-static bool connected;
-static bool stream_on;
-static bool image_pending;
-static bool got_image_0, got_image_1;
+static rsp_client_t clients[CMD_MAX_CLIENTS];
+
+// Encoded images.  Each client sends at most one image at a time so there is never
+// a need for more than one per client.
+static rsp_image_t images[CMD_MAX_CLIENTS];
+
+// Lepton frame acquired from the frame broker for transmission from each Lepton
+// (NULL when none)
+static lep_buffer_t* cur_lep_bufP[LEP_NUM_LEPTONS];
+
+// Frame broker subscriber id and notification for each Lepton
+static int frame_sub[LEP_NUM_LEPTONS];
+static const uint32_t frame_notify_mask[] = {RSP_NOTIFY_LEP_FRAME_MASK, RSP_NOTIFY_LEP2_FRAME_MASK};
+
+// UDP stream socket (shared by all clients, created when first needed) and datagram
+static int udp_sock = -1;
+static uint8_t udp_pkt[RSP_UDP_HEADER_LEN + RSP_MAX_UDP_DATA_LEN];
+
+// Raw packet batch with its header for UDP streams (sent in one datagram)
+static uint8_t udp_raw_batch[RSP_PKT_HEADER_LEN + LEP_PKT_BATCH_PKTS*LEP_PKT_LENGTH];
 
-// Stream rate/duration control
-static uint32_t next_stream_frame_delay_msec;   // mSec between images; 0 = fast as possible
-static uint32_t cur_stream_frame_delay_usec;
-static uint32_t next_stream_frame_num;          // Number of frames to stream; 0 = infinite
-static uint32_t cur_stream_frame_num;
-static uint32_t stream_remaining_frames;        // Remaining frames to stream
-static int64_t stream_ready_usec;               // Next ESP32 uSec timestamp to send image
+// Vsync of the last frame and the interval between frames from each Lepton for
+// synchronized streams
+static int64_t sync_vsync_usec[LEP_NUM_LEPTONS];
+static int64_t sync_frame_usec[LEP_NUM_LEPTONS];
+
+// Histogram of the image being encoded and its fine bins
+static lep_hist_t img_hist;
+static uint16_t hist_fine[RSP_HIST_FINE_BINS];
+
+// Block means of the frame being dispatched for change triggered streams
+static uint16_t trig_blocks[RSP_TRIG_NUM_BLOCKS];
+
+// History dump response
+static char hist_text[JSON_MAX_RSP_TEXT_LEN];
+
+// Latency probe record
+static char probe_text[RSP_PROBE_TEXT_LEN];
+
+// Averaged image being summed for avg_client (-1 when none) and the image once its
+// avg_num frames have been summed
+static int avg_client;
+static uint32_t avg_num;
+static uint32_t avg_skipped;           // FFC frames skipped
+static lep_buffer_t avg_buf;
+
+// 8-bit pixels of the json image chunk being encoded
+static uint8_t agc8_chunk[RSP_JSON_CHUNK_SRC_LEN];
+
+// When the last frame from lep_task was ready (for timing background WiFi scans)
+static int64_t last_frame_usec;
 
-// Command Response buffer (holds single responses from the cmd_task)
-static char cmd_task_response_buffer[JSON_MAX_RSP_TEXT_LEN];
 
 
 
@@ -80,13 +371,84 @@ static char cmd_task_response_buffer[JSON_MAX_RSP_TEXT_LEN];
 // RSP Task Forward Declarations for internal functions
 //
 static void init_state();
-static void eval_stream_ready();
-static void handle_notifications();
-static int process_image(int n);
-static void send_response(char* rsp, int len);
-static bool cmd_response_available();
-static int get_cmd_response();
-static char pop_cmd_response_buffer();
+static void init_client(rsp_client_t* c);
+static void init_view(rsp_view_t* v);
+static void post_event(int client, int event, uint32_t arg);
+static void post_event_args(rsp_cmd_event_t* evt);
+static void handle_event(rsp_cmd_event_t* evt);
+static bool setup_udp_stream(rsp_client_t* c, uint16_t port, uint32_t addr);
+static void eval_stream_ready(rsp_client_t* c);
+static uint32_t get_frame_delay(rsp_client_t* c);
+static void reset_adapt(rsp_client_t* c);
+static int get_adapt_max_level(rsp_client_t* c);
+static bool adapt_can_bin(rsp_client_t* c, int bin);
+static void set_adapt_level(rsp_client_t* c, int level);
+static void update_adapt(rsp_client_t* c, int64_t latency_usec);
+static TickType_t get_wait_ticks();
+static bool tx_pending();
+static void wait_tx_ready(TickType_t wait_ticks);
+static void handle_notifications(TickType_t wait_ticks);
+static bool image_wanted(int lepton);
+static bool segments_wanted();
+static void dispatch_segment(lep_segment_t* segP);
+static void queue_segment(rsp_client_t* c, lep_segment_t* segP);
+static bool raw_wanted();
+static void dispatch_packets();
+static void queue_packets(rsp_client_t* c, lep_pkt_batch_t* batchP);
+static void dispatch_image(lep_buffer_t* lep_bufP, int client);
+static void dispatch_newest(int client);
+static void get_trigger_blocks(lep_buffer_t* lep_bufP);
+static bool trigger_wanted(rsp_client_t* c);
+static bool sync_wanted(rsp_client_t* c, lep_buffer_t* lep_bufP);
+static int64_t get_sync_tick(int client);
+static void trigger_sent(rsp_client_t* c);
+static void cancel_average(int client);
+static bool avg_buf_busy();
+static void accumulate_frame(lep_buffer_t* lep_bufP);
+static void finish_average(lep_buffer_t* lep_bufP);
+static rsp_image_t* get_free_image(rsp_image_t** frame_images, int num_frame_images);
+static int get_image_key(int client);
+static uint8_t get_telem_mask(int client);
+static void get_image_view(int client, rsp_view_t* v);
+static bool same_view(rsp_view_t* v1, rsp_view_t* v2);
+static bool same_preview(rsp_image_t* imgP, int client);
+static bool encode_image(rsp_image_t* imgP, lep_buffer_t* lep_bufP, int key, rsp_view_t* v, int client);
+static void get_image_hist(const uint16_t* pixelP, uint32_t n, uint16_t lo, uint16_t hi);
+static uint32_t encode_preview(rsp_image_t* imgP, int key, int client);
+static void reduce_frame(lep_buffer_t* lep_bufP, lep_buffer_t* dstP, rsp_view_t* v);
+static bool is_agc8_frame(lep_buffer_t* bufP);
+static void pack_agc8(const uint16_t* srcP, uint8_t* dstP, uint32_t n);
+static void queue_image(int client, rsp_image_t* imgP, lep_buffer_t* lep_bufP);
+static bool send_udp_image(rsp_client_t* c, rsp_image_t* imgP, lep_buffer_t* lep_bufP);
+static bool send_rtp_image(rsp_client_t* c, rsp_image_t* imgP);
+static bool send_udp_data(rsp_client_t* c, char* buf, uint32_t len, uint32_t* offset, int* index, int count);
+static uint8_t* put_u16(uint8_t* p, uint16_t v);
+static uint8_t* put_be16(uint8_t* p, uint16_t v);
+static void release_image(rsp_image_t* imgP);
+static void send_probe(rsp_client_t* c, rsp_image_t* imgP, int64_t queued_usec);
+static int process_image(json_image_string_t* encP, lep_buffer_t* lep_bufP, bool agc8, uint8_t telem_mask);
+static void start_json_chunks(rsp_client_t* c, rsp_image_t* imgP);
+static uint32_t encode_json_chunk(rsp_client_t* c, lep_buffer_t* lep_bufP, char* buf);
+static bool next_json_chunk(rsp_client_t* c, rsp_tx_item_t* itemP);
+static void prefetch_json_chunk(rsp_client_t* c);
+static void queue_response(rsp_client_t* c, int len);
+static void push_ws_header(rsp_client_t* c, uint8_t* buf, uint32_t len);
+static void push_tx(rsp_client_t* c, char* buf, uint32_t len, bool img_end);
+static void pop_tx(rsp_client_t* c);
+static void flush_tx(rsp_client_t* c);
+static void send_client_data(rsp_client_t* c);
+static bool cmd_response_available(int client);
+static int get_cmd_response(int client);
+static uint32_t copy_to_cmd_response_buffer(json_cmd_response_queue_t* q, uint32_t index, const void* src, uint32_t len);
+static uint32_t copy_from_cmd_response_buffer(json_cmd_response_queue_t* q, uint32_t index, void* dst, uint32_t len);
+static void flush_cmd_response_buffer(int client);
+static int get_record_data(rsp_client_t* c);
+static void start_history(int client);
+static void start_burst(int client);
+static void end_dump(rsp_client_t* c);
+static void queue_history(rsp_client_t* c);
+static void update_power_save();
+static bool scan_gap();
 
 
 
@@ -95,7 +457,8 @@ static char pop_cmd_response_buffer();
 //
 void rsp_task()
 {
-	int len;
+	int i, len;
+	rsp_client_t* c;
 	
 	ESP_LOGI(TAG, "Start task");
 	
@@ -104,310 +467,2997 @@ void rsp_task()
 	while (1) {
 		// Evaluate streaming conditions for ready to send image if enabled before
 		// handling notifications (of images from lep_task)
-		if (stream_on) {
-			eval_stream_ready();
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			if (clients[i].connected && clients[i].stream_on && !clients[i].stream_seg && !clients[i].stream_raw) {
+				eval_stream_ready(&clients[i]);
+			}
 		}
 		
-		// Process notifications from other tasks
-		handle_notifications();
+		// Block until notified by another task, a client can accept more data or it is
+		// time to evaluate streaming again (letting the CPUs slow down until then)
+		pm_release(PM_LOCK_RSP);
+		if (tx_pending()) {
+			wait_tx_ready(get_wait_ticks());
+			pm_hold(PM_LOCK_RSP);
+			handle_notifications(0);
+		} else {
+			handle_notifications(get_wait_ticks());
+			pm_hold(PM_LOCK_RSP);
+		}
 		
-		// Get our current connection state
-		if (cmd_connected()) {
-			connected = true;
-		} else if (connected) {
-			// Clear our state since we are no longer connected
-			init_state();
+		// Hand a new frame to the clients waiting for one from its Lepton
+		for (i=0; i<LEP_NUM_LEPTONS; i++) {
+			if (cur_lep_bufP[i] != NULL) {
+				last_frame_usec = cur_lep_bufP[i]->ready_usec;
+				accumulate_frame(cur_lep_bufP[i]);
+				dispatch_image(cur_lep_bufP[i], -1);
+				cur_lep_bufP[i] = NULL;
+			}
 		}
 		
-		// Look for things to send
-		if (got_image_0 || got_image_1) {
-			if (connected) {
-				if (got_image_0) {
-					len = process_image(0);
-					got_image_0 = false;
-#ifdef LOG_IMG_TIMESTAMP
-					ESP_LOGI(TAG, "process image 0");
-#endif
-				} else {
-					len = process_image(1);
-					got_image_1 = false;
-#ifdef LOG_IMG_TIMESTAMP
-					ESP_LOGI(TAG, "process image 1");
-#endif
-				}	
-					
-				// Send the image
-				if (len != 0) {
-					send_response(sys_image_rsp_buffer.bufferP, sys_image_rsp_buffer.length);
-				}
-				
-				// If streaming, determine if we have sent the required number of images if necessary
-				if (stream_on && (cur_stream_frame_num != 0)) {
-					if (--stream_remaining_frames == 0) {
-						stream_on = false;
-					}
-				}
+		// Answer get_image requests that accept a frame already captured
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			if (clients[i].image_max_age_usec != 0) {
+				dispatch_newest(i);
 			}
 		}
 		
-		if (cmd_response_available()) {
-			// Get the command response and send it if possible
-			len = get_cmd_response();
-			if (connected && (len != 0)) {
-				send_response(cmd_task_response_buffer, len);
+		// Hand the raw packet batches from lep_task to the raw streams
+		dispatch_packets();
+		
+		// Hand a completed average to its client
+		if ((avg_client >= 0) && (avg_num == clients[avg_client].avg_frames)) {
+			dispatch_image(&avg_buf, -1);
+			if (!clients[avg_client].image_pending) {
+				clients[avg_client].avg_frames = 0;
+				avg_client = -1;
 			}
 		}
 		
-		// Sleep task - less if we are streaming
-		if (stream_on) {
-			vTaskDelay(pdMS_TO_TICKS(RSP_TASK_EVAL_FAST_MSEC));
-		} else {
-			vTaskDelay(pdMS_TO_TICKS(RSP_TASK_EVAL_NORM_MSEC));
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			c = &clients[i];
+			if (!c->connected) continue;
+			
+			// Queue the next command response when the previous one has been sent
+			if (!c->rsp_busy && cmd_response_available(i)) {
+				len = get_cmd_response(i);
+				if (len != 0) {
+					queue_response(c, len);
+				}
+			}
+			
+			// Queue requested recording data when the previous data has been sent
+			if (!c->rec_busy && c->rec_pending) {
+				len = get_record_data(c);
+				c->rec_pending = false;
+				c->rec_busy = true;
+				push_ws_header(c, c->rec_wrap, len);
+				push_tx(c, (char*) c->rec_bufP, len, false);
+			}
+			
+			// Queue the next history record when the previous one has been sent
+			if (c->hist_on && !c->hist_busy) {
+				queue_history(c);
+			}
+			
+			// Send as much as the client will take and then encode its next json image
+			// chunk while the socket drains
+			send_client_data(c);
+			prefetch_json_chunk(c);
+		}
+		
+		update_power_save();
+		
+		// Scan another channel for a background WiFi scan while there's a gap in traffic
+		if (wifi_get_bg_scan_channel() != 0) {
+			wifi_bg_scan_service(scan_gap());
 		}
+		
+		// Have lep_task copy segments only while a low latency stream needs them
+		frame_seg_enable(segments_wanted());
+		frame_pkt_enable(raw_wanted());
 	} 
 }
 
 
-// Called before sending RSP_NOTIFY_CMD_STREAM_ON_MASK
-void rsp_set_stream_parameters(uint32_t delay_ms, uint32_t num_frames)
+// Called by cmd_task when a client connects (or for HTTP clients, once the request has
+// been accepted and any response header sent) with the transport it uses
+void rsp_client_connected(int client, int sock, int transport)
+{
+	rsp_cmd_event_t evt;
+	
+	evt.client = client;
+	evt.event = RSP_EVT_CONNECT;
+	evt.args[0] = (uint32_t) sock;
+	evt.args[1] = (uint32_t) transport;
+	post_event_args(&evt);
+}
+
+
+// Called by cmd_task when a client disconnects.  rsp_task closes the socket and
+// then calls cmd_client_closed() so the client slot can be reused.
+void rsp_client_disconnected(int client)
+{
+	post_event(client, RSP_EVT_DISCONNECT, 0);
+}
+
+
+// Called by cmd_task to send a client the next image or, when avg_frames is more than 1,
+// the average of the next avg_frames frames.  A non-zero max_age_ms sends the newest
+// frame already captured if it is no older than that instead of waiting for the next.
+void rsp_get_image(int client, uint32_t avg_frames, uint32_t max_age_ms)
+{
+	rsp_cmd_event_t evt;
+	
+	evt.client = client;
+	evt.event = RSP_EVT_GET_IMG;
+	evt.args[0] = avg_frames;
+	evt.args[1] = max_age_ms;
+	post_event_args(&evt);
+}
+
+
+// Called by cmd_task to start streaming to a client.  udp_port is 0 to stream over the
+// client's connection.  Otherwise images are sent to udp_addr (host byte order, 0 for
+// the client's address) at udp_port.  Binary images are cropped to roi (r1, c1, r2, c2)
+// and reduced by averaging bin x bin pixels.  segments selects a low latency stream of
+// frame segments instead of images and raw a stream of the VoSPI packets read from the
+// Lepton (see RSP_PKT_START).  rtp sends a UDP stream as RTP/JPEG packets.  trig
+// (NULL or a zero threshold for none) only sends images when the scene changes.
+// adapt_ms (0 for none) is the image latency target of an adaptive TCP stream.  probe
+// follows each image with its latency record.  sync sends the frames nearest each
+// multiple of delay_ms since 1970 (see RSP_SYNC_DEF_FRAME_USEC).  cmd_priority holds
+// images back while a command response is waiting to be sent.
+void rsp_stream_on(int client, uint32_t delay_ms, uint32_t num_frames, uint32_t key_interval, uint16_t udp_port, uint32_t udp_addr, uint16_t* roi, int bin, bool segments, bool raw, bool rtp, bool probe, bool sync, bool cmd_priority, const rsp_trigger_t* trig, uint32_t adapt_ms)
+{
+	rsp_cmd_event_t evt;
+	
+	evt.client = client;
+	evt.event = RSP_EVT_STREAM_ON;
+	evt.args[0] = delay_ms;
+	evt.args[1] = num_frames;
+	evt.args[2] = key_interval;
+	evt.args[3] = udp_port;
+	evt.args[4] = udp_addr;
+	evt.args[5] = (roi[3] << 24) | (roi[2] << 16) | (roi[1] << 8) | roi[0];
+	evt.args[6] = bin;
+	evt.args[7] = ((segments) ? 1 : 0) | ((rtp) ? 2 : 0) | ((probe) ? 4 : 0) | ((sync) ? 8 : 0) | ((cmd_priority) ? 16 : 0) | ((raw) ? 32 : 0);
+	post_event_args(&evt);
+	
+	// The trigger follows in its own event (handled before the next frame)
+	if ((trig != NULL) && (trig->threshold != 0) && !segments && !raw) {
+		evt.event = RSP_EVT_STREAM_TRIG;
+		evt.args[0] = trig->threshold;
+		evt.args[1] = trig->min_blocks;
+		evt.args[2] = trig->hold_ms;
+		evt.args[3] = trig->heartbeat_ms;
+		post_event_args(&evt);
+	}
+	
+	// As is the adaptive stream latency target (UDP streams don't see backpressure)
+	if ((adapt_ms != 0) && !segments && !raw && (udp_port == 0)) {
+		evt.event = RSP_EVT_STREAM_ADAPT;
+		evt.args[0] = adapt_ms;
+		post_event_args(&evt);
+	}
+}
+
+
+// Called by cmd_task to stop streaming to a client
+void rsp_stream_off(int client)
+{
+	post_event(client, RSP_EVT_STREAM_OFF, 0);
+}
+
+
+// Called by cmd_task when a client lost its delta image reference
+void rsp_stream_resync(int client)
+{
+	post_event(client, RSP_EVT_STREAM_RESYNC, 0);
+}
+
+
+// Called by cmd_task to select the image format for a client.  palette, lo and hi are
+// used by PNG and JPEG images (hi = 0 to scale each image to its own range).  agc8 packs
+// json and raw binary images of AGC output frames into 8-bit pixels.  A non-zero
+// telem_mask sends only those telemetry fields (LEP_TEL_FLD_xxx) with streamed images.
+// hist adds each image's histogram and percentiles to its metadata.  Sparse images
+// only send pixels at or above threshold (raw value).
+void rsp_set_image_format(int client, int format, int palette, uint16_t lo, uint16_t hi, bool agc8, uint8_t telem_mask, bool hist, uint16_t threshold)
+{
+	rsp_cmd_event_t evt;
+	
+	evt.client = client;
+	evt.event = RSP_EVT_SET_IMG_FMT;
+	evt.args[0] = format;
+	evt.args[1] = palette;
+	evt.args[2] = (hi << 16) | lo;
+	evt.args[3] = (agc8) ? 1 : 0;
+	evt.args[4] = telem_mask;
+	evt.args[5] = (hist) ? 1 : 0;
+	evt.args[6] = threshold;
+	post_event_args(&evt);
+}
+
+
+// Called by cmd_task or ana_task to send a client the frames in the history ring
+void rsp_dump_history(int client)
+{
+	post_event(client, RSP_EVT_DUMP_HIST, 0);
+}
+
+
+// Called by hist_task to send a client the burst it captured
+void rsp_dump_burst(int client)
+{
+	post_event(client, RSP_EVT_DUMP_BURST, 0);
+}
+
+
+// Called by cmd_task to select the Lepton (0 - LEP_NUM_LEPTONS-1) a client's images
+// and streams come from
+void rsp_set_lepton(int client, int lepton)
+{
+	post_event(client, RSP_EVT_SET_LEPTON, lepton);
+}
+
+
+// Called by cmd_task to send a client part of the recording
+void rsp_get_record(int client, uint32_t offset, uint32_t length)
+{
+	rsp_cmd_event_t evt;
+	
+	evt.client = client;
+	evt.event = RSP_EVT_GET_RECORD;
+	evt.args[0] = offset;
+	evt.args[1] = length;
+	post_event_args(&evt);
+}
+
+
+// Called by cmd_task to request part of the event log.  Shares the recording data
+// buffer so it replaces a get_record request that hasn't been started.
+void rsp_get_log(int client, uint32_t offset, uint32_t length)
+{
+	rsp_cmd_event_t evt;
+	
+	evt.client = client;
+	evt.event = RSP_EVT_GET_LOG;
+	evt.args[0] = offset;
+	evt.args[1] = length;
+	post_event_args(&evt);
+}
+
+
+// Called by cmd_task and ana_task to push a delimited json string into a client's
+// command response buffer if there is room, otherwise it is just dropped (up to the
+// external host to make sure this doesn't happen, dropped responses are counted)
+void rsp_push_response(int client, char* buf, uint32_t len)
+{
+	bool dropped;
+	int64_t push_usec = esp_timer_get_time();
+	uint16_t rsp_len = (uint16_t) len;
+	uint32_t index;
+	json_cmd_response_queue_t* q = &sys_cmd_response_buffer[client];
+	
+	if ((len == 0) || (len > JSON_MAX_RSP_TEXT_LEN)) return;
+	
+	// Atomically load the response, preceded by its length and the time it was pushed,
+	// if there's room for it
+	xSemaphoreTake(q->mutex, portMAX_DELAY);
+	dropped = ((len + sizeof(rsp_len) + sizeof(push_usec)) > (CMD_RESPONSE_BUFFER_LEN - q->length));
+	if (!dropped) {
+		index = copy_to_cmd_response_buffer(q, q->push_index, &rsp_len, sizeof(rsp_len));
+		index = copy_to_cmd_response_buffer(q, index, &push_usec, sizeof(push_usec));
+		q->push_index = copy_to_cmd_response_buffer(q, index, buf, len);
+		q->length += len + sizeof(rsp_len) + sizeof(push_usec);
+	}
+	xSemaphoreGive(q->mutex);
+	
+	if (dropped) {
+		perf_count(PERF_CNT_RSP_DROP);
+		return;
+	}
+	
+	// Let rsp_task know there's something to send
+	xTaskNotify(task_handle_rsp, RSP_NOTIFY_CMD_RESPONSE_MASK, eSetBits);
+}
+
+
+// Called by cmd_task to get a client's adaptive stream state for get_status.  The
+// fields are only written by rsp_task so a snapshot that straddles an update just
+// mixes two consecutive states.
+void rsp_get_adapt_status(int client, rsp_adapt_status_t* s)
+{
+	rsp_client_t* c = &clients[client];
+	
+	if (!c->stream_on || (c->adapt_target_usec == 0)) {
+		s->target_ms = 0;
+		return;
+	}
+	
+	s->target_ms = c->adapt_target_usec / 1000;
+	s->latency_ms = c->adapt_latency_usec / 1000;
+	s->level = c->adapt_level;
+	s->max_level = get_adapt_max_level(c);
+	s->compress = c->adapt_compress;
+	s->bin = (c->adapt_bin > c->view.bin) ? c->adapt_bin : c->view.bin;
+	s->delay_ms = get_frame_delay(c) / 1000;
+}
+
+
+// Called by cmd_task to get a client's queue depths for status metrics.  Like
+// rsp_get_adapt_status() the values are read without locking.
+void rsp_get_queue_status(int client, rsp_queue_status_t* s)
 {
-	next_stream_frame_delay_msec = delay_ms;
-	next_stream_frame_num = num_frames;
+	s->tx_items = clients[client].tx_num;
+	s->rsp_bytes = sys_cmd_response_buffer[client].length;
 }
 
 
+
 //
 // Internal functions
 //
 
 /**
- * (Re)Initialize
+ * Initialize
  */
 static void init_state()
 {
-	connected = false;
-	stream_on = false;
-	next_stream_frame_delay_msec = 0;
-	next_stream_frame_num = 0;
-	image_pending = false;
-	got_image_0 = false;
-	got_image_1 = false;
+	int i;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		images[i].refs = 0;
+		images[i].lep_bufP = NULL;
+		images[i].encP = &sys_image_rsp_buffer[i];
+		images[i].viewP = sys_rsp_view_bufferP[i];
+		
+		clients[i].rec_bufP = sys_rsp_rec_bufferP[i];
+		clients[i].json_bufP[0] = sys_rsp_json_bufferP[i][0];
+		clients[i].json_bufP[1] = sys_rsp_json_bufferP[i][1];
+		clients[i].json_len[0] = 0;
+		clients[i].json_len[1] = 0;
+		clients[i].tx_num = 0;
+		clients[i].imageP = NULL;
+		clients[i].segP = NULL;
+		clients[i].pktP = NULL;
+		init_client(&clients[i]);
+	}
+	
+	avg_client = -1;
+	avg_buf.lep_bufferP = sys_rsp_avg_bufferP;
+	avg_buf.lep_telemP = sys_rsp_avg_telemP;
 	
-	// Flush the command response buffer
-	xSemaphoreTake(sys_cmd_response_buffer.mutex, portMAX_DELAY);
-	sys_cmd_response_buffer.length = 0;
-	sys_cmd_response_buffer.popP = sys_cmd_response_buffer.pushP;
-	xSemaphoreGive(sys_cmd_response_buffer.mutex);
+	for (i=0; i<LEP_NUM_LEPTONS; i++) {
+		cur_lep_bufP[i] = NULL;
+		sync_vsync_usec[i] = 0;
+		sync_frame_usec[i] = RSP_SYNC_DEF_FRAME_USEC;
+		frame_sub[i] = frame_subscribe_lepton(xTaskGetCurrentTaskHandle(), frame_notify_mask[i], i);
+	}
+	frame_seg_subscribe(xTaskGetCurrentTaskHandle(), RSP_NOTIFY_LEP_SEGMENT_MASK);
+	frame_pkt_subscribe(xTaskGetCurrentTaskHandle(), RSP_NOTIFY_LEP_PACKETS_MASK);
 }
 
 
 /**
- * Evaluate stream rate/duration variables to see if it's time to send an image.
- * Assumes stream_on set.
+ * (Re)Initialize a client.  Assumes the client's transmit queue is empty.
  */
-static void eval_stream_ready()
+static void init_client(rsp_client_t* c)
 {
-	// Determine if we are ready to send the next available image
-	if (cur_stream_frame_delay_usec == 0) {
-		image_pending = true;
-	} else {
-		if (esp_timer_get_time() >= stream_ready_usec) {
-			image_pending = true;
-			stream_ready_usec = stream_ready_usec + cur_stream_frame_delay_usec;
-		}
-	}
+	c->connected = false;
+	c->sock = -1;
+	c->transport = RSP_TRANSPORT_SOCKET;
+	c->image_format = RSP_IMG_FMT_JSON;
+	c->agc8 = false;
+	c->telem_mask = 0;
+	c->hist = false;
+	c->preview_palette = PALETTE_DEFAULT;
+	c->preview_lo = 0;
+	c->preview_hi = 0;
+	c->sparse_threshold = 0;
+	c->lepton = 0;
+	init_view(&c->view);
+	c->stream_on = false;
+	c->image_pending = false;
+	c->avg_frames = 0;
+	c->image_max_age_usec = 0;
+	c->stream_key_interval = 0;
+	c->stream_seg = false;
+	c->stream_raw = false;
+	c->stream_probe = false;
+	c->stream_sync = false;
+	c->stream_cmd_priority = false;
+	c->stream_udp = false;
+	c->udp_frame_num = 0;
+	c->stream_rtp = false;
+	c->trig.threshold = 0;
+	reset_adapt(c);
+	c->tx_offset = 0;
+	c->tx_stall_usec = 0;
+	c->tx_stalled = false;
+	c->rsp_busy = false;
+	c->rec_pending = false;
+	c->rec_busy = false;
+	c->hist_on = false;
+	c->hist_busy = false;
+	c->hist_burst = false;
 }
 
 
 /**
- * Handle incoming notifications
+ * Set a view for full resolution images of the entire frame
  */
-static void handle_notifications()
+static void init_view(rsp_view_t* v)
 {
-	uint32_t notification_value;
+	v->r1 = 0;
+	v->c1 = 0;
+	v->r2 = LEP_HEIGHT - 1;
+	v->c2 = LEP_WIDTH - 1;
+	v->bin = 1;
+}
+
+
+/**
+ * Queue an event with a single argument for rsp_task
+ */
+static void post_event(int client, int event, uint32_t arg)
+{
+	rsp_cmd_event_t evt;
 	
-	notification_value = 0;
-	if (xTaskNotifyWait(0x00, 0xFFFFFFFF, &notification_value, 0)) {
-		// Handle cmd_task notifications
-		if (Notification(notification_value, RSP_NOTIFY_CMD_GET_IMG_MASK)) {
-			// Note to process the next received image
-			image_pending = true;
+	evt.client = client;
+	evt.event = event;
+	evt.args[0] = arg;
+	post_event_args(&evt);
+}
+
+
+/**
+ * Queue an event for rsp_task
+ */
+static void post_event_args(rsp_cmd_event_t* evt)
+{
+	xQueueSend(sys_rsp_event_queue, evt, portMAX_DELAY);
+	xTaskNotify(task_handle_rsp, RSP_NOTIFY_CMD_EVENT_MASK, eSetBits);
+}
+
+
+/**
+ * Handle an event from cmd_task
+ */
+static void handle_event(rsp_cmd_event_t* evt)
+{
+	rsp_client_t* c;
+	
+	if ((evt->client < 0) || (evt->client >= CMD_MAX_CLIENTS)) return;
+	c = &clients[evt->client];
+	
+	if (evt->event == RSP_EVT_CONNECT) {
+		init_client(c);
+		c->sock = (int) evt->args[0];
+		c->transport = (int) evt->args[1];
+		c->connected = true;
+		
+		// WebSocket clients can't receive json images (they aren't encoded in one piece)
+		if (c->transport == RSP_TRANSPORT_WS) {
+			c->image_format = RSP_IMG_FMT_BIN;
+		}
+		return;
+	}
+	
+	if (!c->connected) {
+		// A burst for a client that has gone can't be sent
+		if (evt->event == RSP_EVT_DUMP_BURST) {
+			hist_end_burst();
+		}
+		return;
+	}
+	
+	switch (evt->event) {
+		case RSP_EVT_DISCONNECT:
+			// Drop anything we were sending and let cmd_task reuse the client
+			flush_tx(c);
+			cancel_average(evt->client);
+			if (c->hist_on) {
+				end_dump(c);
+			}
+			ESP_LOGI(TAG, "Closing client %d socket", evt->client);
+			close(c->sock);
+			init_client(c);
+			flush_cmd_response_buffer(evt->client);
+			cmd_client_closed(evt->client);
+			break;
+			
+		case RSP_EVT_GET_IMG:
+			// Note to process the next received image (a new request restarts an average)
+			cancel_average(evt->client);
+			c->image_pending = true;
+			c->avg_frames = (evt->args[0] > 1) ? evt->args[0] : 0;
+#ifdef CONFIG_TCAM_NO_PSRAM
+			// The low memory build has no averaging buffers
+			c->avg_frames = 0;
+#endif
+			c->image_max_age_usec = (c->avg_frames == 0) ? evt->args[1] * 1000 : 0;
 			
 			// Stop any on-going streaming
-			stream_on = false;
-		}
+			c->stream_on = false;
+			c->stream_key_interval = 0;
+			c->stream_seg = false;
+			c->stream_raw = false;
+			c->stream_probe = false;
+			c->stream_sync = false;
+			c->stream_udp = false;
+			c->stream_rtp = false;
+			c->trig.threshold = 0;
+			reset_adapt(c);
+			init_view(&c->view);
+			break;
 		
-		if (Notification(notification_value, RSP_NOTIFY_CMD_STREAM_ON_MASK)) {
+		case RSP_EVT_STREAM_ON:
 			// Setup streaming
-			cur_stream_frame_delay_usec = next_stream_frame_delay_msec * 1000;
-			cur_stream_frame_num = next_stream_frame_num;
-			stream_remaining_frames = next_stream_frame_num;
+			cancel_average(evt->client);
+			c->stream_frame_delay_usec = evt->args[0] * 1000;
+			c->stream_frame_num = evt->args[1];
+			c->stream_remaining_frames = evt->args[1];
+			c->stream_key_interval = evt->args[2];
+			c->stream_force_key = true;
+			c->view.r1 = evt->args[5] & 0xFF;
+			c->view.c1 = (evt->args[5] >> 8) & 0xFF;
+			c->view.r2 = (evt->args[5] >> 16) & 0xFF;
+			c->view.c2 = evt->args[5] >> 24;
+			c->view.bin = (uint8_t) evt->args[6];
+			c->stream_seg = ((evt->args[7] & 1) != 0);
+			c->stream_raw = ((evt->args[7] & 32) != 0);
+			c->stream_probe = ((evt->args[7] & 4) != 0);
+			c->stream_sync = ((evt->args[7] & 8) != 0);
+			c->stream_cmd_priority = ((evt->args[7] & 16) != 0);
+			c->sync_tick_usec = 0;
+			c->stream_udp = false;
+			c->stream_rtp = false;
+			c->trig.threshold = 0;
+			reset_adapt(c);
+			if (evt->args[3] != 0) {
+				if (!setup_udp_stream(c, (uint16_t) evt->args[3], evt->args[4])) {
+					c->stream_on = false;
+					break;
+				}
+				
+				// RTP streams are images only and start a new RTP session
+				if ((evt->args[7] & 2) != 0) {
+					c->stream_rtp = true;
+					c->stream_seg = false;
+					c->stream_raw = false;
+					c->rtp_seq = (uint16_t) esp_random();
+					c->rtp_ssrc = esp_random();
+				}
+			}
+			
+			// Segment streams send every segment from the start of the next frame and raw
+			// streams every packet batch from the next one (instead of segments)
+			if (c->stream_raw) {
+				c->stream_seg = false;
+			}
+			if (c->stream_seg || c->stream_raw) {
+				c->stream_frame_delay_usec = 0;
+				c->stream_key_interval = 0;
+				c->seg_next = 0;
+			}
 			
 			// First image is immediate
-			stream_ready_usec = esp_timer_get_time();
-			image_pending = true;
+			c->stream_ready_usec = esp_timer_get_time();
+			c->image_pending = !c->stream_seg && !c->stream_raw;
 			
 			// Start streaming
-			stream_on = true;
-		}
+			c->stream_on = true;
+			break;
+		
+		case RSP_EVT_STREAM_TRIG:
+			// Only send images when the scene changes (the first image is always sent)
+			if (c->stream_on && !c->stream_seg && !c->stream_raw) {
+				c->trig.threshold = (uint16_t) evt->args[0];
+				c->trig.min_blocks = (uint16_t) evt->args[1];
+				c->trig.hold_ms = evt->args[2];
+				c->trig.heartbeat_ms = evt->args[3];
+				c->trig_active = false;
+				c->trig_ref_valid = false;
+			}
+			break;
+		
+		case RSP_EVT_STREAM_ADAPT:
+			// Start at the stream as requested
+			if (c->stream_on && !c->stream_seg && !c->stream_raw && !c->stream_udp) {
+				c->adapt_target_usec = evt->args[0] * 1000;
+				c->adapt_latency_usec = 0;
+				set_adapt_level(c, 0);
+			}
+			break;
 		
-		if (Notification(notification_value, RSP_NOTIFY_CMD_STREAM_OFF_MASK)) {
+		case RSP_EVT_STREAM_OFF:
 			// Stop streaming
-			stream_on = false;
-		}
+			c->stream_on = false;
+			c->stream_key_interval = 0;
+			c->stream_seg = false;
+			c->stream_raw = false;
+			c->stream_probe = false;
+			c->stream_sync = false;
+			c->stream_udp = false;
+			c->stream_rtp = false;
+			c->trig.threshold = 0;
+			reset_adapt(c);
+			init_view(&c->view);
+			break;
+		
+		case RSP_EVT_STREAM_RESYNC:
+			// Host lost its delta image reference
+			c->stream_force_key = true;
+			break;
 		
-		// Handle lep_task notifications
-		if (Notification(notification_value, RSP_NOTIFY_LEP_FRAME_MASK_0)) {
-			if (image_pending) {
-				got_image_0 = true;
-				image_pending = false;
+		case RSP_EVT_SET_IMG_FMT:
+			c->image_format = (int) evt->args[0];
+			c->preview_palette = (int) evt->args[1];
+			c->preview_lo = evt->args[2] & 0xFFFF;
+			c->preview_hi = evt->args[2] >> 16;
+			c->agc8 = (evt->args[3] != 0);
+			c->telem_mask = (uint8_t) evt->args[4];
+			c->hist = (evt->args[5] != 0);
+			c->sparse_threshold = (uint16_t) evt->args[6];
+#ifdef CONFIG_TCAM_NO_PSRAM
+			// The low memory build only has the buffers to send json and raw binary images
+			if (c->image_format != RSP_IMG_FMT_JSON) {
+				c->image_format = RSP_IMG_FMT_BIN;
 			}
-		}
-		if (Notification(notification_value, RSP_NOTIFY_LEP_FRAME_MASK_1)) {
-			if (image_pending) {
-				got_image_1 = true;
-				image_pending = false;
+#endif
+			
+			// The delta image reference is also the PNG encoder's work buffer
+			c->stream_force_key = true;
+			
+			// Adaptive stream levels depend on the format
+			if (c->adapt_target_usec != 0) {
+				set_adapt_level(c, c->adapt_level);
 			}
-		}
+			break;
+		
+		case RSP_EVT_GET_RECORD:
+		case RSP_EVT_GET_LOG:
+			// A new request replaces one that hasn't been started
+			c->rec_offset = evt->args[0];
+			c->rec_length = evt->args[1];
+			c->rec_log = (evt->event == RSP_EVT_GET_LOG);
+			c->rec_pending = true;
+			break;
+		
+		case RSP_EVT_DUMP_HIST:
+			// A dump already being sent includes the event that asked for another
+			if (!c->hist_on) {
+				start_history(evt->client);
+			}
+			break;
+		
+		case RSP_EVT_DUMP_BURST:
+			start_burst(evt->client);
+			break;
+		
+		case RSP_EVT_SET_LEPTON:
+			// An average being summed from the other Lepton is restarted and the next
+			// streamed image is a keyframe
+			if (c->lepton != (int) evt->args[0]) {
+				cancel_average(evt->client);
+				c->lepton = (int) evt->args[0];
+				c->stream_force_key = true;
+				c->trig_ref_valid = false;
+			}
+			break;
 	}
 }
 
 
 /**
- * Convert lepton data in the specified half of the ping-pong buffer into a json record
- * with delimitors for transmission over the network
+ * Setup a client to stream to a UDP destination.  addr is in host byte order and may
+ * be a multicast group.  A zero addr sends to the client's own address.
  */
-static int process_image(int n)
+static bool setup_udp_stream(rsp_client_t* c, uint16_t port, uint32_t addr)
 {
-#ifdef LOG_PROC_TIMESTAMP
-	int64_t tb, te;
+	socklen_t addr_len;
 	
-	tb = esp_timer_get_time();
-#endif
+	if (udp_sock < 0) {
+		udp_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (udp_sock < 0) {
+			ESP_LOGE(TAG, "Unable to create UDP socket: errno %d", errno);
+			return false;
+		}
+	}
 	
-	// Convert the image into a json record
-	xSemaphoreTake(rsp_lep_buffer[n].lep_mutex, portMAX_DELAY);
-    sys_image_rsp_buffer.length = json_get_image_file_string(sys_image_rsp_buffer.bufferP+1, &rsp_lep_buffer[n]);
-    xSemaphoreGive(rsp_lep_buffer[n].lep_mutex);
-    
-    if ((sys_image_rsp_buffer.length > 0) && (sys_image_rsp_buffer.length < JSON_MAX_IMAGE_TEXT_LEN-2)) {
-        // Add the delimitors
-        *sys_image_rsp_buffer.bufferP = CMD_JSON_STRING_START;
-        *(sys_image_rsp_buffer.bufferP + sys_image_rsp_buffer.length + 1) = CMD_JSON_STRING_STOP;
-        sys_image_rsp_buffer.length = sys_image_rsp_buffer.length + 2;
-    } else {
-        ESP_LOGE(TAG, "Illegal image_json_text for sys_image_rsp_buffer (%d bytes)", sys_image_rsp_buffer.length);
-        sys_image_rsp_buffer.length = 0;
+	if (addr == 0) {
+		addr_len = sizeof(c->udp_dest);
+		if (getpeername(c->sock, (struct sockaddr *) &c->udp_dest, &addr_len) != 0) {
+			ESP_LOGE(TAG, "Unable to get client address: errno %d", errno);
+			return false;
+		}
+	} else {
+		memset(&c->udp_dest, 0, sizeof(c->udp_dest));
+		c->udp_dest.sin_family = AF_INET;
+		c->udp_dest.sin_addr.s_addr = htonl(addr);
 	}
+	c->udp_dest.sin_port = htons(port);
+	c->stream_udp = true;
 	
-#ifdef LOG_PROC_TIMESTAMP
-	te = esp_timer_get_time();
-	ESP_LOGI(TAG, "process_image took %d uSec", (int) (te - tb));
-#endif
-
-	return sys_image_rsp_buffer.length;
+	return true;
 }
 
 
 /**
- * Send a response
+ * Evaluate stream rate/duration variables to see if it's time to send a client an
+ * image.  Assumes stream_on set.
  */
-static void send_response(char* rsp, int rsp_length)
+static void eval_stream_ready(rsp_client_t* c)
 {
-	int byte_offset;
-	int err;
-	int len;
-	int sock;
-#ifdef LOG_SEND_TIMESTAMP
-	int64_t tb, te;
-	
-	tb = esp_timer_get_time();
-#endif
-	
-	sock = cmd_get_socket();
-	
-	// Write our response to the socket
-    byte_offset = 0;
-	while (byte_offset < rsp_length) {
-		len = rsp_length - byte_offset;
-		if (len > RSP_MAX_TX_PKT_LEN) len = RSP_MAX_TX_PKT_LEN;
-		err = send(sock, rsp + byte_offset, len, 0);
-		if (err < 0) {
-			ESP_LOGE(TAG, "Error in socket send: errno %d", errno);
-			break;
+	// Determine if we are ready to send the next available image (change triggered
+	// and synchronized streams look at every frame and decide as it is dispatched)
+	if ((get_frame_delay(c) == 0) || (c->trig.threshold != 0) || c->stream_sync) {
+		c->image_pending = true;
+	} else {
+		if (esp_timer_get_time() >= c->stream_ready_usec) {
+			c->image_pending = true;
+			c->stream_ready_usec = c->stream_ready_usec + get_frame_delay(c);
 		}
-		byte_offset += err;
 	}
-	
-#ifdef LOG_SEND_TIMESTAMP
-	te = esp_timer_get_time();
-	ESP_LOGI(TAG, "send_response took %d uSec", (int) (te - tb));
-#endif
 }
 
 
 /**
- * Atomically check if there is a response from cmd_task to transmit and load our global
- * cmd_response_length variable with its length
+ * Get the uSec between a client's images: the requested delay or the adaptive stream
+ * level's minimum if that is longer
  */
-static bool cmd_response_available()
+static uint32_t get_frame_delay(rsp_client_t* c)
 {
-	int len;
-	
-	xSemaphoreTake(sys_cmd_response_buffer.mutex, portMAX_DELAY);
-	len = sys_cmd_response_buffer.length;
-	xSemaphoreGive(sys_cmd_response_buffer.mutex);
-	
-	return (len != 0);
+	return (c->adapt_delay_usec > c->stream_frame_delay_usec) ? c->adapt_delay_usec : c->stream_frame_delay_usec;
 }
 
 
 /**
- * Load our cmd_task_response_buffer w and atomically update the command response buffer
- * indicating we popped a response
+ * Disable a client's adaptive stream
  */
-static int get_cmd_response()
+static void reset_adapt(rsp_client_t* c)
 {
-	char c;
-	int len = 0;
-	
-	// Pop an entire delimited json string
-	do {
-		c = pop_cmd_response_buffer();
-		cmd_task_response_buffer[len++] = c;
-	} while ((c != CMD_JSON_STRING_STOP) && (len <= JSON_MAX_RSP_TEXT_LEN));
-	
-	// Atomically update cmd_task_response_buffer
-	xSemaphoreTake(sys_cmd_response_buffer.mutex, portMAX_DELAY);
-	if (len > JSON_MAX_RSP_TEXT_LEN) {
-		// Didn't find complete json string so flush the queue
-		sys_cmd_response_buffer.length = 0;
-		sys_cmd_response_buffer.popP = sys_cmd_response_buffer.pushP;
-		len = 0;
-	} else {
-		// Subtract the length of the data we popped
-		sys_cmd_response_buffer.length = sys_cmd_response_buffer.length - len;
+	c->adapt_target_usec = 0;
+	c->adapt_level = 0;
+	c->adapt_compress = false;
+	c->adapt_bin = 0;
+	c->adapt_delay_usec = 0;
+	c->adapt_latency_usec = 0;
+}
+
+
+/**
+ * Get the number of adaptive stream levels below the requested stream for a client's
+ * image format and view
+ */
+static int get_adapt_max_level(rsp_client_t* c)
+{
+	int bin;
+	int n = RSP_ADAPT_RATE_STEPS;
+	
+	if (c->image_format == RSP_IMG_FMT_BIN) n++;
+	for (bin = c->view.bin * 2; adapt_can_bin(c, bin); bin *= 2) n++;
+	
+	return n;
+}
+
+
+/**
+ * True if a client's binary images can be binned by bin
+ */
+static bool adapt_can_bin(rsp_client_t* c, int bin)
+{
+	if ((c->image_format != RSP_IMG_FMT_BIN) && (c->image_format != RSP_IMG_FMT_BIN_RICE)) return false;
+	
+	return ((bin <= 4) && ((c->view.r2 - c->view.r1 + 1) >= bin) && ((c->view.c2 - c->view.c1 + 1) >= bin));
+}
+
+
+/**
+ * Set a client's adaptive stream level.  Each level below the requested stream takes
+ * the next step that applies to its format: compression, binning and then the delay
+ * between images.
+ */
+static void set_adapt_level(rsp_client_t* c, int level)
+{
+	int n;
+	uint8_t prev_bin = c->adapt_bin;
+	
+	if (level > get_adapt_max_level(c)) level = get_adapt_max_level(c);
+	if (level < 0) level = 0;
+	c->adapt_level = level;
+	
+	n = level;
+	c->adapt_compress = (n > 0) && (c->image_format == RSP_IMG_FMT_BIN);
+	if (c->adapt_compress) n--;
+	
+	c->adapt_bin = 0;
+	while ((n > 0) && adapt_can_bin(c, ((c->adapt_bin == 0) ? c->view.bin : c->adapt_bin) * 2)) {
+		c->adapt_bin = ((c->adapt_bin == 0) ? c->view.bin : c->adapt_bin) * 2;
+		n--;
+	}
+	
+	c->adapt_delay_usec = (n > 0) ? (RSP_ADAPT_BASE_DELAY_USEC << (n - 1)) : 0;
+	
+	// A new view needs a new delta image reference and the next image is timed from now
+	if (c->adapt_bin != prev_bin) {
+		c->stream_force_key = true;
+	}
+	c->stream_ready_usec = esp_timer_get_time();
+	c->adapt_images = 0;
+	c->adapt_good_usec = 0;
+}
+
+
+/**
+ * Update a client's adaptive stream with the latency of an image it has been sent.
+ * Step down while the smoothed latency is over the target (giving each level a few
+ * images to take effect) and back up once it has been well under the target for a
+ * while.
+ */
+static void update_adapt(rsp_client_t* c, int64_t latency_usec)
+{
+	int64_t t = esp_timer_get_time();
+	
+	if (latency_usec < 0) latency_usec = 0;
+	if (c->adapt_latency_usec == 0) {
+		c->adapt_latency_usec = (uint32_t) latency_usec;
+	} else {
+		c->adapt_latency_usec = (uint32_t) ((3 * (int64_t) c->adapt_latency_usec + latency_usec) / 4);
+	}
+	c->adapt_images++;
+	
+	if (c->adapt_latency_usec > c->adapt_target_usec) {
+		c->adapt_good_usec = 0;
+		if ((c->adapt_images >= RSP_ADAPT_SETTLE_IMAGES) && (c->adapt_level < get_adapt_max_level(c))) {
+			set_adapt_level(c, c->adapt_level + 1);
+			ESP_LOGI(TAG, "Client %d adaptive stream down to level %d", (int) (c - clients), c->adapt_level);
+		}
+	} else if (c->adapt_latency_usec < (c->adapt_target_usec / 100) * RSP_ADAPT_UP_PCT) {
+		if (c->adapt_good_usec == 0) {
+			c->adapt_good_usec = t;
+		} else if ((c->adapt_level > 0) && ((t - c->adapt_good_usec) >= ((int64_t) RSP_ADAPT_UP_MSEC * 1000))) {
+			set_adapt_level(c, c->adapt_level - 1);
+			ESP_LOGI(TAG, "Client %d adaptive stream up to level %d", (int) (c - clients), c->adapt_level);
+		}
+	} else {
+		c->adapt_good_usec = 0;
+	}
+}
+
+
+/**
+ * Determine how long we can block waiting for notifications.  Only a delayed stream
+ * waiting for its next image time needs to wake up on its own.  Everything else
+ * (commands, responses, images, connection changes) is signalled by a notification.
+ */
+static TickType_t get_wait_ticks()
+{
+	int i;
+	int64_t wait_usec;
+	int64_t min_wait_usec = RSP_TASK_MAX_WAIT_MSEC * 1000;
+	rsp_client_t* c;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		c = &clients[i];
+		if (c->connected && c->stream_on && !c->image_pending && (get_frame_delay(c) != 0)) {
+			wait_usec = c->stream_ready_usec - esp_timer_get_time();
+			
+			// Wake early to leave power save ahead of a slow stream's image
+			if ((get_frame_delay(c) >= RSP_PS_SLOW_STREAM_USEC) && (wait_usec > RSP_PS_WAKE_USEC)) {
+				wait_usec -= RSP_PS_WAKE_USEC;
+			}
+			if (wait_usec < min_wait_usec) {
+				min_wait_usec = wait_usec;
+			}
+		}
+	}
+	
+	if (min_wait_usec <= 0) {
+		return 0;
+	}
+	
+	// Round up to the next tick so we don't wake early
+	return (TickType_t) ((min_wait_usec + (portTICK_PERIOD_MS * 1000) - 1) / (portTICK_PERIOD_MS * 1000));
+}
+
+
+/**
+ * True if any client has data waiting to be sent
+ */
+static bool tx_pending()
+{
+	int i;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (clients[i].tx_num != 0) return true;
+	}
+	
+	return false;
+}
+
+
+/**
+ * Block until a client with data waiting to be sent can accept more, for up to
+ * wait_ticks (limited to RSP_TX_WAIT_MSEC so we don't miss notifications for long)
+ */
+static void wait_tx_ready(TickType_t wait_ticks)
+{
+	int i;
+	int max_sock = -1;
+	uint32_t wait_msec;
+	fd_set tx_fds;
+	struct timeval tx_timeout;
+	
+	FD_ZERO(&tx_fds);
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (clients[i].tx_num != 0) {
+			FD_SET(clients[i].sock, &tx_fds);
+			if (clients[i].sock > max_sock) max_sock = clients[i].sock;
+		}
+	}
+	
+	wait_msec = wait_ticks * portTICK_PERIOD_MS;
+	if (wait_msec > RSP_TX_WAIT_MSEC) wait_msec = RSP_TX_WAIT_MSEC;
+	tx_timeout.tv_sec = 0;
+	tx_timeout.tv_usec = wait_msec * 1000;
+	
+	// Errors are detected by the following send
+	(void) select(max_sock + 1, NULL, &tx_fds, NULL, &tx_timeout);
+}
+
+
+/**
+ * Wait up to wait_ticks for and handle incoming notifications
+ */
+static void handle_notifications(TickType_t wait_ticks)
+{
+	int i;
+	uint32_t notification_value;
+	uint32_t missed;
+	lep_buffer_t* lep_bufP;
+	lep_segment_t* segP;
+	rsp_cmd_event_t evt;
+	
+	notification_value = 0;
+	if (xTaskNotifyWait(0x00, 0xFFFFFFFF, &notification_value, wait_ticks)) {
+		// Handle cmd_task notifications
+		if (Notification(notification_value, RSP_NOTIFY_CMD_EVENT_MASK)) {
+			while (xQueueReceive(sys_rsp_event_queue, &evt, 0) == pdTRUE) {
+				handle_event(&evt);
+			}
+		}
+		
+		// Handle lep_task notifications for each Lepton
+		for (i=0; i<LEP_NUM_LEPTONS; i++) {
+			if (Notification(notification_value, frame_notify_mask[i])) {
+				// Take the most recent frame if a client needs one
+				if (image_wanted(i)) {
+					lep_bufP = frame_acquire(frame_sub[i], &missed);
+					if (lep_bufP != NULL) {
+						if (cur_lep_bufP[i] != NULL) {
+							frame_release(cur_lep_bufP[i]);
+							missed++;
+						}
+						cur_lep_bufP[i] = lep_bufP;
+					}
+					perf_add(PERF_CNT_FRAME_SKIP, missed);
+				} else {
+					perf_add(PERF_CNT_FRAME_DROP, frame_skip(frame_sub[i]));
+				}
+			}
+		}
+		
+		// Hand each segment from lep_task to the low latency streams in order
+		if (Notification(notification_value, RSP_NOTIFY_LEP_SEGMENT_MASK)) {
+			while ((segP = frame_seg_acquire()) != NULL) {
+				dispatch_segment(segP);
+			}
+		}
+		
+		// Command responses from cmd_task (RSP_NOTIFY_CMD_RESPONSE_MASK) and raw packet
+		// batches (RSP_NOTIFY_LEP_PACKETS_MASK) are checked for each time through the
+		// main loop
+	}
+}
+
+
+/**
+ * True if any client is waiting for an image from a Lepton and able to send it
+ */
+static bool image_wanted(int lepton)
+{
+	int i;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (clients[i].connected && clients[i].image_pending && (clients[i].imageP == NULL) &&
+		    (clients[i].lepton == lepton)) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+
+/**
+ * True if any client is streaming segments
+ */
+static bool segments_wanted()
+{
+	int i;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (clients[i].connected && clients[i].stream_on && clients[i].stream_seg) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+
+/**
+ * Queue a segment for the clients streaming segments that are sending its frame.
+ * Clients start with the first segment of a frame and skip the rest of the frame if
+ * they are still sending the previous segment.
+ */
+static void dispatch_segment(lep_segment_t* segP)
+{
+	int i;
+	rsp_client_t* c;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		c = &clients[i];
+		if (!c->connected || !c->stream_on || !c->stream_seg) continue;
+		
+		if (segP->seg == 1) {
+			c->seg_frame_num = segP->frame_num;
+			c->seg_next = 1;
+		}
+		if ((segP->frame_num != c->seg_frame_num) || (segP->seg != c->seg_next)) continue;
+		
+		if (c->segP != NULL) {
+			c->seg_next = 0;
+			perf_count(PERF_CNT_SEG_DROP);
+			continue;
+		}
+		
+		queue_segment(c, segP);
+	}
+	
+	frame_seg_release(segP);
+}
+
+
+/**
+ * Queue a segment for a client (or send it immediately for UDP streams) and update its
+ * stream state.  The last segment of a frame includes the binary image header for the
+ * complete frame and the telemetry.
+ */
+static void queue_segment(rsp_client_t* c, lep_segment_t* segP)
+{
+	int count;
+	int index = 0;
+	uint8_t* p = c->seg_header;
+	uint32_t img_hdr_len = 0;
+	uint32_t telem_len = 0;
+	uint32_t offset = 0;
+	
+	if (segP->seg == 4) {
+		img_hdr_len = bin_get_image_header(c->seg_img_header, &segP->buf, LEP_WIDTH, LEP_HEIGHT, BIN_ENC_RAW, LEP_NUM_PIXELS*2, c->telem_mask);
+		telem_len = bin_get_image_telem_len(&segP->buf, c->telem_mask);
+	}
+	
+	*p++ = RSP_SEG_START;
+	*p++ = RSP_SEG_VERSION;
+	p = put_u16(p, RSP_SEG_HEADER_LEN);
+	p = put_u16(p, segP->frame_num & 0xFFFF);
+	p = put_u16(p, segP->frame_num >> 16);
+	*p++ = segP->seg;
+	*p++ = 0;
+	p = put_u16(p, segP->start);
+	p = put_u16(p, segP->len);
+	p = put_u16(p, (uint16_t) img_hdr_len);
+	(void) put_u16(p, (uint16_t) telem_len);
+	
+	if (c->stream_udp) {
+		// Each part of the segment starts a new datagram
+		count = 1 + (segP->len*2 + RSP_MAX_UDP_DATA_LEN - 1) / RSP_MAX_UDP_DATA_LEN;
+		count += (img_hdr_len + RSP_MAX_UDP_DATA_LEN - 1) / RSP_MAX_UDP_DATA_LEN;
+		count += (telem_len + RSP_MAX_UDP_DATA_LEN - 1) / RSP_MAX_UDP_DATA_LEN;
+		if (send_udp_data(c, (char*) c->seg_header, RSP_SEG_HEADER_LEN, &offset, &index, count) &&
+		    send_udp_data(c, (char*) segP->buf.lep_bufferP, segP->len*2, &offset, &index, count) &&
+		    send_udp_data(c, (char*) c->seg_img_header, img_hdr_len, &offset, &index, count)) {
+			(void) send_udp_data(c, (char*) segP->buf.lep_telemP, telem_len, &offset, &index, count);
+		}
+		perf_record(PERF_STAGE_SEG_SEND, segP->ready_usec);
+		c->udp_frame_num++;
+	} else {
+		frame_seg_hold(segP);
+		c->segP = segP;
+		push_ws_header(c, c->seg_wrap, RSP_SEG_HEADER_LEN + segP->len*2 + img_hdr_len + telem_len);
+		push_tx(c, (char*) c->seg_header, RSP_SEG_HEADER_LEN, false);
+		push_tx(c, (char*) segP->buf.lep_bufferP, segP->len*2, false);
+		if (img_hdr_len != 0) {
+			push_tx(c, (char*) c->seg_img_header, img_hdr_len, false);
+		}
+		if (telem_len != 0) {
+			push_tx(c, (char*) segP->buf.lep_telemP, telem_len, false);
+		}
+		c->tx_items[c->tx_num - 1].seg_end = true;
+	}
+	
+	// Count streamed frames at their last segment
+	if (segP->seg == 4) {
+		c->seg_next = 0;
+		if ((c->stream_frame_num != 0) && (--c->stream_remaining_frames == 0)) {
+			c->stream_on = false;
+		}
+	} else {
+		c->seg_next++;
+	}
+}
+
+
+/**
+ * True if any client is streaming raw packets
+ */
+static bool raw_wanted()
+{
+	int i;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (clients[i].connected && clients[i].stream_on && clients[i].stream_raw) {
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+
+/**
+ * Queue the raw packet batches published by lep_task, oldest first, for the clients
+ * streaming raw packets from their Lepton and start sending them.  Batches wait in the
+ * pool while a raw stream is still sending the previous one (so a host only sees gaps
+ * when the pool overflows) and are discarded when there are no raw streams.
+ */
+static void dispatch_packets()
+{
+	int i;
+	rsp_client_t* c;
+	lep_pkt_batch_t* batchP;
+	
+	while (frame_pkt_available()) {
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			c = &clients[i];
+			if (c->connected && c->stream_on && c->stream_raw && (c->pktP != NULL)) return;
+		}
+		
+		if ((batchP = frame_pkt_acquire()) == NULL) return;
+		
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			c = &clients[i];
+			if (!c->connected || !c->stream_on || !c->stream_raw || (c->lepton != batchP->lepton)) continue;
+			
+			queue_packets(c, batchP);
+			send_client_data(c);
+		}
+		
+		frame_pkt_release(batchP);
+	}
+}
+
+
+/**
+ * Queue a raw packet batch with its header for a client (or send it immediately in one
+ * datagram for UDP streams)
+ */
+static void queue_packets(rsp_client_t* c, lep_pkt_batch_t* batchP)
+{
+	int index = 0;
+	uint8_t* p = c->pkt_header;
+	uint32_t offset = 0;
+	uint32_t len = batchP->num_pkts * LEP_PKT_LENGTH;
+	uint32_t t = (uint32_t) batchP->read_usec;
+	
+	*p++ = RSP_PKT_START;
+	*p++ = RSP_PKT_VERSION;
+	p = put_u16(p, RSP_PKT_HEADER_LEN);
+	p = put_u16(p, batchP->pkt_num & 0xFFFF);
+	p = put_u16(p, batchP->pkt_num >> 16);
+	*p++ = batchP->lepton;
+	*p++ = batchP->num_pkts;
+	p = put_u16(p, LEP_PKT_LENGTH);
+	p = put_u16(p, t & 0xFFFF);
+	(void) put_u16(p, t >> 16);
+	
+	if (c->stream_udp) {
+		memcpy(udp_raw_batch, c->pkt_header, RSP_PKT_HEADER_LEN);
+		memcpy(udp_raw_batch + RSP_PKT_HEADER_LEN, batchP->pktP, len);
+		(void) send_udp_data(c, (char*) udp_raw_batch, RSP_PKT_HEADER_LEN + len, &offset, &index, 1);
+		c->udp_frame_num++;
+	} else {
+		frame_pkt_hold(batchP);
+		c->pktP = batchP;
+		push_ws_header(c, c->pkt_wrap, RSP_PKT_HEADER_LEN + len);
+		push_tx(c, (char*) c->pkt_header, RSP_PKT_HEADER_LEN, false);
+		push_tx(c, (char*) batchP->pktP, len, false);
+		c->tx_items[c->tx_num - 1].pkt_end = true;
+	}
+}
+
+
+/**
+ * Encode a lepton frame once for each format needed by the clients waiting for an
+ * image (or only for client when it isn't -1) and queue it for them.  Clients still
+ * sending a previous image skip this frame.  The frame is released when no image
+ * being sent is holding it.
+ */
+static void dispatch_image(lep_buffer_t* lep_bufP, int client)
+{
+	bool held;
+	bool have_blocks = false;
+	int i, j, key;
+	int num_frame_images = 0;
+	rsp_image_t* frame_images[CMD_MAX_CLIENTS];
+	rsp_image_t* imgP;
+	rsp_client_t* c;
+	rsp_view_t view;
+	
+	// Measure the interval between frames for synchronized streams
+	if ((lep_bufP != &avg_buf) && (client < 0)) {
+		if ((sync_vsync_usec[lep_bufP->lepton] != 0) && (lep_bufP->vsync_usec > sync_vsync_usec[lep_bufP->lepton])) {
+			sync_frame_usec[lep_bufP->lepton] = lep_bufP->vsync_usec - sync_vsync_usec[lep_bufP->lepton];
+		}
+		sync_vsync_usec[lep_bufP->lepton] = lep_bufP->vsync_usec;
+	}
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if ((client >= 0) && (i != client)) continue;
+		c = &clients[i];
+		if (!c->connected || !c->image_pending || (c->imageP != NULL)) continue;
+		
+		// Clients only take frames from the Lepton they selected
+		if (c->lepton != lep_bufP->lepton) continue;
+		
+		// Clients waiting for an averaged image only take the average of their frames
+		if ((c->avg_frames != 0) ? ((lep_bufP != &avg_buf) || (i != avg_client)) : (lep_bufP == &avg_buf)) continue;
+		
+		// Change triggered streams skip frames until the scene changes
+		if (c->stream_on && (c->trig.threshold != 0)) {
+			if (!have_blocks) {
+				get_trigger_blocks(lep_bufP);
+				have_blocks = true;
+			}
+			if (!trigger_wanted(c)) continue;
+		}
+		
+		// Synchronized streams skip frames that aren't the nearest to a tick
+		if (c->stream_on && c->stream_sync && !sync_wanted(c, lep_bufP)) continue;
+		
+		// Command priority streams skip frames while a command response is waiting
+		if (c->stream_on && c->stream_cmd_priority && (c->rsp_busy || cmd_response_available(i))) continue;
+		
+		// Look for an image already encoded from this frame for the client's format
+		key = get_image_key(i);
+		get_image_view(i, &view);
+		imgP = NULL;
+		for (j=0; j<num_frame_images; j++) {
+			if ((frame_images[j]->key == key) && same_view(&frame_images[j]->view, &view) &&
+			    (frame_images[j]->telem_mask == get_telem_mask(i)) && same_preview(frame_images[j], i) &&
+			    (frame_images[j]->hist == c->hist) &&
+			    (frame_images[j]->sync_tick_usec == get_sync_tick(i))) {
+				imgP = frame_images[j];
+				break;
+			}
+		}
+		
+		if (imgP == NULL) {
+			// Encode the frame into a free image
+			imgP = get_free_image(frame_images, num_frame_images);
+			if (imgP == NULL) {
+				ESP_LOGE(TAG, "No free image for client %d", i);
+				continue;
+			}
+			if (!encode_image(imgP, lep_bufP, key, &view, i)) {
+				continue;
+			}
+			perf_count(PERF_CNT_IMAGES_ENC);
+			frame_images[num_frame_images++] = imgP;
+		}
+		
+		queue_image(i, imgP, lep_bufP);
+		if (c->trig.threshold != 0) {
+			trigger_sent(c);
+		}
+	}
+	
+	// Release the frame buffer if no image holds it (images only sent
+	// as UDP datagrams are already done with it)
+	for (j=0; j<num_frame_images; j++) {
+		if (frame_images[j]->refs == 0) {
+			frame_images[j]->lep_bufP = NULL;
+		}
+	}
+	held = false;
+	for (j=0; j<CMD_MAX_CLIENTS; j++) {
+		if ((images[j].refs != 0) && (images[j].lep_bufP == lep_bufP)) {
+			held = true;
+		}
+	}
+	if (!held) {
+		frame_release(lep_bufP);
+	}
+}
+
+
+/**
+ * Send a client waiting for an image the newest frame already captured if it is
+ * recent enough.  Otherwise the client gets the next frame.  Images hold one frame
+ * reference between them so the reference taken here is dropped again if an image
+ * being sent already holds the frame.
+ */
+static void dispatch_newest(int client)
+{
+	int i;
+	int64_t max_age_usec;
+	lep_buffer_t* lep_bufP;
+	rsp_client_t* c = &clients[client];
+	
+	max_age_usec = c->image_max_age_usec;
+	c->image_max_age_usec = 0;
+	if (!c->connected || !c->image_pending || c->stream_on || (c->imageP != NULL)) return;
+	
+	lep_bufP = frame_acquire_newest(frame_sub[c->lepton]);
+	if (lep_bufP == NULL) return;
+	
+	if ((esp_timer_get_time() - lep_bufP->vsync_usec) > max_age_usec) {
+		frame_release(lep_bufP);
+		return;
+	}
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if ((images[i].refs != 0) && (images[i].lep_bufP == lep_bufP)) {
+			frame_release(lep_bufP);
+			break;
+		}
+	}
+	dispatch_image(lep_bufP, client);
+}
+
+
+/**
+ * Load trig_blocks with the mean of each block of the frame
+ */
+static void get_trigger_blocks(lep_buffer_t* lep_bufP)
+{
+	int bx, by, x, y;
+	uint16_t* rowP;
+	uint32_t sums[RSP_TRIG_BLOCKS_X];
+	
+	for (by=0; by<RSP_TRIG_BLOCKS_Y; by++) {
+		for (bx=0; bx<RSP_TRIG_BLOCKS_X; bx++) {
+			sums[bx] = 0;
+		}
+		for (y=0; y<RSP_TRIG_BLOCK_SIZE; y++) {
+			rowP = lep_bufP->lep_bufferP + (by*RSP_TRIG_BLOCK_SIZE + y)*LEP_WIDTH;
+			for (bx=0; bx<RSP_TRIG_BLOCKS_X; bx++) {
+				for (x=0; x<RSP_TRIG_BLOCK_SIZE; x++) {
+					sums[bx] += *rowP++;
+				}
+			}
+		}
+		for (bx=0; bx<RSP_TRIG_BLOCKS_X; bx++) {
+			trig_blocks[by*RSP_TRIG_BLOCKS_X + bx] = sums[bx] / (RSP_TRIG_BLOCK_SIZE*RSP_TRIG_BLOCK_SIZE);
+		}
+	}
+}
+
+
+/**
+ * Compare the frame's blocks (trig_blocks) with the last image sent to a change
+ * triggered stream, update its state and return true if the frame should be sent:
+ * the first image, when the scene starts changing, at the stream rate while it is
+ * changing and heartbeats
+ */
+static bool trigger_wanted(rsp_client_t* c)
+{
+	bool start = false;
+	int i;
+	int num_trig = 0;
+	int num_hold = 0;
+	int64_t t = esp_timer_get_time();
+	uint16_t d;
+	
+	if (!c->trig_ref_valid) return true;
+	
+	// Sum of absolute differences of each block
+	for (i=0; i<RSP_TRIG_NUM_BLOCKS; i++) {
+		d = (trig_blocks[i] > c->trig_ref[i]) ? trig_blocks[i] - c->trig_ref[i] : c->trig_ref[i] - trig_blocks[i];
+		if (d >= c->trig.threshold) num_trig++;
+		if (d >= (c->trig.threshold + 1) / 2) num_hold++;
+	}
+	
+	// Start on the threshold, stay active down to half of it (hysteresis)
+	if (num_trig >= c->trig.min_blocks) {
+		start = !c->trig_active;
+		c->trig_active = true;
+		c->trig_change_usec = t;
+	} else if (c->trig_active && (num_hold >= c->trig.min_blocks)) {
+		c->trig_change_usec = t;
+	} else if (c->trig_active && ((t - c->trig_change_usec) >= ((int64_t) c->trig.hold_ms * 1000))) {
+		c->trig_active = false;
+	}
+	
+	if (start) return true;
+	if (c->trig_active && (t >= c->stream_ready_usec)) return true;
+	if ((c->trig.heartbeat_ms != 0) && ((t - c->trig_sent_usec) >= ((int64_t) c->trig.heartbeat_ms * 1000))) {
+		return true;
+	}
+	
+	return false;
+}
+
+
+/**
+ * Note an image was queued for a change triggered stream.  Its blocks become the
+ * reference for the following frames.
+ */
+static void trigger_sent(rsp_client_t* c)
+{
+	int64_t t = esp_timer_get_time();
+	
+	memcpy(c->trig_ref, trig_blocks, sizeof(trig_blocks));
+	c->trig_ref_valid = true;
+	c->trig_sent_usec = t;
+	c->stream_ready_usec = t + get_frame_delay(c);
+}
+
+
+/**
+ * Return true if a synchronized stream should send the frame: it is within half the
+ * interval between frames of a tick the stream hasn't sent.  The ticks are multiples of
+ * the stream's delay (rounded up to whole delays while an adaptive stream is slowed) in
+ * uSec since 1970.  Loads the client's sync_tick_usec with the frame's tick.
+ */
+static bool sync_wanted(rsp_client_t* c, lep_buffer_t* lep_bufP)
+{
+	int64_t period, t, tick;
+	
+	period = c->stream_frame_delay_usec;
+	period = ((get_frame_delay(c) + period - 1) / period) * period;
+	
+	t = time_timer_to_usec(lep_bufP->vsync_usec);
+	tick = ((t + period/2) / period) * period;
+	
+	// The clock may have been stepped back so any other tick is new
+	if (tick == c->sync_tick_usec) return false;
+	if (llabs(t - tick) > (sync_frame_usec[lep_bufP->lepton] / 2)) return false;
+	
+	c->sync_tick_usec = tick;
+	return true;
+}
+
+
+/**
+ * Stop summing frames for a client's averaged image
+ */
+static void cancel_average(int client)
+{
+	clients[client].avg_frames = 0;
+	if (avg_client == client) {
+		avg_client = -1;
+	}
+}
+
+
+/**
+ * True while an image is being sent from the last average
+ */
+static bool avg_buf_busy()
+{
+	int i;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if ((images[i].refs != 0) && (images[i].lep_bufP == &avg_buf)) return true;
+	}
+	
+	return false;
+}
+
+
+/**
+ * Add a frame to the averaged image being summed, starting one for the first client
+ * waiting for an averaged image when none is (and the last one has been sent).  Frames
+ * taken during a FFC are skipped.
+ */
+static void accumulate_frame(lep_buffer_t* lep_bufP)
+{
+	int i;
+	uint16_t* sP = lep_bufP->lep_bufferP;
+	uint32_t* aP = sys_rsp_avg_sumP;
+	
+	if (avg_client < 0) {
+		if (avg_buf_busy()) return;
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			if (clients[i].connected && clients[i].image_pending && (clients[i].avg_frames != 0)) break;
+		}
+		if (i == CMD_MAX_CLIENTS) return;
+		avg_client = i;
+		avg_num = 0;
+		avg_skipped = 0;
+	}
+	if ((avg_num == clients[avg_client].avg_frames) || (lep_bufP->lepton != clients[avg_client].lepton)) return;
+	
+	if (lep_bufP->telem_valid ? lepton_tel_ffc_active(lep_bufP->lep_telemP) : lepton_ffc_commanded(LEP_FFC_WAIT_MSEC)) {
+		avg_skipped++;
+		return;
+	}
+	
+	if (avg_num == 0) {
+		for (i=0; i<LEP_NUM_PIXELS; i++) {
+			*aP++ = *sP++;
+		}
+	} else {
+		for (i=0; i<LEP_NUM_PIXELS; i++) {
+			*aP++ += *sP++;
+		}
+	}
+	
+	if (++avg_num == clients[avg_client].avg_frames) {
+		finish_average(lep_bufP);
+	}
+}
+
+
+/**
+ * Load avg_buf with the mean of the summed frames and the metadata and telemetry of the
+ * last one.  Radiometric images keep the fractional bits the average supports that fit
+ * in 16-bit pixels.
+ */
+static void finish_average(lep_buffer_t* lep_bufP)
+{
+	int i, key;
+	uint16_t* dP = avg_buf.lep_bufferP;
+	uint16_t t16;
+	uint16_t min = 0xFFFF;
+	uint16_t max = 0x0000;
+	uint32_t* aP = sys_rsp_avg_sumP;
+	uint32_t max_sum = 0;
+	uint32_t n = avg_num;
+	uint32_t bits = 0;
+	
+	key = get_image_key(avg_client);
+	if ((key == RSP_KEY_JSON) || (key == RSP_KEY_BIN) || (key == RSP_KEY_RICE)) {
+		while (((4 << (2*bits)) <= n) && (bits < RSP_AVG_MAX_FRAC_BITS)) bits++;
+		for (i=0; i<LEP_NUM_PIXELS; i++) {
+			if (aP[i] > max_sum) max_sum = aP[i];
+		}
+		while ((bits > 0) && ((((max_sum << bits) + n/2) / n) > 0xFFFF)) bits--;
+	}
+	
+	for (i=0; i<LEP_NUM_PIXELS; i++) {
+		t16 = (uint16_t) (((*aP++ << bits) + n/2) / n);
+		if (t16 < min) min = t16;
+		if (t16 > max) max = t16;
+		*dP++ = t16;
+	}
+	
+	avg_buf.telem_valid = lep_bufP->telem_valid;
+	avg_buf.lep_min_val = min;
+	avg_buf.lep_max_val = max;
+	avg_buf.vsync_usec = lep_bufP->vsync_usec;
+	avg_buf.ready_usec = lep_bufP->ready_usec;
+	avg_buf.seq = lep_bufP->seq;
+	avg_buf.lepton = lep_bufP->lepton;
+	avg_buf.avg_frames = (uint8_t) n;
+	avg_buf.avg_frac_bits = (uint8_t) bits;
+	if (lep_bufP->telem_valid) {
+		memcpy(avg_buf.lep_telemP, lep_bufP->lep_telemP, LEP_TEL_WORDS*2);
+	}
+	
+	ESP_LOGI(TAG, "Averaged %d frames (%d skipped for FFC) for client %d", (int) n, (int) avg_skipped, avg_client);
+}
+
+
+/**
+ * Return an image that isn't being sent or used for the current frame, NULL if none
+ */
+static rsp_image_t* get_free_image(rsp_image_t** frame_images, int num_frame_images)
+{
+	int i, j;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		if (images[i].refs != 0) continue;
+		
+		// Images sent only as UDP datagrams have no references but may still be
+		// shared by another client for this frame
+		for (j=0; j<num_frame_images; j++) {
+			if (frame_images[j] == &images[i]) break;
+		}
+		if (j == num_frame_images) {
+			return &images[i];
+		}
+	}
+	
+	return NULL;
+}
+
+
+/**
+ * Determine how a client's next image is encoded
+ */
+static int get_image_key(int client)
+{
+	rsp_client_t* c = &clients[client];
+	
+#ifdef CONFIG_TCAM_NO_PSRAM
+	// Binary images are always sent raw from the frame in the low memory build
+	if (c->image_format != RSP_IMG_FMT_JSON) return RSP_KEY_BIN;
+#endif
+	
+	// RTP streams send JPEG preview images whatever format the connection uses
+	if (c->stream_on && c->stream_rtp) return RSP_KEY_JPEG;
+	
+	switch (c->image_format) {
+		case RSP_IMG_FMT_BIN:
+			// Adaptive streams compress raw images when the link backs up
+			if (c->stream_on && c->adapt_compress) return RSP_KEY_RICE;
+			return (c->agc8) ? RSP_KEY_BIN8 : RSP_KEY_BIN;
+		
+		case RSP_IMG_FMT_BIN_RICE:
+			// Compressed streams with a key interval send delta images against the
+			// previous image between keyframes
+			if (c->stream_on && (c->stream_key_interval != 0) && !c->stream_force_key &&
+			    ((c->stream_frames_since_key + 1) < c->stream_key_interval)) {
+				return RSP_KEY_DELTA + client;
+			}
+			return RSP_KEY_RICE;
+		
+		case RSP_IMG_FMT_PNG:
+			return RSP_KEY_PNG;
+		
+		case RSP_IMG_FMT_JPEG:
+			return RSP_KEY_JPEG;
+		
+		case RSP_IMG_FMT_SPARSE:
+			// Streams send sparse images with a compressed keyframe first and every key
+			// interval images for context.  Single images are always complete.
+			if (c->stream_on && !c->stream_force_key && ((c->stream_key_interval == 0) ||
+			    ((c->stream_frames_since_key + 1) < c->stream_key_interval))) {
+				return RSP_KEY_SPARSE + client;
+			}
+			return RSP_KEY_RICE;
+		
+		default:
+			return (c->agc8) ? RSP_KEY_JSON8 : RSP_KEY_JSON;
+	}
+}
+
+
+/**
+ * Get the telemetry fields sent with a client's images.  Streams send the fields the
+ * client selected.  Single images (get_image) always include the complete telemetry.
+ */
+static uint8_t get_telem_mask(int client)
+{
+	rsp_client_t* c = &clients[client];
+	
+	return (c->stream_on) ? c->telem_mask : 0;
+}
+
+
+/**
+ * Get the synchronized stream tick a client's image is tagged with (0 for other images)
+ */
+static int64_t get_sync_tick(int client)
+{
+	rsp_client_t* c = &clients[client];
+	
+	return (c->stream_on && c->stream_sync) ? c->sync_tick_usec : 0;
+}
+
+
+/**
+ * Get the view of the frame used for a client's images (json images, and all images in
+ * the low memory build which has no view buffers, are always the full frame)
+ */
+static void get_image_view(int client, rsp_view_t* v)
+{
+#ifdef CONFIG_TCAM_NO_PSRAM
+	init_view(v);
+#else
+	if (clients[client].image_format == RSP_IMG_FMT_JSON) {
+		init_view(v);
+	} else {
+		*v = clients[client].view;
+		if (clients[client].stream_on && (clients[client].adapt_bin > v->bin)) {
+			v->bin = clients[client].adapt_bin;
+		}
+	}
+#endif
+}
+
+
+static bool same_view(rsp_view_t* v1, rsp_view_t* v2)
+{
+	return ((v1->r1 == v2->r1) && (v1->c1 == v2->c1) && (v1->r2 == v2->r2) &&
+	        (v1->c2 == v2->c2) && (v1->bin == v2->bin));
+}
+
+
+/**
+ * True if an image can be sent to a client using preview images with its palette and
+ * range
+ */
+static bool same_preview(rsp_image_t* imgP, int client)
+{
+	rsp_client_t* c = &clients[client];
+	
+	if ((imgP->key != RSP_KEY_PNG) && (imgP->key != RSP_KEY_JPEG)) return true;
+	
+	return ((imgP->preview_palette == c->preview_palette) && (imgP->preview_lo == c->preview_lo) &&
+	        (imgP->preview_hi == c->preview_hi));
+}
+
+
+/**
+ * Encode a lepton frame into imgP.  Json images have the start of the json record
+ * generated and hold the frame so the rest of the record can be encoded from it as it
+ * is sent.  Binary images have the header and metadata generated locally and hold
+ * the frame so the image and telemetry can be sent from it.  A view smaller than the
+ * full frame is first reduced into the image's view buffer.  Compressed images are
+ * encoded into the image's buffer and sent from there unless they would be larger
+ * than the raw image.  PNG images are encoded using the client's delta image reference
+ * as work space (PNG clients never send delta images).  A preview image that doesn't
+ * fit (or a JPEG image of a view that isn't a multiple of the MCU size) is left raw.
+ */
+static bool encode_image(rsp_image_t* imgP, lep_buffer_t* lep_bufP, int key, rsp_view_t* v, int client)
+{
+	uint32_t len;
+	int64_t tb;
+	int64_t t_start = esp_timer_get_time();
+	lep_buffer_t tagged;
+	
+	imgP->key = key;
+	imgP->view = *v;
+	imgP->telem_mask = get_telem_mask(client);
+	imgP->sync_tick_usec = get_sync_tick(client);
+	imgP->hist = clients[client].hist;
+	imgP->lep_bufP = NULL;
+	
+	if ((key == RSP_KEY_JSON) || (key == RSP_KEY_JSON8)) {
+		// The metadata is encoded from a copy of the frame's state tagged with the tick
+		tagged = *lep_bufP;
+		tagged.sync_tick_usec = imgP->sync_tick_usec;
+		if (imgP->hist) {
+			get_image_hist(lep_bufP->lep_bufferP, LEP_NUM_PIXELS, lep_bufP->lep_min_val, lep_bufP->lep_max_val);
+			tagged.histP = &img_hist;
+		}
+		imgP->encoding = ((key == RSP_KEY_JSON8) && is_agc8_frame(lep_bufP)) ? BIN_ENC_AGC8 : BIN_ENC_RAW;
+		len = process_image(imgP->encP, &tagged, (imgP->encoding == BIN_ENC_AGC8), imgP->telem_mask);
+		if (len == 0) return false;
+		imgP->imgP = imgP->encP->bufferP;
+		imgP->img_len = len;
+		imgP->hdr_len = 0;
+		imgP->telem_len = 0;
+		imgP->lep_bufP = lep_bufP;
+		imgP->enc_usec = (uint32_t) (esp_timer_get_time() - t_start);
+		return true;
+	}
+	
+	imgP->src = *lep_bufP;
+	imgP->src.sync_tick_usec = imgP->sync_tick_usec;
+	imgP->width = (v->c2 - v->c1 + 1) / v->bin;
+	imgP->height = (v->r2 - v->r1 + 1) / v->bin;
+	if ((imgP->width != LEP_WIDTH) || (imgP->height != LEP_HEIGHT)) {
+		imgP->src.lep_bufferP = imgP->viewP;
+		reduce_frame(lep_bufP, &imgP->src, v);
+	}
+	
+	imgP->imgP = (char*) imgP->src.lep_bufferP;
+	imgP->img_len = imgP->width*imgP->height*2;
+	imgP->encoding = BIN_ENC_RAW;
+	
+	if ((key == RSP_KEY_PNG) || (key == RSP_KEY_JPEG)) {
+		tb = esp_timer_get_time();
+		len = encode_preview(imgP, key, client);
+		perf_record((key == RSP_KEY_PNG) ? PERF_STAGE_PNG_ENC : PERF_STAGE_JPEG_ENC, tb);
+		if (len != 0) {
+			imgP->imgP = imgP->encP->bufferP;
+			imgP->img_len = len;
+			imgP->encoding = (key == RSP_KEY_PNG) ? BIN_ENC_PNG : BIN_ENC_JPEG;
+		}
+	} else if (key == RSP_KEY_BIN8) {
+		if (is_agc8_frame(&imgP->src)) {
+			pack_agc8(imgP->src.lep_bufferP, (uint8_t*) imgP->encP->bufferP, imgP->width*imgP->height);
+			imgP->imgP = imgP->encP->bufferP;
+			imgP->img_len = imgP->width*imgP->height;
+			imgP->encoding = BIN_ENC_AGC8;
+		}
+	} else if (key >= RSP_KEY_SPARSE) {
+		// Images with too many pixels above the threshold to be smaller are sent raw
+		len = sparse_encode_image(imgP->src.lep_bufferP, imgP->width, imgP->height, clients[client].sparse_threshold,
+		                          (uint8_t*) imgP->encP->bufferP, imgP->img_len);
+		if (len != 0) {
+			imgP->imgP = imgP->encP->bufferP;
+			imgP->img_len = len;
+			imgP->encoding = BIN_ENC_SPARSE;
+		}
+	} else if (key != RSP_KEY_BIN) {
+		tb = esp_timer_get_time();
+		len = enc_rice_encode_image(imgP->src.lep_bufferP, (key == RSP_KEY_RICE) ? NULL : sys_rsp_ref_bufferP[client],
+		                        imgP->width, imgP->height,
+		                        (uint8_t*) imgP->encP->bufferP, imgP->img_len);
+		perf_record(PERF_STAGE_RICE_ENC, tb);
+		if (len != 0) {
+			imgP->imgP = imgP->encP->bufferP;
+			imgP->img_len = len;
+			imgP->encoding = (key == RSP_KEY_RICE) ? BIN_ENC_RICE : BIN_ENC_RICE_DELTA;
+		}
+	}
+	
+	if (imgP->hist) {
+		get_image_hist(imgP->src.lep_bufferP, imgP->width*imgP->height, imgP->src.lep_min_val, imgP->src.lep_max_val);
+		imgP->src.histP = &img_hist;
+	}
+	imgP->hdr_len = bin_get_image_header(imgP->header, &imgP->src, imgP->width, imgP->height, imgP->encoding, imgP->img_len, imgP->telem_mask);
+	imgP->src.histP = NULL;
+	imgP->telem_len = bin_get_image_telem_len(lep_bufP, imgP->telem_mask);
+	imgP->lep_bufP = lep_bufP;
+	imgP->enc_usec = (uint32_t) (esp_timer_get_time() - t_start);
+	
+	return true;
+}
+
+
+
+/**
+ * Load img_hist with the histogram of n pixels in the range lo - hi and the pixel
+ * values at its percentiles (the lowest value with at least that share of the pixels
+ * at or below it, exact for ranges up to RSP_HIST_FINE_BINS)
+ */
+static void get_image_hist(const uint16_t* pixelP, uint32_t n, uint16_t lo, uint16_t hi)
+{
+	int i;
+	uint16_t v;
+	uint32_t range = (uint32_t) hi - lo + 1;
+	uint32_t sum = 0;
+	uint32_t next;
+	uint32_t p1 = (n + 99) / 100;
+	uint32_t p50 = (n + 1) / 2;
+	uint32_t p99 = (n*99 + 99) / 100;
+	
+	memset(hist_fine, 0, sizeof(hist_fine));
+	memset(&img_hist, 0, sizeof(img_hist));
+	
+	while (n--) {
+		v = *pixelP++;
+		if (v < lo) v = lo;
+		if (v > hi) v = hi;
+		hist_fine[((uint32_t) (v - lo) * RSP_HIST_FINE_BINS) / range]++;
+	}
+	
+	for (i=0; i<RSP_HIST_FINE_BINS; i++) {
+		if (hist_fine[i] == 0) continue;
+		img_hist.bins[i / (RSP_HIST_FINE_BINS / LEP_HIST_BINS)] += hist_fine[i];
+		
+		// The lowest value counted in this bin
+		v = lo + ((uint32_t) i * range + RSP_HIST_FINE_BINS - 1) / RSP_HIST_FINE_BINS;
+		next = sum + hist_fine[i];
+		if ((sum < p1) && (next >= p1)) img_hist.p1 = v;
+		if ((sum < p50) && (next >= p50)) img_hist.p50 = v;
+		if ((sum < p99) && (next >= p99)) img_hist.p99 = v;
+		sum = next;
+	}
+}
+
+/**
+ * Encode an image as a PNG or JPEG file using the client's palette and range.  A fixed
+ * range (K * 100) is only used for radiometric images; other images are scaled to their
+ * own range.  Returns the file length or 0 if it couldn't be encoded.
+ */
+static uint32_t encode_preview(rsp_image_t* imgP, int key, int client)
+{
+	rsp_client_t* c = &clients[client];
+	bool radiometric;
+	uint16_t lo = imgP->src.lep_min_val;
+	uint16_t hi = imgP->src.lep_max_val;
+	uint32_t scale = LEP_TLIN_SCALE_0_01K;
+	
+	imgP->preview_palette = c->preview_palette;
+	imgP->preview_lo = c->preview_lo;
+	imgP->preview_hi = c->preview_hi;
+	
+	if (imgP->src.telem_valid) {
+		radiometric = (imgP->src.lep_telemP[LEP_TEL_TLIN_ENABLE] != 0);
+		if (radiometric) {
+			scale = lepton_tel_tlin_scale(imgP->src.lep_telemP);
+		}
+	} else {
+		radiometric = !system_get_lep_st()->agc_set_enabled;
+	}
+	
+	if (radiometric && (c->preview_hi != 0)) {
+		lo = c->preview_lo / scale;
+		hi = c->preview_hi / scale;
+	}
+	imgP->scale_lo = lo;
+	imgP->scale_hi = hi;
+	imgP->scale_res = (radiometric) ? scale : 0;
+	
+	if (key == RSP_KEY_JPEG) {
+		return jpeg_encode_image(imgP->src.lep_bufferP, imgP->width, imgP->height,
+		                         palette_get(c->preview_palette), lo, hi, JPEG_DEF_QUALITY,
+		                         (uint8_t*) imgP->encP->bufferP, LEP_NUM_PIXELS*2, &imgP->scan_offset);
+	}
+	
+	return png_encode_image(imgP->src.lep_bufferP, imgP->width, imgP->height,
+	                        palette_get(c->preview_palette), lo, hi,
+	                        (uint8_t*) sys_rsp_ref_bufferP[client],
+	                        (uint8_t*) imgP->encP->bufferP, LEP_NUM_PIXELS*2);
+}
+
+
+/**
+ * True if a frame (or a view of it) is Lepton AGC output that fits in 8-bit pixels
+ */
+static bool is_agc8_frame(lep_buffer_t* bufP)
+{
+	bool agc;
+	
+	if (bufP->telem_valid) {
+		agc = (lepton_get_tel_status(bufP->lep_telemP) & LEP_STATUS_AGC_STATE) != 0;
+	} else {
+		agc = system_get_lep_st()->agc_set_enabled;
+	}
+	
+	return (agc && (bufP->lep_max_val <= 0xFF));
+}
+
+
+/**
+ * Pack n pixels into 8-bit pixels
+ */
+static void pack_agc8(const uint16_t* srcP, uint8_t* dstP, uint32_t n)
+{
+	while (n--) {
+		*dstP++ = (uint8_t) *srcP++;
+	}
+}
+
+
+/**
+ * Crop a frame to a view and average each bin x bin block of pixels into dstP's
+ * image, computing its range
+ */
+static void reduce_frame(lep_buffer_t* lep_bufP, lep_buffer_t* dstP, rsp_view_t* v)
+{
+	int bin = v->bin;
+	int width = (v->c2 - v->c1 + 1) / bin;
+	int height = (v->r2 - v->r1 + 1) / bin;
+	int x, y, i, j;
+	uint16_t* sp;
+	uint16_t* dp = dstP->lep_bufferP;
+	uint16_t min = 0xFFFF;
+	uint16_t max = 0x0000;
+	uint16_t t16;
+	uint32_t sum;
+	
+	for (y=0; y<height; y++) {
+		sp = lep_bufP->lep_bufferP + ((v->r1 + y*bin) * LEP_WIDTH) + v->c1;
+		for (x=0; x<width; x++) {
+			if (bin == 1) {
+				t16 = *sp;
+			} else {
+				sum = 0;
+				for (j=0; j<bin; j++) {
+					for (i=0; i<bin; i++) {
+						sum += *(sp + (j * LEP_WIDTH) + i);
+					}
+				}
+				t16 = (uint16_t) (sum / (bin * bin));
+			}
+			if (t16 < min) min = t16;
+			if (t16 > max) max = t16;
+			*dp++ = t16;
+			sp += bin;
+		}
+	}
+	
+	dstP->lep_min_val = min;
+	dstP->lep_max_val = max;
+}
+
+
+/**
+ * Queue an encoded image for a client (or send it immediately for UDP streams) and
+ * update its stream state
+ */
+static void queue_image(int client, rsp_image_t* imgP, lep_buffer_t* lep_bufP)
+{
+	int n;
+	int64_t tb;
+	bool sent;
+	rsp_client_t* c = &clients[client];
+	
+	if (c->stream_on && c->stream_udp) {
+		tb = esp_timer_get_time();
+		if (c->stream_rtp) {
+			sent = send_rtp_image(c, imgP);
+		} else {
+			sent = send_udp_image(c, imgP, lep_bufP);
+		}
+		perf_record(PERF_STAGE_SEND, tb);
+		if (sent) {
+			perf_count(PERF_CNT_IMAGES_SENT);
+			if (c->stream_probe) {
+				send_probe(c, imgP, tb);
+			}
+		}
+	} else if (c->transport == RSP_TRANSPORT_MJPEG) {
+		// Only the JPEG file is sent (a frame that couldn't be encoded is skipped)
+		if (imgP->encoding == BIN_ENC_JPEG) {
+			imgP->refs++;
+			c->imageP = imgP;
+			c->image_queued_usec = esp_timer_get_time();
+			c->image_vsync_usec = lep_bufP->vsync_usec;
+			n = http_get_mjpeg_part_header((char*) c->img_wrap, "image/jpeg", imgP->img_len);
+			push_tx(c, (char*) c->img_wrap, n, false);
+			push_tx(c, imgP->imgP, imgP->img_len, true);
+		}
+	} else if (imgP->hdr_len != 0) {
+		imgP->refs++;
+		c->imageP = imgP;
+		c->image_queued_usec = esp_timer_get_time();
+		c->image_vsync_usec = lep_bufP->vsync_usec;
+		push_ws_header(c, c->img_wrap, imgP->hdr_len + imgP->img_len + imgP->telem_len);
+		push_tx(c, (char*) imgP->header, imgP->hdr_len, false);
+		push_tx(c, imgP->imgP, imgP->img_len, (imgP->telem_len == 0));
+		if (imgP->telem_len != 0) {
+			push_tx(c, (char*) lep_bufP->lep_telemP, imgP->telem_len, true);
+		}
+	} else {
+		imgP->refs++;
+		c->imageP = imgP;
+		c->image_queued_usec = esp_timer_get_time();
+		c->image_vsync_usec = lep_bufP->vsync_usec;
+		push_tx(c, imgP->imgP, imgP->img_len, false);
+		
+		// The chunks are sent as one item refilled from the chunk buffers as it is sent
+		start_json_chunks(c, imgP);
+		c->json_len[0] = encode_json_chunk(c, lep_bufP, c->json_bufP[0]);
+		push_tx(c, c->json_bufP[0], c->json_len[0], true);
+		c->tx_items[c->tx_num - 1].json_chunk = true;
+	}
+	c->image_pending = false;
+	
+	// Update the delta image state and reference (raw images are also keyframes)
+	if ((c->image_format == RSP_IMG_FMT_BIN_RICE) && (c->stream_key_interval != 0)) {
+		if (imgP->encoding == BIN_ENC_RICE_DELTA) {
+			c->stream_frames_since_key++;
+		} else {
+			c->stream_frames_since_key = 0;
+			c->stream_force_key = false;
+		}
+		tb = esp_timer_get_time();
+		memcpy(sys_rsp_ref_bufferP[client], imgP->src.lep_bufferP, imgP->width*imgP->height*2);
+		perf_record(PERF_STAGE_FRAME_COPY, tb);
+	} else if (c->image_format == RSP_IMG_FMT_SPARSE) {
+		if (imgP->encoding == BIN_ENC_SPARSE) {
+			c->stream_frames_since_key++;
+		} else {
+			c->stream_frames_since_key = 0;
+			c->stream_force_key = false;
+		}
+	}
+	
+	// If streaming, determine if we have sent the required number of images if necessary
+	if (c->stream_on && (c->stream_frame_num != 0)) {
+		if (--c->stream_remaining_frames == 0) {
+			c->stream_on = false;
+		}
+	}
+}
+
+
+/**
+ * Send an encoded image to a client's UDP destination split into datagrams.  The rest
+ * of the image is dropped if the network stack can't take a datagram.  Returns true if
+ * the whole image was sent.
+ */
+static bool send_udp_image(rsp_client_t* c, rsp_image_t* imgP, lep_buffer_t* lep_bufP)
+{
+	bool sent = false;
+	int count;
+	int index = 0;
+	uint32_t len, n;
+	uint32_t offset = 0;
+	
+	// Each part of the image starts a new datagram so image rows aren't split
+	count = (imgP->img_len + RSP_MAX_UDP_DATA_LEN - 1) / RSP_MAX_UDP_DATA_LEN;
+	if (imgP->hdr_len != 0) {
+		count += (imgP->hdr_len + RSP_MAX_UDP_DATA_LEN - 1) / RSP_MAX_UDP_DATA_LEN;
+		count += (imgP->telem_len + RSP_MAX_UDP_DATA_LEN - 1) / RSP_MAX_UDP_DATA_LEN;
+		
+		sent = send_udp_data(c, (char*) imgP->header, imgP->hdr_len, &offset, &index, count) &&
+		       send_udp_data(c, imgP->imgP, imgP->img_len, &offset, &index, count) &&
+		       send_udp_data(c, (char*) lep_bufP->lep_telemP, imgP->telem_len, &offset, &index, count);
+	} else {
+		// Json images are followed by their chunks
+		len = (imgP->encoding == BIN_ENC_AGC8) ? LEP_NUM_PIXELS : LEP_NUM_PIXELS*2;
+		for (offset=0; offset<len; offset+=RSP_JSON_CHUNK_SRC_LEN) {
+			n = len - offset;
+			if (n > RSP_JSON_CHUNK_SRC_LEN) n = RSP_JSON_CHUNK_SRC_LEN;
+			count += (((n + 2) / 3) * 4 + RSP_MAX_UDP_DATA_LEN - 1) / RSP_MAX_UDP_DATA_LEN;
+		}
+		count += (json_get_image_tail_len(imgP->telem_mask) + 1 + RSP_MAX_UDP_DATA_LEN - 1) / RSP_MAX_UDP_DATA_LEN;
+		offset = 0;
+		
+		if (send_udp_data(c, imgP->imgP, imgP->img_len, &offset, &index, count)) {
+			start_json_chunks(c, imgP);
+			sent = true;
+			while ((len = encode_json_chunk(c, lep_bufP, c->json_bufP[0])) != 0) {
+				if (!send_udp_data(c, c->json_bufP[0], len, &offset, &index, count)) {
+					sent = false;
+					break;
+				}
+			}
+			perf_record(PERF_STAGE_JSON_ENC, esp_timer_get_time() - c->json_enc_usec);
+		}
+	}
+	
+	c->udp_frame_num++;
+	return sent;
+}
+
+
+/**
+ * Send the scan of a JPEG image to a client's UDP destination as RTP/JPEG packets.  The
+ * rest of the image is dropped if the network stack can't take a packet.  Images that
+ * couldn't be encoded as JPEG are skipped.  Returns true if the whole image was sent.
+ */
+static bool send_rtp_image(rsp_client_t* c, rsp_image_t* imgP)
+{
+	bool first = true;
+	int err;
+	uint8_t* p;
+	uint8_t* scanP;
+	uint32_t len, n, max_n;
+	uint32_t offset = 0;
+	uint32_t ts;
+	
+	if (imgP->encoding != BIN_ENC_JPEG) return false;
+	
+	// The scan without the EOI (receivers append their own)
+	scanP = (uint8_t*) imgP->imgP + imgP->scan_offset;
+	len = imgP->img_len - imgP->scan_offset - 2;
+	ts = (uint32_t) ((esp_timer_get_time() * (RSP_RTP_CLOCK_HZ / 1000)) / 1000);
+	
+	while (len != 0) {
+		max_n = RSP_UDP_HEADER_LEN + RSP_MAX_UDP_DATA_LEN - RSP_RTP_HEADER_LEN - RSP_RTP_JPEG_HDR_LEN;
+		if (first) max_n -= RSP_RTP_EXT_LEN;
+		n = (len > max_n) ? max_n : len;
+		
+		// RTP header (the marker is set on the last packet of the image)
+		p = udp_pkt;
+		*p++ = (RSP_RTP_VERSION << 6) | ((first) ? 0x10 : 0x00);
+		*p++ = ((n == len) ? 0x80 : 0x00) | RSP_RTP_PT_JPEG;
+		p = put_be16(p, c->rtp_seq++);
+		p = put_be16(p, ts >> 16);
+		p = put_be16(p, ts & 0xFFFF);
+		p = put_be16(p, c->rtp_ssrc >> 16);
+		p = put_be16(p, c->rtp_ssrc & 0xFFFF);
+		
+		if (first) {
+			p = put_be16(p, 0xBEDE);
+			p = put_be16(p, (RSP_RTP_EXT_LEN - 4) / 4);
+			*p++ = (RSP_RTP_EXT_ID_RANGE << 4) | (8 - 1);
+			p = put_be16(p, imgP->scale_lo);
+			p = put_be16(p, imgP->scale_hi);
+			p = put_be16(p, imgP->src.lep_min_val);
+			p = put_be16(p, imgP->src.lep_max_val);
+			*p++ = (RSP_RTP_EXT_ID_RES << 4) | (2 - 1);
+			p = put_be16(p, imgP->scale_res);
+		}
+		
+		// JPEG header: type specific, fragment offset, type, Q, width / 8, height / 8
+		*p++ = 0;
+		*p++ = (offset >> 16) & 0xFF;
+		p = put_be16(p, offset & 0xFFFF);
+		*p++ = JPEG_RTP_TYPE;
+		*p++ = JPEG_DEF_QUALITY;
+		*p++ = imgP->width / 8;
+		*p++ = imgP->height / 8;
+		memcpy(p, scanP, n);
+		p += n;
+		
+		err = sendto(udp_sock, udp_pkt, p - udp_pkt, MSG_DONTWAIT,
+		             (struct sockaddr *) &c->udp_dest, sizeof(c->udp_dest));
+		if (err < 0) {
+			ESP_LOGD(TAG, "RTP sendto failed: errno %d - dropping image", errno);
+			perf_count(PERF_CNT_SEND_FAIL);
+			break;
+		}
+		
+		first = false;
+		scanP += n;
+		len -= n;
+		offset += n;
+	}
+	
+	c->udp_frame_num++;
+	return (len == 0);
+}
+
+
+/**
+ * Send len bytes of an image in one or more datagrams, updating the image offset and
+ * packet index
+ */
+static bool send_udp_data(rsp_client_t* c, char* buf, uint32_t len, uint32_t* offset, int* index, int count)
+{
+	int err;
+	uint8_t* p;
+	uint32_t n;
+	
+	while (len != 0) {
+		n = (len > RSP_MAX_UDP_DATA_LEN) ? RSP_MAX_UDP_DATA_LEN : len;
+		
+		p = udp_pkt;
+		*p++ = RSP_UDP_PKT_START;
+		*p++ = RSP_UDP_PKT_VERSION;
+		p = put_u16(p, c->udp_frame_num);
+		p = put_u16(p, (uint16_t) *index);
+		p = put_u16(p, (uint16_t) count);
+		p = put_u16(p, *offset & 0xFFFF);
+		p = put_u16(p, *offset >> 16);
+		memcpy(p, buf, n);
+		
+		err = sendto(udp_sock, udp_pkt, RSP_UDP_HEADER_LEN + n, MSG_DONTWAIT,
+		             (struct sockaddr *) &c->udp_dest, sizeof(c->udp_dest));
+		if (err < 0) {
+			ESP_LOGD(TAG, "UDP sendto failed: errno %d - dropping image", errno);
+			perf_count(PERF_CNT_SEND_FAIL);
+			return false;
+		}
+		
+		buf += n;
+		len -= n;
+		*offset += n;
+		*index += 1;
+	}
+	
+	return true;
+}
+
+
+/**
+ * Store a value little-endian, returning the next location
+ */
+static uint8_t* put_u16(uint8_t* p, uint16_t v)
+{
+	*p++ = v & 0xFF;
+	*p++ = v >> 8;
+	
+	return p;
+}
+
+
+/**
+ * Store a value big-endian (network order), returning the next location
+ */
+static uint8_t* put_be16(uint8_t* p, uint16_t v)
+{
+	*p++ = v >> 8;
+	*p++ = v & 0xFF;
+	
+	return p;
+}
+
+
+/**
+ * Follow an image sent to a client with its latency record: the time from the frame's
+ * vsync to the end of its readout, the encode time and when the image was queued to and
+ * accepted by the transport (queued_usec).
+ */
+static void send_probe(rsp_client_t* c, rsp_image_t* imgP, int64_t queued_usec)
+{
+	lep_buffer_t* lep_bufP = imgP->lep_bufP;
+	rsp_latency_t l;
+	uint32_t len;
+	
+	if ((lep_bufP == NULL) ||
+	    ((c->transport != RSP_TRANSPORT_SOCKET) && (c->transport != RSP_TRANSPORT_WS))) {
+		return;
+	}
+	
+	l.seq = lep_bufP->seq;
+	l.timestamp = (uint64_t) time_timer_to_usec(lep_bufP->vsync_usec);
+	l.capture_usec = (uint32_t) (lep_bufP->ready_usec - lep_bufP->vsync_usec);
+	l.encode_usec = imgP->enc_usec + ((imgP->hdr_len == 0) ? (uint32_t) c->json_enc_usec : 0);
+	l.send_start_usec = (uint32_t) (queued_usec - lep_bufP->vsync_usec);
+	l.send_end_usec = (uint32_t) (esp_timer_get_time() - lep_bufP->vsync_usec);
+	
+	len = json_get_latency(probe_text, sizeof(probe_text), &l);
+	if (len != 0) {
+		rsp_push_response(c - clients, probe_text, len);
+	} else {
+		ESP_LOGE(TAG, "Latency record didn't fit");
+	}
+}
+
+
+/**
+ * Release a client's reference to an image.  The frame held by the image is released
+ * when no other image holds it.
+ */
+static void release_image(rsp_image_t* imgP)
+{
+	int i;
+	lep_buffer_t* lep_bufP;
+	
+	if (--imgP->refs > 0) return;
+	
+	lep_bufP = imgP->lep_bufP;
+	imgP->lep_bufP = NULL;
+	if (lep_bufP != NULL) {
+		for (i=0; i<CMD_MAX_CLIENTS; i++) {
+			if ((images[i].refs != 0) && (images[i].lep_bufP == lep_bufP)) return;
+		}
+		frame_release(lep_bufP);
+	}
+}
+
+
+/**
+ * Generate the start of a json record (the start delimitor and the metadata) for
+ * transmission over the network.  The rest of the record is encoded by each client
+ * as it is sent.
+ */
+static int process_image(json_image_string_t* encP, lep_buffer_t* lep_bufP, bool agc8, uint8_t telem_mask)
+{
+    encP->length = json_get_image_head(encP->bufferP+1, RSP_IMAGE_ENC_LEN - 1, lep_bufP, agc8, telem_mask);
+    
+    if (encP->length > 0) {
+        // Add the start delimitor
+        *encP->bufferP = CMD_JSON_STRING_START;
+        encP->length = encP->length + 1;
+    } else {
+        ESP_LOGE(TAG, "Illegal image_json_text for sys_image_rsp_buffer");
+	}
+	
+	return encP->length;
+}
+
+
+/**
+ * Setup a client to encode the chunks of a json image from the start of the frame
+ * (packed into 8-bit pixels for AGC8 images)
+ */
+static void start_json_chunks(rsp_client_t* c, rsp_image_t* imgP)
+{
+	c->json_len[0] = 0;
+	c->json_len[1] = 0;
+	c->json_cur = 0;
+	c->json_offset = 0;
+	c->json_src_len = (imgP->encoding == BIN_ENC_AGC8) ? LEP_NUM_PIXELS : LEP_NUM_PIXELS*2;
+	c->json_telem_mask = imgP->telem_mask;
+	c->json_tail_done = false;
+	c->json_enc_usec = 0;
+}
+
+
+/**
+ * Encode the next chunk of a client's json image from the frame into buf.  Chunks are
+ * the base64 encoded pixels followed by the end of the record (the telemetry and the
+ * stop delimitor).  Returns the chunk length, 0 when the record is complete.
+ */
+static uint32_t encode_json_chunk(rsp_client_t* c, lep_buffer_t* lep_bufP, char* buf)
+{
+	uint32_t len, n;
+	int64_t tb;
+	
+	tb = esp_timer_get_time();
+	
+	if (c->json_offset < c->json_src_len) {
+		n = c->json_src_len - c->json_offset;
+		if (n > RSP_JSON_CHUNK_SRC_LEN) n = RSP_JSON_CHUNK_SRC_LEN;
+		if (c->json_src_len == LEP_NUM_PIXELS) {
+			pack_agc8(lep_bufP->lep_bufferP + c->json_offset, agc8_chunk, n);
+			len = json_get_image_base64(buf, RSP_JSON_CHUNK_BUF_LEN, agc8_chunk, n);
+		} else {
+			len = json_get_image_base64(buf, RSP_JSON_CHUNK_BUF_LEN, (uint8_t*) lep_bufP->lep_bufferP + c->json_offset, n);
+		}
+		c->json_offset += n;
+	} else if (!c->json_tail_done) {
+		len = json_get_image_tail(buf, RSP_JSON_CHUNK_BUF_LEN - 1, lep_bufP, c->json_telem_mask);
+		if (len != 0) {
+			buf[len++] = CMD_JSON_STRING_STOP;
+		}
+		c->json_tail_done = true;
+	} else {
+		return 0;
+	}
+	
+	if (len == 0) {
+		ESP_LOGE(TAG, "Illegal json image chunk");
+		c->json_offset = c->json_src_len;
+		c->json_tail_done = true;
+	}
+	
+	c->json_enc_usec += esp_timer_get_time() - tb;
+	
+	return len;
+}
+
+
+/**
+ * Load a client's json chunk transmit item with the next chunk (already encoded into
+ * the spare buffer or encoded now).  Returns false when the image is complete.
+ */
+static bool next_json_chunk(rsp_client_t* c, rsp_tx_item_t* itemP)
+{
+	int next = c->json_cur ^ 1;
+	
+	c->json_len[c->json_cur] = 0;
+	if (c->json_len[next] == 0) {
+		c->json_len[next] = encode_json_chunk(c, c->imageP->lep_bufP, c->json_bufP[next]);
+	}
+	if (c->json_len[next] == 0) {
+		perf_record(PERF_STAGE_JSON_ENC, esp_timer_get_time() - c->json_enc_usec);
+		return false;
+	}
+	
+	c->json_cur = next;
+	itemP->bufP = c->json_bufP[next];
+	itemP->len = c->json_len[next];
+	c->tx_offset = 0;
+	
+	return true;
+}
+
+
+/**
+ * Encode the next chunk of the json image a client is sending into the spare buffer
+ * if it is empty
+ */
+static void prefetch_json_chunk(rsp_client_t* c)
+{
+	int i;
+	int next = c->json_cur ^ 1;
+	
+	for (i=0; i<c->tx_num; i++) {
+		if (c->tx_items[i].json_chunk) {
+			if (c->json_len[next] == 0) {
+				c->json_len[next] = encode_json_chunk(c, c->imageP->lep_bufP, c->json_bufP[next]);
+			}
+			return;
+		}
+	}
+}
+
+
+/**
+ * Queue the command response in a client's rsp_text for its transport.  WebSocket
+ * and REST clients are sent the json without the delimitors.
+ */
+static void queue_response(rsp_client_t* c, int len)
+{
+	int n;
+	
+	switch (c->transport) {
+		case RSP_TRANSPORT_WS:
+			n = ws_put_header(c->rsp_wrap, WS_OP_TEXT, len - 2);
+			push_tx(c, (char*) c->rsp_wrap, n, false);
+			push_tx(c, c->rsp_text + 1, len - 2, false);
+			break;
+		
+		case RSP_TRANSPORT_REST:
+			n = http_get_response_header((char*) c->rsp_wrap, 200, "application/json", len - 2);
+			push_tx(c, (char*) c->rsp_wrap, n, false);
+			push_tx(c, c->rsp_text + 1, len - 2, false);
+			break;
+		
+		case RSP_TRANSPORT_MJPEG:
+			// Nothing but images can be sent in the stream
+			return;
+		
+		default:
+			push_tx(c, c->rsp_text, len, false);
+	}
+	
+	c->rsp_busy = true;
+}
+
+
+/**
+ * Add the WebSocket frame header for a binary message of len bytes to a WebSocket
+ * client's transmit queue.  The message's parts follow.
+ */
+static void push_ws_header(rsp_client_t* c, uint8_t* buf, uint32_t len)
+{
+	if (c->transport == RSP_TRANSPORT_WS) {
+		push_tx(c, (char*) buf, ws_put_header(buf, WS_OP_BIN, len), false);
+	}
+}
+
+
+/**
+ * Add data to a client's transmit queue
+ */
+static void push_tx(rsp_client_t* c, char* buf, uint32_t len, bool img_end)
+{
+	if (c->tx_num < RSP_MAX_TX_ITEMS) {
+		c->tx_items[c->tx_num].bufP = buf;
+		c->tx_items[c->tx_num].len = len;
+		c->tx_items[c->tx_num].img_end = img_end;
+		c->tx_items[c->tx_num].json_chunk = false;
+		c->tx_items[c->tx_num].seg_end = false;
+		c->tx_items[c->tx_num].pkt_end = false;
+		c->tx_items[c->tx_num].hist_end = false;
+		c->tx_num++;
+	} else {
+		ESP_LOGE(TAG, "Transmit queue full");
+	}
+}
+
+
+/**
+ * Remove the first item from a client's transmit queue
+ */
+static void pop_tx(rsp_client_t* c)
+{
+	int i;
+	
+	if (c->tx_items[0].img_end && (c->imageP != NULL)) {
+		if (c->tx_offset >= c->tx_items[0].len) {
+			perf_record(PERF_STAGE_SEND, c->image_queued_usec);
+			perf_count(PERF_CNT_IMAGES_SENT);
+			if (c->stream_on && (c->adapt_target_usec != 0)) {
+				update_adapt(c, esp_timer_get_time() - c->image_vsync_usec);
+			}
+			if (c->stream_on && c->stream_probe) {
+				send_probe(c, c->imageP, c->image_queued_usec);
+			}
+		}
+		release_image(c->imageP);
+		c->imageP = NULL;
+	} else if (c->tx_items[0].seg_end && (c->segP != NULL)) {
+		if (c->tx_offset >= c->tx_items[0].len) {
+			perf_record(PERF_STAGE_SEG_SEND, c->segP->ready_usec);
+		}
+		frame_seg_release(c->segP);
+		c->segP = NULL;
+	} else if (c->tx_items[0].pkt_end && (c->pktP != NULL)) {
+		frame_pkt_release(c->pktP);
+		c->pktP = NULL;
+	} else if ((c->tx_items[0].bufP >= c->rsp_text) && (c->tx_items[0].bufP < (c->rsp_text + JSON_MAX_RSP_TEXT_LEN))) {
+		if (c->tx_offset >= c->tx_items[0].len) {
+			perf_record(PERF_STAGE_CMD_RSP, c->rsp_queued_usec);
+		}
+		c->rsp_busy = false;
+		
+		// A REST request is complete once its response has been sent (cmd_task sees
+		// the host close the connection)
+		if (c->transport == RSP_TRANSPORT_REST) {
+			shutdown(c->sock, SHUT_WR);
+		}
+	} else if (c->tx_items[0].bufP == (char*) c->rec_bufP) {
+		c->rec_busy = false;
+	} else if (c->tx_items[0].hist_end) {
+		c->hist_busy = false;
+	}
+	
+	for (i=1; i<c->tx_num; i++) {
+		c->tx_items[i-1] = c->tx_items[i];
+	}
+	c->tx_num--;
+	c->tx_offset = 0;
+}
+
+
+/**
+ * Discard everything in a client's transmit queue
+ */
+static void flush_tx(rsp_client_t* c)
+{
+	while (c->tx_num != 0) {
+		pop_tx(c);
 	}
-	xSemaphoreGive(sys_cmd_response_buffer.mutex);
+	if (c->imageP != NULL) {
+		release_image(c->imageP);
+		c->imageP = NULL;
+	}
+	if (c->segP != NULL) {
+		frame_seg_release(c->segP);
+		c->segP = NULL;
+	}
+	if (c->pktP != NULL) {
+		frame_pkt_release(c->pktP);
+		c->pktP = NULL;
+	}
+	c->rsp_busy = false;
+	c->rec_busy = false;
+	c->hist_busy = false;
+}
+
+
+/**
+ * Send data from a client's transmit queue until it is empty or the socket can't
+ * take any more without blocking.  Each send gathers up to RSP_MAX_TX_PKT_LEN bytes
+ * from as many items as it can (ending at a json chunk since its buffer is refilled
+ * once it has been sent) so an image's headers, pixels and telemetry reach lwIP in
+ * one call instead of one call, and trip into the tcpip task, per item.  A socket
+ * that takes nothing for RSP_SEND_STALL_MSEC is reported to cmd_task to be closed
+ * and the client's data is dropped until it is.
+ */
+static void send_client_data(rsp_client_t* c)
+{
+	int err;
+	int n;
+	uint32_t len, offset, total;
+	rsp_tx_item_t* itemP;
+	struct iovec iov[RSP_MAX_TX_ITEMS];
+	struct msghdr msg;
+	
+	if (c->tx_stalled) {
+		flush_tx(c);
+		return;
+	}
+	
+	while (c->tx_num != 0) {
+		total = 0;
+		offset = c->tx_offset;
+		for (n=0; (n < c->tx_num) && (total < RSP_MAX_TX_PKT_LEN); n++) {
+			itemP = &c->tx_items[n];
+			len = itemP->len - offset;
+			if (len > (RSP_MAX_TX_PKT_LEN - total)) len = RSP_MAX_TX_PKT_LEN - total;
+			iov[n].iov_base = itemP->bufP + offset;
+			iov[n].iov_len = len;
+			total += len;
+			offset = 0;
+			if (itemP->json_chunk) {
+				n++;
+				break;
+			}
+		}
+		
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = iov;
+		msg.msg_iovlen = n;
+		err = sendmsg(c->sock, &msg, MSG_DONTWAIT);
+		if (err < 0) {
+			if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+				// cmd_task will see the connection close
+				ESP_LOGE(TAG, "Error in socket send: errno %d", errno);
+				if (c->imageP != NULL) {
+					perf_count(PERF_CNT_SEND_FAIL);
+				}
+				flush_tx(c);
+			} else if (c->tx_stall_usec == 0) {
+				c->tx_stall_usec = esp_timer_get_time();
+			} else if ((esp_timer_get_time() - c->tx_stall_usec) >= (RSP_SEND_STALL_MSEC * 1000)) {
+				ESP_LOGE(TAG, "Client %d socket stalled", (int) (c - clients));
+				if (c->imageP != NULL) {
+					perf_count(PERF_CNT_SEND_FAIL);
+				}
+				flush_tx(c);
+				c->tx_stalled = true;
+				cmd_client_stalled((int) (c - clients));
+			}
+			break;
+		}
+		c->tx_stall_usec = 0;
+		
+		// Retire the items that were completely sent
+		total = err;
+		while (c->tx_num != 0) {
+			itemP = &c->tx_items[0];
+			len = itemP->len - c->tx_offset;
+			if (total < len) {
+				c->tx_offset += total;
+				break;
+			}
+			total -= len;
+			c->tx_offset = itemP->len;
+			if (itemP->json_chunk && next_json_chunk(c, itemP)) {
+				break;
+			}
+			pop_tx(c);
+		}
+	}
+}
+
+
+/**
+ * Check if there is a response from cmd_task to transmit to a client.  Only rsp_task
+ * removes responses so a non-zero length can't change to zero under us.
+ */
+static bool cmd_response_available(int client)
+{
+	return (sys_cmd_response_buffer[client].length != 0);
+}
+
+
+/**
+ * Load a client's rsp_text buffer with the oldest response and atomically update its
+ * command response buffer indicating we popped it.  Pushes only write the free part of
+ * the buffer so the response is copied without holding the mutex.
+ */
+static int get_cmd_response(int client)
+{
+	uint16_t len;
+	uint32_t index;
+	json_cmd_response_queue_t* q = &sys_cmd_response_buffer[client];
+	
+	index = copy_from_cmd_response_buffer(q, q->pop_index, &len, sizeof(len));
+	index = copy_from_cmd_response_buffer(q, index, &clients[client].rsp_queued_usec, sizeof(int64_t));
+	index = copy_from_cmd_response_buffer(q, index, clients[client].rsp_text, len);
+	
+	xSemaphoreTake(q->mutex, portMAX_DELAY);
+	q->pop_index = index;
+	q->length -= len + sizeof(len) + sizeof(int64_t);
+	xSemaphoreGive(q->mutex);
 	
 	return len;
 }
 
 
 /**
- * Pop a character from the command response buffer
+ * Copy data into or out of a command response buffer at index with at most two
+ * memcpys (where it wraps), returning the index following it
+ */
+static uint32_t copy_to_cmd_response_buffer(json_cmd_response_queue_t* q, uint32_t index, const void* src, uint32_t len)
+{
+	uint32_t n = CMD_RESPONSE_BUFFER_LEN - index;
+	
+	if (len < n) n = len;
+	memcpy(q->bufferP + index, src, n);
+	memcpy(q->bufferP, (const char*) src + n, len - n);
+	
+	index += len;
+	return (index >= CMD_RESPONSE_BUFFER_LEN) ? index - CMD_RESPONSE_BUFFER_LEN : index;
+}
+
+
+static uint32_t copy_from_cmd_response_buffer(json_cmd_response_queue_t* q, uint32_t index, void* dst, uint32_t len)
+{
+	uint32_t n = CMD_RESPONSE_BUFFER_LEN - index;
+	
+	if (len < n) n = len;
+	memcpy(dst, q->bufferP + index, n);
+	memcpy((char*) dst + n, q->bufferP, len - n);
+	
+	index += len;
+	return (index >= CMD_RESPONSE_BUFFER_LEN) ? index - CMD_RESPONSE_BUFFER_LEN : index;
+}
+
+
+/**
+ * Discard any unsent responses for a client
+ */
+static void flush_cmd_response_buffer(int client)
+{
+	json_cmd_response_queue_t* q = &sys_cmd_response_buffer[client];
+	
+	xSemaphoreTake(q->mutex, portMAX_DELAY);
+	q->length = 0;
+	q->pop_index = q->push_index;
+	xSemaphoreGive(q->mutex);
+}
+
+
+/**
+ * Load a client's recording data buffer with the header and the requested part of
+ * the recording or event log.  Returns the length of the data in the buffer.
+ */
+static int get_record_data(rsp_client_t* c)
+{
+	uint8_t* p = c->rec_bufP;
+	uint32_t len;
+	
+	if (c->rec_log) {
+		len = evlog_read(c->rec_offset, c->rec_bufP + RSP_REC_CHUNK_HEADER_LEN, c->rec_length);
+	} else {
+		len = rec_read(c->rec_offset, c->rec_bufP + RSP_REC_CHUNK_HEADER_LEN, c->rec_length);
+	}
+	
+	*p++ = c->rec_log ? RSP_LOG_CHUNK_START : RSP_REC_CHUNK_START;
+	*p++ = RSP_REC_CHUNK_VERSION;
+	p = put_u16(p, RSP_REC_CHUNK_HEADER_LEN);
+	p = put_u16(p, c->rec_offset & 0xFFFF);
+	p = put_u16(p, c->rec_offset >> 16);
+	p = put_u16(p, len & 0xFFFF);
+	(void) put_u16(p, len >> 16);
+	
+	return RSP_REC_CHUNK_HEADER_LEN + len;
+}
+
+
+/**
+ * Hold the records in the history ring for a client and tell it how many binary
+ * images follow.  Clients that can only receive JPEG images or one response don't get
+ * history dumps.
+ */
+static void start_history(int client)
+{
+	rsp_client_t* c = &clients[client];
+	hist_dump_t dump;
+	uint32_t len;
+	
+	if ((c->transport == RSP_TRANSPORT_MJPEG) || (c->transport == RSP_TRANSPORT_REST)) return;
+	
+	if (!hist_hold(&dump)) {
+		dump.num = 0;
+		dump.length = 0;
+	}
+	len = json_get_history_dump(hist_text, sizeof(hist_text), dump.num, dump.length);
+	if (len != 0) {
+		rsp_push_response(client, hist_text, len);
+	}
+	
+	if (dump.num != 0) {
+		c->hist_on = true;
+		c->hist_busy = false;
+		c->hist_burst = false;
+		c->hist_next = dump.first;
+		c->hist_end = dump.first + dump.num;
+	}
+}
+
+
+/**
+ * Tell a client about the burst it captured and send it the way a history dump is
+ * sent.  No history dump can be in progress (a burst can't start during one and they
+ * can't start during a burst).
+ */
+static void start_burst(int client)
+{
+	rsp_client_t* c = &clients[client];
+	hist_burst_t burst;
+	uint32_t len;
+	
+	if (!hist_get_burst(&burst)) return;
+	
+	if ((c->transport == RSP_TRANSPORT_MJPEG) || (c->transport == RSP_TRANSPORT_REST) || c->hist_on) {
+		hist_end_burst();
+		return;
+	}
+	
+	len = json_get_burst_dump(hist_text, sizeof(hist_text), burst.dump.num, burst.dump.length, burst.missed,
+	                          burst.complete);
+	if (len != 0) {
+		rsp_push_response(client, hist_text, len);
+	}
+	
+	c->hist_on = true;
+	c->hist_busy = false;
+	c->hist_burst = true;
+	c->hist_next = burst.dump.first;
+	c->hist_end = burst.dump.first + burst.dump.num;
+}
+
+
+/**
+ * Release the records of a client's history or burst dump
+ */
+static void end_dump(rsp_client_t* c)
+{
+	if (c->hist_burst) {
+		hist_end_burst();
+	} else {
+		hist_release();
+	}
+	c->hist_on = false;
+	c->hist_burst = false;
+}
+
+
+/**
+ * Queue a client's next history record or finish its dump
+ */
+static void queue_history(rsp_client_t* c)
+{
+	uint8_t* bufP;
+	uint32_t len;
+	
+	// Wait for room for the record and its WebSocket header
+	if (c->tx_num > (RSP_MAX_TX_ITEMS - 2)) return;
+	
+	if ((c->hist_next != c->hist_end) && hist_get_record(c->hist_next, &bufP, &len)) {
+		push_ws_header(c, c->hist_wrap, len);
+		push_tx(c, (char*) bufP, len, false);
+		c->tx_items[c->tx_num - 1].hist_end = true;
+		c->hist_busy = true;
+		c->hist_next++;
+	} else {
+		end_dump(c);
+	}
+}
+
+
+/**
+ * Select the WiFi power save mode for the current activity.  With no clients the
+ * station sleeps between several beacons (a new connection may take up to a second).
+ * A slow stream sleeps the same way between images and uses the normal mode from
+ * RSP_PS_WAKE_USEC before an image until it has been sent.  Faster streams, other
+ * transmissions and connected clients that aren't streaming use the normal mode, or
+ * no power save for fast streams in the streaming profile.  Streams aren't fast while
+ * the Lepton is powered down between interval captures.
  */
-static char pop_cmd_response_buffer()
+static void update_power_save()
 {
-	char c;
+	bool awake = false;
+	bool connected = false;
+	bool fast = false;
+	int i;
+	int64_t t = esp_timer_get_time();
+	lep_interval_t lep_interval;
+	rsp_client_t* c;
 	
-	c = *sys_cmd_response_buffer.popP;
+	lep_get_interval_capture(&lep_interval);
 	
-	if (++sys_cmd_response_buffer.popP >= (sys_cmd_response_buffer.bufferP + CMD_RESPONSE_BUFFER_LEN)) {
-		sys_cmd_response_buffer.popP = sys_cmd_response_buffer.bufferP;
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		c = &clients[i];
+		if (!c->connected) continue;
+		connected = true;
+		if (c->tx_num != 0) {
+			awake = true;
+		}
+		if (!c->stream_on) {
+			awake = true;
+		} else if ((get_frame_delay(c) < RSP_PS_SLOW_STREAM_USEC) && !lep_interval.power_down) {
+			fast = true;
+		} else if (c->image_pending || (t >= (c->stream_ready_usec - RSP_PS_WAKE_USEC))) {
+			awake = true;
+		}
 	}
 	
-	return c;
+	if (fast) {
+#ifdef CONFIG_TCAM_STREAM_WIFI_PS_NONE
+		wifi_set_power_save(WIFI_PS_NONE);
+#else
+		wifi_set_power_save(WIFI_PS_MIN_MODEM);
+#endif
+	} else if (connected && awake) {
+		wifi_set_power_save(WIFI_PS_MIN_MODEM);
+	} else {
+		wifi_set_power_save(WIFI_PS_MAX_MODEM);
+	}
 }
 
 
+/**
+ * Returns true when nothing will be sent to the clients for WIFI_BG_SCAN_SLOT_USEC so
+ * a background WiFi scan can leave the AP's channel without delaying an image.  A
+ * stream's next image goes with the first frame after its stream_ready_usec so it
+ * isn't sent before the later of the two (the next frame is expected a frame period
+ * after the last one).  Low latency and raw streams send too often to leave a gap.
+ */
+static bool scan_gap()
+{
+	int i;
+	int64_t t = esp_timer_get_time();
+	int64_t slot_end_usec = t + WIFI_BG_SCAN_SLOT_USEC;
+	int64_t next_frame_usec = last_frame_usec + (LEP_INTERVAL_FRAME_MSEC * 1000);
+	rsp_client_t* c;
+	
+	for (i=0; i<CMD_MAX_CLIENTS; i++) {
+		c = &clients[i];
+		if (!c->connected) continue;
+		if (c->tx_num != 0) return false;
+		if (c->stream_on) {
+			if (c->stream_seg || c->stream_raw) return false;
+			if ((c->stream_ready_usec < slot_end_usec) && (next_frame_usec < slot_end_usec)) return false;
+		} else if (c->image_pending && (next_frame_usec < slot_end_usec)) {
+			return false;
+		}
+	}
+	
+	return true;
+}
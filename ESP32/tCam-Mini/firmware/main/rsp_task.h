@@ -26,6 +26,7 @@
 #ifndef RSP_TASK_H
 #define RSP_TASK_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 
@@ -33,24 +34,274 @@
 // RSP Task Constants
 //
 
-// Task evaluation interval
-#define RSP_TASK_EVAL_NORM_MSEC 50
-#define RSP_TASK_EVAL_FAST_MSEC 20
+// Maximum time to block waiting for an event before re-evaluating state
+#define RSP_TASK_MAX_WAIT_MSEC 1000
 
-// Maximum send packet size (less than a MTU)
-#define RSP_MAX_TX_PKT_LEN 1280
+// Maximum time to block waiting for a client socket to accept more data before
+// re-evaluating state
+#define RSP_TX_WAIT_MSEC 10
+
+// A client whose socket takes nothing for this long while data is waiting to be sent
+// is closed (its peer is gone but TCP would keep retransmitting for minutes).  Longer
+// than CMD_WIFI_LOST_MSEC so connections still ride out a short WiFi drop.
+#define RSP_SEND_STALL_MSEC 8000
+
+// WiFi power save (client mode).  Streams with at least RSP_PS_SLOW_STREAM_USEC
+// between images let the station sleep for several beacon intervals between images
+// and it is woken RSP_PS_WAKE_USEC ahead of each image.
+#define RSP_PS_SLOW_STREAM_USEC 2000000
+#define RSP_PS_WAKE_USEC        300000
+
+// Maximum data handed to a single sendmsg() - the socket send buffer size since a
+// non-blocking send only takes what fits in the buffer
+#define RSP_MAX_TX_PKT_LEN CONFIG_LWIP_TCP_SND_BUF_DEFAULT
+
+// Maximum queued transmissions per client (a response, recording data, a history
+// record and the parts of an image or segment, each with a WebSocket or HTTP header)
+#define RSP_MAX_TX_ITEMS 12
+
+// Json images are base64 encoded from the frame and sent a chunk at a time from one of
+// two per-client chunk buffers so the next chunk can be encoded while the previous one
+// is sent.  Chunks are 12 lines of pixels (a multiple of 3 bytes so the base64 text of
+// the chunks joins into one string).  The chunk buffer also holds the end of the record
+// (the telemetry and the stop delimitor).
+#define RSP_JSON_CHUNK_SRC_LEN (12 * 160 * 2)
+#define RSP_JSON_CHUNK_BUF_LEN ((RSP_JSON_CHUNK_SRC_LEN / 3) * 4 + 1)
+
+// Maximum image data per UDP stream datagram
+#define RSP_MAX_UDP_DATA_LEN 1280
+
+// UDP stream datagram header (all multi-byte values little-endian)
+//    0     : RSP_UDP_PKT_START
+//    1     : RSP_UDP_PKT_VERSION
+//    2 -  3: Frame number (increments with each image sent to the client)
+//    4 -  5: Packet index (0 - count-1)
+//    6 -  7: Packet count for the frame
+//    8 - 11: Offset of this packet's data in the image
+// The image is the same byte stream sent over TCP (json or binary format) and is
+// complete when all packets for a frame number have been received.
+#define RSP_UDP_PKT_START   0x04
+#define RSP_UDP_PKT_VERSION 1
+#define RSP_UDP_HEADER_LEN  12
+
+// RTP/JPEG UDP streams (stream_on rtp) send JPEG preview images as RFC 2435 payloads
+// (type 0, Q = JPEG_DEF_QUALITY) with a 90 kHz timestamp taken when the image is sent.
+// The first packet of each image carries an RFC 8285 one-byte header extension with
+// the radiometric scaling of the image (all values big-endian):
+//    ID 1 (8 bytes): uint16_t lo, hi raw values mapped to palette index 0 and 255,
+//                    uint16_t min, max raw image values
+//    ID 2 (2 bytes): uint16_t radiometric resolution (raw value * res = K * 100, 0 if
+//                    the image isn't radiometric)
+#define RSP_RTP_VERSION       2
+#define RSP_RTP_PT_JPEG       26
+#define RSP_RTP_CLOCK_HZ      90000
+#define RSP_RTP_HEADER_LEN    12
+#define RSP_RTP_JPEG_HDR_LEN  8
+#define RSP_RTP_EXT_LEN       16
+#define RSP_RTP_EXT_ID_RANGE  1
+#define RSP_RTP_EXT_ID_RES    2
+
+// Recording data response header to the get_record command (all multi-byte values
+// little-endian)
+//    0     : RSP_REC_CHUNK_START
+//    1     : RSP_REC_CHUNK_VERSION
+//    2 -  3: Header length (RSP_REC_CHUNK_HEADER_LEN)
+//    4 -  7: Offset of the data in the recording
+//    8 - 11: Data length (0 at or past the end of the recording)
+#define RSP_REC_CHUNK_START      0x05
+#define RSP_REC_CHUNK_VERSION    1
+#define RSP_REC_CHUNK_HEADER_LEN 12
+
+// Event log data response to the get_log command.  The same header as the recording
+// data response with RSP_LOG_CHUNK_START, the offset and length are in the event log
+// partition (see evlog_utilities.h).
+#define RSP_LOG_CHUNK_START      0x09
+
+// Low latency stream segment header (all multi-byte values little-endian)
+//    0     : RSP_SEG_START
+//    1     : RSP_SEG_VERSION
+//    2 -  3: Header length (RSP_SEG_HEADER_LEN)
+//    4 -  7: Frame number (the same for each segment of a frame)
+//    8     : Segment (1-4)
+//    9     : Reserved (0)
+//   10 - 11: Offset of the segment's first pixel in the image
+//   12 - 13: Number of pixels following the header
+//   14 - 15: Length of the binary image header following the pixels (last segment)
+//   16 - 17: Length of the telemetry following the binary image header
+// The binary image header sent with the last segment describes the complete raw image
+// so the binary image header, the pixels of the four segments and the telemetry join
+// into a binary image.
+#define RSP_SEG_START      0x07
+#define RSP_SEG_VERSION    1
+#define RSP_SEG_HEADER_LEN 18
+
+// Raw (passthrough) stream packet batch header (all multi-byte values little-endian)
+//    0     : RSP_PKT_START
+//    1     : RSP_PKT_VERSION
+//    2 -  3: Header length (RSP_PKT_HEADER_LEN)
+//    4 -  7: Number of the first packet (counts every non-discard packet read so a gap
+//            shows packets that were dropped)
+//    8     : Lepton (0 - LEP_NUM_LEPTONS-1)
+//    9     : Number of packets following the header
+//   10 - 11: Packet length (LEP_PKT_LENGTH)
+//   12 - 15: Low 32 bits of the ESP32 uSec time the first packet was read
+// The packets follow exactly as read from the Lepton (big-endian ID, CRC and payload,
+// discard packets left out) for a host-side segment assembler.
+#define RSP_PKT_START      0x08
+#define RSP_PKT_VERSION    1
+#define RSP_PKT_HEADER_LEN 16
+
+// Image formats (selected per connection with set_image_format)
+#define RSP_IMG_FMT_JSON 0
+#define RSP_IMG_FMT_BIN  1
+#define RSP_IMG_FMT_BIN_RICE 2
+#define RSP_IMG_FMT_PNG  3
+#define RSP_IMG_FMT_JPEG 4
+#define RSP_IMG_FMT_SPARSE 5
+
+// Client transports (the command port or one of the HTTP endpoints, see http_utilities.h)
+#define RSP_TRANSPORT_SOCKET 0     // Delimited json responses and binary data
+#define RSP_TRANSPORT_WS     1     // WebSocket text responses and binary messages
+#define RSP_TRANSPORT_MJPEG  2     // Multipart stream of JPEG images only
+#define RSP_TRANSPORT_REST   3     // One json response then the connection is closed
+
+// Client command events (rsp_cmd_event_t event)
+#define RSP_EVT_CONNECT       0
+#define RSP_EVT_DISCONNECT    1
+#define RSP_EVT_GET_IMG       2
+#define RSP_EVT_STREAM_ON     3
+#define RSP_EVT_STREAM_OFF    4
+#define RSP_EVT_STREAM_RESYNC 5
+#define RSP_EVT_SET_IMG_FMT   6
+#define RSP_EVT_GET_RECORD    7
+#define RSP_EVT_STREAM_TRIG   8
+#define RSP_EVT_STREAM_ADAPT  9
+#define RSP_EVT_DUMP_HIST     10
+#define RSP_EVT_SET_LEPTON    11
+#define RSP_EVT_GET_LOG       12
+#define RSP_EVT_DUMP_BURST    13
+
+// Change triggered streams compare the means of RSP_TRIG_BLOCKS_X x RSP_TRIG_BLOCKS_Y
+// blocks of RSP_TRIG_BLOCK_SIZE x RSP_TRIG_BLOCK_SIZE pixels with the blocks of the last
+// image sent to the client
+#define RSP_TRIG_BLOCK_SIZE   8
+#define RSP_TRIG_BLOCKS_X     20
+#define RSP_TRIG_BLOCKS_Y     15
+#define RSP_TRIG_NUM_BLOCKS   (RSP_TRIG_BLOCKS_X * RSP_TRIG_BLOCKS_Y)
+
+// Change triggered stream defaults
+#define RSP_TRIG_DEF_BLOCKS        1
+#define RSP_TRIG_DEF_HOLD_MSEC     2000
+#define RSP_TRIG_DEF_HEARTBEAT_MSEC 10000
+
+// Adaptive TCP streams (stream_on adapt) measure each image's latency from the frame's
+// vsync until its last byte has been handed to the socket.  While the smoothed latency
+// is over the target the stream steps down one level each RSP_ADAPT_SETTLE_IMAGES
+// images and it steps back up after RSP_ADAPT_UP_MSEC below RSP_ADAPT_UP_PCT of the
+// target.  The levels compress raw binary images first, then double the binning of
+// binary images (up to 4) and finally send images at most every RSP_ADAPT_BASE_DELAY_USEC
+// doubling up to RSP_ADAPT_RATE_STEPS times.
+#define RSP_ADAPT_SETTLE_IMAGES    3
+#define RSP_ADAPT_UP_MSEC          3000
+#define RSP_ADAPT_UP_PCT           50
+#define RSP_ADAPT_BASE_DELAY_USEC  222222
+#define RSP_ADAPT_RATE_STEPS       4
+#define RSP_ADAPT_MAX_TARGET_MSEC  10000
+
+// Synchronized streams (stream_on sync) send the frame whose vsync is nearest each tick,
+// a multiple of the stream's delay in uSec since 1970, so cameras with SNTP synchronized
+// clocks send frames captured at about the same time tagged with the same tick.  A frame
+// is nearest its tick when it is within half the interval between frames, measured from
+// each Lepton's frames (RSP_SYNC_DEF_FRAME_USEC until two have been seen).
+#define RSP_SYNC_DEF_FRAME_USEC    111111
+
+// Streams with a latency probe (set_stream_on probe) follow each image with a latency
+// record of up to RSP_PROBE_TEXT_LEN bytes once its last byte has been taken by the socket
+#define RSP_PROBE_TEXT_LEN         192
+
+// Averaged single images (get_image average) sum up to RSP_MAX_AVG_FRAMES consecutive
+// frames, skipping frames taken during a FFC, and send the mean of each pixel.  Averaging
+// N frames reduces the noise by sqrt(N) so radiometric images (json, binary and
+// compressed binary formats with 16-bit pixels) keep half a bit of the mean's fraction
+// for each doubling of N, up to RSP_AVG_MAX_FRAC_BITS, as long as the image fits in
+// 16-bit pixels.  The image's metadata has the number of frames and fractional bits.
+// Clients are served one at a time.
+#define RSP_MAX_AVG_FRAMES     64
+#define RSP_AVG_MAX_FRAC_BITS  3
 
 // Response Task notifications
-#define RSP_NOTIFY_CMD_GET_IMG_MASK    0x00000001
-#define RSP_NOTIFY_CMD_STREAM_ON_MASK  0x00000002
-#define RSP_NOTIFY_CMD_STREAM_OFF_MASK 0x00000004
-#define RSP_NOTIFY_LEP_FRAME_MASK_0    0x00000010
-#define RSP_NOTIFY_LEP_FRAME_MASK_1    0x00000020
+#define RSP_NOTIFY_LEP_FRAME_MASK      0x00000010
+#define RSP_NOTIFY_CMD_EVENT_MASK      0x00000020
+#define RSP_NOTIFY_CMD_RESPONSE_MASK   0x00000040
+#define RSP_NOTIFY_LEP_SEGMENT_MASK    0x00000080
+#define RSP_NOTIFY_LEP2_FRAME_MASK     0x00000100
+#define RSP_NOTIFY_LEP_PACKETS_MASK    0x00000200
+
+
+//
+// RSP Task typedefs
+//
+
+// Change triggered stream.  Images are only sent while the scene is changing (at the
+// stream's delay_msec rate) and as heartbeats.  A stream becomes active when at least
+// min_blocks block means differ from the last image sent by threshold and stays active
+// until hold_ms have passed without min_blocks differing by threshold / 2.
+typedef struct {
+	uint16_t threshold;          // Block mean difference (pixel counts), 0 = disabled
+	uint16_t min_blocks;         // Blocks that must differ
+	uint32_t hold_ms;            // Time to stay active after the last change
+	uint32_t heartbeat_ms;       // Maximum time between images, 0 = none
+} rsp_trigger_t;
+
+// Adaptive stream controller state of a client for get_status (target_ms is 0 when the
+// client doesn't have an adaptive stream)
+typedef struct {
+	uint32_t target_ms;          // Latency target
+	uint32_t latency_ms;         // Smoothed latency of the images sent
+	int level;                   // Current level (0 = the stream as requested)
+	int max_level;
+	bool compress;               // Raw binary images are being compressed
+	int bin;                     // Binning factor of binary images
+	uint32_t delay_ms;           // Minimum time between images (0 = none)
+} rsp_adapt_status_t;
+
+// Transmit queue depths of a client for status metrics
+typedef struct {
+	int tx_items;                // Transmissions queued for the socket (of RSP_MAX_TX_ITEMS)
+	uint32_t rsp_bytes;          // Command response bytes waiting to be sent
+} rsp_queue_status_t;
+
+// Latency record of an image sent to a client with a latency probe.  The durations are
+// measured from the frame's vsync (except encode_usec).
+typedef struct {
+	uint32_t seq;                // Frame's capture sequence number (the image's Seq)
+	uint64_t timestamp;          // Frame's vsync (the image's Timestamp)
+	uint32_t capture_usec;       // Frame read from the Lepton
+	uint32_t encode_usec;        // Time spent encoding the image
+	uint32_t send_start_usec;    // Image queued for the client
+	uint32_t send_end_usec;      // Last byte taken by the socket
+} rsp_latency_t;
+
+
 
 //
 // RSP Task API
 //
 void rsp_task();
-void rsp_set_stream_parameters(uint32_t delay_ms, uint32_t num_frames);
+void rsp_client_connected(int client, int sock, int transport);
+void rsp_client_disconnected(int client);
+void rsp_get_image(int client, uint32_t avg_frames, uint32_t max_age_ms);
+void rsp_stream_on(int client, uint32_t delay_ms, uint32_t num_frames, uint32_t key_interval, uint16_t udp_port, uint32_t udp_addr, uint16_t* roi, int bin, bool segments, bool raw, bool rtp, bool probe, bool sync, bool cmd_priority, const rsp_trigger_t* trig, uint32_t adapt_ms);
+void rsp_stream_off(int client);
+void rsp_stream_resync(int client);
+void rsp_set_image_format(int client, int format, int palette, uint16_t lo, uint16_t hi, bool agc8, uint8_t telem_mask, bool hist, uint16_t threshold);
+void rsp_dump_history(int client);
+void rsp_dump_burst(int client);
+void rsp_set_lepton(int client, int lepton);
+void rsp_get_record(int client, uint32_t offset, uint32_t length);
+void rsp_get_log(int client, uint32_t offset, uint32_t length);
+void rsp_push_response(int client, char* buf, uint32_t len);
+void rsp_get_adapt_status(int client, rsp_adapt_status_t* s);
+void rsp_get_queue_status(int client, rsp_queue_status_t* s);
 
 #endif /* RSP_TASK_H */
\ No newline at end of file
@@ -0,0 +1,470 @@
+/*
+ * Serial Bridge Task
+ *
+ * Bridge a host on the USB serial port to the command port (see ser_task.h).  The UART
+ * driver's ring buffers and interrupt driven FIFO transfers move the data so this task
+ * only encodes and decodes packets: data read from the loopback connection is sent in
+ * DATA packets (blocking while the transmit buffer is full, which backs the connection,
+ * and so rsp_task, up to the serial port's rate) and DATA packets from the host are
+ * written to the connection.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "ser_task.h"
+#include "system_config.h"
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include <string.h>
+
+
+// The gateway firmware's gw_task owns the serial port
+#ifndef CONFIG_TCAM_ESPNOW_GATEWAY
+
+//
+// SER Task variables
+//
+static const char* TAG = "ser_task";
+
+static bool session_open = false;
+static int ser_sock = -1;
+static uint8_t tx_seq;
+static uint8_t rx_seq;
+static int64_t last_rx_usec;
+
+static uint16_t crc_table[256];
+
+// Encoded packet being received (up to its delimiter)
+static uint8_t rx_enc[SER_MAX_ENC_LEN];
+static int rx_enc_len = 0;
+static bool rx_overflow = false;
+
+static uint8_t rx_read_buf[256];
+static uint8_t rx_pkt[SER_MAX_PKT_LEN];
+static uint8_t tx_pkt[SER_MAX_PKT_LEN];
+static uint8_t tx_enc[SER_MAX_ENC_LEN];
+
+
+
+//
+// SER Task Forward Declarations for internal functions
+//
+static bool init_bridge();
+static void service_uart(TickType_t wait);
+static void service_connection();
+static void handle_packet(int len);
+static void open_session(uint32_t baud);
+static void end_session(bool notify);
+static int open_connection();
+static bool write_connection(const uint8_t* data, int len);
+static void send_delimiter();
+static void send_packet(uint8_t type, uint8_t seq, int len);
+static uint16_t crc16(const uint8_t* data, int len);
+static int cobs_encode(const uint8_t* src, int len, uint8_t* dst);
+static int cobs_decode(const uint8_t* src, int len, uint8_t* dst, int max_len);
+
+
+
+//
+// SER Task API
+//
+void ser_task()
+{
+	ESP_LOGI(TAG, "Start task");
+
+	if (!init_bridge()) {
+		ESP_LOGE(TAG, "Serial bridge init failed");
+		while (1) {vTaskDelay(pdMS_TO_TICKS(100));}
+	}
+
+	while (1) {
+		if (session_open) {
+			service_connection();
+			service_uart(0);
+			if (session_open && ((esp_timer_get_time() - last_rx_usec) > (SER_IDLE_MSEC * 1000))) {
+				end_session(false);
+			}
+		} else {
+			// Only an OPEN is looked for between sessions
+			service_uart(pdMS_TO_TICKS(100));
+		}
+	}
+}
+
+
+
+//
+// SER Task internal functions
+//
+
+/**
+ * Build the CRC table and install the serial port driver.  Packets are written by
+ * the driver so they aren't changed by the console's line ending conversion.
+ */
+static bool init_bridge()
+{
+	esp_err_t ret;
+	uint16_t crc;
+	int i, j;
+
+	for (i=0; i<256; i++) {
+		crc = i << 8;
+		for (j=0; j<8; j++) {
+			crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+		}
+		crc_table[i] = crc;
+	}
+
+	ret = uart_driver_install(UART_NUM_0, SER_RX_BUF_LEN, SER_TX_BUF_LEN, 0, NULL, 0);
+	if (ret != ESP_OK) {
+		ESP_LOGE(TAG, "uart_driver_install failed (%d)", ret);
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+ * Read what the host has sent, waiting up to wait ticks for it, and handle each
+ * complete packet.  An encoded packet too long to be valid is dropped at its delimiter.
+ */
+static void service_uart(TickType_t wait)
+{
+	int i, n, len;
+
+	n = uart_read_bytes(UART_NUM_0, rx_read_buf, sizeof(rx_read_buf), wait);
+	for (i=0; i<n; i++) {
+		if (rx_read_buf[i] == 0) {
+			if (!rx_overflow && (rx_enc_len != 0)) {
+				len = cobs_decode(rx_enc, rx_enc_len, rx_pkt, sizeof(rx_pkt));
+				handle_packet(len);
+			}
+			rx_enc_len = 0;
+			rx_overflow = false;
+		} else if (rx_enc_len < SER_MAX_ENC_LEN) {
+			rx_enc[rx_enc_len++] = rx_read_buf[i];
+		} else {
+			rx_overflow = true;
+		}
+	}
+}
+
+
+/**
+ * Wait up to SER_POLL_MSEC for data from the command port and send what has arrived
+ * to the host
+ */
+static void service_connection()
+{
+	fd_set rx_fds;
+	struct timeval tv;
+	int n;
+
+	FD_ZERO(&rx_fds);
+	FD_SET(ser_sock, &rx_fds);
+	tv.tv_sec = 0;
+	tv.tv_usec = SER_POLL_MSEC * 1000;
+	if (select(ser_sock + 1, &rx_fds, NULL, NULL, &tv) <= 0) return;
+
+	n = recv(ser_sock, &tx_pkt[2], SER_MAX_PAYLOAD, MSG_DONTWAIT);
+	if (n > 0) {
+		send_packet(SER_PKT_DATA, tx_seq++, n);
+	} else if ((n == 0) || ((errno != EAGAIN) && (errno != EWOULDBLOCK))) {
+		ESP_LOGI(TAG, "Connection closed");
+		end_session(true);
+	}
+}
+
+
+/**
+ * Handle a decoded packet from the host (len < 0 if it didn't decode)
+ */
+static void handle_packet(int len)
+{
+	uint16_t crc;
+	uint32_t baud;
+	int n;
+
+	// Garbage between sessions (for example a host at the wrong rate) is ignored
+	if (len >= SER_PKT_OVERHEAD) {
+		crc = rx_pkt[len-2] | (rx_pkt[len-1] << 8);
+		if (crc != crc16(rx_pkt, len - 2)) len = -1;
+	}
+	if (len < SER_PKT_OVERHEAD) {
+		if (session_open) send_packet(SER_PKT_ERROR, 0, 0);
+		return;
+	}
+	n = len - SER_PKT_OVERHEAD;
+
+	if (rx_pkt[0] == SER_PKT_OPEN) {
+		if (n == 4) {
+			baud = rx_pkt[2] | (rx_pkt[3] << 8) | (rx_pkt[4] << 16) | (rx_pkt[5] << 24);
+			open_session(baud);
+		}
+		return;
+	}
+	if (!session_open) return;
+	last_rx_usec = esp_timer_get_time();
+
+	switch (rx_pkt[0]) {
+		case SER_PKT_DATA:
+			if (rx_pkt[1] != rx_seq) {
+				send_packet(SER_PKT_ERROR, 0, 0);
+			} else {
+				rx_seq++;
+				if (!write_connection(&rx_pkt[2], n)) {
+					end_session(true);
+				}
+			}
+			break;
+
+		case SER_PKT_CLOSE:
+			end_session(false);
+			break;
+
+		default:
+			// PING
+			break;
+	}
+}
+
+
+/**
+ * Open a session or restart the open one on a new connection.  OPENED is sent at the
+ * current rate, then the port switches to the session's rate.
+ */
+static void open_session(uint32_t baud)
+{
+	if ((baud < SER_MIN_BAUD) || (baud > SER_MAX_BAUD)) {
+		send_packet(SER_PKT_ERROR, 0, 0);
+		return;
+	}
+
+	if (ser_sock >= 0) {
+		shutdown(ser_sock, 0);
+		close(ser_sock);
+	}
+	ser_sock = open_connection();
+	if (ser_sock < 0) {
+		send_packet(SER_PKT_ERROR, 0, 0);
+		if (session_open) end_session(false);
+		return;
+	}
+
+	if (!session_open) {
+		ESP_LOGI(TAG, "Session open at %u baud", baud);
+		esp_log_level_set("*", ESP_LOG_NONE);
+	}
+	tx_seq = 0;
+	rx_seq = 0;
+	tx_pkt[2] = baud & 0xFF;
+	tx_pkt[3] = (baud >> 8) & 0xFF;
+	tx_pkt[4] = (baud >> 16) & 0xFF;
+	tx_pkt[5] = (baud >> 24) & 0xFF;
+	send_delimiter();
+	send_packet(SER_PKT_OPENED, 0, 4);
+	(void) uart_wait_tx_done(UART_NUM_0, pdMS_TO_TICKS(100));
+	(void) uart_set_baudrate(UART_NUM_0, baud);
+
+	session_open = true;
+	last_rx_usec = esp_timer_get_time();
+}
+
+
+/**
+ * Close the connection and go back to the console rate and logging
+ */
+static void end_session(bool notify)
+{
+	if (notify) send_packet(SER_PKT_CLOSE, 0, 0);
+	(void) uart_wait_tx_done(UART_NUM_0, pdMS_TO_TICKS(100));
+
+	if (ser_sock >= 0) {
+		shutdown(ser_sock, 0);
+		close(ser_sock);
+		ser_sock = -1;
+	}
+	session_open = false;
+
+	(void) uart_set_baudrate(UART_NUM_0, SER_CONSOLE_BAUD);
+	esp_log_level_set("*", CONFIG_LOG_DEFAULT_LEVEL);
+	ESP_LOGI(TAG, "Session closed");
+}
+
+
+/**
+ * Connect to the command port over the loopback interface.  Returns the socket or -1.
+ */
+static int open_connection()
+{
+	struct sockaddr_in addr;
+	int sock;
+
+	sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+	if (sock < 0) {
+		ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+		return -1;
+	}
+
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(CMD_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (connect(sock, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+		ESP_LOGE(TAG, "Unable to connect to the command port: errno %d", errno);
+		close(sock);
+		return -1;
+	}
+
+	return sock;
+}
+
+
+/**
+ * Write host data to the command port.  Returns false if the connection failed.
+ */
+static bool write_connection(const uint8_t* data, int len)
+{
+	int n;
+
+	while (len > 0) {
+		n = send(ser_sock, data, len, 0);
+		if (n < 0) {
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+				vTaskDelay(pdMS_TO_TICKS(1));
+				continue;
+			}
+			return false;
+		}
+		data += n;
+		len -= n;
+	}
+
+	return true;
+}
+
+
+/**
+ * Send a packet delimiter by itself to end whatever came before (log messages at the
+ * console rate)
+ */
+static void send_delimiter()
+{
+	const char delim = 0;
+
+	(void) uart_write_bytes(UART_NUM_0, &delim, 1);
+}
+
+
+/**
+ * Add the header and CRC to the len byte payload in tx_pkt and queue the encoded
+ * packet for transmission (waiting for room in the transmit buffer)
+ */
+static void send_packet(uint8_t type, uint8_t seq, int len)
+{
+	uint16_t crc;
+	int n;
+
+	tx_pkt[0] = type;
+	tx_pkt[1] = seq;
+	crc = crc16(tx_pkt, len + 2);
+	tx_pkt[len+2] = crc & 0xFF;
+	tx_pkt[len+3] = crc >> 8;
+
+	n = cobs_encode(tx_pkt, len + SER_PKT_OVERHEAD, tx_enc);
+	tx_enc[n++] = 0;
+	(void) uart_write_bytes(UART_NUM_0, (const char*) tx_enc, n);
+}
+
+
+/**
+ * CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF)
+ */
+static uint16_t crc16(const uint8_t* data, int len)
+{
+	uint16_t crc = 0xFFFF;
+
+	while (len--) {
+		crc = (crc << 8) ^ crc_table[(crc >> 8) ^ *data++];
+	}
+
+	return crc;
+}
+
+
+/**
+ * COBS encode len bytes.  Returns the encoded length (without a delimiter).
+ */
+static int cobs_encode(const uint8_t* src, int len, uint8_t* dst)
+{
+	int i;
+	int code_pos = 0;
+	int n = 1;
+	uint8_t code = 1;
+
+	for (i=0; i<len; i++) {
+		if (src[i] == 0) {
+			dst[code_pos] = code;
+			code_pos = n++;
+			code = 1;
+		} else {
+			dst[n++] = src[i];
+			if (++code == 0xFF) {
+				dst[code_pos] = code;
+				code_pos = n++;
+				code = 1;
+			}
+		}
+	}
+	dst[code_pos] = code;
+
+	return n;
+}
+
+
+/**
+ * COBS decode len bytes (without the delimiter).  Returns the decoded length or -1 if
+ * the data isn't valid or decodes to more than max_len bytes.
+ */
+static int cobs_decode(const uint8_t* src, int len, uint8_t* dst, int max_len)
+{
+	int i;
+	int n = 0;
+	uint8_t code;
+
+	while (len > 0) {
+		code = *src++;
+		len--;
+		if ((code == 0) || ((code - 1) > len) || ((n + code) > max_len)) return -1;
+		for (i=1; i<code; i++) {
+			dst[n++] = *src++;
+		}
+		len -= code - 1;
+		if ((code != 0xFF) && (len > 0)) {
+			dst[n++] = 0;
+		}
+	}
+
+	return n;
+}
+
+#endif /* !CONFIG_TCAM_ESPNOW_GATEWAY */
@@ -0,0 +1,103 @@
+/*
+ * Serial Bridge Task
+ *
+ * Wired connection over the USB serial port.  A host opens a session by sending a
+ * SER_PKT_OPEN packet at the console baud rate with the rate it wants (up to
+ * SER_MAX_BAUD).  The bridge connects to the command port over the loopback interface
+ * so the session is an ordinary client: the same commands and responses (including
+ * binary images) as a socket connection, carried in SER_PKT_DATA packets.  Logging is
+ * turned off while a session is open so the serial port only carries packets.  The
+ * session ends when the host sends SER_PKT_CLOSE or nothing for SER_IDLE_MSEC and the
+ * port goes back to the console baud rate.
+ *
+ * Packets are COBS encoded and end with a 0x00 delimiter so the receiver finds the
+ * start of the next packet after an error.  Before encoding a packet is
+ *   0      Type (SER_PKT_xxx)
+ *   1      Sequence number (DATA packets, counting up from 0 in each direction after
+ *          OPEN, 0 in the other types)
+ *   2...   Payload (n bytes, up to SER_MAX_PAYLOAD)
+ *   2+n    CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of bytes 0 to 1+n,
+ *          little-endian
+ * A packet with a bad CRC or a sequence number gap means data was lost.  The bridge
+ * answers one from the host with SER_PKT_ERROR.  The host restarts the session with
+ * another OPEN (at the session's rate), which replaces the loopback connection
+ * so the host's parser starts over on a fresh connection.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef SER_TASK_H
+#define SER_TASK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+//
+// SER Task Constants
+//
+
+// Session baud rates.  OPEN is sent at the console rate.  The USB serial bridge chip
+// limits the rate to 3 Mbaud (about 300 kB/sec: a full rate stream of compressed
+// binary images but not of raw ones).
+#define SER_CONSOLE_BAUD  115200
+#define SER_MIN_BAUD      115200
+#define SER_MAX_BAUD      3000000
+
+// Close the session after this long without a packet from the host (the host sends
+// SER_PKT_PING when it has nothing else to send)
+#define SER_IDLE_MSEC     5000
+
+// Time the bridge waits for data from the connection or the host each pass
+#define SER_POLL_MSEC     5
+
+// Driver ring buffer sizes (the transmit buffer is where images wait while they are
+// shifted out)
+#define SER_RX_BUF_LEN    2048
+#define SER_TX_BUF_LEN    16384
+
+// Packet types
+//   OPEN     Host: payload baud rate (uint32_t, little-endian).  Opens or restarts the
+//            session.  Answered with OPENED at the current rate before the bridge switches.
+//   OPENED   Bridge: payload baud rate
+//   DATA     Both: command port data
+//   PING     Host: keeps the session open
+//   CLOSE    Both: end the session (bridge: the connection was closed)
+//   ERROR    Bridge: a packet from the host was lost (or OPEN failed)
+#define SER_PKT_OPEN      1
+#define SER_PKT_OPENED    2
+#define SER_PKT_DATA      3
+#define SER_PKT_PING      4
+#define SER_PKT_CLOSE     5
+#define SER_PKT_ERROR     6
+
+#define SER_MAX_PAYLOAD   1024
+#define SER_PKT_OVERHEAD  4
+#define SER_MAX_PKT_LEN   (SER_MAX_PAYLOAD + SER_PKT_OVERHEAD)
+
+// Encoded length: one COBS code byte for each 254 bytes plus the delimiter
+#define SER_MAX_ENC_LEN   (SER_MAX_PKT_LEN + (SER_MAX_PKT_LEN / 254) + 2)
+
+
+
+//
+// SER Task API
+//
+void ser_task();
+
+#endif /* SER_TASK_H */
@@ -31,7 +31,8 @@
 // System debug
 //
 
-// Undefine to include the system monitoring task (included only for debugging/tuning)
+// Undefine to include the system monitoring log output (included only for debugging/tuning).
+// The monitoring task always runs so its profiler can be enabled with get_sys_stats.
 //#define INCLUDE_SYS_MON
 
 
@@ -57,6 +58,15 @@
 #define I2C_MASTER_SDA_IO 23
 #define I2C_MASTER_SCL_IO 22
 
+// Second Lepton (CONFIG_TCAM_DUAL_LEPTON) on VSPI and the second I2C port.  It shares
+// LEP_RESET_IO.
+#define LEP2_SCK_IO       18
+#define LEP2_CSN_IO       25
+#define LEP2_VSYNC_IO     35
+#define LEP2_MISO_IO      34
+#define LEP2_I2C_SDA_IO   26
+#define LEP2_I2C_SCL_IO   27
+
 
 
 
@@ -67,13 +77,54 @@
 // I2C
 #define I2C_MASTER_NUM     1
 #define I2C_MASTER_FREQ_HZ 100000
+#define LEP2_I2C_NUM       0
+
+// Number of Leptons.  A second Lepton's segments are read by lep_task on the same core
+// in the order the vsyncs arrive so both run at the Lepton's maximum SPI clock to fit
+// two segment reads in one segment period.  Both Leptons have the same I2C address so
+// the second one's CCI is on its own port, only used to enable its vsync output.  It
+// otherwise runs with its power-on settings (AGC off, no telemetry).
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+#define LEP_NUM_LEPTONS 2
+#else
+#define LEP_NUM_LEPTONS 1
+#endif
 
 // SPI
 //   Lepton uses HSPI (no MOSI)
-//   LCD and TS use VSPI
+//   Second Lepton uses VSPI (no MOSI)
 #define LEP_SPI_HOST    HSPI_HOST
 #define LEP_DMA_NUM     2
+#define LEP2_SPI_HOST   VSPI_HOST
+#define LEP2_DMA_NUM    1
+#ifdef CONFIG_TCAM_DUAL_LEPTON
+#define LEP_SPI_FREQ_HZ 20000000
+#else
 #define LEP_SPI_FREQ_HZ 16000000
+#endif
+
+// SPI clock calibration (see lep_calibrate_spi).  The rates tried are the APB clock
+// divided by 8 down to 4 (the Lepton is specified to 20 MHz).  Each is measured for
+// LEP_SPI_CAL_MSEC after the link has run at it for LEP_SPI_CAL_SETTLE_MSEC.  A
+// calibrated rate stored in NVS replaces LEP_SPI_FREQ_HZ.
+#define LEP_SPI_CAL_STEPS       {10000000, 11428571, 13333333, 16000000, 20000000}
+#define LEP_SPI_CAL_SETTLE_MSEC 1000
+#define LEP_SPI_CAL_MSEC        10000
+
+// Maximum number of VoSPI packets read in one SPI DMA transaction once a segment
+// has been found (packets are searched for one at a time until the first valid
+// packet is seen).  Set to LEP_TEL_PKTS_PER_SEG (61) to read the remainder of a
+// segment at once or 1 for the original packet-at-a-time capture.
+#define LEP_SPI_BURST_PKTS 61
+
+// Comment out to skip checking the CRC of each VoSPI packet.  A packet with a bad
+// CRC restarts frame acquisition so a corrupted frame is never sent.
+#define LEP_CHECK_CRC
+
+// Comment out to have the Lepton send telemetry as a footer (end of segment 4)
+// instead of a header (start of segment 1).  As a header the telemetry for a frame
+// is available as soon as its first segment has been read.
+#define LEP_TELEM_HEADER
 
 
 
@@ -86,6 +137,118 @@
 #define CAMERA_MODEL_NUM 2
 
 
+// Task placement: core, priority and stack size (bytes) of each task.  lep_task has
+// core 1 to itself (except for enc_task, which only runs while lep_task waits for the
+// next segment) so it never misses a segment.  Everything else shares core 0 with the
+// WiFi and lwIP tasks.
+#define TASK_CTRL_CORE     0
+#define TASK_CTRL_PRIO     1
+#define TASK_CTRL_STACK    2048
+#define TASK_CMD_CORE      0
+#define TASK_CMD_PRIO      1
+#define TASK_CMD_STACK     3072
+#define TASK_RSP_CORE      0
+#define TASK_RSP_PRIO      2
+#define TASK_RSP_STACK     3072
+#define TASK_REC_CORE      0
+#define TASK_REC_PRIO      1
+#define TASK_REC_STACK     3072
+#define TASK_ANA_CORE      0
+#define TASK_ANA_PRIO      1
+#define TASK_ANA_STACK     2048
+#define TASK_HIST_CORE     0
+#define TASK_HIST_PRIO     1
+#define TASK_HIST_STACK    2048
+#define TASK_HIST_BURST_PRIO 3       // While capturing a burst (above rsp_task)
+#define TASK_NOW_CORE      0
+#define TASK_NOW_PRIO      1
+#define TASK_NOW_STACK     2048
+#define TASK_GW_CORE       0
+#define TASK_GW_PRIO       2
+#define TASK_GW_STACK      3072
+#define TASK_SER_CORE      0
+#define TASK_SER_PRIO      2
+#define TASK_SER_STACK     3072
+#define TASK_MON_CORE      0
+#define TASK_MON_PRIO      1
+#define TASK_MON_STACK     2048
+#define TASK_LEP_CORE      1
+#define TASK_LEP_PRIO      19
+#define TASK_LEP_STACK     2048
+#define TASK_ENC_CORE      1
+#define TASK_ENC_PRIO      (TASK_LEP_PRIO - 1)
+#define TASK_ENC_STACK     2048
+
+// Comment out to encode compressed images entirely in rsp_task.  When defined
+// enc_task encodes the second half of each image on the other core at the same time.
+// The low memory build doesn't send compressed images.
+#ifndef CONFIG_TCAM_NO_PSRAM
+#define RSP_PARALLEL_ENCODE
+#endif
+
+
+// Maximum number of simultaneously connected clients (the low memory build without
+// PSRAM has room for one)
+#ifdef CONFIG_TCAM_NO_PSRAM
+#define CMD_MAX_CLIENTS 1
+#else
+#define CMD_MAX_CLIENTS 3
+#endif
+
+// Comment out to refuse a new connection when every client slot is in use.  When
+// defined the newest connection wins: it takes over the client that has gone longest
+// without sending anything (so a client whose peer vanished doesn't lock others out).
+#define CMD_CLIENT_TAKEOVER
+
+// Number of client command events that can be queued for rsp_task
+#define RSP_EVENT_QUEUE_LEN 16
+
+
+// Number of lepton frame buffers managed by the frame broker.  One is being loaded
+// by lep_task, one may be held by rsp_task for each client sending a raw binary
+// or json image, one is being handed out to clients, one may be held by rec_task while it
+// is recorded, one may be held by ana_task while it is analyzed, one may be held by
+// hist_task while it is stored, one may be held by now_task while it is compressed and
+// the remainder hold completed frames.  Add one for each additional frame subscriber
+// that holds frames.  A second Lepton has a buffer being loaded and its newest frame.
+//
+// The low memory build only has the buffer being loaded and the newest frame (lep_task
+// drops the frames it loads, reloading its buffer, while a subscriber holds the newest
+// frame) and every buffer is in internal DRAM.
+#ifdef CONFIG_TCAM_NO_PSRAM
+#define LEP_FRAME_POOL_SIZE (2*LEP_NUM_LEPTONS)
+#else
+#define LEP_FRAME_POOL_SIZE (CMD_MAX_CLIENTS + 6 + 2*(LEP_NUM_LEPTONS - 1))
+#endif
+
+// Number of frame buffers placed in internal DRAM (if there is room).  lep_task loads
+// these first so the frame being captured and the newest frame, which is the one being
+// encoded, are usually read from internal memory instead of the slower PSRAM.
+#ifdef CONFIG_TCAM_NO_PSRAM
+#define LEP_FRAME_POOL_INTERNAL LEP_FRAME_POOL_SIZE
+#else
+#define LEP_FRAME_POOL_INTERNAL 2
+#endif
+
+// Number of segment buffers for low latency (segment) streams.  Each client holds at
+// most one while it is sent and the remainder hold segments waiting for rsp_task.
+#ifdef CONFIG_TCAM_NO_PSRAM
+#define LEP_SEG_POOL_SIZE (CMD_MAX_CLIENTS + 1)
+#else
+#define LEP_SEG_POOL_SIZE (CMD_MAX_CLIENTS + 5)
+#endif
+
+// Raw packet batches for passthrough (raw) streams.  Each batch holds up to
+// LEP_PKT_BATCH_PKTS packets (so a batch and its header fit in one UDP stream datagram)
+// and the pool buffers the packets of a few segments while rsp_task sends them.
+#define LEP_PKT_BATCH_PKTS 7
+#ifdef CONFIG_TCAM_NO_PSRAM
+#define LEP_PKT_POOL_SIZE  4
+#else
+#define LEP_PKT_POOL_SIZE  32
+#endif
+
+
 // Image (Lepton + Telemetry + Metadata) json object text size
 // Based on the following items:
 //   1. Base64 encoded Lepton image size: (160x120x2)*4 / 3
@@ -95,21 +258,57 @@
 // Manually calculate this and round to 4-byte boundary
 #define JSON_MAX_IMAGE_TEXT_LEN (1024 * 54)
 
+// Cached image json object metadata text size (fixed items: camera name, model, version)
+#define JSON_MAX_IMAGE_META_PREFIX_LEN 256
+
 // Max command response json object text size
 #define JSON_MAX_RSP_TEXT_LEN   1024
 
-// Command Response Buffer Size (large enough for several responses)
+// Command Response Buffer Size per client (large enough for several responses)
+#ifdef CONFIG_TCAM_NO_PSRAM
+#define CMD_RESPONSE_BUFFER_LEN (JSON_MAX_RSP_TEXT_LEN * 2)
+#else
 #define CMD_RESPONSE_BUFFER_LEN (JSON_MAX_RSP_TEXT_LEN * 4)
+#endif
+
+// Encoded image buffer size per client.  Compressed images are never larger than the
+// raw image and json images only hold their metadata in it.  The low memory build only
+// sends json and raw binary images, which are encoded from the frame as they are sent.
+#ifdef CONFIG_TCAM_NO_PSRAM
+#define RSP_IMAGE_ENC_LEN       (JSON_MAX_IMAGE_META_PREFIX_LEN + 3840)
+#else
+#define RSP_IMAGE_ENC_LEN       (LEP_NUM_PIXELS * 2)
+#endif
 
-// Maximum incoming command json string length (large enough for longest command)
-#define JSON_MAX_CMD_TEXT_LEN   256
+// Maximum incoming command json string length (large enough for longest command,
+// set_analytics with polygon regions)
+//  Commands are assembled per client as they are received so this is also the
+//  receive buffer
+#define JSON_MAX_CMD_TEXT_LEN   2048
 
-// Maximum TCP/IP Socket receiver buffer
-//  This should be large enough for the maximum number of command received at a time
-//  (probably 2 is ok)
-#define CMD_MAX_TCP_RX_BUFFER_LEN 1024
+// cJSON arena holding the parsed command object and response tree while one command
+// is processed (each item takes 40 bytes plus its name and string value, about six
+// bytes for every byte of typical json text).  Larger trees use the heap.
+//  The low memory build's arena holds typical commands and larger ones use the heap.
+#ifdef CONFIG_TCAM_NO_PSRAM
+#define JSON_ARENA_LEN          ((JSON_MAX_CMD_TEXT_LEN + JSON_MAX_RSP_TEXT_LEN) * 3)
+#else
+#define JSON_ARENA_LEN          ((JSON_MAX_CMD_TEXT_LEN + JSON_MAX_RSP_TEXT_LEN) * 6)
+#endif
 
 // TCP/IP listening port
 #define CMD_PORT 5001
 
+// HTTP listening port (mjpeg, WebSocket and REST endpoints)
+#define HTTP_PORT 80
+
+// Maximum recording data sent in response to one get_record command
+#define RSP_MAX_REC_CHUNK_LEN 4096
+
+// Minimum time between the flash sectors of a network firmware update (POST /ota).
+// Each sector erase stalls the other tasks for tens of mSec so this is the rate image
+// capture is interrupted at while an update is received (a 1 MB image takes about a
+// minute).
+#define OTA_SECTOR_MSEC 250
+
 #endif // SYSTEM_CONFIG_H
\ No newline at end of file
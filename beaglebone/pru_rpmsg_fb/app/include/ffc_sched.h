@@ -0,0 +1,67 @@
+#ifndef FFC_SCHED_H
+#define FFC_SCHED_H
+
+#include "cci.h"
+#include "vospi.h"
+#include <signal.h>
+#include <stdint.h>
+
+// Smart FFC scheduler.  The Lepton is switched to manual FFC and a FFC is run when
+// the FPA temperature has drifted since the last one (or the Lepton reports it wants
+// one), but only once the scene has been still for a while so the image freezes when
+// nothing is happening.  A FFC that can't find a still scene is forced after a
+// maximum wait and the application can approve one at any time.  It needs the frame
+// telemetry (VOSPI_TELEM) and runs in the thread consuming frames.
+
+#ifdef VOSPI_TELEM
+
+// Default settings
+#define FFC_SCHED_DEF_DRIFT_K100    150     // FPA drift making a FFC due (K * 100)
+#define FFC_SCHED_DEF_MOTION        50      // Block mean change that is motion
+#define FFC_SCHED_DEF_QUIET_MSEC    2000    // Still time before a due FFC runs
+#define FFC_SCHED_DEF_MIN_MSEC      60000   // Minimum time between FFCs
+#define FFC_SCHED_DEF_MAX_WAIT_MSEC 600000  // Time before a due FFC is forced (0: never)
+
+// Time after commanding a FFC before the telemetry reflects it
+#define FFC_SCHED_WAIT_MSEC         2500
+
+// Motion is detected from the means of FFC_SCHED_BLOCK_SIZE square pixel blocks
+#define FFC_SCHED_BLOCK_SIZE        8
+#define FFC_SCHED_BLOCKS_X          (160 / FFC_SCHED_BLOCK_SIZE)
+#define FFC_SCHED_BLOCKS_Y          (120 / FFC_SCHED_BLOCK_SIZE)
+#define FFC_SCHED_NUM_BLOCKS        (FFC_SCHED_BLOCKS_X * FFC_SCHED_BLOCKS_Y)
+
+typedef struct {
+	uint32_t drift_k100;
+	uint32_t motion;
+	uint32_t quiet_msec;
+	uint32_t min_msec;
+	uint32_t max_wait_msec;
+} ffc_sched_config_t;
+
+typedef struct {
+	ffc_sched_config_t config;
+	int fd;                          // CCI
+	uint16_t saved_mode[CCI_FFC_SHUTTER_MODE_WORDS];  // Restored by ffc_sched_stop()
+	volatile sig_atomic_t approved;  // Set by ffc_sched_approve()
+	int64_t due_usec;                // When the pending FFC became due (0: none)
+	int64_t still_usec;              // When the scene last moved
+	int64_t run_usec;                // When the last FFC was commanded
+	int ref_valid;
+	uint16_t ref[FFC_SCHED_NUM_BLOCKS];  // Block means when the scene last moved
+	uint32_t num_quiet;              // FFCs run in a still scene
+	uint32_t num_forced;             // FFCs forced after max_wait_msec
+	uint32_t num_approved;           // FFCs run by ffc_sched_approve()
+} ffc_sched_t;
+
+
+
+void ffc_sched_default_config(ffc_sched_config_t* config);
+int ffc_sched_start(ffc_sched_t* sched, ffc_sched_config_t* config, char* i2c_dev);
+void ffc_sched_frame(ffc_sched_t* sched, vospi_frame_t* frame);
+void ffc_sched_approve(ffc_sched_t* sched);
+void ffc_sched_stop(ffc_sched_t* sched);
+
+#endif /* VOSPI_TELEM */
+
+#endif /* FFC_SCHED_H */
@@ -0,0 +1,50 @@
+#ifndef MCSPI_H
+#define MCSPI_H
+
+#include "vospi.h"
+#include <stdint.h>
+
+// Hardware SPI (McSPI through spidev) Lepton interface used instead of the PRUs.  The
+// omap2_mcspi driver uses EDMA for transfers so each segment is read with a few large
+// transfers scheduled by the Lepton VSYNC output instead of a bit-banged PRU SPI.
+// Frames are stored in the same vospi_frame_t layout the PRUs produce so all the
+// vospi frame utilities work with them.
+
+// SPI clock rate (the Lepton supports up to 20 MHz)
+#define MCSPI_SPEED_HZ        20000000
+
+// Lepton VoSPI packet
+#define MCSPI_PKT_LEN         164
+#define MCSPI_PKT_DATA_LEN    160
+
+// Packets per segment (telemetry adds a packet to each segment)
+#if defined(VOSPI_TELEM_HEADER) || defined(VOSPI_TELEM_FOOTER)
+#define MCSPI_SEG_PKTS        61
+#else
+#define MCSPI_SEG_PKTS        60
+#endif
+#define MCSPI_TELEM_PKTS      4
+#define MCSPI_NUM_SEGS        4
+#define MCSPI_FRAME_PKTS      (VOSPI_FRAME_BYTES / VOSPI_PKT_NUM_BYTES)
+
+// Maximum packets read by one spidev transfer (must fit in the spidev bufsiz which
+// defaults to 4096 bytes)
+#define MCSPI_XFER_PKTS       20
+
+// Maximum discard packets read after VSYNC looking for the first packet of a segment
+#define MCSPI_MAX_DISCARDS    8
+
+// Maximum time to wait for VSYNC
+#define MCSPI_VSYNC_TO_MSEC   100
+
+// Number of consecutive bad segments before resynchronizing with the Lepton by idling
+// the interface (CS de-asserted) for MCSPI_RESYNC_MSEC
+#define MCSPI_RESYNC_SEGS     12
+#define MCSPI_RESYNC_MSEC     185
+
+
+
+int mcspi_init(char* spi_dev, int vsync_gpio);
+int mcspi_transfer_frame(vospi_frame_t* frame);
+
+#endif /* MCSPI_H */
@@ -0,0 +1,44 @@
+#ifndef PRU_STATS_H
+#define PRU_STATS_H
+
+#include <stdint.h>
+
+// PRU health counters.  Both PRUs keep free-running counts of what happens during
+// capture in the PRU shared RAM (cleared when each PRU boots).  They are read from
+// /dev/mem (so the reader must run as root) without disturbing the PRUs or the
+// application using them.
+
+// PRU-ICSS shared RAM physical address and the counters' offset in it.  This must
+// match SMEM_STATS_OFFSET in the firmware's pru_common.h.
+#define PRU_STATS_SMEM_PA     0x4A310000
+#define PRU_STATS_SMEM_LEN    0x3000
+#define PRU_STATS_OFFSET      28
+#define PRU_STATS_MAGIC       0x4C455053
+
+// Counters - must match smem_stats_t in the firmware's pru_common.h
+typedef struct {
+	uint32_t magic;
+	uint32_t p0_discard_pkts;  // Discard packets from the Lepton
+	uint32_t p0_crc_fails;     // Packets with a bad CRC
+	uint32_t p0_restarts;      // Capture restarts after an unexpected packet (or bad CRC)
+	uint32_t p0_resyncs;       // Lepton resyncs
+	uint32_t p0_frames;        // Frames captured by PRU0
+	uint32_t p1_aborts;        // Frames aborted by PRU0
+	uint32_t p1_timing_fails;  // Frames aborted for a message under/overrun
+	uint32_t p1_send_fails;    // Failed rpmsg sends
+	uint32_t p1_frames;        // Frames sent to the host
+} pru_stats_t;
+
+typedef struct {
+	void* map;
+	volatile pru_stats_t* stats;
+} pru_stats_reader_t;
+
+
+
+int pru_stats_open(pru_stats_reader_t* reader);
+void pru_stats_close(pru_stats_reader_t* reader);
+void pru_stats_read(pru_stats_reader_t* reader, pru_stats_t* stats);
+int pru_stats_write_textfile(const char* path, pru_stats_t* stats);
+
+#endif /* PRU_STATS_H */
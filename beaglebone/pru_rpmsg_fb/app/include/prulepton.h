@@ -0,0 +1,83 @@
+#ifndef PRULEPTON_H
+#define PRULEPTON_H
+
+#include "frame_ring.h"
+#include "vospi.h"
+#include <pthread.h>
+#include <stdint.h>
+
+// PRU Lepton frame access.  Configures the Lepton through CCI, runs the PRUs and
+// transfers frames into a frame ring from its own capture thread (optionally a
+// SCHED_FIFO thread pinned to a CPU).  Applications either take frames with a frame
+// ready callback (prulepton_run()) or wait on the handle's file descriptor with
+// poll/select/epoll and take them with prulepton_get_frame() without blocking.
+// Frames are processed in place in the ring and must be released when done.
+// With VOSPI_DUAL_LEPTON there is no PRU device: each handle captures the Lepton on
+// one PRU (config.pru) and several handles can run at once.
+//
+// A transfer that fails outright (the device read failed, the PRUs couldn't sync or
+// a PRU was disabled) doesn't stop capture.  The capture thread recovers in place,
+// escalating with each failure until a frame arrives, so consumers and their sockets
+// stay attached:
+//   resync  Disable the PRUs for PRULEPTON_RESYNC_MSEC (longer than the Lepton's 185
+//           mSec resync time) and enable them again, PRULEPTON_RESYNC_TRIES times
+//   reboot  Reboot the Lepton through CCI (config.i2c_dev), configure it again with
+//           prulepton_init_lepton() and enable the PRUs, PRULEPTON_REBOOT_TRIES times
+// Capture only stops (with error set) once these have failed.
+
+// Default devices
+#define PRULEPTON_I2C_DEV "/dev/i2c-2"
+#define PRULEPTON_PRU_DEV "/dev/rpmsg_pru31"
+
+// I2C device for the Lepton on PRU1 (VOSPI_DUAL_LEPTON)
+#define PRULEPTON_I2C_DEV_1 "/dev/i2c-1"
+
+// Recovery
+#define PRULEPTON_RESYNC_MSEC  250
+#define PRULEPTON_RESYNC_TRIES 3
+#define PRULEPTON_REBOOT_TRIES 2
+
+typedef struct {
+	char* pru_dev;
+	int rt_priority;     // SCHED_FIFO priority of the capture thread, 0 for SCHED_OTHER
+	int cpu;             // CPU the capture thread is pinned to, -1 for any
+	char* i2c_dev;       // Lepton CCI device for recovery reboots, NULL to only resync
+#ifdef VOSPI_DUAL_LEPTON
+	int pru;             // PRU capturing the Lepton (0 or 1)
+#endif
+} prulepton_config_t;
+
+typedef struct {
+	prulepton_config_t config;
+	frame_ring_t ring;
+	int pru_fd;
+#ifdef VOSPI_DUAL_LEPTON
+	vospi_pru_t pru;
+#endif
+	int event_fd;        // Readable when frames have been pushed into the ring
+	int running;         // Cleared when capture stops
+	int error;           // Set if capture stopped because the device failed
+	uint32_t recoveries; // Failed transfers recovered from (PRU restarts and reboots)
+	uint32_t reboots;    // Lepton reboots by recovery
+	int failures;        // Failed transfers since the last frame (the recovery level)
+	pthread_t capture_thread;
+} prulepton_t;
+
+// Frame ready callback.  The frame is valid until it is released (prulepton_run()
+// releases it after the callback returns if the callback did not).
+typedef void (*prulepton_frame_cb_t)(prulepton_t* lep, vospi_frame_t* frame, uint32_t seq, void* arg);
+
+
+
+int prulepton_open_cci(char* i2c_dev);
+int prulepton_init_lepton(char* i2c_dev);
+void prulepton_default_config(prulepton_config_t* config);
+int prulepton_start(prulepton_t* lep, prulepton_config_t* config);
+void prulepton_stop(prulepton_t* lep);
+int prulepton_get_fd(prulepton_t* lep);
+vospi_frame_t* prulepton_get_frame(prulepton_t* lep, uint32_t* seq);
+vospi_frame_t* prulepton_wait_frame(prulepton_t* lep, uint32_t* seq);
+int prulepton_release_frame(prulepton_t* lep, uint32_t seq);
+int prulepton_run(prulepton_t* lep, prulepton_frame_cb_t cb, void* arg);
+
+#endif /* PRULEPTON_H */
@@ -3,18 +3,161 @@
 
 #include <stdint.h>
 
+// Uncomment to receive full 16-bit Radiometric TLinear pixels (Kelvin * 100) instead
+// of 8-bit AGC pixels.  This must match the LEP_16BIT define both PRUs were built with.
+//#define VOSPI_16BIT
+
 // The size of a single VoSPI PRMsg 
+#ifdef VOSPI_16BIT
+#define VOSPI_PKT_NUM_BYTES   160
+#define VPSPI_MSG_NUM_PKTS    3
+#else
 #define VOSPI_PKT_NUM_BYTES   80
 #define VPSPI_MSG_NUM_PKTS    6
+#endif
 #define VOSPI_MSG_DATA_BYTES  (VOSPI_PKT_NUM_BYTES * VPSPI_MSG_NUM_PKTS)
 #define VOSPI_MSG_TOTAL_BYTES (VOSPI_MSG_DATA_BYTES + 1)
 
-// A single frame
+// A single frame (VOSPI_FRAME_LEN pixels of VOSPI_PIXEL_BYTES each)
 #define VOSPI_FRAME_LEN       (160 * 120)
-#define VOSPI_FRAME_NUM_MSGS  (VOSPI_FRAME_LEN / VOSPI_MSG_DATA_BYTES)
+#define VOSPI_PIXEL_BYTES     (VOSPI_PKT_NUM_BYTES / 80)
+#define VOSPI_FRAME_BYTES     (VOSPI_FRAME_LEN * VOSPI_PIXEL_BYTES)
+#define VOSPI_FRAME_NUM_MSGS  (VOSPI_FRAME_BYTES / VOSPI_MSG_DATA_BYTES)
+
+// Uncomment to receive the pixel statistics PRU1 computes for each frame in
+// VOSPI_STATS_NUM_MSGS extra messages following the image messages.  This must match
+// the FRAME_STATS define PRU1 was built with (not available with VOSPI_DDR_RING).
+//#define VOSPI_FRAME_STATS
+
+#define VOSPI_HIST_BINS       256
+#ifdef VOSPI_FRAME_STATS
+#define VOSPI_STATS_NUM_MSGS  2
+#else
+#define VOSPI_STATS_NUM_MSGS  0
+#endif
+
+// Lepton telemetry location (leave both undefined to disable telemetry).  This
+// must match the TELEM_HEADER/TELEM_FOOTER define both PRUs were built with.  The
+// image is the same with any setting.  With telemetry PRU1 sends rows A-C (16-bit
+// words, high byte first, whatever the pixel format) in a message following the
+// image messages (or after the image in each DDR ring frame).
+//#define VOSPI_TELEM_HEADER
+//#define VOSPI_TELEM_FOOTER
+
+#if defined(VOSPI_TELEM_HEADER) || defined(VOSPI_TELEM_FOOTER)
+#define VOSPI_TELEM
+#define VOSPI_TELEM_NUM_MSGS  1
+#else
+#define VOSPI_TELEM_NUM_MSGS  0
+#endif
+#define VOSPI_TELEM_BYTES     (VOSPI_TELEM_NUM_MSGS * VOSPI_MSG_DATA_BYTES)
+
+#define VOSPI_FRAME_TOTAL_MSGS (VOSPI_FRAME_NUM_MSGS + VOSPI_TELEM_NUM_MSGS + VOSPI_STATS_NUM_MSGS)
+
+// Telemetry words (numbered from the start of row A)
+#define VOSPI_TEL_TC_LOW      1      // Lepton uptime (mSec)
+#define VOSPI_TEL_TC_HIGH     2
+#define VOSPI_TEL_STATUS_LOW  3
+#define VOSPI_TEL_STATUS_HIGH 4
+#define VOSPI_TEL_FC_LOW      20     // Frame counter
+#define VOSPI_TEL_FC_HIGH     21
+#define VOSPI_TEL_FRAME_MEAN  22
+#define VOSPI_TEL_FPA_T_K100  24
+#define VOSPI_TEL_HSE_T_K100  26
+#define VOSPI_TEL_LAST_FFC_T  29     // FPA temperature at the last FFC (K * 100)
+#define VOSPI_TEL_LAST_TC_LOW 30     // Uptime at the last FFC (mSec)
+#define VOSPI_TEL_LAST_TC_HIGH 31
+
+// Telemetry status bits and FFC states
+#define VOSPI_STATUS_FFC_DESIRED 0x00000008
+#define VOSPI_STATUS_FFC_STATE   0x00000030
+#define VOSPI_STATUS_OT_IMM      0x00100000
+#define VOSPI_FFC_STATE_IDLE     0x00000000
+#define VOSPI_FFC_STATE_IMM      0x00000010
+#define VOSPI_FFC_STATE_RUN      0x00000020
+#define VOSPI_FFC_STATE_CMPL     0x00000030
 
-// Abort message seq num
+// Abort message seq num and reasons (in data[0])
 #define VOSPI_ABORT_MSG       0xFF
+#define VOSPI_ABORT_PKT       0      // PRU0 received a bad packet
+#define VOSPI_ABORT_UNDERRUN  1      // PRU1 sending faster than PRU0 stores packets
+#define VOSPI_ABORT_OVERRUN   2      // PRU1 sending too slowly, PRU0 overwrote data
+
+// PRU timing command (VOSPI_TIMING_CMD followed by the PRU0 packet sample period and
+// the PRU1 message period in uSec as 16-bit little endian values, a value outside its
+// range selects the firmware default).  This must match HOST_CMD_TIMING in the
+// firmware's pru_common.h.  It is sent while acquisition is stopped.
+#define VOSPI_TIMING_CMD      'T'
+#define VOSPI_TIMING_CMD_LEN  5
+#define VOSPI_SAMPLE_USEC_MIN 100
+#define VOSPI_SAMPLE_USEC_MAX 157
+#define VOSPI_SAMPLE_USEC_DEF 128
+#define VOSPI_XMIT_USEC_MIN   200
+#define VOSPI_XMIT_USEC_MAX   2000
+#ifdef VOSPI_16BIT
+#define VOSPI_XMIT_USEC_DEF   480
+#else
+#define VOSPI_XMIT_USEC_DEF   1024
+#endif
+
+// PRU timing the applications set before starting acquisition (0 for the firmware
+// defaults).  Use calibrate_timing to find the tightest stable timing for a board.
+#define VOSPI_SAMPLE_USEC     0
+#define VOSPI_XMIT_USEC       0
+
+// Uncomment to receive complete frames through a ring in a DDR carve-out (mapped from
+// /dev/mem) instead of rpmsg data messages.  PRU1 then only sends a short rpmsg
+// notification for each frame.  This must match the DDR_RING define PRU1 was built with.
+//#define VOSPI_DDR_RING
+
+// Uncomment to capture two Leptons, one with each PRU.  Each PRU captures complete frames
+// into its own DDR ring which is found and polled through the PRU shared RAM (mapped from
+// /dev/mem) with the vospi_pru_xxx functions instead of through rpmsg.  This must match
+// the DUAL_LEPTON define the firmware was built with.  Implies VOSPI_DDR_RING.
+//#define VOSPI_DUAL_LEPTON
+
+#if defined(VOSPI_DUAL_LEPTON) && !defined(VOSPI_DDR_RING)
+#define VOSPI_DDR_RING
+#endif
+
+// DDR ring message types (seq followed by a 32-bit little endian value in data[0-3])
+#define VOSPI_RING_INFO_MSG   0xFE   // Carve-out physical address
+#define VOSPI_RING_FRAME_MSG  0xFD   // Ring head after a frame was written (and with
+                                     // VOSPI_FRAME_TIMESTAMP the timestamp in data[4-11])
+
+// DDR ring carve-out layout (frames, each the image followed by any telemetry, follow
+// the header)
+#define VOSPI_RING_MAGIC      0x4C455052
+#define VOSPI_RING_LEN        0x40000
+#define VOSPI_RING_HDR_LEN    64
+#define VOSPI_RING_FRAME_BYTES (VOSPI_FRAME_BYTES + VOSPI_TELEM_BYTES)
+
+// Dual Lepton PRU control blocks in the PRU-ICSS shared RAM (one for each PRU).  This
+// must match the SMEM_LEP_xxx layout in the firmware's pru_common.h.
+#define VOSPI_PRU_SMEM_PA     0x4A310000
+#define VOSPI_PRU_SMEM_LEN    0x3000
+#define VOSPI_PRU_CTRL_OFFSET(pru) (68 + (pru) * 64)
+#define VOSPI_PRU_MAGIC       0x4C45504C
+#define VOSPI_PRU_CLK_PER_USEC 200
+#define VOSPI_NUM_PRUS        2
+
+// How often the ring head is checked for a new frame, how long a PRU may take to set
+// up its ring once enabled and how long it may take to see it was disabled (it can be
+// busy resyncing the Lepton)
+#define VOSPI_PRU_POLL_USEC   2000
+#define VOSPI_PRU_START_MSEC  500
+#define VOSPI_PRU_STOP_USEC   250000
+
+// Uncomment to time each frame's capture.  PRU0 latches its IEP timer when it sees the
+// start of segment 1 and PRU1 sends it with the frame along with its age (nSec) in a
+// VOSPI_TS_MSG message following the frame (or in the DDR ring notification).  The
+// frame's timestamp_usec is the CLOCK_MONOTONIC time the message arrived minus the age.
+// This must match the FRAME_TIMESTAMP define both PRUs were built with.
+//#define VOSPI_FRAME_TIMESTAMP
+
+// Frame timestamp message type (seq followed by the 32-bit little endian IEP count in
+// data[0-3] and the nSec since then in data[4-7])
+#define VOSPI_TS_MSG          0xFC
 
 
 
@@ -24,15 +167,90 @@ typedef struct {
 	uint8_t data[VOSPI_MSG_DATA_BYTES];
 } vospi_rpmsg_t;
 
-// A single VoSPI frame
+// A single VoSPI frame (image messages followed by any telemetry and statistics messages)
 typedef struct {
-	vospi_rpmsg_t msg[VOSPI_FRAME_NUM_MSGS];
+	vospi_rpmsg_t msg[VOSPI_FRAME_TOTAL_MSGS];
+	int64_t timestamp_usec;  // CLOCK_MONOTONIC capture time (VOSPI_FRAME_TIMESTAMP only)
+	uint32_t pru_ts;         // PRU IEP count (nSec, wraps) at capture
 } vospi_frame_t;
 
+// Frame pixel statistics (16-bit pixels are binned over the previous frame's range)
+typedef struct {
+	uint32_t num_pixels;  // VOSPI_FRAME_LEN for valid statistics
+	uint32_t sum;
+	uint16_t min;
+	uint16_t max;
+	uint16_t hist_base;   // Pixel value at the start of bin 0
+	uint16_t hist_shift;  // Each bin is (1 << hist_shift) pixel values wide
+	uint16_t hist[VOSPI_HIST_BINS];
+} vospi_stats_t;
+
+// Frame telemetry fields
+typedef struct {
+	uint32_t uptime_msec;
+	uint32_t status;          // VOSPI_STATUS_xxx bits
+	uint32_t frame_count;
+	uint16_t frame_mean;
+	uint16_t fpa_temp_k100;
+	uint16_t housing_temp_k100;
+	uint16_t ffc_fpa_temp_k100;  // FPA temperature at the last FFC
+	uint32_t ffc_uptime_msec;    // Uptime at the last FFC
+} vospi_telem_t;
+
+// DDR ring header (head and tail are free-running frame counts)
+typedef struct {
+	uint32_t magic;
+	uint32_t head;        // Frames written by PRU1 (the capturing PRU with VOSPI_DUAL_LEPTON)
+	uint32_t tail;        // Frames consumed by us
+	uint32_t frame_len;
+	uint32_t num_frames;
+	uint32_t dropped;     // Times PRU0 had to wait for a free frame (ring full)
+} vospi_ring_hdr_t;
+
+// Dual Lepton PRU control block
+typedef struct {
+	uint32_t magic;       // VOSPI_PRU_MAGIC once the firmware is running
+	uint8_t enable;       // Set by us
+	uint8_t reserved[3];
+	uint32_t sample;      // Packet sample period in PRU cycles, 0 for the default (set by us)
+	uint32_t ring_pa;     // Ring physical address, set by the PRU once it is enabled
+} vospi_pru_ctrl_t;
+
+// A dual Lepton PRU and its mapped ring
+typedef struct {
+	int pru;
+	void* smem;
+	volatile vospi_pru_ctrl_t* ctrl;
+	void* ring;
+	volatile vospi_ring_hdr_t* ring_hdr;
+	uint8_t* ring_frames;
+} vospi_pru_t;
+
 
 
+int vospi_set_timing(int fd, uint16_t sample_usec, uint16_t xmit_usec);
 int sync_and_transfer_exp_msg(int fd, vospi_rpmsg_t* msg, uint8_t exp_seq);
 int sync_and_transfer_frame(int fd, vospi_frame_t* frame);
 void frame_to_pixel(vospi_frame_t* frame, uint8_t* pixbuf);
+#ifdef VOSPI_DUAL_LEPTON
+int vospi_pru_open(vospi_pru_t* pru, int num);
+int vospi_pru_start(vospi_pru_t* pru, uint16_t sample_usec);
+void vospi_pru_stop(vospi_pru_t* pru);
+void vospi_pru_close(vospi_pru_t* pru);
+int vospi_pru_transfer_frame(vospi_pru_t* pru, vospi_frame_t* frame);
+#endif
+#ifdef VOSPI_FRAME_STATS
+int frame_to_stats(vospi_frame_t* frame, vospi_stats_t* stats);
+#endif
+#ifdef VOSPI_TELEM
+uint16_t vospi_telem_word(vospi_frame_t* frame, int word);
+void frame_to_telem(vospi_frame_t* frame, vospi_telem_t* telem);
+int vospi_telem_ffc_active(vospi_telem_t* telem);
+#endif
+#ifdef VOSPI_16BIT
+void frame_to_pixel16(vospi_frame_t* frame, uint16_t* pixbuf);
+void pixel16_to_pixel(uint16_t* pix16buf, uint8_t* pixbuf);
+void pixel16_scale(uint16_t* pix16buf, uint8_t* pixbuf, uint16_t min, uint16_t max);
+#endif
 
 #endif /* VOSPI_H */
@@ -6,10 +6,19 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <linux/fb.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// Lepton image and (x2) display dimensions
+#define IMG_W 160
+#define IMG_H 120
+#define FB_W  (IMG_W * 2)
 
 int fbfd = 0;
 struct fb_var_screeninfo vinfo;
@@ -17,13 +26,33 @@ struct fb_fix_screeninfo finfo;
 char *fbp = 0;
 uint8_t* cmap_p = (uint8_t*) colormap_golden;
 
+// RGB565 values for the current colormap
+uint16_t cmap_lut[256];
+int cmap_lut_valid = 0;
+
+// One display line rendered in memory and then copied to the two frame buffer lines
+// it covers (frame buffer memory is slow to read back)
+uint16_t line_buf[FB_W];
+#ifdef FB_BILINEAR
+uint8_t interp_buf[IMG_W];
+#endif
+
+// Display pages.  With two pages (drivers that support panning) each frame is drawn
+// into the hidden page which is then panned to the display.  Otherwise frames are
+// drawn into an off-screen back buffer and copied to the display in one go.
+int fb_pages = 1;
+int fb_page = 0;
+int fb_vsync = 0;
+long int page_size = 0;
+char* back_buf = 0;
+
 
 /**
  * Initialize frame buffer
  */
 int init_fb(char* fb_path)
 {
-	long int screensize = 0;
+	uint32_t arg = 0;
 
 	// Open the file for reading and writing
 	fbfd = open(fb_path, O_RDWR);
@@ -48,11 +77,26 @@ int init_fb(char* fb_path)
 	log_info("FB: %dx%d, %dbpp, length %d, offsets: %d %d", vinfo.xres, vinfo.yres,
 		 vinfo.bits_per_pixel, finfo.line_length, vinfo.xoffset, vinfo.yoffset);
 
+	// Try to get a second page to flip to if the driver can pan
+	if ((finfo.ypanstep != 0) && (vinfo.yres_virtual < 2 * vinfo.yres)) {
+		vinfo.yres_virtual = 2 * vinfo.yres;
+		(void) ioctl(fbfd, FBIOPUT_VSCREENINFO, &vinfo);
+		(void) ioctl(fbfd, FBIOGET_VSCREENINFO, &vinfo);
+		(void) ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo);
+	}
+	if ((finfo.ypanstep != 0) && (vinfo.yres_virtual >= 2 * vinfo.yres)) {
+		vinfo.yoffset = 0;
+		if (ioctl(fbfd, FBIOPAN_DISPLAY, &vinfo) == 0) {
+			fb_pages = 2;
+			fb_vsync = (ioctl(fbfd, FBIO_WAITFORVSYNC, &arg) == 0);
+		}
+	}
+
 	// Figure out the size of the screen in bytes
-	screensize = vinfo.xres * vinfo.yres * vinfo.bits_per_pixel / 8;
+	page_size = finfo.line_length * vinfo.yres;
 
 	// Map the device to memory
-	fbp = (char *)mmap(0, screensize, PROT_READ | PROT_WRITE, MAP_SHARED, fbfd, 0);
+	fbp = (char *)mmap(0, page_size * fb_pages, PROT_READ | PROT_WRITE, MAP_SHARED, fbfd, 0);
 	if ((int)fbp == -1) {
 		log_fatal("Error: failed to map framebuffer device to memory");
 	        exit(4);
@@ -60,40 +104,193 @@ int init_fb(char* fb_path)
 
 	log_info("Framebuffer device mapped to memory successfully.");
 
+	if (fb_pages == 2) {
+		log_info("Page flipping %s vsync", fb_vsync ? "with" : "without");
+	} else {
+		back_buf = malloc(page_size);
+		if (back_buf == NULL) {
+			log_fatal("Error: failed to allocate back buffer");
+			exit(5);
+		}
+		log_info("Drawing to a back buffer");
+	}
+
 	return(0);
 }
 
 
 /*
- * Draw the 8-bit data into the frame buffer (x2 in size)
+ * Build the RGB565 lookup table for the current colormap
  */
-void update_fb(uint8_t* pixbuf)
+static void build_lut()
+{
+	int i;
+	uint8_t* cP = cmap_p;
+
+	for (i=0; i<256; i++) {
+		cmap_lut[i] = (cP[0] / 8) << 11 | (cP[1] / 4) << 5 | (cP[2] / 8);
+		cP += 3;
+	}
+	cmap_lut_valid = 1;
+}
+
+
+#ifdef FB_BILINEAR
+/*
+ * Render one line of data into line_buf, interpolating between adjacent pixels
+ */
+static void render_line(uint8_t* bP)
+{
+	uint16_t* dP = line_buf;
+	int x;
+
+	for (x=0; x < IMG_W-1; x++) {
+		*dP++ = cmap_lut[bP[0]];
+		*dP++ = cmap_lut[(bP[0] + bP[1] + 1) >> 1];
+		bP++;
+	}
+	*dP++ = cmap_lut[*bP];
+	*dP = cmap_lut[*bP];
+}
+#else
+/*
+ * Render one line of data into line_buf, doubling each pixel
+ */
+static void render_line(uint8_t* bP)
+{
+	int x;
+#ifdef __ARM_NEON
+	uint16_t t[8];
+	uint16x8_t v;
+	uint16x8x2_t v2;
+	int i;
+
+	for (x=0; x < IMG_W; x=x+8) {
+		for (i=0; i<8; i++) {
+			t[i] = cmap_lut[*bP++];
+		}
+		v = vld1q_u16(t);
+		v2 = vzipq_u16(v, v);
+		vst1q_u16(&line_buf[x*2], v2.val[0]);
+		vst1q_u16(&line_buf[x*2 + 8], v2.val[1]);
+	}
+#else
+	uint32_t* dP = (uint32_t*) line_buf;
+	uint32_t t;
+
+	for (x=0; x < IMG_W; x++) {
+		t = cmap_lut[*bP++];
+		*dP++ = t | (t << 16);
+	}
+#endif
+}
+#endif
+
+
+/*
+ * Get the start of line y of the page (or back buffer) being drawn
+ */
+static char* draw_line_ptr(int y)
+{
+	if (fb_pages == 2) {
+		return fbp + (fb_page ^ 1) * page_size + y * finfo.line_length;
+	} else {
+		return back_buf + y * finfo.line_length;
+	}
+}
+
+
+#ifdef FB_BILINEAR
+/*
+ * Draw the second frame buffer line for row y of the 8-bit data in pixbuf (which
+ * must also contain row y+1 unless y is the last row)
+ */
+static void draw_second_line(uint8_t* pixbuf, int y)
 {
 	uint8_t* bP;
-	int x, y, offset;
-	uint16_t t;
+	uint8_t* nP;
+	int x;
+
+	// Halfway to the next line of data
+	bP = pixbuf + y * IMG_W;
+	nP = (y < IMG_H-1) ? bP + IMG_W : bP;
+	for (x=0; x < IMG_W; x++) {
+		interp_buf[x] = (bP[x] + nP[x] + 1) >> 1;
+	}
+	render_line(interp_buf);
+	memcpy(draw_line_ptr(y*2 + 1), line_buf, sizeof(line_buf));
+}
+#endif
+
 
-	for (y=0; y < 240; y=y+2) {
+/*
+ * Draw n rows of the 8-bit data starting at row y into the frame buffer (x2 in size)
+ * without displaying them.  pixbuf holds the whole frame and rows must be drawn in
+ * order.  With FB_BILINEAR the second line of the last row is drawn with the next
+ * rows since it needs the row after it.
+ */
+void draw_fb_rows(uint8_t* pixbuf, int y, int n)
+{
+	int last = y + n - 1;
+
+	if (!cmap_lut_valid) {
+		build_lut();
+	}
+
+#ifdef FB_BILINEAR
+	if (y > 0) {
+		draw_second_line(pixbuf, y - 1);
+	}
+#endif
+	for (; y <= last; y++) {
 		// Line 1
-		bP = pixbuf + y/2*160;
-		for (x = 0; x < 320; x=x+2) {
-			offset = (x * 2) + (y * finfo.line_length);
-			t = get_rgb_pixel(*bP++);
-			*((uint16_t*)(fbp + offset)) = t;
-			*((uint16_t*)(fbp + offset + 2)) = t;
-		}
+		render_line(pixbuf + y * IMG_W);
+		memcpy(draw_line_ptr(y*2), line_buf, sizeof(line_buf));
+
 		// Line 2
-		bP = pixbuf + y/2*160;
-		for (x = 0; x < 320; x=x+2) {
-			offset = (x * 2) + ((y+1) * finfo.line_length);
-			t = get_rgb_pixel(*bP++);
-			*((uint16_t*)(fbp + offset)) = t;
-			*((uint16_t*)(fbp + offset + 2)) = t;
+#ifdef FB_BILINEAR
+		if ((y < last) || (y == IMG_H-1)) {
+			draw_second_line(pixbuf, y);
 		}
+#else
+		memcpy(draw_line_ptr(y*2 + 1), line_buf, sizeof(line_buf));
+#endif
 	}
 }
 
 
+/*
+ * Display the rows drawn by draw_fb_rows()
+ */
+void show_fb()
+{
+	uint32_t arg = 0;
+
+	if (fb_pages == 2) {
+		// Show the new page
+		fb_page ^= 1;
+		vinfo.yoffset = fb_page * vinfo.yres;
+		(void) ioctl(fbfd, FBIOPAN_DISPLAY, &vinfo);
+		if (fb_vsync) {
+			// Don't start drawing into the old page until it is no longer displayed
+			(void) ioctl(fbfd, FBIO_WAITFORVSYNC, &arg);
+		}
+	} else {
+		memcpy(fbp, back_buf, IMG_H * 2 * finfo.line_length);
+	}
+}
+
+
+/*
+ * Draw the 8-bit data into the frame buffer (x2 in size) and display it
+ */
+void update_fb(uint8_t* pixbuf)
+{
+	draw_fb_rows(pixbuf, 0, IMG_H);
+	show_fb();
+}
+
+
 void set_colormap(int n)
 {
 	switch (n) {
@@ -113,18 +310,14 @@ void set_colormap(int n)
 			cmap_p = (uint8_t*) colormap_golden;
 			break;
 	}
+	build_lut();
 }
 
 
 uint16_t get_rgb_pixel(uint8_t p)
 {
-	uint8_t r, g, b;
-	uint8_t* cP;
-
-	cP = cmap_p + p*3;
-	r = *(cP) / 8;
-	g = *(++cP) / 4;
-	b = *(++cP) / 8;
-	return r<<11 | g<<5 | b;
+	if (!cmap_lut_valid) {
+		build_lut();
+	}
+	return cmap_lut[p];
 }
-
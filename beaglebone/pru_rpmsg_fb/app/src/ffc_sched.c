@@ -0,0 +1,216 @@
+#include "ffc_sched.h"
+#include "log.h"
+#include "prulepton.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef VOSPI_TELEM
+
+static int64_t now_usec();
+static int scene_still(ffc_sched_t* sched, vospi_frame_t* frame, int64_t t);
+static void run_ffc(ffc_sched_t* sched, int64_t t, uint32_t* counter);
+
+
+
+/**
+ * Load the default settings
+ */
+void ffc_sched_default_config(ffc_sched_config_t* config)
+{
+	config->drift_k100 = FFC_SCHED_DEF_DRIFT_K100;
+	config->motion = FFC_SCHED_DEF_MOTION;
+	config->quiet_msec = FFC_SCHED_DEF_QUIET_MSEC;
+	config->min_msec = FFC_SCHED_DEF_MIN_MSEC;
+	config->max_wait_msec = FFC_SCHED_DEF_MAX_WAIT_MSEC;
+}
+
+
+/**
+ * Open the CCI and switch the Lepton to manual FFC, saving its FFC mode.  Returns 0
+ * for success, -1 if the Lepton could not be configured.
+ */
+int ffc_sched_start(ffc_sched_t* sched, ffc_sched_config_t* config, char* i2c_dev)
+{
+	uint16_t mode[CCI_FFC_SHUTTER_MODE_WORDS];
+
+	memset(sched, 0, sizeof(ffc_sched_t));
+	sched->config = *config;
+	if (sched->config.motion < 1) {
+		sched->config.motion = 1;
+	}
+
+	if ((sched->fd = prulepton_open_cci(i2c_dev)) < 0) {
+		return -1;
+	}
+
+	if (cci_get_ffc_shutter_mode(sched->fd, sched->saved_mode) < 0) {
+		log_error("FFC: failed to read the FFC mode");
+		close(sched->fd);
+		sched->fd = -1;
+		return -1;
+	}
+
+	memcpy(mode, sched->saved_mode, sizeof(mode));
+	mode[CCI_FFC_SHUTTER_MODE_WORD] = CCI_FFC_SHUTTER_MODE_MANUAL;
+	mode[CCI_FFC_SHUTTER_MODE_WORD + 1] = 0;
+	cci_set_ffc_shutter_mode(sched->fd, mode);
+
+	log_info("FFC: smart scheduling, drift %u, motion %u, quiet %u mSec, min %u mSec, max wait %u mSec",
+	         sched->config.drift_k100, sched->config.motion, sched->config.quiet_msec,
+	         sched->config.min_msec, sched->config.max_wait_msec);
+	return 0;
+}
+
+
+/**
+ * Run the scheduler for a frame: run an approved FFC or decide from the frame's
+ * telemetry if one is due and run it once the scene is still (or it has waited too
+ * long).  A FFC is never due while one is running or within FFC_SCHED_WAIT_MSEC of
+ * commanding one.
+ */
+void ffc_sched_frame(ffc_sched_t* sched, vospi_frame_t* frame)
+{
+	vospi_telem_t telem;
+	uint32_t drift;
+	int due = 0;
+	int64_t t = now_usec();
+
+	if (sched->fd < 0) {
+		return;
+	}
+
+	if (sched->approved) {
+		sched->approved = 0;
+		run_ffc(sched, t, &sched->num_approved);
+		return;
+	}
+
+	frame_to_telem(frame, &telem);
+	drift = abs((int) telem.fpa_temp_k100 - (int) telem.ffc_fpa_temp_k100);
+	if (!vospi_telem_ffc_active(&telem) &&
+	    ((sched->run_usec == 0) || ((t - sched->run_usec) >= ((int64_t) FFC_SCHED_WAIT_MSEC * 1000))) &&
+	    ((telem.uptime_msec - telem.ffc_uptime_msec) >= sched->config.min_msec)) {
+		due = (drift >= sched->config.drift_k100) || ((telem.status & VOSPI_STATUS_FFC_DESIRED) != 0);
+	}
+
+	if (!due) {
+		sched->due_usec = 0;
+		return;
+	}
+
+	if (sched->due_usec == 0) {
+		log_info("FFC: due (FPA drift %u)", drift);
+		sched->due_usec = t;
+		sched->ref_valid = 0;
+	}
+	if (scene_still(sched, frame, t)) {
+		run_ffc(sched, t, &sched->num_quiet);
+	} else if ((sched->config.max_wait_msec != 0) &&
+	           ((t - sched->due_usec) >= ((int64_t) sched->config.max_wait_msec * 1000))) {
+		run_ffc(sched, t, &sched->num_forced);
+	}
+}
+
+
+/**
+ * Run a FFC with the next frame (safe to call from a signal handler)
+ */
+void ffc_sched_approve(ffc_sched_t* sched)
+{
+	sched->approved = 1;
+}
+
+
+/**
+ * Restore the Lepton's FFC mode and close the CCI
+ */
+void ffc_sched_stop(ffc_sched_t* sched)
+{
+	if (sched->fd < 0) {
+		return;
+	}
+
+	cci_set_ffc_shutter_mode(sched->fd, sched->saved_mode);
+	log_info("FFC: %u quiet, %u forced, %u approved", sched->num_quiet, sched->num_forced,
+	         sched->num_approved);
+	close(sched->fd);
+	sched->fd = -1;
+}
+
+
+
+static int64_t now_usec()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+/**
+ * Returns true once the scene has been still for quiet_msec.  The frame's block means
+ * are compared with the blocks of the frame the scene last moved in.
+ */
+static int scene_still(ffc_sched_t* sched, vospi_frame_t* frame, int64_t t)
+{
+	uint32_t sums[FFC_SCHED_NUM_BLOCKS];
+	uint16_t mean;
+	uint8_t* p;
+	int seq, i, n, x = 0, y = 0;
+	int moved = 0;
+
+	// Pixels are in row order across the image messages (16-bit pixels big-endian)
+	memset(sums, 0, sizeof(sums));
+	for (seq=0; seq < VOSPI_FRAME_NUM_MSGS; seq++) {
+		p = frame->msg[seq].data;
+		for (i=0; i<VOSPI_MSG_DATA_BYTES; i+=VOSPI_PIXEL_BYTES) {
+#ifdef VOSPI_16BIT
+			sums[(y / FFC_SCHED_BLOCK_SIZE) * FFC_SCHED_BLOCKS_X + x / FFC_SCHED_BLOCK_SIZE] += (p[i] << 8) | p[i+1];
+#else
+			sums[(y / FFC_SCHED_BLOCK_SIZE) * FFC_SCHED_BLOCKS_X + x / FFC_SCHED_BLOCK_SIZE] += p[i];
+#endif
+			if (++x == 160) {
+				x = 0;
+				y++;
+			}
+		}
+	}
+
+	for (n=0; n<FFC_SCHED_NUM_BLOCKS; n++) {
+		mean = sums[n] / (FFC_SCHED_BLOCK_SIZE * FFC_SCHED_BLOCK_SIZE);
+		if (sched->ref_valid && (abs((int) mean - (int) sched->ref[n]) >= (int) sched->config.motion)) {
+			moved = 1;
+		}
+		sums[n] = mean;
+	}
+
+	if (!sched->ref_valid || moved) {
+		for (n=0; n<FFC_SCHED_NUM_BLOCKS; n++) {
+			sched->ref[n] = sums[n];
+		}
+		sched->ref_valid = 1;
+		sched->still_usec = t;
+		return 0;
+	}
+
+	return ((t - sched->still_usec) >= ((int64_t) sched->config.quiet_msec * 1000));
+}
+
+
+/**
+ * Command a FFC, counting it in one of the counters
+ */
+static void run_ffc(ffc_sched_t* sched, int64_t t, uint32_t* counter)
+{
+	log_info("FFC: run");
+	cci_run_ffc(sched->fd);
+	sched->run_usec = t;
+	sched->due_usec = 0;
+	(*counter)++;
+}
+
+#endif /* VOSPI_TELEM */
@@ -0,0 +1,111 @@
+#include "frame_ring.h"
+#include "log.h"
+
+#include <stdlib.h>
+
+
+/**
+ * Allocate the ring's frames.  Returns 0 for success, -1 if the frames could not be
+ * allocated.
+ */
+int frame_ring_init(frame_ring_t* ring)
+{
+	int i;
+
+	for (i=0; i<FRAME_RING_SIZE; i++) {
+		if ((ring->frames[i] = malloc(sizeof(vospi_frame_t))) == NULL) {
+			log_fatal("RING: failed to allocate frames");
+			return -1;
+		}
+	}
+	ring->head = 0;
+	ring->tail = 0;
+	ring->dropped = 0;
+	sem_init(&ring->push_sem, 0, 0);
+
+	return 0;
+}
+
+
+/**
+ * Producer: Get the slot to transfer the next frame into.  If the ring is full the
+ * oldest frame is dropped to make room.  The slot may be filled (or a failed transfer
+ * left in it) until frame_ring_push() is called.
+ */
+vospi_frame_t* frame_ring_get_write(frame_ring_t* ring)
+{
+	uint32_t head = ring->head;    // Only written by us
+	uint32_t tail;
+
+	tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	while ((head - tail) == FRAME_RING_SIZE) {
+		// Drop the oldest frame unless the consumer just released it
+		if (__atomic_compare_exchange_n(&ring->tail, &tail, tail + 1, 0,
+		                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			ring->dropped++;
+			break;
+		}
+	}
+
+	return ring->frames[head % FRAME_RING_SIZE];
+}
+
+
+/**
+ * Producer: Make the frame in the slot returned by frame_ring_get_write() available
+ * to the consumer
+ */
+void frame_ring_push(frame_ring_t* ring)
+{
+	__atomic_store_n(&ring->head, ring->head + 1, __ATOMIC_RELEASE);
+	sem_post(&ring->push_sem);
+}
+
+
+/**
+ * Consumer: Block until there is a frame and return the oldest one.  seq identifies
+ * the frame for frame_ring_release().
+ */
+vospi_frame_t* frame_ring_get_read(frame_ring_t* ring, uint32_t* seq)
+{
+	vospi_frame_t* frame;
+
+	while ((frame = frame_ring_try_read(ring, seq)) == NULL) {
+		// Empty (extra posts are left by dropped frames)
+		sem_wait(&ring->push_sem);
+	}
+
+	return frame;
+}
+
+
+/**
+ * Consumer: Return the oldest frame without blocking or NULL if the ring is empty.
+ * seq identifies the frame for frame_ring_release().
+ */
+vospi_frame_t* frame_ring_try_read(frame_ring_t* ring, uint32_t* seq)
+{
+	uint32_t tail;
+
+	tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	if (tail == __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) {
+		return NULL;
+	}
+
+	*seq = tail;
+	return ring->frames[tail % FRAME_RING_SIZE];
+}
+
+
+/**
+ * Consumer: Release the frame returned by frame_ring_get_read() so its slot can be
+ * reused.  Returns false if the producer dropped the frame (and may have overwritten
+ * it) while it was being processed.
+ */
+int frame_ring_release(frame_ring_t* ring, uint32_t seq)
+{
+	uint32_t tail = seq;
+
+	return __atomic_compare_exchange_n(&ring->tail, &tail, seq + 1, 0,
+	                                   __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
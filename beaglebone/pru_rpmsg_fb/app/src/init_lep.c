@@ -0,0 +1,23 @@
+#include "log.h"
+#include "prulepton.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <stdlib.h>
+
+
+char i2c_dev[] = PRULEPTON_I2C_DEV;
+
+
+int main(int argc, char *argv[])
+{
+  // Configure the Lepton for the PRUs (for the pru_lepton_v4l2 kernel driver which
+  // doesn't use the CCI interface itself)
+  log_info("Configuring Lepton...");
+  if (prulepton_init_lepton(i2c_dev) < 0) {
+    return -1;
+  }
+  log_info("  Done");
+
+  return 0;
+}
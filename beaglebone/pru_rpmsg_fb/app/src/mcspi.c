@@ -0,0 +1,313 @@
+#include "log.h"
+#include "mcspi.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/spi/spidev.h>
+#include <linux/types.h>
+#include <sys/ioctl.h>
+
+
+// Device files
+static int spi_fd = -1;
+static int vsync_fd = -1;
+
+// One segment of raw Lepton packets
+static uint8_t seg_buf[MCSPI_SEG_PKTS * MCSPI_PKT_LEN];
+
+// Consecutive bad segments
+static int bad_segs = 0;
+
+
+
+/**
+ * Write a string to a sysfs file.  Returns false if the write fails.
+ */
+static int write_sysfs(char* path, char* val)
+{
+	int fd;
+	int n;
+
+	if ((fd = open(path, O_WRONLY)) < 0) {
+		return 0;
+	}
+	n = write(fd, val, strlen(val));
+	close(fd);
+
+	return (n == strlen(val));
+}
+
+
+/**
+ * Export the VSYNC gpio through sysfs for rising edge interrupts and open its value
+ * file.  Returns the file descriptor or -1.
+ */
+static int open_vsync(int gpio)
+{
+	char path[64];
+	char val[8];
+
+	sprintf(path, "/sys/class/gpio/gpio%d/value", gpio);
+	if (access(path, F_OK) != 0) {
+		sprintf(val, "%d", gpio);
+		(void) write_sysfs("/sys/class/gpio/export", val);
+	}
+
+	sprintf(path, "/sys/class/gpio/gpio%d/direction", gpio);
+	if (!write_sysfs(path, "in")) {
+		return -1;
+	}
+	sprintf(path, "/sys/class/gpio/gpio%d/edge", gpio);
+	if (!write_sysfs(path, "rising")) {
+		return -1;
+	}
+
+	sprintf(path, "/sys/class/gpio/gpio%d/value", gpio);
+	return open(path, O_RDONLY);
+}
+
+
+/**
+ * Wait for the next VSYNC rising edge.  Returns 1 for VSYNC, 0 for a timeout and -1
+ * for an error.
+ */
+static int wait_vsync()
+{
+	struct pollfd pfd;
+	char c;
+	int rsp;
+
+	pfd.fd = vsync_fd;
+	pfd.events = POLLPRI | POLLERR;
+	pfd.revents = 0;
+	rsp = poll(&pfd, 1, MCSPI_VSYNC_TO_MSEC);
+	if (rsp < 0) {
+		log_fatal("VSYNC: poll failed");
+		return -1;
+	}
+
+	// Clear the edge
+	(void) lseek(vsync_fd, 0, SEEK_SET);
+	(void) read(vsync_fd, &c, 1);
+
+	return (rsp > 0) ? 1 : 0;
+}
+
+
+/**
+ * Read n packets into buf with one spidev transfer.  Returns false if the transfer
+ * fails.
+ */
+static int read_pkts(uint8_t* buf, int n)
+{
+	struct spi_ioc_transfer xfer;
+
+	memset(&xfer, 0, sizeof(xfer));
+	xfer.rx_buf = (unsigned long) buf;
+	xfer.len = n * MCSPI_PKT_LEN;
+	xfer.speed_hz = MCSPI_SPEED_HZ;
+	xfer.bits_per_word = 8;
+
+	if (ioctl(spi_fd, SPI_IOC_MESSAGE(1), &xfer) < 1) {
+		log_fatal("SPI: failed to transfer packets");
+		return 0;
+	}
+
+	return 1;
+}
+
+
+/**
+ * Read a segment after VSYNC into seg_buf.  Returns 1 with the segment number (0
+ * for the Lepton's invalid segments or 1-4) in seg for a segment with the expected
+ * sequence of packets, 0 for a bad segment and -1 for an error.
+ */
+static int read_segment(int* seg)
+{
+	int i, n;
+	uint8_t* p;
+
+	// Skip any discard packets ahead of the segment
+	i = 0;
+	do {
+		if (!read_pkts(seg_buf, 1)) {
+			return -1;
+		}
+	} while (((seg_buf[0] & 0x0F) == 0x0F) && (++i < MCSPI_MAX_DISCARDS));
+
+	// Read the rest of the segment
+	n = 1;
+	while (n < MCSPI_SEG_PKTS) {
+		i = MCSPI_SEG_PKTS - n;
+		if (i > MCSPI_XFER_PKTS) i = MCSPI_XFER_PKTS;
+		if (!read_pkts(&seg_buf[n * MCSPI_PKT_LEN], i)) {
+			return -1;
+		}
+		n += i;
+	}
+
+	// Validate the packet numbers
+	for (n=0; n<MCSPI_SEG_PKTS; n++) {
+		p = &seg_buf[n * MCSPI_PKT_LEN];
+		if (((p[0] & 0x0F) == 0x0F) || (p[1] != n)) {
+			return 0;
+		}
+	}
+
+	// Packet 20 contains the segment number
+	*seg = (seg_buf[20 * MCSPI_PKT_LEN] >> 4) & 0x07;
+	return 1;
+}
+
+
+/**
+ * Copy the image packets in seg_buf into their location in frame and any telemetry
+ * rows A-C into the frame's telemetry message
+ */
+static void store_segment(vospi_frame_t* frame, int seg)
+{
+	int i, n;
+#ifndef VOSPI_16BIT
+	int j;
+#endif
+	uint8_t* dP;
+	uint8_t* sP;
+	vospi_rpmsg_t* msg;
+
+	for (i=0; i<MCSPI_SEG_PKTS; i++) {
+		n = (seg - 1) * MCSPI_SEG_PKTS + i;
+#ifdef VOSPI_TELEM_HEADER
+		n -= MCSPI_TELEM_PKTS;
+#endif
+		if ((n < 0) || (n >= MCSPI_FRAME_PKTS)) {
+#ifdef VOSPI_TELEM
+			// Telemetry packets in order (row D is not stored)
+			n = (n < 0) ? (n + MCSPI_TELEM_PKTS) : (n - MCSPI_FRAME_PKTS);
+			if (n < (VOSPI_TELEM_BYTES / MCSPI_PKT_DATA_LEN)) {
+				msg = &frame->msg[VOSPI_FRAME_NUM_MSGS];
+				msg->seq = VOSPI_FRAME_NUM_MSGS;
+				memcpy(&msg->data[n * MCSPI_PKT_DATA_LEN], &seg_buf[i * MCSPI_PKT_LEN + 4], MCSPI_PKT_DATA_LEN);
+			}
+#endif
+			continue;
+		}
+
+		msg = &frame->msg[n / VPSPI_MSG_NUM_PKTS];
+		msg->seq = n / VPSPI_MSG_NUM_PKTS;
+		dP = &msg->data[(n % VPSPI_MSG_NUM_PKTS) * VOSPI_PKT_NUM_BYTES];
+		sP = &seg_buf[i * MCSPI_PKT_LEN + 4];
+#ifdef VOSPI_16BIT
+		memcpy(dP, sP, MCSPI_PKT_DATA_LEN);
+#else
+		// Low byte of each AGC word
+		for (j=1; j<MCSPI_PKT_DATA_LEN; j+=2) {
+			*dP++ = sP[j];
+		}
+#endif
+	}
+}
+
+
+/**
+ * Sleep for the specified number of milliseconds
+ */
+static void sleep_ms(int milliseconds)
+{
+	struct timespec ts;
+
+	ts.tv_sec = milliseconds / 1000;
+	ts.tv_nsec = (milliseconds % 1000) * 1000000;
+	nanosleep(&ts, NULL);
+}
+
+
+
+/**
+ * Open and configure the spidev device and the VSYNC gpio.  The Lepton must be
+ * configured to output VSYNC on its GPIO3.  Returns 0 for success, -1 for failure.
+ */
+int mcspi_init(char* spi_dev, int vsync_gpio)
+{
+	uint8_t mode = SPI_MODE_3;
+	uint8_t bits = 8;
+	uint32_t speed = MCSPI_SPEED_HZ;
+
+	log_info("opening SPI device ... %s", spi_dev);
+	if ((spi_fd = open(spi_dev, O_RDWR)) < 0) {
+		log_fatal("SPI: failed to open device - check permissions & spidev enabled");
+		return -1;
+	}
+
+	if ((ioctl(spi_fd, SPI_IOC_WR_MODE, &mode) == -1) ||
+	    (ioctl(spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) == -1) ||
+	    (ioctl(spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) == -1)) {
+		log_fatal("SPI: failed to configure device");
+		return -1;
+	}
+
+	log_info("opening VSYNC gpio ... %d", vsync_gpio);
+	if ((vsync_fd = open_vsync(vsync_gpio)) < 0) {
+		log_fatal("VSYNC: failed to open gpio - check permissions");
+		return -1;
+	}
+
+	bad_segs = 0;
+
+	return 0;
+}
+
+
+/**
+ * Read segments on each VSYNC until a complete frame has been stored in frame.
+ * Returns 0 for a frame, 1 if VSYNC stopped and -1 for an error.
+ */
+int mcspi_transfer_frame(vospi_frame_t* frame)
+{
+	int exp_seg = 1;
+	int rsp;
+	int seg;
+
+#ifdef VOSPI_FRAME_STATS
+	// No PRU statistics (frame_to_stats() reports them invalid)
+	memset(&frame->msg[VOSPI_FRAME_NUM_MSGS], 0, VOSPI_STATS_NUM_MSGS * sizeof(vospi_rpmsg_t));
+#endif
+
+	while (1) {
+		rsp = wait_vsync();
+		if (rsp <= 0) {
+			return (rsp == 0) ? 1 : -1;
+		}
+
+		rsp = read_segment(&seg);
+		if (rsp < 0) {
+			return -1;
+		} else if (rsp == 0) {
+			// Lost sync with the Lepton
+			exp_seg = 1;
+			if (++bad_segs == MCSPI_RESYNC_SEGS) {
+				log_info("Resync");
+				bad_segs = 0;
+				sleep_ms(MCSPI_RESYNC_MSEC);
+			}
+			continue;
+		}
+		bad_segs = 0;
+
+		if ((seg == exp_seg) || (seg == 1)) {
+			store_segment(frame, seg);
+			if (seg == MCSPI_NUM_SEGS) {
+				return 0;
+			}
+			exp_seg = seg + 1;
+		} else {
+			// Invalid segment or out of order, wait for the start of the next frame
+			exp_seg = 1;
+		}
+	}
+}
@@ -0,0 +1,222 @@
+#include "cci.h"
+#include "fb.h"
+#include "frame_ring.h"
+#include "log.h"
+#include "mcspi.h"
+#include "vospi.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <assert.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+
+
+/* ------------ */
+/* Device files */
+/* ------------ */
+char i2c_dev[] = "/dev/i2c-2";
+char spi_dev[] = "/dev/spidev2.0";    // SPI1 (the kernel numbers SPI0 as spidev1)
+char fb_dev[] = "/dev/fb0";
+
+// Lepton VSYNC input (P9.27 - gpio3_19)
+#define VSYNC_GPIO 115
+
+
+/* --------------- */
+/* Local Variables */
+/* --------------- */
+
+// The frame ring (frames are transferred into and displayed from it in place)
+frame_ring_t ring;
+
+
+
+/**
+ * Attempt to configure the Lepton into AGC mode (or Radiometric TLinear mode for
+ * VOSPI_16BIT) with VSYNC output enabled via the I2C interface
+ */
+int init_lepton()
+{
+  int fd;
+  uint32_t rsp;
+
+  // Open the I2C device
+  log_info("opening I2C device ... %s", i2c_dev);
+  if ((fd = open(i2c_dev, O_RDWR)) < 0) {
+    log_fatal("I2C: failed to open device - check permissions & i2c enabled");
+    return -1;
+  }
+
+  // Initialize I2C interface
+  cci_init(fd);
+  
+  // Perform a FFC to (re)initialize the sensor
+  /*
+  log_info("  Perform FFC");
+  cci_run_ffc(fd);
+  sleep(2);
+  */
+
+  // Configure Radiometry for TLinear disabled (to support AGC) or enabled (16-bit)
+  cci_set_radiometry_enable_state(fd, CCI_RADIOMETRY_ENABLED);
+  rsp = cci_get_radiometry_enable_state(fd);
+  log_info("  Radiometry = %d", rsp);
+#ifdef VOSPI_16BIT
+  cci_set_radiometry_tlinear_enable_state(fd, CCI_RADIOMETRY_TLINEAR_ENABLED);
+#else
+  cci_set_radiometry_tlinear_enable_state(fd, CCI_RADIOMETRY_TLINEAR_DISABLED);
+#endif
+  rsp = cci_get_radiometry_tlinear_enable_state(fd);
+  log_info("  Radiometry TLinear = %d", rsp);
+
+#ifdef VOSPI_16BIT
+  // Disable AGC for 16-bit radiometric pixels
+  cci_set_agc_enable_state(fd, CCI_AGC_DISABLED);
+#else
+  // Enable AGC calculations
+  cci_set_agc_calc_enable_state(fd, CCI_AGC_ENABLED);
+  rsp = cci_get_agc_calc_enable_state(fd);
+  log_info("  AGC Calc En = %d", rsp);
+
+  // Enable AGC
+  cci_set_agc_enable_state(fd, CCI_AGC_ENABLED);
+#endif
+  rsp = cci_get_agc_enable_state(fd);
+  log_info("  AGC = %d", rsp);
+
+  // Telemetry in the location mcspi was built to skip
+#if defined(VOSPI_TELEM_HEADER) || defined(VOSPI_TELEM_FOOTER)
+#ifdef VOSPI_TELEM_HEADER
+  cci_set_telemetry_location(fd, CCI_TELEMETRY_LOCATION_HEADER);
+#else
+  cci_set_telemetry_location(fd, CCI_TELEMETRY_LOCATION_FOOTER);
+#endif
+  rsp = cci_get_telemetry_location(fd);
+  log_info("  Telemetry Location = %d", rsp);
+  cci_set_telemetry_enable_state(fd, CCI_TELEMETRY_ENABLED);
+#else
+  cci_set_telemetry_enable_state(fd, CCI_TELEMETRY_DISABLED);
+#endif
+  rsp = cci_get_telemetry_enable_state(fd);
+  log_info("  Telemetry = %d", rsp);
+
+  // Enable VSYNC on GPIO3 to schedule segment reads
+  cci_set_gpio_mode(fd, LEP_OEM_GPIO_MODE_VSYNC);
+  rsp = cci_get_gpio_mode(fd);
+  log_info("  GPIO Mode = %d", rsp);
+
+  // Close up
+  close(fd);
+  return 0;
+}
+
+
+/**
+ * Read frames from the device directly into the frame ring.
+ */
+void* get_frames_from_device(void* spidev_path_ptr)
+{
+    char* spidev_path = (char*)spidev_path_ptr;
+    int rsp;
+
+    vospi_frame_t* frame;
+
+    // Open the McSPI interface
+    if (mcspi_init(spidev_path, VSYNC_GPIO) == -1) {
+      exit(-1);
+    }
+
+    // Receive frames forever
+    log_info("Starting VoSPI transfers");
+    do {
+
+      // Transfer into the next ring slot (dropping the oldest frame if the ring is full)
+      frame = frame_ring_get_write(&ring);
+      rsp = mcspi_transfer_frame(frame);
+      if (rsp == -1) {
+	      log_error("Failed to get frame with error %d", rsp);
+	      exit(-1);
+      } else if (rsp == 1) {
+	      log_info("Transfer failed with reason %d", rsp);
+      }
+      else {
+          /* got frame */
+          frame_ring_push(&ring);
+      }
+    } while (1);  // Forever
+}
+
+
+/**
+ * Send frames to the fb as soon as they are ready
+ */
+void* send_frames_to_fb(void* fbdev_path_ptr)
+{
+    char* fbdev_path = (char*)fbdev_path_ptr;
+    uint8_t pixbuf[VOSPI_FRAME_LEN];
+    vospi_frame_t* frame;
+    uint32_t seq;
+
+    // Initialize frame buffer
+    (void) init_fb(fbdev_path);
+
+    while (1) {
+      // Wait for the next frame
+      frame = frame_ring_get_read(&ring, &seq);
+
+      // Convert it to pixels straight from the ring
+      frame_to_pixel(frame, pixbuf);
+
+      // Render it into the frame buffer unless it was overwritten while we converted it
+      if (frame_ring_release(&ring, seq)) {
+        update_fb(pixbuf);
+      }
+    }
+}
+
+/**
+ * Main entry point for McSPI-based Lepton FB display
+ */
+int main(int argc, char *argv[])
+{
+  pthread_t get_frames_thread, send_frames_to_fb_thread;
+
+  // Set the log level
+  log_set_level(LOG_INFO);
+
+  // Allocate space to receive the frames in the frame ring
+  log_info("Preallocating space for frames...");
+  if (frame_ring_init(&ring)) {
+    exit(-1);
+  }
+
+  // Setup colormap if user has selected a non-default
+  if (argc > 1) {
+	  set_colormap(atoi(argv[1]));
+  }
+
+  // Attempt to initialize the lepton
+  if (init_lepton()) {
+	  exit(-1);
+  }
+
+  log_info("Creating get_frames_from_device thread");
+  if (pthread_create(&get_frames_thread, NULL, get_frames_from_device, spi_dev)) {
+    log_fatal("Error creating get_frames_from_device thread");
+    return 1;
+  }
+
+  log_info("Creating send_frames_to_fb thread");
+  if (pthread_create(&send_frames_to_fb_thread, NULL, send_frames_to_fb, fb_dev)) {
+    log_fatal("Error creating send_frames_to_fb thread");
+    return 1;
+  }
+
+  pthread_join(get_frames_thread, NULL);
+  pthread_join(send_frames_to_fb_thread, NULL);
+}
@@ -1,167 +1,236 @@
-#include "cci.h"
+#include "ffc_sched.h"
+#include "frame_bus.h"
 #include "log.h"
+#include "prulepton.h"
+#include "tcam_frame.h"
+#include "v4l2out.h"
 #include "vospi.h"
+#include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
-#include <pthread.h>
-#include <semaphore.h>
 #include <assert.h>
 #include <string.h>
+#include <time.h>
 #include <zmq.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
+#include <linux/videodev2.h>
 
 // The default spec for the ZMQ socket that will be used for comms with the frontend
 #define ZMQ_DEFAULT_SOCKET_SPEC "tcp://*:5555"
 
-// The size of the circular frame buffer
-#define FRAME_BUF_SIZE 8
+// With VOSPI_DUAL_LEPTON the Lepton on PRU1 (configured through PRULEPTON_I2C_DEV_1) is
+// served the same way on its own socket (the second argument).  Only the Lepton on PRU0
+// is written to the V4L2 device and the frame bus and has its FFCs scheduled.
+#ifdef VOSPI_DUAL_LEPTON
+#define ZMQ_DEFAULT_SOCKET_SPEC_1 "tcp://*:5565"
+#define LEP_NUM_CAMS 2
+#else
+#define LEP_NUM_CAMS 1
+#endif
+
+// Uncomment to publish every frame as it arrives on a ZMQ_PUB socket (to any number
+// of subscribers, e.g. zmq_fb built with LEP_ZMQ_PUBSUB) instead of replying to
+// requests on a ZMQ_REP socket.  Each message is a frame in the shared frame format
+// (vospi_asm/tcam_frame.h) so subscribers can detect frames they missed from its
+// sequence number.
+//#define LEP_ZMQ_PUBSUB
+
+// Uncomment to also send the frames requested on the ZMQ_REP socket as tcam_frame.h
+// frames instead of plain pixels (Damien's webserver requires plain pixels)
+//#define LEP_FRAME_HEADER
+
+// Frames queued for a slow subscriber before new frames are dropped for it
+#define ZMQ_PUB_SNDHWM 2
+
+// Number of frame message buffers zmq may hold on to while it sends them
+#define ZMQ_MSG_BUFS 4
+
+// Uncomment to also write every frame to the V4L2OUT_DEV v4l2loopback device (Y16
+// with VOSPI_16BIT, GREY otherwise) so V4L2 applications can read it.  Frames are
+// taken as they arrive so requests on the default ZMQ_REP socket aren't served, use
+// it with LEP_ZMQ_PUBSUB or on its own.
+//#define LEP_V4L2_OUTPUT
+
+// Uncomment to schedule FFCs (see ffc_sched.h) so they run when the scene is still
+// instead of on the Lepton's timer.  Send SIGUSR1 to run one immediately.  Needs
+// telemetry (VOSPI_TELEM_HEADER or VOSPI_TELEM_FOOTER).  With the default ZMQ_REP
+// socket only the requested frames are seen.
+//#define LEP_FFC_SCHED
+
+#if defined(LEP_FFC_SCHED) && !defined(VOSPI_TELEM)
+#error "LEP_FFC_SCHED needs VOSPI_TELEM"
+#endif
+
+// Uncomment to also publish every frame on the local shared memory frame bus
+// (FRAME_BUS_NAME, see vospi_asm/frame_bus.h) so programs on this board, for example
+// zmq_fb built with LEP_FRAME_BUS, read the frames in place without a socket.  Frames
+// are taken as they arrive, use it with LEP_ZMQ_PUBSUB or on its own.
+//#define LEP_FRAME_BUS
+
+#if defined(LEP_ZMQ_PUBSUB) || defined(LEP_V4L2_OUTPUT) || defined(LEP_FRAME_BUS)
+#define LEP_FRAME_CB
+#endif
 
 /* ------------ */
 /* Device files */
 /* ------------ */
-char i2c_dev[] = "/dev/i2c-2";
-char pru_dev[] = "/dev/rpmsg_pru31";
+char i2c_dev[] = PRULEPTON_I2C_DEV;
+char pru_dev[] = PRULEPTON_PRU_DEV;
+#ifdef VOSPI_DUAL_LEPTON
+char i2c_dev_1[] = PRULEPTON_I2C_DEV_1;
+#endif
 
 
 /* --------------- */
 /* Local Variables */
 /* --------------- */
 
-// Positions of the reader and writer in the frame buffer
-int reader = 0, writer = 0;
+// The PRU Lepton handles (frames are transferred into and sent from their rings in place)
+prulepton_t leps[LEP_NUM_CAMS];
+
+// The Lepton with the V4L2 output, the frame bus and the FFC scheduler
+#define IS_PRIMARY(lep) ((lep) == &leps[0])
 
-// semaphore tracking the number of frames available
-sem_t count_sem;
+#ifdef VOSPI_DUAL_LEPTON
+// The second Lepton's socket
+char* socket_path_1;
+#endif
 
-// a lock protecting accesses to the frame buffer
-pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+// Frame message (a tcam_frame.h frame, the header is only sent when publishing or with
+// LEP_FRAME_HEADER)
+typedef struct {
+  tcam_frame_hdr_t hdr;
+#ifdef VOSPI_16BIT
+  uint16_t pixbuf[VOSPI_FRAME_LEN];
+#else
+  uint8_t pixbuf[VOSPI_FRAME_LEN];
+#endif
+} frame_msg_t;
 
-// The frame buffer
-vospi_frame_t* frame_buf[FRAME_BUF_SIZE];
+// Message buffers frames are converted into and handed to zmq without being copied.
+// zmq frees a buffer through free_msg_buf() once it has been sent.
+frame_msg_t msg_bufs[ZMQ_MSG_BUFS];
+int msg_buf_busy[ZMQ_MSG_BUFS];
 
-// PRU file device for RPMsg
-//
-int pru_fd;
+#ifdef LEP_V4L2_OUTPUT
+// The V4L2 output device (frames are converted straight into its buffers)
+v4l2out_t v4l2_out;
+#endif
+
+#ifdef LEP_FFC_SCHED
+// The FFC scheduler (runs with each frame before it is released)
+ffc_sched_t ffc_sched;
+#endif
+
+#ifdef LEP_FRAME_BUS
+// The frame bus (frames are converted straight into its slots)
+frame_bus_t* frame_bus;
+#endif
 
 
 
 /**
- * Attempt to configure the Lepton into AGC mode via the I2C interface
+ * zmq callback (from its I/O thread) returning a message buffer once it has been sent
  */
-int init_lepton()
+void free_msg_buf(void* data, void* hint)
 {
-  int fd;
-  uint32_t rsp;
-
-  // Open the I2C device
-  log_info("opening I2C device ... %s", i2c_dev);
-  if ((fd = open(i2c_dev, O_RDWR)) < 0) {
-    log_fatal("I2C: failed to open device - check permissions & i2c enabled");
-    return -1;
-  }
-
-  // Initialize I2C interface
-  cci_init(fd);
-  
-  // Perform a FFC to (re)initialize the sensor
-  /*
-  log_info("  Perform FFC");
-  cci_run_ffc(fd);
-  sleep(2);
-  */
-
-  // Configure Radiometry for TLinear disabled (to support AGC)
-  cci_set_radiometry_enable_state(fd, CCI_RADIOMETRY_ENABLED);
-  rsp = cci_get_radiometry_enable_state(fd);
-  log_info("  Radiometry = %d", rsp);
-  cci_set_radiometry_tlinear_enable_state(fd, CCI_RADIOMETRY_TLINEAR_DISABLED);
-  rsp = cci_get_radiometry_tlinear_enable_state(fd);
-  log_info("  Radiometry TLinear = %d", rsp);
-
-  // Enable AGC calculations
-  cci_set_agc_calc_enable_state(fd, CCI_AGC_ENABLED);
-  rsp = cci_get_agc_calc_enable_state(fd);
-  log_info("  AGC Calc En = %d", rsp);
-
-  // Enable AGC
-  cci_set_agc_enable_state(fd, CCI_AGC_ENABLED);
-  rsp = cci_get_agc_enable_state(fd);
-  log_info("  AGC = %d", rsp);
-
-  // Close up
-  close(fd);
-  return 0;
+  __atomic_store_n((int*) hint, 0, __ATOMIC_RELEASE);
 }
 
 
 /**
- * Read frames from the device into the circular buffer.
+ * Get a free message buffer, waiting for zmq to finish sending one if necessary
  */
-void* get_frames_from_device(void* prudev_path_ptr)
+int get_msg_buf()
 {
-    char* prudev_path = (char*)prudev_path_ptr;
-    int rsp;
-
-    // Declare a static frame to use as a scratch space to avoid locking the framebuffer while
-    // we're waiting for a new frame
-    vospi_frame_t frame;
-
-    // Open the PRU SPI interface device
-    log_info("opening PRU ... %s", prudev_path);
-    if ((pru_fd = open(prudev_path, O_RDWR)) < 0) {
-      log_fatal("PRU: failed to open device - check permissions & firmware loaded");
-      exit(-1);
-    }
-
-    // Enable the PRU
-    if (write(pru_fd, "1", 2) == 0) {
-        log_fatal("PRU: Failed to enable");
-        exit(-1);
+  int i, busy;
+
+  while (1) {
+    for (i=0; i<ZMQ_MSG_BUFS; i++) {
+      busy = 0;
+      if (__atomic_compare_exchange_n(&msg_buf_busy[i], &busy, 1, 0,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return i;
+      }
     }
+    usleep(1000);
+  }
+}
 
-    // Receive frames forever
-    log_info("Starting VoSPI transfers");
-    do {
 
-      rsp = sync_and_transfer_frame(pru_fd, &frame);
-      if ((rsp == -1) || (rsp == 3)) {
-	      log_error("Failed to get frame with error %d", rsp);
-	      exit(-1);
-      } else if ((rsp == 1) || (rsp == 2)) {
-	      log_info("Transfer failed with reason %d", rsp);
-      }
-      else {
-          /* got frame */
-          pthread_mutex_lock(&lock);
+/**
+ * Send len bytes at data in message buffer n without copying them.  The buffer is
+ * freed when zmq is done with it.
+ */
+void send_msg_buf(void* socket, int n, void* data, size_t len, int flags)
+{
+  zmq_msg_t msg;
 
-          // Copy the newly-received frame into place
-          memcpy(frame_buf[writer], &frame, sizeof(vospi_frame_t));
+  zmq_msg_init_data(&msg, data, len, free_msg_buf, &msg_buf_busy[n]);
+  if (zmq_msg_send(&msg, socket, flags) < 0) {
+    // Still ours, closing it frees the buffer
+    zmq_msg_close(&msg);
+  }
+}
 
-          // Move the writer ahead
-          writer = (writer + 1) & (FRAME_BUF_SIZE - 1);
 
-          // Unlock and post the space semaphore
-          pthread_mutex_unlock(&lock);
-          sem_post(&count_sem);
-      }
-    } while (1);  // Forever
+/**
+ * Fill in the tcam_frame.h header for a frame from the ring
+ */
+void fill_frame_hdr(tcam_frame_hdr_t* hdr, vospi_frame_t* frame, uint32_t seq)
+{
+  struct timespec ts;
+  int64_t now_usec;
+#ifdef VOSPI_TELEM
+  vospi_telem_t telem;
+#endif
+
+#ifdef VOSPI_16BIT
+  tcam_frame_init(hdr, 160, 120, 14, TCAM_FRAME_FMT_16LE);
+#else
+  tcam_frame_init(hdr, 160, 120, 8, TCAM_FRAME_FMT_8);
+#endif
+  hdr->seq = seq;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  now_usec = (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#ifdef VOSPI_FRAME_TIMESTAMP
+  hdr->timestamp_usec = frame->timestamp_usec;
+#else
+  hdr->timestamp_usec = now_usec;
+#endif
+  clock_gettime(CLOCK_REALTIME, &ts);
+  hdr->wall_usec = ((int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000) - (now_usec - hdr->timestamp_usec);
+  hdr->flags = TCAM_FRAME_FLAG_WALL;
+
+#ifdef VOSPI_TELEM
+  frame_to_telem(frame, &telem);
+  hdr->telem_fields = TCAM_FRAME_TEL_FRAME_CNT | TCAM_FRAME_TEL_FPA_TEMP | TCAM_FRAME_TEL_AUX_TEMP |
+                      TCAM_FRAME_TEL_FFC;
+  hdr->lep_frame_count = telem.frame_count;
+  hdr->fpa_temp_k100 = telem.fpa_temp_k100;
+  hdr->aux_temp_k100 = telem.housing_temp_k100;
+  hdr->ffc = ((telem.status & VOSPI_STATUS_FFC_STATE) >> 4) |
+             ((telem.status & VOSPI_STATUS_FFC_DESIRED) ? 0x04 : 0);
+#endif
 }
 
 
 /**
- * Wait for reqests for frames on the ZMQ socket and respond with a frame each time.
+ * Wait for reqests for frames on the ZMQ socket and respond with a frame from lep
+ * each time.
  */
-void* send_frames_to_socket(void* socket_path_ptr)
+void send_frames_to_socket(prulepton_t* lep, char* socket_path)
 {
-    uint8_t pixbuf[VOSPI_FRAME_LEN];
+    frame_msg_t* msg;
+    vospi_frame_t* frame;
+    uint32_t seq;
+    int n;
 
     // Create the ZMQ context & socket
-    char* socket_path = (char*)socket_path_ptr;
     void* context = zmq_ctx_new();
     void* responder = zmq_socket(context, ZMQ_REP);
     if (zmq_bind(responder, socket_path) != 0) {
@@ -175,33 +244,231 @@ void* send_frames_to_socket(void* socket_path_ptr)
       char req_buf[10];
       zmq_recv(responder, req_buf, 10, 0);
 
-      // Wait if there are no new frames to transmit
-      sem_wait(&count_sem);
+      // Convert the oldest frame to pixels straight from the ring into a message
+      // buffer (trying again with the next one if it was overwritten while we
+      // converted it)
+      n = get_msg_buf();
+      msg = &msg_bufs[n];
+      do {
+        if ((frame = prulepton_wait_frame(lep, &seq)) == NULL) {
+          // Capture stopped
+          return;
+        }
+#ifdef VOSPI_16BIT
+        frame_to_pixel16(frame, msg->pixbuf);
+#else
+        frame_to_pixel(frame, msg->pixbuf);
+#endif
+#ifdef LEP_FRAME_HEADER
+        fill_frame_hdr(&msg->hdr, frame, seq);
+#endif
+#ifdef LEP_FFC_SCHED
+        if (IS_PRIMARY(lep)) {
+          ffc_sched_frame(&ffc_sched, frame);
+        }
+#endif
+      } while (!prulepton_release_frame(lep, seq));
+
+      // Send the frame
+#ifdef LEP_FRAME_HEADER
+      send_msg_buf(responder, n, msg, sizeof(frame_msg_t), 0);
+#else
+      send_msg_buf(responder, n, msg->pixbuf, sizeof(msg->pixbuf), 0);
+#endif
+    }
+}
+
 
-      // Lock the data structure to prevent new frames being added while we're reading this one
-      pthread_mutex_lock(&lock);
+#ifdef LEP_FRAME_CB
+/**
+ * Frame ready callback: convert each frame straight from the ring into the next V4L2
+ * output buffer, a message buffer and the next frame bus slot and, unless it was
+ * overwritten meanwhile, queue it on the V4L2 device and publish it on the ZMQ socket
+ * and the frame bus (only the first Lepton's).  The sequence number is the
+ * frame's ring sequence so frames dropped by the ring show up as gaps.
+ */
+void serve_frame(prulepton_t* lep, vospi_frame_t* frame, uint32_t seq, void* publisher)
+{
+#ifdef LEP_V4L2_OUTPUT
+    uint8_t* buf = NULL;
+#endif
+#ifdef LEP_ZMQ_PUBSUB
+    frame_msg_t* msg;
+    int n;
+#endif
+#ifdef LEP_FRAME_BUS
+    frame_bus_slot_t* slot = NULL;
+#endif
+
+#ifdef LEP_V4L2_OUTPUT
+    // The frame is skipped on the device while all of its buffers are queued
+    if (IS_PRIMARY(lep) && ((buf = v4l2out_get_buf(&v4l2_out)) != NULL)) {
+#ifdef VOSPI_16BIT
+      frame_to_pixel16(frame, (uint16_t*) buf);
+#else
+      frame_to_pixel(frame, buf);
+#endif
+    }
+#endif
+#ifdef LEP_ZMQ_PUBSUB
+    n = get_msg_buf();
+    msg = &msg_bufs[n];
+#ifdef VOSPI_16BIT
+    frame_to_pixel16(frame, msg->pixbuf);
+#else
+    frame_to_pixel(frame, msg->pixbuf);
+#endif
+    fill_frame_hdr(&msg->hdr, frame, seq);
+#endif
+#ifdef LEP_FRAME_BUS
+    if (IS_PRIMARY(lep)) {
+      slot = frame_bus_begin(frame_bus);
+      fill_frame_hdr(&slot->hdr, frame, seq);
+#ifdef VOSPI_16BIT
+      frame_to_pixel16(frame, (uint16_t*) tcam_frame_pixels(&slot->hdr));
+#else
+      frame_to_pixel(frame, tcam_frame_pixels(&slot->hdr));
+#endif
+#ifdef VOSPI_TELEM
+      memcpy(tcam_frame_telem(&slot->hdr), frame->msg[VOSPI_FRAME_NUM_MSGS].data, VOSPI_TELEM_BYTES);
+      slot->hdr.telem_len = VOSPI_TELEM_BYTES;
+      slot->hdr.flags |= TCAM_FRAME_FLAG_TELEM_BE;
+#endif
+    }
+#endif
+#ifdef LEP_FFC_SCHED
+    if (IS_PRIMARY(lep)) {
+      ffc_sched_frame(&ffc_sched, frame);
+    }
+#endif
+
+    if (!prulepton_release_frame(lep, seq)) {
+      // Overwritten while we converted it (the V4L2 buffer is used for the next frame)
+#ifdef LEP_ZMQ_PUBSUB
+      free_msg_buf(msg, &msg_buf_busy[n]);
+#endif
+#ifdef LEP_FRAME_BUS
+      if (slot != NULL) {
+        frame_bus_cancel(frame_bus, slot);
+      }
+#endif
+      return;
+    }
 
-      // Copy the next frame out to our local buffer
-      frame_to_pixel(frame_buf[reader], pixbuf);
+#ifdef LEP_FRAME_BUS
+    if (slot != NULL) {
+      frame_bus_publish(frame_bus, slot);
+    }
+#endif
 
-      // Move the reader ahead
-      reader = (reader + 1) & (FRAME_BUF_SIZE - 1);
+#ifdef LEP_V4L2_OUTPUT
+    if (buf != NULL) {
+      (void) v4l2out_put_buf(&v4l2_out);
+    }
+#endif
+#ifdef LEP_ZMQ_PUBSUB
+    // Publish it (never blocks, subscribers over their high water mark miss it)
+    send_msg_buf(publisher, n, msg, sizeof(frame_msg_t), ZMQ_DONTWAIT);
+#endif
+}
 
-      // Unlock data structure
-      pthread_mutex_unlock(&lock);
 
-      // Send the message
-      zmq_send(responder, pixbuf, sizeof(pixbuf), 0);
+/**
+ * Open the outputs (the ZMQ_PUB socket and, for the first Lepton, the V4L2 device and
+ * the frame bus) and serve frames from lep as they arrive until capture stops
+ */
+void serve_frames(prulepton_t* lep, char* socket_path)
+{
+    void* publisher = NULL;
+#ifdef LEP_ZMQ_PUBSUB
+    int hwm = ZMQ_PUB_SNDHWM;
+
+    // Create the ZMQ context & socket
+    void* context = zmq_ctx_new();
+    publisher = zmq_socket(context, ZMQ_PUB);
+    zmq_setsockopt(publisher, ZMQ_SNDHWM, &hwm, sizeof(hwm));
+    if (zmq_bind(publisher, socket_path) != 0) {
+      log_fatal("Failed to bind to socket: %s", zmq_strerror(errno));
+      exit(1);
+    }
+#endif
+
+#ifdef LEP_V4L2_OUTPUT
+    if (IS_PRIMARY(lep)) {
+#ifdef VOSPI_16BIT
+      if (v4l2out_open(&v4l2_out, V4L2OUT_DEV, 160, 120, V4L2_PIX_FMT_Y16)) {
+#else
+      if (v4l2out_open(&v4l2_out, V4L2OUT_DEV, 160, 120, V4L2_PIX_FMT_GREY)) {
+#endif
+        exit(-1);
+      }
     }
+#endif
+
+#ifdef LEP_FRAME_BUS
+    if (IS_PRIMARY(lep)) {
+#ifdef VOSPI_16BIT
+      frame_bus = frame_bus_create(FRAME_BUS_NAME, 160, 120, FRAME_BUS_FMT_16LE);
+#else
+      frame_bus = frame_bus_create(FRAME_BUS_NAME, 160, 120, FRAME_BUS_FMT_8);
+#endif
+      if (frame_bus == NULL) {
+        log_fatal("Failed to create frame bus %s", FRAME_BUS_NAME);
+        exit(-1);
+      }
+    }
+#endif
+
+    if (prulepton_run(lep, serve_frame, publisher)) {
+      exit(-1);
+    }
+}
+#endif
+
+#ifdef VOSPI_DUAL_LEPTON
+/**
+ * Thread serving the second Lepton
+ */
+void* serve_second(void* arg)
+{
+#ifdef LEP_FRAME_CB
+  serve_frames(&leps[1], socket_path_1);
+#else
+  send_frames_to_socket(&leps[1], socket_path_1);
+#endif
+  return NULL;
+}
+#endif
+
+#ifdef LEP_FFC_SCHED
+/*
+ * SIGUSR1 signal handler running a FFC with the next frame
+ */
+void approve_ffc(int sig)
+{
+  ffc_sched_approve(&ffc_sched);
 }
+#endif
 
 /*
  * SIGINT signal handler
  */
 void sig_handler(int sig)
 {
+	int i;
+
 	// Try to shut down the PRUs before exiting
-	(void) write(pru_fd, "0", 2);
+	for (i=0; i<LEP_NUM_CAMS; i++) {
+		prulepton_stop(&leps[i]);
+	}
+#ifdef LEP_FFC_SCHED
+	ffc_sched_stop(&ffc_sched);
+#endif
+#ifdef LEP_FRAME_BUS
+	if (frame_bus != NULL) {
+		frame_bus_destroy(frame_bus, FRAME_BUS_NAME);
+	}
+#endif
 	log_info("Shutting down");
 	sleep(1); /* make sure command makes it to PRU */
 	exit(0);
@@ -213,43 +480,66 @@ void sig_handler(int sig)
  */
 int main(int argc, char *argv[])
 {
-  pthread_t get_frames_thread, send_frames_to_socket_thread;
+  prulepton_config_t config;
+#ifdef LEP_FFC_SCHED
+  ffc_sched_config_t ffc_config;
+#endif
+  char* socket_path = argc > 1 ? argv[1] : ZMQ_DEFAULT_SOCKET_SPEC;
+#ifdef VOSPI_DUAL_LEPTON
+  pthread_t second_thread;
+
+  socket_path_1 = argc > 2 ? argv[2] : ZMQ_DEFAULT_SOCKET_SPEC_1;
+#endif
 
   // Set the log level
   log_set_level(LOG_INFO);
 
-  // Setup semaphores
-  sem_init(&count_sem, 0, 0);
-
-  // Allocate space to receive the frames in the circular buffer
-  log_info("Preallocating space for frames...");
-  for (int frame = 0; frame < FRAME_BUF_SIZE; frame ++) {
-    frame_buf[frame] = malloc(sizeof(vospi_frame_t));
-  }
-
   // Attempt to initialize the lepton
-  if (init_lepton()) {
+  if (prulepton_init_lepton(i2c_dev)) {
 	  exit(-1);
   }
+#ifdef VOSPI_DUAL_LEPTON
+  if (prulepton_init_lepton(i2c_dev_1)) {
+	  exit(-1);
+  }
+#endif
 
   // Setup the signal handler
   signal(SIGINT, sig_handler);
 
-  log_info("Creating get_frames_from_device thread");
-  if (pthread_create(&get_frames_thread, NULL, get_frames_from_device, pru_dev)) {
-    log_fatal("Error creating get_frames_from_device thread");
-    return 1;
+#ifdef LEP_FFC_SCHED
+  // Take over FFC from the Lepton
+  ffc_sched_default_config(&ffc_config);
+  if (ffc_sched_start(&ffc_sched, &ffc_config, i2c_dev)) {
+    exit(-1);
   }
-
-  log_info("Creating send_frames_to_socket thread");
-  char* socket_path = argc > 1 ? argv[1] : ZMQ_DEFAULT_SOCKET_SPEC;
-  if (pthread_create(&send_frames_to_socket_thread, NULL, send_frames_to_socket, socket_path)) {
-    log_fatal("Error creating send_frames_to_socket thread");
-    return 1;
+  signal(SIGUSR1, approve_ffc);
+#endif
+
+  // Start capturing
+  prulepton_default_config(&config);
+  config.pru_dev = pru_dev;
+  if (prulepton_start(&leps[0], &config)) {
+    exit(-1);
+  }
+#ifdef VOSPI_DUAL_LEPTON
+  config.pru = 1;
+  config.i2c_dev = i2c_dev_1;
+  if (prulepton_start(&leps[1], &config)) {
+    exit(-1);
   }
 
-
-  pthread_join(get_frames_thread, NULL);
-  pthread_join(send_frames_to_socket_thread, NULL);
+  // Serve the second Lepton from its own thread
+  if (pthread_create(&second_thread, NULL, serve_second, NULL) != 0) {
+    log_fatal("Error creating second Lepton thread");
+    exit(-1);
+  }
+#endif
+
+  // Serve frames from this thread
+#ifdef LEP_FRAME_CB
+  serve_frames(&leps[0], socket_path);
+#else
+  send_frames_to_socket(&leps[0], socket_path);
+#endif
 }
-
@@ -0,0 +1,78 @@
+/*
+ * Periodically log the PRU health counters (the change since the last report) and
+ * optionally write them to a Prometheus node exporter textfile.  Must be run as root
+ * (the counters are read from /dev/mem) while the PRU firmware is running.  It can run
+ * alongside any of the applications.
+ *
+ *   pru_monitor [-i <seconds>] [-t <textfile>]
+ */
+#include "log.h"
+#include "pru_stats.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Default report interval
+#define MON_INTERVAL_SEC 10
+
+
+static void usage(char* name)
+{
+  printf("Usage: %s [-i <seconds>] [-t <textfile>]\n", name);
+  printf("  -i : Report interval (default %d seconds)\n", MON_INTERVAL_SEC);
+  printf("  -t : Also write the counters to this Prometheus textfile (for example\n");
+  printf("       /var/lib/node_exporter/textfile_collector/lepton_pru.prom)\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+  int c;
+  int interval = MON_INTERVAL_SEC;
+  char* textfile = NULL;
+  pru_stats_reader_t reader;
+  pru_stats_t last, cur;
+
+  while ((c = getopt(argc, argv, "i:t:h")) != -1) {
+    switch (c) {
+      case 'i':
+        interval = atoi(optarg);
+        if (interval < 1) interval = 1;
+        break;
+      case 't':
+        textfile = optarg;
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+
+  log_set_level(LOG_INFO);
+
+  if (pru_stats_open(&reader)) {
+    exit(-1);
+  }
+
+  pru_stats_read(&reader, &last);
+  while (1) {
+    sleep(interval);
+    pru_stats_read(&reader, &cur);
+
+    // Unsigned differences handle the counters wrapping
+    log_info("PRU0: %u frames, %u discards, %u crc fails, %u restarts, %u resyncs",
+             cur.p0_frames - last.p0_frames, cur.p0_discard_pkts - last.p0_discard_pkts,
+             cur.p0_crc_fails - last.p0_crc_fails, cur.p0_restarts - last.p0_restarts,
+             cur.p0_resyncs - last.p0_resyncs);
+    log_info("PRU1: %u frames, %u aborts, %u timing fails, %u send fails",
+             cur.p1_frames - last.p1_frames, cur.p1_aborts - last.p1_aborts,
+             cur.p1_timing_fails - last.p1_timing_fails, cur.p1_send_fails - last.p1_send_fails);
+    if (textfile != NULL) {
+      (void) pru_stats_write_textfile(textfile, &cur);
+    }
+    last = cur;
+  }
+
+  return 0;
+}
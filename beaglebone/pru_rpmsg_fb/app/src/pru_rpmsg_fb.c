@@ -1,6 +1,6 @@
-#include "cci.h"
 #include "fb.h"
 #include "log.h"
+#include "prulepton.h"
 #include "vospi.h"
 #include <signal.h>
 #include <stdio.h>
@@ -8,22 +8,37 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
-#include <pthread.h>
-#include <semaphore.h>
 #include <assert.h>
 #include <string.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
 
 
-// The size of the circular frame buffer
-#define FRAME_BUF_SIZE 8
+// Uncomment to run a single event driven thread that waits on the PRU device with
+// epoll, takes all waiting messages with one readv() and draws each message's rows
+// into the frame buffer as it arrives instead of handing complete frames from a
+// reader thread to a display thread.  The frame is displayed as soon as its last
+// message arrives.
+//#define RPMSG_FB_EPOLL
+
+#ifdef RPMSG_FB_EPOLL
+#if defined(VOSPI_16BIT) || defined(VOSPI_DDR_RING)
+#error "RPMSG_FB_EPOLL requires 8-bit rpmsg frames"
+#endif
+
+// Maximum messages taken with one readv()
+#define RPMSG_BATCH_MSGS 8
+
+// Image rows in each message
+#define ROWS_PER_MSG     (VOSPI_MSG_DATA_BYTES / 160)
+#endif
 
 /* ------------ */
 /* Device files */
 /* ------------ */
-char i2c_dev[] = "/dev/i2c-2";
-char pru_dev[] = "/dev/rpmsg_pru31";
+char i2c_dev[] = PRULEPTON_I2C_DEV;
+char pru_dev[] = PRULEPTON_PRU_DEV;
 char fb_dev[] = "/dev/fb0";
 
 
@@ -31,158 +46,137 @@ char fb_dev[] = "/dev/fb0";
 /* Local Variables */
 /* --------------- */
 
-// Positions of the reader and writer in the frame buffer
-int reader = 0, writer = 0;
-
-// semaphore tracking the number of frames available
-sem_t count_sem;
-
-// a lock protecting accesses to the frame buffer
-pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
-
+#ifdef RPMSG_FB_EPOLL
 // PRU file device for RPMsg
 //
 int pru_fd;
-
-// The frame buffer
-vospi_frame_t* frame_buf[FRAME_BUF_SIZE];
+#else
+// The PRU Lepton handle (frames are transferred into and displayed from its ring in
+// place)
+prulepton_t lep;
+#endif
 
 
 
+#ifndef RPMSG_FB_EPOLL
 /**
- * Attempt to configure the Lepton into AGC mode via the I2C interface
+ * Display each frame as it becomes ready
  */
-int init_lepton()
+void frame_ready(prulepton_t* lep, vospi_frame_t* frame, uint32_t seq, void* arg)
 {
-  int fd;
-  uint32_t rsp;
-
-  // Open the I2C device
-  log_info("opening I2C device ... %s", i2c_dev);
-  if ((fd = open(i2c_dev, O_RDWR)) < 0) {
-    log_fatal("I2C: failed to open device - check permissions & i2c enabled");
-    return -1;
-  }
+    uint8_t* pixbuf = (uint8_t*) arg;
+
+    // Convert it to pixels straight from the ring
+    frame_to_pixel(frame, pixbuf);
 
-  // Initialize I2C interface
-  cci_init(fd);
-  
-  // Perform a FFC to (re)initialize the sensor
-  /*
-  log_info("  Perform FFC");
-  cci_run_ffc(fd);
-  sleep(2);
-  */
-
-  // Configure Radiometry for TLinear disabled (to support AGC)
-  cci_set_radiometry_enable_state(fd, CCI_RADIOMETRY_ENABLED);
-  rsp = cci_get_radiometry_enable_state(fd);
-  log_info("  Radiometry = %d", rsp);
-  cci_set_radiometry_tlinear_enable_state(fd, CCI_RADIOMETRY_TLINEAR_DISABLED);
-  rsp = cci_get_radiometry_tlinear_enable_state(fd);
-  log_info("  Radiometry TLinear = %d", rsp);
-
-  // Enable AGC calculations
-  cci_set_agc_calc_enable_state(fd, CCI_AGC_ENABLED);
-  rsp = cci_get_agc_calc_enable_state(fd);
-  log_info("  AGC Calc En = %d", rsp);
-
-  // Enable AGC
-  cci_set_agc_enable_state(fd, CCI_AGC_ENABLED);
-  rsp = cci_get_agc_enable_state(fd);
-  log_info("  AGC = %d", rsp);
-
-  // Close up
-  close(fd);
-  return 0;
+    // Render it into the frame buffer unless it was overwritten while we converted it
+    if (prulepton_release_frame(lep, seq)) {
+      update_fb(pixbuf);
+    }
 }
+#endif
 
 
+#ifdef RPMSG_FB_EPOLL
 /**
- * Read frames from the device into the circular buffer.
+ * Draw the rows in a message if it is the next one in the frame.  Returns the next
+ * expected sequence number.
  */
-void* get_frames_from_device(void* prudev_path_ptr)
+int process_msg(vospi_rpmsg_t* msg, uint8_t* pixbuf, int exp_seq)
 {
-    char* prudev_path = (char*)prudev_path_ptr;
-    int rsp;
-
-    // Declare a static frame to use as a scratch space to avoid locking the framebuffer while
-    // we're waiting for a new frame
-    vospi_frame_t frame;
-
-    // Open the PRU SPI interface device
-    log_info("opening PRU ... %s", prudev_path);
-    if ((pru_fd = open(prudev_path, O_RDWR)) < 0) {
-      log_fatal("PRU: failed to open device - check permissions & firmware loaded");
-      exit(-1);
-    }
-
-    // Enable the PRU
-    if (write(pru_fd, "1", 2) == 0) {
-        log_fatal("PRU: Failed to enable");
-        exit(-1);
-    }
-
-    // Receive frames forever
-    log_info("Starting VoSPI transfers");
-    do {
-
-      rsp = sync_and_transfer_frame(pru_fd, &frame);
-      if ((rsp == -1) || (rsp == 3)) {
-	      log_error("Failed to get frame with error %d", rsp);
-	      exit(-1);
-      } else if ((rsp == 1) || (rsp == 2)) {
-	      log_info("Transfer failed with reason %d", rsp);
+    if (msg->seq != exp_seq) {
+      if (msg->seq != 0) {
+        // Abort, statistics or out of sequence, wait for the start of the next frame
+        if ((msg->seq == VOSPI_ABORT_MSG) || (exp_seq != 0)) {
+          log_info("Transfer failed with reason %d", (msg->seq == VOSPI_ABORT_MSG) ? 2 : 1);
+        }
+        return 0;
       }
-      else {
-          /* got frame */
-          pthread_mutex_lock(&lock);
-
-          // Copy the newly-received frame into place
-          memcpy(frame_buf[writer], &frame, sizeof(vospi_frame_t));
+      exp_seq = 0;
+    }
 
-          // Move the writer ahead
-          writer = (writer + 1) & (FRAME_BUF_SIZE - 1);
+    memcpy(pixbuf + exp_seq * VOSPI_MSG_DATA_BYTES, msg->data, VOSPI_MSG_DATA_BYTES);
+    draw_fb_rows(pixbuf, exp_seq * ROWS_PER_MSG, ROWS_PER_MSG);
 
-          // Unlock and post the space semaphore
-          pthread_mutex_unlock(&lock);
-          sem_post(&count_sem);
-      }
-    } while (1);  // Forever
+    if (++exp_seq == VOSPI_FRAME_NUM_MSGS) {
+      /* got frame */
+      show_fb();
+      return 0;
+    }
+    return exp_seq;
 }
 
 
 /**
- * Send frames to the fb as soon as they are ready
+ * Receive messages from the device and draw them as they arrive
  */
-void* send_frames_to_fb(void* fbdev_path_ptr)
+void run_event_loop(char* prudev_path, char* fbdev_path)
 {
-    char* fbdev_path = (char*)fbdev_path_ptr;
+    vospi_rpmsg_t batch[RPMSG_BATCH_MSGS];
+    struct iovec iov[RPMSG_BATCH_MSGS];
+    struct epoll_event ev;
     uint8_t pixbuf[VOSPI_FRAME_LEN];
+    int epfd;
+    int exp_seq = 0;
+    int i, n, len;
 
     // Initialize frame buffer
     (void) init_fb(fbdev_path);
 
-    while (1) {
-      // Wait if there are no new frames to transmit
-      sem_wait(&count_sem);
+    // Open the PRU SPI interface device
+    log_info("opening PRU ... %s", prudev_path);
+    if ((pru_fd = open(prudev_path, O_RDWR | O_NONBLOCK)) < 0) {
+      log_fatal("PRU: failed to open device - check permissions & firmware loaded");
+      exit(-1);
+    }
 
-      // Lock the data structure to prevent new frames being added while we're reading this one
-      pthread_mutex_lock(&lock);
+    epfd = epoll_create1(0);
+    ev.events = EPOLLIN;
+    ev.data.fd = pru_fd;
+    if ((epfd < 0) || (epoll_ctl(epfd, EPOLL_CTL_ADD, pru_fd, &ev) < 0)) {
+      log_fatal("PRU: failed to setup epoll");
+      exit(-1);
+    }
 
-      // Copy the next frame out to our local buffer
-      frame_to_pixel(frame_buf[reader], pixbuf);
+    // rpmsg_pru returns one message for each read so each iovec gets one message
+    for (i=0; i<RPMSG_BATCH_MSGS; i++) {
+      iov[i].iov_base = &batch[i];
+      iov[i].iov_len = VOSPI_MSG_TOTAL_BYTES;
+    }
 
-      // Move the reader ahead
-      reader = (reader + 1) & (FRAME_BUF_SIZE - 1);
+    // Set the PRU timing and enable the PRU
+    (void) vospi_set_timing(pru_fd, VOSPI_SAMPLE_USEC, VOSPI_XMIT_USEC);
+    if (write(pru_fd, "1", 2) == 0) {
+        log_fatal("PRU: Failed to enable");
+        exit(-1);
+    }
 
-      // Unlock data structure
-      pthread_mutex_unlock(&lock);
+    // Receive messages forever
+    log_info("Starting VoSPI transfers");
+    while (1) {
+      if (epoll_wait(epfd, &ev, 1, -1) < 0) {
+        if (errno == EINTR) continue;
+        log_fatal("PRU: epoll failed");
+        exit(-1);
+      }
 
-      // Render it into the frame buffer
-      update_fb(pixbuf);
+      // Take all the waiting messages
+      do {
+        len = readv(pru_fd, iov, RPMSG_BATCH_MSGS);
+        if (len < 0) {
+          if ((errno == EAGAIN) || (errno == EINTR)) break;
+          log_fatal("RPMSG: failed to transfer packet");
+          exit(-1);
+        }
+        n = len / VOSPI_MSG_TOTAL_BYTES;
+        for (i=0; i<n; i++) {
+          exp_seq = process_msg(&batch[i], pixbuf, exp_seq);
+        }
+      } while (n == RPMSG_BATCH_MSGS);
     }
 }
+#endif
+
 
 /*
  * SIGINT signal handler
@@ -190,7 +184,11 @@ void* send_frames_to_fb(void* fbdev_path_ptr)
 void sig_handler(int sig)
 {
 	// Try to shut down the PRUs before exiting
+#ifdef RPMSG_FB_EPOLL
 	(void) write(pru_fd, "0", 2);
+#else
+	prulepton_stop(&lep);
+#endif
 	log_info("Shutting down");
 	sleep(1); /* make sure command makes it to PRU */
 	exit(0);
@@ -202,45 +200,41 @@ void sig_handler(int sig)
  */
 int main(int argc, char *argv[])
 {
-  pthread_t get_frames_thread, send_frames_to_fb_thread;
+#ifndef RPMSG_FB_EPOLL
+  prulepton_config_t config;
+  uint8_t pixbuf[VOSPI_FRAME_LEN];
+#endif
 
   // Set the log level
   log_set_level(LOG_INFO);
 
-  // Setup semaphores
-  sem_init(&count_sem, 0, 0);
-
-  // Allocate space to receive the frames in the circular buffer
-  log_info("Preallocating space for frames...");
-  for (int frame = 0; frame < FRAME_BUF_SIZE; frame ++) {
-    frame_buf[frame] = malloc(sizeof(vospi_frame_t));
-  }
-
   // Setup colormap if user has selected a non-default
   if (argc > 1) {
 	  set_colormap(atoi(argv[1]));
   }
 
   // Attempt to initialize the lepton
-  if (init_lepton()) {
+  if (prulepton_init_lepton(i2c_dev)) {
 	  exit(-1);
   }
 
   // Setup the signal handler
   signal(SIGINT, sig_handler);
 
-  log_info("Creating get_frames_from_device thread");
-  if (pthread_create(&get_frames_thread, NULL, get_frames_from_device, pru_dev)) {
-    log_fatal("Error creating get_frames_from_device thread");
-    return 1;
+#ifdef RPMSG_FB_EPOLL
+  run_event_loop(pru_dev, fb_dev);
+#else
+  // Initialize frame buffer
+  (void) init_fb(fb_dev);
+
+  // Start capturing and display frames as they arrive
+  prulepton_default_config(&config);
+  config.pru_dev = pru_dev;
+  if (prulepton_start(&lep, &config)) {
+    exit(-1);
   }
-
-  log_info("Creating send_frames_to_fb thread");
-  if (pthread_create(&send_frames_to_fb_thread, NULL, send_frames_to_fb, fb_dev)) {
-    log_fatal("Error creating send_frames_to_fb thread");
-    return 1;
+  if (prulepton_run(&lep, frame_ready, pixbuf)) {
+    exit(-1);
   }
-
-  pthread_join(get_frames_thread, NULL);
-  pthread_join(send_frames_to_fb_thread, NULL);
+#endif
 }
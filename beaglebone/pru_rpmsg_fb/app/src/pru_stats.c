@@ -0,0 +1,122 @@
+#include "log.h"
+#include "pru_stats.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+
+
+/**
+ * Map the counters in the PRU shared RAM.  Returns 0 for success, -1 if they could not
+ * be mapped or the firmware doesn't keep them.
+ */
+int pru_stats_open(pru_stats_reader_t* reader)
+{
+	int fd;
+
+	if ((fd = open("/dev/mem", O_RDONLY | O_SYNC)) < 0) {
+		log_error("STATS: failed to open /dev/mem - check permissions");
+		return -1;
+	}
+	reader->map = mmap(NULL, PRU_STATS_SMEM_LEN, PROT_READ, MAP_SHARED, fd, PRU_STATS_SMEM_PA);
+	close(fd);
+	if (reader->map == MAP_FAILED) {
+		log_error("STATS: failed to map the PRU shared RAM");
+		return -1;
+	}
+
+	reader->stats = (volatile pru_stats_t*) ((uint8_t*) reader->map + PRU_STATS_OFFSET);
+	if (reader->stats->magic != PRU_STATS_MAGIC) {
+		log_error("STATS: no counters - check the PRU firmware is running");
+		pru_stats_close(reader);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+void pru_stats_close(pru_stats_reader_t* reader)
+{
+	munmap(reader->map, PRU_STATS_SMEM_LEN);
+	reader->map = NULL;
+	reader->stats = NULL;
+}
+
+
+/**
+ * Take a copy of the counters
+ */
+void pru_stats_read(pru_stats_reader_t* reader, pru_stats_t* stats)
+{
+	stats->magic = reader->stats->magic;
+	stats->p0_discard_pkts = reader->stats->p0_discard_pkts;
+	stats->p0_crc_fails = reader->stats->p0_crc_fails;
+	stats->p0_restarts = reader->stats->p0_restarts;
+	stats->p0_resyncs = reader->stats->p0_resyncs;
+	stats->p0_frames = reader->stats->p0_frames;
+	stats->p1_aborts = reader->stats->p1_aborts;
+	stats->p1_timing_fails = reader->stats->p1_timing_fails;
+	stats->p1_send_fails = reader->stats->p1_send_fails;
+	stats->p1_frames = reader->stats->p1_frames;
+}
+
+
+/**
+ * Write the counters to a Prometheus node exporter textfile (written to a temporary
+ * file and renamed so the exporter never sees a partial file).  Returns 0 for
+ * success, -1 for failure.
+ */
+int pru_stats_write_textfile(const char* path, pru_stats_t* stats)
+{
+	char tmp_path[256];
+	FILE* fp;
+
+	snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+	if ((fp = fopen(tmp_path, "w")) == NULL) {
+		log_error("STATS: failed to create %s", tmp_path);
+		return -1;
+	}
+
+	fprintf(fp, "# HELP lepton_pru_discard_packets_total Discard packets from the Lepton\n");
+	fprintf(fp, "# TYPE lepton_pru_discard_packets_total counter\n");
+	fprintf(fp, "lepton_pru_discard_packets_total %u\n", stats->p0_discard_pkts);
+	fprintf(fp, "# HELP lepton_pru_crc_fails_total Packets with a bad CRC\n");
+	fprintf(fp, "# TYPE lepton_pru_crc_fails_total counter\n");
+	fprintf(fp, "lepton_pru_crc_fails_total %u\n", stats->p0_crc_fails);
+	fprintf(fp, "# HELP lepton_pru_restarts_total Capture restarts after an unexpected packet\n");
+	fprintf(fp, "# TYPE lepton_pru_restarts_total counter\n");
+	fprintf(fp, "lepton_pru_restarts_total %u\n", stats->p0_restarts);
+	fprintf(fp, "# HELP lepton_pru_resyncs_total Lepton resyncs\n");
+	fprintf(fp, "# TYPE lepton_pru_resyncs_total counter\n");
+	fprintf(fp, "lepton_pru_resyncs_total %u\n", stats->p0_resyncs);
+	fprintf(fp, "# HELP lepton_pru_frames_captured_total Frames captured by PRU0\n");
+	fprintf(fp, "# TYPE lepton_pru_frames_captured_total counter\n");
+	fprintf(fp, "lepton_pru_frames_captured_total %u\n", stats->p0_frames);
+	fprintf(fp, "# HELP lepton_pru_aborts_total Frames aborted by PRU0\n");
+	fprintf(fp, "# TYPE lepton_pru_aborts_total counter\n");
+	fprintf(fp, "lepton_pru_aborts_total %u\n", stats->p1_aborts);
+	fprintf(fp, "# HELP lepton_pru_timing_fails_total Frames aborted for a message under/overrun\n");
+	fprintf(fp, "# TYPE lepton_pru_timing_fails_total counter\n");
+	fprintf(fp, "lepton_pru_timing_fails_total %u\n", stats->p1_timing_fails);
+	fprintf(fp, "# HELP lepton_pru_send_fails_total Failed rpmsg sends\n");
+	fprintf(fp, "# TYPE lepton_pru_send_fails_total counter\n");
+	fprintf(fp, "lepton_pru_send_fails_total %u\n", stats->p1_send_fails);
+	fprintf(fp, "# HELP lepton_pru_frames_sent_total Frames sent to the host\n");
+	fprintf(fp, "# TYPE lepton_pru_frames_sent_total counter\n");
+	fprintf(fp, "lepton_pru_frames_sent_total %u\n", stats->p1_frames);
+
+	if (fclose(fp) != 0) {
+		log_error("STATS: failed to write %s", tmp_path);
+		return -1;
+	}
+	if (rename(tmp_path, path) != 0) {
+		log_error("STATS: failed to rename %s", tmp_path);
+		return -1;
+	}
+
+	return 0;
+}
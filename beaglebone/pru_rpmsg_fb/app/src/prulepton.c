@@ -0,0 +1,438 @@
+#define _GNU_SOURCE
+#include "cci.h"
+#include "log.h"
+#include "prulepton.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+
+
+/**
+ * Signal the handle's event descriptor and wake any thread waiting for a frame
+ */
+static void notify(prulepton_t* lep)
+{
+	uint64_t one = 1;
+
+	(void) write(lep->event_fd, &one, sizeof(one));
+}
+
+
+/**
+ * Enable or disable the PRUs
+ */
+static void pru_enable(prulepton_t* lep, int enable)
+{
+#ifdef VOSPI_DUAL_LEPTON
+	if (enable) {
+		// A PRU that doesn't start fails the next transfer (the next recovery level)
+		(void) vospi_pru_start(&lep->pru, VOSPI_SAMPLE_USEC);
+	} else {
+		vospi_pru_stop(&lep->pru);
+	}
+#else
+	(void) write(lep->pru_fd, enable ? "1" : "0", 2);
+#endif
+}
+
+
+/**
+ * Reboot the Lepton and configure it again.  Returns 0 for success, -1 for failure.
+ */
+static int reboot_lepton(char* i2c_dev)
+{
+	int fd;
+
+	if ((fd = prulepton_open_cci(i2c_dev)) < 0) {
+		return -1;
+	}
+	cc_run_oem_reboot(fd);
+	close(fd);
+
+	return prulepton_init_lepton(i2c_dev);
+}
+
+
+/**
+ * Recover from a transfer that failed with rsp, escalating with each failure since
+ * the last frame (see prulepton.h).  Returns 0 when there is nothing left to try.
+ */
+static int recover(prulepton_t* lep, int rsp)
+{
+	int n = ++lep->failures;
+
+	pru_enable(lep, 0);
+	if (n <= PRULEPTON_RESYNC_TRIES) {
+		log_error("Failed to get frame with error %d - restarting the PRUs (%d)", rsp, n);
+		usleep(PRULEPTON_RESYNC_MSEC * 1000);
+	} else if ((lep->config.i2c_dev != NULL) && (n <= PRULEPTON_RESYNC_TRIES + PRULEPTON_REBOOT_TRIES)) {
+		log_error("Failed to get frame with error %d - rebooting the Lepton (%d)", rsp,
+		          n - PRULEPTON_RESYNC_TRIES);
+		lep->reboots++;
+		if (reboot_lepton(lep->config.i2c_dev)) {
+			log_error("Lepton reboot failed");
+		}
+	} else {
+		log_error("Failed to get frame with error %d - giving up", rsp);
+		return 0;
+	}
+
+	lep->recoveries++;
+	if (lep->running) {
+		pru_enable(lep, 1);
+	}
+	return 1;
+}
+
+
+/**
+ * Capture thread: read frames from the device directly into the frame ring
+ */
+static void* capture_frames(void* lep_ptr)
+{
+	prulepton_t* lep = (prulepton_t*) lep_ptr;
+	vospi_frame_t* frame;
+	int rsp;
+
+	log_info("Starting VoSPI transfers");
+	while (lep->running) {
+		// Transfer into the next ring slot (dropping the oldest frame if the ring is full)
+		frame = frame_ring_get_write(&lep->ring);
+#ifdef VOSPI_DUAL_LEPTON
+		rsp = vospi_pru_transfer_frame(&lep->pru, frame);
+#else
+		rsp = sync_and_transfer_frame(lep->pru_fd, frame);
+#endif
+		if ((rsp == -1) || (rsp == 3)) {
+			if (lep->running && !recover(lep, rsp)) {
+				lep->error = 1;
+				lep->running = 0;
+			}
+		} else if ((rsp == 1) || (rsp == 2)) {
+			log_info("Transfer failed with reason %d", rsp);
+		} else {
+			/* got frame */
+			lep->failures = 0;
+			frame_ring_push(&lep->ring);
+			notify(lep);
+		}
+	}
+
+	// Wake the consumer so it sees capture has stopped
+	sem_post(&lep->ring.push_sem);
+	notify(lep);
+	return NULL;
+}
+
+
+/**
+ * Create the capture thread with the configured scheduling.  Falls back to a normal
+ * thread if the real-time scheduling can't be set (e.g. not running as root).
+ * Returns 0 for success, -1 for failure.
+ */
+static int create_capture_thread(prulepton_t* lep)
+{
+	pthread_attr_t attr;
+	struct sched_param param;
+	cpu_set_t cpus;
+	int rsp = -1;
+
+	if (lep->config.rt_priority > 0) {
+		pthread_attr_init(&attr);
+		pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+		param.sched_priority = lep->config.rt_priority;
+		pthread_attr_setschedparam(&attr, &param);
+		rsp = pthread_create(&lep->capture_thread, &attr, capture_frames, lep);
+		pthread_attr_destroy(&attr);
+		if (rsp != 0) {
+			log_info("Capture thread: SCHED_FIFO priority %d not permitted - using normal scheduling",
+			         lep->config.rt_priority);
+		}
+	}
+	if ((rsp != 0) && (pthread_create(&lep->capture_thread, NULL, capture_frames, lep) != 0)) {
+		log_fatal("Error creating capture thread");
+		return -1;
+	}
+
+	if (lep->config.cpu >= 0) {
+		CPU_ZERO(&cpus);
+		CPU_SET(lep->config.cpu, &cpus);
+		if (pthread_setaffinity_np(lep->capture_thread, sizeof(cpus), &cpus) != 0) {
+			log_info("Capture thread: could not pin to CPU %d", lep->config.cpu);
+		}
+	}
+
+	return 0;
+}
+
+
+
+/**
+ * Open the I2C device and initialize the CCI interface.  Returns the file descriptor
+ * or -1 for failure.
+ */
+int prulepton_open_cci(char* i2c_dev)
+{
+	int fd;
+
+	// Open the I2C device
+	log_info("opening I2C device ... %s", i2c_dev);
+	if ((fd = open(i2c_dev, O_RDWR)) < 0) {
+		log_fatal("I2C: failed to open device - check permissions & i2c enabled");
+		return -1;
+	}
+
+	// Initialize I2C interface
+	cci_init(fd);
+
+	return fd;
+}
+
+
+/**
+ * Attempt to configure the Lepton into AGC mode (or Radiometric TLinear mode for
+ * VOSPI_16BIT) via the I2C interface.  Returns 0 for success, -1 for failure.
+ */
+int prulepton_init_lepton(char* i2c_dev)
+{
+	int fd;
+	uint32_t rsp;
+
+	if ((fd = prulepton_open_cci(i2c_dev)) < 0) {
+		return -1;
+	}
+
+	// Perform a FFC to (re)initialize the sensor
+	/*
+	log_info("  Perform FFC");
+	cci_run_ffc(fd);
+	sleep(2);
+	*/
+
+	// Configure Radiometry for TLinear disabled (to support AGC) or enabled (16-bit)
+	cci_set_radiometry_enable_state(fd, CCI_RADIOMETRY_ENABLED);
+	rsp = cci_get_radiometry_enable_state(fd);
+	log_info("  Radiometry = %d", rsp);
+#ifdef VOSPI_16BIT
+	cci_set_radiometry_tlinear_enable_state(fd, CCI_RADIOMETRY_TLINEAR_ENABLED);
+#else
+	cci_set_radiometry_tlinear_enable_state(fd, CCI_RADIOMETRY_TLINEAR_DISABLED);
+#endif
+	rsp = cci_get_radiometry_tlinear_enable_state(fd);
+	log_info("  Radiometry TLinear = %d", rsp);
+
+#ifdef VOSPI_16BIT
+	// Disable AGC for 16-bit radiometric pixels
+	cci_set_agc_enable_state(fd, CCI_AGC_DISABLED);
+#else
+	// Enable AGC calculations
+	cci_set_agc_calc_enable_state(fd, CCI_AGC_ENABLED);
+	rsp = cci_get_agc_calc_enable_state(fd);
+	log_info("  AGC Calc En = %d", rsp);
+
+	// Enable AGC
+	cci_set_agc_enable_state(fd, CCI_AGC_ENABLED);
+#endif
+	rsp = cci_get_agc_enable_state(fd);
+	log_info("  AGC = %d", rsp);
+
+	// Telemetry in the location PRU0 was built to skip
+#if defined(VOSPI_TELEM_HEADER) || defined(VOSPI_TELEM_FOOTER)
+#ifdef VOSPI_TELEM_HEADER
+	cci_set_telemetry_location(fd, CCI_TELEMETRY_LOCATION_HEADER);
+#else
+	cci_set_telemetry_location(fd, CCI_TELEMETRY_LOCATION_FOOTER);
+#endif
+	rsp = cci_get_telemetry_location(fd);
+	log_info("  Telemetry Location = %d", rsp);
+	cci_set_telemetry_enable_state(fd, CCI_TELEMETRY_ENABLED);
+#else
+	cci_set_telemetry_enable_state(fd, CCI_TELEMETRY_DISABLED);
+#endif
+	rsp = cci_get_telemetry_enable_state(fd);
+	log_info("  Telemetry = %d", rsp);
+
+	// Close up
+	close(fd);
+	return 0;
+}
+
+
+/**
+ * Fill in the default configuration: the default PRU device and a normally scheduled
+ * capture thread on any CPU
+ */
+void prulepton_default_config(prulepton_config_t* config)
+{
+	config->pru_dev = PRULEPTON_PRU_DEV;
+	config->rt_priority = 0;
+	config->cpu = -1;
+	config->i2c_dev = PRULEPTON_I2C_DEV;
+#ifdef VOSPI_DUAL_LEPTON
+	config->pru = 0;
+#endif
+}
+
+
+/**
+ * Allocate the frame ring, open and enable the PRUs and start the capture thread.  The
+ * Lepton should already be configured with prulepton_init_lepton().  Returns 0 for
+ * success, -1 for failure.
+ */
+int prulepton_start(prulepton_t* lep, prulepton_config_t* config)
+{
+	memset(lep, 0, sizeof(prulepton_t));
+	lep->config = *config;
+	lep->pru_fd = -1;
+
+	// Allocate space to receive the frames in the frame ring
+	log_info("Preallocating space for frames...");
+	if (frame_ring_init(&lep->ring)) {
+		return -1;
+	}
+
+	if ((lep->event_fd = eventfd(0, EFD_NONBLOCK)) < 0) {
+		log_fatal("Failed to create event descriptor");
+		return -1;
+	}
+
+#ifdef VOSPI_DUAL_LEPTON
+	// Find the PRU's control block, set its timing, enable it and map its ring
+	log_info("starting PRU%d", config->pru);
+	if (vospi_pru_open(&lep->pru, config->pru)) {
+		return -1;
+	}
+	if (vospi_pru_start(&lep->pru, VOSPI_SAMPLE_USEC)) {
+		return -1;
+	}
+#else
+	// Open the PRU SPI interface device
+	log_info("opening PRU ... %s", config->pru_dev);
+	if ((lep->pru_fd = open(config->pru_dev, O_RDWR)) < 0) {
+		log_fatal("PRU: failed to open device - check permissions & firmware loaded");
+		return -1;
+	}
+
+	// Set the PRU timing and enable the PRU
+	(void) vospi_set_timing(lep->pru_fd, VOSPI_SAMPLE_USEC, VOSPI_XMIT_USEC);
+	if (write(lep->pru_fd, "1", 2) == 0) {
+		log_fatal("PRU: Failed to enable");
+		return -1;
+	}
+#endif
+
+	lep->running = 1;
+	if (create_capture_thread(lep)) {
+		lep->running = 0;
+		prulepton_stop(lep);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Disable the PRUs and stop capturing.  Waiting consumers return without a frame.
+ * Only makes system calls that are safe from a signal handler.
+ */
+void prulepton_stop(prulepton_t* lep)
+{
+	lep->running = 0;
+#ifdef VOSPI_DUAL_LEPTON
+	vospi_pru_stop(&lep->pru);
+#else
+	if (lep->pru_fd >= 0) {
+		(void) write(lep->pru_fd, "0", 2);
+	}
+#endif
+	sem_post(&lep->ring.push_sem);
+	notify(lep);
+}
+
+
+/**
+ * Return a file descriptor that polls readable when frames are available.  After it
+ * does, call prulepton_get_frame() until it returns NULL.
+ */
+int prulepton_get_fd(prulepton_t* lep)
+{
+	return lep->event_fd;
+}
+
+
+/**
+ * Return the oldest frame without blocking or NULL if there isn't one (or capture has
+ * stopped).  seq identifies the frame for prulepton_release_frame().
+ */
+vospi_frame_t* prulepton_get_frame(prulepton_t* lep, uint32_t* seq)
+{
+	uint64_t count;
+
+	// Clear the event before looking so a frame pushed after we look sets it again
+	(void) read(lep->event_fd, &count, sizeof(count));
+
+	if (!lep->running) {
+		return NULL;
+	}
+	return frame_ring_try_read(&lep->ring, seq);
+}
+
+
+/**
+ * Block until there is a frame and return the oldest one.  Returns NULL if capture
+ * stops.  seq identifies the frame for prulepton_release_frame().
+ */
+vospi_frame_t* prulepton_wait_frame(prulepton_t* lep, uint32_t* seq)
+{
+	vospi_frame_t* frame;
+
+	while (lep->running) {
+		if ((frame = frame_ring_try_read(&lep->ring, seq)) != NULL) {
+			return frame;
+		}
+		// Empty (extra posts are left by dropped frames)
+		sem_wait(&lep->ring.push_sem);
+	}
+
+	return NULL;
+}
+
+
+/**
+ * Release a frame so its slot can be reused.  Returns false if the frame was dropped
+ * (and may have been overwritten) while it was being processed.
+ */
+int prulepton_release_frame(prulepton_t* lep, uint32_t seq)
+{
+	return frame_ring_release(&lep->ring, seq);
+}
+
+
+/**
+ * Call cb for each frame as it becomes ready until capture stops.  Returns 0 if
+ * stopped with prulepton_stop(), -1 if the device failed.
+ */
+int prulepton_run(prulepton_t* lep, prulepton_frame_cb_t cb, void* arg)
+{
+	vospi_frame_t* frame;
+	uint32_t seq;
+
+	while ((frame = prulepton_wait_frame(lep, &seq)) != NULL) {
+		cb(lep, frame, seq, arg);
+
+		// Does nothing if the callback already released it
+		(void) frame_ring_release(&lep->ring, seq);
+	}
+
+	return lep->error ? -1 : 0;
+}
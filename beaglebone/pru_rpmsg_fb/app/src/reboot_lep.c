@@ -1,31 +1,24 @@
 #include "cci.h"
 #include "log.h"
+#include "prulepton.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <unistd.h>
 #include <stdlib.h>
-#include <fcntl.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
 
 
-char i2c_dev[] = "/dev/i2c-2";
+char i2c_dev[] = PRULEPTON_I2C_DEV;
 
 
 int main(int argc, char *argv[])
 {
   int fd;
 
-  // Open the I2C device
-  log_info("opening I2C device ... %s", i2c_dev);
-  if ((fd = open(i2c_dev, O_RDWR)) < 0) {
-    log_fatal("I2C: failed to open device - check permissions & i2c enabled");
+  // Open the I2C device and initialize the CCI interface
+  if ((fd = prulepton_open_cci(i2c_dev)) < 0) {
     return -1;
   }
 
-  // Initialize I2C interface
-  cci_init(fd);
-  
   // Reboot the Lepton in case it's in a funny state
   log_info("Starting reboot...");
   cc_run_oem_reboot(fd);
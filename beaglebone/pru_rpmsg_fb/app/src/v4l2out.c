@@ -0,0 +1,180 @@
+#include "log.h"
+#include "v4l2out.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+
+/**
+ * Open a V4L2 output device for width x height frames of pixfmt (V4L2_PIX_FMT_GREY
+ * or V4L2_PIX_FMT_Y16), map its buffers and start streaming.  Returns 0 for success,
+ * -1 for failure.
+ */
+int v4l2out_open(v4l2out_t* out, char* dev, int width, int height, uint32_t pixfmt)
+{
+	struct v4l2_format fmt;
+	struct v4l2_streamparm parm;
+	struct v4l2_requestbuffers req;
+	struct v4l2_buffer buf;
+	int type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+	int bytes_per_pixel = (pixfmt == V4L2_PIX_FMT_Y16) ? 2 : 1;
+	int i;
+
+	memset(out, 0, sizeof(v4l2out_t));
+	out->cur = -1;
+	log_info("opening V4L2 output device ... %s", dev);
+	if ((out->fd = open(dev, O_RDWR | O_NONBLOCK)) < 0) {
+		log_fatal("V4L2: failed to open device - check v4l2loopback is loaded");
+		return -1;
+	}
+
+	memset(&fmt, 0, sizeof(fmt));
+	fmt.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+	fmt.fmt.pix.width = width;
+	fmt.fmt.pix.height = height;
+	fmt.fmt.pix.pixelformat = pixfmt;
+	fmt.fmt.pix.field = V4L2_FIELD_NONE;
+	fmt.fmt.pix.bytesperline = width * bytes_per_pixel;
+	fmt.fmt.pix.sizeimage = width * height * bytes_per_pixel;
+	fmt.fmt.pix.colorspace = V4L2_COLORSPACE_RAW;
+	if (ioctl(out->fd, VIDIOC_S_FMT, &fmt) < 0) {
+		log_fatal("V4L2: failed to set the format");
+		goto fail;
+	}
+	out->frame_len = width * height * bytes_per_pixel;
+
+	memset(&parm, 0, sizeof(parm));
+	parm.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+	parm.parm.output.timeperframe.numerator = 1;
+	parm.parm.output.timeperframe.denominator = V4L2OUT_FPS;
+	(void) ioctl(out->fd, VIDIOC_S_PARM, &parm);
+
+	memset(&req, 0, sizeof(req));
+	req.count = V4L2OUT_NUM_BUFS;
+	req.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+	req.memory = V4L2_MEMORY_MMAP;
+	if ((ioctl(out->fd, VIDIOC_REQBUFS, &req) < 0) || (req.count == 0)) {
+		log_fatal("V4L2: failed to request buffers");
+		goto fail;
+	}
+	out->num_bufs = (req.count < V4L2OUT_NUM_BUFS) ? req.count : V4L2OUT_NUM_BUFS;
+
+	for (i=0; i<out->num_bufs; i++) {
+		memset(&buf, 0, sizeof(buf));
+		buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+		buf.memory = V4L2_MEMORY_MMAP;
+		buf.index = i;
+		if (ioctl(out->fd, VIDIOC_QUERYBUF, &buf) < 0) {
+			log_fatal("V4L2: failed to query buffer %d", i);
+			goto fail;
+		}
+		out->bufs[i].len = buf.length;
+		out->bufs[i].p = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, out->fd, buf.m.offset);
+		if ((out->bufs[i].p == MAP_FAILED) || (buf.length < out->frame_len)) {
+			out->bufs[i].p = NULL;
+			log_fatal("V4L2: failed to map buffer %d", i);
+			goto fail;
+		}
+	}
+	out->num_fresh = out->num_bufs;
+
+	if (ioctl(out->fd, VIDIOC_STREAMON, &type) < 0) {
+		log_fatal("V4L2: failed to start streaming");
+		goto fail;
+	}
+
+	log_info("V4L2: %dx%d %s, %d buffers", width, height,
+	         (pixfmt == V4L2_PIX_FMT_Y16) ? "Y16" : "GREY", out->num_bufs);
+	return 0;
+
+fail:
+	v4l2out_close(out);
+	return -1;
+}
+
+
+/**
+ * Stop streaming and close the device
+ */
+void v4l2out_close(v4l2out_t* out)
+{
+	int type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+	int i;
+
+	if (out->fd < 0) {
+		return;
+	}
+
+	(void) ioctl(out->fd, VIDIOC_STREAMOFF, &type);
+	for (i=0; i<out->num_bufs; i++) {
+		if (out->bufs[i].p != NULL) {
+			munmap(out->bufs[i].p, out->bufs[i].len);
+		}
+	}
+	close(out->fd);
+	out->fd = -1;
+}
+
+
+/**
+ * Get a buffer to write a frame (frame_len bytes) into.  Returns NULL if all of the
+ * buffers are still queued.
+ */
+uint8_t* v4l2out_get_buf(v4l2out_t* out)
+{
+	struct v4l2_buffer buf;
+
+	if (out->cur < 0) {
+		if (out->num_fresh > 0) {
+			out->cur = out->num_bufs - out->num_fresh--;
+		} else {
+			memset(&buf, 0, sizeof(buf));
+			buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+			buf.memory = V4L2_MEMORY_MMAP;
+			if (ioctl(out->fd, VIDIOC_DQBUF, &buf) < 0) {
+				if (errno != EAGAIN) {
+					log_error("V4L2: failed to dequeue buffer");
+				}
+				return NULL;
+			}
+			out->cur = buf.index;
+		}
+	}
+
+	return out->bufs[out->cur].p;
+}
+
+
+/**
+ * Queue the buffer from v4l2out_get_buf() holding a new frame.  Returns 0 for
+ * success, -1 for failure.
+ */
+int v4l2out_put_buf(v4l2out_t* out)
+{
+	struct v4l2_buffer buf;
+
+	if (out->cur < 0) {
+		return -1;
+	}
+
+	memset(&buf, 0, sizeof(buf));
+	buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+	buf.memory = V4L2_MEMORY_MMAP;
+	buf.index = out->cur;
+	buf.bytesused = out->frame_len;
+	buf.field = V4L2_FIELD_NONE;
+	if (ioctl(out->fd, VIDIOC_QBUF, &buf) < 0) {
+		// Keep the buffer for the next frame
+		log_error("V4L2: failed to queue buffer");
+		return -1;
+	}
+	out->cur = -1;
+
+	return 0;
+}
@@ -6,6 +6,308 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef VOSPI_DDR_RING
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+#ifdef VOSPI_FRAME_TIMESTAMP
+#include <time.h>
+#endif
+
+#if defined(VOSPI_FRAME_STATS) && defined(VOSPI_DDR_RING)
+#error "VOSPI_FRAME_STATS requires the rpmsg transport"
+#endif
+
+#if defined(VOSPI_FRAME_TIMESTAMP) && defined(VOSPI_DUAL_LEPTON)
+#error "VOSPI_FRAME_TIMESTAMP requires the PRU1 relay"
+#endif
+
+
+#ifdef VOSPI_FRAME_TIMESTAMP
+/**
+ *  Time a frame from the IEP count and age PRU1 sent in data just read
+ */
+static void set_frame_ts(vospi_frame_t* frame, uint8_t* data)
+{
+	struct timespec ts;
+	uint32_t age;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	frame->pru_ts = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+	age = data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t) data[7] << 24);
+	frame->timestamp_usec = (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000 - age / 1000;
+}
+#endif
+
+
+#ifdef VOSPI_DDR_RING
+// The mapped DDR ring
+static volatile vospi_ring_hdr_t* ring_hdr = NULL;
+static uint8_t* ring_frames;
+
+
+/**
+ *  Read rpmsg messages into msg until one of the specified DDR ring type arrives and
+ *  return its value.  Returns false for a bad read.
+ */
+static int get_ring_msg(int fd, uint8_t type, vospi_rpmsg_t* msg, uint32_t* val)
+{
+	do {
+		if (read(fd, (uint8_t*) msg, VOSPI_MSG_TOTAL_BYTES) < 1) {
+			log_fatal("RPMSG: failed to transfer packet");
+			return 0;
+		}
+	} while (msg->seq != type);
+
+	*val = msg->data[0] | (msg->data[1] << 8) | (msg->data[2] << 16) | ((uint32_t) msg->data[3] << 24);
+	return 1;
+}
+
+
+/**
+ *  Map len bytes of physical memory at pa.  Returns NULL for failure.
+ */
+static void* map_phys(uint32_t pa, size_t len)
+{
+	int mem_fd;
+	void* p;
+
+	if ((mem_fd = open("/dev/mem", O_RDWR | O_SYNC)) < 0) {
+		log_fatal("MEM: failed to open /dev/mem - check permissions");
+		return NULL;
+	}
+	p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, pa);
+	close(mem_fd);
+	if (p == MAP_FAILED) {
+		log_fatal("MEM: failed to map 0x%08x", pa);
+		return NULL;
+	}
+
+	return p;
+}
+
+
+/**
+ *  Map the DDR ring at pa and check its header.  Returns NULL if the ring could not
+ *  be mapped.
+ */
+static void* map_ring(uint32_t pa)
+{
+	void* p;
+	volatile vospi_ring_hdr_t* hdr;
+
+	if ((p = map_phys(pa, VOSPI_RING_LEN)) == NULL) {
+		return NULL;
+	}
+
+	hdr = (volatile vospi_ring_hdr_t*) p;
+	if ((hdr->magic != VOSPI_RING_MAGIC) || (hdr->frame_len != VOSPI_RING_FRAME_BYTES)) {
+		log_fatal("RING: unexpected ring header - check DDR_RING, LEP_16BIT and TELEM_xxx");
+		munmap(p, VOSPI_RING_LEN);
+		return NULL;
+	}
+	log_info("RING: mapped %d frames at 0x%08x", hdr->num_frames, pa);
+
+	return p;
+}
+
+
+/**
+ *  Copy the oldest frame in a ring into the rpmsg frame layout (so the transport is
+ *  invisible to the caller) and release it
+ */
+static void copy_ring_frame(volatile vospi_ring_hdr_t* hdr, uint8_t* frames, vospi_frame_t* frame)
+{
+	int seq;
+	uint32_t tail;
+	uint8_t* src;
+
+	__sync_synchronize();
+	tail = hdr->tail;
+	src = frames + (tail % hdr->num_frames) * VOSPI_RING_FRAME_BYTES;
+	for (seq=0; seq < (VOSPI_FRAME_NUM_MSGS + VOSPI_TELEM_NUM_MSGS); seq++) {
+		frame->msg[seq].seq = seq;
+		memcpy(frame->msg[seq].data, src, VOSPI_MSG_DATA_BYTES);
+		src += VOSPI_MSG_DATA_BYTES;
+	}
+
+	// Release the ring frame back to the PRU
+	__sync_synchronize();
+	hdr->tail = tail + 1;
+}
+
+
+/**
+ *  Map the DDR ring using the physical address PRU1 sends when it is enabled.
+ *  Returns false if the ring could not be mapped.
+ */
+static int open_ring(int fd)
+{
+	uint32_t pa;
+	void* p;
+	vospi_rpmsg_t msg;
+
+	if (!get_ring_msg(fd, VOSPI_RING_INFO_MSG, &msg, &pa)) {
+		return 0;
+	}
+
+	if ((p = map_ring(pa)) == NULL) {
+		return 0;
+	}
+	ring_hdr = (volatile vospi_ring_hdr_t*) p;
+	ring_frames = (uint8_t*) p + VOSPI_RING_HDR_LEN;
+
+	return 1;
+}
+#endif
+
+
+#ifdef VOSPI_DUAL_LEPTON
+/**
+ *  Map the PRU shared RAM and find PRU num's control block.  Returns 0 for success,
+ *  -1 if it could not be mapped or the PRU isn't running the dual Lepton firmware.
+ */
+int vospi_pru_open(vospi_pru_t* pru, int num)
+{
+	memset(pru, 0, sizeof(vospi_pru_t));
+	pru->pru = num;
+
+	if ((pru->smem = map_phys(VOSPI_PRU_SMEM_PA, VOSPI_PRU_SMEM_LEN)) == NULL) {
+		return -1;
+	}
+	pru->ctrl = (volatile vospi_pru_ctrl_t*) ((uint8_t*) pru->smem + VOSPI_PRU_CTRL_OFFSET(num));
+	if (pru->ctrl->magic != VOSPI_PRU_MAGIC) {
+		log_fatal("PRU%d: not running - check the DUAL_LEPTON firmware is loaded", num);
+		vospi_pru_close(pru);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+/**
+ *  Set the PRU's packet sample period (0 for the firmware default), enable it and map
+ *  the ring it sets up.  Returns 0 for success, -1 for failure.
+ */
+int vospi_pru_start(vospi_pru_t* pru, uint16_t sample_usec)
+{
+	int i;
+	void* p;
+
+	// Make sure the PRU starts a new ring
+	if (pru->ctrl->enable) {
+		pru->ctrl->enable = 0;
+		usleep(VOSPI_PRU_STOP_USEC);
+	}
+	if (pru->ring != NULL) {
+		munmap(pru->ring, VOSPI_RING_LEN);
+		pru->ring = NULL;
+	}
+
+	if ((sample_usec >= VOSPI_SAMPLE_USEC_MIN) && (sample_usec <= VOSPI_SAMPLE_USEC_MAX)) {
+		pru->ctrl->sample = sample_usec * VOSPI_PRU_CLK_PER_USEC;
+	} else {
+		pru->ctrl->sample = 0;
+	}
+	pru->ctrl->ring_pa = 0;
+	__sync_synchronize();
+	pru->ctrl->enable = 1;
+
+	// Wait for the PRU to set up its ring
+	for (i=0; (pru->ctrl->ring_pa == 0) && (i < VOSPI_PRU_START_MSEC); i++) {
+		usleep(1000);
+	}
+	if (pru->ctrl->ring_pa == 0) {
+		log_fatal("PRU%d: ring not set up", pru->pru);
+		pru->ctrl->enable = 0;
+		return -1;
+	}
+
+	if ((p = map_ring(pru->ctrl->ring_pa)) == NULL) {
+		pru->ctrl->enable = 0;
+		return -1;
+	}
+	pru->ring = p;
+	pru->ring_hdr = (volatile vospi_ring_hdr_t*) p;
+	pru->ring_frames = (uint8_t*) p + VOSPI_RING_HDR_LEN;
+
+	return 0;
+}
+
+
+/**
+ *  Disable the PRU.  Only writes its control block so it is safe from a signal
+ *  handler.
+ */
+void vospi_pru_stop(vospi_pru_t* pru)
+{
+	if (pru->ctrl != NULL) {
+		pru->ctrl->enable = 0;
+	}
+}
+
+
+void vospi_pru_close(vospi_pru_t* pru)
+{
+	if (pru->ring != NULL) {
+		munmap(pru->ring, VOSPI_RING_LEN);
+	}
+	if (pru->smem != NULL) {
+		munmap(pru->smem, VOSPI_PRU_SMEM_LEN);
+	}
+	pru->ring = NULL;
+	pru->ring_hdr = NULL;
+	pru->smem = NULL;
+	pru->ctrl = NULL;
+}
+
+
+/**
+ *  Transfer a single VoSPI frame from the PRU's ring.  Polls the ring head every
+ *  VOSPI_PRU_POLL_USEC until the PRU has written a frame.
+ *  Returns:
+ *    -1 : PRU disabled - fatal
+ *     0 : Successful transfer
+ */
+int vospi_pru_transfer_frame(vospi_pru_t* pru, vospi_frame_t* frame)
+{
+	while (pru->ring_hdr->head == pru->ring_hdr->tail) {
+		if (!pru->ctrl->enable) {
+			return -1;
+		}
+		usleep(VOSPI_PRU_POLL_USEC);
+	}
+
+	copy_ring_frame(pru->ring_hdr, pru->ring_frames, frame);
+	return 0;
+}
+#endif
+
+
+/**
+ *  Set the PRU0 packet sample period and PRU1 message period (0 for the firmware
+ *  defaults).  Must be called while acquisition is stopped.  Returns 0 for success,
+ *  -1 if the command could not be sent.
+ */
+int vospi_set_timing(int fd, uint16_t sample_usec, uint16_t xmit_usec)
+{
+	uint8_t cmd[VOSPI_TIMING_CMD_LEN];
+
+	cmd[0] = VOSPI_TIMING_CMD;
+	cmd[1] = sample_usec & 0xFF;
+	cmd[2] = sample_usec >> 8;
+	cmd[3] = xmit_usec & 0xFF;
+	cmd[4] = xmit_usec >> 8;
+
+	if (write(fd, cmd, VOSPI_TIMING_CMD_LEN) != VOSPI_TIMING_CMD_LEN) {
+		log_error("RPMSG: failed to set timing");
+		return -1;
+	}
+
+	return 0;
+}
 
 
 /**
@@ -37,6 +339,38 @@ int sync_and_transfer_exp_msg(int fd, vospi_rpmsg_t* msg, uint8_t exp_seq)
 }
 
 
+#ifdef VOSPI_DDR_RING
+/**
+ *  Transfer a single VoSPI frame from the DDR ring.  Blocks until PRU1 notifies us
+ *  that it has written a frame.  Frames are copied into the rpmsg frame layout so
+ *  the transport is invisible to the caller.
+ *  Returns:
+ *    -1 : Bad Read or ring could not be mapped - fatal
+ *     0 : Successful transfer
+ */
+int sync_and_transfer_frame(int fd, vospi_frame_t* frame)
+{
+	uint32_t head;
+	vospi_rpmsg_t msg;
+
+	if (ring_hdr == NULL) {
+		if (!open_ring(fd)) {
+			return -1;
+		}
+	}
+
+	// One notification is sent for each frame PRU1 makes available in the ring
+	if (!get_ring_msg(fd, VOSPI_RING_FRAME_MSG, &msg, &head)) {
+		return -1;
+	}
+#ifdef VOSPI_FRAME_TIMESTAMP
+	set_frame_ts(frame, &msg.data[4]);
+#endif
+
+	copy_ring_frame(ring_hdr, ring_frames, frame);
+	return 0;
+}
+#else
 /**
  *  Transfer a single VoSPI frame.
  *  Returns:
@@ -51,6 +385,9 @@ int sync_and_transfer_frame(int fd, vospi_frame_t* frame)
 	int rsp;
 	int seq = 0;
 	int cnt = 0;
+#ifdef VOSPI_FRAME_TIMESTAMP
+	vospi_rpmsg_t ts_msg;
+#endif
 
 	// Keep streaming packets until we receive a valid, first packets to sync
 	log_debug("Synchronising with first message");
@@ -65,7 +402,7 @@ int sync_and_transfer_frame(int fd, vospi_frame_t* frame)
 				break;
 			case 1:
 				/* keep waiting for a while */
-				if (++cnt > VOSPI_FRAME_NUM_MSGS) {
+				if (++cnt > VOSPI_FRAME_TOTAL_MSGS) {
 					return 3;
 				}
 				break;
@@ -76,8 +413,8 @@ int sync_and_transfer_frame(int fd, vospi_frame_t* frame)
 		}
 	}
 
-	// Attempt to read remaining frame messages
-	while (seq < VOSPI_FRAME_NUM_MSGS) {
+	// Attempt to read remaining frame (and statistics) messages
+	while (seq < VOSPI_FRAME_TOTAL_MSGS) {
 		log_debug("synchronising with message %d", seq);
 		rsp = sync_and_transfer_exp_msg(fd, &frame->msg[seq], seq);
 		if (rsp == 0) {
@@ -89,15 +426,42 @@ int sync_and_transfer_frame(int fd, vospi_frame_t* frame)
 		}
 	}
 
+#ifdef VOSPI_FRAME_TIMESTAMP
+	// The timestamp follows the frame
+	rsp = sync_and_transfer_exp_msg(fd, &ts_msg, VOSPI_TS_MSG);
+	if (rsp != 0) {
+		return rsp;
+	}
+	set_frame_ts(frame, ts_msg.data);
+#endif
+
 	return 0;
 }
+#endif
 
 
 /**
- * Copy data from a frame into a pixel buffer discarding the sequence numbers
+ * Copy data from a frame into an 8-bit pixel buffer discarding the sequence numbers.
+ * 16-bit frames are linearly scaled between their minimum and maximum pixel (taken
+ * from the frame statistics when available).
  */
 void frame_to_pixel(vospi_frame_t* frame, uint8_t* pixbuf)
 {
+#ifdef VOSPI_16BIT
+	uint16_t pix16buf[VOSPI_FRAME_LEN];
+#ifdef VOSPI_FRAME_STATS
+	vospi_stats_t stats;
+#endif
+
+	frame_to_pixel16(frame, pix16buf);
+#ifdef VOSPI_FRAME_STATS
+	if (frame_to_stats(frame, &stats)) {
+		pixel16_scale(pix16buf, pixbuf, stats.min, stats.max);
+		return;
+	}
+#endif
+	pixel16_to_pixel(pix16buf, pixbuf);
+#else
 	int i;
 	int seq;
 
@@ -106,5 +470,129 @@ void frame_to_pixel(vospi_frame_t* frame, uint8_t* pixbuf)
 			*pixbuf++ = frame->msg[seq].data[i];
 		}
 	}
+#endif
+}
+
+
+#ifdef VOSPI_FRAME_STATS
+/**
+ * Copy the statistics from the end of a frame.  Returns false if the frame does not
+ * contain valid statistics.
+ */
+int frame_to_stats(vospi_frame_t* frame, vospi_stats_t* stats)
+{
+	int n;
+	int seq = VOSPI_FRAME_NUM_MSGS + VOSPI_TELEM_NUM_MSGS;
+	uint8_t* dst = (uint8_t*) stats;
+	int len = sizeof(vospi_stats_t);
+
+	while (len > 0) {
+		n = (len < VOSPI_MSG_DATA_BYTES) ? len : VOSPI_MSG_DATA_BYTES;
+		memcpy(dst, frame->msg[seq++].data, n);
+		dst += n;
+		len -= n;
+	}
+
+	return (stats->num_pixels == VOSPI_FRAME_LEN);
+}
+#endif
+
+
+#ifdef VOSPI_TELEM
+/**
+ * Return a telemetry word (numbered from the start of row A) from a frame
+ */
+uint16_t vospi_telem_word(vospi_frame_t* frame, int word)
+{
+	uint8_t* p = &frame->msg[VOSPI_FRAME_NUM_MSGS].data[word * 2];
+
+	return (p[0] << 8) | p[1];
+}
+
+
+/**
+ * Extract the commonly used telemetry fields from a frame
+ */
+void frame_to_telem(vospi_frame_t* frame, vospi_telem_t* telem)
+{
+	telem->uptime_msec = ((uint32_t) vospi_telem_word(frame, VOSPI_TEL_TC_HIGH) << 16) |
+	                     vospi_telem_word(frame, VOSPI_TEL_TC_LOW);
+	telem->status = ((uint32_t) vospi_telem_word(frame, VOSPI_TEL_STATUS_HIGH) << 16) |
+	                vospi_telem_word(frame, VOSPI_TEL_STATUS_LOW);
+	telem->frame_count = ((uint32_t) vospi_telem_word(frame, VOSPI_TEL_FC_HIGH) << 16) |
+	                     vospi_telem_word(frame, VOSPI_TEL_FC_LOW);
+	telem->frame_mean = vospi_telem_word(frame, VOSPI_TEL_FRAME_MEAN);
+	telem->fpa_temp_k100 = vospi_telem_word(frame, VOSPI_TEL_FPA_T_K100);
+	telem->housing_temp_k100 = vospi_telem_word(frame, VOSPI_TEL_HSE_T_K100);
+	telem->ffc_fpa_temp_k100 = vospi_telem_word(frame, VOSPI_TEL_LAST_FFC_T);
+	telem->ffc_uptime_msec = ((uint32_t) vospi_telem_word(frame, VOSPI_TEL_LAST_TC_HIGH) << 16) |
+	                         vospi_telem_word(frame, VOSPI_TEL_LAST_TC_LOW);
+}
+
+
+/**
+ * Returns true if the telemetry status indicates a FFC is imminent or running (the
+ * shutter is or is about to be closed so the image is frozen)
+ */
+int vospi_telem_ffc_active(vospi_telem_t* telem)
+{
+	uint32_t state = telem->status & VOSPI_STATUS_FFC_STATE;
+
+	return ((state == VOSPI_FFC_STATE_IMM) || (state == VOSPI_FFC_STATE_RUN));
+}
+#endif
+
+
+#ifdef VOSPI_16BIT
+/**
+ * Copy data from a frame into a 16-bit pixel buffer discarding the sequence numbers
+ */
+void frame_to_pixel16(vospi_frame_t* frame, uint16_t* pixbuf)
+{
+	int i;
+	int seq;
+
+	for (seq=0; seq < VOSPI_FRAME_NUM_MSGS; seq++) {
+		for (i=0; i<VOSPI_MSG_DATA_BYTES; i+=2) {
+			*pixbuf++ = (frame->msg[seq].data[i] << 8) | frame->msg[seq].data[i+1];
+		}
+	}
+}
+
+
+/**
+ * Linearly scale a 16-bit pixel buffer between its minimum and maximum pixel into
+ * an 8-bit pixel buffer for display
+ */
+void pixel16_to_pixel(uint16_t* pix16buf, uint8_t* pixbuf)
+{
+	int i;
+	uint16_t min = 0xFFFF;
+	uint16_t max = 0;
+
+	for (i=0; i<VOSPI_FRAME_LEN; i++) {
+		if (pix16buf[i] < min) min = pix16buf[i];
+		if (pix16buf[i] > max) max = pix16buf[i];
+	}
+
+	pixel16_scale(pix16buf, pixbuf, min, max);
+}
+
+
+/**
+ * Linearly scale a 16-bit pixel buffer between min and max into an 8-bit pixel buffer
+ * for display
+ */
+void pixel16_scale(uint16_t* pix16buf, uint8_t* pixbuf, uint16_t min, uint16_t max)
+{
+	int i;
+	uint32_t range;
+
+	range = (max > min) ? (max - min) : 1;
+
+	for (i=0; i<VOSPI_FRAME_LEN; i++) {
+		*pixbuf++ = (uint8_t) (((uint32_t) (pix16buf[i] - min) * 255) / range);
+	}
 }
+#endif
 
@@ -1,5 +1,7 @@
 #include "fb.h"
+#include "frame_bus.h"
 #include "log.h"
+#include "tcam_frame.h"
 #include "vospi.h"
 #include <fcntl.h>
 #include <stdio.h>
@@ -7,13 +9,33 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
-#include <time.h> 
 #include <zmq.h>
 
 
 // The default spec for the ZMQ socket that will be used for comms with the frontend
 #define ZMQ_DEFAULT_SOCKET_SPEC "tcp://127.0.0.1:5555"
 
+// Uncomment to subscribe to frames published by pru_leptonic built with LEP_ZMQ_PUBSUB
+// instead of requesting each frame
+//#define LEP_ZMQ_PUBSUB
+
+// Uncomment to request frames from pru_leptonic built with LEP_FRAME_HEADER (published
+// frames always have the tcam_frame.h header)
+//#define LEP_FRAME_HEADER
+
+#if defined(LEP_ZMQ_PUBSUB) || defined(LEP_FRAME_HEADER)
+#define LEP_FRAME_MSG
+#endif
+
+// Uncomment to read the frames pru_leptonic built with LEP_FRAME_BUS publishes on the
+// local shared memory frame bus instead of using a ZMQ socket (the socket argument is
+// then ignored).  Frames are drawn straight from the bus.
+//#define LEP_FRAME_BUS
+
+// Set to 1 to keep only the most recent published frame (older queued frames are
+// discarded if we fall behind) or 0 to receive every frame published
+#define LEP_ZMQ_CONFLATE 1
+
 /* ------------ */
 /* Device files */
 /* ------------ */
@@ -24,18 +46,35 @@ char fb_dev[] = "/dev/fb0";
 /* Local Variables */
 /* --------------- */
 uint8_t pixbuf[VOSPI_FRAME_LEN];
+#ifdef VOSPI_16BIT
+uint16_t pix16buf[VOSPI_FRAME_LEN];
+#endif
 
+#ifdef LEP_FRAME_MSG
+// Received tcam_frame.h frame (the header and pixels)
+uint8_t msg_buf[sizeof(tcam_frame_hdr_t) + VOSPI_FRAME_BYTES];
+#endif
 
-/*
- * Sleep function
+
+
+/**
+ * Convert the pixels of a frame from pru_leptonic (received or on the frame bus) for
+ * display.  Returns false if it isn't a frame of the expected format.
  */
-void sleep_ms(int ms)
+int frame_to_display(const tcam_frame_hdr_t* hdr)
 {
-  struct timespec ts;
-
-  ts.tv_sec = ms/1000;
-  ts.tv_nsec = (ms % 1000) * 1000000;
-  nanosleep(&ts, NULL);
+#ifdef VOSPI_16BIT
+  if ((hdr == NULL) || (hdr->format != TCAM_FRAME_FMT_16LE) || (hdr->width * hdr->height != VOSPI_FRAME_LEN)) {
+    return 0;
+  }
+  pixel16_to_pixel((uint16_t*) tcam_frame_pixels(hdr), pixbuf);
+#else
+  if ((hdr == NULL) || (hdr->format != TCAM_FRAME_FMT_8) || (hdr->width * hdr->height != VOSPI_FRAME_LEN)) {
+    return 0;
+  }
+  memcpy(pixbuf, tcam_frame_pixels(hdr), VOSPI_FRAME_LEN);
+#endif
+  return 1;
 }
 
 
@@ -44,19 +83,49 @@ void sleep_ms(int ms)
  */
 int main(int argc, char *argv[])
 {
+#if defined(LEP_FRAME_BUS)
+  frame_bus_client_t bus;
+  const frame_bus_slot_t* slot;
+  uint32_t missed = 0;
+#else
+#ifdef LEP_FRAME_MSG
+  const tcam_frame_hdr_t* hdr;
+  int len;
+#endif
+#ifdef LEP_ZMQ_PUBSUB
+  uint32_t next_seq = 0;
+  int conflate = LEP_ZMQ_CONFLATE;
+  int first = 1;
+#else
   char req_buf[10];
+#endif
+#endif
 
   // Set the log level
   log_set_level(LOG_INFO);
 
+#ifdef LEP_FRAME_BUS
+  // Wait for the publisher to create the bus
+  while (!frame_bus_open(&bus, FRAME_BUS_NAME)) {
+    sleep(1);
+  }
+#else
   // Create the ZMQ context & socket
   char* socket_path = argc > 2 ? argv[2] : ZMQ_DEFAULT_SOCKET_SPEC;
   void* context = zmq_ctx_new();
+#ifdef LEP_ZMQ_PUBSUB
+  void* subscriber = zmq_socket(context, ZMQ_SUB);
+  zmq_setsockopt(subscriber, ZMQ_CONFLATE, &conflate, sizeof(conflate));
+  zmq_setsockopt(subscriber, ZMQ_SUBSCRIBE, "", 0);
+  zmq_connect(subscriber, socket_path);
+#else
   void* requester = zmq_socket(context, ZMQ_REQ);
   zmq_connect(requester, socket_path);
 
   // Set the request frame string (could be anything)
   strcpy(req_buf, "get");
+#endif
+#endif
 
   // Initialize frame buffer
   (void) init_fb(fb_dev);
@@ -67,16 +136,64 @@ int main(int argc, char *argv[])
   }
 
   while (1) {
+#if defined(LEP_FRAME_BUS)
+    // Wait for the next frame, reopening the bus if the publisher restarted
+    if ((slot = frame_bus_wait(&bus, 1000)) == NULL) {
+      if (bus.bus->magic != FRAME_BUS_MAGIC) {
+        frame_bus_close(&bus);
+        while (!frame_bus_open(&bus, FRAME_BUS_NAME)) {
+          sleep(1);
+        }
+      }
+      continue;
+    }
+    if (bus.missed != missed) {
+      log_debug("Missed %u frames", bus.missed - missed);
+      missed = bus.missed;
+    }
+
+    // Map it straight from the slot and only draw it if it wasn't overwritten meanwhile
+    if (frame_to_display(&slot->hdr) && frame_bus_valid(&bus)) {
+      update_fb(pixbuf);
+    }
+#elif defined(LEP_ZMQ_PUBSUB)
+    // Wait for the next published frame
+    len = zmq_recv(subscriber, msg_buf, sizeof(msg_buf), 0);
+    hdr = (len > 0) ? tcam_frame_view(msg_buf, len) : NULL;
+    if (!frame_to_display(hdr)) {
+      log_debug("Ignoring %d byte message", len);
+      continue;
+    }
+    if (!first && (hdr->seq != next_seq)) {
+      log_debug("Missed %u frames", hdr->seq - next_seq);
+    }
+    first = 0;
+    next_seq = hdr->seq + 1;
+
+    // Render it into the frame buffer
+    update_fb(pixbuf);
+#else
     // Request a frame
     zmq_send(requester, req_buf, sizeof(req_buf), 0);
 
     // Wait for a response
+#if defined(LEP_FRAME_HEADER)
+    len = zmq_recv(requester, msg_buf, sizeof(msg_buf), 0);
+    hdr = (len > 0) ? tcam_frame_view(msg_buf, len) : NULL;
+    if (!frame_to_display(hdr)) {
+      log_debug("Ignoring %d byte message", len);
+      continue;
+    }
+#elif defined(VOSPI_16BIT)
+    zmq_recv(requester, pix16buf, sizeof(pix16buf), 0);
+    pixel16_to_pixel(pix16buf, pixbuf);
+#else
     zmq_recv(requester, pixbuf, VOSPI_FRAME_LEN, 0);
+#endif
 
-    // Render it into the frame buffer
+    // Render it into the frame buffer (the server replies when it has a new frame so
+    // this runs at the frame rate)
     update_fb(pixbuf);
-
-    // Sleep a bit between frames
-    sleep_ms(111);
+#endif
   }
 }
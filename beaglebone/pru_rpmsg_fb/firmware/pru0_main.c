@@ -7,7 +7,10 @@
  * using a bit-banged MISO-only SPI interface running at 16.67 MHz.
  * It stores non-discard packets in a circular buffer located in shared
  * memory.  Only the low 8-bits of each Lepton data words are stored for
- * a total of 80 bytes per packet.  It assumes it is receiving a valid
+ * a total of 80 bytes per packet (when LEP_16BIT is defined in pru_common.h
+ * the Lepton is expected to be in Radiometric TLinear mode and both bytes of
+ * each word are stored, high byte first, for a total of 160 bytes per packet).
+ * It assumes it is receiving a valid
  * frame when it sees packet 20 of segment 1 and notifies PRU1 that it can
  * start pushing packet data up to the host via RPMsg. 
  *
@@ -21,8 +24,9 @@
  * up overwriting the start of the buffer with the end of the frame while
  * PRU1 is reading the buffer.  It's important to make sure the timing
  *
- * One frame requires 80 x 240 = 19200 bytes.  Almost the entire 12K shared
- * memory buffer is available for the circular buffer.
+ * One frame requires 80 x 240 = 19200 bytes (160 x 240 = 38400 bytes with
+ * LEP_16BIT).  Almost the entire 12K shared memory buffer is available for the
+ * circular buffer.
  *
  * This PRU reads one packet every 128 uSec (less than the maximum 158 uSec
  * period that is required to keep up with the Lepton).  The other PRU must
@@ -35,11 +39,62 @@
  * packet with an unexpected count it resets.  If it has previously triggered
  * PRU1 to start reading out packets then it sends an abort notification to PRU1.
  *
+ * When CHECK_CRC is defined this PRU also checks the CRC of each non-discard packet
+ * and resets (like an unexpected count) if it is bad so a corrupted frame is never
+ * pushed to the host.  The CRC is computed a byte at a time from a lookup table as
+ * each byte is read which adds about 10 cycles per byte (under 2000 cycles per
+ * packet) to the roughly 17000 cycles spent reading a packet, well within the 25600
+ * cycle sample period.
+ *
+ * When ASM_SPI_READ is defined packets are read by spi_read_packet() in
+ * spi_packet.asm instead of spi_read8().  It clocks the SPI at 20 MHz with unrolled
+ * bit reads, computes the CRC inline (in the high half of each byte's last bit) and
+ * reads the whole packet into pkt_buf in about 15000 cycles.  The packet is checked
+ * before any of it is stored so a packet with a bad CRC never reaches the buffer.
+ *
+ * When TELEM_HEADER or TELEM_FOOTER is defined in pru_common.h the Lepton is
+ * expected to have telemetry enabled in that location (61 packets per segment).
+ * The telemetry packets (packets 0-3 of segment 1 as a header or packets 57-60 of
+ * segment 4 as a footer) are read and checked like any other packet.  Rows A-C
+ * are stored with both bytes of each word (whatever the pixel format) apart from
+ * the image, at the end of shared memory (counted in the TELEM register) or after
+ * the image in the DDR ring frame, so PRU1 and the host still see a 240 packet
+ * image followed by the telemetry.
+ *
+ * When DDR_RING is defined in pru_common.h this PRU instead stores packets
+ * directly into the DDR ring frame PRU1 offered in the shared memory SLOT
+ * register and hands the complete frame back through the DONE register.  It
+ * can then immediately start capturing the next frame into the next free ring
+ * frame while PRU1 and the host deal with the last one.  It only discards
+ * packets waiting for a free frame when the host has fallen behind and the
+ * ring is full.
+ *
+ * When DUAL_LEPTON is defined in pru_common.h this firmware runs on both PRUs
+ * (built for PRU1 with CAPTURE_PRU1 defined), each reading its own Lepton.  There
+ * is no PRU1 relay: each PRU manages its own DDR ring from its resource table
+ * carve-out, taking the next free frame itself and making each complete frame
+ * available by advancing the ring head, which the host polls.  The host enables
+ * the PRU, sets its sample period and finds its ring through the PRU's control
+ * block in shared memory, where the PRU also keeps its health counters.
+ *
+ * When FRAME_TIMESTAMP is defined in pru_common.h this PRU runs the PRU-ICSS IEP
+ * timer (counting nSec) and latches it in the shared memory TS register when it
+ * sees packet 20 of segment 1 so PRU1 can pass the frame's capture time to the host.
+ *
+ * The packet sample period can be changed by the host through PRU1 which writes
+ * it to the shared memory SAMPLE register.  It is latched each time this PRU is
+ * enabled.  This PRU also counts the packets it has stored for the current frame
+ * in the shared memory PKTS register so PRU1 can check that its message period
+ * keeps it between this PRU's writes and the end of the circular buffer.
+ *
+ * This PRU counts discard packets, CRC failures, capture restarts, Lepton resyncs
+ * and captured frames in the shared memory health counters (pru_common.h).
+ *
  * PRU1 sets an enable locatation in shared memory buffer to 1 to indicate when
  * to run.  Otherwise this PRU spins waiting to be enabled.
  *
- * The LED attached to P9.31 is lit while receiving a valid frame (from segment 1,
- * packet 20 to segment 4, packet 59).
+ * The LED attached to P9.31 (P8.45 for PRU1 with DUAL_LEPTON) is lit while
+ * receiving a valid frame (from segment 1, packet 20 to the last packet of segment 4).
  *
  * Copyright (C) 2018 Dan Julio <dan@danjuliodesigns.com>
  *
@@ -48,15 +103,34 @@
  * Free Software Foundation; either version 2 of the License, or (at your
  * option) any later version.
  */
-/* We are compiling for PRU0 */
+/* We are compiling for PRU0 (or PRU1 capturing the second Lepton) */
+#ifdef CAPTURE_PRU1
+#define PRU1
+#define LEP_PRU 1
+#define LEP_CTRL PRU1_CTRL
+#else
 #define PRU0
+#define LEP_PRU 0
+#define LEP_CTRL PRU0_CTRL
+#endif
 
 #include <stdint.h>
 #include <pru_cfg.h>
 #include <pru_ctrl.h>
+#ifdef FRAME_TIMESTAMP
+#include <pru_iep.h>
+#endif
 #include "pru_common.h"
 #include "resource_table_0.h"
 
+#if defined(CAPTURE_PRU1) && !defined(DUAL_LEPTON)
+#error "PRU1 only captures with DUAL_LEPTON"
+#endif
+
+#if defined(DUAL_LEPTON) && defined(FRAME_TIMESTAMP)
+#error "FRAME_TIMESTAMP requires the PRU1 relay"
+#endif
+
 
 /* ========= */
 /* Constants */
@@ -65,8 +139,8 @@
 /* ----------- */
 /* Sample Time */
 /* ----------- */
+/* Default (the host can set it between SAMPLE_USEC_MIN and SAMPLE_USEC_MAX) */
 #define PKT_SAMPLE_USEC  128
-#define PRU_CLK_PER_USEC 200
 #define PRU_SAMPLE_TO    (PKT_SAMPLE_USEC * PRU_CLK_PER_USEC)
 
 /* Number of packet sample intervals to detect need to resync Lepton  */
@@ -82,10 +156,17 @@
 /* -------------- */
 /* PRU IO related */
 /* -------------- */
+#ifdef CAPTURE_PRU1
+#define CLK     4       //P8_41
+#define MISO    5       //P8_42
+#define CSN     2       //P8_43
+#define LED     0       //P8_45
+#else
 #define CLK     14      //P8_12
 #define MISO    5       //P9_27
 #define CSN     2       //P9_30
 #define LED     0       //P9_31
+#endif
 
 #define SET_PIN(bit,high)	if(high) __R30 |= (1 << (bit)); else __R30 &= ~(1 << (bit));
 #define INVERT_PIN(bit)		__R30 ^= (1 << (bit));
@@ -98,6 +179,22 @@
 #define LEP_PACKET_SIZE      164 // Bytes
 #define LEP_PACKET_DATA_SIZE 160 // Bytes
 
+/* Comment out to skip checking the packet CRC */
+#define CHECK_CRC
+
+/* Comment out to read packets with spi_read8() instead of spi_packet.asm */
+#define ASM_SPI_READ
+
+/* Packet CRC polynomial: x^16 + x^12 + x^5 + 1 (0 seed, computed with the TTT */
+/* bits of the ID and the CRC set to 0)                                        */
+#define LEP_CRC_POLY         0x1021
+
+#ifdef LEP_TELEM
+#define LAST_PACKET          60
+#else
+#define LAST_PACKET          59
+#endif
+
 
 /* --------- */
 /* Run state */
@@ -117,6 +214,14 @@
 #define PKT_ILLEGAL  3
 
 
+/* ---------------------------- */
+/* Packet storage (get_packet)  */
+/* ---------------------------- */
+#define STORE_NONE   0
+#define STORE_IMAGE  1
+#define STORE_TELEM  2
+
+
 /* ================ */
 /* Global Variables */
 /* ================ */
@@ -124,22 +229,105 @@ volatile register unsigned __R31;
 volatile register unsigned __R30;
 
 /* Shared memory buffer */
+#ifdef DUAL_LEPTON
+/* Our control block */
+volatile uint8_t* buf_en_reg_ptr = SMEM_LEP_EN_REG(LEP_PRU);
+volatile uint8_t* buf_cur_ptr;
+volatile uint32_t* buf_sample_reg_ptr = SMEM_LEP_SAMPLE_REG(LEP_PRU);
+volatile smem_stats_t* stats_ptr = SMEM_LEP_STATS(LEP_PRU);
+volatile uint32_t* lep_magic_reg_ptr = SMEM_LEP_MAGIC_REG(LEP_PRU);
+volatile uint32_t* lep_ring_reg_ptr = SMEM_LEP_RING_REG(LEP_PRU);
+
+/* Our DDR ring */
+volatile ddr_ring_hdr_t* ring_hdr_ptr;
+uint32_t ring_slot = P0_NO_SLOT;  /* Ring frame being captured into */
+#else
 volatile uint8_t* buf_en_reg_ptr = SMEM_EN_REG;
 volatile uint8_t* buf_pru1_cmd_ptr =  SMEM_CMD_REG;
 volatile uint8_t* buf_cur_ptr = SMEM_BUF_START;
+volatile uint32_t* buf_sample_reg_ptr = SMEM_SAMPLE_REG;
+volatile smem_stats_t* stats_ptr = SMEM_STATS;
+#endif
+#ifdef DDR_RING
+#ifndef DUAL_LEPTON
+volatile uint32_t* buf_slot_reg_ptr = SMEM_SLOT_REG;
+volatile uint32_t* buf_done_reg_ptr = SMEM_DONE_REG;
+#endif
+#else
+volatile uint32_t* buf_pkts_reg_ptr = SMEM_PKTS_REG;
+#ifdef LEP_TELEM
+volatile uint32_t* buf_telem_reg_ptr = SMEM_TELEM_REG;
+#endif
+#endif
+#ifdef LEP_TELEM
+volatile uint8_t* telem_cur_ptr;
+#endif
+#ifdef FRAME_TIMESTAMP
+volatile uint32_t* buf_ts_reg_ptr = SMEM_TS_REG;
+#endif
 
 uint8_t run_state = RUN_STATE_STOPPED;
 uint8_t cur_segment = 0; /* 0 while waiting, 1 - 4 while receiving */
-uint8_t cur_packet = 59; /* 0 - 59 */
+uint8_t cur_packet = LAST_PACKET; /* 0 - LAST_PACKET */
 uint8_t cur_count = 0;   /* 0 - 239 */
 uint16_t lep_resync_count = 0; /* Counts sample intervals, reset each trigger */
+uint32_t sample_to = PRU_SAMPLE_TO;  /* Packet sample period in PRU cycles */
+uint16_t resync_threshold_count = RESYNC_THRESHOLD_COUNT;
 uint32_t lep_discard_pkt_count = 0;  /* Counts consecutive Lepton discard packets in a row */
                                      /* for diag purposes to read out with prudebug */
+#ifdef CHECK_CRC
+uint32_t lep_crc_fail_count = 0;     /* Counts packets with a bad CRC for diag purposes */
+#endif
+#if defined(CHECK_CRC) || defined(ASM_SPI_READ)
+uint16_t crc_table[256];
+#endif
+#ifdef ASM_SPI_READ
+#pragma DATA_ALIGN(pkt_buf, 4)
+uint8_t pkt_buf[LEP_PACKET_SIZE];    /* Packet read by spi_read_packet() */
+#endif
 
 
 /* =========== */
 /* Subroutines */
 /* =========== */
+#ifdef ASM_SPI_READ
+/* spi_packet.asm */
+extern uint16_t spi_read_packet(uint8_t* pkt, const uint16_t* table);
+#endif
+
+#if defined(CHECK_CRC) || defined(ASM_SPI_READ)
+void init_crc_table()
+{
+	uint16_t i, j;
+	uint16_t crc;
+
+	for (i=0; i<256; i++) {
+		crc = i << 8;
+		for (j=0; j<8; j++) {
+			crc = (crc & 0x8000) ? ((crc << 1) ^ LEP_CRC_POLY) : (crc << 1);
+		}
+		crc_table[i] = crc;
+	}
+}
+
+#define CRC_UPDATE(crc,b)	crc = (crc << 8) ^ crc_table[(uint8_t) ((crc >> 8) ^ (b))];
+#endif
+
+/* Store a byte in the DDR ring frame or the shared memory circular buffer */
+#ifdef DDR_RING
+#define STORE_BYTE(b)		*buf_cur_ptr++ = (b);
+#else
+#define STORE_BYTE(b)		*buf_cur_ptr++ = (b); if (buf_cur_ptr > SMEM_BUF_END) buf_cur_ptr = SMEM_BUF_START;
+#endif
+
+/* Store a telemetry byte */
+#ifdef LEP_TELEM
+#define STORE_TELEM_BYTE(b)	if (store == STORE_TELEM) *telem_cur_ptr++ = (b);
+#else
+#define STORE_TELEM_BYTE(b)
+#endif
+
+
 void init_pru()
 {
 	/* Enable OCP Master Port */
@@ -148,6 +336,32 @@ void init_pru()
 	/* Make sure we always start up disabled - clear any enable left laying around */
 	*buf_en_reg_ptr = P0_DISABLE;
 
+	/* Clear our health counters */
+	stats_ptr->p0_discard_pkts = 0;
+	stats_ptr->p0_crc_fails = 0;
+	stats_ptr->p0_restarts = 0;
+	stats_ptr->p0_resyncs = 0;
+	stats_ptr->p0_frames = 0;
+
+#ifdef DUAL_LEPTON
+	/* Tell the host we're running (our ring is set up when we're enabled) */
+	*lep_ring_reg_ptr = 0;
+	stats_ptr->magic = SMEM_STATS_MAGIC;
+	*lep_magic_reg_ptr = SMEM_LEP_MAGIC;
+#endif
+
+#if defined(CHECK_CRC) || defined(ASM_SPI_READ)
+	init_crc_table();
+#endif
+
+#ifdef FRAME_TIMESTAMP
+	/* Start the free-running IEP timer counting nSec */
+	CT_IEP.TMR_GLB_CFG_bit.CNT_EN = 0;
+	CT_IEP.TMR_GLB_CFG_bit.DEFAULT_INC = IEP_CNT_INC;
+	CT_IEP.TMR_CNT = 0;
+	CT_IEP.TMR_GLB_CFG_bit.CNT_EN = 1;
+#endif
+
 	/* Set CSN de-asserted and SCK high */
 	SET_PIN(CSN,1);
 	SET_PIN(CLK,1);
@@ -159,33 +373,120 @@ void init_pru()
 }
 
 
+/* Latch the packet sample period PRU1 passed from the host (0 for the default) */
+void init_sample_time()
+{
+	sample_to = *buf_sample_reg_ptr;
+	if (sample_to == 0) {
+		sample_to = PRU_SAMPLE_TO;
+	}
+	resync_threshold_count = (RESYNC_THRESHOLD_USEC * PRU_CLK_PER_USEC) / sample_to;
+}
+
+
 void init_capture()
 {
+#if defined(DUAL_LEPTON)
+	buf_cur_ptr = (volatile uint8_t*) ring_slot;
+#ifdef LEP_TELEM
+	telem_cur_ptr = buf_cur_ptr + LEP_IMAGE_LEN;
+#endif
+#elif defined(DDR_RING)
+	buf_cur_ptr = (volatile uint8_t*) *buf_slot_reg_ptr;
+#ifdef LEP_TELEM
+	telem_cur_ptr = buf_cur_ptr + LEP_IMAGE_LEN;
+#endif
+#else
 	buf_cur_ptr = SMEM_BUF_START;
+	*buf_pkts_reg_ptr = P0_PKTS_RESET;
+#ifdef LEP_TELEM
+	telem_cur_ptr = SMEM_TELEM_START;
+	*buf_telem_reg_ptr = P0_TELEM_RESET;
+#endif
+#endif
 	cur_segment = 0;   /* setup to receive segment 1 in packet 20 as first valid segment */
-	cur_packet = 59;   /* setup to receive packet 0 as first valid packet */
+	cur_packet = LAST_PACKET; /* setup to receive packet 0 as first valid packet */
 	cur_count = 0;
 }
 
 
+#ifdef DUAL_LEPTON
+/*
+ * Initialize our ring header in the carve-out and tell the host where it is
+ */
+void init_ring()
+{
+	uint32_t pa = pru_remoteproc_ResourceTable.ddr_ring.pa;
+
+	ring_hdr_ptr = (volatile ddr_ring_hdr_t*) pa;
+	ring_hdr_ptr->head = 0;
+	ring_hdr_ptr->tail = 0;
+	ring_hdr_ptr->frame_len = DDR_RING_FRAME_LEN;
+	ring_hdr_ptr->num_frames = DDR_RING_FRAMES;
+	ring_hdr_ptr->dropped = 0;
+	ring_hdr_ptr->magic = DDR_RING_MAGIC;
+	ring_slot = P0_NO_SLOT;
+
+	*lep_ring_reg_ptr = pa;
+}
+
+
+/*
+ * Take the next free ring frame to capture into if we don't have one.  Returns 1
+ * if we have a frame.
+ */
+uint8_t take_ring_frame()
+{
+	uint32_t head;
+
+	if (ring_slot == P0_NO_SLOT) {
+		head = ring_hdr_ptr->head;
+		if ((head - ring_hdr_ptr->tail) < DDR_RING_FRAMES) {
+			ring_slot = (uint32_t) ring_hdr_ptr + DDR_RING_HDR_LEN +
+			            (head % DDR_RING_FRAMES) * DDR_RING_FRAME_LEN;
+		}
+	}
+	return (ring_slot != P0_NO_SLOT);
+}
+
+
+/*
+ * Make the frame we just captured available to the host.  Counts a drop if there
+ * isn't a free frame to capture the next frame into.
+ */
+void push_ring_frame()
+{
+	uint32_t head;
+
+	head = ring_hdr_ptr->head + 1;
+	ring_hdr_ptr->head = head;
+	ring_slot = P0_NO_SLOT;
+
+	if ((head - ring_hdr_ptr->tail) >= DDR_RING_FRAMES) {
+		ring_hdr_ptr->dropped += 1;
+	}
+}
+#endif
+
+
 void disable_timer()
 {
-	PRU0_CTRL.CTRL_bit.CTR_EN = 0;
+	LEP_CTRL.CTRL_bit.CTR_EN = 0;
 }
 
 
 void init_timer()
 {
-	PRU0_CTRL.CTRL_bit.CTR_EN = 0;  /* Disable timer */
-	PRU0_CTRL.CYCLE = 0;            /* Reset timer */
-	PRU0_CTRL.CTRL_bit.CTR_EN = 1;  /* Enable timer */
+	LEP_CTRL.CTRL_bit.CTR_EN = 0;  /* Disable timer */
+	LEP_CTRL.CYCLE = 0;            /* Reset timer */
+	LEP_CTRL.CTRL_bit.CTR_EN = 1;  /* Enable timer */
 }
 
 
 /* Returns 1 if the timer has expired - and resets timer */
 int timer_expired()
 {
-	if (PRU0_CTRL.CYCLE >= PRU_SAMPLE_TO) {
+	if (LEP_CTRL.CYCLE >= sample_to) {
 		init_timer();
 		return 1;
 	}
@@ -228,41 +529,156 @@ uint8_t get_packet()
 	uint8_t i;
 	uint8_t pktNumHigh;
 	uint8_t pktNumLow;
-
+	uint8_t store;
+	uint8_t d;
+#if defined(CHECK_CRC) || defined(ASM_SPI_READ)
+	uint16_t pktCrc;
+	uint16_t crc;
+#endif
+#ifdef ASM_SPI_READ
+	uint8_t* p;
+
+	/* Read the whole packet, computing its CRC */
+	crc = spi_read_packet(pkt_buf, crc_table);
+	pktNumHigh = pkt_buf[0];   /* TTT bits and discard indication */
+	pktNumLow = pkt_buf[1];    /* Packet number */
+	pktCrc = (pkt_buf[2] << 8) | pkt_buf[3];
+#else
 	/* Read one packet */
 	pktNumHigh = spi_read8();  /* TTT bits and discard indication */
 	pktNumLow = spi_read8();   /* Packet number */
-	i = spi_read8();           /* Throw away CRC for now */
-	i = spi_read8();           /* Throw away CRC for now */
+#ifdef CHECK_CRC
+	pktCrc = spi_read8() << 8;
+	pktCrc |= spi_read8();
+#else
+	i = spi_read8();           /* Throw away CRC */
+	i = spi_read8();           /* Throw away CRC */
+#endif
+#endif /* ASM_SPI_READ */
 
 	/* Look to see if we should discard this packet */
 	if (((pktNumHigh & 0x0F) == 0x0F) || (run_state == RUN_STATE_DISCARD)) {
 		/* Count discard packets */
 		if ((pktNumHigh & 0x0F) == 0x0F) {
 			++lep_discard_pkt_count;
+			stats_ptr->p0_discard_pkts += 1;
 		} else {
 			lep_discard_pkt_count = 0;
 		}
 
+#ifndef ASM_SPI_READ
 		/* Throw away this packet */
 		for (i=0; i<LEP_PACKET_DATA_SIZE; i++) {
 			(void) spi_read8();
 		}
+#endif
 		return PKT_DISCARD;
 	}
 
 	/* Reset consecutive discard count */
 	lep_discard_pkt_count = 0;
 
+	/* Telemetry packets are stored apart from the image (row D is not stored) */
+	store = STORE_IMAGE;
+#if defined(TELEM_HEADER)
+	if ((cur_segment == 0) && (pktNumLow < TELEM_PACKETS)) {
+		store = (pktNumLow < TELEM_STORE_PACKETS) ? STORE_TELEM : STORE_NONE;
+	}
+#elif defined(TELEM_FOOTER)
+	if ((cur_segment == 4) && (pktNumLow > (LAST_PACKET - TELEM_PACKETS))) {
+		d = pktNumLow - (LAST_PACKET - TELEM_PACKETS + 1);
+		store = (d < TELEM_STORE_PACKETS) ? STORE_TELEM : STORE_NONE;
+	}
+#endif
+
+#if defined(ASM_SPI_READ)
+#ifdef CHECK_CRC
+	if (crc != pktCrc) {
+		/* Corrupted packet - restart */
+		++lep_crc_fail_count;
+		stats_ptr->p0_crc_fails += 1;
+		return PKT_ILLEGAL;
+	}
+#endif
+
 	/* Store packet - low 8-bits of each word */
+	p = &pkt_buf[4];
+	for (i=0; i<LEP_PACKET_DATA_SIZE/2; i++) {
+		d = *p++;
+#ifdef LEP_16BIT
+		if (store == STORE_IMAGE) {
+			STORE_BYTE(d);                 /* Store high half - TLinear data */
+		}
+#endif
+		STORE_TELEM_BYTE(d);               /* Otherwise skip high half */
+		d = *p++;
+		if (store == STORE_IMAGE) {
+			STORE_BYTE(d);                 /* Store low half - output of AGC module */
+		}
+		STORE_TELEM_BYTE(d);
+	}
+#elif defined(CHECK_CRC)
+	/* Start the CRC with the header (TTT bits and CRC field as 0) */
+	crc = 0;
+	CRC_UPDATE(crc, pktNumHigh & 0x0F);
+	CRC_UPDATE(crc, pktNumLow);
+	CRC_UPDATE(crc, 0);
+	CRC_UPDATE(crc, 0);
+
+	/* Store packet - low 8-bits of each word - and include each byte in the CRC */
 	for (i=0; i<LEP_PACKET_DATA_SIZE/2; i++) {
-		(void) spi_read8();                /* Skip high half */
-		*buf_cur_ptr++ = spi_read8();      /* Store low half - output of AGC module */
-		if (buf_cur_ptr > SMEM_BUF_END) {
-			buf_cur_ptr = SMEM_BUF_START;
+		d = spi_read8();                   /* Skip high half */
+		CRC_UPDATE(crc, d);
+#ifdef LEP_16BIT
+		if (store == STORE_IMAGE) {
+			STORE_BYTE(d);                 /* Store high half - TLinear data */
+		}
+#endif
+		STORE_TELEM_BYTE(d);
+		d = spi_read8();
+		CRC_UPDATE(crc, d);
+		if (store == STORE_IMAGE) {
+			STORE_BYTE(d);                 /* Store low half - output of AGC module */
 		}
+		STORE_TELEM_BYTE(d);
 	}
 
+	if (crc != pktCrc) {
+		/* Corrupted packet - restart */
+		++lep_crc_fail_count;
+		stats_ptr->p0_crc_fails += 1;
+		return PKT_ILLEGAL;
+	}
+#else
+	/* Store packet - low 8-bits of each word */
+	for (i=0; i<LEP_PACKET_DATA_SIZE/2; i++) {
+		d = spi_read8();
+#ifdef LEP_16BIT
+		if (store == STORE_IMAGE) {
+			STORE_BYTE(d);                 /* Store high half - TLinear data */
+		}
+#endif
+		STORE_TELEM_BYTE(d);               /* Otherwise skip high half */
+		d = spi_read8();
+		if (store == STORE_IMAGE) {
+			STORE_BYTE(d);                 /* Store low half - output of AGC module */
+		}
+		STORE_TELEM_BYTE(d);
+	}
+#endif
+
+#ifndef DDR_RING
+	/* Let PRU1 know the packet is in the circular buffer (or the telemetry area) */
+	if (store == STORE_IMAGE) {
+		*buf_pkts_reg_ptr += 1;
+	}
+#ifdef LEP_TELEM
+	if (store == STORE_TELEM) {
+		*buf_telem_reg_ptr += 1;
+	}
+#endif
+#endif
+
 	/* Update state */
 	if (pktNumLow == 20) {
 		/* Check and update our segment */
@@ -288,7 +704,7 @@ uint8_t get_packet()
 			/* Unexpected segment number */
 			return PKT_ILLEGAL;
 		}
-	} else if (cur_packet == 59) {
+	} else if (cur_packet == LAST_PACKET) {
 		if (pktNumLow == 0) {
 			/* Expected packet for start of next segment */
 			cur_packet = 0;
@@ -326,7 +742,17 @@ void main()
 		if (*buf_en_reg_ptr == P0_ENABLE) {
 			if (run_state == RUN_STATE_STOPPED) {
 				/* Start up */
+#if defined(DUAL_LEPTON)
+				/* Start a new ring (waiting for a frame if the host hasn't freed one) */
+				init_ring();
+				run_state = take_ring_frame() ? RUN_STATE_DATA : RUN_STATE_DISCARD;
+#elif defined(DDR_RING)
+				/* Wait for a ring frame if PRU1 hasn't offered one */
+				run_state = (*buf_slot_reg_ptr != P0_NO_SLOT) ? RUN_STATE_DATA : RUN_STATE_DISCARD;
+#else
 				run_state = RUN_STATE_DATA;
+#endif
+				init_sample_time();
 				init_capture();
 				init_timer();
 				lep_resync_count = 0;
@@ -348,9 +774,16 @@ void main()
 
 		/* Get data if enabled */
 		if (run_state != RUN_STATE_STOPPED) {
-			/* Check if PRU1 is done processing and we can start pushing data again */
+			/* Check if PRU1 is done processing (or has given us a free ring frame) */
+			/* and we can start pushing data again                                */
 			if (run_state == RUN_STATE_DISCARD) {
+#if defined(DUAL_LEPTON)
+				if (take_ring_frame()) {
+#elif defined(DDR_RING)
+				if (*buf_slot_reg_ptr != P0_NO_SLOT) {
+#else
 				if (*buf_pru1_cmd_ptr == P1_CMD_IDLE) {
+#endif
 					run_state = RUN_STATE_DATA;
 
 					/* Initialize capture system for next frame */
@@ -364,18 +797,27 @@ void main()
 				pkt_response = get_packet();
 				lep_resync_count++;
 				if (pkt_response == PKT_ILLEGAL) {
+#ifndef DDR_RING
 					/* Notify PRU1 if necessary */
 					if (*buf_pru1_cmd_ptr == P1_CMD_IN_FRAME) {
 						*buf_pru1_cmd_ptr = P1_CMD_ABORT;
 						/* PRU1 will clear command when it reads it */
 					}
+#endif
 
 					/* Try to restart */
+					stats_ptr->p0_restarts += 1;
 					init_capture();
 					SET_PIN(LED,0);
 				} else if (pkt_response == PKT_TRIGGER) {
+#ifdef FRAME_TIMESTAMP
+					/* Time the frame for PRU1 */
+					*buf_ts_reg_ptr = CT_IEP.TMR_CNT;
+#endif
+#ifndef DDR_RING
 					/* Got Seg1/Pkt20 - Tell PRU1 to start processing */
 					*buf_pru1_cmd_ptr = P1_CMD_IN_FRAME;
+#endif
 
 					/* Reset lepton resync counter because we expect this is a good frame */
 					lep_resync_count = 0;
@@ -384,8 +826,22 @@ void main()
 					SET_PIN(LED,1);
 				} else if (pkt_response == PKT_GOOD) {
 					/* Look for last packet just pushed */
-					if ((cur_packet == 59) && (cur_segment == 4)) {
-						/* Discard packets until PRU1 is done */
+					if ((cur_packet == LAST_PACKET) && (cur_segment == 4)) {
+						stats_ptr->p0_frames += 1;
+#ifdef DDR_RING
+						/* Read back the last byte to make sure the frame is in DDR */
+						(void) *(buf_cur_ptr - 1);
+
+#ifdef DUAL_LEPTON
+						/* Hand the frame to the host */
+						push_ring_frame();
+#else
+						/* Hand the frame to PRU1 */
+						*buf_done_reg_ptr = *buf_slot_reg_ptr;
+						*buf_slot_reg_ptr = P0_NO_SLOT;
+#endif
+#endif
+						/* Discard packets until PRU1 is done (or has a free ring frame) */
 						run_state = RUN_STATE_DISCARD;
 
 						/* Clear LED */
@@ -394,7 +850,9 @@ void main()
 				}
 
 				/* Look for need to resync Lepton */
-				if (lep_resync_count == RESYNC_THRESHOLD_COUNT) {
+				if (lep_resync_count == resync_threshold_count) {
+					stats_ptr->p0_resyncs += 1;
+
 					/* De-assert CS and LED */
 					SET_PIN(CSN,1);
 					SET_PIN(LED,0);
@@ -2,19 +2,182 @@
  * Common header for both PRUs
  */
 
+/* Uncomment to transfer the full 16-bit Lepton data words (Radiometric TLinear       */
+/* pixels) instead of the low 8-bits (AGC pixels).  Must match VOSPI_16BIT in the     */
+/* application's vospi.h                                                              */
+//#define LEP_16BIT
+
+/* Uncomment to have PRU0 capture complete frames directly into a ring in a DDR        */
+/* carve-out (allocated by remoteproc from PRU1's resource table) that PRU1 hands to  */
+/* the host instead of passing the frame data through the shared memory circular     */
+/* buffer and rpmsg messages.  Must match VOSPI_DDR_RING in the application's vospi.h */
+//#define DDR_RING
+
+/* Uncomment to capture two Leptons, one with each PRU.  Both PRUs run the capture     */
+/* firmware (pru0_main.c, built for PRU1 as pru1_lepton.out by "make dual") and each   */
+/* manages its own DDR ring (allocated by remoteproc from its resource table) with no  */
+/* PRU1 relay or rpmsg.  The host controls each PRU and polls its ring through the     */
+/* PRU's control block in shared memory.  Implies DDR_RING.  Must match               */
+/* VOSPI_DUAL_LEPTON in the application's vospi.h                                     */
+//#define DUAL_LEPTON
+
+#if defined(DUAL_LEPTON) && !defined(DDR_RING)
+#define DDR_RING
+#endif
+
+/* Uncomment (with DDR_RING) to announce PRU1's rpmsg channel to the pru_lepton_v4l2  */
+/* kernel driver (kmod directory) instead of the rpmsg_pru character device driver   */
+//#define V4L2_DRIVER
+
+/* Uncomment to have PRU1 compute the minimum, maximum, sum and a 256-bin histogram   */
+/* of each frame's pixels while it copies them and send them in two extra messages   */
+/* at the end of the frame (rpmsg transport only).  Must match VOSPI_FRAME_STATS in   */
+/* the application's vospi.h                                                          */
+//#define FRAME_STATS
+
+/* Uncomment to have PRU0 latch the PRU-ICSS IEP timer when it sees segment 1 of a      */
+/* frame (packet 20) and PRU1 send it with the frame, along with how long ago that was, */
+/* so the host can time the frame's capture instead of its arrival.  Must match        */
+/* VOSPI_FRAME_TIMESTAMP in the application's vospi.h                                 */
+//#define FRAME_TIMESTAMP
+
+/* Define one to match the telemetry location configured on the Lepton by the        */
+/* application (leave both commented out when telemetry is disabled).  PRU0 stores    */
+/* telemetry rows A-C (full 16-bit words, high byte first) and PRU1 sends them in     */
+/* TELEM_NUM_MSGS extra messages following the image (or after the image in each     */
+/* DDR ring frame).  Must match VOSPI_TELEM_HEADER/VOSPI_TELEM_FOOTER in the          */
+/* application's vospi.h                                                              */
+//#define TELEM_HEADER
+//#define TELEM_FOOTER
+
+/* Telemetry packets in each frame and the ones stored (rows A-C, row D is reserved)  */
+#if defined(TELEM_HEADER) || defined(TELEM_FOOTER)
+#define LEP_TELEM
+#define TELEM_STORE_PACKETS      3
+#define TELEM_NUM_MSGS           1
+#else
+#define TELEM_STORE_PACKETS      0
+#define TELEM_NUM_MSGS           0
+#endif
+#define TELEM_PACKETS            4
+#define TELEM_LEN                (TELEM_STORE_PACKETS * 160)
+
+/* Image length (telemetry follows it in DDR ring frames) */
+#ifdef LEP_16BIT
+#define LEP_IMAGE_LEN            (160 * 120 * 2)
+#else
+#define LEP_IMAGE_LEN            (160 * 120)
+#endif
+
+/* PRU clock rate */
+#define PRU_CLK_PER_USEC         200
+
+/* Host timing command - HOST_CMD_TIMING followed by the PRU0 packet sample period  */
+/* and the PRU1 message period in uSec as 16-bit little endian values (a value      */
+/* outside its range selects the default).  PRU1 passes the sample period to PRU0   */
+/* in PRU cycles through the SAMPLE register (0 for the default) and PRU0 latches   */
+/* it when it is enabled.  Must match the VOSPI timing values in the application's  */
+/* vospi.h                                                                          */
+#define HOST_CMD_TIMING          'T'
+#define HOST_CMD_TIMING_LEN      5
+#define SAMPLE_USEC_MIN          100
+#define SAMPLE_USEC_MAX          157
+#define XMIT_USEC_MIN            200
+#define XMIT_USEC_MAX            2000
+
+/* IEP timer increment per 200 MHz IEP clock so it counts nSec (wrapping every 4.3 Sec) */
+#define IEP_CNT_INC              5
+
+/* DDR ring carve-out length - large enough for the header and four 16-bit frames     */
+#define DDR_RING_LEN             0x40000
+
+/* DDR ring carve-out layout - the header followed by DDR_RING_FRAMES frames, each the */
+/* image then any telemetry                                                           */
+#define DDR_RING_MAGIC           0x4C455052  /* "LEPR" */
+#define DDR_RING_HDR_LEN         64
+#define DDR_RING_FRAMES          4
+#define DDR_RING_FRAME_LEN       (LEP_IMAGE_LEN + TELEM_LEN)
+
+/* Ring header at the start of the carve-out - must match vospi_ring_hdr_t */
+typedef struct {
+	uint32_t magic;
+	uint32_t head;        /* Frames written by PRU1 (by the capturing PRU with DUAL_LEPTON) */
+	uint32_t tail;        /* Frames consumed by the host */
+	uint32_t frame_len;
+	uint32_t num_frames;
+	uint32_t dropped;     /* Times the capturing PRU had to wait for a free frame */
+} ddr_ring_hdr_t;
+
 /* Shared Memory Layout */
 #define SMEM_BASE_PHYS_ADDR      0x10000
 #define SMEM_LEN                 (12 * 1024)
 #define SMEM_P0_EN_OFFSET        0
 #define SMEM_P1_CMD_OFFSET       1
-#define SMEM_BUF_START_OFFSET    2
-#define SMEM_BUF_END_OFFSET      (SMEM_LEN - 1)
+#define SMEM_P0_SLOT_OFFSET      4
+#define SMEM_P0_DONE_OFFSET      8
+#define SMEM_P0_SAMPLE_OFFSET    12
+#define SMEM_P0_PKTS_OFFSET      16
+#define SMEM_P0_TS_OFFSET        20
+#define SMEM_P0_TELEM_OFFSET     24
+#define SMEM_STATS_OFFSET        28
+#define SMEM_BUF_START_OFFSET    (SMEM_STATS_OFFSET + 40)
+#define SMEM_TELEM_START_OFFSET  (SMEM_LEN - TELEM_LEN)
+#define SMEM_BUF_END_OFFSET      (SMEM_TELEM_START_OFFSET - 1)
+#define SMEM_BUF_LEN             (SMEM_BUF_END_OFFSET - SMEM_BUF_START_OFFSET + 1)
 
 /* Shared Memory Addresses */
 #define SMEM_EN_REG      (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_EN_OFFSET)
 #define SMEM_CMD_REG     (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P1_CMD_OFFSET)
+#define SMEM_SLOT_REG    (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_SLOT_OFFSET)
+#define SMEM_DONE_REG    (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_DONE_OFFSET)
+#define SMEM_SAMPLE_REG  (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_SAMPLE_OFFSET)
+#define SMEM_PKTS_REG    (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_PKTS_OFFSET)
+#define SMEM_TS_REG      (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_TS_OFFSET)
+#define SMEM_TELEM_REG   (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_TELEM_OFFSET)
+#define SMEM_STATS       (volatile smem_stats_t*) (SMEM_BASE_PHYS_ADDR + SMEM_STATS_OFFSET)
 #define SMEM_BUF_START   (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_BUF_START_OFFSET)
 #define SMEM_BUF_END     (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_BUF_END_OFFSET)
+#define SMEM_TELEM_START (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_TELEM_START_OFFSET)
+
+/* Dual Lepton control blocks (DUAL_LEPTON only) - one for each PRU in place of the    */
+/* circular buffer.  The PRU sets MAGIC when it boots and RING to the physical address */
+/* of its carve-out once it has initialized the ring header after being enabled.  The */
+/* host sets SAMPLE (the packet sample period in PRU cycles, 0 for the default), clears */
+/* RING and then sets EN to P0_ENABLE.  The PRU's health counters (the p0_ ones) follow */
+/* at STATS.  Must match the VOSPI_LEP_xxx offsets in the application's vospi.h        */
+#define SMEM_LEP_LEN             64
+#define SMEM_LEP_OFFSET(pru)     (SMEM_BUF_START_OFFSET + (pru) * SMEM_LEP_LEN)
+#define SMEM_LEP_MAGIC_OFFSET    0
+#define SMEM_LEP_EN_OFFSET       4
+#define SMEM_LEP_SAMPLE_OFFSET   8
+#define SMEM_LEP_RING_OFFSET     12
+#define SMEM_LEP_STATS_OFFSET    16
+#define SMEM_LEP_MAGIC           0x4C45504C  /* "LEPL" */
+
+#define SMEM_LEP_MAGIC_REG(pru)  (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_LEP_OFFSET(pru) + SMEM_LEP_MAGIC_OFFSET)
+#define SMEM_LEP_EN_REG(pru)     (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_LEP_OFFSET(pru) + SMEM_LEP_EN_OFFSET)
+#define SMEM_LEP_SAMPLE_REG(pru) (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_LEP_OFFSET(pru) + SMEM_LEP_SAMPLE_OFFSET)
+#define SMEM_LEP_RING_REG(pru)   (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_LEP_OFFSET(pru) + SMEM_LEP_RING_OFFSET)
+#define SMEM_LEP_STATS(pru)      (volatile smem_stats_t*) (SMEM_BASE_PHYS_ADDR + SMEM_LEP_OFFSET(pru) + SMEM_LEP_STATS_OFFSET)
+
+/* Health counters - free-running counts (cleared when each PRU boots) that the host  */
+/* reads from the PRU shared RAM through /dev/mem to monitor the capture.  Each PRU    */
+/* only writes its own counters.  Must match pru_stats_t in the application's         */
+/* pru_stats.h                                                                        */
+#define SMEM_STATS_MAGIC         0x4C455053  /* "LEPS" - set by PRU1 */
+
+typedef struct {
+	uint32_t magic;
+	uint32_t p0_discard_pkts;  /* Discard packets from the Lepton */
+	uint32_t p0_crc_fails;     /* Packets with a bad CRC */
+	uint32_t p0_restarts;      /* Capture restarts after an unexpected packet (or bad CRC) */
+	uint32_t p0_resyncs;       /* Lepton resyncs (no frame for RESYNC_THRESHOLD_USEC) */
+	uint32_t p0_frames;        /* Frames captured */
+	uint32_t p1_aborts;        /* Frames aborted by PRU0 (P1_CMD_ABORT) */
+	uint32_t p1_timing_fails;  /* Frames aborted for a message under/overrun */
+	uint32_t p1_send_fails;    /* Failed rpmsg sends (host lost) */
+	uint32_t p1_frames;        /* Frames sent to the host */
+} smem_stats_t;
 
 /* P0 Enable values - Set by P1 to enable/disable P0 */
 #define P0_DISABLE               0
@@ -26,3 +189,20 @@
 #define P1_CMD_IN_FRAME          1
 #define P1_CMD_ABORT             2
 
+/* P0 SLOT/DONE values (DDR_RING only) - PRU1 writes the DDR address of the next free  */
+/* ring frame to SLOT.  PRU0 captures a frame into it, writes its address to DONE and  */
+/* sets SLOT to P0_NO_SLOT.  PRU1 makes the frame in DONE available to the host, sets  */
+/* DONE to P0_NO_SLOT and offers the next free frame.  PRU0 only waits for a frame     */
+/* (discarding packets) when the ring is full.                                         */
+#define P0_NO_SLOT               0
+
+/* P0 PKTS value (rpmsg transport only) - PRU0 counts the packets it has stored in the */
+/* circular buffer since the start of the frame so PRU1 can check that the data for a  */
+/* message is there (not yet stored means PRU1 is sending too fast) and hasn't been    */
+/* overwritten (PRU1 is sending too slowly) before it sends it.                        */
+#define P0_PKTS_RESET            0
+
+/* P0 TELEM value (rpmsg transport only) - PRU0 stores the telemetry rows at the end   */
+/* of shared memory (after the circular buffer) and counts them in the TELEM register */
+/* so PRU1 only sends them once they are all there.                                   */
+#define P0_TELEM_RESET           0
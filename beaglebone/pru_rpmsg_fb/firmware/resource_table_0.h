@@ -45,6 +45,9 @@
  *        2) As-is if a PRU application does not need to configure PRU_INTC
  *                  or interact with the rpmsg driver
  *
+ *  With DUAL_LEPTON it holds the DDR ring carve-out for the capture firmware
+ *  (built for either PRU).
+ *
  */
 
 #ifndef _RSC_TABLE_PRU_H_
@@ -53,19 +56,44 @@
 #include <stddef.h>
 #include <rsc_types.h>
 
+#ifdef DUAL_LEPTON
+#define RSC_NUM_ENTRIES		1
+#else
+#define RSC_NUM_ENTRIES		0
+#endif
+
 struct my_resource_table {
 	struct resource_table base;
 
 	uint32_t offset[1]; /* Should match 'num' in actual definition */
+
+#ifdef DUAL_LEPTON
+	/* DDR ring carve-out */
+	struct fw_rsc_carveout ddr_ring;
+#endif
 };
 
 #pragma DATA_SECTION(pru_remoteproc_ResourceTable, ".resource_table")
 #pragma RETAIN(pru_remoteproc_ResourceTable)
 struct my_resource_table pru_remoteproc_ResourceTable = {
 	1,	/* we're the first version that implements this */
-	0,	/* number of entries in the table */
+	RSC_NUM_ENTRIES,	/* number of entries in the table */
 	0, 0,	/* reserved, must be zero */
+#ifdef DUAL_LEPTON
+	{ offsetof(struct my_resource_table, ddr_ring) },	/* offset[0] */
+
+	{
+		TYPE_CARVEOUT,
+		0,                      //da, will be populated by host
+		0,                      //pa, will be populated by host
+		DDR_RING_LEN,           //len (bytes)
+		0,                      //flags
+		0,                      //reserved
+		"ddr_ring",             //name
+	},
+#else
 	0,	/* offset[0] */
+#endif
 };
 
 #endif /* _RSC_TABLE_PRU_H_ */
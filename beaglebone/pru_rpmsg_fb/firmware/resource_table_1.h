@@ -24,6 +24,13 @@
 /* This firmware supports name service notifications as one of its features */
 #define RPMSG_PRU_C0_FEATURES	(1 << VIRTIO_RPMSG_F_NS)
 
+/* Number of resource table entries (the DDR ring adds a carve-out) */
+#ifdef DDR_RING
+#define RSC_NUM_ENTRIES		3
+#else
+#define RSC_NUM_ENTRIES		2
+#endif
+
 /* Definition for unused interrupts */
 #define HOST_UNUSED		255
 
@@ -49,7 +56,11 @@
 #define PRU0_TO_ARM_CHANNEL  HOST_UNUSED
 #define PRU0_FROM_ARM_CHANNEL HOST_UNUSED
 #define HOST_INT			0x80000000
+#ifdef V4L2_DRIVER
+#define CHAN_NAME			"lepton-v4l2"
+#else
 #define CHAN_NAME			"rpmsg-pru"
+#endif
 #define CHAN_DESC			"Channel 31"
 #define CHAN_PORT			31
 #define TO_ARM_CHANNEL PRU1_TO_ARM_CHANNEL
@@ -63,7 +74,7 @@ struct ch_map pru_intc_map[] = { {TO_ARM_HOST, TO_ARM_CHANNEL},
 struct my_resource_table {
 	struct resource_table base;
 
-	uint32_t offset[2]; /* Should match 'num' in actual definition */
+	uint32_t offset[RSC_NUM_ENTRIES]; /* Should match 'num' in actual definition */
 
 	/* rpmsg vdev entry */
 	struct fw_rsc_vdev rpmsg_vdev;
@@ -72,18 +83,26 @@ struct my_resource_table {
 
 	/* intc definition */
 	struct fw_rsc_custom pru_ints;
+
+#ifdef DDR_RING
+	/* DDR ring carve-out */
+	struct fw_rsc_carveout ddr_ring;
+#endif
 };
 
 #pragma DATA_SECTION(resourceTable, ".resource_table")
 #pragma RETAIN(resourceTable)
 struct my_resource_table resourceTable = {
 	1,	/* Resource table version: only version 1 is supported by the current driver */
-	2,	/* number of entries in the table */
+	RSC_NUM_ENTRIES,	/* number of entries in the table */
 	0, 0,	/* reserved, must be zero */
 	/* offsets to entries */
 	{
 		offsetof(struct my_resource_table, rpmsg_vdev),
 		offsetof(struct my_resource_table, pru_ints),
+#ifdef DDR_RING
+		offsetof(struct my_resource_table, ddr_ring),
+#endif
 	},
 
 	/* rpmsg vdev entry */
@@ -129,6 +148,18 @@ struct my_resource_table resourceTable = {
 			pru_intc_map,
 		},
 	},
+
+#ifdef DDR_RING
+	{
+		TYPE_CARVEOUT,
+		0,                      //da, will be populated by host
+		0,                      //pa, will be populated by host
+		DDR_RING_LEN,           //len (bytes)
+		0,                      //flags
+		0,                      //reserved
+		"ddr_ring",             //name
+	},
+#endif
 };
 
 #endif /* _RSC_TABLE_PRU_H_ */
@@ -0,0 +1,147 @@
+;
+; PRU Firmware for IR camera FLIR Lepton 3 - assembly VoSPI packet reader
+;
+; uint16_t spi_read_packet(uint8_t* pkt, const uint16_t* crc_table)
+;
+; Reads one complete 164 byte packet (ID, CRC and 160 data bytes) from the Lepton
+; into pkt (4-byte aligned, in PRU data RAM) using the same bit-banged MISO-only
+; SPI mode 3 interface as spi_read8() in pru0_main.c and returns the packet CRC it
+; computed as the bytes were read (the ID with the TTT bits as 0 and the CRC field
+; as 0 followed by the data, crc_table is the 256 entry CRC-16 table used by
+; pru0_main.c).  CSN must be asserted on entry.
+;
+; The bit reads are unrolled so each bit takes exactly 10 cycles (5 low and 5 high,
+; 20 MHz, the Lepton's maximum VoSPI clock) and the bits are assembled in registers
+; instead of a variable in memory, so there is none of the variability of the C
+; reader.  The CRC table lookup for each byte and the move of the byte into the
+; word being assembled stretch the high half of the byte's last bit.  Each 4 bytes
+; are written to pkt with one SBBO.  A packet takes about 15000 cycles (75 uSec).
+;
+; Built into the capture firmware for PRU1 (the second Lepton with DUAL_LEPTON)
+; with CAPTURE_PRU1 defined, which uses PRU1's pins.
+;
+; Registers (all save-on-call in the PRU C calling convention)
+;   r14  pkt (argument), next word of pkt to write, returns the CRC
+;   r15  crc_table (argument)
+;   r16  bits being shifted in (MISO at bit MISO_BIT, the byte's first bit
+;        ends up MISO_BIT + 7)
+;   r17  MISO sample
+;   r18  word being assembled
+;   r19  CRC (low 16 bits)
+;   r20  CRC table offset
+;   r21  CRC table entry
+;   r22  byte read
+;
+; Copyright (C) 2018 Dan Julio <dan@danjuliodesigns.com>
+;
+; This program is free software; you can redistribute it and/or modify it
+; under the terms of the GNU General Public License as published by the
+; Free Software Foundation; either version 2 of the License, or (at your
+; option) any later version.
+;
+
+; PRU IO (the pins used by pru0_main.c)
+	.if	$isdefed("CAPTURE_PRU1")
+CLK_BIT		.set	4		; P8_41
+MISO_BIT	.set	5		; P8_42
+	.else
+CLK_BIT		.set	14		; P8_12
+MISO_BIT	.set	5		; P9_27
+	.endif
+MISO_MASK	.set	(1 << MISO_BIT)
+
+; Data words in a packet, read 4 bytes at a time
+DATA_WORDS	.set	40
+
+
+; Clock in one bit: the Lepton changes MISO after the falling edge and it is sampled
+; after the rising edge
+SPI_BIT		.macro
+	CLR	r30, r30, CLK_BIT
+	LSL	r16, r16, 1
+	NOP
+	NOP
+	NOP
+	SET	r30, r30, CLK_BIT
+	AND	r17, r31, MISO_MASK
+	OR	r16, r16, r17
+	NOP
+	NOP
+	.endm
+
+; The last bit of a byte leaves its high half to the byte's processing
+SPI_LAST_BIT	.macro
+	CLR	r30, r30, CLK_BIT
+	LSL	r16, r16, 1
+	NOP
+	NOP
+	NOP
+	SET	r30, r30, CLK_BIT
+	AND	r17, r31, MISO_MASK
+	OR	r16, r16, r17
+	.endm
+
+; Read one byte (MSB first) into byte lane of the word being assembled (and r22)
+SPI_BYTE	.macro	lane
+	SPI_BIT
+	SPI_BIT
+	SPI_BIT
+	SPI_BIT
+	SPI_BIT
+	SPI_BIT
+	SPI_BIT
+	SPI_LAST_BIT
+	LSR	r22, r16, MISO_BIT
+	MOV	r18.b:lane:, r22.b0
+	.endm
+
+; crc = (crc << 8) ^ crc_table[(crc >> 8) ^ val]
+CRC_UPDATE	.macro	val
+	LSR	r20, r19, 8
+	XOR	r20.b0, r20.b0, val
+	LSL	r20, r20.b0, 1
+	LBBO	&r21.w0, r15, r20, 2
+	LSL	r19, r19, 8
+	XOR	r19.w0, r19.w0, r21.w0
+	.endm
+
+; Read a data byte into lane and add it to the CRC
+SPI_DATA_BYTE	.macro	lane
+	SPI_BYTE	lane
+	CRC_UPDATE	r22.b0
+	.endm
+
+
+	.sect	".text:spi_read_packet"
+	.clink
+	.global	spi_read_packet
+spi_read_packet:
+	; ID and CRC
+	SPI_BYTE	0
+	SPI_BYTE	1
+	SPI_BYTE	2
+	SPI_BYTE	3
+	SBBO	&r18, r14, 0, 4
+	ADD	r14, r14, 4
+
+	; The CRC starts with the ID (TTT bits as 0) and the CRC field as 0
+	LDI	r19, 0
+	AND	r22.b0, r18.b0, 0x0F
+	CRC_UPDATE	r22.b0
+	CRC_UPDATE	r18.b1
+	LDI	r22, 0
+	CRC_UPDATE	r22.b0
+	CRC_UPDATE	r22.b0
+
+	; Data
+	LOOP	data_done, DATA_WORDS
+	SPI_DATA_BYTE	0
+	SPI_DATA_BYTE	1
+	SPI_DATA_BYTE	2
+	SPI_DATA_BYTE	3
+	SBBO	&r18, r14, 0, 4
+	ADD	r14, r14, 4
+data_done:
+
+	MOV	r14, r19.w0
+	JMP	r3.w2
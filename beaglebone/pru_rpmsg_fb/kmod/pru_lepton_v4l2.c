@@ -0,0 +1,555 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * PRU Lepton V4L2 capture driver
+ *
+ * Binds to the "lepton-v4l2" rpmsg channel PRU1 announces when the firmware is
+ * built with DDR_RING and V4L2_DRIVER and exposes the frames PRU0 captures into the
+ * DDR ring carve-out as a V4L2 capture device.  Starting the stream enables the
+ * PRUs (after optionally setting their timing).  PRU1 replies with the carve-out's
+ * address, which is looked up in the PRU remoteproc's carve-outs, and then sends a
+ * notification with the new ring head for each frame.  The notification callback
+ * copies the frame into the next queued vb2 buffer, stamps it and releases the ring
+ * frame back to PRU1 so the application wakes once per frame with a single
+ * VIDIOC_DQBUF and reads the pixels from its mmap'd buffer.  Frames that arrive
+ * while no buffer is queued are dropped (counted in the sequence numbers).  Buffers
+ * are stamped when the notification arrives or, for firmware built with
+ * FRAME_TIMESTAMP, with the capture time (the arrival time less the age of the IEP
+ * timestamp PRU0 latched at the start of the frame).
+ *
+ * The Lepton must be configured through CCI (init_lep or any of the applications)
+ * before streaming.  Frames are 160x120 GREY (AGC) or, with pixel16=1 for firmware
+ * built with LEP_16BIT, Y16_BE (TLinear Kelvin * 100, high byte first as the PRUs
+ * store them).
+ *
+ */
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/remoteproc.h>
+#include <linux/rpmsg.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/version.h>
+#include <linux/videodev2.h>
+#include <media/v4l2-dev.h>
+#include <media/v4l2-device.h>
+#include <media/v4l2-ioctl.h>
+#include <media/videobuf2-v4l2.h>
+#include <media/videobuf2-vmalloc.h>
+
+
+/* Frame geometry */
+#define LEP_WIDTH             160
+#define LEP_HEIGHT            120
+#define LEP_FPS               9
+
+/* PRU1 commands and ring messages - must match pru_common.h and pru1_main.c */
+#define LEP_CMD_START         "1"
+#define LEP_CMD_STOP          "0"
+#define LEP_CMD_TIMING        'T'
+#define LEP_CMD_TIMING_LEN    5
+#define LEP_RING_INFO_MSG     0xFE
+#define LEP_RING_FRAME_MSG    0xFD
+#define LEP_RING_MSG_LEN      5
+#define LEP_RING_TS_MSG_LEN   13     /* FRAME followed by the IEP count and its age */
+
+/* DDR ring carve-out - must match DDR_RING_xxx in pru1_main.c and pru_common.h */
+#define LEP_RING_MAGIC        0x4C455052
+#define LEP_RING_LEN          0x40000
+#define LEP_RING_HDR_LEN      64
+
+struct lep_ring_hdr {
+	u32 magic;
+	u32 head;             /* Frames written by PRU1 */
+	u32 tail;             /* Frames consumed by us */
+	u32 frame_len;
+	u32 num_frames;
+	u32 dropped;          /* Times PRU0 had to wait for a free frame */
+};
+
+struct lep_buf {
+	struct vb2_v4l2_buffer vb;
+	struct list_head list;
+};
+
+struct lep_dev {
+	struct rpmsg_device *rpdev;
+	struct v4l2_device v4l2_dev;
+	struct video_device vdev;
+	struct vb2_queue queue;
+	struct mutex lock;            /* Serializes the V4L2 ioctls */
+
+	spinlock_t buf_lock;          /* Protects the fields below */
+	struct list_head buf_list;    /* Queued buffers */
+	bool streaming;
+	struct lep_ring_hdr *ring;    /* NULL until PRU1 sends the ring address */
+	u32 sequence;                 /* Frames received while streaming */
+
+	u32 pixfmt;
+	u32 bytesperline;
+	u32 frame_len;
+};
+
+static bool pixel16;
+module_param(pixel16, bool, 0444);
+MODULE_PARM_DESC(pixel16, "16-bit TLinear frames (firmware built with LEP_16BIT)");
+
+static ushort sample_usec;
+module_param(sample_usec, ushort, 0644);
+MODULE_PARM_DESC(sample_usec, "PRU0 packet sample period in uSec (0 for the firmware default)");
+
+static ushort xmit_usec;
+module_param(xmit_usec, ushort, 0644);
+MODULE_PARM_DESC(xmit_usec, "PRU1 message period in uSec (0 for the firmware default)");
+
+
+
+/*
+ * Ring access
+ */
+
+/* Look up the kernel mapping of the ring carve-out at the address PRU1 sent */
+static struct lep_ring_hdr *lep_map_ring(struct lep_dev *lep, u32 pa)
+{
+	struct rproc *rproc;
+	struct lep_ring_hdr *ring;
+
+	rproc = rproc_get_by_child(&lep->rpdev->dev);
+	if (!rproc) {
+		dev_err(&lep->rpdev->dev, "no remoteproc for the rpmsg channel\n");
+		return NULL;
+	}
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 13, 0)
+	ring = rproc_da_to_va(rproc, pa, LEP_RING_LEN, NULL);
+#else
+	ring = rproc_da_to_va(rproc, pa, LEP_RING_LEN);
+#endif
+	if (!ring) {
+		dev_err(&lep->rpdev->dev, "ring 0x%08x is not a carve-out\n", pa);
+		return NULL;
+	}
+
+	/* Ring frames may have telemetry after the image (which isn't passed on) */
+	if ((ring->magic != LEP_RING_MAGIC) || (ring->frame_len < lep->frame_len)) {
+		dev_err(&lep->rpdev->dev, "unexpected ring header - check DDR_RING and pixel16\n");
+		return NULL;
+	}
+	dev_info(&lep->rpdev->dev, "ring of %u frames at 0x%08x\n", ring->num_frames, pa);
+
+	return ring;
+}
+
+
+/* Copy the oldest ring frame into the next queued buffer and release it to PRU1 */
+static void lep_take_frame(struct lep_dev *lep, u64 timestamp)
+{
+	struct lep_ring_hdr *ring = lep->ring;
+	struct lep_buf *buf = NULL;
+	unsigned long flags;
+	u8 *src;
+	u32 tail;
+
+	spin_lock_irqsave(&lep->buf_lock, flags);
+	if (!list_empty(&lep->buf_list)) {
+		buf = list_first_entry(&lep->buf_list, struct lep_buf, list);
+		list_del(&buf->list);
+	}
+	spin_unlock_irqrestore(&lep->buf_lock, flags);
+
+	rmb();
+	tail = READ_ONCE(ring->tail);
+	if (buf) {
+		src = (u8 *) ring + LEP_RING_HDR_LEN + (tail % ring->num_frames) * ring->frame_len;
+		memcpy(vb2_plane_vaddr(&buf->vb.vb2_buf, 0), src, lep->frame_len);
+		vb2_set_plane_payload(&buf->vb.vb2_buf, 0, lep->frame_len);
+		buf->vb.vb2_buf.timestamp = timestamp;
+		buf->vb.sequence = lep->sequence;
+		buf->vb.field = V4L2_FIELD_NONE;
+		vb2_buffer_done(&buf->vb.vb2_buf, VB2_BUF_STATE_DONE);
+	}
+	lep->sequence++;
+
+	/* Release the ring frame back to PRU1 */
+	wmb();
+	WRITE_ONCE(ring->tail, tail + 1);
+}
+
+
+/* Return all of the queued buffers to vb2 */
+static void lep_return_bufs(struct lep_dev *lep, enum vb2_buffer_state state)
+{
+	struct lep_buf *buf, *tmp;
+	unsigned long flags;
+
+	spin_lock_irqsave(&lep->buf_lock, flags);
+	list_for_each_entry_safe(buf, tmp, &lep->buf_list, list) {
+		list_del(&buf->list);
+		vb2_buffer_done(&buf->vb.vb2_buf, state);
+	}
+	spin_unlock_irqrestore(&lep->buf_lock, flags);
+}
+
+
+
+/*
+ * rpmsg
+ */
+
+static int lep_rpmsg_cb(struct rpmsg_device *rpdev, void *data, int len, void *priv, u32 src)
+{
+	struct lep_dev *lep = dev_get_drvdata(&rpdev->dev);
+	u8 *msg = data;
+	u64 now = ktime_get_ns();
+	u32 val;
+
+	if (len < LEP_RING_MSG_LEN) {
+		return 0;
+	}
+	val = msg[1] | (msg[2] << 8) | (msg[3] << 16) | ((u32) msg[4] << 24);
+
+	if (!READ_ONCE(lep->streaming)) {
+		return 0;
+	}
+
+	if (msg[0] == LEP_RING_INFO_MSG) {
+		lep->ring = lep_map_ring(lep, val);
+	} else if ((msg[0] == LEP_RING_FRAME_MSG) && lep->ring) {
+		/* Back date the frame by the age of its IEP timestamp */
+		if (len >= LEP_RING_TS_MSG_LEN)
+			now -= msg[9] | (msg[10] << 8) | (msg[11] << 16) | ((u32) msg[12] << 24);
+		lep_take_frame(lep, now);
+	}
+
+	return 0;
+}
+
+
+static int lep_send_cmd(struct lep_dev *lep, void *cmd, int len)
+{
+	int ret = rpmsg_send(lep->rpdev->ept, cmd, len);
+
+	if (ret)
+		dev_err(&lep->rpdev->dev, "failed to send command (%d)\n", ret);
+	return ret;
+}
+
+
+
+/*
+ * videobuf2
+ */
+
+static int lep_queue_setup(struct vb2_queue *vq, unsigned int *nbuffers, unsigned int *nplanes,
+                           unsigned int sizes[], struct device *alloc_devs[])
+{
+	struct lep_dev *lep = vb2_get_drv_priv(vq);
+
+	if (*nplanes)
+		return (sizes[0] < lep->frame_len) ? -EINVAL : 0;
+
+	*nplanes = 1;
+	sizes[0] = lep->frame_len;
+	if (*nbuffers < 2)
+		*nbuffers = 2;
+	return 0;
+}
+
+
+static int lep_buf_prepare(struct vb2_buffer *vb)
+{
+	struct lep_dev *lep = vb2_get_drv_priv(vb->vb2_queue);
+
+	if (vb2_plane_size(vb, 0) < lep->frame_len)
+		return -EINVAL;
+	return 0;
+}
+
+
+static void lep_buf_queue(struct vb2_buffer *vb)
+{
+	struct lep_dev *lep = vb2_get_drv_priv(vb->vb2_queue);
+	struct lep_buf *buf = container_of(to_vb2_v4l2_buffer(vb), struct lep_buf, vb);
+	unsigned long flags;
+
+	spin_lock_irqsave(&lep->buf_lock, flags);
+	list_add_tail(&buf->list, &lep->buf_list);
+	spin_unlock_irqrestore(&lep->buf_lock, flags);
+}
+
+
+static int lep_start_streaming(struct vb2_queue *vq, unsigned int count)
+{
+	struct lep_dev *lep = vb2_get_drv_priv(vq);
+	u8 timing[LEP_CMD_TIMING_LEN];
+	int ret;
+
+	lep->sequence = 0;
+	lep->ring = NULL;
+	WRITE_ONCE(lep->streaming, true);
+
+	/* Set the PRU timing and enable the PRUs (PRU1 replies with the ring address) */
+	timing[0] = LEP_CMD_TIMING;
+	timing[1] = sample_usec & 0xFF;
+	timing[2] = sample_usec >> 8;
+	timing[3] = xmit_usec & 0xFF;
+	timing[4] = xmit_usec >> 8;
+	ret = lep_send_cmd(lep, timing, LEP_CMD_TIMING_LEN);
+	if (!ret)
+		ret = lep_send_cmd(lep, LEP_CMD_START, 2);
+
+	if (ret) {
+		WRITE_ONCE(lep->streaming, false);
+		lep_return_bufs(lep, VB2_BUF_STATE_QUEUED);
+	}
+	return ret;
+}
+
+
+static void lep_stop_streaming(struct vb2_queue *vq)
+{
+	struct lep_dev *lep = vb2_get_drv_priv(vq);
+
+	(void) lep_send_cmd(lep, LEP_CMD_STOP, 2);
+	WRITE_ONCE(lep->streaming, false);
+	lep_return_bufs(lep, VB2_BUF_STATE_ERROR);
+}
+
+
+static const struct vb2_ops lep_vb2_ops = {
+	.queue_setup     = lep_queue_setup,
+	.buf_prepare     = lep_buf_prepare,
+	.buf_queue       = lep_buf_queue,
+	.start_streaming = lep_start_streaming,
+	.stop_streaming  = lep_stop_streaming,
+	.wait_prepare    = vb2_ops_wait_prepare,
+	.wait_finish     = vb2_ops_wait_finish,
+};
+
+
+
+/*
+ * V4L2 ioctls
+ */
+
+static int lep_querycap(struct file *file, void *priv, struct v4l2_capability *cap)
+{
+	strscpy(cap->driver, KBUILD_MODNAME, sizeof(cap->driver));
+	strscpy(cap->card, "FLIR Lepton (PRU)", sizeof(cap->card));
+	strscpy(cap->bus_info, "platform:pru-lepton", sizeof(cap->bus_info));
+	return 0;
+}
+
+
+static int lep_enum_fmt(struct file *file, void *priv, struct v4l2_fmtdesc *f)
+{
+	struct lep_dev *lep = video_drvdata(file);
+
+	if (f->index > 0)
+		return -EINVAL;
+	f->pixelformat = lep->pixfmt;
+	return 0;
+}
+
+
+/* There is only one format so get, set and try are all the same */
+static int lep_g_fmt(struct file *file, void *priv, struct v4l2_format *f)
+{
+	struct lep_dev *lep = video_drvdata(file);
+
+	f->fmt.pix.width = LEP_WIDTH;
+	f->fmt.pix.height = LEP_HEIGHT;
+	f->fmt.pix.pixelformat = lep->pixfmt;
+	f->fmt.pix.field = V4L2_FIELD_NONE;
+	f->fmt.pix.bytesperline = lep->bytesperline;
+	f->fmt.pix.sizeimage = lep->frame_len;
+	f->fmt.pix.colorspace = V4L2_COLORSPACE_RAW;
+	return 0;
+}
+
+
+static int lep_enum_framesizes(struct file *file, void *priv, struct v4l2_frmsizeenum *fs)
+{
+	struct lep_dev *lep = video_drvdata(file);
+
+	if ((fs->index > 0) || (fs->pixel_format != lep->pixfmt))
+		return -EINVAL;
+	fs->type = V4L2_FRMSIZE_TYPE_DISCRETE;
+	fs->discrete.width = LEP_WIDTH;
+	fs->discrete.height = LEP_HEIGHT;
+	return 0;
+}
+
+
+static int lep_g_parm(struct file *file, void *priv, struct v4l2_streamparm *parm)
+{
+	if (parm->type != V4L2_BUF_TYPE_VIDEO_CAPTURE)
+		return -EINVAL;
+	parm->parm.capture.capability = V4L2_CAP_TIMEPERFRAME;
+	parm->parm.capture.timeperframe.numerator = 1;
+	parm->parm.capture.timeperframe.denominator = LEP_FPS;
+	parm->parm.capture.readbuffers = 2;
+	return 0;
+}
+
+
+static int lep_enum_input(struct file *file, void *priv, struct v4l2_input *inp)
+{
+	if (inp->index > 0)
+		return -EINVAL;
+	inp->type = V4L2_INPUT_TYPE_CAMERA;
+	strscpy(inp->name, "Lepton", sizeof(inp->name));
+	return 0;
+}
+
+
+static int lep_g_input(struct file *file, void *priv, unsigned int *i)
+{
+	*i = 0;
+	return 0;
+}
+
+
+static int lep_s_input(struct file *file, void *priv, unsigned int i)
+{
+	return (i == 0) ? 0 : -EINVAL;
+}
+
+
+static const struct v4l2_ioctl_ops lep_ioctl_ops = {
+	.vidioc_querycap          = lep_querycap,
+	.vidioc_enum_fmt_vid_cap  = lep_enum_fmt,
+	.vidioc_g_fmt_vid_cap     = lep_g_fmt,
+	.vidioc_s_fmt_vid_cap     = lep_g_fmt,
+	.vidioc_try_fmt_vid_cap   = lep_g_fmt,
+	.vidioc_enum_framesizes   = lep_enum_framesizes,
+	.vidioc_g_parm            = lep_g_parm,
+	.vidioc_s_parm            = lep_g_parm,
+	.vidioc_enum_input        = lep_enum_input,
+	.vidioc_g_input           = lep_g_input,
+	.vidioc_s_input           = lep_s_input,
+	.vidioc_reqbufs           = vb2_ioctl_reqbufs,
+	.vidioc_create_bufs       = vb2_ioctl_create_bufs,
+	.vidioc_querybuf          = vb2_ioctl_querybuf,
+	.vidioc_qbuf              = vb2_ioctl_qbuf,
+	.vidioc_dqbuf             = vb2_ioctl_dqbuf,
+	.vidioc_expbuf            = vb2_ioctl_expbuf,
+	.vidioc_streamon          = vb2_ioctl_streamon,
+	.vidioc_streamoff         = vb2_ioctl_streamoff,
+};
+
+
+static const struct v4l2_file_operations lep_fops = {
+	.owner          = THIS_MODULE,
+	.open           = v4l2_fh_open,
+	.release        = vb2_fop_release,
+	.read           = vb2_fop_read,
+	.poll           = vb2_fop_poll,
+	.mmap           = vb2_fop_mmap,
+	.unlocked_ioctl = video_ioctl2,
+};
+
+
+
+/*
+ * Driver
+ */
+
+static int lep_probe(struct rpmsg_device *rpdev)
+{
+	struct lep_dev *lep;
+	struct vb2_queue *q;
+	int ret;
+
+	lep = devm_kzalloc(&rpdev->dev, sizeof(*lep), GFP_KERNEL);
+	if (!lep)
+		return -ENOMEM;
+	lep->rpdev = rpdev;
+	mutex_init(&lep->lock);
+	spin_lock_init(&lep->buf_lock);
+	INIT_LIST_HEAD(&lep->buf_list);
+	dev_set_drvdata(&rpdev->dev, lep);
+
+	if (pixel16) {
+		lep->pixfmt = V4L2_PIX_FMT_Y16_BE;
+		lep->bytesperline = LEP_WIDTH * 2;
+	} else {
+		lep->pixfmt = V4L2_PIX_FMT_GREY;
+		lep->bytesperline = LEP_WIDTH;
+	}
+	lep->frame_len = lep->bytesperline * LEP_HEIGHT;
+
+	ret = v4l2_device_register(&rpdev->dev, &lep->v4l2_dev);
+	if (ret)
+		return ret;
+
+	q = &lep->queue;
+	q->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	q->io_modes = VB2_MMAP | VB2_USERPTR | VB2_READ;
+	q->drv_priv = lep;
+	q->buf_struct_size = sizeof(struct lep_buf);
+	q->ops = &lep_vb2_ops;
+	q->mem_ops = &vb2_vmalloc_memops;
+	q->timestamp_flags = V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(6, 8, 0)
+	q->min_queued_buffers = 1;
+#else
+	q->min_buffers_needed = 1;
+#endif
+	q->lock = &lep->lock;
+	ret = vb2_queue_init(q);
+	if (ret)
+		goto err_v4l2;
+
+	strscpy(lep->vdev.name, "pru-lepton", sizeof(lep->vdev.name));
+	lep->vdev.v4l2_dev = &lep->v4l2_dev;
+	lep->vdev.fops = &lep_fops;
+	lep->vdev.ioctl_ops = &lep_ioctl_ops;
+	lep->vdev.release = video_device_release_empty;
+	lep->vdev.lock = &lep->lock;
+	lep->vdev.queue = q;
+	lep->vdev.device_caps = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING | V4L2_CAP_READWRITE;
+	video_set_drvdata(&lep->vdev, lep);
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(5, 7, 0)
+	ret = video_register_device(&lep->vdev, VFL_TYPE_VIDEO, -1);
+#else
+	ret = video_register_device(&lep->vdev, VFL_TYPE_GRABBER, -1);
+#endif
+	if (ret)
+		goto err_v4l2;
+
+	dev_info(&rpdev->dev, "%s: %dx%d %s\n", video_device_node_name(&lep->vdev),
+	         LEP_WIDTH, LEP_HEIGHT, pixel16 ? "Y16_BE" : "GREY");
+	return 0;
+
+err_v4l2:
+	v4l2_device_unregister(&lep->v4l2_dev);
+	return ret;
+}
+
+
+static void lep_remove(struct rpmsg_device *rpdev)
+{
+	struct lep_dev *lep = dev_get_drvdata(&rpdev->dev);
+
+	video_unregister_device(&lep->vdev);
+	v4l2_device_unregister(&lep->v4l2_dev);
+}
+
+
+static const struct rpmsg_device_id lep_id_table[] = {
+	{ .name = "lepton-v4l2" },
+	{ },
+};
+MODULE_DEVICE_TABLE(rpmsg, lep_id_table);
+
+static struct rpmsg_driver lep_driver = {
+	.drv.name = KBUILD_MODNAME,
+	.id_table = lep_id_table,
+	.probe    = lep_probe,
+	.callback = lep_rpmsg_cb,
+	.remove   = lep_remove,
+};
+module_rpmsg_driver(lep_driver);
+
+MODULE_DESCRIPTION("FLIR Lepton V4L2 capture through the AM335x PRUs");
+MODULE_LICENSE("GPL v2");
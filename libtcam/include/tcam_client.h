@@ -0,0 +1,238 @@
+/*
+ * tCam client library
+ *
+ * Allocation-free C client for the tCam-Mini command interface (port 5001) for
+ * gateways that collect images from many cameras.  Nothing is allocated: each
+ * connection receives into a ring supplied by the caller and responses are handed
+ * out as views of it, decoded straight from the ring into the caller's pixel arrays.
+ *
+ *   - The parser is incremental.  Data is received directly into the ring and each
+ *     call of tcam_parser_next() passes on the next complete response.  json
+ *     responses are framed by their delimiters (0x02 ... 0x03) and the search for
+ *     the end of one resumes where the last search stopped so each byte is only
+ *     examined once.  Binary responses (images, stream segments, recording and event
+ *     log data and raw packet batches) are framed by their headers.
+ *   - A response is held in the ring until the next call of tcam_parser_next().  It
+ *     may wrap around the end of the ring so it is described by two parts.
+ *   - Sockets are non-blocking.  tcam_conn_events() returns the events a connection
+ *     is waiting for (the same values as POLLIN/POLLOUT and EPOLLIN/EPOLLOUT) and
+ *     tcam_conn_service() is called with the events that occurred, so any number
+ *     of connections can be run from one epoll (level-triggered) or poll loop.
+ *   - json images are decoded by finding their radiometric (and telemetry) strings
+ *     and base64 decoding them straight into a uint16_t frame.  The decoder handles
+ *     16 characters at a time using GCC/Clang vector extensions (compiled to NEON on
+ *     ARM gateways and SSE on x86) with a table driven scalar decoder for the rest.
+ *   - Binary images are decoded from their header and metadata TLVs.  Raw, 8-bit
+ *     AGC, lossless compressed (rice and rice delta) and sparse images are decoded
+ *     into 16-bit pixels.  PNG and JPEG preview images are left to the caller.
+ *
+ * The ring must be a power of 2 long and hold the largest response (a json image is
+ * about 53 kB, TCAM_RING_LEN is enough for any response).  Multi-byte values in the
+ * binary protocol are little-endian.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef TCAM_CLIENT_H
+#define TCAM_CLIENT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Constants
+//
+
+// Command interface port
+#define TCAM_PORT              5001
+
+// Lepton 3.5 image
+#define TCAM_WIDTH             160
+#define TCAM_HEIGHT            120
+#define TCAM_PIXELS            (TCAM_WIDTH * TCAM_HEIGHT)
+#define TCAM_TELEM_WORDS       240
+
+// Suggested receive ring length
+#define TCAM_RING_LEN          (128 * 1024)
+
+// Command transmit buffer length
+#define TCAM_TX_LEN            512
+
+// Response types (the start byte of the binary responses)
+#define TCAM_RSP_JSON          0x00
+#define TCAM_RSP_BIN_IMAGE     0x01
+#define TCAM_RSP_REC_CHUNK     0x05
+#define TCAM_RSP_SEGMENT       0x07
+#define TCAM_RSP_PKT_BATCH     0x08
+#define TCAM_RSP_LOG_CHUNK     0x09
+
+// Binary response header lengths
+#define TCAM_BIN_HEADER_LEN    16
+#define TCAM_REC_HEADER_LEN    12
+#define TCAM_SEG_HEADER_LEN    18
+#define TCAM_PKT_HEADER_LEN    16
+
+// Binary image metadata TLVs
+#define TCAM_TLV_MIN_MAX       6
+#define TCAM_TLV_ENCODING      7
+#define TCAM_TLV_CAPTURE_USEC  10
+#define TCAM_TLV_TIME_SYNC     11
+#define TCAM_TLV_SEQ           12
+
+// Binary image encodings (TLV 7)
+#define TCAM_ENC_RAW           0
+#define TCAM_ENC_RICE          1
+#define TCAM_ENC_RICE_DELTA    2
+#define TCAM_ENC_PNG           3
+#define TCAM_ENC_JPEG          4
+#define TCAM_ENC_AGC8          5
+#define TCAM_ENC_SPARSE        6
+
+// tcam_parser_next() results
+#define TCAM_PARSE_NONE        0
+#define TCAM_PARSE_RSP         1
+#define TCAM_PARSE_ERR        -1
+
+// Connection states
+#define TCAM_CONN_CLOSED       0
+#define TCAM_CONN_CONNECTING   1
+#define TCAM_CONN_OPEN         2
+
+// Connection events (the same values as POLLIN/POLLOUT and EPOLLIN/EPOLLOUT)
+#define TCAM_EV_IN             0x001
+#define TCAM_EV_OUT            0x004
+#define TCAM_EV_ERR            0x008
+#define TCAM_EV_HUP            0x010
+
+
+
+//
+// Typedefs
+//
+
+// A response in the receive ring, p[0] followed by p[1] if it wraps (n[1] is 0 otherwise)
+typedef struct {
+	uint8_t type;              // TCAM_RSP_xxx
+	uint32_t len;              // Length (json responses without their delimiters)
+	const uint8_t* p[2];
+	uint32_t n[2];
+} tcam_rsp_t;
+
+// Incremental response parser over a caller-supplied ring.  head, tail and scan are
+// free-running byte counts.
+typedef struct {
+	uint8_t* buf;
+	uint32_t mask;             // Ring length - 1
+	uint32_t head;             // Bytes received
+	uint32_t tail;             // Start of the data not yet passed on
+	uint32_t scan;             // Where the search for the end of a json response resumes
+	uint32_t held;             // Length of the response last passed on (freed by the next call)
+} tcam_parser_t;
+
+// Binary image, decoded from its header and metadata TLVs
+typedef struct {
+	uint16_t width;
+	uint16_t height;
+	uint8_t encoding;          // TCAM_ENC_xxx
+	bool time_sync;            // capture_usec is the time of day
+	bool has_min_max;
+	bool has_seq;
+	uint16_t min;
+	uint16_t max;
+	uint32_t seq;
+	uint64_t capture_usec;
+	uint32_t meta_off;         // Offsets and lengths of the parts of the response
+	uint32_t meta_len;
+	uint32_t img_off;
+	uint32_t img_len;
+	uint32_t telem_off;
+	uint32_t telem_len;
+} tcam_bin_image_t;
+
+// Non-blocking connection to a camera
+typedef struct {
+	int fd;
+	int state;                 // TCAM_CONN_xxx
+	int err;                   // errno of the failure that closed the connection
+	tcam_parser_t rx;
+	uint8_t tx[TCAM_TX_LEN];
+	uint32_t tx_start;
+	uint32_t tx_end;
+	uint64_t rx_bytes;
+} tcam_conn_t;
+
+
+
+//
+// Parser API
+//
+void tcam_parser_init(tcam_parser_t* p, uint8_t* ring, uint32_t len);
+uint8_t* tcam_parser_space(const tcam_parser_t* p, uint32_t* len);
+void tcam_parser_commit(tcam_parser_t* p, uint32_t len);
+int tcam_parser_next(tcam_parser_t* p, tcam_rsp_t* rsp);
+
+//
+// Response API
+//
+uint8_t tcam_rsp_byte(const tcam_rsp_t* rsp, uint32_t off);
+uint32_t tcam_rsp_u16(const tcam_rsp_t* rsp, uint32_t off);
+uint32_t tcam_rsp_u32(const tcam_rsp_t* rsp, uint32_t off);
+uint32_t tcam_rsp_copy(const tcam_rsp_t* rsp, uint32_t off, void* dst, uint32_t len);
+int32_t tcam_rsp_find(const tcam_rsp_t* rsp, uint32_t off, const char* s, uint32_t s_len);
+
+//
+// json API
+//
+bool tcam_json_string(const tcam_rsp_t* rsp, const char* key, uint32_t* off, uint32_t* len);
+bool tcam_json_number(const tcam_rsp_t* rsp, const char* key, int64_t* val);
+int32_t tcam_json_b64(const tcam_rsp_t* rsp, const char* key, uint8_t* out, uint32_t max_len);
+bool tcam_json_image(const tcam_rsp_t* rsp, uint16_t* pixels, uint16_t* telem, bool* has_telem);
+
+//
+// Base64 API
+//
+int32_t tcam_b64_decode(const uint8_t* in, uint32_t len, uint8_t* out, uint32_t max_len);
+int32_t tcam_rsp_b64(const tcam_rsp_t* rsp, uint32_t off, uint32_t len, uint8_t* out, uint32_t max_len);
+
+//
+// Binary image API
+//
+bool tcam_bin_image(const tcam_rsp_t* rsp, tcam_bin_image_t* img);
+bool tcam_bin_pixels(const tcam_rsp_t* rsp, const tcam_bin_image_t* img, uint16_t* pixels, const uint16_t* ref);
+bool tcam_bin_telem(const tcam_rsp_t* rsp, const tcam_bin_image_t* img, uint16_t* telem);
+
+//
+// Connection API
+//
+bool tcam_conn_open(tcam_conn_t* c, const char* addr, uint16_t port, uint8_t* ring, uint32_t ring_len);
+void tcam_conn_close(tcam_conn_t* c);
+uint32_t tcam_conn_events(const tcam_conn_t* c);
+bool tcam_conn_service(tcam_conn_t* c, uint32_t events);
+bool tcam_conn_cmd(tcam_conn_t* c, const char* cmd, const char* args);
+int tcam_conn_next(tcam_conn_t* c, tcam_rsp_t* rsp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TCAM_CLIENT_H */
@@ -0,0 +1,681 @@
+/*
+ * tCam client library - response parser and connections
+ *
+ * Frames the responses in a receive ring (see tcam_client.h), gives access to the
+ * responses in place and runs non-blocking connections to cameras.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#define _GNU_SOURCE
+#include "tcam_client.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+
+//
+// Parser constants
+//
+
+// json delimiters
+#define JSON_START   0x02
+#define JSON_END     0x03
+
+// Longest json key tcam_json_string() and tcam_json_number() look for
+#define MAX_KEY_LEN  32
+
+
+
+//
+// Forward Declarations for internal functions
+//
+static uint8_t ring_byte(const tcam_parser_t* p, uint32_t pos);
+static uint32_t ring_u16(const tcam_parser_t* p, uint32_t pos);
+static uint32_t ring_u32(const tcam_parser_t* p, uint32_t pos);
+static bool ring_find_end(tcam_parser_t* p, uint32_t* pos);
+static void set_rsp(const tcam_parser_t* p, tcam_rsp_t* rsp, uint8_t type, uint32_t pos, uint32_t len);
+static const uint8_t* rsp_ptr(const tcam_rsp_t* rsp, uint32_t off, uint32_t* len);
+static int32_t find_value(const tcam_rsp_t* rsp, const char* key);
+static bool tx_put(tcam_conn_t* c, const char* s, uint32_t len);
+static bool conn_fail(tcam_conn_t* c, int err);
+
+
+
+//
+// Parser API
+//
+
+/**
+ * Start a parser receiving into ring, which must be a power of 2 long
+ */
+void tcam_parser_init(tcam_parser_t* p, uint8_t* ring, uint32_t len)
+{
+	p->buf = ring;
+	p->mask = len - 1;
+	p->head = 0;
+	p->tail = 0;
+	p->scan = 0;
+	p->held = 0;
+}
+
+
+/**
+ * Returns where the next data received should be written and sets len to the
+ * contiguous space there.  Space held by the response last passed on is only freed
+ * by the next call of tcam_parser_next().
+ */
+uint8_t* tcam_parser_space(const tcam_parser_t* p, uint32_t* len)
+{
+	uint32_t free_len = (p->mask + 1) - (p->head - p->tail);
+	uint32_t end_len = (p->mask + 1) - (p->head & p->mask);
+
+	*len = (free_len < end_len) ? free_len : end_len;
+	return &p->buf[p->head & p->mask];
+}
+
+
+/**
+ * Add len bytes written at tcam_parser_space() to the received data
+ */
+void tcam_parser_commit(tcam_parser_t* p, uint32_t len)
+{
+	p->head += len;
+}
+
+
+/**
+ * Pass on the next complete response, freeing the one last passed on.  Returns
+ * TCAM_PARSE_RSP with rsp describing it, TCAM_PARSE_NONE if more data is needed or
+ * TCAM_PARSE_ERR if the next response has a corrupt header or can't fit in the ring
+ * (it is skipped a byte at a time by the following calls until the parser finds the
+ * start of another one).
+ */
+int tcam_parser_next(tcam_parser_t* p, tcam_rsp_t* rsp)
+{
+	uint32_t avail, hdr_len, len, pos;
+	uint8_t type;
+
+	p->tail += p->held;
+	p->held = 0;
+
+	avail = p->head - p->tail;
+	if (avail == 0) return TCAM_PARSE_NONE;
+
+	type = ring_byte(p, p->tail);
+	switch (type) {
+		case TCAM_RSP_BIN_IMAGE:
+			// Header length + payload length
+			hdr_len = TCAM_BIN_HEADER_LEN;
+			if (avail < hdr_len) return TCAM_PARSE_NONE;
+			len = ring_u16(p, p->tail + 2) + ring_u32(p, p->tail + 4);
+			break;
+		case TCAM_RSP_REC_CHUNK:
+		case TCAM_RSP_LOG_CHUNK:
+			// Header length + data length
+			hdr_len = TCAM_REC_HEADER_LEN;
+			if (avail < hdr_len) return TCAM_PARSE_NONE;
+			len = ring_u16(p, p->tail + 2) + ring_u32(p, p->tail + 8);
+			break;
+		case TCAM_RSP_SEGMENT:
+			// Header length + pixels + binary image header length + telemetry length
+			hdr_len = TCAM_SEG_HEADER_LEN;
+			if (avail < hdr_len) return TCAM_PARSE_NONE;
+			len = ring_u16(p, p->tail + 2) + 2 * ring_u16(p, p->tail + 12) + ring_u16(p, p->tail + 14) +
+			      ring_u16(p, p->tail + 16);
+			break;
+		case TCAM_RSP_PKT_BATCH:
+			// Header length + number of packets * packet length
+			hdr_len = TCAM_PKT_HEADER_LEN;
+			if (avail < hdr_len) return TCAM_PARSE_NONE;
+			len = ring_u16(p, p->tail + 2) + ring_byte(p, p->tail + 9) * ring_u16(p, p->tail + 10);
+			break;
+		default:
+			// json, up to its end delimiter
+			if (!ring_find_end(p, &pos)) {
+				if (avail > p->mask) {
+					p->held = 1;
+					return TCAM_PARSE_ERR;
+				}
+				return TCAM_PARSE_NONE;
+			}
+			p->held = pos + 1 - p->tail;
+			if (type == JSON_START) {
+				set_rsp(p, rsp, TCAM_RSP_JSON, p->tail + 1, pos - p->tail - 1);
+			} else {
+				set_rsp(p, rsp, TCAM_RSP_JSON, p->tail, pos - p->tail);
+			}
+			return TCAM_PARSE_RSP;
+	}
+
+	// A corrupt header or a response that can't fit
+	if ((ring_u16(p, p->tail + 2) < hdr_len) || (len > (p->mask + 1))) {
+		p->held = 1;
+		return TCAM_PARSE_ERR;
+	}
+	if (avail < len) return TCAM_PARSE_NONE;
+	p->held = len;
+	set_rsp(p, rsp, type, p->tail, len);
+	return TCAM_PARSE_RSP;
+}
+
+
+
+//
+// Response API
+//
+
+/**
+ * Returns the byte at off in a response
+ */
+uint8_t tcam_rsp_byte(const tcam_rsp_t* rsp, uint32_t off)
+{
+	return (off < rsp->n[0]) ? rsp->p[0][off] : rsp->p[1][off - rsp->n[0]];
+}
+
+
+uint32_t tcam_rsp_u16(const tcam_rsp_t* rsp, uint32_t off)
+{
+	return tcam_rsp_byte(rsp, off) | (tcam_rsp_byte(rsp, off + 1) << 8);
+}
+
+
+uint32_t tcam_rsp_u32(const tcam_rsp_t* rsp, uint32_t off)
+{
+	return tcam_rsp_u16(rsp, off) | (tcam_rsp_u16(rsp, off + 2) << 16);
+}
+
+
+/**
+ * Copy up to len bytes starting at off in a response to dst.  Returns the number
+ * of bytes copied.
+ */
+uint32_t tcam_rsp_copy(const tcam_rsp_t* rsp, uint32_t off, void* dst, uint32_t len)
+{
+	const uint8_t* src;
+	uint8_t* d = (uint8_t*) dst;
+	uint32_t n;
+	uint32_t copied = 0;
+
+	while ((copied < len) && ((src = rsp_ptr(rsp, off, &n)) != NULL)) {
+		if (n > (len - copied)) n = len - copied;
+		memcpy(d + copied, src, n);
+		copied += n;
+		off += n;
+	}
+	return copied;
+}
+
+
+/**
+ * Returns the offset of the first s_len bytes of s at or after off in a response or
+ * -1.  s must be at most MAX_KEY_LEN + 4 bytes long to be found across the wrap.
+ */
+int32_t tcam_rsp_find(const tcam_rsp_t* rsp, uint32_t off, const char* s, uint32_t s_len)
+{
+	uint8_t join[2 * (MAX_KEY_LEN + 4)];
+	const uint8_t* f;
+	uint32_t i, start, end;
+
+	if (s_len == 0) return (off <= rsp->len) ? (int32_t) off : -1;
+
+	// First part
+	if (off < rsp->n[0]) {
+		f = memmem(rsp->p[0] + off, rsp->n[0] - off, s, s_len);
+		if (f != NULL) return (int32_t) (f - rsp->p[0]);
+
+		// Across the wrap: the last s_len - 1 bytes of the first part and the first
+		// s_len - 1 bytes of the second
+		if ((rsp->n[1] != 0) && (s_len > 1) && (s_len <= (MAX_KEY_LEN + 4))) {
+			start = (rsp->n[0] - off > s_len - 1) ? rsp->n[0] - (s_len - 1) : off;
+			end = (rsp->n[1] > s_len - 1) ? rsp->n[0] + (s_len - 1) : rsp->len;
+			for (i=start; i<end; i++) {
+				join[i - start] = tcam_rsp_byte(rsp, i);
+			}
+			f = memmem(join, end - start, s, s_len);
+			if (f != NULL) return (int32_t) (start + (f - join));
+		}
+		off = rsp->n[0];
+	}
+
+	// Second part
+	if ((off - rsp->n[0]) < rsp->n[1]) {
+		f = memmem(rsp->p[1] + (off - rsp->n[0]), rsp->n[1] - (off - rsp->n[0]), s, s_len);
+		if (f != NULL) return (int32_t) (rsp->n[0] + (f - rsp->p[1]));
+	}
+	return -1;
+}
+
+
+
+//
+// json API
+//
+
+/**
+ * Find the string item key in a json response and set off and len to its text
+ * (without the quotes).  Strings with escaped quotes aren't supported (the camera's
+ * base64 and name strings don't have any).
+ */
+bool tcam_json_string(const tcam_rsp_t* rsp, const char* key, uint32_t* off, uint32_t* len)
+{
+	int32_t start, end;
+
+	if ((start = find_value(rsp, key)) < 0) return false;
+	while (((uint32_t) start < rsp->len) && (tcam_rsp_byte(rsp, start) == ' ')) start++;
+	if (((uint32_t) start >= rsp->len) || (tcam_rsp_byte(rsp, start) != '"')) return false;
+	start++;
+	if ((end = tcam_rsp_find(rsp, start, "\"", 1)) < 0) return false;
+
+	*off = start;
+	*len = end - start;
+	return true;
+}
+
+
+/**
+ * Find the integer item key in a json response
+ */
+bool tcam_json_number(const tcam_rsp_t* rsp, const char* key, int64_t* val)
+{
+	int32_t pos;
+	uint8_t c;
+	bool neg = false;
+	bool digits = false;
+	int64_t v = 0;
+
+	if ((pos = find_value(rsp, key)) < 0) return false;
+	while (((uint32_t) pos < rsp->len) && (tcam_rsp_byte(rsp, pos) == ' ')) pos++;
+	if (((uint32_t) pos < rsp->len) && (tcam_rsp_byte(rsp, pos) == '-')) {
+		neg = true;
+		pos++;
+	}
+	while ((uint32_t) pos < rsp->len) {
+		c = tcam_rsp_byte(rsp, pos++);
+		if ((c < '0') || (c > '9')) break;
+		v = v * 10 + (c - '0');
+		digits = true;
+	}
+
+	*val = neg ? -v : v;
+	return digits;
+}
+
+
+/**
+ * Base64 decode the string item key in a json response into out.  Returns the
+ * decoded length or -1 if the item wasn't found, isn't valid base64 or doesn't fit.
+ */
+int32_t tcam_json_b64(const tcam_rsp_t* rsp, const char* key, uint8_t* out, uint32_t max_len)
+{
+	uint32_t off, len;
+
+	if (!tcam_json_string(rsp, key, &off, &len)) return -1;
+	return tcam_rsp_b64(rsp, off, len, out, max_len);
+}
+
+
+/**
+ * Decode the radiometric data of a json image into pixels (TCAM_PIXELS) and, if
+ * telem isn't NULL, its telemetry words (TCAM_TELEM_WORDS) into telem.  8-bit AGC
+ * images are expanded to 16-bit pixels.  has_telem (if not NULL) is set if the image
+ * had telemetry (telem is zeroed otherwise).  Returns false if the response isn't a
+ * complete json image.
+ */
+bool tcam_json_image(const tcam_rsp_t* rsp, uint16_t* pixels, uint16_t* telem, bool* has_telem)
+{
+	uint8_t* bytes = (uint8_t*) pixels;
+	int32_t i, len;
+
+	len = tcam_json_b64(rsp, "radiometric", bytes, TCAM_PIXELS * 2);
+	if (len == TCAM_PIXELS) {
+		// Expanded in place from the end
+		for (i=TCAM_PIXELS-1; i>=0; i--) {
+			pixels[i] = bytes[i];
+		}
+	} else if (len != TCAM_PIXELS * 2) {
+		return false;
+	}
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	else {
+		for (i=0; i<TCAM_PIXELS; i++) {
+			pixels[i] = __builtin_bswap16(pixels[i]);
+		}
+	}
+#endif
+
+	if (has_telem != NULL) *has_telem = false;
+	if (telem != NULL) {
+		if (tcam_json_b64(rsp, "telemetry", (uint8_t*) telem, TCAM_TELEM_WORDS * 2) == TCAM_TELEM_WORDS * 2) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			for (i=0; i<TCAM_TELEM_WORDS; i++) {
+				telem[i] = __builtin_bswap16(telem[i]);
+			}
+#endif
+			if (has_telem != NULL) *has_telem = true;
+		} else {
+			memset(telem, 0, TCAM_TELEM_WORDS * 2);
+		}
+	}
+	return true;
+}
+
+
+
+//
+// Connection API
+//
+
+/**
+ * Start a non-blocking connection to the camera at the IPv4 address addr receiving
+ * into ring (a power of 2 long).  Returns false if the connection couldn't be
+ * started (c->err holds errno).  Add c->fd to the caller's poll set and wait for
+ * tcam_conn_events().
+ */
+bool tcam_conn_open(tcam_conn_t* c, const char* addr, uint16_t port, uint8_t* ring, uint32_t ring_len)
+{
+	struct sockaddr_in sa;
+	int one = 1;
+
+	c->fd = -1;
+	c->state = TCAM_CONN_CLOSED;
+	c->err = 0;
+	c->tx_start = 0;
+	c->tx_end = 0;
+	c->rx_bytes = 0;
+	tcam_parser_init(&c->rx, ring, ring_len);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sin_family = AF_INET;
+	sa.sin_port = htons(port);
+	if (inet_pton(AF_INET, addr, &sa.sin_addr) != 1) {
+		c->err = EINVAL;
+		return false;
+	}
+
+	if ((c->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0) {
+		c->err = errno;
+		return false;
+	}
+	(void) setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	if (connect(c->fd, (struct sockaddr*) &sa, sizeof(sa)) == 0) {
+		c->state = TCAM_CONN_OPEN;
+	} else if (errno == EINPROGRESS) {
+		c->state = TCAM_CONN_CONNECTING;
+	} else {
+		return conn_fail(c, errno);
+	}
+	return true;
+}
+
+
+void tcam_conn_close(tcam_conn_t* c)
+{
+	if (c->fd >= 0) {
+		close(c->fd);
+		c->fd = -1;
+	}
+	c->state = TCAM_CONN_CLOSED;
+}
+
+
+/**
+ * Returns the events the connection is waiting for: TCAM_EV_OUT while it connects
+ * or has commands to send and TCAM_EV_IN while there is room to receive.  0 when it
+ * is closed.
+ */
+uint32_t tcam_conn_events(const tcam_conn_t* c)
+{
+	uint32_t events = 0;
+	uint32_t len;
+
+	switch (c->state) {
+		case TCAM_CONN_CONNECTING:
+			events = TCAM_EV_OUT;
+			break;
+		case TCAM_CONN_OPEN:
+			if (c->tx_end != c->tx_start) events |= TCAM_EV_OUT;
+			(void) tcam_parser_space(&c->rx, &len);
+			if (len != 0) events |= TCAM_EV_IN;
+			break;
+	}
+	return events;
+}
+
+
+/**
+ * Handle the events that occurred on the connection: finish connecting, send queued
+ * commands and receive until the socket is drained or the ring is full.  Returns
+ * false if the connection failed or the camera closed it (it is closed and c->err
+ * holds errno, 0 when the camera closed it).  Call tcam_conn_next() afterwards to
+ * get the responses.
+ */
+bool tcam_conn_service(tcam_conn_t* c, uint32_t events)
+{
+	uint8_t* bufP;
+	uint32_t len;
+	ssize_t n;
+	int err;
+	socklen_t err_len = sizeof(err);
+
+	if (c->state == TCAM_CONN_CLOSED) return false;
+
+	if (c->state == TCAM_CONN_CONNECTING) {
+		if ((events & (TCAM_EV_OUT | TCAM_EV_ERR | TCAM_EV_HUP)) == 0) return true;
+		if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &err_len) < 0) err = errno;
+		if (err != 0) return conn_fail(c, err);
+		c->state = TCAM_CONN_OPEN;
+	}
+
+	// Send
+	while (c->tx_end != c->tx_start) {
+		n = send(c->fd, &c->tx[c->tx_start], c->tx_end - c->tx_start, MSG_NOSIGNAL);
+		if (n < 0) {
+			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) break;
+			if (errno == EINTR) continue;
+			return conn_fail(c, errno);
+		}
+		c->tx_start += n;
+	}
+	if (c->tx_start == c->tx_end) {
+		c->tx_start = 0;
+		c->tx_end = 0;
+	}
+
+	// Receive
+	if (events & (TCAM_EV_IN | TCAM_EV_ERR | TCAM_EV_HUP)) {
+		for (;;) {
+			bufP = tcam_parser_space(&c->rx, &len);
+			if (len == 0) break;
+			n = recv(c->fd, bufP, len, 0);
+			if (n < 0) {
+				if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) break;
+				if (errno == EINTR) continue;
+				return conn_fail(c, errno);
+			}
+			if (n == 0) return conn_fail(c, 0);
+			tcam_parser_commit(&c->rx, n);
+			c->rx_bytes += n;
+			if ((uint32_t) n < len) break;
+		}
+	}
+	return true;
+}
+
+
+/**
+ * Queue the command {"cmd":cmd,"args":args} (without args if it is NULL) to be sent.
+ * args is the json text of the arguments object.  Returns false if it doesn't fit
+ * in the transmit buffer.
+ */
+bool tcam_conn_cmd(tcam_conn_t* c, const char* cmd, const char* args)
+{
+	char buf[TCAM_TX_LEN];
+	int len;
+
+	if (c->state == TCAM_CONN_CLOSED) return false;
+	if (args != NULL) {
+		len = snprintf(buf, sizeof(buf), "\x02{\"cmd\":\"%s\",\"args\":%s}\x03", cmd, args);
+	} else {
+		len = snprintf(buf, sizeof(buf), "\x02{\"cmd\":\"%s\"}\x03", cmd);
+	}
+	if ((len < 0) || (len >= (int) sizeof(buf))) return false;
+	return tx_put(c, buf, len);
+}
+
+
+/**
+ * Pass on the connection's next complete response (see tcam_parser_next())
+ */
+int tcam_conn_next(tcam_conn_t* c, tcam_rsp_t* rsp)
+{
+	return tcam_parser_next(&c->rx, rsp);
+}
+
+
+
+//
+// Internal functions
+//
+static uint8_t ring_byte(const tcam_parser_t* p, uint32_t pos)
+{
+	return p->buf[pos & p->mask];
+}
+
+
+static uint32_t ring_u16(const tcam_parser_t* p, uint32_t pos)
+{
+	return ring_byte(p, pos) | (ring_byte(p, pos + 1) << 8);
+}
+
+
+static uint32_t ring_u32(const tcam_parser_t* p, uint32_t pos)
+{
+	return ring_u16(p, pos) | (ring_u16(p, pos + 2) << 16);
+}
+
+
+/**
+ * Search for the end delimiter of the json response at tail, resuming where the last
+ * search stopped.  Sets pos to it if found.
+ */
+static bool ring_find_end(tcam_parser_t* p, uint32_t* pos)
+{
+	const uint8_t* f;
+	uint32_t start, len;
+
+	if ((int32_t) (p->scan - p->tail) < 0) p->scan = p->tail;
+	while (p->scan != p->head) {
+		// Contiguous data from scan
+		start = p->scan & p->mask;
+		len = p->head - p->scan;
+		if (len > (p->mask + 1) - start) len = (p->mask + 1) - start;
+
+		if ((f = memchr(&p->buf[start], JSON_END, len)) != NULL) {
+			*pos = p->scan + (f - &p->buf[start]);
+			p->scan = *pos + 1;
+			return true;
+		}
+		p->scan += len;
+	}
+	return false;
+}
+
+
+static void set_rsp(const tcam_parser_t* p, tcam_rsp_t* rsp, uint8_t type, uint32_t pos, uint32_t len)
+{
+	uint32_t start = pos & p->mask;
+	uint32_t end_len = (p->mask + 1) - start;
+
+	rsp->type = type;
+	rsp->len = len;
+	rsp->p[0] = &p->buf[start];
+	rsp->p[1] = p->buf;
+	if (len > end_len) {
+		rsp->n[0] = end_len;
+		rsp->n[1] = len - end_len;
+	} else {
+		rsp->n[0] = len;
+		rsp->n[1] = 0;
+	}
+}
+
+
+/**
+ * Returns the contiguous data at off in a response (and sets len to its length) or
+ * NULL at the end of the response
+ */
+static const uint8_t* rsp_ptr(const tcam_rsp_t* rsp, uint32_t off, uint32_t* len)
+{
+	if (off < rsp->n[0]) {
+		*len = rsp->n[0] - off;
+		return rsp->p[0] + off;
+	}
+	off -= rsp->n[0];
+	if (off < rsp->n[1]) {
+		*len = rsp->n[1] - off;
+		return rsp->p[1] + off;
+	}
+	return NULL;
+}
+
+
+/**
+ * Returns the offset of the value of the json item key (just past its ':') or -1
+ */
+static int32_t find_value(const tcam_rsp_t* rsp, const char* key)
+{
+	char pattern[MAX_KEY_LEN + 4];
+	int len;
+	int32_t pos;
+
+	len = snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+	if ((len < 0) || (len >= (int) sizeof(pattern))) return -1;
+	if ((pos = tcam_rsp_find(rsp, 0, pattern, len)) < 0) return -1;
+	return pos + len;
+}
+
+
+static bool tx_put(tcam_conn_t* c, const char* s, uint32_t len)
+{
+	if (c->tx_start != 0) {
+		memmove(c->tx, &c->tx[c->tx_start], c->tx_end - c->tx_start);
+		c->tx_end -= c->tx_start;
+		c->tx_start = 0;
+	}
+	if ((c->tx_end + len) > TCAM_TX_LEN) return false;
+	memcpy(&c->tx[c->tx_end], s, len);
+	c->tx_end += len;
+	return true;
+}
+
+
+static bool conn_fail(tcam_conn_t* c, int err)
+{
+	c->err = err;
+	tcam_conn_close(c);
+	return false;
+}
@@ -0,0 +1,533 @@
+/*
+ * tCam client library - image decoders
+ *
+ * Base64 decoder for json images and the binary image decoders.  Both decode straight
+ * from a response in the receive ring into the caller's arrays.
+ *
+ * The base64 decoder translates and packs 16 characters (12 bytes) at a time using
+ * GCC/Clang vector extensions, which the compiler turns into NEON on ARM and SSE on
+ * x86, so the same code is vectorized on any gateway.  A block with a character that
+ * isn't in the base64 alphabet, the last block (with any padding) and the last 16
+ * bytes of the output (each block stores 16 bytes) are decoded by the scalar table
+ * decoder.  Define TCAM_NO_SIMD to only use the scalar decoder.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "tcam_client.h"
+
+#include <string.h>
+
+
+//
+// Decoder constants
+//
+
+// Vector base64 decoder (little-endian hosts with vector extensions)
+#if !defined(TCAM_NO_SIMD) && defined(__GNUC__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define B64_SIMD
+#endif
+
+// Invalid base64 character in the decode table
+#define B64_BAD      0xFF
+
+// Rice coded image parameters (rice_codec.h in the firmware)
+#define RICE_BLOCK_LEN  32
+#define RICE_ESCAPE     16
+
+// Sparse image header and span header lengths (sparse_codec.h in the firmware)
+#define SPARSE_HEADER_LEN       4
+#define SPARSE_SPAN_HEADER_LEN  4
+
+
+
+//
+// Typedefs
+//
+
+#ifdef B64_SIMD
+typedef uint8_t v16u8 __attribute__((vector_size(16)));
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+#endif
+
+// Bit reader for a rice coded image in a response
+typedef struct {
+	const tcam_rsp_t* rsp;
+	uint32_t pos;
+	uint32_t end;
+	uint32_t acc;
+	int bits;
+} bit_reader_t;
+
+
+
+//
+// Variables
+//
+
+// Base64 character values (B64_BAD for characters not in the alphabet)
+static const uint8_t b64_table[256] = {
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x3E, 0xFF, 0xFF, 0xFF, 0x3F,
+	0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E,
+	0x0F, 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x30, 0x31, 0x32, 0x33, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+	0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+
+
+//
+// Forward Declarations for internal functions
+//
+static int32_t b64_quads(const uint8_t* in, uint32_t len, uint8_t* out, uint32_t max_len, bool last);
+static int32_t b64_quad(const uint8_t* in, uint8_t* out, uint32_t max_len, bool last);
+#ifdef B64_SIMD
+static bool b64_block16(const uint8_t* in, uint8_t* out);
+#endif
+static bool rice_decode(const tcam_rsp_t* rsp, const tcam_bin_image_t* img, uint16_t* pixels, const uint16_t* ref);
+static inline uint32_t get_bits(bit_reader_t* r, int n);
+static bool sparse_decode(const tcam_rsp_t* rsp, const tcam_bin_image_t* img, uint16_t* pixels);
+static void swap_words(uint16_t* p, uint32_t n);
+
+
+
+//
+// Base64 API
+//
+
+/**
+ * Decode len base64 characters (a multiple of 4) into out.  Returns the decoded
+ * length or -1 if the text isn't valid base64 or doesn't fit in max_len bytes.
+ */
+int32_t tcam_b64_decode(const uint8_t* in, uint32_t len, uint8_t* out, uint32_t max_len)
+{
+	if ((len & 3) != 0) return -1;
+	return b64_quads(in, len, out, max_len, true);
+}
+
+
+/**
+ * Decode the len base64 characters (a multiple of 4) at off in a response into out.
+ * The text may wrap around the end of the ring.  Returns the decoded length or -1.
+ */
+int32_t tcam_rsp_b64(const tcam_rsp_t* rsp, uint32_t off, uint32_t len, uint8_t* out, uint32_t max_len)
+{
+	uint8_t quad[4];
+	uint32_t n;
+	int32_t done = 0;
+	int32_t r;
+
+	if (((len & 3) != 0) || ((off + len) > rsp->len)) return -1;
+
+	// The whole quads before the wrap
+	n = 0;
+	if (off < rsp->n[0]) {
+		n = rsp->n[0] - off;
+		if (n > len) n = len;
+		n &= ~3;
+		if ((r = b64_quads(rsp->p[0] + off, n, out, max_len, n == len)) < 0) return -1;
+		done = r;
+		off += n;
+		len -= n;
+	}
+	if (len == 0) return done;
+
+	// The quad split by the wrap
+	if (off < rsp->n[0]) {
+		(void) tcam_rsp_copy(rsp, off, quad, 4);
+		if ((r = b64_quad(quad, out + done, max_len - done, len == 4)) < 0) return -1;
+		done += r;
+		off += 4;
+		len -= 4;
+	}
+
+	// The rest
+	if ((r = b64_quads(rsp->p[1] + (off - rsp->n[0]), len, out + done, max_len - done, true)) < 0) return -1;
+	return done + r;
+}
+
+
+
+//
+// Binary image API
+//
+
+/**
+ * Decode the header and metadata TLVs of a binary image response.  Returns false if
+ * its header is inconsistent.
+ */
+bool tcam_bin_image(const tcam_rsp_t* rsp, tcam_bin_image_t* img)
+{
+	uint32_t hdr_len, payload_len, pos, end;
+	uint8_t type, len;
+
+	if ((rsp->type != TCAM_RSP_BIN_IMAGE) || (rsp->len < TCAM_BIN_HEADER_LEN)) return false;
+
+	memset(img, 0, sizeof(tcam_bin_image_t));
+	hdr_len = tcam_rsp_u16(rsp, 2);
+	payload_len = tcam_rsp_u32(rsp, 4);
+	img->width = tcam_rsp_u16(rsp, 8);
+	img->height = tcam_rsp_u16(rsp, 10);
+	img->meta_len = tcam_rsp_u16(rsp, 12);
+	img->telem_len = tcam_rsp_u16(rsp, 14);
+	if ((img->meta_len + img->telem_len) > payload_len) return false;
+
+	img->meta_off = hdr_len;
+	img->img_off = hdr_len + img->meta_len;
+	img->img_len = payload_len - img->meta_len - img->telem_len;
+	img->telem_off = img->img_off + img->img_len;
+
+	// Metadata TLVs (type, length, value)
+	pos = img->meta_off;
+	end = img->meta_off + img->meta_len;
+	while ((pos + 2) <= end) {
+		type = tcam_rsp_byte(rsp, pos);
+		len = tcam_rsp_byte(rsp, pos + 1);
+		pos += 2;
+		if ((pos + len) > end) break;
+		switch (type) {
+			case TCAM_TLV_MIN_MAX:
+				if (len >= 4) {
+					img->min = tcam_rsp_u16(rsp, pos);
+					img->max = tcam_rsp_u16(rsp, pos + 2);
+					img->has_min_max = true;
+				}
+				break;
+			case TCAM_TLV_ENCODING:
+				if (len >= 1) img->encoding = tcam_rsp_byte(rsp, pos);
+				break;
+			case TCAM_TLV_CAPTURE_USEC:
+				if (len >= 8) {
+					img->capture_usec = tcam_rsp_u32(rsp, pos) | ((uint64_t) tcam_rsp_u32(rsp, pos + 4) << 32);
+				}
+				break;
+			case TCAM_TLV_TIME_SYNC:
+				if (len >= 1) img->time_sync = tcam_rsp_byte(rsp, pos) != 0;
+				break;
+			case TCAM_TLV_SEQ:
+				if (len >= 4) {
+					img->seq = tcam_rsp_u32(rsp, pos);
+					img->has_seq = true;
+				}
+				break;
+		}
+		pos += len;
+	}
+	return true;
+}
+
+
+/**
+ * Decode the pixels of a binary image into pixels (TCAM_PIXELS).  Delta images are
+ * decoded against ref, the previous image's pixels (which may be pixels itself).
+ * Pixels below a sparse image's threshold are 0.  Returns false for an image that is
+ * corrupt or too large, a PNG or JPEG preview or a delta image without ref.
+ */
+bool tcam_bin_pixels(const tcam_rsp_t* rsp, const tcam_bin_image_t* img, uint16_t* pixels, const uint16_t* ref)
+{
+	uint32_t num = img->width * img->height;
+	int32_t i;
+
+	if (num > TCAM_PIXELS) return false;
+
+	switch (img->encoding) {
+		case TCAM_ENC_RAW:
+			if (img->img_len != num * 2) return false;
+			(void) tcam_rsp_copy(rsp, img->img_off, pixels, num * 2);
+			swap_words(pixels, num);
+			return true;
+		case TCAM_ENC_AGC8:
+			// Expanded in place from the end
+			if (img->img_len != num) return false;
+			(void) tcam_rsp_copy(rsp, img->img_off, pixels, num);
+			for (i=num-1; i>=0; i--) {
+				pixels[i] = ((uint8_t*) pixels)[i];
+			}
+			return true;
+		case TCAM_ENC_RICE:
+			return rice_decode(rsp, img, pixels, NULL);
+		case TCAM_ENC_RICE_DELTA:
+			if (ref == NULL) return false;
+			return rice_decode(rsp, img, pixels, ref);
+		case TCAM_ENC_SPARSE:
+			return sparse_decode(rsp, img, pixels);
+	}
+	return false;
+}
+
+
+/**
+ * Copy the telemetry words (TCAM_TELEM_WORDS) of a binary image into telem.  Returns
+ * false if it has none.
+ */
+bool tcam_bin_telem(const tcam_rsp_t* rsp, const tcam_bin_image_t* img, uint16_t* telem)
+{
+	if (img->telem_len != TCAM_TELEM_WORDS * 2) return false;
+	(void) tcam_rsp_copy(rsp, img->telem_off, telem, TCAM_TELEM_WORDS * 2);
+	swap_words(telem, TCAM_TELEM_WORDS);
+	return true;
+}
+
+
+
+//
+// Internal functions
+//
+/**
+ * Decode len characters (a multiple of 4).  The last quad may be padded if last is
+ * set.
+ */
+static int32_t b64_quads(const uint8_t* in, uint32_t len, uint8_t* out, uint32_t max_len, bool last)
+{
+	uint32_t i = 0;
+	uint32_t done = 0;
+	int32_t r;
+
+#ifdef B64_SIMD
+	// 16 characters at a time while there is a block after this one and room to store
+	// 16 bytes
+	while (((i + 20) <= len) && ((done + 16) <= max_len)) {
+		if (!b64_block16(in + i, out + done)) break;
+		i += 16;
+		done += 12;
+	}
+#endif
+
+	for (; i<len; i+=4) {
+		if ((r = b64_quad(in + i, out + done, max_len - done, last && ((i + 4) == len))) < 0) return -1;
+		done += r;
+	}
+	return done;
+}
+
+
+static int32_t b64_quad(const uint8_t* in, uint8_t* out, uint32_t max_len, bool last)
+{
+	uint8_t a = b64_table[in[0]];
+	uint8_t b = b64_table[in[1]];
+	uint8_t c = b64_table[in[2]];
+	uint8_t d = b64_table[in[3]];
+	uint32_t n = 3;
+
+	if ((a | b) == B64_BAD) return -1;
+	if ((c | d) == B64_BAD) {
+		// Padding
+		if (!last || (in[3] != '=')) return -1;
+		if (in[2] == '=') {
+			n = 1;
+			c = 0;
+		} else if (c != B64_BAD) {
+			n = 2;
+		} else {
+			return -1;
+		}
+		d = 0;
+	}
+	if (n > max_len) return -1;
+
+	out[0] = (a << 2) | (b >> 4);
+	if (n > 1) out[1] = (b << 4) | (c >> 2);
+	if (n > 2) out[2] = (c << 6) | d;
+	return n;
+}
+
+
+#ifdef B64_SIMD
+/**
+ * Decode 16 characters into 12 bytes (16 bytes are stored).  Returns false if any
+ * character isn't in the base64 alphabet.
+ */
+static bool b64_block16(const uint8_t* in, uint8_t* out)
+{
+	v16u8 c, upper, lower, digit, plus, slash, v, valid;
+	v4u32 w;
+	uint64_t ok[2];
+#ifdef __clang__
+	v16u8 packed;
+#else
+	const v16u8 order = {2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, 3, 7, 11, 15};
+	v16u8 packed;
+#endif
+
+	memcpy(&c, in, 16);
+
+	// Translate each character to its 6-bit value
+	upper = (v16u8) ((c >= 'A') & (c <= 'Z'));
+	lower = (v16u8) ((c >= 'a') & (c <= 'z'));
+	digit = (v16u8) ((c >= '0') & (c <= '9'));
+	plus = (v16u8) (c == '+');
+	slash = (v16u8) (c == '/');
+	valid = upper | lower | digit | plus | slash;
+	memcpy(ok, &valid, 16);
+	if ((ok[0] & ok[1]) != UINT64_MAX) return false;
+	v = (upper & (c - 'A')) | (lower & (c - ('a' - 26))) | (digit & (c + (52 - '0'))) | (plus & 62) | (slash & 63);
+
+	// Pack each group of 4 values (a 32-bit lane, first character lowest) into 24 bits
+	// and store them most significant byte first
+	memcpy(&w, &v, 16);
+	w = ((w & 0x3F) << 18) | (((w >> 8) & 0x3F) << 12) | (((w >> 16) & 0x3F) << 6) | (w >> 24);
+	memcpy(&v, &w, 16);
+#ifdef __clang__
+	packed = __builtin_shufflevector(v, v, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, 3, 7, 11, 15);
+#else
+	packed = __builtin_shuffle(v, order);
+#endif
+	memcpy(out, &packed, 16);
+	return true;
+}
+#endif
+
+
+/**
+ * Decode a rice coded image (see rice_codec.h in the firmware)
+ */
+static bool rice_decode(const tcam_rsp_t* rsp, const tcam_bin_image_t* img, uint16_t* pixels, const uint16_t* ref)
+{
+	bit_reader_t r;
+	uint32_t idx, n, q, u, k;
+	uint32_t num = img->width * img->height;
+	int x = 0;
+	int y = 0;
+	int width = img->width;
+	uint16_t a, b, c, pred;
+	int16_t d;
+
+	r.rsp = rsp;
+	r.pos = img->img_off;
+	r.end = img->img_off + img->img_len;
+	r.acc = 0;
+	r.bits = 0;
+
+	idx = 0;
+	while (idx < num) {
+		k = get_bits(&r, 4);
+		n = (num - idx < RICE_BLOCK_LEN) ? num - idx : RICE_BLOCK_LEN;
+		while (n--) {
+			q = 0;
+			while ((q < RICE_ESCAPE) && get_bits(&r, 1)) q++;
+			if (q == RICE_ESCAPE) {
+				u = get_bits(&r, 16);
+			} else {
+				u = (k != 0) ? ((q << k) | get_bits(&r, k)) : q;
+			}
+			d = (int16_t) ((u >> 1) ^ -(u & 1));
+
+			if (ref != NULL) {
+				pred = ref[idx];
+			} else if (y == 0) {
+				pred = (x != 0) ? pixels[idx - 1] : 0;
+			} else if (x == 0) {
+				pred = pixels[idx - width];
+			} else {
+				a = pixels[idx - 1];
+				b = pixels[idx - width];
+				c = pixels[idx - width - 1];
+				if (c >= ((a > b) ? a : b)) {
+					pred = (a < b) ? a : b;
+				} else if (c <= ((a < b) ? a : b)) {
+					pred = (a > b) ? a : b;
+				} else {
+					pred = a + b - c;
+				}
+			}
+			pixels[idx++] = (uint16_t) (pred + d);
+			if (++x == width) {
+				x = 0;
+				y++;
+			}
+		}
+	}
+
+	// The bitstream must have held the image
+	return (r.pos - (r.bits / 8)) <= r.end;
+}
+
+
+/**
+ * Returns the next n (up to 16) bits, MSB first.  Past the end of the image the
+ * bits are 0.
+ */
+static inline uint32_t get_bits(bit_reader_t* r, int n)
+{
+	uint32_t v;
+
+	while (r->bits < n) {
+		r->acc = (r->acc << 8) | ((r->pos < r->end) ? tcam_rsp_byte(r->rsp, r->pos) : 0);
+		r->pos++;
+		r->bits += 8;
+	}
+	r->bits -= n;
+	v = (r->acc >> r->bits) & ((1 << n) - 1);
+	return v;
+}
+
+
+/**
+ * Decode a sparse image (see sparse_codec.h in the firmware)
+ */
+static bool sparse_decode(const tcam_rsp_t* rsp, const tcam_bin_image_t* img, uint16_t* pixels)
+{
+	uint32_t num = img->width * img->height;
+	uint32_t pos = img->img_off;
+	uint32_t end = img->img_off + img->img_len;
+	uint32_t spans, start, count;
+
+	if (img->img_len < SPARSE_HEADER_LEN) return false;
+	memset(pixels, 0, num * 2);
+	spans = tcam_rsp_u16(rsp, pos + 2);
+	pos += SPARSE_HEADER_LEN;
+	while (spans--) {
+		if ((pos + SPARSE_SPAN_HEADER_LEN) > end) return false;
+		start = tcam_rsp_u16(rsp, pos);
+		count = tcam_rsp_u16(rsp, pos + 2);
+		pos += SPARSE_SPAN_HEADER_LEN;
+		if (((start + count) > num) || ((pos + count * 2) > end)) return false;
+		(void) tcam_rsp_copy(rsp, pos, &pixels[start], count * 2);
+		swap_words(&pixels[start], count);
+		pos += count * 2;
+	}
+	return true;
+}
+
+
+/**
+ * Little-endian words to host order
+ */
+static void swap_words(uint16_t* p, uint32_t n)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	while (n--) {
+		*p = __builtin_bswap16(*p);
+		p++;
+	}
+#else
+	(void) p;
+	(void) n;
+#endif
+}
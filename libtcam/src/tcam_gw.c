@@ -0,0 +1,336 @@
+/*
+ * tCam gateway example
+ *
+ * Streams images from a number of cameras over one epoll loop using libtcam and
+ * prints each camera's image rate, data rate, decode errors and the range of its
+ * last image once a second.  Images are decoded into a frame per camera, which is
+ * also the reference image for delta images.  A connection that fails or is closed
+ * is reopened a second later.
+ *
+ * Usage: tcam_gw [options] <camera address> ...
+ *   -f <format>  Image format (set_image_format format, 0 - 2 or 5, default 0 json)
+ *   -T <value>   Threshold for sparse images (format 5)
+ *   -d <msec>    Delay between images (stream_on delay_msec, default 0)
+ *   -k <n>       Key image interval for delta images (stream_on key_interval)
+ *   -p <port>    Camera port (default 5001)
+ *   -t <secs>    Run time (default until interrupted)
+ *   -q           Only print the totals when done
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include "tcam_client.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+
+#define MAX_CAMERAS      16
+#define RECONNECT_MSEC   1000
+#define REPORT_MSEC      1000
+
+
+typedef struct {
+	const char* addr;
+	tcam_conn_t conn;
+	uint32_t events;              // Events registered with epoll
+	bool have_ref;                // frame holds the last image (the delta image reference)
+	uint64_t retry_msec;          // When to reopen a closed connection
+	unsigned long images;
+	unsigned long errors;
+	unsigned long total_images;
+	unsigned long total_errors;
+	uint64_t bytes;
+	uint64_t total_bytes;
+	uint16_t min, max;
+	uint16_t frame[TCAM_PIXELS];
+} camera_t;
+
+
+static camera_t cameras[MAX_CAMERAS];
+static uint8_t rings[MAX_CAMERAS][TCAM_RING_LEN];
+
+static int epfd;
+static int num_cameras;
+static uint16_t port = TCAM_PORT;
+static char format_args[64];
+static char stream_args[96];
+static volatile sig_atomic_t done = 0;
+
+
+static uint64_t now_msec()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+static void stop(int sig)
+{
+	(void) sig;
+	done = 1;
+}
+
+
+static void usage(const char* name)
+{
+	fprintf(stderr, "Usage: %s [-f format] [-T threshold] [-d delay_msec] [-k key_interval] [-p port] [-t secs] [-q] <camera address> ...\n", name);
+	exit(1);
+}
+
+
+/**
+ * Register the events the open connection waits for
+ */
+static void update_events(camera_t* cam, int n)
+{
+	struct epoll_event ev;
+	uint32_t events = tcam_conn_events(&cam->conn);
+
+	if (events == cam->events) return;
+	ev.events = events;
+	ev.data.u32 = n;
+	(void) epoll_ctl(epfd, (cam->events == 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, cam->conn.fd, &ev);
+	cam->events = events;
+}
+
+
+static void open_camera(camera_t* cam, int n)
+{
+	cam->events = 0;
+	cam->have_ref = false;
+	if (!tcam_conn_open(&cam->conn, cam->addr, port, rings[n], TCAM_RING_LEN)) {
+		fprintf(stderr, "%s: %s\n", cam->addr, strerror(cam->conn.err));
+		cam->retry_msec = now_msec() + RECONNECT_MSEC;
+		return;
+	}
+
+	// Queued until the connection is open
+	if (format_args[0] != 0) (void) tcam_conn_cmd(&cam->conn, "set_image_format", format_args);
+	(void) tcam_conn_cmd(&cam->conn, "stream_on", stream_args);
+	update_events(cam, n);
+}
+
+
+static void close_camera(camera_t* cam)
+{
+	if (cam->conn.err != 0) {
+		fprintf(stderr, "%s: %s\n", cam->addr, strerror(cam->conn.err));
+	} else {
+		fprintf(stderr, "%s: connection closed\n", cam->addr);
+	}
+	// The socket is already closed (which removed it from the epoll set)
+	cam->events = 0;
+	cam->retry_msec = now_msec() + RECONNECT_MSEC;
+}
+
+
+static void image_range(camera_t* cam)
+{
+	int i;
+
+	cam->min = 0xFFFF;
+	cam->max = 0;
+	for (i=0; i<TCAM_PIXELS; i++) {
+		if (cam->frame[i] < cam->min) cam->min = cam->frame[i];
+		if (cam->frame[i] > cam->max) cam->max = cam->frame[i];
+	}
+}
+
+
+static void handle_response(camera_t* cam, const tcam_rsp_t* rsp)
+{
+	tcam_bin_image_t img;
+	bool ok = false;
+
+	if (rsp->type == TCAM_RSP_JSON) {
+		// Only images have radiometric data
+		if (tcam_rsp_find(rsp, 0, "\"radiometric\":", 14) < 0) return;
+		ok = tcam_json_image(rsp, cam->frame, NULL, NULL);
+	} else if (rsp->type == TCAM_RSP_BIN_IMAGE) {
+		ok = tcam_bin_image(rsp, &img) &&
+		     tcam_bin_pixels(rsp, &img, cam->frame, cam->have_ref ? cam->frame : NULL);
+		if (ok) {
+			// Sparse images aren't a reference for delta images
+			if (img.encoding != TCAM_ENC_SPARSE) cam->have_ref = true;
+		} else if (img.encoding == TCAM_ENC_RICE_DELTA) {
+			// Lost the delta image reference, ask the camera for a key image
+			(void) tcam_conn_cmd(&cam->conn, "stream_resync", NULL);
+		}
+	} else {
+		return;
+	}
+
+	if (ok) {
+		cam->images++;
+		image_range(cam);
+	} else {
+		cam->errors++;
+	}
+}
+
+
+static void report(uint64_t msec, int quiet)
+{
+	camera_t* cam;
+	int n;
+
+	for (n=0; n<num_cameras; n++) {
+		cam = &cameras[n];
+		if (!quiet) {
+			printf("%-15s %5.1f fps %6.2f Mbps %lu errors range %u - %u\n", cam->addr,
+			       cam->images * 1000.0 / msec, cam->bytes * 8.0 / (msec * 1000.0),
+			       cam->errors, cam->min, cam->max);
+		}
+		cam->total_images += cam->images;
+		cam->total_errors += cam->errors;
+		cam->total_bytes += cam->bytes;
+		cam->images = 0;
+		cam->errors = 0;
+		cam->bytes = 0;
+	}
+	if (!quiet) fflush(stdout);
+}
+
+
+int main(int argc, char** argv)
+{
+	struct epoll_event events[MAX_CAMERAS];
+	camera_t* cam;
+	tcam_rsp_t rsp;
+	int c, i, n, rsp_status;
+	int format = 0;
+	int threshold = -1;
+	int delay_msec = 0;
+	int key_interval = -1;
+	int run_secs = 0;
+	int quiet = 0;
+	uint64_t start_msec, report_msec, t, rx_bytes;
+	bool ok;
+
+	while ((c = getopt(argc, argv, "f:T:d:k:p:t:q")) != -1) {
+		switch (c) {
+			case 'f':
+				format = atoi(optarg);
+				break;
+			case 'T':
+				threshold = atoi(optarg);
+				break;
+			case 'd':
+				delay_msec = atoi(optarg);
+				break;
+			case 'k':
+				key_interval = atoi(optarg);
+				break;
+			case 'p':
+				port = atoi(optarg);
+				break;
+			case 't':
+				run_secs = atoi(optarg);
+				break;
+			case 'q':
+				quiet = 1;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+	num_cameras = argc - optind;
+	if ((num_cameras < 1) || (num_cameras > MAX_CAMERAS)) usage(argv[0]);
+	if ((format == 5) && (threshold < 0)) {
+		fprintf(stderr, "Sparse images (format 5) need a threshold (-T)\n");
+		return 1;
+	}
+
+	if (format == 5) {
+		snprintf(format_args, sizeof(format_args), "{\"format\":5,\"threshold\":%d}", threshold);
+	} else if (format != 0) {
+		snprintf(format_args, sizeof(format_args), "{\"format\":%d}", format);
+	}
+	if (key_interval >= 0) {
+		snprintf(stream_args, sizeof(stream_args), "{\"delay_msec\":%d,\"num_frames\":0,\"key_interval\":%d}",
+		         delay_msec, key_interval);
+	} else {
+		snprintf(stream_args, sizeof(stream_args), "{\"delay_msec\":%d,\"num_frames\":0}", delay_msec);
+	}
+
+	if ((epfd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+		perror("epoll_create1");
+		return 1;
+	}
+	signal(SIGINT, stop);
+	signal(SIGTERM, stop);
+
+	for (i=0; i<num_cameras; i++) {
+		cameras[i].addr = argv[optind + i];
+		open_camera(&cameras[i], i);
+	}
+
+	start_msec = now_msec();
+	report_msec = start_msec;
+	while (!done) {
+		n = epoll_wait(epfd, events, MAX_CAMERAS, 100);
+		for (i=0; i<n; i++) {
+			cam = &cameras[events[i].data.u32];
+			rx_bytes = cam->conn.rx_bytes;
+			ok = tcam_conn_service(&cam->conn, events[i].events);
+			cam->bytes += cam->conn.rx_bytes - rx_bytes;
+			if (!ok) {
+				close_camera(cam);
+				continue;
+			}
+			while ((rsp_status = tcam_conn_next(&cam->conn, &rsp)) != TCAM_PARSE_NONE) {
+				if (rsp_status == TCAM_PARSE_RSP) {
+					handle_response(cam, &rsp);
+				} else {
+					cam->errors++;
+				}
+			}
+			update_events(cam, events[i].data.u32);
+		}
+
+		t = now_msec();
+		for (i=0; i<num_cameras; i++) {
+			if ((cameras[i].conn.state == TCAM_CONN_CLOSED) && (t >= cameras[i].retry_msec)) {
+				open_camera(&cameras[i], i);
+			}
+		}
+		if (t - report_msec >= REPORT_MSEC) {
+			report(t - report_msec, quiet);
+			report_msec = t;
+		}
+		if ((run_secs != 0) && ((t - start_msec) >= (uint64_t) run_secs * 1000)) break;
+	}
+
+	t = now_msec();
+	report(t - report_msec, 1);
+	for (i=0; i<num_cameras; i++) {
+		printf("%-15s images %lu errors %lu bytes %llu\n", cameras[i].addr, cameras[i].total_images,
+		       cameras[i].total_errors, (unsigned long long) cameras[i].total_bytes);
+		tcam_conn_close(&cameras[i].conn);
+	}
+	close(epfd);
+	return 0;
+}
@@ -1,5 +1,11 @@
 /*
  * Analog Input Module
+ *
+ * While awake the inputs are sampled in the background, round-robin, one
+ * conversion per 5 mSec TIMER0 tick.  The tick after a channel is selected
+ * starts its conversion (so every channel gets a full tick to acquire) and the
+ * ADC interrupt files the result into a per-channel filter and selects the next
+ * channel.  ADC_GetValue() returns the filtered value without waiting for the ADC.
  */
 #include "system.h"
 #include "system_config.h"
@@ -8,13 +14,33 @@
 
 
 
+// Filter: each channel's value is kept as an exponential moving average of its
+// samples scaled up by 2^ADC_FILT_SHIFT (about the last 8 samples, 160 mSec)
+#define ADC_FILT_SHIFT  3
+#define ADC_FILT_ROUND  (1 << (ADC_FILT_SHIFT-1))
+
+// Scheduler state
+#define ADC_SCHED_IDLE   0
+#define ADC_SCHED_SELECT 1
+#define ADC_SCHED_ACQ    2
+#define ADC_SCHED_CONV   3
+
+
 // Variables
 uint8_t ADC_A1ref;
 
+volatile uint8_t adcSchedState;
+volatile uint8_t adcSchedCh;
+volatile uint8_t adcSchedRef;        // AN1 reference its current sample was started with
+volatile uint8_t adcValidMask;       // Bit per channel with a filtered value
+volatile uint16_t adcFilt[ADC_NUM_CH];
+
 
 // Internal function forward references
 void ADC_SetRef(uint8_t r);
 
+void ADC_SelectChannel(uint8_t ch);
+
 
 void ADC_Initialize()
 {
@@ -41,48 +67,159 @@ void ADC_SetupWake()
 
     // Initialize variables
     ADC_A1ref = EEP_GetArefCfg() & ADC_AIN_REF_MASK;
+
+    // Start the background sampling with an empty cache
+    adcValidMask = 0;
+    adcSchedCh = ADC_CH_BATT;
+    adcSchedState = ADC_SCHED_SELECT;
+    PIR1bits.ADIF = 0;
+    PIE1bits.ADIE = 1;
+    INTCONbits.PEIE = 1;
 }
 
 
 void ADC_SetupSleep()
 {
+    // Stop the background sampling
+    PIE1bits.ADIE = 0;
+    adcSchedState = ADC_SCHED_IDLE;
+    FVRCONbits.TSEN = 0;
+
     // Disable the FVR and ADC
     FVRCONbits.FVREN = 0;
     ADCON0bits.ADON = 0;
 }
 
 
+// Direct conversion, waiting for the ADC.  Used before the background sampling
+// has a value (e.g. the battery check right after wake-up).
 uint16_t ADC_Read(uint8_t ch)
 {
-    switch (ch) {
-        case 0:     // Direct battery voltage
-            ADC_SetRef(ADC_REF_1);
-            ADCON0bits.CHS = BATT_CH;
-            break;
-        case 1:     // Channel 1
-            ADC_SetRef(ADC_A1ref);
-            ADCON0bits.CHS = AN1_CH;
-            break;
-        default:    // Indirect battery voltage - measure our FVR against VDD
-            ADC_SetRef(ADC_REF_VDD4FVR);  // VREF connected to VDD
-            ADCON0bits.CHS = 0x1F;        // FVR Input to ADC
-            break;
-    }
+    uint16_t v;
+    bool sched;
+
+    // Pause the background sampling (letting a conversion it started finish)
+    sched = (adcSchedState != ADC_SCHED_IDLE);
+    PIE1bits.ADIE = 0;
+    adcSchedState = ADC_SCHED_IDLE;
+    while (ADCON0bits.GO_nDONE);
+
+    ADC_SelectChannel(ch);
 
     // Short delay to allow the input capacitor to charge
     // 10 uSec @ 83.3 nSec/cycle = 120 cycles
-    _delay(120);
+    // The temperature indicator needs 200 uSec = 2400 cycles
+    if (ch == ADC_CH_TEMP) {
+        _delay(2400);
+    } else {
+        _delay(120);
+    }
 
     // Read the value
     ADCON0bits.GO = 1;
     while (ADCON0bits.GO_nDONE);     // Wait for conversion
-    return((ADRESH << 8) | ADRESL);
+    v = (ADRESH << 8) | ADRESL;
+
+    // Only power the temperature indicator while it is being read
+    FVRCONbits.TSEN = 0;
+
+    // Resume the background sampling, restarting the sample it was taking
+    if (sched) {
+        adcSchedState = ADC_SCHED_SELECT;
+        PIR1bits.ADIF = 0;
+        PIE1bits.ADIE = 1;
+    }
+    return(v);
+}
+
+
+// Filtered value of a channel from the background sampling
+uint16_t ADC_GetValue(uint8_t ch)
+{
+    uint16_t v;
+    bool valid;
+
+    if (ch > ADC_CH_FVR) {
+        ch = ADC_CH_FVR;
+    }
+
+    // Disable the ADC interrupt while reading the multi-byte value
+    PIE1bits.ADIE = 0;
+    valid = ((adcValidMask & (1 << ch)) != 0);
+    v = adcFilt[ch];
+    if (adcSchedState != ADC_SCHED_IDLE) {
+        PIE1bits.ADIE = 1;
+    }
+
+    if (!valid) {
+        // No sample yet
+        return(ADC_Read(ch));
+    }
+    return((v + ADC_FILT_ROUND) >> ADC_FILT_SHIFT);
+}
+
+
+// Called from the TIMER0 tick interrupt
+void ADC_ISR_Tick()
+{
+    switch (adcSchedState) {
+        case ADC_SCHED_SELECT:
+            ADC_SelectChannel(adcSchedCh);
+            adcSchedState = ADC_SCHED_ACQ;
+            break;
+        case ADC_SCHED_ACQ:
+            // The channel has acquired since the last tick
+            ADCON0bits.GO = 1;
+            adcSchedState = ADC_SCHED_CONV;
+            break;
+    }
+}
+
+
+// Called from the ADC conversion complete interrupt
+void ADC_ISR_Complete()
+{
+    uint16_t v;
+    uint8_t m;
+
+    PIR1bits.ADIF = 0;
+    FVRCONbits.TSEN = 0;
+    if (adcSchedState != ADC_SCHED_CONV) {
+        return;
+    }
+
+    v = (ADRESH << 8) | ADRESL;
+    m = 1 << adcSchedCh;
+    if ((adcSchedCh == ADC_CH_AN1) && (adcSchedRef != ADC_A1ref)) {
+        // AN1's reference was changed during the sample
+        adcValidMask &= ~m;
+    } else if ((adcValidMask & m) == 0) {
+        // First sample
+        adcFilt[adcSchedCh] = v << ADC_FILT_SHIFT;
+        adcValidMask |= m;
+    } else {
+        adcFilt[adcSchedCh] += v - (adcFilt[adcSchedCh] >> ADC_FILT_SHIFT);
+    }
+
+    // Start acquiring the next channel
+    if (++adcSchedCh == ADC_NUM_CH) {
+        adcSchedCh = 0;
+    }
+    ADC_SelectChannel(adcSchedCh);
+    adcSchedState = ADC_SCHED_ACQ;
 }
 
 
 void ADC_SetRefType(uint8_t r)
 {
     ADC_A1ref = r & 0x03;
+
+    // Restart AN1's filter with the new reference
+    PIE1bits.ADIE = 0;
+    adcValidMask &= ~(1 << ADC_CH_AN1);
+    if (adcSchedState != ADC_SCHED_IDLE) {
+        PIE1bits.ADIE = 1;
+    }
 }
 
 
@@ -93,6 +230,33 @@ uint8_t ADC_GetRefType() {
 
 
 // Internal Functions
+// Connect a channel to the ADC (starting its acquisition)
+void ADC_SelectChannel(uint8_t ch)
+{
+    switch (ch) {
+        case ADC_CH_BATT:   // Direct battery voltage
+            ADC_SetRef(ADC_REF_1);
+            ADCON0bits.CHS = BATT_CH;
+            break;
+        case ADC_CH_AN1:    // Channel 1
+            adcSchedRef = ADC_A1ref;
+            ADC_SetRef(ADC_A1ref);
+            ADCON0bits.CHS = AN1_CH;
+            break;
+        case ADC_CH_TEMP:   // Temperature indicator (low range) against VDD
+            ADC_SetRef(ADC_REF_VDD);
+            FVRCONbits.TSRNG = 0;
+            FVRCONbits.TSEN = 1;
+            ADCON0bits.CHS = 0x1D;
+            break;
+        default:    // Indirect battery voltage - measure our FVR against VDD
+            ADC_SetRef(ADC_REF_VDD4FVR);  // VREF connected to VDD
+            ADCON0bits.CHS = 0x1F;        // FVR Input to ADC
+            break;
+    }
+}
+
+
 void ADC_SetRef(uint8_t r)
 {
     uint8_t FVRCON_OrVal;
@@ -18,6 +18,13 @@
 // Default Reference configuration
 #define ADC_DEF_REF_1_CFG ADC_REF_VDD
 
+// Channels (sampled in the background in this order)
+#define ADC_CH_BATT     0
+#define ADC_CH_AN1      1
+#define ADC_CH_TEMP     2
+#define ADC_CH_FVR      3
+#define ADC_NUM_CH      4
+
 
 // API
 void ADC_Initialize();
@@ -28,6 +35,12 @@ void ADC_SetupSleep();
 
 uint16_t ADC_Read(uint8_t ch);
 
+uint16_t ADC_GetValue(uint8_t ch);
+
+void ADC_ISR_Tick();
+
+void ADC_ISR_Complete();
+
 void ADC_SetRefType(uint8_t r);
 
 uint8_t ADC_GetRefType();
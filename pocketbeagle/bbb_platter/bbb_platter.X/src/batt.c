@@ -70,7 +70,7 @@ void BATT_ReadBatteryInternal()
     // Take 4 readings and compute an average
     battIntAdcCount = 0;
     for (i=0; i<4; i++) {
-        battIntAdcCount += ADC_Read(3);   // Read Vref against our supply voltage
+        battIntAdcCount += ADC_Read(ADC_CH_FVR);   // Read Vref against our supply voltage
     }
     // Round then compute the average by shifting (since we read power-of-two)
     if ((battIntAdcCount & 0x0002) != 0) {
@@ -136,12 +136,12 @@ void BATT_Tasks()
     if (battAdcAvg == 0) {
         // First time after powering up, initialize our array all at once
         for (battAdcSamplePushIndex=0; battAdcSamplePushIndex<BATT_NUM_SMPLS; battAdcSamplePushIndex++) {
-            battAdcSamples[battAdcSamplePushIndex] = ADC_Read(0);
+            battAdcSamples[battAdcSamplePushIndex] = ADC_GetValue(ADC_CH_BATT);
         }
         battAdcSamplePushIndex = 0;
     } else {
         // Steady state - just add another reading to our average
-        battAdcSamples[battAdcSamplePushIndex] = ADC_Read(0);
+        battAdcSamples[battAdcSamplePushIndex] = ADC_GetValue(ADC_CH_BATT);
         if (++battAdcSamplePushIndex == BATT_NUM_SMPLS) {
             battAdcSamplePushIndex = 0;
         }
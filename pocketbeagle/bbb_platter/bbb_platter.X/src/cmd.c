@@ -26,6 +26,9 @@ bool CMD_IsValidDec(uint8_t c, uint8_t* v);
 void CMD_Execute(void);
 void CMD_ReturnDecVal(uint32_t v, bool includeIndex);
 void CMD_ReturnFloatVal(float f);
+uint8_t CMD_GetStatus(void);
+void CMD_LoadFloatVal(char* buf, float f);
+void CMD_LoadTelemetry(void);
 uint8_t CMD_Load8bitDecVal(char* buf, uint8_t v);
 //uint8_t CMD_GetHexChar(uint8_t v);
 void CMD_ReturnError(uint8_t e);
@@ -48,6 +51,9 @@ void CMD_ReturnError(uint8_t e);
 // Maximum warning buffer size
 #define CMD_WARN_BUF_LEN 9
 
+// Maximum telemetry buffer size ("TLM 99.99 255 1023<CR><LF>")
+#define CMD_TLM_BUF_LEN 24
+
 
 // Command USB variables
 uint8_t cmdUSBrxBuffer[CDC_DATA_IN_EP_SIZE];  // RX Data from USB to process
@@ -57,6 +63,8 @@ uint8_t cmdUSBtxBuffer[CDC_DATA_OUT_EP_SIZE];  // TX Data to send out via USB
 uint8_t cmdUSBtxBufIndex;  // Index to next available entry (also the count)
 uint8_t cmdUSBwtxBuffer[CMD_WARN_BUF_LEN];
 uint8_t cmdUSBwtxBufIndex; // Index to next available entry (also the count)
+uint8_t cmdUSBttxBuffer[CMD_TLM_BUF_LEN];
+uint8_t cmdUSBttxBufIndex; // Index to next available entry (also the count)
 
 
 // Command processing variables
@@ -67,6 +75,11 @@ bit cmdIsSet;         // =0 for query, =1 for set
 uint32_t cmdData;     // Data value for set
 
 
+// Telemetry variables
+uint8_t cmdTlmPeriod;   // Seconds between frames, 0 when disabled
+uint8_t cmdTlmCount;    // Seconds until the next frame
+
+
 
 // API Routines
 void CMD_Initialize(void)
@@ -76,7 +89,11 @@ void CMD_Initialize(void)
     cmdUSBrxBufNum = 0;
     cmdUSBtxBufIndex = 0;
     cmdUSBwtxBufIndex = 0;
+    cmdUSBttxBufIndex = 0;
     cmdState = CMD_ST_IDLE;
+
+    // A newly connected host has to subscribe again
+    cmdTlmPeriod = 0;
 }
 
 
@@ -106,6 +123,21 @@ void CMD_Tasks(void)
         cmdUSBwtxBufIndex = 0;
     }
 
+    // Load a telemetry frame when one is due.  A frame that couldn't be sent
+    // before the next one is replaced by it.
+    if ((cmdTlmPeriod != 0) && SYSTEM_SecTick()) {
+        if (--cmdTlmCount == 0) {
+            cmdTlmCount = cmdTlmPeriod;
+            CMD_LoadTelemetry();
+        }
+    }
+
+    // Attempt to send any telemetry frame if available
+    if ((cmdUSBttxBufIndex != 0) && (USBUSARTIsTxTrfReady())) {
+        putUSBUSART(&cmdUSBttxBuffer[0], cmdUSBttxBufIndex);
+        cmdUSBttxBufIndex = 0;
+    }
+
     CDCTxService();
 }
 
@@ -205,13 +237,11 @@ bool CMD_IsValidDec(uint8_t c, uint8_t* v)
 
 void CMD_Execute(void)
 {
-    uint8_t t;
-
     switch (cmdOp) {
         case 'A':
             if (cmdIsSet == 0) {
                 if (cmdIndex == 1) {
-                    CMD_ReturnDecVal(ADC_Read(cmdIndex), true);
+                    CMD_ReturnDecVal(ADC_GetValue(cmdIndex), true);
                 } else {
                     CMD_ReturnError(CMD_ERR_ILL_INDEX);
                 }
@@ -308,6 +338,15 @@ void CMD_Execute(void)
                 SYSTEM_SchedulePowerDown(cmdData);
             }
             break;
+        case 'P':
+            if (cmdIsSet == 0) {
+                CMD_ReturnDecVal(cmdTlmPeriod, false);
+            } else {
+                // First frame at the next second
+                cmdTlmPeriod = (cmdData > CMD_TLM_MAX_PERIOD) ? CMD_TLM_MAX_PERIOD : cmdData;
+                cmdTlmCount = 1;
+            }
+            break;
         case 'R':
             if (cmdIsSet == 0) {
                 CMD_ReturnDecVal(RTC_GetRepeatTime(), false);
@@ -317,26 +356,7 @@ void CMD_Execute(void)
             break;
         case 'S':
             if (cmdIsSet == 0) {
-                t = BATT_LowDetected() ? CMD_STATUS_LOW_BAT_MASK : 0;
-                t |= BATT_CriticalDetected() ? CMD_STATUS_CRIT_BATT_MASK : 0;
-                t |= UPS_UsbPowerEnabled() ? CMD_STATUS_USB_POWER_MASK : 0;
-                t |= CHGS_ChargeStatus() ? CMD_STATUS_BATT_CHARGE_MASK : 0;
-                switch (SYSTEM_GetPowerUpReason()) {
-                    case SYSTEM_PWRUP_BUTTON:
-                        t |= CMD_STATUS_PWRUP_BUTTON_MASK;
-                        break;
-                    case SYSTEM_PWRUP_RESTART:
-                        t |= CMD_STATUS_PWRUP_BATT_MASK;
-                        break;
-                    case SYSTEM_PWRUP_USB_PWR:
-                        t |= CMD_STATUS_PWRUP_USB_MASK;
-                        break;
-                    default:
-                        t |= CMD_STATUS_PWRUP_ALARM_MASK;
-                }
-                t |= USBPWR_FaultDetected() ? CMD_STATUS_USB_FAULT_MASK : 0;
-
-                CMD_ReturnDecVal(t, false);
+                CMD_ReturnDecVal(CMD_GetStatus(), false);
             } else {
                 CMD_ReturnError(CMD_ERR_NO_SET);
             }
@@ -417,7 +437,6 @@ void CMD_ReturnDecVal(uint32_t v, bool includeIndex)
 void CMD_ReturnFloatVal(float f)
 {
     uint8_t i;
-    uint32_t l, rem;
 
     // Clear the buffer so we can determine where the string ends
     for (i=0; i<CDC_DATA_OUT_EP_SIZE; i++) {
@@ -428,15 +447,7 @@ void CMD_ReturnFloatVal(float f)
     cmdUSBtxBuffer[0] = cmdOp;
     cmdUSBtxBuffer[1] = '=';
 
-    // Convert the floating point number into a string with the form N.NN
-    l = (uint32_t) f;
-    f -= (float) l;
-    rem = (uint32_t)round(f*1e2);
-    if (rem >= 100) {
-        l = l + 1;
-        rem = rem - 100;
-    }
-    sprintf(&cmdUSBtxBuffer[2], "%lu.%2.2lu",l, rem);
+    CMD_LoadFloatVal(&cmdUSBtxBuffer[2], f);
 
     // Determine how many characters are loaded
     for (i=0; i<CDC_DATA_OUT_EP_SIZE; i++) {
@@ -451,6 +462,69 @@ void CMD_ReturnFloatVal(float f)
 }
 
 
+uint8_t CMD_GetStatus(void)
+{
+    uint8_t t;
+
+    t = BATT_LowDetected() ? CMD_STATUS_LOW_BAT_MASK : 0;
+    t |= BATT_CriticalDetected() ? CMD_STATUS_CRIT_BATT_MASK : 0;
+    t |= UPS_UsbPowerEnabled() ? CMD_STATUS_USB_POWER_MASK : 0;
+    t |= CHGS_ChargeStatus() ? CMD_STATUS_BATT_CHARGE_MASK : 0;
+    switch (SYSTEM_GetPowerUpReason()) {
+        case SYSTEM_PWRUP_BUTTON:
+            t |= CMD_STATUS_PWRUP_BUTTON_MASK;
+            break;
+        case SYSTEM_PWRUP_RESTART:
+            t |= CMD_STATUS_PWRUP_BATT_MASK;
+            break;
+        case SYSTEM_PWRUP_USB_PWR:
+            t |= CMD_STATUS_PWRUP_USB_MASK;
+            break;
+        default:
+            t |= CMD_STATUS_PWRUP_ALARM_MASK;
+    }
+    t |= USBPWR_FaultDetected() ? CMD_STATUS_USB_FAULT_MASK : 0;
+
+    return t;
+}
+
+
+void CMD_LoadFloatVal(char* buf, float f)
+{
+    uint32_t l, rem;
+
+    // Convert the floating point number into a string with the form N.NN
+    l = (uint32_t) f;
+    f -= (float) l;
+    rem = (uint32_t)round(f*1e2);
+    if (rem >= 100) {
+        l = l + 1;
+        rem = rem - 100;
+    }
+    sprintf(buf, "%lu.%2.2lu",l, rem);
+}
+
+
+void CMD_LoadTelemetry(void)
+{
+    uint8_t i;
+
+    // Frame format: "TLM V.VV S T<CR><LF>"
+    cmdUSBttxBuffer[0] = 'T';
+    cmdUSBttxBuffer[1] = 'L';
+    cmdUSBttxBuffer[2] = 'M';
+    cmdUSBttxBuffer[3] = ' ';
+    CMD_LoadFloatVal(&cmdUSBttxBuffer[4], BATT_GetBattVoltage());
+    for (i=4; cmdUSBttxBuffer[i] != 0; i++) ;
+    sprintf(&cmdUSBttxBuffer[i], " %u %u", CMD_GetStatus(), ADC_GetValue(ADC_CH_TEMP));
+    for (; cmdUSBttxBuffer[i] != 0; i++) ;
+
+    cmdUSBttxBuffer[i++] = TERM_CHAR;
+    cmdUSBttxBuffer[i] = TERM_LF;
+    cmdUSBttxBufIndex = i+1;
+}
+
+
 uint8_t CMD_Load8bitDecVal(char* buf, uint8_t v)
 {
     sprintf(buf, "%1u", v);
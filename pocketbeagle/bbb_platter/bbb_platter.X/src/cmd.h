@@ -16,6 +16,14 @@
 #define CMD_WARN_USB_FAULT 2
 
 
+// Telemetry frames
+//   Enabled with "P=N" to send a frame every N seconds (1-255, 0 disables) until
+//   the host disconnects.  Format: "TLM V.VV S T<CR><LF>"
+//     V.VV - Battery voltage (as returned by "B")
+//     S    - STATUS byte (as returned by "S")
+//     T    - Temperature indicator ADC count (uncalibrated, measured against VDD)
+#define CMD_TLM_MAX_PERIOD 255
+
 // STATUS Byte Masks
 //   Bit 7: USB Fault Detected
 //   Bit 6: Reserved
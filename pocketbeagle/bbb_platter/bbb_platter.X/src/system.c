@@ -429,6 +429,12 @@ void interrupt SYS_InterruptHigh(void)
         TMR0 = TMR0_TO;
         INTCONbits.T0IF = 0;   // Clear the interrupt
         TMR0tick = 1;
+        ADC_ISR_Tick();
+    }
+
+    // ADC conversion complete - background sampling
+    if ((PIE1bits.ADIE == 1) && (PIR1bits.ADIF == 1)) {
+        ADC_ISR_Complete();
     }
 
     // TIMER1 - RTC - always running
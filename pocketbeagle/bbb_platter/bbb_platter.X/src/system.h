@@ -22,8 +22,8 @@
 // Firmware version (must be BCD encoded for use in the USB Descriptor)
 //   Major - Bits 15:8 - functionality changes
 //   Minor - Bits  7:0 - bug fixes
-#define FW_MAJOR 0x01
-#define FW_MAJOR_MASK  0x00000100
+#define FW_MAJOR 0x02
+#define FW_MAJOR_MASK  0x00000200
 #define FW_MINOR 0x00
 #define FW_MINOR_MASK  0x00000000
 
@@ -62,6 +62,7 @@ extern bit PowerRestartEnable;
 extern uint16_t sysWatchdogCount;
 extern volatile bit sysBoostEnabled;
 extern bit sysUsbEnabled;
+extern bit SecTick;
 
 
 
@@ -111,6 +112,7 @@ void SYSTEM_BoostDisable(void);
 #define SYSTEM_SetWatchdogTimeout(t) (sysWatchdogCount = t)
 #define SYSTEM_GetWatchdogTimeout() (sysWatchdogCount)
 #define SYSTEM_BoostEnabled() (sysBoostEnabled == 1)
+#define SYSTEM_SecTick() (SecTick == 1)
 
 
 #endif //SYSTEM_H
@@ -6,6 +6,14 @@
  *      restart on charge.
  *   2. A new pseudo-tty called /dev/bb-platter for applications to connect too
  *   3. An optional port for direct TCP connection by applications
+ *   4. Optional caching of battery voltage responses so frequent queries don't
+ *      each wake the Pi Platter
+ *   5. Optional periodic telemetry frames pushed by the Pi Platter and published
+ *      to clients of a separate TCP port
+ *
+ * All the ports are non-blocking and served from one epoll loop.  Data written to
+ * a port goes through its own output ring so a slow TCP client can't stall the
+ * serial port or the other clients.
  *
  * Parts of this code are thanks to Paul Davis' remserial code.
  *
@@ -38,6 +46,7 @@
 #include <syslog.h>
 #include <signal.h>
 #include <errno.h>
+#include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
 #include <sys/types.h>
@@ -49,31 +58,94 @@
 #include <libudev.h>
 #include <locale.h>
 #include <termios.h>
+#include <time.h>
 
 #define MAX_SER_NAME_CHARS  64
 
 #define VERSION_MAJOR       0
-#define VERSION_MINOR       1
+#define VERSION_MINOR       3
+
+// Bytes each port's output ring holds
+#define RING_SIZE           4096
+
+// Maximum events taken with one epoll_wait()
+#define MAX_EVENTS          8
+
+// Maximum cached command and response lengths
+#define MAX_CACHE_CMD_CHARS 4
+#define MAX_CACHE_RSP_CHARS 32
+
+// Maximum telemetry frame length ("TLM V.VV S T<CR><LF>")
+#define MAX_TLM_CHARS       32
+
+
+// A port: its file descriptor, output ring and state for the commands it sends
+typedef struct {
+	int fd;
+	int head;                       // Index of the next byte to write
+	int len;                        // Bytes waiting to be written
+	char buf[RING_SIZE];
+	int lineStart;                  // Next byte received starts a command line
+	int holdLen;                    // Bytes of a cacheable command held back
+	char hold[MAX_CACHE_CMD_CHARS];
+	int swallowLf;                  // Drop a LF ending a query answered from the cache
+	int subscriber;                 // Telemetry subscriber (only sent frames)
+} Port;
+
+// A cacheable query and the last response to it from the Pi Platter
+typedef struct {
+	const char* cmd;
+	char rsp[MAX_CACHE_RSP_CHARS];
+	int rspLen;                     // 0 until a response has been seen
+	long rspMsec;                   // When it was received
+} CacheEntry;
 
 
 char serName[MAX_SER_NAME_CHARS];
-int serialFd;
 struct sockaddr_in addr,remoteaddr;
 int sockfd = -1;
 int port = 0;
 int debug=0;
-int linkFd;
-int *remotefd;
+Port serialPort;
+Port linkPort;
+Port *remote;
 char *linkname = "/dev/bb-platter";
 int isdaemon = 0;
 int restartEnable = 0;
 int warnMsgIndex = 0;
 int sawWarnCritical = 0;
 int sawWarnLow = 0;
-fd_set fdsread,fdsreaduse;
+int epfd = -1;
 int curConnects = 0;
+int maxConnects = 1;
 int sendMask = 0x01;
 
+// Response caching (-c).  Queries for these commands are answered from the last
+// response if it is less than cacheMsec old.
+int cacheMsec = 0;
+CacheEntry cache[] = {
+	{"B"}         // Battery voltage
+};
+#define NUM_CACHE_ENTRIES (sizeof(cache) / sizeof(cache[0]))
+char serLine[MAX_CACHE_RSP_CHARS];
+int serLineLen = 0;
+
+// Telemetry (-t, -s).  The Pi Platter sends a "TLM ..." frame every tlmPeriod
+// seconds.  Frames are taken out of the data sent to the applications (so they
+// don't get mixed up with command responses) and published to the subscribers
+// connected to subPort instead.
+int tlmPeriod = 0;
+int subPort = 0;
+int subfd = -1;
+Port *subscriber;
+int curSubscribers = 0;
+const char tlmPrefix[] = "TLM ";
+int tlmIndex = 0;                   // Prefix characters matched, -1 within a line
+char tlmLine[MAX_TLM_CHARS];
+int tlmLen = 0;                     // Frame characters collected, 0 outside a frame
+char lastTlm[MAX_TLM_CHARS];
+int lastTlmLen = 0;
+
 extern char* ptsname(int fd);
 
 
@@ -225,12 +297,18 @@ void SigHandler(int sig)
 
 	if ( sockfd != -1 )
 		close(sockfd);
-	for (i=0 ; i<curConnects ; i++)
-		close(remotefd[i]);
-	if ( serialFd != -1)
-		close(serialFd);
-	if ( linkFd != -1 )
-		close(linkFd);
+	if ( subfd != -1 )
+		close(subfd);
+	for (i=0 ; i<maxConnects ; i++) {
+		if ( remote[i].fd != -1 )
+			close(remote[i].fd);
+		if ( subscriber[i].fd != -1 )
+			close(subscriber[i].fd);
+	}
+	if ( serialPort.fd != -1)
+		close(serialPort.fd);
+	if ( linkPort.fd != -1 )
+		close(linkPort.fd);
 	if (linkname)
 		unlink(linkname);
 	syslog(LOG_NOTICE, "Terminating on signal %d",sig);
@@ -241,11 +319,11 @@ void SigHandler(int sig)
 void LinkSlave(int fd)
 {
 	char *slavename;
-	int status = grantpt(linkFd);
+	int status = grantpt(fd);
 	if (status != -1)
-		status = unlockpt(linkFd);
+		status = unlockpt(fd);
 	if (status != -1) {
-		slavename = ptsname(linkFd);
+		slavename = ptsname(fd);
 		if (slavename) {
 			// Safety first
 			unlink(linkname);
@@ -266,14 +344,588 @@ void LinkSlave(int fd)
 }
 
 
+long GetMsec()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+
+// Start using fd for a port and add it to the epoll set
+void OpenPort(Port* p, int fd)
+{
+	struct epoll_event ev;
+
+	p->fd = fd;
+	p->head = 0;
+	p->len = 0;
+	p->lineStart = 1;
+	p->holdLen = 0;
+	p->swallowLf = 0;
+
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	ev.events = EPOLLIN;
+	ev.data.ptr = p;
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+		syslog(LOG_ERR, "Cannot add fd to epoll: %m");
+		exit(1);
+	}
+}
+
+
+void ClosePort(Port* p)
+{
+	// Closing the fd also removes it from the epoll set
+	if (p->fd != -1)
+		close(p->fd);
+	p->fd = -1;
+	p->len = 0;
+}
+
+
+// Only wait for a port to be writable while its ring has data
+void SetPortOutput(Port* p, int enable)
+{
+	struct epoll_event ev;
+
+	ev.events = EPOLLIN | (enable ? EPOLLOUT : 0);
+	ev.data.ptr = p;
+	(void) epoll_ctl(epfd, EPOLL_CTL_MOD, p->fd, &ev);
+}
+
+
+// Write as much of a port's ring as it will take.  Returns -1 if the port failed.
+int FlushPort(Port* p)
+{
+	int n, seg;
+
+	while (p->len > 0) {
+		seg = (p->head + p->len > RING_SIZE) ? RING_SIZE - p->head : p->len;
+		n = write(p->fd, p->buf + p->head, seg);
+		if (n == -1) {
+			if ((errno == EAGAIN) || (errno == EINTR))
+				return 0;
+			return -1;
+		}
+		p->head = (p->head + n) % RING_SIZE;
+		p->len -= n;
+	}
+	SetPortOutput(p, 0);
+	return 0;
+}
+
+
+// Send data to a port.  Data is written directly when the ring is empty and only
+// what the port won't take immediately is copied into the ring.  Returns -1 if the
+// port failed or its ring overflowed (the data that didn't fit is dropped).
+int QueuePort(Port* p, const char* data, int len)
+{
+	int n, tail, seg;
+
+	if ((p->fd == -1) || (len <= 0))
+		return 0;
+
+	if (p->len == 0) {
+		n = write(p->fd, data, len);
+		if (n == -1) {
+			if ((errno != EAGAIN) && (errno != EINTR))
+				return -1;
+			n = 0;
+		}
+		data += n;
+		len -= n;
+		if (len == 0)
+			return 0;
+		SetPortOutput(p, 1);
+	}
+
+	if (len > RING_SIZE - p->len) {
+		len = RING_SIZE - p->len;
+		n = -1;
+	} else {
+		n = 0;
+	}
+	while (len > 0) {
+		tail = (p->head + p->len) % RING_SIZE;
+		seg = (tail + len > RING_SIZE) ? RING_SIZE - tail : len;
+		memcpy(p->buf + tail, data, seg);
+		p->len += seg;
+		data += seg;
+		len -= seg;
+	}
+	return n;
+}
+
+
+void CloseRemote(Port* p)
+{
+	if (debug>0)
+		syslog(LOG_NOTICE,"%s closed", p->subscriber ? "Subscriber" : "Connection");
+	ClosePort(p);
+	if (p->subscriber)
+		curSubscribers--;
+	else
+		curConnects--;
+}
+
+
+// Send data from the Pi Platter to all connections in clients (remote or
+// subscriber).  Connections that can't keep up are dropped.
+void SendClients(Port* clients, const char* data, int len)
+{
+	int i;
+
+	for (i=0 ; i<maxConnects ; i++) {
+		if ( (clients[i].fd != -1) && (QueuePort(&clients[i], data, len) == -1) ) {
+			if (debug>0)
+				syslog(LOG_NOTICE,"Dropping slow or failed connection");
+			CloseRemote(&clients[i]);
+		}
+	}
+}
+
+
+// Returns the cache entry for a complete command or NULL
+CacheEntry* FindCacheEntry(const char* cmd, int cmdLen)
+{
+	int i;
+
+	for (i=0 ; i<NUM_CACHE_ENTRIES ; i++) {
+		if ( (strlen(cache[i].cmd) == cmdLen) && (strncmp(cache[i].cmd, cmd, cmdLen) == 0) )
+			return &cache[i];
+	}
+	return NULL;
+}
+
+
+// Returns 1 if the held command followed by c could still be a cacheable query
+int IsCachePrefix(const char* cmd, int cmdLen, char c)
+{
+	int i;
+
+	for (i=0 ; i<NUM_CACHE_ENTRIES ; i++) {
+		if ( (strlen(cache[i].cmd) > cmdLen) && (strncmp(cache[i].cmd, cmd, cmdLen) == 0) &&
+		     (cache[i].cmd[cmdLen] == c) )
+			return 1;
+	}
+	return 0;
+}
+
+
+// Looks for responses to cacheable queries ("<cmd>=<value>" lines) from the Pi Platter
+void CacheResponses(char* strP, int strLen)
+{
+	CacheEntry* e;
+	char c;
+	int i, n;
+
+	while (strLen--) {
+		c = *strP++;
+		if ((c == '\r') || (c == '\n')) {
+			for (i=0 ; i<NUM_CACHE_ENTRIES ; i++) {
+				e = &cache[i];
+				n = strlen(e->cmd);
+				if ( (serLineLen > n) && (strncmp(serLine, e->cmd, n) == 0) && (serLine[n] == '=') ) {
+					memcpy(e->rsp, serLine, serLineLen);
+					memcpy(e->rsp + serLineLen, "\r\n", 2);
+					e->rspLen = serLineLen + 2;
+					e->rspMsec = GetMsec();
+				}
+			}
+			serLineLen = 0;
+		} else if (serLineLen != -1) {
+			// Lines too long to be cached are ignored up to their end
+			if (serLineLen < MAX_CACHE_RSP_CHARS-2)
+				serLine[serLineLen++] = c;
+			else
+				serLineLen = -1;
+		}
+	}
+}
+
+
+// Ask the Pi Platter to start sending telemetry frames (it stops when it is
+// reconnected)
+void EnableTelemetry()
+{
+	char cmd[16];
+
+	if (tlmPeriod > 0) {
+		sprintf(cmd, "P=%d\r", tlmPeriod);
+		(void) QueuePort(&serialPort, cmd, strlen(cmd));
+	}
+}
+
+
+// Publish a complete telemetry frame and use its battery voltage to refresh the
+// cached "B" response
+void PublishTelemetry(const char* line, int len)
+{
+	CacheEntry* e;
+	int n;
+
+	memcpy(lastTlm, line, len);
+	lastTlmLen = len;
+	SendClients(subscriber, line, len);
+	if (debug>2)
+		syslog(LOG_INFO, "Telemetry %.*s", len-2, line);
+
+	e = FindCacheEntry("B", 1);
+	for (n=4 ; (n < len) && (line[n] != ' ') && (line[n] != '\r') ; n++) ;
+	if ( e && (n > 4) ) {
+		memcpy(e->rsp, "B=", 2);
+		memcpy(e->rsp + 2, line + 4, n - 4);
+		memcpy(e->rsp + 2 + n - 4, "\r\n", 2);
+		e->rspLen = n;
+		e->rspMsec = GetMsec();
+	}
+}
+
+
+// Take telemetry frames out of the data from the Pi Platter, copying the rest to
+// out (which must have room for len+3 bytes since a prefix held back from the
+// last read may turn out not to be a frame).  Returns the number of bytes in out.
+int FilterTelemetry(const char* in, int len, char* out)
+{
+	int n = 0;
+	char c;
+
+	while (len--) {
+		c = *in++;
+		if (tlmLen > 0) {
+			// Collect the frame up to its LF (overlong frames are truncated)
+			if (c == '\n') {
+				memcpy(tlmLine + tlmLen, "\r\n", 2);
+				PublishTelemetry(tlmLine, tlmLen + 2);
+				tlmLen = 0;
+				tlmIndex = 0;
+			} else if ( (c != '\r') && (tlmLen < MAX_TLM_CHARS-2) ) {
+				tlmLine[tlmLen++] = c;
+			}
+			continue;
+		}
+
+		if ( (tlmIndex >= 0) && (c == tlmPrefix[tlmIndex]) ) {
+			if (++tlmIndex == strlen(tlmPrefix)) {
+				memcpy(tlmLine, tlmPrefix, tlmIndex);
+				tlmLen = tlmIndex;
+			}
+			continue;
+		}
+
+		if (tlmIndex > 0) {
+			// Not a frame after all
+			memcpy(out + n, tlmPrefix, tlmIndex);
+			n += tlmIndex;
+		}
+		out[n++] = c;
+		tlmIndex = ((c == '\r') || (c == '\n')) ? 0 : -1;
+	}
+	return n;
+}
+
+
+// Send data from an application to the Pi Platter.  Cacheable queries (a line with
+// just the command) are held back until the end of their line and answered from the
+// cache when it is fresh enough.  Returns the number of bytes sent.
+int ForwardToSerial(Port* p, char* buf, int len)
+{
+	CacheEntry* e;
+	int start = 0;
+	int sent = 0;
+	int i;
+	char c;
+
+	if (cacheMsec == 0) {
+		(void) QueuePort(&serialPort, buf, len);
+		return len;
+	}
+
+	for (i=0 ; i<len ; i++) {
+		c = buf[i];
+		if ( p->swallowLf && (c == '\n') ) {
+			// The rest of the line ending of a query answered from the cache
+			p->swallowLf = 0;
+			start = i + 1;
+			continue;
+		}
+		p->swallowLf = 0;
+
+		if ((c == '\r') || (c == '\n')) {
+			if (p->holdLen > 0) {
+				e = FindCacheEntry(p->hold, p->holdLen);
+				if ( e && (e->rspLen > 0) && ((GetMsec() - e->rspMsec) < cacheMsec) ) {
+					(void) QueuePort(p, e->rsp, e->rspLen);
+					if (debug>1)
+						syslog(LOG_INFO,"Answered %s from the cache", e->cmd);
+					p->holdLen = 0;
+					p->lineStart = 1;
+					p->swallowLf = (c == '\r');
+					start = i + 1;
+					continue;
+				}
+				(void) QueuePort(&serialPort, p->hold, p->holdLen);
+				sent += p->holdLen;
+				p->holdLen = 0;
+			}
+			p->lineStart = 1;
+		} else if ( (p->lineStart || (p->holdLen > 0)) && (p->holdLen < MAX_CACHE_CMD_CHARS) &&
+		            IsCachePrefix(p->hold, p->holdLen, c) ) {
+			(void) QueuePort(&serialPort, buf + start, i - start);
+			sent += i - start;
+			p->hold[p->holdLen++] = c;
+			p->lineStart = 0;
+			start = i + 1;
+		} else {
+			if (p->holdLen > 0) {
+				// Not a cacheable query after all
+				(void) QueuePort(&serialPort, p->hold, p->holdLen);
+				sent += p->holdLen;
+				p->holdLen = 0;
+			}
+			p->lineStart = 0;
+		}
+	}
+
+	(void) QueuePort(&serialPort, buf + start, len - start);
+	return sent + len - start;
+}
+
+
+// Data to read from the pi platter.  Returns -1 if the serial port can't be reopened.
+int HandleSerial()
+{
+	char rawbuf[512];
+	char devbuf[516];
+	int devbytes;
+	int fd;
+
+	devbytes = read(serialPort.fd,rawbuf,512);
+	if ( (devbytes == -1) && ((errno == EAGAIN) || (errno == EINTR)) )
+		return 0;
+	if (debug>1)
+		syslog(LOG_INFO,"Pi Platter: %d bytes",devbytes);
+	if ( devbytes <= 0 ) {
+		if ( debug>0 )
+			syslog(LOG_INFO,"%s closed",serName);
+		ClosePort(&serialPort);
+		while (1) {
+			fd = OpenSerialPort(serName);
+			if ( fd != -1 )
+				break;
+			syslog(LOG_ERR, "Open of %s failed: %m", serName);
+			if ( errno != EIO )
+				return -1;
+			sleep(1);
+		}
+		if ( debug>0 )
+			syslog(LOG_INFO,"%s re-opened",serName);
+		OpenPort(&serialPort, fd);
+		EnableTelemetry();
+		return 0;
+	}
+
+	devbytes = FilterTelemetry(rawbuf, devbytes, devbuf);
+	if (sendMask & 0x01)
+		(void) QueuePort(&linkPort, devbuf, devbytes);
+	if (sendMask & 0x02)
+		SendClients(remote, devbuf, devbytes);
+	if (cacheMsec != 0)
+		CacheResponses(devbuf, devbytes);
+	if (ProcessResponse(devbuf, devbytes)) {
+		if (sawWarnCritical) {
+			if (restartEnable) {
+				(void) QueuePort(&serialPort, "C7=1\r", 5);
+			}
+			syslog(LOG_CRIT, "Battery Critical");
+			system("sudo shutdown now");
+		}
+		if (sawWarnLow) {
+			syslog(LOG_WARNING, "Battery Low");
+		}
+	}
+	if ( debug>2 ) {
+		devbuf[devbytes] = 0;
+		syslog(LOG_INFO, "Pi Platter sent %s", devbuf);
+	}
+	return 0;
+}
+
+
+// Data to read from the linked device file.  Returns -1 if it can't be reopened.
+int HandleLink()
+{
+	char devbuf[513];
+	int devbytes;
+	int fd;
+
+	devbytes = read(linkPort.fd,devbuf,512);
+	if ( (devbytes == -1) && ((errno == EAGAIN) || (errno == EINTR)) )
+		return 0;
+	if (debug>1)
+		syslog(LOG_INFO,"%s: %d bytes", linkname, devbytes);
+	if ( devbytes <= 0 ) {
+		if ( debug>0 )
+			syslog(LOG_INFO,"%s closed",linkname);
+		ClosePort(&linkPort);
+		while (1) {
+			fd = open("/dev/ptmx", O_RDWR);
+			if ( fd != -1 )
+				break;
+			syslog(LOG_ERR, "Open of /dev/ptmx failed: %m");
+			if ( errno != EIO )
+				return -1;
+			sleep(1);
+		}
+		if ( debug>0 )
+			syslog(LOG_INFO,"/dev/ptmx re-opened");
+		LinkSlave(fd);
+		OpenPort(&linkPort, fd);
+	}
+	else if ( serialPort.fd != -1 ) {
+		/* Write the data to the pi platter */
+		if (ForwardToSerial(&linkPort, devbuf, devbytes) > 0)
+			sendMask = 0x01;
+		if ( debug>2 ) {
+			devbuf[devbytes] = 0;
+			syslog(LOG_INFO, "%s sent %s", linkname, devbuf);
+		}
+	}
+	return 0;
+}
+
+
+/* Data to read from a remote system */
+void HandleRemote(Port* p)
+{
+	char devbuf[513];
+	int devbytes;
+
+	devbytes = read(p->fd,devbuf,512);
+	if ( (devbytes == -1) && ((errno == EAGAIN) || (errno == EINTR)) )
+		return;
+
+	if (debug>1)
+		syslog(LOG_INFO,"Remote: %d bytes",devbytes);
+
+	if ( devbytes <= 0 ) {
+		CloseRemote(p);
+	}
+	else if ( p->subscriber ) {
+		/* Subscribers only receive telemetry, anything they send is ignored */
+	}
+	else if ( serialPort.fd != -1 ) {
+		/* Write the data to the pi platter */
+		if (ForwardToSerial(p, devbuf, devbytes) > 0)
+			sendMask = 0x02;
+		if ( debug>2 ) {
+			devbuf[devbytes] = 0;
+			syslog(LOG_INFO, "Remote sent %s", devbuf);
+		}
+	}
+}
+
+
+/* Accept a remote system's attachment to listening socket lfd as one of clients
+   (the remote connections or the telemetry subscribers) */
+void AcceptRemote(int lfd, Port* clients)
+{
+	socklen_t remoteaddrlen;
+	unsigned long ip;
+	int fd, i;
+
+	remoteaddrlen = sizeof(struct sockaddr_in);
+	fd = accept(lfd,(struct sockaddr*)(&remoteaddr),
+		&remoteaddrlen);
+
+	if ( fd == -1 ) {
+		if ( (errno != EAGAIN) && (errno != EINTR) )
+			syslog(LOG_ERR,"accept failed: %m");
+		return;
+	}
+
+	for (i=0 ; i<maxConnects ; i++)
+		if (clients[i].fd == -1)
+			break;
+	if (i < maxConnects) {
+		OpenPort(&clients[i], fd);
+		if (clients[i].subscriber) {
+			/* A new subscriber starts with the latest frame */
+			curSubscribers++;
+			(void) QueuePort(&clients[i], lastTlm, lastTlmLen);
+		}
+		else
+			curConnects++;
+		ip = ntohl(remoteaddr.sin_addr.s_addr);
+		if (debug>0)
+			syslog(LOG_NOTICE, "Connection from %d.%d.%d.%d",
+				(int)(ip>>24)&0xff,
+				(int)(ip>>16)&0xff,
+				(int)(ip>>8)&0xff,
+				(int)(ip>>0)&0xff);
+	}
+	else {
+		// Too many connections, just close it to reject
+		close(fd);
+	}
+}
+
+
+// Open a TCP socket listening on netport.  Exits if it can't.
+int OpenListenSocket(int netport)
+{
+	int fd;
+
+	/* Open the socket for communications */
+	fd = socket(AF_INET, SOCK_STREAM, 6);
+	if ( fd == -1 ) {
+		syslog(LOG_ERR, "Can't open socket: %m");
+		exit(1);
+	}
+
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = 0;
+	addr.sin_port = htons(netport);
+
+	/* Set up to listen on the given port */
+	if( bind( fd, (struct sockaddr*)(&addr),
+		sizeof(struct sockaddr_in)) < 0 ) {
+		syslog(LOG_ERR, "Couldn't bind port %d, aborting: %m",netport );
+		exit(1);
+	}
+	if ( debug>1 )
+		syslog(LOG_NOTICE,"Bound port %d", netport);
+
+	/* Tell the system we want to listen on this socket */
+	if ( listen(fd, 4) == -1 ) {
+		syslog(LOG_ERR, "Socket listen failed: %m");
+		exit(1);
+	}
+
+	if ( debug>1 )
+		syslog(LOG_NOTICE,"Done listen");
+
+	return fd;
+}
+
+
 void Usage(char *progname) {
 	printf("bpd version %0d.%0d.  Usage:\n", VERSION_MAJOR, VERSION_MINOR);
-	printf("bpd [-d] [-p netport] [-m maxconnect] [-x debuglevel] [-h]\n\n");
+	printf("bpd [-d] [-p netport] [-m maxconnect] [-c cachemsec] [-t telemetrysec] [-s subport]\n");
+	printf("    [-x debuglevel] [-h]\n\n");
 
 	printf("-d			Run as a daemon program\n");
 	printf("-p netport		Enable socket connection on IP port#\n");
 	printf("-m max-connections	Maximum number of simultaneous client connections to allow\n");
 	printf("			 (only applies if -p is also specified)\n");
+	printf("-c cache-msec		Answer battery voltage (B) queries from the last response\n");
+	printf("			 if it is less than cache-msec old (default 0, disabled)\n");
+	printf("-t telemetry-sec		Have the Pi Platter send a telemetry frame every telemetry-sec\n");
+	printf("			 seconds (1-255, default 0, disabled)\n");
+	printf("-s subport		Publish telemetry frames to connections on IP port#\n");
+	printf("			 (up to max-connections of them)\n");
 	printf("-r                      Enable auto-restart after critical battery shutdown\n");
 	printf("-x debuglevel		Set debug level, 0 is default, 1-3 give more info\n");
 	printf("-h                      Usage\n");
@@ -282,22 +934,24 @@ void Usage(char *progname) {
 
 int main(int argc, char *argv[])
 {
-	int result;
+	struct epoll_event events[MAX_EVENTS];
+	Port listenPort;
+	Port subListenPort;
+	Port *p;
 	extern char *optarg;
 	extern int optind;
-	int maxfd = -1;
-	char devbuf[512];
-	int devbytes;
-	int remoteaddrlen;
 	int c;
-	int maxConnects = 1;
-	register int i;
+	int fd;
+	int i, n;
 
-	while ( (c=getopt(argc,argv,"dm:p:rx:h")) != EOF )
+	while ( (c=getopt(argc,argv,"dc:m:p:rs:t:x:h")) != EOF )
 		switch (c) {
 		case 'd':
 			isdaemon = 1;
 			break;
+		case 'c':
+			cacheMsec = atoi(optarg);
+			break;
 		case 'm':
 			maxConnects = atoi(optarg);
 			break;
@@ -307,6 +961,12 @@ int main(int argc, char *argv[])
 		case 'r':
 			restartEnable = 1;
 			break;
+		case 's':
+			subPort = atoi(optarg);
+			break;
+		case 't':
+			tlmPeriod = atoi(optarg);
+			break;
 		case 'x':
 			debug = atoi(optarg);
 			break;
@@ -316,10 +976,31 @@ int main(int argc, char *argv[])
 			exit(1);
 		}
 
-	remotefd = (int *) malloc (maxConnects * sizeof(int));
+	if (maxConnects < 1)
+		maxConnects = 1;
+	if (tlmPeriod > 255)
+		tlmPeriod = 255;
+	remote = (Port *) malloc (maxConnects * sizeof(Port));
+	subscriber = (Port *) malloc (maxConnects * sizeof(Port));
+	for (i=0 ; i<maxConnects ; i++) {
+		remote[i].fd = -1;
+		remote[i].subscriber = 0;
+		subscriber[i].fd = -1;
+		subscriber[i].subscriber = 1;
+	}
+	serialPort.fd = -1;
+	serialPort.subscriber = 0;
+	linkPort.fd = -1;
+	linkPort.subscriber = 0;
 
 	openlog("bpd", LOG_PID, LOG_USER);
 
+	epfd = epoll_create1(0);
+	if (epfd == -1) {
+		syslog(LOG_ERR, "Can't create epoll: %m");
+		exit(1);
+	}
+
 	// Try to find the pi platter
 	memset(serName, '\0', sizeof(serName));
 	if (FindPiPlatter(serName) == -1) {
@@ -327,55 +1008,36 @@ int main(int argc, char *argv[])
 	}
 
 	// Try to open the serial port
-	if ((serialFd = OpenSerialPort(serName)) == -1) {
+	if ((fd = OpenSerialPort(serName)) == -1) {
 		exit(1);
 	}
+	OpenPort(&serialPort, fd);
 
 	// Initialize Pi Platter for Critical battery WARN message
-	write(serialFd, "C2=1\r", 5);
+	(void) QueuePort(&serialPort, "C2=1\r", 5);
+	EnableTelemetry();
 
 	// Setup device file link
-	linkFd = open("/dev/ptmx", O_RDWR);
-	if (linkFd == -1) {
+	fd = open("/dev/ptmx", O_RDWR);
+	if (fd == -1) {
 		syslog(LOG_ERR, "Open of /dev/ptmx failed: %m");
 		exit(1);
 	}
-	LinkSlave(linkFd);
+	LinkSlave(fd);
+	OpenPort(&linkPort, fd);
 
 	signal(SIGINT,SigHandler);
 	signal(SIGHUP,SigHandler);
 	signal(SIGTERM,SigHandler);
 
+	/* The listening sockets are ports that are only ever readable */
 	if (port) {
-		/* Open the socket for communications */
-		sockfd = socket(AF_INET, SOCK_STREAM, 6);
-		if ( sockfd == -1 ) {
-			syslog(LOG_ERR, "Can't open socket: %m");
-			exit(1);
-		}
-
-		addr.sin_family = AF_INET;
-		addr.sin_addr.s_addr = 0;
-		addr.sin_port = htons(port);
-	 
-		/* Set up to listen on the given port */
-		if( bind( sockfd, (struct sockaddr*)(&addr),
-			sizeof(struct sockaddr_in)) < 0 ) {
-			syslog(LOG_ERR, "Couldn't bind port %d, aborting: %m",port );
-			exit(1);
-		}
-		if ( debug>1 )
-			syslog(LOG_NOTICE,"Bound port");
-
-		/* Tell the system we want to listen on this socket */
-		result = listen(sockfd, 4);
-		if ( result == -1 ) {
-			syslog(LOG_ERR, "Socket listen failed: %m");
-			exit(1);
-		}
-
-		if ( debug>1 )
-			syslog(LOG_NOTICE,"Done listen");
+		sockfd = OpenListenSocket(port);
+		OpenPort(&listenPort, sockfd);
+	}
+	if (subPort) {
+		subfd = OpenListenSocket(subPort);
+		OpenPort(&subListenPort, subfd);
 	}
 
 	if ( isdaemon ) {
@@ -385,190 +1047,59 @@ int main(int argc, char *argv[])
 		close(2);
 	}
 
-	/* Set up the files/sockets for the select() call */
-	FD_SET(serialFd,&fdsread);
-	if ( serialFd >= maxfd )
-		maxfd = serialFd + 1;
-
-	FD_SET(linkFd,&fdsread);
-	if ( linkFd >= maxfd )
-		maxfd = linkFd + 1;
-
-	if ( sockfd != -1 ) {
-		FD_SET(sockfd,&fdsread);
-		if ( sockfd >= maxfd )
-			maxfd = sockfd + 1;
-	}
-
-	for (i=0 ; i<curConnects ; i++) {
-		FD_SET(remotefd[i],&fdsread);
-		if ( remotefd[i] >= maxfd )
-			maxfd = remotefd[i] + 1;
-	}
-
 	/* Note we are running */
 	syslog(LOG_NOTICE,"Connected to Pi Platter at %s", serName);
 
 	while (1) {
 
-		/* Wait for data from the listening socket, the device,
-		   the linked device, or the remote connection */
-		fdsreaduse = fdsread;
-		if ( select(maxfd,&fdsreaduse,NULL,NULL,NULL) == -1 )
+		/* Wait for data from the listening socket, the device, the linked
+		   device, or the remote connections, or for room to write to them */
+		n = epoll_wait(epfd, events, MAX_EVENTS, -1);
+		if ( n == -1 ) {
+			if ( errno == EINTR )
+				continue;
 			break;
-
-		/* Activity on the socket */
-		if ( port && FD_ISSET(sockfd,&fdsreaduse) ) {
-			int fd;
-
-			/* Accept the remote systems attachment */
-			remoteaddrlen = sizeof(struct sockaddr_in);
-			fd = accept(sockfd,(struct sockaddr*)(&remoteaddr),
-				&remoteaddrlen);
-
-			if ( fd == -1 )
-				syslog(LOG_ERR,"accept failed: %m");
-			else if (curConnects < maxConnects) {
-				unsigned long ip;
-
-				remotefd[curConnects++] = fd;
-				/* Tell select to watch this new socket */
-				FD_SET(fd,&fdsread);
-				if ( fd >= maxfd )
-					maxfd = fd + 1;
-				ip = ntohl(remoteaddr.sin_addr.s_addr);
-				if (debug>0)
-					syslog(LOG_NOTICE, "Connection from %d.%d.%d.%d",
-						(int)(ip>>24)&0xff,
-						(int)(ip>>16)&0xff,
-						(int)(ip>>8)&0xff,
-						(int)(ip>>0)&0xff);
-			}
-			else {
-				// Too many connections, just close it to reject
-				close(fd);
-			}
 		}
 
-		/* Data to read from the pi platter */
-		if ( FD_ISSET(serialFd,&fdsreaduse) ) {
-			devbytes = read(serialFd,devbuf,512);
-			if (debug>1)
-				syslog(LOG_INFO,"Pi Platter: %d bytes",devbytes);
-			if ( devbytes <= 0 ) {
-				if ( debug>0 )
-					syslog(LOG_INFO,"%s closed",serName);
-				close(serialFd);
-				FD_CLR(serialFd,&fdsread);
-				while (1) {
-					serialFd = OpenSerialPort(serName);
-					if ( serialFd != -1 )
-						break;
-					syslog(LOG_ERR, "Open of %s failed: %m", serName);
-					if ( errno != EIO )
-						goto err_exit;
-					sleep(1);
-				}
-				if ( debug>0 )
-					syslog(LOG_INFO,"%s re-opened",serName);
-				FD_SET(serialFd,&fdsread);
-				if ( serialFd >= maxfd )
-					maxfd = serialFd + 1;
+		for (i=0 ; i<n ; i++) {
+			p = (Port *) events[i].data.ptr;
+
+			/* Skip events for a port closed earlier in this batch */
+			if ( p->fd == -1 )
+				continue;
+
+			if ( port && (p == &listenPort) ) {
+				AcceptRemote(sockfd, remote);
+				continue;
 			}
-			else {
-				if (sendMask & 0x01) {
-					if ( linkFd != -1 ) 
-						write(linkFd,devbuf,devbytes);
-				}
-				if (sendMask & 0x02) {
-					for (i=0 ; i<curConnects ; i++)
-						write(remotefd[i],devbuf,devbytes);
-				}
-				if (ProcessResponse(devbuf, devbytes)) {
-					if (sawWarnCritical) {
-						if (restartEnable) {
-							write(serialFd, "C7=1\r", 5);
-						}
-						syslog(LOG_CRIT, "Battery Critical");
-						system("sudo shutdown now");
-					}
-					if (sawWarnLow) {
-						syslog(LOG_WARNING, "Battery Low");
-					}
-				}
-				if ( debug>2 ) {
-					devbuf[devbytes] = 0;
-					syslog(LOG_INFO, "Pi Platter sent %s", devbuf);
-				}
+			if ( subPort && (p == &subListenPort) ) {
+				AcceptRemote(subfd, subscriber);
+				continue;
 			}
-		}
 
-		/* Data to read from the linked device file */
-		if ( FD_ISSET(linkFd,&fdsreaduse) ) {
-			devbytes = read(linkFd,devbuf,512);
-			if (debug>1)
-				syslog(LOG_INFO,"%s: %d bytes", linkname, devbytes);
-			if ( devbytes <= 0 ) {
-				if ( debug>0 )
-					syslog(LOG_INFO,"%s closed",linkname);
-				close(linkFd);
-				FD_CLR(linkFd,&fdsread);
-				while (1) {
-					linkFd = open("/dev/ptmx", O_RDWR);
-					if ( linkFd != -1 )
-						break;
-					syslog(LOG_ERR, "Open of /dev/ptmx failed: %m");
-					if ( errno != EIO )
-						goto err_exit;
-					sleep(1);
+			if ( (events[i].events & EPOLLOUT) && (FlushPort(p) == -1) ) {
+				if ( (p == &serialPort) || (p == &linkPort) ) {
+					/* Drop what couldn't be written, reading will find out why */
+					p->len = 0;
+					SetPortOutput(p, 0);
 				}
-				if ( debug>0 )
-					syslog(LOG_INFO,"/dev/ptmx re-opened");
-				LinkSlave(linkFd);
-				FD_SET(linkFd,&fdsread);
-				if ( linkFd >= maxfd )
-					maxfd = linkFd + 1;
-			}
-			else if ( serialFd != -1 ) {
-				/* Write the data to the pi platter */
-				write(serialFd,devbuf,devbytes);
-				if ( debug>2 ) {
-					devbuf[devbytes] = 0;
-					syslog(LOG_INFO, "%s sent %s", linkname, devbuf);
+				else {
+					CloseRemote(p);
+					continue;
 				}
-				sendMask = 0x01;
 			}
-		}
 
-		/* Data to read from the remote system */
-		for (i=0 ; i<curConnects ; i++) {
-			if (FD_ISSET(remotefd[i],&fdsreaduse) ) {
-
-				devbytes = read(remotefd[i],devbuf,512);
-
-				if (debug>1)
-					syslog(LOG_INFO,"Remote: %d bytes",devbytes);
-
-				if ( devbytes == 0 ) {
-					register int j;
-
-					if (debug>0)
-						syslog(LOG_NOTICE,"Connection closed");
-					close(remotefd[i]);
-					FD_CLR(remotefd[i],&fdsread);
-					curConnects--;
-					for (j=i ; j<curConnects ; j++)
-						remotefd[j] = remotefd[j+1];
+			if ( events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR) ) {
+				if ( p == &serialPort ) {
+					if ( HandleSerial() == -1 )
+						goto err_exit;
 				}
-				else if ( serialFd != -1 ) {
-					/* Write the data to the pi platter */
-					write(serialFd,devbuf,devbytes);
-					if ( debug>2 ) {
-						devbuf[devbytes] = 0;
-						syslog(LOG_INFO, "Remote sent %s", devbuf);
-					}
-					sendMask = 0x02;
+				else if ( p == &linkPort ) {
+					if ( HandleLink() == -1 )
+						goto err_exit;
 				}
+				else
+					HandleRemote(p);
 			}
 		}
 	}
@@ -577,9 +1108,16 @@ err_exit:
 	// We normally only exit from a signal (via the signal handler) so this
 	// is used for an  error exit
 	close(sockfd);
-	for (i=0 ; i<curConnects ; i++)
-		close(remotefd[i]);
-	CloseSerialPort(serialFd);
-	close(linkFd);
+	close(subfd);
+	for (i=0 ; i<maxConnects ; i++) {
+		if ( remote[i].fd != -1 )
+			close(remote[i].fd);
+		if ( subscriber[i].fd != -1 )
+			close(subscriber[i].fd);
+	}
+	if ( serialPort.fd != -1 )
+		CloseSerialPort(serialPort.fd);
+	if ( linkPort.fd != -1 )
+		close(linkPort.fd);
 	exit(1);
 }
@@ -0,0 +1,143 @@
+#include "damage.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+
+/* --------------- */
+/* Local Variables */
+/* --------------- */
+
+static struct fb_var_screeninfo vinfo;
+static struct fb_fix_screeninfo finfo;
+static uint16_t* fbp = NULL;
+
+// What LittlevGL has drawn (shadow) and what is on the display (front), one row of
+// LV_HOR_RES_MAX pixels for each display row
+static uint16_t shadow[LV_HOR_RES_MAX * LV_VER_RES_MAX];
+static uint16_t front[LV_HOR_RES_MAX * LV_VER_RES_MAX];
+
+// Columns of each row flushed during the current refresh (x1 > x2 if none)
+static int16_t dirty_x1[LV_VER_RES_MAX];
+static int16_t dirty_x2[LV_VER_RES_MAX];
+
+static int disp_w;
+static int disp_h;
+
+
+
+/**
+ * Map the frame buffer.  Returns -1 if it can't be used (not 16-bit or larger than
+ * LittlevGL's maximum resolution) so the caller can use fbdev_flush() instead.
+ */
+int damage_init(const char* fb_path)
+{
+	int fd;
+	int y;
+
+	if ((fd = open(fb_path, O_RDWR)) < 0) {
+		perror("Error: cannot open framebuffer device");
+		return -1;
+	}
+
+	if ((ioctl(fd, FBIOGET_FSCREENINFO, &finfo) < 0) || (ioctl(fd, FBIOGET_VSCREENINFO, &vinfo) < 0)) {
+		perror("Error reading screen information");
+		close(fd);
+		return -1;
+	}
+
+	if ((vinfo.bits_per_pixel != 16) || (LV_COLOR_DEPTH != 16) ||
+	    (vinfo.xres > LV_HOR_RES_MAX) || (vinfo.yres > LV_VER_RES_MAX)) {
+		printf("Damage flush not supported for %dx%d, %dbpp\n", vinfo.xres, vinfo.yres, vinfo.bits_per_pixel);
+		close(fd);
+		return -1;
+	}
+	disp_w = vinfo.xres;
+	disp_h = vinfo.yres;
+
+	fbp = (uint16_t*) mmap(0, finfo.line_length * vinfo.yres_virtual, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (fbp == MAP_FAILED) {
+		perror("Error: failed to map framebuffer device to memory");
+		fbp = NULL;
+		return -1;
+	}
+	fbp += vinfo.yoffset * (finfo.line_length / 2) + vinfo.xoffset;
+
+	// Start with a cleared display so the front copy matches it
+	for (y=0; y<LV_VER_RES_MAX; y++) {
+		dirty_x1[y] = LV_HOR_RES_MAX;
+		dirty_x2[y] = -1;
+	}
+	memset(front, 0, sizeof(front));
+	for (y=0; y<disp_h; y++) {
+		memcpy(fbp + y * (finfo.line_length / 2), front + y * LV_HOR_RES_MAX, disp_w * 2);
+	}
+
+	printf("%dx%d, %dbpp (damage flush)\n", vinfo.xres, vinfo.yres, vinfo.bits_per_pixel);
+	return 0;
+}
+
+
+/**
+ * Copy an area into the shadow screen and note its rows.  Nothing is written to the
+ * frame buffer until the refresh is done.
+ */
+void damage_flush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p)
+{
+	int x1 = (area->x1 < 0) ? 0 : area->x1;
+	int y1 = (area->y1 < 0) ? 0 : area->y1;
+	int x2 = (area->x2 >= disp_w) ? disp_w - 1 : area->x2;
+	int y2 = (area->y2 >= disp_h) ? disp_h - 1 : area->y2;
+	int w = lv_area_get_width(area);
+	int y;
+
+	if ((x1 <= x2) && (y1 <= y2)) {
+		color_p += (y1 - area->y1) * w + (x1 - area->x1);
+		for (y=y1; y<=y2; y++) {
+			memcpy(shadow + y * LV_HOR_RES_MAX + x1, color_p, (x2 - x1 + 1) * 2);
+			color_p += w;
+			if (x1 < dirty_x1[y]) dirty_x1[y] = x1;
+			if (x2 > dirty_x2[y]) dirty_x2[y] = x2;
+		}
+	}
+
+	lv_disp_flush_ready(drv);
+}
+
+
+/**
+ * End of a refresh: write the changed part of each flushed row to the frame buffer
+ */
+void damage_monitor(lv_disp_drv_t* drv, uint32_t time, uint32_t px)
+{
+	uint16_t* sP;
+	uint16_t* fP;
+	int x1, x2, y;
+
+	for (y=0; y<disp_h; y++) {
+		if (dirty_x1[y] > dirty_x2[y]) continue;
+
+		// Trim the unchanged pixels from both ends
+		sP = shadow + y * LV_HOR_RES_MAX;
+		fP = front + y * LV_HOR_RES_MAX;
+		x1 = dirty_x1[y];
+		x2 = dirty_x2[y];
+		while ((x1 <= x2) && (sP[x1] == fP[x1])) x1++;
+		while ((x2 >= x1) && (sP[x2] == fP[x2])) x2--;
+
+		if (x1 <= x2) {
+			memcpy(fP + x1, sP + x1, (x2 - x1 + 1) * 2);
+			memcpy(fbp + y * (finfo.line_length / 2) + x1, sP + x1, (x2 - x1 + 1) * 2);
+		}
+
+		dirty_x1[y] = LV_HOR_RES_MAX;
+		dirty_x2[y] = -1;
+	}
+}
@@ -0,0 +1,20 @@
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+#include "lvgl/lvgl.h"
+
+// Damage-aware frame buffer flush for SPI displays driven by fbtft (the ILI9341).
+// fbtft's deferred io sends every row from the first to the last frame buffer page
+// written since its last update, so the cost of a refresh is set by which pages are
+// touched, not by how much LittlevGL redrew.  Flushed areas are copied into a shadow
+// screen and, when LittlevGL finishes the refresh (its monitor callback), each
+// flushed row is compared with what is already on the display and only the pixels
+// that actually changed are written to the frame buffer in one batch.  Areas redrawn
+// with the same content (for example the image under an unchanged label) and half
+// finished refreshes never reach the SPI bus.  16-bit displays only.
+
+int damage_init(const char* fb_path);
+void damage_flush(lv_disp_drv_t* drv, const lv_area_t* area, lv_color_t* color_p);
+void damage_monitor(lv_disp_drv_t* drv, uint32_t time, uint32_t px);
+
+#endif /* DAMAGE_H */
@@ -45,8 +45,14 @@
 #define LV_ANTIALIAS        1
 
 /* Default display refresh period.
- * Can be changed in the display driver (`lv_disp_drv_t`).*/
+ * Can be changed in the display driver (`lv_disp_drv_t`).
+ * The main loop also wakes with this period.  The thermal viewer uses the Lepton's
+ * ~9 Hz frame period (each new frame is also refreshed as soon as it arrives).*/
+#ifdef THERMAL_VIEWER
+#define LV_DISP_DEF_REFR_PERIOD      111     /*[ms]*/
+#else
 #define LV_DISP_DEF_REFR_PERIOD      30      /*[ms]*/
+#endif
 
 /* Dot Per Inch: used to initialize default sizes.
  * E.g. a button with width = LV_DPI / 2 -> half inch wide
@@ -2,17 +2,118 @@
 #include "lv_drivers/display/fbdev.h"
 #include "lv_drivers/indev/evdev.h"
 #include "lv_examples/lv_apps/demo/demo.h"
+#include "damage.h"
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#ifdef THERMAL_VIEWER
+#include "thermal.h"
+#include "prulepton.h"
+#include "vospi.h"
+#include <signal.h>
+#endif
 
 #define DISP_BUF_SIZE (320*240*2)
 
-int main(void)
+/*Maximum events taken with one epoll_wait()*/
+#define MAX_EVENTS 4
+
+/*The touchscreen device (opened by evdev_init())*/
+extern int evdev_fd;
+
+#ifdef THERMAL_VIEWER
+/*The PRU Lepton handle (frames are converted straight from its ring)*/
+static prulepton_t lep;
+
+/*Frame rate label state*/
+static int frames = 0;
+static uint32_t fps_t;
+#endif
+
+/*Current monotonic time in mSec*/
+static uint32_t get_msec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*Add a readable fd to the epoll set*/
+static void watch_fd(int epfd, int fd)
+{
+	struct epoll_event ev;
+
+	ev.events = EPOLLIN;
+	ev.data.fd = fd;
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		perror("epoll_ctl");
+		exit(-1);
+	}
+}
+
+#ifdef THERMAL_VIEWER
+/*Stop the PRUs before exiting*/
+static void sig_handler(int sig)
+{
+	prulepton_stop(&lep);
+	sleep(1);
+	exit(0);
+}
+
+/*Draw each new frame (unless it was overwritten while it was converted).  Returns
+  true if the image changed.*/
+static bool take_frames(void)
+{
+	static uint8_t pixbuf[VOSPI_FRAME_LEN];
+	vospi_frame_t* frame;
+	uint32_t seq;
+	bool drawn = false;
+
+	while ((frame = prulepton_get_frame(&lep, &seq)) != NULL) {
+		frame_to_pixel(frame, pixbuf);
+		if (prulepton_release_frame(&lep, seq)) {
+			thermal_update(pixbuf);
+			frames++;
+			drawn = true;
+		}
+	}
+	if (!lep.running) {
+		exit(-1);
+	}
+
+	return drawn;
+}
+
+/*Show the palette and frame rate once a second*/
+static void update_label(uint32_t t)
+{
+	char txt[32];
+
+	if ((t - fps_t) >= 1000) {
+		snprintf(txt, sizeof(txt), "%s  %d fps", thermal_get_palette_name(), (int) ((frames * 1000 + 500) / (t - fps_t)));
+		thermal_set_text(txt);
+		frames = 0;
+		fps_t = t;
+	}
+}
+#endif
+
+int main(int argc, char *argv[])
 {
 	/*LittlevGL init*/
 	lv_init();
 
-	/*Linux frame buffer device init*/
-	fbdev_init();
+	/*Linux frame buffer device init (only changed pixels are written when possible)*/
+	bool damage = (damage_init(FBDEV_PATH) == 0);
+	if (!damage) {
+		fbdev_init();
+	}
 
 	/*Linux touchscreen device init*/
 	evdev_init();
@@ -29,7 +130,12 @@ int main(void)
 	lv_disp_drv_t disp_drv;
 	lv_disp_drv_init(&disp_drv);
 	disp_drv.buffer = &disp_buf;
-	disp_drv.flush_cb = fbdev_flush;
+	if (damage) {
+		disp_drv.flush_cb = damage_flush;
+		disp_drv.monitor_cb = damage_monitor;
+	} else {
+		disp_drv.flush_cb = fbdev_flush;
+	}
 	lv_disp_drv_register(&disp_drv);
 
 	/*Initialize and register an input device*/
@@ -39,14 +145,89 @@ int main(void)
 	indev_drv.read_cb = evdev_read;
 	lv_indev_t * my_indev = lv_indev_drv_register(&indev_drv);
 
+#ifdef THERMAL_VIEWER
+	/*Create the thermal viewer (optional colormap argument) and start the Lepton*/
+	prulepton_config_t config;
+
+	thermal_create(lv_scr_act());
+	if (argc > 1) {
+		thermal_set_palette(atoi(argv[1]));
+	}
+
+	if (prulepton_init_lepton(PRULEPTON_I2C_DEV)) {
+		exit(-1);
+	}
+	signal(SIGINT, sig_handler);
+	signal(SIGTERM, sig_handler);
+	prulepton_default_config(&config);
+	config.pru_dev = PRULEPTON_PRU_DEV;
+	if (prulepton_start(&lep, &config)) {
+		exit(-1);
+	}
+	fps_t = get_msec();
+#else
 	 /*Create demo*/
 	demo_create();
+#endif
+
+	/*Wake on the refresh period tick, touches and (thermal viewer) new frames instead
+	  of polling.  LittlevGL tasks are only handled when one of them happens.*/
+	struct epoll_event evs[MAX_EVENTS];
+	struct itimerspec its;
+	uint64_t expirations;
+	uint32_t t, last_t;
+	int epfd, tfd, i, n;
 
-	/*Handle LitlevGL tasks (tickless mode)*/
+	epfd = epoll_create1(0);
+	tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+	if ((epfd < 0) || (tfd < 0)) {
+		perror("epoll/timerfd");
+		exit(-1);
+	}
+	its.it_interval.tv_sec = 0;
+	its.it_interval.tv_nsec = LV_DISP_DEF_REFR_PERIOD * 1000000L;
+	its.it_value = its.it_interval;
+	(void) timerfd_settime(tfd, 0, &its, NULL);
+	watch_fd(epfd, tfd);
+	if (evdev_fd >= 0) {
+		watch_fd(epfd, evdev_fd);
+	}
+#ifdef THERMAL_VIEWER
+	watch_fd(epfd, prulepton_get_fd(&lep));
+#endif
+
+	last_t = get_msec();
 	while(1) {
-		lv_tick_inc(5);
+		n = epoll_wait(epfd, evs, MAX_EVENTS, -1);
+		if (n < 0) {
+			if (errno == EINTR) continue;
+			perror("epoll_wait");
+			exit(-1);
+		}
+
+		for (i=0; i<n; i++) {
+			if (evs[i].data.fd == tfd) {
+				(void) read(tfd, &expirations, sizeof(expirations));
+			} else if (evs[i].data.fd == evdev_fd) {
+				/*Read the touch now (evdev_read() drains the device)*/
+				lv_task_ready(my_indev->driver.read_task);
+			}
+#ifdef THERMAL_VIEWER
+			else if (take_frames()) {
+				/*Show the new image without waiting for the refresh period*/
+				lv_task_ready(lv_disp_get_default()->refr_task);
+			}
+#endif
+		}
+
+		/*Handle LittlevGL tasks with the time that has actually passed*/
+		t = get_msec();
+#ifdef THERMAL_VIEWER
+		update_label(t);
+#endif
+		lv_tick_inc(t - last_t);
+		last_t = t;
 		lv_task_handler();
-		usleep(5000);
 	}
 
 	return 0;
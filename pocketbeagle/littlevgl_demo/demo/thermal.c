@@ -0,0 +1,153 @@
+#include "thermal.h"
+#include "colormaps.h"
+
+#include <stdint.h>
+#include <string.h>
+
+
+/* --------------- */
+/* Local Variables */
+/* --------------- */
+
+// Palette colormaps (R-G-B) and the number of colors in each
+static const struct {
+	const char* name;
+	const unsigned char* cmap;
+	int num_colors;
+} palettes[THERMAL_NUM_PAL] = {
+	{"Golden", (const unsigned char*) colormap_golden, sizeof(colormap_golden) / 3},
+	{"Rainbow", colormap_rainbow, sizeof(colormap_rainbow) / 3},
+	{"Grayscale", colormap_grayscale, sizeof(colormap_grayscale) / 3},
+	{"Ironblack", colormap_ironblack, sizeof(colormap_ironblack) / 3}
+};
+
+static int cur_palette = THERMAL_PAL_GOLDEN;
+
+// Canvas colors for each pixel value with the current palette
+static lv_color_t lut[256];
+
+// Canvas image buffer
+static lv_color_t canvas_buf[THERMAL_WIDTH * THERMAL_HEIGHT];
+
+static lv_obj_t* canvas;
+static lv_obj_t* label;
+static lv_style_t label_style;
+
+
+
+/**
+ * Build the LUT for the current palette
+ */
+static void build_lut()
+{
+	const unsigned char* cP;
+	int i, n;
+
+	for (i=0; i<256; i++) {
+		// Short colormaps repeat their last color
+		n = (i < palettes[cur_palette].num_colors) ? i : palettes[cur_palette].num_colors - 1;
+		cP = palettes[cur_palette].cmap + n*3;
+		lut[i] = lv_color_make(cP[0], cP[1], cP[2]);
+	}
+}
+
+
+/**
+ * Touching the image selects the next palette
+ */
+static void canvas_event_cb(lv_obj_t* obj, lv_event_t event)
+{
+	if (event == LV_EVENT_CLICKED) {
+		thermal_set_palette((cur_palette + 1) % THERMAL_NUM_PAL);
+	}
+}
+
+
+
+/**
+ * Create the viewer in parent with a black image and the palette name as its label.
+ * Returns the canvas so the application can position it.
+ */
+lv_obj_t* thermal_create(lv_obj_t* parent)
+{
+	int i;
+
+	build_lut();
+	for (i=0; i<THERMAL_WIDTH * THERMAL_HEIGHT; i++) {
+		canvas_buf[i] = LV_COLOR_BLACK;
+	}
+
+	canvas = lv_canvas_create(parent, NULL);
+	lv_canvas_set_buffer(canvas, canvas_buf, THERMAL_WIDTH, THERMAL_HEIGHT, LV_IMG_CF_TRUE_COLOR);
+	lv_obj_set_click(canvas, true);
+	lv_obj_set_event_cb(canvas, canvas_event_cb);
+
+	// White text without a background on the image
+	lv_style_copy(&label_style, &lv_style_plain);
+	label_style.text.color = LV_COLOR_WHITE;
+	label = lv_label_create(parent, NULL);
+	lv_label_set_style(label, LV_LABEL_STYLE_MAIN, &label_style);
+	lv_label_set_text(label, palettes[cur_palette].name);
+	lv_obj_align(label, canvas, LV_ALIGN_IN_TOP_LEFT, 4, 4);
+
+	return canvas;
+}
+
+
+/**
+ * Select palette n (THERMAL_PAL_xxx).  It is used starting with the next image.
+ */
+void thermal_set_palette(int n)
+{
+	if ((n < 0) || (n >= THERMAL_NUM_PAL)) {
+		n = THERMAL_PAL_GOLDEN;
+	}
+	cur_palette = n;
+	build_lut();
+}
+
+
+int thermal_get_palette()
+{
+	return cur_palette;
+}
+
+
+const char* thermal_get_palette_name()
+{
+	return palettes[cur_palette].name;
+}
+
+
+/**
+ * Set the label text.  LittlevGL invalidates just the label's old and new areas.
+ */
+void thermal_set_text(const char* txt)
+{
+	lv_label_set_text(label, txt);
+}
+
+
+/**
+ * Draw an image of THERMAL_IMG_W x THERMAL_IMG_H 8-bit pixels into the canvas buffer,
+ * doubling each pixel, and invalidate the canvas so it is redrawn by the next
+ * lv_task_handler()
+ */
+void thermal_update(const uint8_t* pixbuf)
+{
+	lv_color_t* dP = canvas_buf;
+	int x, y;
+
+	for (y=0; y<THERMAL_IMG_H; y++) {
+		// Render one line and copy it to the second line it covers
+		for (x=0; x<THERMAL_IMG_W; x++) {
+			*dP = lut[*pixbuf++];
+			*(dP+1) = *dP;
+			dP += 2;
+		}
+		memcpy(dP, dP - THERMAL_WIDTH, THERMAL_WIDTH * sizeof(lv_color_t));
+		dP += THERMAL_WIDTH;
+	}
+
+	lv_obj_invalidate(canvas);
+}
@@ -0,0 +1,36 @@
+#ifndef THERMAL_H
+#define THERMAL_H
+
+#include "lvgl/lvgl.h"
+#include <stdint.h>
+
+// LittlevGL thermal image viewer.  A canvas showing Lepton frames (8-bit pixels from
+// frame_to_pixel()) scaled x2 through a palette LUT with a label overlaid on its top
+// left corner.  Each new image is drawn straight into the canvas buffer and only the
+// canvas area is invalidated so LittlevGL redraws it (and anything on top of it)
+// through its display driver along with the rest of the UI.  Touching the image
+// selects the next palette.  There is one viewer per application.
+
+// Lepton image and (x2) viewer dimensions
+#define THERMAL_IMG_W   160
+#define THERMAL_IMG_H   120
+#define THERMAL_WIDTH   (THERMAL_IMG_W * 2)
+#define THERMAL_HEIGHT  (THERMAL_IMG_H * 2)
+
+// Palettes (the same numbering as the pru_rpmsg_fb colormap argument)
+#define THERMAL_PAL_GOLDEN     0
+#define THERMAL_PAL_RAINBOW    1
+#define THERMAL_PAL_GRAYSCALE  2
+#define THERMAL_PAL_IRONBLACK  3
+#define THERMAL_NUM_PAL        4
+
+
+
+lv_obj_t* thermal_create(lv_obj_t* parent);
+void thermal_set_palette(int n);
+int thermal_get_palette();
+const char* thermal_get_palette_name();
+void thermal_set_text(const char* txt);
+void thermal_update(const uint8_t* pixbuf);
+
+#endif /* THERMAL_H */
@@ -0,0 +1,58 @@
+#ifndef AGC_H
+#define AGC_H
+
+#include <stdint.h>
+
+// Software AGC for 16-bit (Radiometric TLinear) frames.  Maps each frame to 8-bit
+// display pixels so a radiometric stream can be displayed without reconfiguring the
+// Lepton's AGC.  The histogram is built in the same pass that finds the frame's range
+// with AGC_HIST_BINS bins spread over the previous frame's range (the same binning
+// PRU1's frame statistics use, so their histogram can be used instead with
+// agc_map_hist()).  The mapping is a 256 entry LUT indexed by bin, applied with NEON
+// table lookups when available.
+//
+//   AGC_MODE_LINEAR - Linear between the lowest and highest occupied bins
+//   AGC_MODE_HEQ    - Histogram equalization with an optional clip limit
+//   AGC_MODE_CLAHE  - Contrast limited adaptive histogram equalization: a clipped
+//                     HEQ map for each of AGC_TILES_X x AGC_TILES_Y tiles,
+//                     bilinearly interpolated between the tile centers
+//
+// The clip limit is a multiple of the average bin count (0 disables clipping).  Counts
+// above it are redistributed over all bins, limiting how much contrast the large
+// uniform areas of a scene get.  2 - 4 is typical for CLAHE.
+
+#define AGC_MODE_LINEAR  0
+#define AGC_MODE_HEQ     1
+#define AGC_MODE_CLAHE   2
+
+#define AGC_HIST_BINS    256
+
+// Frame and CLAHE tile dimensions
+#define AGC_WIDTH        160
+#define AGC_HEIGHT       120
+#define AGC_TILES_X      4
+#define AGC_TILES_Y      4
+#define AGC_NUM_TILES    (AGC_TILES_X * AGC_TILES_Y)
+
+typedef struct {
+	int mode;
+	int clip;
+	int primed;                  // Set once a frame has set the histogram range
+	uint16_t base;               // Pixel value at the start of bin 0
+	uint16_t shift;              // Each bin is (1 << shift) pixel values wide
+	uint16_t hist[AGC_NUM_TILES][AGC_HIST_BINS];
+	uint8_t map[AGC_NUM_TILES][AGC_HIST_BINS];
+	uint8_t col_tile[AGC_WIDTH];  // CLAHE tile left of each column's center and its weight
+	uint8_t col_w[AGC_WIDTH];
+	uint8_t row_tile[AGC_HEIGHT]; // CLAHE tile above each row's center and its weight
+	uint8_t row_w[AGC_HEIGHT];
+} agc_t;
+
+
+
+void agc_init(agc_t* agc, int mode, int clip);
+void agc_map(agc_t* agc, const uint16_t* pix16buf, uint8_t* pixbuf);
+void agc_map_hist(agc_t* agc, const uint16_t* pix16buf, uint8_t* pixbuf, const uint16_t* hist,
+                  uint16_t base, uint16_t shift);
+
+#endif /* AGC_H */
@@ -12,6 +12,14 @@
 #define CCI_REG_COMMAND 0x0004
 #define CCI_REG_DATA_LENGTH 0x0006
 #define CCI_REG_DATA_0 0x0008
+#define CCI_REG_DATA_BUFFER 0xF800
+
+/* Largest block transfer: the 1 kB data buffer (the 16 DATA registers hold 16 words) */
+#define CCI_MAX_BLOCK_WORDS 512
+
+/* Busy poll period and the time allowed for a command to complete */
+#define CCI_BUSY_POLL_USEC 500
+#define CCI_BUSY_TIMEOUT_MSEC 5000
 
 /* Commands */
 #define CCI_CMD_SYS_RUN_FFC 0x0242
@@ -20,6 +28,8 @@
 #define CCI_CMD_SYS_SET_TELEMETRY_ENABLE_STATE 0x0219
 #define CCI_CMD_SYS_GET_TELEMETRY_LOCATION 0x021C
 #define CCI_CMD_SYS_SET_TELEMETRY_LOCATION 0x021D
+#define CCI_CMD_SYS_GET_FFC_SHUTTER_MODE 0x023C
+#define CCI_CMD_SYS_SET_FFC_SHUTTER_MODE 0x023D
 
 #define CCI_CMD_RAD_GET_RADIOMETRY_ENABLE_STATE 0x4E10
 #define CCI_CMD_RAD_SET_RADIOMETRY_ENABLE_STATE 0x4E11
@@ -32,6 +42,8 @@
 #define CCI_CMD_AGC_SET_CALC_ENABLE_STATE 0x0149
 
 #define CCI_CMD_OEM_RUN_REBOOT 0x4842
+#define CCI_CMD_OEM_GET_GPIO_MODE 0x4854
+#define CCI_CMD_OEM_SET_GPIO_MODE 0x4855
 
 
 #define WAIT_FOR_BUSY_DEASSERT() cci_wait_busy_clear(fd);
@@ -47,6 +59,17 @@ typedef enum {
   CCI_TELEMETRY_LOCATION_FOOTER,
 } cci_telemetry_location_t;
 
+/* FFC shutter mode object for use with CCI_CMD_SYS_*_FFC_SHUTTER_MODE: 16 words with
+   the shutter mode in the first (32-bit values are least significant word first) */
+#define CCI_FFC_SHUTTER_MODE_WORDS 16
+#define CCI_FFC_SHUTTER_MODE_WORD  0
+
+typedef enum {
+  CCI_FFC_SHUTTER_MODE_MANUAL,
+  CCI_FFC_SHUTTER_MODE_AUTO,
+  CCI_FFC_SHUTTER_MODE_EXTERNAL,
+} cci_ffc_shutter_mode_t;
+
 /* Radiometry Modes for use with CCI_CMD_RAD_SET_RADIOMETRY* */
 typedef enum {
   CCI_RADIOMETRY_DISABLED,
@@ -64,13 +87,25 @@ typedef enum {
   CCI_AGC_ENABLED,
 } cci_agc_enable_state_t;
 
+/* GPIO Modes for use with CCI_CMD_OEM_SET_GPIO_MODE* */
+typedef enum {
+  LEP_OEM_GPIO_MODE_GPIO = 0,
+  LEP_OEM_GPIO_MODE_I2C_MASTER = 1,
+  LEP_OEM_GPIO_MODE_SPI_MASTER_VLB_DATA = 2,
+  LEP_OEM_GPIO_MODE_SPIO_MASTER_REG_DATA = 3,
+  LEP_OEM_GPIO_MODE_SPI_SLAVE_VLB_DATA = 4,
+  LEP_OEM_GPIO_MODE_VSYNC = 5
+} cci_gpio_mode_t;
+
 /* Setup */
 int cci_init(int fd);
 
 /* Primative methods */
 int cci_write_register(int fd, uint16_t reg, uint16_t value);
 uint16_t cci_read_register(int fd, uint16_t reg);
-void cci_wait_busy_clear(int fd);
+int cci_write_block(int fd, uint16_t reg, const uint16_t* words, int nwords);
+int cci_read_block(int fd, uint16_t reg, uint16_t* words, int nwords);
+int cci_wait_busy_clear(int fd);
 
 /* Module: SYS */
 void cci_run_ffc(int fd);
@@ -79,6 +114,8 @@ void cci_set_telemetry_enable_state(int fd, cci_telemetry_enable_state_t state);
 uint32_t cci_get_telemetry_enable_state(int fd);
 void cci_set_telemetry_location(int fd, cci_telemetry_location_t location);
 uint32_t cci_get_telemetry_location(int fd);
+void cci_set_ffc_shutter_mode(int fd, const uint16_t* obj);
+int cci_get_ffc_shutter_mode(int fd, uint16_t* obj);
 
 /* Module: RAD */
 void cci_set_radiometry_enable_state(int fd, cci_radiometry_enable_state_t state);
@@ -94,5 +131,7 @@ uint32_t cci_get_agc_calc_enable_state(int fd);
 
 /* Module: OEM */
 void cc_run_oem_reboot(int fd);
+void cci_set_gpio_mode(int fd, cci_gpio_mode_t mode);
+uint32_t cci_get_gpio_mode(int fd);
 
 #endif /* CCI_H */
@@ -3,8 +3,20 @@
 
 #include <stdint.h>
 
+// Uncomment to scale the image up with bilinear interpolation instead of doubling each
+// pixel
+//#define FB_BILINEAR
+
+// Maximum number of mosaic tiles
+#define FB_MAX_TILES 16
+
 int init_fb(char* fb_path);
 void update_fb(uint8_t* pixbuf);
+void draw_fb_rows(uint8_t* pixbuf, int y, int n);
+void show_fb();
+int set_fb_tiles(int n);
+void draw_fb_tile(int tile, uint8_t* pixbuf);
+void show_fb_tiles();
 void set_colormap(int n);
 uint16_t get_rgb_pixel(uint8_t p);
 
@@ -0,0 +1,35 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include "vospi.h"
+#include <semaphore.h>
+#include <stdint.h>
+
+// Lock-free single producer / single consumer ring of frames.  The producer (the
+// thread reading the device) transfers frames directly into the next ring slot and
+// the consumer processes them in place so frames are never copied.  When the ring is
+// full the producer overwrites the oldest frame.  The consumer detects when a frame
+// it was processing was overwritten (frame_ring_release() fails) so it can discard
+// its result.
+
+// Number of frames in the ring
+#define FRAME_RING_SIZE 8
+
+typedef struct {
+	vospi_frame_t* frames[FRAME_RING_SIZE];
+	uint32_t head;       // Frames pushed by the producer (free-running)
+	uint32_t tail;       // Frames released by the consumer or dropped (free-running)
+	uint32_t dropped;    // Frames overwritten before the consumer got to them
+	sem_t push_sem;      // Posted for each pushed frame to wake the consumer
+} frame_ring_t;
+
+
+
+int frame_ring_init(frame_ring_t* ring);
+vospi_frame_t* frame_ring_get_write(frame_ring_t* ring);
+void frame_ring_push(frame_ring_t* ring);
+vospi_frame_t* frame_ring_get_read(frame_ring_t* ring, uint32_t* seq);
+vospi_frame_t* frame_ring_try_read(frame_ring_t* ring, uint32_t* seq);
+int frame_ring_release(frame_ring_t* ring, uint32_t seq);
+
+#endif /* FRAME_RING_H */
@@ -0,0 +1,35 @@
+#ifndef JPEG_H
+#define JPEG_H
+
+#include <stdint.h>
+
+// Baseline JPEG encoder for palette mapped 8-bit images (the same encoder as the
+// tCam-Mini preview images).  Each pixel is a palette index converted to YCbCr
+// through the palette.  The file has the layout RTP/JPEG (RFC 2435) type 0 describes
+// so the scan can be sent without its headers and rebuilt by any receiver from the
+// quality alone:
+//   YCbCr 4:2:2 (Y 2x1, Cb 1x1, Cr 1x1), 16x8 pixel MCUs, no restart markers
+//   Quantization tables: Annex K tables scaled by quality (RFC 2435 Appendix A)
+//   Huffman tables: the Annex K standard tables
+//   SOI, APP0 (JFIF), DQT (2 tables), SOF0, DHT (4 tables), SOS, scan, EOI
+
+// Quality (1 - 99, also the RTP/JPEG Q value)
+#define JPEG_MIN_QUALITY  1
+#define JPEG_MAX_QUALITY  99
+#define JPEG_DEF_QUALITY  80
+
+// Image dimensions must be multiples of the MCU size
+#define JPEG_MCU_WIDTH    16
+#define JPEG_MCU_HEIGHT   8
+
+// RTP/JPEG type for the layout
+#define JPEG_RTP_TYPE     0
+
+// Output buffer large enough for a 160x120 image at any quality
+#define JPEG_MAX_LEN      65536
+
+
+
+int jpeg_encode(const uint8_t* img, int width, int height, const uint8_t* palette, int quality, uint8_t* out, int max_len, int* scan_offset);
+
+#endif /* JPEG_H */
@@ -0,0 +1,67 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "prulepton.h"
+#include <pthread.h>
+
+// Battery power policy.  Subscribes to the telemetry frames bpd publishes from the
+// Pi Platter ("TLM <battery volts> <status> <temperature>", see the bbb_platter
+// utilities) and steps the capture pipeline down as the battery runs down by
+// lowering the frame rate (the PRUs are disabled between frames) and dimming the
+// display backlight.  Capture is paused and the backlight turned off when the
+// battery is critical.  Everything is restored as soon as the Pi Platter reports
+// external (USB) power.  The policy runs in its own thread and reconnects to bpd
+// if the connection is lost (running at full power until it has telemetry again).
+//
+//   POWER_FULL     - External power (or no telemetry): every frame, full backlight
+//   POWER_REDUCED  - On battery: POWER_REDUCED_MSEC frames, dimmed backlight
+//   POWER_LOW      - Battery below POWER_LOW_MV or low battery warning: POWER_LOW_MSEC
+//                    frames, dim backlight
+//   POWER_STANDBY  - Battery below POWER_STANDBY_MV or critical battery: capture
+//                    paused, backlight off
+//
+// Levels are only stepped back up once the battery is POWER_HYST_MV above the
+// threshold that stepped them down (external power restores full power at once).
+
+#define POWER_FULL     0
+#define POWER_REDUCED  1
+#define POWER_LOW      2
+#define POWER_STANDBY  3
+
+// Default bpd telemetry port (bpd -s) on this host
+#define POWER_DEF_PORT      23001
+
+// Battery thresholds
+#define POWER_LOW_MV        3700
+#define POWER_STANDBY_MV    3450
+#define POWER_HYST_MV       50
+
+// Minimum time between frames for each level
+#define POWER_REDUCED_MSEC  500
+#define POWER_LOW_MSEC      2000
+
+// pwm-backlight brightness (levels 0-7 from PB-TFT-ILI9348-SPI0.dts) for each level
+#define POWER_BACKLIGHT     "/sys/class/backlight/backlight/brightness"
+#define POWER_FULL_BL       7
+#define POWER_REDUCED_BL    4
+#define POWER_LOW_BL        2
+
+// Pi Platter STATUS byte bits
+#define POWER_STATUS_LOW_BATT   0x01
+#define POWER_STATUS_CRIT_BATT  0x02
+#define POWER_STATUS_USB_POWER  0x04
+
+typedef struct {
+	prulepton_t* lep;    // Capture whose frame rate is controlled
+	int port;
+	int level;           // Current POWER_xxx level
+	int batt_mv;         // Last reported battery voltage
+	pthread_t thread;
+} power_t;
+
+
+
+int power_start(power_t* power, prulepton_t* lep, int port);
+int power_get_level(power_t* power);
+
+#endif /* POWER_H */
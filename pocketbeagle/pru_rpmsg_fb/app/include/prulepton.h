@@ -0,0 +1,97 @@
+#ifndef PRULEPTON_H
+#define PRULEPTON_H
+
+#include "frame_ring.h"
+#include "vospi.h"
+#include <pthread.h>
+#include <stdint.h>
+
+// PRU Lepton frame access.  Configures the Lepton through CCI, runs the PRUs and
+// transfers frames into a frame ring from its own capture thread (optionally a
+// SCHED_FIFO thread pinned to a CPU).  Applications either take frames with a frame
+// ready callback (prulepton_run()) or wait on the handle's file descriptor with
+// poll/select/epoll and take them with prulepton_get_frame() without blocking.
+// Frames are processed in place in the ring and must be released when done.
+//
+// The frame rate can be lowered (to save power) with prulepton_set_interval().  The
+// capture thread then disables the PRUs after each frame and enables them again when
+// the next frame is due so neither the PRUs nor the capture thread do anything in
+// between.  A negative interval pauses capture until a new interval is set.
+//
+// With VOSPI_DDR_RING the PRUs can instead be put into standby with
+// prulepton_set_standby() (at the full frame rate).  They keep capturing and check
+// each frame against the triggers without waking the capture thread so the system
+// idles until a frame trips them.  The frames leading up to it are then pushed
+// into the frame ring at once and capture continues normally.
+//
+// A transfer that fails outright (the device read failed or the PRUs couldn't sync)
+// doesn't stop capture.  The capture thread recovers in place, escalating with each
+// failure until a frame arrives, so consumers and their sockets stay attached:
+//   resync  Disable the PRUs for PRULEPTON_RESYNC_MSEC (longer than the Lepton's 185
+//           mSec resync time) and enable them again, PRULEPTON_RESYNC_TRIES times
+//   reboot  Reboot the Lepton through CCI (config.i2c_dev), configure it again with
+//           prulepton_init_lepton() and enable the PRUs, PRULEPTON_REBOOT_TRIES times
+// Capture only stops (with error set) once these have failed.
+
+// prulepton_set_interval() values
+#define PRULEPTON_ALL_FRAMES  0
+#define PRULEPTON_PAUSED      -1
+
+// Recovery
+#define PRULEPTON_RESYNC_MSEC  250
+#define PRULEPTON_RESYNC_TRIES 3
+#define PRULEPTON_REBOOT_TRIES 2
+
+// Default devices
+#define PRULEPTON_I2C_DEV "/dev/i2c-2"
+#define PRULEPTON_PRU_DEV "/dev/rpmsg_pru31"
+
+typedef struct {
+	char* pru_dev;
+	int rt_priority;     // SCHED_FIFO priority of the capture thread, 0 for SCHED_OTHER
+	int cpu;             // CPU the capture thread is pinned to, -1 for any
+	char* i2c_dev;       // Lepton CCI device for recovery reboots, NULL to only resync
+} prulepton_config_t;
+
+typedef struct {
+	prulepton_config_t config;
+	frame_ring_t ring;
+	int pru_fd;
+	int event_fd;        // Readable when frames have been pushed into the ring
+	int running;         // Cleared when capture stops
+	int error;           // Set if capture stopped because the device failed
+	uint32_t resyncs;    // Frame transfers that failed (the PRUs resynchronize)
+	uint32_t recoveries; // Failed transfers recovered from (PRU restarts and reboots)
+	uint32_t reboots;    // Lepton reboots by recovery
+	int failures;        // Failed transfers since the last frame (the recovery level)
+	volatile int interval_msec;  // Minimum time between frames (PRULEPTON_xxx)
+#ifdef VOSPI_DDR_RING
+	volatile int standby_pending;  // standby is sent to the PRUs after the next frame
+	vospi_standby_t standby;
+#endif
+	pthread_t capture_thread;
+} prulepton_t;
+
+// Frame ready callback.  The frame is valid until it is released (prulepton_run()
+// releases it after the callback returns if the callback did not).
+typedef void (*prulepton_frame_cb_t)(prulepton_t* lep, vospi_frame_t* frame, uint32_t seq, void* arg);
+
+
+
+int prulepton_open_cci(char* i2c_dev);
+int prulepton_init_lepton(char* i2c_dev);
+int prulepton_init_lepton_fast(char* i2c_dev);
+void prulepton_default_config(prulepton_config_t* config);
+int prulepton_start(prulepton_t* lep, prulepton_config_t* config);
+void prulepton_stop(prulepton_t* lep);
+int prulepton_get_fd(prulepton_t* lep);
+vospi_frame_t* prulepton_get_frame(prulepton_t* lep, uint32_t* seq);
+vospi_frame_t* prulepton_wait_frame(prulepton_t* lep, uint32_t* seq);
+int prulepton_release_frame(prulepton_t* lep, uint32_t seq);
+void prulepton_set_interval(prulepton_t* lep, int msec);
+#ifdef VOSPI_DDR_RING
+void prulepton_set_standby(prulepton_t* lep, const vospi_standby_t* standby);
+#endif
+int prulepton_run(prulepton_t* lep, prulepton_frame_cb_t cb, void* arg);
+
+#endif /* PRULEPTON_H */
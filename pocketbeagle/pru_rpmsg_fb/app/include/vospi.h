@@ -3,18 +3,111 @@
 
 #include <stdint.h>
 
+// Uncomment to receive full 16-bit Radiometric TLinear pixels (Kelvin * 100) instead
+// of 8-bit AGC pixels.  This must match the LEP_16BIT define both PRUs were built with.
+//#define VOSPI_16BIT
+
 // The size of a single VoSPI PRMsg 
+#ifdef VOSPI_16BIT
+#define VOSPI_PKT_NUM_BYTES   160
+#define VPSPI_MSG_NUM_PKTS    3
+#else
 #define VOSPI_PKT_NUM_BYTES   80
 #define VPSPI_MSG_NUM_PKTS    6
+#endif
 #define VOSPI_MSG_DATA_BYTES  (VOSPI_PKT_NUM_BYTES * VPSPI_MSG_NUM_PKTS)
 #define VOSPI_MSG_TOTAL_BYTES (VOSPI_MSG_DATA_BYTES + 1)
 
-// A single frame
+// A single frame (VOSPI_FRAME_LEN pixels of VOSPI_PIXEL_BYTES each)
 #define VOSPI_FRAME_LEN       (160 * 120)
-#define VOSPI_FRAME_NUM_MSGS  (VOSPI_FRAME_LEN / VOSPI_MSG_DATA_BYTES)
+#define VOSPI_PIXEL_BYTES     (VOSPI_PKT_NUM_BYTES / 80)
+#define VOSPI_FRAME_BYTES     (VOSPI_FRAME_LEN * VOSPI_PIXEL_BYTES)
+#define VOSPI_FRAME_NUM_MSGS  (VOSPI_FRAME_BYTES / VOSPI_MSG_DATA_BYTES)
+
+// Uncomment to map 16-bit frames to 8-bit pixels in frame_to_pixel() with the software
+// AGC (AGC_MODE_LINEAR, AGC_MODE_HEQ or AGC_MODE_CLAHE, see agc.h) instead of scaling
+// them linearly between their minimum and maximum pixel, giving a display with
+// contrast while the Lepton sends radiometric frames.  The histogram from the frame
+// statistics is used when available.  VOSPI_AGC_CLIP is the clip limit (0 for none).
+//#define VOSPI_AGC_MODE        AGC_MODE_HEQ
+#define VOSPI_AGC_CLIP        4
+
+// Uncomment to filter the Lepton's frame to frame noise with a recursive temporal
+// filter of this level (1 - 4, stronger filtering, see vospi_tf.h) as frames are
+// converted to pixels.  The filter keeps one accumulator for the application's frame
+// stream so frame_to_pixel() or frame_to_pixel16() should be called exactly once for
+// each frame.  16-bit frames are scaled to the filtered range.
+//#define VOSPI_TF_LEVEL        2
+
+// Uncomment to receive the pixel statistics PRU1 computes for each frame in
+// VOSPI_STATS_NUM_MSGS extra messages following the image messages.  This must match
+// the FRAME_STATS define PRU1 was built with (not available with VOSPI_DDR_RING).
+//#define VOSPI_FRAME_STATS
+
+#define VOSPI_HIST_BINS       256
+#ifdef VOSPI_FRAME_STATS
+#define VOSPI_STATS_NUM_MSGS  2
+#else
+#define VOSPI_STATS_NUM_MSGS  0
+#endif
+#define VOSPI_FRAME_TOTAL_MSGS (VOSPI_FRAME_NUM_MSGS + VOSPI_STATS_NUM_MSGS)
 
-// Abort message seq num
+// Abort message seq num and reasons (in data[0])
 #define VOSPI_ABORT_MSG       0xFF
+#define VOSPI_ABORT_PKT       0      // PRU0 received a bad packet
+#define VOSPI_ABORT_UNDERRUN  1      // PRU1 sending faster than PRU0 stores packets
+#define VOSPI_ABORT_OVERRUN   2      // PRU1 sending too slowly, PRU0 overwrote data
+
+// PRU timing command (VOSPI_TIMING_CMD followed by the PRU0 packet sample period and
+// the PRU1 message period in uSec as 16-bit little endian values, a value outside its
+// range selects the firmware default).  This must match HOST_CMD_TIMING in the
+// firmware's pru_common.h.  It is sent while acquisition is stopped.
+#define VOSPI_TIMING_CMD      'T'
+#define VOSPI_TIMING_CMD_LEN  5
+#define VOSPI_SAMPLE_USEC_MIN 100
+#define VOSPI_SAMPLE_USEC_MAX 157
+#define VOSPI_SAMPLE_USEC_DEF 128
+#define VOSPI_XMIT_USEC_MIN   200
+#define VOSPI_XMIT_USEC_MAX   2000
+#ifdef VOSPI_16BIT
+#define VOSPI_XMIT_USEC_DEF   480
+#else
+#define VOSPI_XMIT_USEC_DEF   1024
+#endif
+
+// PRU timing the applications set before starting acquisition (0 for the firmware
+// defaults).  Use calibrate_timing to find the tightest stable timing for a board.
+#define VOSPI_SAMPLE_USEC     0
+#define VOSPI_XMIT_USEC       0
+
+// Uncomment to receive complete frames through a ring in a DDR carve-out (mapped from
+// /dev/mem) instead of rpmsg data messages.  PRU1 then only sends a short rpmsg
+// notification for each frame.  This must match the DDR_RING define PRU1 was built with.
+//#define VOSPI_DDR_RING
+
+// DDR ring message types (seq followed by a 32-bit little endian value in data[0-3])
+#define VOSPI_RING_INFO_MSG   0xFE   // Carve-out physical address
+#define VOSPI_RING_FRAME_MSG  0xFD   // Ring head after a frame was written
+#define VOSPI_RING_WAKE_MSG   0xFC   // Ring head when standby ended
+
+// DDR ring carve-out layout (frames follow the header)
+#define VOSPI_RING_MAGIC      0x4C455052
+#define VOSPI_RING_LEN        0x40000
+#define VOSPI_RING_HDR_LEN    64
+
+// PRU standby command (VOSPI_DDR_RING only, see vospi_set_standby()).  This must match
+// HOST_CMD_STANDBY in the firmware's pru_common.h.  It is sent while acquisition is
+// enabled.
+#define VOSPI_STANDBY_CMD     'S'
+#define VOSPI_STANDBY_CMD_LEN 8
+#define VOSPI_STANDBY_THRESHOLD 0x01  // Wake on pixels at or above a threshold
+#define VOSPI_STANDBY_CHANGE  0x02    // Wake on pixels that changed from the previous frame
+
+// Lepton telemetry location (leave both undefined to disable telemetry).  This
+// must match the TELEM_HEADER/TELEM_FOOTER define PRU0 was built with.  PRU0 does
+// not store the telemetry packets so frames are the same with any setting.
+//#define VOSPI_TELEM_HEADER
+//#define VOSPI_TELEM_FOOTER
 
 
 
@@ -24,15 +117,59 @@ typedef struct {
 	uint8_t data[VOSPI_MSG_DATA_BYTES];
 } vospi_rpmsg_t;
 
-// A single VoSPI frame
+// A single VoSPI frame (image messages followed by any statistics messages)
 typedef struct {
-	vospi_rpmsg_t msg[VOSPI_FRAME_NUM_MSGS];
+	vospi_rpmsg_t msg[VOSPI_FRAME_TOTAL_MSGS];
 } vospi_frame_t;
 
+// Frame pixel statistics (16-bit pixels are binned over the previous frame's range)
+typedef struct {
+	uint32_t num_pixels;  // VOSPI_FRAME_LEN for valid statistics
+	uint32_t sum;
+	uint16_t min;
+	uint16_t max;
+	uint16_t hist_base;   // Pixel value at the start of bin 0
+	uint16_t hist_shift;  // Each bin is (1 << hist_shift) pixel values wide
+	uint16_t hist[VOSPI_HIST_BINS];
+} vospi_stats_t;
+
+// DDR ring header (head and tail are free-running frame counts)
+typedef struct {
+	uint32_t magic;
+	uint32_t head;        // Frames written by PRU1
+	uint32_t tail;        // Frames consumed by us
+	uint32_t frame_len;
+	uint32_t num_frames;
+	uint32_t dropped;     // Times PRU0 had to wait for a free frame (ring full)
+	uint32_t wake_pixels; // Pixels of the last standby frame that tripped the triggers
+} vospi_ring_hdr_t;
+
+// PRU standby triggers (a frame trips them when at least min_pixels of its pixels are
+// at or above threshold or changed by at least delta from the previous frame)
+typedef struct {
+	uint8_t triggers;     // VOSPI_STANDBY_xxx bits, 0 to wake now
+	uint16_t threshold;
+	uint16_t delta;
+	uint16_t min_pixels;
+} vospi_standby_t;
+
 
 
+int vospi_set_timing(int fd, uint16_t sample_usec, uint16_t xmit_usec);
+#ifdef VOSPI_DDR_RING
+int vospi_set_standby(int fd, const vospi_standby_t* standby);
+uint32_t vospi_wake_pixels();
+#endif
 int sync_and_transfer_exp_msg(int fd, vospi_rpmsg_t* msg, uint8_t exp_seq);
 int sync_and_transfer_frame(int fd, vospi_frame_t* frame);
 void frame_to_pixel(vospi_frame_t* frame, uint8_t* pixbuf);
+#ifdef VOSPI_FRAME_STATS
+int frame_to_stats(vospi_frame_t* frame, vospi_stats_t* stats);
+#endif
+#ifdef VOSPI_16BIT
+void frame_to_pixel16(vospi_frame_t* frame, uint16_t* pixbuf);
+void pixel16_to_pixel(uint16_t* pix16buf, uint8_t* pixbuf);
+void pixel16_scale(uint16_t* pix16buf, uint8_t* pixbuf, uint16_t min, uint16_t max);
+#endif
 
 #endif /* VOSPI_H */
@@ -0,0 +1,292 @@
+#include "agc.h"
+
+#include <stdint.h>
+#include <string.h>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+#define AGC_NUM_PIXELS  (AGC_WIDTH * AGC_HEIGHT)
+#define AGC_TILE_W      (AGC_WIDTH / AGC_TILES_X)
+#define AGC_TILE_H      (AGC_HEIGHT / AGC_TILES_Y)
+
+
+/**
+ * Find the tile whose center is at or before each of n positions (tile size len) and
+ * the weight (1/256) of the following tile for bilinear interpolation
+ */
+static void init_interp(uint8_t* tile, uint8_t* w, int n, int len, int num_tiles)
+{
+	int i, f;
+
+	for (i=0; i<n; i++) {
+		// Position in tile units relative to the first tile's center (1/256)
+		f = ((2*i + 1) * 256) / (2*len) - 128;
+		if (f < 0) {
+			tile[i] = 0;
+			w[i] = 0;
+		} else if ((f >> 8) >= num_tiles-1) {
+			tile[i] = num_tiles - 1;
+			w[i] = 0;
+		} else {
+			tile[i] = f >> 8;
+			w[i] = f & 0xFF;
+		}
+	}
+}
+
+
+/**
+ * Bin pixels over the previous frame's range like PRU1's frame statistics
+ */
+static inline int get_bin(agc_t* agc, uint16_t p)
+{
+	int bin = (p > agc->base) ? ((p - agc->base) >> agc->shift) : 0;
+
+	return (bin >= AGC_HIST_BINS) ? AGC_HIST_BINS - 1 : bin;
+}
+
+
+/**
+ * Set the histogram range of the next frame from this frame's range
+ */
+static void set_range(agc_t* agc, uint16_t min, uint16_t max)
+{
+	uint16_t range;
+
+	if (max > min) {
+		agc->base = min;
+		range = max - min;
+		agc->shift = 0;
+		while ((range >> agc->shift) >= AGC_HIST_BINS) {
+			agc->shift++;
+		}
+	} else {
+		agc->base = 0;
+		agc->shift = 8;
+	}
+	agc->primed = 1;
+}
+
+
+/**
+ * Build the map for a histogram of total pixels (the histogram is clipped in place)
+ */
+static void build_map(agc_t* agc, uint16_t* hist, uint32_t total, uint8_t* map)
+{
+	uint32_t limit, add, rem;
+	uint32_t excess = 0;
+	uint32_t cdf = 0;
+	int i, lo, hi;
+
+	if (total == 0) {
+		for (i=0; i<AGC_HIST_BINS; i++) map[i] = i;
+		return;
+	}
+
+	if (agc->mode == AGC_MODE_LINEAR) {
+		for (lo=0; (lo < AGC_HIST_BINS-1) && (hist[lo] == 0); lo++) ;
+		for (hi=AGC_HIST_BINS-1; (hi > lo) && (hist[hi] == 0); hi--) ;
+		for (i=0; i<AGC_HIST_BINS; i++) {
+			if (i <= lo) {
+				map[i] = 0;
+			} else if (i >= hi) {
+				map[i] = 255;
+			} else {
+				map[i] = ((i - lo) * 255) / (hi - lo);
+			}
+		}
+		return;
+	}
+
+	// Clip and redistribute the excess evenly
+	if (agc->clip > 0) {
+		limit = (agc->clip * total) / AGC_HIST_BINS;
+		if (limit < 1) limit = 1;
+		for (i=0; i<AGC_HIST_BINS; i++) {
+			if (hist[i] > limit) {
+				excess += hist[i] - limit;
+				hist[i] = limit;
+			}
+		}
+		add = excess / AGC_HIST_BINS;
+		rem = excess % AGC_HIST_BINS;
+		for (i=0; i<AGC_HIST_BINS; i++) {
+			hist[i] += add + ((i < rem) ? 1 : 0);
+		}
+	}
+
+	// Map each bin to the middle of its part of the cumulative histogram
+	for (i=0; i<AGC_HIST_BINS; i++) {
+		map[i] = ((cdf + hist[i]/2) * 255) / total;
+		cdf += hist[i];
+	}
+}
+
+
+/**
+ * Map pixels through a single map
+ */
+static void apply_map(agc_t* agc, const uint16_t* pix16buf, uint8_t* pixbuf)
+{
+	const uint8_t* map = agc->map[0];
+	int i = 0;
+#ifdef __ARM_NEON
+	// 256 entry lookup as 8 32-byte table lookups, each only replacing the lanes
+	// whose index falls in its part of the table
+	uint8x8x4_t tbl[AGC_HIST_BINS / 32];
+	uint16x8_t vbase = vdupq_n_u16(agc->base);
+	int16x8_t vshift = vdupq_n_s16(-agc->shift);
+	uint16x8_t vmax = vdupq_n_u16(AGC_HIST_BINS - 1);
+	uint16x8_t v;
+	uint8x8_t idx, out;
+	int j, k;
+
+	for (k=0; k<AGC_HIST_BINS/32; k++) {
+		for (j=0; j<4; j++) {
+			tbl[k].val[j] = vld1_u8(map + k*32 + j*8);
+		}
+	}
+
+	for (; i<=AGC_NUM_PIXELS-8; i+=8) {
+		v = vld1q_u16(pix16buf + i);
+		v = vminq_u16(vshlq_u16(vqsubq_u16(v, vbase), vshift), vmax);
+		idx = vmovn_u16(v);
+		out = vtbl4_u8(tbl[0], idx);
+		for (k=1; k<AGC_HIST_BINS/32; k++) {
+			out = vtbx4_u8(out, tbl[k], vsub_u8(idx, vdup_n_u8(k*32)));
+		}
+		vst1_u8(pixbuf + i, out);
+	}
+#endif
+	for (; i<AGC_NUM_PIXELS; i++) {
+		pixbuf[i] = map[get_bin(agc, pix16buf[i])];
+	}
+}
+
+
+/**
+ * Map pixels bilinearly interpolating between the maps of the four nearest tiles
+ */
+static void apply_tile_maps(agc_t* agc, const uint16_t* pix16buf, uint8_t* pixbuf)
+{
+	const uint8_t* m0;
+	const uint8_t* m1;
+	const uint8_t* m2;
+	const uint8_t* m3;
+	uint32_t wx, wy, top, bot;
+	int x, y, t0, t1, b;
+
+	for (y=0; y<AGC_HEIGHT; y++) {
+		t0 = agc->row_tile[y] * AGC_TILES_X;
+		t1 = (agc->row_w[y] != 0) ? t0 + AGC_TILES_X : t0;
+		wy = agc->row_w[y];
+		for (x=0; x<AGC_WIDTH; x++) {
+			b = get_bin(agc, *pix16buf++);
+			wx = agc->col_w[x];
+			m0 = agc->map[t0 + agc->col_tile[x]];
+			m2 = agc->map[t1 + agc->col_tile[x]];
+			m1 = (wx != 0) ? m0 + AGC_HIST_BINS : m0;
+			m3 = (wx != 0) ? m2 + AGC_HIST_BINS : m2;
+
+			top = m0[b] * (256 - wx) + m1[b] * wx;
+			bot = m2[b] * (256 - wx) + m3[b] * wx;
+			*pixbuf++ = (top * (256 - wy) + bot * wy + 32768) >> 16;
+		}
+	}
+}
+
+
+
+/**
+ * Initialize the AGC for mode (AGC_MODE_xxx) with clip limit clip (0 for none)
+ */
+void agc_init(agc_t* agc, int mode, int clip)
+{
+	agc->mode = mode;
+	agc->clip = (clip < 0) ? 0 : clip;
+	agc->primed = 0;
+	agc->base = 0;
+	agc->shift = 8;
+
+	init_interp(agc->col_tile, agc->col_w, AGC_WIDTH, AGC_TILE_W, AGC_TILES_X);
+	init_interp(agc->row_tile, agc->row_w, AGC_HEIGHT, AGC_TILE_H, AGC_TILES_Y);
+}
+
+
+/**
+ * Map a 16-bit frame into an 8-bit pixel buffer, building the histogram (or tile
+ * histograms) and finding the frame's range in one pass
+ */
+void agc_map(agc_t* agc, const uint16_t* pix16buf, uint8_t* pixbuf)
+{
+	const uint16_t* pP;
+	uint16_t* hP;
+	uint16_t p;
+	uint16_t min = 0xFFFF;
+	uint16_t max = 0;
+	int i, x, y, t;
+
+	// The first frame sets its own range
+	if (!agc->primed) {
+		for (i=0; i<AGC_NUM_PIXELS; i++) {
+			if (pix16buf[i] < min) min = pix16buf[i];
+			if (pix16buf[i] > max) max = pix16buf[i];
+		}
+		set_range(agc, min, max);
+		min = 0xFFFF;
+		max = 0;
+	}
+
+	if (agc->mode == AGC_MODE_CLAHE) {
+		memset(agc->hist, 0, sizeof(agc->hist));
+		pP = pix16buf;
+		for (y=0; y<AGC_HEIGHT; y++) {
+			hP = agc->hist[(y / AGC_TILE_H) * AGC_TILES_X];
+			for (x=0; x<AGC_WIDTH; x++) {
+				p = *pP++;
+				if (p < min) min = p;
+				if (p > max) max = p;
+				hP[(x / AGC_TILE_W) * AGC_HIST_BINS + get_bin(agc, p)]++;
+			}
+		}
+		for (t=0; t<AGC_NUM_TILES; t++) {
+			build_map(agc, agc->hist[t], AGC_TILE_W * AGC_TILE_H, agc->map[t]);
+		}
+		apply_tile_maps(agc, pix16buf, pixbuf);
+	} else {
+		memset(agc->hist[0], 0, sizeof(agc->hist[0]));
+		hP = agc->hist[0];
+		for (i=0; i<AGC_NUM_PIXELS; i++) {
+			p = pix16buf[i];
+			if (p < min) min = p;
+			if (p > max) max = p;
+			hP[get_bin(agc, p)]++;
+		}
+		build_map(agc, hP, AGC_NUM_PIXELS, agc->map[0]);
+		apply_map(agc, pix16buf, pixbuf);
+	}
+
+	set_range(agc, min, max);
+}
+
+
+/**
+ * Map a 16-bit frame into an 8-bit pixel buffer using a histogram already built for
+ * it (PRU1's frame statistics) with AGC_HIST_BINS bins starting at base, each
+ * (1 << shift) pixel values wide.  CLAHE needs tile histograms so it builds its own.
+ */
+void agc_map_hist(agc_t* agc, const uint16_t* pix16buf, uint8_t* pixbuf, const uint16_t* hist,
+                  uint16_t base, uint16_t shift)
+{
+	if (agc->mode == AGC_MODE_CLAHE) {
+		agc_map(agc, pix16buf, pixbuf);
+		return;
+	}
+
+	agc->base = base;
+	agc->shift = shift;
+	memcpy(agc->hist[0], hist, sizeof(agc->hist[0]));
+	build_map(agc, agc->hist[0], AGC_NUM_PIXELS, agc->map[0]);
+	apply_map(agc, pix16buf, pixbuf);
+}
@@ -0,0 +1,202 @@
+/*
+ * Find the tightest stable PRU timing for this board.  For a series of PRU0 packet
+ * sample periods it binary searches for the shortest PRU1 message period that
+ * still delivers CAL_TEST_FRAMES consecutive frames without an abort or a missing
+ * message and then reports the timing (with some margin) to set in vospi.h.
+ *
+ * The Lepton must already be configured the way the application uses it (run the
+ * application once after power up) and no other program may be using the PRUs.
+ */
+#include "log.h"
+#include "vospi.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef VOSPI_DDR_RING
+#error "calibrate_timing requires the rpmsg transport"
+#endif
+
+// Consecutive good frames required (about 3 seconds)
+#define CAL_TEST_FRAMES  27
+
+// Maximum time to get them
+#define CAL_TEST_MSEC    10000
+
+// Sample period step and the message period search resolution
+#define CAL_SAMPLE_STEP  4
+#define CAL_XMIT_STEP    8
+
+// Margin added to the shortest stable message period
+#define CAL_MARGIN_PCT   10
+
+
+char pru_dev[] = "/dev/rpmsg_pru31";
+
+int pru_fd;
+
+
+
+/**
+ * Millisecond timestamp
+ */
+static int64_t time_ms()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+/**
+ * Stop acquisition and discard any messages waiting from the PRU
+ */
+static void stop_pru()
+{
+  vospi_rpmsg_t msg;
+
+  (void) write(pru_fd, "0", 2);
+  usleep(100000);
+  while (read(pru_fd, (uint8_t*) &msg, VOSPI_MSG_TOTAL_BYTES) > 0) {}
+}
+
+
+/**
+ * Run the PRUs with the specified timing.  Returns true if CAL_TEST_FRAMES consecutive
+ * frames were received without a failure once the first frame arrived.
+ */
+static int test_timing(int sample_usec, int xmit_usec)
+{
+  vospi_rpmsg_t msg;
+  struct pollfd pfd;
+  int64_t end_ms;
+  int exp_seq = 0;
+  int frames = 0;
+  int fails = 0;
+  int synced = 0;
+  int timeout;
+
+  stop_pru();
+  if (vospi_set_timing(pru_fd, sample_usec, xmit_usec) != 0) {
+    exit(-1);
+  }
+  if (write(pru_fd, "1", 2) == 0) {
+    log_fatal("PRU: Failed to enable");
+    exit(-1);
+  }
+
+  end_ms = time_ms() + CAL_TEST_MSEC;
+  pfd.fd = pru_fd;
+  pfd.events = POLLIN;
+  while ((frames < CAL_TEST_FRAMES) && (fails == 0)) {
+    timeout = (int) (end_ms - time_ms());
+    if ((timeout <= 0) || (poll(&pfd, 1, timeout) <= 0)) {
+      break;
+    }
+    if (read(pru_fd, (uint8_t*) &msg, VOSPI_MSG_TOTAL_BYTES) < 1) {
+      if (errno == EAGAIN) continue;
+      log_fatal("RPMSG: failed to transfer packet");
+      exit(-1);
+    }
+
+    if (msg.seq == exp_seq) {
+      if (++exp_seq == VOSPI_FRAME_TOTAL_MSGS) {
+        exp_seq = 0;
+        if (synced) {
+          frames++;
+        }
+        synced = 1;
+      }
+    } else {
+      // Abort or missing message (failures before the first frame are start up)
+      if (synced) {
+        log_debug("  fail: seq %d (expected %d) reason %d", msg.seq, exp_seq, msg.data[0]);
+        fails++;
+      }
+      exp_seq = (msg.seq == 0) ? 1 : 0;
+    }
+  }
+
+  log_info("  sample %d uSec, message %d uSec: %d frames, %d failures%s", sample_usec,
+           xmit_usec, frames, fails, (frames < CAL_TEST_FRAMES) && (fails == 0) ? " (timeout)" : "");
+
+  return ((frames == CAL_TEST_FRAMES) && (fails == 0));
+}
+
+
+/**
+ * Main entry point for the PRU timing calibration
+ */
+int main(int argc, char *argv[])
+{
+  int sample, lo, hi, mid;
+  int best_sample = VOSPI_SAMPLE_USEC_DEF;
+  int best_xmit = VOSPI_XMIT_USEC_DEF;
+  int xmit;
+
+  // Set the log level
+  log_set_level(LOG_INFO);
+
+  // Open the PRU SPI interface device
+  log_info("opening PRU ... %s", pru_dev);
+  if ((pru_fd = open(pru_dev, O_RDWR | O_NONBLOCK)) < 0) {
+    log_fatal("PRU: failed to open device - check permissions & firmware loaded");
+    exit(-1);
+  }
+
+  log_info("Checking the default timing");
+  if (!test_timing(best_sample, best_xmit)) {
+    log_fatal("Default timing is not stable - check the Lepton");
+    stop_pru();
+    exit(-1);
+  }
+
+  // Faster sampling lets PRU1 send faster, stop when it no longer helps
+  for (sample = VOSPI_SAMPLE_USEC_DEF; sample >= VOSPI_SAMPLE_USEC_MIN; sample -= CAL_SAMPLE_STEP) {
+    log_info("Searching message periods for a %d uSec sample period", sample);
+    hi = best_xmit;
+    if ((sample != VOSPI_SAMPLE_USEC_DEF) && !test_timing(sample, hi)) {
+      break;
+    }
+    lo = VOSPI_XMIT_USEC_MIN;
+    while ((hi - lo) > CAL_XMIT_STEP) {
+      mid = (lo + hi) / 2;
+      if (test_timing(sample, mid)) {
+        hi = mid;
+      } else {
+        lo = mid;
+      }
+    }
+
+    if ((sample != VOSPI_SAMPLE_USEC_DEF) && (hi >= best_xmit)) {
+      break;
+    }
+    best_sample = sample;
+    best_xmit = hi;
+  }
+
+  // Back off a little and make sure it is still good
+  xmit = best_xmit + (best_xmit * CAL_MARGIN_PCT) / 100;
+  if (xmit > VOSPI_XMIT_USEC_DEF) xmit = VOSPI_XMIT_USEC_DEF;
+  log_info("Verifying the timing with margin");
+  if (!test_timing(best_sample, xmit)) {
+    best_sample = VOSPI_SAMPLE_USEC_DEF;
+    xmit = VOSPI_XMIT_USEC_DEF;
+    log_info("Timing with margin failed - keep the defaults");
+  }
+  stop_pru();
+
+  log_info("Shortest stable message period: %d uSec at a %d uSec sample period", best_xmit, best_sample);
+  log_info("Set in vospi.h (frame transfer window %d mSec):", (VOSPI_FRAME_TOTAL_MSGS * xmit) / 1000);
+  log_info("  #define VOSPI_SAMPLE_USEC     %d", best_sample);
+  log_info("  #define VOSPI_XMIT_USEC       %d", xmit);
+
+  close(pru_fd);
+  return 0;
+}
@@ -1,15 +1,25 @@
 #include "log.h"
 #include "fb.h"
 #include "colormaps.h"
+#include "tcam_palettes.h"
 
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <linux/fb.h>
 #include <sys/mman.h>
 #include <sys/ioctl.h>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// Lepton image and (x2) display dimensions
+#define IMG_W 160
+#define IMG_H 120
+#define FB_W  (IMG_W * 2)
 
 int fbfd = 0;
 struct fb_var_screeninfo vinfo;
@@ -17,13 +27,53 @@ struct fb_fix_screeninfo finfo;
 char *fbp = 0;
 uint8_t* cmap_p = (uint8_t*) colormap_golden;
 
+// RGB565 values for the current colormap
+uint16_t cmap_lut[256];
+int cmap_lut_valid = 0;
+
+// One display line rendered in memory and then copied to the two frame buffer lines
+// it covers (frame buffer memory is slow to read back)
+uint16_t line_buf[FB_W];
+#ifdef FB_BILINEAR
+uint8_t interp_buf[IMG_W];
+#endif
+
+// Display pages.  With two pages (drivers that support panning) each frame is drawn
+// into the hidden page which is then panned to the display.  Otherwise frames are
+// drawn into an off-screen back buffer and copied to the display in one go.
+int fb_pages = 1;
+int fb_page = 0;
+int fb_vsync = 0;
+long int page_size = 0;
+char* back_buf = 0;
+
+// Mosaic tiles (see set_fb_tiles()).  Each tile is rendered into its own RGB565 buffer
+// and copied to each page it hasn't been copied to yet when the tiles are shown, so a
+// tile is only redrawn when it has a new frame.
+int num_tiles = 0;
+int tile_w, tile_h;
+int tile_x[FB_MAX_TILES];
+int tile_y[FB_MAX_TILES];
+int tile_dirty[FB_MAX_TILES];      // Pages the tile still has to be copied to
+uint16_t* tile_buf[FB_MAX_TILES];
+
+// Source column and row of each tile column and row and, with FB_BILINEAR, the weight
+// of the next column or row (0 - 128)
+uint8_t* tile_sx;
+uint8_t* tile_sy;
+uint8_t* tile_wx;
+uint8_t* tile_wy;
+#ifdef FB_BILINEAR
+uint8_t blend_buf[IMG_W];
+#endif
+
 
 /**
  * Initialize frame buffer
  */
 int init_fb(char* fb_path)
 {
-	long int screensize = 0;
+	uint32_t arg = 0;
 
 	// Open the file for reading and writing
 	fbfd = open(fb_path, O_RDWR);
@@ -48,11 +98,26 @@ int init_fb(char* fb_path)
 	log_info("FB: %dx%d, %dbpp, length %d, offsets: %d %d", vinfo.xres, vinfo.yres,
 		 vinfo.bits_per_pixel, finfo.line_length, vinfo.xoffset, vinfo.yoffset);
 
+	// Try to get a second page to flip to if the driver can pan
+	if ((finfo.ypanstep != 0) && (vinfo.yres_virtual < 2 * vinfo.yres)) {
+		vinfo.yres_virtual = 2 * vinfo.yres;
+		(void) ioctl(fbfd, FBIOPUT_VSCREENINFO, &vinfo);
+		(void) ioctl(fbfd, FBIOGET_VSCREENINFO, &vinfo);
+		(void) ioctl(fbfd, FBIOGET_FSCREENINFO, &finfo);
+	}
+	if ((finfo.ypanstep != 0) && (vinfo.yres_virtual >= 2 * vinfo.yres)) {
+		vinfo.yoffset = 0;
+		if (ioctl(fbfd, FBIOPAN_DISPLAY, &vinfo) == 0) {
+			fb_pages = 2;
+			fb_vsync = (ioctl(fbfd, FBIO_WAITFORVSYNC, &arg) == 0);
+		}
+	}
+
 	// Figure out the size of the screen in bytes
-	screensize = vinfo.xres * vinfo.yres * vinfo.bits_per_pixel / 8;
+	page_size = finfo.line_length * vinfo.yres;
 
 	// Map the device to memory
-	fbp = (char *)mmap(0, screensize, PROT_READ | PROT_WRITE, MAP_SHARED, fbfd, 0);
+	fbp = (char *)mmap(0, page_size * fb_pages, PROT_READ | PROT_WRITE, MAP_SHARED, fbfd, 0);
 	if ((int)fbp == -1) {
 		log_fatal("Error: failed to map framebuffer device to memory");
 	        exit(4);
@@ -60,42 +125,426 @@ int init_fb(char* fb_path)
 
 	log_info("Framebuffer device mapped to memory successfully.");
 
+	if (fb_pages == 2) {
+		log_info("Page flipping %s vsync", fb_vsync ? "with" : "without");
+	} else {
+		back_buf = malloc(page_size);
+		if (back_buf == NULL) {
+			log_fatal("Error: failed to allocate back buffer");
+			exit(5);
+		}
+		log_info("Drawing to a back buffer");
+	}
+
 	return(0);
 }
 
 
 /*
- * Draw the 8-bit data into the frame buffer (x2 in size)
+ * Build the RGB565 lookup table for the current colormap
  */
-void update_fb(uint8_t* pixbuf)
+static void build_lut()
+{
+	int i;
+	uint8_t* cP = cmap_p;
+
+	for (i=0; i<256; i++) {
+		cmap_lut[i] = (cP[0] / 8) << 11 | (cP[1] / 4) << 5 | (cP[2] / 8);
+		cP += 3;
+	}
+	cmap_lut_valid = 1;
+}
+
+
+#ifdef FB_BILINEAR
+/*
+ * Render one line of data into line_buf, interpolating between adjacent pixels
+ */
+static void render_line(uint8_t* bP)
+{
+	uint16_t* dP = line_buf;
+	int x;
+
+	for (x=0; x < IMG_W-1; x++) {
+		*dP++ = cmap_lut[bP[0]];
+		*dP++ = cmap_lut[(bP[0] + bP[1] + 1) >> 1];
+		bP++;
+	}
+	*dP++ = cmap_lut[*bP];
+	*dP = cmap_lut[*bP];
+}
+#else
+/*
+ * Render one line of data into line_buf, doubling each pixel
+ */
+static void render_line(uint8_t* bP)
+{
+	int x;
+#ifdef __ARM_NEON
+	uint16_t t[8];
+	uint16x8_t v;
+	uint16x8x2_t v2;
+	int i;
+
+	for (x=0; x < IMG_W; x=x+8) {
+		for (i=0; i<8; i++) {
+			t[i] = cmap_lut[*bP++];
+		}
+		v = vld1q_u16(t);
+		v2 = vzipq_u16(v, v);
+		vst1q_u16(&line_buf[x*2], v2.val[0]);
+		vst1q_u16(&line_buf[x*2 + 8], v2.val[1]);
+	}
+#else
+	uint32_t* dP = (uint32_t*) line_buf;
+	uint32_t t;
+
+	for (x=0; x < IMG_W; x++) {
+		t = cmap_lut[*bP++];
+		*dP++ = t | (t << 16);
+	}
+#endif
+}
+#endif
+
+
+/*
+ * Get the start of line y of the page (or back buffer) being drawn
+ */
+static char* draw_line_ptr(int y)
+{
+	if (fb_pages == 2) {
+		return fbp + (fb_page ^ 1) * page_size + y * finfo.line_length;
+	} else {
+		return back_buf + y * finfo.line_length;
+	}
+}
+
+
+#ifdef FB_BILINEAR
+/*
+ * Draw the second frame buffer line for row y of the 8-bit data in pixbuf (which
+ * must also contain row y+1 unless y is the last row)
+ */
+static void draw_second_line(uint8_t* pixbuf, int y)
 {
 	uint8_t* bP;
-	int x, y, offset;
-	uint16_t t;
+	uint8_t* nP;
+	int x;
+
+	// Halfway to the next line of data
+	bP = pixbuf + y * IMG_W;
+	nP = (y < IMG_H-1) ? bP + IMG_W : bP;
+	for (x=0; x < IMG_W; x++) {
+		interp_buf[x] = (bP[x] + nP[x] + 1) >> 1;
+	}
+	render_line(interp_buf);
+	memcpy(draw_line_ptr(y*2 + 1), line_buf, sizeof(line_buf));
+}
+#endif
 
-	for (y=0; y < 240; y=y+2) {
+
+/*
+ * Draw n rows of the 8-bit data starting at row y into the frame buffer (x2 in size)
+ * without displaying them.  pixbuf holds the whole frame and rows must be drawn in
+ * order.  With FB_BILINEAR the second line of the last row is drawn with the next
+ * rows since it needs the row after it.
+ */
+void draw_fb_rows(uint8_t* pixbuf, int y, int n)
+{
+	int last = y + n - 1;
+
+	if (!cmap_lut_valid) {
+		build_lut();
+	}
+
+#ifdef FB_BILINEAR
+	if (y > 0) {
+		draw_second_line(pixbuf, y - 1);
+	}
+#endif
+	for (; y <= last; y++) {
 		// Line 1
-		bP = pixbuf + y/2*160;
-		for (x = 0; x < 320; x=x+2) {
-			offset = (x * 2) + (y * finfo.line_length);
-			t = get_rgb_pixel(*bP++);
-			*((uint16_t*)(fbp + offset)) = t;
-			*((uint16_t*)(fbp + offset + 2)) = t;
-		}
+		render_line(pixbuf + y * IMG_W);
+		memcpy(draw_line_ptr(y*2), line_buf, sizeof(line_buf));
+
 		// Line 2
-		bP = pixbuf + y/2*160;
-		for (x = 0; x < 320; x=x+2) {
-			offset = (x * 2) + ((y+1) * finfo.line_length);
-			t = get_rgb_pixel(*bP++);
-			*((uint16_t*)(fbp + offset)) = t;
-			*((uint16_t*)(fbp + offset + 2)) = t;
+#ifdef FB_BILINEAR
+		if ((y < last) || (y == IMG_H-1)) {
+			draw_second_line(pixbuf, y);
+		}
+#else
+		memcpy(draw_line_ptr(y*2 + 1), line_buf, sizeof(line_buf));
+#endif
+	}
+}
+
+
+/*
+ * Show the page drawn into
+ */
+static void flip_page()
+{
+	uint32_t arg = 0;
+
+	fb_page ^= 1;
+	vinfo.yoffset = fb_page * vinfo.yres;
+	(void) ioctl(fbfd, FBIOPAN_DISPLAY, &vinfo);
+	if (fb_vsync) {
+		// Don't start drawing into the old page until it is no longer displayed
+		(void) ioctl(fbfd, FBIO_WAITFORVSYNC, &arg);
+	}
+}
+
+
+/*
+ * Display the rows drawn by draw_fb_rows()
+ */
+void show_fb()
+{
+	if (fb_pages == 2) {
+		flip_page();
+	} else {
+		memcpy(fbp, back_buf, IMG_H * 2 * finfo.line_length);
+	}
+}
+
+
+/*
+ * Fill a tile scaling table with the source position of each of n destination
+ * positions over src source positions, sampling at the centre of each destination
+ * position.  weights gets the weight of the next source position (0 - 128) for
+ * bilinear interpolation.
+ */
+static void init_tile_map(uint8_t* pos, uint8_t* weights, int n, int src)
+{
+	int i;
+	int f;
+
+	for (i=0; i<n; i++) {
+#ifdef FB_BILINEAR
+		// 7 fractional bits, clamped to the edges
+		f = (((2*i + 1) * src * 128) / (2*n)) - 64;
+		if (f < 0) f = 0;
+		if (f > (src - 1) * 128) f = (src - 1) * 128;
+		pos[i] = f >> 7;
+		weights[i] = f & 0x7F;
+#else
+		f = ((2*i + 1) * src) / (2*n);
+		pos[i] = f;
+		weights[i] = 0;
+#endif
+	}
+}
+
+
+/*
+ * Divide the display into a mosaic of n tiles (up to FB_MAX_TILES) in a grid as close
+ * to square as possible.  Each tile holds a 4:3 image as large as fits in its cell,
+ * scaled up or down from the Lepton frame.  The display is cleared.  Returns the
+ * number of tiles or -1 if they can't be set up.
+ */
+int set_fb_tiles(int n)
+{
+	int cols, rows;
+	int cell_w, cell_h;
+	int i;
+
+	if ((n < 1) || (n > FB_MAX_TILES)) {
+		log_error("Error: %d tiles (maximum %d)", n, FB_MAX_TILES);
+		return -1;
+	}
+
+	cols = 1;
+	while (cols * cols < n) cols++;
+	rows = (n + cols - 1) / cols;
+	cell_w = vinfo.xres / cols;
+	cell_h = vinfo.yres / rows;
+	tile_w = cell_w;
+	tile_h = (tile_w * 3) / 4;
+	if (tile_h > cell_h) {
+		tile_h = cell_h;
+		tile_w = (tile_h * 4) / 3;
+	}
+
+	tile_sx = malloc(tile_w);
+	tile_wx = malloc(tile_w);
+	tile_sy = malloc(tile_h);
+	tile_wy = malloc(tile_h);
+	if ((tile_sx == NULL) || (tile_wx == NULL) || (tile_sy == NULL) || (tile_wy == NULL)) {
+		log_error("Error: failed to allocate tile tables");
+		return -1;
+	}
+	init_tile_map(tile_sx, tile_wx, tile_w, IMG_W);
+	init_tile_map(tile_sy, tile_wy, tile_h, IMG_H);
+
+	for (i=0; i<n; i++) {
+		tile_buf[i] = calloc(tile_w * tile_h, sizeof(uint16_t));
+		if (tile_buf[i] == NULL) {
+			log_error("Error: failed to allocate tile %d", i);
+			return -1;
+		}
+		tile_x[i] = (i % cols) * cell_w + (cell_w - tile_w) / 2;
+		tile_y[i] = (i / cols) * cell_h + (cell_h - tile_h) / 2;
+		tile_dirty[i] = 0;
+	}
+	num_tiles = n;
+
+	if (!cmap_lut_valid) {
+		build_lut();
+	}
+	memset(fbp, 0, page_size * fb_pages);
+	log_info("Mosaic: %d tiles of %dx%d in %d columns", n, tile_w, tile_h, cols);
+
+	return n;
+}
+
+
+#ifdef FB_BILINEAR
+/*
+ * Blend two rows of the 8-bit data into blend_buf with weight w (0 - 128) for the
+ * second row
+ */
+static void blend_rows(uint8_t* aP, uint8_t* bP, int w)
+{
+	int x;
+#ifdef __ARM_NEON
+	uint8x8_t wa = vdup_n_u8(128 - w);
+	uint8x8_t wb = vdup_n_u8(w);
+	uint16x8_t s;
+
+	for (x=0; x < IMG_W; x=x+8) {
+		s = vmull_u8(vld1_u8(aP + x), wa);
+		s = vmlal_u8(s, vld1_u8(bP + x), wb);
+		vst1_u8(&blend_buf[x], vrshrn_n_u16(s, 7));
+	}
+#else
+	for (x=0; x < IMG_W; x++) {
+		blend_buf[x] = (aP[x] * (128 - w) + bP[x] * w + 64) >> 7;
+	}
+#endif
+}
+#endif
+
+
+/*
+ * Render one line of 8-bit data scaled to a tile line
+ */
+static void render_tile_line(uint8_t* bP, uint16_t* dP)
+{
+	int x;
+#ifdef FB_BILINEAR
+	int s, w;
+
+	for (x=0; x < tile_w; x++) {
+		s = tile_sx[x];
+		w = tile_wx[x];
+		if (w == 0) {
+			dP[x] = cmap_lut[bP[s]];
+		} else {
+			dP[x] = cmap_lut[(bP[s] * (128 - w) + bP[s+1] * w + 64) >> 7];
+		}
+	}
+#else
+	for (x=0; x < tile_w; x++) {
+		dP[x] = cmap_lut[bP[tile_sx[x]]];
+	}
+#endif
+}
+
+
+/*
+ * Draw the 8-bit data into a mosaic tile without displaying it
+ */
+void draw_fb_tile(int tile, uint8_t* pixbuf)
+{
+	uint16_t* dP;
+	uint8_t* sP;
+	int y;
+#ifndef FB_BILINEAR
+	int prev = -1;
+#endif
+
+	if ((tile < 0) || (tile >= num_tiles)) return;
+
+	dP = tile_buf[tile];
+	for (y=0; y < tile_h; y++) {
+		sP = pixbuf + tile_sy[y] * IMG_W;
+#ifdef FB_BILINEAR
+		// Blend rows with NEON before the columns are interpolated
+		if (tile_wy[y] != 0) {
+			blend_rows(sP, sP + IMG_W, tile_wy[y]);
+			sP = blend_buf;
+		}
+		render_tile_line(sP, dP);
+#else
+		// Repeated source rows are copied instead of rendered again
+		if (tile_sy[y] == prev) {
+			memcpy(dP, dP - tile_w, tile_w * sizeof(uint16_t));
+		} else {
+			render_tile_line(sP, dP);
 		}
+		prev = tile_sy[y];
+#endif
+		dP += tile_w;
 	}
+
+	tile_dirty[tile] = fb_pages;
+}
+
+
+/*
+ * Display the mosaic tiles drawn by draw_fb_tile() since the last call.  Only those
+ * tiles are copied to the frame buffer.
+ */
+void show_fb_tiles()
+{
+	char* pageP;
+	uint16_t* sP;
+	int drawn = 0;
+	int i, y;
+
+	// Tiles are copied straight to the display without page flipping
+	pageP = (fb_pages == 2) ? fbp + (fb_page ^ 1) * page_size : fbp;
+
+	for (i=0; i<num_tiles; i++) {
+		if (tile_dirty[i] == 0) continue;
+
+		sP = tile_buf[i];
+		for (y=0; y < tile_h; y++) {
+			memcpy(pageP + (tile_y[i] + y) * finfo.line_length + tile_x[i] * sizeof(uint16_t),
+			       sP, tile_w * sizeof(uint16_t));
+			sP += tile_w;
+		}
+		tile_dirty[i]--;
+		drawn = 1;
+	}
+
+	if (drawn && (fb_pages == 2)) {
+		flip_page();
+	}
+}
+
+
+/*
+ * Draw the 8-bit data into the frame buffer (x2 in size) and display it
+ */
+void update_fb(uint8_t* pixbuf)
+{
+	draw_fb_rows(pixbuf, 0, IMG_H);
+	show_fb();
 }
 
 
 void set_colormap(int n)
 {
+	// 4 and up are the tCam palettes, already in RGB565
+	if ((n >= 4) && (n < 4 + TCAM_NUM_PALETTES)) {
+		memcpy(cmap_lut, tcam_palettes[n - 4].rgb565, sizeof(cmap_lut));
+		cmap_lut_valid = 1;
+		return;
+	}
+
 	switch (n) {
 		case 0:
 			cmap_p = (uint8_t*) colormap_golden;
@@ -113,18 +562,14 @@ void set_colormap(int n)
 			cmap_p = (uint8_t*) colormap_golden;
 			break;
 	}
+	build_lut();
 }
 
 
 uint16_t get_rgb_pixel(uint8_t p)
 {
-	uint8_t r, g, b;
-	uint8_t* cP;
-
-	cP = cmap_p + p*3;
-	r = *(cP) / 8;
-	g = *(++cP) / 4;
-	b = *(++cP) / 8;
-	return r<<11 | g<<5 | b;
+	if (!cmap_lut_valid) {
+		build_lut();
+	}
+	return cmap_lut[p];
 }
-
@@ -0,0 +1,488 @@
+#include "jpeg.h"
+#include <stddef.h>
+#include <string.h>
+
+// Baseline JPEG encoder for palette mapped 8-bit images.  See jpeg.h for the layout.
+
+// Space reserved after the last MCU for the bit flush and EOI
+#define JPEG_TAIL_LEN 4
+
+// Worst case bytes for one MCU (4 blocks with every coefficient 0xFF stuffed)
+#define JPEG_MAX_MCU_LEN 1024
+
+
+
+// Code and length of each symbol of a Huffman table
+typedef struct {
+	uint16_t code[256];
+	uint8_t size[256];
+} huff_code_t;
+
+
+
+// Natural order index of each zigzag coefficient
+static const uint8_t zigzag[64] = {
+	 0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+	12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+	35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+	58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+// Annex K quantization tables (natural order)
+static const uint8_t std_luma_quant[64] = {
+	16,  11,  10,  16,  24,  40,  51,  61,
+	12,  12,  14,  19,  26,  58,  60,  55,
+	14,  13,  16,  24,  40,  57,  69,  56,
+	14,  17,  22,  29,  51,  87,  80,  62,
+	18,  22,  37,  56,  68, 109, 103,  77,
+	24,  35,  55,  64,  81, 104, 113,  92,
+	49,  64,  78,  87, 103, 121, 120, 101,
+	72,  92,  95,  98, 112, 100, 103,  99
+};
+
+static const uint8_t std_chroma_quant[64] = {
+	17,  18,  24,  47,  99,  99,  99,  99,
+	18,  21,  26,  66,  99,  99,  99,  99,
+	24,  26,  56,  99,  99,  99,  99,  99,
+	47,  66,  99,  99,  99,  99,  99,  99,
+	99,  99,  99,  99,  99,  99,  99,  99,
+	99,  99,  99,  99,  99,  99,  99,  99,
+	99,  99,  99,  99,  99,  99,  99,  99,
+	99,  99,  99,  99,  99,  99,  99,  99
+};
+
+// Annex K Huffman tables (code counts for lengths 1 - 16 followed by the symbols)
+static const uint8_t std_dc_luma_bits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+static const uint8_t std_dc_luma_vals[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+static const uint8_t std_dc_chroma_bits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+static const uint8_t std_dc_chroma_vals[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+static const uint8_t std_ac_luma_bits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7D};
+static const uint8_t std_ac_luma_vals[162] = {
+	0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+	0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xA1, 0x08, 0x23, 0x42, 0xB1, 0xC1, 0x15, 0x52, 0xD1, 0xF0,
+	0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0A, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2A, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+	0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+	0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+	0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7,
+	0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3, 0xC4, 0xC5,
+	0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xE1, 0xE2,
+	0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+	0xF9, 0xFA
+};
+
+static const uint8_t std_ac_chroma_bits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+static const uint8_t std_ac_chroma_vals[162] = {
+	0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+	0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xA1, 0xB1, 0xC1, 0x09, 0x23, 0x33, 0x52, 0xF0,
+	0x15, 0x62, 0x72, 0xD1, 0x0A, 0x16, 0x24, 0x34, 0xE1, 0x25, 0xF1, 0x17, 0x18, 0x19, 0x1A, 0x26,
+	0x27, 0x28, 0x29, 0x2A, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+	0x49, 0x4A, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+	0x69, 0x6A, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+	0x88, 0x89, 0x8A, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0xA2, 0xA3, 0xA4, 0xA5,
+	0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xC2, 0xC3,
+	0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA,
+	0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8,
+	0xF9, 0xFA
+};
+
+// AAN DCT output scale factors
+static const float aan_scale[8] = {
+	1.0f, 1.387039845f, 1.306562965f, 1.175875602f,
+	1.0f, 0.785694958f, 0.541196100f, 0.275899379f
+};
+
+// Generated tables
+static int huff_init = 0;
+static huff_code_t dc_luma_codes;
+static huff_code_t dc_chroma_codes;
+static huff_code_t ac_luma_codes;
+static huff_code_t ac_chroma_codes;
+
+static int table_quality = 0;
+static uint8_t luma_quant[64];
+static uint8_t chroma_quant[64];
+static float luma_fdtbl[64];
+static float chroma_fdtbl[64];
+
+// Palette converted to YCbCr for the current image
+static uint8_t ycc[256][3];
+
+// Output state
+static uint8_t* outP;
+static uint32_t bit_buf;
+static int bit_cnt;
+
+
+
+static void init_huff_codes(huff_code_t* h, const uint8_t* bits, const uint8_t* vals);
+static void init_quant_tables(int quality);
+static void init_ycc(const uint8_t* palette);
+static uint8_t* put_marker_len(uint8_t* p, uint8_t marker, int len);
+static uint8_t* put_header(uint8_t* p, int width, int height);
+static uint8_t* put_dht(uint8_t* p, int class_id, const uint8_t* bits, const uint8_t* vals, int nvals);
+static void fdct(float* d);
+static void encode_block(float* d, const float* fdtbl, int* last_dc, const huff_code_t* dc, const huff_code_t* ac);
+static inline void put_bits(uint32_t v, int n);
+static inline void put_value(int v, const huff_code_t* h, int sym_hi);
+static void flush_bits();
+
+
+
+/**
+ * Encode a width x height image of 8-bit palette indices (width and height multiples
+ * of JPEG_MCU_WIDTH and JPEG_MCU_HEIGHT) into out as a JPEG file using the 256 entry
+ * RGB palette.  Sets scan_offset to the offset of the entropy coded scan (the RTP/JPEG
+ * payload).  Returns the file length or 0 if it would be longer than max_len bytes.
+ */
+int jpeg_encode(const uint8_t* img, int width, int height, const uint8_t* palette, int quality, uint8_t* out, int max_len, int* scan_offset)
+{
+	const uint8_t* ip;
+	const uint8_t* c;
+	float y0[64], y1[64], cb[64], cr[64];
+	int last_dc[3];
+	int mx, my, x, y, i;
+	uint8_t* endP = out + max_len;
+
+	if (((width % JPEG_MCU_WIDTH) != 0) || ((height % JPEG_MCU_HEIGHT) != 0)) return 0;
+	if (max_len < (1024 + JPEG_TAIL_LEN)) return 0;
+
+	if (!huff_init) {
+		init_huff_codes(&dc_luma_codes, std_dc_luma_bits, std_dc_luma_vals);
+		init_huff_codes(&dc_chroma_codes, std_dc_chroma_bits, std_dc_chroma_vals);
+		init_huff_codes(&ac_luma_codes, std_ac_luma_bits, std_ac_luma_vals);
+		init_huff_codes(&ac_chroma_codes, std_ac_chroma_bits, std_ac_chroma_vals);
+		huff_init = 1;
+	}
+	if (quality < JPEG_MIN_QUALITY) quality = JPEG_MIN_QUALITY;
+	if (quality > JPEG_MAX_QUALITY) quality = JPEG_MAX_QUALITY;
+	if (quality != table_quality) {
+		init_quant_tables(quality);
+	}
+	init_ycc(palette);
+
+	outP = put_header(out, width, height);
+	*scan_offset = outP - out;
+	bit_buf = 0;
+	bit_cnt = 0;
+	for (i=0; i<3; i++) last_dc[i] = 0;
+
+	for (my=0; my<height; my+=JPEG_MCU_HEIGHT) {
+		for (mx=0; mx<width; mx+=JPEG_MCU_WIDTH) {
+			if ((endP - outP) < (JPEG_MAX_MCU_LEN + JPEG_TAIL_LEN)) return 0;
+
+			// Level shifted Y blocks and horizontally averaged chroma for one MCU
+			for (y=0; y<JPEG_MCU_HEIGHT; y++) {
+				ip = img + ((my + y) * width) + mx;
+				for (x=0; x<8; x++) {
+					y0[y*8 + x] = (float) ycc[ip[x]][0] - 128.0f;
+					y1[y*8 + x] = (float) ycc[ip[x+8]][0] - 128.0f;
+					c = ycc[ip[2*x]];
+					cb[y*8 + x] = (float) c[1];
+					cr[y*8 + x] = (float) c[2];
+					c = ycc[ip[2*x + 1]];
+					cb[y*8 + x] = (cb[y*8 + x] + (float) c[1]) * 0.5f - 128.0f;
+					cr[y*8 + x] = (cr[y*8 + x] + (float) c[2]) * 0.5f - 128.0f;
+				}
+			}
+
+			encode_block(y0, luma_fdtbl, &last_dc[0], &dc_luma_codes, &ac_luma_codes);
+			encode_block(y1, luma_fdtbl, &last_dc[0], &dc_luma_codes, &ac_luma_codes);
+			encode_block(cb, chroma_fdtbl, &last_dc[1], &dc_chroma_codes, &ac_chroma_codes);
+			encode_block(cr, chroma_fdtbl, &last_dc[2], &dc_chroma_codes, &ac_chroma_codes);
+		}
+	}
+
+	flush_bits();
+	*outP++ = 0xFF;
+	*outP++ = 0xD9;          // EOI
+
+	return (outP - out);
+}
+
+
+
+
+/**
+ * Generate the canonical code for each symbol of a table
+ */
+static void init_huff_codes(huff_code_t* h, const uint8_t* bits, const uint8_t* vals)
+{
+	int i, j;
+	int k = 0;
+	uint16_t code = 0;
+
+	memset(h->size, 0, sizeof(h->size));
+	for (i=0; i<16; i++) {
+		for (j=0; j<bits[i]; j++) {
+			h->code[vals[k]] = code++;
+			h->size[vals[k]] = i + 1;
+			k++;
+		}
+		code <<= 1;
+	}
+}
+
+
+/**
+ * Scale the Annex K tables as RFC 2435 Appendix A (and libjpeg) does so a receiver
+ * generates the same tables from Q
+ */
+static void init_quant_tables(int quality)
+{
+	int factor, i, u, v;
+	int32_t t;
+
+	factor = (quality < 50) ? (5000 / quality) : (200 - quality * 2);
+	for (i=0; i<64; i++) {
+		t = (std_luma_quant[i] * factor + 50) / 100;
+		luma_quant[i] = (t < 1) ? 1 : ((t > 255) ? 255 : t);
+		t = (std_chroma_quant[i] * factor + 50) / 100;
+		chroma_quant[i] = (t < 1) ? 1 : ((t > 255) ? 255 : t);
+	}
+
+	// Divisors with the AAN DCT scale folded in
+	for (u=0; u<8; u++) {
+		for (v=0; v<8; v++) {
+			i = u*8 + v;
+			luma_fdtbl[i] = 1.0f / ((float) luma_quant[i] * aan_scale[u] * aan_scale[v] * 8.0f);
+			chroma_fdtbl[i] = 1.0f / ((float) chroma_quant[i] * aan_scale[u] * aan_scale[v] * 8.0f);
+		}
+	}
+
+	table_quality = quality;
+}
+
+
+static void init_ycc(const uint8_t* palette)
+{
+	const uint8_t* p = palette;
+	float r, g, b, f;
+	int i;
+
+	for (i=0; i<256; i++) {
+		r = (float) *p++;
+		g = (float) *p++;
+		b = (float) *p++;
+		f = 0.299f*r + 0.587f*g + 0.114f*b;
+		ycc[i][0] = (uint8_t) (f + 0.5f);
+		f = -0.168736f*r - 0.331264f*g + 0.5f*b + 128.0f;
+		ycc[i][1] = (f > 255.0f) ? 255 : (uint8_t) (f + 0.5f);
+		f = 0.5f*r - 0.418688f*g - 0.081312f*b + 128.0f;
+		ycc[i][2] = (f > 255.0f) ? 255 : (uint8_t) (f + 0.5f);
+	}
+}
+
+
+static uint8_t* put_marker_len(uint8_t* p, uint8_t marker, int len)
+{
+	*p++ = 0xFF;
+	*p++ = marker;
+	*p++ = len >> 8;
+	*p++ = len & 0xFF;
+
+	return p;
+}
+
+
+static uint8_t* put_header(uint8_t* p, int width, int height)
+{
+	static const uint8_t jfif[14] = {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+	int i;
+
+	*p++ = 0xFF;
+	*p++ = 0xD8;             // SOI
+
+	p = put_marker_len(p, 0xE0, 2 + sizeof(jfif));
+	memcpy(p, jfif, sizeof(jfif));
+	p += sizeof(jfif);
+
+	// Both quantization tables in zigzag order
+	p = put_marker_len(p, 0xDB, 2 + 2*65);
+	*p++ = 0;
+	for (i=0; i<64; i++) *p++ = luma_quant[zigzag[i]];
+	*p++ = 1;
+	for (i=0; i<64; i++) *p++ = chroma_quant[zigzag[i]];
+
+	// Baseline frame: Y (2x1, table 0), Cb and Cr (1x1, table 1)
+	p = put_marker_len(p, 0xC0, 17);
+	*p++ = 8;
+	*p++ = height >> 8;
+	*p++ = height & 0xFF;
+	*p++ = width >> 8;
+	*p++ = width & 0xFF;
+	*p++ = 3;
+	*p++ = 1; *p++ = 0x21; *p++ = 0;
+	*p++ = 2; *p++ = 0x11; *p++ = 1;
+	*p++ = 3; *p++ = 0x11; *p++ = 1;
+
+	p = put_dht(p, 0x00, std_dc_luma_bits, std_dc_luma_vals, sizeof(std_dc_luma_vals));
+	p = put_dht(p, 0x10, std_ac_luma_bits, std_ac_luma_vals, sizeof(std_ac_luma_vals));
+	p = put_dht(p, 0x01, std_dc_chroma_bits, std_dc_chroma_vals, sizeof(std_dc_chroma_vals));
+	p = put_dht(p, 0x11, std_ac_chroma_bits, std_ac_chroma_vals, sizeof(std_ac_chroma_vals));
+
+	p = put_marker_len(p, 0xDA, 12);
+	*p++ = 3;
+	*p++ = 1; *p++ = 0x00;
+	*p++ = 2; *p++ = 0x11;
+	*p++ = 3; *p++ = 0x11;
+	*p++ = 0;                // Spectral selection 0 - 63
+	*p++ = 63;
+	*p++ = 0;
+
+	return p;
+}
+
+
+static uint8_t* put_dht(uint8_t* p, int class_id, const uint8_t* bits, const uint8_t* vals, int nvals)
+{
+	p = put_marker_len(p, 0xC4, 2 + 1 + 16 + nvals);
+	*p++ = class_id;
+	memcpy(p, bits, 16);
+	p += 16;
+	memcpy(p, vals, nvals);
+
+	return p + nvals;
+}
+
+
+/**
+ * Forward DCT (Arai, Agui and Nakajima) in place.  Outputs are scaled by aan_scale[u] *
+ * aan_scale[v] * 8, which the quantization divisors remove.
+ */
+static void fdct(float* d)
+{
+	float t0, t1, t2, t3, t4, t5, t6, t7;
+	float t10, t11, t12, t13;
+	float z1, z2, z3, z4, z5, z11, z13;
+	float* p;
+	int i, s;
+
+	// Rows then columns
+	for (s=0; s<2; s++) {
+		for (i=0; i<8; i++) {
+			p = (s == 0) ? &d[i*8] : &d[i];
+#define D(n) p[(s == 0) ? (n) : ((n)*8)]
+			t0 = D(0) + D(7);
+			t7 = D(0) - D(7);
+			t1 = D(1) + D(6);
+			t6 = D(1) - D(6);
+			t2 = D(2) + D(5);
+			t5 = D(2) - D(5);
+			t3 = D(3) + D(4);
+			t4 = D(3) - D(4);
+
+			t10 = t0 + t3;
+			t13 = t0 - t3;
+			t11 = t1 + t2;
+			t12 = t1 - t2;
+			D(0) = t10 + t11;
+			D(4) = t10 - t11;
+			z1 = (t12 + t13) * 0.707106781f;
+			D(2) = t13 + z1;
+			D(6) = t13 - z1;
+
+			t10 = t4 + t5;
+			t11 = t5 + t6;
+			t12 = t6 + t7;
+			z5 = (t10 - t12) * 0.382683433f;
+			z2 = 0.541196100f * t10 + z5;
+			z4 = 1.306562965f * t12 + z5;
+			z3 = t11 * 0.707106781f;
+			z11 = t7 + z3;
+			z13 = t7 - z3;
+			D(5) = z13 + z2;
+			D(3) = z13 - z2;
+			D(1) = z11 + z4;
+			D(7) = z11 - z4;
+#undef D
+		}
+	}
+}
+
+
+static void encode_block(float* d, const float* fdtbl, int* last_dc, const huff_code_t* dc, const huff_code_t* ac)
+{
+	int q[64];
+	int i, run, v;
+	float f;
+
+	fdct(d);
+	for (i=0; i<64; i++) {
+		f = d[zigzag[i]] * fdtbl[zigzag[i]];
+		q[i] = (int) ((f < 0.0f) ? (f - 0.5f) : (f + 0.5f));
+	}
+
+	// DC difference
+	v = q[0] - *last_dc;
+	*last_dc = q[0];
+	put_value(v, dc, 0);
+
+	// AC run lengths
+	run = 0;
+	for (i=1; i<64; i++) {
+		if (q[i] == 0) {
+			run++;
+		} else {
+			while (run > 15) {
+				put_bits(ac->code[0xF0], ac->size[0xF0]);
+				run -= 16;
+			}
+			put_value(q[i], ac, run);
+			run = 0;
+		}
+	}
+	if (run > 0) {
+		put_bits(ac->code[0x00], ac->size[0x00]);    // EOB
+	}
+}
+
+
+static inline void put_bits(uint32_t v, int n)
+{
+	uint8_t b;
+
+	bit_buf = (bit_buf << n) | (v & ((1 << n) - 1));
+	bit_cnt += n;
+	while (bit_cnt >= 8) {
+		bit_cnt -= 8;
+		b = (bit_buf >> bit_cnt) & 0xFF;
+		*outP++ = b;
+		if (b == 0xFF) *outP++ = 0;
+	}
+}
+
+
+/**
+ * Emit the code for symbol (sym_hi << 4 | magnitude category) followed by the
+ * magnitude bits of v
+ */
+static inline void put_value(int v, const huff_code_t* h, int sym_hi)
+{
+	int a = (v < 0) ? -v : v;
+	int n = 0;
+	int sym;
+
+	while (a != 0) {
+		n++;
+		a >>= 1;
+	}
+	sym = (sym_hi << 4) | n;
+	put_bits(h->code[sym], h->size[sym]);
+	if (n != 0) {
+		put_bits((v < 0) ? (v - 1) : v, n);
+	}
+}
+
+
+/**
+ * Pad the last byte with 1 bits
+ */
+static void flush_bits()
+{
+	if (bit_cnt > 0) {
+		put_bits(0x7F, 8 - bit_cnt);
+	}
+}
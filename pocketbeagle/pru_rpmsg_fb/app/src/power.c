@@ -0,0 +1,205 @@
+#include "log.h"
+#include "power.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+// Seconds between attempts to connect to bpd
+#define RECONNECT_SEC  5
+
+// Maximum telemetry line length
+#define MAX_LINE_LEN   64
+
+
+/* --------------- */
+/* Local Variables */
+/* --------------- */
+
+static const char* level_names[] = {"full", "reduced", "low", "standby"};
+
+
+
+/**
+ * Set the display backlight brightness (silently ignored when there is no pwm-backlight)
+ */
+static void set_backlight(int brightness)
+{
+	FILE* fp;
+
+	if ((fp = fopen(POWER_BACKLIGHT, "w")) != NULL) {
+		fprintf(fp, "%d\n", brightness);
+		fclose(fp);
+	}
+}
+
+
+/**
+ * Apply a level to the capture pipeline and backlight
+ */
+static void set_level(power_t* power, int level)
+{
+	if (level == power->level) {
+		return;
+	}
+	log_info("Power: %s (battery %d mV)", level_names[level], power->batt_mv);
+	power->level = level;
+
+	switch (level) {
+		case POWER_REDUCED:
+			prulepton_set_interval(power->lep, POWER_REDUCED_MSEC);
+			set_backlight(POWER_REDUCED_BL);
+			break;
+		case POWER_LOW:
+			prulepton_set_interval(power->lep, POWER_LOW_MSEC);
+			set_backlight(POWER_LOW_BL);
+			break;
+		case POWER_STANDBY:
+			prulepton_set_interval(power->lep, PRULEPTON_PAUSED);
+			set_backlight(0);
+			break;
+		default:
+			prulepton_set_interval(power->lep, PRULEPTON_ALL_FRAMES);
+			set_backlight(POWER_FULL_BL);
+	}
+}
+
+
+/**
+ * Pick the level for a battery voltage and status.  A battery level is only left
+ * for a higher one once the voltage is POWER_HYST_MV above the threshold.
+ */
+static int eval_level(power_t* power, int mv, unsigned int status)
+{
+	int hyst_low = (power->level >= POWER_LOW) ? POWER_HYST_MV : 0;
+	int hyst_standby = (power->level == POWER_STANDBY) ? POWER_HYST_MV : 0;
+
+	if (status & POWER_STATUS_USB_POWER) {
+		return POWER_FULL;
+	}
+	if ((status & POWER_STATUS_CRIT_BATT) || (mv < POWER_STANDBY_MV + hyst_standby)) {
+		return POWER_STANDBY;
+	}
+	if ((status & POWER_STATUS_LOW_BATT) || (mv < POWER_LOW_MV + hyst_low)) {
+		return POWER_LOW;
+	}
+	return POWER_REDUCED;
+}
+
+
+/**
+ * Handle one line from bpd.  Anything other than a telemetry frame is ignored.
+ */
+static void process_line(power_t* power, const char* line)
+{
+	float volts;
+	unsigned int status;
+
+	if (sscanf(line, "TLM %f %u", &volts, &status) == 2) {
+		power->batt_mv = (int) (volts * 1000 + 0.5);
+		set_level(power, eval_level(power, power->batt_mv, status));
+	}
+}
+
+
+/**
+ * Connect to bpd's telemetry port on this host.  Returns the socket or -1.
+ */
+static int connect_bpd(int port)
+{
+	struct sockaddr_in addr;
+	int fd;
+
+	if ((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+		return -1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(port);
+	if (connect(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+
+/**
+ * Policy thread: read telemetry lines from bpd, reconnecting (at full power) when the
+ * connection is lost
+ */
+static void* power_task(void* power_ptr)
+{
+	power_t* power = (power_t*) power_ptr;
+	char buf[256];
+	char line[MAX_LINE_LEN];
+	int line_len = 0;
+	int fd, i, n;
+	int logged = 0;
+
+	while (power->lep->running) {
+		if ((fd = connect_bpd(power->port)) < 0) {
+			if (!logged) {
+				log_info("Power: no telemetry from bpd on port %d - running at full power", power->port);
+				logged = 1;
+			}
+			sleep(RECONNECT_SEC);
+			continue;
+		}
+		log_info("Power: connected to bpd");
+		logged = 0;
+		line_len = 0;
+
+		while ((n = read(fd, buf, sizeof(buf))) > 0) {
+			for (i=0; i<n; i++) {
+				if (buf[i] == '\n') {
+					line[line_len] = 0;
+					process_line(power, line);
+					line_len = 0;
+				} else if (line_len < MAX_LINE_LEN-1) {
+					line[line_len++] = buf[i];
+				}
+			}
+		}
+		close(fd);
+
+		// Without telemetry we can't tell how the battery is doing
+		set_level(power, POWER_FULL);
+	}
+
+	return NULL;
+}
+
+
+
+/**
+ * Start the power policy for a running capture using telemetry from bpd on port.
+ * Starts at full power.  Returns 0 for success, -1 for failure.
+ */
+int power_start(power_t* power, prulepton_t* lep, int port)
+{
+	power->lep = lep;
+	power->port = port;
+	power->level = POWER_FULL;
+	power->batt_mv = 0;
+	set_backlight(POWER_FULL_BL);
+
+	if (pthread_create(&power->thread, NULL, power_task, power) != 0) {
+		log_error("Error creating power policy thread");
+		return -1;
+	}
+
+	return 0;
+}
+
+
+int power_get_level(power_t* power)
+{
+	return power->level;
+}
@@ -1,5 +1,5 @@
-#include "cci.h"
 #include "log.h"
+#include "prulepton.h"
 #include "vospi.h"
 #include <signal.h>
 #include <stdio.h>
@@ -7,161 +7,112 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
-#include <pthread.h>
-#include <semaphore.h>
 #include <assert.h>
 #include <string.h>
 #include <zmq.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
 
 // The default spec for the ZMQ socket that will be used for comms with the frontend
 #define ZMQ_DEFAULT_SOCKET_SPEC "tcp://*:5555"
 
-// The size of the circular frame buffer
-#define FRAME_BUF_SIZE 8
+// Uncomment to publish every frame as it arrives on a ZMQ_PUB socket (to any number
+// of subscribers, e.g. zmq_fb built with LEP_ZMQ_PUBSUB) instead of replying to
+// requests on a ZMQ_REP socket.  Each message starts with a 32-bit frame sequence
+// number so subscribers can detect frames they missed.
+//#define LEP_ZMQ_PUBSUB
+
+// Frames queued for a slow subscriber before new frames are dropped for it
+#define ZMQ_PUB_SNDHWM 2
+
+// Number of frame message buffers zmq may hold on to while it sends them
+#define ZMQ_MSG_BUFS 4
 
 /* ------------ */
 /* Device files */
 /* ------------ */
-char i2c_dev[] = "/dev/i2c-2";
-char pru_dev[] = "/dev/rpmsg_pru31";
+char i2c_dev[] = PRULEPTON_I2C_DEV;
+char pru_dev[] = PRULEPTON_PRU_DEV;
 
 
 /* --------------- */
 /* Local Variables */
 /* --------------- */
 
-// Positions of the reader and writer in the frame buffer
-int reader = 0, writer = 0;
-
-// semaphore tracking the number of frames available
-sem_t count_sem;
-
-// a lock protecting accesses to the frame buffer
-pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+// The PRU Lepton handle (frames are transferred into and sent from its ring in place)
+prulepton_t lep;
 
-// The frame buffer
-vospi_frame_t* frame_buf[FRAME_BUF_SIZE];
+// Frame message (the sequence number is only sent when publishing)
+typedef struct {
+  uint32_t seq;
+#ifdef VOSPI_16BIT
+  uint16_t pixbuf[VOSPI_FRAME_LEN];
+#else
+  uint8_t pixbuf[VOSPI_FRAME_LEN];
+#endif
+} frame_msg_t;
 
-// PRU file device for RPMsg
-//
-int pru_fd;
+// Message buffers frames are converted into and handed to zmq without being copied.
+// zmq frees a buffer through free_msg_buf() once it has been sent.
+frame_msg_t msg_bufs[ZMQ_MSG_BUFS];
+int msg_buf_busy[ZMQ_MSG_BUFS];
 
 
 
 /**
- * Attempt to configure the Lepton into AGC mode via the I2C interface
+ * zmq callback (from its I/O thread) returning a message buffer once it has been sent
  */
-int init_lepton()
+void free_msg_buf(void* data, void* hint)
 {
-  int fd;
-  uint32_t rsp;
-
-  // Open the I2C device
-  log_info("opening I2C device ... %s", i2c_dev);
-  if ((fd = open(i2c_dev, O_RDWR)) < 0) {
-    log_fatal("I2C: failed to open device - check permissions & i2c enabled");
-    return -1;
-  }
-
-  // Initialize I2C interface
-  cci_init(fd);
-  
-  // Perform a FFC to (re)initialize the sensor
-  /*
-  log_info("  Perform FFC");
-  cci_run_ffc(fd);
-  sleep(2);
-  */
-
-  // Configure Radiometry for TLinear disabled (to support AGC)
-  cci_set_radiometry_enable_state(fd, CCI_RADIOMETRY_ENABLED);
-  rsp = cci_get_radiometry_enable_state(fd);
-  log_info("  Radiometry = %d", rsp);
-  cci_set_radiometry_tlinear_enable_state(fd, CCI_RADIOMETRY_TLINEAR_DISABLED);
-  rsp = cci_get_radiometry_tlinear_enable_state(fd);
-  log_info("  Radiometry TLinear = %d", rsp);
-
-  // Enable AGC calculations
-  cci_set_agc_calc_enable_state(fd, CCI_AGC_ENABLED);
-  rsp = cci_get_agc_calc_enable_state(fd);
-  log_info("  AGC Calc En = %d", rsp);
-
-  // Enable AGC
-  cci_set_agc_enable_state(fd, CCI_AGC_ENABLED);
-  rsp = cci_get_agc_enable_state(fd);
-  log_info("  AGC = %d", rsp);
-
-  // Close up
-  close(fd);
-  return 0;
+  __atomic_store_n((int*) hint, 0, __ATOMIC_RELEASE);
 }
 
 
 /**
- * Read frames from the device into the circular buffer.
+ * Get a free message buffer, waiting for zmq to finish sending one if necessary
  */
-void* get_frames_from_device(void* prudev_path_ptr)
+int get_msg_buf()
 {
-    char* prudev_path = (char*)prudev_path_ptr;
-    int rsp;
-
-    // Declare a static frame to use as a scratch space to avoid locking the framebuffer while
-    // we're waiting for a new frame
-    vospi_frame_t frame;
-
-    // Open the PRU SPI interface device
-    log_info("opening PRU ... %s", prudev_path);
-    if ((pru_fd = open(prudev_path, O_RDWR)) < 0) {
-      log_fatal("PRU: failed to open device - check permissions & firmware loaded");
-      exit(-1);
-    }
-
-    // Enable the PRU
-    if (write(pru_fd, "1", 2) == 0) {
-        log_fatal("PRU: Failed to enable");
-        exit(-1);
-    }
-
-    // Receive frames forever
-    log_info("Starting VoSPI transfers");
-    do {
-
-      rsp = sync_and_transfer_frame(pru_fd, &frame);
-      if ((rsp == -1) || (rsp == 3)) {
-	      log_error("Failed to get frame with error %d", rsp);
-	      exit(-1);
-      } else if ((rsp == 1) || (rsp == 2)) {
-	      log_info("Transfer failed with reason %d", rsp);
+  int i, busy;
+
+  while (1) {
+    for (i=0; i<ZMQ_MSG_BUFS; i++) {
+      busy = 0;
+      if (__atomic_compare_exchange_n(&msg_buf_busy[i], &busy, 1, 0,
+                                      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        return i;
       }
-      else {
-          /* got frame */
-          pthread_mutex_lock(&lock);
+    }
+    usleep(1000);
+  }
+}
 
-          // Copy the newly-received frame into place
-          memcpy(frame_buf[writer], &frame, sizeof(vospi_frame_t));
 
-          // Move the writer ahead
-          writer = (writer + 1) & (FRAME_BUF_SIZE - 1);
+/**
+ * Send len bytes at data in message buffer n without copying them.  The buffer is
+ * freed when zmq is done with it.
+ */
+void send_msg_buf(void* socket, int n, void* data, size_t len, int flags)
+{
+  zmq_msg_t msg;
 
-          // Unlock and post the space semaphore
-          pthread_mutex_unlock(&lock);
-          sem_post(&count_sem);
-      }
-    } while (1);  // Forever
+  zmq_msg_init_data(&msg, data, len, free_msg_buf, &msg_buf_busy[n]);
+  if (zmq_msg_send(&msg, socket, flags) < 0) {
+    // Still ours, closing it frees the buffer
+    zmq_msg_close(&msg);
+  }
 }
 
 
 /**
  * Wait for reqests for frames on the ZMQ socket and respond with a frame each time.
  */
-void* send_frames_to_socket(void* socket_path_ptr)
+void send_frames_to_socket(char* socket_path)
 {
-    uint8_t pixbuf[VOSPI_FRAME_LEN];
+    frame_msg_t* msg;
+    vospi_frame_t* frame;
+    uint32_t seq;
+    int n;
 
     // Create the ZMQ context & socket
-    char* socket_path = (char*)socket_path_ptr;
     void* context = zmq_ctx_new();
     void* responder = zmq_socket(context, ZMQ_REP);
     if (zmq_bind(responder, socket_path) != 0) {
@@ -175,25 +126,80 @@ void* send_frames_to_socket(void* socket_path_ptr)
       char req_buf[10];
       zmq_recv(responder, req_buf, 10, 0);
 
-      // Wait if there are no new frames to transmit
-      sem_wait(&count_sem);
+      // Convert the oldest frame to pixels straight from the ring into a message
+      // buffer (trying again with the next one if it was overwritten while we
+      // converted it)
+      n = get_msg_buf();
+      msg = &msg_bufs[n];
+      do {
+        if ((frame = prulepton_wait_frame(&lep, &seq)) == NULL) {
+          // Capture stopped
+          return;
+        }
+#ifdef VOSPI_16BIT
+        frame_to_pixel16(frame, msg->pixbuf);
+#else
+        frame_to_pixel(frame, msg->pixbuf);
+#endif
+      } while (!prulepton_release_frame(&lep, seq));
+
+      // Send the pixels
+      send_msg_buf(responder, n, msg->pixbuf, sizeof(msg->pixbuf), 0);
+    }
+}
 
-      // Lock the data structure to prevent new frames being added while we're reading this one
-      pthread_mutex_lock(&lock);
 
-      // Copy the next frame out to our local buffer
-      frame_to_pixel(frame_buf[reader], pixbuf);
+#ifdef LEP_ZMQ_PUBSUB
+/**
+ * Publish each frame on the ZMQ socket as soon as it arrives.  The sequence number is
+ * the frame's ring sequence so frames dropped by the ring show up as gaps.
+ */
+void publish_frame(prulepton_t* lep, vospi_frame_t* frame, uint32_t seq, void* publisher)
+{
+    frame_msg_t* msg;
+    int n;
+
+    // Convert the frame to pixels straight from the ring into a message buffer
+    n = get_msg_buf();
+    msg = &msg_bufs[n];
+#ifdef VOSPI_16BIT
+    frame_to_pixel16(frame, msg->pixbuf);
+#else
+    frame_to_pixel(frame, msg->pixbuf);
+#endif
+    if (!prulepton_release_frame(lep, seq)) {
+      // Overwritten while we converted it
+      free_msg_buf(msg, &msg_buf_busy[n]);
+      return;
+    }
+
+    // Publish it (never blocks, subscribers over their high water mark miss it)
+    msg->seq = seq;
+    send_msg_buf(publisher, n, msg, sizeof(frame_msg_t), ZMQ_DONTWAIT);
+}
+
 
-      // Move the reader ahead
-      reader = (reader + 1) & (FRAME_BUF_SIZE - 1);
+/**
+ * Create the ZMQ_PUB socket and publish frames until capture stops
+ */
+void publish_frames_to_socket(char* socket_path)
+{
+    int hwm = ZMQ_PUB_SNDHWM;
 
-      // Unlock data structure
-      pthread_mutex_unlock(&lock);
+    // Create the ZMQ context & socket
+    void* context = zmq_ctx_new();
+    void* publisher = zmq_socket(context, ZMQ_PUB);
+    zmq_setsockopt(publisher, ZMQ_SNDHWM, &hwm, sizeof(hwm));
+    if (zmq_bind(publisher, socket_path) != 0) {
+      log_fatal("Failed to bind to socket: %s", zmq_strerror(errno));
+      exit(1);
+    }
 
-      // Send the message
-      zmq_send(responder, pixbuf, sizeof(pixbuf), 0);
+    if (prulepton_run(&lep, publish_frame, publisher)) {
+      exit(-1);
     }
 }
+#endif
 
 /*
  * SIGINT signal handler
@@ -201,7 +207,7 @@ void* send_frames_to_socket(void* socket_path_ptr)
 void sig_handler(int sig)
 {
 	// Try to shut down the PRUs before exiting
-	(void) write(pru_fd, "0", 2);
+	prulepton_stop(&lep);
 	log_info("Shutting down");
 	sleep(1); /* make sure command makes it to PRU */
 	exit(0);
@@ -213,43 +219,31 @@ void sig_handler(int sig)
  */
 int main(int argc, char *argv[])
 {
-  pthread_t get_frames_thread, send_frames_to_socket_thread;
+  prulepton_config_t config;
+  char* socket_path = argc > 1 ? argv[1] : ZMQ_DEFAULT_SOCKET_SPEC;
 
   // Set the log level
   log_set_level(LOG_INFO);
 
-  // Setup semaphores
-  sem_init(&count_sem, 0, 0);
-
-  // Allocate space to receive the frames in the circular buffer
-  log_info("Preallocating space for frames...");
-  for (int frame = 0; frame < FRAME_BUF_SIZE; frame ++) {
-    frame_buf[frame] = malloc(sizeof(vospi_frame_t));
-  }
-
   // Attempt to initialize the lepton
-  if (init_lepton()) {
+  if (prulepton_init_lepton(i2c_dev)) {
 	  exit(-1);
   }
 
   // Setup the signal handler
   signal(SIGINT, sig_handler);
 
-  log_info("Creating get_frames_from_device thread");
-  if (pthread_create(&get_frames_thread, NULL, get_frames_from_device, pru_dev)) {
-    log_fatal("Error creating get_frames_from_device thread");
-    return 1;
-  }
-
-  log_info("Creating send_frames_to_socket thread");
-  char* socket_path = argc > 1 ? argv[1] : ZMQ_DEFAULT_SOCKET_SPEC;
-  if (pthread_create(&send_frames_to_socket_thread, NULL, send_frames_to_socket, socket_path)) {
-    log_fatal("Error creating send_frames_to_socket thread");
-    return 1;
+  // Start capturing
+  prulepton_default_config(&config);
+  config.pru_dev = pru_dev;
+  if (prulepton_start(&lep, &config)) {
+    exit(-1);
   }
 
-
-  pthread_join(get_frames_thread, NULL);
-  pthread_join(send_frames_to_socket_thread, NULL);
+  // Serve frames from this thread
+#ifdef LEP_ZMQ_PUBSUB
+  publish_frames_to_socket(socket_path);
+#else
+  send_frames_to_socket(socket_path);
+#endif
 }
-
@@ -0,0 +1,401 @@
+#define _GNU_SOURCE
+#include "log.h"
+#include "prulepton.h"
+#include "vospi.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// Raw frame recorder.  Writes every frame to storage (e.g. the microSD card) in
+// container files that are preallocated with fallocate() and written with O_DIRECT
+// in REC_ALIGN sized blocks so the page cache never builds up dirty data that the
+// kernel then flushes in one long burst.  Frames are unpacked in the thread reading
+// the frame ring into a staging ring and a separate (normal priority) writer thread
+// writes runs of them, so a slow card only fills the staging ring and never stalls
+// the capture thread.  Frames that arrive while the staging ring is full are dropped
+// and counted.  The file header holds the index (the number of valid frames), which
+// is rewritten and synced every REC_INDEX_FRAMES frames rather than each frame.
+//
+// File layout (all little-endian):
+//   Header      REC_ALIGN bytes (rec_file_hdr_t followed by zeros)
+//   Records     rec_file_hdr_t.record_bytes each, a rec_frame_hdr_t followed by the
+//               frame's pixels (VOSPI_PIXEL_BYTES each, row order) and zeros
+// A file has room for a fixed number of frames, then the next file is started.  After
+// a power loss records past num_frames can be recovered by checking each record's
+// magic and index.
+
+// Block size the files are written in (a multiple of the card's logical block size)
+#define REC_ALIGN           4096
+
+// Frames buffered between the reading thread and the writer (about 7 seconds)
+#define REC_RING_FRAMES     64
+
+// Largest run of frames written with one pwrite()
+#define REC_MAX_WRITE_FRAMES 16
+
+// Frames between index updates (about 10 seconds)
+#define REC_INDEX_FRAMES    87
+
+// Default frames per file (about 10 minutes)
+#define REC_DEF_FILE_FRAMES 5220
+
+// Maximum path length
+#define MAX_PATH_LEN        256
+
+#define REC_FILE_MAGIC      0x4352464C
+#define REC_FRAME_MAGIC     0x4345524C
+#define REC_VERSION         1
+
+#define REC_RECORD_BYTES    (((sizeof(rec_frame_hdr_t) + VOSPI_FRAME_BYTES) + REC_ALIGN - 1) & ~(REC_ALIGN - 1))
+
+typedef struct {
+	uint32_t magic;          // REC_FILE_MAGIC
+	uint32_t version;
+	uint16_t width;
+	uint16_t height;
+	uint16_t pixel_bytes;
+	uint16_t reserved;
+	uint32_t header_bytes;   // Offset of the first record
+	uint32_t record_bytes;
+	uint32_t capacity;       // Frames the file was preallocated for
+	uint32_t num_frames;     // Valid frames (the index)
+	uint32_t dropped;        // Frames dropped since recording started
+	int64_t first_usec;      // CLOCK_REALTIME of the first and last valid frames
+	int64_t last_usec;
+} rec_file_hdr_t;
+
+typedef struct {
+	uint32_t magic;          // REC_FRAME_MAGIC
+	uint32_t index;          // Frame number in the file
+	uint32_t seq;            // Frame ring sequence number (gaps are dropped frames)
+	uint32_t reserved;
+	int64_t realtime_usec;   // CLOCK_REALTIME when the frame was read
+	int64_t monotonic_usec;  // CLOCK_MONOTONIC when the frame was read
+} rec_frame_hdr_t;
+
+
+/* ------------ */
+/* Device files */
+/* ------------ */
+char i2c_dev[] = PRULEPTON_I2C_DEV;
+char pru_dev[] = PRULEPTON_PRU_DEV;
+
+
+/* --------------- */
+/* Local Variables */
+/* --------------- */
+
+prulepton_t lep;
+
+// Staging ring (REC_RING_FRAMES records, head and tail are free-running counts)
+uint8_t* ring_buf;
+uint32_t ring_head;
+uint32_t ring_tail;
+uint32_t ring_dropped;
+int ring_done;
+sem_t ring_sem;
+
+// Writer state
+char* rec_dir;
+char rec_stamp[32];
+uint32_t rec_file_frames;
+rec_file_hdr_t* file_hdr;   // REC_ALIGN aligned block
+int file_fd = -1;
+int file_num;
+uint32_t total_frames;
+uint32_t max_write_msec;
+
+
+
+int64_t get_usec(clockid_t clk)
+{
+	struct timespec ts;
+
+	clock_gettime(clk, &ts);
+	return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+/**
+ * Write the file header (the index) and sync the file.  Returns 0 for success, -1 for
+ * failure.
+ */
+int write_index()
+{
+	if (pwrite(file_fd, file_hdr, REC_ALIGN, 0) != REC_ALIGN) {
+		log_error("REC: failed to write the index (%s)", strerror(errno));
+		return -1;
+	}
+	if (fdatasync(file_fd) != 0) {
+		log_error("REC: failed to sync (%s)", strerror(errno));
+		return -1;
+	}
+	log_info("REC: %u frames, %u dropped, longest write %u mSec", total_frames,
+	         file_hdr->dropped, max_write_msec);
+	return 0;
+}
+
+
+/**
+ * Finish the current file, trimming any unused preallocated space
+ */
+void close_file()
+{
+	if (file_fd < 0) {
+		return;
+	}
+
+	(void) write_index();
+	if (file_hdr->num_frames < file_hdr->capacity) {
+		(void) ftruncate(file_fd, REC_ALIGN + (off_t) file_hdr->num_frames * REC_RECORD_BYTES);
+	}
+	close(file_fd);
+	file_fd = -1;
+}
+
+
+/**
+ * Create and preallocate the next file.  Returns 0 for success, -1 for failure.
+ */
+int open_file()
+{
+	char path[MAX_PATH_LEN];
+	off_t len = REC_ALIGN + (off_t) rec_file_frames * REC_RECORD_BYTES;
+	int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+	snprintf(path, sizeof(path), "%s/rec_%s_%03d.lrf", rec_dir, rec_stamp, file_num++);
+	if ((file_fd = open(path, flags | O_DIRECT, 0644)) < 0) {
+		// Not all filesystems support O_DIRECT
+		if ((file_fd = open(path, flags, 0644)) < 0) {
+			log_error("REC: could not create %s (%s)", path, strerror(errno));
+			return -1;
+		}
+		log_warn("REC: O_DIRECT not supported for %s, using buffered writes", path);
+	}
+
+	// Allocate the whole file now so writes never wait for block allocation
+	if (fallocate(file_fd, 0, 0, len) != 0) {
+		log_warn("REC: could not preallocate %s (%s)", path, strerror(errno));
+	}
+
+	memset(file_hdr, 0, REC_ALIGN);
+	file_hdr->magic = REC_FILE_MAGIC;
+	file_hdr->version = REC_VERSION;
+	file_hdr->width = 160;
+	file_hdr->height = 120;
+	file_hdr->pixel_bytes = VOSPI_PIXEL_BYTES;
+	file_hdr->header_bytes = REC_ALIGN;
+	file_hdr->record_bytes = REC_RECORD_BYTES;
+	file_hdr->capacity = rec_file_frames;
+	file_hdr->dropped = __atomic_load_n(&ring_dropped, __ATOMIC_RELAXED);
+	if (write_index()) {
+		close(file_fd);
+		file_fd = -1;
+		return -1;
+	}
+
+	log_info("REC: recording to %s", path);
+	return 0;
+}
+
+
+/**
+ * Writer thread: write runs of staged frames to the current file until the reading
+ * thread is done and the ring is empty
+ */
+void* writer_thread(void* arg)
+{
+	rec_frame_hdr_t* rec;
+	uint32_t head, n, i, slot;
+	int64_t t;
+	ssize_t len;
+	int done;
+
+	while (1) {
+		sem_wait(&ring_sem);
+		done = __atomic_load_n(&ring_done, __ATOMIC_ACQUIRE);
+		head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+
+		while (ring_tail != head) {
+			if ((file_fd < 0) && open_file()) {
+				// Storage failed, discard the frames
+				__atomic_store_n(&ring_tail, head, __ATOMIC_RELEASE);
+				break;
+			}
+
+			// One run: contiguous in the ring and in the file
+			slot = ring_tail % REC_RING_FRAMES;
+			n = head - ring_tail;
+			if (n > REC_RING_FRAMES - slot) n = REC_RING_FRAMES - slot;
+			if (n > file_hdr->capacity - file_hdr->num_frames) n = file_hdr->capacity - file_hdr->num_frames;
+			if (n > REC_MAX_WRITE_FRAMES) n = REC_MAX_WRITE_FRAMES;
+
+			for (i=0; i<n; i++) {
+				rec = (rec_frame_hdr_t*) &ring_buf[(slot + i) * REC_RECORD_BYTES];
+				rec->index = file_hdr->num_frames + i;
+			}
+
+			t = get_usec(CLOCK_MONOTONIC);
+			len = pwrite(file_fd, &ring_buf[slot * REC_RECORD_BYTES], n * REC_RECORD_BYTES,
+			             REC_ALIGN + (off_t) file_hdr->num_frames * REC_RECORD_BYTES);
+			t = (get_usec(CLOCK_MONOTONIC) - t) / 1000;
+			if (t > max_write_msec) {
+				max_write_msec = t;
+			}
+			if (len != n * REC_RECORD_BYTES) {
+				log_error("REC: write failed (%s)", (len < 0) ? strerror(errno) : "short write");
+				close_file();
+				__atomic_store_n(&ring_tail, head, __ATOMIC_RELEASE);
+				break;
+			}
+
+			// Update the index the next write_index() stores
+			rec = (rec_frame_hdr_t*) &ring_buf[slot * REC_RECORD_BYTES];
+			if (file_hdr->num_frames == 0) {
+				file_hdr->first_usec = rec->realtime_usec;
+			}
+			rec = (rec_frame_hdr_t*) &ring_buf[(slot + n - 1) * REC_RECORD_BYTES];
+			file_hdr->last_usec = rec->realtime_usec;
+			file_hdr->num_frames += n;
+			file_hdr->dropped = __atomic_load_n(&ring_dropped, __ATOMIC_RELAXED);
+			total_frames += n;
+			__atomic_store_n(&ring_tail, ring_tail + n, __ATOMIC_RELEASE);
+
+			if (file_hdr->num_frames == file_hdr->capacity) {
+				close_file();
+			} else if ((total_frames % REC_INDEX_FRAMES) < n) {
+				(void) write_index();
+			}
+		}
+
+		if (done) {
+			break;
+		}
+	}
+
+	close_file();
+	return NULL;
+}
+
+
+/**
+ * Unpack a frame into the next staging slot.  Returns 0 if it was staged, -1 if the
+ * ring is full or the frame was overwritten while it was unpacked.
+ */
+int stage_frame(vospi_frame_t* frame, uint32_t seq)
+{
+	rec_frame_hdr_t* rec;
+	uint32_t tail = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+
+	if ((ring_head - tail) >= REC_RING_FRAMES) {
+		(void) prulepton_release_frame(&lep, seq);
+		return -1;
+	}
+
+	rec = (rec_frame_hdr_t*) &ring_buf[(ring_head % REC_RING_FRAMES) * REC_RECORD_BYTES];
+	rec->magic = REC_FRAME_MAGIC;
+	rec->seq = seq;
+	rec->realtime_usec = get_usec(CLOCK_REALTIME);
+	rec->monotonic_usec = get_usec(CLOCK_MONOTONIC);
+#ifdef VOSPI_16BIT
+	frame_to_pixel16(frame, (uint16_t*) (rec + 1));
+#else
+	frame_to_pixel(frame, (uint8_t*) (rec + 1));
+#endif
+	if (!prulepton_release_frame(&lep, seq)) {
+		return -1;
+	}
+
+	__atomic_store_n(&ring_head, ring_head + 1, __ATOMIC_RELEASE);
+	sem_post(&ring_sem);
+	return 0;
+}
+
+
+/*
+ * SIGINT signal handler - stop capture so the recording is finished
+ */
+void sig_handler(int sig)
+{
+	prulepton_stop(&lep);
+}
+
+
+/**
+ * Main entry point.  Optional arguments: the output directory (default "."), the
+ * frames per file (default REC_DEF_FILE_FRAMES) and the number of frames to record
+ * (default 0, until SIGINT or SIGTERM).
+ */
+int main(int argc, char *argv[])
+{
+	prulepton_config_t config;
+	vospi_frame_t* frame;
+	pthread_t writer;
+	uint32_t seq;
+	time_t now;
+	int file_frames = (argc > 2) ? atoi(argv[2]) : REC_DEF_FILE_FRAMES;
+	int max_frames = (argc > 3) ? atoi(argv[3]) : 0;
+	int n = 0;
+
+	rec_dir = (argc > 1) ? argv[1] : ".";
+	rec_file_frames = (file_frames > 0) ? file_frames : REC_DEF_FILE_FRAMES;
+
+	log_set_level(LOG_INFO);
+
+	// O_DIRECT buffers must be aligned
+	if (posix_memalign((void**) &ring_buf, REC_ALIGN, REC_RING_FRAMES * REC_RECORD_BYTES) ||
+	    posix_memalign((void**) &file_hdr, REC_ALIGN, REC_ALIGN)) {
+		log_fatal("REC: could not allocate buffers");
+		exit(-1);
+	}
+	memset(ring_buf, 0, REC_RING_FRAMES * REC_RECORD_BYTES);
+	sem_init(&ring_sem, 0, 0);
+
+	// Name the files by the wall clock time recording started
+	now = time(NULL);
+	strftime(rec_stamp, sizeof(rec_stamp), "%Y%m%d_%H%M%S", localtime(&now));
+
+	if (prulepton_init_lepton(i2c_dev)) {
+		exit(-1);
+	}
+
+	signal(SIGINT, sig_handler);
+	signal(SIGTERM, sig_handler);
+
+	if (pthread_create(&writer, NULL, writer_thread, NULL)) {
+		log_fatal("REC: could not start the writer thread");
+		exit(-1);
+	}
+
+	prulepton_default_config(&config);
+	config.pru_dev = pru_dev;
+	if (prulepton_start(&lep, &config)) {
+		exit(-1);
+	}
+
+	while (((max_frames == 0) || (n < max_frames)) && ((frame = prulepton_wait_frame(&lep, &seq)) != NULL)) {
+		if (stage_frame(frame, seq) == 0) {
+			n++;
+		} else {
+			__atomic_add_fetch(&ring_dropped, 1, __ATOMIC_RELAXED);
+		}
+	}
+	prulepton_stop(&lep);
+
+	// Let the writer finish the ring and the file
+	__atomic_store_n(&ring_done, 1, __ATOMIC_RELEASE);
+	sem_post(&ring_sem);
+	pthread_join(writer, NULL);
+
+	log_info("REC: recorded %u frames, dropped %u", total_frames, ring_dropped);
+	return 0;
+}
@@ -0,0 +1,912 @@
+#include "colormaps.h"
+#include "tcam_palettes.h"
+#include "jpeg.h"
+#include "log.h"
+#include "prulepton.h"
+#include "vospi.h"
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <linux/sockios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+// RTSP server for video players and video management systems.  Each frame is
+// converted through a colormap into a JPEG image (encoded once for all clients) and
+// sent to each playing client as RFC 2435 RTP/JPEG packets over UDP or interleaved on
+// the RTSP connection.  The first packet of each image carries an RFC 8285 one-byte
+// header extension with the image's radiometric scaling (the same as tCam-Mini RTP
+// streams, all values big-endian):
+//   ID 1 (8 bytes): uint16_t lo, hi pixel values mapped to colormap index 0 and 255,
+//                   uint16_t min, max image pixel values
+//   ID 2 (2 bytes): uint16_t radiometric resolution (pixel * res = K * 100, 0 for 8-bit
+//                   AGC frames)
+// The stream is rtsp://<address>:8554/ (any path is accepted).
+//
+// An HTTP GET of http://<address>:8554/metrics on the same port returns the capture
+// and streaming counters and the JPEG encode time histogram in the OpenMetrics text
+// format (the names used for tCam-Mini by tcam_metrics.py) for Prometheus.
+
+#define RTSP_DEFAULT_PORT   8554
+#define RTSP_MAX_CLIENTS    4
+#define RTSP_MAX_REQ_LEN    2048
+#define RTSP_MAX_RSP_LEN    1024
+#define RTSP_MAX_URL_LEN    256
+#define RTSP_SESSION_TIMEOUT 60
+
+// Server UDP ports (RTP and the RTCP port we don't read), 0 to let the kernel choose
+#define RTP_SERVER_PORT     6970
+
+#define RTP_VERSION         2
+#define RTP_PT_JPEG         26
+#define RTP_CLOCK_HZ        90000
+#define RTP_HEADER_LEN      12
+#define RTP_JPEG_HDR_LEN    8
+#define RTP_EXT_LEN         16
+#define RTP_EXT_ID_RANGE    1
+#define RTP_EXT_ID_RES      2
+
+// RTP packet size (fits a 1500 byte Ethernet MTU with the IP, UDP or interleaved headers)
+#define RTP_MAX_PKT_LEN     1400
+
+// Frame rate for the SDP (the Lepton's 8.7 fps)
+#define RTSP_FRAMERATE      "8.7"
+
+// /metrics response length and the encode time histogram buckets (the tCam-Mini
+// get_perf_stats buckets)
+#define METRICS_MAX_LEN     4096
+#define METRICS_BUCKETS     8
+
+// Client states
+#define RTSP_STATE_INIT     0
+#define RTSP_STATE_READY    1
+#define RTSP_STATE_PLAYING  2
+
+typedef struct {
+	int fd;                          // RTSP connection, -1 if the slot is free
+	int state;
+	char rx_buf[RTSP_MAX_REQ_LEN+1];
+	int rx_len;
+	uint32_t session;
+	int interleaved;                 // RTP interleaved on the connection
+	int rtp_channel;
+	struct sockaddr_in rtp_dest;     // UDP destination
+	uint16_t rtp_seq;
+	uint32_t rtp_ssrc;
+} rtsp_client_t;
+
+typedef struct {
+	uint32_t images_encoded;
+	uint32_t images_sent;            // Images sent to clients (one per playing client)
+	uint32_t images_skipped;         // Images an interleaved client couldn't take
+	uint32_t requests;
+	uint64_t encode_usec;
+	uint32_t encode_hist[METRICS_BUCKETS];
+} rtsp_metrics_t;
+
+
+/* ------------ */
+/* Device files */
+/* ------------ */
+char i2c_dev[] = PRULEPTON_I2C_DEV;
+char pru_dev[] = PRULEPTON_PRU_DEV;
+
+
+/* --------------- */
+/* Local Variables */
+/* --------------- */
+
+// The PRU Lepton handle
+prulepton_t lep;
+
+rtsp_client_t clients[RTSP_MAX_CLIENTS];
+int listen_fd = -1;
+int rtp_fd = -1;
+int rtcp_fd = -1;
+uint16_t rtp_port;
+
+// 256 entry colormap the images are encoded with
+uint8_t palette[256*3];
+
+// Frame pixels and its JPEG image
+uint8_t pixbuf[VOSPI_FRAME_LEN];
+#ifdef VOSPI_16BIT
+uint16_t pix16buf[VOSPI_FRAME_LEN];
+#endif
+uint8_t jpeg_buf[JPEG_MAX_LEN];
+uint8_t pkt_buf[4 + RTP_MAX_PKT_LEN];
+
+rtsp_metrics_t metrics;
+const uint32_t metrics_bounds[METRICS_BUCKETS - 1] = {64, 256, 1024, 4096, 16384, 65536, 262144};
+const char http_not_found[] = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+
+
+/**
+ * Copy colormap n (the same numbers as pru_rpmsg_fb) into the 256 entry palette.
+ * colormap_golden only has 255 entries so its last entry is repeated.
+ */
+static void load_palette(int n)
+{
+	const uint8_t* cmap;
+	int len = 256;
+	int i;
+
+	if ((n >= 4) && (n < 4 + TCAM_NUM_PALETTES)) {
+		for (i=0; i<256; i++) {
+			palette[i*3]     = tcam_palettes[n - 4].rgba32[i] >> 16;
+			palette[i*3 + 1] = tcam_palettes[n - 4].rgba32[i] >> 8;
+			palette[i*3 + 2] = tcam_palettes[n - 4].rgba32[i];
+		}
+		return;
+	}
+
+	switch (n) {
+		case 1:
+			cmap = colormap_rainbow;
+			break;
+		case 2:
+			cmap = colormap_grayscale;
+			break;
+		case 3:
+			cmap = colormap_ironblack;
+			break;
+		default:
+			cmap = (const uint8_t*) colormap_golden;
+			len = sizeof(colormap_golden) / 3;
+			break;
+	}
+
+	memcpy(palette, cmap, len*3);
+	for (; len<256; len++) {
+		memcpy(&palette[len*3], &palette[(len-1)*3], 3);
+	}
+}
+
+
+static uint8_t* put_be16(uint8_t* p, uint16_t v)
+{
+	*p++ = v >> 8;
+	*p++ = v & 0xFF;
+
+	return p;
+}
+
+
+static uint8_t* put_be32(uint8_t* p, uint32_t v)
+{
+	p = put_be16(p, v >> 16);
+	return put_be16(p, v & 0xFFFF);
+}
+
+
+/**
+ * Open a TCP listening socket or a bound UDP socket on port (0 for any port)
+ */
+static int open_socket(int type, uint16_t port)
+{
+	int fd, opt = 1;
+	struct sockaddr_in addr;
+
+	fd = socket(AF_INET, type, 0);
+	if (fd < 0) return -1;
+	setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	addr.sin_port = htons(port);
+	if (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+	if ((type == SOCK_STREAM) && (listen(fd, RTSP_MAX_CLIENTS) < 0)) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+
+/**
+ * Open the RTP and RTCP UDP sockets on a pair of adjacent ports
+ */
+static int open_rtp_sockets()
+{
+	struct sockaddr_in addr;
+	socklen_t len = sizeof(addr);
+	uint16_t port;
+
+	for (port=RTP_SERVER_PORT; port<RTP_SERVER_PORT+100; port+=2) {
+		if ((rtp_fd = open_socket(SOCK_DGRAM, port)) < 0) continue;
+		if ((rtcp_fd = open_socket(SOCK_DGRAM, port + 1)) >= 0) break;
+		close(rtp_fd);
+		rtp_fd = -1;
+	}
+	if (rtp_fd < 0) return -1;
+
+	getsockname(rtp_fd, (struct sockaddr*) &addr, &len);
+	rtp_port = ntohs(addr.sin_port);
+
+	return 0;
+}
+
+
+static void close_client(rtsp_client_t* c)
+{
+	if (c->fd >= 0) {
+		log_info("RTSP client %d closed", (int) (c - clients));
+		close(c->fd);
+	}
+	c->fd = -1;
+	c->state = RTSP_STATE_INIT;
+	c->rx_len = 0;
+}
+
+
+static void accept_client()
+{
+	int i, fd, opt = 1;
+	struct sockaddr_in addr;
+	socklen_t len = sizeof(addr);
+
+	fd = accept(listen_fd, (struct sockaddr*) &addr, &len);
+	if (fd < 0) return;
+
+	for (i=0; i<RTSP_MAX_CLIENTS; i++) {
+		if (clients[i].fd < 0) break;
+	}
+	if (i == RTSP_MAX_CLIENTS) {
+		log_warn("RTSP connection from %s refused: too many clients", inet_ntoa(addr.sin_addr));
+		close(fd);
+		return;
+	}
+
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+	clients[i].fd = fd;
+	clients[i].state = RTSP_STATE_INIT;
+	clients[i].rx_len = 0;
+	clients[i].session = (uint32_t) random();
+	clients[i].interleaved = 0;
+	log_info("RTSP client %d connected from %s", i, inet_ntoa(addr.sin_addr));
+}
+
+
+/**
+ * Copy the value of a request header into val.  Returns 0 if it isn't included.
+ */
+static int get_header(const char* req, const char* name, char* val, int val_len)
+{
+	const char* p = req;
+	const char* e;
+	int n = strlen(name);
+
+	while ((p = strstr(p, "\r\n")) != NULL) {
+		p += 2;
+		if ((strncasecmp(p, name, n) == 0) && (p[n] == ':')) {
+			p += n + 1;
+			while (*p == ' ') p++;
+			e = p;
+			while ((*e != '\r') && (*e != 0)) e++;
+			if ((e - p) >= val_len) return 0;
+			memcpy(val, p, e - p);
+			val[e - p] = 0;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+/**
+ * Send a response with the request's CSeq, extra headers (each ending with \r\n) and
+ * an optional body
+ */
+static void send_response(rtsp_client_t* c, int status, const char* reason, const char* cseq, const char* headers, const char* body)
+{
+	char rsp[RTSP_MAX_RSP_LEN];
+	int n;
+
+	n = snprintf(rsp, sizeof(rsp), "RTSP/1.0 %d %s\r\nCSeq: %s\r\nServer: pru_rtsp\r\n%s",
+	             status, reason, cseq, headers);
+	if (body != NULL) {
+		n += snprintf(rsp + n, sizeof(rsp) - n, "Content-Length: %d\r\n\r\n%s", (int) strlen(body), body);
+	} else {
+		n += snprintf(rsp + n, sizeof(rsp) - n, "\r\n");
+	}
+	if (n >= (int) sizeof(rsp)) n = sizeof(rsp) - 1;
+
+	if (send(c->fd, rsp, n, MSG_NOSIGNAL) != n) {
+		close_client(c);
+	}
+}
+
+
+static void handle_describe(rtsp_client_t* c, const char* url, const char* cseq)
+{
+	char hdrs[RTSP_MAX_URL_LEN + 64];
+	char sdp[RTSP_MAX_RSP_LEN / 2];
+	char ip[INET_ADDRSTRLEN] = "0.0.0.0";
+	struct sockaddr_in addr;
+	socklen_t len = sizeof(addr);
+
+	if (getsockname(c->fd, (struct sockaddr*) &addr, &len) == 0) {
+		inet_ntop(AF_INET, &addr.sin_addr, ip, sizeof(ip));
+	}
+
+	snprintf(sdp, sizeof(sdp), "v=0\r\n"
+	         "o=- %u 1 IN IP4 %s\r\n"
+	         "s=PocketBeagle Lepton\r\n"
+	         "c=IN IP4 0.0.0.0\r\n"
+	         "t=0 0\r\n"
+	         "a=control:*\r\n"
+	         "m=video 0 RTP/AVP %d\r\n"
+	         "a=rtpmap:%d JPEG/%d\r\n"
+	         "a=framerate:" RTSP_FRAMERATE "\r\n"
+	         "a=extmap:%d urn:tcam:radiometric-range\r\n"
+	         "a=extmap:%d urn:tcam:radiometric-resolution\r\n"
+	         "a=control:track1\r\n",
+	         c->session, ip, RTP_PT_JPEG, RTP_PT_JPEG, RTP_CLOCK_HZ, RTP_EXT_ID_RANGE, RTP_EXT_ID_RES);
+	snprintf(hdrs, sizeof(hdrs), "Content-Base: %s/\r\nContent-Type: application/sdp\r\n", url);
+	send_response(c, 200, "OK", cseq, hdrs, sdp);
+}
+
+
+/**
+ * Setup the client's transport: interleaved on the connection or unicast UDP to its
+ * client_port
+ */
+static void handle_setup(rtsp_client_t* c, const char* req, const char* cseq)
+{
+	char transport[128];
+	char hdrs[256];
+	char* p;
+	int ch0, ch1, port0, port1;
+	socklen_t len = sizeof(c->rtp_dest);
+
+	if (!get_header(req, "Transport", transport, sizeof(transport))) {
+		send_response(c, 400, "Bad Request", cseq, "", NULL);
+		return;
+	}
+
+	if (strstr(transport, "RTP/AVP/TCP") != NULL) {
+		ch0 = 0;
+		ch1 = 1;
+		if ((p = strstr(transport, "interleaved=")) != NULL) {
+			if (sscanf(p, "interleaved=%d-%d", &ch0, &ch1) < 1) ch0 = 0;
+			ch1 = ch0 + 1;
+		}
+		c->interleaved = 1;
+		c->rtp_channel = ch0;
+		snprintf(hdrs, sizeof(hdrs), "Transport: RTP/AVP/TCP;unicast;interleaved=%d-%d\r\n"
+		         "Session: %08X;timeout=%d\r\n", ch0, ch1, c->session, RTSP_SESSION_TIMEOUT);
+	} else if (((p = strstr(transport, "client_port=")) != NULL) && (strstr(transport, "multicast") == NULL) &&
+	           (rtp_fd >= 0)) {
+		if (sscanf(p, "client_port=%d-%d", &port0, &port1) < 2) port1 = port0 + 1;
+		if (getpeername(c->fd, (struct sockaddr*) &c->rtp_dest, &len) != 0) {
+			send_response(c, 500, "Internal Server Error", cseq, "", NULL);
+			return;
+		}
+		c->rtp_dest.sin_port = htons(port0);
+		c->interleaved = 0;
+		snprintf(hdrs, sizeof(hdrs), "Transport: RTP/AVP;unicast;client_port=%d-%d;server_port=%d-%d\r\n"
+		         "Session: %08X;timeout=%d\r\n", port0, port1, rtp_port, rtp_port + 1, c->session,
+		         RTSP_SESSION_TIMEOUT);
+	} else {
+		send_response(c, 461, "Unsupported Transport", cseq, "", NULL);
+		return;
+	}
+
+	c->rtp_seq = (uint16_t) random();
+	c->rtp_ssrc = (uint32_t) random();
+	c->state = RTSP_STATE_READY;
+	send_response(c, 200, "OK", cseq, hdrs, NULL);
+}
+
+
+static uint64_t get_usec()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+static uint32_t rtp_timestamp()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t) (((uint64_t) ts.tv_sec * RTP_CLOCK_HZ) + ((uint64_t) ts.tv_nsec * RTP_CLOCK_HZ / 1000000000));
+}
+
+
+/**
+ * Append to the metrics text, stopping at the end of the buffer
+ */
+static void put_metrics(char* buf, int* n, const char* fmt, ...)
+{
+	va_list ap;
+	int len;
+
+	if (*n >= METRICS_MAX_LEN - 1) return;
+	va_start(ap, fmt);
+	len = vsnprintf(buf + *n, METRICS_MAX_LEN - *n, fmt, ap);
+	va_end(ap);
+	*n = (len < 0) ? *n : ((*n + len >= METRICS_MAX_LEN) ? METRICS_MAX_LEN - 1 : *n + len);
+}
+
+
+static void put_counter(char* buf, int* n, const char* name, const char* help, const char* cam, uint64_t v)
+{
+	put_metrics(buf, n, "# TYPE %s counter\n# HELP %s %s\n%s_total{camera=\"%s\"} %llu\n",
+	            name, name, help, name, cam, (unsigned long long) v);
+}
+
+
+/**
+ * Answer an HTTP GET /metrics with the OpenMetrics text of the counters and close the
+ * connection.  The camera label is the host name.
+ */
+static void handle_metrics(rtsp_client_t* c)
+{
+	char body[METRICS_MAX_LEN];
+	char hdr[192];
+	char cam[64];
+	int i, n = 0, hn, clients_open = 0, clients_playing = 0;
+	uint32_t count = 0;
+
+	if (gethostname(cam, sizeof(cam)) != 0) strcpy(cam, "pru_rtsp");
+	cam[sizeof(cam) - 1] = 0;
+	for (i=0; i<RTSP_MAX_CLIENTS; i++) {
+		if (clients[i].fd < 0) continue;
+		clients_open++;
+		if (clients[i].state == RTSP_STATE_PLAYING) clients_playing++;
+	}
+
+	put_counter(body, &n, "tcam_frames", "Frames captured from the Lepton", cam, lep.ring.head);
+	put_counter(body, &n, "tcam_frames_dropped", "Frames overwritten in the ring before they were taken", cam, lep.ring.dropped);
+	put_counter(body, &n, "tcam_resyncs", "Frame transfers that failed and resynchronized", cam, lep.resyncs);
+	put_counter(body, &n, "tcam_recoveries", "Capture failures recovered from by restarting the PRUs or the Lepton", cam, lep.recoveries);
+	put_counter(body, &n, "tcam_lepton_reboots", "Lepton reboots by capture recovery", cam, lep.reboots);
+	put_counter(body, &n, "tcam_images_encoded", "Images encoded", cam, metrics.images_encoded);
+	put_counter(body, &n, "tcam_images_sent", "Images sent", cam, metrics.images_sent);
+	put_counter(body, &n, "tcam_frames_skipped", "Images not sent because the connection was busy", cam, metrics.images_skipped);
+	put_counter(body, &n, "tcam_metrics_requests", "Metrics requests", cam, ++metrics.requests);
+
+	put_metrics(body, &n, "# TYPE tcam_stage_seconds histogram\n# UNIT tcam_stage_seconds seconds\n"
+	            "# HELP tcam_stage_seconds Time taken by each stage of the pipeline\n");
+	for (i=0; i<METRICS_BUCKETS; i++) {
+		count += metrics.encode_hist[i];
+		if (i < METRICS_BUCKETS - 1) {
+			put_metrics(body, &n, "tcam_stage_seconds_bucket{camera=\"%s\",stage=\"jpeg_encode\",le=\"%g\"} %u\n",
+			            cam, metrics_bounds[i] / 1e6, count);
+		} else {
+			put_metrics(body, &n, "tcam_stage_seconds_bucket{camera=\"%s\",stage=\"jpeg_encode\",le=\"+Inf\"} %u\n",
+			            cam, count);
+		}
+	}
+	put_metrics(body, &n, "tcam_stage_seconds_count{camera=\"%s\",stage=\"jpeg_encode\"} %u\n", cam, count);
+	put_metrics(body, &n, "tcam_stage_seconds_sum{camera=\"%s\",stage=\"jpeg_encode\"} %.6f\n", cam,
+	            metrics.encode_usec / 1e6);
+
+	put_metrics(body, &n, "# TYPE tcam_rtsp_clients gauge\n# HELP tcam_rtsp_clients Connected RTSP clients\n"
+	            "tcam_rtsp_clients{camera=\"%s\"} %d\n", cam, clients_open - 1);  // Not this connection
+	put_metrics(body, &n, "# TYPE tcam_rtsp_clients_playing gauge\n# HELP tcam_rtsp_clients_playing Playing RTSP clients\n"
+	            "tcam_rtsp_clients_playing{camera=\"%s\"} %d\n", cam, clients_playing);
+	put_metrics(body, &n, "# EOF\n");
+
+	hn = snprintf(hdr, sizeof(hdr), "HTTP/1.1 200 OK\r\nContent-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+	              "Content-Length: %d\r\nConnection: close\r\n\r\n", n);
+	if (send(c->fd, hdr, hn, MSG_NOSIGNAL) == hn) {
+		(void) send(c->fd, body, n, MSG_NOSIGNAL);
+	}
+	close_client(c);
+}
+
+
+static void handle_request(rtsp_client_t* c, char* req)
+{
+	char cseq[16] = "0";
+	char url[RTSP_MAX_URL_LEN];
+	char method[16];
+	char hdrs[RTSP_MAX_URL_LEN + 96];
+
+	if (sscanf(req, "%15s %255s", method, url) != 2) {
+		send_response(c, 400, "Bad Request", cseq, "", NULL);
+		return;
+	}
+	get_header(req, "CSeq", cseq, sizeof(cseq));
+	log_debug("RTSP client %d: %s %s", (int) (c - clients), method, url);
+
+	if (strcmp(method, "GET") == 0) {
+		// HTTP metrics scrape on the RTSP port
+		if (strncmp(url, "/metrics", 8) == 0) {
+			handle_metrics(c);
+		} else {
+			(void) send(c->fd, http_not_found, strlen(http_not_found), MSG_NOSIGNAL);
+			close_client(c);
+		}
+		return;
+	}
+
+	if (strcmp(method, "OPTIONS") == 0) {
+		send_response(c, 200, "OK", cseq, "Public: OPTIONS, DESCRIBE, SETUP, PLAY, PAUSE, TEARDOWN, GET_PARAMETER\r\n", NULL);
+	} else if (strcmp(method, "DESCRIBE") == 0) {
+		handle_describe(c, url, cseq);
+	} else if (strcmp(method, "SETUP") == 0) {
+		handle_setup(c, req, cseq);
+	} else if ((strcmp(method, "PLAY") == 0) && (c->state != RTSP_STATE_INIT)) {
+		c->state = RTSP_STATE_PLAYING;
+		snprintf(hdrs, sizeof(hdrs), "Session: %08X\r\nRange: npt=0.000-\r\nRTP-Info: url=%s;seq=%u;rtptime=%u\r\n",
+		         c->session, url, c->rtp_seq, rtp_timestamp());
+		send_response(c, 200, "OK", cseq, hdrs, NULL);
+	} else if ((strcmp(method, "PAUSE") == 0) && (c->state != RTSP_STATE_INIT)) {
+		c->state = RTSP_STATE_READY;
+		snprintf(hdrs, sizeof(hdrs), "Session: %08X\r\n", c->session);
+		send_response(c, 200, "OK", cseq, hdrs, NULL);
+	} else if (strcmp(method, "TEARDOWN") == 0) {
+		snprintf(hdrs, sizeof(hdrs), "Session: %08X\r\n", c->session);
+		send_response(c, 200, "OK", cseq, hdrs, NULL);
+		close_client(c);
+	} else if (strcmp(method, "GET_PARAMETER") == 0) {
+		// Keep-alive
+		snprintf(hdrs, sizeof(hdrs), "Session: %08X\r\n", c->session);
+		send_response(c, 200, "OK", cseq, hdrs, NULL);
+	} else if ((strcmp(method, "PLAY") == 0) || (strcmp(method, "PAUSE") == 0)) {
+		send_response(c, 455, "Method Not Valid in This State", cseq, "", NULL);
+	} else {
+		send_response(c, 501, "Not Implemented", cseq, "", NULL);
+	}
+}
+
+
+/**
+ * Read from a client's connection and handle each complete request.  Interleaved
+ * packets from the client (RTCP reports) and request bodies are skipped.
+ */
+static void read_client(rtsp_client_t* c)
+{
+	char* end;
+	char clen[16];
+	int n, len;
+
+	n = recv(c->fd, c->rx_buf + c->rx_len, RTSP_MAX_REQ_LEN - c->rx_len, 0);
+	if (n <= 0) {
+		close_client(c);
+		return;
+	}
+	c->rx_len += n;
+
+	while ((c->fd >= 0) && (c->rx_len > 0)) {
+		if (c->rx_buf[0] == '$') {
+			// Interleaved packet: '$', channel, 16-bit length
+			if (c->rx_len < 4) break;
+			len = 4 + ((uint8_t) c->rx_buf[2] << 8) + (uint8_t) c->rx_buf[3];
+			if (len > RTSP_MAX_REQ_LEN) {
+				close_client(c);
+				return;
+			}
+		} else {
+			c->rx_buf[c->rx_len] = 0;
+			if ((end = strstr(c->rx_buf, "\r\n\r\n")) == NULL) {
+				if (c->rx_len == RTSP_MAX_REQ_LEN) {
+					log_warn("RTSP client %d request too long", (int) (c - clients));
+					close_client(c);
+				}
+				return;
+			}
+			len = end + 4 - c->rx_buf;
+			if (get_header(c->rx_buf, "Content-Length", clen, sizeof(clen))) {
+				len += atoi(clen);
+				if ((len > RTSP_MAX_REQ_LEN) || (atoi(clen) < 0)) {
+					close_client(c);
+					return;
+				}
+			}
+			if (c->rx_len < len) break;
+			*end = 0;
+			handle_request(c, c->rx_buf);
+			if (c->fd < 0) return;
+		}
+		if (c->rx_len < len) break;
+
+		memmove(c->rx_buf, c->rx_buf + len, c->rx_len - len);
+		c->rx_len -= len;
+	}
+}
+
+
+/**
+ * True if an interleaved client's connection can take len more bytes without
+ * blocking (a client that can't keep up skips frames instead of stalling the others)
+ */
+static int tcp_room(rtsp_client_t* c, int len)
+{
+	int queued, sndbuf;
+	socklen_t optlen = sizeof(sndbuf);
+
+	if (ioctl(c->fd, SIOCOUTQ, &queued) < 0) return 0;
+	if (getsockopt(c->fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, &optlen) < 0) return 0;
+
+	return ((sndbuf / 2 - queued) >= len);
+}
+
+
+/**
+ * Send the scan of the JPEG image to a client as RTP/JPEG packets
+ */
+static void send_image(rtsp_client_t* c, int jpeg_len, int scan_offset, uint16_t* ext, uint32_t ts)
+{
+	int first = 1;
+	int len, n, max_n, pre;
+	uint32_t offset = 0;
+	uint8_t* scan = jpeg_buf + scan_offset;
+	uint8_t* p;
+
+	// The scan without the EOI (receivers append their own)
+	len = jpeg_len - scan_offset - 2;
+	pre = (c->interleaved) ? 4 : 0;
+	if (c->interleaved && !tcp_room(c, len + (len / 256) + 256)) {
+		log_debug("RTSP client %d skipped a frame", (int) (c - clients));
+		metrics.images_skipped++;
+		return;
+	}
+
+	while (len > 0) {
+		max_n = RTP_MAX_PKT_LEN - RTP_HEADER_LEN - RTP_JPEG_HDR_LEN - ((first) ? RTP_EXT_LEN : 0);
+		n = (len > max_n) ? max_n : len;
+
+		// RTP header (the marker is set on the last packet of the image)
+		p = pkt_buf + pre;
+		*p++ = (RTP_VERSION << 6) | ((first) ? 0x10 : 0x00);
+		*p++ = ((n == len) ? 0x80 : 0x00) | RTP_PT_JPEG;
+		p = put_be16(p, c->rtp_seq++);
+		p = put_be32(p, ts);
+		p = put_be32(p, c->rtp_ssrc);
+
+		if (first) {
+			p = put_be16(p, 0xBEDE);
+			p = put_be16(p, (RTP_EXT_LEN - 4) / 4);
+			*p++ = (RTP_EXT_ID_RANGE << 4) | (8 - 1);
+			p = put_be16(p, ext[0]);
+			p = put_be16(p, ext[1]);
+			p = put_be16(p, ext[2]);
+			p = put_be16(p, ext[3]);
+			*p++ = (RTP_EXT_ID_RES << 4) | (2 - 1);
+			p = put_be16(p, ext[4]);
+		}
+
+		// JPEG header: type specific, fragment offset, type, Q, width / 8, height / 8
+		*p++ = 0;
+		*p++ = (offset >> 16) & 0xFF;
+		p = put_be16(p, offset & 0xFFFF);
+		*p++ = JPEG_RTP_TYPE;
+		*p++ = JPEG_DEF_QUALITY;
+		*p++ = 160 / 8;
+		*p++ = 120 / 8;
+		memcpy(p, scan, n);
+		p += n;
+
+		if (c->interleaved) {
+			pkt_buf[0] = '$';
+			pkt_buf[1] = c->rtp_channel;
+			put_be16(&pkt_buf[2], (p - pkt_buf) - 4);
+			if (send(c->fd, pkt_buf, p - pkt_buf, MSG_NOSIGNAL) != (p - pkt_buf)) {
+				close_client(c);
+				return;
+			}
+		} else if (sendto(rtp_fd, pkt_buf, p - pkt_buf, MSG_DONTWAIT,
+		                  (struct sockaddr*) &c->rtp_dest, sizeof(c->rtp_dest)) < 0) {
+			// Drop the rest of the image
+			return;
+		}
+
+		first = 0;
+		scan += n;
+		len -= n;
+		offset += n;
+	}
+	metrics.images_sent++;
+}
+
+
+/**
+ * Take the newest frame from the ring and send it to the playing clients
+ */
+static void process_frames()
+{
+	vospi_frame_t* frame;
+	uint32_t seq;
+	uint16_t ext[5];
+	int i, have_frame = 0, playing = 0;
+	int len, scan_offset;
+	uint64_t t;
+
+	for (i=0; i<RTSP_MAX_CLIENTS; i++) {
+		if ((clients[i].fd >= 0) && (clients[i].state == RTSP_STATE_PLAYING)) playing = 1;
+	}
+
+	// Convert each available frame (keeping the newest one that wasn't overwritten)
+	while ((frame = prulepton_get_frame(&lep, &seq)) != NULL) {
+		if (playing) {
+#ifdef VOSPI_16BIT
+			frame_to_pixel16(frame, pix16buf);
+#else
+			frame_to_pixel(frame, pixbuf);
+#endif
+			have_frame = prulepton_release_frame(&lep, seq);
+		} else {
+			(void) prulepton_release_frame(&lep, seq);
+		}
+	}
+	if (!have_frame) return;
+
+	// Scale 16-bit frames to their own range
+#ifdef VOSPI_16BIT
+	ext[2] = 0xFFFF;
+	ext[3] = 0;
+	for (i=0; i<VOSPI_FRAME_LEN; i++) {
+		if (pix16buf[i] < ext[2]) ext[2] = pix16buf[i];
+		if (pix16buf[i] > ext[3]) ext[3] = pix16buf[i];
+	}
+	pixel16_scale(pix16buf, pixbuf, ext[2], ext[3]);
+	ext[0] = ext[2];
+	ext[1] = (ext[3] > ext[2]) ? ext[3] : ext[2] + 1;
+	ext[4] = 1;
+#else
+	ext[2] = 0xFF;
+	ext[3] = 0;
+	for (i=0; i<VOSPI_FRAME_LEN; i++) {
+		if (pixbuf[i] < ext[2]) ext[2] = pixbuf[i];
+		if (pixbuf[i] > ext[3]) ext[3] = pixbuf[i];
+	}
+	ext[0] = 0;
+	ext[1] = 255;
+	ext[4] = 0;
+#endif
+
+	t = get_usec();
+	len = jpeg_encode(pixbuf, 160, 120, palette, JPEG_DEF_QUALITY, jpeg_buf, sizeof(jpeg_buf), &scan_offset);
+	if (len == 0) return;
+	t = get_usec() - t;
+	metrics.images_encoded++;
+	metrics.encode_usec += t;
+	for (i=0; i<METRICS_BUCKETS - 1; i++) {
+		if (t <= metrics_bounds[i]) break;
+	}
+	metrics.encode_hist[i]++;
+
+	for (i=0; i<RTSP_MAX_CLIENTS; i++) {
+		if ((clients[i].fd >= 0) && (clients[i].state == RTSP_STATE_PLAYING)) {
+			send_image(&clients[i], len, scan_offset, ext, rtp_timestamp());
+		}
+	}
+}
+
+
+/**
+ * Serve RTSP clients and frames from this thread until capture stops
+ */
+static void run_server(uint16_t port)
+{
+	struct pollfd fds[2 + RTSP_MAX_CLIENTS];
+	int idx[RTSP_MAX_CLIENTS];
+	int i, n;
+
+	listen_fd = open_socket(SOCK_STREAM, port);
+	if (listen_fd < 0) {
+		log_fatal("Failed to listen on port %d: %s", port, strerror(errno));
+		exit(1);
+	}
+	if (open_rtp_sockets() < 0) {
+		log_warn("No UDP ports for RTP, only interleaved clients supported");
+	}
+	log_info("RTSP server on port %d (RTP UDP port %d)", port, rtp_port);
+
+	while (lep.running) {
+		fds[0].fd = listen_fd;
+		fds[0].events = POLLIN;
+		fds[1].fd = prulepton_get_fd(&lep);
+		fds[1].events = POLLIN;
+		n = 2;
+		for (i=0; i<RTSP_MAX_CLIENTS; i++) {
+			idx[i] = -1;
+			if (clients[i].fd >= 0) {
+				idx[i] = n;
+				fds[n].fd = clients[i].fd;
+				fds[n].events = POLLIN;
+				n++;
+			}
+		}
+
+		if (poll(fds, n, 1000) < 0) {
+			if (errno == EINTR) continue;
+			log_fatal("poll failed: %s", strerror(errno));
+			exit(1);
+		}
+
+		if (fds[1].revents & POLLIN) {
+			process_frames();
+		}
+		for (i=0; i<RTSP_MAX_CLIENTS; i++) {
+			if ((idx[i] >= 0) && (clients[i].fd >= 0) && (fds[idx[i]].revents & (POLLIN | POLLHUP | POLLERR))) {
+				read_client(&clients[i]);
+			}
+		}
+		if (fds[0].revents & POLLIN) {
+			accept_client();
+		}
+	}
+}
+
+
+/*
+ * SIGINT signal handler
+ */
+void sig_handler(int sig)
+{
+	// Try to shut down the PRUs before exiting
+	prulepton_stop(&lep);
+	log_info("Shutting down");
+	sleep(1); /* make sure command makes it to PRU */
+	exit(0);
+}
+
+
+/**
+ * Main entry point for the PRU-based RTSP server.  Optional arguments: the colormap
+ * (0 - 3, the same as pru_rpmsg_fb) and the RTSP port.
+ */
+int main(int argc, char *argv[])
+{
+	prulepton_config_t config;
+	int i;
+	int cmap = (argc > 1) ? atoi(argv[1]) : 3;
+	uint16_t port = (argc > 2) ? atoi(argv[2]) : RTSP_DEFAULT_PORT;
+
+	// Set the log level
+	log_set_level(LOG_INFO);
+
+	load_palette(cmap);
+	srandom(time(NULL) ^ getpid());
+	for (i=0; i<RTSP_MAX_CLIENTS; i++) {
+		clients[i].fd = -1;
+		close_client(&clients[i]);
+	}
+
+	// Attempt to initialize the lepton
+	if (prulepton_init_lepton(i2c_dev)) {
+		exit(-1);
+	}
+
+	// Setup the signal handler
+	signal(SIGINT, sig_handler);
+	signal(SIGPIPE, SIG_IGN);
+
+	// Start capturing
+	prulepton_default_config(&config);
+	config.pru_dev = pru_dev;
+	if (prulepton_start(&lep, &config)) {
+		exit(-1);
+	}
+
+	run_server(port);
+
+	prulepton_stop(&lep);
+	return (lep.error) ? -1 : 0;
+}
@@ -0,0 +1,184 @@
+#include "log.h"
+#include "prulepton.h"
+#include "vospi.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// Interval capture snapshot.  Takes a few frames as quickly as possible after the
+// system boots (started by scripts/interval_capture.sh after a Pi Platter RTC alarm
+// wake), writes them to storage as PGM images and exits.  Radiometric (TLinear)
+// frames are written as 16-bit PGMs when built with VOSPI_16BIT, otherwise the
+// Lepton's 8-bit AGC frames are written.  The time from boot to the start of the
+// program, the Lepton setup time and the time to the first frame are appended to
+// SNAP_LOG in the output directory so the wake path can be tuned.
+
+// Timing log in the output directory
+#define SNAP_LOG "snap.log"
+
+// Maximum path length
+#define MAX_PATH_LEN 256
+
+
+/* ------------ */
+/* Device files */
+/* ------------ */
+char i2c_dev[] = PRULEPTON_I2C_DEV;
+char pru_dev[] = PRULEPTON_PRU_DEV;
+
+
+/* --------------- */
+/* Local Variables */
+/* --------------- */
+
+prulepton_t lep;
+
+#ifdef VOSPI_16BIT
+uint16_t pixbuf[VOSPI_FRAME_LEN];
+#else
+uint8_t pixbuf[VOSPI_FRAME_LEN];
+#endif
+
+
+
+/**
+ * Milliseconds since the system booted
+ */
+uint32_t get_boot_msec()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_BOOTTIME, &ts);
+	return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+/**
+ * Write the pixel buffer as a PGM image.  Returns 0 for success, -1 for failure.
+ */
+int write_pgm(const char* path)
+{
+	FILE* fp;
+#ifdef VOSPI_16BIT
+	int i;
+#endif
+
+	if ((fp = fopen(path, "wb")) == NULL) {
+		log_error("Could not create %s", path);
+		return -1;
+	}
+
+#ifdef VOSPI_16BIT
+	// 16-bit PGM samples are big-endian
+	fprintf(fp, "P5\n160 120\n65535\n");
+	for (i=0; i<VOSPI_FRAME_LEN; i++) {
+		fputc(pixbuf[i] >> 8, fp);
+		fputc(pixbuf[i] & 0xFF, fp);
+	}
+#else
+	fprintf(fp, "P5\n160 120\n255\n");
+	(void) fwrite(pixbuf, 1, VOSPI_FRAME_LEN, fp);
+#endif
+
+	if (fclose(fp) != 0) {
+		log_error("Could not write %s", path);
+		return -1;
+	}
+	return 0;
+}
+
+
+/*
+ * SIGINT signal handler
+ */
+void sig_handler(int sig)
+{
+	// Try to shut down the PRUs before exiting
+	prulepton_stop(&lep);
+	sleep(1); /* make sure command makes it to PRU */
+	exit(-1);
+}
+
+
+/**
+ * Main entry point.  Optional arguments: the number of frames to save (default 1),
+ * the output directory (default ".") and the number of frames to discard first while
+ * the Lepton settles after power-up (default 0).
+ */
+int main(int argc, char *argv[])
+{
+	prulepton_config_t config;
+	vospi_frame_t* frame;
+	char path[MAX_PATH_LEN];
+	char stamp[32];
+	uint32_t start_t, init_t, first_t;
+	uint32_t seq;
+	time_t now;
+	FILE* fp;
+	int num_frames = (argc > 1) ? atoi(argv[1]) : 1;
+	char* dir = (argc > 2) ? argv[2] : ".";
+	int skip = (argc > 3) ? atoi(argv[3]) : 0;
+	int n = 0;
+
+	start_t = get_boot_msec();
+	log_set_level(LOG_INFO);
+
+	// Configure the Lepton without the read-backs and start the PRUs right away
+	if (prulepton_init_lepton_fast(i2c_dev)) {
+		exit(-1);
+	}
+	init_t = get_boot_msec();
+
+	signal(SIGINT, sig_handler);
+	signal(SIGTERM, sig_handler);
+
+	prulepton_default_config(&config);
+	config.pru_dev = pru_dev;
+	if (prulepton_start(&lep, &config)) {
+		exit(-1);
+	}
+
+	// Name the images by the (RTC set) wall clock time of the capture
+	now = time(NULL);
+	strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", localtime(&now));
+
+	first_t = 0;
+	while ((n < num_frames) && ((frame = prulepton_wait_frame(&lep, &seq)) != NULL)) {
+		if (first_t == 0) {
+			first_t = get_boot_msec();
+		}
+		if (skip > 0) {
+			skip--;
+		} else {
+#ifdef VOSPI_16BIT
+			frame_to_pixel16(frame, pixbuf);
+#else
+			frame_to_pixel(frame, pixbuf);
+#endif
+			if (prulepton_release_frame(&lep, seq)) {
+				snprintf(path, sizeof(path), "%s/lep_%s_%d.pgm", dir, stamp, n);
+				if (write_pgm(path) == 0) {
+					n++;
+				}
+			}
+		}
+		// Does nothing if it was already released
+		(void) prulepton_release_frame(&lep, seq);
+	}
+	prulepton_stop(&lep);
+
+	log_info("Boot to start %u mSec, Lepton setup %u mSec, first frame %u mSec after start",
+	         start_t, init_t - start_t, first_t - start_t);
+	snprintf(path, sizeof(path), "%s/%s", dir, SNAP_LOG);
+	if ((fp = fopen(path, "a")) != NULL) {
+		fprintf(fp, "%s boot_to_start=%u lepton_setup=%u first_frame=%u frames=%d\n",
+		        stamp, start_t, init_t - start_t, first_t - start_t, n);
+		fclose(fp);
+	}
+
+	return (n == num_frames) ? 0 : -1;
+}
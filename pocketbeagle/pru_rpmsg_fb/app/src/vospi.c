@@ -6,6 +6,196 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#ifdef VOSPI_DDR_RING
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+#ifdef VOSPI_TF_LEVEL
+#include "vospi_tf.h"
+#endif
+#if defined(VOSPI_16BIT) && defined(VOSPI_AGC_MODE)
+#include "agc.h"
+#endif
+
+#if defined(VOSPI_FRAME_STATS) && defined(VOSPI_DDR_RING)
+#error "VOSPI_FRAME_STATS requires the rpmsg transport"
+#endif
+
+
+#if defined(VOSPI_16BIT) && defined(VOSPI_AGC_MODE)
+// Software AGC (initialized by the first frame converted)
+static agc_t agc;
+static int agc_ready = 0;
+#endif
+
+
+#ifdef VOSPI_TF_LEVEL
+// Temporal filter and its accumulator (initialized by the first frame converted)
+static vospi_tf_t tf;
+static uint32_t tf_acc[VOSPI_FRAME_LEN];
+static int tf_init = 0;
+
+
+static vospi_tf_t* get_tf()
+{
+	if (!tf_init) {
+		vospi_tf_init(&tf, tf_acc, VOSPI_TF_LEVEL, VOSPI_TF_DEF_MOTION);
+		tf_init = 1;
+	}
+
+	return &tf;
+}
+#endif
+
+
+#ifdef VOSPI_DDR_RING
+// The mapped DDR ring
+static volatile vospi_ring_hdr_t* ring_hdr = NULL;
+static uint8_t* ring_frames;
+
+// Set from sending a standby command until PRU1's wake message arrives
+static int ring_standby = 0;
+
+
+/**
+ *  Read rpmsg messages until one of the specified DDR ring type arrives and return
+ *  its value.  Frame notifications are skipped while in standby (PRU1 notifies the
+ *  frames in the ring again after its wake message).  Returns false for a bad read.
+ */
+static int get_ring_msg(int fd, uint8_t type, uint32_t* val)
+{
+	vospi_rpmsg_t msg;
+
+	while (1) {
+		if (read(fd, (uint8_t*) &msg, VOSPI_MSG_TOTAL_BYTES) < 1) {
+			log_fatal("RPMSG: failed to transfer packet");
+			return 0;
+		}
+		if (msg.seq == VOSPI_RING_WAKE_MSG) {
+			ring_standby = 0;
+		}
+		if ((msg.seq == type) && !((type == VOSPI_RING_FRAME_MSG) && ring_standby)) {
+			break;
+		}
+	}
+
+	*val = msg.data[0] | (msg.data[1] << 8) | (msg.data[2] << 16) | ((uint32_t) msg.data[3] << 24);
+	return 1;
+}
+
+
+/**
+ *  Map the DDR ring using the physical address PRU1 sends when it is enabled.
+ *  Returns false if the ring could not be mapped.
+ */
+static int open_ring(int fd)
+{
+	int mem_fd;
+	uint32_t pa;
+	void* p;
+
+	if (!get_ring_msg(fd, VOSPI_RING_INFO_MSG, &pa)) {
+		return 0;
+	}
+
+	if ((mem_fd = open("/dev/mem", O_RDWR | O_SYNC)) < 0) {
+		log_fatal("RING: failed to open /dev/mem - check permissions");
+		return 0;
+	}
+	p = mmap(NULL, VOSPI_RING_LEN, PROT_READ | PROT_WRITE, MAP_SHARED, mem_fd, pa);
+	close(mem_fd);
+	if (p == MAP_FAILED) {
+		log_fatal("RING: failed to map 0x%08x", pa);
+		return 0;
+	}
+
+	ring_hdr = (volatile vospi_ring_hdr_t*) p;
+	ring_frames = (uint8_t*) p + VOSPI_RING_HDR_LEN;
+	if ((ring_hdr->magic != VOSPI_RING_MAGIC) || (ring_hdr->frame_len != VOSPI_FRAME_BYTES)) {
+		log_fatal("RING: unexpected ring header - check DDR_RING and LEP_16BIT");
+		munmap(p, VOSPI_RING_LEN);
+		ring_hdr = NULL;
+		return 0;
+	}
+	log_info("RING: mapped %d frames at 0x%08x", ring_hdr->num_frames, pa);
+
+	return 1;
+}
+#endif
+
+
+/**
+ *  Set the PRU0 packet sample period and PRU1 message period (0 for the firmware
+ *  defaults).  Must be called while acquisition is stopped.  Returns 0 for success,
+ *  -1 if the command could not be sent.
+ */
+int vospi_set_timing(int fd, uint16_t sample_usec, uint16_t xmit_usec)
+{
+	uint8_t cmd[VOSPI_TIMING_CMD_LEN];
+
+	cmd[0] = VOSPI_TIMING_CMD;
+	cmd[1] = sample_usec & 0xFF;
+	cmd[2] = sample_usec >> 8;
+	cmd[3] = xmit_usec & 0xFF;
+	cmd[4] = xmit_usec >> 8;
+
+	if (write(fd, cmd, VOSPI_TIMING_CMD_LEN) != VOSPI_TIMING_CMD_LEN) {
+		log_error("RPMSG: failed to set timing");
+		return -1;
+	}
+
+	return 0;
+}
+
+
+#ifdef VOSPI_DDR_RING
+/**
+ *  Put PRU1 into standby with the specified triggers (NULL or no triggers to wake it
+ *  now).  PRU1 stops sending notifications and keeps the latest frames in the ring
+ *  so sync_and_transfer_frame() blocks, and the process can sleep, until a frame
+ *  trips the triggers.  It then returns the frames that were in the ring (the last
+ *  is the one that tripped them) followed by each new frame.  Must be called while
+ *  acquisition is enabled from the thread calling sync_and_transfer_frame().
+ *  Restarting acquisition leaves standby so wake PRU1 before disabling it.  Returns
+ *  0 for success, -1 if the command could not be sent.
+ */
+int vospi_set_standby(int fd, const vospi_standby_t* standby)
+{
+	uint8_t cmd[VOSPI_STANDBY_CMD_LEN];
+
+	memset(cmd, 0, VOSPI_STANDBY_CMD_LEN);
+	cmd[0] = VOSPI_STANDBY_CMD;
+	if (standby != NULL) {
+		cmd[1] = standby->triggers;
+		cmd[2] = standby->threshold & 0xFF;
+		cmd[3] = standby->threshold >> 8;
+		cmd[4] = standby->delta & 0xFF;
+		cmd[5] = standby->delta >> 8;
+		cmd[6] = standby->min_pixels & 0xFF;
+		cmd[7] = standby->min_pixels >> 8;
+	}
+
+	if (write(fd, cmd, VOSPI_STANDBY_CMD_LEN) != VOSPI_STANDBY_CMD_LEN) {
+		log_error("RPMSG: failed to set standby");
+		return -1;
+	}
+
+	// Frames PRU1 notified before it got the command stay in the ring for after the wake
+	ring_standby = 1;
+	return 0;
+}
+
+
+/**
+ *  Return the number of pixels that tripped the standby triggers for the last wake
+ */
+uint32_t vospi_wake_pixels()
+{
+	return (ring_hdr != NULL) ? ring_hdr->wake_pixels : 0;
+}
+#endif
 
 
 /**
@@ -37,6 +227,50 @@ int sync_and_transfer_exp_msg(int fd, vospi_rpmsg_t* msg, uint8_t exp_seq)
 }
 
 
+#ifdef VOSPI_DDR_RING
+/**
+ *  Transfer a single VoSPI frame from the DDR ring.  Blocks until PRU1 notifies us
+ *  that it has written a frame.  Frames are copied into the rpmsg frame layout so
+ *  the transport is invisible to the caller.
+ *  Returns:
+ *    -1 : Bad Read or ring could not be mapped - fatal
+ *     0 : Successful transfer
+ */
+int sync_and_transfer_frame(int fd, vospi_frame_t* frame)
+{
+	int seq;
+	uint32_t head;
+	uint32_t tail;
+	uint8_t* src;
+
+	if (ring_hdr == NULL) {
+		if (!open_ring(fd)) {
+			return -1;
+		}
+	}
+
+	// One notification is sent for each frame PRU1 makes available in the ring (in
+	// standby PRU1 sends them for the frames in the ring when it wakes)
+	if (!get_ring_msg(fd, VOSPI_RING_FRAME_MSG, &head)) {
+		return -1;
+	}
+
+	__sync_synchronize();
+	tail = ring_hdr->tail;
+	src = ring_frames + (tail % ring_hdr->num_frames) * VOSPI_FRAME_BYTES;
+	for (seq=0; seq < VOSPI_FRAME_NUM_MSGS; seq++) {
+		frame->msg[seq].seq = seq;
+		memcpy(frame->msg[seq].data, src, VOSPI_MSG_DATA_BYTES);
+		src += VOSPI_MSG_DATA_BYTES;
+	}
+
+	// Release the ring frame back to PRU1
+	__sync_synchronize();
+	ring_hdr->tail = tail + 1;
+
+	return 0;
+}
+#else
 /**
  *  Transfer a single VoSPI frame.
  *  Returns:
@@ -66,7 +300,7 @@ int sync_and_transfer_frame(int fd, vospi_frame_t* frame)
 				break;
 			case 1:
 				/* keep waiting for a while */
-				if (++cnt > VOSPI_FRAME_NUM_MSGS) {
+				if (++cnt > VOSPI_FRAME_TOTAL_MSGS) {
 					return 3;
 				}
 				break;
@@ -77,8 +311,8 @@ int sync_and_transfer_frame(int fd, vospi_frame_t* frame)
 		}
 	}
 
-	// Attempt to read remaining frame messages
-	while (seq < VOSPI_FRAME_NUM_MSGS) {
+	// Attempt to read remaining frame (and statistics) messages
+	while (seq < VOSPI_FRAME_TOTAL_MSGS) {
 		log_debug("synchronising with message %d", seq);
 		rsp = sync_and_transfer_exp_msg(fd, &frame->msg[seq], seq);
 		if (rsp == 0) {
@@ -92,20 +326,154 @@ int sync_and_transfer_frame(int fd, vospi_frame_t* frame)
 
 	return 0;
 }
+#endif
 
 
 /**
- * Copy data from a frame into a pixel buffer discarding the sequence numbers
+ * Copy data from a frame into an 8-bit pixel buffer discarding the sequence numbers.
+ * 16-bit frames are mapped with the software AGC (VOSPI_AGC_MODE) or linearly scaled
+ * between their minimum and maximum pixel.  The frame statistics are used when
+ * available and the pixels aren't filtered.
  */
 void frame_to_pixel(vospi_frame_t* frame, uint8_t* pixbuf)
 {
+#ifdef VOSPI_16BIT
+	uint16_t pix16buf[VOSPI_FRAME_LEN];
+#if defined(VOSPI_FRAME_STATS) && !defined(VOSPI_TF_LEVEL)
+	vospi_stats_t stats;
+#endif
+
+	frame_to_pixel16(frame, pix16buf);
+#ifdef VOSPI_AGC_MODE
+	if (!agc_ready) {
+		agc_init(&agc, VOSPI_AGC_MODE, VOSPI_AGC_CLIP);
+		agc_ready = 1;
+	}
+#if defined(VOSPI_FRAME_STATS) && !defined(VOSPI_TF_LEVEL)
+	if (frame_to_stats(frame, &stats)) {
+		agc_map_hist(&agc, pix16buf, pixbuf, stats.hist, stats.hist_base, stats.hist_shift);
+		return;
+	}
+#endif
+	agc_map(&agc, pix16buf, pixbuf);
+#else
+#if defined(VOSPI_FRAME_STATS) && !defined(VOSPI_TF_LEVEL)
+	if (frame_to_stats(frame, &stats)) {
+		pixel16_scale(pix16buf, pixbuf, stats.min, stats.max);
+		return;
+	}
+#endif
+	pixel16_to_pixel(pix16buf, pixbuf);
+#endif
+#else
 	int i;
 	int seq;
+#ifdef VOSPI_TF_LEVEL
+	vospi_tf_t* tfP = get_tf();
 
+	for (seq=0; seq < VOSPI_FRAME_NUM_MSGS; seq++) {
+		for (i=0; i<VOSPI_MSG_DATA_BYTES; i++) {
+			*pixbuf++ = (uint8_t) vospi_tf_pixel(tfP, seq*VOSPI_MSG_DATA_BYTES + i, frame->msg[seq].data[i]);
+		}
+	}
+	vospi_tf_end_frame(tfP);
+#else
 	for (seq=0; seq < VOSPI_FRAME_NUM_MSGS; seq++) {
 		for (i=0; i<VOSPI_MSG_DATA_BYTES; i++) {
 			*pixbuf++ = frame->msg[seq].data[i];
 		}
 	}
+#endif
+#endif
+}
+
+
+#ifdef VOSPI_FRAME_STATS
+/**
+ * Copy the statistics from the end of a frame.  Returns false if the frame does not
+ * contain valid statistics.
+ */
+int frame_to_stats(vospi_frame_t* frame, vospi_stats_t* stats)
+{
+	int n;
+	int seq = VOSPI_FRAME_NUM_MSGS;
+	uint8_t* dst = (uint8_t*) stats;
+	int len = sizeof(vospi_stats_t);
+
+	while (len > 0) {
+		n = (len < VOSPI_MSG_DATA_BYTES) ? len : VOSPI_MSG_DATA_BYTES;
+		memcpy(dst, frame->msg[seq++].data, n);
+		dst += n;
+		len -= n;
+	}
+
+	return (stats->num_pixels == VOSPI_FRAME_LEN);
+}
+#endif
+
+
+#ifdef VOSPI_16BIT
+/**
+ * Copy data from a frame into a 16-bit pixel buffer discarding the sequence numbers
+ * (and filtering each pixel with VOSPI_TF_LEVEL)
+ */
+void frame_to_pixel16(vospi_frame_t* frame, uint16_t* pixbuf)
+{
+	int i;
+	int seq;
+#ifdef VOSPI_TF_LEVEL
+	vospi_tf_t* tfP = get_tf();
+	int n = 0;
+
+	for (seq=0; seq < VOSPI_FRAME_NUM_MSGS; seq++) {
+		for (i=0; i<VOSPI_MSG_DATA_BYTES; i+=2) {
+			*pixbuf++ = vospi_tf_pixel(tfP, n++, (frame->msg[seq].data[i] << 8) | frame->msg[seq].data[i+1]);
+		}
+	}
+	vospi_tf_end_frame(tfP);
+#else
+	for (seq=0; seq < VOSPI_FRAME_NUM_MSGS; seq++) {
+		for (i=0; i<VOSPI_MSG_DATA_BYTES; i+=2) {
+			*pixbuf++ = (frame->msg[seq].data[i] << 8) | frame->msg[seq].data[i+1];
+		}
+	}
+#endif
+}
+
+
+/**
+ * Linearly scale a 16-bit pixel buffer between its minimum and maximum pixel into
+ * an 8-bit pixel buffer for display
+ */
+void pixel16_to_pixel(uint16_t* pix16buf, uint8_t* pixbuf)
+{
+	int i;
+	uint16_t min = 0xFFFF;
+	uint16_t max = 0;
+
+	for (i=0; i<VOSPI_FRAME_LEN; i++) {
+		if (pix16buf[i] < min) min = pix16buf[i];
+		if (pix16buf[i] > max) max = pix16buf[i];
+	}
+
+	pixel16_scale(pix16buf, pixbuf, min, max);
+}
+
+
+/**
+ * Linearly scale a 16-bit pixel buffer between min and max into an 8-bit pixel buffer
+ * for display
+ */
+void pixel16_scale(uint16_t* pix16buf, uint8_t* pixbuf, uint16_t min, uint16_t max)
+{
+	int i;
+	uint32_t range;
+
+	range = (max > min) ? (max - min) : 1;
+
+	for (i=0; i<VOSPI_FRAME_LEN; i++) {
+		*pixbuf++ = (uint8_t) (((uint32_t) (pix16buf[i] - min) * 255) / range);
+	}
 }
+#endif
 
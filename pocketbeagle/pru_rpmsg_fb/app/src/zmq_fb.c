@@ -7,13 +7,25 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
-#include <time.h> 
 #include <zmq.h>
 
 
 // The default spec for the ZMQ socket that will be used for comms with the frontend
 #define ZMQ_DEFAULT_SOCKET_SPEC "tcp://127.0.0.1:5555"
 
+// Uncomment to subscribe to frames published by pru_leptonic built with LEP_ZMQ_PUBSUB
+// instead of requesting each frame
+//#define LEP_ZMQ_PUBSUB
+
+// Set to 1 to keep only the most recent published frame (older queued frames are
+// discarded if we fall behind) or 0 to receive every frame published
+#define LEP_ZMQ_CONFLATE 1
+
+// More than one socket spec on the command line shows the sources as a mosaic of up
+// to FB_MAX_TILES tiles.  Each source is scaled into its own tile and only the tiles
+// with a new frame are drawn.
+#define MOSAIC_MAX_SOURCES FB_MAX_TILES
+
 /* ------------ */
 /* Device files */
 /* ------------ */
@@ -24,18 +36,108 @@ char fb_dev[] = "/dev/fb0";
 /* Local Variables */
 /* --------------- */
 uint8_t pixbuf[VOSPI_FRAME_LEN];
+#ifdef VOSPI_16BIT
+uint16_t pix16buf[VOSPI_FRAME_LEN];
+#endif
+
+#ifdef LEP_ZMQ_PUBSUB
+// Published message
+typedef struct {
+  uint32_t seq;
+#ifdef VOSPI_16BIT
+  uint16_t pixbuf[VOSPI_FRAME_LEN];
+#else
+  uint8_t pixbuf[VOSPI_FRAME_LEN];
+#endif
+} pub_msg_t;
+
+pub_msg_t msg;
+#endif
 
 
-/*
- * Sleep function
+
+/**
+ * Show the frames of n sources as a mosaic.  Each source is subscribed to (with
+ * LEP_ZMQ_PUBSUB) or has a request outstanding so frames are drawn into their tiles
+ * as they arrive from any of them.  Never returns.
  */
-void sleep_ms(int ms)
+void run_mosaic(void* context, int n, char* specs[])
 {
-  struct timespec ts;
+  zmq_pollitem_t items[MOSAIC_MAX_SOURCES];
+  int i;
+  int len;
+#ifdef LEP_ZMQ_PUBSUB
+  int conflate = LEP_ZMQ_CONFLATE;
+#else
+  char req_buf[10];
+
+  strcpy(req_buf, "get");
+#endif
 
-  ts.tv_sec = ms/1000;
-  ts.tv_nsec = (ms % 1000) * 1000000;
-  nanosleep(&ts, NULL);
+  if (set_fb_tiles(n) < 0) {
+    log_fatal("Error: can't show %d sources", n);
+    exit(1);
+  }
+
+  for (i=0; i<n; i++) {
+#ifdef LEP_ZMQ_PUBSUB
+    items[i].socket = zmq_socket(context, ZMQ_SUB);
+    zmq_setsockopt(items[i].socket, ZMQ_CONFLATE, &conflate, sizeof(conflate));
+    zmq_setsockopt(items[i].socket, ZMQ_SUBSCRIBE, "", 0);
+    zmq_connect(items[i].socket, specs[i]);
+#else
+    items[i].socket = zmq_socket(context, ZMQ_REQ);
+    zmq_connect(items[i].socket, specs[i]);
+    zmq_send(items[i].socket, req_buf, sizeof(req_buf), 0);
+#endif
+    items[i].fd = 0;
+    items[i].events = ZMQ_POLLIN;
+    log_info("Tile %d: %s", i, specs[i]);
+  }
+
+  while (1) {
+    if (zmq_poll(items, n, -1) <= 0) {
+      continue;
+    }
+
+    for (i=0; i<n; i++) {
+      if ((items[i].revents & ZMQ_POLLIN) == 0) {
+        continue;
+      }
+#ifdef LEP_ZMQ_PUBSUB
+      len = zmq_recv(items[i].socket, &msg, sizeof(msg), 0);
+      if (len != sizeof(msg)) {
+        log_debug("Tile %d: ignoring %d byte message", i, len);
+        continue;
+      }
+#ifdef VOSPI_16BIT
+      pixel16_to_pixel(msg.pixbuf, pixbuf);
+#else
+      memcpy(pixbuf, msg.pixbuf, VOSPI_FRAME_LEN);
+#endif
+#else
+      // Take the reply and ask for the source's next frame
+#ifdef VOSPI_16BIT
+      len = zmq_recv(items[i].socket, pix16buf, sizeof(pix16buf), 0);
+      zmq_send(items[i].socket, req_buf, sizeof(req_buf), 0);
+      if (len != sizeof(pix16buf)) {
+        continue;
+      }
+      pixel16_to_pixel(pix16buf, pixbuf);
+#else
+      len = zmq_recv(items[i].socket, pixbuf, VOSPI_FRAME_LEN, 0);
+      zmq_send(items[i].socket, req_buf, sizeof(req_buf), 0);
+      if (len != VOSPI_FRAME_LEN) {
+        continue;
+      }
+#endif
+#endif
+      draw_fb_tile(i, pixbuf);
+    }
+
+    // Copy the new tiles to the display (the others keep their last frame)
+    show_fb_tiles();
+  }
 }
 
 
@@ -44,39 +146,81 @@ void sleep_ms(int ms)
  */
 int main(int argc, char *argv[])
 {
+#ifdef LEP_ZMQ_PUBSUB
+  uint32_t next_seq = 0;
+  int conflate = LEP_ZMQ_CONFLATE;
+  int first = 1;
+  int len;
+#else
   char req_buf[10];
+#endif
 
   // Set the log level
   log_set_level(LOG_INFO);
 
+  // Initialize frame buffer
+  (void) init_fb(fb_dev);
+
+  // Setup colormap if user has selected a non-default
+  if (argc > 1) {
+	  set_colormap(atoi(argv[1]));
+  }
+
   // Create the ZMQ context & socket
   char* socket_path = argc > 2 ? argv[2] : ZMQ_DEFAULT_SOCKET_SPEC;
   void* context = zmq_ctx_new();
+  if (argc > 3) {
+    run_mosaic(context, argc - 2, &argv[2]);
+  }
+#ifdef LEP_ZMQ_PUBSUB
+  void* subscriber = zmq_socket(context, ZMQ_SUB);
+  zmq_setsockopt(subscriber, ZMQ_CONFLATE, &conflate, sizeof(conflate));
+  zmq_setsockopt(subscriber, ZMQ_SUBSCRIBE, "", 0);
+  zmq_connect(subscriber, socket_path);
+#else
   void* requester = zmq_socket(context, ZMQ_REQ);
   zmq_connect(requester, socket_path);
 
   // Set the request frame string (could be anything)
   strcpy(req_buf, "get");
-
-  // Initialize frame buffer
-  (void) init_fb(fb_dev);
-
-  // Setup colormap if user has selected a non-default
-  if (argc > 1) {
-	  set_colormap(atoi(argv[1]));
-  }
+#endif
 
   while (1) {
+#ifdef LEP_ZMQ_PUBSUB
+    // Wait for the next published frame
+    len = zmq_recv(subscriber, &msg, sizeof(msg), 0);
+    if (len != sizeof(msg)) {
+      log_debug("Ignoring %d byte message", len);
+      continue;
+    }
+    if (!first && (msg.seq != next_seq)) {
+      log_debug("Missed %u frames", msg.seq - next_seq);
+    }
+    first = 0;
+    next_seq = msg.seq + 1;
+#ifdef VOSPI_16BIT
+    pixel16_to_pixel(msg.pixbuf, pixbuf);
+#else
+    memcpy(pixbuf, msg.pixbuf, VOSPI_FRAME_LEN);
+#endif
+
+    // Render it into the frame buffer
+    update_fb(pixbuf);
+#else
     // Request a frame
     zmq_send(requester, req_buf, sizeof(req_buf), 0);
 
     // Wait for a response
+#ifdef VOSPI_16BIT
+    zmq_recv(requester, pix16buf, sizeof(pix16buf), 0);
+    pixel16_to_pixel(pix16buf, pixbuf);
+#else
     zmq_recv(requester, pixbuf, VOSPI_FRAME_LEN, 0);
+#endif
 
-    // Render it into the frame buffer
+    // Render it into the frame buffer (the server replies when it has a new frame so
+    // this runs at the frame rate)
     update_fb(pixbuf);
-
-    // Sleep a bit between frames
-    sleep_ms(111);
+#endif
   }
 }
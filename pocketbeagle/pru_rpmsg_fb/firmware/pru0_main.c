@@ -7,7 +7,10 @@
  * using a bit-banged MISO-only SPI interface running at 16.67 MHz.
  * It stores non-discard packets in a circular buffer located in shared
  * memory.  Only the low 8-bits of each Lepton data words are stored for
- * a total of 80 bytes per packet.  It assumes it is receiving a valid
+ * a total of 80 bytes per packet (when LEP_16BIT is defined in pru_common.h
+ * the Lepton is expected to be in Radiometric TLinear mode and both bytes of
+ * each word are stored, high byte first, for a total of 160 bytes per packet).
+ * It assumes it is receiving a valid
  * frame when it sees packet 20 of segment 1 and notifies PRU1 that it can
  * start pushing packet data up to the host via RPMsg. 
  *
@@ -21,8 +24,9 @@
  * up overwriting the start of the buffer with the end of the frame while
  * PRU1 is reading the buffer.  It's important to make sure the timing
  *
- * One frame requires 80 x 240 = 19200 bytes.  Almost the entire 12K shared
- * memory buffer is available for the circular buffer.
+ * One frame requires 80 x 240 = 19200 bytes (160 x 240 = 38400 bytes with
+ * LEP_16BIT).  Almost the entire 12K shared memory buffer is available for the
+ * circular buffer.
  *
  * This PRU reads one packet every 128 uSec (less than the maximum 158 uSec
  * period that is required to keep up with the Lepton).  The other PRU must
@@ -35,11 +39,38 @@
  * packet with an unexpected count it resets.  If it has previously triggered
  * PRU1 to start reading out packets then it sends an abort notification to PRU1.
  *
+ * When CHECK_CRC is defined this PRU also checks the CRC of each non-discard packet
+ * and resets (like an unexpected count) if it is bad so a corrupted frame is never
+ * pushed to the host.  The CRC is computed a byte at a time from a lookup table as
+ * each byte is read which adds about 10 cycles per byte (under 2000 cycles per
+ * packet) to the roughly 17000 cycles spent reading a packet, well within the 25600
+ * cycle sample period.
+ *
+ * When TELEM_HEADER or TELEM_FOOTER is defined the Lepton is expected to have
+ * telemetry enabled in that location (61 packets per segment).  The telemetry
+ * packets (packets 0-3 of segment 1 as a header or packets 57-60 of segment 4 as
+ * a footer) are read and checked like any other packet but are not stored so PRU1
+ * and the host always see a 240 packet image.
+ *
+ * When DDR_RING is defined in pru_common.h this PRU instead stores packets
+ * directly into the DDR ring frame PRU1 offered in the shared memory SLOT
+ * register and hands the complete frame back through the DONE register.  It
+ * can then immediately start capturing the next frame into the next free ring
+ * frame while PRU1 and the host deal with the last one.  It only discards
+ * packets waiting for a free frame when the host has fallen behind and the
+ * ring is full.
+ *
+ * The packet sample period can be changed by the host through PRU1 which writes
+ * it to the shared memory SAMPLE register.  It is latched each time this PRU is
+ * enabled.  This PRU also counts the packets it has stored for the current frame
+ * in the shared memory PKTS register so PRU1 can check that its message period
+ * keeps it between this PRU's writes and the end of the circular buffer.
+ *
  * PRU1 sets an enable locatation in shared memory buffer to 1 to indicate when
  * to run.  Otherwise this PRU spins waiting to be enabled.
  *
  * The LED attached to P1.36 is lit while receiving a valid frame (from segment 1,
- * packet 20 to segment 4, packet 59).
+ * packet 20 to the last packet of segment 4).
  *
  * Copyright (C) 2018 Dan Julio <dan@danjuliodesigns.com>
  *
@@ -65,8 +96,8 @@
 /* ----------- */
 /* Sample Time */
 /* ----------- */
+/* Default (the host can set it between SAMPLE_USEC_MIN and SAMPLE_USEC_MAX) */
 #define PKT_SAMPLE_USEC  128
-#define PRU_CLK_PER_USEC 200
 #define PRU_SAMPLE_TO    (PKT_SAMPLE_USEC * PRU_CLK_PER_USEC)
 
 /* Number of packet sample intervals to detect need to resync Lepton  */
@@ -98,6 +129,25 @@
 #define LEP_PACKET_SIZE      164 // Bytes
 #define LEP_PACKET_DATA_SIZE 160 // Bytes
 
+/* Comment out to skip checking the packet CRC */
+#define CHECK_CRC
+
+/* Packet CRC polynomial: x^16 + x^12 + x^5 + 1 (0 seed, computed with the TTT */
+/* bits of the ID and the CRC set to 0)                                        */
+#define LEP_CRC_POLY         0x1021
+
+/* Define one to match the telemetry location configured on the Lepton by the */
+/* application (leave both commented out when telemetry is disabled)          */
+//#define TELEM_HEADER
+//#define TELEM_FOOTER
+
+#if defined(TELEM_HEADER) || defined(TELEM_FOOTER)
+#define LAST_PACKET          60
+#else
+#define LAST_PACKET          59
+#endif
+#define TELEM_PACKETS        4
+
 
 /* --------- */
 /* Run state */
@@ -127,19 +177,58 @@ volatile register unsigned __R30;
 volatile uint8_t* buf_en_reg_ptr = SMEM_EN_REG;
 volatile uint8_t* buf_pru1_cmd_ptr =  SMEM_CMD_REG;
 volatile uint8_t* buf_cur_ptr = SMEM_BUF_START;
+volatile uint32_t* buf_sample_reg_ptr = SMEM_SAMPLE_REG;
+#ifdef DDR_RING
+volatile uint32_t* buf_slot_reg_ptr = SMEM_SLOT_REG;
+volatile uint32_t* buf_done_reg_ptr = SMEM_DONE_REG;
+#else
+volatile uint32_t* buf_pkts_reg_ptr = SMEM_PKTS_REG;
+#endif
 
 uint8_t run_state = RUN_STATE_STOPPED;
 uint8_t cur_segment = 0; /* 0 while waiting, 1 - 4 while receiving */
-uint8_t cur_packet = 59; /* 0 - 59 */
+uint8_t cur_packet = LAST_PACKET; /* 0 - LAST_PACKET */
 uint8_t cur_count = 0;   /* 0 - 239 */
 uint16_t lep_resync_count = 0; /* Counts sample intervals, reset each trigger */
+uint32_t sample_to = PRU_SAMPLE_TO;  /* Packet sample period in PRU cycles */
+uint16_t resync_threshold_count = RESYNC_THRESHOLD_COUNT;
 uint32_t lep_discard_pkt_count = 0;  /* Counts consecutive Lepton discard packets in a row */
                                      /* for diag purposes to read out with prudebug */
+#ifdef CHECK_CRC
+uint32_t lep_crc_fail_count = 0;     /* Counts packets with a bad CRC for diag purposes */
+uint16_t crc_table[256];
+#endif
 
 
 /* =========== */
 /* Subroutines */
 /* =========== */
+#ifdef CHECK_CRC
+void init_crc_table()
+{
+	uint16_t i, j;
+	uint16_t crc;
+
+	for (i=0; i<256; i++) {
+		crc = i << 8;
+		for (j=0; j<8; j++) {
+			crc = (crc & 0x8000) ? ((crc << 1) ^ LEP_CRC_POLY) : (crc << 1);
+		}
+		crc_table[i] = crc;
+	}
+}
+
+#define CRC_UPDATE(crc,b)	crc = (crc << 8) ^ crc_table[(uint8_t) ((crc >> 8) ^ (b))];
+#endif
+
+/* Store a byte in the DDR ring frame or the shared memory circular buffer */
+#ifdef DDR_RING
+#define STORE_BYTE(b)		*buf_cur_ptr++ = (b);
+#else
+#define STORE_BYTE(b)		*buf_cur_ptr++ = (b); if (buf_cur_ptr > SMEM_BUF_END) buf_cur_ptr = SMEM_BUF_START;
+#endif
+
+
 void init_pru()
 {
 	/* Enable OCP Master Port */
@@ -148,6 +237,10 @@ void init_pru()
 	/* Make sure we always start up disabled - clear any enable left laying around */
 	*buf_en_reg_ptr = P0_DISABLE;
 
+#ifdef CHECK_CRC
+	init_crc_table();
+#endif
+
 	/* Set CSN de-asserted and SCK high */
 	SET_PIN(CSN,1);
 	SET_PIN(CLK,1);
@@ -159,11 +252,27 @@ void init_pru()
 }
 
 
+/* Latch the packet sample period PRU1 passed from the host (0 for the default) */
+void init_sample_time()
+{
+	sample_to = *buf_sample_reg_ptr;
+	if (sample_to == 0) {
+		sample_to = PRU_SAMPLE_TO;
+	}
+	resync_threshold_count = (RESYNC_THRESHOLD_USEC * PRU_CLK_PER_USEC) / sample_to;
+}
+
+
 void init_capture()
 {
+#ifdef DDR_RING
+	buf_cur_ptr = (volatile uint8_t*) *buf_slot_reg_ptr;
+#else
 	buf_cur_ptr = SMEM_BUF_START;
+	*buf_pkts_reg_ptr = P0_PKTS_RESET;
+#endif
 	cur_segment = 0;   /* setup to receive segment 1 in packet 20 as first valid segment */
-	cur_packet = 59;   /* setup to receive packet 0 as first valid packet */
+	cur_packet = LAST_PACKET; /* setup to receive packet 0 as first valid packet */
 	cur_count = 0;
 }
 
@@ -185,7 +294,7 @@ void init_timer()
 /* Returns 1 if the timer has expired - and resets timer */
 int timer_expired()
 {
-	if (PRU0_CTRL.CYCLE >= PRU_SAMPLE_TO) {
+	if (PRU0_CTRL.CYCLE >= sample_to) {
 		init_timer();
 		return 1;
 	}
@@ -228,12 +337,23 @@ uint8_t get_packet()
 	uint8_t i;
 	uint8_t pktNumHigh;
 	uint8_t pktNumLow;
+	uint8_t store;
+#ifdef CHECK_CRC
+	uint8_t d;
+	uint16_t pktCrc;
+	uint16_t crc;
+#endif
 
 	/* Read one packet */
 	pktNumHigh = spi_read8();  /* TTT bits and discard indication */
 	pktNumLow = spi_read8();   /* Packet number */
-	i = spi_read8();           /* Throw away CRC for now */
-	i = spi_read8();           /* Throw away CRC for now */
+#ifdef CHECK_CRC
+	pktCrc = spi_read8() << 8;
+	pktCrc |= spi_read8();
+#else
+	i = spi_read8();           /* Throw away CRC */
+	i = spi_read8();           /* Throw away CRC */
+#endif
 
 	/* Look to see if we should discard this packet */
 	if (((pktNumHigh & 0x0F) == 0x0F) || (run_state == RUN_STATE_DISCARD)) {
@@ -254,14 +374,70 @@ uint8_t get_packet()
 	/* Reset consecutive discard count */
 	lep_discard_pkt_count = 0;
 
+	/* Telemetry packets are read (and checked) but not stored */
+#if defined(TELEM_HEADER)
+	store = !((cur_segment == 0) && (pktNumLow < TELEM_PACKETS));
+#elif defined(TELEM_FOOTER)
+	store = !((cur_segment == 4) && (pktNumLow > (LAST_PACKET - TELEM_PACKETS)));
+#else
+	store = 1;
+#endif
+
+#ifdef CHECK_CRC
+	/* Start the CRC with the header (TTT bits and CRC field as 0) */
+	crc = 0;
+	CRC_UPDATE(crc, pktNumHigh & 0x0F);
+	CRC_UPDATE(crc, pktNumLow);
+	CRC_UPDATE(crc, 0);
+	CRC_UPDATE(crc, 0);
+
+	/* Store packet - low 8-bits of each word - and include each byte in the CRC */
+	for (i=0; i<LEP_PACKET_DATA_SIZE/2; i++) {
+		d = spi_read8();                   /* Skip high half */
+		CRC_UPDATE(crc, d);
+#ifdef LEP_16BIT
+		if (store) {
+			STORE_BYTE(d);                 /* Store high half - TLinear data */
+		}
+#endif
+		d = spi_read8();
+		CRC_UPDATE(crc, d);
+		if (store) {
+			STORE_BYTE(d);                 /* Store low half - output of AGC module */
+		}
+	}
+
+	if (crc != pktCrc) {
+		/* Corrupted packet - restart */
+		++lep_crc_fail_count;
+		return PKT_ILLEGAL;
+	}
+#else
 	/* Store packet - low 8-bits of each word */
 	for (i=0; i<LEP_PACKET_DATA_SIZE/2; i++) {
+#ifdef LEP_16BIT
+		if (store) {
+			STORE_BYTE(spi_read8());       /* Store high half - TLinear data */
+		} else {
+			(void) spi_read8();
+		}
+#else
 		(void) spi_read8();                /* Skip high half */
-		*buf_cur_ptr++ = spi_read8();      /* Store low half - output of AGC module */
-		if (buf_cur_ptr > SMEM_BUF_END) {
-			buf_cur_ptr = SMEM_BUF_START;
+#endif
+		if (store) {
+			STORE_BYTE(spi_read8());       /* Store low half - output of AGC module */
+		} else {
+			(void) spi_read8();
 		}
 	}
+#endif
+
+#ifndef DDR_RING
+	/* Let PRU1 know the packet is in the circular buffer */
+	if (store) {
+		*buf_pkts_reg_ptr += 1;
+	}
+#endif
 
 	/* Update state */
 	if (pktNumLow == 20) {
@@ -288,7 +464,7 @@ uint8_t get_packet()
 			/* Unexpected segment number */
 			return PKT_ILLEGAL;
 		}
-	} else if (cur_packet == 59) {
+	} else if (cur_packet == LAST_PACKET) {
 		if (pktNumLow == 0) {
 			/* Expected packet for start of next segment */
 			cur_packet = 0;
@@ -326,7 +502,13 @@ void main()
 		if (*buf_en_reg_ptr == P0_ENABLE) {
 			if (run_state == RUN_STATE_STOPPED) {
 				/* Start up */
+#ifdef DDR_RING
+				/* Wait for a ring frame if PRU1 hasn't offered one */
+				run_state = (*buf_slot_reg_ptr != P0_NO_SLOT) ? RUN_STATE_DATA : RUN_STATE_DISCARD;
+#else
 				run_state = RUN_STATE_DATA;
+#endif
+				init_sample_time();
 				init_capture();
 				init_timer();
 				lep_resync_count = 0;
@@ -348,9 +530,14 @@ void main()
 
 		/* Get data if enabled */
 		if (run_state != RUN_STATE_STOPPED) {
-			/* Check if PRU1 is done processing and we can start pushing data again */
+			/* Check if PRU1 is done processing (or has given us a free ring frame) */
+			/* and we can start pushing data again                                */
 			if (run_state == RUN_STATE_DISCARD) {
+#ifdef DDR_RING
+				if (*buf_slot_reg_ptr != P0_NO_SLOT) {
+#else
 				if (*buf_pru1_cmd_ptr == P1_CMD_IDLE) {
+#endif
 					run_state = RUN_STATE_DATA;
 
 					/* Initialize capture system for next frame */
@@ -364,18 +551,22 @@ void main()
 				pkt_response = get_packet();
 				lep_resync_count++;
 				if (pkt_response == PKT_ILLEGAL) {
+#ifndef DDR_RING
 					/* Notify PRU1 if necessary */
 					if (*buf_pru1_cmd_ptr == P1_CMD_IN_FRAME) {
 						*buf_pru1_cmd_ptr = P1_CMD_ABORT;
 						/* PRU1 will clear command when it reads it */
 					}
+#endif
 
 					/* Try to restart */
 					init_capture();
 					SET_PIN(LED,0);
 				} else if (pkt_response == PKT_TRIGGER) {
+#ifndef DDR_RING
 					/* Got Seg1/Pkt20 - Tell PRU1 to start processing */
 					*buf_pru1_cmd_ptr = P1_CMD_IN_FRAME;
+#endif
 
 					/* Reset lepton resync counter because we expect this is a good frame */
 					lep_resync_count = 0;
@@ -384,8 +575,16 @@ void main()
 					SET_PIN(LED,1);
 				} else if (pkt_response == PKT_GOOD) {
 					/* Look for last packet just pushed */
-					if ((cur_packet == 59) && (cur_segment == 4)) {
-						/* Discard packets until PRU1 is done */
+					if ((cur_packet == LAST_PACKET) && (cur_segment == 4)) {
+#ifdef DDR_RING
+						/* Read back the last byte to make sure the frame is in DDR */
+						(void) *(buf_cur_ptr - 1);
+
+						/* Hand the frame to PRU1 */
+						*buf_done_reg_ptr = *buf_slot_reg_ptr;
+						*buf_slot_reg_ptr = P0_NO_SLOT;
+#endif
+						/* Discard packets until PRU1 is done (or has a free ring frame) */
 						run_state = RUN_STATE_DISCARD;
 
 						/* Clear LED */
@@ -394,7 +593,7 @@ void main()
 				}
 
 				/* Look for need to resync Lepton */
-				if (lep_resync_count == RESYNC_THRESHOLD_COUNT) {
+				if (lep_resync_count == resync_threshold_count) {
 					/* De-assert CS and LED */
 					SET_PIN(CSN,1);
 					SET_PIN(LED,0);
@@ -9,20 +9,66 @@
  * facility.
  *
  * In order to not overwhelm the host processor, 6 80-byte Lepton packets
- * are combined with a sequence number in each message.  Messages are sent
+ * (3 160-byte packets when LEP_16BIT is defined in pru_common.h) are
+ * combined with a sequence number in each message.  Messages are sent
  * at a slightly lower transfer rate than data is being stored into the 
  * circular buffer but fast enough to a) keep PRU0 from overwriting good data
  * since the data is larger than the buffer size and b) keep up with the valid
  * frame rate of the lepton.
  *
  * RPMsg packets consist of a one-byte sequence number to allow the host to
- * validate incoming data followed by 480 bytes of 8-bit pixel data.  The
- * sequence number ranges from 0 to 39.  It is set to 0xFF to indicate that  the
+ * validate incoming data followed by 480 bytes of 8-bit pixel data (240 16-bit
+ * pixels, high byte first, with LEP_16BIT).  The sequence number ranges from 0
+ * to 39 (0 to 79 with LEP_16BIT).  It is set to 0xFF to indicate that  the
  * transfer is invalid (PRU0 detected an invalid packet after it initiated PRU1
  * transfer).
  *
+ * When DDR_RING is defined in pru_common.h PRU0 instead captures complete
+ * frames directly into a ring of DDR_RING_FRAMES frames in a DDR carve-out that
+ * the host maps from /dev/mem.  This code manages the ring: it offers PRU0 the
+ * next free frame through the shared memory SLOT register and makes each frame
+ * PRU0 hands back through the DONE register available to the host.  Since PRU0
+ * always has the next frame ready it captures every Lepton frame while the host
+ * reads the previous ones.  The ring header holds free-running head (written by
+ * this PRU) and tail (written by the host) frame counts.  A 5-byte message with
+ * the physical address of the carve-out is sent when acquisition is enabled and
+ * a 5-byte notification with the new head is sent after each frame so the host
+ * only wakes once per frame.  If the ring is full PRU0 waits (discarding frames,
+ * counted in the ring header) so a slow host never stalls acquisition.
+ *
+ * With the DDR ring the host can also put this code into standby with a standby
+ * message (HOST_CMD_STANDBY in pru_common.h) so it can sleep while nothing is
+ * happening.  The PRUs keep capturing but no notifications are sent.  Instead
+ * this code takes over the ring tail, freeing the oldest frame for each new one
+ * so the ring always holds the latest frames, and checks each frame in the ring
+ * against the standby triggers: the number of pixels at or above a threshold
+ * and/or the number of pixels that changed by at least a delta from the previous
+ * frame.  When a frame has enough of them it leaves standby, writes the count to
+ * the ring header and sends a wake message (PRMSG_RING_WAKE) followed by a
+ * notification for each frame in the ring so the host has the frames that led
+ * up to the event at once.  A standby message without triggers wakes the host
+ * immediately.
+ *
+ * When FRAME_STATS is defined in pru_common.h this code also computes the
+ * minimum, maximum and sum of the pixels and a 256-bin histogram as it copies
+ * each message so the host doesn't have to walk the pixels to auto-range them.
+ * The statistics are sent in STATS_NUM_MSGS additional messages (sequence
+ * numbers following the image messages) at the end of each frame.  8-bit pixels
+ * have one bin per value.  16-bit pixels are binned over the range of the
+ * previous frame (the statistics include the bin 0 base and the bin width shift).
+ *
+ * Before sending each message this code checks PRU0's count of stored packets
+ * to make sure all of the message's data is in the circular buffer and that
+ * PRU0 hasn't overwritten any of it.  If not the frame is aborted with an abort
+ * message whose first data byte has the reason (PRMSG_ABORT_UNDERRUN when sending
+ * faster than PRU0 is storing, PRMSG_ABORT_OVERRUN when sending too slowly)
+ * instead of sending the host a corrupted frame.
+ *
  * The host can control frame aquisition by sending a one-byte message, either '0'
- * to disable or '1' to enable, via RPMsg to PRU1.  Frame aquisition will be
+ * to disable or '1' to enable, via RPMsg to PRU1.  It can also send a timing
+ * message (HOST_CMD_TIMING in pru_common.h) while aquisition is disabled to change
+ * PRU0's packet sample period and this code's message period (which sets the
+ * time to transfer a frame) from their defaults.  Frame aquisition will be
  * automatically disabled if there is a failure to send a message to the host
  * (e.g. host buffer full because consuming application has died).
  *
@@ -56,8 +102,14 @@
 /* ----------- */
 /* Sample Time */
 /* ----------- */
+/* 16-bit messages are sent faster than 16-bit packets arrive between segments  */
+/* (1 byte/uSec vs 1.25 byte/uSec) but slower than the average rate over a frame */
+/* so PRU0 stays less than one circular buffer ahead                             */
+#ifdef LEP_16BIT
+#define PKT_XMIT_USEC    480
+#else
 #define PKT_XMIT_USEC    1024
-#define PRU_CLK_PER_USEC 200
+#endif
 #define PRU_XMIT_TO      (PKT_XMIT_USEC * PRU_CLK_PER_USEC)
 
 
@@ -74,11 +126,44 @@
 /* ------------------ */
 /* Lepton 3.5 related */
 /* ------------------ */
-#define LEP_AGC_PACKET_SIZE 80
-#define LEP_AGC_FRAME_SIZE  (160 * 120)
+#ifdef LEP_16BIT
+#define LEP_PACKET_SIZE     160
+#define LEP_FRAME_SIZE      (160 * 120 * 2)
+#define LEP_PKTS_PER_MSG    3
+#else
+#define LEP_PACKET_SIZE     80
+#define LEP_FRAME_SIZE      (160 * 120)
 #define LEP_PKTS_PER_MSG    6
-#define BYTES_PER_MSG       (LEP_AGC_PACKET_SIZE * LEP_PKTS_PER_MSG)
-#define NUM_MSGS            (LEP_AGC_FRAME_SIZE / BYTES_PER_MSG)
+#endif
+#define BYTES_PER_MSG       (LEP_PACKET_SIZE * LEP_PKTS_PER_MSG)
+#define NUM_MSGS            (LEP_FRAME_SIZE / BYTES_PER_MSG)
+
+
+/* ---------------- */
+/* Frame statistics */
+/* ---------------- */
+#ifdef FRAME_STATS
+#if defined(DDR_RING)
+#error "FRAME_STATS requires the rpmsg transport"
+#endif
+#define STATS_HIST_BINS     256
+#define STATS_NUM_MSGS      2
+#define FRAME_MSGS          (NUM_MSGS + STATS_NUM_MSGS)
+#define PIXELS_PER_MSG      (LEP_PKTS_PER_MSG * 80)
+
+/* Statistics sent after the image messages - must match vospi_stats_t */
+typedef struct {
+	uint32_t num_pixels;
+	uint32_t sum;
+	uint16_t min;
+	uint16_t max;
+	uint16_t hist_base;   /* Pixel value at the start of bin 0 */
+	uint16_t hist_shift;  /* Each bin is (1 << hist_shift) pixel values wide */
+	uint16_t hist[STATS_HIST_BINS];
+} frame_stats_t;
+#else
+#define FRAME_MSGS          NUM_MSGS
+#endif
 
 
 /* --------- */
@@ -105,8 +190,44 @@
 /* RPMSG packet size */
 #define RPMSG_MSG_LEN              (BYTES_PER_MSG + 1)
 
-/* "Abort" sequence number */
+/* "Abort" sequence number and reasons (first data byte) */
 #define PRMSG_ABORT_SEQ_NUM        0xFF
+#define PRMSG_ABORT_PKT            0      /* PRU0 received a bad packet */
+#define PRMSG_ABORT_UNDERRUN       1      /* Message data not stored by PRU0 yet */
+#define PRMSG_ABORT_OVERRUN        2      /* Message data overwritten by PRU0 */
+
+/* DDR ring message types (followed by a 32-bit little endian value) */
+#define PRMSG_RING_INFO            0xFE   /* Carve-out physical address */
+#define PRMSG_RING_FRAME           0xFD   /* Ring head after a frame was written */
+#define PRMSG_RING_WAKE            0xFC   /* Ring head when standby ended */
+#define PRMSG_RING_MSG_LEN         5
+
+
+/* -------- */
+/* DDR ring */
+/* -------- */
+#ifdef DDR_RING
+#define DDR_RING_MAGIC             0x4C455052  /* "LEPR" */
+#define DDR_RING_HDR_LEN           64
+#define DDR_RING_FRAMES            4
+
+/* Ring header at the start of the carve-out - must match vospi_ring_hdr_t */
+typedef struct {
+	uint32_t magic;
+	uint32_t head;        /* Frames written by PRU1 */
+	uint32_t tail;        /* Frames consumed by the host */
+	uint32_t frame_len;
+	uint32_t num_frames;
+	uint32_t dropped;     /* Times PRU0 had to wait for a free frame */
+	uint32_t wake_pixels; /* Pixels of the last standby frame that tripped the triggers */
+} ddr_ring_hdr_t;
+
+#ifdef LEP_16BIT
+#define PIXELS_PER_WORD            2
+#else
+#define PIXELS_PER_WORD            4
+#endif
+#endif
 
 
 /* ================ */
@@ -119,16 +240,41 @@ volatile register unsigned __R30;
 volatile uint8_t* buf_en_reg_ptr = SMEM_EN_REG;
 volatile uint8_t* buf_pru1_cmd_ptr =  SMEM_CMD_REG;
 volatile uint8_t* buf_cur_ptr = SMEM_BUF_START;
+volatile uint32_t* buf_sample_reg_ptr = SMEM_SAMPLE_REG;
+#ifndef DDR_RING
+volatile uint32_t* buf_pkts_reg_ptr = SMEM_PKTS_REG;
+#endif
 
 /* Local variables */
 uint8_t run_state = RUN_STATE_STOPPED;
+uint32_t xmit_to = PRU_XMIT_TO;  /* Message period in PRU cycles */
+uint32_t timing_fail_count = 0;  /* Counts aborted frames for diag purposes */
 
 uint8_t cur_seq_num = 0;
 uint8_t msg_buffer[RPMSG_BUF_SIZE];
 
+#ifdef FRAME_STATS
+frame_stats_t stats;
+#endif
+
 struct pru_rpmsg_transport transport;
 uint16_t rpmsg_src, rpmsg_dst, rpmsg_len;
 
+#ifdef DDR_RING
+volatile uint32_t* buf_slot_reg_ptr = SMEM_SLOT_REG;
+volatile uint32_t* buf_done_reg_ptr = SMEM_DONE_REG;
+
+volatile ddr_ring_hdr_t* ring_hdr_ptr;
+uint32_t ring_offered;   /* Frames offered to PRU0 (free-running like head and tail) */
+
+/* Standby triggers (STANDBY_TRIG_xxx, 0 when not in standby) */
+uint8_t standby_triggers = 0;
+uint8_t standby_ref;     /* The previous ring frame was captured in standby */
+uint16_t standby_threshold;
+uint16_t standby_delta;
+uint16_t standby_pixels;
+#endif
+
 
 
 /* =========== */
@@ -142,6 +288,7 @@ void init_pru()
 
 	/* Always start off idle - delete any state laying around */
 	*buf_pru1_cmd_ptr = P1_CMD_IDLE;
+	*buf_sample_reg_ptr = 0;
 
 	/* Slow blink the LED to let them know we've started */
 	SET_PIN(LED,1);
@@ -184,23 +331,129 @@ void init_rpmsg()
 }	
 
 
+#ifdef FRAME_STATS
+/*
+ * Reset the statistics for a new frame.  16-bit pixels are binned over the range
+ * of the last frame.
+ */
+void init_stats()
+{
+	uint16_t i;
+#ifdef LEP_16BIT
+	uint16_t range;
+
+	if (stats.max > stats.min) {
+		stats.hist_base = stats.min;
+		range = stats.max - stats.min;
+		stats.hist_shift = 0;
+		while ((range >> stats.hist_shift) >= STATS_HIST_BINS) {
+			stats.hist_shift++;
+		}
+	} else {
+		stats.hist_base = 0;
+		stats.hist_shift = 8;
+	}
+#else
+	stats.hist_base = 0;
+	stats.hist_shift = 0;
+#endif
+
+	stats.num_pixels = 0;
+	stats.sum = 0;
+	stats.min = 0xFFFF;
+	stats.max = 0;
+	for (i=0; i<STATS_HIST_BINS; i++) {
+		stats.hist[i] = 0;
+	}
+}
+
+
+/*
+ * Include the pixels in our local message buffer in the statistics
+ */
+void update_stats()
+{
+	uint16_t i;
+	uint16_t p;
+	uint16_t bin;
+
+#ifdef LEP_16BIT
+	for (i=1; i<=BYTES_PER_MSG; i+=2) {
+		p = (msg_buffer[i] << 8) | msg_buffer[i+1];
+#else
+	for (i=1; i<=BYTES_PER_MSG; i++) {
+		p = msg_buffer[i];
+#endif
+		if (p < stats.min) stats.min = p;
+		if (p > stats.max) stats.max = p;
+		stats.sum += p;
+
+		bin = (p > stats.hist_base) ? ((p - stats.hist_base) >> stats.hist_shift) : 0;
+		if (bin >= STATS_HIST_BINS) bin = STATS_HIST_BINS - 1;
+		stats.hist[bin]++;
+	}
+	stats.num_pixels += PIXELS_PER_MSG;
+}
+
+
+/*
+ * Store the next part of the statistics in our local buffer for transmission
+ */
+void get_stats_msg()
+{
+	uint16_t i;
+	uint16_t n;
+	uint8_t* p = (uint8_t*) &stats;
+
+	n = (cur_seq_num - NUM_MSGS) * BYTES_PER_MSG;
+	for (i=1; i<=BYTES_PER_MSG; i++) {
+		msg_buffer[i] = (n < sizeof(frame_stats_t)) ? p[n] : 0;
+		n++;
+	}
+}
+#endif
+
+
 void init_send()
 {
 	cur_seq_num = 0;
 	buf_cur_ptr = SMEM_BUF_START;
+#ifdef FRAME_STATS
+	init_stats();
+#endif
 }
 
 
 /*
- * Read data from the circular buffer and store it in our local buffer for transmission
+ * Read data from the circular buffer and store it in our local buffer for transmission.
+ * Returns PRMSG_ABORT_UNDERRUN or PRMSG_ABORT_OVERRUN if PRU0 hadn't stored all of the
+ * data yet or overwrote some of it, 0 if the message is good.
  */
-void get_lep_msg()
+uint8_t get_lep_msg()
 {
 	uint16_t i;
+#ifndef DDR_RING
+	uint32_t start = (uint32_t) cur_seq_num * BYTES_PER_MSG;
+#endif
 
 	/* Load this message's sequence number */
 	msg_buffer[0] = cur_seq_num;
 
+#ifdef FRAME_STATS
+	/* The statistics follow the image */
+	if (cur_seq_num >= NUM_MSGS) {
+		get_stats_msg();
+		return 0;
+	}
+#endif
+
+#ifndef DDR_RING
+	/* All of the message must be stored */
+	if ((*buf_pkts_reg_ptr * LEP_PACKET_SIZE) < (start + BYTES_PER_MSG)) {
+		return PRMSG_ABORT_UNDERRUN;
+	}
+#endif
+
 	/* Copy bytes from the circular buffer into our message buffer */
 	for (i=1; i<=BYTES_PER_MSG; i++) {
 		msg_buffer[i] = *buf_cur_ptr++;
@@ -208,15 +461,213 @@ void get_lep_msg()
 			buf_cur_ptr = SMEM_BUF_START;
 		}
 	}
+
+#ifndef DDR_RING
+	/* and none of it overwritten while we copied it (allowing for the packet PRU0 */
+	/* is storing)                                                                 */
+	if (((*buf_pkts_reg_ptr + 1) * LEP_PACKET_SIZE - start) > SMEM_BUF_LEN) {
+		return PRMSG_ABORT_OVERRUN;
+	}
+#endif
+
+#ifdef FRAME_STATS
+	update_stats();
+#endif
+	return 0;
+}
+
+
+#ifdef DDR_RING
+/*
+ * Prepare a ring message in our local buffer for transmission
+ */
+void set_ring_msg(uint8_t type, uint32_t val)
+{
+	msg_buffer[0] = type;
+	msg_buffer[1] = val & 0xFF;
+	msg_buffer[2] = (val >> 8) & 0xFF;
+	msg_buffer[3] = (val >> 16) & 0xFF;
+	msg_buffer[4] = (val >> 24) & 0xFF;
+}
+
+
+/*
+ * Initialize the ring header in the carve-out and prepare a message with its
+ * physical address in our local buffer for transmission
+ */
+void init_ring()
+{
+	uint32_t pa = resourceTable.ddr_ring.pa;
+
+	ring_hdr_ptr = (volatile ddr_ring_hdr_t*) pa;
+	ring_hdr_ptr->head = 0;
+	ring_hdr_ptr->tail = 0;
+	ring_hdr_ptr->frame_len = LEP_FRAME_SIZE;
+	ring_hdr_ptr->num_frames = DDR_RING_FRAMES;
+	ring_hdr_ptr->dropped = 0;
+	ring_hdr_ptr->wake_pixels = 0;
+	ring_hdr_ptr->magic = DDR_RING_MAGIC;
+
+	/* Nothing offered to PRU0 yet and not in standby */
+	ring_offered = 0;
+	standby_triggers = 0;
+	*buf_done_reg_ptr = P0_NO_SLOT;
+	*buf_slot_reg_ptr = P0_NO_SLOT;
+
+	set_ring_msg(PRMSG_RING_INFO, pa);
+}
+
+
+/*
+ * Return the DDR address of a ring frame (by its free-running count)
+ */
+uint32_t ring_frame_addr(uint32_t n)
+{
+	return (uint32_t) ring_hdr_ptr + DDR_RING_HDR_LEN + (n % DDR_RING_FRAMES) * LEP_FRAME_SIZE;
+}
+
+
+/*
+ * Offer PRU0 the next free ring frame if it doesn't have one and there is one.  In
+ * standby the oldest frame is freed if the ring is full.
+ */
+void offer_ring_frame()
+{
+	if (*buf_slot_reg_ptr == P0_NO_SLOT) {
+		if ((standby_triggers != 0) && ((ring_offered - ring_hdr_ptr->tail) >= DDR_RING_FRAMES)) {
+			ring_hdr_ptr->tail += 1;
+		}
+		if ((ring_offered - ring_hdr_ptr->tail) < DDR_RING_FRAMES) {
+			*buf_slot_reg_ptr = ring_frame_addr(ring_offered);
+			ring_offered++;
+		}
+	}
+}
+
+
+/*
+ * Make the frame PRU0 has completed available to the host and prepare a notification
+ * message in our local buffer for transmission.  Counts a drop if there isn't a free
+ * frame for PRU0 to capture the next frame into.
+ */
+void push_ring_frame()
+{
+	uint32_t head;
+
+	head = ring_hdr_ptr->head + 1;
+	ring_hdr_ptr->head = head;
+	*buf_done_reg_ptr = P0_NO_SLOT;
+
+	/* (in standby the ring is always full - the oldest frame is freed instead) */
+	if ((standby_triggers == 0) && ((ring_offered - ring_hdr_ptr->tail) >= DDR_RING_FRAMES)) {
+		ring_hdr_ptr->dropped += 1;
+	}
+
+	set_ring_msg(PRMSG_RING_FRAME, head);
+}
+
+
+/*
+ * Set the standby triggers from a HOST_CMD_STANDBY message in our local buffer
+ */
+void set_standby()
+{
+	standby_triggers = msg_buffer[1] & (STANDBY_TRIG_THRESHOLD | STANDBY_TRIG_CHANGE);
+	standby_threshold = msg_buffer[2] | (msg_buffer[3] << 8);
+	standby_delta = msg_buffer[4] | (msg_buffer[5] << 8);
+	standby_pixels = msg_buffer[6] | (msg_buffer[7] << 8);
+	if (standby_pixels == 0) {
+		standby_pixels = 1;
+	}
+	standby_ref = 0;
+	SET_PIN(LED,0);
+}
+
+
+/*
+ * Count the pixels of the last frame pushed into the ring that trip the standby
+ * triggers, stopping when there are enough.  The frame is read from DDR a word
+ * at a time.  The previous frame is only compared when it was also captured in
+ * standby (the ring then holds it).
+ */
+uint32_t standby_count()
+{
+	volatile uint32_t* cur = (volatile uint32_t*) ring_frame_addr(ring_hdr_ptr->head - 1);
+	volatile uint32_t* prev = (volatile uint32_t*) ring_frame_addr(ring_hdr_ptr->head - 2);
+	uint8_t thresh = standby_triggers & STANDBY_TRIG_THRESHOLD;
+	uint8_t change = (standby_triggers & STANDBY_TRIG_CHANGE) && standby_ref;
+	uint32_t count = 0;
+	uint32_t w;
+	uint32_t pw = 0;
+	uint16_t i, j;
+	uint16_t p, pp;
+
+	if (!thresh && !change) {
+		return 0;
+	}
+
+	for (i=0; i<(LEP_FRAME_SIZE / 4); i++) {
+		w = cur[i];
+		if (change) {
+			pw = prev[i];
+		}
+		for (j=0; j<PIXELS_PER_WORD; j++) {
+#ifdef LEP_16BIT
+			/* Pixels are stored high byte first */
+			p = ((w & 0xFF) << 8) | ((w >> 8) & 0xFF);
+			pp = ((pw & 0xFF) << 8) | ((pw >> 8) & 0xFF);
+			w >>= 16;
+			pw >>= 16;
+#else
+			p = w & 0xFF;
+			pp = pw & 0xFF;
+			w >>= 8;
+			pw >>= 8;
+#endif
+			if ((thresh && (p >= standby_threshold)) ||
+			    (change && (((p > pp) ? (p - pp) : (pp - p)) >= standby_delta))) {
+				if (++count >= standby_pixels) {
+					return count;
+				}
+			}
+		}
+	}
+
+	return count;
 }
+#endif
 
 
 /*
  * Prepare an "abort" message in our local buffer for transmission
  */
-void set_abort_msg()
+void set_abort_msg(uint8_t reason)
 {
 	msg_buffer[0] = PRMSG_ABORT_SEQ_NUM;
+	msg_buffer[1] = reason;
+}
+
+
+/*
+ * Set the timing from a HOST_CMD_TIMING message in our local buffer
+ */
+void set_timing()
+{
+	uint16_t sample_usec = msg_buffer[1] | (msg_buffer[2] << 8);
+	uint16_t xmit_usec = msg_buffer[3] | (msg_buffer[4] << 8);
+
+	/* PRU0 latches its sample period when it is next enabled */
+	if ((sample_usec >= SAMPLE_USEC_MIN) && (sample_usec <= SAMPLE_USEC_MAX)) {
+		*buf_sample_reg_ptr = (uint32_t) sample_usec * PRU_CLK_PER_USEC;
+	} else {
+		*buf_sample_reg_ptr = 0;
+	}
+
+	if ((xmit_usec >= XMIT_USEC_MIN) && (xmit_usec <= XMIT_USEC_MAX)) {
+		xmit_to = (uint32_t) xmit_usec * PRU_CLK_PER_USEC;
+	} else {
+		xmit_to = PRU_XMIT_TO;
+	}
 }
 
 
@@ -226,13 +677,46 @@ void set_abort_msg()
  */
 int send_msg()
 {
-	if (pru_rpmsg_send(&transport, rpmsg_dst, rpmsg_src, msg_buffer, RPMSG_MSG_LEN) == PRU_RPMSG_SUCCESS) {
+#ifdef DDR_RING
+	uint16_t len = PRMSG_RING_MSG_LEN;
+#else
+	uint16_t len = RPMSG_MSG_LEN;
+#endif
+
+	if (pru_rpmsg_send(&transport, rpmsg_dst, rpmsg_src, msg_buffer, len) == PRU_RPMSG_SUCCESS) {
 		return 1;
 	}
 	return 0;
 }
 
 
+#ifdef DDR_RING
+/*
+ * Leave standby: send the host a wake message followed by a notification for each
+ * frame in the ring (oldest first).  The host owns the tail again once it has the
+ * wake message.  Return 0 if a send was unsuccessful, 1 if they were all successful.
+ */
+int standby_wake()
+{
+	uint32_t head = ring_hdr_ptr->head;
+	uint32_t n = ring_hdr_ptr->tail;
+
+	standby_triggers = 0;
+	set_ring_msg(PRMSG_RING_WAKE, head);
+	if (send_msg() == 0) {
+		return 0;
+	}
+	while (n != head) {
+		set_ring_msg(PRMSG_RING_FRAME, ++n);
+		if (send_msg() == 0) {
+			return 0;
+		}
+	}
+	return 1;
+}
+#endif
+
+
 /*
  * Timer control
  */
@@ -254,7 +738,7 @@ void init_timer()
  */
 int timer_expired()
 {
-	if (PRU1_CTRL.CYCLE >= PRU_XMIT_TO) {
+	if (PRU1_CTRL.CYCLE >= xmit_to) {
 		init_timer();
 		return 1;
 	}
@@ -271,12 +755,33 @@ void disable_acq()
 	run_state = RUN_STATE_STOPPED;
 	disable_timer();
 	SET_PIN(LED,0);
+#ifdef DDR_RING
+	standby_triggers = 0;
+#endif
 
 	/* Tell PRU0 to stop */
 	*buf_en_reg_ptr = P0_DISABLE;
 }
 
 
+/*
+ * Stop acquisition and attempt to re-establish communication with the host after
+ * a failure to send it a message
+ */
+void host_lost()
+{
+	/* Stop acquisition */
+	disable_acq();
+
+	/* Attempt to destory the existing channel */
+	(void) pru_rpmsg_channel(RPMSG_NS_DESTROY, &transport, CHAN_NAME,
+	                         CHAN_DESC, CHAN_PORT);
+
+	/* Attempt to reinitialize the RPmsg facility */
+	init_rpmsg();
+}
+
+
 
 /* ==== */
 /* Main */
@@ -301,9 +806,31 @@ void main()
 					if (msg_buffer[0] == '0') {
 						/* Stop */
 						disable_acq();
+					} else if (msg_buffer[0] == HOST_CMD_TIMING) {
+						/* New timing */
+						if (rpmsg_len >= HOST_CMD_TIMING_LEN) {
+							set_timing();
+						}
+#ifdef DDR_RING
+					} else if (msg_buffer[0] == HOST_CMD_STANDBY) {
+						/* Enter standby (or wake now without triggers) */
+						if ((rpmsg_len >= HOST_CMD_STANDBY_LEN) && (run_state != RUN_STATE_STOPPED)) {
+							set_standby();
+							if ((standby_triggers == 0) && (standby_wake() == 0)) {
+								host_lost();
+								break;
+							}
+						}
+#endif
 					} else {
 						/* Start */
 						run_state = RUN_STATE_WAIT;
+#ifdef DDR_RING
+						/* Tell the host where the ring is and give PRU0 a frame */
+						init_ring();
+						(void) send_msg();
+						offer_ring_frame();
+#endif
 
 						/* Tell PRU0 to start */
 						*buf_en_reg_ptr = P0_ENABLE;
@@ -312,6 +839,39 @@ void main()
 			}
 		}
 		
+#ifdef DDR_RING
+		if (run_state != RUN_STATE_STOPPED) {
+			/* Look for a frame from PRU0 */
+			if (*buf_done_reg_ptr != P0_NO_SLOT) {
+				/* Make the frame available */
+				push_ring_frame();
+				if (standby_triggers == 0) {
+					/* Notify the host */
+					INVERT_PIN(LED);
+					if (send_msg() == 0) {
+						host_lost();
+						continue;
+					}
+				} else {
+					/* Let PRU0 start the next frame (freeing the oldest) before */
+					/* checking this one against the triggers                    */
+					offer_ring_frame();
+					ring_hdr_ptr->wake_pixels = standby_count();
+					if (ring_hdr_ptr->wake_pixels >= standby_pixels) {
+						if (standby_wake() == 0) {
+							host_lost();
+							continue;
+						}
+					} else {
+						standby_ref = 1;
+					}
+				}
+			}
+
+			/* Make sure PRU0 has a frame for its next capture */
+			offer_ring_frame();
+		}
+#else
 		if (run_state != RUN_STATE_STOPPED) {
 			if (run_state == RUN_STATE_WAIT) {
 				/* Wait to be triggered */
@@ -328,38 +888,43 @@ void main()
 					/* Terminate this transfer */
 					*buf_pru1_cmd_ptr = P1_CMD_IDLE; /* Tell PRU0 we got the abort */
 					run_state = RUN_STATE_WAIT;
-					set_abort_msg();
+					set_abort_msg(PRMSG_ABORT_PKT);
 					host_present = send_msg();
 					SET_PIN(LED,0);
 
 				} else {
 					/* Process data from the circular buffer */
 					if (timer_expired()) {
-						get_lep_msg();
-						host_present = send_msg();
-						if (++cur_seq_num == NUM_MSGS) {
-						       	/* Tell PRU0 we finished the frame */
-							*buf_pru1_cmd_ptr = P1_CMD_IDLE;
+						uint8_t reason = get_lep_msg();
 
-							/* Done with this frame */
+						if (reason != 0) {
+							/* Our timing doesn't match PRU0's - give up on this frame */
+							/* (PRU0 finishes it and then waits for the next one)     */
+							timing_fail_count++;
+							*buf_pru1_cmd_ptr = P1_CMD_IDLE;
 							run_state = RUN_STATE_WAIT;
+							set_abort_msg(reason);
+							host_present = send_msg();
 							SET_PIN(LED,0);
+						} else {
+							host_present = send_msg();
+							if (++cur_seq_num == FRAME_MSGS) {
+						       		/* Tell PRU0 we finished the frame */
+								*buf_pru1_cmd_ptr = P1_CMD_IDLE;
+
+								/* Done with this frame */
+								run_state = RUN_STATE_WAIT;
+								SET_PIN(LED,0);
+							}
 						}
 					}
 				}
 
 				if (host_present == 0) {
-					/* Stop acquisition */
-					disable_acq();
-
-					/* Attempt to destory the existing channel */
-					(void) pru_rpmsg_channel(RPMSG_NS_DESTROY, &transport, CHAN_NAME,
-					                         CHAN_DESC, CHAN_PORT);
-
-					/* Attempt to reinitialize the RPmsg facility */
-					init_rpmsg();
+					host_lost();
 				}
 			}
 		}
+#endif
 	}
 }
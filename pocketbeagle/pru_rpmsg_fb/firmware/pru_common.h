@@ -2,17 +2,75 @@
  * Common header for both PRUs
  */
 
+/* Uncomment to transfer the full 16-bit Lepton data words (Radiometric TLinear       */
+/* pixels) instead of the low 8-bits (AGC pixels).  Must match VOSPI_16BIT in the     */
+/* application's vospi.h                                                              */
+//#define LEP_16BIT
+
+/* Uncomment to have PRU0 capture complete frames directly into a ring in a DDR        */
+/* carve-out (allocated by remoteproc from PRU1's resource table) that PRU1 hands to  */
+/* the host instead of passing the frame data through the shared memory circular     */
+/* buffer and rpmsg messages.  Must match VOSPI_DDR_RING in the application's vospi.h */
+//#define DDR_RING
+
+/* Uncomment to have PRU1 compute the minimum, maximum, sum and a 256-bin histogram   */
+/* of each frame's pixels while it copies them and send them in two extra messages   */
+/* at the end of the frame (rpmsg transport only).  Must match VOSPI_FRAME_STATS in   */
+/* the application's vospi.h                                                          */
+//#define FRAME_STATS
+
+/* PRU clock rate */
+#define PRU_CLK_PER_USEC         200
+
+/* Host timing command - HOST_CMD_TIMING followed by the PRU0 packet sample period  */
+/* and the PRU1 message period in uSec as 16-bit little endian values (a value      */
+/* outside its range selects the default).  PRU1 passes the sample period to PRU0   */
+/* in PRU cycles through the SAMPLE register (0 for the default) and PRU0 latches   */
+/* it when it is enabled.  Must match the VOSPI timing values in the application's  */
+/* vospi.h                                                                          */
+#define HOST_CMD_TIMING          'T'
+#define HOST_CMD_TIMING_LEN      5
+#define SAMPLE_USEC_MIN          100
+#define SAMPLE_USEC_MAX          157
+#define XMIT_USEC_MIN            200
+#define XMIT_USEC_MAX            2000
+
+/* Host standby command (DDR_RING only) - HOST_CMD_STANDBY followed by the trigger   */
+/* bits, the pixel threshold, the pixel change and the number of pixels as 16-bit    */
+/* little endian values.  It is sent while aquisition is enabled.  PRU1 stops        */
+/* notifying the host of frames, keeps the latest frames in the ring itself and      */
+/* wakes the host when a frame has at least the number of pixels at or above the     */
+/* threshold (STANDBY_TRIG_THRESHOLD) or changed by at least the change from the     */
+/* previous frame (STANDBY_TRIG_CHANGE).  No trigger bits wakes the host at once.    */
+/* Must match the VOSPI standby values in the application's vospi.h                  */
+#define HOST_CMD_STANDBY         'S'
+#define HOST_CMD_STANDBY_LEN     8
+#define STANDBY_TRIG_THRESHOLD   0x01
+#define STANDBY_TRIG_CHANGE      0x02
+
+/* DDR ring carve-out length - large enough for the header and four 16-bit frames     */
+#define DDR_RING_LEN             0x40000
+
 /* Shared Memory Layout */
 #define SMEM_BASE_PHYS_ADDR      0x10000
 #define SMEM_LEN                 (12 * 1024)
 #define SMEM_P0_EN_OFFSET        0
 #define SMEM_P1_CMD_OFFSET       1
-#define SMEM_BUF_START_OFFSET    2
+#define SMEM_P0_SLOT_OFFSET      4
+#define SMEM_P0_DONE_OFFSET      8
+#define SMEM_P0_SAMPLE_OFFSET    12
+#define SMEM_P0_PKTS_OFFSET      16
+#define SMEM_BUF_START_OFFSET    20
 #define SMEM_BUF_END_OFFSET      (SMEM_LEN - 1)
+#define SMEM_BUF_LEN             (SMEM_BUF_END_OFFSET - SMEM_BUF_START_OFFSET + 1)
 
 /* Shared Memory Addresses */
 #define SMEM_EN_REG      (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_EN_OFFSET)
 #define SMEM_CMD_REG     (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P1_CMD_OFFSET)
+#define SMEM_SLOT_REG    (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_SLOT_OFFSET)
+#define SMEM_DONE_REG    (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_DONE_OFFSET)
+#define SMEM_SAMPLE_REG  (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_SAMPLE_OFFSET)
+#define SMEM_PKTS_REG    (volatile uint32_t*) (SMEM_BASE_PHYS_ADDR + SMEM_P0_PKTS_OFFSET)
 #define SMEM_BUF_START   (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_BUF_START_OFFSET)
 #define SMEM_BUF_END     (volatile uint8_t*) (SMEM_BASE_PHYS_ADDR + SMEM_BUF_END_OFFSET)
 
@@ -26,3 +84,15 @@
 #define P1_CMD_IN_FRAME          1
 #define P1_CMD_ABORT             2
 
+/* P0 SLOT/DONE values (DDR_RING only) - PRU1 writes the DDR address of the next free  */
+/* ring frame to SLOT.  PRU0 captures a frame into it, writes its address to DONE and  */
+/* sets SLOT to P0_NO_SLOT.  PRU1 makes the frame in DONE available to the host, sets  */
+/* DONE to P0_NO_SLOT and offers the next free frame.  PRU0 only waits for a frame     */
+/* (discarding packets) when the ring is full.                                         */
+#define P0_NO_SLOT               0
+
+/* P0 PKTS value (rpmsg transport only) - PRU0 counts the packets it has stored in the */
+/* circular buffer since the start of the frame so PRU1 can check that the data for a  */
+/* message is there (not yet stored means PRU1 is sending too fast) and hasn't been    */
+/* overwritten (PRU1 is sending too slowly) before it sends it.                        */
+#define P0_PKTS_RESET            0
@@ -0,0 +1,45 @@
+#!/bin/bash
+#
+# Script to run interval capture from /etc/rc.local (instead of run_pru_rpmsg_fb.sh)
+# on a system powered by a Pi Platter.  Each boot it takes a few frames with pru_snap
+# as soon as the PRUs and Lepton are ready, sets the Pi Platter RTC alarm to wake the
+# system again in INTERVAL seconds and shuts down (the Pi Platter powers everything
+# off when the Pocketbeagle 3.3V goes away).  Create the file NO_SHUTDOWN to keep
+# the system up (for example to log in and change the configuration).
+#
+
+# Configuration
+INTERVAL=3600                  # Seconds between captures
+FRAMES=3                       # Frames saved each wake
+SKIP=9                         # Frames discarded first while the Lepton settles
+OUTDIR=/home/debian/captures
+APPDIR=/home/debian/pru_rpmsg_fb/app
+NO_SHUTDOWN=/home/debian/no_interval_shutdown
+
+# Set the clock from the Pi Platter RTC so images are named with the capture time
+date $(talkbp -t) > /dev/null
+
+# Load and start the PRU firmware, then wait only as long as it takes the RPMsg
+# device to appear (no fixed sleeps)
+echo "am335x-pru0-fw" > /sys/class/remoteproc/remoteproc1/firmware
+echo "am335x-pru1-fw" > /sys/class/remoteproc/remoteproc2/firmware
+echo "start" > /sys/class/remoteproc/remoteproc1/state
+echo "start" > /sys/class/remoteproc/remoteproc2/state
+for i in $(seq 50); do
+    [ -e /dev/rpmsg_pru31 ] && break
+    sleep 0.1
+done
+
+# Capture
+mkdir -p $OUTDIR
+$APPDIR/pru_snap $FRAMES $OUTDIR $SKIP || logger -t interval_capture "pru_snap failed"
+
+# Re-arm the wakeup alarm relative to the RTC and enable it
+talkbp -d $INTERVAL
+talkbp -c C0=1
+
+if [ -e $NO_SHUTDOWN ]; then
+    logger -t interval_capture "$NO_SHUTDOWN exists - staying up"
+    exit 0
+fi
+shutdown now
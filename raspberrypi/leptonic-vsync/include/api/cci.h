@@ -12,6 +12,14 @@
 #define CCI_REG_COMMAND 0x0004
 #define CCI_REG_DATA_LENGTH 0x0006
 #define CCI_REG_DATA_0 0x0008
+#define CCI_REG_DATA_BUFFER 0xF800
+
+/* Largest block transfer: the 1 kB data buffer (the 16 DATA registers hold 16 words) */
+#define CCI_MAX_BLOCK_WORDS 512
+
+/* Busy poll period and the time allowed for a command to complete */
+#define CCI_BUSY_POLL_USEC 500
+#define CCI_BUSY_TIMEOUT_MSEC 5000
 
 /* Commands */
 #define CCI_CMD_SYS_RUN_FFC 0x0242
@@ -29,10 +37,12 @@
 #define CCI_CMD_AGC_GET_AGC_ENABLE_STATE 0x0100
 #define CCI_CMD_AGC_SET_AGC_ENABLE_STATE 0x0101
 
+#define CCI_CMD_OEM_GET_PART_NUMBER 0x481C
 #define CCI_CMD_OEM_GET_GPIO_MODE 0x4854
 #define CCI_CMD_OEM_SET_GPIO_MODE 0x4855
+#define CCI_CMD_OEM_RUN_REBOOT 0x4842
 
-#define WAIT_FOR_BUSY_DEASSERT() while (cci_read_register(fd, CCI_REG_STATUS) & 0x01) ;
+#define WAIT_FOR_BUSY_DEASSERT() cci_wait_busy_clear(fd);
 
 /* Telemetry Modes for use with CCI_CMD_SYS_SET_TELEMETRY_* */
 typedef enum {
@@ -78,6 +88,9 @@ int cci_init(int fd);
 /* Primative methods */
 int cci_write_register(int fd, uint16_t reg, uint16_t value);
 uint16_t cci_read_register(int fd, uint16_t reg);
+int cci_write_block(int fd, uint16_t reg, const uint16_t* words, int nwords);
+int cci_read_block(int fd, uint16_t reg, uint16_t* words, int nwords);
+int cci_wait_busy_clear(int fd);
 
 /* Module: SYS */
 void cci_run_ffc(int fd);
@@ -98,7 +111,9 @@ void cci_set_agc_enable_state(int fd, cci_agc_enable_state_t state);
 uint32_t cci_get_agc_enable_state(int fd);
 
 /* Module: OEM */
+void cci_get_part_number(int fd, char* part, int len);
 uint32_t cci_get_gpio_mode(int fd);
 void cci_set_gpio_mode(int fd, cci_gpio_mode_t mode);
+void cci_run_oem_reboot(int fd);
 
 #endif /* CCI_H */
@@ -0,0 +1,27 @@
+/*
+ * DRM/KMS local display: palette-mapped Lepton frames shown full screen on the Pi's
+ * display by a scaling hardware plane
+ *
+ */
+#ifndef DRMOUT_H
+#define DRMOUT_H
+
+#include <stdint.h>
+#include "vospi_asm.h"
+
+// The display's DRM device (the Pi 5's display controller is /dev/dri/card1)
+#define DRMOUT_DEVICE "/dev/dri/card0"
+
+// Each frame is palette mapped into a DRMOUT_WIDTH x DRMOUT_HEIGHT XRGB8888 dumb
+// buffer and scanned out by an overlay plane that the display controller scales to
+// the largest 4:3 rectangle that fits the screen (black bars fill the rest)
+#define DRMOUT_WIDTH    VOSPI_ASM_WIDTH
+#define DRMOUT_HEIGHT   VOSPI_ASM_HEIGHT
+
+// Plane buffers (one scanned out while the next is filled)
+#define DRMOUT_NUM_BUFS 2
+
+int drmout_init(const char* dev);
+void drmout_submit_frame(const uint8_t* pixels);
+
+#endif /* DRMOUT_H */
@@ -0,0 +1,40 @@
+/*
+ * H.264 output stage: palette-mapped and upscaled Lepton frames encoded by the Pi's
+ * hardware encoder (V4L2 memory-to-memory device) and streamed to a TCP client
+ *
+ */
+#ifndef H264_H
+#define H264_H
+
+#include <stdint.h>
+#include "vospi_asm.h"
+
+// The encoder's V4L2 device
+#define H264_DEVICE "/dev/video11"
+
+// The Lepton image and the encoded image (each pixel is upscaled to a H264_SCALE x
+// H264_SCALE block, H264_SCALE must be even)
+#define H264_SRC_WIDTH  VOSPI_ASM_WIDTH
+#define H264_SRC_HEIGHT VOSPI_ASM_HEIGHT
+#define H264_SCALE      (640 / H264_SRC_WIDTH)
+#define H264_WIDTH      (H264_SRC_WIDTH * H264_SCALE)
+#define H264_HEIGHT     (H264_SRC_HEIGHT * H264_SCALE)
+
+// Encoder settings.  A keyframe (with the SPS/PPS) is sent every H264_IDR_PERIOD
+// frames and when a client connects.
+#define H264_FPS        9
+#define H264_BITRATE    400000
+#define H264_IDR_PERIOD 18
+
+// Encoded frames are written as an Annex-B byte stream to the latest client to
+// connect to this TCP port (for example "ffplay -f h264 tcp://<pi>:5557" or an RTSP
+// server using it as a source)
+#define H264_PORT       5557
+
+// Maximum time to wait for the encoder
+#define H264_ENC_TO_MSEC 500
+
+int h264_init(const char* dev, int port);
+void h264_submit_frame(const uint8_t* pixels);
+
+#endif /* H264_H */
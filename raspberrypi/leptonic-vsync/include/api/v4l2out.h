@@ -0,0 +1,47 @@
+/*
+ * V4L2 output sink (v4l2loopback) using streaming I/O
+ *
+ */
+#ifndef V4L2OUT_H
+#define V4L2OUT_H
+
+#include <stdint.h>
+
+// V4L2 output sink.  Frames are written into mmap'd buffers of a V4L2 output device
+// (a v4l2loopback device, e.g. "modprobe v4l2loopback video_nr=20") and queued with
+// streaming I/O so any V4L2 application (GStreamer, ffmpeg, OpenCV) can read them from
+// the device's capture side.  Get a buffer with v4l2out_get_buf(), fill it with a
+// frame and queue it with v4l2out_put_buf().  There is no buffer (and the frame should
+// be skipped) while all of them are queued.
+
+// Default device
+#define V4L2OUT_DEV "/dev/video20"
+
+// Number of buffers
+#define V4L2OUT_NUM_BUFS 4
+
+// Frame rate the device reports
+#define V4L2OUT_FPS 9
+
+typedef struct {
+  uint8_t* p;
+  uint32_t len;
+} v4l2out_buf_t;
+
+typedef struct {
+  int fd;
+  uint32_t frame_len;                    // Bytes in a frame
+  v4l2out_buf_t bufs[V4L2OUT_NUM_BUFS];
+  int num_bufs;
+  int num_fresh;                         // Buffers not queued yet
+  int cur;                               // Buffer returned by v4l2out_get_buf() or -1
+} v4l2out_t;
+
+
+
+int v4l2out_open(v4l2out_t* out, char* dev, int width, int height, uint32_t pixfmt);
+void v4l2out_close(v4l2out_t* out);
+uint8_t* v4l2out_get_buf(v4l2out_t* out);
+int v4l2out_put_buf(v4l2out_t* out);
+
+#endif /* V4L2OUT_H */
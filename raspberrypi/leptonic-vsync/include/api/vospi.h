@@ -1,12 +1,20 @@
 /*
- * FLIR Lepton 3/3.5 VoSPI interface using VSYNC output
+ * FLIR Lepton VoSPI interface using VSYNC output
+ *
+ * Built for the Lepton 3.x by default or the Lepton 2.x with "make LEPTON=2" (see
+ * VOSPI_ASM_LEPTON in vospi_asm.h).
+ *
+ * Up to VOSPI_MAX_DEVS Leptons can share the SPI bus (one per chip select, each with
+ * its own VSYNC GPIO).  Their segment reads are scheduled so only one uses the bus at
+ * a time, oldest VSYNC first.
  *
  */
 #ifndef VOSPI_H
 #define VOSPI_H
 
 #include <stdint.h>
-#include <sys/time.h>
+#include "vospi_asm.h"
+#include "vospi_cal.h"
 
 // Flip byte order of a word
 #define FLIP_WORD_BYTES(word) (word >> 8) | (word << 8)
@@ -15,14 +23,58 @@
 #define VOSPI_PACKET_BYTES 164
 #define VOSPI_PACKET_SYMBOLS 160
 
+// The image size
+#define VOSPI_WIDTH  VOSPI_ASM_WIDTH
+#define VOSPI_HEIGHT VOSPI_ASM_HEIGHT
+
 // The maximum number of packets per segment, sufficient to include telemetry
-#define VOSPI_MAX_PACKETS_PER_SEGMENT 61
+#define VOSPI_MAX_PACKETS_PER_SEGMENT VOSPI_ASM_TEL_SEG_LINES
 // The number of packets in segments with and without telemetry lines present
-#define VOSPI_PACKETS_PER_SEGMENT_NORMAL 60
-#define VOSPI_PACKETS_PER_SEGMENT_TELEMETRY 61
+#define VOSPI_PACKETS_PER_SEGMENT_NORMAL VOSPI_ASM_SEG_LINES
+#define VOSPI_PACKETS_PER_SEGMENT_TELEMETRY VOSPI_ASM_TEL_SEG_LINES
 
 // The number of segments per frame
-#define VOSPI_SEGMENTS_PER_FRAME 4
+#define VOSPI_SEGMENTS_PER_FRAME VOSPI_ASM_SEGMENTS
+
+// Uncomment to receive telemetry as a footer (leptonic configures the Lepton for it).
+// The telemetry rows are the last packets of the last segment (61 packets per segment
+// with the last four in segment 4 for the Lepton 3.x, 63 packets with the last three
+// for the Lepton 2.x).
+//#define VOSPI_TELEM_FOOTER
+
+#ifdef VOSPI_TELEM_FOOTER
+#define VOSPI_PACKETS_PER_SEGMENT VOSPI_PACKETS_PER_SEGMENT_TELEMETRY
+#else
+#define VOSPI_PACKETS_PER_SEGMENT VOSPI_PACKETS_PER_SEGMENT_NORMAL
+#endif
+
+// Uncomment to check the CRC of each packet (a bad packet restarts the frame)
+//#define VOSPI_CHECK_CRC
+
+// Segment assembler (vospi_asm.h) configuration
+#ifdef VOSPI_TELEM_FOOTER
+#define VOSPI_ASM_TELEM_FLAGS VOSPI_ASM_TELEM
+#else
+#define VOSPI_ASM_TELEM_FLAGS 0
+#endif
+#ifdef VOSPI_CHECK_CRC
+#define VOSPI_ASM_FLAGS (VOSPI_ASM_TELEM_FLAGS | VOSPI_ASM_CHECK_CRC)
+#else
+#define VOSPI_ASM_FLAGS VOSPI_ASM_TELEM_FLAGS
+#endif
+
+// Image packets in a frame (in segment order, followed by any telemetry packets)
+#define VOSPI_IMAGE_PACKETS (VOSPI_SEGMENTS_PER_FRAME * VOSPI_PACKETS_PER_SEGMENT_NORMAL)
+
+// Telemetry packets and the location of the first one in the last segment
+#define VOSPI_TELEM_PACKETS VOSPI_ASM_TEL_LINES
+#define VOSPI_TELEM_FIRST_PACKET (VOSPI_PACKETS_PER_SEGMENT_TELEMETRY - VOSPI_TELEM_PACKETS)
+
+// Telemetry words (from row A)
+#define VOSPI_TEL_FC_LOW     20
+#define VOSPI_TEL_FC_HIGH    21
+#define VOSPI_TEL_FPA_T_K100 24
+#define VOSPI_TEL_HSE_T_K100 26
 
 // The maximum number of resets allowed before giving up on synchronising
 #define VOSPI_MAX_SYNC_RESETS 30
@@ -35,6 +87,54 @@
 #define LEP_TYP_INT_DELAY_USEC   50
 #define LEP_MAX_FRAME_DELAY_USEC (LEP_FRAME_RATE_USEC - LEP_TYP_INT_DELAY_USEC)
 
+// Uncomment to read each segment with one SPI_IOC_MESSAGE ioctl directly into the
+// frame instead of one read per packet (two transfers per packet split the ID & CRC
+// from the symbols).  The segment is larger than spidev's default
+// 4096 byte buffer so add spidev.bufsiz=65536 to /boot/cmdline.txt.
+//#define VOSPI_BATCH_SEGMENT
+
+// The GPIO the Lepton VSYNC output (its GPIO3) is connected to, and the one for a
+// second Lepton on the other chip select
+#define VOSPI_VSYNC_GPIO   4
+#define VOSPI_VSYNC_GPIO_1 17
+
+// Leptons sharing the SPI bus
+#define VOSPI_MAX_DEVS 2
+
+// Time the Lepton isn't accessed to resync it
+#define VOSPI_RESYNC_MSEC 185
+
+// Maximum time sync_and_transfer_frame() waits for a frame
+#define VOSPI_FRAME_WAIT_MSEC 1000
+
+// Consecutive VSYNC wait failures the capture thread retries (VOSPI_VSYNC_RETRY_MSEC
+// apart) before exiting
+#define VOSPI_VSYNC_MAX_FAILS  50
+#define VOSPI_VSYNC_RETRY_MSEC 100
+
+// Uncomment to read segments from our own SCHED_FIFO capture thread pinned to
+// VOSPI_RT_CPU instead of from the pigpio ISR thread.  The thread waits for VSYNC
+// edges through the sysfs gpio interface (or the GPIO character device with
+// VOSPI_GPIO_CHARDEV).  Add isolcpus=<VOSPI_RT_CPU> to
+// /boot/cmdline.txt to keep other tasks off the CPU.
+//#define VOSPI_RT_CAPTURE
+
+#define VOSPI_RT_PRIORITY     80
+#define VOSPI_RT_CPU          3
+#define VOSPI_VSYNC_TO_MSEC   100
+
+// VOSPI_GPIO_CHARDEV (defined by "make VSYNC=chardev") waits for VSYNC line events from
+// the kernel GPIO character device with epoll in a dedicated capture thread instead of
+// using pigpio (which takes DMA channels and samples the GPIO).  The segment timeout
+// is measured from the kernel's timestamp of the edge.
+#define VOSPI_GPIO_CHIP       "/dev/gpiochip0"
+
+#if defined(VOSPI_RT_CAPTURE) || defined(VOSPI_GPIO_CHARDEV)
+#define VOSPI_CAPTURE_THREAD
+#endif
+
+#include <pthread.h>
+
 // A single VoSPI packet
 typedef struct {
   uint16_t id;
@@ -42,24 +142,71 @@ typedef struct {
   uint8_t symbols[VOSPI_PACKET_SYMBOLS];
 } vospi_packet_t;
 
-// A single VoSPI segment
+// The ID & CRC of a packet
 typedef struct {
-  vospi_packet_t packets[VOSPI_MAX_PACKETS_PER_SEGMENT];
-  int packet_count;
-} vospi_segment_t;
+  uint16_t id;
+  uint16_t crc;
+} vospi_packet_meta_t;
 
-// A single VoSPI frame
+// A single VoSPI frame.  The symbols of each packet are written straight into the
+// pixel plane (image packets in order so it holds the whole image, big-endian as sent
+// by the Lepton, ready to send as is) or the telemetry plane (rows A-C and the
+// reserved row) and its ID & CRC into meta (indexed by segment and line).
 typedef struct {
-  vospi_segment_t segments[VOSPI_SEGMENTS_PER_FRAME];
+  uint8_t pixels[VOSPI_IMAGE_PACKETS * VOSPI_PACKET_SYMBOLS];
+  uint8_t telem[VOSPI_TELEM_PACKETS * VOSPI_PACKET_SYMBOLS];
+  vospi_packet_meta_t meta[VOSPI_SEGMENTS_PER_FRAME][VOSPI_MAX_PACKETS_PER_SEGMENT];
+  int64_t timestamp_usec;   // monotonic_usec() time of the VSYNC for its last segment
 } vospi_frame_t;
 
-int vospi_init(int fd, uint32_t speed, vospi_frame_t* frame);
-int sync_and_transfer_frame();
-void transfer_segment(int gpio, int level, uint32_t tick);
-int get_packet(uint8_t* line, uint8_t* seg);
-uint32_t delta_time_usec(struct timeval start, struct timeval stop);
+// The capture state of one Lepton
+typedef struct {
+  int spiFd;                 // File descriptor for SPI device file
+  int vsyncGpio;             // GPIO its VSYNC is connected to
+  vospi_frame_t* my_frame;   // Pointer to a scratch frame used to collect incoming data
+  vospi_packet_t lepPacket;  // Current incoming packet (as received)
+  vospi_asm_t lepAsm;        // Segment assembler
+  int bad_segments;          // Used to trigger resync, counts VSYNC interrupts that
+                             //   do not contain good segments.
+  int64_t resync_usec;       // VSYNCs are ignored until this time while resyncing
+
+  // Shared with the thread taking the frames (protected by frame_lock)
+  pthread_mutex_t frame_lock;
+  pthread_cond_t frame_cond; // Signalled when frame_captured is set
+  int frame_captured;        // Boolean set when the ISR has a full frame
+  uint32_t frames_captured;  // Frames the ISR has captured
+  uint32_t resyncs;          // Resyncs started because no good segment was seen
+  vospi_cal_count_t link_counts; // Segment reads since the counts were last reset (for
+                             //   SPI clock calibration)
+
+  // Segment waiting for the bus (protected by the bus scheduler)
+  int pending;
+  int64_t pending_usec;      // Time of its VSYNC
+  uint32_t late_segments;    // Segments skipped because the bus was busy past their
+                             //   window
+
+#ifdef VOSPI_CAPTURE_THREAD
+  int vsyncFd;               // File descriptor for the VSYNC gpio
+  pthread_t capture_thread;
+#endif
+#ifdef VOSPI_GPIO_CHARDEV
+  int epollFd;               // epoll instance waiting on the VSYNC line events
+  int64_t vsync_usec;        // Kernel timestamp of the latest VSYNC edge
+#endif
+} vospi_dev_t;
+
+int vospi_init(vospi_dev_t* dev, int fd, int vsync_gpio, uint32_t speed, vospi_frame_t* frame);
+int vospi_dev_init(vospi_dev_t* dev, int fd, int vsync_gpio, vospi_frame_t* frame);
+int sync_and_transfer_frame(vospi_dev_t* dev);
+void vospi_flush_frame(vospi_dev_t* dev);
+uint32_t vospi_get_frame_count(vospi_dev_t* dev);
+uint32_t vospi_get_late_count(vospi_dev_t* dev);
+uint32_t vospi_get_resync_count(vospi_dev_t* dev);
+int vospi_set_speed(vospi_dev_t* dev, uint32_t speed);
+void vospi_get_link_counts(vospi_dev_t* dev, vospi_cal_count_t* cnt, int reset);
+void vospi_vsync(vospi_dev_t* dev, int64_t vsync_usec);
+int64_t monotonic_usec();
+uint16_t vospi_telem_word(vospi_frame_t* frame, int word);
 void isr_sleep_ms(int milliseconds);
-void init_line_list();
-int line_list_valid();
 
 #endif /* VOSPI_H */
@@ -1,6 +1,8 @@
 #include "cci.h"
 #include "log.h"
+#include <string.h>
 #include <unistd.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include <sys/ioctl.h>
 
@@ -20,26 +22,98 @@ int cci_init(int fd)
 }
 
 /**
- * Write a CCI register.
+ * Write nwords consecutive CCI registers starting at reg in one I2C transaction.
  */
-int cci_write_register(int fd, uint16_t reg, uint16_t value)
+int cci_write_block(int fd, uint16_t reg, const uint16_t* words, int nwords)
 {
-  // Write the register address and value
-  uint8_t write_buf[4] = {
-    reg >> 8 & 0xff,
-    reg & 0xff,
-    value >> 8 & 0xff,
-    value & 0xff
-  };
+  uint8_t buf[CCI_WORD_LENGTH + CCI_MAX_BLOCK_WORDS * CCI_WORD_LENGTH];
+  struct i2c_msg msg;
+  struct i2c_rdwr_ioctl_data xfer;
+  int i;
+
+  if (nwords < 0 || nwords > CCI_MAX_BLOCK_WORDS) {
+    log_error("CCI: bad block write length %d", nwords);
+    return -1;
+  }
+
+  // The register address followed by the big-endian words
+  buf[0] = reg >> 8 & 0xff;
+  buf[1] = reg & 0xff;
+  for (i = 0; i < nwords; i++) {
+    buf[CCI_WORD_LENGTH + i * 2] = words[i] >> 8 & 0xff;
+    buf[CCI_WORD_LENGTH + i * 2 + 1] = words[i] & 0xff;
+  }
+
+  msg.addr = CCI_ADDRESS;
+  msg.flags = 0;
+  msg.len = CCI_WORD_LENGTH + nwords * CCI_WORD_LENGTH;
+  msg.buf = buf;
+  xfer.msgs = &msg;
+  xfer.nmsgs = 1;
+
+  if (ioctl(fd, I2C_RDWR, &xfer) != 1) {
+    log_error("CCI: failed to write %d words at CCI register %02x", nwords, reg);
+    return -1;
+  }
+
+  return 1;
+}
+
+/**
+ * Read nwords consecutive CCI registers starting at reg in one combined I2C transaction
+ * (register address write, repeated start, read).
+ * Updates cci_last_read_count to indicate how many bytes were read from the CCI.
+ */
+int cci_read_block(int fd, uint16_t reg, uint16_t* words, int nwords)
+{
+  uint8_t addr_buf[CCI_WORD_LENGTH];
+  uint8_t buf[CCI_MAX_BLOCK_WORDS * CCI_WORD_LENGTH];
+  struct i2c_msg msgs[2];
+  struct i2c_rdwr_ioctl_data xfer;
+  int i;
+
+  if (nwords < 0 || nwords > CCI_MAX_BLOCK_WORDS) {
+    log_error("CCI: bad block read length %d", nwords);
+    return -1;
+  }
+
+  addr_buf[0] = reg >> 8 & 0xff;
+  addr_buf[1] = reg & 0xff;
+
+  msgs[0].addr = CCI_ADDRESS;
+  msgs[0].flags = 0;
+  msgs[0].len = sizeof(addr_buf);
+  msgs[0].buf = addr_buf;
+  msgs[1].addr = CCI_ADDRESS;
+  msgs[1].flags = I2C_M_RD;
+  msgs[1].len = nwords * CCI_WORD_LENGTH;
+  msgs[1].buf = buf;
+  xfer.msgs = msgs;
+  xfer.nmsgs = 2;
 
-  if (write(fd, write_buf, sizeof(write_buf)) != sizeof(write_buf)) {
-    log_error("CCI: failed to write CCI register %02x with value %02x", reg, value);
+  if (ioctl(fd, I2C_RDWR, &xfer) != 2) {
+    log_error("CCI: failed to read %d words from CCI register %02x", nwords, reg);
+    cci_last_read_count = 0;
+    memset(words, 0, nwords * sizeof(uint16_t));
     return -1;
-  };
+  }
+  cci_last_read_count = nwords * CCI_WORD_LENGTH;
+
+  for (i = 0; i < nwords; i++) {
+    words[i] = buf[i * 2] << 8 | buf[i * 2 + 1];
+  }
 
   return 1;
 }
 
+/**
+ * Write a CCI register.
+ */
+int cci_write_register(int fd, uint16_t reg, uint16_t value)
+{
+  return cci_write_block(fd, reg, &value, 1);
+}
+
 /**
  * Read a CCI register.
  * Updates cci_last_read_count to indicate how many bytes were read from the CCI.
@@ -47,16 +121,58 @@ int cci_write_register(int fd, uint16_t reg, uint16_t value)
  */
 uint16_t cci_read_register(int fd, uint16_t reg)
 {
-  uint8_t read_buf[2] = {0};
+  uint16_t value = 0;
 
-  if ((cci_last_read_count = read(fd, read_buf, sizeof(read_buf))) != sizeof(read_buf)) {
-    log_error("CCI: failed to read from CCI register %02x (read %d)", reg, cci_last_read_count);
-    cci_last_read_count = 0;
+  (void) cci_read_block(fd, reg, &value, 1);
+
+  return value;
+}
+
+/**
+ * Write a 32-bit command argument to DATA_0 and DATA_1 (least significant word first).
+ */
+static void cci_write_data_u32(int fd, uint32_t value)
+{
+  uint16_t words[2] = {value & 0xffff, value >> 16 & 0xffff};
+
+  cci_write_block(fd, CCI_REG_DATA_0, words, 2);
+}
+
+/**
+ * Read a 32-bit command result from DATA_0 and DATA_1.
+ */
+static uint32_t cci_read_data_u32(int fd)
+{
+  uint16_t words[2] = {0, 0};
+
+  cci_read_block(fd, CCI_REG_DATA_0, words, 2);
+
+  return (uint32_t) words[1] << 16 | words[0];
+}
+
+/**
+ * Wait for busy to be clear in the status register.
+ * The register is polled every CCI_BUSY_POLL_USEC until the camera is not busy.  Returns -1 if that didn't happen within CCI_BUSY_TIMEOUT_MSEC.
+ */
+int cci_wait_busy_clear(int fd)
+{
+  uint16_t status;
+  int polls = (CCI_BUSY_TIMEOUT_MSEC * 1000) / CCI_BUSY_POLL_USEC;
+
+  while (polls-- > 0) {
+    if (cci_read_block(fd, CCI_REG_STATUS, &status, 1) < 0) {
+      log_error("CCI: failed to read STATUS register");
+    } else if ((status & 0x01) == 0) {
+      return 1;
+    }
+    usleep(CCI_BUSY_POLL_USEC);
   }
 
-  return read_buf[0] << 8 | read_buf[1];
+  log_error("CCI: timeout waiting for busy to clear");
+  return -1;
 }
 
+
 /**
  * Request that a flat field correction occur immediately.
  */
@@ -76,9 +192,7 @@ uint32_t cci_get_uptime(int fd)
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
   cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_SYS_GET_UPTIME);
   WAIT_FOR_BUSY_DEASSERT()
-  uint16_t ls_word = cci_read_register(fd, CCI_REG_DATA_0);
-  uint16_t ms_word = cci_read_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH);
-  return ms_word << 16 | ls_word;
+  return cci_read_data_u32(fd);
 }
 
 
@@ -89,10 +203,9 @@ void cci_set_telemetry_enable_state(int fd, cci_telemetry_enable_state_t state)
 {
   uint32_t value = state;
   WAIT_FOR_BUSY_DEASSERT()
-  cci_write_register(fd, CCI_REG_DATA_0, value & 0xffff);
-  cci_write_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH, value >> 16 & 0xffff);
-  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_SYS_SET_TELEMETRY_ENABLE_STATE);
+  cci_write_data_u32(fd, value);
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
+  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_SYS_SET_TELEMETRY_ENABLE_STATE);
   WAIT_FOR_BUSY_DEASSERT()
 }
 
@@ -105,9 +218,7 @@ uint32_t cci_get_telemetry_enable_state(int fd)
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
   cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_SYS_GET_TELEMETRY_ENABLE_STATE);
   WAIT_FOR_BUSY_DEASSERT()
-  uint16_t ls_word = cci_read_register(fd, CCI_REG_DATA_0);
-  uint16_t ms_word = cci_read_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH);
-  return ms_word << 16 | ls_word;
+  return cci_read_data_u32(fd);
 }
 
 /**
@@ -117,10 +228,9 @@ void cci_set_telemetry_location(int fd, cci_telemetry_location_t location)
 {
   uint32_t value = location;
   WAIT_FOR_BUSY_DEASSERT()
-  cci_write_register(fd, CCI_REG_DATA_0, value & 0xffff);
-  cci_write_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH, value >> 16 & 0xffff);
-  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_SYS_SET_TELEMETRY_LOCATION);
+  cci_write_data_u32(fd, value);
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
+  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_SYS_SET_TELEMETRY_LOCATION);
   WAIT_FOR_BUSY_DEASSERT()
 }
 
@@ -133,9 +243,7 @@ uint32_t cci_get_telemetry_location(int fd)
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
   cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_SYS_GET_TELEMETRY_LOCATION);
   WAIT_FOR_BUSY_DEASSERT()
-  uint16_t ls_word = cci_read_register(fd, CCI_REG_DATA_0);
-  uint16_t ms_word = cci_read_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH);
-  return ms_word << 16 | ls_word;
+  return cci_read_data_u32(fd);
 }
 
 /**
@@ -145,10 +253,9 @@ void cci_set_radiometry_enable_state(int fd, cci_radiometry_enable_state_t state
 {
   uint32_t value = state;
   WAIT_FOR_BUSY_DEASSERT()
-  cci_write_register(fd, CCI_REG_DATA_0, value & 0xffff);
-  cci_write_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH, value >> 16 & 0xffff);
-  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_RAD_SET_RADIOMETRY_ENABLE_STATE);
+  cci_write_data_u32(fd, value);
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
+  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_RAD_SET_RADIOMETRY_ENABLE_STATE);
   WAIT_FOR_BUSY_DEASSERT()
 }
 
@@ -161,9 +268,7 @@ uint32_t cci_get_radiometry_enable_state(int fd)
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
   cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_RAD_GET_RADIOMETRY_ENABLE_STATE);
   WAIT_FOR_BUSY_DEASSERT()
-  uint16_t ls_word = cci_read_register(fd, CCI_REG_DATA_0);
-  uint16_t ms_word = cci_read_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH);
-  return ms_word << 16 | ls_word;
+  return cci_read_data_u32(fd);
 }
 
 /**
@@ -173,10 +278,9 @@ void cci_set_radiometry_tlinear_enable_state(int fd, cci_radiometry_tlinear_enab
 {
   uint32_t value = state;
   WAIT_FOR_BUSY_DEASSERT()
-  cci_write_register(fd, CCI_REG_DATA_0, value & 0xffff);
-  cci_write_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH, value >> 16 & 0xffff);
-  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_ENABLE_STATE);
+  cci_write_data_u32(fd, value);
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
+  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_RAD_SET_RADIOMETRY_TLINEAR_ENABLE_STATE);
   WAIT_FOR_BUSY_DEASSERT()
 }
 
@@ -189,9 +293,7 @@ uint32_t cci_get_radiometry_tlinear_enable_state(int fd)
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
   cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_RAD_GET_RADIOMETRY_TLINEAR_ENABLE_STATE);
   WAIT_FOR_BUSY_DEASSERT()
-  uint16_t ls_word = cci_read_register(fd, CCI_REG_DATA_0);
-  uint16_t ms_word = cci_read_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH);
-  return ms_word << 16 | ls_word;
+  return cci_read_data_u32(fd);
 }
 
 /**
@@ -203,9 +305,7 @@ uint32_t cci_get_agc_enable_state(int fd)
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
   cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_AGC_GET_AGC_ENABLE_STATE);
   WAIT_FOR_BUSY_DEASSERT()
-  uint16_t ls_word = cci_read_register(fd, CCI_REG_DATA_0);
-  uint16_t ms_word = cci_read_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH);
-  return ms_word << 16 | ls_word;
+  return cci_read_data_u32(fd);
 }
 
 /**
@@ -215,13 +315,33 @@ void cci_set_agc_enable_state(int fd, cci_agc_enable_state_t state)
 {
   uint32_t value = state;
   WAIT_FOR_BUSY_DEASSERT()
-  cci_write_register(fd, CCI_REG_DATA_0, value & 0xffff);
-  cci_write_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH, value >> 16 & 0xffff);
-  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_AGC_SET_AGC_ENABLE_STATE);
+  cci_write_data_u32(fd, value);
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
+  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_AGC_SET_AGC_ENABLE_STATE);
   WAIT_FOR_BUSY_DEASSERT()
 }
 
+/**
+ * Get the OEM part number ("500-0771-01") as a string of up to len - 1 characters.
+ */
+void cci_get_part_number(int fd, char* part, int len)
+{
+  uint16_t words[16];
+  int i;
+
+  WAIT_FOR_BUSY_DEASSERT()
+  cci_write_register(fd, CCI_REG_DATA_LENGTH, 16);
+  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_OEM_GET_PART_NUMBER);
+  WAIT_FOR_BUSY_DEASSERT()
+  cci_read_block(fd, CCI_REG_DATA_0, words, 16);
+
+  // Characters are packed low byte first
+  for (i = 0; (i < len - 1) && (i < 32); i++) {
+    part[i] = (i & 1) ? words[i / 2] >> 8 : words[i / 2] & 0xff;
+  }
+  part[i] = 0;
+}
+
 /**
  * Get the GPIO mode.
  */
@@ -231,9 +351,7 @@ uint32_t cci_get_gpio_mode(int fd)
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
   cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_OEM_SET_GPIO_MODE);
   WAIT_FOR_BUSY_DEASSERT()
-  uint16_t ls_word = cci_read_register(fd, CCI_REG_DATA_0);
-  uint16_t ms_word = cci_read_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH);
-  return ms_word << 16 | ls_word;
+  return cci_read_data_u32(fd);
 }
 
 /**
@@ -244,8 +362,19 @@ void cci_set_gpio_mode(int fd, cci_gpio_mode_t mode)
   uint32_t value = mode;
   WAIT_FOR_BUSY_DEASSERT()
   cci_write_register(fd, CCI_REG_DATA_LENGTH, 2);
-  cci_write_register(fd, CCI_REG_DATA_0, value & 0xffff);
-  cci_write_register(fd, CCI_REG_DATA_0 + CCI_WORD_LENGTH, value >> 16 & 0xffff);
+  cci_write_data_u32(fd, value);
   cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_OEM_SET_GPIO_MODE);
   WAIT_FOR_BUSY_DEASSERT()
 }
+
+/**
+ * Reboot the Lepton.  It comes back with its default settings (no VSYNC output) so
+ * it has to be configured again.
+ */
+void cci_run_oem_reboot(int fd)
+{
+  WAIT_FOR_BUSY_DEASSERT()
+  cci_write_register(fd, CCI_REG_COMMAND, CCI_CMD_OEM_RUN_REBOOT);
+  sleep(6);
+  WAIT_FOR_BUSY_DEASSERT()
+}
@@ -0,0 +1,486 @@
+/*
+ * DRM/KMS local display: palette-mapped Lepton frames shown full screen on the Pi's
+ * display by a scaling hardware plane
+ *
+ * The display is driven directly through the kernel's mode setting ioctls (no X,
+ * Wayland or libdrm) so leptonic must run from the console, where it becomes the
+ * DRM master.  The first connected display is set to its preferred mode with a black
+ * screen and each frame is written into a small dumb buffer on an overlay plane.  The
+ * display controller (the Pi's HVS) scales the plane to full screen as it scans it
+ * out so only DRMOUT_WIDTH x DRMOUT_HEIGHT pixels are written per frame.
+ *
+ * Frames are handed over by drmout_submit_frame() and shown by our own thread so
+ * the display never holds up frame capture (a frame that arrives before the previous
+ * one is shown replaces it).  Each plane update is a blocking commit that completes
+ * at the next vblank so frames change without tearing.
+ *
+ */
+#include "log.h"
+#include "drmout.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <drm/drm.h>
+#include <drm/drm_fourcc.h>
+#include <drm/drm_mode.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+// drm_mode_get_connector connection state of a connected display
+#define DRMOUT_CONNECTED 1
+
+// A mmap'd dumb buffer and its framebuffer
+typedef struct {
+  uint32_t handle;
+  uint32_t pitch;
+  uint32_t fb_id;
+  uint64_t size;
+  uint8_t* p;
+} drmout_buf_t;
+
+int drmFd;                           // File descriptor for the DRM device
+uint32_t drmConnector;               // The display's connector, CRTC and overlay plane
+uint32_t drmCrtc;
+int drmCrtcIndex;
+uint32_t drmPlane;
+struct drm_mode_modeinfo drmMode;    // The display's mode
+drmout_buf_t screenBuf;              // Black full screen buffer for the primary plane
+drmout_buf_t planeBufs[DRMOUT_NUM_BUFS];
+
+// Where the plane is scaled to on the screen
+uint32_t dstX, dstY, dstW, dstH;
+
+// Palette (mapped to XRGB8888)
+uint32_t palRGB[256];
+
+// The latest frame submitted and whether it has been shown
+pthread_mutex_t drm_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t drm_cond = PTHREAD_COND_INITIALIZER;
+uint8_t drm_pixels[DRMOUT_WIDTH * DRMOUT_HEIGHT * 2];
+int drm_pending;
+
+pthread_t display_thread;
+
+
+/**
+ * Ironbow-style palette (index 0-255) stops, the same as the H.264 stream (h264.c)
+ */
+static const uint8_t pal_stops[][4] = {
+  // index, R, G, B
+  {  0,   0,   0,  10},
+  { 48,  40,   0, 120},
+  { 96, 150,   0, 145},
+  {144, 225,  65,  25},
+  {192, 250, 160,   0},
+  {232, 255, 225,  60},
+  {255, 255, 255, 230}
+};
+
+
+/**
+ * Build the XRGB8888 palette lookup table
+ */
+static void init_palette()
+{
+  int i, s, r, g, b, f, n;
+
+  s = 0;
+  for (i = 0; i < 256; i++) {
+    if (i > pal_stops[s+1][0]) {
+      s++;
+    }
+    n = pal_stops[s+1][0] - pal_stops[s][0];
+    f = i - pal_stops[s][0];
+    r = pal_stops[s][1] + (pal_stops[s+1][1] - pal_stops[s][1]) * f / n;
+    g = pal_stops[s][2] + (pal_stops[s+1][2] - pal_stops[s][2]) * f / n;
+    b = pal_stops[s][3] + (pal_stops[s+1][3] - pal_stops[s][3]) * f / n;
+
+    palRGB[i] = ((uint32_t) r << 16) | ((uint32_t) g << 8) | (uint32_t) b;
+  }
+}
+
+
+/**
+ * Stretch a frame's (big-endian) pixels over the palette into a plane buffer
+ */
+static void fill_plane(const uint8_t* pixels, drmout_buf_t* buf)
+{
+  uint32_t* dst;
+  uint16_t v, min = 0xFFFF, max = 0;
+  uint32_t range;
+  int x, y, i;
+
+  for (i = 0; i < DRMOUT_WIDTH * DRMOUT_HEIGHT; i++) {
+    v = (pixels[2*i] << 8) | pixels[2*i + 1];
+    if (v < min) min = v;
+    if (v > max) max = v;
+  }
+  range = (max > min) ? (max - min) : 1;
+
+  i = 0;
+  for (y = 0; y < DRMOUT_HEIGHT; y++) {
+    dst = (uint32_t*) (buf->p + y * buf->pitch);
+    for (x = 0; x < DRMOUT_WIDTH; x++) {
+      v = (pixels[2*i] << 8) | pixels[2*i + 1];
+      *dst++ = palRGB[((uint32_t) (v - min) * 255) / range];
+      i++;
+    }
+  }
+}
+
+
+/**
+ * Create a width x height XRGB8888 dumb buffer, map it and add it as a framebuffer.
+ * Dumb buffers start out zeroed (black).  Returns 0 for success, -1 for failure.
+ */
+static int create_buf(int width, int height, drmout_buf_t* buf)
+{
+  struct drm_mode_create_dumb create;
+  struct drm_mode_map_dumb map;
+  struct drm_mode_fb_cmd2 fb;
+
+  memset(&create, 0, sizeof(create));
+  create.width = width;
+  create.height = height;
+  create.bpp = 32;
+  if (ioctl(drmFd, DRM_IOCTL_MODE_CREATE_DUMB, &create) < 0) {
+    log_error("DRM: failed to create a %dx%d buffer", width, height);
+    return -1;
+  }
+  buf->handle = create.handle;
+  buf->pitch = create.pitch;
+  buf->size = create.size;
+
+  memset(&map, 0, sizeof(map));
+  map.handle = buf->handle;
+  if (ioctl(drmFd, DRM_IOCTL_MODE_MAP_DUMB, &map) < 0) {
+    log_error("DRM: failed to map a buffer");
+    return -1;
+  }
+  buf->p = mmap(NULL, buf->size, PROT_READ | PROT_WRITE, MAP_SHARED, drmFd, map.offset);
+  if (buf->p == MAP_FAILED) {
+    buf->p = NULL;
+    log_error("DRM: failed to map a buffer");
+    return -1;
+  }
+
+  memset(&fb, 0, sizeof(fb));
+  fb.width = width;
+  fb.height = height;
+  fb.pixel_format = DRM_FORMAT_XRGB8888;
+  fb.handles[0] = buf->handle;
+  fb.pitches[0] = buf->pitch;
+  if (ioctl(drmFd, DRM_IOCTL_MODE_ADDFB2, &fb) < 0) {
+    log_error("DRM: failed to add a framebuffer");
+    return -1;
+  }
+  buf->fb_id = fb.fb_id;
+
+  return 0;
+}
+
+
+/**
+ * Find the first connected display, its preferred mode and a CRTC that can drive it.
+ * Returns 0 for success, -1 for failure.
+ */
+static int find_display()
+{
+  struct drm_mode_card_res res;
+  struct drm_mode_get_connector conn;
+  struct drm_mode_get_encoder enc;
+  struct drm_mode_modeinfo* modes = NULL;
+  uint32_t* connectors = NULL;
+  uint32_t* crtcs = NULL;
+  uint32_t* encoders = NULL;
+  uint32_t crtc_mask;
+  int ret = -1;
+  int i, j, k;
+
+  memset(&res, 0, sizeof(res));
+  if (ioctl(drmFd, DRM_IOCTL_MODE_GETRESOURCES, &res) < 0) {
+    log_error("DRM: failed to get the resources - is this a KMS device?");
+    return -1;
+  }
+  connectors = calloc(res.count_connectors + 1, sizeof(uint32_t));
+  crtcs = calloc(res.count_crtcs + 1, sizeof(uint32_t));
+  res.count_fbs = 0;
+  res.count_encoders = 0;
+  res.connector_id_ptr = (uint64_t) (uintptr_t) connectors;
+  res.crtc_id_ptr = (uint64_t) (uintptr_t) crtcs;
+  if ((connectors == NULL) || (crtcs == NULL) || (ioctl(drmFd, DRM_IOCTL_MODE_GETRESOURCES, &res) < 0)) {
+    log_error("DRM: failed to get the resources");
+    goto done;
+  }
+
+  for (i = 0; (i < (int) res.count_connectors) && (ret < 0); i++) {
+    memset(&conn, 0, sizeof(conn));
+    conn.connector_id = connectors[i];
+    if ((ioctl(drmFd, DRM_IOCTL_MODE_GETCONNECTOR, &conn) < 0) ||
+        (conn.connection != DRMOUT_CONNECTED) || (conn.count_modes == 0)) {
+      continue;
+    }
+
+    free(modes);
+    free(encoders);
+    modes = calloc(conn.count_modes, sizeof(struct drm_mode_modeinfo));
+    encoders = calloc(conn.count_encoders + 1, sizeof(uint32_t));
+    if ((modes == NULL) || (encoders == NULL)) {
+      goto done;
+    }
+    conn.count_props = 0;
+    conn.modes_ptr = (uint64_t) (uintptr_t) modes;
+    conn.encoders_ptr = (uint64_t) (uintptr_t) encoders;
+    if ((ioctl(drmFd, DRM_IOCTL_MODE_GETCONNECTOR, &conn) < 0) || (conn.count_modes == 0)) {
+      continue;
+    }
+
+    // The preferred mode (or the first if none is)
+    drmMode = modes[0];
+    for (j = 0; j < (int) conn.count_modes; j++) {
+      if (modes[j].type & DRM_MODE_TYPE_PREFERRED) {
+        drmMode = modes[j];
+        break;
+      }
+    }
+
+    // Any CRTC one of its encoders can use
+    crtc_mask = 0;
+    for (j = 0; j < (int) conn.count_encoders; j++) {
+      memset(&enc, 0, sizeof(enc));
+      enc.encoder_id = encoders[j];
+      if (ioctl(drmFd, DRM_IOCTL_MODE_GETENCODER, &enc) == 0) {
+        crtc_mask |= enc.possible_crtcs;
+      }
+    }
+    for (k = 0; k < (int) res.count_crtcs; k++) {
+      if (crtc_mask & (1 << k)) {
+        drmConnector = conn.connector_id;
+        drmCrtc = crtcs[k];
+        drmCrtcIndex = k;
+        ret = 0;
+        break;
+      }
+    }
+  }
+
+  if (ret < 0) {
+    log_error("DRM: no connected display");
+  }
+
+done:
+  free(modes);
+  free(encoders);
+  free(connectors);
+  free(crtcs);
+  return ret;
+}
+
+
+/**
+ * Find an idle overlay plane on our CRTC that scans out XRGB8888.  Returns 0 for
+ * success, -1 for failure.
+ */
+static int find_plane()
+{
+  struct drm_mode_get_plane_res res;
+  struct drm_mode_get_plane plane;
+  uint32_t* planes = NULL;
+  uint32_t* formats = NULL;
+  uint32_t i, j;
+  int ret = -1;
+
+  memset(&res, 0, sizeof(res));
+  if (ioctl(drmFd, DRM_IOCTL_MODE_GETPLANERESOURCES, &res) < 0) {
+    log_error("DRM: failed to get the planes");
+    return -1;
+  }
+  if ((planes = calloc(res.count_planes + 1, sizeof(uint32_t))) == NULL) {
+    return -1;
+  }
+  res.plane_id_ptr = (uint64_t) (uintptr_t) planes;
+  if (ioctl(drmFd, DRM_IOCTL_MODE_GETPLANERESOURCES, &res) < 0) {
+    log_error("DRM: failed to get the planes");
+    goto done;
+  }
+
+  for (i = 0; (i < res.count_planes) && (ret < 0); i++) {
+    memset(&plane, 0, sizeof(plane));
+    plane.plane_id = planes[i];
+    if ((ioctl(drmFd, DRM_IOCTL_MODE_GETPLANE, &plane) < 0) ||
+        ((plane.possible_crtcs & (1 << drmCrtcIndex)) == 0) || (plane.fb_id != 0)) {
+      continue;
+    }
+
+    free(formats);
+    if ((formats = calloc(plane.count_format_types + 1, sizeof(uint32_t))) == NULL) {
+      goto done;
+    }
+    plane.format_type_ptr = (uint64_t) (uintptr_t) formats;
+    if (ioctl(drmFd, DRM_IOCTL_MODE_GETPLANE, &plane) < 0) {
+      continue;
+    }
+    for (j = 0; j < plane.count_format_types; j++) {
+      if (formats[j] == DRM_FORMAT_XRGB8888) {
+        drmPlane = plane.plane_id;
+        ret = 0;
+        break;
+      }
+    }
+  }
+
+  if (ret < 0) {
+    log_error("DRM: no free XRGB8888 overlay plane");
+  }
+
+done:
+  free(formats);
+  free(planes);
+  return ret;
+}
+
+
+/**
+ * Light the display in its mode with the black screen buffer on the primary plane.
+ * Returns 0 for success, -1 for failure.
+ */
+static int set_mode()
+{
+  struct drm_mode_crtc crtc;
+
+  if (create_buf(drmMode.hdisplay, drmMode.vdisplay, &screenBuf) < 0) {
+    return -1;
+  }
+
+  memset(&crtc, 0, sizeof(crtc));
+  crtc.crtc_id = drmCrtc;
+  crtc.fb_id = screenBuf.fb_id;
+  crtc.set_connectors_ptr = (uint64_t) (uintptr_t) &drmConnector;
+  crtc.count_connectors = 1;
+  crtc.mode = drmMode;
+  crtc.mode_valid = 1;
+  if (ioctl(drmFd, DRM_IOCTL_MODE_SETCRTC, &crtc) < 0) {
+    log_error("DRM: failed to set the mode - is a desktop using the display?");
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * Show a plane buffer scaled to the destination rectangle.  Returns when the display
+ * has switched to it (at a vblank).
+ */
+static int show_buf(drmout_buf_t* buf)
+{
+  struct drm_mode_set_plane set;
+
+  memset(&set, 0, sizeof(set));
+  set.plane_id = drmPlane;
+  set.crtc_id = drmCrtc;
+  set.fb_id = buf->fb_id;
+  set.crtc_x = dstX;
+  set.crtc_y = dstY;
+  set.crtc_w = dstW;
+  set.crtc_h = dstH;
+
+  // Source rectangle in 16.16 fixed point
+  set.src_w = DRMOUT_WIDTH << 16;
+  set.src_h = DRMOUT_HEIGHT << 16;
+
+  return ioctl(drmFd, DRM_IOCTL_MODE_SETPLANE, &set);
+}
+
+
+/**
+ * Display thread - palette maps each frame submitted into the plane buffer that isn't
+ * on the screen and switches the plane to it
+ */
+static void* display_frames(void* arg)
+{
+  static uint8_t pixels[sizeof(drm_pixels)];
+  int next = 0;
+
+  while (1) {
+    pthread_mutex_lock(&drm_lock);
+    while (!drm_pending) {
+      pthread_cond_wait(&drm_cond, &drm_lock);
+    }
+    memcpy(pixels, drm_pixels, sizeof(pixels));
+    drm_pending = 0;
+    pthread_mutex_unlock(&drm_lock);
+
+    fill_plane(pixels, &planeBufs[next]);
+    if (show_buf(&planeBufs[next]) < 0) {
+      log_error("DRM: failed to update the plane (errno %d)", errno);
+      continue;
+    }
+    next = (next + 1) % DRMOUT_NUM_BUFS;
+  }
+
+  return NULL;
+}
+
+
+/**
+ * Open the display, set its mode and start the display thread.  Returns 0 for
+ * success, -1 for failure.
+ */
+int drmout_init(const char* dev)
+{
+  int i;
+
+  init_palette();
+
+  log_info("opening DRM device ... %s", dev);
+  if ((drmFd = open(dev, O_RDWR | O_CLOEXEC)) < 0) {
+    log_error("DRM: failed to open %s", dev);
+    return -1;
+  }
+  if ((find_display() < 0) || (find_plane() < 0) || (set_mode() < 0)) {
+    return -1;
+  }
+  for (i = 0; i < DRMOUT_NUM_BUFS; i++) {
+    if (create_buf(DRMOUT_WIDTH, DRMOUT_HEIGHT, &planeBufs[i]) < 0) {
+      return -1;
+    }
+  }
+
+  // The largest 4:3 rectangle that fits the screen, centered
+  dstH = drmMode.vdisplay;
+  dstW = (dstH * DRMOUT_WIDTH) / DRMOUT_HEIGHT;
+  if (dstW > drmMode.hdisplay) {
+    dstW = drmMode.hdisplay;
+    dstH = (dstW * DRMOUT_HEIGHT) / DRMOUT_WIDTH;
+  }
+  dstX = (drmMode.hdisplay - dstW) / 2;
+  dstY = (drmMode.vdisplay - dstH) / 2;
+  log_info("DRM: %s, plane scaled to %ux%u", drmMode.name, dstW, dstH);
+
+  if (pthread_create(&display_thread, NULL, display_frames, NULL)) {
+    log_error("DRM: error creating thread");
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * Hand the display a frame's pixel plane (VOSPI_IMAGE_PACKETS * VOSPI_PACKET_SYMBOLS
+ * bytes).  Does not wait for it to be shown.
+ */
+void drmout_submit_frame(const uint8_t* pixels)
+{
+  pthread_mutex_lock(&drm_lock);
+  memcpy(drm_pixels, pixels, sizeof(drm_pixels));
+  drm_pending = 1;
+  pthread_cond_signal(&drm_cond);
+  pthread_mutex_unlock(&drm_lock);
+}
@@ -0,0 +1,554 @@
+/*
+ * H.264 output stage: palette-mapped and upscaled Lepton frames encoded by the Pi's
+ * hardware encoder (V4L2 memory-to-memory device) and streamed to a TCP client
+ *
+ * Frames are handed over by h264_submit_frame() and encoded by our own thread so a
+ * slow encoder or client never holds up frame capture (a frame that arrives before
+ * the previous one is encoded replaces it).  Nothing is encoded while there is no
+ * client.
+ *
+ */
+#include "log.h"
+#include "h264.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+#include <netinet/in.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// Number of encoded (capture) buffers
+#define H264_CAP_BUFS 2
+
+// A mmap'd V4L2 buffer
+typedef struct {
+  uint8_t* p;
+  size_t len;
+} h264_buf_t;
+
+int encFd;                        // File descriptor for the encoder
+h264_buf_t rawBuf;                // The encoder's input (YUV420) buffer
+h264_buf_t encBufs[H264_CAP_BUFS];// The encoder's output (H.264) buffers
+int rawStride;                    // Bytes per line of the Y plane
+
+// Palette (mapped to YUV)
+uint8_t palY[256], palU[256], palV[256];
+
+// The latest frame submitted and whether it has been encoded
+pthread_mutex_t h264_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t h264_cond = PTHREAD_COND_INITIALIZER;
+uint8_t h264_pixels[H264_SRC_WIDTH * H264_SRC_HEIGHT * 2];
+int h264_pending;
+
+// Listening socket and the client (-1 for none).  The next frame is a keyframe when
+// h264_new_client is set.
+int listenFd;
+int clientFd = -1;
+int h264_new_client;
+
+pthread_t enc_thread, accept_thread;
+
+
+/**
+ * Ironbow-style palette (index 0-255) stops
+ */
+static const uint8_t pal_stops[][4] = {
+  // index, R, G, B
+  {  0,   0,   0,  10},
+  { 48,  40,   0, 120},
+  { 96, 150,   0, 145},
+  {144, 225,  65,  25},
+  {192, 250, 160,   0},
+  {232, 255, 225,  60},
+  {255, 255, 255, 230}
+};
+
+
+/**
+ * Build the YUV (BT.601 studio range) palette lookup tables
+ */
+static void init_palette()
+{
+  int i, s, r, g, b, f, n;
+
+  s = 0;
+  for (i = 0; i < 256; i++) {
+    if (i > pal_stops[s+1][0]) {
+      s++;
+    }
+    n = pal_stops[s+1][0] - pal_stops[s][0];
+    f = i - pal_stops[s][0];
+    r = pal_stops[s][1] + (pal_stops[s+1][1] - pal_stops[s][1]) * f / n;
+    g = pal_stops[s][2] + (pal_stops[s+1][2] - pal_stops[s][2]) * f / n;
+    b = pal_stops[s][3] + (pal_stops[s+1][3] - pal_stops[s][3]) * f / n;
+
+    palY[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+    palU[i] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+    palV[i] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+  }
+}
+
+
+/**
+ * Write n values of src, each repeated factor times, to dst
+ */
+static void expand_row(const uint8_t* src, int n, int factor, uint8_t* dst)
+{
+  int i, j;
+
+#ifdef __ARM_NEON
+  uint8x16x2_t d, q0, q1;
+
+  if ((factor == 2) || (factor == 4)) {
+    for (i = 0; i + 16 <= n; i += 16) {
+      d = vzipq_u8(vld1q_u8(&src[i]), vld1q_u8(&src[i]));
+      if (factor == 2) {
+        vst1q_u8(dst, d.val[0]);
+        vst1q_u8(dst + 16, d.val[1]);
+        dst += 32;
+      } else {
+        q0 = vzipq_u8(d.val[0], d.val[0]);
+        q1 = vzipq_u8(d.val[1], d.val[1]);
+        vst1q_u8(dst, q0.val[0]);
+        vst1q_u8(dst + 16, q0.val[1]);
+        vst1q_u8(dst + 32, q1.val[0]);
+        vst1q_u8(dst + 48, q1.val[1]);
+        dst += 64;
+      }
+    }
+    src += i;
+    n -= i;
+  }
+#endif
+  for (i = 0; i < n; i++) {
+    for (j = 0; j < factor; j++) {
+      *dst++ = src[i];
+    }
+  }
+}
+
+
+/**
+ * Stretch a frame's (big-endian) pixels over the palette and write the upscaled
+ * YUV420 image to the encoder's input buffer
+ */
+static void fill_yuv(const uint8_t* pixels)
+{
+  uint8_t idx[H264_SRC_WIDTH * H264_SRC_HEIGHT];
+  uint8_t row[3][H264_SRC_WIDTH];
+  uint8_t* yP = rawBuf.p;
+  uint8_t* uP = yP + rawStride * H264_HEIGHT;
+  uint8_t* vP = uP + (rawStride / 2) * (H264_HEIGHT / 2);
+  uint16_t v, min = 0xFFFF, max = 0;
+  uint32_t range;
+  int x, y, i;
+
+  for (i = 0; i < H264_SRC_WIDTH * H264_SRC_HEIGHT; i++) {
+    v = (pixels[2*i] << 8) | pixels[2*i + 1];
+    if (v < min) min = v;
+    if (v > max) max = v;
+  }
+  range = (max > min) ? (max - min) : 1;
+  for (i = 0; i < H264_SRC_WIDTH * H264_SRC_HEIGHT; i++) {
+    v = (pixels[2*i] << 8) | pixels[2*i + 1];
+    idx[i] = ((uint32_t) (v - min) * 255) / range;
+  }
+
+  for (y = 0; y < H264_SRC_HEIGHT; y++) {
+    for (x = 0; x < H264_SRC_WIDTH; x++) {
+      row[0][x] = palY[idx[y * H264_SRC_WIDTH + x]];
+      row[1][x] = palU[idx[y * H264_SRC_WIDTH + x]];
+      row[2][x] = palV[idx[y * H264_SRC_WIDTH + x]];
+    }
+
+    // Each source row is H264_SCALE luma rows and H264_SCALE/2 chroma rows
+    for (i = 0; i < H264_SCALE; i++) {
+      expand_row(row[0], H264_SRC_WIDTH, H264_SCALE, yP);
+      yP += rawStride;
+    }
+    for (i = 0; i < H264_SCALE / 2; i++) {
+      expand_row(row[1], H264_SRC_WIDTH, H264_SCALE / 2, uP);
+      expand_row(row[2], H264_SRC_WIDTH, H264_SCALE / 2, vP);
+      uP += rawStride / 2;
+      vP += rawStride / 2;
+    }
+  }
+}
+
+
+/**
+ * Set an encoder control.  Not all are supported by all encoders so failures are
+ * only logged.
+ */
+static void set_ctrl(uint32_t id, int32_t value, const char* name)
+{
+  struct v4l2_control ctrl;
+
+  ctrl.id = id;
+  ctrl.value = value;
+  if (ioctl(encFd, VIDIOC_S_CTRL, &ctrl) < 0) {
+    log_error("H264: could not set %s", name);
+  }
+}
+
+
+/**
+ * Request and map the buffers for one of the encoder's queues
+ */
+static int map_bufs(uint32_t type, h264_buf_t* bufs, int num)
+{
+  struct v4l2_requestbuffers req;
+  struct v4l2_buffer buf;
+  struct v4l2_plane planes[VIDEO_MAX_PLANES];
+  int i;
+
+  memset(&req, 0, sizeof(req));
+  req.count = num;
+  req.type = type;
+  req.memory = V4L2_MEMORY_MMAP;
+  if ((ioctl(encFd, VIDIOC_REQBUFS, &req) < 0) || (req.count < num)) {
+    return -1;
+  }
+
+  for (i = 0; i < num; i++) {
+    memset(&buf, 0, sizeof(buf));
+    memset(planes, 0, sizeof(planes));
+    buf.type = type;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = i;
+    buf.m.planes = planes;
+    buf.length = VIDEO_MAX_PLANES;
+    if (ioctl(encFd, VIDIOC_QUERYBUF, &buf) < 0) {
+      return -1;
+    }
+    bufs[i].len = planes[0].length;
+    bufs[i].p = mmap(NULL, planes[0].length, PROT_READ | PROT_WRITE, MAP_SHARED, encFd,
+                     planes[0].m.mem_offset);
+    if (bufs[i].p == MAP_FAILED) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+
+/**
+ * Queue a buffer.  bytesused is the length of the data in an input buffer.
+ */
+static int queue_buf(uint32_t type, int index, uint32_t bytesused)
+{
+  struct v4l2_buffer buf;
+  struct v4l2_plane planes[1];
+
+  memset(&buf, 0, sizeof(buf));
+  memset(planes, 0, sizeof(planes));
+  buf.type = type;
+  buf.memory = V4L2_MEMORY_MMAP;
+  buf.index = index;
+  buf.m.planes = planes;
+  buf.length = 1;
+  planes[0].bytesused = bytesused;
+
+  return ioctl(encFd, VIDIOC_QBUF, &buf);
+}
+
+
+/**
+ * Wait up to H264_ENC_TO_MSEC for a buffer the encoder is done with.  Returns its
+ * index (and the length of its data) or -1.
+ */
+static int dequeue_buf(uint32_t type, uint32_t* bytesused)
+{
+  struct pollfd pfd;
+  struct v4l2_buffer buf;
+  struct v4l2_plane planes[1];
+
+  pfd.fd = encFd;
+  pfd.events = (type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) ? POLLIN : POLLOUT;
+  pfd.revents = 0;
+  if (poll(&pfd, 1, H264_ENC_TO_MSEC) <= 0) {
+    return -1;
+  }
+
+  memset(&buf, 0, sizeof(buf));
+  memset(planes, 0, sizeof(planes));
+  buf.type = type;
+  buf.memory = V4L2_MEMORY_MMAP;
+  buf.m.planes = planes;
+  buf.length = 1;
+  if (ioctl(encFd, VIDIOC_DQBUF, &buf) < 0) {
+    return -1;
+  }
+  *bytesused = planes[0].bytesused;
+
+  return buf.index;
+}
+
+
+/**
+ * Open and configure the encoder for H264_WIDTH x H264_HEIGHT YUV420 input and start
+ * it streaming
+ */
+static int open_encoder(const char* dev)
+{
+  struct v4l2_format fmt;
+  struct v4l2_streamparm parm;
+  uint32_t type;
+  int i;
+
+  if ((encFd = open(dev, O_RDWR | O_NONBLOCK)) < 0) {
+    log_error("H264: failed to open %s", dev);
+    return -1;
+  }
+
+  memset(&fmt, 0, sizeof(fmt));
+  fmt.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+  fmt.fmt.pix_mp.width = H264_WIDTH;
+  fmt.fmt.pix_mp.height = H264_HEIGHT;
+  fmt.fmt.pix_mp.pixelformat = V4L2_PIX_FMT_YUV420;
+  fmt.fmt.pix_mp.field = V4L2_FIELD_ANY;
+  fmt.fmt.pix_mp.colorspace = V4L2_COLORSPACE_SMPTE170M;
+  fmt.fmt.pix_mp.num_planes = 1;
+  fmt.fmt.pix_mp.plane_fmt[0].bytesperline = H264_WIDTH;
+  if (ioctl(encFd, VIDIOC_S_FMT, &fmt) < 0) {
+    log_error("H264: failed to set the input format");
+    return -1;
+  }
+  rawStride = fmt.fmt.pix_mp.plane_fmt[0].bytesperline;
+
+  memset(&fmt, 0, sizeof(fmt));
+  fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+  fmt.fmt.pix_mp.width = H264_WIDTH;
+  fmt.fmt.pix_mp.height = H264_HEIGHT;
+  fmt.fmt.pix_mp.pixelformat = V4L2_PIX_FMT_H264;
+  fmt.fmt.pix_mp.field = V4L2_FIELD_ANY;
+  fmt.fmt.pix_mp.num_planes = 1;
+  fmt.fmt.pix_mp.plane_fmt[0].sizeimage = 512 * 1024;
+  if (ioctl(encFd, VIDIOC_S_FMT, &fmt) < 0) {
+    log_error("H264: failed to set the output format");
+    return -1;
+  }
+
+  memset(&parm, 0, sizeof(parm));
+  parm.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+  parm.parm.output.timeperframe.numerator = 1;
+  parm.parm.output.timeperframe.denominator = H264_FPS;
+  (void) ioctl(encFd, VIDIOC_S_PARM, &parm);
+
+  set_ctrl(V4L2_CID_MPEG_VIDEO_BITRATE, H264_BITRATE, "bitrate");
+  set_ctrl(V4L2_CID_MPEG_VIDEO_H264_I_PERIOD, H264_IDR_PERIOD, "keyframe period");
+  set_ctrl(V4L2_CID_MPEG_VIDEO_REPEAT_SEQ_HEADER, 1, "repeated SPS/PPS");
+  set_ctrl(V4L2_CID_MPEG_VIDEO_H264_PROFILE, V4L2_MPEG_VIDEO_H264_PROFILE_CONSTRAINED_BASELINE, "profile");
+
+  if ((map_bufs(V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, &rawBuf, 1) < 0) ||
+      (map_bufs(V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE, encBufs, H264_CAP_BUFS) < 0)) {
+    log_error("H264: failed to map buffers");
+    return -1;
+  }
+  for (i = 0; i < H264_CAP_BUFS; i++) {
+    if (queue_buf(V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE, i, 0) < 0) {
+      log_error("H264: failed to queue buffers");
+      return -1;
+    }
+  }
+
+  type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+  if (ioctl(encFd, VIDIOC_STREAMON, &type) < 0) {
+    log_error("H264: failed to start the encoder");
+    return -1;
+  }
+  type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+  if (ioctl(encFd, VIDIOC_STREAMON, &type) < 0) {
+    log_error("H264: failed to start the encoder");
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * Send encoded data to the client.  Returns -1 if the send fails.
+ */
+static int send_to_client(int fd, const uint8_t* p, uint32_t len)
+{
+  ssize_t n;
+
+  while (len > 0) {
+    n = send(fd, p, len, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return -1;
+    }
+    p += n;
+    len -= n;
+  }
+
+  return 0;
+}
+
+
+/**
+ * Encode a frame and send the result to the client.  Returns -1 if the client has
+ * gone.
+ */
+static int encode_frame(const uint8_t* pixels, int fd, int keyframe)
+{
+  uint32_t len;
+  int rsp = 0;
+  int i;
+
+  fill_yuv(pixels);
+  if (keyframe) {
+    set_ctrl(V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME, 1, "keyframe");
+  }
+
+  if (queue_buf(V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, 0, rawBuf.len) < 0) {
+    log_error("H264: failed to queue frame");
+    return 0;
+  }
+  if ((i = dequeue_buf(V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE, &len)) >= 0) {
+    rsp = send_to_client(fd, encBufs[i].p, len);
+    (void) queue_buf(V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE, i, 0);
+  } else {
+    log_error("H264: encoder timeout");
+  }
+  (void) dequeue_buf(V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE, &len);
+
+  return rsp;
+}
+
+
+/**
+ * Encoder thread - encodes each frame submitted while there is a client.  Closes
+ * the client's socket when it goes or is replaced.
+ */
+static void* encode_frames(void* arg)
+{
+  static uint8_t pixels[sizeof(h264_pixels)];
+  int fd, keyframe;
+  int cur = -1;
+
+  while (1) {
+    pthread_mutex_lock(&h264_lock);
+    while (!h264_pending) {
+      pthread_cond_wait(&h264_cond, &h264_lock);
+    }
+    memcpy(pixels, h264_pixels, sizeof(pixels));
+    h264_pending = 0;
+    fd = clientFd;
+    keyframe = h264_new_client;
+    h264_new_client = 0;
+    pthread_mutex_unlock(&h264_lock);
+
+    if (fd != cur) {
+      if (cur >= 0) {
+        close(cur);
+      }
+      cur = fd;
+    }
+    if ((cur >= 0) && (encode_frame(pixels, cur, keyframe) < 0)) {
+      log_info("H264: client disconnected");
+      pthread_mutex_lock(&h264_lock);
+      if (clientFd == cur) {
+        clientFd = -1;
+      }
+      pthread_mutex_unlock(&h264_lock);
+      close(cur);
+      cur = -1;
+    }
+  }
+
+  return NULL;
+}
+
+
+/**
+ * Accept thread - the latest client to connect replaces any previous one
+ */
+static void* accept_clients(void* arg)
+{
+  int fd, old;
+
+  while (1) {
+    if ((fd = accept(listenFd, NULL, NULL)) < 0) {
+      continue;
+    }
+    log_info("H264: client connected");
+
+    pthread_mutex_lock(&h264_lock);
+    old = clientFd;
+    clientFd = fd;
+    h264_new_client = 1;
+    pthread_mutex_unlock(&h264_lock);
+    if (old >= 0) {
+      // Stop any send to it (the encoder thread closes it)
+      shutdown(old, SHUT_RDWR);
+    }
+  }
+
+  return NULL;
+}
+
+
+/**
+ * Initialise the encoder and start listening for a client on port.  Returns 0 for
+ * success, -1 for failure.
+ */
+int h264_init(const char* dev, int port)
+{
+  struct sockaddr_in addr;
+  int opt = 1;
+
+  init_palette();
+  if (open_encoder(dev) < 0) {
+    return -1;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(port);
+  listenFd = socket(AF_INET, SOCK_STREAM, 0);
+  (void) setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+  if ((listenFd < 0) || (bind(listenFd, (struct sockaddr*) &addr, sizeof(addr)) < 0) ||
+      (listen(listenFd, 1) < 0)) {
+    log_error("H264: failed to listen on port %d", port);
+    return -1;
+  }
+
+  if (pthread_create(&enc_thread, NULL, encode_frames, NULL) ||
+      pthread_create(&accept_thread, NULL, accept_clients, NULL)) {
+    log_error("H264: error creating threads");
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * Hand the encoder a frame's pixel plane (VOSPI_IMAGE_PACKETS * VOSPI_PACKET_SYMBOLS
+ * bytes).  Does not wait for it to be encoded.
+ */
+void h264_submit_frame(const uint8_t* pixels)
+{
+  pthread_mutex_lock(&h264_lock);
+  if (clientFd >= 0) {
+    memcpy(h264_pixels, pixels, sizeof(h264_pixels));
+    h264_pending = 1;
+    pthread_cond_signal(&h264_cond);
+  }
+  pthread_mutex_unlock(&h264_lock);
+}
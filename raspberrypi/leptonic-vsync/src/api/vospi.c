@@ -2,39 +2,303 @@
  * FLIR Lepton 3/3.5 VoSPI interface using VSYNC output
  *
  */
+#define _GNU_SOURCE
 #include "log.h"
 #include "vospi.h"
+#include "vospi_asm.h"
+#ifndef VOSPI_GPIO_CHARDEV
 #include "pigpio.h"
+#endif
 
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdint.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <linux/spi/spidev.h>
 #include <linux/types.h>
 #include <sys/ioctl.h>
+#ifdef VOSPI_GPIO_CHARDEV
+#include <linux/gpio.h>
+#include <sys/epoll.h>
+#endif
 
 
-vospi_frame_t* my_frame;   // Pointer to a scratch frame used to collect incoming data
-int frame_captured;        // Boolean set when the ISR has a full frame
-int line_list[60];         // Used to validate a segment - entry set to 1 when line seen
-int bad_segments;          // Used to trigger resync, counts VSYNC interrupts that
-                           //   do not contain good segments.
+// Leptons sharing the SPI bus.  Each VSYNC marks its device's segment pending and
+// whichever VSYNC handler gets the bus reads the pending segments, oldest VSYNC first,
+// until none are left.
+static vospi_dev_t* bus_devs[VOSPI_MAX_DEVS];
+static int bus_num_devs;
+static pthread_mutex_t bus_lock = PTHREAD_MUTEX_INITIALIZER;   // Held while reading
+static pthread_mutex_t sched_lock = PTHREAD_MUTEX_INITIALIZER; // Protects the pending
+                                                               //   segments
 
-int spiFd;                 // File descriptor for SPI device file
-vospi_packet_t lepPacket;  // Current incoming packet
+#ifndef VOSPI_GPIO_CHARDEV
+static int pigpio_started;
+static pthread_mutex_t pigpio_lock = PTHREAD_MUTEX_INITIALIZER; // The Leptons may be
+                                                                //   initialised at once
+#endif
 
+// Segment assembler hook context
+typedef struct {
+  vospi_dev_t* dev;
+  int64_t deadline;
+} segment_ctx_t;
+
+
+
+#ifdef VOSPI_GPIO_CHARDEV
+/**
+ * Request rising edge events for the VSYNC line from the GPIO character device.
+ * Returns the (non-blocking) event file descriptor or -1.
+ */
+static int open_vsync(int gpio)
+{
+  struct gpioevent_request req;
+  int chip_fd;
+  int rsp;
+
+  if ((chip_fd = open(VOSPI_GPIO_CHIP, O_RDONLY)) < 0) {
+    return -1;
+  }
+
+  memset(&req, 0, sizeof(req));
+  req.lineoffset = gpio;
+  req.handleflags = GPIOHANDLE_REQUEST_INPUT;
+  req.eventflags = GPIOEVENT_REQUEST_RISING_EDGE;
+  strcpy(req.consumer_label, "lepton-vsync");
+  rsp = ioctl(chip_fd, GPIO_GET_LINEEVENT_IOCTL, &req);
+  close(chip_fd);
+  if (rsp < 0) {
+    return -1;
+  }
+
+  (void) fcntl(req.fd, F_SETFL, O_NONBLOCK);
+  return req.fd;
+}
+
+
+/**
+ * Wait for the next VSYNC line event.  Returns 1 for VSYNC, 0 for a timeout and -1
+ * for an error.
+ */
+static int wait_vsync(vospi_dev_t* dev)
+{
+  struct epoll_event ev;
+  struct gpioevent_data event;
+  int rsp;
+
+  rsp = epoll_wait(dev->epollFd, &ev, 1, VOSPI_VSYNC_TO_MSEC);
+  if (rsp <= 0) {
+    return ((rsp < 0) && (errno != EINTR)) ? -1 : 0;
+  }
+
+  // Take all the waiting events (we only care about the latest one)
+  rsp = 0;
+  while (read(dev->vsyncFd, &event, sizeof(event)) == sizeof(event)) {
+    dev->vsync_usec = event.timestamp / 1000;
+    rsp = 1;
+  }
+
+  return rsp;
+}
+#elif defined(VOSPI_RT_CAPTURE)
+/**
+ * Write a string to a sysfs file.  Returns false if the write fails.
+ */
+static int write_sysfs(char* path, char* val)
+{
+  int fd;
+  int n;
+
+  if ((fd = open(path, O_WRONLY)) < 0) {
+    return 0;
+  }
+  n = write(fd, val, strlen(val));
+  close(fd);
+
+  return (n == strlen(val));
+}
+
+
+/**
+ * Export the VSYNC gpio through sysfs for rising edge interrupts and open its value
+ * file.  Returns the file descriptor or -1.
+ */
+static int open_vsync(int gpio)
+{
+  char path[64];
+  char val[8];
+
+  sprintf(path, "/sys/class/gpio/gpio%d/value", gpio);
+  if (access(path, F_OK) != 0) {
+    sprintf(val, "%d", gpio);
+    (void) write_sysfs("/sys/class/gpio/export", val);
+  }
+
+  sprintf(path, "/sys/class/gpio/gpio%d/direction", gpio);
+  if (!write_sysfs(path, "in")) {
+    return -1;
+  }
+  sprintf(path, "/sys/class/gpio/gpio%d/edge", gpio);
+  if (!write_sysfs(path, "rising")) {
+    return -1;
+  }
+
+  sprintf(path, "/sys/class/gpio/gpio%d/value", gpio);
+  return open(path, O_RDONLY);
+}
+
+
+/**
+ * Wait for the next VSYNC rising edge.  Returns 1 for VSYNC, 0 for a timeout and -1
+ * for an error.
+ */
+static int wait_vsync(vospi_dev_t* dev)
+{
+  struct pollfd pfd;
+  char c;
+  int rsp;
+
+  pfd.fd = dev->vsyncFd;
+  pfd.events = POLLPRI | POLLERR;
+  pfd.revents = 0;
+  rsp = poll(&pfd, 1, VOSPI_VSYNC_TO_MSEC);
+  if (rsp < 0) {
+    return (errno == EINTR) ? 0 : -1;
+  }
+
+  // Clear the edge
+  (void) lseek(dev->vsyncFd, 0, SEEK_SET);
+  (void) read(dev->vsyncFd, &c, 1);
+
+  return (rsp > 0) ? 1 : 0;
+}
+#endif
+
+
+/**
+ * Time of the VSYNC being handled.  The kernel's timestamp of the edge when we have
+ * one.
+ */
+static int64_t vsync_time(vospi_dev_t* dev)
+{
+  int64_t now = monotonic_usec();
+
+#ifdef VOSPI_GPIO_CHARDEV
+  if ((dev->vsync_usec <= now) && ((now - dev->vsync_usec) < LEP_MAX_FRAME_DELAY_USEC)) {
+    return dev->vsync_usec;
+  }
+#endif
+  return now;
+}
+
+
+#ifdef VOSPI_CAPTURE_THREAD
+/**
+ * Capture thread - reads a segment on each VSYNC rising edge
+ */
+static void* capture_segments(void* arg)
+{
+  vospi_dev_t* dev = (vospi_dev_t*) arg;
+  int rsp;
+  int failures = 0;
+
+  while (1) {
+    rsp = wait_vsync(dev);
+    if (rsp < 0) {
+      // Retry a transient failure, giving up only when the wait keeps failing
+      if (++failures > VOSPI_VSYNC_MAX_FAILS) {
+        log_fatal("VSYNC: wait failed");
+        exit(-1);
+      }
+      log_error("VSYNC: wait failed - retrying");
+      usleep(VOSPI_VSYNC_RETRY_MSEC * 1000);
+    } else {
+      failures = 0;
+      if (rsp > 0) {
+        vospi_vsync(dev, vsync_time(dev));
+      }
+    }
+  }
+
+  return NULL;
+}
+
+
+/**
+ * Start the capture thread (with SCHED_FIFO priority pinned to VOSPI_RT_CPU for
+ * VOSPI_RT_CAPTURE, falling back to normal scheduling if that isn't permitted).
+ * Returns 0 for success, -1 for failure.
+ */
+static int start_capture_thread(vospi_dev_t* dev)
+{
+  int rsp = -1;
+#ifdef VOSPI_RT_CAPTURE
+  pthread_attr_t attr;
+  struct sched_param param;
+  cpu_set_t cpus;
+
+  pthread_attr_init(&attr);
+  pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+  pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+  param.sched_priority = VOSPI_RT_PRIORITY;
+  pthread_attr_setschedparam(&attr, &param);
+  rsp = pthread_create(&dev->capture_thread, &attr, capture_segments, dev);
+  pthread_attr_destroy(&attr);
+  if (rsp != 0) {
+    log_error("Capture thread: SCHED_FIFO not permitted - using normal scheduling");
+  }
+#endif
+  if ((rsp != 0) && (pthread_create(&dev->capture_thread, NULL, capture_segments, dev) != 0)) {
+    log_fatal("Error creating capture thread");
+    return -1;
+  }
+
+#ifdef VOSPI_RT_CAPTURE
+  CPU_ZERO(&cpus);
+  CPU_SET(VOSPI_RT_CPU, &cpus);
+  if (pthread_setaffinity_np(dev->capture_thread, sizeof(cpus), &cpus) != 0) {
+    log_error("Capture thread: could not pin to CPU %d", VOSPI_RT_CPU);
+  }
+#endif
+
+  return 0;
+}
+#else
+/**
+ * pigpio VSYNC ISR (userdata is the device)
+ */
+static void vsync_isr(int gpio, int level, uint32_t tick, void* userdata)
+{
+  vospi_dev_t* dev = (vospi_dev_t*) userdata;
+
+  if (level == 1) {
+    vospi_vsync(dev, vsync_time(dev));
+  }
+}
+#endif
 
 
 /**
- * Initialise the VoSPI interface. frame points to a scratch buffer for
- * use by this code to store a received frame.  Calling code must initialize
- * the Lepton to output VSYNC pulses.
+ * Initialise the VoSPI interface for the Lepton on the SPI device fd with its VSYNC
+ * on vsync_gpio. frame points to a scratch buffer for use by this code to store a
+ * received frame.  Calling code must initialize the Lepton to output VSYNC pulses.
  */
-int vospi_init(int fd, uint32_t speed, vospi_frame_t* frame)
+int vospi_init(vospi_dev_t* dev, int fd, int vsync_gpio, uint32_t speed, vospi_frame_t* frame)
 {
+#ifdef VOSPI_GPIO_CHARDEV
+  struct epoll_event ev;
+#endif
+#ifndef VOSPI_CAPTURE_THREAD
   int i;
+#endif
 
   // Set the various SPI parameters
   log_debug("setting SPI device mode...");
@@ -57,231 +321,563 @@ int vospi_init(int fd, uint32_t speed, vospi_frame_t* frame)
     return -1;
   }
 
-  // Setup the vsync interrupt handler
-  i = gpioInitialise();
-  if (i == PI_INIT_FAILED) {
-    log_fatal("gpioInitialize failed: %d", i);
+  // Initialise the capture state and add the Lepton to the bus
+  if (vospi_dev_init(dev, fd, vsync_gpio, frame) < 0) {
+    log_fatal("SPI: more than %d Leptons", VOSPI_MAX_DEVS);
+    return -1;
+  }
+
+#ifdef VOSPI_CAPTURE_THREAD
+  // Start the vsync capture thread
+  if ((dev->vsyncFd = open_vsync(vsync_gpio)) < 0) {
+    log_fatal("VSYNC: failed to open gpio %d - check permissions", vsync_gpio);
+    return -1;
+  }
+#ifdef VOSPI_GPIO_CHARDEV
+  dev->epollFd = epoll_create1(0);
+  ev.events = EPOLLIN;
+  ev.data.fd = dev->vsyncFd;
+  if ((dev->epollFd < 0) ||
+      (epoll_ctl(dev->epollFd, EPOLL_CTL_ADD, dev->vsyncFd, &ev) < 0)) {
+    log_fatal("VSYNC: failed to setup epoll");
     return -1;
   }
-  i = gpioSetISRFunc(4, RISING_EDGE, 20, transfer_segment);
+#endif
+  if (start_capture_thread(dev)) {
+    return -1;
+  }
+#else
+  // Setup the vsync interrupt handler (pigpio is shared by the Leptons)
+  pthread_mutex_lock(&pigpio_lock);
+  if (!pigpio_started) {
+    i = gpioInitialise();
+    if (i == PI_INIT_FAILED) {
+      pthread_mutex_unlock(&pigpio_lock);
+      log_fatal("gpioInitialize failed: %d", i);
+      return -1;
+    }
+    pigpio_started = 1;
+  }
+  pthread_mutex_unlock(&pigpio_lock);
+  i = gpioSetISRFuncEx(vsync_gpio, RISING_EDGE, 0, vsync_isr, dev);
   if (i != 0) {
-    log_fatal("gpioSetISRFunc failed: %d", i);
+    log_fatal("gpioSetISRFuncEx failed: %d", i);
     return -1;
   }
+#endif
 
-  // Save the SPI file descriptor for use in the ISR
-  spiFd = fd;
+  return 1;
+}
 
-  // Initialise variables
-  my_frame = frame;
-  frame_captured = 0;
-  bad_segments = 0;
 
-  return 1;
+/**
+ * Initialise the capture state of dev and add it to the Leptons sharing the bus
+ * without touching the SPI device or VSYNC gpio (called by vospi_init).  Returns -1
+ * if the bus already has VOSPI_MAX_DEVS Leptons.
+ */
+int vospi_dev_init(vospi_dev_t* dev, int fd, int vsync_gpio, vospi_frame_t* frame)
+{
+  pthread_condattr_t cond_attr;
+
+  memset(dev, 0, sizeof(vospi_dev_t));
+  dev->spiFd = fd;
+  dev->vsyncGpio = vsync_gpio;
+  dev->my_frame = frame;
+  vospi_asm_init(&dev->lepAsm, VOSPI_ASM_FLAGS);
+  pthread_mutex_init(&dev->frame_lock, NULL);
+  pthread_condattr_init(&cond_attr);
+  pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC);
+  pthread_cond_init(&dev->frame_cond, &cond_attr);
+
+  pthread_mutex_lock(&sched_lock);
+  if (bus_num_devs == VOSPI_MAX_DEVS) {
+    pthread_mutex_unlock(&sched_lock);
+    return -1;
+  }
+  bus_devs[bus_num_devs++] = dev;
+  pthread_mutex_unlock(&sched_lock);
+
+  return 0;
 }
 
 
 /**
- * Main thread access to stored frames.  Main code must copy data from the
- * scratch frame before the next VSYNC (It has about 74 mSec - 2/3 of a frame
- * period - to do so)
+ * Main thread access to stored frames.  Waits up to VOSPI_FRAME_WAIT_MSEC for the
+ * ISR to capture a frame.  Returns 1 when there is a frame, 0 for a timeout.  Main
+ * code must copy data from the scratch frame before the next VSYNC (It has about
+ * 74 mSec - 2/3 of a frame period - to do so)
  */
-int sync_and_transfer_frame()
+int sync_and_transfer_frame(vospi_dev_t* dev)
 {
-  if (frame_captured) {
-    frame_captured = 0;   // Note we've consumed the buffer
-    return (1);
-  } else {
-    return (0);
-  }
-}
-
-
-/**
- * VSYNC ISR Handler - reads packets from the lepton until it determines the
- * current set is gargage or discard or until it has a full segment.  Stores
- * in-process frame in local buffer, sets frame_captured to 1 when a valid
- * frame has been read. 
- * 
- */
-void transfer_segment(int gpio, int level, uint32_t tick)
-{
-  uint8_t line, prevLine;
-  uint8_t segment;
-  int done = 0;
-  int beforeValidData = 1;
-  static int curSegment = 1;
-  static int validSegmentRegion = 0;
-  struct timeval startT, curT;
-
-  (void) gettimeofday(&startT, NULL);
-  prevLine = 255;
-
-  // Clear our list of valid lines
-  init_line_list();
-
-  // Attempt to collect a segment's worth of lines
-  while (!done) {
-    if (get_packet(&line, &segment)) {
-      // Saw a valid packet
-      if ((line == prevLine) || (line > 59)) {
-        // This is garbage data since line numbers should always increment
-        done = 1;
-      } else {
-        // Check for termination or completion conditions
-        if (line == 20) {
-          // Check segment
-          if (!validSegmentRegion) {
-            // Look for start of valid segment data
-            if (segment == 1) {
-              beforeValidData = 0;
-              validSegmentRegion = 1;
-            }
-          } else if ((segment < 2) || (segment > 4)) {
-            // Hold/Reset in starting position (always collecting in segment 1 buffer
-            // locations)
-            validSegmentRegion = 0;  // In case it was set
-            curSegment = 1;
-          }
-        } 
-        
-        // Copy the data to the current frame
-        //  - beforeValidData is used to collect data before we know if the current segment
-        //   (1) is valid
-        //  - then we use validSegmentRegion for remaining data once we know we're seeing
-        //    valid data
-        if ((beforeValidData || validSegmentRegion) && (line <= 59)) {
-          // Note line
-          line_list[line] = 1;
-
-          // Copy the already flipped id/crc
-          my_frame-> segments[curSegment-1].packets[line].id = lepPacket.id;
-          my_frame-> segments[curSegment-1].packets[line].crc = lepPacket.crc;
-          uint8_t* sPtr = my_frame->segments[curSegment-1].packets[line].symbols;
-          for (int i = 0; i < VOSPI_PACKET_SYMBOLS; i++) {
-            *sPtr++ = lepPacket.symbols[i];
-          }
-        }
-        
-        if (line == 59) {
-          // Saw a complete segment, move to next segment or complete frame aquisition
-          // if possible
-          if (validSegmentRegion && line_list_valid()) {
-            if (curSegment < 4) {
-              // Setup to get next segment
-              curSegment++;
-            } else {
-              // Note that we got a frame
-              frame_captured = 1;
- 
-              // Setup to get the next frame
-              curSegment = 1;
-              validSegmentRegion = 0;
-            }
-            bad_segments = 0;
-          }
-          done = 1;
-        }
-      }
-      prevLine = line;
-    } else {
-      (void) gettimeofday(&curT, NULL);
-      if (delta_time_usec(startT, curT) > LEP_MAX_FRAME_DELAY_USEC) {
-        // Did not see a valid packet within this segment interval
-        done = 1;
-      }
+  struct timespec deadline;
+  int rsp;
+
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += VOSPI_FRAME_WAIT_MSEC / 1000;
+  deadline.tv_nsec += (VOSPI_FRAME_WAIT_MSEC % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  pthread_mutex_lock(&dev->frame_lock);
+  while (!dev->frame_captured) {
+    if (pthread_cond_timedwait(&dev->frame_cond, &dev->frame_lock, &deadline) == ETIMEDOUT) {
+      break;
+    }
+  }
+  rsp = dev->frame_captured;
+  dev->frame_captured = 0;   // Note we've consumed the buffer
+  pthread_mutex_unlock(&dev->frame_lock);
+
+  return rsp;
+}
+
+
+/**
+ * Discard a frame the ISR has captured that hasn't been taken yet so the next call
+ * to sync_and_transfer_frame() waits for a new one
+ */
+void vospi_flush_frame(vospi_dev_t* dev)
+{
+  pthread_mutex_lock(&dev->frame_lock);
+  dev->frame_captured = 0;
+  pthread_mutex_unlock(&dev->frame_lock);
+}
+
+
+/**
+ * Return the number of frames the ISR has captured
+ */
+uint32_t vospi_get_frame_count(vospi_dev_t* dev)
+{
+  uint32_t n;
+
+  pthread_mutex_lock(&dev->frame_lock);
+  n = dev->frames_captured;
+  pthread_mutex_unlock(&dev->frame_lock);
+
+  return n;
+}
+
+
+/**
+ * Return the number of resyncs started because no good segment was seen for a while
+ */
+uint32_t vospi_get_resync_count(vospi_dev_t* dev)
+{
+  uint32_t n;
+
+  pthread_mutex_lock(&dev->frame_lock);
+  n = dev->resyncs;
+  pthread_mutex_unlock(&dev->frame_lock);
+
+  return n;
+}
+
+
+/**
+ * Return the number of segments skipped because the bus was still busy with the other
+ * Lepton past the end of their window
+ */
+uint32_t vospi_get_late_count(vospi_dev_t* dev)
+{
+  uint32_t n;
+
+  pthread_mutex_lock(&sched_lock);
+  n = dev->late_segments;
+  pthread_mutex_unlock(&sched_lock);
+
+  return n;
+}
+
+
+/**
+ * Change the SPI clock (the requested rate, see vospi_init) while frames are being
+ * captured.  Returns -1 if it couldn't be set.
+ */
+int vospi_set_speed(vospi_dev_t* dev, uint32_t speed)
+{
+  if (ioctl(dev->spiFd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) == -1) {
+    log_error("SPI: failed to set the max speed option");
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/**
+ * Load cnt with the segment read counts, optionally resetting them.  Packet CRC
+ * errors are only counted with VOSPI_CHECK_CRC.
+ */
+void vospi_get_link_counts(vospi_dev_t* dev, vospi_cal_count_t* cnt, int reset)
+{
+  pthread_mutex_lock(&dev->frame_lock);
+  *cnt = dev->link_counts;
+  if (reset) {
+    memset(&dev->link_counts, 0, sizeof(dev->link_counts));
+  }
+  pthread_mutex_unlock(&dev->frame_lock);
+}
+
+
+/**
+ * Take the pending segment with the oldest VSYNC (loading vsync_usec with its time).
+ * Returns NULL if there are none.
+ */
+static vospi_dev_t* next_pending(int64_t* vsync_usec)
+{
+  vospi_dev_t* dev = NULL;
+  int i;
+
+  pthread_mutex_lock(&sched_lock);
+  for (i = 0; i < bus_num_devs; i++) {
+    if (bus_devs[i]->pending &&
+        ((dev == NULL) || (bus_devs[i]->pending_usec < dev->pending_usec))) {
+      dev = bus_devs[i];
+    }
+  }
+  if (dev != NULL) {
+    dev->pending = 0;
+    *vsync_usec = dev->pending_usec;
+  }
+  pthread_mutex_unlock(&sched_lock);
+
+  return dev;
+}
+
+
+static int segments_pending()
+{
+  int i;
+  int n = 0;
+
+  pthread_mutex_lock(&sched_lock);
+  for (i = 0; i < bus_num_devs; i++) {
+    n += bus_devs[i]->pending;
+  }
+  pthread_mutex_unlock(&sched_lock);
+
+  return n;
+}
+
+
+/**
+ * Note a segment that can't be read in its window
+ */
+static void skip_segment(vospi_dev_t* dev)
+{
+  pthread_mutex_lock(&sched_lock);
+  dev->late_segments++;
+  pthread_mutex_unlock(&sched_lock);
+}
+
+
+/**
+ * Finish a segment read with the segment assembler results: note a completed frame
+ * and resync the Lepton if we haven't seen a good segment for a while
+ */
+static void finish_segment(vospi_dev_t* dev, int rsp, int64_t deadline)
+{
+  pthread_mutex_lock(&dev->frame_lock);
+  dev->link_counts.reads++;
+  if (rsp & VOSPI_ASM_SEG_END) dev->link_counts.seg_ends++;
+  if (rsp & VOSPI_ASM_CRC_ERROR) dev->link_counts.crc_errors++;
+  pthread_mutex_unlock(&dev->frame_lock);
+
+  if (rsp & VOSPI_ASM_SEGMENT) {
+    if (rsp & VOSPI_ASM_FRAME) {
+      // Note that we got a frame
+      dev->my_frame->timestamp_usec = deadline - LEP_MAX_FRAME_DELAY_USEC;
+      pthread_mutex_lock(&dev->frame_lock);
+      dev->frame_captured = 1;
+      dev->frames_captured++;
+      pthread_cond_signal(&dev->frame_cond);
+      pthread_mutex_unlock(&dev->frame_lock);
     }
+    dev->bad_segments = 0;
   }
 
   // If we haven't gotten a good frame within 12 interrupts then attempt to resync
-  // (resyncing requires stopping access to the vospi for at least 185 mSec)
-  if (++bad_segments == 12) {
+  // (resyncing requires stopping access to the vospi for at least 185 mSec).  Its
+  // VSYNCs are ignored instead of sleeping so the bus stays available to the other
+  // Lepton.
+  if (++dev->bad_segments == 12) {
     // Attemp to resync
-    log_info("Resync");
-    bad_segments = 0;
-    isr_sleep_ms(185);
+    log_info("Resync gpio %d", dev->vsyncGpio);
+    dev->bad_segments = 0;
+    dev->resync_usec = monotonic_usec() + VOSPI_RESYNC_MSEC * 1000;
+    pthread_mutex_lock(&dev->frame_lock);
+    dev->resyncs++;
+    pthread_mutex_unlock(&dev->frame_lock);
   }
 }
 
 
+#ifndef VOSPI_BATCH_SEGMENT
 /**
- * Transfer a packet
- *  Returns 1 for a non-discard packet with line number and potentially segment number
+ * Read a packet into lepPacket (segment assembler transfer hook).  A failed read is
+ * treated as a discard packet.
  */
-int get_packet(uint8_t* line, uint8_t* seg)
+static const uint8_t* transfer_packet(void* ctx, int numPkts)
 {
-  // Perform the spidev transfer
-  if (read(spiFd, &lepPacket, VOSPI_PACKET_BYTES) < 1) {
+  vospi_dev_t* dev = ((segment_ctx_t*) ctx)->dev;
+  uint8_t* p = (uint8_t*) &dev->lepPacket;
+
+  if (read(dev->spiFd, p, VOSPI_PACKET_BYTES) < 1) {
     log_fatal("SPI: failed to transfer packet");
-    return 0;
+    p[0] = 0x0F;
   }
 
+  return p;
+}
+
+
+/**
+ * Check the segment deadline (segment assembler timing hook)
+ */
+static bool segment_expired(void* ctx)
+{
+  return (monotonic_usec() > ((segment_ctx_t*) ctx)->deadline);
+}
+
+
+/**
+ * Copy a packet to its location in the current frame's pixel or telemetry plane
+ * (segment assembler store hook)
+ */
+static void store_packet(void* ctx, const vospi_asm_t* a, const uint8_t* pktP, int rsp)
+{
+  vospi_frame_t* my_frame = ((segment_ctx_t*) ctx)->dev->my_frame;
+  vospi_packet_meta_t* meta = &my_frame->meta[a->seg-1][a->line];
+  uint8_t* dst;
+
   // Flip the byte order of the ID & CRC
-  lepPacket.id = FLIP_WORD_BYTES(lepPacket.id);
-  lepPacket.crc = FLIP_WORD_BYTES(lepPacket.crc);
+  meta->id = (pktP[0] << 8) | pktP[1];
+  meta->crc = (pktP[2] << 8) | pktP[3];
 
-  if ((lepPacket.id & 0x0f00) == 0x0f00) {
-    // Skip discard 
-    return 0;
+  if (rsp & VOSPI_ASM_STORE_IMAGE) {
+    dst = my_frame->pixels + a->dst * VOSPI_PACKET_SYMBOLS;
+  } else {
+    dst = my_frame->telem + a->dst * VOSPI_PACKET_SYMBOLS;
   }
+  memcpy(dst, pktP + 4, VOSPI_PACKET_SYMBOLS);
+}
+
 
-  *line = lepPacket.id & 0x00FF;
+/**
+ * Segment read - reads packets from the lepton until the segment assembler
+ * determines the current set is garbage or discard or until it has a full segment.
+ * Stores in-process frame in local buffer.  Returns the segment assembler results.
+ */
+static int transfer_segment(vospi_dev_t* dev, int64_t deadline)
+{
+  segment_ctx_t ctx = {dev, deadline};
+  const vospi_asm_hooks_t hooks = {
+    .transfer = transfer_packet,
+    .expired = segment_expired,
+    .store = store_packet,
+    .ctx = &ctx,
+    .maxPkts = 1
+  };
+
+  return vospi_asm_read_segment(&dev->lepAsm, &hooks);
+}
+#else
+/**
+ * Location of the symbols of a line of segment seg (1-4) in the current frame's pixel
+ * or telemetry plane
+ */
+static uint8_t* line_symbols(vospi_frame_t* my_frame, int seg, int line)
+{
+  int n = (seg - 1) * VOSPI_PACKETS_PER_SEGMENT + line;
 
-  // Get segment when possible
-  if (*line == 20) {
-    *seg = lepPacket.id >> 12;
+  if (n < VOSPI_IMAGE_PACKETS) {
+    return my_frame->pixels + n * VOSPI_PACKET_SYMBOLS;
   }
+  return my_frame->telem + (n - VOSPI_IMAGE_PACKETS) * VOSPI_PACKET_SYMBOLS;
+}
 
-  return 1;
+
+/**
+ * Setup the pair of transfers that read a line of segment seg: the ID & CRC into its
+ * meta entry and the symbols into its plane
+ */
+static void setup_line_xfer(vospi_frame_t* my_frame, struct spi_ioc_transfer* xfer,
+                            int seg, int line)
+{
+  xfer[0].rx_buf = (unsigned long) &my_frame->meta[seg-1][line];
+  xfer[0].len = sizeof(vospi_packet_meta_t);
+  xfer[1].rx_buf = (unsigned long) line_symbols(my_frame, seg, line);
+  xfer[1].len = VOSPI_PACKET_SYMBOLS;
 }
 
 
 /**
- * Compute delta-time in uSec from two timeval values
+ * Check a line of segment seg read in place (ID & CRC not flipped yet) with the
+ * segment assembler
  */
-uint32_t delta_time_usec(struct timeval start, struct timeval stop)
+static int check_line(vospi_dev_t* dev, int seg, int line)
 {
-  return ((stop.tv_sec * 1000000 + stop.tv_usec) - (start.tv_sec * 1000000 + start.tv_usec));
+#ifdef VOSPI_CHECK_CRC
+  // The CRC covers the whole packet so check a contiguous copy of it
+  memcpy(&dev->lepPacket, &dev->my_frame->meta[seg-1][line], sizeof(vospi_packet_meta_t));
+  memcpy(dev->lepPacket.symbols, line_symbols(dev->my_frame, seg, line), VOSPI_PACKET_SYMBOLS);
+  return vospi_asm_packet(&dev->lepAsm, (uint8_t*) &dev->lepPacket);
+#else
+  // Only the ID is looked at
+  return vospi_asm_packet(&dev->lepAsm, (uint8_t*) &dev->my_frame->meta[seg-1][line]);
+#endif
 }
 
 
 /**
- * Sleep routine designed for use by the ISR
+ * Segment read - skips discard packets until the start of a segment and then reads
+ * the rest of it directly into the in-process frame's planes with one spidev ioctl.
+ * The packets are checked in place by the segment assembler.  Returns the segment
+ * assembler results or -1 if the SPI transfer failed.
  */
-void isr_sleep_ms(int milliseconds)
+static int transfer_segment(vospi_dev_t* dev, int64_t deadline)
 {
-    struct timespec ts;
+  struct spi_ioc_transfer xfer[2 * (VOSPI_PACKETS_PER_SEGMENT - 1)];
+  vospi_frame_t* my_frame = dev->my_frame;
+  int seg;
+  int rsp;
+  int i;
 
-    ts.tv_sec = milliseconds / 1000;
-    ts.tv_nsec = (milliseconds % 1000) * 1000000;
-    nanosleep(&ts, NULL);
+  vospi_asm_start_segment(&dev->lepAsm);
+  seg = dev->lepAsm.curSegment;
+
+  // Wait for the first packet of the segment (read into its location in the frame)
+  memset(xfer, 0, sizeof(xfer));
+  setup_line_xfer(my_frame, xfer, seg, 0);
+  do {
+    if (ioctl(dev->spiFd, SPI_IOC_MESSAGE(2), xfer) < 1) {
+      log_fatal("SPI: failed to transfer packet");
+      return -1;
+    }
+    rsp = check_line(dev, seg, 0);
+  } while (!(rsp & VOSPI_ASM_VALID) && (monotonic_usec() <= deadline));
+
+  if ((rsp & VOSPI_ASM_VALID) && !(rsp & VOSPI_ASM_DONE) && (dev->lepAsm.line == 0)) {
+    // Read the rest of the segment after it
+    for (i = 1; i < VOSPI_PACKETS_PER_SEGMENT; i++) {
+      setup_line_xfer(my_frame, &xfer[2 * (i - 1)], seg, i);
+    }
+    if (ioctl(dev->spiFd, SPI_IOC_MESSAGE(2 * (VOSPI_PACKETS_PER_SEGMENT - 1)), xfer) < 1) {
+      log_fatal("SPI: failed to transfer segment - check spidev.bufsiz");
+    } else {
+      for (i = 1; (i < VOSPI_PACKETS_PER_SEGMENT) && !(rsp & VOSPI_ASM_DONE); i++) {
+        rsp |= check_line(dev, seg, i);
+      }
+    }
+  }
+
+  // Flip the byte order of the ID & CRC in place
+  for (i = 0; i < VOSPI_PACKETS_PER_SEGMENT; i++) {
+    my_frame->meta[seg-1][i].id = FLIP_WORD_BYTES(my_frame->meta[seg-1][i].id);
+    my_frame->meta[seg-1][i].crc = FLIP_WORD_BYTES(my_frame->meta[seg-1][i].crc);
+  }
+
+  return rsp;
 }
+#endif
 
 
 /**
- * Initialize (zero) valid seen line list array
+ * Read the segment following a VSYNC at vsync_usec unless it's too late to (the bus
+ * was busy with the other Lepton for its whole window) or the Lepton is resyncing.
+ * Called holding the bus.
  */
-void init_line_list()
+static void read_segment(vospi_dev_t* dev, int64_t vsync_usec)
 {
-  int i;
+  int64_t deadline = vsync_usec + LEP_MAX_FRAME_DELAY_USEC;
+  int64_t now = monotonic_usec();
+  int rsp;
+
+  if (now < dev->resync_usec) {
+    return;
+  }
+  if (now > deadline) {
+    skip_segment(dev);
+    return;
+  }
 
-  for (i=0; i<60; i++)
-    line_list[i] = 0;
+  rsp = transfer_segment(dev, deadline);
+  if (rsp >= 0) {
+    finish_segment(dev, rsp, deadline);
+  }
 }
 
 
 /**
- * Check the seen line list array
- *   Returns 1 if all 60 line numbers have been seen, 0 otherwise
+ * VSYNC handler - called by the VSYNC ISR or capture thread of each Lepton.  Marks
+ * its segment pending and, if the bus is free, reads the pending segments of all the
+ * Leptons, oldest VSYNC first.  Otherwise the handler holding the bus reads it after
+ * its own (checking again after releasing the bus so none are left behind).  Sets
+ * frame_captured when a valid frame has been read.
  */
-int line_list_valid()
+void vospi_vsync(vospi_dev_t* dev, int64_t vsync_usec)
 {
-  int i;
+  vospi_dev_t* d;
+  int64_t t;
 
-  for (i=0; i<60; i++) {
-    if (line_list[i] == 0)
-      return 0;
+  pthread_mutex_lock(&sched_lock);
+  if (dev->pending) {
+    // The segment for the previous VSYNC never got the bus
+    dev->late_segments++;
   }
+  dev->pending = 1;
+  dev->pending_usec = vsync_usec;
+  pthread_mutex_unlock(&sched_lock);
 
-  return 1;
+  while (pthread_mutex_trylock(&bus_lock) == 0) {
+    while ((d = next_pending(&t)) != NULL) {
+      read_segment(d, t);
+    }
+    pthread_mutex_unlock(&bus_lock);
+
+    if (!segments_pending()) {
+      break;
+    }
+  }
+}
+
+
+/**
+ * Monotonic time in uSec (unaffected by changes to the system time)
+ */
+int64_t monotonic_usec()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+
+/**
+ * Return a telemetry word (numbered from the start of row A) from a frame received
+ * with VOSPI_TELEM_FOOTER
+ */
+uint16_t vospi_telem_word(vospi_frame_t* frame, int word)
+{
+  uint8_t* p = frame->telem + word * 2;
+
+  return (p[0] << 8) | p[1];
+}
+
+
+/**
+ * Sleep routine designed for use by the ISR
+ */
+void isr_sleep_ms(int milliseconds)
+{
+    struct timespec ts;
+
+    ts.tv_sec = milliseconds / 1000;
+    ts.tv_nsec = (milliseconds % 1000) * 1000000;
+    nanosleep(&ts, NULL);
 }
+
@@ -10,6 +10,36 @@
  *
  * Run from top-level directory: sudo ./bin/leptonic /dev/i2c-1 /dev/spidev0.0
  *
+ * A second Lepton on the other chip select (with its VSYNC on VOSPI_VSYNC_GPIO_1 and
+ * on its own I2C bus since both Leptons have the same address) is added with:
+ *   sudo ./bin/leptonic /dev/i2c-1 /dev/spidev0.0 [spec] /dev/i2c-3 /dev/spidev0.1 [spec]
+ * Each Lepton has its own frame and stats sockets and SPI clock calibration.
+ *
+ * Uncomment VOSPI_RT_CAPTURE in include/api/vospi.h to capture from a locked in memory
+ * SCHED_FIFO thread on an isolated CPU for fewer lost frames on a loaded Pi.
+ *
+ * Uncomment LEP_FRAME_HEADER (and VOSPI_TELEM_FOOTER in vospi.h) to send each frame
+ * in the shared frame format (vospi_asm/tcam_frame.h) with a header carrying the
+ * sequence number, timestamps, frame counter and temperatures.
+ *
+ * Uncomment LEP_V4L2_OUTPUT to also write each frame to a v4l2loopback device for
+ * GStreamer, ffmpeg, OpenCV and other V4L2 applications.
+ *
+ * Uncomment LEP_H264_OUTPUT to also stream a palette-mapped H.264 video of the frames
+ * from the Pi's hardware encoder (see include/api/h264.h).
+ *
+ * Uncomment LEP_DRM_OUTPUT to also show the frames palette-mapped and full screen on
+ * the Pi's display (see include/api/drmout.h).
+ *
+ * Uncomment LEP_FRAME_BUS to also publish each frame on the local shared memory frame
+ * bus (vospi_asm/frame_bus.h) for other programs on the Pi.
+ *
+ * http://<pi>:LEP_METRICS_PORT/metrics returns each Lepton's frame counters and
+ * latency histograms in the OpenMetrics text format for Prometheus.
+ *
+ * The SPI clock is calibrated the first time leptonic runs and stored in
+ * LEP_SPI_CAL_FILE (delete it to calibrate again).
+ *
  * Software provided "as-is" without warranty of any kind in hopes that it's useful
  * to someone.
  *
@@ -19,62 +49,432 @@
 #include "log.h"
 #include "vospi.h"
 #include "cci.h"
+#include "drmout.h"
+#include "frame_bus.h"
+#include "h264.h"
+#include "tcam_frame.h"
+#include "v4l2out.h"
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
 #include <pthread.h>
-#include <semaphore.h>
 #include <assert.h>
 #include <string.h>
 #include <time.h>
 #include <zmq.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <linux/videodev2.h>
 
 // The default spec for the ZMQ socket that will be used for comms with the frontend
-#define ZMQ_DEFAULT_SOCKET_SPEC "tcp://*:5555"
+// (and the one for the second Lepton)
+#define ZMQ_DEFAULT_SOCKET_SPEC   "tcp://*:5555"
+#define ZMQ_DEFAULT_SOCKET_SPEC_1 "tcp://*:5565"
+
+// Leptons (see vospi.h).  The H.264, V4L2, display and frame bus outputs only carry the
+// first.
+#define LEP_MAX_CAMS VOSPI_MAX_DEVS
+
+// Uncomment to publish every frame as it arrives on a ZMQ_PUB socket (to any number
+// of subscribers) instead of replying to requests on a ZMQ_REP socket.  Each message
+// is a tcam_frame.h frame so subscribers can detect frames they missed from its
+// sequence number.  Note: Damien's frontend uses requests and requires the default
+// mode.
+//#define LEP_ZMQ_PUBSUB
+
+// Frames queued for a slow subscriber before new frames are dropped for it
+#define ZMQ_PUB_SNDHWM 2
+
+// Uncomment to configure the Lepton for radiometric TLinear pixels (Kelvin * 100)
+// instead of raw 14-bit counts
+//#define LEP_TLINEAR
+
+// Uncomment to also send the frames requested on the ZMQ_REP socket as tcam_frame.h
+// frames (a tcam_frame_hdr_t followed by the pixels) instead of plain pixels.  Define
+// VOSPI_TELEM_FOOTER in vospi.h for the telemetry values.  Note: Damien's frontend
+// requires plain frames.
+//#define LEP_FRAME_HEADER
+
+#if defined(LEP_FRAME_HEADER) || defined(LEP_ZMQ_PUBSUB)
+#define LEP_FRAME_MSG
+#endif
+
+// Uncomment to also encode the frames as a palette-mapped, upscaled H.264 stream with
+// the Pi's hardware encoder and serve it on H264_PORT.  The ZMQ sockets are unchanged.
+//#define LEP_H264_OUTPUT
+
+// Uncomment to also write every frame to the V4L2OUT_DEV v4l2loopback device as
+// 16-bit (Y16, little-endian) pixels, or 8-bit (GREY) pixels with LEP_V4L2_GREY (for
+// use with the AGC enabled), so V4L2 applications can read them.  The ZMQ sockets are
+// unchanged.
+//#define LEP_V4L2_OUTPUT
+//#define LEP_V4L2_GREY
+
+// Uncomment to also show every frame, stretched over an ironbow palette, full screen
+// on the display connected to the Pi through DRM/KMS (run from the console, not a
+// desktop).  The display controller upscales the frame so this costs almost no CPU.
+// The ZMQ sockets are unchanged.
+//#define LEP_DRM_OUTPUT
+
+// Uncomment to also publish every frame (big-endian pixels as sent by the Lepton and,
+// with VOSPI_TELEM_FOOTER, telemetry rows A-C) as tcam_frame.h frames on the
+// FRAME_BUS_NAME shared memory frame bus.  Local programs read the frames in place with the frame_bus.h subscriber
+// functions instead of each getting a copy over a ZMQ socket.  The ZMQ sockets are
+// unchanged.
+//#define LEP_FRAME_BUS
 
 // The size of the circular frame buffer
 #define FRAME_BUF_SIZE 8
 
-// Positions of the reader in the frame buffer
-int reader = 0, writer = 0;
+// What to do with a new frame when the frame buffer is full.  Dropping the oldest
+// frame keeps the freshest frames for live view.  Dropping the newest frame or
+// blocking (the capture thread waits for space, frames captured meanwhile are missed)
+// keeps a gap-free run of frames for recording.
+#define LEP_OVERFLOW_DROP_OLDEST 0
+#define LEP_OVERFLOW_DROP_NEWEST 1
+#define LEP_OVERFLOW_BLOCK       2
+
+#define LEP_OVERFLOW_POLICY LEP_OVERFLOW_DROP_OLDEST
+
+// The spec for the ZMQ_REP socket that replies to any request with the frame counters
+// and the frame latency percentiles (comment out to disable) and the one for the second
+// Lepton
+#define LEP_STATS_SOCKET_SPEC   "tcp://*:5556"
+#define LEP_STATS_SOCKET_SPEC_1 "tcp://*:5566"
+
+// Frames whose latency is kept for the stats percentiles
+#define LAT_RING_SIZE 256
+
+// The port of the HTTP server that answers GET /metrics with the frame counters and
+// latency histograms of each Lepton in the OpenMetrics text format (comment out to
+// disable).  The latency histogram buckets (uSec, the last is everything longer) and
+// the response length.
+#define LEP_METRICS_PORT        9106
+#define LEP_METRICS_BUCKETS     8
+#define LEP_METRICS_BOUNDS      {2000, 5000, 10000, 20000, 50000, 100000, 200000}
+#define LEP_METRICS_MAX_LEN     8192
+
+// SPI clock calibration (see vospi_cal.h).  The requested rates tried (the spi driver
+// runs at about 0.6x the requested rate so the fastest is about the Lepton's 20 MHz
+// maximum).  Each is measured for LEP_SPI_CAL_MSEC after the link has run at it for
+// LEP_SPI_CAL_SETTLE_MSEC.  The chosen rate is stored in LEP_SPI_CAL_FILE and used
+// instead of LEP_SPI_DEF_SPEED from then on.  Define VOSPI_CHECK_CRC in vospi.h to
+// include packet CRC errors in the measurements.
+#define LEP_SPI_DEF_SPEED       33333333
+#define LEP_SPI_CAL_STEPS       {16666667, 20000000, 25000000, 28571429, 33333333}
+#define LEP_SPI_CAL_SETTLE_MSEC 1000
+#define LEP_SPI_CAL_MSEC        10000
+#define LEP_SPI_CAL_FILE        "leptonic_spi.cal"
+#define LEP_SPI_CAL_FILE_1      "leptonic_spi1.cal"
+
+// Recovery when no frame arrives for LEP_STALL_SEC even though the ISR resyncs: the
+// Lepton is rebooted through the CCI and configured again while the sockets and their
+// clients stay up.  The server only exits after LEP_MAX_REBOOTS reboots in a row
+// without a frame.
+#define LEP_STALL_SEC           5
+#define LEP_MAX_REBOOTS         3
+
+#ifdef LEP_STATS_SOCKET_SPEC
+// The latency of the most recently sent frames, each stage from the frame's VSYNC
+// (timestamp_usec): capture - readout finished, queue - taken from the frame buffer
+// for a client, total - accepted by ZMQ for sending
+typedef struct {
+  uint32_t capture_usec;
+  uint32_t queue_usec;
+  uint32_t total_usec;
+} lep_latency_t;
+#endif
+
+// A Lepton and the frames read from it
+typedef struct {
+  int index;
+  char* i2c_path;
+  char* spi_path;
+  char* socket_spec;
+  char* stats_spec;
+  char* cal_file;
+  int vsync_gpio;
+
+  // Its VoSPI interface and the scratch frame it fills (so the frame buffer isn't
+  // locked while we're waiting for a new frame)
+  vospi_dev_t dev;
+  vospi_frame_t frame;
+
+  // Positions of the reader in the frame buffer and the number of frames in it
+  int reader, writer;
+  int buf_count;
+
+  // a lock protecting accesses to the frame buffer and the conditions signalling when
+  // frames are available and when there is space
+  pthread_mutex_t lock;
+  pthread_cond_t avail_cond;
+  pthread_cond_t space_cond;
+
+  // Frame counters: dropped by the overflow policy and sent to clients (frames
+  // received are counted by frame_count below)
+  uint32_t dropped_count;
+  uint32_t served_count;
+
+  // Lepton reboots by the stall recovery
+  uint32_t reboots;
+
+  // The frame buffer
+  vospi_frame_t* frame_buf[FRAME_BUF_SIZE];
+
+  // The sequence number of each frame in the frame buffer (counts every frame received,
+  // including those dropped because the buffer was full)
+  uint32_t frame_seq[FRAME_BUF_SIZE];
+  uint32_t frame_count;
+
+  // When each frame in the frame buffer finished its readout (monotonic_usec() time)
+  int64_t frame_ready_usec[FRAME_BUF_SIZE];
+
+#ifdef LEP_STATS_SOCKET_SPEC
+  lep_latency_t lat_ring[LAT_RING_SIZE];
+  uint32_t lat_count;
+#endif
+
+#ifdef LEP_METRICS_PORT
+  // Latency histograms and total latency of the frames sent (capture, queue and total
+  // from the VSYNC)
+  uint32_t lat_hist[3][LEP_METRICS_BUCKETS];
+  uint64_t lat_sum_usec[3];
+#endif
+} lep_cam_t;
+
+lep_cam_t cams[LEP_MAX_CAMS];
+int num_cams = 0;
+
+#ifdef LEP_METRICS_PORT
+const uint32_t metrics_bounds[LEP_METRICS_BUCKETS - 1] = LEP_METRICS_BOUNDS;
+#endif
+
+#ifdef LEP_V4L2_OUTPUT
+// The V4L2 output device
+v4l2out_t v4l2_out;
+#endif
+
+#ifdef LEP_FRAME_BUS
+// The frame bus each frame is published on
+frame_bus_t* frame_bus;
+#endif
+
+#if defined(LEP_FRAME_MSG) || defined(LEP_FRAME_BUS)
+/**
+ * Fill in the tcam_frame.h header for a frame (its big-endian pixels follow it)
+ */
+void fill_frame_hdr(tcam_frame_hdr_t* hdr, vospi_frame_t* frame, uint32_t seq)
+{
+  struct timespec ts;
+
+  tcam_frame_init(hdr, VOSPI_WIDTH, VOSPI_HEIGHT, 14, TCAM_FRAME_FMT_16BE);
+  hdr->seq = seq;
+  hdr->timestamp_usec = frame->timestamp_usec;
+
+  // The wall clock time of the frame's VSYNC
+  clock_gettime(CLOCK_REALTIME, &ts);
+  hdr->wall_usec = ((int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000) -
+                   (monotonic_usec() - frame->timestamp_usec);
+  hdr->flags |= TCAM_FRAME_FLAG_WALL;
+#ifdef VOSPI_TELEM_FOOTER
+  hdr->telem_fields = TCAM_FRAME_TEL_FRAME_CNT | TCAM_FRAME_TEL_FPA_TEMP | TCAM_FRAME_TEL_AUX_TEMP;
+  hdr->lep_frame_count = ((uint32_t) vospi_telem_word(frame, VOSPI_TEL_FC_HIGH) << 16) |
+                         vospi_telem_word(frame, VOSPI_TEL_FC_LOW);
+  hdr->fpa_temp_k100 = vospi_telem_word(frame, VOSPI_TEL_FPA_T_K100);
+  hdr->aux_temp_k100 = vospi_telem_word(frame, VOSPI_TEL_HSE_T_K100);
+#endif
+#ifdef LEP_TLINEAR
+  hdr->bits = 16;
+  hdr->flags |= TCAM_FRAME_FLAG_TLINEAR;
+#endif
+}
+#endif
+
+#ifdef LEP_FRAME_BUS
+/**
+ * Copy a frame into the next frame bus slot and publish it
+ */
+void publish_bus_frame(vospi_frame_t* frame, uint32_t seq)
+{
+  frame_bus_slot_t* slot = frame_bus_begin(frame_bus);
+
+  fill_frame_hdr(&slot->hdr, frame, seq);
+  memcpy(tcam_frame_pixels(&slot->hdr), frame->pixels, sizeof(frame->pixels));
+#ifdef VOSPI_TELEM_FOOTER
+  memcpy(tcam_frame_telem(&slot->hdr), frame->telem, FRAME_BUS_MAX_TELEM_BYTES);
+  slot->hdr.telem_len = FRAME_BUS_MAX_TELEM_BYTES;
+  slot->hdr.flags |= TCAM_FRAME_FLAG_TELEM_BE;
+#endif
+  frame_bus_publish(frame_bus, slot);
+}
+#endif
+
+#ifdef LEP_V4L2_OUTPUT
+/**
+ * Convert a frame's (big-endian) pixels straight into the next V4L2 output buffer and
+ * queue it.  The frame is skipped while all of the buffers are queued.
+ */
+void write_v4l2_frame(vospi_frame_t* frame)
+{
+  uint8_t* src = frame->pixels;
+  uint8_t* dst;
+  int i;
+
+  if ((dst = v4l2out_get_buf(&v4l2_out)) == NULL) {
+    return;
+  }
+
+  for (i = 0; i < VOSPI_IMAGE_PACKETS * VOSPI_PACKET_SYMBOLS / 2; i++) {
+#ifdef LEP_V4L2_GREY
+    *dst++ = src[1];
+#else
+    *dst++ = src[1];
+    *dst++ = src[0];
+#endif
+    src += 2;
+  }
+  (void) v4l2out_put_buf(&v4l2_out);
+}
+#endif
 
-// semaphore tracking the number of frames available
-sem_t count_sem;
+/**
+ * Return the SPI clock stored in the camera's calibration file (LEP_SPI_CAL_FILE) or 0
+ * if it hasn't been calibrated
+ */
+uint32_t read_spi_cal(lep_cam_t* c)
+{
+    FILE* fp;
+    uint32_t speed = 0;
 
-// a lock protecting accesses to the frame buffer
-pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    if ((fp = fopen(c->cal_file, "r")) != NULL) {
+      if (fscanf(fp, "%u", &speed) != 1) {
+        speed = 0;
+      }
+      fclose(fp);
+    }
 
-// The frame buffer
-vospi_frame_t* frame_buf[FRAME_BUF_SIZE];
+    return speed;
+}
+
+/**
+ * Step the SPI clock through LEP_SPI_CAL_STEPS while the ISR reads frames and store
+ * the fastest stable rate (with a margin) in the camera's calibration file.  The SPI
+ * is left at the rate chosen (LEP_SPI_DEF_SPEED if none was stable).
+ */
+void calibrate_spi(lep_cam_t* c)
+{
+    static const uint32_t steps[] = LEP_SPI_CAL_STEPS;
+    vospi_cal_t cal;
+    vospi_cal_count_t cnt;
+    int64_t end_usec;
+    uint32_t speed;
+    FILE* fp;
+
+    log_info("calibrating SPI clock for %s", c->spi_path);
+    vospi_cal_init(&cal, steps, sizeof(steps) / sizeof(steps[0]));
+    do {
+      if (vospi_set_speed(&c->dev, vospi_cal_freq(&cal)) < 0) {
+        (void) vospi_set_speed(&c->dev, LEP_SPI_DEF_SPEED);
+        return;
+      }
+      usleep(LEP_SPI_CAL_SETTLE_MSEC * 1000);
+      vospi_get_link_counts(&c->dev, &cnt, 1);
+
+      // Measure until the time is up or the rate can no longer be stable
+      end_usec = monotonic_usec() + (LEP_SPI_CAL_MSEC * 1000);
+      do {
+        usleep(100000);
+        vospi_get_link_counts(&c->dev, &cnt, 0);
+      } while ((monotonic_usec() < end_usec) &&
+               !vospi_cal_failing(&cnt, (LEP_SPI_CAL_MSEC * 1000) / LEP_FRAME_RATE_USEC));
+
+      log_info("  %u Hz: %u reads, %u incomplete, %u CRC errors", vospi_cal_freq(&cal),
+               cnt.reads, cnt.reads - cnt.seg_ends, cnt.crc_errors);
+    } while (!vospi_cal_next(&cal, vospi_cal_stable(&cnt)));
+
+    if ((speed = vospi_cal_result(&cal)) == 0) {
+      log_error("SPI unstable at %u Hz, using %u Hz", vospi_cal_freq(&cal), LEP_SPI_DEF_SPEED);
+      speed = LEP_SPI_DEF_SPEED;
+    } else {
+      log_info("SPI calibrated to %u Hz", speed);
+      if ((fp = fopen(c->cal_file, "w")) != NULL) {
+        fprintf(fp, "%u\n", speed);
+        fclose(fp);
+      } else {
+        log_error("Could not write %s", c->cal_file);
+      }
+    }
+    (void) vospi_set_speed(&c->dev, speed);
+}
 
 /**
- * Utility to sleep the get_frames_from_device thread
+ * Read frames from a camera's device into its circular buffer.
+ */
+/**
+ * Configure a Lepton for the server: VSYNC output, the pixel format and telemetry.
+ * Done at startup and again after a reboot.
  */
-void sleep_ms(int milliseconds)
+void configure_lepton(int i2c_fd)
 {
-    struct timespec ts;
+    // Enable VSYNC
+    cci_set_gpio_mode(i2c_fd, LEP_OEM_GPIO_MODE_VSYNC);
+    // Uncomment to enable AGC
+    //cci_set_agc_enable_state(i2c_fd, CCI_AGC_ENABLED);
 
-    ts.tv_sec = milliseconds / 1000;
-    ts.tv_nsec = (milliseconds % 1000) * 1000000;
-    nanosleep(&ts, NULL);
+#ifdef LEP_TLINEAR
+    // Radiometric TLinear pixels
+    cci_set_radiometry_enable_state(i2c_fd, CCI_RADIOMETRY_ENABLED);
+    cci_set_radiometry_tlinear_enable_state(i2c_fd, CCI_RADIOMETRY_TLINEAR_ENABLED);
+    log_info("  Radiometry TLinear = %d", cci_get_radiometry_tlinear_enable_state(i2c_fd));
+#endif
+
+    // Telemetry where vospi expects it
+#ifdef VOSPI_TELEM_FOOTER
+    cci_set_telemetry_location(i2c_fd, CCI_TELEMETRY_LOCATION_FOOTER);
+    cci_set_telemetry_enable_state(i2c_fd, CCI_TELEMETRY_ENABLED);
+#else
+    cci_set_telemetry_enable_state(i2c_fd, CCI_TELEMETRY_DISABLED);
+#endif
+    log_info("  Telemetry = %d", cci_get_telemetry_enable_state(i2c_fd));
 }
 
 /**
- * Read frames from the device into the circular buffer.
+ * Reboot a Lepton that has stopped sending frames and configure it again (the ISR
+ * keeps waiting for VSYNC meanwhile).  Exits once LEP_MAX_REBOOTS reboots in a row
+ * haven't brought it back.
  */
-void* get_frames_from_device(void* hw_dev_strings)
+void recover_lepton(lep_cam_t* c, int i2c_fd, int* reboots)
 {
-    char* i2cdev_path = (char*)hw_dev_strings;
-    char* spidev_path = (char*)hw_dev_strings + 64;
+    if (++(*reboots) > LEP_MAX_REBOOTS) {
+      log_fatal("lepton%d: no frames after %d reboots", c->index, LEP_MAX_REBOOTS);
+      exit(-1);
+    }
+
+    log_error("lepton%d: no frames for %d sec - rebooting it", c->index, LEP_STALL_SEC);
+    cci_run_oem_reboot(i2c_fd);
+    configure_lepton(i2c_fd);
+
+    pthread_mutex_lock(&c->lock);
+    c->reboots++;
+    pthread_mutex_unlock(&c->lock);
+}
+
+void* get_frames_from_device(void* cam)
+{
+    lep_cam_t* c = (lep_cam_t*)cam;
+    char* i2cdev_path = c->i2c_path;
+    char* spidev_path = c->spi_path;
+    vospi_frame_t* frame = &c->frame;
     int spi_fd;
     int i2c_fd;
-    int n;
-
-    // Declare a static frame to use as a scratch space to avoid locking the framebuffer while
-    // we're waiting for a new frame
-    vospi_frame_t frame;
+    uint32_t spi_speed;
+    int stalled;
+    int reboots = 0;
 
     // Open the I2C device
     log_info("opening I2C device... %s", i2cdev_path);
@@ -90,115 +490,480 @@ void* get_frames_from_device(void* hw_dev_strings)
       exit(-1);
     }
 
-    // Initialise the VoSPI interface.  Hand it the array of frame buffers to fill.
+    // Initialise the VoSPI interface at the calibrated clock.  Hand it the array of
+    // frame buffers to fill.
     //  Note: there is a bug in the spi driver that causes the frequency to be
     //        0.6 what is set...  So work around that here.
-    if (vospi_init(spi_fd, 33333333, &frame) == -1) {
+    if ((spi_speed = read_spi_cal(c)) != 0) {
+      log_info("  SPI speed = %u (%s)", spi_speed, c->cal_file);
+    }
+    if (vospi_init(&c->dev, spi_fd, c->vsync_gpio, (spi_speed != 0) ? spi_speed : LEP_SPI_DEF_SPEED,
+                   frame) == -1) {
         log_fatal("SPI: failed to condition SPI device for VoSPI use.");
         exit(-1);
     }
 
-    // Enable VSYNC
+    // Check the Lepton is the one we were built for
     cci_init(i2c_fd);
-    cci_set_gpio_mode(i2c_fd, LEP_OEM_GPIO_MODE_VSYNC);
-    // Uncomment to enable AGC
-    //cci_set_agc_enable_state(i2c_fd, CCI_AGC_ENABLED);
+    char part[33];
+    cci_get_part_number(i2c_fd, part, sizeof(part));
+    int family = vospi_asm_part_lepton(part);
+    log_info("  Part number = %s", part);
+    if ((family != VOSPI_ASM_PART_UNKNOWN) && (family != VOSPI_ASM_LEPTON)) {
+      log_fatal("Found a Lepton %d.x but built for a Lepton %d.x (make LEPTON=%d)", family, VOSPI_ASM_LEPTON, family);
+      exit(-1);
+    }
+
+    configure_lepton(i2c_fd);
+
+    // Find the fastest stable SPI clock the first time (frames aren't sent meanwhile)
+    if (spi_speed == 0) {
+      calibrate_spi(c);
+    }
 
     // Receive frames forever
     log_info("aquiring VoSPI synchronisation");
     do {
 
-      while (0 == sync_and_transfer_frame()) {
-        sleep_ms(1);
+#if LEP_OVERFLOW_POLICY == LEP_OVERFLOW_BLOCK
+      // Wait for space before taking a frame so it isn't overwritten while we wait
+      pthread_mutex_lock(&c->lock);
+      while (c->buf_count == FRAME_BUF_SIZE) {
+        pthread_cond_wait(&c->space_cond, &c->lock);
+      }
+      pthread_mutex_unlock(&c->lock);
+      vospi_flush_frame(&c->dev);
+#endif
+
+      // Wait for the ISR to signal a complete frame, rebooting the Lepton if none
+      // arrives for LEP_STALL_SEC
+      stalled = 0;
+      while (0 == sync_and_transfer_frame(&c->dev)) {
+        if (++stalled >= (LEP_STALL_SEC * 1000 / VOSPI_FRAME_WAIT_MSEC)) {
+          recover_lepton(c, i2c_fd, &reboots);
+          stalled = 0;
+        }
       }
+      reboots = 0;
+      int64_t ready_usec = monotonic_usec();
 
-      // Only push this frame if our circular frame buffer is not full
-      sem_getvalue(&count_sem, &n);
-      
-      if (n < FRAME_BUF_SIZE) {
-        pthread_mutex_lock(&lock);
+      c->frame_count++;
 
-        // Copy the newly-received frame into place
-        memcpy(frame_buf[writer], &frame, sizeof(vospi_frame_t));
+      if (c->index == 0) {
+#ifdef LEP_V4L2_OUTPUT
+        write_v4l2_frame(frame);
+#endif
+#ifdef LEP_H264_OUTPUT
+        // The encoder takes its own copy (and skips frames it's too busy for)
+        h264_submit_frame(frame->pixels);
+#endif
+#ifdef LEP_DRM_OUTPUT
+        // The display takes its own copy (and skips frames that arrive before a vblank)
+        drmout_submit_frame(frame->pixels);
+#endif
+#ifdef LEP_FRAME_BUS
+        publish_bus_frame(frame, c->frame_count);
+#endif
+      }
 
-        // Move the writer ahead
-        writer = (writer + 1) & (FRAME_BUF_SIZE - 1);
+      pthread_mutex_lock(&c->lock);
+      if (c->buf_count == FRAME_BUF_SIZE) {
+#if LEP_OVERFLOW_POLICY == LEP_OVERFLOW_DROP_NEWEST
+        // Keep the frames we have
+        c->dropped_count++;
+        pthread_mutex_unlock(&c->lock);
+        continue;
+#else
+        // Make room by dropping the oldest frame
+        c->reader = (c->reader + 1) & (FRAME_BUF_SIZE - 1);
+        c->buf_count--;
+        c->dropped_count++;
+#endif
+      }
 
-        // Unlock and post the space semaphore
-        pthread_mutex_unlock(&lock);
-        sem_post(&count_sem);
-     }
+      // Copy the newly-received frame into place
+      memcpy(c->frame_buf[c->writer], frame, sizeof(vospi_frame_t));
+      c->frame_seq[c->writer] = c->frame_count;
+      c->frame_ready_usec[c->writer] = ready_usec;
+
+      // Move the writer ahead
+      c->writer = (c->writer + 1) & (FRAME_BUF_SIZE - 1);
+      c->buf_count++;
+
+      // Unlock and signal the frame is available
+      pthread_cond_signal(&c->avail_cond);
+      pthread_mutex_unlock(&c->lock);
 
     } while (1);  // Forever
 
 }
 
 /**
- * Wait for reqests for frames on the ZMQ socket and respond with a frame each time.
+ * Wait for reqests for frames on a camera's ZMQ socket and respond with a frame each
+ * time (or publish each frame as it arrives with LEP_ZMQ_PUBSUB).
  */
-void* send_frames_to_socket(void* socket_path_ptr)
+void* send_frames_to_socket(void* cam)
 {
+    lep_cam_t* c = (lep_cam_t*)cam;
+    zmq_msg_t msg;
+    int64_t vsync_usec, ready_usec, taken_usec;
+
     // Create the ZMQ context & socket
-    char* socket_path = (char*)socket_path_ptr;
+    char* socket_path = c->socket_spec;
     void* context = zmq_ctx_new();
+#ifdef LEP_ZMQ_PUBSUB
+    int hwm = ZMQ_PUB_SNDHWM;
+    void* responder = zmq_socket(context, ZMQ_PUB);
+    zmq_setsockopt(responder, ZMQ_SNDHWM, &hwm, sizeof(hwm));
+#else
     void* responder = zmq_socket(context, ZMQ_REP);
+#endif
 
     if (zmq_bind(responder, socket_path) != 0) {
       log_fatal("Failed to bind to socket: %s", zmq_strerror(errno));
       exit(1);
     }
 
-    // Declare a static frame
-    vospi_frame_t next_frame;
-
-    // Declare a static buffer to copy frame data into for sending
-    unsigned char message_buf[VOSPI_SEGMENTS_PER_FRAME * VOSPI_PACKETS_PER_SEGMENT_NORMAL * VOSPI_PACKET_SYMBOLS];
+    // Size of the message the frame data is packed into for sending
+    size_t message_len = VOSPI_IMAGE_PACKETS * VOSPI_PACKET_SYMBOLS;
+#ifdef LEP_FRAME_MSG
+    message_len += sizeof(tcam_frame_hdr_t);
+#endif
 
     while (1) {
 
+#ifndef LEP_ZMQ_PUBSUB
       // Receive requests
       char req_buf[10];
       zmq_recv(responder, req_buf, 10, 0);
+#endif
 
-      // Wait if there are no new frames to transmit
-      sem_wait(&count_sem);
-
-      // Uncomment to display frame_buf fill level
-      /*
-      int n;
-      sem_getvalue(&count_sem, &n);
-      log_info("n=%d",n);
-      */
+      // Allocate the message so the frame can be packed straight into the buffer zmq
+      // sends from
+      zmq_msg_init_size(&msg, message_len);
+      void* message_buf_pos = zmq_msg_data(&msg);
 
-      // Lock the data structure to prevent new frames being added while we're reading this one
-      pthread_mutex_lock(&lock);
+      // Lock the data structure to prevent new frames being added while we're reading
+      // this one and wait if there are no new frames to transmit
+      pthread_mutex_lock(&c->lock);
+      while (c->buf_count == 0) {
+        pthread_cond_wait(&c->avail_cond, &c->lock);
+      }
 
-      // Copy the next frame out ready to transmit
-      memcpy(&next_frame, frame_buf[reader], sizeof(vospi_frame_t));
+      // Pack the next frame into the message buffer
+      vospi_frame_t* f = c->frame_buf[c->reader];
+#ifdef LEP_FRAME_MSG
+      fill_frame_hdr((tcam_frame_hdr_t*) message_buf_pos, f, c->frame_seq[c->reader]);
+      message_buf_pos += sizeof(tcam_frame_hdr_t);
+#endif
+      memcpy(message_buf_pos, f->pixels, sizeof(f->pixels));
+      vsync_usec = f->timestamp_usec;
+      ready_usec = c->frame_ready_usec[c->reader];
+      taken_usec = monotonic_usec();
 
       // Move the reader ahead
-      reader = (reader + 1) & (FRAME_BUF_SIZE - 1);
+      c->reader = (c->reader + 1) & (FRAME_BUF_SIZE - 1);
+      c->buf_count--;
 
       // Unlock data structure
-      pthread_mutex_unlock(&lock);
-
-      // Prepare the message buffer
-      void* message_buf_pos = &message_buf;
-      for (int seg = 0; seg < VOSPI_SEGMENTS_PER_FRAME; seg ++) {
-        for (int pkt = 0; pkt < VOSPI_PACKETS_PER_SEGMENT_NORMAL; pkt ++) {
-          // Copy each packet into the message buffer
-          memcpy(
-            message_buf_pos,
-            next_frame.segments[seg].packets[pkt].symbols,
-            VOSPI_PACKET_SYMBOLS
-          );
-          message_buf_pos += VOSPI_PACKET_SYMBOLS;
+      pthread_cond_signal(&c->space_cond);
+      pthread_mutex_unlock(&c->lock);
+
+      // Send the message (never blocks when publishing, subscribers over their high
+      // water mark miss it)
+#ifdef LEP_ZMQ_PUBSUB
+      if (zmq_msg_send(&msg, responder, ZMQ_DONTWAIT) < 0) {
+#else
+      if (zmq_msg_send(&msg, responder, 0) < 0) {
+#endif
+        zmq_msg_close(&msg);
+      } else {
+        c->served_count++;
+#if defined(LEP_STATS_SOCKET_SPEC) || defined(LEP_METRICS_PORT)
+        uint32_t lat[3];
+        lat[0] = (uint32_t) (ready_usec - vsync_usec);
+        lat[1] = (uint32_t) (taken_usec - ready_usec);
+        lat[2] = (uint32_t) (monotonic_usec() - vsync_usec);
+        pthread_mutex_lock(&c->lock);
+#ifdef LEP_STATS_SOCKET_SPEC
+        lep_latency_t* l = &c->lat_ring[c->lat_count % LAT_RING_SIZE];
+        l->capture_usec = lat[0];
+        l->queue_usec = lat[1];
+        l->total_usec = lat[2];
+        c->lat_count++;
+#endif
+#ifdef LEP_METRICS_PORT
+        for (int s = 0; s < 3; s++) {
+          int b = 0;
+          while ((b < LEP_METRICS_BUCKETS - 1) && (lat[s] > metrics_bounds[b])) b++;
+          c->lat_hist[s][b]++;
+          c->lat_sum_usec[s] += lat[s];
+        }
+#endif
+        pthread_mutex_unlock(&c->lock);
+#endif
+      }
+    }
+}
+
+#ifdef LEP_STATS_SOCKET_SPEC
+int cmp_uint32(const void* a, const void* b)
+{
+  uint32_t x = *((const uint32_t*) a);
+  uint32_t y = *((const uint32_t*) b);
+
+  return (x > y) - (x < y);
+}
+
+/**
+ * Write a "stage":[p50,p99] latency item for n samples (sorted in place) into buf
+ */
+int put_percentiles(char* buf, const char* stage, uint32_t* samples, int n)
+{
+  qsort(samples, n, sizeof(uint32_t), cmp_uint32);
+  return sprintf(buf, "\"%s\":[%u,%u]", stage, samples[n / 2], samples[(n * 99) / 100]);
+}
+
+/**
+ * Reply to any request on a camera's stats socket with the frame counters and the p50
+ * and p99 latency (uSec from the VSYNC) of the last LAT_RING_SIZE frames sent.
+ * "missed" frames were captured by the ISR but overwritten before
+ * get_frames_from_device() took them.  "late" segments weren't read because the bus
+ * was busy with the other Lepton for their whole window.
+ */
+void* send_stats_to_socket(void* cam)
+{
+    lep_cam_t* c = (lep_cam_t*)cam;
+    char req_buf[10];
+    char stats[352];
+    uint32_t captured, received, dropped, served, late;
+    uint32_t capture[LAT_RING_SIZE], queue[LAT_RING_SIZE], total[LAT_RING_SIZE];
+    int buffered, i, n, len;
+
+    char* socket_path = c->stats_spec;
+    void* context = zmq_ctx_new();
+    void* responder = zmq_socket(context, ZMQ_REP);
+    if (zmq_bind(responder, socket_path) != 0) {
+      log_error("Failed to bind to stats socket: %s", zmq_strerror(errno));
+      return NULL;
+    }
+
+    while (1) {
+      zmq_recv(responder, req_buf, 10, 0);
+
+      pthread_mutex_lock(&c->lock);
+      captured = vospi_get_frame_count(&c->dev);
+      late = vospi_get_late_count(&c->dev);
+      received = c->frame_count;
+      dropped = c->dropped_count;
+      served = c->served_count;
+      buffered = c->buf_count;
+      n = (c->lat_count < LAT_RING_SIZE) ? c->lat_count : LAT_RING_SIZE;
+      for (i = 0; i < n; i++) {
+        capture[i] = c->lat_ring[i].capture_usec;
+        queue[i] = c->lat_ring[i].queue_usec;
+        total[i] = c->lat_ring[i].total_usec;
+      }
+      pthread_mutex_unlock(&c->lock);
+
+      len = sprintf(stats, "{\"captured\":%u,\"missed\":%u,\"received\":%u,\"dropped\":%u,\"served\":%u,\"buffered\":%d,\"late\":%u",
+                    captured, captured - received, received, dropped, served, buffered, late);
+      if (n != 0) {
+        len += sprintf(stats + len, ",\"latency_usec\":{");
+        len += put_percentiles(stats + len, "capture", capture, n);
+        len += sprintf(stats + len, ",");
+        len += put_percentiles(stats + len, "queue", queue, n);
+        len += sprintf(stats + len, ",");
+        len += put_percentiles(stats + len, "total", total, n);
+        len += sprintf(stats + len, "}");
+      }
+      sprintf(stats + len, "}");
+      zmq_send(responder, stats, strlen(stats), 0);
+    }
+}
+#endif
+
+#ifdef LEP_METRICS_PORT
+/**
+ * Append to the metrics text, stopping at the end of the buffer
+ */
+void put_metrics(char* buf, int* n, const char* fmt, ...)
+{
+  va_list ap;
+  int len;
+
+  if (*n >= LEP_METRICS_MAX_LEN - 1) return;
+  va_start(ap, fmt);
+  len = vsnprintf(buf + *n, LEP_METRICS_MAX_LEN - *n, fmt, ap);
+  va_end(ap);
+  if (len > 0) *n = (*n + len >= LEP_METRICS_MAX_LEN) ? LEP_METRICS_MAX_LEN - 1 : *n + len;
+}
+
+/**
+ * Write the OpenMetrics text of every camera's counters and latency histograms into
+ * buf.  Returns its length.  Each camera is labelled lepton<index>.  CRC failures are
+ * only counted with VOSPI_CHECK_CRC (and restart after the SPI clock calibration).
+ */
+int get_metrics(char* buf)
+{
+  static const char* stages[3] = {"capture", "queue", "total"};
+  static const char* counters[8][2] = {
+    {"tcam_frames", "Frames captured by the ISR"},
+    {"tcam_frames_lost", "Frames overwritten before they were taken from the ISR"},
+    {"tcam_frames_dropped", "Frames dropped from the frame buffer by the overflow policy"},
+    {"tcam_images_sent", "Frames sent to clients"},
+    {"tcam_segments_late", "Segments not read because the bus was busy with the other Lepton"},
+    {"tcam_resyncs", "Lepton resyncs"},
+    {"tcam_crc_failures", "Segment reads ended by a packet CRC failure"},
+    {"tcam_lepton_reboots", "Lepton reboots by the stall recovery"}
+  };
+  uint32_t v[LEP_MAX_CAMS][8];
+  int buffered[LEP_MAX_CAMS];
+  uint32_t hist[LEP_MAX_CAMS][3][LEP_METRICS_BUCKETS];
+  uint64_t sum[LEP_MAX_CAMS][3];
+  vospi_cal_count_t link;
+  uint32_t count;
+  int i, j, s, n = 0;
+
+  for (i = 0; i < num_cams; i++) {
+    lep_cam_t* c = &cams[i];
+    v[i][0] = vospi_get_frame_count(&c->dev);
+    v[i][4] = vospi_get_late_count(&c->dev);
+    v[i][5] = vospi_get_resync_count(&c->dev);
+    vospi_get_link_counts(&c->dev, &link, 0);
+    v[i][6] = link.crc_errors;
+    pthread_mutex_lock(&c->lock);
+    v[i][1] = v[i][0] - c->frame_count;
+    v[i][2] = c->dropped_count;
+    v[i][3] = c->served_count;
+    v[i][7] = c->reboots;
+    buffered[i] = c->buf_count;
+    memcpy(hist[i], c->lat_hist, sizeof(hist[i]));
+    memcpy(sum[i], c->lat_sum_usec, sizeof(sum[i]));
+    pthread_mutex_unlock(&c->lock);
+  }
+
+  for (j = 0; j < 8; j++) {
+    put_metrics(buf, &n, "# TYPE %s counter\n# HELP %s %s\n", counters[j][0], counters[j][0], counters[j][1]);
+    for (i = 0; i < num_cams; i++) {
+      put_metrics(buf, &n, "%s_total{camera=\"lepton%d\"} %u\n", counters[j][0], i, v[i][j]);
+    }
+  }
+
+  put_metrics(buf, &n, "# TYPE tcam_frame_buffer_items gauge\n# HELP tcam_frame_buffer_items Frames waiting to be sent\n");
+  for (i = 0; i < num_cams; i++) {
+    put_metrics(buf, &n, "tcam_frame_buffer_items{camera=\"lepton%d\"} %d\n", i, buffered[i]);
+  }
+
+  put_metrics(buf, &n, "# TYPE tcam_latency_seconds histogram\n# UNIT tcam_latency_seconds seconds\n"
+              "# HELP tcam_latency_seconds Latency of the frames sent from their VSYNC\n");
+  for (i = 0; i < num_cams; i++) {
+    for (s = 0; s < 3; s++) {
+      count = 0;
+      for (j = 0; j < LEP_METRICS_BUCKETS; j++) {
+        count += hist[i][s][j];
+        if (j < LEP_METRICS_BUCKETS - 1) {
+          put_metrics(buf, &n, "tcam_latency_seconds_bucket{camera=\"lepton%d\",stage=\"%s\",le=\"%g\"} %u\n",
+                      i, stages[s], metrics_bounds[j] / 1e6, count);
+        } else {
+          put_metrics(buf, &n, "tcam_latency_seconds_bucket{camera=\"lepton%d\",stage=\"%s\",le=\"+Inf\"} %u\n",
+                      i, stages[s], count);
         }
       }
+      put_metrics(buf, &n, "tcam_latency_seconds_count{camera=\"lepton%d\",stage=\"%s\"} %u\n", i, stages[s], count);
+      put_metrics(buf, &n, "tcam_latency_seconds_sum{camera=\"lepton%d\",stage=\"%s\"} %.6f\n", i, stages[s],
+                  sum[i][s] / 1e6);
+    }
+  }
+  put_metrics(buf, &n, "# EOF\n");
+
+  return n;
+}
+
+/**
+ * Answer HTTP GET /metrics requests (404 for anything else), one connection at a time
+ */
+void* serve_metrics(void* arg)
+{
+  static const char not_found[] = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+  static char body[LEP_METRICS_MAX_LEN];
+  char req[1024];
+  char hdr[192];
+  struct sockaddr_in addr;
+  struct timeval tv = {2, 0};
+  int fd, cfd, len, hlen, r, opt = 1;
 
-      // Send the message
-      zmq_send(responder, message_buf, sizeof(message_buf), 0);
+  fd = socket(AF_INET, SOCK_STREAM, 0);
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(LEP_METRICS_PORT);
+  if ((fd < 0) || (bind(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) || (listen(fd, 4) != 0)) {
+    log_error("Failed to open metrics port %d", LEP_METRICS_PORT);
+    return NULL;
+  }
+
+  while (1) {
+    if ((cfd = accept(fd, NULL, NULL)) < 0) continue;
+    setsockopt(cfd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    // Read the request line and headers
+    len = 0;
+    while (len < (int) sizeof(req) - 1) {
+      if ((r = recv(cfd, req + len, sizeof(req) - 1 - len, 0)) <= 0) break;
+      len += r;
+      req[len] = 0;
+      if (strstr(req, "\r\n\r\n") != NULL) break;
     }
+    req[len] = 0;
+
+    if (strncmp(req, "GET /metrics", 12) == 0) {
+      len = get_metrics(body);
+      hlen = snprintf(hdr, sizeof(hdr), "HTTP/1.1 200 OK\r\nContent-Type: application/openmetrics-text; version=1.0.0; charset=utf-8\r\n"
+                      "Content-Length: %d\r\nConnection: close\r\n\r\n", len);
+      if (send(cfd, hdr, hlen, MSG_NOSIGNAL) == hlen) {
+        (void) send(cfd, body, len, MSG_NOSIGNAL);
+      }
+    } else {
+      (void) send(cfd, not_found, strlen(not_found), MSG_NOSIGNAL);
+    }
+    close(cfd);
+  }
+}
+#endif
+
+/**
+ * Setup a camera from the next arguments (I2C device, SPI device and an optional
+ * socket spec).  Returns the index of the argument after them.
+ */
+int init_cam(lep_cam_t* c, int index, int argc, char* argv[], int arg)
+{
+  memset(c, 0, sizeof(lep_cam_t));
+  c->index = index;
+  c->i2c_path = argv[arg++];
+  c->spi_path = argv[arg++];
+  if ((arg < argc) && (strncmp(argv[arg], "/dev/", 5) != 0)) {
+    c->socket_spec = argv[arg++];
+  } else {
+    c->socket_spec = (index == 0) ? ZMQ_DEFAULT_SOCKET_SPEC : ZMQ_DEFAULT_SOCKET_SPEC_1;
+  }
+#ifdef LEP_STATS_SOCKET_SPEC
+  c->stats_spec = (index == 0) ? LEP_STATS_SOCKET_SPEC : LEP_STATS_SOCKET_SPEC_1;
+#endif
+  c->cal_file = (index == 0) ? LEP_SPI_CAL_FILE : LEP_SPI_CAL_FILE_1;
+  c->vsync_gpio = (index == 0) ? VOSPI_VSYNC_GPIO : VOSPI_VSYNC_GPIO_1;
+
+  pthread_mutex_init(&c->lock, NULL);
+  pthread_cond_init(&c->avail_cond, NULL);
+  pthread_cond_init(&c->space_cond, NULL);
+
+  // Allocate space to receive the segments in the circular buffer
+  for (int frame = 0; frame < FRAME_BUF_SIZE; frame ++) {
+    c->frame_buf[frame] = malloc(sizeof(vospi_frame_t));
+  }
+
+  return arg;
 }
 
 /**
@@ -206,44 +971,102 @@ void* send_frames_to_socket(void* socket_path_ptr)
  */
 int main(int argc, char *argv[])
 {
-  char hwDevs[2][64];
-  pthread_t get_frames_thread, send_frames_to_socket_thread;
+  pthread_t get_frames_thread[LEP_MAX_CAMS], send_frames_to_socket_thread[LEP_MAX_CAMS];
+#ifdef LEP_STATS_SOCKET_SPEC
+  pthread_t send_stats_to_socket_thread[LEP_MAX_CAMS];
+#endif
+#ifdef LEP_METRICS_PORT
+  pthread_t serve_metrics_thread;
+#endif
+  int arg = 1;
 
   // Set the log level
   log_set_level(LOG_INFO);
 
-  // Setup semaphores
-  sem_init(&count_sem, 0, 0);
-
   // Check we have enough arguments to work
   if (argc < 3) {
     log_error("Can't start - I2C then SPI device file path must be specified.");
     exit(-1);
   }
 
-  // Allocate space to receive the segments in the circular buffer
+  // Each camera's I2C and SPI devices (and socket spec)
   log_info("preallocating space for segments...");
-  for (int frame = 0; frame < FRAME_BUF_SIZE; frame ++) {
-    frame_buf[frame] = malloc(sizeof(vospi_frame_t));
-    for (int seg = 0; seg < VOSPI_SEGMENTS_PER_FRAME; seg ++) {
-      frame_buf[frame]->segments[seg].packet_count = VOSPI_PACKETS_PER_SEGMENT_NORMAL;
-    }
+  while ((num_cams < LEP_MAX_CAMS) && ((arg + 1) < argc)) {
+    arg = init_cam(&cams[num_cams], num_cams, argc, argv, arg);
+    num_cams++;
+  }
+  if (arg < argc) {
+    log_error("Can't start - unexpected argument %s", argv[arg]);
+    exit(-1);
+  }
+#ifdef LEP_V4L2_OUTPUT
+#ifdef LEP_V4L2_GREY
+  if (v4l2out_open(&v4l2_out, V4L2OUT_DEV, VOSPI_WIDTH, VOSPI_HEIGHT, V4L2_PIX_FMT_GREY)) {
+#else
+  if (v4l2out_open(&v4l2_out, V4L2OUT_DEV, VOSPI_WIDTH, VOSPI_HEIGHT, V4L2_PIX_FMT_Y16)) {
+#endif
+    return 1;
   }
-  (void) strcpy(hwDevs[0], argv[1]); // I2C
-  (void) strcpy(hwDevs[1], argv[2]); // SPI
-  log_info("Creating get_frames_from_device thread");
-  if (pthread_create(&get_frames_thread, NULL, get_frames_from_device, hwDevs)) {
-    log_fatal("Error creating get_frames_from_device thread");
+#endif
+#ifdef LEP_H264_OUTPUT
+  log_info("Starting H.264 encoder");
+  if (h264_init(H264_DEVICE, H264_PORT) < 0) {
+    log_fatal("H.264 encoder failed to start");
     return 1;
   }
+#endif
+#ifdef LEP_DRM_OUTPUT
+  log_info("Starting DRM display");
+  if (drmout_init(DRMOUT_DEVICE) < 0) {
+    log_fatal("DRM display failed to start");
+    return 1;
+  }
+#endif
+#ifdef LEP_FRAME_BUS
+  if ((frame_bus = frame_bus_create(FRAME_BUS_NAME, VOSPI_WIDTH, VOSPI_HEIGHT, FRAME_BUS_FMT_16BE)) == NULL) {
+    log_fatal("Failed to create frame bus %s", FRAME_BUS_NAME);
+    return 1;
+  }
+#endif
+#ifdef VOSPI_RT_CAPTURE
+  // Keep our pages in memory so the capture thread never waits for a page fault
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    log_error("mlockall failed - run as root to lock memory");
+  }
+#endif
+
+  for (int i = 0; i < num_cams; i++) {
+    log_info("Creating get_frames_from_device thread");
+    if (pthread_create(&get_frames_thread[i], NULL, get_frames_from_device, &cams[i])) {
+      log_fatal("Error creating get_frames_from_device thread");
+      return 1;
+    }
 
-  log_info("Creating send_frames_to_socket thread");
-  char* socket_path = argc > 3 ? argv[3] : ZMQ_DEFAULT_SOCKET_SPEC;
-  if (pthread_create(&send_frames_to_socket_thread, NULL, send_frames_to_socket, socket_path)) {
-    log_fatal("Error creating send_frames_to_socket thread");
+    log_info("Creating send_frames_to_socket thread (%s)", cams[i].socket_spec);
+    if (pthread_create(&send_frames_to_socket_thread[i], NULL, send_frames_to_socket, &cams[i])) {
+      log_fatal("Error creating send_frames_to_socket thread");
+      return 1;
+    }
+
+#ifdef LEP_STATS_SOCKET_SPEC
+    log_info("Creating send_stats_to_socket thread (%s)", cams[i].stats_spec);
+    if (pthread_create(&send_stats_to_socket_thread[i], NULL, send_stats_to_socket, &cams[i])) {
+      log_fatal("Error creating send_stats_to_socket thread");
+      return 1;
+    }
+#endif
+  }
+
+#ifdef LEP_METRICS_PORT
+  log_info("Creating serve_metrics thread (port %d)", LEP_METRICS_PORT);
+  if (pthread_create(&serve_metrics_thread, NULL, serve_metrics, NULL)) {
+    log_fatal("Error creating serve_metrics thread");
     return 1;
   }
+#endif
 
-  pthread_join(get_frames_thread, NULL);
-  pthread_join(send_frames_to_socket_thread, NULL);
+  for (int i = 0; i < num_cams; i++) {
+    pthread_join(get_frames_thread[i], NULL);
+    pthread_join(send_frames_to_socket_thread[i], NULL);
+  }
 }
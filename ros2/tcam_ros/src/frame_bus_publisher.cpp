@@ -0,0 +1,232 @@
+/*
+ * ROS 2 frame bus publisher: a composable node that republishes the frames a capture
+ * program (leptonic on the Raspberry Pi or pru_leptonic on the Beaglebone) writes to
+ * the local shared memory frame bus (vospi_asm/frame_bus.h).
+ *
+ *   image_raw        sensor_msgs/Image, mono16 (radiometric or raw 14-bit pixels) or
+ *                    mono8 (AGC pixels) as the publisher wrote them
+ *   telemetry        std_msgs/UInt16MultiArray, the Lepton's telemetry words (only for
+ *                    frames that carry them)
+ *   fpa_temperature  sensor_msgs/Temperature, the Lepton's FPA temperature (deg C)
+ *
+ * Each message is stamped with the frame's capture time, not the time it was
+ * published.  Frames are copied once, from their frame bus slot into the message (the
+ * slot is overwritten a few frames later), and checked against the slot's sequence
+ * lock afterwards so a frame overwritten during the copy is dropped.  Messages are
+ * loaned from the middleware when it supports it and are otherwise published as
+ * unique_ptrs which intra-process subscribers in the same component container take
+ * without another copy.
+ *
+ * Copyright 2021 Dan Julio
+ *
+ * This file is part of tCam.
+ *
+ * tCam is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * tCam is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with tCam.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ */
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <time.h>
+
+#include "rclcpp/rclcpp.hpp"
+#include "rclcpp_components/register_node_macro.hpp"
+#include "sensor_msgs/msg/image.hpp"
+#include "sensor_msgs/msg/temperature.hpp"
+#include "std_msgs/msg/u_int16_multi_array.hpp"
+
+#include "frame_bus.h"
+
+
+namespace tcam_ros
+{
+
+class FrameBusPublisher : public rclcpp::Node
+{
+public:
+  explicit FrameBusPublisher(const rclcpp::NodeOptions& options)
+  : Node("tcam_frame_bus", rclcpp::NodeOptions(options).use_intra_process_comms(true))
+  {
+    bus_name_ = declare_parameter<std::string>("bus_name", FRAME_BUS_NAME);
+    frame_id_ = declare_parameter<std::string>("frame_id", "thermal_camera");
+    telemetry_ = declare_parameter<bool>("telemetry", true);
+
+    image_pub_ = create_publisher<sensor_msgs::msg::Image>("image_raw", rclcpp::SensorDataQoS());
+    if (telemetry_) {
+      telem_pub_ = create_publisher<std_msgs::msg::UInt16MultiArray>("telemetry", rclcpp::SensorDataQoS());
+      temp_pub_ = create_publisher<sensor_msgs::msg::Temperature>("fpa_temperature", rclcpp::SensorDataQoS());
+    }
+
+    // frame_bus_wait() blocks on the bus futex so frames are published from their own thread
+    thread_ = std::thread(&FrameBusPublisher::run, this);
+  }
+
+  ~FrameBusPublisher() override
+  {
+    stop_ = true;
+    if (thread_.joinable()) {
+      thread_.join();
+    }
+    frame_bus_close(&bus_);
+  }
+
+private:
+  void run()
+  {
+    const frame_bus_slot_t* slot;
+    uint32_t missed = 0;
+    bool open = false;
+
+    while (!stop_ && rclcpp::ok()) {
+      // Wait for the capture program to create the bus
+      if (!open) {
+        if (!frame_bus_open(&bus_, bus_name_.c_str())) {
+          std::this_thread::sleep_for(std::chrono::seconds(1));
+          continue;
+        }
+        RCLCPP_INFO(get_logger(), "Reading frames from %s", bus_name_.c_str());
+        open = true;
+        missed = 0;
+      }
+
+      // A timeout so stop_ is noticed, reopening the bus if the publisher restarted
+      if ((slot = frame_bus_wait(&bus_, 1000)) == NULL) {
+        if (__atomic_load_n(&bus_.bus->magic, __ATOMIC_ACQUIRE) != FRAME_BUS_MAGIC) {
+          RCLCPP_INFO(get_logger(), "Frame bus publisher went away");
+          frame_bus_close(&bus_);
+          open = false;
+        }
+        continue;
+      }
+      if (bus_.missed != missed) {
+        RCLCPP_DEBUG(get_logger(), "Missed %u frames", bus_.missed - missed);
+        missed = bus_.missed;
+      }
+
+      publish_frame(&slot->hdr);
+    }
+  }
+
+  void publish_frame(const tcam_frame_hdr_t* hdr)
+  {
+    builtin_interfaces::msg::Time stamp;
+
+    if (hdr->compression != TCAM_FRAME_COMP_RAW) {
+      RCLCPP_WARN_ONCE(get_logger(), "Ignoring compressed frames");
+      return;
+    }
+    stamp = capture_stamp(hdr);
+
+    if (image_pub_->can_loan_messages()) {
+      auto loan = image_pub_->borrow_loaned_message();
+      load_image(hdr, stamp, loan.get());
+      if (!frame_bus_valid(&bus_)) {
+        return;
+      }
+      image_pub_->publish(std::move(loan));
+    } else {
+      auto msg = std::make_unique<sensor_msgs::msg::Image>();
+      load_image(hdr, stamp, *msg);
+      if (!frame_bus_valid(&bus_)) {
+        return;
+      }
+      image_pub_->publish(std::move(msg));
+    }
+
+    if (telemetry_) {
+      publish_telemetry(hdr, stamp);
+    }
+  }
+
+  // The capture time on the node's clock (the producer's monotonic capture time is moved
+  // onto it by how long ago the frame was captured unless it also knew the wall time)
+  builtin_interfaces::msg::Time capture_stamp(const tcam_frame_hdr_t* hdr)
+  {
+    struct timespec ts;
+    int64_t age_nsec;
+
+    if (hdr->flags & TCAM_FRAME_FLAG_WALL) {
+      return rclcpp::Time(hdr->wall_usec * 1000, RCL_SYSTEM_TIME);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    age_nsec = ((int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec) - hdr->timestamp_usec * 1000;
+    return now() - rclcpp::Duration::from_nanoseconds(age_nsec);
+  }
+
+  void load_image(const tcam_frame_hdr_t* hdr, const builtin_interfaces::msg::Time& stamp,
+    sensor_msgs::msg::Image& img)
+  {
+    const uint8_t* pixels = tcam_frame_pixels(hdr);
+    int bpp = (hdr->format == TCAM_FRAME_FMT_8) ? 1 : 2;
+
+    img.header.stamp = stamp;
+    img.header.frame_id = frame_id_;
+    img.width = hdr->width;
+    img.height = hdr->height;
+    img.encoding = (bpp == 1) ? "mono8" : "mono16";
+    img.is_bigendian = (hdr->format == TCAM_FRAME_FMT_16BE);
+    img.step = hdr->width * bpp;
+    img.data.assign(pixels, pixels + img.step * img.height);
+  }
+
+  void publish_telemetry(const tcam_frame_hdr_t* hdr, const builtin_interfaces::msg::Time& stamp)
+  {
+    if (hdr->telem_len != 0) {
+      auto msg = std::make_unique<std_msgs::msg::UInt16MultiArray>();
+      const uint8_t* tP = tcam_frame_telem(hdr);
+      int n = hdr->telem_len / 2;
+      bool be = (hdr->flags & TCAM_FRAME_FLAG_TELEM_BE) != 0;
+
+      msg->layout.dim.resize(1);
+      msg->layout.dim[0].label = "word";
+      msg->layout.dim[0].size = n;
+      msg->layout.dim[0].stride = n;
+      msg->data.resize(n);
+      for (int i = 0; i < n; i++) {
+        msg->data[i] = be ? ((tP[2*i] << 8) | tP[2*i + 1]) : (tP[2*i] | (tP[2*i + 1] << 8));
+      }
+      if (frame_bus_valid(&bus_)) {
+        telem_pub_->publish(std::move(msg));
+      }
+    }
+
+    if (hdr->telem_fields & TCAM_FRAME_TEL_FPA_TEMP) {
+      auto msg = std::make_unique<sensor_msgs::msg::Temperature>();
+
+      msg->header.stamp = stamp;
+      msg->header.frame_id = frame_id_;
+      msg->temperature = ((double) hdr->fpa_temp_k100 - 27315.0) / 100.0;
+      msg->variance = 0;
+      if (frame_bus_valid(&bus_)) {
+        temp_pub_->publish(std::move(msg));
+      }
+    }
+  }
+
+  std::string bus_name_;
+  std::string frame_id_;
+  bool telemetry_;
+  frame_bus_client_t bus_ = {};
+  std::atomic<bool> stop_{false};
+  std::thread thread_;
+  rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr image_pub_;
+  rclcpp::Publisher<std_msgs::msg::UInt16MultiArray>::SharedPtr telem_pub_;
+  rclcpp::Publisher<sensor_msgs::msg::Temperature>::SharedPtr temp_pub_;
+};
+
+}  // namespace tcam_ros
+
+RCLCPP_COMPONENTS_REGISTER_NODE(tcam_ros::FrameBusPublisher)
@@ -0,0 +1,287 @@
+/*
+ * LeptonRecorder - Raw 16-bit frame recorder for the teensy 4 test sketches
+ *
+ * Software released "as-is" for instructional use.  No warranty as to correctness or fitness for any application.
+ *
+ */
+#include <time.h>
+#include "LeptonRecorder.h"
+
+#if !defined(__IMXRT1062__)
+#error "LeptonRecorder requires a teensy 4"
+#endif
+
+LeptonRecorder LepRecorder;
+
+// Configuration
+static SdFs* recSd;
+static uint32_t recFileFrames;
+
+// Staging double buffer (OCRAM: the CPU copies into it and SdFat copies out of it).  head
+// and tail are free-running counts of records staged by the ISR and written by service().
+DMAMEM static uint8_t recBuf[LEP_REC_BUFFERS][LEP_REC_RECORD_BYTES] __attribute__((aligned(32)));
+static volatile uint32_t recHead;
+static volatile uint32_t recTail;
+static volatile bool recording = false;
+
+// Staging state (owned by the ISR while recording)
+static uint32_t recSeq;
+static volatile uint32_t recDropped;
+static uint32_t prevMicros;
+static uint32_t microsHigh;
+static int64_t rtcOffsetUsec;
+
+// Writer state
+static uint8_t hdrBuf[LEP_REC_ALIGN] __attribute__((aligned(32)));
+static LepRecFileHdr* fileHdr = (LepRecFileHdr*) hdrBuf;
+static FsFile recFile;
+static bool fileOpen = false;
+static char recStamp[20];
+static int fileNum;
+static uint32_t totalFrames;
+static uint32_t maxWriteMsec;
+
+
+static int64_t Micros64() {
+  uint32_t t = micros();
+
+  if (t < prevMicros) {
+    microsHigh++;
+  }
+  prevMicros = t;
+  return ((int64_t) microsHigh << 32) | t;
+}
+
+
+void LeptonRecorder::begin(SdFs* sd, uint32_t fileFrames)
+{
+  recSd = sd;
+  recFileFrames = fileFrames;
+}
+
+
+bool LeptonRecorder::start()
+{
+  struct tm tm;
+  time_t now;
+
+  if (recording || fileOpen) {
+    return false;
+  }
+
+  // Files are named from the RTC (set to local time when the sketch is uploaded)
+  now = rtc_get();
+  gmtime_r(&now, &tm);
+  strftime(recStamp, sizeof(recStamp), "%Y%m%d_%H%M%S", &tm);
+  fileNum = 0;
+  totalFrames = 0;
+  maxWriteMsec = 0;
+
+  // Padding after the pixels is written as zeros
+  memset(recBuf, 0, sizeof(recBuf));
+  recHead = 0;
+  recTail = 0;
+  recSeq = 0;
+  recDropped = 0;
+  prevMicros = 0;
+  microsHigh = 0;
+  rtcOffsetUsec = (int64_t) now * 1000000 - Micros64();
+
+  if (!openFile()) {
+    return false;
+  }
+  recording = true;
+  return true;
+}
+
+
+void LeptonRecorder::stop()
+{
+  recording = false;
+  (void) service();
+  closeFile();
+}
+
+
+bool LeptonRecorder::isRecording()
+{
+  return recording;
+}
+
+
+bool LeptonRecorder::stageFrame(const uint16_t* pixels)
+{
+  LepRecFrameHdr* rec;
+
+  if (!recording) {
+    return false;
+  }
+
+  if ((recHead - recTail) >= LEP_REC_BUFFERS) {
+    recSeq++;
+    recDropped++;
+    return false;
+  }
+
+  rec = (LepRecFrameHdr*) recBuf[recHead % LEP_REC_BUFFERS];
+  rec->magic = LEP_REC_FRAME_MAGIC;
+  rec->seq = recSeq++;
+  rec->monotonic_usec = Micros64();
+  rec->realtime_usec = rec->monotonic_usec + rtcOffsetUsec;
+  memcpy(rec + 1, pixels, LEP_REC_FRAME_BYTES);
+
+  // The record is complete before service() sees it
+  __asm__ volatile("" ::: "memory");
+  recHead = recHead + 1;
+  return true;
+}
+
+
+bool LeptonRecorder::service()
+{
+  LepRecFrameHdr* rec;
+  uint32_t head, n, i, slot, t;
+
+  head = recHead;
+  while (recTail != head) {
+    if (!fileOpen && !openFile()) {
+      // Storage failed, discard the frames
+      recording = false;
+      recTail = head;
+      return false;
+    }
+
+    // One run: contiguous in the double buffer and in the file
+    slot = recTail % LEP_REC_BUFFERS;
+    n = head - recTail;
+    if (n > LEP_REC_BUFFERS - slot) n = LEP_REC_BUFFERS - slot;
+    if (n > fileHdr->capacity - fileHdr->num_frames) n = fileHdr->capacity - fileHdr->num_frames;
+
+    for (i=0; i<n; i++) {
+      rec = (LepRecFrameHdr*) recBuf[slot + i];
+      rec->index = fileHdr->num_frames + i;
+    }
+
+    t = millis();
+    if (recFile.write(recBuf[slot], n * LEP_REC_RECORD_BYTES) != n * LEP_REC_RECORD_BYTES) {
+      closeFile();
+      recording = false;
+      recTail = head;
+      return false;
+    }
+    t = millis() - t;
+    if (t > maxWriteMsec) {
+      maxWriteMsec = t;
+    }
+
+    // Update the index the next writeIndex() stores
+    rec = (LepRecFrameHdr*) recBuf[slot];
+    if (fileHdr->num_frames == 0) {
+      fileHdr->first_usec = rec->realtime_usec;
+    }
+    rec = (LepRecFrameHdr*) recBuf[slot + n - 1];
+    fileHdr->last_usec = rec->realtime_usec;
+    fileHdr->num_frames += n;
+    fileHdr->dropped = recDropped;
+    totalFrames += n;
+    recTail = recTail + n;
+
+    if (fileHdr->num_frames == fileHdr->capacity) {
+      closeFile();
+    } else if ((totalFrames % LEP_REC_INDEX_FRAMES) < n) {
+      (void) writeIndex();
+    }
+  }
+
+  return true;
+}
+
+
+uint32_t LeptonRecorder::getFrameCount()
+{
+  return totalFrames;
+}
+
+
+uint32_t LeptonRecorder::getDroppedCount()
+{
+  return recDropped;
+}
+
+
+uint32_t LeptonRecorder::getMaxWriteMsec()
+{
+  return maxWriteMsec;
+}
+
+
+//
+// Create and preallocate the next file.  Returns false if it couldn't be created.
+//
+bool LeptonRecorder::openFile()
+{
+  char path[40];
+  uint64_t len = LEP_REC_ALIGN + (uint64_t) recFileFrames * LEP_REC_RECORD_BYTES;
+
+  sprintf(path, "rec_%s_%03d.lrf", recStamp, fileNum++);
+  if (!recFile.open(path, O_RDWR | O_CREAT | O_TRUNC)) {
+    return false;
+  }
+
+  // Allocate the whole file as one extent now so writes never wait for cluster allocation
+  // (the recording continues in a fragmented file if the card has no room for one)
+  (void) recFile.preAllocate(len);
+
+  memset(hdrBuf, 0, sizeof(hdrBuf));
+  fileHdr->magic = LEP_REC_FILE_MAGIC;
+  fileHdr->version = LEP_REC_VERSION;
+  fileHdr->width = LEP_REC_WIDTH;
+  fileHdr->height = LEP_REC_HEIGHT;
+  fileHdr->pixel_bytes = LEP_REC_PIXEL_BYTES;
+  fileHdr->header_bytes = LEP_REC_ALIGN;
+  fileHdr->record_bytes = LEP_REC_RECORD_BYTES;
+  fileHdr->capacity = recFileFrames;
+  fileHdr->dropped = recDropped;
+  fileOpen = true;
+  if (!writeIndex()) {
+    recFile.close();
+    fileOpen = false;
+    return false;
+  }
+
+  return true;
+}
+
+
+//
+// Finish the current file, trimming any unused preallocated space
+//
+void LeptonRecorder::closeFile()
+{
+  if (!fileOpen) {
+    return;
+  }
+
+  (void) writeIndex();
+  (void) recFile.truncate(LEP_REC_ALIGN + (uint64_t) fileHdr->num_frames * LEP_REC_RECORD_BYTES);
+  recFile.close();
+  fileOpen = false;
+}
+
+
+//
+// Write the file header (the index) and sync the file, leaving the file position after
+// the last record.  Returns false on failure.
+//
+bool LeptonRecorder::writeIndex()
+{
+  uint64_t pos = LEP_REC_ALIGN + (uint64_t) fileHdr->num_frames * LEP_REC_RECORD_BYTES;
+
+  if (!recFile.seekSet(0) || (recFile.write(hdrBuf, LEP_REC_ALIGN) != LEP_REC_ALIGN)) {
+    return false;
+  }
+  if (!recFile.seekSet(pos)) {
+    return false;
+  }
+  return recFile.sync();
+}
@@ -0,0 +1,125 @@
+/*
+ * LeptonRecorder - Raw 16-bit frame recorder for the teensy 4 test sketches
+ *   - Writes every frame to an SD card (SdFat) in the same .lrf container files as the
+ *     PocketBeagle's pru_record (described below) so the same tools read both
+ *   - Each file is preallocated as one contiguous extent so writes never wait for cluster
+ *     allocation and unused space is trimmed when the file is closed
+ *   - Records are a multiple of 512 bytes and written from 512 byte aligned buffers so
+ *     SdFat sends each run of records straight from the buffer as one multi-block write
+ *   - Frames are staged from the acquisition ISR with a copy into a double buffer and
+ *     written from loop() so a slow card never stalls acquisition.  Frames that arrive while
+ *     both buffers are full are dropped and counted.
+ *   - The file header holds the index (the number of valid frames), which is rewritten and
+ *     synced every LEP_REC_INDEX_FRAMES frames rather than each frame
+ *
+ * File layout (all little-endian):
+ *   Header      LEP_REC_ALIGN bytes (LepRecFileHdr followed by zeros)
+ *   Records     LEP_REC_RECORD_BYTES each, a LepRecFrameHdr followed by the frame's
+ *               pixels (16-bit, row order) and zeros
+ * Readers find the records with header_bytes and record_bytes (pru_record uses 4096 byte
+ * blocks).  Times are from the teensy RTC and micros().
+ *
+ * Usage
+ *   LepRecorder.begin(&sd, LEP_REC_DEF_FILE_FRAMES);
+ *   LepRecorder.start();
+ *   ...
+ *   LepRecorder.stageFrame(acqBuffer);   // In the ISR when a frame is complete
+ *   ...
+ *   LepRecorder.service();               // In loop()
+ *   ...
+ *   LepRecorder.stop();
+ *
+ * Requires a teensy 4 (the double buffer doesn't fit in a teensy 3.2's RAM) and SdFat 2
+ * (included with Teensyduino 1.54 and later).
+ *
+ * Software released "as-is" for instructional use.  No warranty as to correctness or fitness for any application.
+ *
+ */
+#ifndef _LEPTON_RECORDER_H_
+#define _LEPTON_RECORDER_H_
+
+#include <Arduino.h>
+#include <SdFat.h>
+
+// Block size the files are written in (the SD card's block size)
+#define LEP_REC_ALIGN           512
+
+// Records staged between the ISR and the writer
+#define LEP_REC_BUFFERS         2
+
+// Frames between index updates (about 10 seconds)
+#define LEP_REC_INDEX_FRAMES    87
+
+// Default frames per file (about 10 minutes)
+#define LEP_REC_DEF_FILE_FRAMES 5220
+
+#define LEP_REC_WIDTH           160
+#define LEP_REC_HEIGHT          120
+#define LEP_REC_PIXEL_BYTES     2
+#define LEP_REC_FRAME_BYTES     (LEP_REC_WIDTH * LEP_REC_HEIGHT * LEP_REC_PIXEL_BYTES)
+
+#define LEP_REC_FILE_MAGIC      0x4352464C
+#define LEP_REC_FRAME_MAGIC     0x4345524C
+#define LEP_REC_VERSION         1
+
+#define LEP_REC_RECORD_BYTES    (((sizeof(LepRecFrameHdr) + LEP_REC_FRAME_BYTES) + LEP_REC_ALIGN - 1) & ~(LEP_REC_ALIGN - 1))
+
+// Same layout as pru_record's rec_file_hdr_t
+typedef struct {
+  uint32_t magic;          // LEP_REC_FILE_MAGIC
+  uint32_t version;
+  uint16_t width;
+  uint16_t height;
+  uint16_t pixel_bytes;
+  uint16_t reserved;
+  uint32_t header_bytes;   // Offset of the first record
+  uint32_t record_bytes;
+  uint32_t capacity;       // Frames the file was preallocated for
+  uint32_t num_frames;     // Valid frames (the index)
+  uint32_t dropped;        // Frames dropped since recording started
+  int64_t first_usec;      // Realtime of the first and last valid frames
+  int64_t last_usec;
+} LepRecFileHdr;
+
+// Same layout as pru_record's rec_frame_hdr_t
+typedef struct {
+  uint32_t magic;          // LEP_REC_FRAME_MAGIC
+  uint32_t index;          // Frame number in the file
+  uint32_t seq;            // Frames staged since recording started (gaps are dropped frames)
+  uint32_t reserved;
+  int64_t realtime_usec;   // RTC time when the frame was staged
+  int64_t monotonic_usec;  // micros() (extended to 64 bits) when the frame was staged
+} LepRecFrameHdr;
+
+
+class LeptonRecorder
+{
+public:
+  // sd must already be started
+  void begin(SdFs* sd, uint32_t fileFrames);
+
+  bool start();
+  void stop();
+  bool isRecording();
+
+  // Copy a complete frame (host order 16-bit pixels) into a free buffer.  Called from the
+  // acquisition ISR.  Returns false if the frame was dropped.
+  bool stageFrame(const uint16_t* pixels);
+
+  // Write the staged frames.  Called from loop().  Returns false if recording stopped
+  // because of a card error.
+  bool service();
+
+  uint32_t getFrameCount();
+  uint32_t getDroppedCount();
+  uint32_t getMaxWriteMsec();
+
+private:
+  bool openFile();
+  void closeFile();
+  bool writeIndex();
+};
+
+extern LeptonRecorder LepRecorder;
+
+#endif /* _LEPTON_RECORDER_H_ */
@@ -63,7 +63,7 @@
 *******************************************************************************/
 #include "LeptonSDKEmb32OEM.h"
 #include <Arduino.h>
-#if defined(CORE_TEENSY)
+#if defined(LEP_I2C_T3)
 #include <i2c_t3.h>
 #else
 #include <Wire.h> 
@@ -75,6 +75,15 @@
 
 LeptonSDKEmb32OEM::LeptonSDKEmb32OEM()
 {
+    asyncHead = 0;
+    asyncCount = 0;
+    asyncState = ASYNC_IDLE;
+
+#if (USE_ATTRIBUTE_CACHE == 1)
+    attrCacheEnable = LEP_FALSE;
+    attrCacheGen = 0;
+    LEP_InvalidateAttrCache();
+#endif
 }
 
 
@@ -82,159 +91,6 @@ LeptonSDKEmb32OEM::LeptonSDKEmb32OEM()
 /*                AGC                 */
 /**************************************/
 
-/**
- * Retrieves the current AGC Enable state from the Camera. The 
- * AGC enable state turns AGC On (enabled) or OFF (disabled).   
- * 
- * @param agcEnableStatePtr
- *               Pointer to variable to update with the camera's
- *               current state.
- *               Range:
- *                  LEP_AGC_DISABLE=0
- *                  LEP_AGC_ENABLE =1
- * 
- * @return LEP_OK if all goes well, otherwise an error code.
- */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_AGC_ENABLE_E_PTR agcEnableStatePtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* attribute is an enum, so 32-bit value */
-
-   /* Validate Parameter(s)
-   */
-   if( agcEnableStatePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Read the Camera's AGC Enable State
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR )agcEnableStatePtr,
-                              attributeWordLength );
-   return( result );
-}
-
-/**
- * Sets the current AGC Enable state on the Camera.  The 
- * AGC enable state turns AGC On (enabled) or OFF (disabled).
- * 
- * @param agcEnableState 
- *             Specifies the enable state to set the camera' AGC
- *             Range:
- *                LEP_AGC_DISABLE=0
- *                LEP_AGC_ENABLE =1
- * 
- * @return LEP_OK if all goes well, otherwise an error code.
- */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_AGC_ENABLE_E agcEnableState )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* 2 16-bit value */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) agcEnableState;
-
-   /* Validate Parameter(s)
-   */
-   if( agcEnableState >= LEP_END_AGC_ENABLE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   /* Perform Command
-   ** Writing the Camera's AGC Enable State
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcPolicy( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                             LEP_AGC_POLICY_E_PTR agcPolicyPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* 2 16-bit value */
-
-   /* Validate Parameter(s)
-   */
-   if( agcPolicyPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Reading the Camera's AGC Policy
-   */
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_POLICY,
-                              ( LEP_ATTRIBUTE_T_PTR )agcPolicyPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcPolicy( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                             LEP_AGC_POLICY_E agcPolicy )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* 2 16-bit value */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) agcPolicy;
-
-   /* Bounds Check
-   */
-   if( agcPolicy >= LEP_END_AGC_POLICY )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   /* Perform Command
-   ** Writing the Camera's AGC Policy
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_POLICY,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcROI( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                          LEP_AGC_ROI_T_PTR agcROIPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* four 16-bit values */
-
-   /* Validate Parameter(s)
-   */
-   if( agcROIPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Reading the Camera's AGC ROI
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_ROI,
-                              ( LEP_ATTRIBUTE_T_PTR )agcROIPtr,
-                              attributeWordLength );
-   //return(sizeof(*agcROIPtr));
-   return( result );
-}
-
-
 LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcROI( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                           LEP_AGC_ROI_T agcROI )
 {
@@ -258,5854 +114,2850 @@ LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcROI( LEP_CAMERA_PORT_DESC_T_PTR portDesc
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcLinearHistogramClipPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_UINT16 *agcLinearHistogramClipPercentPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHistogramStatistics( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                          LEP_AGC_HISTOGRAM_STATISTICS_T_PTR *agcHistogramStatisticsPtr )
 {
    LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+   LEP_UINT16 attributeWordLength = 4; /* four 16-bit values */
 
    /* Validate Parameter(s)
    */
-   if( agcLinearHistogramClipPercentPtr == NULL )
+   if( agcHistogramStatisticsPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
 
    /* Perform Command
-   ** Reading the Camera's AGC Linear Histogram Clip Percent
+   ** Reading the Camera's AGC Linear Histogram Statistics
    */
    result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HISTOGRAM_CLIP_PERCENT,
-                              ( LEP_ATTRIBUTE_T_PTR )agcLinearHistogramClipPercentPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_AGC_STATISTICS,
+                              ( LEP_ATTRIBUTE_T_PTR )agcHistogramStatisticsPtr,
                               attributeWordLength );
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcLinearHistogramClipPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_UINT16 agcLinearHistogramClipPercent )
+
+
+/* Linear Policy Controls
+*/
+
+/* Heq Policy Controls
+*/
+
+/**************************************/
+/*           I2C_Protocol             */
+/**************************************/
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_SelectDevice(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr, 
+                                LEP_PROTOCOL_DEVICE_E device)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_RESULT result;
 
+    result = LEP_I2C_MasterSelectDevice( portDescPtr, device );
 
-   /* Perform Command
-   ** Writing the Camera's AGC Linear Histogram Clip Percent
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HISTOGRAM_CLIP_PERCENT,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcLinearHistogramClipPercent,
-                              attributeWordLength
-                              );
-   return( result );
+    return(result);
 }
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcLinearHistogramTailSize( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_UINT16 *agcLinearHistogramTailSizePtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_OpenPort(LEP_UINT16 portID,
+                            LEP_UINT16 *baudRateInkHz,
+                            LEP_UINT8* deviceAddress)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+   LEP_RESULT result;
+   LEP_UINT16 statusReg;
 
-   /* Validate Parameter(s)
-   */
-   if( agcLinearHistogramTailSizePtr == NULL )
+   result = LEP_I2C_MasterOpen( portID, baudRateInkHz );
+
+   if(result != LEP_OK)
    {
-      return( LEP_BAD_ARG_POINTER_ERROR );
+      return(LEP_COMM_INVALID_PORT_ERROR);
    }
 
-   /* Perform Command
-   ** Reading the Camera's AGC Linear Histogram Tail Size
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HISTOGRAM_TAIL_SIZE,
-                              ( LEP_ATTRIBUTE_T_PTR )agcLinearHistogramTailSizePtr,
-                              attributeWordLength );
-   return( result );
+   *deviceAddress = 0x2a;
+   result = LEP_I2C_MasterReadData( portID,
+                                *deviceAddress,
+                                LEP_I2C_STATUS_REG,
+                                &statusReg,
+                                1 );
+   
+   if(result != LEP_OK)
+   {
+      /*
+       *    Try 0x00 as the device address if 0x2a didn't work. In this case, we are in Virgin Boot Mode.
+       *
+       */
+      *deviceAddress = 0x00;
+      result = LEP_I2C_MasterReadData( portID,
+                                   *deviceAddress,
+                                   LEP_I2C_STATUS_REG,
+                                   &statusReg,
+                                   1 );
+      if(result != LEP_OK)
+      {
+         return(LEP_COMM_NO_DEV);
+      }
+   }
+
+    return(result);
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcLinearHistogramTailSize( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_UINT16 agcLinearHistogramTailSize )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_ClosePort(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_RESULT result;
 
+    result =LEP_I2C_MasterClose( portDescPtr );
 
-   /* Perform Command
-   ** Writing the Camera's AGC Linear Histogram Clip Percent
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HISTOGRAM_TAIL_SIZE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcLinearHistogramTailSize,
-                              attributeWordLength
-                              );
-   return( result );
+    return(result);
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHistogramStatistics( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_AGC_HISTOGRAM_STATISTICS_T_PTR *agcHistogramStatisticsPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_ResetPort(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* four 16-bit values */
+    LEP_RESULT result;
 
-   /* Validate Parameter(s)
-   */
-   if( agcHistogramStatisticsPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    result = LEP_I2C_MasterReset( portDescPtr );
 
-   /* Perform Command
-   ** Reading the Camera's AGC Linear Histogram Statistics
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_STATISTICS,
-                              ( LEP_ATTRIBUTE_T_PTR )agcHistogramStatisticsPtr,
-                              attributeWordLength );
-   return( result );
+    return(result);
 }
 
 
-
-/* Linear Policy Controls
+/* The synchronous I2C commands are built on the asynchronous command engine
+** below and wait for their queued command to complete.
 */
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcLinearMaxGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_UINT16 *agcLinearMaxGainPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_GetAttribute(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                LEP_COMMAND_ID commandID, 
+                                LEP_ATTRIBUTE_T_PTR attributePtr,
+                                LEP_UINT16 attributeWordLength)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_ASYNC_CMD_T cmd;
 
-   /* Validate Parameter(s)
-   */
-   if( agcLinearMaxGainPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    cmd.portDescPtr = portDescPtr;
+    cmd.type = LEP_ASYNC_GET_ATTRIBUTE;
+    cmd.commandID = commandID;
+    cmd.attributePtr = attributePtr;
+    cmd.attributeWordLength = attributeWordLength;
+    cmd.callback = NULL;
 
-   /* Perform Command
-   ** Reading the Camera's AGC Linear Max Gain
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_LINEAR_MAX_GAIN,
-                              ( LEP_ATTRIBUTE_T_PTR )agcLinearMaxGainPtr,
-                              attributeWordLength );
-   return( result );
+    return(LEP_I2C_WaitCommand(&cmd));
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcLinearMaxGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_UINT16 agcLinearMaxGain )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_SetAttribute(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                LEP_COMMAND_ID commandID, 
+                                LEP_ATTRIBUTE_T_PTR attributePtr,
+                                LEP_UINT16 attributeWordLength)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_ASYNC_CMD_T cmd;
 
+    cmd.portDescPtr = portDescPtr;
+    cmd.type = LEP_ASYNC_SET_ATTRIBUTE;
+    cmd.commandID = commandID;
+    cmd.attributePtr = attributePtr;
+    cmd.attributeWordLength = attributeWordLength;
+    cmd.callback = NULL;
 
-   /* Perform Command
-   ** Writing the Camera's AGC Linear Max Gain
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_LINEAR_MAX_GAIN,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcLinearMaxGain,
-                              attributeWordLength
-                              );
-   return( result );
+    return(LEP_I2C_WaitCommand(&cmd));
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcLinearMidPoint( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_UINT16 *agcLinearMidPointPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_RunCommand(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                              LEP_COMMAND_ID commandID)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_ASYNC_CMD_T cmd;
 
-   /* Validate Parameter(s)
-   */
-   if( agcLinearMidPointPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    cmd.portDescPtr = portDescPtr;
+    cmd.type = LEP_ASYNC_RUN_COMMAND;
+    cmd.commandID = commandID;
+    cmd.attributePtr = NULL;
+    cmd.attributeWordLength = 0;
+    cmd.callback = NULL;
 
-   /* Perform Command
-   ** Reading the Camera's AGC Linear Midpoint
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_LINEAR_MIDPOINT,
-                              ( LEP_ATTRIBUTE_T_PTR )agcLinearMidPointPtr,
-                              attributeWordLength );
-   return( result );
+    return(LEP_I2C_WaitCommand(&cmd));
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcLinearMidPoint( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_UINT16 agcLinearMidPoint )
+/**
+ * Queues a command to be run by the asynchronous command engine.  cmdPtr
+ * (and its attribute data) must remain valid until cmdPtr->done is set.  The
+ * callback, if any, is called with the result just before done is set.  On
+ * the Teensy the command is sequenced from the i2c_t3 interrupt callbacks so
+ * the caller does not wait while the camera is busy.  Other platforms run the
+ * command to completion before returning.
+ *
+ * Other I2C devices on the bus must not be accessed while commands are queued.
+ * 
+ * @return LEP_OK if the command was queued, LEP_NOT_READY if the queue is full
+ */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_SubmitCommand(LEP_ASYNC_CMD_T_PTR cmdPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_BOOL start;
 
+    if( cmdPtr == NULL || cmdPtr->portDescPtr == NULL )
+    {
+        return(LEP_BAD_ARG_POINTER_ERROR);
+    }
+    if( cmdPtr->attributeWordLength > 1024 )
+    {
+        return(LEP_RANGE_ERROR);
+    }
 
-   /* Perform Command
-   ** Writing the Camera's AGC Linear Midpoint
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_LINEAR_MIDPOINT,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcLinearMidPoint,
-                              attributeWordLength
-                              );
-   return( result );
-}
+    cmdPtr->done = LEP_FALSE;
+    cmdPtr->result = LEP_OK;
 
+    /* Sets and resets empty the attribute cache when they are queued
+    */
+    AttrCacheCommand(cmdPtr->commandID);
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcLinearDampeningFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_UINT16 *agcLinearDampeningFactorPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    /* May be called from a completion callback in the I2C interrupt so
+    ** restore the previous interrupt mask
+    */
+#if defined(LEP_I2C_T3)
+    uint32_t primask;
 
-   /* Validate Parameter(s)
-   */
-   if( agcLinearDampeningFactorPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    __asm__ volatile("mrs %0, primask\n" : "=r" (primask)::);
+    __disable_irq();
+#endif
+    if( asyncCount == LEP_ASYNC_QUEUE_LENGTH )
+    {
+#if defined(LEP_I2C_T3)
+        if( !primask ) __enable_irq();
+#endif
+        return(LEP_NOT_READY);
+    }
+    asyncQueue[(asyncHead + asyncCount) % LEP_ASYNC_QUEUE_LENGTH] = cmdPtr;
+    asyncCount++;
+    start = (asyncState == ASYNC_IDLE);
+    if( start )
+    {
+        AsyncStart();
+    }
+#if defined(LEP_I2C_T3)
+    if( !primask ) __enable_irq();
+#endif
 
-   /* Perform Command
-   ** Reading the Camera's AGC Linear Dampening Factor
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_LINEAR_DAMPENING_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR )agcLinearDampeningFactorPtr,
-                              attributeWordLength );
-   return( result );
+    if( start )
+    {
+#if defined(LEP_I2C_T3)
+        AsyncIssue();
+#else
+        AsyncRun();
+#endif
+    }
+
+    return(LEP_OK);
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcLinearDampeningFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_UINT16 agcLinearDampeningFactor )
+/**
+ * Queues a command (waiting for room in the queue) and waits for it to
+ * complete.
+ * 
+ * @return The command's result
+ */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_WaitCommand(LEP_ASYNC_CMD_T_PTR cmdPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_RESULT result;
 
+    while( (result = LEP_I2C_SubmitCommand(cmdPtr)) == LEP_NOT_READY ) {}
+    if( result != LEP_OK )
+    {
+        return(result);
+    }
 
-   /* Perform Command
-   ** Writing the Camera's AGC Linear Histogram Dampening Factor
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_LINEAR_DAMPENING_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcLinearDampeningFactor,
-                              attributeWordLength
-                              );
-   return( result );
+    while( !cmdPtr->done ) {}
+
+    return(cmdPtr->result);
 }
 
 
+/**
+ * @return LEP_TRUE when no commands are queued or running
+ */
+LEP_BOOL LeptonSDKEmb32OEM::LEP_I2C_AsyncIdle(void)
+{
+    return( (asyncState == ASYNC_IDLE) ? LEP_TRUE : LEP_FALSE );
+}
+
 
-/* Heq Policy Controls
+/* Implement the Lepton TWI READ and WRITE Protocols for the command at the
+** head of the queue.  Called with the engine idle.
 */
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqDampingFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_UINT16 *agcHeqDampingFactorPtr )
+void LeptonSDKEmb32OEM::AsyncStart(void)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    /* First wait until the Camera is ready to receive a new
+    ** command by polling the STATUS REGISTER BUSY Bit until it
+    ** reports NOT BUSY.
+    */ 
+    asyncTimeoutCount = LEPTON_I2C_COMMAND_BUSY_WAIT_COUNT;
+    asyncState = ASYNC_WAIT_READY;
+    AsyncSetTransfer(LEP_FALSE, LEP_I2C_STATUS_REG, &asyncXferWord, 1);
+}
 
-   /* Validate Parameter(s)
-   */
-   if( agcHeqDampingFactorPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
 
-   /* Perform Command
-   ** Reading the Camera's AGC HEQ Dampening Factor
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_DAMPENING_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR )agcHeqDampingFactorPtr,
-                              attributeWordLength );
-   return( result );
+void LeptonSDKEmb32OEM::AsyncSetTransfer(LEP_BOOL write, LEP_UINT16 regAddress, LEP_UINT16 *dataPtr, LEP_UINT16 words)
+{
+    asyncXferWrite = write;
+    asyncXferReg = regAddress;
+    asyncXferPtr = dataPtr;
+    asyncXferWords = words;
+    asyncXferOffset = 0;
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqDampingFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_UINT16 agcHeqDampingFactor )
+/* Moves the command at the head of the queue to its next state given the
+** result of the transfer that just completed and sets up the next transfer.
+** Returns the command if it completed (the next queued command, if any, is
+** started).
+*/
+LEP_ASYNC_CMD_T_PTR LeptonSDKEmb32OEM::AsyncAdvance(LEP_RESULT xferResult)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_ASYNC_CMD_T_PTR cmdPtr = asyncQueue[asyncHead];
+    LEP_RESULT result = xferResult;
+    LEP_INT16 statusCode;
+    LEP_BOOL complete = LEP_FALSE;
 
+    if( result != LEP_OK )
+    {
+        complete = LEP_TRUE;
+    }
+    else
+    {
+        switch( asyncState )
+        {
+            case ASYNC_WAIT_READY:
+                if( asyncXferWord & LEP_I2C_STATUS_BUSY_BIT_MASK )
+                {
+                    /* Timed out waiting for command busy to go away
+                    */ 
+                    if( (cmdPtr->type == LEP_ASYNC_SET_ATTRIBUTE) && (asyncTimeoutCount-- == 0) )
+                    {
+                        result = LEP_TIMEOUT_ERROR;
+                        complete = LEP_TRUE;
+                    }
+                    break;
+                }
+                if( (cmdPtr->type == LEP_ASYNC_SET_ATTRIBUTE) && (cmdPtr->attributeWordLength > 0) )
+                {
+                    /* WRITE the DATA to the DATA Registers (always start from
+                    ** DATA 0) or the DATA Block Buffer
+                    */ 
+                    asyncState = ASYNC_WRITE_DATA;
+                    AsyncSetTransfer(LEP_TRUE,
+                                     (cmdPtr->attributeWordLength <= 16) ? LEP_I2C_DATA_0_REG : LEP_I2C_DATA_BUFFER_0,
+                                     cmdPtr->attributePtr,
+                                     cmdPtr->attributeWordLength);
+                    break;
+                }
+                /* No data to write - fall through */
 
-   /* Perform Command
-   ** Writing the Camera's AGC HEQ Histogram Dampening Factor
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_DAMPENING_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcHeqDampingFactor,
-                              attributeWordLength
-                              );
-   return( result );
-}
+            case ASYNC_WRITE_DATA:
+                /* Set the Lepton's DATA LENGTH REGISTER to inform the
+                ** Lepton Camera how many 16-bit DATA words are transferred.
+                */ 
+                asyncXferWord = cmdPtr->attributeWordLength;
+                asyncState = ASYNC_WRITE_LENGTH;
+                AsyncSetTransfer(LEP_TRUE, LEP_I2C_DATA_LENGTH_REG, &asyncXferWord, 1);
+                break;
 
+            case ASYNC_WRITE_LENGTH:
+                /* Now issue the Command
+                */ 
+                asyncXferWord = cmdPtr->commandID;
+                asyncState = ASYNC_WRITE_COMMAND;
+                AsyncSetTransfer(LEP_TRUE, LEP_I2C_COMMAND_REG, &asyncXferWord, 1);
+                break;
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqMaxGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_UINT16 *agcHeqMaxGainPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+            case ASYNC_WRITE_COMMAND:
+                /* Now wait until the Camera has completed this command by
+                ** polling the STATUS REGISTER BUSY Bit until it reports NOT
+                ** BUSY.
+                */ 
+                asyncState = ASYNC_WAIT_DONE;
+                AsyncSetTransfer(LEP_FALSE, LEP_I2C_STATUS_REG, &asyncXferWord, 1);
+                break;
 
-   /* Validate Parameter(s)
-   */
-   if( agcHeqMaxGainPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+            case ASYNC_WAIT_DONE:
+                if( asyncXferWord & LEP_I2C_STATUS_BUSY_BIT_MASK )
+                {
+                    break;
+                }
 
-   /* Perform Command
-   ** Reading the Camera's AGC HEQ Max Gain
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_MAX_GAIN,
-                              ( LEP_ATTRIBUTE_T_PTR )agcHeqMaxGainPtr,
-                              attributeWordLength );
-   return( result );
-}
+                /* Check status word for Errors?
+                */ 
+                statusCode = (asyncXferWord >> 8) ? ((asyncXferWord >> 8) | 0xFF00) : 0;
+                if( statusCode )
+                {
+                    result = (LEP_RESULT)statusCode;
+                    complete = LEP_TRUE;
+                }
+                else if( (cmdPtr->type == LEP_ASYNC_GET_ATTRIBUTE) && (cmdPtr->attributeWordLength > 0) )
+                {
+                    /* If NO Errors then READ the DATA from the DATA
+                    ** Registers or the DATA Block Buffer
+                    */ 
+                    asyncState = ASYNC_READ_DATA;
+                    AsyncSetTransfer(LEP_FALSE,
+                                     (cmdPtr->attributeWordLength <= 16) ? LEP_I2C_DATA_0_REG : LEP_I2C_DATA_BUFFER_0,
+                                     cmdPtr->attributePtr,
+                                     cmdPtr->attributeWordLength);
+                }
+                else
+                {
+                    complete = LEP_TRUE;
+                }
+                break;
 
+            case ASYNC_READ_DATA:
+            default:
+                complete = LEP_TRUE;
+                break;
+        }
+    }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqMaxGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_UINT16 agcHeqMaxGain )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    if( !complete )
+    {
+        return(NULL);
+    }
 
+    /* Remove the command and start the next one
+    */
+    cmdPtr->result = result;
+    asyncHead = (asyncHead + 1) % LEP_ASYNC_QUEUE_LENGTH;
+    asyncCount--;
+    if( asyncCount == 0 )
+    {
+        asyncState = ASYNC_IDLE;
+    }
+    else
+    {
+        AsyncStart();
+    }
 
-   /* Perform Command
-   ** Writing the Camera's AGC HEQ Max Gain
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_MAX_GAIN,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcHeqMaxGain,
-                              attributeWordLength
-                              );
-   return( result );
+    return(cmdPtr);
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqClipLimitHigh( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_UINT16 *agcHeqClipLimitHighPtr )
+/* Notifies the owner of a completed command.  Called after the next command's
+** transfer has been issued so the callback may queue another command.
+*/
+void LeptonSDKEmb32OEM::AsyncFinish(LEP_ASYNC_CMD_T_PTR cmdPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   /* Validate Parameter(s)
-   */
-   if( agcHeqClipLimitHighPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    if( cmdPtr->callback != NULL )
+    {
+        cmdPtr->callback(cmdPtr->result, cmdPtr->callbackArg);
+    }
+    cmdPtr->done = LEP_TRUE;
+}
 
-   /* Perform Command
-   ** Reading the Camera's AGC HEQ Clip Limit High
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_CLIP_LIMIT_HIGH,
-                              ( LEP_ATTRIBUTE_T_PTR )agcHeqClipLimitHighPtr,
-                              attributeWordLength );
 
-   return( result );
+/* Swap the big-endian words read from the Lepton in place
+*/
+static void SwapWords(LEP_UINT16 *dataPtr, LEP_UINT16 words)
+{
+#ifndef _BIG_ENDIAN
+   while (words--) {
+      *dataPtr = (*dataPtr >> 8) | (*dataPtr << 8);
+      dataPtr++;
+   }
+#endif
 }
 
+#if defined(LEP_I2C_T3)
+/* i2c_t3 callbacks only get a function so the engine is run for the instance
+** that initialized the port.
+*/
+static LeptonSDKEmb32OEM *asyncInstance = NULL;
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqClipLimitHigh( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_UINT16 agcHeqClipLimitHigh )
+/* Starts the current transfer without blocking.  A read is the register
+** address write followed by a request for the data.
+*/
+void LeptonSDKEmb32OEM::AsyncIssue(void)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_UINT16 *dataPtr = asyncXferPtr + asyncXferOffset;
+    LEP_UINT16 regAddress = asyncXferReg + (asyncXferOffset << 1);
+    LEP_UINT16 words = asyncXferWords - asyncXferOffset;
 
-
-   /* Perform Command
-   ** Writing the Camera's AGC HEQ Clip Limit High
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_CLIP_LIMIT_HIGH,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcHeqClipLimitHigh,
-                              attributeWordLength
-                              );
-   return( result );
+    /* Large data blocks are transferred in chunks that fit the i2c_t3 buffers
+    */
+    if( words > LEP_I2C_CHUNK_WORDS )
+    {
+        words = LEP_I2C_CHUNK_WORDS;
+    }
+    asyncXferChunk = words;
+
+    asyncInstance = this;
+    asyncXferAddrPhase = LEP_TRUE;
+    Wire.beginTransmission(asyncQueue[asyncHead]->portDescPtr->deviceAddress);
+    Wire.write(regAddress >> 8);
+    Wire.write(regAddress & 0xFF);
+    if( asyncXferWrite )
+    {
+        while( words-- )
+        {
+            Wire.write(*dataPtr >> 8);
+            Wire.write(*dataPtr & 0xFF);
+            dataPtr++;
+        }
+    }
+    Wire.sendTransmission(I2C_STOP);
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqClipLimitLow( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_UINT16 *agcHeqClipLimitLowPtr )
+void LeptonSDKEmb32OEM::AsyncTransmitDone(void)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LeptonSDKEmb32OEM *lep = asyncInstance;
+    LEP_ASYNC_CMD_T_PTR cmdPtr;
 
-   /* Validate Parameter(s)
-   */
-   if( agcHeqClipLimitLowPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    /* Ignore blocking transfers by other code
+    */
+    if( lep == NULL || lep->asyncState == ASYNC_IDLE )
+    {
+        return;
+    }
 
-   /* Perform Command
-   ** Reading the Camera's AGC HEQ Clip Limit Low
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_CLIP_LIMIT_LOW,
-                              ( LEP_ATTRIBUTE_T_PTR )agcHeqClipLimitLowPtr,
-                              attributeWordLength );
-   return( result );
+    if( !lep->asyncXferWrite && lep->asyncXferAddrPhase )
+    {
+        lep->asyncXferAddrPhase = LEP_FALSE;
+        Wire.sendRequest(lep->asyncQueue[lep->asyncHead]->portDescPtr->deviceAddress,
+                         lep->asyncXferChunk << 1, I2C_STOP);
+        return;
+    }
+
+    lep->asyncXferOffset += lep->asyncXferChunk;
+    if( lep->asyncXferOffset < lep->asyncXferWords )
+    {
+        lep->AsyncIssue();
+        return;
+    }
+
+    cmdPtr = lep->AsyncAdvance(LEP_OK);
+    if( lep->asyncState != ASYNC_IDLE )
+    {
+        lep->AsyncIssue();
+    }
+    if( cmdPtr != NULL )
+    {
+        lep->AsyncFinish(cmdPtr);
+    }
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqClipLimitLow( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_UINT16 agcHeqClipLimitLow )
+void LeptonSDKEmb32OEM::AsyncRequestDone(void)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LeptonSDKEmb32OEM *lep = asyncInstance;
+    LEP_ASYNC_CMD_T_PTR cmdPtr;
+    LEP_UINT16 *writePtr;
+    LEP_UINT16 words;
+
+    if( lep == NULL || lep->asyncState == ASYNC_IDLE || lep->asyncXferAddrPhase )
+    {
+        return;
+    }
 
+    writePtr = lep->asyncXferPtr + lep->asyncXferOffset;
+    words = Wire.read((uint8_t*) writePtr, lep->asyncXferChunk << 1) >> 1;
+    SwapWords(writePtr, words);
 
-   /* Perform Command
-   ** Writing the Camera's AGC HEQ Clip Limit Low
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_CLIP_LIMIT_LOW,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcHeqClipLimitLow,
-                              attributeWordLength
-                              );
-   return( result );
+    lep->asyncXferOffset += lep->asyncXferChunk;
+    if( (words == lep->asyncXferChunk) && (lep->asyncXferOffset < lep->asyncXferWords) )
+    {
+        lep->AsyncIssue();
+        return;
+    }
+
+    cmdPtr = lep->AsyncAdvance(LEP_OK);
+    if( lep->asyncState != ASYNC_IDLE )
+    {
+        lep->AsyncIssue();
+    }
+    if( cmdPtr != NULL )
+    {
+        lep->AsyncFinish(cmdPtr);
+    }
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqBinExtension( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_UINT16 *agcHeqBinExtensionPtr )
+void LeptonSDKEmb32OEM::AsyncError(void)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LeptonSDKEmb32OEM *lep = asyncInstance;
+    LEP_ASYNC_CMD_T_PTR cmdPtr;
 
-   /* Validate Parameter(s)
-   */
-   if( agcHeqBinExtensionPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    if( lep == NULL || lep->asyncState == ASYNC_IDLE )
+    {
+        return;
+    }
 
-   /* Perform Command
-   ** Reading the Camera's AGC HEQ Bin Extension
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_BIN_EXTENSION,
-                              ( LEP_ATTRIBUTE_T_PTR )agcHeqBinExtensionPtr,
-                              attributeWordLength );
-   return( result );
+    cmdPtr = lep->AsyncAdvance(LEP_ERROR);
+    if( lep->asyncState != ASYNC_IDLE )
+    {
+        lep->AsyncIssue();
+    }
+    if( cmdPtr != NULL )
+    {
+        lep->AsyncFinish(cmdPtr);
+    }
 }
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqBinExtension( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_UINT16 agcHeqBinExtension )
+#else
+/* Runs the queued commands to completion with blocking transfers
+*/
+void LeptonSDKEmb32OEM::AsyncRun(void)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+    LEP_ASYNC_CMD_T_PTR cmdPtr;
+    LEP_UINT16 portID;
+    LEP_UINT8 deviceAddress;
+    LEP_UINT16 words;
+    LEP_UINT16 status;
+    LEP_RESULT result;
 
+    while( asyncState != ASYNC_IDLE )
+    {
+        portID = asyncQueue[asyncHead]->portDescPtr->portID;
+        deviceAddress = asyncQueue[asyncHead]->portDescPtr->deviceAddress;
+        if( asyncXferWrite )
+        {
+            result = DEV_I2C_MasterWriteData(portID, deviceAddress, asyncXferReg,
+                                             asyncXferPtr, asyncXferWords, &words, &status);
+        }
+        else
+        {
+            result = DEV_I2C_MasterReadData(portID, deviceAddress, asyncXferReg,
+                                            asyncXferPtr, asyncXferWords, &words, &status);
+        }
 
-   /* Perform Command
-   ** Writing the Camera's AGC HEQ Bin Extension
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_BIN_EXTENSION,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcHeqBinExtension,
-                              attributeWordLength
-                              );
-   return( result );
+        cmdPtr = AsyncAdvance(result);
+        if( cmdPtr != NULL )
+        {
+            AsyncFinish(cmdPtr);
+        }
+    }
 }
+#endif
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqMidPoint( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_UINT16 *agcHeqMidPointPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_DirectReadRegister(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                      LEP_UINT16 regAddress,
+                                      LEP_UINT16 *regValue)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
+   LEP_RESULT result = LEP_OK;
 
-   /* Validate Parameter(s)
-   */
-   if( agcHeqMidPointPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Reading the Camera's AGC HEQ Midpoint
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_MIDPOINT,
-                              ( LEP_ATTRIBUTE_T_PTR )agcHeqMidPointPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqMidPoint( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_UINT16 agcHeqMidPoint )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-
-   /* Perform Command
-   ** Writing the Camera's AGC HEQ Midpoint
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_MIDPOINT,
-                              ( LEP_ATTRIBUTE_T_PTR ) & agcHeqMidPoint,
-                              attributeWordLength
-                              );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqEmptyCount( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_AGC_HEQ_EMPTY_COUNT_T_PTR emptyCountPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_EMPTY_COUNTS,
-                              ( LEP_ATTRIBUTE_T_PTR )emptyCountPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqEmptyCount( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_AGC_HEQ_EMPTY_COUNT_T emptyCount )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_EMPTY_COUNTS,
-                              ( LEP_ATTRIBUTE_T_PTR ) & emptyCount,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqNormalizationFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_AGC_HEQ_NORMALIZATION_FACTOR_T_PTR normalizationFactorPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_NORMALIZATION_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR )normalizationFactorPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqNormalizationFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_AGC_HEQ_NORMALIZATION_FACTOR_T normalizationFactor )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_NORMALIZATION_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR ) & normalizationFactor,
-                              attributeWordLength );
+   result = LEP_I2C_MasterReadRegister( portDescPtr->portID,
+                                        portDescPtr->deviceAddress,
+                                        regAddress,
+                                        regValue);
 
-   return( result );
+   return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_AGC_HEQ_SCALE_FACTOR_E_PTR scaleFactorPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_SCALE_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR )scaleFactorPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_AGC_HEQ_SCALE_FACTOR_E scaleFactor )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_GetPortStatus(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
 {
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) scaleFactor;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_SCALE_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
+    LEP_RESULT result = LEP_OK;
 
-   return( result );
+    return(result);
 }
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcCalcEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_AGC_ENABLE_E_PTR agcCalculationEnableStatePtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_GetDeviceAddress(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                    LEP_UINT8* deviceAddress)
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
 
-   if( agcCalculationEnableStatePtr == NULL )
+   if(deviceAddress == NULL)
    {
-      return( LEP_BAD_ARG_POINTER_ERROR );
+      return(LEP_BAD_ARG_POINTER_ERROR);
    }
+   *deviceAddress = portDescPtr->deviceAddress;
 
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_CALC_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR )agcCalculationEnableStatePtr,
-                              attributeWordLength );
-
-   return( result );
+   return(result);
 }
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcCalcEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_AGC_ENABLE_E agcCalculationEnableState )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) agcCalculationEnableState;
-
-   if( agcCalculationEnableState >= LEP_END_AGC_ENABLE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_CALC_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
 
-   return( result );
-}
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAgcHeqLinearPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_UINT16 *agcHeqLinearPercentPtr)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_DirectWriteBuffer(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                     LEP_ATTRIBUTE_T_PTR attributePtr,
+                                     LEP_UINT16 attributeWordLength)
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;
 
-   if( agcHeqLinearPercentPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+   /* WRITE to the DATA Block Buffer
+   */     
+   result = LEP_I2C_MasterWriteData(portDescPtr->portID,
+                                    portDescPtr->deviceAddress,
+                                    LEP_I2C_DATA_BUFFER_0,
+                                    attributePtr,
+                                    attributeWordLength );
 
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_LINEAR_PERCENT,
-                              ( LEP_ATTRIBUTE_T_PTR )agcHeqLinearPercentPtr,
-                              attributeWordLength );
+  
 
    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAgcHeqLinearPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_UINT16 agcHeqLinearPercent)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_DirectWriteRegister(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                       LEP_UINT16 regAddress,
+                                       LEP_UINT16 regValue)
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_AGC_HEQ_LINEAR_PERCENT,
-                              ( LEP_ATTRIBUTE_T_PTR )&agcHeqLinearPercent,
-                              attributeWordLength );
 
+   result = LEP_I2C_MasterWriteRegister(portDescPtr->portID,
+                                        portDescPtr->deviceAddress,
+                                        regAddress, 
+                                        regValue);
    return(result);
 }
 
 
 /**************************************/
-/*           I2C_Protocol             */
+/*            I2C_Service             */
 /**************************************/
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_SelectDevice(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr, 
-                                LEP_PROTOCOL_DEVICE_E device)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterSelectDevice(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr, 
+                                      LEP_PROTOCOL_DEVICE_E device)
 {
-    LEP_RESULT result;
+    LEP_RESULT result = LEP_OK;
 
-    result = LEP_I2C_MasterSelectDevice( portDescPtr, device );
+    /* Do any device-specific calls to implement a close operation
+    */ 
+#ifdef IMPLEMENTS_SELECT_DEVICE
+	result = DEV_I2C_MasterSelectDevice(device);
+#else
+    result = LEP_UNDEFINED_FUNCTION_ERROR;
+#endif
 
     return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_OpenPort(LEP_UINT16 portID,
-                            LEP_UINT16 *baudRateInkHz,
-                            LEP_UINT8* deviceAddress)
+/* Driver Open
+*/ 
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterOpen(LEP_UINT16 portID, 
+                              LEP_UINT16 *portBaudRate)
 {
-   LEP_RESULT result;
-   LEP_UINT16 statusReg;
+    LEP_RESULT result;
 
-   result = LEP_I2C_MasterOpen( portID, baudRateInkHz );
+    /* Call the I2C Device-Specific Driver to open device as a
+    ** Master
+    */ 
+    result = DEV_I2C_MasterInit( portID, portBaudRate );
 
-   if(result != LEP_OK)
-   {
-      return(LEP_COMM_INVALID_PORT_ERROR);
-   }
+    return(result);
+}
 
-   *deviceAddress = 0x2a;
-   result = LEP_I2C_MasterReadData( portID,
-                                *deviceAddress,
-                                LEP_I2C_STATUS_REG,
-                                &statusReg,
-                                1 );
-   
-   if(result != LEP_OK)
-   {
-      /*
-       *    Try 0x00 as the device address if 0x2a didn't work. In this case, we are in Virgin Boot Mode.
-       *
-       */
-      *deviceAddress = 0x00;
-      result = LEP_I2C_MasterReadData( portID,
-                                   *deviceAddress,
-                                   LEP_I2C_STATUS_REG,
-                                   &statusReg,
-                                   1 );
-      if(result != LEP_OK)
-      {
-         return(LEP_COMM_NO_DEV);
-      }
-   }
+/* Driver Close
+*/ 
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterClose(LEP_CAMERA_PORT_DESC_T_PTR portDescriptorPtr)
+{
+    LEP_RESULT result = LEP_OK;
 
+    /* Do any device-specific calls to implement a close operation
+    */ 
+	result = DEV_I2C_MasterClose();
     return(result);
 }
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_ClosePort(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
+/* Driver Reset
+*/ 
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterReset(LEP_CAMERA_PORT_DESC_T_PTR portDescriptorPtr )
 {
-    LEP_RESULT result;
-
-    result =LEP_I2C_MasterClose( portDescPtr );
+    LEP_RESULT result = LEP_OK;
 
     return(result);
 }
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_ResetPort(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
+/**
+ * Driver Read
+ *    Use Lepton I2C protocol for READ starting from current
+ *      location
+ * 
+ * @param portID        User-defined parameter to identify one of multiple ports
+ * 
+ * @param deviceAddress This is the Lepton TWI/CCI (I2C) device address.
+ * 
+ * @param subAddress    Specifies the Lepton Register Address to write to
+ * 
+ * @param dataPtr       Pointer to the DATA buffer that is filled by this command
+ * 
+ * @param dataLength    Number of 16-bit words to read.
+ * 
+ * @return 
+ */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterReadData(LEP_UINT16 portID,
+                                  LEP_UINT8  deviceAddress, 
+                                  LEP_UINT16 subAddress, 
+                                  LEP_UINT16 *dataPtr,
+                                  LEP_UINT16 dataLength)
 {
-    LEP_RESULT result;
+    LEP_RESULT result = LEP_OK;
+    LEP_UINT16 transactionStatus;
+    LEP_UINT16 numWordsRead;
 
-    result = LEP_I2C_MasterReset( portDescPtr );
+    result = DEV_I2C_MasterReadData(portID,
+                                    deviceAddress,
+                                    subAddress,
+                                    dataPtr,
+                                    dataLength,
+                                    &numWordsRead,
+                                    &transactionStatus
+                                   );
 
     return(result);
 }
 
+/**
+ * Driver Write
+ * 
+ * @param portID     User-defined parameter to identify one of multiple ports
+ * 
+ * @param subAddress Specifies the Lepton Register Address to write to
+ * 
+ * @param dataPtr    Pointer to a DATA buffer to source the transfers
+ * 
+ * @param dataLength Specifies the number of 16-bit words to write from the bufffer
+ * 
+ * @return LEP_RESULT   LEP_OK if all goes well; otherwise a Lepton error code.
+ */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterWriteData(LEP_UINT16 portID,
+                                   LEP_UINT8  deviceAddress, 
+                                   LEP_UINT16 subAddress, 
+                                   LEP_UINT16 *dataPtr,
+                                   LEP_UINT16 dataLength)
+{
+    LEP_RESULT result = LEP_OK;
+    LEP_UINT16 transactionStatus;
+    LEP_UINT16 numWordsWritten;
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_GetAttribute(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_COMMAND_ID commandID, 
-                                LEP_ATTRIBUTE_T_PTR attributePtr,
-                                LEP_UINT16 attributeWordLength)
-{
-    LEP_RESULT result;
-    LEP_UINT16 statusReg;
-    LEP_INT16 statusCode;
-    LEP_UINT32 done;
-    LEP_UINT16 crcExpected, crcActual;
-
-    /* Implement the Lepton TWI READ Protocol
-    */
-    /* First wait until the Camera is ready to receive a new
-    ** command by polling the STATUS REGISTER BUSY Bit until it
-    ** reports NOT BUSY.
-    */ 
-
-    do
-    {
-        /* Read the Status REGISTER and peek at the BUSY Bit
-        */ 
-        result = LEP_I2C_MasterReadData( portDescPtr->portID,
-                                         portDescPtr->deviceAddress,
-                                         LEP_I2C_STATUS_REG,
-                                         &statusReg,
-                                         1 );
-        if(result != LEP_OK)
-        {
-           return(result);
-        }
-        done = (statusReg & LEP_I2C_STATUS_BUSY_BIT_MASK)? 0: 1;
-
-    }while( !done );
-
-    /* Set the Lepton's DATA LENGTH REGISTER first to inform the
-    ** Lepton Camera how many 16-bit DATA words we want to read.
-    */ 
-    result = LEP_I2C_MasterWriteData( portDescPtr->portID,
-                                      portDescPtr->deviceAddress,
-                                      LEP_I2C_DATA_LENGTH_REG, 
-                                      &attributeWordLength, 
-                                      1);
-    if(result != LEP_OK)
-    {
-       return(result);
-    }
-    /* Now issue the GET Attribute Command
-    */ 
-    result = LEP_I2C_MasterWriteData( portDescPtr->portID,
-                                      portDescPtr->deviceAddress,
-                                      LEP_I2C_COMMAND_REG, 
-                                      &commandID, 
-                                      1);
-
-    if(result != LEP_OK)
-    {
-       return(result);
-    }
-
-    /* Now wait until the Camera has completed this command by
-    ** polling the statusReg REGISTER BUSY Bit until it reports NOT
-    ** BUSY.
-    */ 
-    do
-    {
-        /* Read the statusReg REGISTER and peek at the BUSY Bit
-        */ 
-        result = LEP_I2C_MasterReadData( portDescPtr->portID,
-                                         portDescPtr->deviceAddress,
-                                         LEP_I2C_STATUS_REG,
-                                         &statusReg,
-                                         1 );
-
-        if(result != LEP_OK)
-        {
-           return(result);
-        }
-        done = (statusReg & LEP_I2C_STATUS_BUSY_BIT_MASK)? 0: 1;
-
-    }while( !done );
-    
-
-    /* Check statusReg word for Errors?
-    */ 
-    statusCode = (statusReg >> 8) ? ((statusReg >> 8) | 0xFF00) : 0;
-    if(statusCode)
-    {
-      return((LEP_RESULT)statusCode);
-    }
-
-    /* If NO Errors then READ the DATA from the DATA REGISTER(s)
-    */ 
-    if( attributeWordLength <= 16 )
-    {
-        /* Read from the DATA Registers - always start from DATA 0
-        ** Little Endean
-        */ 
-        result = LEP_I2C_MasterReadData(portDescPtr->portID,
-                                        portDescPtr->deviceAddress,
-                                        LEP_I2C_DATA_0_REG,
-                                        attributePtr,
-                                        attributeWordLength );
-    }
-    else if( attributeWordLength <= 1024 )
-    {
-        /* Read from the DATA Block Buffer
-        */ 
-      result = LEP_I2C_MasterReadData(portDescPtr->portID,
-                                      portDescPtr->deviceAddress,
-                                      LEP_I2C_DATA_BUFFER_0,
-                                      attributePtr,
-                                      attributeWordLength );
-    }
-
-//    if(result == LEP_OK && attributeWordLength > 0)
-//    {
-//       /* Check CRC */
-//       result = LEP_I2C_MasterReadData( portDescPtr->portID,
-//                                        portDescPtr->deviceAddress,
-//                                        LEP_I2C_DATA_CRC_REG,
-//                                        &crcExpected,
-//                                        1);
-//       crcActual = (LEP_UINT16)CalcCRC16Words(attributeWordLength, (short*)attributePtr);
-//
-//       /* Check for 0 in the register in case the camera does not support CRC check
-//       */
-//       if(crcExpected != 0 && crcExpected != crcActual)
-//       {
-//          return(LEP_CHECKSUM_ERROR);
-//       }
-//       
-//    }
-
+    result = DEV_I2C_MasterWriteData(portID,
+                                     deviceAddress,
+                                     subAddress,
+                                     dataPtr,
+                                     dataLength,
+                                     &numWordsWritten,
+                                     &transactionStatus
+                                    );
     return(result);
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_SetAttribute(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_COMMAND_ID commandID, 
-                                LEP_ATTRIBUTE_T_PTR attributePtr,
-                                LEP_UINT16 attributeWordLength)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterReadRegister(LEP_UINT16 portID,
+                                      LEP_UINT8  deviceAddress, 
+                                      LEP_UINT16 regAddress,
+                                      LEP_UINT16 *regValue)
 {
-    LEP_RESULT result;
-    LEP_UINT16 statusReg;
-    LEP_INT16 statusCode;
-    LEP_UINT32 done;
-    LEP_UINT16 timeoutCount = LEPTON_I2C_COMMAND_BUSY_WAIT_COUNT;
-
-    /* Implement the Lepton TWI WRITE Protocol
-    */
-    /* First wait until the Camera is ready to receive a new
-    ** command by polling the STATUS REGISTER BUSY Bit until it
-    ** reports NOT BUSY.
-    */ 
-    do
-    {
-        /* Read the Status REGISTER and peek at the BUSY Bit
-        */ 
-        result = LEP_I2C_MasterReadData( portDescPtr->portID,
-                                         portDescPtr->deviceAddress,
-                                         LEP_I2C_STATUS_REG,
-                                         &statusReg,
-                                         1 );
-        if(result != LEP_OK)
-        {
-           return(result);
-        }
-        done = (statusReg & LEP_I2C_STATUS_BUSY_BIT_MASK)? 0: 1;
-        /* Add timout check */
-        if( timeoutCount-- == 0 )
-        {
-            /* Timed out waiting for command busy to go away
-            */ 
-          return(LEP_TIMEOUT_ERROR);
-
-        }
-    }while( !done );
-
-    if( result == LEP_OK )
-    {
-        /* Now WRITE the DATA to the DATA REGISTER(s)
-        */ 
-        if( attributeWordLength <= 16 )
-        {
-            /* WRITE to the DATA Registers - always start from DATA 0
-            */ 
-            result = LEP_I2C_MasterWriteData(portDescPtr->portID,
-                                             portDescPtr->deviceAddress,
-                                             LEP_I2C_DATA_0_REG,
-                                             attributePtr,
-                                             attributeWordLength );
-        }
-        else if( attributeWordLength <= 1024 )
-        {
-            /* WRITE to the DATA Block Buffer
-            */     
-            result = LEP_I2C_MasterWriteData(portDescPtr->portID,
-                                             portDescPtr->deviceAddress,
-                                             LEP_I2C_DATA_BUFFER_0,
-                                             attributePtr,
-                                             attributeWordLength );
-
-        }
-        else
-            result = LEP_RANGE_ERROR;
-    }
-
-    if( result == LEP_OK )
-    {
-        /* Set the Lepton's DATA LENGTH REGISTER first to inform the
-        ** Lepton Camera how many 16-bit DATA words we want to read.
-        */ 
-        result = LEP_I2C_MasterWriteData( portDescPtr->portID,
-                                          portDescPtr->deviceAddress,
-                                          LEP_I2C_DATA_LENGTH_REG, 
-                                          &attributeWordLength, 
-                                          1);
-
-        if( result == LEP_OK )
-        {
-            /* Now issue the SET Attribute Command
-            */ 
-            result = LEP_I2C_MasterWriteData( portDescPtr->portID,
-                                              portDescPtr->deviceAddress,
-                                              LEP_I2C_COMMAND_REG, 
-                                              &commandID, 
-                                              1);
-			
-            if( result == LEP_OK )
-            {
-                /* Now wait until the Camera has completed this command by
-                ** polling the statusReg REGISTER BUSY Bit until it reports NOT
-                ** BUSY.
-                */ 
-                do
-                {
-                    /* Read the statusReg REGISTER and peek at the BUSY Bit
-                    */ 
-                    result = LEP_I2C_MasterReadData( portDescPtr->portID,
-                                                     portDescPtr->deviceAddress,
-                                                     LEP_I2C_STATUS_REG,
-                                                     &statusReg,
-                                                     1 );
-                    if(result != LEP_OK)
-                    {
-                       return(result);
-                    }
-                    done = (statusReg & LEP_I2C_STATUS_BUSY_BIT_MASK)? 0: 1;
-
-                }while( !done );
-
-                    /* Check statusReg word for Errors?
-                   */ 
-                   statusCode = (statusReg >> 8) ? ((statusReg >> 8) | 0xFF00) : 0;
-                   if(statusCode)
-                   {
-                     return((LEP_RESULT)statusCode);
-                   }
-
-            }
-        }
-    }
-
-    /* Check statusReg word for Errors?
-    */
+    LEP_RESULT result = LEP_OK;
+    LEP_UINT16 transactionStatus;
 
+    result = DEV_I2C_MasterReadRegister(portID,
+                                        deviceAddress,
+                                        regAddress,
+                                        regValue,
+                                        &transactionStatus
+                                       );
     return(result);
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_RunCommand(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_COMMAND_ID commandID)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterWriteRegister(LEP_UINT16 portID,
+                                       LEP_UINT8  deviceAddress, 
+                                       LEP_UINT16 regAddress,
+                                       LEP_UINT16 regValue)
 {
-    LEP_RESULT result;
-    LEP_UINT16 statusReg;
-    LEP_INT16 statusCode;
-    LEP_UINT32 done;
-    LEP_UINT16 timeoutCount = LEPTON_I2C_COMMAND_BUSY_WAIT_COUNT;
-
-    /* Implement the Lepton TWI WRITE Protocol
-    */
-    /* First wait until the Camera is ready to receive a new
-    ** command by polling the STATUS REGISTER BUSY Bit until it
-    ** reports NOT BUSY.
-    */ 
-    do
-    {
-        /* Read the Status REGISTER and peek at the BUSY Bit
-        */ 
-        result = LEP_I2C_MasterReadRegister( portDescPtr->portID,
-                                             portDescPtr->deviceAddress,
-                                             LEP_I2C_STATUS_REG,
-                                             &statusReg);
-        if(result != LEP_OK)
-        {
-            return(result);
-        }
-        done = (statusReg & LEP_I2C_STATUS_BUSY_BIT_MASK)? 0: 1;
-        /* Add timout check */
-        if( timeoutCount-- == 0 )
-        {
-            /* Timed out waiting for command busy to go away
-            */ 
-
-        }
-    }while( !done );
-
-    if( result == LEP_OK )
-    {
-        /* Set the Lepton's DATA LENGTH REGISTER first to inform the
-        ** Lepton Camera no 16-bit DATA words being transferred.
-        */ 
-        result = LEP_I2C_MasterWriteRegister( portDescPtr->portID,
-                                              portDescPtr->deviceAddress,
-                                              LEP_I2C_DATA_LENGTH_REG, 
-                                              (LEP_UINT16)0);
-
-        if( result == LEP_OK )
-        {
-            /* Now issue the Run Command
-            */ 
-            result = LEP_I2C_MasterWriteRegister( portDescPtr->portID,
-                                                  portDescPtr->deviceAddress,
-                                                  LEP_I2C_COMMAND_REG, 
-                                                  commandID);
-            if( result == LEP_OK )
-            {
-                /* Now wait until the Camera has completed this command by
-                ** polling the statusReg REGISTER BUSY Bit until it reports NOT
-                ** BUSY.
-                */ 
-                do
-                {
-                    /* Read the statusReg REGISTER and peek at the BUSY Bit
-                    */ 
-                    result = LEP_I2C_MasterReadRegister( portDescPtr->portID,
-                                                         portDescPtr->deviceAddress,
-                                                         LEP_I2C_STATUS_REG,
-                                                         &statusReg);
-                    if(result != LEP_OK)
-                    {
-                        return(result);
-                    }
-                    done = (statusReg & LEP_I2C_STATUS_BUSY_BIT_MASK)? 0: 1;
-                    /* Timeout? */
-
-                }while( !done );
-
-                statusCode = (statusReg >> 8) ? ((statusReg >> 8) | 0xFF00) : 0;
-                if(statusCode)
-                {
-                  return((LEP_RESULT)statusCode);
-                }
-            }
-        }
-    }
-
-    /* Check statusReg word for Errors?
-    */
+    LEP_RESULT result = LEP_OK;
+    LEP_UINT16 transactionStatus;
 
-    
+    result = DEV_I2C_MasterWriteRegister(portID,
+                                         deviceAddress,
+                                         regAddress,
+                                         regValue,
+                                         &transactionStatus
+                                        );
     return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_DirectReadRegister(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_UINT16 regAddress,
-                                      LEP_UINT16 *regValue)
-{
-   LEP_RESULT result = LEP_OK;
-
-   result = LEP_I2C_MasterReadRegister( portDescPtr->portID,
-                                        portDescPtr->deviceAddress,
-                                        regAddress,
-                                        regValue);
-
-   return(result);
-}
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_GetPortStatus(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
+/* Driver Status
+*/ 
+LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterStatus(LEP_UINT16 portID,
+                                LEP_UINT16 *portStatus )
 {
     LEP_RESULT result = LEP_OK;
 
     return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_GetDeviceAddress(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_UINT8* deviceAddress)
+
+/**************************************/
+/*                OEM                 */
+/**************************************/
+/******************************************************************************/
+LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemPowerOn( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
 {
    LEP_RESULT result = LEP_OK;
 
-   if(deviceAddress == NULL)
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
-   *deviceAddress = portDescPtr->deviceAddress;
+   result = LEP_DirectWriteRegister( portDescPtr, 0x0, 0x0 );
 
-   return(result);
+   return( result );
 }
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_DirectWriteBuffer(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_ATTRIBUTE_T_PTR attributePtr,
-                                     LEP_UINT16 attributeWordLength)
+/**
+ * Places the Camera into the Stand By condition.
+ * 
+ * @param portDescPtr
+ * 
+ * @return 
+ */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemStandby( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
 {
-   LEP_RESULT result = LEP_OK;
+   LEP_RESULT  result = LEP_OK;
 
-   /* WRITE to the DATA Block Buffer
-   */     
-   result = LEP_I2C_MasterWriteData(portDescPtr->portID,
-                                    portDescPtr->deviceAddress,
-                                    LEP_I2C_DATA_BUFFER_0,
-                                    attributePtr,
-                                    attributeWordLength );
 
-  
+   //result= LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_OEM_STANDBY );
 
-   return(result);
+   return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_DirectWriteRegister(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_UINT16 regAddress,
-                                       LEP_UINT16 regValue)
+#if 0
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemMasterID( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                              LEP_OEM_MASTER_ID_T_PTR oemMasterIDPtr )
 {
-   LEP_RESULT result = LEP_OK;
+   LEP_RESULT  result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 48; /* 96 bytes  */
 
-   result = LEP_I2C_MasterWriteRegister(portDescPtr->portID,
-                                        portDescPtr->deviceAddress,
-                                        regAddress, 
-                                        regValue);
-   return(result);
-}
+   /* Validate Parameter(s)
+   */
+   if( oemMasterIDPtr == NULL )
+   {
+      return( LEP_BAD_ARG_POINTER_ERROR );
+   }
 
+   /* Perform Command
+   ** Reading the Camera's Chip Master ID
+   */
+   result = LEP_GetAttribute( portDescPtr,
+                             ( LEP_COMMAND_ID )LEP_CID_OEM_MASTER_ID,
+                             ( LEP_ATTRIBUTE_T_PTR )oemMasterIDPtr,
+                             attributeWordLength );
+   return( result );
+}
+#endif
 
-/**************************************/
-/*            I2C_Service             */
-/**************************************/
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterSelectDevice(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr, 
-                                      LEP_PROTOCOL_DEVICE_E device)
+#if USE_DEPRECATED_PART_NUMBER_INTERFACE
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemFlirPartNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                     LEP_OEM_PART_NUMBER_T_PTR oemPartNumberPtr )
 {
-    LEP_RESULT result = LEP_OK;
+   LEP_RESULT  result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 16; /* 32 bytes */
 
-    /* Do any device-specific calls to implement a close operation
-    */ 
-#ifdef IMPLEMENTS_SELECT_DEVICE
-	result = DEV_I2C_MasterSelectDevice(device);
-#else
-    result = LEP_UNDEFINED_FUNCTION_ERROR;
-#endif
+   /* Validate Parameter(s)
+   */
+   if( oemPartNumberPtr == NULL )
+   {
+      return( LEP_BAD_ARG_POINTER_ERROR );
+   }
 
-    return(result);
+   /* Perform Command
+   ** Reading the Camera's Part Number
+   */
+   result = LEP_GetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_FLIR_PART_NUMBER,
+                              ( LEP_ATTRIBUTE_T_PTR )oemPartNumberPtr,
+                              attributeWordLength );
+
+   return( result );
 }
 
-/* Driver Open
-*/ 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterOpen(LEP_UINT16 portID, 
-                              LEP_UINT16 *portBaudRate)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemCustPartNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                     LEP_OEM_PART_NUMBER_T_PTR oemPartNumberPtr )
 {
-    LEP_RESULT result;
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 16;   /* 32 bytes */
 
-    /* Call the I2C Device-Specific Driver to open device as a
-    ** Master
-    */ 
-    result = DEV_I2C_MasterInit( portID, portBaudRate );
+   if( oemPartNumberPtr == NULL )
+   {
+      return( LEP_BAD_ARG_POINTER_ERROR );
+   }
 
-    return(result);
-}
+   result = LEP_GetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_CUST_PART_NUMBER,
+                              ( LEP_ATTRIBUTE_T_PTR )oemPartNumberPtr,
+                              attributeWordLength );
 
-/* Driver Close
-*/ 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterClose(LEP_CAMERA_PORT_DESC_T_PTR portDescriptorPtr)
+   return( result );
+}
+#else
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemFlirPartNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                     LEP_OEM_PART_NUMBER_T_PTR oemPartNumberPtr )
 {
-    LEP_RESULT result = LEP_OK;
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 16; /* 32 bytes */
 
-    /* Do any device-specific calls to implement a close operation
-    */ 
-	result = DEV_I2C_MasterClose();
-    return(result);
-}
+   /* Validate Parameter(s)
+   */
+   if( oemPartNumberPtr == NULL )
+   {
+      return( LEP_BAD_ARG_POINTER_ERROR );
+   }
 
-/* Driver Reset
-*/ 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterReset(LEP_CAMERA_PORT_DESC_T_PTR portDescriptorPtr )
-{
-    LEP_RESULT result = LEP_OK;
+   /* Perform Command
+   ** Reading the Camera's Part Number
+   */
+   result = LEP_GetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_FLIR_PART_NUMBER,
+                              ( LEP_ATTRIBUTE_T_PTR )oemPartNumberPtr,
+                              attributeWordLength );
 
-    return(result);
+   return( result );
 }
-
-/**
- * Driver Read
- *    Use Lepton I2C protocol for READ starting from current
- *      location
- * 
- * @param portID        User-defined parameter to identify one of multiple ports
- * 
- * @param deviceAddress This is the Lepton TWI/CCI (I2C) device address.
- * 
- * @param subAddress    Specifies the Lepton Register Address to write to
- * 
- * @param dataPtr       Pointer to the DATA buffer that is filled by this command
- * 
- * @param dataLength    Number of 16-bit words to read.
- * 
- * @return 
- */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterReadData(LEP_UINT16 portID,
-                                  LEP_UINT8  deviceAddress, 
-                                  LEP_UINT16 subAddress, 
-                                  LEP_UINT16 *dataPtr,
-                                  LEP_UINT16 dataLength)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemCustPartNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                     LEP_OEM_PART_NUMBER_T_PTR oemPartNumberPtr )
 {
-    LEP_RESULT result = LEP_OK;
-    LEP_UINT16 transactionStatus;
-    LEP_UINT16 numWordsRead;
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 16;   /* 32 bytes */
 
-    result = DEV_I2C_MasterReadData(portID,
-                                    deviceAddress,
-                                    subAddress,
-                                    dataPtr,
-                                    dataLength,
-                                    &numWordsRead,
-                                    &transactionStatus
-                                   );
+   if( oemPartNumberPtr == NULL )
+   {
+      return( LEP_BAD_ARG_POINTER_ERROR );
+   }
 
-    return(result);
-}
+   result = LEP_GetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_CUST_PART_NUMBER,
+                              ( LEP_ATTRIBUTE_T_PTR )oemPartNumberPtr,
+                              attributeWordLength );
 
-/**
- * Driver Write
- * 
- * @param portID     User-defined parameter to identify one of multiple ports
- * 
- * @param subAddress Specifies the Lepton Register Address to write to
- * 
- * @param dataPtr    Pointer to a DATA buffer to source the transfers
- * 
- * @param dataLength Specifies the number of 16-bit words to write from the bufffer
- * 
- * @return LEP_RESULT   LEP_OK if all goes well; otherwise a Lepton error code.
- */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterWriteData(LEP_UINT16 portID,
-                                   LEP_UINT8  deviceAddress, 
-                                   LEP_UINT16 subAddress, 
-                                   LEP_UINT16 *dataPtr,
-                                   LEP_UINT16 dataLength)
-{
-    LEP_RESULT result = LEP_OK;
-    LEP_UINT16 transactionStatus;
-    LEP_UINT16 numWordsWritten;
 
-    result = DEV_I2C_MasterWriteData(portID,
-                                     deviceAddress,
-                                     subAddress,
-                                     dataPtr,
-                                     dataLength,
-                                     &numWordsWritten,
-                                     &transactionStatus
-                                    );
-    return(result);
+   return( result );
 }
+#endif
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterReadRegister(LEP_UINT16 portID,
-                                      LEP_UINT8  deviceAddress, 
-                                      LEP_UINT16 regAddress,
-                                      LEP_UINT16 *regValue)
+#if 0
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemVendorID(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                              LEP_OEM_VENDORID_T *oemVendorIDPtr)
 {
-    LEP_RESULT result = LEP_OK;
-    LEP_UINT16 transactionStatus;
+   LEP_RESULT  result = LEP_OK;
 
-    result = DEV_I2C_MasterReadRegister(portID,
-                                        deviceAddress,
-                                        regAddress,
-                                        regValue,
-                                        &transactionStatus
-                                       );
-    return(result);
+   return( result );
 }
+#endif
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterWriteRegister(LEP_UINT16 portID,
-                                       LEP_UINT8  deviceAddress, 
-                                       LEP_UINT16 regAddress,
-                                       LEP_UINT16 regValue)
-{
-    LEP_RESULT result = LEP_OK;
-    LEP_UINT16 transactionStatus;
 
-    result = DEV_I2C_MasterWriteRegister(portID,
-                                         deviceAddress,
-                                         regAddress,
-                                         regValue,
-                                         &transactionStatus
-                                        );
-    return(result);
-}
+LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemFFCNormalization( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                       LEP_OEM_FFC_NORMALIZATION_TARGET_T ffcTarget )
+{
+   LEP_RESULT result = LEP_OK;
+   LEP_OEM_STATUS_E oemStatus = LEP_OEM_STATUS_BUSY;
 
+   result = LEP_SetOemFFCNormalizationTarget( portDescPtr, ffcTarget );
+   if( result == LEP_OK )
+   {
+      result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_FFC_NORMALIZATION_TARGET );
+      while( oemStatus == LEP_OEM_STATUS_BUSY )
+      {
+         LEP_GetOemCalStatus( portDescPtr, &oemStatus );
+      }
+   }
 
-/* Driver Status
-*/ 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_I2C_MasterStatus(LEP_UINT16 portID,
-                                LEP_UINT16 *portStatus )
-{
-    LEP_RESULT result = LEP_OK;
+   return( result );
 
-    return(result);
 }
 
-
-/**************************************/
-/*                OEM                 */
-/**************************************/
-/******************************************************************************/
-/**
- * Power Down the Camera by asserting the POWERDOWN condition.
- * 
- * @param portDescPtr
- * 
- * @return 
- */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemPowerDown( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemFFC( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
 {
-   LEP_RESULT  result = LEP_OK;
+   LEP_RESULT result = LEP_OK;
+   LEP_OEM_STATUS_E oemStatus = LEP_OEM_STATUS_BUSY;
 
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_POWER_DOWN );
+   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_FFC_NORMALIZATION_TARGET );
+   while( oemStatus == LEP_OEM_STATUS_BUSY )
+   {
+      LEP_GetOemCalStatus( portDescPtr, &oemStatus );
+   }
 
    return( result );
+
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemPowerOn( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemGpioVsyncPhaseDelay( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                          LEP_OEM_VSYNC_DELAY_E numHsyncLines )
 {
    LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
 
-   result = LEP_DirectWriteRegister( portDescPtr, 0x0, 0x0 );
-
-   return( result );
-}
-
-/**
- * Places the Camera into the Stand By condition.
- * 
- * @param portDescPtr
- * 
- * @return 
- */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemStandby( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
-{
-   LEP_RESULT  result = LEP_OK;
+   _LEP_data[1] = 0;
+   _LEP_data[0] = (LEP_INT16) numHsyncLines;
 
+   if( numHsyncLines >= LEP_END_OEM_VSYNC_DELAY )
+   {
+      return( LEP_RANGE_ERROR );
+   }
 
-   //result= LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_OEM_STANDBY );
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_GPIO_VSYNC_PHASE_DELAY,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemReboot( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemThermalShutdownEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                            LEP_OEM_THERMAL_SHUTDOWN_ENABLE_T ThermalShutdownEnableState )
 {
    LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
 
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_REBOOT );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemLowPowerMode1( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_LOW_POWER_MODE_1 );
+   _LEP_data[1] = 0;
+   _LEP_data[0] = (LEP_UINT16) ThermalShutdownEnableState.oemThermalShutdownEnable;
 
+   if( ThermalShutdownEnableState.oemThermalShutdownEnable >= LEP_OEM_END_STATE )
+   {
+      return( LEP_RANGE_ERROR );
+   }
+   /* Perform Command
+   ** Writing the Camera's current video freeze enable state
+   */
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_THERMAL_SHUTDOWN_ENABLE_STATE,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemLowPowerMode2( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemThermalShutdownEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                            LEP_OEM_THERMAL_SHUTDOWN_ENABLE_T_PTR ThermalShutdownEnableStatePtr )
 {
-   LEP_RESULT  result = LEP_OK;
-
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_LOW_POWER_MODE_2 );
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
 
+   if( ThermalShutdownEnableStatePtr == NULL )
+   {
+      return( LEP_BAD_ARG_POINTER_ERROR );
+   }
+   result = LEP_GetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_THERMAL_SHUTDOWN_ENABLE_STATE,
+                              ( LEP_ATTRIBUTE_T_PTR )ThermalShutdownEnableStatePtr,
+                              attributeWordLength );
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemBit( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemShutterProfileObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                        LEP_OEM_SHUTTER_PROFILE_OBJ_T ShutterProfileObj )
 {
-   LEP_RESULT  result = LEP_OK;
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2; /* 2 words */
 
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_BIT_TEST );
+   _LEP_data[1] = ShutterProfileObj.openPeriodInFrames;
+   _LEP_data[0] = ShutterProfileObj.closePeriodInFrames;
 
+   /* Perform Command
+   ** Writing the Camera's current video freeze enable state
+   */
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_SHUTTER_PROFILE_OBJ,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemMaskRevision( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_OEM_MASK_REVISION_T_PTR oemMaskRevisionPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemBadPixelReplaceControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                             LEP_OEM_BAD_PIXEL_REPLACE_CONTROL_T BadPixelReplaceControl )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* one 16-bit value */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2; /* two word enums */
 
-   /* Validate Parameter(s)
-   */
-   if( oemMaskRevisionPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+   _LEP_data[1] = 0;
+   _LEP_data[0] = (LEP_UINT16) BadPixelReplaceControl.oemBadPixelReplaceEnable;
 
    /* Perform Command
-   ** Reading the Camera's Chip Mask Revision
+   ** Writing the Camera's current video freeze enable state
    */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_MASK_REVISION,
-                              ( LEP_ATTRIBUTE_T_PTR )oemMaskRevisionPtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_BAD_PIXEL_REPLACE_CONTROL,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
                               attributeWordLength );
+
    return( result );
 }
-#if 0
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemMasterID( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_OEM_MASTER_ID_T_PTR oemMasterIDPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 48; /* 96 bytes  */
 
-   /* Validate Parameter(s)
-   */
-   if( oemMasterIDPtr == NULL )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemBadPixelReplaceControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                             LEP_OEM_BAD_PIXEL_REPLACE_CONTROL_T_PTR BadPixelReplaceControlPtr )
+{
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2; /* one enum */
+   if( BadPixelReplaceControlPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   /* Perform Command
-   ** Reading the Camera's Chip Master ID
-   */
    result = LEP_GetAttribute( portDescPtr,
-                             ( LEP_COMMAND_ID )LEP_CID_OEM_MASTER_ID,
-                             ( LEP_ATTRIBUTE_T_PTR )oemMasterIDPtr,
-                             attributeWordLength );
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_BAD_PIXEL_REPLACE_CONTROL,
+                              ( LEP_ATTRIBUTE_T_PTR )BadPixelReplaceControlPtr,
+                              attributeWordLength );
    return( result );
 }
-#endif
 
-#if USE_DEPRECATED_PART_NUMBER_INTERFACE
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemFlirPartNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_OEM_PART_NUMBER_T_PTR oemPartNumberPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemTemporalFilterControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                            LEP_OEM_TEMPORAL_FILTER_CONTROL_T TemporalFilterControl )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 16; /* 32 bytes */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
 
-   /* Validate Parameter(s)
-   */
-   if( oemPartNumberPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+   _LEP_data[1] = 0;
+   _LEP_data[0] = (LEP_UINT16) TemporalFilterControl.oemTemporalFilterEnable;;
 
    /* Perform Command
-   ** Reading the Camera's Part Number
+   ** Writing the Camera's current video freeze enable state
    */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_FLIR_PART_NUMBER,
-                              ( LEP_ATTRIBUTE_T_PTR )oemPartNumberPtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_TEMPORAL_FILTER_CONTROL,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
                               attributeWordLength );
-
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemCustPartNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_OEM_PART_NUMBER_T_PTR oemPartNumberPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemTemporalFilterControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                            LEP_OEM_TEMPORAL_FILTER_CONTROL_T_PTR TemporalFilterControlPtr )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 16;   /* 32 bytes */
-
-   if( oemPartNumberPtr == NULL )
+   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
+   if( TemporalFilterControlPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
    result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_CUST_PART_NUMBER,
-                              ( LEP_ATTRIBUTE_T_PTR )oemPartNumberPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_TEMPORAL_FILTER_CONTROL,
+                              ( LEP_ATTRIBUTE_T_PTR )TemporalFilterControlPtr,
                               attributeWordLength );
-
    return( result );
 }
-#else
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemFlirPartNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_OEM_PART_NUMBER_T_PTR oemPartNumberPtr )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemColumnNoiseEstimateControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                                 LEP_OEM_COLUMN_NOISE_ESTIMATE_CONTROL_T ColumnNoiseEstimateControl )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 16; /* 32 bytes */
+   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
 
-   /* Validate Parameter(s)
-   */
-   if( oemPartNumberPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+   _LEP_data[1] = 0;
+   _LEP_data[0] = (LEP_UINT16) ColumnNoiseEstimateControl.oemColumnNoiseEstimateEnable;;
 
-   /* Perform Command
-   ** Reading the Camera's Part Number
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_FLIR_PART_NUMBER,
-                              ( LEP_ATTRIBUTE_T_PTR )oemPartNumberPtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_COLUMN_NOISE_ESTIMATE_CONTROL,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
                               attributeWordLength );
-
    return( result );
 }
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemCustPartNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_OEM_PART_NUMBER_T_PTR oemPartNumberPtr )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemColumnNoiseEstimateControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                                 LEP_OEM_COLUMN_NOISE_ESTIMATE_CONTROL_T_PTR ColumnNoiseEstimateControlPtr )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 16;   /* 32 bytes */
-
-   if( oemPartNumberPtr == NULL )
+   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
+   if( ColumnNoiseEstimateControlPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
    result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_CUST_PART_NUMBER,
-                              ( LEP_ATTRIBUTE_T_PTR )oemPartNumberPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_COLUMN_NOISE_ESTIMATE_CONTROL,
+                              ( LEP_ATTRIBUTE_T_PTR )ColumnNoiseEstimateControlPtr,
                               attributeWordLength );
-
-
    return( result );
 }
-#endif
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemSoftwareVersion( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_OEM_SW_VERSION_T *oemSoftwareVersionPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemPixelNoiseSettings( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                         LEP_OEM_PIXEL_NOISE_SETTINGS_T_PTR pixelNoiseSettingsPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* 4 16-bit words to contain 64-bits */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2;    /* struct size 4 bytes */
 
-   /* Validate Parameter(s)
-   */
-   if( oemSoftwareVersionPtr == NULL )
+   if( pixelNoiseSettingsPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
 
-   /* Perform Command
-   ** Reading the Camera's Software Version
-   */
    result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_SOFTWARE_VERSION,
-                              ( LEP_ATTRIBUTE_T_PTR )oemSoftwareVersionPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_PIXEL_NOISE_ESTIMATE_CONTROL,
+                              ( LEP_ATTRIBUTE_T_PTR )pixelNoiseSettingsPtr,
                               attributeWordLength );
-   return( result );
-}
-
-
-#if 0
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemVendorID(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_OEM_VENDORID_T *oemVendorIDPtr)
-{
-   LEP_RESULT  result = LEP_OK;
 
    return( result );
 }
-#endif
-
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemVideoOutputEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_OEM_VIDEO_OUTPUT_ENABLE_E_PTR oemVideoOutputEnablePtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoOutputEnablePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Reading the Camera's current video output enable state
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_ENABLE,
-                              ( LEP_ATTRIBUTE_T_PTR )oemVideoOutputEnablePtr,
-                              attributeWordLength );
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemVideoOutputEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_OEM_VIDEO_OUTPUT_ENABLE_E oemVideoOutputEnable )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) oemVideoOutputEnable;
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoOutputEnable >= LEP_END_VIDEO_OUTPUT_ENABLE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   /* Perform Command
-   ** Writing the Camera's current video output enable state
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_ENABLE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemVideoOutputFormat( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_OEM_VIDEO_OUTPUT_FORMAT_E_PTR oemVideoOutputFormatPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoOutputFormatPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Reading the Camera's current video output format
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_FORMAT,
-                              ( LEP_ATTRIBUTE_T_PTR )oemVideoOutputFormatPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemVideoOutputFormat( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_OEM_VIDEO_OUTPUT_FORMAT_E oemVideoOutputFormat )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) oemVideoOutputFormat;
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoOutputFormat >= LEP_END_VIDEO_OUTPUT_FORMAT )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   /* Perform Command
-   ** Writing the Camera's current video output format
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_FORMAT,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemVideoOutputSource( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_OEM_VIDEO_OUTPUT_SOURCE_E_PTR oemVideoOutputSourcePtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoOutputSourcePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Reading the Camera's current video output source selection
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_SOURCE,
-                              ( LEP_ATTRIBUTE_T_PTR )oemVideoOutputSourcePtr,
-                              attributeWordLength );
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemVideoOutputSource( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_OEM_VIDEO_OUTPUT_SOURCE_E oemVideoOutputSource )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) oemVideoOutputSource;
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoOutputSource >= LEP_END_VIDEO_OUTPUT_SOURCE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   /* Perform Command
-   ** Writing the Camera's current video output source selection
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_SOURCE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemVideoOutputSourceConstant( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_UINT16 oemVideoOutputSourceConstant )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* 1 16-bit values for constant value */
-
-
-   /* Perform Command
-   ** Reading the Camera's current video output source selection
-   */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_CONSTANT,
-                              ( LEP_ATTRIBUTE_T_PTR ) & oemVideoOutputSourceConstant,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemVideoOutputSourceConstant( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_UINT16 *oemVideoOutputSourceConstPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* 1 16-bit values for constant value */
-
-   if( oemVideoOutputSourceConstPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Writing the Camera's current video output source selection
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_CONSTANT,
-                              ( LEP_ATTRIBUTE_T_PTR )oemVideoOutputSourceConstPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemVideoOutputChannel( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_OEM_VIDEO_OUTPUT_CHANNEL_E_PTR oemVideoOutputChannelPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoOutputChannelPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Reading the Camera's current video output channel selection
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_CHANNEL,
-                              ( LEP_ATTRIBUTE_T_PTR )oemVideoOutputChannelPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemVideoOutputChannel( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_OEM_VIDEO_OUTPUT_CHANNEL_E oemVideoOutputChannel )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) oemVideoOutputChannel;
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoOutputChannel >= LEP_END_VIDEO_OUTPUT_CHANNEL )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   /* Perform Command
-   ** Writing the Camera's current video output channel selection
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_OUTPUT_CHANNEL,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemVideoGammaEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_OEM_VIDEO_GAMMA_ENABLE_E_PTR oemVideoGammaEnablePtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoGammaEnablePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Reading the Camera's current video gamma correction enable
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_GAMMA_ENABLE,
-                              ( LEP_ATTRIBUTE_T_PTR )oemVideoGammaEnablePtr,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemVideoGammaEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_OEM_VIDEO_GAMMA_ENABLE_E oemVideoGammaEnable )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) oemVideoGammaEnable;
-
-   /* Validate Parameter(s)
-   */
-   if( oemVideoGammaEnable >= LEP_END_VIDEO_GAMMA_ENABLE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   /* Perform Command
-   ** Writing the Camera's current video output channel selection
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_VIDEO_GAMMA_ENABLE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemCalStatus( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_OEM_STATUS_E_PTR calStatusPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   if( calStatusPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_STATUS,
-                              ( LEP_ATTRIBUTE_T_PTR )calStatusPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemFFCNormalizationTarget( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_OEM_FFC_NORMALIZATION_TARGET_T_PTR ffcTargetPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* FFC Target is a single 16-bit value */
-
-   if( ffcTargetPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_FFC_NORMALIZATION_TARGET,
-                              ( LEP_ATTRIBUTE_T_PTR )ffcTargetPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemFFCNormalizationTarget( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_OEM_FFC_NORMALIZATION_TARGET_T ffcTarget )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_FFC_NORMALIZATION_TARGET,
-                              ( LEP_ATTRIBUTE_T_PTR ) & ffcTarget,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemFFCNormalization( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_OEM_FFC_NORMALIZATION_TARGET_T ffcTarget )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_OEM_STATUS_E oemStatus = LEP_OEM_STATUS_BUSY;
-
-   result = LEP_SetOemFFCNormalizationTarget( portDescPtr, ffcTarget );
-   if( result == LEP_OK )
-   {
-      result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_FFC_NORMALIZATION_TARGET );
-      while( oemStatus == LEP_OEM_STATUS_BUSY )
-      {
-         LEP_GetOemCalStatus( portDescPtr, &oemStatus );
-      }
-   }
-
-   return( result );
-
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemFFC( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_OEM_STATUS_E oemStatus = LEP_OEM_STATUS_BUSY;
-
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_FFC_NORMALIZATION_TARGET );
-   while( oemStatus == LEP_OEM_STATUS_BUSY )
-   {
-      LEP_GetOemCalStatus( portDescPtr, &oemStatus );
-   }
-
-   return( result );
-
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemFrameMean( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_OEM_FRAME_AVERAGE_T_PTR frameAveragePtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;
-
-   if( frameAveragePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_SCENE_MEAN_VALUE,
-                              ( LEP_ATTRIBUTE_T_PTR )frameAveragePtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemPowerMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_OEM_POWER_STATE_E_PTR powerModePtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
-
-   if( powerModePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_POWER_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR )powerModePtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemPowerMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_OEM_POWER_STATE_E powerMode )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) powerMode;
-
-   if( powerMode >= LEP_OEM_END_POWER_MODE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_POWER_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemGpioMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_OEM_GPIO_MODE_E_PTR gpioModePtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
-
-   if( gpioModePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_GPIO_MODE_SELECT,
-                              ( LEP_ATTRIBUTE_T_PTR )gpioModePtr,
-                              attributeWordLength );
-
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemGpioMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_OEM_GPIO_MODE_E gpioMode )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) gpioMode;
-
-   if ( gpioMode >= LEP_OEM_END_GPIO_MODE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_GPIO_MODE_SELECT,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemGpioVsyncPhaseDelay( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_OEM_VSYNC_DELAY_E_PTR numHsyncLinesPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
-
-   if( numHsyncLinesPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_GPIO_VSYNC_PHASE_DELAY,
-                              ( LEP_ATTRIBUTE_T_PTR )numHsyncLinesPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemGpioVsyncPhaseDelay( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_OEM_VSYNC_DELAY_E numHsyncLines )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_INT16) numHsyncLines;
-
-   if( numHsyncLines >= LEP_END_OEM_VSYNC_DELAY )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_GPIO_VSYNC_PHASE_DELAY,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemUserDefaultsState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_OEM_USER_PARAMS_STATE_E_PTR userParamsStatePtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
-
-   if( userParamsStatePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_USER_DEFAULTS,
-                              ( LEP_ATTRIBUTE_T_PTR )userParamsStatePtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemUserDefaultsCopyToOtp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
-{
-   LEP_RESULT result = LEP_OK;
-
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_USER_DEFAULTS );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunOemUserDefaultsRestore( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
-{
-   LEP_RESULT result = LEP_OK;
-
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_OEM_USER_DEFAULTS_RESTORE );
-
-   return( result );
-}
-
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemThermalShutdownEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_OEM_THERMAL_SHUTDOWN_ENABLE_T ThermalShutdownEnableState )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) ThermalShutdownEnableState.oemThermalShutdownEnable;
-
-   if( ThermalShutdownEnableState.oemThermalShutdownEnable >= LEP_OEM_END_STATE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-   /* Perform Command
-   ** Writing the Camera's current video freeze enable state
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_THERMAL_SHUTDOWN_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemThermalShutdownEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_OEM_THERMAL_SHUTDOWN_ENABLE_T_PTR ThermalShutdownEnableStatePtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
-
-   if( ThermalShutdownEnableStatePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_THERMAL_SHUTDOWN_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR )ThermalShutdownEnableStatePtr,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemShutterProfileObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_OEM_SHUTTER_PROFILE_OBJ_T ShutterProfileObj )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* 2 words */
-
-   _LEP_data[1] = ShutterProfileObj.openPeriodInFrames;
-   _LEP_data[0] = ShutterProfileObj.closePeriodInFrames;
-
-   /* Perform Command
-   ** Writing the Camera's current video freeze enable state
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_SHUTTER_PROFILE_OBJ,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemShutterProfileObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_OEM_SHUTTER_PROFILE_OBJ_T_PTR ShutterProfileObjPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* 2 words */
-
-   if( ShutterProfileObjPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_SHUTTER_PROFILE_OBJ,
-                              ( LEP_ATTRIBUTE_T_PTR )ShutterProfileObjPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemBadPixelReplaceControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_OEM_BAD_PIXEL_REPLACE_CONTROL_T BadPixelReplaceControl )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two word enums */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) BadPixelReplaceControl.oemBadPixelReplaceEnable;
-
-   /* Perform Command
-   ** Writing the Camera's current video freeze enable state
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_BAD_PIXEL_REPLACE_CONTROL,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemBadPixelReplaceControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_OEM_BAD_PIXEL_REPLACE_CONTROL_T_PTR BadPixelReplaceControlPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* one enum */
-   if( BadPixelReplaceControlPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_BAD_PIXEL_REPLACE_CONTROL,
-                              ( LEP_ATTRIBUTE_T_PTR )BadPixelReplaceControlPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemTemporalFilterControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_OEM_TEMPORAL_FILTER_CONTROL_T TemporalFilterControl )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) TemporalFilterControl.oemTemporalFilterEnable;;
-
-   /* Perform Command
-   ** Writing the Camera's current video freeze enable state
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_TEMPORAL_FILTER_CONTROL,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemTemporalFilterControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_OEM_TEMPORAL_FILTER_CONTROL_T_PTR TemporalFilterControlPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
-   if( TemporalFilterControlPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_TEMPORAL_FILTER_CONTROL,
-                              ( LEP_ATTRIBUTE_T_PTR )TemporalFilterControlPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemColumnNoiseEstimateControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_OEM_COLUMN_NOISE_ESTIMATE_CONTROL_T ColumnNoiseEstimateControl )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) ColumnNoiseEstimateControl.oemColumnNoiseEstimateEnable;;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_COLUMN_NOISE_ESTIMATE_CONTROL,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemColumnNoiseEstimateControl( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_OEM_COLUMN_NOISE_ESTIMATE_CONTROL_T_PTR ColumnNoiseEstimateControlPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* one enum = two words */
-   if( ColumnNoiseEstimateControlPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_COLUMN_NOISE_ESTIMATE_CONTROL,
-                              ( LEP_ATTRIBUTE_T_PTR )ColumnNoiseEstimateControlPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetOemPixelNoiseSettings( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_OEM_PIXEL_NOISE_SETTINGS_T_PTR pixelNoiseSettingsPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* struct size 4 bytes */
-
-   if( pixelNoiseSettingsPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_PIXEL_NOISE_ESTIMATE_CONTROL,
-                              ( LEP_ATTRIBUTE_T_PTR )pixelNoiseSettingsPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemPixelNoiseSettings( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_OEM_PIXEL_NOISE_SETTINGS_T pixelNoiseSettings )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* struct size 4 bytes */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) pixelNoiseSettings.oemPixelNoiseEstimateEnable;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_OEM_PIXEL_NOISE_ESTIMATE_CONTROL,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-/**************************************/
-/*                RAD                 */
-/**************************************/
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTShutterMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_RAD_TS_MODE_E_PTR radTShutterModePtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   /* Validate Parameter(s)
-   */
-   if( radTShutterModePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   /* Perform Command
-   ** Reading the Camera's current TShutter mode
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TSHUTTER_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR )radTShutterModePtr,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTShutterMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_RAD_TS_MODE_E radTShutterMode )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) radTShutterMode;
-
-   /* Validate Parameter(s)
-   */
-   if( radTShutterMode >= LEP_RAD_TS_END_TS_MODE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
-
-   /* Perform Command
-   ** Writing the Camera's current TShutter mode
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TSHUTTER_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTShutter( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_RAD_KELVIN_T_PTR radTShutterPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radTShutterPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TSHUTTER,
-                              ( LEP_ATTRIBUTE_T_PTR )radTShutterPtr,
-                              attributeWordLength );
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTShutter( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_RAD_KELVIN_T radTShutter )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TSHUTTER,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radTShutter,
-                              attributeWordLength );
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunRadFFC( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_RAD_STATUS_E radStatus = LEP_RAD_STATUS_BUSY;
-
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_RAD_RUN_FFC );
-   if( result == LEP_OK )
-   {
-      //TODO: Add timeout check
-      while( radStatus == LEP_RAD_STATUS_BUSY )
-      {
-         LEP_GetRadRunStatus( portDescPtr, &radStatus );
-      }
-   }
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadRBFOInternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_INTERNAL,
-                              ( LEP_ATTRIBUTE_T_PTR )radRBFOPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadRBFOInternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
-   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
-   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
-   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
-   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
-   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
-   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
-   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_INTERNAL,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadRBFOExternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_EXTERNAL,
-                              ( LEP_ATTRIBUTE_T_PTR )radRBFOPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadRBFOExternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 4 16-bit words
-
-   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
-   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
-   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
-   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
-   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
-   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
-   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
-   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_EXTERNAL,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadInternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_INTERNAL,
-                              ( LEP_ATTRIBUTE_T_PTR )radRBFOPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadInternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
-   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
-   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
-   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
-   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
-   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
-   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
-   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_INTERNAL,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadExternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_EXTERNAL,
-                              ( LEP_ATTRIBUTE_T_PTR )radRBFOPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadExternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
-   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
-   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
-   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
-   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
-   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
-   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
-   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_EXTERNAL,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadInternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_INTERNAL_LG,
-                              ( LEP_ATTRIBUTE_T_PTR )radRBFOPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadInternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
-   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
-   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
-   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
-   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
-   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
-   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
-   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_INTERNAL_LG,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadExternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_EXTERNAL_LG,
-                              ( LEP_ATTRIBUTE_T_PTR )radRBFOPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadExternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;    // RBFO is 4 16-bit words
-
-   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
-   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
-   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
-   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
-   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
-   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
-   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
-   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
-
-   if( radRBFOPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_EXTERNAL_LG,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadResponsivityShift( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_RAD_RS_T_PTR radResponsivityShiftPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radResponsivityShiftPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RESPONSIVITY_SHIFT,
-                              ( LEP_ATTRIBUTE_T_PTR )radResponsivityShiftPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadResponsivityShift( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_RAD_RS_T radResponsivityShift )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RESPONSIVITY_SHIFT,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radResponsivityShift,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadFNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_FNUMBER_T_PTR radFNumberPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radFNumberPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_F_NUMBER,
-                              ( LEP_ATTRIBUTE_T_PTR )radFNumberPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadFNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_FNUMBER_T radFNumber )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_F_NUMBER,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radFNumber,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTauLens( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_TAULENS_T_PTR radTauLensPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radTauLensPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAU_LENS,
-                              ( LEP_ATTRIBUTE_T_PTR )radTauLensPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTauLens( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_TAULENS_T radTauLens )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAU_LENS,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radTauLens,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadRadometryFilter( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_RAD_RADIOMETRY_FILTER_T_PTR radRadiometryFilterPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radRadiometryFilterPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RADIOMETRY_FILTER,
-                              ( LEP_ATTRIBUTE_T_PTR )radRadiometryFilterPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadRadometryFilter( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_RAD_RADIOMETRY_FILTER_T radRadiometryFilter )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RADIOMETRY_FILTER,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radRadiometryFilter,
-                              attributeWordLength );
-
-   return( result );
-}
-
-/* Deprecated: Use LEP_GetRadTFpaLut */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTFpaCLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_RAD_LUT256_T_PTR radTFpaCLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
-
-   if( radTFpaCLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTFpaCLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-/* Deprecated: Use LEP_SetRadTFpaLut */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTFpaCLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_RAD_LUT256_T_PTR radTFpaCLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
-
-   if( radTFpaCLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTFpaCLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-/* Deprecated: Use LEP_GetRadTAuxLut */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTAuxCLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_RAD_LUT256_T_PTR radTAuxCLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
-
-   if( radTAuxCLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTAuxCLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-/* Deprecated: Use LEP_SetRadTAuxLut */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTAuxCLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_RAD_LUT256_T_PTR radTAuxCLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
-
-   if( radTAuxCLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTAuxCLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTFpaLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_LUT256_T_PTR radTFpaLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
-
-   if( radTFpaLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTFpaLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTFpaLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_LUT256_T_PTR radTFpaLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
-
-   if( radTFpaLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTFpaLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTAuxLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_LUT256_T_PTR radTAuxLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
-
-   if( radTAuxLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTAuxLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTAuxLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_LUT256_T_PTR radTAuxLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
-
-   if( radTAuxLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTAuxLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadResponsivityValueLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RAD_LUT128_T_PTR radResponsivityValueLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 128;    // 128 16-bit word LUT
-
-   if( radResponsivityValueLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RESPONSIVITY_VALUE_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radResponsivityValueLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadResponsivityValueLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RAD_LUT128_T_PTR radResponsivityValueLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 128;    // 128 16-bit word LUT
-
-   if( radResponsivityValueLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RESPONSIVITY_VALUE_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radResponsivityValueLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadDebugTemp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_RAD_KELVIN_T_PTR radDebugTempPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radDebugTempPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_DEBUG_TEMP,
-                              ( LEP_ATTRIBUTE_T_PTR )radDebugTempPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadDebugTemp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_RAD_KELVIN_T radDebugTemp )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_DEBUG_TEMP,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radDebugTemp,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadDebugFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_RAD_FLUX_T_PTR radDebugFluxPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // 2 16-bit words
-
-   if( radDebugFluxPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_DEBUG_FLUX,
-                              ( LEP_ATTRIBUTE_T_PTR )radDebugFluxPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadDebugFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_RAD_FLUX_T radDebugFlux )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // 2 16-bit words
-
-   _LEP_data[1] = radDebugFlux >> 16;
-   _LEP_data[0] = radDebugFlux & 0xFFFF;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_DEBUG_FLUX,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_ENABLE_E_PTR radEnableStatePtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // 2 16-bit words for an enum
-
-   if( radEnableStatePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR )radEnableStatePtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_ENABLE_E radEnableState )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // 2 16-bit words for an enum
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) radEnableState;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadGlobalGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_RAD_GLOBAL_GAIN_T_PTR radGlobalGainPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radGlobalGainPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_GLOBAL_GAIN,
-                              ( LEP_ATTRIBUTE_T_PTR )radGlobalGainPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadGlobalGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_RAD_GLOBAL_GAIN_T radGlobalGain )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_GLOBAL_GAIN,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radGlobalGain,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadGlobalOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_RAD_GLOBAL_OFFSET_T_PTR radGlobalOffsetPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radGlobalOffsetPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_GLOBAL_OFFSET,
-                              ( LEP_ATTRIBUTE_T_PTR )radGlobalOffsetPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadGlobalOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_RAD_GLOBAL_OFFSET_T radGlobalOffset )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* single 16-bit value */
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_GLOBAL_OFFSET,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radGlobalOffset,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTFpaCtsMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_TEMPERATURE_UPDATE_E_PTR radTFpaCtsModePtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // 2 16-bit words for an enum
-
-   if( radTFpaCtsModePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_CTS_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR )radTFpaCtsModePtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTFpaCtsMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_TEMPERATURE_UPDATE_E radTFpaCtsMode )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // 2 16-bit words for an enum
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) radTFpaCtsMode;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_CTS_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTAuxCtsMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_TEMPERATURE_UPDATE_E_PTR radTAuxCtsModePtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // 2 16-bit words for an enum
-
-   if( radTAuxCtsModePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_CTS_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR )radTAuxCtsModePtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTAuxCtsMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_TEMPERATURE_UPDATE_E radTAuxCtsMode )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // 2 16-bit words for an enum
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) radTAuxCtsMode;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_CTS_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTFpaCts( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_TEMPERATURE_COUNTS_T_PTR radTFpaCtsPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radTFpaCtsPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_CTS,
-                              ( LEP_ATTRIBUTE_T_PTR )radTFpaCtsPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTFpaCts( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_TEMPERATURE_COUNTS_T radTFpaCts )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_CTS,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radTFpaCts,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTAuxCts( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_TEMPERATURE_COUNTS_T_PTR radTAuxCtsPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   if( radTAuxCtsPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_CTS,
-                              ( LEP_ATTRIBUTE_T_PTR )radTAuxCtsPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTAuxCts( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_TEMPERATURE_COUNTS_T radTAuxCts )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    // single 16-bit word
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_CTS,
-                              ( LEP_ATTRIBUTE_T_PTR ) & radTAuxCts,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTEqShutterLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_RAD_LUT128_T_PTR radTEqShutterLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 128;    // 128 16-bit word LUT
-
-   if( radTEqShutterLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TEQ_SHUTTER_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTEqShutterLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTEqShutterLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_RAD_LUT128_T_PTR radTEqShutterLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 128;    // 128 16-bit word LUT
-
-   if( radTEqShutterLutPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TEQ_SHUTTER_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radTEqShutterLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadRunStatus( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_RAD_STATUS_E_PTR radStatusPtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   if( radStatusPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_RUN_STATUS,
-                              ( LEP_ATTRIBUTE_T_PTR )radStatusPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTEqShutterFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_FLUX_T_PTR radTEqShutterFluxPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // single 32-bit word
-
-   if( radTEqShutterFluxPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TEQ_SHUTTER_FLUX,
-                              ( LEP_ATTRIBUTE_T_PTR )radTEqShutterFluxPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTEqShutterFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_FLUX_T radTEqShutterFlux )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // single 32-bit word
-
-   _LEP_data[1] = radTEqShutterFlux >> 16;
-   _LEP_data[0] = radTEqShutterFlux & 0xFFFF;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TEQ_SHUTTER_FLUX,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadMffcFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_RAD_FLUX_T_PTR radRadMffcFluxPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // single 32-bit word
-
-   if( radRadMffcFluxPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_MFFC_FLUX,
-                              ( LEP_ATTRIBUTE_T_PTR )radRadMffcFluxPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadMffcFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_RAD_FLUX_T radRadMffcFlux )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    // single 32-bit word
-
-   _LEP_data[1] = radRadMffcFlux >> 16;
-   _LEP_data[0] = radRadMffcFlux & 0xFFFF;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_MFFC_FLUX,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadFrameMedianPixelValue( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_MEDIAN_VALUE_T_PTR frameMedianPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* 1 16-bit word */
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_FRAME_MEDIAN_VALUE,
-                              ( LEP_ATTRIBUTE_T_PTR )frameMedianPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadMLGLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                             LEP_RAD_SIGNED_LUT128_T_PTR radMLGLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 128;    // 256 16-bit word LUT
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_MLG_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radMLGLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadMLGLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                             LEP_RAD_SIGNED_LUT128_T_PTR radMLGLutPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 128;    // 256 16-bit word LUT
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_MLG_LUT,
-                              ( LEP_ATTRIBUTE_T_PTR )radMLGLutPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-#if USE_DEPRECATED_HOUSING_TCP_INTERFACE
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTHousingTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR radHousingTcp )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;    // LEP_RAD_LINEAR_TEMP_CORRECTION_T is 4 16-bit words
-
-   if( radHousingTcp == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_THOUSING_TCP,
-                              ( LEP_ATTRIBUTE_T_PTR )radHousingTcp,
-                              attributeWordLength );
-
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTHousingTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_LINEAR_TEMP_CORRECTION_T radHousingTcp )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* single 16-bit value */
-
-   _LEP_data[3] = radHousingTcp.offset;
-   _LEP_data[2] = radHousingTcp.gainAux;
-   _LEP_data[1] = radHousingTcp.gainShutter;
-   _LEP_data[0] = radHousingTcp.pad;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_THOUSING_TCP,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-#else
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadHousingTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR RadHousingTcpPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;    // LEP_RAD_LINEAR_TEMP_CORRECTION_T is 4 16-bit words
-
-   if( RadHousingTcpPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_HOUSING_TCP,
-                              ( LEP_ATTRIBUTE_T_PTR )RadHousingTcpPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadHousingTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_RAD_LINEAR_TEMP_CORRECTION_T RadHousingTcp )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* single 16-bit value */
-
-   _LEP_data[3] = RadHousingTcp.offset;
-   _LEP_data[2] = RadHousingTcp.gainAux;
-   _LEP_data[1] = RadHousingTcp.gainShutter;
-   _LEP_data[0] = RadHousingTcp.pad;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_HOUSING_TCP,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-#endif
-
-
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadShutterTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR RadShutterTcpPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;    // LEP_RAD_LINEAR_TEMP_CORRECTION_T is 4 16-bit words
-
-   if( RadShutterTcpPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_SHUTTER_TCP,
-                              ( LEP_ATTRIBUTE_T_PTR )RadShutterTcpPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadShutterTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_RAD_LINEAR_TEMP_CORRECTION_T RadShutterTcp )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* single 16-bit value */
-
-   _LEP_data[3] = RadShutterTcp.offset;
-   _LEP_data[2] = RadShutterTcp.gainAux;
-   _LEP_data[1] = RadShutterTcp.gainShutter;
-   _LEP_data[0] = RadShutterTcp.pad;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_SHUTTER_TCP,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadLensTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR RadLensTcpPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;    // LEP_RAD_LINEAR_TEMP_CORRECTION_T is 4 16-bit words
-
-   if( RadLensTcpPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-   result = LEP_GetAttribute(  portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_LENS_TCP,
-                              ( LEP_ATTRIBUTE_T_PTR )RadLensTcpPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadLensTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_RAD_LINEAR_TEMP_CORRECTION_T RadLensTcp )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* 4 16-bit value */
-
-   _LEP_data[3] = RadLensTcp.offset;
-   _LEP_data[2] = RadLensTcp.gainAux;
-   _LEP_data[1] = RadLensTcp.gainShutter;
-   _LEP_data[0] = RadLensTcp.pad;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_LENS_TCP,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadPreviousGlobalOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RAD_GLOBAL_OFFSET_T_PTR globalOffsetPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* 1 16-bit value */
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_PREVIOUS_GLOBAL_OFFSET,
-                              ( LEP_ATTRIBUTE_T_PTR )globalOffsetPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadPreviousGlobalGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_RAD_GLOBAL_GAIN_T_PTR globalGainPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* 1 16-bit value */
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_PREVIOUS_GLOBAL_GAIN,
-                              ( LEP_ATTRIBUTE_T_PTR )globalGainPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetGlobalGainFFC( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_RAD_GLOBAL_GAIN_T_PTR globalGainFfcPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* 1 16-bit value */
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_GLOBAL_GAIN_FFC,
-                              ( LEP_ATTRIBUTE_T_PTR )globalGainFfcPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadCnfScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_PARAMETER_SCALE_FACTOR_T_PTR scaleFactorPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* 1 16-bit value */
-
-   if( scaleFactorPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_CNF_SCALE_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR )scaleFactorPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTnfScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_PARAMETER_SCALE_FACTOR_T_PTR scaleFactorPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* 1 16-bit value */
-
-   if( scaleFactorPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_TNF_SCALE_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR )scaleFactorPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadSnfScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_PARAMETER_SCALE_FACTOR_T_PTR scaleFactorPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* 1 16-bit value */
-
-   if( scaleFactorPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_SNF_SCALE_FACTOR,
-                              ( LEP_ATTRIBUTE_T_PTR )scaleFactorPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadArbitraryOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_RAD_ARBITRARY_OFFSET_T_PTR arbitraryOffsetPtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* 1 16-bit value */
-
-   if( arbitraryOffsetPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_ARBITRARY_OFFSET,
-                              ( LEP_ATTRIBUTE_T_PTR )arbitraryOffsetPtr,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadArbitraryOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_RAD_ARBITRARY_OFFSET_T arbitraryOffset )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_RAD_ARBITRARY_OFFSET,
-                              ( LEP_ATTRIBUTE_T_PTR ) & arbitraryOffset,
-                              attributeWordLength );
-
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadFluxLinearParams(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_RAD_FLUX_LINEAR_PARAMS_T_PTR fluxParamsPtr)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;
-
-   if(fluxParamsPtr == NULL)
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
-
-   result = LEP_GetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_FLUX_LINEAR_PARAMS,
-                             (LEP_ATTRIBUTE_T_PTR)fluxParamsPtr,
-                             attributeWordLength);
-
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadFluxLinearParams(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_RAD_FLUX_LINEAR_PARAMS_T fluxParams)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 8;
-
-   result = LEP_SetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_FLUX_LINEAR_PARAMS,
-                             (LEP_ATTRIBUTE_T_PTR)&fluxParams,
-                             attributeWordLength);
-
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTLinearEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_RAD_ENABLE_E_PTR enableStatePtr)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   if(enableStatePtr == NULL)
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
-
-   result = LEP_GetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_TLINEAR_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR ) enableStatePtr,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTLinearEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_RAD_ENABLE_E enableState)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) enableState;
-
-   result = LEP_SetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_TLINEAR_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTLinearResolution(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_RAD_TLINEAR_RESOLUTION_E_PTR resolutionPtr)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   if(resolutionPtr == NULL)
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
-
-   result = LEP_GetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_TLINEAR_RESOLUTION,
-                             (LEP_ATTRIBUTE_T_PTR)resolutionPtr,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTLinearResolution(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_RAD_TLINEAR_RESOLUTION_E resolution)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) resolution;
-
-   result = LEP_SetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_TLINEAR_RESOLUTION,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTLinearAutoResolution(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RAD_ENABLE_E_PTR enableStatePtr)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   if(enableStatePtr == NULL)
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
-
-   result = LEP_GetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_TLINEAR_AUTO_RESOLUTION,
-                             (LEP_ATTRIBUTE_T_PTR)enableStatePtr,
-                             attributeWordLength);
-   return(result);
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTLinearAutoResolution(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RAD_ENABLE_E enableState)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) enableState;
-
-   result = LEP_SetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_TLINEAR_AUTO_RESOLUTION,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadSpotmeterRoi(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_ROI_T_PTR spotmeterRoiPtr)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;
-
-   if(spotmeterRoiPtr == NULL)
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
-
-   result = LEP_GetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_SPOTMETER_ROI,
-                             (LEP_ATTRIBUTE_T_PTR)spotmeterRoiPtr,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadSpotmeterRoi(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_RAD_ROI_T spotmeterRoi)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;
-
-   _LEP_data[3] = spotmeterRoi.endRow;
-   _LEP_data[2] = spotmeterRoi.endCol;
-   _LEP_data[1] = spotmeterRoi.startRow;
-   _LEP_data[0] = spotmeterRoi.startCol;
-
-   result = LEP_SetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_SPOTMETER_ROI,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadSpotmeterObjInKelvinX100(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_RAD_SPOTMETER_OBJ_KELVIN_T_PTR kelvinPtr)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;
-
-   if(kelvinPtr == NULL)
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
-
-   result = LEP_GetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_SPOTMETER_OBJ_KELVIN,
-                             (LEP_ATTRIBUTE_T_PTR)kelvinPtr,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadArbitraryOffsetMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_RAD_ARBITRARY_OFFSET_MODE_E_PTR arbitraryOffsetModePtr )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   if(arbitraryOffsetModePtr == NULL)
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
-
-   result = LEP_GetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_ARBITRARY_OFFSET_MODE,
-                             (LEP_ATTRIBUTE_T_PTR)arbitraryOffsetModePtr,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadArbitraryOffsetMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_RAD_ARBITRARY_OFFSET_MODE_E arbitraryOffsetMode )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   result = LEP_SetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_ARBITRARY_OFFSET_MODE,
-                             (LEP_ATTRIBUTE_T_PTR)&arbitraryOffsetMode,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadArbitraryOffsetParams( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_ARBITRARY_OFFSET_PARAMS_T_PTR arbitraryOffsetParamsPtr)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   if(arbitraryOffsetParamsPtr == NULL)
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
-
-   result = LEP_GetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_ARBITRARY_OFFSET_PARAMS,
-                             (LEP_ATTRIBUTE_T_PTR)arbitraryOffsetParamsPtr,
-                             attributeWordLength);
-   return(result);
-
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadArbitraryOffsetParams( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_ARBITRARY_OFFSET_PARAMS_T arbitraryOffsetParams)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   result = LEP_SetAttribute(portDescPtr,
-                             (LEP_COMMAND_ID)LEP_CID_RAD_ARBITRARY_OFFSET_PARAMS,
-                             (LEP_ATTRIBUTE_T_PTR)&arbitraryOffsetParams,
-                             attributeWordLength);
-   return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadRadioCalValues( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_RADIO_CAL_VALUES_T_PTR radRadioCalValuesPtr)
-{
-    LEP_RESULT result = LEP_OK;
-    LEP_UINT16 attributeWordLength = 4;
-
-    if(radRadioCalValuesPtr == NULL)
-    {
-       return(LEP_BAD_ARG_POINTER_ERROR);
-    }
-
-    result = LEP_GetAttribute(portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_RAD_RADIO_CAL_VALUES,
-                              (LEP_ATTRIBUTE_T_PTR)radRadioCalValuesPtr,
-                              attributeWordLength);
-    return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadRadioCalValues( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_RADIO_CAL_VALUES_T radRadioCalValues )
-{
-    LEP_RESULT result = LEP_OK;
-    LEP_UINT16 attributeWordLength = 4;
-
-    result = LEP_SetAttribute(portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_RAD_RADIO_CAL_VALUES,
-                              (LEP_ATTRIBUTE_T_PTR)&radRadioCalValues,
-                              attributeWordLength);
-    return(result);
-}
-
-
-/**************************************/
-/*                SDK                 */
-/**************************************/
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAttribute(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                            LEP_COMMAND_ID commandID, 
-                            LEP_ATTRIBUTE_T_PTR attributePtr,
-                            LEP_UINT16 attributeWordLength)
-{
-    LEP_RESULT  result = LEP_OK;
-
-    /* Validate the port descriptor
-    */ 
-    if( portDescPtr == NULL )
-    {
-        return(LEP_COMM_PORT_NOT_OPEN);
-    }
-
-    /* Validate input pointer
-    */
-    if( attributePtr == NULL )
-    {
-        return(LEP_BAD_ARG_POINTER_ERROR);
-    }
-
-    /* Modify the passed-in command ID to add the Get type
-    */
-    commandID |= LEP_GET_TYPE;
-
-    /* Perform Command using the active Port
-    */
-    if( portDescPtr->portType == LEP_CCI_TWI )
-    {
-        /* Use the Lepton TWI/CCI Port
-        */ 
-        result = LEP_I2C_GetAttribute( portDescPtr, 
-                                       commandID,
-                                       attributePtr,
-                                       attributeWordLength );
-    }
-    else if( portDescPtr->portType == LEP_CCI_SPI )
-    {
-
-        /* Use the Lepton SPI Port
-        */ 
-
-    }
-    else
-        result = LEP_COMM_INVALID_PORT_ERROR;
-
-    return(result);
-}
-
-/**
- * Sets the value of a camera attribute.
- * 
- * @return 
- */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAttribute(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                            LEP_COMMAND_ID commandID, 
-                            LEP_ATTRIBUTE_T_PTR attributePtr,
-                            LEP_UINT16 attributeWordLength)
-{
-    LEP_RESULT result = LEP_OK;
-
-    /* Validate the port descriptor
-    */ 
-    if( portDescPtr == NULL )
-    {
-        return(LEP_COMM_PORT_NOT_OPEN);
-    }
-
-    /* Modify the passed-in command ID to add the Get type
-    */
-    commandID |= LEP_SET_TYPE;
-
-    /* Issue Command to the Active Port
-    */
-    if( portDescPtr->portType == LEP_CCI_TWI )
-    {
-        /* Use the Lepton TWI/CCI Port
-        */ 
-        result = LEP_I2C_SetAttribute( portDescPtr, 
-                                       commandID,
-                                       attributePtr,
-                                       attributeWordLength );
-    }
-    else if( portDescPtr->portType == LEP_CCI_SPI )
-    {
-        /* Use the Lepton SPI Port
-        */ 
-
-    }
-    else
-        result = LEP_COMM_INVALID_PORT_ERROR;
-
-    return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunCommand(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                          LEP_COMMAND_ID commandID)
-{
-    LEP_RESULT  result = LEP_OK;
-
-    /* Validate the port descriptor
-    */ 
-    if( portDescPtr == NULL )
-    {
-        return(LEP_COMM_PORT_NOT_OPEN);
-    }
-
-    /* Modify the passed-in command ID to add the Run type
-    */
-    commandID |= LEP_RUN_TYPE;
-
-    /* Perform Command
-    */
-    if( portDescPtr->portType == LEP_CCI_TWI )
-    {
-        /* Use the Lepton TWI/CCI Port
-        */ 
-        result = LEP_I2C_RunCommand( portDescPtr, 
-                                     commandID);
-    }
-    else if( portDescPtr->portType == LEP_CCI_SPI )
-    {
-        /* Use the Lepton SPI Port
-        */ 
-
-    }
-    else
-        result = LEP_COMM_INVALID_PORT_ERROR;
-
-    return(result);
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SelectDevice(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr, 
-                            LEP_PROTOCOL_DEVICE_E device)
-{
-    LEP_RESULT result = LEP_OK;
-
-    /* Validate the port descriptor
-    */ 
-    if( portDescPtr == NULL )
-    {
-        return(LEP_COMM_PORT_NOT_OPEN);
-    }
-
-    /* Select Device
-    */
-    if( portDescPtr->portType == LEP_CCI_TWI )
-    {
-        result = LEP_I2C_SelectDevice(portDescPtr, device);
-    }
-    else if( portDescPtr->portType == LEP_CCI_SPI )
-    {
-
-    }
-    else
-        result = LEP_COMM_INVALID_PORT_ERROR;
-
-    return(result);
-}
-
-/******************************************************************************/
-/**
- * Opens a Lepton commnications port of the specified type and
- * is assigned the passed ID.
- * This function dynamically allocates a new descriptor from the
- * system heap.
- * 
- * @param portID      LEP_UINT 16  User defined port ID.  This 
- *                    value is not used by the Lepton SDK but
- *                    provides the ability for
- *                    application-specific use.
- * 
- * @param portType    LEP_CAMERA_PORT_E  Specifies the Lepton 
- *                    Communications Port type.
- * 
- * @param pDescriptor LEP_CAMERA_PORT_DESC_T_PTR  Lepton Port
- *                    descriptor. This is a handle to a valid
- *                    Lepton port is fusseccful, NULL otherwise.
- * 
- * @return LEP_RESULT  Lepton Error Code.  LEP_OK if all goes well,
- *         otherise and Lepton error code is retunred.
- */
-LEP_RESULT LeptonSDKEmb32OEM::LEP_OpenPort(LEP_UINT16 portID,
-                        LEP_CAMERA_PORT_E portType,
-                        LEP_UINT16   portBaudRate,
-                        LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
-{
-    LEP_RESULT result = LEP_COMM_INVALID_PORT_ERROR;
-    LEP_UINT8 deviceAddress;
-
-    /* Attempt to acquire memory
-    **   Dynamic creation using malloc() or static allocation
-    **   Our reference will us dynamic creation
-    */ 
-#ifdef LEP_USE_DYNAMIC_ALLOCATION
-    /* Allocate from the heap
-    */ 
-    portDescPtr = (LEP_CAMERA_PORT_DESC_T_PTR)malloc( sizeof(LEP_CAMERA_PORT_DESC_T));
-#else    
-    /* Allocate from static memory
-    */ 
-#endif        
-
-    /* Validate the port descriptor
-    */ 
-    if( portDescPtr != NULL )
-    {
-        /* Open Port driver
-        */
-        switch( portType )
-        {
-            case LEP_CCI_TWI:
-                result = LEP_I2C_OpenPort(portID, &portBaudRate, &deviceAddress);
-                if( result == LEP_OK )
-                {
-                    portDescPtr->portBaudRate = portBaudRate;
-                    portDescPtr->portID = portID;
-                    portDescPtr->portType = portType;
-                    portDescPtr->deviceAddress = deviceAddress;
-                }
-                
-#ifdef LEP_USE_DYNAMIC_ALLOCATION
-				else
-					free( portDescPtr);
-#endif
-                    
-
-                break;
-
-            case LEP_CCI_SPI:
-                break;
-
-            default:
-                break;
-        }
-    }
-    else
-        result = LEP_ERROR_CREATING_COMM;
-
-
-    return(result);
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_ClosePort(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
-{
-    LEP_RESULT result = LEP_OK;
-	
-    /* Validate the port descriptor
-    */ 
-    if( portDescPtr == NULL )
-    {
-        return(LEP_COMM_PORT_NOT_OPEN);
-    }
-
-    /* Close Port driver
-    */
-    if( portDescPtr->portType == LEP_CCI_TWI )
-    {
-        result = LEP_I2C_ClosePort(portDescPtr);
-    }
-    else if( portDescPtr->portType == LEP_CCI_SPI )
-    {
-
-    }
-    else
-        result = LEP_COMM_INVALID_PORT_ERROR;
-
-    
-
-#ifdef LEP_USE_DYNAMIC_ALLOCATION
-    free( portDescPtr );
-#endif        
-
-    return(result);
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_ResetPort(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
-{
-    LEP_RESULT result;
-
-    /* Validate the port descriptor
-    */ 
-    if( portDescPtr == NULL )
-    {
-        return(LEP_COMM_PORT_NOT_OPEN);
-    }
-
-    if( portDescPtr->portType == LEP_CCI_TWI )
-    {
-        LEP_I2C_ResetPort( portDescPtr );
-    }
-    else if( portDescPtr->portType == LEP_CCI_SPI )
-    {
-
-    }
-    else
-        result = LEP_COMM_INVALID_PORT_ERROR;
-
-    return(result);
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetPortStatus(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr, 
-                             LEP_UINT16 *status)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetOemPixelNoiseSettings( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                         LEP_OEM_PIXEL_NOISE_SETTINGS_T pixelNoiseSettings )
 {
-    LEP_RESULT result = LEP_OK;
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2;    /* struct size 4 bytes */
 
+   _LEP_data[1] = 0;
+   _LEP_data[0] = (LEP_UINT16) pixelNoiseSettings.oemPixelNoiseEstimateEnable;
 
-    return(result);
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_OEM_PIXEL_NOISE_ESTIMATE_CONTROL,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
+
+   return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_DirectReadRegister(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_UINT16 registerAddress,
-                                  LEP_UINT16* regValue)
+
+/**************************************/
+/*                RAD                 */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_RunRadFFC( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
 {
    LEP_RESULT result = LEP_OK;
+   LEP_RAD_STATUS_E radStatus = LEP_RAD_STATUS_BUSY;
 
-
-   if( portDescPtr->portType == LEP_CCI_TWI )
-   {
-     /* Use the Lepton TWI/CCI Port
-     */ 
-      result = LEP_I2C_DirectReadRegister(portDescPtr, registerAddress, regValue);
-   }
-   else if( portDescPtr->portType == LEP_CCI_SPI )
+   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_RAD_RUN_FFC );
+   if( result == LEP_OK )
    {
-     /* Use the Lepton SPI Port
-     */ 
-
+      //TODO: Add timeout check
+      while( radStatus == LEP_RAD_STATUS_BUSY )
+      {
+         LEP_GetRadRunStatus( portDescPtr, &radStatus );
+      }
    }
-   else
-     result = LEP_COMM_INVALID_PORT_ERROR;
-
-   return(result);
+   return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetDeviceAddress(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_UINT8* deviceAddress)
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadRBFOInternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                    LEP_RBFO_T_PTR radRBFOPtr )
 {
    LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
 
-   if(portDescPtr->portType == LEP_CCI_TWI)
+   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
+   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
+   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
+   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
+   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
+   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
+   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
+   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
+
+   if( radRBFOPtr == NULL )
    {
-      result = LEP_I2C_GetDeviceAddress(portDescPtr, deviceAddress);
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_INTERNAL,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
 
-   return(result);
+   return( result );
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_DirectWriteRegister(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_UINT16 registerAddress,
-                                   LEP_UINT16 regValue)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadRBFOExternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                    LEP_RBFO_T_PTR radRBFOPtr )
 {
    LEP_RESULT result = LEP_OK;
-   /* Validate the port descriptor
-   */ 
-   if( portDescPtr == NULL )
-   {
-     return(LEP_COMM_PORT_NOT_OPEN);
-   }
+   LEP_UINT16 attributeWordLength = 8;    // RBFO is 4 16-bit words
 
-   /* Issue Command to the Active Port
-   */
-   if( portDescPtr->portType == LEP_CCI_TWI )
+   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
+   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
+   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
+   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
+   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
+   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
+   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
+   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
+
+   if( radRBFOPtr == NULL )
    {
-     /* Use the Lepton TWI/CCI Port
-     */ 
-      result = LEP_I2C_DirectWriteRegister(portDescPtr, registerAddress, regValue);
-     
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
-   else if( portDescPtr->portType == LEP_CCI_SPI )
-   {
-     /* Use the Lepton SPI Port
-     */ 
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_EXTERNAL,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
 
-   }
-   else
-     result = LEP_COMM_INVALID_PORT_ERROR;
-   return(result);
+   return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_DirectWriteBuffer(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_ATTRIBUTE_T_PTR attributePtr,
-                                 LEP_UINT16 attributeWordLength)
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadInternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                           LEP_RBFO_T_PTR radRBFOPtr )
 {
    LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
 
-   /* Validate the port descriptor
-   */ 
-   if( portDescPtr == NULL )
-   {
-     return(LEP_COMM_PORT_NOT_OPEN);
-   }
+   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
+   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
+   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
+   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
+   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
+   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
+   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
+   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
 
-   /* Issue Command to the Active Port
-   */
-   if( portDescPtr->portType == LEP_CCI_TWI )
+   if( radRBFOPtr == NULL )
    {
-     /* Use the Lepton TWI/CCI Port
-     */ 
-     result = LEP_I2C_DirectWriteBuffer(portDescPtr,
-                                        attributePtr,
-                                        attributeWordLength );
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
-   else if( portDescPtr->portType == LEP_CCI_SPI )
-   {
-     /* Use the Lepton SPI Port
-     */ 
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_INTERNAL,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
 
-   }
-   else
-     result = LEP_COMM_INVALID_PORT_ERROR;
-   return(result);
+   return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSDKVersion(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                             LEP_SDK_VERSION_T_PTR sdkVersionPtr)
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadExternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                           LEP_RBFO_T_PTR radRBFOPtr )
 {
    LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
 
-   if(sdkVersionPtr == NULL)
+   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
+   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
+   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
+   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
+   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
+   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
+   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
+   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
+
+   if( radRBFOPtr == NULL )
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
-   sdkVersionPtr->major = LEP_SDK_VERSION_MAJOR;
-   sdkVersionPtr->minor = LEP_SDK_VERSION_MINOR;
-   sdkVersionPtr->build = LEP_SDK_VERSION_BUILD;
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_EXTERNAL,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
 
-   return(result);
+   return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetCameraBootStatus(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_SDK_BOOT_STATUS_E_PTR bootStatusPtr)
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadInternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                           LEP_RBFO_T_PTR radRBFOPtr )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 regValue;
+   LEP_UINT16 attributeWordLength = 8;    // RBFO is 8 16-bit words
 
-   result = LEP_DirectReadRegister(portDescPtr, 0x2, &regValue);
+   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
+   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
+   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
+   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
+   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
+   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
+   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
+   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
 
-   if(result == LEP_OK && regValue & 4)
-   {
-      *bootStatusPtr = LEP_BOOT_STATUS_BOOTED;
-   }
-   else
+   if( radRBFOPtr == NULL )
    {
-      *bootStatusPtr = LEP_BOOT_STATUS_NOT_BOOTED;
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_INTERNAL_LG,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
 
-   return(result);
+   return( result );
 }
 
-/******************************************************************************/
-/** PRIVATE MODULE FUNCTIONS                                                 **/
-/******************************************************************************/
 
-LEP_RESULT LeptonSDKEmb32OEM::_LEP_DelayCounts(LEP_UINT32 counts)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadExternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                           LEP_RBFO_T_PTR radRBFOPtr )
 {
-    LEP_UINT32 a = 0;
-    while( counts-- )
-    {
-        a=counts;        
-    }
-    if( a )
-    {
-        return(LEP_TIMEOUT_ERROR) ;
-    }
-    return(LEP_OK);
-}
-
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 8;    // RBFO is 4 16-bit words
 
-/**************************************/
-/*                SYS                 */
-/**************************************/
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunSysPing( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
-{
-   LEP_RESULT  result = LEP_OK;
+   _LEP_data[7] = (LEP_UINT16) radRBFOPtr->RBFO_O >> 16;
+   _LEP_data[6] = (LEP_UINT16) radRBFOPtr->RBFO_O & 0xFFFF;
+   _LEP_data[5] = (LEP_UINT16) radRBFOPtr->RBFO_F >> 16;
+   _LEP_data[4] = (LEP_UINT16) radRBFOPtr->RBFO_F & 0xFFFF;
+   _LEP_data[3] = (LEP_UINT16) radRBFOPtr->RBFO_B >> 16;
+   _LEP_data[2] = (LEP_UINT16) radRBFOPtr->RBFO_B & 0xFFFF;
+   _LEP_data[1] = (LEP_UINT16) radRBFOPtr->RBFO_R >> 16;
+   _LEP_data[0] = (LEP_UINT16) radRBFOPtr->RBFO_R & 0xFFFF;
 
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_SYS_PING );
+   if( radRBFOPtr == NULL )
+   {
+      return( LEP_BAD_ARG_POINTER_ERROR );
+   }
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_RBFO_EXTERNAL_LG,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysStatus( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                             LEP_STATUS_T_PTR sysStatusPtr )
+/* Deprecated: Use LEP_GetRadTFpaLut */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTFpaCLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                               LEP_RAD_LUT256_T_PTR radTFpaCLutPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* 4 16-bit values */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
 
-   /* Validate Parameter(s)
-   */
-   if( sysStatusPtr == NULL )
+   if( radTFpaCLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   /* Perform Command
-   ** Reading the Camera's Status
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_CAM_STATUS,
-                              ( LEP_ATTRIBUTE_T_PTR )sysStatusPtr,
+   result = LEP_GetAttribute(  portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTFpaCLutPtr,
                               attributeWordLength );
+
    return( result );
 }
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysFlirSerialNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_SYS_FLIR_SERIAL_NUMBER_T_PTR sysSerialNumberBufPtr )
+/* Deprecated: Use LEP_SetRadTFpaLut */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTFpaCLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                               LEP_RAD_LUT256_T_PTR radTFpaCLutPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* 8 bytes values */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
 
-   /* Validate Parameter(s)
-   */
-   if( sysSerialNumberBufPtr == NULL )
+   if( radTFpaCLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   /* Perform Command
-   ** Reading the Camera's Serial Number
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_FLIR_SERIAL_NUMBER,
-                              ( LEP_ATTRIBUTE_T_PTR )sysSerialNumberBufPtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTFpaCLutPtr,
                               attributeWordLength );
+
    return( result );
 }
-#if USE_DEPRECATED_SERIAL_NUMBER_INTERFACE
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysCustSerialNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_SYS_CUST_SERIAL_NUMBER_T_PTR sysSerialNumberPtr )
+
+/* Deprecated: Use LEP_GetRadTAuxLut */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTAuxCLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                               LEP_RAD_LUT256_T_PTR radTAuxCLutPtr )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 16;   /* 32 byte string */
+   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
 
-   if( sysSerialNumberPtr == NULL )
+   if( radTAuxCLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_CUST_SERIAL_NUMBER,
-                              ( LEP_ATTRIBUTE_T_PTR )sysSerialNumberPtr,
+   result = LEP_GetAttribute(  portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTAuxCLutPtr,
                               attributeWordLength );
 
    return( result );
 }
-#else
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysCustSerialNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_SYS_CUST_SERIAL_NUMBER_T_PTR sysCustSNPtr )
+/* Deprecated: Use LEP_SetRadTAuxLut */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTAuxCLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                               LEP_RAD_LUT256_T_PTR radTAuxCLutPtr )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 16;      /*32 byte string */
+   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
 
-   if( sysCustSNPtr == NULL )
+   if( radTAuxCLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_CUST_SERIAL_NUMBER,
-                              ( LEP_ATTRIBUTE_T_PTR )sysCustSNPtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTAuxCLutPtr,
                               attributeWordLength );
 
    return( result );
 }
-#endif
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysCameraUpTime( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_SYS_UPTIME_NUMBER_T_PTR sysCameraUpTimePtr )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTFpaLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                              LEP_RAD_LUT256_T_PTR radTFpaLutPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
 
-   /* Validate Parameter(s)
-   */
-   if( sysCameraUpTimePtr == NULL )
+   if( radTFpaLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   /* Perform Command
-   ** Reading the Camera's Serial Number
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_CAM_UPTIME,
-                              ( LEP_ATTRIBUTE_T_PTR )sysCameraUpTimePtr,
+   result = LEP_GetAttribute(  portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTFpaLutPtr,
                               attributeWordLength );
+
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysAuxTemperatureCelcius( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_SYS_AUX_TEMPERATURE_CELCIUS_T_PTR auxTemperaturePtr )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTFpaLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                              LEP_RAD_LUT256_T_PTR radTFpaLutPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_SYS_AUX_TEMPERATURE_KELVIN_T unitsKelvin;
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
 
-   /* Validate Parameter(s)
-   */
-   if( auxTemperaturePtr == NULL )
+   if( radTFpaLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   result = LEP_GetSysAuxTemperatureKelvin( portDescPtr, &unitsKelvin );
-   *auxTemperaturePtr = ( LEP_SYS_AUX_TEMPERATURE_CELCIUS_T )( ( ( unitsKelvin / 100 ) + ( ( unitsKelvin % 100 ) * .01 ) ) - 273.15 );
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TFPA_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTFpaLutPtr,
+                              attributeWordLength );
 
    return( result );
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysFpaTemperatureCelcius( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_SYS_FPA_TEMPERATURE_CELCIUS_T_PTR fpaTemperaturePtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTAuxLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                              LEP_RAD_LUT256_T_PTR radTAuxLutPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_SYS_FPA_TEMPERATURE_KELVIN_T unitsKelvin;
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
 
-   /* Validate Parameter(s)
-   */
-   if( fpaTemperaturePtr == NULL )
+   if( radTAuxLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   result = LEP_GetSysFpaTemperatureKelvin( portDescPtr, &unitsKelvin );
-   *fpaTemperaturePtr = ( LEP_SYS_FPA_TEMPERATURE_CELCIUS_T )( ( ( unitsKelvin / 100 ) + ( ( unitsKelvin % 100 ) * .01 ) ) - 273.15 );
+   result = LEP_GetAttribute(  portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTAuxLutPtr,
+                              attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysAuxTemperatureKelvin( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_SYS_AUX_TEMPERATURE_KELVIN_T_PTR auxTemperaturePtr )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTAuxLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                              LEP_RAD_LUT256_T_PTR radTAuxLutPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* one 16-bit values */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 256;    // 256 16-bit word LUT
 
-   /* Validate Parameter(s)
-   */
-   if( auxTemperaturePtr == NULL )
+   if( radTAuxLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   /* Perform Command
-   ** Reading the Camera's Serial Number
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_AUX_TEMPERATURE_KELVIN,
-                              ( LEP_ATTRIBUTE_T_PTR )auxTemperaturePtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TAUX_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTAuxLutPtr,
                               attributeWordLength );
+
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysFpaTemperatureKelvin( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_SYS_FPA_TEMPERATURE_KELVIN_T_PTR fpaTemperaturePtr )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadResponsivityValueLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                           LEP_RAD_LUT128_T_PTR radResponsivityValueLutPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1; /* one 16-bit values */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 128;    // 128 16-bit word LUT
 
-   /* Validate Parameter(s)
-   */
-   if( fpaTemperaturePtr == NULL )
+   if( radResponsivityValueLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   /* Perform Command
-   ** Reading the Camera's Serial Number
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_FPA_TEMPERATURE_KELVIN,
-                              ( LEP_ATTRIBUTE_T_PTR )fpaTemperaturePtr,
+   result = LEP_GetAttribute(  portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_RESPONSIVITY_VALUE_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radResponsivityValueLutPtr,
                               attributeWordLength );
+
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysTelemetryEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_SYS_TELEMETRY_ENABLE_STATE_E_PTR enableStatePtr )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadResponsivityValueLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                           LEP_RAD_LUT128_T_PTR radResponsivityValueLutPtr )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* enums are 32-bits */
+   LEP_UINT16 attributeWordLength = 128;    // 128 16-bit word LUT
 
-   if( enableStatePtr == NULL )
+   if( radResponsivityValueLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   /* Perform Command
-   ** 
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_TELEMETRY_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR )enableStatePtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_RESPONSIVITY_VALUE_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radResponsivityValueLutPtr,
                               attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetSysTelemetryEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_SYS_TELEMETRY_ENABLE_STATE_E enableState )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadDebugFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                LEP_RAD_FLUX_T radDebugFlux )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* enums are 32-bits */
+   LEP_UINT16 attributeWordLength = 2;    // 2 16-bit words
 
-   if( enableState >= LEP_END_TELEMETRY_ENABLE_STATE )
-   {
-      return( LEP_RANGE_ERROR );
-   }
+   _LEP_data[1] = radDebugFlux >> 16;
+   _LEP_data[0] = radDebugFlux & 0xFFFF;
 
-   /* Perform Command
-   ** 
-   */
    result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_TELEMETRY_ENABLE_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & enableState,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_DEBUG_FLUX,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
                               attributeWordLength );
+
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysTelemetryLocation( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_SYS_TELEMETRY_LOCATION_E_PTR telemetryLocationPtr )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTEqShutterLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                    LEP_RAD_LUT128_T_PTR radTEqShutterLutPtr )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* enums are 32-bits */
+   LEP_UINT16 attributeWordLength = 128;    // 128 16-bit word LUT
 
-   if( telemetryLocationPtr == NULL )
+   if( radTEqShutterLutPtr == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   /* Perform Command
-   ** 
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_TELEMETRY_LOCATION,
-                              ( LEP_ATTRIBUTE_T_PTR )telemetryLocationPtr,
+   result = LEP_GetAttribute(  portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TEQ_SHUTTER_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTEqShutterLutPtr,
                               attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetSysTelemetryLocation( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_SYS_TELEMETRY_LOCATION_E telemetryLocation )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTEqShutterLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                    LEP_RAD_LUT128_T_PTR radTEqShutterLutPtr )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* enums are 32-bits */
+   LEP_UINT16 attributeWordLength = 128;    // 128 16-bit word LUT
 
-   if( telemetryLocation >= LEP_END_TELEMETRY_LOCATION )
+   if( radTEqShutterLutPtr == NULL )
    {
-      return( LEP_RANGE_ERROR );
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
    result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_TELEMETRY_LOCATION,
-                              ( LEP_ATTRIBUTE_T_PTR ) & telemetryLocation,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TEQ_SHUTTER_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radTEqShutterLutPtr,
                               attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunFrameAverage( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTEqShutterFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                     LEP_RAD_FLUX_T radTEqShutterFlux )
 {
-   LEP_RESULT  result;
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2;    // single 32-bit word
 
-   /* Run the frame averaging command
-   */
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_SYS_EXECTUE_FRAME_AVERAGE );
+   _LEP_data[1] = radTEqShutterFlux >> 16;
+   _LEP_data[0] = radTEqShutterFlux & 0xFFFF;
+
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_TEQ_SHUTTER_FLUX,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunSysAverageFrames( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_SYS_FRAME_AVERAGE_DIVISOR_E numFrameToAverage )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadMffcFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                               LEP_RAD_FLUX_T radRadMffcFlux )
 {
-   LEP_RESULT  result = LEP_OK;
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 2;    // single 32-bit word
 
-   /* Set the requested frames to average
-   */
-   result = LEP_SetSysFramesToAverage( portDescPtr, numFrameToAverage );
+   _LEP_data[1] = radRadMffcFlux >> 16;
+   _LEP_data[0] = radRadMffcFlux & 0xFFFF;
 
-   if( result == LEP_OK )
-   {
-      /* Run the frame averaging command
-      */
-      result = LEP_RunFrameAverage( portDescPtr );
-   }
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_MFFC_FLUX,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                              attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysFramesToAverage( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_FRAME_AVERAGE_DIVISOR_E_PTR numFrameToAveragePtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* one 32-bit value enum */
-
-   /* Validate Parameter(s) 
-   */
-   if( numFrameToAveragePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadMLGLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                             LEP_RAD_SIGNED_LUT128_T_PTR radMLGLutPtr )
+{
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 128;    // 256 16-bit word LUT
 
-   /* Perform Command
-   ** Writing the Camera's current number of frames to average
-   ** step
-   */
    result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_NUM_FRAMES_TO_AVERAGE,
-                              ( LEP_ATTRIBUTE_T_PTR )numFrameToAveragePtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_MLG_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radMLGLutPtr,
                               attributeWordLength );
 
-
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetSysFramesToAverage( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_FRAME_AVERAGE_DIVISOR_E numFrameToAverage )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadMLGLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                             LEP_RAD_SIGNED_LUT128_T_PTR radMLGLutPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* enums are 32-bit */
-
-   /* Validate Parameter(s) 
-   */
-   if( numFrameToAverage >= LEP_SYS_END_FA_DIV )
-   {
-      return( LEP_RANGE_ERROR );
-   }
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 128;    // 256 16-bit word LUT
 
-   /* Perform Command
-   ** Writing the Camera's current number of frames to average
-   ** step
-   */
    result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_NUM_FRAMES_TO_AVERAGE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & numFrameToAverage,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_MLG_LUT,
+                              ( LEP_ATTRIBUTE_T_PTR )radMLGLutPtr,
                               attributeWordLength );
 
-
    return( result );
 }
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysSceneStatistics( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_SCENE_STATISTICS_T_PTR sceneStatisticsPtr )
+#if USE_DEPRECATED_HOUSING_TCP_INTERFACE
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadTHousingTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                  LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR radHousingTcp )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;    /* struct contains 4 16-bit values */
+   LEP_UINT16 attributeWordLength = 4;    // LEP_RAD_LINEAR_TEMP_CORRECTION_T is 4 16-bit words
 
-   if( sceneStatisticsPtr == NULL )
+   if( radHousingTcp == NULL )
    {
       return( LEP_BAD_ARG_POINTER_ERROR );
    }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_SCENE_STATISTICS,
-                              ( LEP_ATTRIBUTE_T_PTR )sceneStatisticsPtr,
+   result = LEP_GetAttribute(  portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_THOUSING_TCP,
+                              ( LEP_ATTRIBUTE_T_PTR )radHousingTcp,
                               attributeWordLength );
 
    return( result );
 }
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysSceneRoi( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_SYS_VIDEO_ROI_T_PTR sceneRoiPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadTHousingTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                  LEP_RAD_LINEAR_TEMP_CORRECTION_T radHousingTcp )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;    /* roi consists of 4 16-bit values */
+   LEP_UINT16 attributeWordLength = 4; /* single 16-bit value */
 
-   if( sceneRoiPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+   _LEP_data[3] = radHousingTcp.offset;
+   _LEP_data[2] = radHousingTcp.gainAux;
+   _LEP_data[1] = radHousingTcp.gainShutter;
+   _LEP_data[0] = radHousingTcp.pad;
 
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_SCENE_ROI,
-                              ( LEP_ATTRIBUTE_T_PTR )sceneRoiPtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_THOUSING_TCP,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
                               attributeWordLength );
 
    return( result );
 }
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetSysSceneRoi( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_SYS_VIDEO_ROI_T sceneRoi )
+#else
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadHousingTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                 LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR RadHousingTcpPtr )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4;    /* roi consists of 4 16-bit values */
+   LEP_UINT16 attributeWordLength = 4;    // LEP_RAD_LINEAR_TEMP_CORRECTION_T is 4 16-bit words
 
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_SCENE_ROI,
-                              ( LEP_ATTRIBUTE_T_PTR ) & sceneRoi,
+   if( RadHousingTcpPtr == NULL )
+   {
+      return( LEP_BAD_ARG_POINTER_ERROR );
+   }
+   result = LEP_GetAttribute(  portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_HOUSING_TCP,
+                              ( LEP_ATTRIBUTE_T_PTR )RadHousingTcpPtr,
                               attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysThermalShutdownCount( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_SYS_THERMAL_SHUTDOWN_COUNTS_T_PTR thermalCountsPtr )
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadHousingTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                 LEP_RAD_LINEAR_TEMP_CORRECTION_T RadHousingTcp )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 1;    /* 1 16-bit value */
+   LEP_UINT16 attributeWordLength = 4; /* single 16-bit value */
 
-   if( thermalCountsPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+   _LEP_data[3] = RadHousingTcp.offset;
+   _LEP_data[2] = RadHousingTcp.gainAux;
+   _LEP_data[1] = RadHousingTcp.gainShutter;
+   _LEP_data[0] = RadHousingTcp.pad;
 
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_THERMAL_SHUTDOWN_COUNT,
-                              ( LEP_ATTRIBUTE_T_PTR )thermalCountsPtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_HOUSING_TCP,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
                               attributeWordLength );
 
    return( result );
 }
+#endif
+
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysShutterPosition( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_SHUTTER_POSITION_E_PTR shutterPositionPtr )
+
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadShutterTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                 LEP_RAD_LINEAR_TEMP_CORRECTION_T RadShutterTcp )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;    /* enums are 32-bit */
+   LEP_UINT16 attributeWordLength = 4; /* single 16-bit value */
 
-   if( shutterPositionPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+   _LEP_data[3] = RadShutterTcp.offset;
+   _LEP_data[2] = RadShutterTcp.gainAux;
+   _LEP_data[1] = RadShutterTcp.gainShutter;
+   _LEP_data[0] = RadShutterTcp.pad;
 
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_SHUTTER_POSITION,
-                              ( LEP_ATTRIBUTE_T_PTR )shutterPositionPtr,
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_SHUTTER_TCP,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
                               attributeWordLength );
 
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetSysShutterPosition( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_SHUTTER_POSITION_E shutterPosition )
+
+
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadLensTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                              LEP_RAD_LINEAR_TEMP_CORRECTION_T RadLensTcp )
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;     /* enums are 32-bit */
+   LEP_UINT16 attributeWordLength = 4; /* 4 16-bit value */
 
-   if( shutterPosition >= LEP_SYS_SHUTTER_POSITION_END )
-   {
-      return( LEP_RANGE_ERROR );
-   }
+   _LEP_data[3] = RadLensTcp.offset;
+   _LEP_data[2] = RadLensTcp.gainAux;
+   _LEP_data[1] = RadLensTcp.gainShutter;
+   _LEP_data[0] = RadLensTcp.pad;
 
    result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_SHUTTER_POSITION,
-                              ( LEP_ATTRIBUTE_T_PTR ) & shutterPosition,
+                              ( LEP_COMMAND_ID )LEP_CID_RAD_LENS_TCP,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
                               attributeWordLength );
 
    return( result );
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysFfcShutterModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_SYS_FFC_SHUTTER_MODE_OBJ_T_PTR shutterModeObjPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetRadSpotmeterRoi(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                  LEP_RAD_ROI_T spotmeterRoi)
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 16;
+   LEP_UINT16 attributeWordLength = 4;
 
-   if( shutterModeObjPtr == NULL )
+   _LEP_data[3] = spotmeterRoi.endRow;
+   _LEP_data[2] = spotmeterRoi.endCol;
+   _LEP_data[1] = spotmeterRoi.startRow;
+   _LEP_data[0] = spotmeterRoi.startCol;
+
+   result = LEP_SetAttribute(portDescPtr,
+                             (LEP_COMMAND_ID)LEP_CID_RAD_SPOTMETER_ROI,
+                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
+                             attributeWordLength);
+   return(result);
+}
+
+/**
+ * Queues a read of the spot meter without waiting for the camera.  kelvinPtr
+ * is valid when cmdPtr->done is set (or the callback is called) with LEP_OK.
+ * 
+ * @return LEP_OK if the command was queued, otherwise an error code.
+ */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetRadSpotmeterObjInKelvinX100Async(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                                   LEP_ASYNC_CMD_T_PTR cmdPtr,
+                                                   LEP_RAD_SPOTMETER_OBJ_KELVIN_T_PTR kelvinPtr,
+                                                   LEP_ASYNC_CALLBACK callback,
+                                                   void *callbackArg)
+{
+   if(portDescPtr == NULL)
    {
-      return( LEP_BAD_ARG_POINTER_ERROR );
+      return(LEP_COMM_PORT_NOT_OPEN);
+   }
+   if(cmdPtr == NULL || kelvinPtr == NULL)
+   {
+      return(LEP_BAD_ARG_POINTER_ERROR);
+   }
+   if(portDescPtr->portType != LEP_CCI_TWI)
+   {
+      return(LEP_COMM_INVALID_PORT_ERROR);
    }
 
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_FFC_SHUTTER_MODE_OBJ,
-                              ( LEP_ATTRIBUTE_T_PTR )shutterModeObjPtr,
-                              attributeWordLength );
+   cmdPtr->portDescPtr = portDescPtr;
+   cmdPtr->type = LEP_ASYNC_GET_ATTRIBUTE;
+   typedef lep::Attr<LEP_CID_RAD_SPOTMETER_OBJ_KELVIN, LEP_RAD_SPOTMETER_OBJ_KELVIN_T, 4> A;
 
-   return( result );
+   cmdPtr->commandID = A::id | LEP_GET_TYPE;
+   cmdPtr->attributePtr = (LEP_ATTRIBUTE_T_PTR)kelvinPtr;
+   cmdPtr->attributeWordLength = A::words;
+   cmdPtr->callback = callback;
+   cmdPtr->callbackArg = callbackArg;
+
+   return(LEP_I2C_SubmitCommand(cmdPtr));
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetSysFfcShutterModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_SYS_FFC_SHUTTER_MODE_OBJ_T shutterModeObj )
+/**************************************/
+/*                SDK                 */
+/**************************************/
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetAttribute(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                            LEP_COMMAND_ID commandID, 
+                            LEP_ATTRIBUTE_T_PTR attributePtr,
+                            LEP_UINT16 attributeWordLength)
 {
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 16;
+    LEP_RESULT  result = LEP_OK;
+#if (USE_ATTRIBUTE_CACHE == 1)
+    LEP_UINT8 gen;
+#endif
 
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_FFC_SHUTTER_MODE_OBJ,
-                              ( LEP_ATTRIBUTE_T_PTR ) & shutterModeObj,
-                              attributeWordLength );
+    /* Validate the port descriptor
+    */ 
+    if( portDescPtr == NULL )
+    {
+        return(LEP_COMM_PORT_NOT_OPEN);
+    }
 
-   return( result );
+    /* Validate input pointer
+    */
+    if( attributePtr == NULL )
+    {
+        return(LEP_BAD_ARG_POINTER_ERROR);
+    }
+
+    /* Modify the passed-in command ID to add the Get type
+    */
+    commandID |= LEP_GET_TYPE;
+
+    /* Perform Command using the active Port
+    */
+    if( portDescPtr->portType == LEP_CCI_TWI )
+    {
+#if (USE_ATTRIBUTE_CACHE == 1)
+        /* Cached values don't need the camera at all
+        */
+        if( AttrCacheGet( commandID, attributePtr, attributeWordLength ) )
+        {
+            return(LEP_OK);
+        }
+        gen = attrCacheGen;
+#endif
+
+        /* Use the Lepton TWI/CCI Port
+        */ 
+        result = LEP_I2C_GetAttribute( portDescPtr, 
+                                       commandID,
+                                       attributePtr,
+                                       attributeWordLength );
+#if (USE_ATTRIBUTE_CACHE == 1)
+        if( result == LEP_OK )
+        {
+            AttrCachePut( commandID, attributePtr, attributeWordLength, gen );
+        }
+#endif
+    }
+    else if( portDescPtr->portType == LEP_CCI_SPI )
+    {
+
+        /* Use the Lepton SPI Port
+        */ 
+
+    }
+    else
+        result = LEP_COMM_INVALID_PORT_ERROR;
+
+    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_RunSysFFCNormalization( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+/**
+ * Sets the value of a camera attribute.
+ * 
+ * @return 
+ */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetAttribute(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                            LEP_COMMAND_ID commandID, 
+                            LEP_ATTRIBUTE_T_PTR attributePtr,
+                            LEP_UINT16 attributeWordLength)
 {
-   LEP_RESULT result = LEP_OK;
-   LEP_SYS_STATUS_E sysStatus = LEP_SYS_STATUS_BUSY;
+    LEP_RESULT result = LEP_OK;
+
+    /* Validate the port descriptor
+    */ 
+    if( portDescPtr == NULL )
+    {
+        return(LEP_COMM_PORT_NOT_OPEN);
+    }
+
+    /* Modify the passed-in command ID to add the Get type
+    */
+    commandID |= LEP_SET_TYPE;
+
+    /* Issue Command to the Active Port
+    */
+    if( portDescPtr->portType == LEP_CCI_TWI )
+    {
+        /* Use the Lepton TWI/CCI Port
+        */ 
+        result = LEP_I2C_SetAttribute( portDescPtr, 
+                                       commandID,
+                                       attributePtr,
+                                       attributeWordLength );
+    }
+    else if( portDescPtr->portType == LEP_CCI_SPI )
+    {
+        /* Use the Lepton SPI Port
+        */ 
 
-   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )FLR_CID_SYS_RUN_FFC );
-   while( sysStatus == LEP_SYS_STATUS_BUSY )
-   {
-      LEP_GetSysFFCStatus( portDescPtr, &sysStatus );
-   }
+    }
+    else
+        result = LEP_COMM_INVALID_PORT_ERROR;
 
-   return( result );
+    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysFFCStatus( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_SYS_STATUS_E_PTR ffcStatusPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_RunCommand(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                          LEP_COMMAND_ID commandID)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   if( ffcStatusPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_FFC_STATUS,
-                              ( LEP_ATTRIBUTE_T_PTR )ffcStatusPtr,
-                              attributeWordLength );
+    LEP_RESULT  result = LEP_OK;
 
-   return( result );
-}
+    /* Validate the port descriptor
+    */ 
+    if( portDescPtr == NULL )
+    {
+        return(LEP_COMM_PORT_NOT_OPEN);
+    }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysGainMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_SYS_GAIN_MODE_E_PTR gainModePtr )
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* enums are 32-bit */
+    /* Modify the passed-in command ID to add the Run type
+    */
+    commandID |= LEP_RUN_TYPE;
 
-   if( gainModePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    /* Perform Command
+    */
+    if( portDescPtr->portType == LEP_CCI_TWI )
+    {
+        /* Use the Lepton TWI/CCI Port
+        */ 
+        result = LEP_I2C_RunCommand( portDescPtr, 
+                                     commandID);
+    }
+    else if( portDescPtr->portType == LEP_CCI_SPI )
+    {
+        /* Use the Lepton SPI Port
+        */ 
 
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_GAIN_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR )gainModePtr,
-                              attributeWordLength );
+    }
+    else
+        result = LEP_COMM_INVALID_PORT_ERROR;
 
-   return( result );
+    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetSysGainMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_SYS_GAIN_MODE_E gainMode )
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
-
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_GAIN_MODE,
-                              ( LEP_ATTRIBUTE_T_PTR ) & gainMode,
-                              attributeWordLength );
 
-   return( result );
+/**
+ * Enables or disables the attribute cache.  Disabling it also empties it.
+ */
+void LeptonSDKEmb32OEM::LEP_EnableAttrCache(LEP_BOOL enable)
+{
+#if (USE_ATTRIBUTE_CACHE == 1)
+    LEP_InvalidateAttrCache();
+    attrCacheEnable = enable;
+#endif
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysGainModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_SYS_GAIN_MODE_OBJ_T_PTR gainModeObjPtr )
+/**
+ * Empties the attribute cache.
+ */
+void LeptonSDKEmb32OEM::LEP_InvalidateAttrCache(void)
 {
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 14;
+#if (USE_ATTRIBUTE_CACHE == 1)
+    LEP_UINT8 i;
 
-   if( gainModeObjPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
-
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_GAIN_MODE_OBJ,
-                              ( LEP_ATTRIBUTE_T_PTR )gainModeObjPtr,
-                              attributeWordLength );
-
-   return( result );
+    /* A get in progress must not store the value it reads
+    */
+    attrCacheGen = attrCacheGen + 1;
+    for( i = 0; i < LEP_ATTR_CACHE_ENTRIES; i++ )
+    {
+        attrCache[i].words = 0;
+    }
+    attrCacheNext = 0;
+#endif
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetSysGainModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                  LEP_SYS_GAIN_MODE_OBJ_T gainModeObj )
+
+/**
+ * Empties the attribute cache for a command that may change the camera's
+ * settings: any set, and the commands that restore the camera's defaults.
+ * Called for every command queued to the command engine.
+ */
+void LeptonSDKEmb32OEM::AttrCacheCommand(LEP_COMMAND_ID commandID)
 {
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 14;
+#if (USE_ATTRIBUTE_CACHE == 1)
+    switch( commandID )
+    {
+        case LEP_CID_OEM_REBOOT | LEP_RUN_TYPE:
+        case LEP_CID_OEM_POWER_DOWN | LEP_RUN_TYPE:
+        case LEP_CID_OEM_USER_DEFAULTS_RESTORE | LEP_RUN_TYPE:
+            LEP_InvalidateAttrCache();
+            break;
+
+        default:
+            if( (commandID & 0x0003) == LEP_SET_TYPE )
+            {
+                LEP_InvalidateAttrCache();
+            }
+            break;
+    }
+#else
+    (void)commandID;
+#endif
+}
 
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_GAIN_MODE_OBJ,
-                              ( LEP_ATTRIBUTE_T_PTR ) & gainModeObj,
-                              attributeWordLength );
 
-   return( result );
+#if (USE_ATTRIBUTE_CACHE == 1)
+/**
+ * Read-mostly attributes the camera only changes when the host sets them.
+ * Temperatures, statistics, status and the TLinear resolution (which
+ * changes on its own in auto resolution mode) are always read.
+ */
+LEP_BOOL LeptonSDKEmb32OEM::AttrCacheable(LEP_COMMAND_ID commandID)
+{
+    switch( commandID )
+    {
+        case LEP_CID_AGC_ENABLE_STATE:
+        case LEP_CID_AGC_POLICY:
+        case LEP_CID_AGC_ROI:
+        case LEP_CID_AGC_CALC_ENABLE_STATE:
+
+        case LEP_CID_OEM_MASK_REVISION:
+        case LEP_CID_OEM_FLIR_PART_NUMBER:
+        case LEP_CID_OEM_SOFTWARE_VERSION:
+        case LEP_CID_OEM_CUST_PART_NUMBER:
+        case LEP_CID_OEM_VIDEO_OUTPUT_ENABLE:
+        case LEP_CID_OEM_VIDEO_OUTPUT_FORMAT:
+        case LEP_CID_OEM_VIDEO_OUTPUT_SOURCE:
+        case LEP_CID_OEM_VIDEO_OUTPUT_CHANNEL:
+        case LEP_CID_OEM_GPIO_MODE_SELECT:
+        case LEP_CID_OEM_GPIO_VSYNC_PHASE_DELAY:
+
+        case LEP_CID_RAD_ENABLE_STATE:
+        case LEP_CID_RAD_FLUX_LINEAR_PARAMS:
+        case LEP_CID_RAD_TLINEAR_ENABLE_STATE:
+        case LEP_CID_RAD_TLINEAR_AUTO_RESOLUTION:
+        case LEP_CID_RAD_SPOTMETER_ROI:
+
+        case LEP_CID_SYS_FLIR_SERIAL_NUMBER:
+        case LEP_CID_SYS_CUST_SERIAL_NUMBER:
+        case LEP_CID_SYS_TELEMETRY_ENABLE_STATE:
+        case LEP_CID_SYS_TELEMETRY_LOCATION:
+        case LEP_CID_SYS_NUM_FRAMES_TO_AVERAGE:
+        case LEP_CID_SYS_SCENE_ROI:
+        case LEP_CID_SYS_FFC_SHUTTER_MODE_OBJ:
+        case LEP_CID_SYS_GAIN_MODE:
+        case LEP_CID_SYS_GAIN_MODE_OBJ:
+
+        case LEP_CID_VID_POLARITY_SELECT:
+        case LEP_CID_VID_LUT_SELECT:
+        case LEP_CID_VID_FOCUS_CALC_ENABLE:
+        case LEP_CID_VID_SBNUC_ENABLE:
+        case LEP_CID_VID_FREEZE_ENABLE:
+        case LEP_CID_VID_VIDEO_OUTPUT_FORMAT:
+            return(LEP_TRUE);
+
+        default:
+            return(LEP_FALSE);
+    }
 }
 
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysFFCStates( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                LEP_SYS_FFC_STATES_E_PTR ffcStatePtr )
+/**
+ * Copies a cached attribute value.
+ * 
+ * @return LEP_TRUE if the attribute was in the cache
+ */
+LEP_BOOL LeptonSDKEmb32OEM::AttrCacheGet(LEP_COMMAND_ID commandID,
+                                        LEP_ATTRIBUTE_T_PTR attributePtr,
+                                        LEP_UINT16 words)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2;
+    LEP_UINT8 i;
 
-   if( ffcStatePtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    if( !attrCacheEnable )
+    {
+        return(LEP_FALSE);
+    }
 
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_FFC_STATE,
-                              ( LEP_ATTRIBUTE_T_PTR )ffcStatePtr,
-                              attributeWordLength );
+    for( i = 0; i < LEP_ATTR_CACHE_ENTRIES; i++ )
+    {
+        if( (attrCache[i].words == words) && (attrCache[i].commandID == commandID) )
+        {
+            memcpy( attributePtr, attrCache[i].data, words * 2 );
+            return(LEP_TRUE);
+        }
+    }
 
-   return( result );
+    return(LEP_FALSE);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysBoresightValues( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_BORESIGHT_VALUES_T_PTR boresightValuesPtr)
+
+/**
+ * Stores an attribute value that was just read, replacing the oldest entry
+ * when the cache is full.  gen is attrCacheGen from before the read so a
+ * value read while a set was queued is not kept.
+ */
+void LeptonSDKEmb32OEM::AttrCachePut(LEP_COMMAND_ID commandID,
+                                     LEP_ATTRIBUTE_T_PTR attributePtr,
+                                     LEP_UINT16 words,
+                                     LEP_UINT8 gen)
 {
-    LEP_RESULT  result = LEP_OK;
-    LEP_UINT16 attributeWordLength = 6;
+    ATTR_CACHE_ENTRY_T *entryPtr;
 
-    if( boresightValuesPtr == NULL )
+    if( !attrCacheEnable || (gen != attrCacheGen) ||
+        (words == 0) || (words > LEP_ATTR_CACHE_MAX_WORDS) ||
+        !AttrCacheable( commandID & ~0x0003 ) )
     {
-       return( LEP_BAD_ARG_POINTER_ERROR );
+        return;
     }
 
-    result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_SYS_BORESIGHT_VALUES,
-                              ( LEP_ATTRIBUTE_T_PTR )boresightValuesPtr,
-                              attributeWordLength );
+    entryPtr = &attrCache[attrCacheNext];
+    attrCacheNext = (attrCacheNext + 1) % LEP_ATTR_CACHE_ENTRIES;
 
-    return( result );
+    entryPtr->commandID = commandID;
+    memcpy( entryPtr->data, attributePtr, words * 2 );
+    entryPtr->words = words;
 }
+#endif
 
 
-/**************************************/
-/*                VID                 */
-/**************************************/
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidPolarity(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_POLARITY_E_PTR vidPolarityPtr)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SelectDevice(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr, 
+                            LEP_PROTOCOL_DEVICE_E device)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+    LEP_RESULT result = LEP_OK;
 
-   /* Validate Parameter(s)
-   */
-   if( vidPolarityPtr == NULL )
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
+    /* Validate the port descriptor
+    */ 
+    if( portDescPtr == NULL )
+    {
+        return(LEP_COMM_PORT_NOT_OPEN);
+    }
 
-   /* Perform Command
-   ** Reading the Camera's Video Polarity
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_POLARITY_SELECT, 
-                              (LEP_ATTRIBUTE_T_PTR)vidPolarityPtr,
-                              attributeWordLength );
-   return( result );
+    /* Select Device
+    */
+    if( portDescPtr->portType == LEP_CCI_TWI )
+    {
+        result = LEP_I2C_SelectDevice(portDescPtr, device);
+    }
+    else if( portDescPtr->portType == LEP_CCI_SPI )
+    {
+
+    }
+    else
+        result = LEP_COMM_INVALID_PORT_ERROR;
+
+    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidPolarity(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                              LEP_POLARITY_E vidPolarity)
+/******************************************************************************/
+/**
+ * Opens a Lepton commnications port of the specified type and
+ * is assigned the passed ID.
+ * This function dynamically allocates a new descriptor from the
+ * system heap.
+ * 
+ * @param portID      LEP_UINT 16  User defined port ID.  This 
+ *                    value is not used by the Lepton SDK but
+ *                    provides the ability for
+ *                    application-specific use.
+ * 
+ * @param portType    LEP_CAMERA_PORT_E  Specifies the Lepton 
+ *                    Communications Port type.
+ * 
+ * @param pDescriptor LEP_CAMERA_PORT_DESC_T_PTR  Lepton Port
+ *                    descriptor. This is a handle to a valid
+ *                    Lepton port is fusseccful, NULL otherwise.
+ * 
+ * @return LEP_RESULT  Lepton Error Code.  LEP_OK if all goes well,
+ *         otherise and Lepton error code is retunred.
+ */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_OpenPort(LEP_UINT16 portID,
+                        LEP_CAMERA_PORT_E portType,
+                        LEP_UINT16   portBaudRate,
+                        LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+    LEP_RESULT result = LEP_COMM_INVALID_PORT_ERROR;
+    LEP_UINT8 deviceAddress;
 
-   /* Validate Parameter(s)
-   */
-   if( vidPolarity >= LEP_VID_END_POLARITY )
-   {
-      return(LEP_RANGE_ERROR);
-   }
+    /* Attempt to acquire memory
+    **   Dynamic creation using malloc() or static allocation
+    **   Our reference will us dynamic creation
+    */ 
+#ifdef LEP_USE_DYNAMIC_ALLOCATION
+    /* Allocate from the heap
+    */ 
+    portDescPtr = (LEP_CAMERA_PORT_DESC_T_PTR)malloc( sizeof(LEP_CAMERA_PORT_DESC_T));
+#else    
+    /* Allocate from static memory
+    */ 
+#endif        
 
-   /* Perform Command
-   ** Writing the Camera's Video Polarity
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_POLARITY_SELECT, 
-                              (LEP_ATTRIBUTE_T_PTR)&vidPolarity,
-                              attributeWordLength);
-   return( result );
-}
+    /* Validate the port descriptor
+    */ 
+    if( portDescPtr != NULL )
+    {
+        /* Open Port driver
+        */
+        switch( portType )
+        {
+            case LEP_CCI_TWI:
+                result = LEP_I2C_OpenPort(portID, &portBaudRate, &deviceAddress);
+                if( result == LEP_OK )
+                {
+                    portDescPtr->portBaudRate = portBaudRate;
+                    portDescPtr->portID = portID;
+                    portDescPtr->portType = portType;
+                    portDescPtr->deviceAddress = deviceAddress;
+                }
+                
+#ifdef LEP_USE_DYNAMIC_ALLOCATION
+				else
+					free( portDescPtr);
+#endif
+                    
 
+                break;
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidPcolorLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_PCOLOR_LUT_E_PTR vidPcolorLutPtr)
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+            case LEP_CCI_SPI:
+                break;
+
+            default:
+                break;
+        }
+    }
+    else
+        result = LEP_ERROR_CREATING_COMM;
 
-   /* Validate Parameter(s)
-   */
-   if( vidPcolorLutPtr == NULL )
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
 
-   /* Perform Command
-   ** Reading the Camera's current Video LUT selection
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_LUT_SELECT, 
-                              (LEP_ATTRIBUTE_T_PTR)vidPcolorLutPtr,
-                              attributeWordLength );
-   return( result );
+    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidPcolorLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                               LEP_PCOLOR_LUT_E vidPcolorLut)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_ClosePort(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+    LEP_RESULT result = LEP_OK;
+	
+    /* Validate the port descriptor
+    */ 
+    if( portDescPtr == NULL )
+    {
+        return(LEP_COMM_PORT_NOT_OPEN);
+    }
 
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) vidPcolorLut;
+    /* Close Port driver
+    */
+    if( portDescPtr->portType == LEP_CCI_TWI )
+    {
+        result = LEP_I2C_ClosePort(portDescPtr);
+    }
+    else if( portDescPtr->portType == LEP_CCI_SPI )
+    {
 
-   /* Validate Parameter(s)
-   */
-   if( vidPcolorLut >= LEP_VID_END_PCOLOR_LUT )
-   {
-      return(LEP_RANGE_ERROR);
-   }
+    }
+    else
+        result = LEP_COMM_INVALID_PORT_ERROR;
 
-   /* Perform Command
-   ** Writing the Camera's current Video LUT selection
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_LUT_SELECT, 
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength);
-   return( result );
-}
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidLowGainPcolorLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_PCOLOR_LUT_E_PTR vidPcolorLutPtr)
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+    
 
-   /* Validate Parameter(s)
-   */
-   if( vidPcolorLutPtr == NULL )
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
+#ifdef LEP_USE_DYNAMIC_ALLOCATION
+    free( portDescPtr );
+#endif        
 
-   /* Perform Command
-   ** Reading the Camera's current Video LUT selection
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_LOW_GAIN_COLOR_LUT, 
-                              (LEP_ATTRIBUTE_T_PTR)vidPcolorLutPtr,
-                              attributeWordLength );
-   return( result );
+    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidLowGainPcolorLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_PCOLOR_LUT_E vidPcolorLut)
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_ResetPort(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+    LEP_RESULT result;
 
-   /* Validate Parameter(s)
-   */
-   if( vidPcolorLut >= LEP_VID_END_PCOLOR_LUT )
-   {
-      return(LEP_RANGE_ERROR);
-   }
+    /* Validate the port descriptor
+    */ 
+    if( portDescPtr == NULL )
+    {
+        return(LEP_COMM_PORT_NOT_OPEN);
+    }
 
-   /* Perform Command
-   ** Writing the Camera's current Video LUT selection
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_LOW_GAIN_COLOR_LUT, 
-                              (LEP_ATTRIBUTE_T_PTR)&vidPcolorLut,
-                              attributeWordLength);
-   return( result );
+    if( portDescPtr->portType == LEP_CCI_TWI )
+    {
+        LEP_I2C_ResetPort( portDescPtr );
+    }
+    else if( portDescPtr->portType == LEP_CCI_SPI )
+    {
+
+    }
+    else
+        result = LEP_COMM_INVALID_PORT_ERROR;
+
+    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidUserLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                             LEP_VID_LUT_BUFFER_T_PTR vidUserLutBufPtr)
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetPortStatus(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr, 
+                             LEP_UINT16 *status)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 512; /* 512 16-bit values for 1024 byte LUT*/
+    LEP_RESULT result = LEP_OK;
 
-   /* Validate Parameter(s)
-   */
-   if( vidUserLutBufPtr == NULL )
-   {
-      return(LEP_BAD_ARG_POINTER_ERROR);
-   }
 
-   /* Perform Command
-   ** Reading the Camera's User Video LUT 
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_LUT_TRANSFER, 
-                              (LEP_ATTRIBUTE_T_PTR)vidUserLutBufPtr,
-                              attributeWordLength );
-   return( result );
+    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidUserLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                             LEP_VID_LUT_BUFFER_T_PTR vidUserLutBufPtr)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_DirectReadRegister(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                  LEP_UINT16 registerAddress,
+                                  LEP_UINT16* regValue)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 512; /* 512 16-bit values for 1024 byte LUT*/
+   LEP_RESULT result = LEP_OK;
 
-   /* Validate Parameter(s)
-   */
-   if( vidUserLutBufPtr == NULL )
+
+   if( portDescPtr->portType == LEP_CCI_TWI )
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+     /* Use the Lepton TWI/CCI Port
+     */ 
+      result = LEP_I2C_DirectReadRegister(portDescPtr, registerAddress, regValue);
    }
+   else if( portDescPtr->portType == LEP_CCI_SPI )
+   {
+     /* Use the Lepton SPI Port
+     */ 
 
-   /* Perform Command
-   ** Writing the Camera's User Video LUT
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_LUT_TRANSFER, 
-                              (LEP_ATTRIBUTE_T_PTR)vidUserLutBufPtr,
-                              attributeWordLength);
-   return( result );
-}
+   }
+   else
+     result = LEP_COMM_INVALID_PORT_ERROR;
 
+   return(result);
+}
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidFocusCalcEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_VID_FOCUS_CALC_ENABLE_E_PTR vidEnableFocusCalcStatePtr)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetDeviceAddress(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                LEP_UINT8* deviceAddress)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+   LEP_RESULT result = LEP_OK;
 
-   /* Validate Parameter(s)
-   */
-   if( vidEnableFocusCalcStatePtr == NULL )
+   if(portDescPtr->portType == LEP_CCI_TWI)
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+      result = LEP_I2C_GetDeviceAddress(portDescPtr, deviceAddress);
    }
 
-   /* Perform Command
-   ** Reading the Camera's Video Focus Metric calculation enable 
-   ** state
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_FOCUS_CALC_ENABLE, 
-                              (LEP_ATTRIBUTE_T_PTR)vidEnableFocusCalcStatePtr,
-                              attributeWordLength );
-   return( result );
+   return(result);
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidFocusCalcEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_VID_FOCUS_CALC_ENABLE_E vidFocusCalcEnableState)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_DirectWriteRegister(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                   LEP_UINT16 registerAddress,
+                                   LEP_UINT16 regValue)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) vidFocusCalcEnableState;
-
-   /* Validate Parameter(s)
-   */
-   if( vidFocusCalcEnableState >= LEP_VID_END_FOCUS_CALC_ENABLE )
+   LEP_RESULT result = LEP_OK;
+   /* Validate the port descriptor
+   */ 
+   if( portDescPtr == NULL )
    {
-      return(LEP_RANGE_ERROR);
+     return(LEP_COMM_PORT_NOT_OPEN);
    }
 
-   /* Perform Command
-   ** Writing the Camera's Video Focus Metric Calculation enable
-   ** state
+   /* Issue Command to the Active Port
    */
-   result = LEP_SetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_FOCUS_CALC_ENABLE, 
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength);
-   return( result );
-}
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidBoresightCalcEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_VID_BORESIGHT_CALC_ENABLE_STATE_E_PTR boresightCalcEnableStatePtr)
-{
-   LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* Enums are 32-bit */
-
-   if(boresightCalcEnableStatePtr == NULL)
+   if( portDescPtr->portType == LEP_CCI_TWI )
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+     /* Use the Lepton TWI/CCI Port
+     */ 
+      result = LEP_I2C_DirectWriteRegister(portDescPtr, registerAddress, regValue);
+     
    }
+   else if( portDescPtr->portType == LEP_CCI_SPI )
+   {
+     /* Use the Lepton SPI Port
+     */ 
 
-   result = LEP_GetAttribute( portDescPtr,
-                           (LEP_COMMAND_ID)LEP_CID_VID_BORESIGHT_CALC_ENABLE, 
-                           (LEP_ATTRIBUTE_T_PTR)boresightCalcEnableStatePtr,
-                           attributeWordLength );
-
-
+   }
+   else
+     result = LEP_COMM_INVALID_PORT_ERROR;
    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidBoresightCalcEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_VID_BORESIGHT_CALC_ENABLE_STATE_E boresightCalcEnableState)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_DirectWriteBuffer(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                 LEP_ATTRIBUTE_T_PTR attributePtr,
+                                 LEP_UINT16 attributeWordLength)
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* Enums are 32-bit */
 
-   if(boresightCalcEnableState >= LEP_VID_END_BORESIGHT_CALC_ENABLE_STATE)
+   /* Validate the port descriptor
+   */ 
+   if( portDescPtr == NULL )
    {
-      return(LEP_RANGE_ERROR);
+     return(LEP_COMM_PORT_NOT_OPEN);
    }
 
-   result = LEP_SetAttribute( portDescPtr,
-                           (LEP_COMMAND_ID)LEP_CID_VID_BORESIGHT_CALC_ENABLE, 
-                           (LEP_ATTRIBUTE_T_PTR)&boresightCalcEnableState,
-                           attributeWordLength);
+   /* Issue Command to the Active Port
+   */
+   if( portDescPtr->portType == LEP_CCI_TWI )
+   {
+     /* Use the Lepton TWI/CCI Port
+     */ 
+     result = LEP_I2C_DirectWriteBuffer(portDescPtr,
+                                        attributePtr,
+                                        attributeWordLength );
+   }
+   else if( portDescPtr->portType == LEP_CCI_SPI )
+   {
+     /* Use the Lepton SPI Port
+     */ 
 
+   }
+   else
+     result = LEP_COMM_INVALID_PORT_ERROR;
    return(result);
 }
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidBoresightCoordinates(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_VID_BORESIGHT_COORDINATES_T_PTR boresightCoordinatesPtr)
+
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSDKVersion(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                             LEP_SDK_VERSION_T_PTR sdkVersionPtr)
 {
    LEP_RESULT result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 16;
 
-   if( boresightCoordinatesPtr == NULL )
+   if(sdkVersionPtr == NULL)
    {
       return(LEP_BAD_ARG_POINTER_ERROR);
    }
-
-   result = LEP_GetAttribute( portDescPtr,
-                        (LEP_COMMAND_ID)LEP_CID_VID_BORESIGHT_COORDINATES, 
-                        (LEP_ATTRIBUTE_T_PTR)boresightCoordinatesPtr,
-                        attributeWordLength );
+   sdkVersionPtr->major = LEP_SDK_VERSION_MAJOR;
+   sdkVersionPtr->minor = LEP_SDK_VERSION_MINOR;
+   sdkVersionPtr->build = LEP_SDK_VERSION_BUILD;
 
    return(result);
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidTargetPosition(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_VID_TARGET_POSITION_T_PTR targetPositionPtr)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetCameraBootStatus(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                   LEP_SDK_BOOT_STATUS_E_PTR bootStatusPtr)
 {
    LEP_RESULT result = LEP_OK;
-   LEP_VID_BORESIGHT_COORDINATES_T boresightCoordinates;
+   LEP_UINT16 regValue;
 
-   if(targetPositionPtr == NULL)
+   result = LEP_DirectReadRegister(portDescPtr, 0x2, &regValue);
+
+   if(result == LEP_OK && regValue & 4)
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+      *bootStatusPtr = LEP_BOOT_STATUS_BOOTED;
    }
-#if (USE_BORESIGHT_MEASUREMENT_FUNCTIONS == 1)
-   result = LEP_GetVidBoresightCoordinates(portDescPtr, &boresightCoordinates);
-   if(result == LEP_OK)
+   else
    {
-      LEP_CalcVidBoresightAlignment(boresightCoordinates, targetPositionPtr);
+      *bootStatusPtr = LEP_BOOT_STATUS_NOT_BOOTED;
    }
-#else
-   return(LEP_FUNCTION_NOT_SUPPORTED);
-#endif
 
    return(result);
 }
 
+/******************************************************************************/
+/** PRIVATE MODULE FUNCTIONS                                                 **/
+/******************************************************************************/
+
+LEP_RESULT LeptonSDKEmb32OEM::_LEP_DelayCounts(LEP_UINT32 counts)
+{
+    LEP_UINT32 a = 0;
+    while( counts-- )
+    {
+        a=counts;        
+    }
+    if( a )
+    {
+        return(LEP_TIMEOUT_ERROR) ;
+    }
+    return(LEP_OK);
+}
+
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidROI(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                         LEP_VID_FOCUS_ROI_T_PTR vidROIPtr)
+/**************************************/
+/*                SYS                 */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysStatus( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                             LEP_STATUS_T_PTR sysStatusPtr )
 {
    LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* four 16-bit values */
+   LEP_UINT16 attributeWordLength = 4; /* 4 16-bit values */
 
    /* Validate Parameter(s)
    */
-   if( vidROIPtr == NULL )
+   if( sysStatusPtr == NULL )
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
 
    /* Perform Command
-   ** Reading the Camera's AGC ROI
+   ** Reading the Camera's Status
    */
    result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_FOCUS_ROI, 
-                              (LEP_ATTRIBUTE_T_PTR)vidROIPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_SYS_CAM_STATUS,
+                              ( LEP_ATTRIBUTE_T_PTR )sysStatusPtr,
                               attributeWordLength );
    return( result );
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidROI(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                         LEP_VID_FOCUS_ROI_T vidROI)
-{
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 4; /* four 16-bit values */
-
-   /* Perform Command
-   ** Writing the Camera's AGC ROI
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_FOCUS_ROI, 
-                              (LEP_ATTRIBUTE_T_PTR)&vidROI,
-                              attributeWordLength);
-   return( result );
-}
-
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidFocusMetric(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_VID_FOCUS_METRIC_T_PTR vidFocusMetricPtr)
+#if USE_DEPRECATED_SERIAL_NUMBER_INTERFACE
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysCustSerialNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                       LEP_SYS_CUST_SERIAL_NUMBER_T_PTR sysSerialNumberPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 16;   /* 32 byte string */
 
-   /* Validate Parameter(s)
-   */
-   if( vidFocusMetricPtr == NULL )
+   if( sysSerialNumberPtr == NULL )
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
 
-   /* Perform Command
-   ** Reading the Camera's current video Focus Metric calculation
-   ** result
-   */
    result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_FOCUS_METRIC, 
-                              (LEP_ATTRIBUTE_T_PTR)vidFocusMetricPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_SYS_CUST_SERIAL_NUMBER,
+                              ( LEP_ATTRIBUTE_T_PTR )sysSerialNumberPtr,
                               attributeWordLength );
+
    return( result );
 }
+#else
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidFocusMetricThreshold(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_VID_FOCUS_METRIC_THRESHOLD_T_PTR vidFocusMetricThresholdPtr)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysCustSerialNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                       LEP_SYS_CUST_SERIAL_NUMBER_T_PTR sysCustSNPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 16;      /*32 byte string */
 
-   /* Validate Parameter(s)
-   */
-   if( vidFocusMetricThresholdPtr == NULL )
+   if( sysCustSNPtr == NULL )
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
 
-   /* Perform Command
-   ** Reading the Camera's current video Focus Metric threshold
-   */
    result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_FOCUS_THRESHOLD, 
-                              (LEP_ATTRIBUTE_T_PTR)vidFocusMetricThresholdPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_SYS_CUST_SERIAL_NUMBER,
+                              ( LEP_ATTRIBUTE_T_PTR )sysCustSNPtr,
                               attributeWordLength );
+
    return( result );
 }
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidFocusMetricThreshold(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_VID_FOCUS_METRIC_THRESHOLD_T vidFocusMetricThreshold)
+#endif
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysAuxTemperatureCelcius( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                            LEP_SYS_AUX_TEMPERATURE_CELCIUS_T_PTR auxTemperaturePtr )
 {
    LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit value*/
+   LEP_SYS_AUX_TEMPERATURE_KELVIN_T unitsKelvin;
 
    /* Validate Parameter(s)
    */
+   if( auxTemperaturePtr == NULL )
+   {
+      return( LEP_BAD_ARG_POINTER_ERROR );
+   }
+
+   result = LEP_GetSysAuxTemperatureKelvin( portDescPtr, &unitsKelvin );
+   *auxTemperaturePtr = ( LEP_SYS_AUX_TEMPERATURE_CELCIUS_T )( ( ( unitsKelvin / 100 ) + ( ( unitsKelvin % 100 ) * .01 ) ) - 273.15 );
 
-   /* Perform Command
-   ** Writing the Camera's current video Focus Metric threshold
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_FOCUS_THRESHOLD, 
-                              (LEP_ATTRIBUTE_T_PTR)&vidFocusMetricThreshold,
-                              attributeWordLength);
    return( result );
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidSbNucEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_VID_SBNUC_ENABLE_E_PTR vidSbNucEnableStatePtr)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysFpaTemperatureCelcius( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                            LEP_SYS_FPA_TEMPERATURE_CELCIUS_T_PTR fpaTemperaturePtr )
 {
    LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+   LEP_SYS_FPA_TEMPERATURE_KELVIN_T unitsKelvin;
 
    /* Validate Parameter(s)
    */
-   if( vidSbNucEnableStatePtr == NULL )
+   if( fpaTemperaturePtr == NULL )
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
 
-   /* Perform Command
-   ** Reading the Camera's current Scene-Based NUC enable state
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_SBNUC_ENABLE, 
-                              (LEP_ATTRIBUTE_T_PTR)vidSbNucEnableStatePtr,
-                              attributeWordLength );
+   result = LEP_GetSysFpaTemperatureKelvin( portDescPtr, &unitsKelvin );
+   *fpaTemperaturePtr = ( LEP_SYS_FPA_TEMPERATURE_CELCIUS_T )( ( ( unitsKelvin / 100 ) + ( ( unitsKelvin % 100 ) * .01 ) ) - 273.15 );
+
    return( result );
 }
 
+LEP_RESULT LeptonSDKEmb32OEM::LEP_RunFrameAverage( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+{
+   LEP_RESULT  result;
+
+   /* Run the frame averaging command
+   */
+   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )LEP_CID_SYS_EXECTUE_FRAME_AVERAGE );
+
+   return( result );
+}
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidSbNucEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_VID_SBNUC_ENABLE_E vidSbNucEnableState)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_RunSysAverageFrames( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                    LEP_SYS_FRAME_AVERAGE_DIVISOR_E numFrameToAverage )
 {
    LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
 
-   /* Validate Parameter(s)
+   /* Set the requested frames to average
    */
-   if( vidSbNucEnableState >= LEP_VID_END_SBNUC_ENABLE )
+   result = LEP_SetSysFramesToAverage( portDescPtr, numFrameToAverage );
+
+   if( result == LEP_OK )
    {
-      return(LEP_RANGE_ERROR);
+      /* Run the frame averaging command
+      */
+      result = LEP_RunFrameAverage( portDescPtr );
    }
 
-   /* Perform Command
-   ** Writing the Camera's current Scene-Based NUC enable state
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_SBNUC_ENABLE, 
-                              (LEP_ATTRIBUTE_T_PTR)&vidSbNucEnableState,
-                              attributeWordLength);
    return( result );
 }
 
-
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidFreezeEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_VID_FREEZE_ENABLE_E_PTR vidFreezeEnableStatePtr)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysFfcShutterModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                        LEP_SYS_FFC_SHUTTER_MODE_OBJ_T_PTR shutterModeObjPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 16;
 
-   /* Validate Parameter(s)
-   */
-   if( vidFreezeEnableStatePtr == NULL )
+   if( shutterModeObjPtr == NULL )
    {
-      return(LEP_BAD_ARG_POINTER_ERROR);
+      return( LEP_BAD_ARG_POINTER_ERROR );
    }
 
-   /* Perform Command
-   ** Reading the Camera's current video freeze enable state
-   */
    result = LEP_GetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_FREEZE_ENABLE, 
-                              (LEP_ATTRIBUTE_T_PTR)vidFreezeEnableStatePtr,
+                              ( LEP_COMMAND_ID )LEP_CID_SYS_FFC_SHUTTER_MODE_OBJ,
+                              ( LEP_ATTRIBUTE_T_PTR )shutterModeObjPtr,
                               attributeWordLength );
+
    return( result );
 }
 
+LEP_RESULT LeptonSDKEmb32OEM::LEP_SetSysFfcShutterModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                        LEP_SYS_FFC_SHUTTER_MODE_OBJ_T shutterModeObj )
+{
+   LEP_RESULT result = LEP_OK;
+   LEP_UINT16 attributeWordLength = 16;
+
+   result = LEP_SetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_SYS_FFC_SHUTTER_MODE_OBJ,
+                              ( LEP_ATTRIBUTE_T_PTR ) & shutterModeObj,
+                              attributeWordLength );
+
+   return( result );
+}
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidFreezeEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_VID_FREEZE_ENABLE_E vidFreezeEnableState)
+LEP_RESULT LeptonSDKEmb32OEM::LEP_RunSysFFCNormalization( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+   LEP_RESULT result = LEP_OK;
+   LEP_SYS_STATUS_E sysStatus = LEP_SYS_STATUS_BUSY;
 
-   /* Validate Parameter(s)
-   */
-   if( vidFreezeEnableState >= LEP_VID_END_FREEZE_ENABLE )
+   result = LEP_RunCommand( portDescPtr, ( LEP_COMMAND_ID )FLR_CID_SYS_RUN_FFC );
+   while( sysStatus == LEP_SYS_STATUS_BUSY )
    {
-      return(LEP_RANGE_ERROR);
+      LEP_GetSysFFCStatus( portDescPtr, &sysStatus );
    }
 
-   /* Perform Command
-   ** Writing the Camera's current video freeze enable state
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              (LEP_COMMAND_ID)LEP_CID_VID_FREEZE_ENABLE, 
-                              (LEP_ATTRIBUTE_T_PTR)&vidFreezeEnableState,
-                              attributeWordLength);
    return( result );
 }
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidVideoOutputFormat( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_VID_VIDEO_OUTPUT_FORMAT_E_PTR vidVideoOutputFormatPtr )
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetSysBoresightValues( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                      LEP_SYS_BORESIGHT_VALUES_T_PTR boresightValuesPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
+    LEP_RESULT  result = LEP_OK;
+    LEP_UINT16 attributeWordLength = 6;
 
-   /* Validate Parameter(s)
-   */
-   if( vidVideoOutputFormatPtr == NULL )
-   {
-      return( LEP_BAD_ARG_POINTER_ERROR );
-   }
+    if( boresightValuesPtr == NULL )
+    {
+       return( LEP_BAD_ARG_POINTER_ERROR );
+    }
 
-   /* Perform Command
-   ** Reading the Camera's current video output format
-   */
-   result = LEP_GetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_VID_VIDEO_OUTPUT_FORMAT,
-                              ( LEP_ATTRIBUTE_T_PTR )vidVideoOutputFormatPtr,
+    result = LEP_GetAttribute( portDescPtr,
+                              ( LEP_COMMAND_ID )LEP_CID_SYS_BORESIGHT_VALUES,
+                              ( LEP_ATTRIBUTE_T_PTR )boresightValuesPtr,
                               attributeWordLength );
-   return( result );
+
+    return( result );
 }
 
 
-LEP_RESULT LeptonSDKEmb32OEM::LEP_SetVidVideoOutputFormat( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_VID_VIDEO_OUTPUT_FORMAT_E vidVideoOutputFormat )
+/**************************************/
+/*                VID                 */
+LEP_RESULT LeptonSDKEmb32OEM::LEP_GetVidTargetPosition(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                    LEP_VID_TARGET_POSITION_T_PTR targetPositionPtr)
 {
-   LEP_RESULT  result = LEP_OK;
-   LEP_UINT16 attributeWordLength = 2; /* two 16-bit values for 32-bit enum */
-
-   _LEP_data[1] = 0;
-   _LEP_data[0] = (LEP_UINT16) vidVideoOutputFormat;
+   LEP_RESULT result = LEP_OK;
+   LEP_VID_BORESIGHT_COORDINATES_T boresightCoordinates;
 
-   /* Validate Parameter(s)
-   */
-   if( vidVideoOutputFormat >= LEP_END_VID_VIDEO_OUTPUT_FORMAT )
+   if(targetPositionPtr == NULL)
    {
-      return( LEP_RANGE_ERROR );
+      return(LEP_BAD_ARG_POINTER_ERROR);
+   }
+#if (USE_BORESIGHT_MEASUREMENT_FUNCTIONS == 1)
+   result = LEP_GetVidBoresightCoordinates(portDescPtr, &boresightCoordinates);
+   if(result == LEP_OK)
+   {
+      LEP_CalcVidBoresightAlignment(boresightCoordinates, targetPositionPtr);
    }
+#else
+   return(LEP_FUNCTION_NOT_SUPPORTED);
+#endif
 
-   /* Perform Command
-   ** Writing the Camera's current video output format
-   */
-   result = LEP_SetAttribute( portDescPtr,
-                              ( LEP_COMMAND_ID )LEP_CID_VID_VIDEO_OUTPUT_FORMAT,
-                              ( LEP_ATTRIBUTE_T_PTR ) & _LEP_data,
-                              attributeWordLength );
-   return( result );
+   return(result);
 }
 
+
 #if (USE_BORESIGHT_MEASUREMENT_FUNCTIONS == 1)
 
 LEP_RESULT LeptonSDKEmb32OEM::LEP_CalcVidBoresightAlignment(LEP_VID_BORESIGHT_COORDINATES_T boresightCoordinates, LEP_VID_TARGET_POSITION_T_PTR targetPositionPtr)
@@ -6186,9 +3038,18 @@ LEP_RESULT LeptonSDKEmb32OEM::DEV_I2C_MasterInit(LEP_UINT16 portID,
     LEP_RESULT result = LEP_OK;
 
     Wire.begin();
-#if defined(CORE_TEENSY)
-    Wire.setClock(*BaudRate*1000);
+    if (*BaudRate > LEP_I2C_MAX_CLOCK_KHZ) {
+        *BaudRate = LEP_I2C_MAX_CLOCK_KHZ;
+    }
+    Wire.setClock(*BaudRate*1000UL);
+#if defined(LEP_I2C_T3)
     *BaudRate = Wire.getClock()/1000;
+
+    /* Sequence asynchronous commands from the I2C interrupt
+    */
+    Wire.onTransmitDone(AsyncTransmitDone);
+    Wire.onReqFromDone(AsyncRequestDone);
+    Wire.onError(AsyncError);
 #endif
 
     return(result);
@@ -6215,7 +3076,7 @@ LEP_RESULT LeptonSDKEmb32OEM::DEV_I2C_MasterReset(void )
 {
    LEP_RESULT result = LEP_OK;
 
-#if defined(CORE_TEENSY)
+#if defined(LEP_I2C_T3)
   Wire.resetBus();
 #else
   Wire.begin();
@@ -6224,6 +3085,62 @@ LEP_RESULT LeptonSDKEmb32OEM::DEV_I2C_MasterReset(void )
    return(result);
 }
 
+#if defined(LEP_I2C_T3)
+static void PrintReadStatus(LEP_UINT16 regAddress, LEP_UINT32 bytesToRead)
+{
+   i2c_status st;
+   st = Wire.status();
+   Serial.printf("DEV_I2C_MasterReadData requestFrom %d of %d failed with %d - ", regAddress, bytesToRead, st);
+   switch (st) {
+       case I2C_WAITING:
+           Serial.println("WAITING");
+           break;
+       case I2C_TIMEOUT:
+           Serial.println("TIMEOUT");
+           break;
+       case I2C_ADDR_NAK:
+           Serial.println("ADDR_NAK");
+           break;
+       case I2C_DATA_NAK:
+           Serial.println("DATA_NAK");
+           break;
+       case I2C_ARB_LOST:
+           Serial.println("ARB_LOST");
+           break;
+       case I2C_BUF_OVF:
+           Serial.println("BUF_OVF");
+           break;
+       case I2C_NOT_ACQ:
+           Serial.println("NOT_ACQ");
+           break;
+       case I2C_DMA_ERR:
+           Serial.println("DMA_ERR");
+           break;
+       case I2C_SENDING:
+           Serial.println("SENDING");
+           break;
+       case I2C_SEND_ADDR:
+           Serial.println("SEND_ADDR");
+           break;
+       case I2C_RECEIVING:
+           Serial.println("RECEIVING");
+           break;
+       case I2C_SLAVE_TX:
+           Serial.println("SLAVE_TX");
+           break;
+       case I2C_SLAVE_RX:
+           Serial.println("SLAVE_RX");
+           break;
+   }
+}
+#endif
+
+/*
+ * Reads are done in chunks of up to LEP_I2C_CHUNK_WORDS (the Wire library's
+ * buffer size), each its own register address write and read with a stop.  The
+ * Lepton's data registers and block buffer are contiguous so each chunk
+ * starts at the register address after the previous one.
+ */
 LEP_RESULT LeptonSDKEmb32OEM::DEV_I2C_MasterReadData(LEP_UINT16  portID,               // User-defined port ID
                                   LEP_UINT8   deviceAddress,        // Lepton Camera I2C Device Address
                                   LEP_UINT16  regAddress,           // Lepton Register Address
@@ -6238,114 +3155,71 @@ LEP_RESULT LeptonSDKEmb32OEM::DEV_I2C_MasterReadData(LEP_UINT16  portID,
     /* Place Device-Specific Interface here
     */ 
    
-   LEP_UINT32 bytesToRead = wordsToRead << 1;
-   LEP_UINT32 bytesActuallyRead = 0;
-   LEP_UINT16 wordsActuallyRead = 0;
-   LEP_UINT16 *writePtr;
-
+   LEP_UINT32 bytesToRead;
+   LEP_UINT32 bytesActuallyRead;
+   LEP_UINT16 wordsActuallyRead;
+   LEP_UINT16 chunkWords;
+   LEP_UINT16 *writePtr = readDataPtr;
 
-   /*
-     Write the address, which is 2 bytes
+#if defined(LEP_I2C_T3)
+   /* Wait for any queued asynchronous commands to finish with the bus
    */
-   Wire.beginTransmission(deviceAddress);
-   Wire.write(regAddress >> 8);
-   Wire.write(regAddress & 0xFF);
-   *status = Wire.endTransmission();
-//Serial.printf("For reg %d trying %d, ", regAddress, bytesToRead);
-   if (*status != 0) {
-      result = LEP_ERROR;
-   } else {
+   while (asyncState != ASYNC_IDLE) {}
+#endif
+
+   *numWordsRead = 0;
+   *status = 0;
+   while ((result == LEP_OK) && (wordsToRead > 0)) {
+       chunkWords = (wordsToRead > LEP_I2C_CHUNK_WORDS) ? LEP_I2C_CHUNK_WORDS : wordsToRead;
+       bytesToRead = chunkWords << 1;
+
        /*
-             Read back the data at the address written above
+         Write the address, which is 2 bytes
        */
+       Wire.beginTransmission(deviceAddress);
+       Wire.write(regAddress >> 8);
+       Wire.write(regAddress & 0xFF);
+       *status = Wire.endTransmission();
+       if (*status != 0) {
+          result = LEP_ERROR;
+          break;
+       }
 
-#if defined(CORE_TEENSY)
+       /*
+             Read back the data at the address written above directly into
+             the buffer
+       */
+#if defined(LEP_I2C_T3)
        bytesActuallyRead = Wire.requestFrom(deviceAddress, bytesToRead, I2C_STOP);
-#else
-       bytesActuallyRead = Wire.requestFrom((int) deviceAddress, (int) bytesToRead, 1);
-#endif
-#if defined(CORE_TEENSY)
        if (bytesActuallyRead == 0) {
-          i2c_status st;
-          st = Wire.status();
-          Serial.printf("DEV_I2C_MasterReadData requestFrom %d of %d failed with %d - ", regAddress, bytesToRead, st);
-          switch (st) {
-              case I2C_WAITING:
-                  Serial.println("WAITING");
-                  break;
-              case I2C_TIMEOUT:
-                  Serial.println("TIMEOUT");
-                  break;
-              case I2C_ADDR_NAK:
-                  Serial.println("ADDR_NAK");
-                  break;
-              case I2C_DATA_NAK:
-                  Serial.println("DATA_NAK");
-                  break;
-              case I2C_ARB_LOST:
-                  Serial.println("ARB_LOST");
-                  break;
-              case I2C_BUF_OVF:
-                  Serial.println("BUF_OVF");
-                  break;
-              case I2C_NOT_ACQ:
-                  Serial.println("NOT_ACQ");
-                  break;
-              case I2C_DMA_ERR:
-                  Serial.println("DMA_ERR");
-                  break;
-              case I2C_SENDING:
-                  Serial.println("SENDING");
-                  break;
-              case I2C_SEND_ADDR:
-                  Serial.println("SEND_ADDR");
-                  break;
-              case I2C_RECEIVING:
-                  Serial.println("RECEIVING");
-                  break;
-              case I2C_SLAVE_TX:
-                  Serial.println("SLAVE_TX");
-                  break;
-              case I2C_SLAVE_RX:
-                  Serial.println("SLAVE_RX");
-                  break;
-          }
-//       } else {
-//          Serial.printf("read %d\n", bytesActuallyRead);
+          PrintReadStatus(regAddress, bytesToRead);
        }
+       bytesActuallyRead = Wire.read((uint8_t*) writePtr, bytesActuallyRead);
+#else
+       bytesActuallyRead = Wire.requestFrom((int) deviceAddress, (int) bytesToRead, 1);
+       bytesActuallyRead = Wire.readBytes((uint8_t*) writePtr, bytesActuallyRead);
 #endif
-/*
-       if (bytesActuallyRead != bytesToRead)
-       {
-          result = LEP_ERROR;
-       }
-*/
-
-   }
 
-   wordsActuallyRead = (LEP_UINT16)((bytesActuallyRead >> 1) + (bytesActuallyRead & 0x01));
-   *numWordsRead = wordsActuallyRead;
+       wordsActuallyRead = (LEP_UINT16)(bytesActuallyRead >> 1);
+       SwapWords(writePtr, wordsActuallyRead);
+       *numWordsRead += wordsActuallyRead;
+       writePtr += wordsActuallyRead;
 
-   if(result == LEP_OK)
-   {
-       writePtr = readDataPtr;
-       while(wordsActuallyRead--)
-       {
-#if defined(CORE_TEENSY)
-          *writePtr  = Wire.readByte() << 8;
-          *writePtr |= Wire.readByte();
-#else
-          *writePtr  = Wire.read() << 8;
-          *writePtr |= Wire.read();
-#endif
-//Serial.println(*writePtr, HEX);
-          writePtr++;
+       if (wordsActuallyRead != chunkWords) {
+          /* Short read - leave the rest of the buffer */
+          break;
        }
+       wordsToRead -= chunkWords;
+       regAddress += bytesToRead;
    }
 
    return(result);
 }
 
+/*
+ * Writes are done in chunks of up to LEP_I2C_CHUNK_WORDS, each its own
+ * transaction starting at the register address after the previous one.
+ */
 LEP_RESULT LeptonSDKEmb32OEM::DEV_I2C_MasterWriteData(LEP_UINT16  portID,              // User-defined port ID
                                    LEP_UINT8   deviceAddress,       // Lepton Camera I2C Device Address
                                    LEP_UINT16  regAddress,          // Lepton Register Address
@@ -6355,25 +3229,36 @@ LEP_RESULT LeptonSDKEmb32OEM::DEV_I2C_MasterWriteData(LEP_UINT16  portID,
                                    LEP_UINT16 *status)              // Transaction Status
 {
    LEP_RESULT result = LEP_OK;
+   LEP_UINT16 chunkWords;
 
-   *numWordsWritten = wordsToWrite;
-   
-   Wire.beginTransmission(deviceAddress);
-   Wire.write(regAddress >> 8);
-   Wire.write(regAddress & 0xFF);
-//Serial.printf("Writing to %d: ", regAddress);
-   while (wordsToWrite--) {
-       Wire.write(*writeDataPtr >> 8);
-       Wire.write(*writeDataPtr & 0xFF);
-//Serial.printf("0x%4x ", *writeDataPtr);
-       writeDataPtr++;
-   } 
-//Serial.printf("\n");
-   *status = Wire.endTransmission();
+#if defined(LEP_I2C_T3)
+   /* Wait for any queued asynchronous commands to finish with the bus
+   */
+   while (asyncState != ASYNC_IDLE) {}
+#endif
 
-   if (*status != 0) {
-      result = LEP_ERROR;
-   }
+   *numWordsWritten = 0;
+   do {
+       chunkWords = (wordsToWrite > LEP_I2C_CHUNK_WORDS) ? LEP_I2C_CHUNK_WORDS : wordsToWrite;
+
+       Wire.beginTransmission(deviceAddress);
+       Wire.write(regAddress >> 8);
+       Wire.write(regAddress & 0xFF);
+       for (LEP_UINT16 i=0; i<chunkWords; i++) {
+           Wire.write(*writeDataPtr >> 8);
+           Wire.write(*writeDataPtr & 0xFF);
+           writeDataPtr++;
+       }
+       *status = Wire.endTransmission();
+       if (*status != 0) {
+          result = LEP_ERROR;
+          break;
+       }
+
+       *numWordsWritten += chunkWords;
+       wordsToWrite -= chunkWords;
+       regAddress += chunkWords << 1;
+   } while (wordsToWrite > 0);
    
    return(result);
 }
@@ -92,6 +92,7 @@
 #define USE_DEPRECATED_ASICID_INTERFACE         0
 #define USE_DEPRECATED_HOUSING_TCP_INTERFACE    0
 #define USE_BORESIGHT_MEASUREMENT_FUNCTIONS     1
+#define USE_ATTRIBUTE_CACHE                     1
 
 
 /* SDK Constants
@@ -229,6 +230,26 @@
 */
     #define LEPTON_I2C_COMMAND_BUSY_WAIT_COUNT              1000
 
+/* Maximum I2C clock the Lepton supports (kHz)
+*/
+    #define LEP_I2C_MAX_CLOCK_KHZ               1000
+
+/* Teensy 3.x uses the i2c_t3 library (with background transfers).  Teensy 4.x
+** (IMXRT1062) and other boards use the Wire library.
+*/
+#if defined(CORE_TEENSY) && !defined(__IMXRT1062__)
+    #define LEP_I2C_T3
+#endif
+
+/* Largest data transfer in one I2C transaction (16-bit words), limited by
+** the Wire library's buffers (which include the 2 byte register address)
+*/
+#if defined(LEP_I2C_T3)
+    #define LEP_I2C_CHUNK_WORDS                 128
+#else
+    #define LEP_I2C_CHUNK_WORDS                 63
+#endif
+
 /* DEVICE ADDRESSES
 */
 /* The Lepton camera's device address
@@ -1654,6 +1675,113 @@ typedef struct LEP_SYS_BORESIGHT_VALUES_T_TAG
         } LEP_RESPONSE_PACKET_T;
 
 
+/* Asynchronous CCI commands
+*/
+    #define LEP_ASYNC_QUEUE_LENGTH     4
+
+        typedef enum
+        {
+                LEP_ASYNC_GET_ATTRIBUTE = 0,
+                LEP_ASYNC_SET_ATTRIBUTE,
+                LEP_ASYNC_RUN_COMMAND,
+
+                LEP_END_ASYNC_COMMAND_TYPE
+        } LEP_ASYNC_COMMAND_TYPE_E;
+
+        /* Called when a queued command completes.  On the Teensy this runs
+        ** in the I2C interrupt.
+        */
+        typedef void (*LEP_ASYNC_CALLBACK)(LEP_RESULT result, void *arg);
+
+        /* Owned by the caller and must stay valid (along with the attribute
+        ** data) until done is set
+        */
+        typedef struct
+        {
+                LEP_CAMERA_PORT_DESC_T_PTR portDescPtr;
+                LEP_ASYNC_COMMAND_TYPE_E type;
+                LEP_COMMAND_ID commandID;
+                LEP_ATTRIBUTE_T_PTR attributePtr;
+                LEP_UINT16 attributeWordLength;
+
+                LEP_ASYNC_CALLBACK callback;     /* May be NULL */
+                void *callbackArg;
+
+                volatile LEP_BOOL done;
+                volatile LEP_RESULT result;
+
+        } LEP_ASYNC_CMD_T, *LEP_ASYNC_CMD_T_PTR;
+
+
+/* CCI attribute cache
+**   Read-mostly attributes (identification and settings that only change
+**   when the host sets them) are kept after the first successful get when
+**   the cache is enabled with LEP_EnableAttrCache.  Any set, and the reboot,
+**   power down and user defaults restore commands, empty the cache.
+*/
+    #define LEP_ATTR_CACHE_ENTRIES     12
+    #define LEP_ATTR_CACHE_MAX_WORDS   16     /* The part numbers are the largest */
+
+
+/* Attribute descriptors
+**   lep::Attr<commandID, type, words, end> describes a camera attribute at
+**   compile time for LEP_GetAttr/LEP_SetAttr.  end, if non-zero, is the
+**   enum's LEP_END_ value used to range check sets.
+*/
+namespace lep
+{
+        template <LEP_UINT16 CMD, typename T, LEP_UINT16 WORDS = sizeof(T) / 2, unsigned END = 0>
+        struct Attr
+        {
+                typedef T type;
+                static const LEP_UINT16 id = CMD;
+                static const LEP_UINT16 words = WORDS;
+                static const unsigned end = END;
+
+                /* Enums are 32-bit values on the camera (and may be smaller
+                ** here), everything else is transferred in place
+                */
+                static_assert(__is_enum(T) ? (WORDS == 2) : (sizeof(T) == 2 * WORDS),
+                              "attribute word count does not match its type");
+        };
+
+        /* Transfer buffer for an attribute value
+        */
+        template <typename T, bool IS_ENUM = __is_enum(T)>
+        struct AttrData
+        {
+                LEP_ATTRIBUTE_T_PTR ptr;
+
+                AttrData(T *valuePtr) : ptr((LEP_ATTRIBUTE_T_PTR)valuePtr) {}
+                void store(T *) {}
+        };
+
+        template <typename T>
+        struct AttrData<T, true>
+        {
+                LEP_UINT32 data;
+                LEP_ATTRIBUTE_T_PTR ptr;
+
+                AttrData(T *valuePtr) : data((LEP_UINT32)*valuePtr), ptr((LEP_ATTRIBUTE_T_PTR)&data) {}
+                void store(T *valuePtr) { *valuePtr = (T)data; }
+        };
+
+        template <unsigned END>
+        struct AttrRange
+        {
+                template <typename T>
+                static bool valid(const T &value) { return((unsigned)value < END); }
+        };
+
+        template <>
+        struct AttrRange<0>
+        {
+                template <typename T>
+                static bool valid(const T &) { return(true); }
+        };
+}
+
+
 /* Utility
 */
 typedef unsigned short CRC16;
@@ -1703,6 +1831,63 @@ LeptonSDKEmb32OEM();
     LEP_RESULT LEP_RunCommand(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                      LEP_COMMAND_ID commandID);
 
+    /* Attribute cache control.  The cache is disabled until enabled.  It
+    ** must be invalidated if the camera is reset or power cycled through its
+    ** pins rather than by command.
+    */
+    void LEP_EnableAttrCache(LEP_BOOL enable);
+    void LEP_InvalidateAttrCache(void);
+
+    /* Typed attribute access using a lep::Attr descriptor.  Each compiles
+    ** down to a single LEP_GetAttribute/LEP_SetAttribute call.
+    */
+    template <class A>
+    LEP_RESULT LEP_GetAttr(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                           typename A::type *valuePtr)
+    {
+        LEP_RESULT result;
+
+        if( valuePtr == NULL )
+        {
+            return(LEP_BAD_ARG_POINTER_ERROR);
+        }
+
+        lep::AttrData<typename A::type> data(valuePtr);
+        result = LEP_GetAttribute(portDescPtr, A::id, data.ptr, A::words);
+        if( result == LEP_OK )
+        {
+            data.store(valuePtr);
+        }
+        return(result);
+    }
+
+    template <class A>
+    LEP_RESULT LEP_SetAttr(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                           typename A::type value)
+    {
+        if( !lep::AttrRange<A::end>::valid(value) )
+        {
+            return(LEP_RANGE_ERROR);
+        }
+
+        lep::AttrData<typename A::type> data(&value);
+        return(LEP_SetAttribute(portDescPtr, A::id, data.ptr, A::words));
+    }
+
+    /* For large attributes passed by pointer
+    */
+    template <class A>
+    LEP_RESULT LEP_SetAttr(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                           typename A::type *valuePtr)
+    {
+        if( valuePtr == NULL )
+        {
+            return(LEP_BAD_ARG_POINTER_ERROR);
+        }
+
+        return(LEP_SetAttribute(portDescPtr, A::id, (LEP_ATTRIBUTE_T_PTR)valuePtr, A::words));
+    }
+
     LEP_RESULT LEP_DirectWriteBuffer(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                             LEP_ATTRIBUTE_T_PTR attributePtr,
                                             LEP_UINT16 attributeWordLength);
@@ -1725,26 +1910,59 @@ LeptonSDKEmb32OEM();
 /* General AGC Controls
 */
 
+/**
+ * Retrieves the current AGC Enable state from the Camera. The 
+ * AGC enable state turns AGC On (enabled) or OFF (disabled).   
+ * 
+ * @param agcEnableStatePtr
+ *               Pointer to variable to update with the camera's
+ *               current state.
+ *               Range:
+ *                  LEP_AGC_DISABLE=0
+ *                  LEP_AGC_ENABLE =1
+ * 
+ * @return LEP_OK if all goes well, otherwise an error code.
+ */
 LEP_RESULT LEP_GetAgcEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_AGC_ENABLE_E_PTR agcEnableStatePtr );
+                                         LEP_AGC_ENABLE_E_PTR agcEnableStatePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_ENABLE_STATE, LEP_AGC_ENABLE_E, 2> >( portDescPtr, agcEnableStatePtr ) ); }
+
+/**
+ * Sets the current AGC Enable state on the Camera.  The 
+ * AGC enable state turns AGC On (enabled) or OFF (disabled).
+ * 
+ * @param agcEnableState 
+ *             Specifies the enable state to set the camera' AGC
+ *             Range:
+ *                LEP_AGC_DISABLE=0
+ *                LEP_AGC_ENABLE =1
+ * 
+ * @return LEP_OK if all goes well, otherwise an error code.
+ */
 LEP_RESULT LEP_SetAgcEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_AGC_ENABLE_E agcEnableState );
+                                         LEP_AGC_ENABLE_E agcEnableState )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_ENABLE_STATE, LEP_AGC_ENABLE_E, 2, LEP_END_AGC_ENABLE> >( portDescPtr, agcEnableState ) ); }
 
 LEP_RESULT LEP_GetAgcPolicy( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_AGC_POLICY_E_PTR agcPolicyPtr );
+                                    LEP_AGC_POLICY_E_PTR agcPolicyPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_POLICY, LEP_AGC_POLICY_E, 2> >( portDescPtr, agcPolicyPtr ) ); }
 LEP_RESULT LEP_SetAgcPolicy( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                    LEP_AGC_POLICY_E agcPolicy );
+                                    LEP_AGC_POLICY_E agcPolicy )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_POLICY, LEP_AGC_POLICY_E, 2, LEP_END_AGC_POLICY> >( portDescPtr, agcPolicy ) ); }
 
 LEP_RESULT LEP_GetAgcROI( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                 LEP_AGC_ROI_T_PTR agcROIPtr );
+                                 LEP_AGC_ROI_T_PTR agcROIPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_ROI, LEP_AGC_ROI_T, 4> >( portDescPtr, agcROIPtr ) ); }
 LEP_RESULT LEP_SetAgcROI( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                  LEP_AGC_ROI_T agcROI );
 
 LEP_RESULT LEP_GetAgcLinearHistogramClipPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_UINT16 *agcLinearHistogramClipPercentPtr );
+                                                 LEP_UINT16 *agcLinearHistogramClipPercentPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HISTOGRAM_CLIP_PERCENT, LEP_UINT16, 1> >( portDescPtr, agcLinearHistogramClipPercentPtr ) ); }
 
 LEP_RESULT LEP_SetAgcLinearHistogramClipPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_UINT16 agcLinearHistogramClipPercent );
+                                                 LEP_UINT16 agcLinearHistogramClipPercent )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HISTOGRAM_CLIP_PERCENT, LEP_UINT16, 1> >( portDescPtr, agcLinearHistogramClipPercent ) ); }
 
 LEP_RESULT LEP_GetAgcHistogramStatistics( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                  LEP_AGC_HISTOGRAM_STATISTICS_T_PTR *agcHistogramStatisticsPtr );
@@ -1752,9 +1970,11 @@ LEP_RESULT LEP_GetAgcHistogramStatistics( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr
 /* Linear AGC Policy Controls
 */
 LEP_RESULT LEP_GetAgcLinearHistogramTailSize( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                     LEP_UINT16 *agcLinearHistogramTailSizePtr );
+                                                     LEP_UINT16 *agcLinearHistogramTailSizePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HISTOGRAM_TAIL_SIZE, LEP_UINT16, 1> >( portDescPtr, agcLinearHistogramTailSizePtr ) ); }
 LEP_RESULT LEP_SetAgcLinearHistogramTailSize( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                     LEP_UINT16 agcLinearHistogramTailSize );
+                                                     LEP_UINT16 agcLinearHistogramTailSize )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HISTOGRAM_TAIL_SIZE, LEP_UINT16, 1> >( portDescPtr, agcLinearHistogramTailSize ) ); }
 
 LEP_RESULT LEP_GetAgcHistogramClipPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                   LEP_UINT16 *agcLinearClipPercentPtr );
@@ -1762,78 +1982,106 @@ LEP_RESULT LEP_SetAgcHistogramClipPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPt
                                                   LEP_UINT16 agcLinearClipPercent );
 
 LEP_RESULT LEP_GetAgcLinearMaxGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_UINT16 *agcLinearMaxGainPtr );
+                                           LEP_UINT16 *agcLinearMaxGainPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_LINEAR_MAX_GAIN, LEP_UINT16, 1> >( portDescPtr, agcLinearMaxGainPtr ) ); }
 LEP_RESULT LEP_SetAgcLinearMaxGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_UINT16 agcLinearMaxGain );
+                                           LEP_UINT16 agcLinearMaxGain )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_LINEAR_MAX_GAIN, LEP_UINT16, 1> >( portDescPtr, agcLinearMaxGain ) ); }
 
 LEP_RESULT LEP_GetAgcLinearMidPoint( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_UINT16 *agcLinearMidPointPtr );
+                                            LEP_UINT16 *agcLinearMidPointPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_LINEAR_MIDPOINT, LEP_UINT16, 1> >( portDescPtr, agcLinearMidPointPtr ) ); }
 LEP_RESULT LEP_SetAgcLinearMidPoint( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_UINT16 agcLinearMidPoint );
+                                            LEP_UINT16 agcLinearMidPoint )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_LINEAR_MIDPOINT, LEP_UINT16, 1> >( portDescPtr, agcLinearMidPoint ) ); }
 
 LEP_RESULT LEP_GetAgcLinearDampeningFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                   LEP_UINT16 *agcLinearDampeningFactorPtr );
+                                                   LEP_UINT16 *agcLinearDampeningFactorPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_LINEAR_DAMPENING_FACTOR, LEP_UINT16, 1> >( portDescPtr, agcLinearDampeningFactorPtr ) ); }
 LEP_RESULT LEP_SetAgcLinearDampeningFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                   LEP_UINT16 agcLinearDampeningFactor );
+                                                   LEP_UINT16 agcLinearDampeningFactor )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_LINEAR_DAMPENING_FACTOR, LEP_UINT16, 1> >( portDescPtr, agcLinearDampeningFactor ) ); }
 
 /* Heq AGC Policy Controls
 */
 LEP_RESULT LEP_GetAgcHeqDampingFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_UINT16 *agcHeqDampingFactorPtr );
+                                              LEP_UINT16 *agcHeqDampingFactorPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_DAMPENING_FACTOR, LEP_UINT16, 1> >( portDescPtr, agcHeqDampingFactorPtr ) ); }
 LEP_RESULT LEP_SetAgcHeqDampingFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_UINT16 agcHeqDampingFactor );
+                                              LEP_UINT16 agcHeqDampingFactor )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_DAMPENING_FACTOR, LEP_UINT16, 1> >( portDescPtr, agcHeqDampingFactor ) ); }
 
 LEP_RESULT LEP_GetAgcHeqMaxGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_UINT16 *agcHeqMaxGainPtr );
+                                        LEP_UINT16 *agcHeqMaxGainPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_MAX_GAIN, LEP_UINT16, 1> >( portDescPtr, agcHeqMaxGainPtr ) ); }
 LEP_RESULT LEP_SetAgcHeqMaxGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_UINT16 agcHeqMaxGain );
+                                        LEP_UINT16 agcHeqMaxGain )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_MAX_GAIN, LEP_UINT16, 1> >( portDescPtr, agcHeqMaxGain ) ); }
 
 LEP_RESULT LEP_GetAgcHeqClipLimitHigh( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_UINT16 *agcHeqClipLimitHighPtr );
+                                              LEP_UINT16 *agcHeqClipLimitHighPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_CLIP_LIMIT_HIGH, LEP_UINT16, 1> >( portDescPtr, agcHeqClipLimitHighPtr ) ); }
 LEP_RESULT LEP_SetAgcHeqClipLimitHigh( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_UINT16 agcHeqClipLimitHigh );
+                                              LEP_UINT16 agcHeqClipLimitHigh )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_CLIP_LIMIT_HIGH, LEP_UINT16, 1> >( portDescPtr, agcHeqClipLimitHigh ) ); }
 
 LEP_RESULT LEP_GetAgcHeqClipLimitLow( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_UINT16 *agcHeqClipLimitLowPtr );
+                                             LEP_UINT16 *agcHeqClipLimitLowPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_CLIP_LIMIT_LOW, LEP_UINT16, 1> >( portDescPtr, agcHeqClipLimitLowPtr ) ); }
 LEP_RESULT LEP_SetAgcHeqClipLimitLow( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_UINT16 agcHeqClipLimitLow );
+                                             LEP_UINT16 agcHeqClipLimitLow )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_CLIP_LIMIT_LOW, LEP_UINT16, 1> >( portDescPtr, agcHeqClipLimitLow ) ); }
 
 LEP_RESULT LEP_GetAgcHeqBinExtension( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_UINT16 *agcHeqBinExtensionPtr );
+                                             LEP_UINT16 *agcHeqBinExtensionPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_BIN_EXTENSION, LEP_UINT16, 1> >( portDescPtr, agcHeqBinExtensionPtr ) ); }
 LEP_RESULT LEP_SetAgcHeqBinExtension( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_UINT16 agcHeqBinExtension );
+                                             LEP_UINT16 agcHeqBinExtension )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_BIN_EXTENSION, LEP_UINT16, 1> >( portDescPtr, agcHeqBinExtension ) ); }
 
 LEP_RESULT LEP_GetAgcHeqMidPoint( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_UINT16 *agcHeqMidPointPtr );
+                                         LEP_UINT16 *agcHeqMidPointPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_MIDPOINT, LEP_UINT16, 1> >( portDescPtr, agcHeqMidPointPtr ) ); }
 LEP_RESULT LEP_SetAgcHeqMidPoint( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_UINT16 agcHeqMidPoint );
+                                         LEP_UINT16 agcHeqMidPoint )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_MIDPOINT, LEP_UINT16, 1> >( portDescPtr, agcHeqMidPoint ) ); }
 
 LEP_RESULT LEP_GetAgcHeqEmptyCount( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_AGC_HEQ_EMPTY_COUNT_T_PTR emptyCountPtr );
+                                           LEP_AGC_HEQ_EMPTY_COUNT_T_PTR emptyCountPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_EMPTY_COUNTS, LEP_AGC_HEQ_EMPTY_COUNT_T, 1> >( portDescPtr, emptyCountPtr ) ); }
 LEP_RESULT LEP_SetAgcHeqEmptyCount( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_AGC_HEQ_EMPTY_COUNT_T emptyCount );
+                                           LEP_AGC_HEQ_EMPTY_COUNT_T emptyCount )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_EMPTY_COUNTS, LEP_AGC_HEQ_EMPTY_COUNT_T, 1> >( portDescPtr, emptyCount ) ); }
 
 LEP_RESULT LEP_GetAgcHeqNormalizationFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                    LEP_AGC_HEQ_NORMALIZATION_FACTOR_T_PTR normalizationFactorPtr );
+                                                    LEP_AGC_HEQ_NORMALIZATION_FACTOR_T_PTR normalizationFactorPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_NORMALIZATION_FACTOR, LEP_AGC_HEQ_NORMALIZATION_FACTOR_T, 1> >( portDescPtr, normalizationFactorPtr ) ); }
 LEP_RESULT LEP_SetAgcHeqNormalizationFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                    LEP_AGC_HEQ_NORMALIZATION_FACTOR_T normalizationFactor );
+                                                    LEP_AGC_HEQ_NORMALIZATION_FACTOR_T normalizationFactor )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_NORMALIZATION_FACTOR, LEP_AGC_HEQ_NORMALIZATION_FACTOR_T, 1> >( portDescPtr, normalizationFactor ) ); }
 
 LEP_RESULT LEP_GetAgcHeqScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_AGC_HEQ_SCALE_FACTOR_E_PTR scaleFactorPtr );
+                                            LEP_AGC_HEQ_SCALE_FACTOR_E_PTR scaleFactorPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_SCALE_FACTOR, LEP_AGC_HEQ_SCALE_FACTOR_E, 2> >( portDescPtr, scaleFactorPtr ) ); }
 LEP_RESULT LEP_SetAgcHeqScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_AGC_HEQ_SCALE_FACTOR_E scaleFactor );
+                                            LEP_AGC_HEQ_SCALE_FACTOR_E scaleFactor )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_SCALE_FACTOR, LEP_AGC_HEQ_SCALE_FACTOR_E, 2> >( portDescPtr, scaleFactor ) ); }
 
 LEP_RESULT LEP_GetAgcCalcEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_AGC_ENABLE_E_PTR agcCalculationEnableStatePtr );
+                                             LEP_AGC_ENABLE_E_PTR agcCalculationEnableStatePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_CALC_ENABLE_STATE, LEP_AGC_ENABLE_E, 2> >( portDescPtr, agcCalculationEnableStatePtr ) ); }
 
 LEP_RESULT LEP_SetAgcCalcEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_AGC_ENABLE_E agcCalculationEnableState );
+                                             LEP_AGC_ENABLE_E agcCalculationEnableState )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_CALC_ENABLE_STATE, LEP_AGC_ENABLE_E, 2, LEP_END_AGC_ENABLE> >( portDescPtr, agcCalculationEnableState ) ); }
 
 LEP_RESULT LEP_GetAgcHeqLinearPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_UINT16 *agcHeqLinearPercentPtr);
+                                              LEP_UINT16 *agcHeqLinearPercentPtr)
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_AGC_HEQ_LINEAR_PERCENT, LEP_UINT16, 1> >( portDescPtr, agcHeqLinearPercentPtr ) ); }
 
 LEP_RESULT LEP_SetAgcHeqLinearPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_UINT16 agcHeqLinearPercent);
+                                              LEP_UINT16 agcHeqLinearPercent)
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_AGC_HEQ_LINEAR_PERCENT, LEP_UINT16, 1> >( portDescPtr, agcHeqLinearPercent ) ); }
 
 /* I2C_Protocol
 */
@@ -1866,6 +2114,12 @@ LEP_RESULT LEP_SetAgcHeqLinearPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
     LEP_RESULT LEP_I2C_RunCommand(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                          LEP_COMMAND_ID commandID);
 
+    LEP_RESULT LEP_I2C_SubmitCommand(LEP_ASYNC_CMD_T_PTR cmdPtr);
+
+    LEP_RESULT LEP_I2C_WaitCommand(LEP_ASYNC_CMD_T_PTR cmdPtr);
+
+    LEP_BOOL LEP_I2C_AsyncIdle(void);
+
     LEP_RESULT LEP_I2C_ReadData(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr);
 
     LEP_RESULT LEP_I2C_WriteData(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr);
@@ -1926,16 +2180,30 @@ LEP_RESULT LEP_SetAgcHeqLinearPercent( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
 
 /* OEM
 */
-LEP_RESULT LEP_RunOemPowerDown( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
+
+/**
+ * Power Down the Camera by asserting the POWERDOWN condition.
+ * 
+ * @param portDescPtr
+ * 
+ * @return 
+ */
+LEP_RESULT LEP_RunOemPowerDown( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+    { return( LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_OEM_POWER_DOWN ) ); }
 LEP_RESULT LEP_RunOemPowerOn( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
 LEP_RESULT LEP_RunOemStandby( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
-LEP_RESULT LEP_RunOemReboot( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
-LEP_RESULT LEP_RunOemLowPowerMode1( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
-LEP_RESULT LEP_RunOemLowPowerMode2( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
-LEP_RESULT LEP_RunOemBit( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
+LEP_RESULT LEP_RunOemReboot( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+    { return( LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_OEM_REBOOT ) ); }
+LEP_RESULT LEP_RunOemLowPowerMode1( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+    { return( LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_OEM_LOW_POWER_MODE_1 ) ); }
+LEP_RESULT LEP_RunOemLowPowerMode2( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+    { return( LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_OEM_LOW_POWER_MODE_2 ) ); }
+LEP_RESULT LEP_RunOemBit( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+    { return( LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_OEM_BIT_TEST ) ); }
 
 LEP_RESULT LEP_GetOemMaskRevision( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_OEM_MASK_REVISION_T *oemMaskRevisionPtr );
+                                          LEP_OEM_MASK_REVISION_T *oemMaskRevisionPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_MASK_REVISION, LEP_OEM_MASK_REVISION_T, 1> >( portDescPtr, oemMaskRevisionPtr ) ); }
    #if 0
 LEP_RESULT LEP_GetOemMasterID( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                      LEP_OEM_MASTER_ID_T_PTR oemMasterIDPtr );
@@ -1955,7 +2223,8 @@ LEP_RESULT LEP_GetOemCustPartNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                             LEP_OEM_PART_NUMBER_T_PTR oemPartNumberPtr );
    #endif
 LEP_RESULT LEP_GetOemSoftwareVersion( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_OEM_SW_VERSION_T *oemSoftwareVersionPtr );
+                                             LEP_OEM_SW_VERSION_T *oemSoftwareVersionPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_SOFTWARE_VERSION, LEP_OEM_SW_VERSION_T, 4> >( portDescPtr, oemSoftwareVersionPtr ) ); }
 
    #if 0
 LEP_RESULT LEP_GetOemVendorID(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
@@ -1963,69 +2232,93 @@ LEP_RESULT LEP_GetOemVendorID(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
    #endif
 
 LEP_RESULT LEP_GetOemVideoOutputEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_OEM_VIDEO_OUTPUT_ENABLE_E_PTR oemVideoOutputEnablePtr );
+                                               LEP_OEM_VIDEO_OUTPUT_ENABLE_E_PTR oemVideoOutputEnablePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_ENABLE, LEP_OEM_VIDEO_OUTPUT_ENABLE_E, 2> >( portDescPtr, oemVideoOutputEnablePtr ) ); }
 LEP_RESULT LEP_SetOemVideoOutputEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_OEM_VIDEO_OUTPUT_ENABLE_E oemVideoOutputEnable );
+                                               LEP_OEM_VIDEO_OUTPUT_ENABLE_E oemVideoOutputEnable )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_ENABLE, LEP_OEM_VIDEO_OUTPUT_ENABLE_E, 2, LEP_END_VIDEO_OUTPUT_ENABLE> >( portDescPtr, oemVideoOutputEnable ) ); }
 
 LEP_RESULT LEP_GetOemVideoOutputFormat( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_OEM_VIDEO_OUTPUT_FORMAT_E_PTR oemVideoOutputFormatPtr );
+                                               LEP_OEM_VIDEO_OUTPUT_FORMAT_E_PTR oemVideoOutputFormatPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_FORMAT, LEP_OEM_VIDEO_OUTPUT_FORMAT_E, 2> >( portDescPtr, oemVideoOutputFormatPtr ) ); }
 LEP_RESULT LEP_SetOemVideoOutputFormat( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_OEM_VIDEO_OUTPUT_FORMAT_E oemVideoOutputFormat );
+                                               LEP_OEM_VIDEO_OUTPUT_FORMAT_E oemVideoOutputFormat )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_FORMAT, LEP_OEM_VIDEO_OUTPUT_FORMAT_E, 2, LEP_END_VIDEO_OUTPUT_FORMAT> >( portDescPtr, oemVideoOutputFormat ) ); }
 LEP_RESULT LEP_GetOemVideoOutputSource( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_OEM_VIDEO_OUTPUT_SOURCE_E_PTR oemVideoOutputSourcePtr );
+                                               LEP_OEM_VIDEO_OUTPUT_SOURCE_E_PTR oemVideoOutputSourcePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_SOURCE, LEP_OEM_VIDEO_OUTPUT_SOURCE_E, 2> >( portDescPtr, oemVideoOutputSourcePtr ) ); }
 LEP_RESULT LEP_SetOemVideoOutputSource( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_OEM_VIDEO_OUTPUT_SOURCE_E oemVideoOutputSource );
+                                               LEP_OEM_VIDEO_OUTPUT_SOURCE_E oemVideoOutputSource )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_SOURCE, LEP_OEM_VIDEO_OUTPUT_SOURCE_E, 2, LEP_END_VIDEO_OUTPUT_SOURCE> >( portDescPtr, oemVideoOutputSource ) ); }
 LEP_RESULT LEP_GetOemVideoOutputSourceConstant( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                       LEP_UINT16 *oemVideoOutputSourceConstant );
+                                                       LEP_UINT16 *oemVideoOutputSourceConstant )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_CONSTANT, LEP_UINT16, 1> >( portDescPtr, oemVideoOutputSourceConstant ) ); }
 LEP_RESULT LEP_SetOemVideoOutputSourceConstant( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                       LEP_UINT16 oemVideoOutputSourceConstant );
+                                                       LEP_UINT16 oemVideoOutputSourceConstant )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_CONSTANT, LEP_UINT16, 1> >( portDescPtr, oemVideoOutputSourceConstant ) ); }
 
 
 LEP_RESULT LEP_GetOemVideoOutputChannel( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_OEM_VIDEO_OUTPUT_CHANNEL_E_PTR oemVideoOutputChannelPtr );
+                                                LEP_OEM_VIDEO_OUTPUT_CHANNEL_E_PTR oemVideoOutputChannelPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_CHANNEL, LEP_OEM_VIDEO_OUTPUT_CHANNEL_E, 2> >( portDescPtr, oemVideoOutputChannelPtr ) ); }
 LEP_RESULT LEP_SetOemVideoOutputChannel( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_OEM_VIDEO_OUTPUT_CHANNEL_E oemVideoOutputChannel );
+                                                LEP_OEM_VIDEO_OUTPUT_CHANNEL_E oemVideoOutputChannel )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_OEM_VIDEO_OUTPUT_CHANNEL, LEP_OEM_VIDEO_OUTPUT_CHANNEL_E, 2, LEP_END_VIDEO_OUTPUT_CHANNEL> >( portDescPtr, oemVideoOutputChannel ) ); }
 
 LEP_RESULT LEP_GetOemVideoGammaEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_OEM_VIDEO_GAMMA_ENABLE_E_PTR oemVideoGammaEnablePtr );
+                                              LEP_OEM_VIDEO_GAMMA_ENABLE_E_PTR oemVideoGammaEnablePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_VIDEO_GAMMA_ENABLE, LEP_OEM_VIDEO_GAMMA_ENABLE_E, 2> >( portDescPtr, oemVideoGammaEnablePtr ) ); }
 LEP_RESULT LEP_SetOemVideoGammaEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_OEM_VIDEO_GAMMA_ENABLE_E oemVideoGammaEnable );
+                                              LEP_OEM_VIDEO_GAMMA_ENABLE_E oemVideoGammaEnable )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_OEM_VIDEO_GAMMA_ENABLE, LEP_OEM_VIDEO_GAMMA_ENABLE_E, 2, LEP_END_VIDEO_GAMMA_ENABLE> >( portDescPtr, oemVideoGammaEnable ) ); }
 
 LEP_RESULT LEP_GetOemCalStatus( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_OEM_STATUS_E_PTR calStatusPtr );
+                                       LEP_OEM_STATUS_E_PTR calStatusPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_STATUS, LEP_OEM_STATUS_E, 2> >( portDescPtr, calStatusPtr ) ); }
 
 LEP_RESULT LEP_GetOemFFCNormalizationTarget( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                    LEP_OEM_FFC_NORMALIZATION_TARGET_T_PTR ffcTargetPtr );
+                                                    LEP_OEM_FFC_NORMALIZATION_TARGET_T_PTR ffcTargetPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_FFC_NORMALIZATION_TARGET, LEP_OEM_FFC_NORMALIZATION_TARGET_T, 1> >( portDescPtr, ffcTargetPtr ) ); }
 LEP_RESULT LEP_SetOemFFCNormalizationTarget( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                    LEP_OEM_FFC_NORMALIZATION_TARGET_T ffcTarget );
+                                                    LEP_OEM_FFC_NORMALIZATION_TARGET_T ffcTarget )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_OEM_FFC_NORMALIZATION_TARGET, LEP_OEM_FFC_NORMALIZATION_TARGET_T, 1> >( portDescPtr, ffcTarget ) ); }
 LEP_RESULT LEP_RunOemFFCNormalization( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                               LEP_OEM_FFC_NORMALIZATION_TARGET_T ffcTarget );
 
 LEP_RESULT LEP_GetOemFrameMean( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_OEM_FRAME_AVERAGE_T_PTR frameAveragePtr );
+                                       LEP_OEM_FRAME_AVERAGE_T_PTR frameAveragePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_SCENE_MEAN_VALUE, LEP_OEM_FRAME_AVERAGE_T, 1> >( portDescPtr, frameAveragePtr ) ); }
 
 LEP_RESULT LEP_GetOemPowerMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_OEM_POWER_STATE_E_PTR powerModePtr );
+                                       LEP_OEM_POWER_STATE_E_PTR powerModePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_POWER_MODE, LEP_OEM_POWER_STATE_E, 2> >( portDescPtr, powerModePtr ) ); }
 LEP_RESULT LEP_SetOemPowerMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_OEM_POWER_STATE_E powerMode );
+                                       LEP_OEM_POWER_STATE_E powerMode )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_OEM_POWER_MODE, LEP_OEM_POWER_STATE_E, 2, LEP_OEM_END_POWER_MODE> >( portDescPtr, powerMode ) ); }
 
 LEP_RESULT LEP_RunOemFFC( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
 
 
 LEP_RESULT LEP_GetOemGpioMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_OEM_GPIO_MODE_E_PTR gpioModePtr );
+                                      LEP_OEM_GPIO_MODE_E_PTR gpioModePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_GPIO_MODE_SELECT, LEP_OEM_GPIO_MODE_E, 2> >( portDescPtr, gpioModePtr ) ); }
 LEP_RESULT LEP_SetOemGpioMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_OEM_GPIO_MODE_E gpioMode );
+                                      LEP_OEM_GPIO_MODE_E gpioMode )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_OEM_GPIO_MODE_SELECT, LEP_OEM_GPIO_MODE_E, 2, LEP_OEM_END_GPIO_MODE> >( portDescPtr, gpioMode ) ); }
 LEP_RESULT LEP_GetOemGpioVsyncPhaseDelay( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_OEM_VSYNC_DELAY_E_PTR numHsyncLinesPtr );
+                                                 LEP_OEM_VSYNC_DELAY_E_PTR numHsyncLinesPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_GPIO_VSYNC_PHASE_DELAY, LEP_OEM_VSYNC_DELAY_E, 2> >( portDescPtr, numHsyncLinesPtr ) ); }
 LEP_RESULT LEP_SetOemGpioVsyncPhaseDelay( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                  LEP_OEM_VSYNC_DELAY_E numHsyncLines );
 
 
 LEP_RESULT LEP_GetOemUserDefaultsState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_OEM_USER_PARAMS_STATE_E_PTR userParamsStatePtr );
-LEP_RESULT LEP_RunOemUserDefaultsCopyToOtp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
-LEP_RESULT LEP_RunOemUserDefaultsRestore( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
+                                               LEP_OEM_USER_PARAMS_STATE_E_PTR userParamsStatePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_USER_DEFAULTS, LEP_OEM_USER_PARAMS_STATE_E, 2> >( portDescPtr, userParamsStatePtr ) ); }
+LEP_RESULT LEP_RunOemUserDefaultsCopyToOtp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+    { return( LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_OEM_USER_DEFAULTS ) ); }
+LEP_RESULT LEP_RunOemUserDefaultsRestore( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+    { return( LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_OEM_USER_DEFAULTS_RESTORE ) ); }
 
 
 
@@ -2036,7 +2329,8 @@ LEP_RESULT LEP_SetOemThermalShutdownEnable( LEP_CAMERA_PORT_DESC_T_PTR portDescP
                                                    LEP_OEM_THERMAL_SHUTDOWN_ENABLE_T ThermalShutdownEnableState );
 
 LEP_RESULT LEP_GetOemShutterProfileObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_OEM_SHUTTER_PROFILE_OBJ_T_PTR ShutterProfileObjPtr );
+                                               LEP_OEM_SHUTTER_PROFILE_OBJ_T_PTR ShutterProfileObjPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_OEM_SHUTTER_PROFILE_OBJ, LEP_OEM_SHUTTER_PROFILE_OBJ_T, 2> >( portDescPtr, ShutterProfileObjPtr ) ); }
 
 LEP_RESULT LEP_SetOemShutterProfileObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                LEP_OEM_SHUTTER_PROFILE_OBJ_T ShutterProfileObj );
@@ -2067,55 +2361,71 @@ LEP_RESULT LEP_SetOemPixelNoiseSettings( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
 
 /* RAD
 */
+
+/**************************************/
 LEP_RESULT LEP_GetRadTShutterMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_RAD_TS_MODE_E_PTR radTShutterModePtr );
+                                          LEP_RAD_TS_MODE_E_PTR radTShutterModePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TSHUTTER_MODE, LEP_RAD_TS_MODE_E, 2> >( portDescPtr, radTShutterModePtr ) ); }
 
 LEP_RESULT LEP_SetRadTShutterMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_RAD_TS_MODE_E radTShutterMode );
+                                          LEP_RAD_TS_MODE_E radTShutterMode )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TSHUTTER_MODE, LEP_RAD_TS_MODE_E, 2, LEP_RAD_TS_END_TS_MODE> >( portDescPtr, radTShutterMode ) ); }
 
 LEP_RESULT LEP_GetRadTShutter( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_RAD_KELVIN_T_PTR radTShutterPtr );
+                                      LEP_RAD_KELVIN_T_PTR radTShutterPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TSHUTTER, LEP_RAD_KELVIN_T, 1> >( portDescPtr, radTShutterPtr ) ); }
 
 LEP_RESULT LEP_SetRadTShutter( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_RAD_KELVIN_T radTShutter );
+                                      LEP_RAD_KELVIN_T radTShutter )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TSHUTTER, LEP_RAD_KELVIN_T, 1> >( portDescPtr, radTShutter ) ); }
 
 LEP_RESULT LEP_RunRadFFC( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
 
 LEP_RESULT LEP_GetRadRBFOInternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr );
+                                           LEP_RBFO_T_PTR radRBFOPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RBFO_INTERNAL, LEP_RBFO_T, 8> >( portDescPtr, radRBFOPtr ) ); }
 
 LEP_RESULT LEP_SetRadRBFOInternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                            LEP_RBFO_T_PTR radRBFOPtr );
 
 LEP_RESULT LEP_GetRadRBFOExternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_RBFO_T_PTR radRBFOPtr );
+                                           LEP_RBFO_T_PTR radRBFOPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RBFO_EXTERNAL, LEP_RBFO_T, 8> >( portDescPtr, radRBFOPtr ) ); }
 
 LEP_RESULT LEP_SetRadRBFOExternal0( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                            LEP_RBFO_T_PTR radRBFOPtr );
 
 LEP_RESULT LEP_GetRadResponsivityShift( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_RAD_RS_T_PTR radResponsivityShiftPtr );
+                                               LEP_RAD_RS_T_PTR radResponsivityShiftPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RESPONSIVITY_SHIFT, LEP_RAD_RS_T, 1> >( portDescPtr, radResponsivityShiftPtr ) ); }
 
 LEP_RESULT LEP_SetRadResponsivityShift( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_RAD_RS_T radResponsivityShift );
+                                               LEP_RAD_RS_T radResponsivityShift )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_RESPONSIVITY_SHIFT, LEP_RAD_RS_T, 1> >( portDescPtr, radResponsivityShift ) ); }
 
 LEP_RESULT LEP_GetRadFNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_FNUMBER_T_PTR radFNumberPtr );
+                                     LEP_RAD_FNUMBER_T_PTR radFNumberPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_F_NUMBER, LEP_RAD_FNUMBER_T, 1> >( portDescPtr, radFNumberPtr ) ); }
 
 LEP_RESULT LEP_SetRadFNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_FNUMBER_T radFNumber );
+                                     LEP_RAD_FNUMBER_T radFNumber )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_F_NUMBER, LEP_RAD_FNUMBER_T, 1> >( portDescPtr, radFNumber ) ); }
 
 LEP_RESULT LEP_GetRadTauLens( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_TAULENS_T_PTR radTauLensPtr );
+                                     LEP_RAD_TAULENS_T_PTR radTauLensPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TAU_LENS, LEP_RAD_TAULENS_T, 1> >( portDescPtr, radTauLensPtr ) ); }
 
 LEP_RESULT LEP_SetRadTauLens( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_TAULENS_T radTauLens );
+                                     LEP_RAD_TAULENS_T radTauLens )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TAU_LENS, LEP_RAD_TAULENS_T, 1> >( portDescPtr, radTauLens ) ); }
 
 LEP_RESULT LEP_GetRadRadometryFilter( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_RAD_RADIOMETRY_FILTER_T_PTR radRadiometryFilterPtr );
+                                             LEP_RAD_RADIOMETRY_FILTER_T_PTR radRadiometryFilterPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RADIOMETRY_FILTER, LEP_RAD_RADIOMETRY_FILTER_T, 1> >( portDescPtr, radRadiometryFilterPtr ) ); }
 
 LEP_RESULT LEP_SetRadRadometryFilter( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_RAD_RADIOMETRY_FILTER_T radRadiometryFilter );
+                                             LEP_RAD_RADIOMETRY_FILTER_T radRadiometryFilter )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_RADIOMETRY_FILTER, LEP_RAD_RADIOMETRY_FILTER_T, 1> >( portDescPtr, radRadiometryFilter ) ); }
 
 /* Deprecated: Use LEP_GetRadTFpaLut */
 LEP_RESULT LEP_GetRadTFpaCLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
@@ -2149,58 +2459,75 @@ LEP_RESULT LEP_SetRadResponsivityValueLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPt
                                                   LEP_RAD_LUT128_T_PTR radResponsivityValueLutPtr );
 
 LEP_RESULT LEP_GetRadDebugTemp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_RAD_KELVIN_T_PTR radDebugTempPtr );
+                                       LEP_RAD_KELVIN_T_PTR radDebugTempPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_DEBUG_TEMP, LEP_RAD_KELVIN_T, 1> >( portDescPtr, radDebugTempPtr ) ); }
 
 LEP_RESULT LEP_SetRadDebugTemp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_RAD_KELVIN_T radDebugTemp );
+                                       LEP_RAD_KELVIN_T radDebugTemp )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_DEBUG_TEMP, LEP_RAD_KELVIN_T, 1> >( portDescPtr, radDebugTemp ) ); }
 
 LEP_RESULT LEP_GetRadDebugFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_RAD_FLUX_T_PTR radDebugFluxPtr );
+                                       LEP_RAD_FLUX_T_PTR radDebugFluxPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_DEBUG_FLUX, LEP_RAD_FLUX_T, 2> >( portDescPtr, radDebugFluxPtr ) ); }
 
 LEP_RESULT LEP_SetRadDebugFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                        LEP_RAD_FLUX_T radDebugFlux );
 
 LEP_RESULT LEP_GetRadEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_RAD_ENABLE_E_PTR radEnableStatePtr );
+                                         LEP_RAD_ENABLE_E_PTR radEnableStatePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_ENABLE_STATE, LEP_RAD_ENABLE_E, 2> >( portDescPtr, radEnableStatePtr ) ); }
 
 LEP_RESULT LEP_SetRadEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_RAD_ENABLE_E radEnableState );
+                                         LEP_RAD_ENABLE_E radEnableState )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_ENABLE_STATE, LEP_RAD_ENABLE_E, 2> >( portDescPtr, radEnableState ) ); }
 
 LEP_RESULT LEP_GetRadGlobalGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_RAD_GLOBAL_GAIN_T_PTR radGlobalGainPtr );
+                                        LEP_RAD_GLOBAL_GAIN_T_PTR radGlobalGainPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_GLOBAL_GAIN, LEP_RAD_GLOBAL_GAIN_T, 1> >( portDescPtr, radGlobalGainPtr ) ); }
 
 LEP_RESULT LEP_SetRadGlobalGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_RAD_GLOBAL_GAIN_T radGlobalGain );
+                                        LEP_RAD_GLOBAL_GAIN_T radGlobalGain )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_GLOBAL_GAIN, LEP_RAD_GLOBAL_GAIN_T, 1> >( portDescPtr, radGlobalGain ) ); }
 
 LEP_RESULT LEP_GetRadGlobalOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_RAD_GLOBAL_OFFSET_T_PTR radGlobalOffsetPtr );
+                                          LEP_RAD_GLOBAL_OFFSET_T_PTR radGlobalOffsetPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_GLOBAL_OFFSET, LEP_RAD_GLOBAL_OFFSET_T, 1> >( portDescPtr, radGlobalOffsetPtr ) ); }
 
 LEP_RESULT LEP_SetRadGlobalOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_RAD_GLOBAL_OFFSET_T radGlobalOffset );
+                                          LEP_RAD_GLOBAL_OFFSET_T radGlobalOffset )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_GLOBAL_OFFSET, LEP_RAD_GLOBAL_OFFSET_T, 1> >( portDescPtr, radGlobalOffset ) ); }
 
 LEP_RESULT LEP_GetRadTFpaCtsMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_RAD_TEMPERATURE_UPDATE_E_PTR radTFpaCtsModePtr );
+                                         LEP_RAD_TEMPERATURE_UPDATE_E_PTR radTFpaCtsModePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TFPA_CTS_MODE, LEP_RAD_TEMPERATURE_UPDATE_E, 2> >( portDescPtr, radTFpaCtsModePtr ) ); }
 
 LEP_RESULT LEP_SetRadTFpaCtsMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_RAD_TEMPERATURE_UPDATE_E radTFpaCtsMode );
+                                         LEP_RAD_TEMPERATURE_UPDATE_E radTFpaCtsMode )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TFPA_CTS_MODE, LEP_RAD_TEMPERATURE_UPDATE_E, 2> >( portDescPtr, radTFpaCtsMode ) ); }
 
 LEP_RESULT LEP_GetRadTAuxCtsMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_RAD_TEMPERATURE_UPDATE_E_PTR radTAuxCtsModePtr );
+                                         LEP_RAD_TEMPERATURE_UPDATE_E_PTR radTAuxCtsModePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TAUX_CTS_MODE, LEP_RAD_TEMPERATURE_UPDATE_E, 2> >( portDescPtr, radTAuxCtsModePtr ) ); }
 
 LEP_RESULT LEP_SetRadTAuxCtsMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_RAD_TEMPERATURE_UPDATE_E radTAuxCtsMode );
+                                         LEP_RAD_TEMPERATURE_UPDATE_E radTAuxCtsMode )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TAUX_CTS_MODE, LEP_RAD_TEMPERATURE_UPDATE_E, 2> >( portDescPtr, radTAuxCtsMode ) ); }
 
 LEP_RESULT LEP_GetRadTFpaCts( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_TEMPERATURE_COUNTS_T_PTR radTFpaCtsPtr );
+                                     LEP_RAD_TEMPERATURE_COUNTS_T_PTR radTFpaCtsPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TFPA_CTS, LEP_RAD_TEMPERATURE_COUNTS_T, 1> >( portDescPtr, radTFpaCtsPtr ) ); }
 
 LEP_RESULT LEP_SetRadTFpaCts( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_TEMPERATURE_COUNTS_T radTFpaCts );
+                                     LEP_RAD_TEMPERATURE_COUNTS_T radTFpaCts )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TFPA_CTS, LEP_RAD_TEMPERATURE_COUNTS_T, 1> >( portDescPtr, radTFpaCts ) ); }
 
 LEP_RESULT LEP_GetRadTAuxCts( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_TEMPERATURE_COUNTS_T_PTR radTAuxCtsPtr );
+                                     LEP_RAD_TEMPERATURE_COUNTS_T_PTR radTAuxCtsPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TAUX_CTS, LEP_RAD_TEMPERATURE_COUNTS_T, 1> >( portDescPtr, radTAuxCtsPtr ) ); }
 
 LEP_RESULT LEP_SetRadTAuxCts( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_TEMPERATURE_COUNTS_T radTAuxCts );
+                                     LEP_RAD_TEMPERATURE_COUNTS_T radTAuxCts )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TAUX_CTS, LEP_RAD_TEMPERATURE_COUNTS_T, 1> >( portDescPtr, radTAuxCts ) ); }
 
 LEP_RESULT LEP_GetRadTEqShutterLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                            LEP_RAD_LUT128_T_PTR radTEqShutterLutPtr );
@@ -2209,22 +2536,26 @@ LEP_RESULT LEP_SetRadTEqShutterLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                            LEP_RAD_LUT128_T_PTR radTEqShutterLutPtr );
 
 LEP_RESULT LEP_GetRadRunStatus( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_RAD_STATUS_E_PTR radStatusPtr );
+                                       LEP_RAD_STATUS_E_PTR radStatusPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RUN_STATUS, LEP_RAD_STATUS_E, 2> >( portDescPtr, radStatusPtr ) ); }
 
 LEP_RESULT LEP_GetRadTEqShutterFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_FLUX_T_PTR radTEqShutterFluxPtr );
+                                            LEP_RAD_FLUX_T_PTR radTEqShutterFluxPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TEQ_SHUTTER_FLUX, LEP_RAD_FLUX_T, 2> >( portDescPtr, radTEqShutterFluxPtr ) ); }
 
 LEP_RESULT LEP_SetRadTEqShutterFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                             LEP_RAD_FLUX_T radTEqShutterFlux );
 
 LEP_RESULT LEP_GetRadMffcFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_RAD_FLUX_T_PTR radRadMffcFluxPtr  );
+                                      LEP_RAD_FLUX_T_PTR radRadMffcFluxPtr  )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_MFFC_FLUX, LEP_RAD_FLUX_T, 2> >( portDescPtr, radRadMffcFluxPtr ) ); }
 
 LEP_RESULT LEP_SetRadMffcFlux( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                       LEP_RAD_FLUX_T radRadMffcFlux );
 
 LEP_RESULT LEP_GetRadFrameMedianPixelValue( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                   LEP_RAD_MEDIAN_VALUE_T_PTR frameMedianPtr );
+                                                   LEP_RAD_MEDIAN_VALUE_T_PTR frameMedianPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_FRAME_MEDIAN_VALUE, LEP_RAD_MEDIAN_VALUE_T, 1> >( portDescPtr, frameMedianPtr ) ); }
 
 LEP_RESULT LEP_GetRadMLGLut( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                     LEP_RAD_SIGNED_LUT128_T_PTR radMLGLutPtr );
@@ -2246,120 +2577,160 @@ LEP_RESULT LEP_SetRadHousingTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
 
 
 LEP_RESULT LEP_GetRadShutterTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR radShutterTcp );
+                                        LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR radShutterTcp )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_SHUTTER_TCP, LEP_RAD_LINEAR_TEMP_CORRECTION_T, 4> >( portDescPtr, radShutterTcp ) ); }
 
 LEP_RESULT LEP_SetRadShutterTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                         LEP_RAD_LINEAR_TEMP_CORRECTION_T radShutterTcp );
 
 LEP_RESULT LEP_GetRadLensTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                     LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR radLensTcp );
+                                     LEP_RAD_LINEAR_TEMP_CORRECTION_T_PTR radLensTcp )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_LENS_TCP, LEP_RAD_LINEAR_TEMP_CORRECTION_T, 4> >( portDescPtr, radLensTcp ) ); }
 
 LEP_RESULT LEP_SetRadLensTcp( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                      LEP_RAD_LINEAR_TEMP_CORRECTION_T radLensTcp );
 
 LEP_RESULT LEP_GetRadPreviousGlobalOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                  LEP_RAD_GLOBAL_OFFSET_T_PTR globalOffsetPtr );
+                                                  LEP_RAD_GLOBAL_OFFSET_T_PTR globalOffsetPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_PREVIOUS_GLOBAL_OFFSET, LEP_RAD_GLOBAL_OFFSET_T, 1> >( portDescPtr, globalOffsetPtr ) ); }
 
 LEP_RESULT LEP_GetRadPreviousGlobalGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_RAD_GLOBAL_GAIN_T_PTR globalGainPtr );
+                                                LEP_RAD_GLOBAL_GAIN_T_PTR globalGainPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_PREVIOUS_GLOBAL_GAIN, LEP_RAD_GLOBAL_GAIN_T, 1> >( portDescPtr, globalGainPtr ) ); }
 
 LEP_RESULT LEP_GetGlobalGainFFC( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_RAD_GLOBAL_GAIN_T_PTR globalGainFfcPtr );
+                                        LEP_RAD_GLOBAL_GAIN_T_PTR globalGainFfcPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_GLOBAL_GAIN_FFC, LEP_RAD_GLOBAL_GAIN_T, 1> >( portDescPtr, globalGainFfcPtr ) ); }
 
 LEP_RESULT LEP_GetRadCnfScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_PARAMETER_SCALE_FACTOR_T_PTR scaleFactorPtr );
+                                            LEP_RAD_PARAMETER_SCALE_FACTOR_T_PTR scaleFactorPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_CNF_SCALE_FACTOR, LEP_RAD_PARAMETER_SCALE_FACTOR_T, 1> >( portDescPtr, scaleFactorPtr ) ); }
 LEP_RESULT LEP_GetRadTnfScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_PARAMETER_SCALE_FACTOR_T_PTR scaleFactorPtr );
+                                            LEP_RAD_PARAMETER_SCALE_FACTOR_T_PTR scaleFactorPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TNF_SCALE_FACTOR, LEP_RAD_PARAMETER_SCALE_FACTOR_T, 1> >( portDescPtr, scaleFactorPtr ) ); }
 LEP_RESULT LEP_GetRadSnfScaleFactor( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_PARAMETER_SCALE_FACTOR_T_PTR scaleFactorPtr );
+                                            LEP_RAD_PARAMETER_SCALE_FACTOR_T_PTR scaleFactorPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_SNF_SCALE_FACTOR, LEP_RAD_PARAMETER_SCALE_FACTOR_T, 1> >( portDescPtr, scaleFactorPtr ) ); }
 
 LEP_RESULT LEP_GetRadArbitraryOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_RAD_ARBITRARY_OFFSET_T_PTR arbitraryOffsetPtr );
+                                             LEP_RAD_ARBITRARY_OFFSET_T_PTR arbitraryOffsetPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_ARBITRARY_OFFSET, LEP_RAD_ARBITRARY_OFFSET_T, 1> >( portDescPtr, arbitraryOffsetPtr ) ); }
 LEP_RESULT LEP_SetRadArbitraryOffset( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_RAD_ARBITRARY_OFFSET_T arbitraryOffset );
+                                             LEP_RAD_ARBITRARY_OFFSET_T arbitraryOffset )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_ARBITRARY_OFFSET, LEP_RAD_ARBITRARY_OFFSET_T, 1> >( portDescPtr, arbitraryOffset ) ); }
 
 LEP_RESULT LEP_GetRadFluxLinearParams( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_RAD_FLUX_LINEAR_PARAMS_T_PTR fluxParamsPtr );
+                                              LEP_RAD_FLUX_LINEAR_PARAMS_T_PTR fluxParamsPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_FLUX_LINEAR_PARAMS, LEP_RAD_FLUX_LINEAR_PARAMS_T, 8> >( portDescPtr, fluxParamsPtr ) ); }
 
 LEP_RESULT LEP_SetRadFluxLinearParams( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_RAD_FLUX_LINEAR_PARAMS_T fluxParams );
+                                              LEP_RAD_FLUX_LINEAR_PARAMS_T fluxParams )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_FLUX_LINEAR_PARAMS, LEP_RAD_FLUX_LINEAR_PARAMS_T, 8> >( portDescPtr, fluxParams ) ); }
 
 LEP_RESULT LEP_GetRadTLinearEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_RAD_ENABLE_E_PTR enableStatePtr );
+                                                LEP_RAD_ENABLE_E_PTR enableStatePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TLINEAR_ENABLE_STATE, LEP_RAD_ENABLE_E, 2> >( portDescPtr, enableStatePtr ) ); }
 
 LEP_RESULT LEP_SetRadTLinearEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_RAD_ENABLE_E enableState );
+                                                LEP_RAD_ENABLE_E enableState )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TLINEAR_ENABLE_STATE, LEP_RAD_ENABLE_E, 2> >( portDescPtr, enableState ) ); }
 
 LEP_RESULT LEP_GetRadTLinearResolution( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_RAD_TLINEAR_RESOLUTION_E_PTR resolutionPtr );
+                                               LEP_RAD_TLINEAR_RESOLUTION_E_PTR resolutionPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TLINEAR_RESOLUTION, LEP_RAD_TLINEAR_RESOLUTION_E, 2> >( portDescPtr, resolutionPtr ) ); }
 
 LEP_RESULT LEP_SetRadTLinearResolution( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_RAD_TLINEAR_RESOLUTION_E resolution );
+                                               LEP_RAD_TLINEAR_RESOLUTION_E resolution )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TLINEAR_RESOLUTION, LEP_RAD_TLINEAR_RESOLUTION_E, 2> >( portDescPtr, resolution ) ); }
 
 LEP_RESULT LEP_GetRadTLinearAutoResolution( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                   LEP_RAD_ENABLE_E_PTR enableStatePtr );
+                                                   LEP_RAD_ENABLE_E_PTR enableStatePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_TLINEAR_AUTO_RESOLUTION, LEP_RAD_ENABLE_E, 2> >( portDescPtr, enableStatePtr ) ); }
 
 LEP_RESULT LEP_SetRadTLinearAutoResolution( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                   LEP_RAD_ENABLE_E enableState );
+                                                   LEP_RAD_ENABLE_E enableState )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_TLINEAR_AUTO_RESOLUTION, LEP_RAD_ENABLE_E, 2> >( portDescPtr, enableState ) ); }
 
 LEP_RESULT LEP_GetRadSpotmeterRoi( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_RAD_ROI_T_PTR spotmeterRoiPtr );
+                                          LEP_RAD_ROI_T_PTR spotmeterRoiPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_SPOTMETER_ROI, LEP_RAD_ROI_T, 4> >( portDescPtr, spotmeterRoiPtr ) ); }
 
 LEP_RESULT LEP_SetRadSpotmeterRoi( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                           LEP_RAD_ROI_T spotmeterRoi );
 
 LEP_RESULT LEP_GetRadSpotmeterObjInKelvinX100( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                      LEP_RAD_SPOTMETER_OBJ_KELVIN_T_PTR kelvinPtr );
+                                                      LEP_RAD_SPOTMETER_OBJ_KELVIN_T_PTR kelvinPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_SPOTMETER_OBJ_KELVIN, LEP_RAD_SPOTMETER_OBJ_KELVIN_T, 4> >( portDescPtr, kelvinPtr ) ); }
+
+LEP_RESULT LEP_GetRadSpotmeterObjInKelvinX100Async( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
+                                                           LEP_ASYNC_CMD_T_PTR cmdPtr,
+                                                           LEP_RAD_SPOTMETER_OBJ_KELVIN_T_PTR kelvinPtr,
+                                                           LEP_ASYNC_CALLBACK callback,
+                                                           void *callbackArg );
 
 LEP_RESULT LEP_GetRadArbitraryOffsetMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_RAD_ARBITRARY_OFFSET_MODE_E_PTR arbitraryOffsetModePtr );
+                                                 LEP_RAD_ARBITRARY_OFFSET_MODE_E_PTR arbitraryOffsetModePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_ARBITRARY_OFFSET_MODE, LEP_RAD_ARBITRARY_OFFSET_MODE_E, 2> >( portDescPtr, arbitraryOffsetModePtr ) ); }
 
 LEP_RESULT LEP_SetRadArbitraryOffsetMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_RAD_ARBITRARY_OFFSET_MODE_E arbitraryOffsetMode );
+                                                 LEP_RAD_ARBITRARY_OFFSET_MODE_E arbitraryOffsetMode )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_ARBITRARY_OFFSET_MODE, LEP_RAD_ARBITRARY_OFFSET_MODE_E, 2> >( portDescPtr, arbitraryOffsetMode ) ); }
 
 LEP_RESULT LEP_GetRadArbitraryOffsetParams( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                   LEP_RAD_ARBITRARY_OFFSET_PARAMS_T_PTR arbitraryOffsetParamsPtr);
+                                                   LEP_RAD_ARBITRARY_OFFSET_PARAMS_T_PTR arbitraryOffsetParamsPtr)
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_ARBITRARY_OFFSET_PARAMS, LEP_RAD_ARBITRARY_OFFSET_PARAMS_T, 2> >( portDescPtr, arbitraryOffsetParamsPtr ) ); }
 
 LEP_RESULT LEP_SetRadArbitraryOffsetParams( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                   LEP_RAD_ARBITRARY_OFFSET_PARAMS_T arbitraryOffsetParams);
+                                                   LEP_RAD_ARBITRARY_OFFSET_PARAMS_T arbitraryOffsetParams)
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_ARBITRARY_OFFSET_PARAMS, LEP_RAD_ARBITRARY_OFFSET_PARAMS_T, 2> >( portDescPtr, arbitraryOffsetParams ) ); }
 
 LEP_RESULT LEP_GetRadInternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                  LEP_RBFO_T_PTR radRBFOPtr );
+                                                  LEP_RBFO_T_PTR radRBFOPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RBFO_INTERNAL, LEP_RBFO_T, 8> >( portDescPtr, radRBFOPtr ) ); }
 
 LEP_RESULT LEP_SetRadInternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                   LEP_RBFO_T_PTR radRBFOPtr );
 
 LEP_RESULT LEP_GetRadExternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                  LEP_RBFO_T_PTR radRBFOPtr );
+                                                  LEP_RBFO_T_PTR radRBFOPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RBFO_EXTERNAL, LEP_RBFO_T, 8> >( portDescPtr, radRBFOPtr ) ); }
 
 LEP_RESULT LEP_SetRadExternalRBFOHighGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                   LEP_RBFO_T_PTR radRBFOPtr );
 
 LEP_RESULT LEP_GetRadInternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_RBFO_T_PTR radRBFOPtr );
+                                                 LEP_RBFO_T_PTR radRBFOPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RBFO_INTERNAL_LG, LEP_RBFO_T, 8> >( portDescPtr, radRBFOPtr ) ); }
 
 LEP_RESULT LEP_SetRadInternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                  LEP_RBFO_T_PTR radRBFOPtr );
 
 LEP_RESULT LEP_GetRadExternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                 LEP_RBFO_T_PTR radRBFOPtr );
+                                                 LEP_RBFO_T_PTR radRBFOPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RBFO_EXTERNAL_LG, LEP_RBFO_T, 8> >( portDescPtr, radRBFOPtr ) ); }
 
 LEP_RESULT LEP_SetRadExternalRBFOLowGain( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                  LEP_RBFO_T_PTR radRBFOPtr );
 
 LEP_RESULT LEP_GetRadRadioCalValues( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_RADIO_CAL_VALUES_T_PTR radRadioCalValuesPtr);
+                                            LEP_RAD_RADIO_CAL_VALUES_T_PTR radRadioCalValuesPtr)
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_RAD_RADIO_CAL_VALUES, LEP_RAD_RADIO_CAL_VALUES_T, 4> >( portDescPtr, radRadioCalValuesPtr ) ); }
 
 LEP_RESULT LEP_SetRadRadioCalValues( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                            LEP_RAD_RADIO_CAL_VALUES_T radRadioCalValues );
+                                            LEP_RAD_RADIO_CAL_VALUES_T radRadioCalValues )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_RAD_RADIO_CAL_VALUES, LEP_RAD_RADIO_CAL_VALUES_T, 4> >( portDescPtr, radRadioCalValues ) ); }
 
 /* SYS
 */
-LEP_RESULT LEP_RunSysPing( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
+
+/**************************************/
+LEP_RESULT LEP_RunSysPing( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr )
+    { return( LEP_RunCommand( portDescPtr, (LEP_COMMAND_ID)LEP_CID_SYS_PING ) ); }
 LEP_RESULT LEP_GetSysStatus( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                     LEP_STATUS_T_PTR sysStatusPtr );
 LEP_RESULT LEP_GetSysFlirSerialNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                              LEP_SYS_FLIR_SERIAL_NUMBER_T_PTR sysSerialNumberBufPtr );
+                                              LEP_SYS_FLIR_SERIAL_NUMBER_T_PTR sysSerialNumberBufPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_FLIR_SERIAL_NUMBER, LEP_SYS_FLIR_SERIAL_NUMBER_T, 4> >( portDescPtr, sysSerialNumberBufPtr ) ); }
 
 /* Deprecated: Use LEP_GetSysCustSN instead */
    #if LEP_SYS_CUST_SERIAL_NUMBER_T
@@ -2370,7 +2741,8 @@ LEP_RESULT LEP_GetSysCustSerialNumber( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                               LEP_SYS_CUST_SERIAL_NUMBER_T_PTR sysCustSNPtr );
    #endif
 LEP_RESULT LEP_GetSysCameraUpTime( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                          LEP_SYS_UPTIME_NUMBER_T_PTR sysCameraUpTimePtr );
+                                          LEP_SYS_UPTIME_NUMBER_T_PTR sysCameraUpTimePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_CAM_UPTIME, LEP_SYS_UPTIME_NUMBER_T, 2> >( portDescPtr, sysCameraUpTimePtr ) ); }
 
 LEP_RESULT LEP_GetSysAuxTemperatureCelcius( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                    LEP_SYS_AUX_TEMPERATURE_CELCIUS_T_PTR auxTemperaturePtr );
@@ -2379,47 +2751,61 @@ LEP_RESULT LEP_GetSysFpaTemperatureCelcius( LEP_CAMERA_PORT_DESC_T_PTR portDescP
                                                    LEP_SYS_FPA_TEMPERATURE_CELCIUS_T_PTR fpaTemperaturePtr );
 
 LEP_RESULT LEP_GetSysAuxTemperatureKelvin( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                  LEP_SYS_AUX_TEMPERATURE_KELVIN_T_PTR auxTemperaturePtr );
+                                                  LEP_SYS_AUX_TEMPERATURE_KELVIN_T_PTR auxTemperaturePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_AUX_TEMPERATURE_KELVIN, LEP_SYS_AUX_TEMPERATURE_KELVIN_T, 1> >( portDescPtr, auxTemperaturePtr ) ); }
 
 LEP_RESULT LEP_GetSysFpaTemperatureKelvin( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                  LEP_SYS_FPA_TEMPERATURE_KELVIN_T_PTR fpaTemperaturePtr );
+                                                  LEP_SYS_FPA_TEMPERATURE_KELVIN_T_PTR fpaTemperaturePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_FPA_TEMPERATURE_KELVIN, LEP_SYS_FPA_TEMPERATURE_KELVIN_T, 1> >( portDescPtr, fpaTemperaturePtr ) ); }
 
 LEP_RESULT LEP_GetSysTelemetryEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                  LEP_SYS_TELEMETRY_ENABLE_STATE_E_PTR enableStatePtr );
+                                                  LEP_SYS_TELEMETRY_ENABLE_STATE_E_PTR enableStatePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_TELEMETRY_ENABLE_STATE, LEP_SYS_TELEMETRY_ENABLE_STATE_E, 2> >( portDescPtr, enableStatePtr ) ); }
 LEP_RESULT LEP_SetSysTelemetryEnableState( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                  LEP_SYS_TELEMETRY_ENABLE_STATE_E enableState );
+                                                  LEP_SYS_TELEMETRY_ENABLE_STATE_E enableState )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_SYS_TELEMETRY_ENABLE_STATE, LEP_SYS_TELEMETRY_ENABLE_STATE_E, 2, LEP_END_TELEMETRY_ENABLE_STATE> >( portDescPtr, enableState ) ); }
 
 LEP_RESULT LEP_GetSysTelemetryLocation( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_SYS_TELEMETRY_LOCATION_E_PTR telemetryLocationPtr );
+                                               LEP_SYS_TELEMETRY_LOCATION_E_PTR telemetryLocationPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_TELEMETRY_LOCATION, LEP_SYS_TELEMETRY_LOCATION_E, 2> >( portDescPtr, telemetryLocationPtr ) ); }
 LEP_RESULT LEP_SetSysTelemetryLocation( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                               LEP_SYS_TELEMETRY_LOCATION_E telemetryLocation );
+                                               LEP_SYS_TELEMETRY_LOCATION_E telemetryLocation )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_SYS_TELEMETRY_LOCATION, LEP_SYS_TELEMETRY_LOCATION_E, 2, LEP_END_TELEMETRY_LOCATION> >( portDescPtr, telemetryLocation ) ); }
 
 
 LEP_RESULT LEP_RunSysAverageFrames( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                            LEP_SYS_FRAME_AVERAGE_DIVISOR_E numFrameToAverage );
 LEP_RESULT LEP_GetSysFramesToAverage( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_SYS_FRAME_AVERAGE_DIVISOR_E_PTR numFrameToAveragePtr );
+                                             LEP_SYS_FRAME_AVERAGE_DIVISOR_E_PTR numFrameToAveragePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_NUM_FRAMES_TO_AVERAGE, LEP_SYS_FRAME_AVERAGE_DIVISOR_E, 2> >( portDescPtr, numFrameToAveragePtr ) ); }
 LEP_RESULT LEP_SetSysFramesToAverage( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_SYS_FRAME_AVERAGE_DIVISOR_E numFrameToAverage );
+                                             LEP_SYS_FRAME_AVERAGE_DIVISOR_E numFrameToAverage )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_SYS_NUM_FRAMES_TO_AVERAGE, LEP_SYS_FRAME_AVERAGE_DIVISOR_E, 2, LEP_SYS_END_FA_DIV> >( portDescPtr, numFrameToAverage ) ); }
 
 LEP_RESULT LEP_GetSysSceneStatistics( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_SYS_SCENE_STATISTICS_T_PTR sceneStatisticsPtr );
+                                             LEP_SYS_SCENE_STATISTICS_T_PTR sceneStatisticsPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_SCENE_STATISTICS, LEP_SYS_SCENE_STATISTICS_T, 4> >( portDescPtr, sceneStatisticsPtr ) ); }
 
 LEP_RESULT LEP_RunFrameAverage( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
 
 LEP_RESULT LEP_GetSysSceneRoi( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_VIDEO_ROI_T_PTR sceneRoiPtr );
+                                      LEP_SYS_VIDEO_ROI_T_PTR sceneRoiPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_SCENE_ROI, LEP_SYS_VIDEO_ROI_T, 4> >( portDescPtr, sceneRoiPtr ) ); }
 LEP_RESULT LEP_SetSysSceneRoi( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_VIDEO_ROI_T sceneRoi );
+                                      LEP_SYS_VIDEO_ROI_T sceneRoi )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_SYS_SCENE_ROI, LEP_SYS_VIDEO_ROI_T, 4> >( portDescPtr, sceneRoi ) ); }
 
 LEP_RESULT LEP_GetSysThermalShutdownCount( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                  LEP_SYS_THERMAL_SHUTDOWN_COUNTS_T_PTR thermalCountsPtr );
+                                                  LEP_SYS_THERMAL_SHUTDOWN_COUNTS_T_PTR thermalCountsPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_THERMAL_SHUTDOWN_COUNT, LEP_SYS_THERMAL_SHUTDOWN_COUNTS_T, 1> >( portDescPtr, thermalCountsPtr ) ); }
 
 LEP_RESULT LEP_GetSysShutterPosition( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_SYS_SHUTTER_POSITION_E_PTR shutterPositionPtr );
+                                             LEP_SYS_SHUTTER_POSITION_E_PTR shutterPositionPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_SHUTTER_POSITION, LEP_SYS_SHUTTER_POSITION_E, 2> >( portDescPtr, shutterPositionPtr ) ); }
 
 LEP_RESULT LEP_SetSysShutterPosition( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                             LEP_SYS_SHUTTER_POSITION_E shutterPosition );
+                                             LEP_SYS_SHUTTER_POSITION_E shutterPosition )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_SYS_SHUTTER_POSITION, LEP_SYS_SHUTTER_POSITION_E, 2, LEP_SYS_SHUTTER_POSITION_END> >( portDescPtr, shutterPosition ) ); }
 
 LEP_RESULT LEP_GetSysFfcShutterModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                LEP_SYS_FFC_SHUTTER_MODE_OBJ_T_PTR shutterModeObjPtr );
@@ -2428,22 +2814,28 @@ LEP_RESULT LEP_SetSysFfcShutterModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                                LEP_SYS_FFC_SHUTTER_MODE_OBJ_T shutterModeObj );
 
 LEP_RESULT LEP_GetSysFFCStatus( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_SYS_STATUS_E_PTR ffcStatusPtr );
+                                       LEP_SYS_STATUS_E_PTR ffcStatusPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_FFC_STATUS, LEP_SYS_STATUS_E, 2> >( portDescPtr, ffcStatusPtr ) ); }
 
 LEP_RESULT LEP_RunSysFFCNormalization( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr );
 
 LEP_RESULT LEP_GetSysGainMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_GAIN_MODE_E_PTR gainModePtr );
+                                      LEP_SYS_GAIN_MODE_E_PTR gainModePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_GAIN_MODE, LEP_SYS_GAIN_MODE_E, 2> >( portDescPtr, gainModePtr ) ); }
 LEP_RESULT LEP_SetSysGainMode( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                      LEP_SYS_GAIN_MODE_E gainMode );
+                                      LEP_SYS_GAIN_MODE_E gainMode )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_SYS_GAIN_MODE, LEP_SYS_GAIN_MODE_E, 2> >( portDescPtr, gainMode ) ); }
 
 LEP_RESULT LEP_GetSysFFCStates( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_SYS_FFC_STATES_E_PTR ffcStatePtr );
+                                       LEP_SYS_FFC_STATES_E_PTR ffcStatePtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_FFC_STATE, LEP_SYS_FFC_STATES_E, 2> >( portDescPtr, ffcStatePtr ) ); }
 
 LEP_RESULT LEP_GetSysGainModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_SYS_GAIN_MODE_OBJ_T_PTR gainModeObjPtr );
+                                         LEP_SYS_GAIN_MODE_OBJ_T_PTR gainModeObjPtr )
+    { return( LEP_GetAttr< lep::Attr<LEP_CID_SYS_GAIN_MODE_OBJ, LEP_SYS_GAIN_MODE_OBJ_T, 14> >( portDescPtr, gainModeObjPtr ) ); }
 LEP_RESULT LEP_SetSysGainModeObj( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_SYS_GAIN_MODE_OBJ_T gainModeObj );
+                                         LEP_SYS_GAIN_MODE_OBJ_T gainModeObj )
+    { return( LEP_SetAttr< lep::Attr<LEP_CID_SYS_GAIN_MODE_OBJ, LEP_SYS_GAIN_MODE_OBJ_T, 14> >( portDescPtr, gainModeObj ) ); }
 
 LEP_RESULT LEP_GetSysBoresightValues( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                              LEP_SYS_BORESIGHT_VALUES_T_PTR boresightValuesPtr);
@@ -2451,70 +2843,96 @@ LEP_RESULT LEP_GetSysBoresightValues( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
 
 /* VID
 */
+
+/**************************************/
    LEP_RESULT LEP_GetVidPolarity(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_POLARITY_E_PTR vidPolarityPtr);
+                                        LEP_POLARITY_E_PTR vidPolarityPtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_POLARITY_SELECT, LEP_POLARITY_E, 2> >( portDescPtr, vidPolarityPtr ) ); }
    LEP_RESULT LEP_SetVidPolarity(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_POLARITY_E vidPolarity);
+                                        LEP_POLARITY_E vidPolarity)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_POLARITY_SELECT, LEP_POLARITY_E, 2, LEP_VID_END_POLARITY> >( portDescPtr, vidPolarity ) ); }
 
    LEP_RESULT LEP_GetVidPcolorLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_PCOLOR_LUT_E_PTR vidPcolorLutPtr);
+                                         LEP_PCOLOR_LUT_E_PTR vidPcolorLutPtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_LUT_SELECT, LEP_PCOLOR_LUT_E, 2> >( portDescPtr, vidPcolorLutPtr ) ); }
    LEP_RESULT LEP_SetVidPcolorLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                         LEP_PCOLOR_LUT_E vidPcolorLut);
+                                         LEP_PCOLOR_LUT_E vidPcolorLut)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_LUT_SELECT, LEP_PCOLOR_LUT_E, 2, LEP_VID_END_PCOLOR_LUT> >( portDescPtr, vidPcolorLut ) ); }
 
    LEP_RESULT LEP_GetVidLowGainPcolorLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_PCOLOR_LUT_E_PTR vidPcolorLutPtr);
+                                                LEP_PCOLOR_LUT_E_PTR vidPcolorLutPtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_LOW_GAIN_COLOR_LUT, LEP_PCOLOR_LUT_E, 2> >( portDescPtr, vidPcolorLutPtr ) ); }
    LEP_RESULT LEP_SetVidLowGainPcolorLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_PCOLOR_LUT_E vidPcolorLut);
+                                                LEP_PCOLOR_LUT_E vidPcolorLut)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_LOW_GAIN_COLOR_LUT, LEP_PCOLOR_LUT_E, 2, LEP_VID_END_PCOLOR_LUT> >( portDescPtr, vidPcolorLut ) ); }
 
    LEP_RESULT LEP_GetVidUserLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_VID_LUT_BUFFER_T_PTR vidUserLutBufPtr);
+                                       LEP_VID_LUT_BUFFER_T_PTR vidUserLutBufPtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_LUT_TRANSFER, LEP_VID_LUT_BUFFER_T, 512> >( portDescPtr, vidUserLutBufPtr ) ); }
 
    LEP_RESULT LEP_SetVidUserLut(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_VID_LUT_BUFFER_T_PTR vidUserLutBufPtr);
+                                       LEP_VID_LUT_BUFFER_T_PTR vidUserLutBufPtr)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_LUT_TRANSFER, LEP_VID_LUT_BUFFER_T, 512> >( portDescPtr, vidUserLutBufPtr ) ); }
 
    LEP_RESULT LEP_GetVidFocusCalcEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                    LEP_VID_FOCUS_CALC_ENABLE_E_PTR vidEnableFocusCalcStatePtr);
+                                                    LEP_VID_FOCUS_CALC_ENABLE_E_PTR vidEnableFocusCalcStatePtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_FOCUS_CALC_ENABLE, LEP_VID_FOCUS_CALC_ENABLE_E, 2> >( portDescPtr, vidEnableFocusCalcStatePtr ) ); }
    LEP_RESULT LEP_SetVidFocusCalcEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                    LEP_VID_FOCUS_CALC_ENABLE_E vidFocusCalcEnableState);
+                                                    LEP_VID_FOCUS_CALC_ENABLE_E vidFocusCalcEnableState)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_FOCUS_CALC_ENABLE, LEP_VID_FOCUS_CALC_ENABLE_E, 2, LEP_VID_END_FOCUS_CALC_ENABLE> >( portDescPtr, vidFocusCalcEnableState ) ); }
 
    LEP_RESULT LEP_GetVidBoresightCalcEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                        LEP_VID_BORESIGHT_CALC_ENABLE_STATE_E_PTR boresightCalcEnableStatePtr);
+                                                        LEP_VID_BORESIGHT_CALC_ENABLE_STATE_E_PTR boresightCalcEnableStatePtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_BORESIGHT_CALC_ENABLE, LEP_VID_BORESIGHT_CALC_ENABLE_STATE_E, 2> >( portDescPtr, boresightCalcEnableStatePtr ) ); }
    LEP_RESULT LEP_SetVidBoresightCalcEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                        LEP_VID_BORESIGHT_CALC_ENABLE_STATE_E boresightCalcEnableState);
+                                                        LEP_VID_BORESIGHT_CALC_ENABLE_STATE_E boresightCalcEnableState)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_BORESIGHT_CALC_ENABLE, LEP_VID_BORESIGHT_CALC_ENABLE_STATE_E, 2, LEP_VID_END_BORESIGHT_CALC_ENABLE_STATE> >( portDescPtr, boresightCalcEnableState ) ); }
    LEP_RESULT LEP_GetVidBoresightCoordinates(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                    LEP_VID_BORESIGHT_COORDINATES_T_PTR boresightCoordinatesPtr);
+                                                    LEP_VID_BORESIGHT_COORDINATES_T_PTR boresightCoordinatesPtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_BORESIGHT_COORDINATES, LEP_VID_BORESIGHT_COORDINATES_T, 16> >( portDescPtr, boresightCoordinatesPtr ) ); }
    LEP_RESULT LEP_GetVidTargetPosition(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
                                               LEP_VID_TARGET_POSITION_T_PTR targetPositionPtr);
 
    LEP_RESULT LEP_GetVidROI(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_VID_FOCUS_ROI_T_PTR vidFocusROIPtr);
+                                   LEP_VID_FOCUS_ROI_T_PTR vidFocusROIPtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_FOCUS_ROI, LEP_VID_FOCUS_ROI_T, 4> >( portDescPtr, vidFocusROIPtr ) ); }
    LEP_RESULT LEP_SetVidROI(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                   LEP_VID_FOCUS_ROI_T vidFocusROI);
+                                   LEP_VID_FOCUS_ROI_T vidFocusROI)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_FOCUS_ROI, LEP_VID_FOCUS_ROI_T, 4> >( portDescPtr, vidFocusROI ) ); }
 
    LEP_RESULT LEP_GetVidFocusMetric(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                           LEP_VID_FOCUS_METRIC_T_PTR vidFocusMetricPtr);
+                                           LEP_VID_FOCUS_METRIC_T_PTR vidFocusMetricPtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_FOCUS_METRIC, LEP_VID_FOCUS_METRIC_T, 2> >( portDescPtr, vidFocusMetricPtr ) ); }
 
    LEP_RESULT LEP_GetVidFocusMetricThreshold(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                    LEP_VID_FOCUS_METRIC_THRESHOLD_T_PTR vidFocusMetricThresholdPtr);
+                                                    LEP_VID_FOCUS_METRIC_THRESHOLD_T_PTR vidFocusMetricThresholdPtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_FOCUS_THRESHOLD, LEP_VID_FOCUS_METRIC_THRESHOLD_T, 2> >( portDescPtr, vidFocusMetricThresholdPtr ) ); }
    LEP_RESULT LEP_SetVidFocusMetricThreshold(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                    LEP_VID_FOCUS_METRIC_THRESHOLD_T vidFocusMetricThreshold);
+                                                    LEP_VID_FOCUS_METRIC_THRESHOLD_T vidFocusMetricThreshold)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_FOCUS_THRESHOLD, LEP_VID_FOCUS_METRIC_THRESHOLD_T, 2> >( portDescPtr, vidFocusMetricThreshold ) ); }
 
    LEP_RESULT LEP_GetVidSbNucEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_VID_SBNUC_ENABLE_E_PTR vidSbNucEnableStatePtr);
+                                                LEP_VID_SBNUC_ENABLE_E_PTR vidSbNucEnableStatePtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_SBNUC_ENABLE, LEP_VID_SBNUC_ENABLE_E, 2> >( portDescPtr, vidSbNucEnableStatePtr ) ); }
    LEP_RESULT LEP_SetVidSbNucEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                                LEP_VID_SBNUC_ENABLE_E vidSbNucEnableState);
+                                                LEP_VID_SBNUC_ENABLE_E vidSbNucEnableState)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_SBNUC_ENABLE, LEP_VID_SBNUC_ENABLE_E, 2, LEP_VID_END_SBNUC_ENABLE> >( portDescPtr, vidSbNucEnableState ) ); }
 
    LEP_RESULT LEP_GetVidFreezeEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_VID_FREEZE_ENABLE_E_PTR vidFreezeEnableStatePtr);
+                                       LEP_VID_FREEZE_ENABLE_E_PTR vidFreezeEnableStatePtr)
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_FREEZE_ENABLE, LEP_VID_FREEZE_ENABLE_E, 2> >( portDescPtr, vidFreezeEnableStatePtr ) ); }
 
    LEP_RESULT LEP_SetVidFreezeEnableState(LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                       LEP_VID_FREEZE_ENABLE_E vidFreezeEnableState);
+                                       LEP_VID_FREEZE_ENABLE_E vidFreezeEnableState)
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_FREEZE_ENABLE, LEP_VID_FREEZE_ENABLE_E, 2, LEP_VID_END_FREEZE_ENABLE> >( portDescPtr, vidFreezeEnableState ) ); }
 
    LEP_RESULT LEP_GetVidVideoOutputFormat( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_VID_VIDEO_OUTPUT_FORMAT_E_PTR vidVideoOutputFormatPtr );
+                                        LEP_VID_VIDEO_OUTPUT_FORMAT_E_PTR vidVideoOutputFormatPtr )
+       { return( LEP_GetAttr< lep::Attr<LEP_CID_VID_VIDEO_OUTPUT_FORMAT, LEP_VID_VIDEO_OUTPUT_FORMAT_E, 2> >( portDescPtr, vidVideoOutputFormatPtr ) ); }
 
    LEP_RESULT LEP_SetVidVideoOutputFormat( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
-                                        LEP_VID_VIDEO_OUTPUT_FORMAT_E vidVideoOutputFormat );
+                                        LEP_VID_VIDEO_OUTPUT_FORMAT_E vidVideoOutputFormat )
+       { return( LEP_SetAttr< lep::Attr<LEP_CID_VID_VIDEO_OUTPUT_FORMAT, LEP_VID_VIDEO_OUTPUT_FORMAT_E, 2, LEP_END_VID_VIDEO_OUTPUT_FORMAT> >( portDescPtr, vidVideoOutputFormat ) ); }
 
 /*
    LEP_RESULT LEP_GetOemVideoOutputFormat( LEP_CAMERA_PORT_DESC_T_PTR portDescPtr,
@@ -2621,6 +3039,68 @@ CRC16 CalcCRC16Bytes(unsigned int count, char *buffer);
 // Internal buffer to convert enum size to Lep data size
 LEP_UINT16 _LEP_data[16];
 
+// Asynchronous CCI command engine
+typedef enum
+{
+    ASYNC_IDLE = 0,
+    ASYNC_WAIT_READY,
+    ASYNC_WRITE_DATA,
+    ASYNC_WRITE_LENGTH,
+    ASYNC_WRITE_COMMAND,
+    ASYNC_WAIT_DONE,
+    ASYNC_READ_DATA
+} ASYNC_STATE_E;
+
+LEP_ASYNC_CMD_T_PTR asyncQueue[LEP_ASYNC_QUEUE_LENGTH];
+volatile LEP_UINT8 asyncHead;
+volatile LEP_UINT8 asyncCount;
+volatile ASYNC_STATE_E asyncState;
+LEP_UINT16 asyncTimeoutCount;
+
+// Current transfer
+LEP_BOOL asyncXferWrite;
+LEP_UINT16 asyncXferReg;
+LEP_UINT16 *asyncXferPtr;
+LEP_UINT16 asyncXferWords;
+LEP_UINT16 asyncXferOffset;     // Words transferred in previous chunks
+LEP_UINT16 asyncXferWord;       // Status, length or command register value
+
+void AsyncStart(void);
+LEP_ASYNC_CMD_T_PTR AsyncAdvance(LEP_RESULT xferResult);
+void AsyncSetTransfer(LEP_BOOL write, LEP_UINT16 regAddress, LEP_UINT16 *dataPtr, LEP_UINT16 words);
+void AsyncFinish(LEP_ASYNC_CMD_T_PTR cmdPtr);
+#if defined(LEP_I2C_T3)
+LEP_BOOL asyncXferAddrPhase;
+LEP_UINT16 asyncXferChunk;      // Words in the current chunk
+
+void AsyncIssue(void);
+static void AsyncTransmitDone(void);
+static void AsyncRequestDone(void);
+static void AsyncError(void);
+#else
+void AsyncRun(void);
+#endif
+
+// Attribute cache (an entry with no words is empty)
+#if (USE_ATTRIBUTE_CACHE == 1)
+typedef struct
+{
+    LEP_COMMAND_ID commandID;
+    LEP_UINT16 words;
+    LEP_UINT16 data[LEP_ATTR_CACHE_MAX_WORDS];
+} ATTR_CACHE_ENTRY_T;
+
+ATTR_CACHE_ENTRY_T attrCache[LEP_ATTR_CACHE_ENTRIES];
+LEP_BOOL attrCacheEnable;
+LEP_UINT8 attrCacheNext;
+volatile LEP_UINT8 attrCacheGen;   // Incremented each time the cache is emptied
+
+static LEP_BOOL AttrCacheable(LEP_COMMAND_ID commandID);
+LEP_BOOL AttrCacheGet(LEP_COMMAND_ID commandID, LEP_ATTRIBUTE_T_PTR attributePtr, LEP_UINT16 words);
+void AttrCachePut(LEP_COMMAND_ID commandID, LEP_ATTRIBUTE_T_PTR attributePtr, LEP_UINT16 words, LEP_UINT8 gen);
+#endif
+void AttrCacheCommand(LEP_COMMAND_ID commandID);
+
 };
 
 #endif /* _LEPTON_SDK_H_ */
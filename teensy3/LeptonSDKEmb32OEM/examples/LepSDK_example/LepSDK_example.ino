@@ -34,7 +34,7 @@ void setup() {
   delay(1000);
 
   // Attempt to connect to the Lepton
-  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 100, portDescP) != LEP_OK) {
+  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 1000, portDescP) != LEP_OK) {
     Serial.println("Open failed");
   } else {
     lepConnected = true;
@@ -0,0 +1,361 @@
+/*
+ * LeptonVoSPI - Lepton 3.5 acquisition and display core shared by the teensy 3.2 test sketches
+ *
+ * Software released "as-is" for instructional use.  No warranty as to correctness or fitness for any application.
+ *
+ */
+#include <SPI.h>
+#include "LeptonVoSPI.h"
+
+LeptonVoSPI LepVoSPI;
+
+// Configuration
+static int pinCs;
+static int pinVsync;
+static LepVoSPIFormat pixFormat;
+
+//Array to store one Lepton packet
+static uint8_t lepPacket[LEP_PKT_LENGTH];
+
+// Ping-pong frame buffers: one owned by the sketch (valid while dispBufferValid) while the
+// other is acquired
+static uint8_t* dispBuffer;
+static uint8_t* acqBuffer;
+static volatile bool dispBufferValid = false;
+
+// Segment assembler and the hooks the VSYNC ISR reads segments with
+static vospi_asm_t lepAsm;
+static vospi_asm_hooks_t lepHooks;
+static uint32_t segStartUsec;
+
+// 16-bit statistics: the frame being acquired, the last completed frame and the range
+// used to scale the frame being acquired
+static uint16_t acqMinVal, acqMaxVal, acqCenterVal;
+static uint32_t acqSpotSum;
+static volatile uint16_t frameMinVal, frameMaxVal, frameCenterVal, frameSpotVal;
+static uint16_t scaleMinVal = 0;
+static uint32_t scaleRange = 0x3FFF;
+
+static volatile uint32_t frameCount = 0;
+static volatile uint32_t droppedCount = 0;
+
+// Next line of the image to draw
+static int dispLine = LEP_DISP_FIRST_LINE;
+
+
+static uint32_t AbsDiff32u(uint32_t n1, uint32_t n2) {
+  if (n2 >= n1) {
+    return (n2-n1);
+  } else {
+    return (n2-n1+0xFFFFFFFF);
+  }
+}
+
+
+void LeptonVoSPI::begin(int csPin, int vsyncPin, LepVoSPIFormat format, uint8_t* buf0, uint8_t* buf1)
+{
+  pinCs = csPin;
+  pinVsync = vsyncPin;
+  pixFormat = format;
+  dispBuffer = buf0;
+  acqBuffer = buf1;
+  
+  pinMode(pinCs, OUTPUT);
+  digitalWrite(pinCs, HIGH);
+  pinMode(pinVsync, INPUT);
+
+  acqMinVal = 0xFFFF;
+  acqMaxVal = 0;
+  acqSpotSum = 0;
+
+  vospi_asm_init(&lepAsm, 0);
+  lepHooks.transfer = transferPacket;
+  lepHooks.expired = segmentExpired;
+  lepHooks.store = storePacket;
+  lepHooks.ctx = NULL;
+  lepHooks.maxPkts = 1;
+}
+
+
+void LeptonVoSPI::enable()
+{
+  attachInterrupt(pinVsync, vsyncHandler, RISING);
+  
+  // Configure the SPI library to be able to run in the ISR
+  SPI.usingInterrupt(pinVsync);
+}
+
+
+void LeptonVoSPI::disable()
+{
+  detachInterrupt(pinVsync);
+  SPI.notUsingInterrupt(IRQ_PORTA);
+}
+
+
+bool LeptonVoSPI::frameAvailable()
+{
+  return dispBufferValid;
+}
+
+
+uint8_t* LeptonVoSPI::getFrame()
+{
+  return dispBuffer;
+}
+
+
+void LeptonVoSPI::releaseFrame()
+{
+  dispBufferValid = false;
+}
+
+
+uint16_t LeptonVoSPI::getMinVal()
+{
+  return frameMinVal;
+}
+
+
+uint16_t LeptonVoSPI::getMaxVal()
+{
+  return frameMaxVal;
+}
+
+
+uint16_t LeptonVoSPI::getCenterVal()
+{
+  return frameCenterVal;
+}
+
+
+uint16_t LeptonVoSPI::getSpotVal()
+{
+  return frameSpotVal;
+}
+
+
+uint32_t LeptonVoSPI::getFrameCount()
+{
+  return frameCount;
+}
+
+
+uint32_t LeptonVoSPI::getDroppedCount()
+{
+  return droppedCount;
+}
+
+
+uint8_t* LeptonVoSPI::getPacket()
+{
+  return lepPacket;
+}
+
+
+//
+// Set the ILI9341 address window and start the memory write (done directly so it doesn't
+// depend on the Adafruit library version's setAddrWindow() arguments)
+//
+static void setDispWindow(int tftDcPin, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  digitalWrite(tftDcPin, LOW);
+  SPI.transfer(ILI9341_CASET);
+  digitalWrite(tftDcPin, HIGH);
+  SPI.transfer16(x);
+  SPI.transfer16(x+w-1);
+  digitalWrite(tftDcPin, LOW);
+  SPI.transfer(ILI9341_PASET);
+  digitalWrite(tftDcPin, HIGH);
+  SPI.transfer16(y);
+  SPI.transfer16(y+h-1);
+  digitalWrite(tftDcPin, LOW);
+  SPI.transfer(ILI9341_RAMWR);
+  digitalWrite(tftDcPin, HIGH);
+}
+
+
+//
+// Fast routine to display the pixel-doubled image to fill the LCD below the status line
+//   - Draws LEP_DISP_BAND_LINES lines per call so VSYNC (masked by the SPI transaction)
+//     is only delayed briefly
+//   - Draws an inverted pixel at the center after the last band
+//
+bool LeptonVoSPI::drawFrameBand(Adafruit_ILI9341* tft, int tftCsPin, int tftDcPin, uint8_t* frame, uint16_t* colorMap)
+{
+  int16_t x, y, n;
+  uint16_t pixel;
+  uint8_t* ptr;
+
+  n = LEP_HEIGHT - dispLine;
+  if (n > LEP_DISP_BAND_LINES) n = LEP_DISP_BAND_LINES;
+
+  SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE0));
+  digitalWrite(tftCsPin, LOW);
+  setDispWindow(tftDcPin, 0, 2*dispLine, 320, 2*n);
+  for(y=dispLine; y<dispLine+n; y++) {
+    // Line 1
+    ptr = &frame[y*LEP_WIDTH];
+    for(x=0; x<LEP_WIDTH; x++) {
+      pixel = colorMap[*ptr++];
+      SPI.transfer16(pixel);
+      SPI.transfer16(pixel);
+    }
+    // Line 2
+    ptr = &frame[y*LEP_WIDTH];
+    for(x=0; x<LEP_WIDTH; x++) {
+      pixel = colorMap[*ptr++];
+      SPI.transfer16(pixel);
+      SPI.transfer16(pixel);
+    }
+  }
+  SPI.endTransaction();
+  digitalWrite(tftCsPin, HIGH);
+
+  dispLine += n;
+  if (dispLine < LEP_HEIGHT) {
+    return false;
+  }
+  dispLine = LEP_DISP_FIRST_LINE;
+
+  // Draw an inverted pixel at the center
+  pixel = ~colorMap[frame[LEP_NUM_PIXELS/2 + (LEP_WIDTH/2)]];
+  tft->fillRect(159, 119, 2, 2, pixel);
+  return true;
+}
+
+
+//
+// VSYNC ISR
+//   - Attempt to read a complete segment from the Lepton
+//   - Data loaded into acqBuffer
+//   - frameComplete() swaps the buffers when all 4 segments have been read for a frame
+// 
+void LeptonVoSPI::vsyncHandler()
+{
+  segStartUsec = micros();
+  if (vospi_asm_read_segment(&lepAsm, &lepHooks) & VOSPI_ASM_FRAME) {
+    frameComplete();
+  }
+}
+
+
+//
+// Read one packet from the lepton (segment assembler transfer hook)
+//
+const uint8_t* LeptonVoSPI::transferPacket(void* ctx, int numPkts)
+{
+  SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE1));
+
+  //Start transfer  - CS LOW
+  digitalWriteFast(pinCs, LOW);
+
+  SPI.transfer(lepPacket, LEP_PKT_LENGTH);
+
+  //End transfer - CS HIGH
+  digitalWriteFast(pinCs, HIGH);
+
+  //End SPI Transaction
+  SPI.endTransaction();
+
+  return lepPacket;
+}
+
+
+//
+// Returns true when we did not see a valid packet within this segment interval (segment
+// assembler timing hook)
+//
+bool LeptonVoSPI::segmentExpired(void* ctx)
+{
+  return (AbsDiff32u(segStartUsec, micros()) > LEP_MAX_FRAME_DELAY_USEC);
+}
+
+
+//
+// Store the packet in the frame being acquired (segment assembler store hook)
+//
+void LeptonVoSPI::storePacket(void* ctx, const vospi_asm_t* a, const uint8_t* pktP, int rsp)
+{
+  copyPacketToBuffer(a->dst);
+}
+
+
+void LeptonVoSPI::copyPacketToBuffer(int pkt)
+{
+  int pixIndex = pkt * (LEP_WIDTH/2);
+  uint8_t* lepPopPtr;
+  uint8_t* acqPushPtr = &acqBuffer[pixIndex];
+  int row = pixIndex / LEP_WIDTH;
+  int col = pixIndex % LEP_WIDTH;
+  int c;
+  uint16_t t;
+  uint32_t v;
+
+  if (pixFormat == LEP_VOSPI_AGC8) {
+    // Only going to copy the low bytes
+    lepPopPtr = &lepPacket[5];
+    while (lepPopPtr <= &lepPacket[163]) {
+      *acqPushPtr++ = *lepPopPtr;
+      lepPopPtr += 2;
+    }
+  } else {
+    lepPopPtr = &lepPacket[4];
+    if (pixIndex == (LEP_NUM_PIXELS/2 + (LEP_WIDTH/2))) {
+      // Packet starts with the center pixel
+      acqCenterVal = (lepPopPtr[0] << 8) | lepPopPtr[1];
+    }
+    if ((row >= LEP_SPOT_ROW) && (row < (LEP_SPOT_ROW + LEP_SPOT_SIZE))) {
+      // Spot meter pixels in this packet
+      for (c=max(col, LEP_SPOT_COL); c<min(col + LEP_WIDTH/2, LEP_SPOT_COL + LEP_SPOT_SIZE); c++) {
+        acqSpotSum += (lepPopPtr[2*(c - col)] << 8) | lepPopPtr[2*(c - col) + 1];
+      }
+    }
+    while (lepPopPtr <= &lepPacket[163]) {
+      t = *lepPopPtr++ << 8;
+      t |= *lepPopPtr++;
+      if (t < acqMinVal) acqMinVal = t;
+      if (t > acqMaxVal) acqMaxVal = t;
+      if (t <= scaleMinVal) {
+        v = 0;
+      } else {
+        v = ((t - scaleMinVal) * 255) / scaleRange;
+        if (v > 255) v = 255;
+      }
+      *acqPushPtr++ = (uint8_t) v;
+    }
+  }
+}
+
+
+//
+// Hand the acquired frame to the sketch if it is done with the previous one (otherwise
+// it is dropped and the next frame is acquired into the same buffer)
+//
+void LeptonVoSPI::frameComplete()
+{
+  uint8_t* t;
+
+  if (pixFormat == LEP_VOSPI_RAD16_SCALED) {
+    // Scale the next frame with this frame's range
+    frameMinVal = acqMinVal;
+    frameMaxVal = acqMaxVal;
+    frameCenterVal = acqCenterVal;
+    frameSpotVal = (acqSpotSum + (LEP_SPOT_SIZE*LEP_SPOT_SIZE)/2) / (LEP_SPOT_SIZE*LEP_SPOT_SIZE);
+    acqSpotSum = 0;
+    scaleMinVal = acqMinVal;
+    scaleRange = (acqMaxVal > acqMinVal) ? (acqMaxVal - acqMinVal) : 1;
+    acqMinVal = 0xFFFF;
+    acqMaxVal = 0;
+  }
+
+  if (!dispBufferValid) {
+    t = dispBuffer;
+    dispBuffer = acqBuffer;
+    acqBuffer = t;
+    dispBufferValid = true;
+    frameCount++;
+  } else {
+    droppedCount++;
+  }
+}
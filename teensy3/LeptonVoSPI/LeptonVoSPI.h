@@ -0,0 +1,95 @@
+/*
+ * LeptonVoSPI - Lepton 3.5 acquisition and display core shared by the teensy 3.2 test sketches
+ *   - Reads a segment from the Lepton in the VSYNC ISR using the shared VoSPI segment assembler
+ *     (vospi_asm, which should also be put in your Arduino libraries folder)
+ *   - Acquires continuously into a pair of ping-pong frame buffers.  A completed frame is
+ *     swapped in when the sketch has released the previous one (otherwise it is dropped)
+ *     so acquisition never stops and the Lepton never has to be resynchronized.
+ *   - Stores 8-bit AGC values or 16-bit radiometric values linearly scaled to 8-bits using
+ *     the range of the previous frame (two 16-bit frames don't fit in the teensy 3.2 RAM)
+ *   - Draws the pixel-doubled frame to an ILI9341 a few lines at a time so VSYNC is only
+ *     held off briefly while the display is updated
+ *
+ * Usage
+ *   LepVoSPI.begin(pin_lepton_cs, pin_lepton_vsync, LEP_VOSPI_AGC8, lepFrames[0], lepFrames[1]);
+ *   LepVoSPI.enable();
+ *   ...
+ *   if (LepVoSPI.frameAvailable()) {
+ *     if (LepVoSPI.drawFrameBand(&tft, pin_tft_cs, pin_tft_dc, LepVoSPI.getFrame(), colorMap)) {
+ *       LepVoSPI.releaseFrame();
+ *     }
+ *   }
+ *
+ * Software released "as-is" for instructional use.  No warranty as to correctness or fitness for any application.
+ *
+ */
+#ifndef _LEPTON_VOSPI_H_
+#define _LEPTON_VOSPI_H_
+
+#include <Arduino.h>
+#include <vospi_asm.h>
+#include "Adafruit_ILI9341.h"
+
+#define LEP_MAX_FRAME_DELAY_USEC 9450
+
+#define LEP_WIDTH      160
+#define LEP_HEIGHT     120
+#define LEP_NUM_PIXELS (LEP_WIDTH*LEP_HEIGHT)
+#define LEP_PKT_LENGTH 164
+
+// Spot meter: the mean of the LEP_SPOT_SIZE x LEP_SPOT_SIZE pixels at the center of the
+// image (the Lepton's default spot meter region)
+#define LEP_SPOT_SIZE  2
+#define LEP_SPOT_COL   (LEP_WIDTH/2 - LEP_SPOT_SIZE/2)
+#define LEP_SPOT_ROW   (LEP_HEIGHT/2 - LEP_SPOT_SIZE/2)
+
+// Display: the first lines of the image are skipped to leave room for a status line and
+// the image is drawn LEP_DISP_BAND_LINES lines at a time (about 2 mSec at 20 MHz)
+#define LEP_DISP_FIRST_LINE 10
+#define LEP_DISP_BAND_LINES 4
+
+// Pixel format stored in the frame buffers
+enum LepVoSPIFormat {
+  LEP_VOSPI_AGC8,           // Low byte of each AGC pixel
+  LEP_VOSPI_RAD16_SCALED    // 16-bit pixels scaled to 8-bits with the previous frame's range
+};
+
+
+class LeptonVoSPI
+{
+public:
+  void begin(int csPin, int vsyncPin, LepVoSPIFormat format, uint8_t* buf0, uint8_t* buf1);
+  void enable();
+  void disable();
+
+  // Frame access: getFrame() is valid from frameAvailable() until releaseFrame()
+  bool frameAvailable();
+  uint8_t* getFrame();
+  void releaseFrame();
+
+  // Unscaled statistics of the last completed frame (LEP_VOSPI_RAD16_SCALED), found while
+  // the packets are copied so reading them needs no CCI (I2C) commands
+  uint16_t getMinVal();
+  uint16_t getMaxVal();
+  uint16_t getCenterVal();
+  uint16_t getSpotVal();
+
+  uint32_t getFrameCount();
+  uint32_t getDroppedCount();
+  uint8_t* getPacket();
+
+  // Draw the next band of frame.  Returns true when the whole image has been drawn.
+  bool drawFrameBand(Adafruit_ILI9341* tft, int tftCsPin, int tftDcPin, uint8_t* frame, uint16_t* colorMap);
+
+private:
+  static void vsyncHandler();
+  static const uint8_t* transferPacket(void* ctx, int numPkts);
+  static bool segmentExpired(void* ctx);
+  static void storePacket(void* ctx, const vospi_asm_t* a, const uint8_t* pktP, int rsp);
+  static void copyPacketToBuffer(int pkt);
+  static void frameComplete();
+};
+
+extern LeptonVoSPI LepVoSPI;
+
+#endif /* _LEPTON_VOSPI_H_ */
@@ -0,0 +1,323 @@
+/*
+ * Lepton 3.5 USB bridge - for teensy 4.0/4.1 w/ LEP (600 MHz w/ Faster optimizations)
+ *   - Turns the teensy into a wired radiometric USB camera: every frame is sent to the host
+ *     over the USB serial port at the Lepton's full frame rate (no display)
+ *   - Enable TLinear (0.01 K resolution) with the Lepton's AGC disabled
+ *   - Frames are sent in the shared binary frame format (vospi_asm/tcam_frame.h), the same
+ *     frames the Linux capture programs publish, read on the host with tcam_frame.py
+ *     (ESP32/python/examples/teensy_bridge.py)
+ *   - Uses Lepton VSYNC output
+ *
+ * Acquisition (the same as lep_test11)
+ *   - Each packet is DMAed (LPSPI eDMA through the SPI library's asynchronous transfers) into one
+ *     half of a double-buffered packet area at 20 MHz while the other half is processed
+ *   - Segment state is advanced in the DMA complete ISR (the VSYNC ISR just starts the first packet)
+ *   - Frames are acquired into one of two frame buffers while the other is sent so the USB
+ *     transfer overlaps capture.  Frames are swapped when the send is done (otherwise the
+ *     completed frame is dropped, which the host sees as a gap in the sequence numbers).
+ *
+ * USB
+ *   - Teensyduino has no UVC device class so frames go over the USB serial (CDC bulk) port.
+ *     The 4.x is a USB high speed device so a frame (38 kB) takes a few mSec to send.
+ *   - Each frame is a 64 byte tcam_frame_hdr_t followed by the 16-bit little-endian TLinear
+ *     pixels (Kelvin * 100).  seq counts every frame completed and timestamp_usec is the teensy's
+ *     uSec time when the frame was completed.  A host that loses its place (or a frame that was
+ *     cut short by a stalled host) finds the next frame by its magic.
+ *   - Frames are only sent while a host has the port open (DTR set)
+ *   - Single character commands from the host: 'f' runs a FFC, 'p' pauses and 's' resumes the
+ *     stream
+ *
+ * Connections (the Lepton pins of lep_test11)
+ *   D2 - Lepton nCS output
+ *   D3 - Lepton VSYNC input
+ *   D12 - SPI MISO (to Lepton)
+ *   D13 - SPI SCK output (to Lepton)
+ *   A4 - I2C SDA0 (to Lepton) with external 4.7 k pull-up to 3V3
+ *   A5 - I2C SCL0 (to Lepton) with external 4.7 k pull-up to 3V3
+ *
+ * Requires the LeptonSDKEmb32OEM library (which uses Wire on the Teensy 4) and the top-level vospi_asm
+ * directory in your Arduino libraries folder.
+ *
+ * Software released "as-is" for instructional use.  No warranty as to correctness or fitness for any application.
+ *
+ * Written (or, more accurately, hacked together) by Dan Julio
+ *
+ */
+#include <SPI.h>
+#include <EventResponder.h>
+#include <LeptonSDKEmb32OEM.h>
+#include <vospi_asm.h>
+#include <tcam_frame.h>
+
+#if !defined(__IMXRT1062__)
+#error "lep_bridge requires a Teensy 4.0 or 4.1 (two 16-bit frames don't fit in a Teensy 3.2)"
+#endif
+
+#define LEP_MAX_FRAME_DELAY_USEC 9450
+
+#define LEP_WIDTH      160
+#define LEP_HEIGHT     120
+#define LEP_NUM_PIXELS (LEP_WIDTH*LEP_HEIGHT)
+#define LEP_PKT_LENGTH 164
+
+#define LEP_SPI_CLOCK  20000000
+
+// All fast GPIO pins (including VSYNC) share one interrupt
+#define LEP_VSYNC_IRQ  IRQ_GPIO6789
+
+// IO Pins
+const int pin_lepton_cs = 2;
+const int pin_lepton_vsync = 3;
+
+LeptonSDKEmb32OEM lep;
+
+LEP_CAMERA_PORT_DESC_T portDesc;
+LEP_CAMERA_PORT_DESC_T_PTR portDescP = &portDesc;
+
+// A frame as it is sent: the shared frame header straight in front of the pixels
+typedef struct __attribute__((packed)) {
+  tcam_frame_hdr_t hdr;
+  uint16_t pixels[LEP_NUM_PIXELS];
+} bridge_frame_t;
+
+// Frame buffers - one sent while the other is acquired
+static bridge_frame_t lepFrames[2];
+static bridge_frame_t* sendFrame = &lepFrames[0];
+static bridge_frame_t* acqFrame = &lepFrames[1];
+
+// Double-buffered packet area (one packet is DMAed in while the other is processed)
+static uint8_t dmaPacket[2][LEP_PKT_LENGTH];
+static uint8_t dmaTxPacket[LEP_PKT_LENGTH];   // Zeros clocked out while reading
+volatile int dmaPacketIndex;
+EventResponder dmaEvent;
+
+// Segment capture state (owned by the VSYNC and DMA complete ISRs)
+volatile bool captureActive = false;          // Segment being read (the Lepton has the SPI bus)
+volatile bool segmentDone;                    // Stop after the packet in flight
+uint32_t segStartUsec;
+vospi_asm_t segAsm;                           // Segment assembler
+
+// Frame counters (seq counts every frame completed, including those dropped)
+uint32_t frameSeq = 0;
+volatile uint32_t droppedFrames = 0;
+uint32_t sentFrames = 0;
+
+// 64-bit uSec time (extended in the DMA complete ISR, its only user)
+uint32_t prevMicros = 0;
+uint64_t microsHigh = 0;
+
+volatile bool sendBufferValid = false;
+bool streamOn = true;
+
+
+void setup() {
+  bool success = true;
+
+  // The host opens the port to start the stream
+  Serial.begin(115200);
+
+  pinMode(pin_lepton_cs, OUTPUT);
+  digitalWrite(pin_lepton_cs, HIGH);
+  pinMode(pin_lepton_vsync, INPUT);
+
+  // Every frame has the same geometry
+  tcam_frame_init(&lepFrames[0].hdr, LEP_WIDTH, LEP_HEIGHT, 16, TCAM_FRAME_FMT_16LE);
+  lepFrames[0].hdr.flags = TCAM_FRAME_FLAG_TLINEAR;
+  lepFrames[0].hdr.telem_fields = TCAM_FRAME_TEL_TLIN;
+  lepFrames[0].hdr.tlinear = 0x03;   // Enabled, 0.01 K resolution
+  lepFrames[1].hdr = lepFrames[0].hdr;
+
+  // Advance the segment state directly from the DMA complete interrupt
+  vospi_asm_init(&segAsm, 0);
+  dmaEvent.attachImmediate(dmaCompleteHandler);
+
+  delay(2000);
+
+  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 1000, portDescP) != LEP_OK) {
+    success = false;
+  } else {
+    if (lep.LEP_SetAgcEnableState(portDescP, LEP_AGC_DISABLE) != LEP_OK) {
+      success = false;
+    }
+    if (lep.LEP_SetRadTLinearEnableState(portDescP, LEP_RAD_ENABLE) != LEP_OK) {
+      success = false;
+    }
+    if (lep.LEP_SetRadTLinearResolution(portDescP, LEP_RAD_RESOLUTION_0_01) != LEP_OK) {
+      success = false;
+    }
+    if (lep.LEP_SetOemGpioMode(portDescP, LEP_OEM_GPIO_MODE_VSYNC) != LEP_OK) {
+      success = false;
+    }
+  }
+
+  // Flash the LED forever on init failure (the host sees no frames)
+  if (!success) {
+    pinMode(LED_BUILTIN, OUTPUT);
+    while (1) {
+      digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+      delay(250);
+    }
+  }
+
+  // Enable vsync interrupts
+  EnableImageAcquisition();
+}
+
+
+void loop() {
+  EvalCommands();
+
+  if (sendBufferValid) {
+    // Acquisition continues into the other buffer while this one is sent
+    if (streamOn && Serial.dtr()) {
+      Serial.write((const uint8_t*) sendFrame, sizeof(bridge_frame_t));
+      Serial.send_now();
+      sentFrames++;
+    }
+    sendBufferValid = false;
+  }
+}
+
+
+// Handle single character commands from the host
+void EvalCommands() {
+  switch (Serial.available() ? Serial.read() : 0) {
+    case 'f':
+      // The Lepton's I2C is separate from its SPI so acquisition continues
+      (void) lep.LEP_RunSysFFCNormalization(portDescP);
+      break;
+    case 'p':
+      streamOn = false;
+      break;
+    case 's':
+      streamOn = true;
+      break;
+  }
+}
+
+
+void EnableImageAcquisition() {
+  attachInterrupt(pin_lepton_vsync, vsyncHandler, RISING);
+
+  // Configure the SPI library to be able to run in the ISR
+  SPI.usingInterrupt(pin_lepton_vsync);
+}
+
+
+//
+// VSYNC ISR
+//   - Select the Lepton and start the DMA of the first packet of the segment
+//   - The rest of the segment is read by dmaCompleteHandler
+//
+void vsyncHandler() {
+  if (captureActive) {
+    // Still reading the previous segment
+    return;
+  }
+
+  captureActive = true;
+  segmentDone = false;
+  segStartUsec = micros();
+  vospi_asm_start_segment(&segAsm);
+  dmaPacketIndex = 0;
+
+  // The transaction (and CS) is held for the whole segment
+  SPI.beginTransaction(SPISettings(LEP_SPI_CLOCK, MSBFIRST, SPI_MODE1));
+  digitalWriteFast(pin_lepton_cs, LOW);
+  SPI.transfer(dmaTxPacket, dmaPacket[0], LEP_PKT_LENGTH, dmaEvent);
+}
+
+
+//
+// DMA complete ISR
+//   - Start the DMA of the next packet into the other half of the packet area
+//   - Process the packet that just arrived, advancing the segment state
+//   - Release the SPI bus after the packet in flight when the segment is done
+//
+void dmaCompleteHandler(EventResponderRef event) {
+  uint8_t* pkt = dmaPacket[dmaPacketIndex];
+
+  if (segmentDone) {
+    digitalWriteFast(pin_lepton_cs, HIGH);
+    SPI.endTransaction();
+    captureActive = false;
+    return;
+  }
+
+  dmaPacketIndex ^= 1;
+  SPI.transfer(dmaTxPacket, dmaPacket[dmaPacketIndex], LEP_PKT_LENGTH, dmaEvent);
+
+  segmentDone = !ProcessDmaPacket(pkt);
+}
+
+
+//
+// Process one packet of a segment read by DMA with the segment assembler
+//   - Data loaded into acqFrame
+//   - Buffers swapped and sendBufferValid flag set when all 4 segments have been read
+//     for a frame and loop() is done sending the previous one
+//   - Returns false when the segment is complete (or failed)
+//
+bool ProcessDmaPacket(uint8_t* pkt) {
+  int rsp;
+  bridge_frame_t* t;
+
+  rsp = vospi_asm_packet(&segAsm, pkt);
+  if (!(rsp & VOSPI_ASM_VALID)) {
+    // Discard packet, keep looking for data within this segment interval
+    return (AbsDiff32u(segStartUsec, micros()) <= LEP_MAX_FRAME_DELAY_USEC);
+  }
+
+  if (rsp & VOSPI_ASM_STORE_IMAGE) {
+    CopyPacketToBuffer(pkt, segAsm.dst, acqFrame->pixels);
+  }
+
+  if (rsp & VOSPI_ASM_FRAME) {
+    acqFrame->hdr.seq = frameSeq++;
+    acqFrame->hdr.timestamp_usec = (int64_t) MicrosSinceBoot();
+    if (!sendBufferValid) {
+      // Flip/flop the frame buffers
+      t = sendFrame;
+      sendFrame = acqFrame;
+      acqFrame = t;
+      sendBufferValid = true;
+    } else {
+      droppedFrames++;
+    }
+  }
+
+  return !(rsp & VOSPI_ASM_DONE);
+}
+
+
+// Store the big-endian pixels of image packet dst in host (little-endian) order
+void CopyPacketToBuffer(uint8_t* pkt, int dst, uint16_t* buf) {
+  uint8_t* lepPopPtr = &pkt[4];
+  uint16_t* acqPushPtr = &buf[dst * (LEP_WIDTH/2)];
+
+  while (lepPopPtr <= &pkt[162]) {
+    *acqPushPtr++ = (lepPopPtr[0] << 8) | lepPopPtr[1];
+    lepPopPtr += 2;
+  }
+}
+
+
+// micros() extended to 64 bits (called at least once a frame so it sees every wrap)
+uint64_t MicrosSinceBoot() {
+  uint32_t t = micros();
+
+  if (t < prevMicros) {
+    microsHigh += 0x100000000ULL;
+  }
+  prevMicros = t;
+  return microsHigh | t;
+}
+
+
+uint32_t AbsDiff32u(uint32_t n1, uint32_t n2) {
+  if (n2 >= n1) {
+    return (n2-n1);
+  } else {
+    return (n2-n1+0xFFFFFFFF);
+  }
+}
@@ -9,7 +9,26 @@
  *   - Uses Lepton VSYNC output
  *   - Uses hardware platform with modified Sparkfun LiPo charger + power button + rocker button
  * 
- * Gets about 4.4 Hz refresh rate
+ * Uses the LeptonVoSPI library to acquire continuously into ping-pong frame buffers and to display in
+ * bands between segments so the Lepton doesn't have to resync after each displayed frame
+ * 
+ * The spot meter is read with the library's asynchronous CCI commands (sequenced from the I2C interrupt)
+ * so the display never waits for the Lepton.  The value shown is from the previous request.  (The 8-bit
+ * AGC frame holds no temperatures so they can't be found from the pixels as lep_test9 does.)  The status
+ * line only redraws the characters that change.
+ * 
+ * Define LEP_DMA_CAPTURE to read segments with the SPI FIFO and eDMA instead of in the VSYNC ISR
+ *   - Each packet is DMAed into one half of a double-buffered packet area while the other half is processed
+ *   - Segment state is advanced in the DMA complete ISR (the VSYNC ISR just starts the first packet)
+ *   - Acquisition runs continuously into a second frame buffer, frames are swapped when the display is done
+ *   - The display is drawn in bands between segments (the LCD and Lepton share the SPI bus)
+ *   - Requires Teensyduino 1.42 or later (asynchronous SPI transfers)
+ * 
+ * Define LEP_DMA_DISPLAY (with LEP_DMA_CAPTURE) to also DMA the display
+ *   - Each segment is drawn as soon as it has been read instead of waiting for the complete frame
+ *   - Lepton lines are expanded through a byte-swapped color map into a pair of line buffers,
+ *     one is DMAed to the LCD while the next is expanded
+ *   - Keeps up with the Lepton's 8.7 Hz frame rate
  * 
  * Operation
  *   - Press and hold power switch to startup (release when you see the display clear as teensy code is running)
@@ -48,16 +67,20 @@
  */
 #include <SPI.h>
 #include <LeptonSDKEmb32OEM.h>
+#include <LeptonVoSPI.h>
 #include "Adafruit_GFX.h"
 #include "Adafruit_ILI9341.h"
 #include "colormaps.h"
 
-#define LEP_MAX_FRAME_DELAY_USEC 9450
+// Uncomment to capture segments using DMA
+//#define LEP_DMA_CAPTURE
+
+// Uncomment to also write the display using DMA, drawing each segment as it arrives
+//#define LEP_DMA_DISPLAY
 
-#define LEP_WIDTH      160
-#define LEP_HEIGHT     120
-#define LEP_NUM_PIXELS (LEP_WIDTH*LEP_HEIGHT)
-#define LEP_PKT_LENGTH 164
+#if defined(LEP_DMA_DISPLAY) && !defined(LEP_DMA_CAPTURE)
+#error "LEP_DMA_DISPLAY requires LEP_DMA_CAPTURE"
+#endif
 
 // Rocker Buttons
 #define L_B_MASK 0x01
@@ -82,16 +105,41 @@ Adafruit_ILI9341 tft = Adafruit_ILI9341(pin_tft_cs, pin_tft_dc);
 LEP_CAMERA_PORT_DESC_T portDesc;
 LEP_CAMERA_PORT_DESC_T_PTR portDescP = &portDesc;
 
-//Array to store one Lepton packet
-static uint8_t lepPacket[LEP_PKT_LENGTH];
+// Lepton Frame buffers (8-bit for AGC values) - one displayed while the other is acquired
+static uint8_t lepFrames[2][LEP_NUM_PIXELS];
+static uint8_t* lepBuffer = lepFrames[0];
 
-// Lepton Frame buffer (8-bit for AGC values)
-static uint8_t lepBuffer[LEP_WIDTH*LEP_HEIGHT];
+#ifdef LEP_DMA_CAPTURE
+// Double-buffered packet area (one packet is DMAed in while the other is processed)
+static uint8_t dmaPacket[2][LEP_PKT_LENGTH];
+static uint8_t dmaTxPacket[LEP_PKT_LENGTH];   // Zeros clocked out while reading
+volatile int dmaPacketIndex;
+EventResponder dmaEvent;
+
+// Segment capture state (owned by the VSYNC and DMA complete ISRs)
+volatile bool captureActive = false;          // Segment being read (the Lepton has the SPI bus)
+volatile bool segmentDone;                    // Stop after the packet in flight
+uint32_t segStartUsec;
+vospi_asm_t segAsm;                           // Segment assembler
+
+static uint8_t* acqBuffer = lepFrames[1];
 
 volatile bool dispBufferValid = false;
 
-volatile int curSegment = 1;
-volatile bool validSegmentRegion = false;
+
+#ifdef LEP_DMA_DISPLAY
+// Display is drawn LEP_DISP_BAND_LINES Lepton lines at a time between segments
+int dispLine = LEP_DISP_FIRST_LINE;
+
+// Lepton lines of lepBuffer that have been acquired (lepBuffer is drawn as it is acquired)
+volatile int dispRowsReady;
+
+// Line buffers holding one pixel-doubled Lepton line (two LCD lines) in LCD byte order
+static uint16_t dispLineBuf[2][2*2*LEP_WIDTH];
+volatile bool dispDmaActive = false;
+EventResponder dispEvent;
+#endif
+#endif
 
 // GUI
 #define NUM_GUI_CONTROLS 2
@@ -102,6 +150,9 @@ int curGuiSelector = GUI_LUT;
 // NUM_COLORMAPS includes grayscale as index 0
 #define NUM_COLORMAPS 4
 static uint16_t colorMap[256];
+#ifdef LEP_DMA_DISPLAY
+static uint16_t colorMapSwapped[256];   // Byte-swapped for DMA to the LCD
+#endif
 int colorMapSelector = 0;
 
 // RAD Flux Linear Parameters
@@ -116,8 +167,31 @@ int colorMapSelector = 0;
 //    0x734B
 #define EMISSIVITY_STEP 5
 LEP_RAD_FLUX_LINEAR_PARAMS_T radFluxParms;
+
+// Asynchronous spot meter read
+LEP_ASYNC_CMD_T spotCmd;
+LEP_RAD_SPOTMETER_OBJ_KELVIN_T spotVal;
+bool spotPending = false;
+int16_t spotTemp = 0;
 uint16_t curEmissivityInt = 100;            // 0 - 100 %
 
+// Status line text fields.  Each remembers the characters it shows so only the glyph
+// cells that change are redrawn.
+typedef struct {
+  int16_t x;
+  int16_t len;           // Character cells
+  char text[12];
+} TextField;
+
+#define STATUS_Y 5
+
+TextField lutSelField   = {4, 1};
+TextField lutField      = {10, 10};
+TextField spotField     = {160, 4};
+TextField emSelField    = {214, 1};
+TextField emField       = {220, 4};
+TextField battField     = {280, 5};
+
 
 void setup() {
   bool success = true;
@@ -127,9 +201,20 @@ void setup() {
   
   Serial.begin(115200);
   
+#ifdef LEP_DMA_CAPTURE
   pinMode(pin_lepton_cs, OUTPUT);
   digitalWrite(pin_lepton_cs, HIGH);
   pinMode(pin_lepton_vsync, INPUT);
+
+  // Advance the segment state directly from the DMA complete interrupt
+  vospi_asm_init(&segAsm, 0);
+  dmaEvent.attachImmediate(dmaCompleteHandler);
+#ifdef LEP_DMA_DISPLAY
+  dispEvent.attachImmediate(dispDmaCompleteHandler);
+#endif
+#else
+  LepVoSPI.begin(pin_lepton_cs, pin_lepton_vsync, LEP_VOSPI_AGC8, lepFrames[0], lepFrames[1]);
+#endif
   
   tft.begin();
   tft.setRotation(1);
@@ -143,7 +228,7 @@ void setup() {
   tft.setTextSize(2);
   tft.setTextColor(ILI9341_CYAN);
   tft.println("lep_test10");
-  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 100, portDescP) != LEP_OK) {
+  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 1000, portDescP) != LEP_OK) {
     tft.println("LEP Open failed");
   } else {   
     if (lep.LEP_GetRadFluxLinearParams(portDescP, &radFluxParms) != LEP_OK) {
@@ -211,11 +296,19 @@ void setup() {
   tft.fillScreen(ILI9341_BLACK);
   
   // Enable vsync interrupts
+#ifdef LEP_DMA_CAPTURE
   EnableImageAcquisition();
+#else
+  LepVoSPI.enable();
+#endif
 }
 
 
 void loop() {
+#ifdef LEP_DMA_CAPTURE
+  int t;
+#endif
+
   EvalControls();
 
   if (PowerDownDetected()) {
@@ -242,16 +335,31 @@ void loop() {
         UpdateEmissivity();
       }
     } 
+#ifdef LEP_DMA_CAPTURE
   } else if (dispBufferValid) {
+    // Acquisition continues while the display is drawn
+    if (dispFullColorImageBand()) {
+      t = GetSpotMeter();
+      while (!BeginDisplayAccess()) {};
+      dispStatusLine(t);
+      EndDisplayAccess();
+      dispBufferValid = false;
+    }
+#else
+  } else if (LepVoSPI.frameAvailable()) {
+    // Acquisition continues while the display is drawn a band at a time
+    lepBuffer = LepVoSPI.getFrame();
     //dispColorImage(80, 60, LEP_WIDTH, LEP_HEIGHT);
-    dispFullColorImage();
-    dispStatusLine();
-    dispBufferValid = false;
-    EnableImageAcquisition();
+    if (LepVoSPI.drawFrameBand(&tft, pin_tft_cs, pin_tft_dc, lepBuffer, colorMap)) {
+      dispStatusLine(GetSpotMeter());
+      LepVoSPI.releaseFrame();
+    }
+#endif
   }
 }
 
 
+#ifdef LEP_DMA_CAPTURE
 void EnableImageAcquisition() {
   attachInterrupt(pin_lepton_vsync, vsyncHandler, RISING);
   
@@ -267,134 +375,139 @@ void DisableImageAcquisition() {
 
 
 //
-// VSYNC ISR
-//   - Attempt to read a complete segment from the Lepton
-//   - Data loaded into lepBuffer
-//   - dispBufferValid flag set when all 4 segments have been read for a frame
-//     - Image acquisition disabled to allow main code time to display (it must re-enable acquisition)
-// 
-void vsyncHandler() {
-  uint32_t startUsec;
-  uint8_t line, prevLine;
-  uint8_t segment;
-  bool done = false;
-  bool beforeValidData = true;
-
-  startUsec = micros();
-  prevLine = 255;
-
-  while (!done) {
-    if (ProcessPacket(&line, &segment)) {
-      // Saw a valid packet
-      if (line == prevLine) {
-        // This is garbage data since line numbers should always increment
-        done = true;
-      } else {
-        // Check for termination or completion conditions
-        if (line == 20) {
-          // Check segment
-          if (!validSegmentRegion) {
-            // Look for start of valid segment data
-            if (segment == 1) {
-              beforeValidData = false;
-              validSegmentRegion = true;
-            }
-          } else if ((segment < 2) || (segment > 4)) {
-            // Hold/Reset in starting position (always collecting in segment 1 buffer locations)
-            validSegmentRegion = false;  // In case it was set
-            curSegment = 1;
-          }
-        } 
-        
-        // Copy the data to the lepton frame buffer
-        //  - beforeValidData is used to collect data before we know if the current segment (1) is valid
-        //  - then we use validSegmentRegion for remaining data once we know we're seeing valid data
-        if ((beforeValidData || validSegmentRegion) && (line <= 59)) {
-          CopyPacketToBuffer(line);
-        }
-        
-        if (line == 59) {
-          // Saw a complete segment, move to next segment or complete frame aquisition if possible
-          if (validSegmentRegion) {
-            if (curSegment < 4) {
-              // Setup to get next segment
-              curSegment++;
-            } else {
-              // Got frame, see if we can flip/flop the frame buffer (other process is done with previous buffer)
-              if (!dispBufferValid) {
-                // Hand this buffer over to other process
-                dispBufferValid = true;
-                DisableImageAcquisition();
-              }
-              // Setup to get the next frame
-              curSegment = 1;
-              validSegmentRegion = false;
-            }
-          }
-          done = true;
-        }
-      }
-      prevLine = line;
-    } else if (AbsDiff32u(startUsec, micros()) > LEP_MAX_FRAME_DELAY_USEC) {
-      // Did not see a valid packet within this segment interval
-      done = true;
-    }
+// Get the SPI bus for the display between segments.  Holds off the VSYNC interrupt
+// (a VSYNC that occurs is handled late when access ends).  Returns false if a segment
+// is being read.
+//
+bool BeginDisplayAccess() {
+  NVIC_DISABLE_IRQ(IRQ_PORTA);
+  if (captureActive) {
+    NVIC_ENABLE_IRQ(IRQ_PORTA);
+    return false;
   }
+  return true;
 }
 
 
-//
-// This routine attempts to read one RGB packet from the lepton
-//   - Return false for discard packets
-//   - Return true otherwise
-//     - line contains the packet line number for all valid packets
-//     - seg contains the packet segment number if the line number is 20
-//
-bool ProcessPacket(uint8_t* line, uint8_t* seg) {
-  bool valid = false;
+void EndDisplayAccess() {
+  NVIC_ENABLE_IRQ(IRQ_PORTA);
+}
 
-  *seg = 0;
+
+//
+// VSYNC ISR (DMA version)
+//   - Select the Lepton and start the DMA of the first packet of the segment
+//   - The rest of the segment is read by dmaCompleteHandler
+// 
+void vsyncHandler() {
+  if (captureActive) {
+    // Still reading the previous segment
+    return;
+  }
   
-  SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE1));
+  captureActive = true;
+  segmentDone = false;
+  segStartUsec = micros();
+  vospi_asm_start_segment(&segAsm);
+  dmaPacketIndex = 0;
 
-  //Start transfer  - CS LOW
+  // The transaction (and CS) is held for the whole segment
+  SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE1));
   digitalWriteFast(pin_lepton_cs, LOW);
+  SPI.transfer(dmaTxPacket, dmaPacket[0], LEP_PKT_LENGTH, dmaEvent);
+}
 
-  SPI.transfer(lepPacket, LEP_PKT_LENGTH);
 
-  //Repeat as long as the frame is not valid, equals sync
-  if ((lepPacket[0] & 0x0F) == 0x0F) {
-    valid = false;
-  } else {
-    *line = lepPacket[1];
+//
+// DMA complete ISR
+//   - Start the DMA of the next packet into the other half of the packet area
+//   - Process the packet that just arrived, advancing the segment state
+//   - Release the SPI bus after the packet in flight when the segment is done
+//
+void dmaCompleteHandler(EventResponderRef event) {
+  uint8_t* pkt = dmaPacket[dmaPacketIndex];
+
+  if (segmentDone) {
+    digitalWriteFast(pin_lepton_cs, HIGH);
+    SPI.endTransaction();
+    captureActive = false;
+    return;
+  }
+
+  dmaPacketIndex ^= 1;
+  SPI.transfer(dmaTxPacket, dmaPacket[dmaPacketIndex], LEP_PKT_LENGTH, dmaEvent);
+
+  segmentDone = !ProcessDmaPacket(pkt);
+}
 
-    // Get segment when possible
-    if (*line == 20) {
-      *seg = (lepPacket[0] >> 4);
-    }
 
-    valid = true;
+//
+// Process one packet of a segment read by DMA with the segment assembler
+//   - Data loaded into acqBuffer
+//   - Buffers swapped and dispBufferValid flag set when all 4 segments have been read
+//     for a frame and the main code is done displaying the previous one
+//   - With LEP_DMA_DISPLAY the frame is handed to the main code as soon as a segment has
+//     been read if it is done displaying the previous one
+//   - Returns false when the segment is complete (or failed)
+//
+bool ProcessDmaPacket(uint8_t* pkt) {
+  int rsp;
+#ifndef LEP_DMA_DISPLAY
+  uint8_t* t;
+#endif
+  
+  rsp = vospi_asm_packet(&segAsm, pkt);
+  if (!(rsp & VOSPI_ASM_VALID)) {
+    // Discard packet, keep looking for data within this segment interval
+    return (AbsDiff32u(segStartUsec, micros()) <= LEP_MAX_FRAME_DELAY_USEC);
   }
 
-  //End transfer - CS HIGH
-  digitalWriteFast(pin_lepton_cs, HIGH);
+  if (rsp & VOSPI_ASM_STORE_IMAGE) {
+    CopyPacketToBuffer(pkt, segAsm.dst, acqBuffer);
+  }
 
-  //End SPI Transaction
-  SPI.endTransaction();
+  if (rsp & VOSPI_ASM_SEGMENT) {
+#ifdef LEP_DMA_DISPLAY
+    // Start drawing this frame if the display is done with the previous one
+    if (!dispBufferValid) {
+      lepBuffer = acqBuffer;
+      dispBufferValid = true;
+    }
+    if (lepBuffer == acqBuffer) {
+      dispRowsReady = segAsm.seg * 30;
+    }
+    
+    if (rsp & VOSPI_ASM_FRAME) {
+      // Acquire the next frame into the other buffer if this one is being drawn
+      if (lepBuffer == acqBuffer) {
+        acqBuffer = (acqBuffer == lepFrames[0]) ? lepFrames[1] : lepFrames[0];
+      }
+    }
+#else
+    if ((rsp & VOSPI_ASM_FRAME) && !dispBufferValid) {
+      // Flip/flop the frame buffers (otherwise this frame is dropped)
+      t = lepBuffer;
+      lepBuffer = acqBuffer;
+      acqBuffer = t;
+      dispBufferValid = true;
+    }
+#endif
+  }
 
-  return(valid);
+  return !(rsp & VOSPI_ASM_DONE);
 }
 
 
-void CopyPacketToBuffer(uint8_t line) {
-  uint8_t* lepPopPtr = &lepPacket[5];  // Only going to copy the low bytes
-  uint8_t* acqPushPtr = &lepBuffer[((curSegment-1) * 30 * LEP_WIDTH) + (line * (LEP_WIDTH/2))];
+void CopyPacketToBuffer(uint8_t* pkt, int dst, uint8_t* buf) {
+  uint8_t* lepPopPtr = &pkt[5];  // Only going to copy the low bytes
+  uint8_t* acqPushPtr = &buf[dst * (LEP_WIDTH/2)];
 
-  while (lepPopPtr <= &lepPacket[163]) {
+  while (lepPopPtr <= &pkt[163]) {
     *acqPushPtr++ = *lepPopPtr;
     lepPopPtr += 2;
   }
 }
+#endif
 
 
 uint32_t AbsDiff32u(uint32_t n1, uint32_t n2) {
@@ -416,15 +529,23 @@ void UpdateEmissivity()
 }
 
 
+// Returns the most recent spot meter reading and starts the next one
 int16_t GetSpotMeter()
 {
-  LEP_RAD_SPOTMETER_OBJ_KELVIN_T spotVal;
+  if (spotPending && spotCmd.done) {
+    spotPending = false;
+    if (spotCmd.result == LEP_OK) {
+      spotTemp = round(spotVal.radSpotmeterValue / 100.0 - 273.16);
+    }
+  }
 
-  if (lep.LEP_GetRadSpotmeterObjInKelvinX100(portDescP, &spotVal) == LEP_OK) {
-    return (round(spotVal.radSpotmeterValue / 100.0 - 273.16));
+  if (!spotPending) {
+    if (lep.LEP_GetRadSpotmeterObjInKelvinX100Async(portDescP, &spotCmd, &spotVal, NULL, NULL) == LEP_OK) {
+      spotPending = true;
+    }
   }
 
-  return 0;
+  return spotTemp;
 }
 
 
@@ -448,111 +569,137 @@ void dispColorImage(int16_t x, int16_t y, int16_t w, int16_t h)
 }
 
 
-// Fast routine to display pixel-doubled image to fill LCD
-void dispFullColorImage()
+#ifdef LEP_DMA_DISPLAY
+// Display the next band of acquired lines of the pixel-doubled image between segments
+// using DMA.  Returns true when the whole image has been drawn.
+bool dispFullColorImageBand()
 {
-  int16_t x, y;
+  int16_t y, n;
   uint16_t pixel;
-  uint8_t* ptr;
+  uint16_t* buf;
+
+  n = dispRowsReady - dispLine;
+  if (n <= 0) {
+    return false;
+  }
+  if (n > LEP_DISP_BAND_LINES) n = LEP_DISP_BAND_LINES;
+  
+  if (!BeginDisplayAccess()) {
+    return false;
+  }
 
-  // Copy the data to the frame buffer expanding via the colormap (skip the first 10 lines of data)
   SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE0));
   digitalWrite(pin_tft_cs, LOW);
   digitalWrite(pin_tft_dc, LOW);
-  tft.setAddrWindow(0, 20, 320, 240);
+  tft.setAddrWindow(0, 2*dispLine, 320, 2*n);
   digitalWrite(pin_tft_dc, HIGH);
-  for(y=20; y<2*LEP_HEIGHT; y=y+2) {
-    // Line 1
-    ptr = &lepBuffer[y/2*LEP_WIDTH];
-    for(x=0; x<LEP_WIDTH; x++) {
-      pixel = colorMap[*ptr++];
-      SPI.transfer16(pixel);
-      SPI.transfer16(pixel);
-    }
-    // Line 2
-    ptr = &lepBuffer[y/2*LEP_WIDTH];
-    for(x=0; x<LEP_WIDTH; x++) {
-      pixel = colorMap[*ptr++];
-      SPI.transfer16(pixel);
-      SPI.transfer16(pixel);
-    }
+  for (y=0; y<n; y++) {
+    // Expand this line while the previous one is DMAed from the other buffer
+    buf = dispLineBuf[y & 1];
+    ExpandDisplayLine(&lepBuffer[(dispLine + y)*LEP_WIDTH], buf);
+    while (dispDmaActive) {};
+    dispDmaActive = true;
+    SPI.transfer(buf, NULL, sizeof(dispLineBuf[0]), dispEvent);
   }
+  while (dispDmaActive) {};
   SPI.endTransaction();
   digitalWrite(pin_tft_cs, HIGH);
 
-  // Draw an inverted pixel at the center
-  pixel = ~colorMap[lepBuffer[LEP_NUM_PIXELS/2 + (LEP_WIDTH/2)]];
-  tft.fillRect(159, 119, 2, 2, pixel);
+  dispLine += n;
+  if (dispLine == LEP_HEIGHT) {
+    // Draw an inverted pixel at the center
+    pixel = ~colorMap[lepBuffer[LEP_NUM_PIXELS/2 + (LEP_WIDTH/2)]];
+    tft.fillRect(159, 119, 2, 2, pixel);
+    dispLine = LEP_DISP_FIRST_LINE;
+  }
+  
+  EndDisplayAccess();
+  
+  return (dispLine == LEP_DISP_FIRST_LINE);
 }
 
 
-void dispStatusLine() {
-  static int prevGuiSelector = -1;
-  static int prevColorMapSelector = -1;
-  static int prevTcur = 999;
-  static uint8_t prevEmissivity = 255;
-  static float prevBattVolts = 0;
-  int t;
+// Expand one Lepton line into two pixel-doubled LCD lines for DMA
+void ExpandDisplayLine(uint8_t* src, uint16_t* dst)
+{
+  uint16_t* dst2 = dst + 2*LEP_WIDTH;
+  uint16_t pixel;
+  int16_t x;
+
+  for (x=0; x<LEP_WIDTH; x++) {
+    pixel = colorMapSwapped[*src++];
+    *dst++ = pixel;
+    *dst++ = pixel;
+    *dst2++ = pixel;
+    *dst2++ = pixel;
+  }
+}
 
-  tft.setTextColor(ILI9341_YELLOW);
-  tft.setTextSize(1);
 
+void dispDmaCompleteHandler(EventResponderRef event) {
+  dispDmaActive = false;
+}
+#elif defined(LEP_DMA_CAPTURE)
+// Display the next band of the pixel-doubled image between segments.  Returns true when
+// the whole image has been drawn.
+bool dispFullColorImageBand()
+{
+  bool done;
   
-  // Colormap
-  if (prevGuiSelector != curGuiSelector) {
-    tft.fillRect(4, 5, 5, 8, ILI9341_BLACK);
-    tft.setCursor(4, 5);
-    if (curGuiSelector == GUI_LUT) {
-      tft.print(">");
-    }
+  if (!BeginDisplayAccess()) {
+    return false;
   }
-  if (prevColorMapSelector != colorMapSelector) {
-    tft.fillRect(10, 5, 75, 8, ILI9341_BLACK);
-    tft.setCursor(10, 5);
-    switch (colorMapSelector) {
-      case 1: tft.print("Golden"); break;
-      case 2: tft.print("Rainbow"); break;
-      case 3: tft.print("Iron Black"); break;
-      default: tft.print("Grayscale"); break;
+  done = LepVoSPI.drawFrameBand(&tft, pin_tft_cs, pin_tft_dc, lepBuffer, colorMap);
+  EndDisplayAccess();
+
+  return done;
+}
+#endif
+
+
+// Show s in field f, drawing only the cells that differ from what is shown
+void dispTextField(TextField* f, const char* s) {
+  char c;
+  int i;
+
+  for (i=0; i<f->len; i++) {
+    c = (*s != 0) ? *s++ : ' ';
+    if (c != f->text[i]) {
+      // The classic font cell is 6x8 including the background
+      tft.drawChar(f->x + 6*i, STATUS_Y, c, ILI9341_YELLOW, ILI9341_BLACK, 1);
+      f->text[i] = c;
     }
-    prevColorMapSelector = colorMapSelector;
   }
+}
 
-  // Temp
-  t = GetSpotMeter();
-  if (prevTcur != t) {
-    tft.fillRect(160, 5, 30, 8, ILI9341_BLACK);
-    tft.setCursor(160, 5);
-    tft.print(t);
-    prevTcur = t;
+
+// Display the status line with spot meter temperature t (read before drawing since it
+// uses I2C)
+void dispStatusLine(int t) {
+  char buf[12];
+
+  // Colormap
+  dispTextField(&lutSelField, (curGuiSelector == GUI_LUT) ? ">" : "");
+  switch (colorMapSelector) {
+    case 1: dispTextField(&lutField, "Golden"); break;
+    case 2: dispTextField(&lutField, "Rainbow"); break;
+    case 3: dispTextField(&lutField, "Iron Black"); break;
+    default: dispTextField(&lutField, "Grayscale"); break;
   }
 
+  // Temp
+  sprintf(buf, "%d", t);
+  dispTextField(&spotField, buf);
+
   // Emissivity
-  if (prevGuiSelector != curGuiSelector) {
-    tft.fillRect(214, 5, 5, 8, ILI9341_BLACK);
-    tft.setCursor(214, 5);
-    if (curGuiSelector == GUI_EM) {
-      tft.print(">");
-    }
-  }
-  if (prevEmissivity != curEmissivityInt) {
-    tft.fillRect(220, 5, 40, 8, ILI9341_BLACK);
-    tft.setCursor(220, 5);
-    tft.print(curEmissivityInt);
-    tft.print("%");
-    prevEmissivity = curEmissivityInt;
-  }
-  
-  // Battery
-  if (abs(prevBattVolts - GetBattVolts()) > 0.005) {
-    tft.fillRect(280, 5, 30, 8, ILI9341_BLACK);
-    tft.setCursor(280, 5);
-    tft.print(GetBattVolts());
-    tft.print("v");
-    prevBattVolts = GetBattVolts();
-  }
+  dispTextField(&emSelField, (curGuiSelector == GUI_EM) ? ">" : "");
+  sprintf(buf, "%d%%", curEmissivityInt);
+  dispTextField(&emField, buf);
 
-  prevGuiSelector = curGuiSelector;
+  // Battery
+  dtostrf(GetBattVolts(), 4, 2, buf);
+  strcat(buf, "v");
+  dispTextField(&battField, buf);
 }
 
 
@@ -573,6 +720,9 @@ void initColorMap() {
     g = *ptr++ >> 2;
     b = *ptr++ >> 3;
     colorMap[i] = (r << 11) | (g << 5) | b;
+#ifdef LEP_DMA_DISPLAY
+    colorMapSwapped[i] = (colorMap[i] >> 8) | (colorMap[i] << 8);
+#endif
   }
 }
 
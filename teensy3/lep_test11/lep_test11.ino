@@ -0,0 +1,770 @@
+/*
+ * test Lepton 3.5 - for teensy 4.0/4.1 w/ LEP (600 MHz w/ Faster optimizations)
+ *   - A port of lep_test10 to the Teensy 4 using 16-bit radiometric data
+ *   - Enable TLinear (0.01 K resolution) with the Lepton's AGC disabled
+ *   - 16-bit frames are mapped to the color map on the teensy with a linear or histogram
+ *     equalization (HEQ) AGC computed from each frame's own range
+ *   - Allow user to change emissivity
+ *   - Output display on ILI9341 320x240 pixel LCD display
+ *   - Display current color map, AGC mode, spot temp, emissivity % and battery voltage
+ *   - Rocker selection of color map, AGC mode or emissivity percent
+ *   - Uses Lepton VSYNC output
+ *   - Uses hardware platform with modified Sparkfun LiPo charger + power button + rocker button
+ *     (the Teensy 4.0 fits the Teensy 3.2 footprint)
+ *
+ * Acquisition
+ *   - Each packet is DMAed (LPSPI eDMA through the SPI library's asynchronous transfers) into one
+ *     half of a double-buffered packet area at 20 MHz while the other half is processed
+ *   - Segment state is advanced in the DMA complete ISR (the VSYNC ISR just starts the first packet)
+ *   - Two complete 16-bit frames fit in the Teensy 4's RAM so acquisition runs continuously into
+ *     one while the other is displayed, frames are swapped when the display is done (otherwise
+ *     the completed frame is dropped)
+ *   - The minimum and maximum pixel are found as packets are stored
+ *   - The spot temperature is the average of the four center pixels of the frame (no I2C)
+ *
+ * Display
+ *   - The AGC and the color map are combined into one 16-bit LUT when a frame is taken
+ *   - Lepton lines are expanded through the LUT into a pair of pixel-doubled line buffers, one is
+ *     DMAed to the LCD while the next is expanded
+ *   - The display is drawn in bands between segments (the LCD and Lepton share the SPI bus)
+ *   - Frame buffers, line buffers and packets are in DTCM (the default for variables) which is not
+ *     cached so the DMA needs no cache maintenance
+ *
+ * Define LEP_SD_RECORD to record every frame to the teensy's SD card (the built-in slot on
+ * the 4.1, the SDIO pads on the 4.0) with the LeptonRecorder library
+ *   - Send 'r' over the serial port to start or stop recording and 's' for its statistics
+ *   - Frames are copied into the recorder's double buffer when they are complete and written
+ *     from loop() so a slow card never holds up acquisition (the display may skip frames)
+ *   - Writes .lrf files, the same container as the PocketBeagle's pru_record
+ *
+ * Operation
+ *   - Press and hold power switch to startup (release when you see the display clear as teensy code is running)
+ *   - Press power switch again to power down
+ *   - Rocker switch downward press selects between color map, AGC or emissivity mode
+ *   - Rocker swtich left/right selects
+ *     - between color maps in color map mode
+ *     - between linear and HEQ in AGC mode
+ *     - between emissivity values (5% increments) in emissivity mode (0-100%)
+ *
+ * Connections (same pins as lep_test10)
+ *   D0 - Active Low Right Switch Input
+ *   D1 - Active Low Left Switch Input
+ *   D2 - Lepton nCS output
+ *   D3 - Lepton VSYNC input
+ *   D4 - SD Card (on LCD) nCS output (unused)
+ *   D7 - Active High Power Enable/Hold Output (LCD Backlight enable)
+ *   D8 - Active Low Push Switch Input
+ *   D9 - LCD DC control signal output
+ *   D10- LCD nCS output
+ *   D11 - SPI MOSI (to LCD)
+ *   D12 - SPI MISO (to Lepton)
+ *   D13 - SPI SCK output (to Lepton and LCD)
+ *   A4 - I2C SDA0 (to Lepton) with external 4.7 k pull-up to 3V3
+ *   A5 - I2C SCL0 (to Lepton) with external 4.7 k pull-up to 3V3
+ *   A6 - Power Button SNS input
+ *   A7 - Battery SNS input
+ *
+ * Requires the LeptonSDKEmb32OEM library (which uses Wire on the Teensy 4) and the top-level vospi_asm
+ * directory in your Arduino libraries folder.
+ *
+ * Software released "as-is" for instructional use.  No warranty as to correctness or fitness for any application.
+ *
+ * Written (or, more accurately, hacked together) by Dan Julio
+ *
+ */
+#include <SPI.h>
+#include <EventResponder.h>
+#include <LeptonSDKEmb32OEM.h>
+#include <vospi_asm.h>
+#include "Adafruit_GFX.h"
+#include "Adafruit_ILI9341.h"
+#include "colormaps.h"
+
+// Uncomment to record frames to the SD card
+//#define LEP_SD_RECORD
+
+#ifdef LEP_SD_RECORD
+#include <SdFat.h>
+#include <LeptonRecorder.h>
+#endif
+
+#if !defined(__IMXRT1062__)
+#error "lep_test11 requires a Teensy 4.0 or 4.1 (use lep_test10 on a Teensy 3.2)"
+#endif
+
+#define LEP_MAX_FRAME_DELAY_USEC 9450
+
+#define LEP_WIDTH      160
+#define LEP_HEIGHT     120
+#define LEP_NUM_PIXELS (LEP_WIDTH*LEP_HEIGHT)
+#define LEP_PKT_LENGTH 164
+
+#define LEP_SPI_CLOCK  20000000
+#define LCD_SPI_CLOCK  30000000
+
+// Display: the first lines of the image are skipped to leave room for a status line and
+// the image is drawn LEP_DISP_BAND_LINES lines at a time (about 1.4 mSec at 30 MHz)
+#define LEP_DISP_FIRST_LINE 10
+#define LEP_DISP_BAND_LINES 4
+
+// All fast GPIO pins (including VSYNC) share one interrupt
+#define LEP_VSYNC_IRQ  IRQ_GPIO6789
+
+// AGC: pixels are binned over the frame's range into at most AGC_BINS bins
+#define AGC_BINS       1024
+#define AGC_LINEAR     0
+#define AGC_HEQ        1
+
+// Rocker Buttons
+#define L_B_MASK 0x01
+#define P_B_MASK 0x02
+#define R_B_MASK 0x04
+
+// IO Pins
+const int pin_lepton_cs = 2;
+const int pin_lepton_vsync = 3;
+const int pin_tft_dc = 9;
+const int pin_tft_cs = 10;
+
+LeptonSDKEmb32OEM lep;
+
+Adafruit_ILI9341 tft = Adafruit_ILI9341(pin_tft_cs, pin_tft_dc);
+
+LEP_CAMERA_PORT_DESC_T portDesc;
+LEP_CAMERA_PORT_DESC_T_PTR portDescP = &portDesc;
+
+// Lepton Frame buffers (16-bit TLinear values) - one displayed while the other is acquired
+static uint16_t lepFrames[2][LEP_NUM_PIXELS];
+static uint16_t* lepBuffer = lepFrames[0];
+static uint16_t* acqBuffer = lepFrames[1];
+
+// Range of the frame being acquired and of lepBuffer
+static uint16_t acqMin, acqMax;
+static uint16_t lepMin, lepMax;
+
+// Double-buffered packet area (one packet is DMAed in while the other is processed)
+static uint8_t dmaPacket[2][LEP_PKT_LENGTH];
+static uint8_t dmaTxPacket[LEP_PKT_LENGTH];   // Zeros clocked out while reading
+volatile int dmaPacketIndex;
+EventResponder dmaEvent;
+
+// Segment capture state (owned by the VSYNC and DMA complete ISRs)
+volatile bool captureActive = false;          // Segment being read (the Lepton has the SPI bus)
+volatile bool segmentDone;                    // Stop after the packet in flight
+uint32_t segStartUsec;
+vospi_asm_t segAsm;                           // Segment assembler
+
+volatile bool dispBufferValid = false;
+volatile uint32_t droppedFrames = 0;
+
+// Display is drawn LEP_DISP_BAND_LINES Lepton lines at a time between segments
+int dispLine = LEP_DISP_FIRST_LINE;
+
+// Line buffers holding one pixel-doubled Lepton line (two LCD lines) in LCD byte order
+static uint16_t dispLineBuf[2][2*2*LEP_WIDTH];
+volatile bool dispDmaActive = false;
+EventResponder dispEvent;
+
+// GUI
+#define NUM_GUI_CONTROLS 3
+#define GUI_LUT 0
+#define GUI_AGC 1
+#define GUI_EM 2
+int curGuiSelector = GUI_LUT;
+
+// NUM_COLORMAPS includes grayscale as index 0
+#define NUM_COLORMAPS 4
+static uint16_t colorMap[256];
+static uint16_t colorMapSwapped[256];   // Byte-swapped for DMA to the LCD
+int colorMapSelector = 0;
+
+// AGC
+int agcMode = AGC_HEQ;
+static uint32_t agcHist[AGC_BINS];
+static uint16_t dispLut[AGC_BINS];      // AGC + byte-swapped color map for lepBuffer
+int agcShift;                           // (pixel - lepMin) >> agcShift is the bin
+
+// RAD Flux Linear Parameters (see lep_test9)
+#define EMISSIVITY_STEP 5
+LEP_RAD_FLUX_LINEAR_PARAMS_T radFluxParms;
+uint16_t curEmissivityInt = 100;            // 0 - 100 %
+
+float spotTemp = 0;
+
+#ifdef LEP_SD_RECORD
+SdFs sd;
+bool sdPresent = false;
+#endif
+
+
+void setup() {
+  bool success = true;
+
+  // Initialize our controls first to keep power on
+  InitControls();
+
+  Serial.begin(115200);
+
+  pinMode(pin_lepton_cs, OUTPUT);
+  digitalWrite(pin_lepton_cs, HIGH);
+  pinMode(pin_lepton_vsync, INPUT);
+
+  // Advance the segment state directly from the DMA complete interrupt
+  vospi_asm_init(&segAsm, 0);
+  dmaEvent.attachImmediate(dmaCompleteHandler);
+  dispEvent.attachImmediate(dispDmaCompleteHandler);
+
+#ifdef LEP_SD_RECORD
+  sdPresent = sd.begin(SdioConfig(FIFO_SDIO));
+  LepRecorder.begin(&sd, LEP_REC_DEF_FILE_FRAMES);
+#endif
+
+  tft.begin(LCD_SPI_CLOCK);
+  tft.setRotation(1);
+  tft.fillScreen(ILI9341_BLACK);
+
+  initColorMap();
+
+  delay(2000);
+
+  tft.setCursor(0, 20);
+  tft.setTextSize(2);
+  tft.setTextColor(ILI9341_CYAN);
+  tft.println("lep_test11");
+#ifdef LEP_SD_RECORD
+  tft.println(sdPresent ? "SD card found" : "No SD card");
+#endif
+  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 1000, portDescP) != LEP_OK) {
+    tft.println("LEP Open failed");
+    success = false;
+  } else {
+    if (lep.LEP_GetRadFluxLinearParams(portDescP, &radFluxParms) != LEP_OK) {
+      tft.println("Get RAD Flux Linear Parameters failed");
+      success = false;
+    } else {
+      tft.println("Got RAD Flux Linear Parameters");
+    }
+
+    if (lep.LEP_SetAgcEnableState(portDescP, LEP_AGC_DISABLE) != LEP_OK) {
+      tft.println("Set AGC failed");
+      success = false;
+    } else {
+      LEP_AGC_ENABLE_E agcEnable;
+      if (lep.LEP_GetAgcEnableState(portDescP, &agcEnable) != LEP_OK) {
+        tft.println("Get AGC failed");
+        success = false;
+      } else {
+        tft.printf("AGC mode = %d\n", (int) agcEnable);
+      }
+    }
+
+    if (lep.LEP_SetRadTLinearEnableState(portDescP, LEP_RAD_ENABLE) != LEP_OK) {
+      tft.println("Set TLinear Enable failed");
+      success = false;
+    } else {
+      LEP_RAD_ENABLE_E radEnable;
+      if (lep.LEP_GetRadTLinearEnableState(portDescP, &radEnable) != LEP_OK) {
+        tft.println("Get TLinear Enable failed");
+        success = false;
+      } else {
+        tft.printf("TLinear Enable = %d\n", (int) radEnable);
+      }
+    }
+
+    if (lep.LEP_SetRadTLinearResolution(portDescP, LEP_RAD_RESOLUTION_0_01) != LEP_OK) {
+      tft.println("Set TLinear Resolution failed");
+      success = false;
+    }
+
+    if (lep.LEP_SetOemGpioMode(portDescP, LEP_OEM_GPIO_MODE_VSYNC) != LEP_OK) {
+      tft.println("Set GPIO failed");
+    } else {
+      LEP_OEM_GPIO_MODE_E gpioMode;
+      if (lep.LEP_GetOemGpioMode(portDescP, &gpioMode) != LEP_OK) {
+        tft.println("Get GPIO failed");
+      } else {
+        tft.printf("GPIO mode = %d\n", (int) gpioMode);
+      }
+    }
+  }
+
+  while (!success) {};  // Spin forever on init failure
+
+  delay(2000);
+
+  tft.fillScreen(ILI9341_BLACK);
+
+  // Enable vsync interrupts
+  EnableImageAcquisition();
+}
+
+
+void loop() {
+  EvalControls();
+#ifdef LEP_SD_RECORD
+  EvalRecorder();
+#endif
+
+  if (PowerDownDetected()) {
+    PowerDown();
+  } else if (RockerShortPress(P_B_MASK)) {
+    if (++curGuiSelector == NUM_GUI_CONTROLS) curGuiSelector = 0;
+  } else if (RockerShortPress(L_B_MASK)) {
+    if (curGuiSelector == GUI_LUT) {
+      if (--colorMapSelector == -1) colorMapSelector = NUM_COLORMAPS-1;
+      initColorMap();
+    } else if (curGuiSelector == GUI_AGC) {
+      agcMode = (agcMode == AGC_LINEAR) ? AGC_HEQ : AGC_LINEAR;
+    } else if (curGuiSelector == GUI_EM) {
+      if (curEmissivityInt >= EMISSIVITY_STEP) {
+        curEmissivityInt -= EMISSIVITY_STEP;
+        UpdateEmissivity();
+      }
+    }
+  } else if (RockerShortPress(R_B_MASK)) {
+    if (curGuiSelector == GUI_LUT) {
+      if (++colorMapSelector == NUM_COLORMAPS) colorMapSelector = 0;
+      initColorMap();
+    } else if (curGuiSelector == GUI_AGC) {
+      agcMode = (agcMode == AGC_LINEAR) ? AGC_HEQ : AGC_LINEAR;
+    } else if (curGuiSelector == GUI_EM) {
+      if (curEmissivityInt <= (100 - EMISSIVITY_STEP)) {
+        curEmissivityInt += EMISSIVITY_STEP;
+        UpdateEmissivity();
+      }
+    }
+  } else if (dispBufferValid) {
+    // Acquisition continues while the display is drawn
+    if (dispLine == LEP_DISP_FIRST_LINE) {
+      // Starting a new frame
+      ComputeDisplayLut();
+      spotTemp = GetSpotTemp();
+    }
+    if (dispFullColorImageBand()) {
+      while (!BeginDisplayAccess()) {};
+      dispStatusLine(spotTemp);
+      EndDisplayAccess();
+      dispBufferValid = false;
+    }
+  }
+}
+
+
+void EnableImageAcquisition() {
+  attachInterrupt(pin_lepton_vsync, vsyncHandler, RISING);
+
+  // Configure the SPI library to be able to run in the ISR
+  SPI.usingInterrupt(pin_lepton_vsync);
+}
+
+
+void DisableImageAcquisition() {
+  detachInterrupt(pin_lepton_vsync);
+  SPI.notUsingInterrupt(LEP_VSYNC_IRQ);
+}
+
+
+//
+// Get the SPI bus for the display between segments.  Holds off the VSYNC interrupt
+// (a VSYNC that occurs is handled late when access ends).  Returns false if a segment
+// is being read.
+//
+bool BeginDisplayAccess() {
+  NVIC_DISABLE_IRQ(LEP_VSYNC_IRQ);
+  if (captureActive) {
+    NVIC_ENABLE_IRQ(LEP_VSYNC_IRQ);
+    return false;
+  }
+  return true;
+}
+
+
+void EndDisplayAccess() {
+  NVIC_ENABLE_IRQ(LEP_VSYNC_IRQ);
+}
+
+
+//
+// VSYNC ISR
+//   - Select the Lepton and start the DMA of the first packet of the segment
+//   - The rest of the segment is read by dmaCompleteHandler
+//
+void vsyncHandler() {
+  if (captureActive) {
+    // Still reading the previous segment
+    return;
+  }
+
+  captureActive = true;
+  segmentDone = false;
+  segStartUsec = micros();
+  vospi_asm_start_segment(&segAsm);
+  dmaPacketIndex = 0;
+
+  // The transaction (and CS) is held for the whole segment
+  SPI.beginTransaction(SPISettings(LEP_SPI_CLOCK, MSBFIRST, SPI_MODE1));
+  digitalWriteFast(pin_lepton_cs, LOW);
+  SPI.transfer(dmaTxPacket, dmaPacket[0], LEP_PKT_LENGTH, dmaEvent);
+}
+
+
+//
+// DMA complete ISR
+//   - Start the DMA of the next packet into the other half of the packet area
+//   - Process the packet that just arrived, advancing the segment state
+//   - Release the SPI bus after the packet in flight when the segment is done
+//
+void dmaCompleteHandler(EventResponderRef event) {
+  uint8_t* pkt = dmaPacket[dmaPacketIndex];
+
+  if (segmentDone) {
+    digitalWriteFast(pin_lepton_cs, HIGH);
+    SPI.endTransaction();
+    captureActive = false;
+    return;
+  }
+
+  dmaPacketIndex ^= 1;
+  SPI.transfer(dmaTxPacket, dmaPacket[dmaPacketIndex], LEP_PKT_LENGTH, dmaEvent);
+
+  segmentDone = !ProcessDmaPacket(pkt);
+}
+
+
+//
+// Process one packet of a segment read by DMA with the segment assembler
+//   - Data loaded into acqBuffer
+//   - Buffers swapped and dispBufferValid flag set when all 4 segments have been read
+//     for a frame and the main code is done displaying the previous one
+//   - Returns false when the segment is complete (or failed)
+//
+bool ProcessDmaPacket(uint8_t* pkt) {
+  int rsp;
+  uint16_t* t;
+
+  rsp = vospi_asm_packet(&segAsm, pkt);
+  if (!(rsp & VOSPI_ASM_VALID)) {
+    // Discard packet, keep looking for data within this segment interval
+    return (AbsDiff32u(segStartUsec, micros()) <= LEP_MAX_FRAME_DELAY_USEC);
+  }
+
+  if (rsp & VOSPI_ASM_STORE_IMAGE) {
+    if (segAsm.dst == 0) {
+      // First packet of a frame
+      acqMin = 0xFFFF;
+      acqMax = 0;
+    }
+    CopyPacketToBuffer(pkt, segAsm.dst, acqBuffer);
+  }
+
+  if (rsp & VOSPI_ASM_FRAME) {
+#ifdef LEP_SD_RECORD
+    // Every frame is recorded, even those the display drops
+    (void) LepRecorder.stageFrame(acqBuffer);
+#endif
+    if (!dispBufferValid) {
+      // Flip/flop the frame buffers
+      t = lepBuffer;
+      lepBuffer = acqBuffer;
+      acqBuffer = t;
+      lepMin = acqMin;
+      lepMax = acqMax;
+      dispBufferValid = true;
+    } else {
+      droppedFrames++;
+    }
+  }
+
+  return !(rsp & VOSPI_ASM_DONE);
+}
+
+
+// Store the big-endian pixels of image packet dst, tracking the frame's range
+void CopyPacketToBuffer(uint8_t* pkt, int dst, uint16_t* buf) {
+  uint8_t* lepPopPtr = &pkt[4];
+  uint16_t* acqPushPtr = &buf[dst * (LEP_WIDTH/2)];
+  uint16_t minVal = acqMin;
+  uint16_t maxVal = acqMax;
+  uint16_t v;
+
+  while (lepPopPtr <= &pkt[162]) {
+    v = (lepPopPtr[0] << 8) | lepPopPtr[1];
+    lepPopPtr += 2;
+    if (v < minVal) minVal = v;
+    if (v > maxVal) maxVal = v;
+    *acqPushPtr++ = v;
+  }
+  acqMin = minVal;
+  acqMax = maxVal;
+}
+
+
+#ifdef LEP_SD_RECORD
+// Handle serial recorder commands and write the frames staged since the last call
+void EvalRecorder() {
+  switch (Serial.available() ? Serial.read() : 0) {
+    case 'r':
+      if (LepRecorder.isRecording()) {
+        LepRecorder.stop();
+        Serial.printf("Recording stopped: %lu frames, %lu dropped\n", LepRecorder.getFrameCount(), LepRecorder.getDroppedCount());
+      } else if (sdPresent && LepRecorder.start()) {
+        Serial.println("Recording");
+      } else {
+        Serial.println("Could not start recording");
+      }
+      break;
+    case 's':
+      Serial.printf("%s: %lu frames, %lu dropped, longest write %lu mSec\n", LepRecorder.isRecording() ? "Recording" : "Stopped",
+                    LepRecorder.getFrameCount(), LepRecorder.getDroppedCount(), LepRecorder.getMaxWriteMsec());
+      break;
+  }
+
+  if (LepRecorder.isRecording() && !LepRecorder.service()) {
+    Serial.println("Recording stopped: card error");
+  }
+}
+#endif
+
+
+uint32_t AbsDiff32u(uint32_t n1, uint32_t n2) {
+  if (n2 >= n1) {
+    return (n2-n1);
+  } else {
+    return (n2-n1+0xFFFFFFFF);
+  }
+}
+
+
+void UpdateEmissivity()
+{
+  uint32_t newEmissivity = (8192 * curEmissivityInt) / 100;
+
+  radFluxParms.sceneEmissivity = (uint16_t) newEmissivity;
+
+  (void) lep.LEP_SetRadFluxLinearParams(portDescP, radFluxParms);
+}
+
+
+// Returns the temperature (C) of the center of lepBuffer (Kelvin * 100)
+float GetSpotTemp()
+{
+  uint32_t sum;
+
+  sum = lepBuffer[(LEP_HEIGHT/2 - 1)*LEP_WIDTH + LEP_WIDTH/2 - 1] + lepBuffer[(LEP_HEIGHT/2 - 1)*LEP_WIDTH + LEP_WIDTH/2] +
+        lepBuffer[(LEP_HEIGHT/2)*LEP_WIDTH + LEP_WIDTH/2 - 1] + lepBuffer[(LEP_HEIGHT/2)*LEP_WIDTH + LEP_WIDTH/2];
+
+  return (sum / 400.0 - 273.15);
+}
+
+
+//
+// Compute the AGC for lepBuffer and combine it with the color map in dispLut
+//   - Pixels are binned over lepMin - lepMax (more than one value per bin for ranges wider
+//     than AGC_BINS)
+//   - Linear: bins are spread evenly over the color map
+//   - HEQ: bins are mapped through the cumulative histogram so the color map is spread
+//     over the pixels instead of the temperatures
+//
+void ComputeDisplayLut()
+{
+  uint32_t range = lepMax - lepMin;
+  uint32_t numBins, sum;
+  uint16_t* ptr;
+  int i;
+
+  agcShift = 0;
+  while ((range >> agcShift) >= AGC_BINS) agcShift++;
+  numBins = (range >> agcShift) + 1;
+
+  if (agcMode == AGC_HEQ) {
+    memset(agcHist, 0, numBins * sizeof(uint32_t));
+    ptr = lepBuffer;
+    for (i=0; i<LEP_NUM_PIXELS; i++) {
+      agcHist[(*ptr++ - lepMin) >> agcShift]++;
+    }
+    sum = 0;
+    for (i=0; i<(int) numBins; i++) {
+      sum += agcHist[i];
+      dispLut[i] = colorMapSwapped[(sum * 255) / LEP_NUM_PIXELS];
+    }
+  } else {
+    for (i=0; i<(int) numBins; i++) {
+      dispLut[i] = colorMapSwapped[(numBins > 1) ? ((i * 255) / (numBins - 1)) : 0];
+    }
+  }
+}
+
+
+// Display the next band of the pixel-doubled image between segments using DMA.  Returns
+// true when the whole image has been drawn.
+bool dispFullColorImageBand()
+{
+  int16_t y, n;
+  uint16_t pixel;
+  uint16_t* buf;
+
+  n = LEP_HEIGHT - dispLine;
+  if (n > LEP_DISP_BAND_LINES) n = LEP_DISP_BAND_LINES;
+
+  if (!BeginDisplayAccess()) {
+    return false;
+  }
+
+  SPI.beginTransaction(SPISettings(LCD_SPI_CLOCK, MSBFIRST, SPI_MODE0));
+  digitalWrite(pin_tft_cs, LOW);
+  digitalWrite(pin_tft_dc, LOW);
+  tft.setAddrWindow(0, 2*dispLine, 320, 2*n);
+  digitalWrite(pin_tft_dc, HIGH);
+  for (y=0; y<n; y++) {
+    // Expand this line while the previous one is DMAed from the other buffer
+    buf = dispLineBuf[y & 1];
+    ExpandDisplayLine(&lepBuffer[(dispLine + y)*LEP_WIDTH], buf);
+    while (dispDmaActive) {};
+    dispDmaActive = true;
+    SPI.transfer(buf, NULL, sizeof(dispLineBuf[0]), dispEvent);
+  }
+  while (dispDmaActive) {};
+  SPI.endTransaction();
+  digitalWrite(pin_tft_cs, HIGH);
+
+  dispLine += n;
+  if (dispLine == LEP_HEIGHT) {
+    // Draw an inverted pixel at the center
+    pixel = dispLut[(lepBuffer[LEP_NUM_PIXELS/2 + (LEP_WIDTH/2)] - lepMin) >> agcShift];
+    tft.fillRect(159, 119, 2, 2, ~((pixel >> 8) | (pixel << 8)));
+    dispLine = LEP_DISP_FIRST_LINE;
+  }
+
+  EndDisplayAccess();
+
+  return (dispLine == LEP_DISP_FIRST_LINE);
+}
+
+
+// Expand one Lepton line into two pixel-doubled LCD lines for DMA
+void ExpandDisplayLine(uint16_t* src, uint16_t* dst)
+{
+  uint16_t* dst2 = dst + 2*LEP_WIDTH;
+  uint16_t pixel;
+  int16_t x;
+
+  for (x=0; x<LEP_WIDTH; x++) {
+    pixel = dispLut[(*src++ - lepMin) >> agcShift];
+    *dst++ = pixel;
+    *dst++ = pixel;
+    *dst2++ = pixel;
+    *dst2++ = pixel;
+  }
+}
+
+
+void dispDmaCompleteHandler(EventResponderRef event) {
+  dispDmaActive = false;
+}
+
+
+// Display the status line with spot meter temperature t
+void dispStatusLine(float t) {
+  static int prevGuiSelector = -1;
+  static int prevColorMapSelector = -1;
+  static int prevAgcMode = -1;
+  static float prevTcur = 999;
+  static uint8_t prevEmissivity = 255;
+  static float prevBattVolts = 0;
+
+  tft.setTextColor(ILI9341_YELLOW);
+  tft.setTextSize(1);
+
+
+  // Colormap
+  if (prevGuiSelector != curGuiSelector) {
+    tft.fillRect(4, 5, 5, 8, ILI9341_BLACK);
+    tft.setCursor(4, 5);
+    if (curGuiSelector == GUI_LUT) {
+      tft.print(">");
+    }
+  }
+  if (prevColorMapSelector != colorMapSelector) {
+    tft.fillRect(10, 5, 75, 8, ILI9341_BLACK);
+    tft.setCursor(10, 5);
+    switch (colorMapSelector) {
+      case 1: tft.print("Golden"); break;
+      case 2: tft.print("Rainbow"); break;
+      case 3: tft.print("Iron Black"); break;
+      default: tft.print("Grayscale"); break;
+    }
+    prevColorMapSelector = colorMapSelector;
+  }
+
+  // AGC
+  if (prevGuiSelector != curGuiSelector) {
+    tft.fillRect(90, 5, 5, 8, ILI9341_BLACK);
+    tft.setCursor(90, 5);
+    if (curGuiSelector == GUI_AGC) {
+      tft.print(">");
+    }
+  }
+  if (prevAgcMode != agcMode) {
+    tft.fillRect(96, 5, 50, 8, ILI9341_BLACK);
+    tft.setCursor(96, 5);
+    tft.print((agcMode == AGC_HEQ) ? "HEQ" : "Linear");
+    prevAgcMode = agcMode;
+  }
+
+  // Temp
+  if (abs(prevTcur - t) >= 0.05) {
+    tft.fillRect(160, 5, 40, 8, ILI9341_BLACK);
+    tft.setCursor(160, 5);
+    tft.print(t, 1);
+    prevTcur = t;
+  }
+
+  // Emissivity
+  if (prevGuiSelector != curGuiSelector) {
+    tft.fillRect(214, 5, 5, 8, ILI9341_BLACK);
+    tft.setCursor(214, 5);
+    if (curGuiSelector == GUI_EM) {
+      tft.print(">");
+    }
+  }
+  if (prevEmissivity != curEmissivityInt) {
+    tft.fillRect(220, 5, 40, 8, ILI9341_BLACK);
+    tft.setCursor(220, 5);
+    tft.print(curEmissivityInt);
+    tft.print("%");
+    prevEmissivity = curEmissivityInt;
+  }
+
+  // Battery
+  if (abs(prevBattVolts - GetBattVolts()) > 0.005) {
+    tft.fillRect(280, 5, 30, 8, ILI9341_BLACK);
+    tft.setCursor(280, 5);
+    tft.print(GetBattVolts());
+    tft.print("v");
+    prevBattVolts = GetBattVolts();
+  }
+
+  prevGuiSelector = curGuiSelector;
+}
+
+
+void initColorMap() {
+  uint8_t r, g, b;
+  uint8_t* ptr;
+  int i;
+
+  switch (colorMapSelector) {
+    case 1: ptr = (uint8_t*) colormap_golden; break;
+    case 2: ptr = (uint8_t*) colormap_rainbow; break;
+    case 3: ptr = (uint8_t*) colormap_ironblack; break;
+    default: ptr = (uint8_t*) colormap_grayscale; break;
+  }
+
+  for (i=0; i<256; i++) {
+    r = *ptr++ >> 3;
+    g = *ptr++ >> 2;
+    b = *ptr++ >> 3;
+    colorMap[i] = (r << 11) | (g << 5) | b;
+    colorMapSwapped[i] = (colorMap[i] >> 8) | (colorMap[i] << 8);
+  }
+}
@@ -119,7 +119,7 @@ void setup() {
   tft.setTextSize(2);
   tft.setTextColor(ILI9341_CYAN);
   tft.println("Open LEP");
-  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 100, portDescP) != LEP_OK) {
+  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 1000, portDescP) != LEP_OK) {
     tft.println("Open failed");
     success = false;
   } else {
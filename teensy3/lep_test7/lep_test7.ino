@@ -1,16 +1,35 @@
 /*
- * test Lepton 3.5 - for teensy 3.2 w/ LEP (96 Mhz w/ Faster + LTO optimizations)
- *   - Attempt to enable AGC output with RGB output through built-in LUTs
+ * test Lepton 3.5 - for teensy 3.2 w/ LEP (120 MHz w/ Faster + LTO optimizations)
+ *   - Enable AGC output with RGB output through the Lepton's built-in LUTs (colorization is done by the Lepton)
  *   - Output display on ILI9341 320x240 pixel LCD display
- *   - Display currently selected Lepton LUT and battery voltage on display
+ *   - Display currently selected Lepton LUT, displayed frame rate and battery voltage on display
  *   - Uses Lepton VSYNC output
  *   - Uses hardware platform with modified Sparkfun LiPo charger + power button + rocker button
- * 
- * Gets about 4.4 Hz refresh rate
- * 
+ *   - Uses latest Adafruit GFX and ILI9341 Arduino libraries
+ *
+ * RGB888 capture
+ *   - Each 244 byte packet (half a line of 3-byte pixels) is DMAed into one half of a double-buffered
+ *     packet area while the other half is processed
+ *   - Segment state is advanced by the shared vospi_asm segment assembler in the DMA complete ISR (the
+ *     VSYNC ISR just starts the first packet)
+ *   - Acquisition runs continuously (the Lepton never has to be resynchronized) into one frame buffer and
+ *     each segment is drawn between segments as soon as it has been read
+ *   - Build at 120 MHz: the SPI clock is half of F_BUS (60 MHz) for the LCD (30 MHz) and a third for the
+ *     Lepton (its 20 MHz maximum).  At 96 MHz they only run at 24 and 16 MHz.
+ *
+ * RGB565 display
+ *   - Lepton lines are unpacked a word (4 pixels per 3 words) at a time and reduced to 16-bit pixels with
+ *     per-channel LUTs that hold the LCD's (byte-swapped) RGB565 bits, so each pixel is three table
+ *     reads OR'd together
+ *   - Each pixel-doubled line is expanded into one of a pair of line buffers and DMAed to the LCD twice
+ *     while the next line is expanded into the other
+ *
+ * Designed to keep up with the Lepton's 8.7 Hz frame rate at 120 MHz (it got about 4.4 Hz when acquisition
+ * was stopped and the Lepton resynchronized to draw each frame).  The displayed frame rate is shown.
+ *
  * Note: this sketch skips the first 10 lines of data from the Lepton because of memory limitations in the
  * Teensy 3.2.  That omission works out ok because we draw some text in those positions anyway.
- *  
+ *
  * Operation
  *   - Press and hold power switch to startup (release when you see the display clear as teensy code is running)
  *   - Press power switch again to power down
@@ -46,26 +65,36 @@
  */
 #include <SPI.h>
 #include <LeptonSDKEmb32OEM.h>
+#include <vospi_asm.h>
 #include "Adafruit_GFX.h"
 #include "Adafruit_ILI9341.h"
 
+#if F_BUS < 60000000
+#warning "Build at 120 MHz to run the Lepton and LCD SPI clocks at full speed"
+#endif
+
 #define LEP_MAX_FRAME_DELAY_USEC 9450
 
 #define LEP_WIDTH      160
 #define LEP_HEIGHT     120
 #define LEP_NUM_PIXELS (LEP_WIDTH*LEP_HEIGHT)
 #define LEP_PKT_LENGTH 244
+#define LEP_PKT_PIXEL_BYTES 240
+#define LEP_LINE_BYTES (LEP_WIDTH*3)
+
+#define LEP_SPI_CLOCK  20000000
+#define LCD_SPI_CLOCK  30000000
+
+// The first lines are not stored (they're under the status line) and the image is drawn
+// LEP_DISP_BAND_LINES lines at a time between segments
+#define LEP_SKIP_LINES      10
+#define LEP_DISP_BAND_LINES 4
 
 // Rocker Buttons
 #define L_B_MASK 0x01
 #define P_B_MASK 0x02
 #define R_B_MASK 0x04
 
-//Lepton frame error return
-enum LeptonReadError {
-  NONE, DISCARD, SEGMENT_ERROR, ROW_ERROR, SEGMENT_INVALID
-};
-
 // IO Pins
 const int pin_lepton_cs = 2;
 const int pin_lepton_vsync = 3;
@@ -79,94 +108,84 @@ Adafruit_ILI9341 tft = Adafruit_ILI9341(pin_tft_cs, pin_tft_dc);
 LEP_CAMERA_PORT_DESC_T portDesc;
 LEP_CAMERA_PORT_DESC_T_PTR portDescP = &portDesc;
 
-//Array to store one Lepton packet
-static uint8_t lepPacket[LEP_PKT_LENGTH];
-
 // Lepton Frame buffer (8-bit for RGB values)
-// Note: This is minus the first 20 packets (10 lines)
-//       - we only accumulate after seeing a valid line number
-//         (this lets us fit in Teensy 3.2 RAM)
-static uint8_t lepBuffer[3*LEP_WIDTH*(LEP_HEIGHT-10)];
-
-volatile bool dispBufferValid = false;
-
-volatile int curSegment = 1;
-volatile bool validSegmentRegion = false;
+// Note: This is minus the first 20 packets (10 lines) to fit in the Teensy 3.2 RAM
+static uint8_t lepBuffer[LEP_LINE_BYTES*(LEP_HEIGHT-LEP_SKIP_LINES)] __attribute__((aligned(4)));
+
+// Double-buffered packet area (one packet is DMAed in while the other is processed).  The
+// pixels start at a word boundary.
+static uint8_t dmaPacket[2][LEP_PKT_LENGTH] __attribute__((aligned(4)));
+static uint8_t dmaTxPacket[LEP_PKT_LENGTH];   // Zeros clocked out while reading
+volatile int dmaPacketIndex;
+EventResponder dmaEvent;
+
+// Segment capture state (owned by the VSYNC and DMA complete ISRs)
+volatile bool captureActive = false;          // Segment being read (the Lepton has the SPI bus)
+volatile bool segmentDone;                    // Stop after the packet in flight
+uint32_t segStartUsec;
+vospi_asm_t segAsm;                           // Segment assembler
+
+// Lepton lines of lepBuffer that have been acquired for the current frame
+volatile int dispRowsReady = 0;
+
+// Next Lepton line to draw
+int dispLine = LEP_SKIP_LINES;
+
+// Line buffers holding one pixel-doubled LCD line in LCD byte order
+static uint16_t dispLineBuf[2][2*LEP_WIDTH];
+volatile bool dispDmaActive = false;
+EventResponder dispEvent;
+
+// RGB888 to RGB565 reduction: each table holds its channel's bits of the byte-swapped
+// RGB565 LCD pixel
+static uint16_t rgbLutR[256];
+static uint16_t rgbLutG[256];
+static uint16_t rgbLutB[256];
 
 // NUM_COLORMAPS does not include user LUT
 #define NUM_COLORMAPS 8
 int colorMapSelector = 1;  // Fusion is default
 
-uint32_t prevFrameUsec = 0;
+// Displayed frame rate
+uint32_t dispFrameCount = 0;
+uint32_t prevFpsMsec = 0;
+float dispFps = 0;
 
 
 void setup() {
   bool success = true;
-  
+
   // Initialize our controls first to keep power on
   InitControls();
-  
+
   Serial.begin(115200);
-  
+
   pinMode(pin_lepton_cs, OUTPUT);
   digitalWrite(pin_lepton_cs, HIGH);
   pinMode(pin_lepton_vsync, INPUT);
-  
-  tft.begin();
+
+  // Advance the segment state directly from the DMA complete interrupt
+  vospi_asm_init(&segAsm, 0);
+  dmaEvent.attachImmediate(dmaCompleteHandler);
+  dispEvent.attachImmediate(dispDmaCompleteHandler);
+
+  initRgbLut();
+
+  tft.begin(LCD_SPI_CLOCK);
   tft.setRotation(3);
   tft.fillScreen(ILI9341_BLACK);
 
   delay(2000);
-  
+
   tft.setCursor(0, 20);
   tft.setTextSize(2);
   tft.setTextColor(ILI9341_CYAN);
   tft.println("Open LEP");
-  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 100, portDescP) != LEP_OK) {
+  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 1000, portDescP) != LEP_OK) {
     tft.println("Open failed");
     success = false;
   } else {
     // Configure the Lepton's operating state
-/*
-    if (lep.LEP_SetVidFocusCalcEnableState(portDescP, LEP_VID_FOCUS_CALC_DISABLE) != LEP_OK) {
-      tft.println("Set Focus Calc disable failed");
-      success = false;
-    } else {
-      LEP_VID_FOCUS_CALC_ENABLE_E focusEnable;
-      if (lep.LEP_GetVidFocusCalcEnableState(portDescP, &focusEnable) != LEP_OK) {
-        tft.println("Set Focus Calc disable failed");
-        success = false;
-      } else {
-        tft.printf("Focus enable = %d\n", (int) focusEnable);
-      }
-    }
-    
-    if (lep.LEP_SetAgcPolicy(portDescP, LEP_AGC_LINEAR) != LEP_OK) {
-      tft.println("Set AGC Policy failed");
-      success = false;
-    } else {
-      LEP_AGC_POLICY_E agcPolicy;
-      if (lep.LEP_GetAgcPolicy(portDescP, &agcPolicy) != LEP_OK) {
-        tft.println("Get AGC Policy failed");
-        success = false;
-      } else {
-        tft.printf("AGC policy = %d\n", (int) agcPolicy);
-      }
-    }
-
-    if (lep.LEP_SetAgcHeqScaleFactor(portDescP, LEP_AGC_SCALE_TO_8_BITS) != LEP_OK) {
-      tft.println("Set AGC Scale Factor failed");
-      success = false;
-    } else {
-      LEP_AGC_HEQ_SCALE_FACTOR_E heqScaleFactor;
-      success = false;
-      if (lep.LEP_GetAgcHeqScaleFactor(portDescP, &heqScaleFactor) != LEP_OK) {
-        tft.println("Get AGC Scale Factor failed");
-      } else {
-        tft.printf("AGC Scale Factor = %d\n", (int) heqScaleFactor);
-      }
-    }
-*/
     if (lep.LEP_SetRadEnableState(portDescP, LEP_RAD_DISABLE) != LEP_OK) {
       tft.println("Set RAD Disable failed");
       success = false;
@@ -206,20 +225,6 @@ void setup() {
       }
     }
 
-/*
-    if (lep.LEP_SetVidVideoOutputFormat(portDescP, LEP_VID_VIDEO_OUTPUT_FORMAT_RGB888) != LEP_OK) {
-      tft.println("Set AGC Video Format failed");
-      success = false;
-    } else {
-      LEP_VID_VIDEO_OUTPUT_FORMAT_E videoFormat;
-      if (lep.LEP_GetVidVideoOutputFormat(portDescP, &videoFormat) != LEP_OK) {
-        tft.println("Get Video Format failed");
-        success = false;
-      } else {
-        tft.printf("Video Format = %d\n", (int) videoFormat);
-      }
-    }
-*/
     if (lep.LEP_SetOemVideoOutputFormat(portDescP, LEP_VIDEO_OUTPUT_FORMAT_RGB888) != LEP_OK) {
       tft.println("Set OEM Video Format failed");
       success = false;
@@ -254,7 +259,7 @@ void setup() {
   delay(5000);
 
   tft.fillScreen(ILI9341_BLACK);
-  
+
   // Enable vsync interrupts
   EnableImageAcquisition();
 }
@@ -262,7 +267,7 @@ void setup() {
 
 void loop() {
   EvalControls();
-  
+
   if (PowerDownDetected()) {
     PowerDown();
   } else if (RockerShortPress(L_B_MASK)) {
@@ -271,21 +276,19 @@ void loop() {
   } else if (RockerShortPress(R_B_MASK)) {
     if (++colorMapSelector == NUM_COLORMAPS) colorMapSelector = 0;
     SetLepLUT();
-  }  else if (dispBufferValid) {
-    //dispColorImage(80, 60, LEP_WIDTH, (LEP_HEIGHT-10));
-    dispFullColorImage();
+  } else if (dispFullColorImageBand()) {
+    // Acquisition continues while the display is drawn
+    UpdateFps();
+    while (!BeginDisplayAccess()) {};
     dispStatusLine();
-    //dumpLeptonImage();
-    //WaitForChar();
-    dispBufferValid = false;
-    EnableImageAcquisition();
+    EndDisplayAccess();
   }
 }
 
 
 void EnableImageAcquisition() {
   attachInterrupt(pin_lepton_vsync, vsyncHandler, RISING);
-  
+
   // Configure the SPI library to be able to run in the ISR
   SPI.usingInterrupt(pin_lepton_vsync);
 }
@@ -297,6 +300,26 @@ void DisableImageAcquisition() {
 }
 
 
+//
+// Get the SPI bus for the display between segments.  Holds off the VSYNC interrupt
+// (a VSYNC that occurs is handled late when access ends).  Returns false if a segment
+// is being read.
+//
+bool BeginDisplayAccess() {
+  NVIC_DISABLE_IRQ(IRQ_PORTA);
+  if (captureActive) {
+    NVIC_ENABLE_IRQ(IRQ_PORTA);
+    return false;
+  }
+  return true;
+}
+
+
+void EndDisplayAccess() {
+  NVIC_ENABLE_IRQ(IRQ_PORTA);
+}
+
+
 void WaitForChar() {
   while (!Serial.available()) {};
   while (Serial.available()) {
@@ -307,135 +330,77 @@ void WaitForChar() {
 
 //
 // VSYNC ISR
-//   - Attempt to read a complete segment from the Lepton
-//   - Data loaded into lepBuffer
-//   - dispBufferValid flag set when all 4 segments have been read for a frame
-//     - Image acquisition disabled to allow main code time to display (it must re-enable acquisition)
-// 
+//   - Select the Lepton and start the DMA of the first packet of the segment
+//   - The rest of the segment is read by dmaCompleteHandler
+//
 void vsyncHandler() {
-  uint32_t startUsec;
-  uint8_t line, prevLine;
-  uint8_t segment;
-  bool done = false;
-
-  startUsec = micros();
-  prevLine = 255;
-
-  // Skip this if the time between it and when we last released CS is less than 185 mSec
-  // to properly resync
-  if (AbsDiff32u(startUsec, prevFrameUsec) < 185000) {
+  if (captureActive) {
+    // Still reading the previous segment
     return;
   }
-  
-  while (!done) {
-    if (ProcessPacket(&line, &segment)) {
-      // Saw a valid packet
-      if (line == prevLine) {
-        // This is garbage data since line numbers should always increment
-        done = true;
-      } else {
-        // Check for termination or completion conditions
-        if (line == 20) {
-          // Check segment
-          if (!validSegmentRegion) {
-            // Look for start of valid segment data
-            if (segment == 1) {
-              validSegmentRegion = true;
-            }
-          } else if ((segment < 2) || (segment > 4)) {
-            // Hold/Reset in starting position (always collecting in segment 1 buffer locations)
-            validSegmentRegion = false;  // In case it was set
-            curSegment = 1;
-          }
-        }
- 
-        // Copy the data to the lepton frame buffer if it's valid (and past segment 1/line 20)
-        if (validSegmentRegion && (line <= 59)) {
-          CopyPacketToBuffer(line);
-        }
-               
-        if (line == 59) {
-          // Saw a complete segment, move to next segment or complete frame aquisition if possible
-          if (validSegmentRegion) {
-            if (curSegment < 4) {
-              // Setup to get next segment
-              curSegment++;
-            } else {
-              // Got frame, see if we can display the buffer
-              if (!dispBufferValid) {
-                // Hand this buffer over to other process
-                prevFrameUsec = micros();  // Record end-time of this frame
-                dispBufferValid = true;
-                DisableImageAcquisition();
-              }
-
-              // Setup to get the next frame
-              curSegment = 1;
-              validSegmentRegion = false;
-            }
-          }
-          done = true;
-        }
-      }
-      prevLine = line;
-    } else if (AbsDiff32u(startUsec, micros()) > LEP_MAX_FRAME_DELAY_USEC) {
-      // Did not see a valid packet within this segment interval
-      done = true;
-    }
-  }
+
+  captureActive = true;
+  segmentDone = false;
+  segStartUsec = micros();
+  vospi_asm_start_segment(&segAsm);
+  dmaPacketIndex = 0;
+
+  // The transaction (and CS) is held for the whole segment
+  SPI.beginTransaction(SPISettings(LEP_SPI_CLOCK, MSBFIRST, SPI_MODE1));
+  digitalWriteFast(pin_lepton_cs, LOW);
+  SPI.transfer(dmaTxPacket, dmaPacket[0], LEP_PKT_LENGTH, dmaEvent);
 }
 
 
 //
-// This routine attempts to read one RGB packet from the lepton
-//   - Return false for discard packets
-//   - Return true otherwise
-//     - line contains the packet line number for all valid packets
-//     - seg contains the packet segment number if the line number is 20
+// DMA complete ISR
+//   - Start the DMA of the next packet into the other half of the packet area
+//   - Process the packet that just arrived, advancing the segment state
+//   - Release the SPI bus after the packet in flight when the segment is done
 //
-bool ProcessPacket(uint8_t* line, uint8_t* seg) {
-  bool valid = false;
+void dmaCompleteHandler(EventResponderRef event) {
+  uint8_t* pkt = dmaPacket[dmaPacketIndex];
 
-  *seg = 0;
-  
-  SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE1));
+  if (segmentDone) {
+    digitalWriteFast(pin_lepton_cs, HIGH);
+    SPI.endTransaction();
+    captureActive = false;
+    return;
+  }
 
-  //Start transfer  - CS LOW
-  digitalWriteFast(pin_lepton_cs, LOW);
+  dmaPacketIndex ^= 1;
+  SPI.transfer(dmaTxPacket, dmaPacket[dmaPacketIndex], LEP_PKT_LENGTH, dmaEvent);
 
-  SPI.transfer(lepPacket, LEP_PKT_LENGTH);
+  segmentDone = !ProcessDmaPacket(pkt);
+}
 
-  //Repeat as long as the frame is not valid, equals sync
-  if ((lepPacket[0] & 0x0F) == 0x0F) {
-    valid = false;
-  } else {
-    *line = lepPacket[1];
 
-    // Get segment when possible
-    if (*line == 20) {
-      *seg = (lepPacket[0] >> 4);
-    }
+//
+// Process one packet of a segment read by DMA with the segment assembler
+//   - The pixels of packets past the skipped lines are copied into lepBuffer
+//   - dispRowsReady is advanced each time a segment is complete so the main code can
+//     draw it (the first segment of a frame starts the display over)
+//   - Returns false when the segment is complete (or failed)
+//
+bool ProcessDmaPacket(uint8_t* pkt) {
+  int rsp;
 
-    valid = true;
+  rsp = vospi_asm_packet(&segAsm, pkt);
+  if (!(rsp & VOSPI_ASM_VALID)) {
+    // Discard packet, keep looking for data within this segment interval
+    return (AbsDiff32u(segStartUsec, micros()) <= LEP_MAX_FRAME_DELAY_USEC);
   }
 
-  //End transfer - CS HIGH
-  digitalWriteFast(pin_lepton_cs, HIGH);
-
-  //End SPI Transaction
-  SPI.endTransaction();
-
-  return(valid);
-}
-
-
-void CopyPacketToBuffer(uint8_t line) {
-  uint8_t* lepPopPtr = &lepPacket[4];  // Start with first R value
-  uint8_t* acqPushPtr = &lepBuffer[((curSegment-1) * 60 * 240) + (line * 240) - (20*240)];  // Subtract missing first 10 lines
+  if ((rsp & VOSPI_ASM_STORE_IMAGE) && (segAsm.dst >= 2*LEP_SKIP_LINES)) {
+    // Word aligned copy of the 80 3-byte pixels
+    memcpy(&lepBuffer[(segAsm.dst - 2*LEP_SKIP_LINES) * LEP_PKT_PIXEL_BYTES], &pkt[4], LEP_PKT_PIXEL_BYTES);
+  }
 
-  while (lepPopPtr <= &lepPacket[243]) {
-    *acqPushPtr++ = *lepPopPtr++;
+  if (rsp & VOSPI_ASM_SEGMENT) {
+    dispRowsReady = segAsm.seg * (LEP_HEIGHT/4);
   }
+
+  return !(rsp & VOSPI_ASM_DONE);
 }
 
 
@@ -448,73 +413,128 @@ uint32_t AbsDiff32u(uint32_t n1, uint32_t n2) {
 }
 
 
-// Fast routine to display 1:1 pixel image at specified display location
-void dispColorImage(int16_t x, int16_t y, int16_t w, int16_t h)
+// Display the next band of acquired lines of the pixel-doubled image between segments
+// using DMA.  Returns true when the whole image has been drawn.
+bool dispFullColorImageBand()
 {
-  uint8_t r, g, b;
-  uint16_t pixel;
-  uint8_t* ptr = &lepBuffer[0];
-  
-  SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE0));
-  tft.setAddrWindow(x, y, x+w-1, y+h-1);
-  digitalWrite(pin_tft_dc, HIGH);
+  int16_t y, n;
+  uint16_t* buf;
+
+  n = dispRowsReady - dispLine;
+  if (n < 0) {
+    // A new frame has started before this one was drawn, start drawing it instead
+    dispLine = LEP_SKIP_LINES;
+    n = dispRowsReady - dispLine;
+  }
+  if (n <= 0) {
+    return false;
+  }
+  if (n > LEP_DISP_BAND_LINES) n = LEP_DISP_BAND_LINES;
+
+  if (!BeginDisplayAccess()) {
+    return false;
+  }
+
+  SPI.beginTransaction(SPISettings(LCD_SPI_CLOCK, MSBFIRST, SPI_MODE0));
   digitalWrite(pin_tft_cs, LOW);
-  for(y=h; y>0; y--) {
-    for(x=w; x>0; x--) {
-      r = *ptr++ >> 3;
-      g = *ptr++ >> 2;
-      b = *ptr++ >> 3;
-      pixel = (r << 11) | (g << 5) | b;
-      SPI.transfer16(pixel);
-    }
+  digitalWrite(pin_tft_dc, LOW);
+  tft.setAddrWindow(0, 2*dispLine, 320, 2*n);
+  digitalWrite(pin_tft_dc, HIGH);
+  for (y=0; y<n; y++) {
+    // Expand this line while the previous one is DMAed from the other buffer, then
+    // DMA it twice for the two LCD lines
+    buf = dispLineBuf[y & 1];
+    ExpandRgbLine(&lepBuffer[(dispLine + y - LEP_SKIP_LINES)*LEP_LINE_BYTES], buf);
+    while (dispDmaActive) {};
+    dispDmaActive = true;
+    SPI.transfer(buf, NULL, sizeof(dispLineBuf[0]), dispEvent);
+    while (dispDmaActive) {};
+    dispDmaActive = true;
+    SPI.transfer(buf, NULL, sizeof(dispLineBuf[0]), dispEvent);
   }
+  while (dispDmaActive) {};
   SPI.endTransaction();
   digitalWrite(pin_tft_cs, HIGH);
+
+  dispLine += n;
+  if (dispLine == LEP_HEIGHT) {
+    dispLine = LEP_SKIP_LINES;
+    dispRowsReady = 0;
+    EndDisplayAccess();
+    return true;
+  }
+
+  EndDisplayAccess();
+  return false;
 }
 
 
-// Fast routine to display pixel-doubled image to fill LCD
-void dispFullColorImage()
+//
+// Expand one line of RGB888 pixels into a pixel-doubled line of byte-swapped RGB565
+// pixels.  Four pixels are unpacked from three (little-endian) words at a time:
+//   w0 = R0 G0 B0 R1, w1 = G1 B1 R2 G2, w2 = B2 R3 G3 B3
+//
+void ExpandRgbLine(const uint8_t* src, uint16_t* dst)
 {
-  int16_t x, y;
-  uint8_t r, g, b;
-  uint16_t pixel;
-  uint8_t* ptr;
+  const uint32_t* srcW = (const uint32_t*) src;
+  uint32_t* dstW = (uint32_t*) dst;
+  uint32_t w0, w1, w2, p;
+  int16_t x;
+
+  for (x=0; x<LEP_WIDTH; x+=4) {
+    w0 = *srcW++;
+    w1 = *srcW++;
+    w2 = *srcW++;
+    p = rgbLutR[w0 & 0xFF] | rgbLutG[(w0 >> 8) & 0xFF] | rgbLutB[(w0 >> 16) & 0xFF];
+    *dstW++ = p | (p << 16);
+    p = rgbLutR[w0 >> 24] | rgbLutG[w1 & 0xFF] | rgbLutB[(w1 >> 8) & 0xFF];
+    *dstW++ = p | (p << 16);
+    p = rgbLutR[(w1 >> 16) & 0xFF] | rgbLutG[w1 >> 24] | rgbLutB[w2 & 0xFF];
+    *dstW++ = p | (p << 16);
+    p = rgbLutR[(w2 >> 8) & 0xFF] | rgbLutG[(w2 >> 16) & 0xFF] | rgbLutB[w2 >> 24];
+    *dstW++ = p | (p << 16);
+  }
+}
 
-  SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE0));
-  tft.setAddrWindow(0, 20, 319, 239);
-  digitalWrite(pin_tft_dc, HIGH);
-  digitalWrite(pin_tft_cs, LOW);
-  for(y=0; y<2*(LEP_HEIGHT-10); y=y+2) {
-    // Line 1
-    ptr = &lepBuffer[y/2*3*LEP_WIDTH];
-    for(x=0; x<LEP_WIDTH; x++) {
-      r = *ptr++ >> 3;
-      g = *ptr++ >> 2;
-      b = *ptr++ >> 3;
-      pixel = (r << 11) | (g << 5) | b;
-      SPI.transfer16(pixel);
-      SPI.transfer16(pixel);
-    }
-    // Line 2
-    ptr = &lepBuffer[y/2*3*LEP_WIDTH];
-    for(x=0; x<LEP_WIDTH; x++) {
-      r = *ptr++ >> 3;
-      g = *ptr++ >> 2;
-      b = *ptr++ >> 3;
-      pixel = (r << 11) | (g << 5) | b;
-      SPI.transfer16(pixel);
-      SPI.transfer16(pixel);
-    }
+
+void dispDmaCompleteHandler(EventResponderRef event) {
+  dispDmaActive = false;
+}
+
+
+//
+// RGB565 is sent high byte first (RRRRRGGG GGGBBBBB) so in memory the first byte is
+// RRRRRGGG and the second GGGBBBBB
+//
+void initRgbLut() {
+  uint16_t g;
+  int i;
+
+  for (i=0; i<256; i++) {
+    rgbLutR[i] = (i >> 3) << 3;
+    g = i >> 2;
+    rgbLutG[i] = (g >> 3) | ((g & 0x07) << 13);
+    rgbLutB[i] = (i >> 3) << 8;
+  }
+}
+
+
+void UpdateFps() {
+  uint32_t t = millis();
+
+  dispFrameCount++;
+  if (AbsDiff32u(prevFpsMsec, t) >= 2000) {
+    dispFps = (dispFrameCount * 1000.0) / AbsDiff32u(prevFpsMsec, t);
+    dispFrameCount = 0;
+    prevFpsMsec = t;
   }
-  SPI.endTransaction();
-  digitalWrite(pin_tft_cs, HIGH);
 }
 
 
 void dispStatusLine() {
   static float prevBattVolts = 0;
   static int prevColorMapSelector = -1;
+  static float prevFps = -1;
 
   tft.setTextColor(ILI9341_YELLOW);
   tft.setTextSize(1);
@@ -534,6 +554,13 @@ void dispStatusLine() {
     }
     prevColorMapSelector = colorMapSelector;
   }
+  if (prevFps != dispFps) {
+    tft.fillRect(200, 5, 50, 8, ILI9341_BLACK);
+    tft.setCursor(200, 5);
+    tft.print(dispFps, 1);
+    tft.print(" fps");
+    prevFps = dispFps;
+  }
   if (abs(prevBattVolts - GetBattVolts()) > 0.005) {
     tft.fillRect(280, 5, 30, 8, ILI9341_BLACK);
     tft.setCursor(280, 5);
@@ -549,7 +576,7 @@ void dumpLeptonImage() {
   uint8_t* ptr = &lepBuffer[0];
 
   for (x=0; x<LEP_WIDTH; x++) {
-    for (y=0; y<(LEP_HEIGHT-10); y++) {
+    for (y=0; y<(LEP_HEIGHT-LEP_SKIP_LINES); y++) {
       Serial.printf("%2x ", *ptr++);
     }
     Serial.println();
@@ -558,19 +585,6 @@ void dumpLeptonImage() {
 }
 
 
-void dumpLeptonPacket() {
-  int i;
-
-  for (i=0; i<164; i++) {
-    Serial.printf("%2x ", lepPacket[i]);
-    if ((i == 3) || (i == 43) || (i == 83) || (i == 123) || (i == 163)) {
-      Serial.println();
-    }
-  }
-}
-
-
 void SetLepLUT() {
   (void) lep.LEP_SetVidPcolorLut(portDescP, (LEP_PCOLOR_LUT_E) colorMapSelector);
 }
-
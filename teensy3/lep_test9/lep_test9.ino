@@ -3,12 +3,19 @@
  *   - Display 16-bit temperature values, linearly scaled to 8-bits and processed through a color map
  *   - Allow user to change emissivity
  *   - Output display on ILI9341 320x240 pixel LCD display
- *   - Display current color map, center pixel and spot temps, emissivity % and battery voltage
+ *   - Display current color map, minimum, maximum, spot and center pixel temps, emissivity % and battery voltage
  *   - Rocker selection of color map or emissivity percent
  *   - Uses Lepton VSYNC output
  *   - Uses hardware platform with modified Sparkfun LiPo charger + power button + rocker button
  * 
- * Gets about 4.4 Hz refresh rate
+ * Uses the LeptonVoSPI library to acquire continuously into ping-pong frame buffers (16-bit values are
+ * scaled to 8-bits during acquisition using the previous frame's range) and to display in bands between
+ * segments so the Lepton doesn't have to resync after each displayed frame
+ * 
+ * The temperatures are found by the library from the 16-bit pixels as they are copied (the spot is the
+ * mean of the center 2x2 pixels, the Lepton's spot meter region) so there is no I2C traffic in the display
+ * loop.  TLinear is fixed at 0.01 K resolution so the pixels are always Kelvin * 100.  The status line
+ * only redraws the characters that change.
  * 
  * Operation
  *   - Press and hold power switch to startup (release when you see the display clear as teensy code is running)
@@ -47,17 +54,11 @@
  */
 #include <SPI.h>
 #include <LeptonSDKEmb32OEM.h>
+#include <LeptonVoSPI.h>
 #include "Adafruit_GFX.h"
 #include "Adafruit_ILI9341.h"
 #include "colormaps.h"
 
-#define LEP_MAX_FRAME_DELAY_USEC 9450
-
-#define LEP_WIDTH      160
-#define LEP_HEIGHT     120
-#define LEP_NUM_PIXELS (LEP_WIDTH*LEP_HEIGHT)
-#define LEP_PKT_LENGTH 164
-
 // Rocker Buttons
 #define L_B_MASK 0x01
 #define P_B_MASK 0x02
@@ -81,20 +82,9 @@ Adafruit_ILI9341 tft = Adafruit_ILI9341(pin_tft_cs, pin_tft_dc);
 LEP_CAMERA_PORT_DESC_T portDesc;
 LEP_CAMERA_PORT_DESC_T_PTR portDescP = &portDesc;
 
-//Array to store one Lepton packet
-static uint8_t lepPacket[LEP_PKT_LENGTH];
-
-// Lepton Frame buffer (16-bit values)
-static uint16_t lepBuffer[LEP_NUM_PIXELS];
-
-volatile bool dispBufferValid = false;
-
-volatile int curSegment = 1;
-volatile bool validSegmentRegion = false;
-volatile uint16_t minLepVal = 0xFFFF;
-volatile uint16_t maxLepVal = 0x0;
-
-uint32_t prevFrameUsec = 0;
+// Lepton Frame buffers (16-bit values scaled to 8-bits) - one displayed while the other is acquired
+static uint8_t lepFrames[2][LEP_NUM_PIXELS];
+static uint8_t* lepBuffer = lepFrames[0];
 
 // GUI
 #define NUM_GUI_CONTROLS 2
@@ -107,7 +97,11 @@ int curGuiSelector = GUI_LUT;
 static uint16_t colorMap[256];
 int colorMapSelector = 0;
 
+// Temperatures of the displayed frame (Kelvin * 100)
 uint16_t curCentLepVal;
+uint16_t curSpotLepVal;
+uint16_t curMinLepVal;
+uint16_t curMaxLepVal;
 
 // RAD Flux Linear Parameters
 //  Default (read)
@@ -123,6 +117,26 @@ uint16_t curCentLepVal;
 LEP_RAD_FLUX_LINEAR_PARAMS_T radFluxParms;
 uint16_t curEmissivityInt = 100;            // 0 - 100 %
 
+// Status line text fields.  Each remembers the characters it shows so only the glyph
+// cells that change are redrawn.
+typedef struct {
+  int16_t x;
+  int16_t len;           // Character cells
+  char text[12];
+} TextField;
+
+#define STATUS_Y 5
+
+TextField lutSelField   = {4, 1};
+TextField lutField      = {10, 10};
+TextField minField      = {76, 4};
+TextField maxField      = {102, 4};
+TextField spotField     = {130, 4};
+TextField centField     = {160, 4};
+TextField emSelField    = {214, 1};
+TextField emField       = {220, 4};
+TextField battField     = {280, 5};
+
 
 void setup() {
   bool success = true;
@@ -132,9 +146,7 @@ void setup() {
   
   Serial.begin(115200);
   
-  pinMode(pin_lepton_cs, OUTPUT);
-  digitalWrite(pin_lepton_cs, HIGH);
-  pinMode(pin_lepton_vsync, INPUT);
+  LepVoSPI.begin(pin_lepton_cs, pin_lepton_vsync, LEP_VOSPI_RAD16_SCALED, lepFrames[0], lepFrames[1]);
   
   tft.begin();
   tft.setRotation(3);
@@ -148,7 +160,7 @@ void setup() {
   tft.setTextSize(2);
   tft.setTextColor(ILI9341_CYAN);
   tft.println("Open LEP");
-  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 100, portDescP) != LEP_OK) {
+  if (lep.LEP_OpenPort(0, LEP_CCI_TWI, 1000, portDescP) != LEP_OK) {
     tft.println("Open failed");
   } else {
 
@@ -159,7 +171,7 @@ void setup() {
       tft.println("Got RAD Flux Linear Parameters");
     }
     
-    if (lep.LEP_SetRadTLinearAutoResolution(portDescP, LEP_RAD_ENABLE) != LEP_OK) {
+    if (lep.LEP_SetRadTLinearAutoResolution(portDescP, LEP_RAD_DISABLE) != LEP_OK) {
       tft.println("Set RAD Linear AutoResolution Enable failed");
       success = false;
     } else {
@@ -171,6 +183,11 @@ void setup() {
         tft.printf("RAD Linear AutoResolution Enable = %d\n", (int) radAutoResEnable);
       }
     }
+
+    if (lep.LEP_SetRadTLinearResolution(portDescP, LEP_RAD_RESOLUTION_0_01) != LEP_OK) {
+      tft.println("Set RAD Linear Resolution failed");
+      success = false;
+    }
     
     if (lep.LEP_SetOemGpioMode(portDescP, LEP_OEM_GPIO_MODE_VSYNC) != LEP_OK) {
       tft.println("Set GPIO failed");
@@ -191,7 +208,7 @@ void setup() {
   tft.fillScreen(ILI9341_BLACK);
   
   // Enable vsync interrupts
-  EnableImageAcquisition();
+  LepVoSPI.enable();
 }
 
 
@@ -222,37 +239,22 @@ void loop() {
         UpdateEmissivity();
       }
     } 
-  } else if (dispBufferValid) {
-    //Serial.print(millis());
-    AnalyzeLepData();
+  } else if (LepVoSPI.frameAvailable()) {
+    // Acquisition continues while the display is drawn a band at a time
+    lepBuffer = LepVoSPI.getFrame();
     //dispColorImage(80, 60, LEP_WIDTH, LEP_HEIGHT);
-    dispFullColorImage();
-    dispStatusLine();
-    //dumpLeptonImage();
-    //Serial.printf("Min: %d  Max %d\n", minLepVal, maxLepVal);
-    //WaitForChar();
-    dispBufferValid = false;
-    //Serial.print(" ");
-    //Serial.println(millis());
-    EnableImageAcquisition();
+    if (LepVoSPI.drawFrameBand(&tft, pin_tft_cs, pin_tft_dc, lepBuffer, colorMap)) {
+      AnalyzeLepData();
+      dispStatusLine();
+      //dumpLeptonImage();
+      //Serial.printf("Min: %d  Max %d\n", LepVoSPI.getMinVal(), LepVoSPI.getMaxVal());
+      //WaitForChar();
+      LepVoSPI.releaseFrame();
+    }
   }
 }
 
 
-void EnableImageAcquisition() {
-  attachInterrupt(pin_lepton_vsync, vsyncHandler, RISING);
-  
-  // Configure the SPI library to be able to run in the ISR
-  SPI.usingInterrupt(pin_lepton_vsync);
-}
-
-
-void DisableImageAcquisition() {
-  detachInterrupt(pin_lepton_vsync);
-  SPI.notUsingInterrupt(IRQ_PORTA);
-}
-
-
 void WaitForChar() {
   while (!Serial.available()) {};
   while (Serial.available()) {
@@ -261,140 +263,6 @@ void WaitForChar() {
 }
 
 
-//
-// VSYNC ISR
-//   - Attempt to read a complete segment from the Lepton
-//   - Data loaded into lepBuffer
-//   - dispBufferValid flag set when all 4 segments have been read for a frame
-//     - Image acquisition disabled to allow main code time to display (it must re-enable acquisition)
-// 
-void vsyncHandler() {
-  uint32_t startUsec;
-  uint8_t line, prevLine;
-  uint8_t segment;
-  bool done = false;
-  bool beforeValidData = true;
-
-  startUsec = micros();
-  prevLine = 255;
-
-  while (!done) {
-    if (ProcessPacket(&line, &segment)) {
-      // Saw a valid packet
-      if (line == prevLine) {
-        // This is garbage data since line numbers should always increment
-        done = true;
-      } else {
-        // Check for termination or completion conditions
-        if (line == 20) {
-          // Check segment
-          if (!validSegmentRegion) {
-            // Look for start of valid segment data
-            if (segment == 1) {
-              beforeValidData = false;
-              validSegmentRegion = true;
-            }
-          } else if ((segment < 2) || (segment > 4)) {
-            // Hold/Reset in starting position (always collecting in segment 1 buffer locations)
-            validSegmentRegion = false;  // In case it was set
-            curSegment = 1;
-          }
-        } 
-        
-        // Copy the data to the lepton frame buffer
-        //  - beforeValidData is used to collect data before we know if the current segment (1) is valid
-        //  - then we use validSegmentRegion for remaining data once we know we're seeing valid data
-        if ((beforeValidData || validSegmentRegion) && (line <= 59)) {
-          CopyPacketToBuffer(line);
-        }
-        
-        if (line == 59) {
-          // Saw a complete segment, move to next segment or complete frame aquisition if possible
-          if (validSegmentRegion) {
-            if (curSegment < 4) {
-              // Setup to get next segment
-              curSegment++;
-            } else {
-              // Got frame, see if we can flip/flop the frame buffer (other process is done with previous buffer)
-              if (!dispBufferValid) {
-                // Hand this buffer over to other process
-                prevFrameUsec = micros();  // Record end-time of this frame
-                dispBufferValid = true;
-                DisableImageAcquisition();
-              }
-              // Setup to get the next frame
-              curSegment = 1;
-              validSegmentRegion = false;
-            }
-          }
-          done = true;
-        }
-      }
-      prevLine = line;
-    } else if (AbsDiff32u(startUsec, micros()) > LEP_MAX_FRAME_DELAY_USEC) {
-      // Did not see a valid packet within this segment interval
-      done = true;
-    }
-  }
-}
-
-
-//
-// This routine attempts to read one RGB packet from the lepton
-//   - Return false for discard packets
-//   - Return true otherwise
-//     - line contains the packet line number for all valid packets
-//     - seg contains the packet segment number if the line number is 20
-//
-bool ProcessPacket(uint8_t* line, uint8_t* seg) {
-  bool valid = false;
-
-  *seg = 0;
-  
-  SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE1));
-
-  //Start transfer  - CS LOW
-  digitalWriteFast(pin_lepton_cs, LOW);
-
-  SPI.transfer(lepPacket, LEP_PKT_LENGTH);
-
-  //Repeat as long as the frame is not valid, equals sync
-  if ((lepPacket[0] & 0x0F) == 0x0F) {
-    valid = false;
-  } else {
-    *line = lepPacket[1];
-
-    // Get segment when possible
-    if (*line == 20) {
-      *seg = (lepPacket[0] >> 4);
-    }
-
-    valid = true;
-  }
-
-  //End transfer - CS HIGH
-  digitalWriteFast(pin_lepton_cs, HIGH);
-
-  //End SPI Transaction
-  SPI.endTransaction();
-
-  return(valid);
-}
-
-
-void CopyPacketToBuffer(uint8_t line) {
-  uint8_t* lepPopPtr = &lepPacket[4];
-  uint16_t* acqPushPtr = &lepBuffer[((curSegment-1) * 30 * LEP_WIDTH) + (line * (LEP_WIDTH/2))];
-  uint16_t t;
-
-  while (lepPopPtr <= &lepPacket[163]) {
-    t = *lepPopPtr++ << 8;
-    t |= *lepPopPtr++;
-    *acqPushPtr++ = t;
-  }
-}
-
-
 uint32_t AbsDiff32u(uint32_t n1, uint32_t n2) {
   if (n2 >= n1) {
     return (n2-n1);
@@ -414,42 +282,26 @@ void UpdateEmissivity()
 }
 
 
-int16_t GetSpotMeter()
+void AnalyzeLepData()
 {
-  LEP_RAD_SPOTMETER_OBJ_KELVIN_T spotVal;
-
-  if (lep.LEP_GetRadSpotmeterObjInKelvinX100(portDescP, &spotVal) == LEP_OK) {
-    return (round(spotVal.radSpotmeterValue / 100.0 - 273.16));
-  }
-
-  return 0;
+  // The temps are found (and the data scaled) during acquisition
+  curCentLepVal = LepVoSPI.getCenterVal();
+  curSpotLepVal = LepVoSPI.getSpotVal();
+  curMinLepVal = LepVoSPI.getMinVal();
+  curMaxLepVal = LepVoSPI.getMaxVal();
 }
 
 
-void AnalyzeLepData()
+int LepValToTemp(uint16_t v)
 {
-  uint16_t* ptr = &lepBuffer[0];
-  uint16_t t;
-
-  // Find the minimum and maximum temps in the lepton data
-  minLepVal = 0xFFFF;
-  maxLepVal = 0;
-  while (ptr < &lepBuffer[LEP_NUM_PIXELS]) {
-    t = *ptr++;
-    if (t < minLepVal) minLepVal = t;
-    if (t > maxLepVal) maxLepVal = t;
-  }
-
-  // Get the center temp value (before we may overwrite the lep buffer for video)
-  curCentLepVal = lepBuffer[LEP_NUM_PIXELS/2 + (LEP_WIDTH/2)];
+  return round(v / 100.0 - 273.16);
 }
 
 
 // Fast routine to display 1:1 pixel image at specified display location
 void dispColorImage(int16_t x, int16_t y, int16_t w, int16_t h)
 {
-  uint16_t diff = maxLepVal - minLepVal;
-  uint16_t* ptr = &lepBuffer[0];
+  uint8_t* ptr = &lepBuffer[0];
   
   SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE0));
   tft.setAddrWindow(x, y, x+w-1, y+h-1);
@@ -457,7 +309,7 @@ void dispColorImage(int16_t x, int16_t y, int16_t w, int16_t h)
   digitalWrite(pin_tft_cs, LOW);
   for(y=h; y>0; y--) {
     for(x=w; x>0; x--) {
-      SPI.transfer16(colorMap[(*ptr++ - minLepVal) * 255 / diff]);
+      SPI.transfer16(colorMap[*ptr++]);
     }
   }
   SPI.endTransaction();
@@ -465,136 +317,63 @@ void dispColorImage(int16_t x, int16_t y, int16_t w, int16_t h)
 }
 
 
-// Fast routine to display pixel-doubled image to fill LCD
-void dispFullColorImage()
-{
-  int16_t x, y;
-  uint16_t pixel;
-  uint16_t diff = maxLepVal - minLepVal;
-  uint16_t* ptr;
-
-  // Convert the raw lep data into scaled values once so we don't have to repeat the calcs
-  ptr = &lepBuffer[0];
-  while (ptr < &lepBuffer[LEP_NUM_PIXELS]) {
-    pixel = (*ptr - minLepVal) * 255 / diff;
-    *ptr++ = pixel;
-  }
+// Show s in field f, drawing only the cells that differ from what is shown
+void dispTextField(TextField* f, const char* s) {
+  char c;
+  int i;
 
-  // Copy the data to the frame buffer expanding via the colormap (skip the first 10 lines of data)
-  SPI.beginTransaction(SPISettings(20000000, MSBFIRST, SPI_MODE0));
-  tft.setAddrWindow(0, 20, 319, 239);
-  digitalWrite(pin_tft_dc, HIGH);
-  digitalWrite(pin_tft_cs, LOW);
-  for(y=20; y<2*LEP_HEIGHT; y=y+2) {
-    // Line 1
-    ptr = &lepBuffer[y/2*LEP_WIDTH];
-    for(x=0; x<LEP_WIDTH; x++) {
-      pixel = colorMap[*ptr++];
-      SPI.transfer16(pixel);
-      SPI.transfer16(pixel);
-    }
-    // Line 2
-    ptr = &lepBuffer[y/2*LEP_WIDTH];
-    for(x=0; x<LEP_WIDTH; x++) {
-      pixel = colorMap[*ptr++];
-      SPI.transfer16(pixel);
-      SPI.transfer16(pixel);
+  for (i=0; i<f->len; i++) {
+    c = (*s != 0) ? *s++ : ' ';
+    if (c != f->text[i]) {
+      // The classic font cell is 6x8 including the background
+      tft.drawChar(f->x + 6*i, STATUS_Y, c, ILI9341_YELLOW, ILI9341_BLACK, 1);
+      f->text[i] = c;
     }
   }
-  SPI.endTransaction();
-  digitalWrite(pin_tft_cs, HIGH);
-
-  // Draw an inverted pixel at the center
-  pixel = ~colorMap[lepBuffer[LEP_NUM_PIXELS/2 + (LEP_WIDTH/2)]];
-  tft.fillRect(159, 119, 2, 2, pixel);
 }
 
 
 void dispStatusLine() {
-  static int prevGuiSelector = -1;
-  static int prevColorMapSelector = -1;
-  static int prevTcur = 999;
-  static int prevTmax = 999;
-  static uint8_t prevEmissivity = 255;
-  static float prevBattVolts = 0;
-  int t;
-
-  tft.setTextColor(ILI9341_YELLOW);
-  tft.setTextSize(1);
+  char buf[12];
 
-  
   // Colormap
-  if (prevGuiSelector != curGuiSelector) {
-    tft.fillRect(4, 5, 5, 8, ILI9341_BLACK);
-    tft.setCursor(4, 5);
-    if (curGuiSelector == GUI_LUT) {
-      tft.print(">");
-    }
-  }
-  if (prevColorMapSelector != colorMapSelector) {
-    tft.fillRect(10, 5, 75, 8, ILI9341_BLACK);
-    tft.setCursor(10, 5);
-    switch (colorMapSelector) {
-      case 1: tft.print("Golden"); break;
-      case 2: tft.print("Rainbow"); break;
-      case 3: tft.print("Iron Black"); break;
-      default: tft.print("Grayscale"); break;
-    }
-    prevColorMapSelector = colorMapSelector;
+  dispTextField(&lutSelField, (curGuiSelector == GUI_LUT) ? ">" : "");
+  switch (colorMapSelector) {
+    case 1: dispTextField(&lutField, "Golden"); break;
+    case 2: dispTextField(&lutField, "Rainbow"); break;
+    case 3: dispTextField(&lutField, "Iron Black"); break;
+    default: dispTextField(&lutField, "Grayscale"); break;
   }
 
   // Temps
-  t = GetSpotMeter();
-  if (prevTcur != t) {
-    tft.fillRect(120, 5, 30, 8, ILI9341_BLACK);
-    tft.setCursor(120, 5);
-    tft.print(t);
-    prevTcur = t;
-  }
-  t = round(curCentLepVal / 100.0 - 273.16);
-  if (prevTmax != t) {
-    tft.fillRect(160, 5, 30, 8, ILI9341_BLACK);
-    tft.setCursor(160, 5);
-    tft.print(t);
-    prevTmax = curCentLepVal;
-  }
+  sprintf(buf, "%d", LepValToTemp(curMinLepVal));
+  dispTextField(&minField, buf);
+  sprintf(buf, "%d", LepValToTemp(curMaxLepVal));
+  dispTextField(&maxField, buf);
+  sprintf(buf, "%d", LepValToTemp(curSpotLepVal));
+  dispTextField(&spotField, buf);
+  sprintf(buf, "%d", LepValToTemp(curCentLepVal));
+  dispTextField(&centField, buf);
 
   // Emissivity
-  if (prevGuiSelector != curGuiSelector) {
-    tft.fillRect(214, 5, 5, 8, ILI9341_BLACK);
-    tft.setCursor(214, 5);
-    if (curGuiSelector == GUI_EM) {
-      tft.print(">");
-    }
-  }
-  if (prevEmissivity != curEmissivityInt) {
-    tft.fillRect(220, 5, 40, 8, ILI9341_BLACK);
-    tft.setCursor(220, 5);
-    tft.print(curEmissivityInt);
-    tft.print("%");
-    prevEmissivity = curEmissivityInt;
-  }
-  
-  // Battery
-  if (abs(prevBattVolts - GetBattVolts()) > 0.005) {
-    tft.fillRect(280, 5, 30, 8, ILI9341_BLACK);
-    tft.setCursor(280, 5);
-    tft.print(GetBattVolts());
-    tft.print("v");
-    prevBattVolts = GetBattVolts();
-  }
+  dispTextField(&emSelField, (curGuiSelector == GUI_EM) ? ">" : "");
+  sprintf(buf, "%d%%", curEmissivityInt);
+  dispTextField(&emField, buf);
 
-  prevGuiSelector = curGuiSelector;
+  // Battery
+  dtostrf(GetBattVolts(), 4, 2, buf);
+  strcat(buf, "v");
+  dispTextField(&battField, buf);
 }
 
 
 void dumpLeptonImage() {
   int x, y;
-  uint16_t* ptr = &lepBuffer[0];
+  uint8_t* ptr = &lepBuffer[0];
 
   for (x=0; x<LEP_WIDTH; x++) {
     for (y=0; y<LEP_HEIGHT; y++) {
-      Serial.printf("%4x ", *ptr++);
+      Serial.printf("%2x ", *ptr++);
     }
     Serial.println();
     Serial.println();
@@ -603,6 +382,7 @@ void dumpLeptonImage() {
 
 
 void dumpLeptonPacket() {
+  uint8_t* lepPacket = LepVoSPI.getPacket();
   int i;
 
   for (i=0; i<LEP_PKT_LENGTH; i++) {
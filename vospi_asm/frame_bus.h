@@ -0,0 +1,329 @@
+/*
+ * Local shared memory frame bus
+ *
+ * Lets any number of processes on the same Linux host read the frames a capture
+ * program publishes without a socket or a copy per consumer.  The publisher creates a
+ * POSIX shared memory object holding a ring of FRAME_BUS_SLOTS frame slots and writes
+ * each frame straight into the next slot.  Subscribers map it read-only and read the
+ * frames in place.
+ *
+ *   - Each slot is protected by a sequence lock: its seq is odd while the publisher
+ *     writes it.  A subscriber notes seq when it takes a frame and checks it is
+ *     unchanged with frame_bus_valid() after using the frame (the publisher never
+ *     waits for subscribers, a slow subscriber's frame is simply overwritten).
+ *   - head counts the frames published and is also the futex subscribers sleep on, so
+ *     a new frame wakes them within microseconds.
+ *   - Subscribers that fall more than FRAME_BUS_SLOTS - 1 frames behind skip to the
+ *     oldest frame still in the ring and count the frames they missed.
+ *   - Each slot holds a frame in the shared tcam_frame.h format (slot->hdr followed by
+ *     the pixels and telemetry) so a subscriber can pass it on or parse it like a frame
+ *     received over a socket.
+ *
+ * Everything is static inline so this header is the whole implementation.  Link with
+ * -lrt on older C libraries.
+ *
+ */
+#ifndef FRAME_BUS_H
+#define FRAME_BUS_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "tcam_frame.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Frame bus constants
+//
+
+// Default shared memory object name (/dev/shm/lepton_frames)
+#define FRAME_BUS_NAME          "/lepton_frames"
+
+// Slots in the ring
+#define FRAME_BUS_SLOTS         8
+
+// Largest frame image and telemetry
+#define FRAME_BUS_MAX_PIXEL_BYTES (160 * 120 * 2)
+#define FRAME_BUS_MAX_TELEM_BYTES 480
+
+#define FRAME_BUS_MAGIC         0x5355424C
+#define FRAME_BUS_VERSION       2
+
+// Pixel formats
+#define FRAME_BUS_FMT_8         TCAM_FRAME_FMT_8
+#define FRAME_BUS_FMT_16LE      TCAM_FRAME_FMT_16LE
+#define FRAME_BUS_FMT_16BE      TCAM_FRAME_FMT_16BE
+
+
+//
+// Frame bus shared memory layout
+//
+typedef struct {
+	uint32_t seq;              // Sequence lock (odd while being written)
+	uint32_t frame_num;        // Frame number in head (0 while invalid)
+	tcam_frame_hdr_t hdr;      // The frame (tcam_frame_pixels() and tcam_frame_telem())
+	uint8_t data[FRAME_BUS_MAX_PIXEL_BYTES + FRAME_BUS_MAX_TELEM_BYTES];
+} __attribute__((aligned(64))) frame_bus_slot_t;
+
+typedef struct {
+	uint32_t magic;            // FRAME_BUS_MAGIC once initialized
+	uint32_t version;
+	uint32_t num_slots;
+	uint32_t slot_bytes;       // sizeof(frame_bus_slot_t)
+	uint16_t width;
+	uint16_t height;
+	uint16_t format;           // FRAME_BUS_FMT_*
+	uint16_t reserved;
+	uint32_t head;             // Frames published (futex word)
+	uint32_t publisher;        // Publisher's pid
+	frame_bus_slot_t slot[FRAME_BUS_SLOTS];
+} frame_bus_t;
+
+
+//
+// Subscriber state
+//
+typedef struct {
+	frame_bus_t* bus;
+	uint32_t next;             // Next frame number to read
+	uint32_t seq;              // Sequence of the slot last returned
+	frame_bus_slot_t* slot;    // The slot last returned
+	uint32_t missed;           // Frames overwritten before they were read
+} frame_bus_client_t;
+
+
+
+static inline int frame_bus_futex(uint32_t* addr, int op, uint32_t val, const struct timespec* ts)
+{
+	return syscall(SYS_futex, addr, op, val, ts, NULL, 0);
+}
+
+
+//
+// Publisher API
+//
+
+/**
+ * Create (or take over) the shared memory object name and initialize the ring.
+ * Returns NULL if it could not be created.
+ */
+static inline frame_bus_t* frame_bus_create(const char* name, int width, int height, int format)
+{
+	frame_bus_t* bus;
+	int fd;
+
+	if ((fd = shm_open(name, O_RDWR | O_CREAT, 0644)) < 0) {
+		return NULL;
+	}
+	if (ftruncate(fd, sizeof(frame_bus_t)) != 0) {
+		close(fd);
+		return NULL;
+	}
+	bus = (frame_bus_t*) mmap(NULL, sizeof(frame_bus_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (bus == MAP_FAILED) {
+		return NULL;
+	}
+
+	// Old subscribers see the magic cleared while the ring is re-initialized.  head
+	// carries on from a previous publisher so they pick up the new frames.
+	__atomic_store_n(&bus->magic, 0, __ATOMIC_RELAXED);
+	memset(bus->slot, 0, sizeof(bus->slot));
+	bus->version = FRAME_BUS_VERSION;
+	bus->num_slots = FRAME_BUS_SLOTS;
+	bus->slot_bytes = sizeof(frame_bus_slot_t);
+	bus->width = width;
+	bus->height = height;
+	bus->format = format;
+	bus->publisher = getpid();
+	__atomic_store_n(&bus->magic, FRAME_BUS_MAGIC, __ATOMIC_RELEASE);
+
+	return bus;
+}
+
+
+/**
+ * Start writing the next frame.  Returns the slot to write the pixels (and telemetry)
+ * into, its header initialized for a raw frame of the bus's geometry.  Follow with
+ * frame_bus_publish() or frame_bus_cancel().
+ */
+static inline frame_bus_slot_t* frame_bus_begin(frame_bus_t* bus)
+{
+	frame_bus_slot_t* slot = &bus->slot[bus->head % FRAME_BUS_SLOTS];
+
+	// Odd before any of the slot changes
+	__atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+	slot->frame_num = 0;
+	tcam_frame_init(&slot->hdr, bus->width, bus->height, (bus->format == FRAME_BUS_FMT_8) ? 8 : 14, bus->format);
+	return slot;
+}
+
+
+/**
+ * Publish the slot returned by frame_bus_begin() and wake the subscribers
+ */
+static inline void frame_bus_publish(frame_bus_t* bus, frame_bus_slot_t* slot)
+{
+	uint32_t head = bus->head + 1;
+
+	slot->frame_num = head;
+	__atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+	__atomic_store_n(&bus->head, head, __ATOMIC_RELEASE);
+	(void) frame_bus_futex(&bus->head, FUTEX_WAKE, INT_MAX, NULL);
+}
+
+
+/**
+ * Abandon the slot returned by frame_bus_begin() (it holds no frame until reused)
+ */
+static inline void frame_bus_cancel(frame_bus_t* bus, frame_bus_slot_t* slot)
+{
+	__atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * Unmap and remove the bus
+ */
+static inline void frame_bus_destroy(frame_bus_t* bus, const char* name)
+{
+	__atomic_store_n(&bus->magic, 0, __ATOMIC_RELEASE);
+	(void) frame_bus_futex(&bus->head, FUTEX_WAKE, INT_MAX, NULL);
+	munmap(bus, sizeof(frame_bus_t));
+	shm_unlink(name);
+}
+
+
+//
+// Subscriber API
+//
+
+/**
+ * Map the bus name read-only.  Returns false if it doesn't exist (yet) or isn't
+ * compatible.  Reading starts with the most recent frame.
+ */
+static inline bool frame_bus_open(frame_bus_client_t* c, const char* name)
+{
+	frame_bus_t* bus;
+	int fd;
+
+	memset(c, 0, sizeof(frame_bus_client_t));
+	if ((fd = shm_open(name, O_RDONLY, 0)) < 0) {
+		return false;
+	}
+	bus = (frame_bus_t*) mmap(NULL, sizeof(frame_bus_t), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (bus == MAP_FAILED) {
+		return false;
+	}
+
+	if ((__atomic_load_n(&bus->magic, __ATOMIC_ACQUIRE) != FRAME_BUS_MAGIC) ||
+	    (bus->version != FRAME_BUS_VERSION) || (bus->slot_bytes != sizeof(frame_bus_slot_t))) {
+		munmap(bus, sizeof(frame_bus_t));
+		return false;
+	}
+
+	c->bus = bus;
+	c->next = __atomic_load_n(&bus->head, __ATOMIC_ACQUIRE);
+	if (c->next == 0) {
+		c->next = 1;
+	}
+	return true;
+}
+
+
+/**
+ * Wait up to timeout_msec (-1 forever) for the next frame and return its slot to be
+ * read in place, or NULL on timeout or if the publisher went away (magic is cleared,
+ * reopen the bus).  Check the frame with frame_bus_valid() after using it.
+ */
+static inline const frame_bus_slot_t* frame_bus_wait(frame_bus_client_t* c, int timeout_msec)
+{
+	frame_bus_t* bus = c->bus;
+	frame_bus_slot_t* slot;
+	struct timespec ts;
+	uint32_t head, seq;
+
+	while (1) {
+		if (__atomic_load_n(&bus->magic, __ATOMIC_ACQUIRE) != FRAME_BUS_MAGIC) {
+			return NULL;
+		}
+
+		head = __atomic_load_n(&bus->head, __ATOMIC_ACQUIRE);
+		if ((int32_t) (head - c->next) < 0) {
+			// Wait for it (head is checked again by the kernel)
+			if (timeout_msec == 0) {
+				return NULL;
+			}
+			ts.tv_sec = timeout_msec / 1000;
+			ts.tv_nsec = (timeout_msec % 1000) * 1000000;
+			if ((frame_bus_futex(&bus->head, FUTEX_WAIT, head, (timeout_msec < 0) ? NULL : &ts) != 0) &&
+			    (errno == ETIMEDOUT)) {
+				return NULL;
+			}
+			continue;
+		}
+
+		// Skip frames already overwritten
+		if ((head - c->next) >= (FRAME_BUS_SLOTS - 1)) {
+			c->missed += head - c->next - (FRAME_BUS_SLOTS - 2);
+			c->next = head - (FRAME_BUS_SLOTS - 2);
+		}
+
+		slot = &bus->slot[(c->next - 1) % FRAME_BUS_SLOTS];
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		if (((seq & 1) == 0) && (slot->frame_num == c->next)) {
+			c->seq = seq;
+			c->slot = slot;
+			c->next++;
+			return slot;
+		}
+
+		// Being (or already) overwritten
+		c->missed++;
+		c->next++;
+	}
+}
+
+
+/**
+ * Returns true if the frame last returned by frame_bus_wait() wasn't overwritten
+ * while it was being used
+ */
+static inline bool frame_bus_valid(frame_bus_client_t* c)
+{
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	return __atomic_load_n(&c->slot->seq, __ATOMIC_RELAXED) == c->seq;
+}
+
+
+/**
+ * Unmap the bus
+ */
+static inline void frame_bus_close(frame_bus_client_t* c)
+{
+	if (c->bus != NULL) {
+		munmap(c->bus, sizeof(frame_bus_t));
+		c->bus = NULL;
+	}
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_BUS_H */
@@ -0,0 +1,212 @@
+/*
+ * Shared binary frame format
+ *
+ * One frame layout for every program in this repository that hands Lepton frames to
+ * another: the Linux capture programs' ZMQ messages, the shared memory frame bus slots
+ * (frame_bus.h) and the Python tools (ESP32/python/tcam_frame.py).  A frame is a fixed,
+ * versioned header followed by the pixels and, optionally, the Lepton's telemetry:
+ *
+ *   tcam_frame_hdr_t  header_len bytes (sizeof(tcam_frame_hdr_t) for this version)
+ *   pixels            pixel_len bytes, width * height pixels in format as compressed
+ *   telemetry         telem_len bytes of telemetry words (0 if not included)
+ *
+ * The header carries what a consumer needs without parsing the telemetry: geometry,
+ * pixel format and bit depth, capture sequence number, timestamps and the commonly
+ * used telemetry values.  It is little-endian and is written and read in place: a
+ * producer fills the header and packs the pixels straight behind it, and a consumer
+ * checks a received buffer with tcam_frame_view() and reads the pixels where they are.
+ *
+ * Versions only add fields to the end of the header (consumers skip header_len bytes to
+ * find the pixels).  A consumer accepts frames with a newer version and ignores the
+ * fields it doesn't know.
+ *
+ * Everything is static inline so this header is the whole implementation.
+ *
+ */
+#ifndef TCAM_FRAME_H
+#define TCAM_FRAME_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "tcam_frame.h headers are read in place and need a little-endian host"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Frame constants
+//
+
+#define TCAM_FRAME_MAGIC        0x52464354   // "TCFR"
+#define TCAM_FRAME_VERSION      1
+
+// Pixel formats
+#define TCAM_FRAME_FMT_8        0    // 8-bit (AGC) pixels
+#define TCAM_FRAME_FMT_16LE     1    // 16-bit little-endian pixels
+#define TCAM_FRAME_FMT_16BE     2    // 16-bit big-endian pixels (as sent by the Lepton)
+
+// Compression (the same values as the ESP32 binary image BIN_ENC_xxx encodings)
+#define TCAM_FRAME_COMP_RAW        0
+#define TCAM_FRAME_COMP_RICE       1    // See ESP32 rice_codec.h
+#define TCAM_FRAME_COMP_RICE_DELTA 2    // Against the previous frame
+#define TCAM_FRAME_COMP_PNG        3
+#define TCAM_FRAME_COMP_JPEG       4
+
+// Flags
+#define TCAM_FRAME_FLAG_TLINEAR  0x0001   // Pixels are Kelvin * 100 (or * 10, see tlinear)
+#define TCAM_FRAME_FLAG_TELEM_BE 0x0002   // Telemetry words are big-endian (as sent by the Lepton)
+#define TCAM_FRAME_FLAG_WALL     0x0004   // wall_usec is valid
+
+// Telemetry values in the header (telem_fields mask, the same bits as the ESP32
+// LEP_TEL_FLD_xxx telemetry field mask)
+#define TCAM_FRAME_TEL_FRAME_CNT 0x01     // lep_frame_count
+#define TCAM_FRAME_TEL_FPA_TEMP  0x02     // fpa_temp_k100
+#define TCAM_FRAME_TEL_AUX_TEMP  0x04     // aux_temp_k100
+#define TCAM_FRAME_TEL_FFC       0x08     // ffc
+#define TCAM_FRAME_TEL_GAIN      0x10     // gain_mode
+#define TCAM_FRAME_TEL_TLIN      0x20     // tlinear
+
+
+//
+// Frame header (64 bytes)
+//
+typedef struct __attribute__((packed)) {
+	uint32_t magic;            // TCAM_FRAME_MAGIC
+	uint16_t version;          // TCAM_FRAME_VERSION
+	uint16_t header_len;       // Bytes before the pixels
+	uint16_t width;
+	uint16_t height;
+	uint8_t bits;              // Significant bits per pixel (8, 14 or 16)
+	uint8_t format;            // TCAM_FRAME_FMT_*
+	uint8_t compression;       // TCAM_FRAME_COMP_*
+	uint8_t telem_fields;      // TCAM_FRAME_TEL_* values that are valid
+	uint16_t flags;            // TCAM_FRAME_FLAG_*
+	uint16_t telem_len;        // Telemetry bytes following the pixels
+	uint32_t pixel_len;        // Pixel bytes (as compressed)
+	uint32_t seq;              // Capture sequence number (gaps are frames never sent)
+	int64_t timestamp_usec;    // Capture time on the producer's clock (CLOCK_MONOTONIC on Linux)
+	int64_t wall_usec;         // Capture time in uSec since 1970 with TCAM_FRAME_FLAG_WALL
+	uint32_t lep_frame_count;  // The Lepton's frame counter
+	uint16_t fpa_temp_k100;    // FPA temperature (Kelvin * 100)
+	uint16_t aux_temp_k100;    // Housing temperature (Kelvin * 100)
+	uint8_t ffc;               // FFC state (bits 1:0), FFC desired (bit 2)
+	uint8_t gain_mode;         // Effective gain mode (0: High, 1: Low)
+	uint8_t tlinear;           // TLinear enabled (bit 0), 0.01 K resolution (bit 1)
+	uint8_t reserved[9];
+} tcam_frame_hdr_t;
+
+#ifndef __cplusplus
+_Static_assert(sizeof(tcam_frame_hdr_t) == 64, "tcam_frame_hdr_t must be 64 bytes");
+#endif
+
+
+
+//
+// Producer API
+//
+
+/**
+ * Initialize a header for a raw frame of the given geometry (pixel_len is set for the
+ * uncompressed pixels).  The caller fills in the sequence number, timestamps, telemetry
+ * values and flags.
+ */
+static inline void tcam_frame_init(tcam_frame_hdr_t* hdr, int width, int height, int bits, int format)
+{
+	memset(hdr, 0, sizeof(tcam_frame_hdr_t));
+	hdr->magic = TCAM_FRAME_MAGIC;
+	hdr->version = TCAM_FRAME_VERSION;
+	hdr->header_len = sizeof(tcam_frame_hdr_t);
+	hdr->width = width;
+	hdr->height = height;
+	hdr->bits = bits;
+	hdr->format = format;
+	hdr->pixel_len = width * height * ((format == TCAM_FRAME_FMT_8) ? 1 : 2);
+}
+
+
+//
+// Accessors (for producers and consumers)
+//
+
+/**
+ * Returns the first byte of the pixels
+ */
+static inline uint8_t* tcam_frame_pixels(const tcam_frame_hdr_t* hdr)
+{
+	return (uint8_t*) hdr + hdr->header_len;
+}
+
+
+/**
+ * Returns the first byte of the telemetry (where it goes when writing a frame)
+ */
+static inline uint8_t* tcam_frame_telem(const tcam_frame_hdr_t* hdr)
+{
+	return tcam_frame_pixels(hdr) + hdr->pixel_len;
+}
+
+
+/**
+ * Returns the length of the whole frame
+ */
+static inline size_t tcam_frame_len(const tcam_frame_hdr_t* hdr)
+{
+	return (size_t) hdr->header_len + hdr->pixel_len + hdr->telem_len;
+}
+
+
+/**
+ * Returns pixel n of a raw frame as a host-order 16-bit value
+ */
+static inline uint16_t tcam_frame_pixel(const tcam_frame_hdr_t* hdr, int n)
+{
+	const uint8_t* p = tcam_frame_pixels(hdr);
+
+	switch (hdr->format) {
+		case TCAM_FRAME_FMT_8:
+			return p[n];
+		case TCAM_FRAME_FMT_16BE:
+			return ((uint16_t) p[2*n] << 8) | p[2*n + 1];
+		default:
+			return p[2*n] | ((uint16_t) p[2*n + 1] << 8);
+	}
+}
+
+
+//
+// Consumer API
+//
+
+/**
+ * Check that the len bytes at buf hold a complete frame (with all of its pixels if it
+ * is raw) and return its header to be read in place, or NULL if they don't.
+ */
+static inline const tcam_frame_hdr_t* tcam_frame_view(const void* buf, size_t len)
+{
+	const tcam_frame_hdr_t* hdr = (const tcam_frame_hdr_t*) buf;
+
+	if ((len < sizeof(tcam_frame_hdr_t)) || (hdr->magic != TCAM_FRAME_MAGIC) ||
+	    (hdr->version < 1) || (hdr->header_len < sizeof(tcam_frame_hdr_t)) ||
+	    (tcam_frame_len(hdr) > len)) {
+		return NULL;
+	}
+	if ((hdr->compression == TCAM_FRAME_COMP_RAW) &&
+	    (hdr->pixel_len < (uint32_t) hdr->width * hdr->height * ((hdr->format == TCAM_FRAME_FMT_8) ? 1 : 2))) {
+		return NULL;
+	}
+	return hdr;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TCAM_FRAME_H */
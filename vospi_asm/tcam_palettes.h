@@ -0,0 +1,1396 @@
+/*
+ * tCam palettes as RGB565 and RGBA32 (0xAARRGGBB) lookup tables indexed by 8-bit pixels
+ *
+ * Generated from ESP32/python/palettes/palettes.bin by python3 -m palettes.  Do not
+ * edit, change palettes.bin and run it again.
+ *
+ */
+#ifndef TCAM_PALETTES_H
+#define TCAM_PALETTES_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+typedef struct {
+	const char* name;
+	const uint16_t* rgb565;
+	const uint32_t* rgba32;
+} tcam_palette_t;
+
+#define TCAM_NUM_PALETTES 16
+
+
+//
+// arctic
+//
+static const uint16_t tcam_arctic_rgb565[256] = {
+	0x0892, 0x0892, 0x0873, 0x0873, 0x0873, 0x0873, 0x1074, 0x1074,
+	0x0875, 0x0875, 0x1076, 0x1076, 0x1097, 0x1097, 0x0878, 0x0878,
+	0x0879, 0x0879, 0x087A, 0x087A, 0x107B, 0x107B, 0x107C, 0x107C,
+	0x109D, 0x109D, 0x10DE, 0x10DE, 0x091D, 0x091D, 0x097D, 0x097D,
+	0x09BD, 0x09BD, 0x09FD, 0x09FD, 0x0A5D, 0x0A5D, 0x129D, 0x129D,
+	0x12FD, 0x12FD, 0x133D, 0x133D, 0x1B7D, 0x1B7D, 0x1BDD, 0x1BDD,
+	0x1C1D, 0x1C1D, 0x247D, 0x247D, 0x24BD, 0x24BD, 0x251D, 0x251D,
+	0x255D, 0x255D, 0x2D9D, 0x2D9D, 0x2DFD, 0x2DFD, 0x2E3D, 0x2E3D,
+	0x369D, 0x369D, 0x36DD, 0x36DD, 0x371D, 0x371D, 0x3F1C, 0x3F1C,
+	0x3F1C, 0x3F1C, 0x3F1C, 0x3F1C, 0x46FB, 0x46FB, 0x46FB, 0x46FB,
+	0x46BA, 0x46BA, 0x469A, 0x469A, 0x4E79, 0x4E79, 0x4E38, 0x4E38,
+	0x4E18, 0x4E18, 0x55D7, 0x55D7, 0x55B6, 0x55B6, 0x5575, 0x5575,
+	0x5D55, 0x5D55, 0x5D34, 0x5D34, 0x5CF3, 0x5CF3, 0x5CD3, 0x5CD3,
+	0x5C92, 0x5C92, 0x5C71, 0x5C71, 0x5C30, 0x5C30, 0x5C10, 0x5C10,
+	0x5BCF, 0x5BCF, 0x63AE, 0x63AE, 0x636D, 0x636D, 0x634D, 0x634D,
+	0x632C, 0x632C, 0x6B2C, 0x6B2C, 0x732B, 0x732B, 0x732B, 0x732B,
+	0x7B2A, 0x7B2A, 0x832A, 0x832A, 0x832A, 0x832A, 0x8B29, 0x8B29,
+	0x8B29, 0x8B29, 0x9328, 0x9328, 0x9B28, 0x9B28, 0x9B27, 0x9B27,
+	0xA327, 0xA327, 0xAB27, 0xAB27, 0xAB26, 0xAB26, 0xB326, 0xB326,
+	0xBB25, 0xBB25, 0xBB25, 0xBB25, 0xC324, 0xC324, 0xCB24, 0xCB24,
+	0xCB23, 0xCB23, 0xD323, 0xD323, 0xDB23, 0xDB23, 0xDB22, 0xDB22,
+	0xE322, 0xE322, 0xEB21, 0xEB21, 0xEB21, 0xEB21, 0xEB41, 0xEB41,
+	0xEB81, 0xEB81, 0xEBC1, 0xEBC1, 0xEBC1, 0xEBC1, 0xEC01, 0xEC01,
+	0xEC41, 0xEC41, 0xEC61, 0xEC61, 0xECA1, 0xECA1, 0xECE1, 0xECE1,
+	0xED01, 0xED01, 0xED21, 0xED21, 0xED61, 0xED61, 0xED81, 0xED81,
+	0xEDC1, 0xEDC1, 0xEDE1, 0xEDE1, 0xEE21, 0xEE21, 0xEE41, 0xEE41,
+	0xEE63, 0xEE63, 0xEE64, 0xEE64, 0xEE86, 0xEE86, 0xEE88, 0xEE88,
+	0xEEA8, 0xEEA8, 0xEEAA, 0xEEAA, 0xEECC, 0xEECC, 0xEECD, 0xEECD,
+	0xEEEF, 0xEEEF, 0xEEF1, 0xEEF1, 0xEEF2, 0xEEF2, 0xEF14, 0xEF14,
+	0xEF15, 0xEF15, 0xEF16, 0xEF16, 0xEF37, 0xEF37, 0xEF38, 0xEF38,
+	0xEF5D, 0xEF5D, 0xEF5D, 0xEF5D, 0xE73C, 0xE73C, 0xE73C, 0xE73C,
+	0xE71C, 0xE71C, 0xE71C, 0xE71C, 0xDEFB, 0xDEFB, 0xDEFB, 0xDEFB,
+};
+
+static const uint32_t tcam_arctic_rgba32[256] = {
+	0xFF0F1092, 0xFF0F1092, 0xFF0F0F99, 0xFF0F0F99, 0xFF0F0F9F, 0xFF0F0F9F,
+	0xFF100FA7, 0xFF100FA7, 0xFF0F0FAF, 0xFF0F0FAF, 0xFF100FB6, 0xFF100FB6,
+	0xFF1010BE, 0xFF1010BE, 0xFF0E0FC5, 0xFF0E0FC5, 0xFF0F0FCD, 0xFF0F0FCD,
+	0xFF0F0FD3, 0xFF0F0FD3, 0xFF100FDB, 0xFF100FDB, 0xFF100FE3, 0xFF100FE3,
+	0xFF1012EF, 0xFF1012EF, 0xFF1019F0, 0xFF1019F0, 0xFF0F22EF, 0xFF0F22EF,
+	0xFF0F2CEE, 0xFF0F2CEE, 0xFF0E36EF, 0xFF0E36EF, 0xFF0E3FEF, 0xFF0E3FEF,
+	0xFF0E4AEE, 0xFF0E4AEE, 0xFF1152EE, 0xFF1152EE, 0xFF135CED, 0xFF135CED,
+	0xFF1666EF, 0xFF1666EF, 0xFF186FEE, 0xFF186FEE, 0xFF1B78ED, 0xFF1B78ED,
+	0xFF1C83ED, 0xFF1C83ED, 0xFF208CED, 0xFF208CED, 0xFF2296ED, 0xFF2296ED,
+	0xFF24A0EC, 0xFF24A0EC, 0xFF27A8ED, 0xFF27A8ED, 0xFF2AB3ED, 0xFF2AB3ED,
+	0xFF2CBCEC, 0xFF2CBCEC, 0xFF2EC5EC, 0xFF2EC5EC, 0xFF31D0EC, 0xFF31D0EC,
+	0xFF34D9EB, 0xFF34D9EB, 0xFF36E3E8, 0xFF36E3E8, 0xFF39E3E6, 0xFF39E3E6,
+	0xFF3AE2E3, 0xFF3AE2E3, 0xFF3EE0E1, 0xFF3EE0E1, 0xFF40DEDE, 0xFF40DEDE,
+	0xFF42DCDC, 0xFF42DCDC, 0xFF43D7D7, 0xFF43D7D7, 0xFF45D1D2, 0xFF45D1D2,
+	0xFF49CDCC, 0xFF49CDCC, 0xFF4CC6C7, 0xFF4CC6C7, 0xFF4FC1C0, 0xFF4FC1C0,
+	0xFF51BBBB, 0xFF51BBBB, 0xFF53B5B4, 0xFF53B5B4, 0xFF57AFAF, 0xFF57AFAF,
+	0xFF58AAAA, 0xFF58AAAA, 0xFF58A4A5, 0xFF58A4A5, 0xFF5A9E9F, 0xFF5A9E9F,
+	0xFF5A9899, 0xFF5A9899, 0xFF5A9291, 0xFF5A9291, 0xFF5C8C8C, 0xFF5C8C8C,
+	0xFF5C8686, 0xFF5C8686, 0xFF5F8181, 0xFF5F8181, 0xFF5F7B7B, 0xFF5F7B7B,
+	0xFF607574, 0xFF607574, 0xFF616F6E, 0xFF616F6E, 0xFF636969, 0xFF636969,
+	0xFF666666, 0xFF666666, 0xFF6B6561, 0xFF6B6561, 0xFF70655F, 0xFF70655F,
+	0xFF75655A, 0xFF75655A, 0xFF7B6657, 0xFF7B6657, 0xFF816554, 0xFF816554,
+	0xFF866550, 0xFF866550, 0xFF8A664C, 0xFF8A664C, 0xFF8F6549, 0xFF8F6549,
+	0xFF946545, 0xFF946545, 0xFF996542, 0xFF996542, 0xFF9F663F, 0xFF9F663F,
+	0xFFA5663B, 0xFFA5663B, 0xFFAA6538, 0xFFAA6538, 0xFFAF6534, 0xFFAF6534,
+	0xFFB46530, 0xFFB46530, 0xFFB9642D, 0xFFB9642D, 0xFFBF6429, 0xFFBF6429,
+	0xFFC56525, 0xFFC56525, 0xFFC96523, 0xFFC96523, 0xFFCE651F, 0xFFCE651F,
+	0xFFD3651A, 0xFFD3651A, 0xFFD86518, 0xFFD86518, 0xFFDD6513, 0xFFDD6513,
+	0xFFE46512, 0xFFE46512, 0xFFE9650E, 0xFFE9650E, 0xFFED650D, 0xFFED650D,
+	0xFFEC690D, 0xFFEC690D, 0xFFEC700C, 0xFFEC700C, 0xFFEC780D, 0xFFEC780D,
+	0xFFED7B0D, 0xFFED7B0D, 0xFFED820C, 0xFFED820C, 0xFFED890D, 0xFFED890D,
+	0xFFED8E0C, 0xFFED8E0C, 0xFFED950C, 0xFFED950C, 0xFFEC9C0D, 0xFFEC9C0D,
+	0xFFECA00B, 0xFFECA00B, 0xFFEBA70C, 0xFFEBA70C, 0xFFEBAD0C, 0xFFEBAD0C,
+	0xFFEBB30C, 0xFFEBB30C, 0xFFEBB90C, 0xFFEBB90C, 0xFFECBF0D, 0xFFECBF0D,
+	0xFFECC40B, 0xFFECC40B, 0xFFEBCA0C, 0xFFEBCA0C, 0xFFECCC1B, 0xFFECCC1B,
+	0xFFEBCF22, 0xFFEBCF22, 0xFFECD032, 0xFFECD032, 0xFFEBD341, 0xFFEBD341,
+	0xFFEBD447, 0xFFEBD447, 0xFFEBD657, 0xFFEBD657, 0xFFEBD864, 0xFFEBD864,
+	0xFFEBD86C, 0xFFEBD86C, 0xFFECDC7B, 0xFFECDC7B, 0xFFEBDD8A, 0xFFEBDD8A,
+	0xFFEBDD92, 0xFFEBDD92, 0xFFEBE1A0, 0xFFEBE1A0, 0xFFEBE1AF, 0xFFEBE1AF,
+	0xFFECE3B6, 0xFFECE3B6, 0xFFEBE5BF, 0xFFEBE5BF, 0xFFEBE6C2, 0xFFEBE6C2,
+	0xFFEBEBEB, 0xFFEAEAEA, 0xFFE9E9E9, 0xFFE8E8E8, 0xFFE7E7E7, 0xFFE6E6E6,
+	0xFFE5E5E5, 0xFFE4E4E4, 0xFFE3E3E3, 0xFFE2E2E2, 0xFFE1E1E1, 0xFFE0E0E0,
+	0xFFDFDFDF, 0xFFDEDEDE, 0xFFDDDDDD, 0xFFDCDCDC,
+};
+
+//
+// black_hot
+//
+static const uint16_t tcam_black_hot_rgb565[256] = {
+	0xEF5D, 0xEF5D, 0xEF5D, 0xEF5D, 0xE73C, 0xE73C, 0xE73C, 0xE73C,
+	0xE71C, 0xE71C, 0xE71C, 0xE71C, 0xDEFB, 0xDEFB, 0xDEFB, 0xDEFB,
+	0xDEDB, 0xDEDB, 0xDEDB, 0xDEDB, 0xD6BA, 0xD6BA, 0xD6BA, 0xD6BA,
+	0xD69A, 0xD69A, 0xD69A, 0xD69A, 0xD69A, 0xCE79, 0xCE79, 0xCE79,
+	0xCE79, 0xCE59, 0xCE59, 0xCE59, 0xCE59, 0xC638, 0xC638, 0xC638,
+	0xC638, 0xC618, 0xC618, 0xC618, 0xC618, 0xBDF7, 0xBDF7, 0xBDF7,
+	0xBDF7, 0xBDD7, 0xBDD7, 0xBDD7, 0xBDD7, 0xB5B6, 0xB5B6, 0xB5B6,
+	0xB5B6, 0xB596, 0xB596, 0xB596, 0xB596, 0xAD75, 0xAD75, 0xAD75,
+	0xAD75, 0xAD55, 0xAD55, 0xAD55, 0xAD55, 0xA534, 0xA534, 0xA534,
+	0xA534, 0xA514, 0xA514, 0xA514, 0xA514, 0x9CF3, 0x9CF3, 0x9CF3,
+	0x9CF3, 0x9CD3, 0x9CD3, 0x9CD3, 0x9CD3, 0x9CD3, 0x94B2, 0x94B2,
+	0x94B2, 0x94B2, 0x9492, 0x9492, 0x9492, 0x9492, 0x8C71, 0x8C71,
+	0x8C71, 0x8C71, 0x8C51, 0x8C51, 0x8C51, 0x8C51, 0x8430, 0x8430,
+	0x8430, 0x8430, 0x8410, 0x8410, 0x8410, 0x8410, 0x7BEF, 0x7BEF,
+	0x7BEF, 0x7BEF, 0x7BCF, 0x7BCF, 0x7BCF, 0x7BCF, 0x73AE, 0x73AE,
+	0x73AE, 0x73AE, 0x738E, 0x738E, 0x738E, 0x738E, 0x6B6D, 0x6B6D,
+	0x6B6D, 0x6B6D, 0x6B4D, 0x6B4D, 0x6B4D, 0x6B4D, 0x632C, 0x632C,
+	0x632C, 0x632C, 0x630C, 0x630C, 0x630C, 0x630C, 0x630C, 0x5AEB,
+	0x5AEB, 0x5AEB, 0x5AEB, 0x5ACB, 0x5ACB, 0x5ACB, 0x5ACB, 0x52AA,
+	0x52AA, 0x52AA, 0x52AA, 0x528A, 0x528A, 0x528A, 0x528A, 0x4A69,
+	0x4A69, 0x4A69, 0x4A69, 0x4A49, 0x4A49, 0x4A49, 0x4A49, 0x4228,
+	0x4228, 0x4228, 0x4228, 0x4208, 0x4208, 0x4208, 0x4208, 0x39E7,
+	0x39E7, 0x39E7, 0x39E7, 0x39C7, 0x39C7, 0x39C7, 0x39C7, 0x31A6,
+	0x31A6, 0x31A6, 0x31A6, 0x3186, 0x3186, 0x3186, 0x3186, 0x2965,
+	0x2965, 0x2965, 0x2965, 0x2965, 0x2945, 0x2945, 0x2945, 0x2945,
+	0x2124, 0x2124, 0x2124, 0x2124, 0x2104, 0x2104, 0x2104, 0x2104,
+	0x18E3, 0x18E3, 0x18E3, 0x18E3, 0x18C3, 0x18C3, 0x18C3, 0x18C3,
+	0x10A2, 0x10A2, 0x10A2, 0x10A2, 0x1082, 0x1082, 0x1082, 0x1082,
+	0x1219, 0x121A, 0x121A, 0x123A, 0x123A, 0x125B, 0x125B, 0x127B,
+	0x127B, 0x129C, 0x12BC, 0x12BC, 0x12DC, 0x12DC, 0x12FC, 0x12FC,
+	0x131D, 0x133D, 0x133D, 0x135D, 0x137D, 0x1B9D, 0x139D, 0x1BBD,
+	0x1BBD, 0x1BDD, 0x1BFD, 0x1BFD, 0x1BFD, 0x1C1D, 0x1C3D, 0x1C5D,
+};
+
+static const uint32_t tcam_black_hot_rgba32[256] = {
+	0xFFEBEBEB, 0xFFEAEAEA, 0xFFE9E9E9, 0xFFE8E8E8, 0xFFE7E7E7, 0xFFE6E6E6,
+	0xFFE5E5E5, 0xFFE4E4E4, 0xFFE3E3E3, 0xFFE2E2E2, 0xFFE1E1E1, 0xFFE0E0E0,
+	0xFFDFDFDF, 0xFFDEDEDE, 0xFFDDDDDD, 0xFFDCDCDC, 0xFFDBDBDB, 0xFFDADADA,
+	0xFFD9D9D9, 0xFFD8D8D8, 0xFFD7D7D7, 0xFFD6D6D6, 0xFFD5D5D5, 0xFFD4D4D4,
+	0xFFD3D3D3, 0xFFD2D2D2, 0xFFD1D1D1, 0xFFD1D1D1, 0xFFD0D0D0, 0xFFCFCFCF,
+	0xFFCECECE, 0xFFCDCDCD, 0xFFCCCCCC, 0xFFCBCBCB, 0xFFCACACA, 0xFFC9C9C9,
+	0xFFC8C8C8, 0xFFC7C7C7, 0xFFC6C6C6, 0xFFC5C5C5, 0xFFC4C4C4, 0xFFC3C3C3,
+	0xFFC2C2C2, 0xFFC1C1C1, 0xFFC0C0C0, 0xFFBFBFBF, 0xFFBEBEBE, 0xFFBDBDBD,
+	0xFFBCBCBC, 0xFFBBBBBB, 0xFFBABABA, 0xFFB9B9B9, 0xFFB8B8B8, 0xFFB7B7B7,
+	0xFFB6B6B6, 0xFFB5B5B5, 0xFFB4B4B4, 0xFFB3B3B3, 0xFFB2B2B2, 0xFFB1B1B1,
+	0xFFB0B0B0, 0xFFAFAFAF, 0xFFAEAEAE, 0xFFADADAD, 0xFFACACAC, 0xFFABABAB,
+	0xFFAAAAAA, 0xFFA9A9A9, 0xFFA8A8A8, 0xFFA7A7A7, 0xFFA6A6A6, 0xFFA5A5A5,
+	0xFFA4A4A4, 0xFFA3A3A3, 0xFFA2A2A2, 0xFFA1A1A1, 0xFFA0A0A0, 0xFF9F9F9F,
+	0xFF9E9E9E, 0xFF9D9D9D, 0xFF9C9C9C, 0xFF9B9B9B, 0xFF9A9A9A, 0xFF9A9A9A,
+	0xFF999999, 0xFF989898, 0xFF979797, 0xFF969696, 0xFF959595, 0xFF949494,
+	0xFF939393, 0xFF929292, 0xFF919191, 0xFF909090, 0xFF8F8F8F, 0xFF8E8E8E,
+	0xFF8D8D8D, 0xFF8C8C8C, 0xFF8B8B8B, 0xFF8A8A8A, 0xFF898989, 0xFF888888,
+	0xFF878787, 0xFF868686, 0xFF858585, 0xFF848484, 0xFF838383, 0xFF828282,
+	0xFF818181, 0xFF808080, 0xFF7F7F7F, 0xFF7E7E7E, 0xFF7D7D7D, 0xFF7C7C7C,
+	0xFF7B7B7B, 0xFF7A7A7A, 0xFF797979, 0xFF787878, 0xFF777777, 0xFF767676,
+	0xFF757575, 0xFF747474, 0xFF737373, 0xFF727272, 0xFF717171, 0xFF707070,
+	0xFF6F6F6F, 0xFF6E6E6E, 0xFF6D6D6D, 0xFF6C6C6C, 0xFF6B6B6B, 0xFF6A6A6A,
+	0xFF696969, 0xFF686868, 0xFF676767, 0xFF666666, 0xFF656565, 0xFF646464,
+	0xFF636363, 0xFF636363, 0xFF626262, 0xFF616161, 0xFF606060, 0xFF5F5F5F,
+	0xFF5E5E5E, 0xFF5D5D5D, 0xFF5C5C5C, 0xFF5B5B5B, 0xFF5A5A5A, 0xFF595959,
+	0xFF585858, 0xFF575757, 0xFF565656, 0xFF555555, 0xFF545454, 0xFF535353,
+	0xFF525252, 0xFF515151, 0xFF505050, 0xFF4F4F4F, 0xFF4E4E4E, 0xFF4D4D4D,
+	0xFF4C4C4C, 0xFF4B4B4B, 0xFF4A4A4A, 0xFF494949, 0xFF484848, 0xFF474747,
+	0xFF464646, 0xFF454545, 0xFF444444, 0xFF434343, 0xFF424242, 0xFF414141,
+	0xFF404040, 0xFF3F3F3F, 0xFF3E3E3E, 0xFF3D3D3D, 0xFF3C3C3C, 0xFF3B3B3B,
+	0xFF3A3A3A, 0xFF393939, 0xFF383838, 0xFF373737, 0xFF363636, 0xFF353535,
+	0xFF343434, 0xFF333333, 0xFF323232, 0xFF313131, 0xFF303030, 0xFF2F2F2F,
+	0xFF2E2E2E, 0xFF2D2D2D, 0xFF2C2C2C, 0xFF2C2C2C, 0xFF2B2B2B, 0xFF2A2A2A,
+	0xFF292929, 0xFF282828, 0xFF272727, 0xFF262626, 0xFF252525, 0xFF242424,
+	0xFF232323, 0xFF222222, 0xFF212121, 0xFF202020, 0xFF1F1F1F, 0xFF1E1E1E,
+	0xFF1D1D1D, 0xFF1C1C1C, 0xFF1B1B1B, 0xFF1A1A1A, 0xFF191919, 0xFF181818,
+	0xFF171717, 0xFF161616, 0xFF151515, 0xFF141414, 0xFF131313, 0xFF121212,
+	0xFF111111, 0xFF101010, 0xFF1340CE, 0xFF1241D1, 0xFF1243D2, 0xFF1345D4,
+	0xFF1247D7, 0xFF1349D9, 0xFF124BDA, 0xFF124DDB, 0xFF134FDF, 0xFF1352E1,
+	0xFF1354E2, 0xFF1255E3, 0xFF1358E5, 0xFF155AE5, 0xFF165DE7, 0xFF155FE6,
+	0xFF1662E8, 0xFF1665E8, 0xFF1667E8, 0xFF176AEA, 0xFF176DEA, 0xFF1870EC,
+	0xFF1772EB, 0xFF1974EB, 0xFF1977ED, 0xFF1B7AEE, 0xFF1A7CED, 0xFF1B7DEC,
+	0xFF1B7FEB, 0xFF1B82EC, 0xFF1D85EA, 0xFF1E88EA,
+};
+
+//
+// blue_red
+//
+static const uint16_t tcam_blue_red_rgb565[256] = {
+	0x1219, 0x121A, 0x121A, 0x123A, 0x123A, 0x125B, 0x125B, 0x127B,
+	0x127B, 0x129C, 0x12BC, 0x12BC, 0x12DC, 0x12DC, 0x12FC, 0x12FC,
+	0x131D, 0x133D, 0x133D, 0x135D, 0x137D, 0x1B9D, 0x139D, 0x1BBD,
+	0x1BBD, 0x1BDD, 0x1BFD, 0x1BFD, 0x1BFD, 0x1C1D, 0x1C3D, 0x1C5D,
+	0x1C5D, 0x247D, 0x249C, 0x249C, 0x24BC, 0x24DC, 0x24FC, 0x24FC,
+	0x251C, 0x253C, 0x2D3B, 0x2D5B, 0x2D7B, 0x2D9B, 0x2D9A, 0x2DBA,
+	0x35DA, 0x35FA, 0x35F9, 0x3619, 0x3619, 0x3E39, 0x3E58, 0x3E58,
+	0x3E78, 0x3E77, 0x4697, 0x4697, 0x46B6, 0x46B6, 0x4ED6, 0x4ED5,
+	0x4EF5, 0x4EF4, 0x5714, 0x5714, 0x5713, 0x5F33, 0x5F33, 0x5F32,
+	0x6732, 0x6732, 0x6731, 0x6F31, 0x6F50, 0x6F50, 0x7750, 0x774F,
+	0x774F, 0x776F, 0x7F4E, 0x7F4E, 0x874E, 0x874D, 0x874D, 0x8F2C,
+	0x8F2C, 0x8F2C, 0x972C, 0x972B, 0x9F2B, 0x9F0B, 0x9F0A, 0x9F0A,
+	0xA70A, 0xA6EA, 0xA6E9, 0xAEE9, 0xAEC9, 0xAEC9, 0xB6A8, 0xB6A8,
+	0xB688, 0xBE68, 0xBE67, 0xC667, 0xC647, 0xC647, 0xCE26, 0xCE06,
+	0xCDE6, 0xCDE6, 0xD5C6, 0xD5A6, 0xD5A5, 0xD585, 0xDD65, 0xDD65,
+	0xDD45, 0xDD24, 0xE524, 0xE504, 0xE4E4, 0xE4C4, 0xE4A4, 0xE484,
+	0xEC84, 0xE463, 0xEC43, 0xEC43, 0xEC23, 0xEC03, 0xEBE3, 0xEBC3,
+	0xEBC3, 0xEBA3, 0xEB83, 0xEB83, 0xEB63, 0xEB62, 0xEB42, 0xE322,
+	0xE322, 0xE302, 0xE2E2, 0xE2E2, 0xE2C2, 0xE2A2, 0xE2A2, 0xE282,
+	0xDA82, 0xDA62, 0xDA62, 0xDA42, 0xD242, 0xD222, 0xD222, 0xD202,
+	0xCA02, 0xC9E2, 0xC9E2, 0xC9E2, 0xC9C2, 0xC1C2, 0xC1A2, 0xC1A2,
+	0xB9A1, 0xB981, 0xB982, 0xB181, 0xB161, 0xB162, 0xA942, 0xA941,
+	0xA941, 0xA141, 0xA121, 0xA121, 0x9922, 0x9901, 0x9902, 0x9101,
+	0x9102, 0x8902, 0x8901, 0x88E1, 0x80E1, 0x80E1, 0x80E1, 0x78E1,
+	0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D,
+	0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D,
+	0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D,
+	0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x2965, 0x2965,
+	0x2965, 0x3186, 0x3186, 0x3186, 0x3186, 0x31A6, 0x31A6, 0x31A6,
+	0x31A6, 0x39C7, 0x39C7, 0x39C7, 0x39C7, 0x39E7, 0x39E7, 0x39E7,
+	0x39E7, 0x4208, 0x4208, 0x4208, 0x4208, 0x4228, 0x4228, 0x4228,
+	0x4228, 0x4A49, 0x4A49, 0x4A49, 0x4A49, 0x4A69, 0x4A69, 0x4A69,
+};
+
+static const uint32_t tcam_blue_red_rgba32[256] = {
+	0xFF1340CE, 0xFF1241D1, 0xFF1243D2, 0xFF1345D4, 0xFF1247D7, 0xFF1349D9,
+	0xFF124BDA, 0xFF124DDB, 0xFF134FDF, 0xFF1352E1, 0xFF1354E2, 0xFF1255E3,
+	0xFF1358E5, 0xFF155AE5, 0xFF165DE7, 0xFF155FE6, 0xFF1662E8, 0xFF1665E8,
+	0xFF1667E8, 0xFF176AEA, 0xFF176DEA, 0xFF1870EC, 0xFF1772EB, 0xFF1974EB,
+	0xFF1977ED, 0xFF1B7AEE, 0xFF1A7CED, 0xFF1B7DEC, 0xFF1B7FEB, 0xFF1B82EC,
+	0xFF1D85EA, 0xFF1E88EA, 0xFF1F8BE9, 0xFF208DE8, 0xFF2191E7, 0xFF2193E7,
+	0xFF2196E7, 0xFF229AE5, 0xFF249CE4, 0xFF249EE3, 0xFF24A2E1, 0xFF26A5E0,
+	0xFF28A7DE, 0xFF29ABDD, 0xFF2BAED9, 0xFF2DB0D8, 0xFF2CB2D7, 0xFF2EB5D4,
+	0xFF30B8D2, 0xFF31BCD1, 0xFF33BECF, 0xFF35C1CE, 0xFF36C3C9, 0xFF38C6C8,
+	0xFF3AC8C6, 0xFF3BCAC4, 0xFF3DCDC0, 0xFF3FCEBE, 0xFF40D0BB, 0xFF44D2B8,
+	0xFF45D4B4, 0xFF47D7B2, 0xFF49D8B0, 0xFF4AD9AD, 0xFF4EDCAA, 0xFF4FDEA5,
+	0xFF52E0A4, 0xFF53E1A1, 0xFF55E39D, 0xFF58E49A, 0xFF5CE498, 0xFF5EE595,
+	0xFF60E693, 0xFF63E790, 0xFF66E68D, 0xFF68E788, 0xFF6AE886, 0xFF6DE983,
+	0xFF71EA81, 0xFF72EA7D, 0xFF74EB7B, 0xFF77EC78, 0xFF7AEB75, 0xFF7EE971,
+	0xFF80EA70, 0xFF83E96D, 0xFF86E86B, 0xFF89E767, 0xFF8BE666, 0xFF8FE763,
+	0xFF92E660, 0xFF95E55E, 0xFF98E45A, 0xFF9AE358, 0xFF9CE357, 0xFF9DE255,
+	0xFFA1E053, 0xFFA4DF51, 0xFFA6DD4F, 0xFFA9DC4D, 0xFFACD94A, 0xFFAFD84A,
+	0xFFB2D546, 0xFFB5D446, 0xFFB7D243, 0xFFBACF40, 0xFFBDCE3E, 0xFFC0CD3C,
+	0xFFC2C93A, 0xFFC5C839, 0xFFC8C536, 0xFFCAC335, 0xFFCDBF34, 0xFFCFBD33,
+	0xFFD0BB30, 0xFFD1B730, 0xFFD4B42D, 0xFFD6B22C, 0xFFD8AF2B, 0xFFDAAD2A,
+	0xFFDCA928, 0xFFDEA627, 0xFFE0A426, 0xFFE1A223, 0xFFE49D23, 0xFFE39922,
+	0xFFE49520, 0xFFE69321, 0xFFE89020, 0xFFE78D1F, 0xFFE88A1D, 0xFFE8881C,
+	0xFFE9841C, 0xFFEB821B, 0xFFEA7F1B, 0xFFEB7B19, 0xFFED781A, 0xFFEB7618,
+	0xFFEA7318, 0xFFEB7118, 0xFFEA6E18, 0xFFEA6C16, 0xFFE86916, 0xFFE76616,
+	0xFFE76415, 0xFFE76114, 0xFFE65E14, 0xFFE45C14, 0xFFE45912, 0xFFE45713,
+	0xFFE35412, 0xFFE05212, 0xFFDF5113, 0xFFDE4E13, 0xFFDB4C13, 0xFFD94A11,
+	0xFFD74812, 0xFFD64711, 0xFFD34511, 0xFFD24211, 0xFFCF4010, 0xFFCE3F11,
+	0xFFCD3E12, 0xFFCB3C10, 0xFFCA3A11, 0xFFC63911, 0xFFC43610, 0xFFC23611,
+	0xFFBE350F, 0xFFBC320F, 0xFFB93210, 0xFFB7300F, 0xFFB32E0F, 0xFFB12E10,
+	0xFFAF2B10, 0xFFAB2A0F, 0xFFA9290E, 0xFFA6280E, 0xFFA4250E, 0xFFA0260F,
+	0xFF9D2510, 0xFF9A230F, 0xFF982310, 0xFF95220F, 0xFF932210, 0xFF8E2110,
+	0xFF8C210F, 0xFF8B1F0F, 0xFF861E0F, 0xFF831E0E, 0xFF801C0E, 0xFF7E1C0F,
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF2D2D2D, 0xFF2E2E2E, 0xFF2F2F2F, 0xFF303030, 0xFF313131, 0xFF323232,
+	0xFF333333, 0xFF343434, 0xFF353535, 0xFF363636, 0xFF373737, 0xFF383838,
+	0xFF393939, 0xFF3A3A3A, 0xFF3B3B3B, 0xFF3C3C3C, 0xFF3D3D3D, 0xFF3E3E3E,
+	0xFF3F3F3F, 0xFF404040, 0xFF414141, 0xFF424242, 0xFF434343, 0xFF444444,
+	0xFF454545, 0xFF464646, 0xFF474747, 0xFF484848, 0xFF494949, 0xFF4A4A4A,
+	0xFF4B4B4B, 0xFF4C4C4C, 0xFF4D4D4D, 0xFF4E4E4E,
+};
+
+//
+// coldest
+//
+static const uint16_t tcam_coldest_rgb565[256] = {
+	0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D,
+	0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D,
+	0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D,
+	0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x087D, 0x2965, 0x2965,
+	0x2965, 0x3186, 0x3186, 0x3186, 0x3186, 0x31A6, 0x31A6, 0x31A6,
+	0x31A6, 0x39C7, 0x39C7, 0x39C7, 0x39C7, 0x39E7, 0x39E7, 0x39E7,
+	0x39E7, 0x4208, 0x4208, 0x4208, 0x4208, 0x4228, 0x4228, 0x4228,
+	0x4228, 0x4A49, 0x4A49, 0x4A49, 0x4A49, 0x4A69, 0x4A69, 0x4A69,
+	0x4A69, 0x528A, 0x528A, 0x528A, 0x528A, 0x52AA, 0x52AA, 0x52AA,
+	0x52AA, 0x5ACB, 0x5ACB, 0x5ACB, 0x5ACB, 0x5AEB, 0x5AEB, 0x5AEB,
+	0x5AEB, 0x630C, 0x630C, 0x630C, 0x630C, 0x630C, 0x632C, 0x632C,
+	0x632C, 0x632C, 0x6B4D, 0x6B4D, 0x6B4D, 0x6B4D, 0x6B6D, 0x6B6D,
+	0x6B6D, 0x6B6D, 0x738E, 0x738E, 0x738E, 0x738E, 0x73AE, 0x73AE,
+	0x73AE, 0x73AE, 0x7BCF, 0x7BCF, 0x7BCF, 0x7BCF, 0x7BEF, 0x7BEF,
+	0x7BEF, 0x7BEF, 0x8410, 0x8410, 0x8410, 0x8410, 0x8430, 0x8430,
+	0x8430, 0x8430, 0x8C51, 0x8C51, 0x8C51, 0x8C51, 0x8C71, 0x8C71,
+	0x8C71, 0x8C71, 0x9492, 0x9492, 0x9492, 0x9492, 0x94B2, 0x94B2,
+	0x94B2, 0x94B2, 0x9CD3, 0x9CD3, 0x9CD3, 0x9CD3, 0x9CD3, 0x9CF3,
+	0x9CF3, 0x9CF3, 0x9CF3, 0xA514, 0xA514, 0xA514, 0xA514, 0xA534,
+	0xA534, 0xA534, 0xA534, 0xAD55, 0xAD55, 0xAD55, 0xAD55, 0xAD75,
+	0xAD75, 0xAD75, 0xAD75, 0xB596, 0xB596, 0xB596, 0xB596, 0xB5B6,
+	0xB5B6, 0xB5B6, 0xB5B6, 0xBDD7, 0xBDD7, 0xBDD7, 0xBDD7, 0xBDF7,
+	0xBDF7, 0xBDF7, 0xBDF7, 0xC618, 0xC618, 0xC618, 0xC618, 0xC638,
+	0xC638, 0xC638, 0xC638, 0xCE59, 0xCE59, 0xCE59, 0xCE59, 0xCE79,
+	0xCE79, 0xCE79, 0xCE79, 0xD69A, 0xD69A, 0xD69A, 0xD69A, 0xD69A,
+	0xD6BA, 0xD6BA, 0xD6BA, 0xD6BA, 0xDEDB, 0xDEDB, 0xDEDB, 0xDEDB,
+	0xDEFB, 0xDEFB, 0xDEFB, 0xDEFB, 0xE71C, 0xE71C, 0xE71C, 0xE71C,
+	0xE73C, 0xE73C, 0xE73C, 0xE73C, 0xEF5D, 0xEF5D, 0xEF5D, 0xEF5D,
+	0x1082, 0x1082, 0x1863, 0x2084, 0x2865, 0x3066, 0x3867, 0x4068,
+	0x4869, 0x506A, 0x586B, 0x606C, 0x686D, 0x706D, 0x786F, 0x786F,
+	0x8070, 0x8871, 0x9072, 0x9873, 0xA074, 0xA875, 0xB076, 0xB877,
+	0xC078, 0xC879, 0xD07A, 0xD87B, 0xD07A, 0xC87A, 0xC07A, 0xB879,
+};
+
+static const uint32_t tcam_coldest_rgba32[256] = {
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF, 0xFF0F0FEF,
+	0xFF2D2D2D, 0xFF2E2E2E, 0xFF2F2F2F, 0xFF303030, 0xFF313131, 0xFF323232,
+	0xFF333333, 0xFF343434, 0xFF353535, 0xFF363636, 0xFF373737, 0xFF383838,
+	0xFF393939, 0xFF3A3A3A, 0xFF3B3B3B, 0xFF3C3C3C, 0xFF3D3D3D, 0xFF3E3E3E,
+	0xFF3F3F3F, 0xFF404040, 0xFF414141, 0xFF424242, 0xFF434343, 0xFF444444,
+	0xFF454545, 0xFF464646, 0xFF474747, 0xFF484848, 0xFF494949, 0xFF4A4A4A,
+	0xFF4B4B4B, 0xFF4C4C4C, 0xFF4D4D4D, 0xFF4E4E4E, 0xFF4F4F4F, 0xFF505050,
+	0xFF515151, 0xFF525252, 0xFF535353, 0xFF545454, 0xFF555555, 0xFF565656,
+	0xFF575757, 0xFF585858, 0xFF595959, 0xFF5A5A5A, 0xFF5B5B5B, 0xFF5C5C5C,
+	0xFF5D5D5D, 0xFF5E5E5E, 0xFF5F5F5F, 0xFF606060, 0xFF616161, 0xFF626262,
+	0xFF636363, 0xFF636363, 0xFF646464, 0xFF656565, 0xFF666666, 0xFF676767,
+	0xFF686868, 0xFF696969, 0xFF6A6A6A, 0xFF6B6B6B, 0xFF6C6C6C, 0xFF6D6D6D,
+	0xFF6E6E6E, 0xFF6F6F6F, 0xFF707070, 0xFF717171, 0xFF727272, 0xFF737373,
+	0xFF747474, 0xFF757575, 0xFF767676, 0xFF777777, 0xFF787878, 0xFF797979,
+	0xFF7A7A7A, 0xFF7B7B7B, 0xFF7C7C7C, 0xFF7D7D7D, 0xFF7E7E7E, 0xFF7F7F7F,
+	0xFF808080, 0xFF818181, 0xFF828282, 0xFF838383, 0xFF848484, 0xFF858585,
+	0xFF868686, 0xFF878787, 0xFF888888, 0xFF898989, 0xFF8A8A8A, 0xFF8B8B8B,
+	0xFF8C8C8C, 0xFF8D8D8D, 0xFF8E8E8E, 0xFF8F8F8F, 0xFF909090, 0xFF919191,
+	0xFF929292, 0xFF939393, 0xFF949494, 0xFF959595, 0xFF969696, 0xFF979797,
+	0xFF989898, 0xFF999999, 0xFF9A9A9A, 0xFF9A9A9A, 0xFF9B9B9B, 0xFF9C9C9C,
+	0xFF9D9D9D, 0xFF9E9E9E, 0xFF9F9F9F, 0xFFA0A0A0, 0xFFA1A1A1, 0xFFA2A2A2,
+	0xFFA3A3A3, 0xFFA4A4A4, 0xFFA5A5A5, 0xFFA6A6A6, 0xFFA7A7A7, 0xFFA8A8A8,
+	0xFFA9A9A9, 0xFFAAAAAA, 0xFFABABAB, 0xFFACACAC, 0xFFADADAD, 0xFFAEAEAE,
+	0xFFAFAFAF, 0xFFB0B0B0, 0xFFB1B1B1, 0xFFB2B2B2, 0xFFB3B3B3, 0xFFB4B4B4,
+	0xFFB5B5B5, 0xFFB6B6B6, 0xFFB7B7B7, 0xFFB8B8B8, 0xFFB9B9B9, 0xFFBABABA,
+	0xFFBBBBBB, 0xFFBCBCBC, 0xFFBDBDBD, 0xFFBEBEBE, 0xFFBFBFBF, 0xFFC0C0C0,
+	0xFFC1C1C1, 0xFFC2C2C2, 0xFFC3C3C3, 0xFFC4C4C4, 0xFFC5C5C5, 0xFFC6C6C6,
+	0xFFC7C7C7, 0xFFC8C8C8, 0xFFC9C9C9, 0xFFCACACA, 0xFFCBCBCB, 0xFFCCCCCC,
+	0xFFCDCDCD, 0xFFCECECE, 0xFFCFCFCF, 0xFFD0D0D0, 0xFFD1D1D1, 0xFFD1D1D1,
+	0xFFD2D2D2, 0xFFD3D3D3, 0xFFD4D4D4, 0xFFD5D5D5, 0xFFD6D6D6, 0xFFD7D7D7,
+	0xFFD8D8D8, 0xFFD9D9D9, 0xFFDADADA, 0xFFDBDBDB, 0xFFDCDCDC, 0xFFDDDDDD,
+	0xFFDEDEDE, 0xFFDFDFDF, 0xFFE0E0E0, 0xFFE1E1E1, 0xFFE2E2E2, 0xFFE3E3E3,
+	0xFFE4E4E4, 0xFFE5E5E5, 0xFFE6E6E6, 0xFFE7E7E7, 0xFFE8E8E8, 0xFFE9E9E9,
+	0xFFEAEAEA, 0xFFEBEBEB, 0xFF101010, 0xFF171016, 0xFF1E0F1E, 0xFF251025,
+	0xFF2E0F2D, 0xFF350F34, 0xFF3C0F3C, 0xFF430F43, 0xFF4B0F4B, 0xFF520F51,
+	0xFF590F5A, 0xFF620E60, 0xFF690E69, 0xFF700E6F, 0xFF780F79, 0xFF7F0F7F,
+	0xFF870F87, 0xFF8F0E8E, 0xFF960E96, 0xFF9E0E9D, 0xFFA50EA5, 0xFFAC0EAC,
+	0xFFB30EB4, 0xFFBA0EBB, 0xFFC30EC3, 0xFFCA0EC9, 0xFFD10ED2, 0xFFD90ED8,
+	0xFFD10FD6, 0xFFCA0ED3, 0xFFC20FD1, 0xFFBB0ECE,
+};
+
+//
+// contrast
+//
+static const uint16_t tcam_contrast_rgb565[256] = {
+	0x1082, 0x1082, 0x1863, 0x2084, 0x2865, 0x3066, 0x3867, 0x4068,
+	0x4869, 0x506A, 0x586B, 0x606C, 0x686D, 0x706D, 0x786F, 0x786F,
+	0x8070, 0x8871, 0x9072, 0x9873, 0xA074, 0xA875, 0xB076, 0xB877,
+	0xC078, 0xC879, 0xD07A, 0xD87B, 0xD07A, 0xC87A, 0xC07A, 0xB879,
+	0xB079, 0xA879, 0xA078, 0x9878, 0x9078, 0x8877, 0x8077, 0x7877,
+	0x7877, 0x7076, 0x6876, 0x6076, 0x5875, 0x5075, 0x4875, 0x4074,
+	0x3874, 0x3074, 0x2873, 0x2073, 0x1873, 0x1072, 0x0872, 0x10B3,
+	0x08F3, 0x0933, 0x0973, 0x09B4, 0x09D4, 0x0A14, 0x0A55, 0x0A95,
+	0x0AD5, 0x0B16, 0x0B56, 0x0B76, 0x0BB6, 0x0BF7, 0x0C37, 0x0C77,
+	0x0CB8, 0x0CD8, 0x0D18, 0x0D58, 0x0D99, 0x0DD9, 0x0DF9, 0x0E3A,
+	0x0E7A, 0x0EBA, 0x0E99, 0x0E79, 0x0E38, 0x0E17, 0x0DF6, 0x0DD5,
+	0x0DB4, 0x0D93, 0x0D52, 0x0D31, 0x0D10, 0x0CEF, 0x0CAE, 0x0C8D,
+	0x0C6C, 0x0C4C, 0x0C2B, 0x0C0A, 0x0BC9, 0x0BA8, 0x0B87, 0x0B66,
+	0x0B45, 0x0B04, 0x0AE3, 0x0AC2, 0x0AA1, 0x12C1, 0x1AE1, 0x2301,
+	0x2B21, 0x3341, 0x3381, 0x3BA1, 0x43C1, 0x4BE1, 0x5401, 0x5C21,
+	0x6441, 0x6C61, 0x6C81, 0x74C1, 0x7CE1, 0x8501, 0x8D21, 0x9541,
+	0x9561, 0x9D81, 0xA5A1, 0xADC1, 0xB601, 0xBE20, 0xC640, 0xCE61,
+	0xCE80, 0xD6A0, 0xD680, 0xCE40, 0xCE00, 0xCDC0, 0xC5A1, 0xC561,
+	0xBD21, 0xBCE1, 0xB4C1, 0xB481, 0xB441, 0xAC21, 0xABE1, 0xABA1,
+	0xA381, 0xA341, 0xA301, 0x9AC1, 0x9AA1, 0x9261, 0x9221, 0x89E1,
+	0x89C1, 0x8981, 0x8141, 0x8121, 0x78E1, 0x78A1, 0x7861, 0x7882,
+	0x8082, 0x80A2, 0x80A2, 0x80A2, 0x88A3, 0x88C3, 0x90C3, 0x90E3,
+	0x90E3, 0x98E3, 0x9904, 0xA104, 0xA104, 0xA124, 0xA924, 0xA925,
+	0xA945, 0xB145, 0xB165, 0xB165, 0xB966, 0xB986, 0xB986, 0xC186,
+	0xC1A6, 0xC9A6, 0xC9A6, 0xC9E7, 0xCA08, 0xCA49, 0xCA69, 0xD2AA,
+	0xD2CB, 0xD30C, 0xD32D, 0xD36D, 0xD38E, 0xD3CF, 0xD3EF, 0xDC30,
+	0xDC51, 0xDC91, 0xDCB2, 0xDCF3, 0xDD14, 0xDD55, 0xDD75, 0xE5B6,
+	0xE5D7, 0xE618, 0xE638, 0xE679, 0xE69A, 0xE6DA, 0xE6FB, 0xEF3C,
+	0x1062, 0x1883, 0x2084, 0x2884, 0x30A6, 0x38A6, 0x40C7, 0x48C8,
+	0x50E9, 0x58EA, 0x60EB, 0x710C, 0x790D, 0x812D, 0x892F, 0x9150,
+	0x9951, 0x9171, 0x9172, 0x8992, 0x81B3, 0x81D4, 0x79F5, 0x71F5,
+	0x7216, 0x6A36, 0x6A57, 0x6278, 0x5A99, 0x5A99, 0x52BA, 0x4ADB,
+};
+
+static const uint32_t tcam_contrast_rgba32[256] = {
+	0xFF101010, 0xFF171016, 0xFF1E0F1E, 0xFF251025, 0xFF2E0F2D, 0xFF350F34,
+	0xFF3C0F3C, 0xFF430F43, 0xFF4B0F4B, 0xFF520F51, 0xFF590F5A, 0xFF620E60,
+	0xFF690E69, 0xFF700E6F, 0xFF780F79, 0xFF7F0F7F, 0xFF870F87, 0xFF8F0E8E,
+	0xFF960E96, 0xFF9E0E9D, 0xFFA50EA5, 0xFFAC0EAC, 0xFFB30EB4, 0xFFBA0EBB,
+	0xFFC30EC3, 0xFFCA0EC9, 0xFFD10ED2, 0xFFD90ED8, 0xFFD10FD6, 0xFFCA0ED3,
+	0xFFC20FD1, 0xFFBB0ECE, 0xFFB30FCC, 0xFFAC0EC9, 0xFFA50FC7, 0xFF9D0EC4,
+	0xFF960FC2, 0xFF8D0EBF, 0xFF870FBD, 0xFF7E0EBA, 0xFF780FB8, 0xFF700EB5,
+	0xFF690FB3, 0xFF610EB0, 0xFF5B0FAE, 0xFF520EAB, 0xFF4A0FA9, 0xFF430EA6,
+	0xFF3C0FA4, 0xFF340EA1, 0xFF2D0F9F, 0xFF260E9C, 0xFF1E0F9A, 0xFF170E97,
+	0xFF0F0F95, 0xFF101798, 0xFF0E1E9B, 0xFF0F269C, 0xFF0F2C9E, 0xFF0E35A2,
+	0xFF0E3BA4, 0xFF0F43A5, 0xFF0D4AA8, 0xFF0E52AB, 0xFF0F59AE, 0xFF0D60B0,
+	0xFF0E68B2, 0xFF0E6FB4, 0xFF0D77B7, 0xFF0D7DB9, 0xFF0E85BB, 0xFF0C8CBD,
+	0xFF0D94C0, 0xFF0E9BC3, 0xFF0CA2C6, 0xFF0DAAC7, 0xFF0DB1C9, 0xFF0CB9CD,
+	0xFF0CBFCF, 0xFF0DC7D0, 0xFF0BCED3, 0xFF0CD6D6, 0xFF0CD0CE, 0xFF0CCDC8,
+	0xFF0CC7C0, 0xFF0CC2B9, 0xFF0CBEB0, 0xFF0CB9A9, 0xFF0EB5A2, 0xFF0CB09B,
+	0xFF0DAA93, 0xFF0EA68D, 0xFF0DA185, 0xFF0D9C7D, 0xFF0E9777, 0xFF0D936E,
+	0xFF0E8E67, 0xFF0E8960, 0xFF0D8458, 0xFF0E8051, 0xFF0E7A4A, 0xFF0D7642,
+	0xFF0E713C, 0xFF0F6C34, 0xFF0E682C, 0xFF0F6324, 0xFF0F5D1D, 0xFF0F5A16,
+	0xFF0F540F, 0xFF17590E, 0xFF1C5D0D, 0xFF24610F, 0xFF2A670E, 0xFF316A0D,
+	0xFF37700D, 0xFF3F740C, 0xFF45780D, 0xFF4C7D0C, 0xFF54810C, 0xFF5A860B,
+	0xFF618A0A, 0xFF688F0C, 0xFF6F930B, 0xFF75980A, 0xFF7C9C09, 0xFF82A10A,
+	0xFF8AA50A, 0xFF90AA09, 0xFF97AE09, 0xFF9FB308, 0xFFA5B709, 0xFFACBB08,
+	0xFFB3C108, 0xFFBAC407, 0xFFC0CA06, 0xFFC8CE08, 0xFFCDD207, 0xFFD5D706,
+	0xFFD1D007, 0xFFCFC907, 0xFFCCC207, 0xFFC8BB07, 0xFFC4B408, 0xFFC2AD08,
+	0xFFBFA608, 0xFFBB9F09, 0xFFB79909, 0xFFB59109, 0xFFB28B0A, 0xFFAE840A,
+	0xFFAC7C0A, 0xFFA8760B, 0xFFA6700A, 0xFFA2690A, 0xFFA0620B, 0xFF9C5B0B,
+	0xFF99540B, 0xFF964D0C, 0xFF93460C, 0xFF8F3F0C, 0xFF8C390D, 0xFF89310D,
+	0xFF862B0D, 0xFF82240E, 0xFF7F1D0E, 0xFF7C160E, 0xFF790F0F, 0xFF7C1011,
+	0xFF801113, 0xFF821413, 0xFF851515, 0xFF871516, 0xFF8B1718, 0xFF8D1918,
+	0xFF901A1A, 0xFF941C1C, 0xFF971D1E, 0xFF991F1E, 0xFF9C2020, 0xFFA02222,
+	0xFFA32324, 0xFFA42424, 0xFFA82626, 0xFFAB2728, 0xFFAE282A, 0xFFB02B2A,
+	0xFFB42C2C, 0xFFB72D2E, 0xFFBB2E30, 0xFFBD3130, 0xFFBF3131, 0xFFC23233,
+	0xFFC63435, 0xFFC83635, 0xFFCB3737, 0xFFCC3C3D, 0xFFCD4344, 0xFFCE4948,
+	0xFFCF4F4F, 0xFFD05454, 0xFFD15B5B, 0xFFD26061, 0xFFD36768, 0xFFD46D6C,
+	0xFFD57372, 0xFFD67878, 0xFFD77F7F, 0xFFD88485, 0xFFD98B8B, 0xFFDA918F,
+	0xFFDB9796, 0xFFDC9C9C, 0xFFDDA3A3, 0xFFDEA8A9, 0xFFDFAFAF, 0xFFE0B5B3,
+	0xFFE1BBBA, 0xFFE2C0C0, 0xFFE3C7C7, 0xFFE4CCCC, 0xFFE5D3D3, 0xFFE6D9D7,
+	0xFFE7DFDE, 0xFFE8E4E4, 0xFF120F12, 0xFF19111A, 0xFF221220, 0xFF2B1327,
+	0xFF341530, 0xFF3C1737, 0xFF45193E, 0xFF4D1A46, 0xFF561C4B, 0xFF5F1E54,
+	0xFF671F5B, 0xFF702262, 0xFF78236A, 0xFF81246F, 0xFF8A2778, 0xFF922880,
+	0xFF9B2A88, 0xFF962C8C, 0xFF912F92, 0xFF8B3397, 0xFF86369D, 0xFF8239A1,
+	0xFF7C3CA8, 0xFF773FAC, 0xFF7342B3, 0xFF6D46B7, 0xFF6849BD, 0xFF634CC2,
+	0xFF5D50C8, 0xFF5953CD, 0xFF5456D3, 0xFF4E5AD8,
+};
+
+//
+// double_rainbow
+//
+static const uint16_t tcam_double_rainbow_rgb565[256] = {
+	0x1062, 0x1883, 0x2084, 0x2884, 0x30A6, 0x38A6, 0x40C7, 0x48C8,
+	0x50E9, 0x58EA, 0x60EB, 0x710C, 0x790D, 0x812D, 0x892F, 0x9150,
+	0x9951, 0x9171, 0x9172, 0x8992, 0x81B3, 0x81D4, 0x79F5, 0x71F5,
+	0x7216, 0x6A36, 0x6A57, 0x6278, 0x5A99, 0x5A99, 0x52BA, 0x4ADB,
+	0x4AFB, 0x431C, 0x3B1D, 0x3B3D, 0x3B5C, 0x335B, 0x337A, 0x3399,
+	0x2B98, 0x2BB7, 0x2BD6, 0x23D5, 0x23F4, 0x23F3, 0x2412, 0x1C31,
+	0x1C30, 0x1C4F, 0x1C6E, 0x148D, 0x148C, 0x14AA, 0x0CCA, 0x1CC9,
+	0x2CE8, 0x3508, 0x4527, 0x5526, 0x6546, 0x6D65, 0x7D84, 0x8DA4,
+	0x95A3, 0xA5C2, 0xB5E2, 0xC601, 0xC5E1, 0xC5C1, 0xC5A1, 0xC5A1,
+	0xC581, 0xC561, 0xC541, 0xC541, 0xC521, 0xC502, 0xC501, 0xC4E2,
+	0xC4C2, 0xC4A2, 0xC482, 0xC482, 0xC462, 0xC442, 0xC422, 0xC422,
+	0xC402, 0xC3E2, 0xC3E2, 0xC3A2, 0xBB83, 0xBB63, 0xBB43, 0xBB23,
+	0xBAE3, 0xB2C3, 0xB2A4, 0xB284, 0xB264, 0xB244, 0xB204, 0xA9E4,
+	0xA9C5, 0xA9A5, 0xA985, 0xA965, 0xA9A7, 0xA9E9, 0xAA2B, 0xAA6C,
+	0xB28E, 0xB2F0, 0xB312, 0xB354, 0xBB96, 0xBBD8, 0xBC1A, 0xBC5B,
+	0xC49D, 0xC4BD, 0xC4DD, 0xC4FD, 0xC51D, 0xCD3D, 0xCD5D, 0xC55D,
+	0xBD5D, 0xB55C, 0xA55C, 0x9D5C, 0x955B, 0x8D5B, 0x855B, 0x7D5A,
+	0x755A, 0x655A, 0x5D5A, 0x5559, 0x4D59, 0x4559, 0x3D58, 0x3558,
+	0x2D58, 0x2578, 0x1577, 0x0D77, 0x1576, 0x1D75, 0x1D74, 0x2594,
+	0x2593, 0x2D92, 0x3591, 0x35B0, 0x3DAF, 0x45AE, 0x45AD, 0x4DAD,
+	0x4DCC, 0x55CB, 0x5DCA, 0x5DC9, 0x65E8, 0x65E7, 0x6DE7, 0x7606,
+	0x7605, 0x7E04, 0x7E03, 0x8602, 0x8E21, 0x8E21, 0x9641, 0x9641,
+	0x9E61, 0xA661, 0xA681, 0xAE81, 0xAE81, 0xB6A1, 0xB6A1, 0xBEC1,
+	0xC6C1, 0xC6C1, 0xCEE1, 0xCEE1, 0xD701, 0xD701, 0xDF21, 0xDF21,
+	0xE721, 0xE741, 0xEF41, 0xEF21, 0xEF02, 0xEEC2, 0xEEA2, 0xEE82,
+	0xEE42, 0xEE23, 0xEE03, 0xEDE3, 0xEDA3, 0xED84, 0xED64, 0xED24,
+	0xED04, 0xECE5, 0xECA5, 0xEC85, 0xEC65, 0xEC46, 0xEC06, 0xEBE6,
+	0xEBA6, 0xEB86, 0xEB46, 0xEB06, 0xEAE6, 0xE2A6, 0xE286, 0xE246,
+	0xE206, 0xE1E6, 0xE1A6, 0xE186, 0xE1C7, 0xE208, 0xE249, 0xE28A,
+	0xE2CB, 0xE30C, 0xE34D, 0xE38E, 0xE3CF, 0xE411, 0xE451, 0xE492,
+	0xE4D3, 0xED14, 0xED55, 0xED76, 0xED96, 0xEDD7, 0xEDF8, 0xEE18,
+	0xEE39, 0xEE79, 0xEE9A, 0xEEBB, 0xEEDB, 0xEEFC, 0xEF1C, 0xEF5D,
+};
+
+static const uint32_t tcam_double_rainbow_rgba32[256] = {
+	0xFF120F12, 0xFF19111A, 0xFF221220, 0xFF2B1327, 0xFF341530, 0xFF3C1737,
+	0xFF45193E, 0xFF4D1A46, 0xFF561C4B, 0xFF5F1E54, 0xFF671F5B, 0xFF702262,
+	0xFF78236A, 0xFF81246F, 0xFF8A2778, 0xFF922880, 0xFF9B2A88, 0xFF962C8C,
+	0xFF912F92, 0xFF8B3397, 0xFF86369D, 0xFF8239A1, 0xFF7C3CA8, 0xFF773FAC,
+	0xFF7342B3, 0xFF6D46B7, 0xFF6849BD, 0xFF634CC2, 0xFF5D50C8, 0xFF5953CD,
+	0xFF5456D3, 0xFF4E5AD8, 0xFF495CDE, 0xFF4560E3, 0xFF3F63E9, 0xFF3B67EE,
+	0xFF3968E6, 0xFF366BDD, 0xFF326DD5, 0xFF3271CE, 0xFF2E73C4, 0xFF2D75BD,
+	0xFF2A78B4, 0xFF277BAB, 0xFF267DA4, 0xFF237F9A, 0xFF208293, 0xFF1E858A,
+	0xFF1C8781, 0xFF198A7A, 0xFF188C71, 0xFF159068, 0xFF149261, 0xFF109457,
+	0xFF0E9851, 0xFF1B994B, 0xFF299D46, 0xFF36A040, 0xFF45A43C, 0xFF54A636,
+	0xFF62AA31, 0xFF6EAD2C, 0xFF7BB026, 0xFF8AB422, 0xFF97B61C, 0xFFA6BA17,
+	0xFFB3BD12, 0xFFC2C10D, 0xFFC2BD0D, 0xFFC2BA0D, 0xFFC1B70E, 0xFFC2B40F,
+	0xFFC2B10F, 0xFFC2AE0E, 0xFFC1AB0E, 0xFFC2A90F, 0xFFC1A50F, 0xFFC2A110,
+	0xFFC2A00F, 0xFFC29C11, 0xFFC29A12, 0xFFC39611, 0xFFC29311, 0xFFC39112,
+	0xFFC38E12, 0xFFC38A13, 0xFFC28713, 0xFFC38514, 0xFFC38114, 0xFFC37E13,
+	0xFFC37C16, 0xFFC17615, 0xFFBF7218, 0xFFBD6D18, 0xFFBC681B, 0xFFBA641B,
+	0xFFB95F1D, 0xFFB75B1E, 0xFFB55620, 0xFFB45221, 0xFFB24D23, 0xFFB14924,
+	0xFFB04326, 0xFFAD3F27, 0xFFAC3B29, 0xFFAC3629, 0xFFA9322C, 0xFFA92D2D,
+	0xFFAA353C, 0xFFAB3D4A, 0xFFAE445A, 0xFFAE4C67, 0xFFB15377, 0xFFB35C85,
+	0xFFB56395, 0xFFB66BA2, 0xFFB972B2, 0xFFBA7BC0, 0xFFBB83D0, 0xFFBE8BDE,
+	0xFFC192EE, 0xFFC295EC, 0xFFC399EE, 0xFFC59EED, 0xFFC7A0ED, 0xFFC8A5ED,
+	0xFFCBA8EC, 0xFFC1A9EB, 0xFFB9A8E8, 0xFFB0A8E5, 0xFFA6A8E4, 0xFF9DA8E1,
+	0xFF95A8DE, 0xFF8CAADC, 0xFF83A9DA, 0xFF79AAD7, 0xFF71AAD4, 0xFF67AAD3,
+	0xFF5EAAD0, 0xFF56ABCE, 0xFF4CABCB, 0xFF44ABCA, 0xFF3BABC7, 0xFF33AAC4,
+	0xFF29ABC3, 0xFF21ACC1, 0xFF17ACBE, 0xFF0EACBB, 0xFF12ADB5, 0xFF18AEAE,
+	0xFF1EAFA6, 0xFF21B0A0, 0xFF27B198, 0xFF2DB291, 0xFF31B38B, 0xFF36B483,
+	0xFF3CB57E, 0xFF40B676, 0xFF45B76E, 0xFF4AB768, 0xFF4FB961, 0xFF54BA5B,
+	0xFF58BB53, 0xFF5DBB4C, 0xFF63BD47, 0xFF67BE3F, 0xFF6BBF39, 0xFF71C032,
+	0xFF76C12A, 0xFF7AC224, 0xFF7FC31C, 0xFF85C314, 0xFF8BC40F, 0xFF8FC70E,
+	0xFF94C80F, 0xFF97CA0D, 0xFF9BCC0D, 0xFFA1CE0F, 0xFFA4D00D, 0xFFA9D10D,
+	0xFFADD30E, 0xFFB2D50D, 0xFFB6D60D, 0xFFBBD80E, 0xFFC0D90D, 0xFFC4DB0D,
+	0xFFC9DD0D, 0xFFCDDF0D, 0xFFD2E00D, 0xFFD5E20B, 0xFFD9E40D, 0xFFDEE50D,
+	0xFFE2E70B, 0xFFE7E90D, 0xFFECEA0D, 0xFFECE50D, 0xFFECE010, 0xFFEDDB11,
+	0xFFECD614, 0xFFECD116, 0xFFECCB16, 0xFFECC619, 0xFFEDC11C, 0xFFECBC1E,
+	0xFFECB71F, 0xFFECB121, 0xFFECAC22, 0xFFECA724, 0xFFECA227, 0xFFEE9C2A,
+	0xFFED972A, 0xFFED922D, 0xFFED8C2F, 0xFFEE8830, 0xFFEE8333, 0xFFED7D35,
+	0xFFEB7634, 0xFFEB7134, 0xFFEA6934, 0xFFE96334, 0xFFE85D34, 0xFFE75635,
+	0xFFE55034, 0xFFE64934, 0xFFE44335, 0xFFE33D35, 0xFFE23634, 0xFFE13034,
+	0xFFE3383D, 0xFFE34045, 0xFFE3494D, 0xFFE35056, 0xFFE3585D, 0xFFE56065,
+	0xFFE4696D, 0xFFE67176, 0xFFE6797E, 0xFFE78288, 0xFFE78A8E, 0xFFE69296,
+	0xFFE79A9E, 0xFFE9A2A6, 0xFFE9AAAF, 0xFFE8AFB2, 0xFFE8B3B7, 0xFFE9B8BD,
+	0xFFE9BDC2, 0xFFE9C3C6, 0xFFE9C7CA, 0xFFEBCCCE, 0xFFEBD0D5, 0xFFEAD5D8,
+	0xFFEBDADE, 0xFFEBDEE3, 0xFFEAE3E6, 0xFFEBE8EB,
+};
+
+//
+// fusion
+//
+static const uint16_t tcam_fusion_rgb565[256] = {
+	0x0004, 0x0004, 0x0004, 0x0004, 0x0005, 0x0005, 0x0825, 0x0825,
+	0x0825, 0x0826, 0x0826, 0x0826, 0x1027, 0x1027, 0x1027, 0x1027,
+	0x1828, 0x1828, 0x1848, 0x1849, 0x2049, 0x2049, 0x204A, 0x204A,
+	0x284A, 0x284B, 0x284B, 0x284B, 0x306C, 0x306C, 0x306C, 0x386D,
+	0x386D, 0x386D, 0x408E, 0x408E, 0x408E, 0x408F, 0x488F, 0x488F,
+	0x4890, 0x5090, 0x50B0, 0x50B0, 0x58B1, 0x58B1, 0x58B1, 0x58B1,
+	0x60D2, 0x60D2, 0x60D2, 0x68D2, 0x68D2, 0x68D2, 0x68F3, 0x70F3,
+	0x70F3, 0x70F3, 0x78F3, 0x7913, 0x7913, 0x7913, 0x8113, 0x8133,
+	0x8133, 0x8133, 0x8933, 0x8932, 0x8952, 0x9152, 0x9152, 0x9152,
+	0x9151, 0x9971, 0x9971, 0x9971, 0x9970, 0xA190, 0xA190, 0xA18F,
+	0xA98F, 0xA9AF, 0xA9AE, 0xA9AE, 0xB1AD, 0xB1CD, 0xB1CD, 0xB9CC,
+	0xB9EC, 0xB9EB, 0xB9EB, 0xC1EB, 0xC20A, 0xC20A, 0xCA09, 0xCA29,
+	0xCA29, 0xCA28, 0xCA28, 0xD247, 0xD247, 0xD247, 0xDA66, 0xDA66,
+	0xDA65, 0xDA85, 0xDA85, 0xE284, 0xE2A4, 0xE2A4, 0xE2A3, 0xEAC3,
+	0xEAC3, 0xEAE2, 0xEAE2, 0xEAE2, 0xF2E2, 0xF301, 0xF301, 0xF321,
+	0xF321, 0xF321, 0xF340, 0xFB40, 0xFB40, 0xFB60, 0xFB60, 0xFB80,
+	0xFB80, 0xFB80, 0xFBA0, 0xFBA0, 0xFBC0, 0xFBC0, 0xFBE0, 0xFBE0,
+	0xFBE0, 0xFC00, 0xFC00, 0xFC20, 0xFC20, 0xFC40, 0xFC40, 0xFC60,
+	0xFC60, 0xFC80, 0xFC80, 0xFC80, 0xFCA0, 0xFCA0, 0xFCC0, 0xFCE0,
+	0xFCE0, 0xFD00, 0xFD00, 0xFD20, 0xFD20, 0xFD40, 0xFD40, 0xFD40,
+	0xFD60, 0xFD60, 0xFD80, 0xFDA0, 0xFDA0, 0xFDC0, 0xFDC0, 0xFDC1,
+	0xFDE1, 0xFDE1, 0xFE01, 0xFE01, 0xFE21, 0xFE21, 0xFE41, 0xFE42,
+	0xFE62, 0xFE62, 0xFE62, 0xFE82, 0xFE82, 0xFE83, 0xFEA3, 0xFEA3,
+	0xFEC3, 0xFEC3, 0xFEC3, 0xFEE3, 0xFEE4, 0xFEE4, 0xFF04, 0xFF04,
+	0xFF04, 0xFF25, 0xFF25, 0xFF25, 0xFF45, 0xFF46, 0xFF46, 0xFF46,
+	0xFF67, 0xFF67, 0xFF67, 0xFF68, 0xFF68, 0xFF89, 0xFF89, 0xFF89,
+	0xFF8A, 0xFF8A, 0xFFAB, 0xFFAB, 0xFFAC, 0xFFAC, 0xFFAD, 0xFFAD,
+	0xFFAE, 0xFFCE, 0xFFCE, 0xFFCF, 0xFFD0, 0xFFD0, 0xFFD1, 0xFFD1,
+	0xFFD2, 0xFFD2, 0xFFD3, 0xFFD3, 0xFFD4, 0xFFD4, 0xFFD5, 0xFFF5,
+	0xFFF6, 0xFFF6, 0xFFF7, 0xFFF7, 0xFFF8, 0xFFF8, 0xFFF9, 0xFFF9,
+	0xFFF9, 0xFFFA, 0xFFFA, 0xFFFB, 0xFFFB, 0xFFFC, 0xFFFC, 0xFFFC,
+	0xFFFD, 0xFFFD, 0xFFFD, 0xFFFE, 0xFFFE, 0xFFFE, 0xFFFF, 0xFFFF,
+};
+
+static const uint32_t tcam_fusion_rgba32[256] = {
+	0xFF000224, 0xFF010225, 0xFF030326, 0xFF030327, 0xFF050329, 0xFF06032A,
+	0xFF08042C, 0xFF08042E, 0xFF0A042F, 0xFF0C0531, 0xFF0E0533, 0xFF0F0535,
+	0xFF110638, 0xFF12063A, 0xFF14073D, 0xFF16063E, 0xFF180742, 0xFF1A0744,
+	0xFF1C0846, 0xFF1E0849, 0xFF20094B, 0xFF23094E, 0xFF240951, 0xFF270A54,
+	0xFF290A56, 0xFF2B0B59, 0xFF2E0B5B, 0xFF2F0B5F, 0xFF320D61, 0xFF340D65,
+	0xFF370D67, 0xFF390D6A, 0xFF3B0E6D, 0xFF3D0E6F, 0xFF401072, 0xFF421074,
+	0xFF441077, 0xFF471079, 0xFF4A127B, 0xFF4C127F, 0xFF4F1281, 0xFF511383,
+	0xFF531486, 0xFF561587, 0xFF581589, 0xFF5A168B, 0xFF5D168D, 0xFF5F178F,
+	0xFF611891, 0xFF641893, 0xFF661993, 0xFF681A95, 0xFF6B1A97, 0xFF6D1B97,
+	0xFF6F1C98, 0xFF721D99, 0xFF741D9A, 0xFF751E9B, 0xFF781F9B, 0xFF7A209B,
+	0xFF7C219B, 0xFF7E229B, 0xFF80229B, 0xFF82249B, 0xFF85249A, 0xFF862599,
+	0xFF892698, 0xFF8B2797, 0xFF8D2896, 0xFF902994, 0xFF912A93, 0xFF932A91,
+	0xFF962B8E, 0xFF982C8D, 0xFF9A2D8B, 0xFF9C2E88, 0xFF9E2F86, 0xFFA13083,
+	0xFFA33181, 0xFFA6337E, 0xFFA8337C, 0xFFAA3479, 0xFFAC3576, 0xFFAF3673,
+	0xFFB1376F, 0xFFB3386C, 0xFFB63A69, 0xFFB83B66, 0xFFBA3C63, 0xFFBC3D5F,
+	0xFFBF3E5C, 0xFFC03F59, 0xFFC34056, 0xFFC54252, 0xFFC8434F, 0xFFCA444B,
+	0xFFCB4548, 0xFFCE4645, 0xFFCF4742, 0xFFD2483E, 0xFFD34A3B, 0xFFD64B38,
+	0xFFD84C34, 0xFFDA4D31, 0xFFDB4F2F, 0xFFDE502C, 0xFFDF5229, 0xFFE15225,
+	0xFFE35522, 0xFFE55620, 0xFFE7571D, 0xFFE8591B, 0xFFEA5A19, 0xFFEC5C16,
+	0xFFEC5D14, 0xFFEF5E12, 0xFFF05F10, 0xFFF1620E, 0xFFF3630C, 0xFFF4640A,
+	0xFFF56609, 0xFFF66708, 0xFFF76906, 0xFFF86B06, 0xFFF96B06, 0xFFFA6E06,
+	0xFFFB6F06, 0xFFFB7006, 0xFFFC7206, 0xFFFD7306, 0xFFFD7506, 0xFFFD7706,
+	0xFFFD7806, 0xFFFD7A06, 0xFFFD7C06, 0xFFFD7D06, 0xFFFD7F06, 0xFFFD8106,
+	0xFFFD8206, 0xFFFD8506, 0xFFFD8606, 0xFFFD8806, 0xFFFD8A06, 0xFFFD8C06,
+	0xFFFD8D06, 0xFFFD9006, 0xFFFD9206, 0xFFFD9306, 0xFFFD9506, 0xFFFD9706,
+	0xFFFD9A06, 0xFFFD9C06, 0xFFFD9E06, 0xFFFDA006, 0xFFFDA206, 0xFFFDA406,
+	0xFFFDA606, 0xFFFDA806, 0xFFFDAA06, 0xFFFDAB06, 0xFFFDAE06, 0xFFFDAF06,
+	0xFFFDB206, 0xFFFDB406, 0xFFFDB506, 0xFFFDB807, 0xFFFDBA07, 0xFFFDBB08,
+	0xFFFDBD0A, 0xFFFDBF0A, 0xFFFDC10B, 0xFFFDC30C, 0xFFFDC40D, 0xFFFDC70E,
+	0xFFFDC80F, 0xFFFDCA10, 0xFFFDCC12, 0xFFFDCD13, 0xFFFDCF14, 0xFFFDD116,
+	0xFFFDD216, 0xFFFDD318, 0xFFFDD619, 0xFFFDD71A, 0xFFFDD81C, 0xFFFDDA1D,
+	0xFFFDDB1F, 0xFFFDDD1F, 0xFFFDDF21, 0xFFFDDF23, 0xFFFDE124, 0xFFFDE126,
+	0xFFFDE327, 0xFFFDE52A, 0xFFFDE62B, 0xFFFDE62C, 0xFFFDE82F, 0xFFFDE931,
+	0xFFFDE934, 0xFFFDEB36, 0xFFFDEC39, 0xFFFEEC3C, 0xFFFDED3E, 0xFFFDEF41,
+	0xFFFDEF44, 0xFFFEF048, 0xFFFDF14B, 0xFFFEF24E, 0xFFFEF252, 0xFFFDF356,
+	0xFFFDF459, 0xFFFDF45D, 0xFFFDF560, 0xFFFEF564, 0xFFFDF668, 0xFFFEF76C,
+	0xFFFEF770, 0xFFFEF873, 0xFFFEF877, 0xFFFEF87C, 0xFFFEF880, 0xFFFEF984,
+	0xFFFEF988, 0xFFFDFA8D, 0xFFFDFA90, 0xFFFEFA95, 0xFFFEFA99, 0xFFFEFB9D,
+	0xFFFEFBA1, 0xFFFEFBA5, 0xFFFEFBA9, 0xFFFDFCAD, 0xFFFEFCB1, 0xFFFEFCB5,
+	0xFFFEFCB9, 0xFFFEFCBD, 0xFFFEFCC0, 0xFFFEFCC4, 0xFFFEFDC8, 0xFFFEFCCC,
+	0xFFFEFDCF, 0xFFFEFDD3, 0xFFFEFDD7, 0xFFFEFDDA, 0xFFFEFDDD, 0xFFFEFDE0,
+	0xFFFEFEE3, 0xFFFEFEE6, 0xFFFEFEE9, 0xFFFEFEEC, 0xFFFEFEEE, 0xFFFEFEF0,
+	0xFFFEFFF3, 0xFFFEFFF5, 0xFFFEFEF8, 0xFFFFFFFF,
+};
+
+//
+// glowbow
+//
+static const uint16_t tcam_glowbow_rgb565[256] = {
+	0x1082, 0x1082, 0x1082, 0x1882, 0x1882, 0x1882, 0x2082, 0x2082,
+	0x2082, 0x2882, 0x2882, 0x30A2, 0x3082, 0x30A2, 0x38A2, 0x38A2,
+	0x40A3, 0x40A3, 0x48A3, 0x48A3, 0x48A3, 0x50A3, 0x50A3, 0x50A3,
+	0x58C3, 0x60A3, 0x60C4, 0x68C4, 0x68C4, 0x68C4, 0x70C4, 0x78C4,
+	0x78C4, 0x78E4, 0x80C4, 0x80E4, 0x80C4, 0x88E4, 0x88E4, 0x88E5,
+	0x90E5, 0x90E5, 0x98E5, 0x98E5, 0x98E5, 0xA0E5, 0xA105, 0xA905,
+	0xA905, 0xB105, 0xB105, 0xB105, 0xB905, 0xB906, 0xB905, 0xC106,
+	0xC106, 0xC105, 0xC126, 0xC125, 0xC125, 0xC145, 0xC945, 0xC945,
+	0xC965, 0xC965, 0xC965, 0xC965, 0xC965, 0xC985, 0xC984, 0xC9A4,
+	0xC9A4, 0xD1A4, 0xD1A4, 0xD1A4, 0xD1C4, 0xD1C4, 0xD1E4, 0xD1E4,
+	0xD1E4, 0xD1E3, 0xD204, 0xD203, 0xDA03, 0xDA03, 0xDA03, 0xDA23,
+	0xDA23, 0xDA23, 0xDA43, 0xDA43, 0xDA43, 0xDA43, 0xE263, 0xE262,
+	0xE262, 0xE262, 0xE282, 0xE282, 0xE282, 0xE282, 0xE282, 0xE2A2,
+	0xE2A2, 0xEAA2, 0xEAC2, 0xEAC2, 0xEAC1, 0xEAC1, 0xEAE1, 0xEAE1,
+	0xEB01, 0xEB01, 0xEB01, 0xEB21, 0xEB21, 0xEB41, 0xEB41, 0xEB61,
+	0xEB81, 0xEB81, 0xEB81, 0xEBA1, 0xEBA1, 0xEBC1, 0xEBC1, 0xEBE1,
+	0xEBE1, 0xEC01, 0xEC01, 0xEC21, 0xEC21, 0xEC21, 0xEC41, 0xEC61,
+	0xEC81, 0xEC81, 0xEC81, 0xECA1, 0xECA1, 0xECC1, 0xECC1, 0xECE1,
+	0xECE1, 0xED01, 0xED01, 0xED01, 0xED21, 0xED21, 0xED41, 0xED61,
+	0xED61, 0xED81, 0xED81, 0xEDA1, 0xEDA1, 0xEDC1, 0xEDC1, 0xEDC1,
+	0xEDE1, 0xEDE1, 0xEDE1, 0xEE01, 0xEE21, 0xEE21, 0xEE41, 0xEE41,
+	0xEE61, 0xEE62, 0xEE62, 0xEE63, 0xEE63, 0xEE64, 0xEE64, 0xEE65,
+	0xEE85, 0xEE86, 0xEE86, 0xEE87, 0xEE88, 0xEEA8, 0xEEA8, 0xEEA9,
+	0xEEA9, 0xEEAA, 0xEEAA, 0xEEAB, 0xEEAB, 0xEECC, 0xEECC, 0xEECD,
+	0xEECD, 0xEECD, 0xEECE, 0xEECF, 0xEEEF, 0xEEF0, 0xEEF0, 0xEEF1,
+	0xEEF1, 0xEEF2, 0xEEF2, 0xEEF3, 0xEF13, 0xEF14, 0xEF14, 0xEF15,
+	0xEF15, 0xEF15, 0xEF16, 0xEF37, 0xEF37, 0xEF38, 0xEF38, 0xEF39,
+	0xEF39, 0xEF3A, 0xEF5A, 0xEF3B, 0xEF5B, 0xEF5C, 0xEF5C, 0xEF5D,
+	0x1082, 0x1082, 0x1082, 0x1082, 0x10A2, 0x10A2, 0x10A2, 0x10A2,
+	0x18C3, 0x18C3, 0x18C3, 0x18C3, 0x18E3, 0x18E3, 0x18E3, 0x18E3,
+	0x2104, 0x2104, 0x2104, 0x2104, 0x2124, 0x2124, 0x2124, 0x2124,
+	0x2945, 0x2945, 0x2945, 0x2945, 0x2965, 0x2965, 0x2965, 0x2965,
+};
+
+static const uint32_t tcam_glowbow_rgba32[256] = {
+	0xFF101010, 0xFF131112, 0xFF161010, 0xFF191112, 0xFF1C1113, 0xFF1F1114,
+	0xFF221113, 0xFF241214, 0xFF271213, 0xFF2B1315, 0xFF2D1215, 0xFF301415,
+	0xFF341316, 0xFF361417, 0xFF3A1417, 0xFF3F1517, 0xFF441519, 0xFF46151A,
+	0xFF49161B, 0xFF4B161A, 0xFF4F161B, 0xFF51161C, 0xFF54171B, 0xFF57161C,
+	0xFF5B181E, 0xFF60171E, 0xFF661821, 0xFF681920, 0xFF6C1921, 0xFF6E1922,
+	0xFF751922, 0xFF781B22, 0xFF7A1B23, 0xFF7F1C23, 0xFF811B23, 0xFF841D25,
+	0xFF871B25, 0xFF8A1D26, 0xFF8D1D27, 0xFF8F1D28, 0xFF931D29, 0xFF961F29,
+	0xFF981E29, 0xFF9B1D2A, 0xFF9E1E29, 0xFFA51F2C, 0xFFA7202B, 0xFFAA202C,
+	0xFFAF212D, 0xFFB1212E, 0xFFB2202E, 0xFFB6202D, 0xFFBA212F, 0xFFBC2230,
+	0xFFBE222F, 0xFFC22230, 0xFFC32331, 0xFFC3232F, 0xFFC52630, 0xFFC4272E,
+	0xFFC6272D, 0xFFC7292C, 0xFFC82A2B, 0xFFC92B2B, 0xFFC82C29, 0xFFC92D2A,
+	0xFFCB2E29, 0xFFCC2F2A, 0xFFCC2F28, 0xFFCD3128, 0xFFCD3126, 0xFFCE3426,
+	0xFFCF3424, 0xFFD03525, 0xFFD13624, 0xFFD23724, 0xFFD23A23, 0xFFD33B22,
+	0xFFD43C21, 0xFFD53C21, 0xFFD63D21, 0xFFD53E1F, 0xFFD74021, 0xFFD7401F,
+	0xFFD8421E, 0xFFDA421E, 0xFFDA421E, 0xFFDA441D, 0xFFDB461C, 0xFFDC451C,
+	0xFFDD481A, 0xFFDF491A, 0xFFDE4A18, 0xFFDF4B19, 0xFFE04C18, 0xFFE14E17,
+	0xFFE14E16, 0xFFE24F17, 0xFFE35016, 0xFFE35114, 0xFFE45215, 0xFFE55314,
+	0xFFE65312, 0xFFE75613, 0xFFE75611, 0xFFE85710, 0xFFE95811, 0xFFEA5A10,
+	0xFFEB5B0E, 0xFFEB5B0E, 0xFFEC5D0D, 0xFFED5E0C, 0xFFEC600D, 0xFFED610D,
+	0xFFED630E, 0xFFED650D, 0xFFEC670C, 0xFFEC690D, 0xFFED6A0C, 0xFFEC6C0B,
+	0xFFEC700C, 0xFFED710D, 0xFFEC730C, 0xFFEC750D, 0xFFEB770C, 0xFFEC7A0C,
+	0xFFED7B0D, 0xFFED7D0D, 0xFFEC7F0C, 0xFFEC810D, 0xFFED820C, 0xFFEC840D,
+	0xFFEC860C, 0xFFED870C, 0xFFED890D, 0xFFED8E0C, 0xFFEC900D, 0xFFEC920C,
+	0xFFED930D, 0xFFED950C, 0xFFEC970D, 0xFFED980D, 0xFFED9A0C, 0xFFEC9C0D,
+	0xFFEC9E0C, 0xFFECA00B, 0xFFEBA10C, 0xFFECA30C, 0xFFECA50D, 0xFFEBA70C,
+	0xFFECAA0C, 0xFFECAC0B, 0xFFEBAD0C, 0xFFECB00C, 0xFFEBB30C, 0xFFECB40D,
+	0xFFECB60C, 0xFFECB80B, 0xFFEDB90C, 0xFFECBB0B, 0xFFECBC0C, 0xFFEBBE0C,
+	0xFFECBF0D, 0xFFEBC20C, 0xFFECC40B, 0xFFEBC70B, 0xFFECC90B, 0xFFEBCA0C,
+	0xFFEBCC0E, 0xFFECCC13, 0xFFECCD17, 0xFFECCC1B, 0xFFEBCE1E, 0xFFECCE22,
+	0xFFECCF25, 0xFFECCF29, 0xFFEBD02D, 0xFFECD030, 0xFFECD134, 0xFFECD138,
+	0xFFEBD341, 0xFFECD444, 0xFFEBD447, 0xFFECD44A, 0xFFEAD44E, 0xFFEBD552,
+	0xFFEBD657, 0xFFECD65B, 0xFFECD75E, 0xFFEBD961, 0xFFEBD864, 0xFFEBD969,
+	0xFFEBD86C, 0xFFEADA6F, 0xFFEBDA74, 0xFFEBDB7A, 0xFFEBDC7F, 0xFFECDC83,
+	0xFFEBDD86, 0xFFEBDD8A, 0xFFEBDE8E, 0xFFEBDD92, 0xFFEADE94, 0xFFEBDF99,
+	0xFFEBE09D, 0xFFEBE1A0, 0xFFECE1A5, 0xFFEAE1A8, 0xFFEBE2AB, 0xFFEBE1AF,
+	0xFFECE3B6, 0xFFEBE4BB, 0xFFEAE4BE, 0xFFEAE5C3, 0xFFEBE6C5, 0xFFECE6CA,
+	0xFFEAE6CD, 0xFFEBE7D0, 0xFFEBE8D5, 0xFFEBE7D8, 0xFFEAE8DB, 0xFFEAEAE0,
+	0xFFEBEAE4, 0xFFEBEBEB, 0xFF101010, 0xFF111111, 0xFF121212, 0xFF131313,
+	0xFF141414, 0xFF151515, 0xFF161616, 0xFF171717, 0xFF181818, 0xFF191919,
+	0xFF1A1A1A, 0xFF1B1B1B, 0xFF1C1C1C, 0xFF1D1D1D, 0xFF1E1E1E, 0xFF1F1F1F,
+	0xFF202020, 0xFF212121, 0xFF222222, 0xFF232323, 0xFF242424, 0xFF252525,
+	0xFF262626, 0xFF272727, 0xFF282828, 0xFF292929, 0xFF2A2A2A, 0xFF2B2B2B,
+	0xFF2C2C2C, 0xFF2C2C2C, 0xFF2D2D2D, 0xFF2E2E2E,
+};
+
+//
+// gray
+//
+static const uint16_t tcam_gray_rgb565[256] = {
+	0x0000, 0x0000, 0x0000, 0x0000, 0x0020, 0x0020, 0x0020, 0x0020,
+	0x0841, 0x0841, 0x0841, 0x0841, 0x0861, 0x0861, 0x0861, 0x0861,
+	0x1082, 0x1082, 0x1082, 0x1082, 0x10A2, 0x10A2, 0x10A2, 0x10A2,
+	0x18C3, 0x18C3, 0x18C3, 0x18C3, 0x18E3, 0x18E3, 0x18E3, 0x18E3,
+	0x2104, 0x2104, 0x2104, 0x2104, 0x2124, 0x2124, 0x2124, 0x2124,
+	0x2945, 0x2945, 0x2945, 0x2945, 0x2965, 0x2965, 0x2965, 0x2965,
+	0x3186, 0x3186, 0x3186, 0x3186, 0x31A6, 0x31A6, 0x31A6, 0x31A6,
+	0x39C7, 0x39C7, 0x39C7, 0x39C7, 0x39E7, 0x39E7, 0x39E7, 0x39E7,
+	0x4208, 0x4208, 0x4208, 0x4208, 0x4228, 0x4228, 0x4228, 0x4228,
+	0x4A49, 0x4A49, 0x4A49, 0x4A49, 0x4A69, 0x4A69, 0x4A69, 0x4A69,
+	0x528A, 0x528A, 0x528A, 0x528A, 0x52AA, 0x52AA, 0x52AA, 0x52AA,
+	0x5ACB, 0x5ACB, 0x5ACB, 0x5ACB, 0x5AEB, 0x5AEB, 0x5AEB, 0x5AEB,
+	0x630C, 0x630C, 0x630C, 0x630C, 0x632C, 0x632C, 0x632C, 0x632C,
+	0x6B4D, 0x6B4D, 0x6B4D, 0x6B4D, 0x6B6D, 0x6B6D, 0x6B6D, 0x6B6D,
+	0x738E, 0x738E, 0x738E, 0x738E, 0x73AE, 0x73AE, 0x73AE, 0x73AE,
+	0x7BCF, 0x7BCF, 0x7BCF, 0x7BCF, 0x7BEF, 0x7BEF, 0x7BEF, 0x7BEF,
+	0x8410, 0x8410, 0x8410, 0x8410, 0x8430, 0x8430, 0x8430, 0x8430,
+	0x8C51, 0x8C51, 0x8C51, 0x8C51, 0x8C71, 0x8C71, 0x8C71, 0x8C71,
+	0x9492, 0x9492, 0x9492, 0x9492, 0x94B2, 0x94B2, 0x94B2, 0x94B2,
+	0x9CD3, 0x9CD3, 0x9CD3, 0x9CD3, 0x9CF3, 0x9CF3, 0x9CF3, 0x9CF3,
+	0xA514, 0xA514, 0xA514, 0xA514, 0xA534, 0xA534, 0xA534, 0xA534,
+	0xAD55, 0xAD55, 0xAD55, 0xAD55, 0xAD75, 0xAD75, 0xAD75, 0xAD75,
+	0xB596, 0xB596, 0xB596, 0xB596, 0xB5B6, 0xB5B6, 0xB5B6, 0xB5B6,
+	0xBDD7, 0xBDD7, 0xBDD7, 0xBDD7, 0xBDF7, 0xBDF7, 0xBDF7, 0xBDF7,
+	0xC618, 0xC618, 0xC618, 0xC618, 0xC638, 0xC638, 0xC638, 0xC638,
+	0xCE59, 0xCE59, 0xCE59, 0xCE59, 0xCE79, 0xCE79, 0xCE79, 0xCE79,
+	0xD69A, 0xD69A, 0xD69A, 0xD69A, 0xD6BA, 0xD6BA, 0xD6BA, 0xD6BA,
+	0xDEDB, 0xDEDB, 0xDEDB, 0xDEDB, 0xDEFB, 0xDEFB, 0xDEFB, 0xDEFB,
+	0xE71C, 0xE71C, 0xE71C, 0xE71C, 0xE73C, 0xE73C, 0xE73C, 0xE73C,
+	0xEF5D, 0xEF5D, 0xEF5D, 0xEF5D, 0xEF7D, 0xEF7D, 0xEF7D, 0xEF7D,
+	0xF79E, 0xF79E, 0xF79E, 0xF79E, 0xF7BE, 0xF7BE, 0xF7BE, 0xF7BE,
+	0xFFDF, 0xFFDF, 0xFFDF, 0xFFDF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF,
+};
+
+static const uint32_t tcam_gray_rgba32[256] = {
+	0xFF000000, 0xFF010101, 0xFF020202, 0xFF030303, 0xFF040404, 0xFF050505,
+	0xFF060606, 0xFF070707, 0xFF080808, 0xFF090909, 0xFF0A0A0A, 0xFF0B0B0B,
+	0xFF0C0C0C, 0xFF0D0D0D, 0xFF0E0E0E, 0xFF0F0F0F, 0xFF101010, 0xFF111111,
+	0xFF121212, 0xFF131313, 0xFF141414, 0xFF151515, 0xFF161616, 0xFF171717,
+	0xFF181818, 0xFF191919, 0xFF1A1A1A, 0xFF1B1B1B, 0xFF1C1C1C, 0xFF1D1D1D,
+	0xFF1E1E1E, 0xFF1F1F1F, 0xFF202020, 0xFF212121, 0xFF222222, 0xFF232323,
+	0xFF242424, 0xFF252525, 0xFF262626, 0xFF272727, 0xFF282828, 0xFF292929,
+	0xFF2A2A2A, 0xFF2B2B2B, 0xFF2C2C2C, 0xFF2D2D2D, 0xFF2E2E2E, 0xFF2F2F2F,
+	0xFF303030, 0xFF313131, 0xFF323232, 0xFF333333, 0xFF343434, 0xFF353535,
+	0xFF363636, 0xFF373737, 0xFF383838, 0xFF393939, 0xFF3A3A3A, 0xFF3B3B3B,
+	0xFF3C3C3C, 0xFF3D3D3D, 0xFF3E3E3E, 0xFF3F3F3F, 0xFF404040, 0xFF414141,
+	0xFF424242, 0xFF434343, 0xFF444444, 0xFF454545, 0xFF464646, 0xFF474747,
+	0xFF484848, 0xFF494949, 0xFF4A4A4A, 0xFF4B4B4B, 0xFF4C4C4C, 0xFF4D4D4D,
+	0xFF4E4E4E, 0xFF4F4F4F, 0xFF505050, 0xFF515151, 0xFF525252, 0xFF535353,
+	0xFF545454, 0xFF555555, 0xFF565656, 0xFF575757, 0xFF585858, 0xFF595959,
+	0xFF5A5A5A, 0xFF5B5B5B, 0xFF5C5C5C, 0xFF5D5D5D, 0xFF5E5E5E, 0xFF5F5F5F,
+	0xFF606060, 0xFF616161, 0xFF626262, 0xFF636363, 0xFF646464, 0xFF656565,
+	0xFF666666, 0xFF676767, 0xFF686868, 0xFF696969, 0xFF6A6A6A, 0xFF6B6B6B,
+	0xFF6C6C6C, 0xFF6D6D6D, 0xFF6E6E6E, 0xFF6F6F6F, 0xFF707070, 0xFF717171,
+	0xFF727272, 0xFF737373, 0xFF747474, 0xFF757575, 0xFF767676, 0xFF777777,
+	0xFF787878, 0xFF797979, 0xFF7A7A7A, 0xFF7B7B7B, 0xFF7C7C7C, 0xFF7D7D7D,
+	0xFF7E7E7E, 0xFF7F7F7F, 0xFF808080, 0xFF818181, 0xFF828282, 0xFF838383,
+	0xFF848484, 0xFF858585, 0xFF868686, 0xFF878787, 0xFF888888, 0xFF898989,
+	0xFF8A8A8A, 0xFF8B8B8B, 0xFF8C8C8C, 0xFF8D8D8D, 0xFF8E8E8E, 0xFF8F8F8F,
+	0xFF909090, 0xFF919191, 0xFF929292, 0xFF939393, 0xFF949494, 0xFF959595,
+	0xFF969696, 0xFF979797, 0xFF989898, 0xFF999999, 0xFF9A9A9A, 0xFF9B9B9B,
+	0xFF9C9C9C, 0xFF9D9D9D, 0xFF9E9E9E, 0xFF9F9F9F, 0xFFA0A0A0, 0xFFA1A1A1,
+	0xFFA2A2A2, 0xFFA3A3A3, 0xFFA4A4A4, 0xFFA5A5A5, 0xFFA6A6A6, 0xFFA7A7A7,
+	0xFFA8A8A8, 0xFFA9A9A9, 0xFFAAAAAA, 0xFFABABAB, 0xFFACACAC, 0xFFADADAD,
+	0xFFAEAEAE, 0xFFAFAFAF, 0xFFB0B0B0, 0xFFB1B1B1, 0xFFB2B2B2, 0xFFB3B3B3,
+	0xFFB4B4B4, 0xFFB5B5B5, 0xFFB6B6B6, 0xFFB7B7B7, 0xFFB8B8B8, 0xFFB9B9B9,
+	0xFFBABABA, 0xFFBBBBBB, 0xFFBCBCBC, 0xFFBDBDBD, 0xFFBEBEBE, 0xFFBFBFBF,
+	0xFFC0C0C0, 0xFFC1C1C1, 0xFFC2C2C2, 0xFFC3C3C3, 0xFFC4C4C4, 0xFFC5C5C5,
+	0xFFC6C6C6, 0xFFC7C7C7, 0xFFC8C8C8, 0xFFC9C9C9, 0xFFCACACA, 0xFFCBCBCB,
+	0xFFCCCCCC, 0xFFCDCDCD, 0xFFCECECE, 0xFFCFCFCF, 0xFFD0D0D0, 0xFFD1D1D1,
+	0xFFD2D2D2, 0xFFD3D3D3, 0xFFD4D4D4, 0xFFD5D5D5, 0xFFD6D6D6, 0xFFD7D7D7,
+	0xFFD8D8D8, 0xFFD9D9D9, 0xFFDADADA, 0xFFDBDBDB, 0xFFDCDCDC, 0xFFDDDDDD,
+	0xFFDEDEDE, 0xFFDFDFDF, 0xFFE0E0E0, 0xFFE1E1E1, 0xFFE2E2E2, 0xFFE3E3E3,
+	0xFFE4E4E4, 0xFFE5E5E5, 0xFFE6E6E6, 0xFFE7E7E7, 0xFFE8E8E8, 0xFFE9E9E9,
+	0xFFEAEAEA, 0xFFEBEBEB, 0xFFECECEC, 0xFFEDEDED, 0xFFEEEEEE, 0xFFEFEFEF,
+	0xFFF0F0F0, 0xFFF1F1F1, 0xFFF2F2F2, 0xFFF3F3F3, 0xFFF4F4F4, 0xFFF5F5F5,
+	0xFFF6F6F6, 0xFFF7F7F7, 0xFFF8F8F8, 0xFFF9F9F9, 0xFFFAFAFA, 0xFFFBFBFB,
+	0xFFFCFCFC, 0xFFFDFDFD, 0xFFFEFEFE, 0xFFFFFFFF,
+};
+
+//
+// gray_red
+//
+static const uint16_t tcam_gray_red_rgb565[256] = {
+	0xDDD5, 0xDDD5, 0xD5D5, 0xD5D5, 0xD5D5, 0xD5B5, 0xCDB5, 0xCDB5,
+	0xCDB5, 0xCDB5, 0xC595, 0xC594, 0xC594, 0xC594, 0xBD94, 0xBD94,
+	0xBD74, 0xB574, 0xB574, 0xB574, 0xAD74, 0xAD53, 0xAD54, 0xAD53,
+	0xA553, 0xA533, 0xA553, 0x9D33, 0x9D33, 0x9D33, 0x9533, 0x9533,
+	0x8D13, 0x8D13, 0x8D12, 0x8D12, 0x84F2, 0x84F2, 0x84F2, 0x7CF2,
+	0x7CF2, 0x7CF2, 0x7CD2, 0x74D2, 0x74D2, 0x6CD2, 0x6CD2, 0x6CB1,
+	0x6CB1, 0x64B1, 0x64B1, 0x64B1, 0x64B1, 0x5C91, 0x5C91, 0x5C91,
+	0x5C91, 0x5471, 0x5470, 0x5470, 0x5470, 0x4C70, 0x4C50, 0x4C50,
+	0x4C50, 0x4C50, 0x4450, 0x4450, 0x444F, 0x4430, 0x442F, 0x442F,
+	0x442F, 0x3C2F, 0x3C0F, 0x3C0F, 0x3C0F, 0x3C0F, 0x3C0F, 0x3BEF,
+	0x3BEE, 0x3BEE, 0x3BEE, 0x3BCE, 0x3BCE, 0x3BCE, 0x3BCE, 0x3BCE,
+	0x3BCE, 0x3BCE, 0x3BAD, 0x3BAD, 0x3BAD, 0x3BAD, 0x3B8D, 0x3B8D,
+	0x3B8D, 0x3B8D, 0x3B8D, 0x3B8D, 0x3B8D, 0x3B6D, 0x436D, 0x436D,
+	0x436D, 0x434C, 0x4B4C, 0x4B4C, 0x4B4C, 0x4B2C, 0x4B2C, 0x4B2C,
+	0x4B2C, 0x532C, 0x532C, 0x530C, 0x530B, 0x5B0B, 0x5B0B, 0x5AEB,
+	0x62EB, 0x62EB, 0x62EB, 0x62EB, 0x6AEB, 0x6ACB, 0x6ACA, 0x6ACA,
+	0x72CA, 0x72CA, 0x72AA, 0x7AAA, 0x7AAA, 0x7AAA, 0x7AAA, 0x828A,
+	0x828A, 0x8289, 0x8A89, 0x8A89, 0x8A89, 0x9269, 0x9269, 0x9269,
+	0x9A69, 0x9A69, 0x9A49, 0x9A49, 0xA248, 0xA248, 0xAA28, 0xAA28,
+	0xAA28, 0xB228, 0xB228, 0xB208, 0xB208, 0xBA08, 0xBA08, 0xBA08,
+	0xB9E7, 0xC1E7, 0xC1E7, 0xC1E7, 0xC1E7, 0xC9C7, 0xC9C7, 0xC9C7,
+	0xD1C7, 0xD1C7, 0xD1C7, 0xD1A6, 0xD1A6, 0xD9A6, 0xD9A6, 0xD986,
+	0xD986, 0xD986, 0xD986, 0xE186, 0xE165, 0xE186, 0xE165, 0xE165,
+	0xE165, 0xE165, 0xE965, 0xE945, 0xE945, 0xE945, 0xE945, 0xE945,
+	0xE925, 0xE924, 0xE924, 0xE904, 0xE904, 0xE904, 0xE904, 0xE904,
+	0xE904, 0xE8E4, 0xE8E4, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3,
+	0xE8C3, 0xE8C3, 0xE8C3, 0xE8C3, 0xE0A3, 0xE0A3, 0xE0A3, 0xE8A3,
+	0xE0A2, 0xE082, 0xE082, 0xE082, 0xE082, 0xE082, 0xE082, 0xE062,
+	0x1082, 0x1082, 0x1082, 0x1882, 0x1882, 0x1882, 0x2082, 0x2082,
+	0x2082, 0x2882, 0x2882, 0x30A2, 0x3082, 0x30A2, 0x38A2, 0x38A2,
+	0x40A3, 0x40A3, 0x48A3, 0x48A3, 0x48A3, 0x50A3, 0x50A3, 0x50A3,
+	0x58C3, 0x60A3, 0x60C4, 0x68C4, 0x68C4, 0x68C4, 0x70C4, 0x78C4,
+};
+
+static const uint32_t tcam_gray_red_rgba32[256] = {
+	0xFFDABAAF, 0xFFD8BAAE, 0xFFD6BAAD, 0xFFD5B9AC, 0xFFD4B8AB, 0xFFD1B7AA,
+	0xFFCEB6AA, 0xFFCDB5A9, 0xFFCAB4A8, 0xFFCAB4A8, 0xFFC7B3A8, 0xFFC5B2A7,
+	0xFFC2B2A6, 0xFFC1B1A6, 0xFFBFB1A5, 0xFFBAB0A5, 0xFFB9AFA4, 0xFFB6ADA2,
+	0xFFB4AEA2, 0xFFB1ACA2, 0xFFAEACA1, 0xFFACAA9F, 0xFFAAAAA0, 0xFFA8A99F,
+	0xFFA5A99E, 0xFFA2A79D, 0xFFA0A89D, 0xFF9DA79B, 0xFF9CA69A, 0xFF99A59B,
+	0xFF95A49B, 0xFF92A49A, 0xFF8FA398, 0xFF8CA299, 0xFF89A197, 0xFF88A096,
+	0xFF869F95, 0xFF839F96, 0xFF809D94, 0xFF7E9E94, 0xFF7C9C93, 0xFF7A9C92,
+	0xFF789B93, 0xFF759B92, 0xFF739A91, 0xFF6E9890, 0xFF6D9890, 0xFF6A978E,
+	0xFF69968D, 0xFF65958D, 0xFF64958D, 0xFF63948C, 0xFF60948B, 0xFF5D928A,
+	0xFF5C938A, 0xFF5B9289, 0xFF5A918A, 0xFF568F88, 0xFF558E87, 0xFF538E86,
+	0xFF508E85, 0xFF4D8C85, 0xFF4C8B84, 0xFF4B8A83, 0xFF4A8982, 0xFF488981,
+	0xFF478882, 0xFF458980, 0xFF44887F, 0xFF438680, 0xFF42857F, 0xFF41867F,
+	0xFF40857E, 0xFF3F847D, 0xFF3E837C, 0xFF3D827B, 0xFF3C817A, 0xFF3B8079,
+	0xFF3B8079, 0xFF3A7F78, 0xFF3A7D77, 0xFF3A7D77, 0xFF397C76, 0xFF3A7B75,
+	0xFF3A7B75, 0xFF3A7B75, 0xFF397A74, 0xFF387973, 0xFF387973, 0xFF397873,
+	0xFF3A756F, 0xFF3A756F, 0xFF3B746F, 0xFF3B746F, 0xFF3C726E, 0xFF3C736C,
+	0xFF3D726C, 0xFF3D706B, 0xFF3D706B, 0xFF3F706B, 0xFF3F706B, 0xFF3F6E68,
+	0xFF416D68, 0xFF426D68, 0xFF436C68, 0xFF456A66, 0xFF486B65, 0xFF486964,
+	0xFF496864, 0xFF4B6764, 0xFF4E6662, 0xFF4D6561, 0xFF4F6662, 0xFF526560,
+	0xFF536460, 0xFF556360, 0xFF56635F, 0xFF59625D, 0xFF5A615D, 0xFF5C5F5C,
+	0xFF605E5B, 0xFF615E5B, 0xFF645D59, 0xFF675D5A, 0xFF685D58, 0xFF6B5B58,
+	0xFF6B5A56, 0xFF6F5957, 0xFF705957, 0xFF725855, 0xFF755753, 0xFF785754,
+	0xFF7A5654, 0xFF7D5552, 0xFF7E5452, 0xFF825251, 0xFF865250, 0xFF87524E,
+	0xFF8A514E, 0xFF8C504E, 0xFF8F504D, 0xFF914F4D, 0xFF944E4B, 0xFF964D4B,
+	0xFF994D4B, 0xFF9A4D49, 0xFF9D4B49, 0xFF9F4948, 0xFFA34947, 0xFFA44847,
+	0xFFA84645, 0xFFAB4745, 0xFFAD4645, 0xFFB04443, 0xFFB24443, 0xFFB44341,
+	0xFFB64241, 0xFFB84242, 0xFFBB4140, 0xFFBC4040, 0xFFBF3F3F, 0xFFC13F3F,
+	0xFFC23E3D, 0xFFC53D3D, 0xFFC63C3D, 0xFFCA3B39, 0xFFCC3A39, 0xFFCD3939,
+	0xFFD03A38, 0xFFD13938, 0xFFD43838, 0xFFD53737, 0xFFD63636, 0xFFD83534,
+	0xFFDA3434, 0xFFDB3334, 0xFFDD3332, 0xFFDE3232, 0xFFDF3132, 0xFFE13130,
+	0xFFE32F2F, 0xFFE43030, 0xFFE42E2F, 0xFFE52D2E, 0xFFE72D2E, 0xFFE72D2E,
+	0xFFE82C2E, 0xFFE92B2B, 0xFFEA2A2B, 0xFFEA282A, 0xFFEA282A, 0xFFEC282A,
+	0xFFEC2629, 0xFFEC2627, 0xFFEE2527, 0xFFEC2325, 0xFFED2323, 0xFFED2323,
+	0xFFEC2224, 0xFFEE2122, 0xFFED2023, 0xFFEE1F23, 0xFFED1F20, 0xFFEC1E1F,
+	0xFFEB1D1E, 0xFFEB1D1E, 0xFFEB1D1E, 0xFFEA1C1D, 0xFFEA1A1C, 0xFFE9191B,
+	0xFFE8181A, 0xFFE8181A, 0xFFE71719, 0xFFE71719, 0xFFE61618, 0xFFE81518,
+	0xFFE71417, 0xFFE61316, 0xFFE51215, 0xFFE61215, 0xFFE51114, 0xFFE51114,
+	0xFFE41013, 0xFFE30F12, 0xFF101010, 0xFF131112, 0xFF161010, 0xFF191112,
+	0xFF1C1113, 0xFF1F1114, 0xFF221113, 0xFF241214, 0xFF271213, 0xFF2B1315,
+	0xFF2D1215, 0xFF301415, 0xFF341316, 0xFF361417, 0xFF3A1417, 0xFF3F1517,
+	0xFF441519, 0xFF46151A, 0xFF49161B, 0xFF4B161A, 0xFF4F161B, 0xFF51161C,
+	0xFF54171B, 0xFF57161C, 0xFF5B181E, 0xFF60171E, 0xFF661821, 0xFF681920,
+	0xFF6C1921, 0xFF6E1922, 0xFF751922, 0xFF781B22,
+};
+
+//
+// hottest
+//
+static const uint16_t tcam_hottest_rgb565[256] = {
+	0x1082, 0x1082, 0x1082, 0x1082, 0x10A2, 0x10A2, 0x10A2, 0x10A2,
+	0x18C3, 0x18C3, 0x18C3, 0x18C3, 0x18E3, 0x18E3, 0x18E3, 0x18E3,
+	0x2104, 0x2104, 0x2104, 0x2104, 0x2124, 0x2124, 0x2124, 0x2124,
+	0x2945, 0x2945, 0x2945, 0x2945, 0x2965, 0x2965, 0x2965, 0x2965,
+	0x2965, 0x3186, 0x3186, 0x3186, 0x3186, 0x31A6, 0x31A6, 0x31A6,
+	0x31A6, 0x39C7, 0x39C7, 0x39C7, 0x39C7, 0x39E7, 0x39E7, 0x39E7,
+	0x39E7, 0x4208, 0x4208, 0x4208, 0x4208, 0x4228, 0x4228, 0x4228,
+	0x4228, 0x4A49, 0x4A49, 0x4A49, 0x4A49, 0x4A69, 0x4A69, 0x4A69,
+	0x4A69, 0x528A, 0x528A, 0x528A, 0x528A, 0x52AA, 0x52AA, 0x52AA,
+	0x52AA, 0x5ACB, 0x5ACB, 0x5ACB, 0x5ACB, 0x5AEB, 0x5AEB, 0x5AEB,
+	0x5AEB, 0x630C, 0x630C, 0x630C, 0x630C, 0x630C, 0x632C, 0x632C,
+	0x632C, 0x632C, 0x6B4D, 0x6B4D, 0x6B4D, 0x6B4D, 0x6B6D, 0x6B6D,
+	0x6B6D, 0x6B6D, 0x738E, 0x738E, 0x738E, 0x738E, 0x73AE, 0x73AE,
+	0x73AE, 0x73AE, 0x7BCF, 0x7BCF, 0x7BCF, 0x7BCF, 0x7BEF, 0x7BEF,
+	0x7BEF, 0x7BEF, 0x8410, 0x8410, 0x8410, 0x8410, 0x8430, 0x8430,
+	0x8430, 0x8430, 0x8C51, 0x8C51, 0x8C51, 0x8C51, 0x8C71, 0x8C71,
+	0x8C71, 0x8C71, 0x9492, 0x9492, 0x9492, 0x9492, 0x94B2, 0x94B2,
+	0x94B2, 0x94B2, 0x9CD3, 0x9CD3, 0x9CD3, 0x9CD3, 0x9CD3, 0x9CF3,
+	0x9CF3, 0x9CF3, 0x9CF3, 0xA514, 0xA514, 0xA514, 0xA514, 0xA534,
+	0xA534, 0xA534, 0xA534, 0xAD55, 0xAD55, 0xAD55, 0xAD55, 0xAD75,
+	0xAD75, 0xAD75, 0xAD75, 0xB596, 0xB596, 0xB596, 0xB596, 0xB5B6,
+	0xB5B6, 0xB5B6, 0xB5B6, 0xBDD7, 0xBDD7, 0xBDD7, 0xBDD7, 0xBDF7,
+	0xBDF7, 0xBDF7, 0xBDF7, 0xC618, 0xC618, 0xC618, 0xC618, 0xC638,
+	0xC638, 0xC638, 0xC638, 0xCE59, 0xCE59, 0xCE59, 0xCE59, 0xCE79,
+	0xCE79, 0xCE79, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861,
+	0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861,
+	0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861,
+	0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861, 0xB861,
+	0x1082, 0x1082, 0x10A3, 0x10C4, 0x10C5, 0x10E6, 0x1907, 0x1928,
+	0x1928, 0x1949, 0x196A, 0x196B, 0x218C, 0x21AD, 0x21CE, 0x21CF,
+	0x21F0, 0x2210, 0x2A31, 0x2A32, 0x2A53, 0x2A73, 0x2A73, 0x2273,
+	0x2293, 0x2293, 0x2293, 0x22B3, 0x1AB3, 0x1AB3, 0x1AD3, 0x1AD3,
+};
+
+static const uint32_t tcam_hottest_rgba32[256] = {
+	0xFF101010, 0xFF111111, 0xFF121212, 0xFF131313, 0xFF141414, 0xFF151515,
+	0xFF161616, 0xFF171717, 0xFF181818, 0xFF191919, 0xFF1A1A1A, 0xFF1B1B1B,
+	0xFF1C1C1C, 0xFF1D1D1D, 0xFF1E1E1E, 0xFF1F1F1F, 0xFF202020, 0xFF212121,
+	0xFF222222, 0xFF232323, 0xFF242424, 0xFF252525, 0xFF262626, 0xFF272727,
+	0xFF282828, 0xFF292929, 0xFF2A2A2A, 0xFF2B2B2B, 0xFF2C2C2C, 0xFF2C2C2C,
+	0xFF2D2D2D, 0xFF2E2E2E, 0xFF2F2F2F, 0xFF303030, 0xFF313131, 0xFF323232,
+	0xFF333333, 0xFF343434, 0xFF353535, 0xFF363636, 0xFF373737, 0xFF383838,
+	0xFF393939, 0xFF3A3A3A, 0xFF3B3B3B, 0xFF3C3C3C, 0xFF3D3D3D, 0xFF3E3E3E,
+	0xFF3F3F3F, 0xFF404040, 0xFF414141, 0xFF424242, 0xFF434343, 0xFF444444,
+	0xFF454545, 0xFF464646, 0xFF474747, 0xFF484848, 0xFF494949, 0xFF4A4A4A,
+	0xFF4B4B4B, 0xFF4C4C4C, 0xFF4D4D4D, 0xFF4E4E4E, 0xFF4F4F4F, 0xFF505050,
+	0xFF515151, 0xFF525252, 0xFF535353, 0xFF545454, 0xFF555555, 0xFF565656,
+	0xFF575757, 0xFF585858, 0xFF595959, 0xFF5A5A5A, 0xFF5B5B5B, 0xFF5C5C5C,
+	0xFF5D5D5D, 0xFF5E5E5E, 0xFF5F5F5F, 0xFF606060, 0xFF616161, 0xFF626262,
+	0xFF636363, 0xFF636363, 0xFF646464, 0xFF656565, 0xFF666666, 0xFF676767,
+	0xFF686868, 0xFF696969, 0xFF6A6A6A, 0xFF6B6B6B, 0xFF6C6C6C, 0xFF6D6D6D,
+	0xFF6E6E6E, 0xFF6F6F6F, 0xFF707070, 0xFF717171, 0xFF727272, 0xFF737373,
+	0xFF747474, 0xFF757575, 0xFF767676, 0xFF777777, 0xFF787878, 0xFF797979,
+	0xFF7A7A7A, 0xFF7B7B7B, 0xFF7C7C7C, 0xFF7D7D7D, 0xFF7E7E7E, 0xFF7F7F7F,
+	0xFF808080, 0xFF818181, 0xFF828282, 0xFF838383, 0xFF848484, 0xFF858585,
+	0xFF868686, 0xFF878787, 0xFF888888, 0xFF898989, 0xFF8A8A8A, 0xFF8B8B8B,
+	0xFF8C8C8C, 0xFF8D8D8D, 0xFF8E8E8E, 0xFF8F8F8F, 0xFF909090, 0xFF919191,
+	0xFF929292, 0xFF939393, 0xFF949494, 0xFF959595, 0xFF969696, 0xFF979797,
+	0xFF989898, 0xFF999999, 0xFF9A9A9A, 0xFF9A9A9A, 0xFF9B9B9B, 0xFF9C9C9C,
+	0xFF9D9D9D, 0xFF9E9E9E, 0xFF9F9F9F, 0xFFA0A0A0, 0xFFA1A1A1, 0xFFA2A2A2,
+	0xFFA3A3A3, 0xFFA4A4A4, 0xFFA5A5A5, 0xFFA6A6A6, 0xFFA7A7A7, 0xFFA8A8A8,
+	0xFFA9A9A9, 0xFFAAAAAA, 0xFFABABAB, 0xFFACACAC, 0xFFADADAD, 0xFFAEAEAE,
+	0xFFAFAFAF, 0xFFB0B0B0, 0xFFB1B1B1, 0xFFB2B2B2, 0xFFB3B3B3, 0xFFB4B4B4,
+	0xFFB5B5B5, 0xFFB6B6B6, 0xFFB7B7B7, 0xFFB8B8B8, 0xFFB9B9B9, 0xFFBABABA,
+	0xFFBBBBBB, 0xFFBCBCBC, 0xFFBDBDBD, 0xFFBEBEBE, 0xFFBFBFBF, 0xFFC0C0C0,
+	0xFFC1C1C1, 0xFFC2C2C2, 0xFFC3C3C3, 0xFFC4C4C4, 0xFFC5C5C5, 0xFFC6C6C6,
+	0xFFC7C7C7, 0xFFC8C8C8, 0xFFC9C9C9, 0xFFCACACA, 0xFFCBCBCB, 0xFFCCCCCC,
+	0xFFCDCDCD, 0xFFCECECE, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D,
+	0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D,
+	0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D,
+	0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D,
+	0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D, 0xFFBE0E0D,
+	0xFFBE0E0D, 0xFFBE0E0D, 0xFF101010, 0xFF111316, 0xFF13151E, 0xFF141825,
+	0xFF161B2B, 0xFF161F32, 0xFF182039, 0xFF192541, 0xFF1A2746, 0xFF1C2B4E,
+	0xFF1D2C55, 0xFF1F2F5E, 0xFF203264, 0xFF22356B, 0xFF223971, 0xFF253B7A,
+	0xFF253F80, 0xFF274287, 0xFF28458D, 0xFF2A4795, 0xFF2C4A9C, 0xFF294C9C,
+	0xFF294C9C, 0xFF274E9D, 0xFF24509B, 0xFF24529C, 0xFF22529C, 0xFF21559D,
+	0xFF1F569D, 0xFF1E569D, 0xFF1D589C, 0xFF1C5B9D,
+};
+
+//
+// ironblack
+//
+static const uint16_t tcam_ironblack_rgb565[256] = {
+	0xFFFF, 0xFFFF, 0xFFDF, 0xFFDF, 0xF7BE, 0xF7BE, 0xF79E, 0xF79E,
+	0xEF7D, 0xEF7D, 0xEF5D, 0xEF5D, 0xE73C, 0xE73C, 0xE71C, 0xE71C,
+	0xDEFB, 0xDEFB, 0xDEDB, 0xDEDB, 0xD6BA, 0xD6BA, 0xD69A, 0xD69A,
+	0xCE79, 0xCE79, 0xCE59, 0xCE59, 0xC638, 0xC638, 0xC618, 0xC618,
+	0xBDF7, 0xBDF7, 0xBDD7, 0xBDD7, 0xB5B6, 0xB5B6, 0xB596, 0xB596,
+	0xAD75, 0xAD75, 0xAD55, 0xAD55, 0xA534, 0xA534, 0xA514, 0xA514,
+	0x9CF3, 0x9CF3, 0x9CD3, 0x9CD3, 0x94B2, 0x94B2, 0x9492, 0x9492,
+	0x8C71, 0x8C71, 0x8C51, 0x8C51, 0x8430, 0x8430, 0x8410, 0x8410,
+	0x7BEF, 0x7BEF, 0x7BCF, 0x7BCF, 0x73AE, 0x73AE, 0x738E, 0x738E,
+	0x6B6D, 0x6B6D, 0x6B4D, 0x6B4D, 0x632C, 0x632C, 0x630C, 0x630C,
+	0x5AEB, 0x5AEB, 0x5ACB, 0x5ACB, 0x52AA, 0x52AA, 0x528A, 0x528A,
+	0x4A69, 0x4A69, 0x4A49, 0x4A49, 0x4228, 0x4228, 0x4208, 0x4208,
+	0x39E7, 0x39E7, 0x39C7, 0x39C7, 0x31A6, 0x31A6, 0x3186, 0x3186,
+	0x2965, 0x2965, 0x2945, 0x2945, 0x2124, 0x2124, 0x2104, 0x2104,
+	0x18E3, 0x18E3, 0x18C3, 0x18C3, 0x10A2, 0x10A2, 0x1082, 0x1082,
+	0x0861, 0x0861, 0x0841, 0x0841, 0x0020, 0x0020, 0x0000, 0x0000,
+	0x0001, 0x0002, 0x0003, 0x0003, 0x0804, 0x0805, 0x0806, 0x0807,
+	0x1008, 0x1009, 0x100A, 0x100B, 0x180C, 0x180C, 0x180D, 0x180E,
+	0x200F, 0x280F, 0x280F, 0x300F, 0x380F, 0x380F, 0x400F, 0x400F,
+	0x4810, 0x5010, 0x5010, 0x5810, 0x6010, 0x6010, 0x6810, 0x6810,
+	0x7011, 0x7811, 0x7811, 0x8011, 0x8011, 0x8811, 0x9011, 0x9031,
+	0x9831, 0x9831, 0xA031, 0xA031, 0xA831, 0xB031, 0xB031, 0xB831,
+	0xB851, 0xB870, 0xC08F, 0xC08F, 0xC0AE, 0xC8CD, 0xC8ED, 0xC8EC,
+	0xC90B, 0xD12B, 0xD14A, 0xD14A, 0xD969, 0xD988, 0xD9A8, 0xD9A7,
+	0xE1C6, 0xE1E5, 0xE205, 0xE205, 0xE224, 0xE244, 0xE264, 0xE284,
+	0xE2A3, 0xEAC3, 0xEAE3, 0xEAE2, 0xEB02, 0xEB22, 0xEB41, 0xEB61,
+	0xEB81, 0xF3A1, 0xF3A1, 0xF3C1, 0xF3E1, 0xF401, 0xF421, 0xF441,
+	0xF461, 0xF481, 0xF4A1, 0xF4C1, 0xF4E1, 0xF501, 0xF501, 0xF521,
+	0xF541, 0xFD61, 0xFD81, 0xFDA2, 0xFDC2, 0xFDE2, 0xFE02, 0xFE22,
+	0xFE22, 0xFE42, 0xFE63, 0xFE83, 0xFEA3, 0xFEC3, 0xFEE3, 0xFF03,
+	0xFF04, 0xFF26, 0xFF28, 0xFF4A, 0xFF4B, 0xFF6D, 0xFF6F, 0xFF91,
+	0xFF92, 0xFFB4, 0xFFB6, 0xFFD8, 0xFFD9, 0xFFDB, 0xFFFD, 0xFFE3,
+};
+
+static const uint32_t tcam_ironblack_rgba32[256] = {
+	0xFFFFFFFF, 0xFFFDFDFD, 0xFFFBFBFB, 0xFFF9F9F9, 0xFFF7F7F7, 0xFFF5F5F5,
+	0xFFF3F3F3, 0xFFF1F1F1, 0xFFEFEFEF, 0xFFEDEDED, 0xFFEBEBEB, 0xFFE9E9E9,
+	0xFFE7E7E7, 0xFFE5E5E5, 0xFFE3E3E3, 0xFFE1E1E1, 0xFFDFDFDF, 0xFFDDDDDD,
+	0xFFDBDBDB, 0xFFD9D9D9, 0xFFD7D7D7, 0xFFD5D5D5, 0xFFD3D3D3, 0xFFD1D1D1,
+	0xFFCFCFCF, 0xFFCDCDCD, 0xFFCBCBCB, 0xFFC9C9C9, 0xFFC7C7C7, 0xFFC5C5C5,
+	0xFFC3C3C3, 0xFFC1C1C1, 0xFFBFBFBF, 0xFFBDBDBD, 0xFFBBBBBB, 0xFFB9B9B9,
+	0xFFB7B7B7, 0xFFB5B5B5, 0xFFB3B3B3, 0xFFB1B1B1, 0xFFAFAFAF, 0xFFADADAD,
+	0xFFABABAB, 0xFFA9A9A9, 0xFFA7A7A7, 0xFFA5A5A5, 0xFFA3A3A3, 0xFFA1A1A1,
+	0xFF9F9F9F, 0xFF9D9D9D, 0xFF9B9B9B, 0xFF999999, 0xFF979797, 0xFF959595,
+	0xFF939393, 0xFF919191, 0xFF8F8F8F, 0xFF8D8D8D, 0xFF8B8B8B, 0xFF898989,
+	0xFF878787, 0xFF858585, 0xFF838383, 0xFF818181, 0xFF7E7E7E, 0xFF7C7C7C,
+	0xFF7A7A7A, 0xFF787878, 0xFF767676, 0xFF747474, 0xFF727272, 0xFF707070,
+	0xFF6E6E6E, 0xFF6C6C6C, 0xFF6A6A6A, 0xFF686868, 0xFF666666, 0xFF646464,
+	0xFF626262, 0xFF606060, 0xFF5E5E5E, 0xFF5C5C5C, 0xFF5A5A5A, 0xFF585858,
+	0xFF565656, 0xFF545454, 0xFF525252, 0xFF505050, 0xFF4E4E4E, 0xFF4C4C4C,
+	0xFF4A4A4A, 0xFF484848, 0xFF464646, 0xFF444444, 0xFF424242, 0xFF404040,
+	0xFF3E3E3E, 0xFF3C3C3C, 0xFF3A3A3A, 0xFF383838, 0xFF363636, 0xFF343434,
+	0xFF323232, 0xFF303030, 0xFF2E2E2E, 0xFF2C2C2C, 0xFF2A2A2A, 0xFF282828,
+	0xFF262626, 0xFF242424, 0xFF222222, 0xFF202020, 0xFF1E1E1E, 0xFF1C1C1C,
+	0xFF1A1A1A, 0xFF181818, 0xFF161616, 0xFF141414, 0xFF121212, 0xFF101010,
+	0xFF0E0E0E, 0xFF0C0C0C, 0xFF0A0A0A, 0xFF080808, 0xFF060606, 0xFF040404,
+	0xFF020202, 0xFF000000, 0xFF000009, 0xFF020010, 0xFF040018, 0xFF06001F,
+	0xFF080026, 0xFF0A002D, 0xFF0C0035, 0xFF0E003C, 0xFF110043, 0xFF13004A,
+	0xFF150052, 0xFF170059, 0xFF190060, 0xFF1B0067, 0xFF1D006F, 0xFF1F0076,
+	0xFF240078, 0xFF290079, 0xFF2E007A, 0xFF33007B, 0xFF38007C, 0xFF3D007D,
+	0xFF42007E, 0xFF47007F, 0xFF4C0180, 0xFF510181, 0xFF560182, 0xFF5B0183,
+	0xFF600184, 0xFF650185, 0xFF6A0186, 0xFF6F0187, 0xFF740188, 0xFF790188,
+	0xFF7D0289, 0xFF820289, 0xFF870389, 0xFF8B038A, 0xFF90038A, 0xFF95048A,
+	0xFF99048B, 0xFF9E058B, 0xFFA3058B, 0xFFA7058C, 0xFFAC068C, 0xFFB1068C,
+	0xFFB5078D, 0xFFBA078D, 0xFFBD0A89, 0xFFBF0D84, 0xFFC2107F, 0xFFC41379,
+	0xFFC61674, 0xFFC8196F, 0xFFCB1C6A, 0xFFCD1F65, 0xFFCF225F, 0xFFD1255A,
+	0xFFD42855, 0xFFD62B50, 0xFFD82E4B, 0xFFDA3145, 0xFFDD3440, 0xFFDF373B,
+	0xFFE03931, 0xFFE13C2F, 0xFFE2402C, 0xFFE3432A, 0xFFE44727, 0xFFE54A25,
+	0xFFE64E22, 0xFFE75120, 0xFFE7551D, 0xFFE8581B, 0xFFE95C18, 0xFFEA5F16,
+	0xFFEB6313, 0xFFEC6611, 0xFFED6A0E, 0xFFEE6D0C, 0xFFEF700C, 0xFFF0740C,
+	0xFFF0770C, 0xFFF17B0C, 0xFFF17F0C, 0xFFF2820C, 0xFFF2860C, 0xFFF38A0C,
+	0xFFF38D0D, 0xFFF4910D, 0xFFF4950D, 0xFFF5980D, 0xFFF59C0D, 0xFFF6A00D,
+	0xFFF6A30D, 0xFFF7A70D, 0xFFF7AB0D, 0xFFF8AF0E, 0xFFF8B20F, 0xFFF9B610,
+	0xFFF9B912, 0xFFFABD13, 0xFFFAC014, 0xFFFBC415, 0xFFFBC716, 0xFFFCCB17,
+	0xFFFCCE18, 0xFFFDD219, 0xFFFDD51B, 0xFFFED91C, 0xFFFEDC1D, 0xFFFFE01E,
+	0xFFFFE327, 0xFFFFE535, 0xFFFFE743, 0xFFFFE951, 0xFFFFEA5F, 0xFFFFEC6D,
+	0xFFFFEE7B, 0xFFFFF089, 0xFFFFF297, 0xFFFFF4A5, 0xFFFFF6B3, 0xFFFFF8C1,
+	0xFFFFF9CF, 0xFFFFFBDD, 0xFFFFFDEB, 0xFFFFFF18,
+};
+
+//
+// lava
+//
+static const uint16_t tcam_lava_rgb565[256] = {
+	0x1082, 0x1082, 0x10A3, 0x10C4, 0x10C5, 0x10E6, 0x1907, 0x1928,
+	0x1928, 0x1949, 0x196A, 0x196B, 0x218C, 0x21AD, 0x21CE, 0x21CF,
+	0x21F0, 0x2210, 0x2A31, 0x2A32, 0x2A53, 0x2A73, 0x2A73, 0x2273,
+	0x2293, 0x2293, 0x2293, 0x22B3, 0x1AB3, 0x1AB3, 0x1AD3, 0x1AD3,
+	0x1AD3, 0x1AF3, 0x12F3, 0x1313, 0x1313, 0x1313, 0x1334, 0x0B33,
+	0x0B54, 0x0B53, 0x0B53, 0x0B53, 0x0B53, 0x0B73, 0x0B73, 0x0B73,
+	0x0B93, 0x0B93, 0x0B92, 0x0B93, 0x0B92, 0x0BB3, 0x0BB2, 0x0BB2,
+	0x0BB2, 0x0BD2, 0x0BD2, 0x0BD2, 0x0BD2, 0x0BF2, 0x0BF1, 0x0BF2,
+	0x0BF1, 0x0BF1, 0x0BF1, 0x0C11, 0x0C11, 0x0C11, 0x0C11, 0x0C11,
+	0x0C11, 0x0C31, 0x0C30, 0x0C31, 0x0C30, 0x0C30, 0x0C30, 0x0C50,
+	0x0C50, 0x1430, 0x1C10, 0x1BF0, 0x23D0, 0x23B0, 0x2B90, 0x336F,
+	0x3B4F, 0x3B30, 0x430F, 0x4AEF, 0x4ACF, 0x52AF, 0x5A8F, 0x5A6F,
+	0x624F, 0x6A2F, 0x6A0F, 0x71EF, 0x79CF, 0x79CE, 0x79CE, 0x79CE,
+	0x81AE, 0x81AD, 0x81AD, 0x898D, 0x898C, 0x898C, 0x918C, 0x918C,
+	0x918B, 0x916B, 0x916B, 0x996B, 0x996A, 0x996A, 0xA14A, 0xA149,
+	0xA149, 0xA149, 0xA949, 0xA949, 0xA949, 0xA928, 0xA928, 0xA928,
+	0xB128, 0xB127, 0xB127, 0xB127, 0xB127, 0xB927, 0xB927, 0xB926,
+	0xB926, 0xB906, 0xB906, 0xC106, 0xC106, 0xC126, 0xC126, 0xC926,
+	0xC945, 0xC945, 0xC946, 0xD145, 0xD166, 0xD165, 0xD165, 0xD985,
+	0xD985, 0xD9A5, 0xE1A5, 0xE1A5, 0xE1C5, 0xE1C5, 0xE9C5, 0xE9E5,
+	0xE9E5, 0xE9E5, 0xEA05, 0xEA05, 0xEA24, 0xEA24, 0xEA24, 0xEA44,
+	0xEA44, 0xEA63, 0xEA63, 0xEA63, 0xEA83, 0xEAA2, 0xEAA2, 0xEAC2,
+	0xEAC2, 0xEAC2, 0xEAE1, 0xEAE1, 0xEB01, 0xEB01, 0xEB21, 0xEB41,
+	0xEB61, 0xEB81, 0xEBA1, 0xEBC1, 0xEBC1, 0xEBE1, 0xEC01, 0xEC21,
+	0xEC21, 0xEC41, 0xEC61, 0xEC81, 0xECA1, 0xECC1, 0xECC1, 0xECE1,
+	0xED01, 0xED01, 0xED21, 0xED21, 0xED41, 0xED61, 0xED61, 0xED81,
+	0xED81, 0xEDA1, 0xEDA1, 0xEDC1, 0xEDC1, 0xEDE1, 0xEDE1, 0xEE01,
+	0xEE21, 0xEE21, 0xEE41, 0xEE41, 0xEE62, 0xEE64, 0xEE85, 0xEE87,
+	0xEE88, 0xEEA9, 0xEEAB, 0xEECC, 0xEECD, 0xEEEF, 0xEEF0, 0xEEF2,
+	0xEF13, 0xEF14, 0xEF16, 0xEF37, 0xEF39, 0xEF5A, 0xEF5C, 0xEF5D,
+	0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138,
+	0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138,
+};
+
+static const uint32_t tcam_lava_rgba32[256] = {
+	0xFF101010, 0xFF111316, 0xFF13151E, 0xFF141825, 0xFF161B2B, 0xFF161F32,
+	0xFF182039, 0xFF192541, 0xFF1A2746, 0xFF1C2B4E, 0xFF1D2C55, 0xFF1F2F5E,
+	0xFF203264, 0xFF22356B, 0xFF223971, 0xFF253B7A, 0xFF253F80, 0xFF274287,
+	0xFF28458D, 0xFF2A4795, 0xFF2C4A9C, 0xFF294C9C, 0xFF294C9C, 0xFF274E9D,
+	0xFF24509B, 0xFF24529C, 0xFF22529C, 0xFF21559D, 0xFF1F569D, 0xFF1E569D,
+	0xFF1D589C, 0xFF1C5B9D, 0xFF1A5B9D, 0xFF1A5D9E, 0xFF175F9E, 0xFF15619F,
+	0xFF14629F, 0xFF12639E, 0xFF1165A0, 0xFF0F669F, 0xFF0F68A0, 0xFF0D699E,
+	0xFF0D699E, 0xFF0E6A9D, 0xFF0D6B9D, 0xFF0E6C9C, 0xFF0E6E9C, 0xFF0E6F9A,
+	0xFF0F709B, 0xFF0D7199, 0xFF0D7197, 0xFF0E7298, 0xFF0E7297, 0xFF0E7498,
+	0xFF0E7496, 0xFF0D7695, 0xFF0D7793, 0xFF0E7894, 0xFF0D7992, 0xFF0E7A92,
+	0xFF0E7A92, 0xFF0E7C91, 0xFF0E7D8F, 0xFF0F7E90, 0xFF0E7D8F, 0xFF0F7E8E,
+	0xFF0D7F8E, 0xFF0E808E, 0xFF0E808C, 0xFF0E828B, 0xFF0E828B, 0xFF0E828B,
+	0xFF0E8389, 0xFF0D8588, 0xFF0D8587, 0xFF0E8688, 0xFF0D8786, 0xFF0D8786,
+	0xFF0D8786, 0xFF0E8985, 0xFF0E8983, 0xFF138582, 0xFF188284, 0xFF1E7D83,
+	0xFF237982, 0xFF277681, 0xFF2E7281, 0xFF326D7F, 0xFF386A7F, 0xFF3E6580,
+	0xFF43637E, 0xFF495E7D, 0xFF4E5A7E, 0xFF54557D, 0xFF59527C, 0xFF5D4E7B,
+	0xFF63497A, 0xFF69467A, 0xFF6D4279, 0xFF733E7A, 0xFF783A79, 0xFF7B3977,
+	0xFF7C3973, 0xFF7F3872, 0xFF823670, 0xFF85366C, 0xFF86356C, 0xFF883368,
+	0xFF893366, 0xFF8C3264, 0xFF903262, 0xFF913260, 0xFF94315E, 0xFF942F5B,
+	0xFF972E5A, 0xFF9A2D58, 0xFF9B2D54, 0xFF9E2C54, 0xFFA12B51, 0xFFA22A4F,
+	0xFFA5294D, 0xFFA7294B, 0xFFA8294A, 0xFFA92848, 0xFFAB2848, 0xFFAC2746,
+	0xFFAE2743, 0xFFAF2643, 0xFFB02641, 0xFFB2263F, 0xFFB4263E, 0xFFB6263C,
+	0xFFB7253C, 0xFFB8253B, 0xFFBA2539, 0xFFBB2437, 0xFFBD2435, 0xFFBE2335,
+	0xFFBF2334, 0xFFC12232, 0xFFC22230, 0xFFC42430, 0xFFC72530, 0xFFC92730,
+	0xFFCB282F, 0xFFCD292E, 0xFFCF2B30, 0xFFD22B2F, 0xFFD42E30, 0xFFD52F2F,
+	0xFFD72F2E, 0xFFDB312E, 0xFFDC322E, 0xFFDE352E, 0xFFE0352F, 0xFFE3372F,
+	0xFFE4382E, 0xFFE5392D, 0xFFE93B2E, 0xFFEB3C2D, 0xFFED3E2D, 0xFFEE3F2C,
+	0xFFED4129, 0xFFEC4328, 0xFFED4427, 0xFFEC4624, 0xFFED4723, 0xFFED4922,
+	0xFFEE4A21, 0xFFED4D1F, 0xFFED4F1E, 0xFFED4F1B, 0xFFED5319, 0xFFEC5417,
+	0xFFED5615, 0xFFED5814, 0xFFED5810, 0xFFEC5A10, 0xFFED5C0F, 0xFFED5E0C,
+	0xFFED610D, 0xFFED630C, 0xFFEC670C, 0xFFED6A0C, 0xFFEC6E0C, 0xFFED710D,
+	0xFFED740D, 0xFFEC780D, 0xFFED7B0D, 0xFFEC7F0E, 0xFFED820E, 0xFFEC840D,
+	0xFFEC870D, 0xFFEC8B0C, 0xFFEB8F0C, 0xFFEC920C, 0xFFED950C, 0xFFEC990D,
+	0xFFEB9B0C, 0xFFEC9E0C, 0xFFEDA10C, 0xFFECA30C, 0xFFECA50D, 0xFFEBA70C,
+	0xFFECAA0C, 0xFFECAC0B, 0xFFEBAD0C, 0xFFECB00C, 0xFFEBB30C, 0xFFEBB50B,
+	0xFFECB70D, 0xFFEBB90C, 0xFFEBBB0B, 0xFFECBD0B, 0xFFECBF0D, 0xFFEBC20C,
+	0xFFECC40B, 0xFFECC70B, 0xFFECC80C, 0xFFEBCA0C, 0xFFECCD17, 0xFFEBCF22,
+	0xFFEBD02D, 0xFFECD138, 0xFFEBD343, 0xFFEAD44E, 0xFFECD65A, 0xFFEBD864,
+	0xFFEADA6F, 0xFFECDC7B, 0xFFEADC85, 0xFFEBDD92, 0xFFEBE09D, 0xFFECE1A7,
+	0xFFEBE2B3, 0xFFEBE5BF, 0xFFEBE5C9, 0xFFEBE8D5, 0xFFEBE9E0, 0xFFEBEBEB,
+	0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6,
+	0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6,
+	0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6,
+};
+
+//
+// medical
+//
+static const uint16_t tcam_medical_rgb565[256] = {
+	0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138,
+	0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138,
+	0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x2138, 0x423D, 0x423D,
+	0x423D, 0x423D, 0x423D, 0x423D, 0x423D, 0x423D, 0x423D, 0x423D,
+	0x423D, 0x423D, 0x423D, 0x423D, 0x423D, 0x423D, 0x423D, 0x423D,
+	0x423D, 0x423D, 0x423D, 0x423D, 0x423D, 0x1D78, 0x1D78, 0x1D78,
+	0x1D78, 0x1D78, 0x1D78, 0x1D78, 0x1D78, 0x1D78, 0x1D78, 0x1D78,
+	0x1D78, 0x1D78, 0x1D78, 0x1D78, 0x1D78, 0x1D78, 0x1D78, 0x1D78,
+	0x1D78, 0x1D78, 0x1D78, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1,
+	0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1,
+	0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1, 0x0CE1,
+	0x0CE1, 0x0CE1, 0x086F, 0x086F, 0x086F, 0x086F, 0x086F, 0x086F,
+	0x086F, 0x086F, 0x086F, 0x086F, 0x086F, 0x086F, 0x086F, 0x086F,
+	0x086F, 0x086F, 0x086F, 0x086F, 0x086F, 0x086F, 0x086F, 0x086F,
+	0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18,
+	0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18,
+	0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xEA18, 0xE8E3,
+	0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3,
+	0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3,
+	0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xE8E3, 0xECCB, 0xECCB, 0xECCB,
+	0xECCB, 0xECCB, 0xECCB, 0xECCB, 0xECCB, 0xECCB, 0xECCB, 0xECCB,
+	0xECCB, 0xECCB, 0xECCB, 0xECCB, 0xECCB, 0xECCB, 0xECCB, 0xECCB,
+	0xECCB, 0xECCB, 0xECCB, 0xECCB, 0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1,
+	0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1,
+	0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1, 0xE3E1,
+	0xE3E1, 0xE3E1, 0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24,
+	0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24,
+	0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24, 0xEE24,
+	0x1062, 0x10A2, 0x1102, 0x1142, 0x1182, 0x09C2, 0x0A02, 0x0A42,
+	0x0A82, 0x0AC1, 0x0B21, 0x0B61, 0x0BA1, 0x0BE2, 0x0C21, 0x0C61,
+	0x0CA1, 0x0D01, 0x0D41, 0x0D81, 0x0DC1, 0x0E01, 0x0E41, 0x0E81,
+	0x0EC1, 0x0F21, 0x0F61, 0x1702, 0x1EC3, 0x26A4, 0x2E65, 0x3626,
+};
+
+static const uint32_t tcam_medical_rgba32[256] = {
+	0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6,
+	0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6,
+	0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6,
+	0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF2424C6, 0xFF4647EE, 0xFF4647EE,
+	0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF4647EE,
+	0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF4647EE,
+	0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF4647EE,
+	0xFF4647EE, 0xFF4647EE, 0xFF4647EE, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1,
+	0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1,
+	0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1,
+	0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1, 0xFF19ACC1,
+	0xFF19ACC1, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D,
+	0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D,
+	0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D,
+	0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D, 0xFF0E9E0D,
+	0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B,
+	0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B,
+	0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B,
+	0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFF0F0F7B, 0xFFED41C5, 0xFFED41C5,
+	0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFED41C5,
+	0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFED41C5,
+	0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFED41C5,
+	0xFFED41C5, 0xFFED41C5, 0xFFED41C5, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C,
+	0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C,
+	0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C,
+	0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C, 0xFFEE1C1C,
+	0xFFEE1C1C, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D,
+	0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D,
+	0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D,
+	0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D, 0xFFEC985D,
+	0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C,
+	0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C,
+	0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C,
+	0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFE67D0C, 0xFFECC425, 0xFFECC425,
+	0xFFECC425, 0xFFECC425, 0xFFECC425, 0xFFECC425, 0xFFECC425, 0xFFECC425,
+	0xFFECC425, 0xFFECC425, 0xFFECC425, 0xFFECC425, 0xFFECC425, 0xFFECC425,
+	0xFFECC425, 0xFFECC425, 0xFFECC425, 0xFFECC425, 0xFFECC425, 0xFFECC425,
+	0xFFECC425, 0xFFECC425, 0xFF110E11, 0xFF101711, 0xFF112011, 0xFF102810,
+	0xFF103110, 0xFF0F3A10, 0xFF0F4110, 0xFF0E4A10, 0xFF0F5210, 0xFF0F5B0F,
+	0xFF0E640F, 0xFF0F6C0F, 0xFF0E750E, 0xFF0F7D10, 0xFF0E860F, 0xFF0E8F0F,
+	0xFF0F970F, 0xFF0EA00E, 0xFF0FA80E, 0xFF0EB10E, 0xFF0EBA0D, 0xFF0DC00E,
+	0xFF0DC90E, 0xFF0ED10D, 0xFF0EDB0E, 0xFF0DE40E, 0xFF0EEC0D, 0xFF16E316,
+	0xFF1CDB1D, 0xFF25D425, 0xFF2ECC2E, 0xFF34C435,
+};
+
+//
+// rainbow
+//
+static const uint16_t tcam_rainbow_rgb565[256] = {
+	0x0009, 0x0009, 0x0009, 0x0009, 0x0009, 0x0009, 0x0009, 0x0009,
+	0x000A, 0x002A, 0x002B, 0x004B, 0x006B, 0x008C, 0x00AC, 0x00CC,
+	0x00ED, 0x010D, 0x010E, 0x012E, 0x014E, 0x014F, 0x0170, 0x0190,
+	0x0190, 0x0191, 0x01B1, 0x01B1, 0x01B1, 0x01B2, 0x01D2, 0x01D2,
+	0x01F3, 0x01F3, 0x0213, 0x0214, 0x0234, 0x0234, 0x0235, 0x0255,
+	0x0256, 0x0276, 0x0277, 0x0277, 0x0297, 0x0297, 0x02B8, 0x02B8,
+	0x02D9, 0x02D9, 0x02F9, 0x02F9, 0x02FA, 0x02FA, 0x031A, 0x031A,
+	0x031A, 0x033B, 0x033B, 0x035B, 0x035B, 0x035B, 0x037B, 0x037B,
+	0x039B, 0x039B, 0x03BB, 0x03BB, 0x03DB, 0x03DB, 0x03FB, 0x03FA,
+	0x041A, 0x0419, 0x0439, 0x0439, 0x0438, 0x0458, 0x0457, 0x0476,
+	0x0C75, 0x0C94, 0x0C94, 0x0C93, 0x0C93, 0x0C92, 0x0CB1, 0x14B0,
+	0x14CF, 0x1CCE, 0x1CED, 0x24EC, 0x2D0B, 0x2D0A, 0x3529, 0x3D28,
+	0x4547, 0x4D66, 0x4D66, 0x5585, 0x5D84, 0x5DA4, 0x65A3, 0x6DC3,
+	0x6DC2, 0x75E2, 0x75E2, 0x7DE2, 0x8601, 0x8601, 0x8E21, 0x8E21,
+	0x9620, 0x9640, 0x9E40, 0xA640, 0xA660, 0xAE60, 0xAE60, 0xAE60,
+	0xB660, 0xBE80, 0xBE80, 0xC680, 0xC6A0, 0xC6A0, 0xCEA0, 0xCEA0,
+	0xD6A0, 0xD6A0, 0xDEA0, 0xDEA0, 0xDEA0, 0xE6A0, 0xE6A0, 0xE6A0,
+	0xE680, 0xEE80, 0xEE80, 0xEE80, 0xEE80, 0xEE80, 0xEE80, 0xEE81,
+	0xEE61, 0xF661, 0xF641, 0xF641, 0xF641, 0xF641, 0xF621, 0xF621,
+	0xF621, 0xFE01, 0xFDE1, 0xFDE1, 0xFDC1, 0xFDC2, 0xFDA2, 0xFD82,
+	0xFD62, 0xFD42, 0xFD42, 0xFD22, 0xFD22, 0xFD02, 0xFD02, 0xFCE2,
+	0xFCE2, 0xFCC3, 0xFCA3, 0xFC63, 0xFC43, 0xFC23, 0xFC03, 0xFBE4,
+	0xFBA4, 0xFB64, 0xFB44, 0xFB24, 0xFB04, 0xFAE5, 0xFAC5, 0xFA85,
+	0xFA65, 0xFA25, 0xF9E6, 0xF9C6, 0xF9A6, 0xF986, 0xF966, 0xF927,
+	0xF907, 0xF907, 0xF8E7, 0xF8E7, 0xF8E7, 0xF8E7, 0xF8C7, 0xF8C8,
+	0xF8C8, 0xF8C8, 0xF8C8, 0xF8C9, 0xF0C9, 0xF0C9, 0xF0C9, 0xF0CA,
+	0xF10A, 0xF10A, 0xF12A, 0xF14B, 0xF16B, 0xF18B, 0xF9AB, 0xF9CC,
+	0xFA0C, 0xFA4C, 0xFA8D, 0xFAAD, 0xFAED, 0xFAED, 0xFB0D, 0xFB2D,
+	0xFB2E, 0xFB2E, 0xFB6E, 0xFBAF, 0xFBCF, 0xFBEF, 0xFC10, 0xFC30,
+	0xFC50, 0xFC91, 0xFCB1, 0xFCF2, 0xFD12, 0xFD52, 0xFD73, 0xFD93,
+	0xFD93, 0xFDD4, 0xFDF4, 0xFE15, 0xFE35, 0xFE55, 0xFE76, 0xFE96,
+	0xFED7, 0xFED7, 0xFEF8, 0xFEF9, 0xFF19, 0xFF19, 0xFF39, 0xFF5A,
+};
+
+static const uint32_t tcam_rainbow_rgba32[256] = {
+	0xFF01034A, 0xFF00034A, 0xFF00034B, 0xFF00034B, 0xFF00034C, 0xFF00034C,
+	0xFF00034D, 0xFF00034F, 0xFF000352, 0xFF000555, 0xFF000758, 0xFF000A5B,
+	0xFF000E5E, 0xFF001362, 0xFF001664, 0xFF001967, 0xFF001C6A, 0xFF00206D,
+	0xFF002370, 0xFF002674, 0xFF002877, 0xFF002A7B, 0xFF002D80, 0xFF003185,
+	0xFF003286, 0xFF003388, 0xFF003489, 0xFF00358B, 0xFF00368E, 0xFF003790,
+	0xFF003891, 0xFF003A95, 0xFF003D9A, 0xFF003F9C, 0xFF00419F, 0xFF0042A1,
+	0xFF0044A4, 0xFF0045A7, 0xFF0047AA, 0xFF0049AE, 0xFF004BB3, 0xFF004CB5,
+	0xFF004EB8, 0xFF004FBB, 0xFF0050BC, 0xFF0051BE, 0xFF0054C2, 0xFF0057C6,
+	0xFF0058C8, 0xFF005ACB, 0xFF005CCD, 0xFF005ECF, 0xFF005ED0, 0xFF005FD1,
+	0xFF0060D2, 0xFF0061D3, 0xFF0063D6, 0xFF0066D9, 0xFF0067DA, 0xFF0068DB,
+	0xFF0069DC, 0xFF006BDD, 0xFF006DDF, 0xFF006FDF, 0xFF0071DF, 0xFF0073DE,
+	0xFF0075DD, 0xFF0076DC, 0xFF0178DB, 0xFF017AD9, 0xFF027CD8, 0xFF027ED6,
+	0xFF0381D4, 0xFF0383CF, 0xFF0484CD, 0xFF0485CA, 0xFF0486C5, 0xFF0588C0,
+	0xFF068AB9, 0xFF078DB2, 0xFF088EAC, 0xFF0A90A6, 0xFF0A90A2, 0xFF0B919E,
+	0xFF0C9299, 0xFF0D9395, 0xFF0F958C, 0xFF119784, 0xFF169978, 0xFF199A73,
+	0xFF1C9C6D, 0xFF229E65, 0xFF28A05E, 0xFF2DA256, 0xFF33A44F, 0xFF3BA745,
+	0xFF43AB3C, 0xFF48AD36, 0xFF4EAF30, 0xFF53B12B, 0xFF59B327, 0xFF5DB523,
+	0xFF62B71F, 0xFF69B91A, 0xFF6DBB17, 0xFF71BC15, 0xFF76BD13, 0xFF7BBF11,
+	0xFF80C10E, 0xFF86C30C, 0xFF8AC40A, 0xFF8EC508, 0xFF92C606, 0xFF97C805,
+	0xFF9BC904, 0xFFA0CB03, 0xFFA4CC02, 0xFFA9CD02, 0xFFADCE01, 0xFFAFCF01,
+	0xFFB2CF01, 0xFFB8D000, 0xFFBED200, 0xFFC1D300, 0xFFC4D400, 0xFFC7D400,
+	0xFFCAD501, 0xFFCFD602, 0xFFD4D703, 0xFFD7D603, 0xFFDAD603, 0xFFDCD503,
+	0xFFDED504, 0xFFE0D404, 0xFFE1D405, 0xFFE2D405, 0xFFE5D305, 0xFFE8D306,
+	0xFFE8D306, 0xFFE9D306, 0xFFEAD206, 0xFFEBD207, 0xFFECD107, 0xFFEDD008,
+	0xFFEFCE08, 0xFFF1CC09, 0xFFF2CB09, 0xFFF4CA0A, 0xFFF4C90A, 0xFFF5C80A,
+	0xFFF5C70B, 0xFFF6C60B, 0xFFF7C50C, 0xFFF8C20D, 0xFFF9BF0E, 0xFFFABD0E,
+	0xFFFBBB0F, 0xFFFBB910, 0xFFFCB711, 0xFFFCB212, 0xFFFDAE13, 0xFFFDAB13,
+	0xFFFEA814, 0xFFFEA515, 0xFFFEA415, 0xFFFFA316, 0xFFFFA116, 0xFFFF9F17,
+	0xFFFF9D17, 0xFFFF9B18, 0xFFFF9519, 0xFFFF8F1B, 0xFFFF8B1C, 0xFFFF871E,
+	0xFFFF831F, 0xFFFF7F20, 0xFFFF7622, 0xFFFF6E24, 0xFFFF6825, 0xFFFF6526,
+	0xFFFF6327, 0xFFFF5D28, 0xFFFF582A, 0xFFFE522B, 0xFFFE4D2D, 0xFFFE452F,
+	0xFFFE3E31, 0xFFFD3932, 0xFFFD3534, 0xFFFC3135, 0xFFFC2D37, 0xFFFB2739,
+	0xFFFB213B, 0xFFFB203C, 0xFFFB1F3C, 0xFFFB1E3D, 0xFFFB1D3D, 0xFFFB1C3E,
+	0xFFFA1B3F, 0xFFFA1B41, 0xFFF91A42, 0xFFF91A44, 0xFFF81946, 0xFFF81849,
+	0xFFF7184B, 0xFFF7194D, 0xFFF7194F, 0xFFF71A51, 0xFFF72053, 0xFFF72355,
+	0xFFF72656, 0xFFF72A58, 0xFFF72E5A, 0xFFF7325C, 0xFFF8375E, 0xFFF83B60,
+	0xFFF84062, 0xFFF84865, 0xFFF95168, 0xFFF9576A, 0xFFFA5D6C, 0xFFFA5F6D,
+	0xFFFA626E, 0xFFFA646F, 0xFFFB6570, 0xFFFB6671, 0xFFFB6D75, 0xFFFC7479,
+	0xFFFC797B, 0xFFFD7E7E, 0xFFFD8280, 0xFFFE8783, 0xFFFE8B85, 0xFFFE9088,
+	0xFFFE978C, 0xFFFF9E90, 0xFFFFA392, 0xFFFFA895, 0xFFFFAD98, 0xFFFFB099,
+	0xFFFFB29B, 0xFFFFB8A0, 0xFFFFBFA5, 0xFFFFC3A8, 0xFFFFC7AC, 0xFFFFCBAF,
+	0xFFFFCFB3, 0xFFFFD3B6, 0xFFFFD8B9, 0xFFFFDABE, 0xFFFFDCC4, 0xFFFFDEC8,
+	0xFFFFE1CA, 0xFFFFE3CC, 0xFFFFE6CE, 0xFFFFE9D0,
+};
+
+//
+// wheel2
+//
+static const uint16_t tcam_wheel2_rgb565[256] = {
+	0x1062, 0x10A2, 0x1102, 0x1142, 0x1182, 0x09C2, 0x0A02, 0x0A42,
+	0x0A82, 0x0AC1, 0x0B21, 0x0B61, 0x0BA1, 0x0BE2, 0x0C21, 0x0C61,
+	0x0CA1, 0x0D01, 0x0D41, 0x0D81, 0x0DC1, 0x0E01, 0x0E41, 0x0E81,
+	0x0EC1, 0x0F21, 0x0F61, 0x1702, 0x1EC3, 0x26A4, 0x2E65, 0x3626,
+	0x3DE7, 0x45A8, 0x4D69, 0x552A, 0x5CEB, 0x648C, 0x6C6D, 0x742E,
+	0x7BCF, 0x83B0, 0x8B71, 0x9332, 0x9AF3, 0xA2B4, 0xAA75, 0xB236,
+	0xB9F7, 0xC1B8, 0xC979, 0xD13A, 0xD8FB, 0xE0BC, 0xE87D, 0xE89D,
+	0xE0BD, 0xD8DD, 0xD8FD, 0xD13D, 0xD15D, 0xC97D, 0xC19D, 0xC1BD,
+	0xB9FD, 0xBA1D, 0xB23D, 0xB25D, 0xAA7D, 0xA2BD, 0xA2DD, 0x9AFD,
+	0x9B1D, 0x933D, 0x8B5D, 0x8B7D, 0x839D, 0x83DD, 0x7BFD, 0x741D,
+	0x743D, 0x6C5D, 0x6C9D, 0x64BD, 0x64DD, 0x5CFD, 0x551D, 0x555D,
+	0x4D7D, 0x459D, 0x45BD, 0x3DDD, 0x3E1D, 0x363D, 0x2E5D, 0x2E7D,
+	0x269D, 0x26BD, 0x1EFD, 0x171D, 0x173D, 0x0F5D, 0x173D, 0x1F1C,
+	0x1EFC, 0x26DB, 0x26BA, 0x2E9A, 0x2E59, 0x3639, 0x3618, 0x3DF8,
+	0x45D7, 0x45B6, 0x4D96, 0x4D75, 0x5555, 0x5514, 0x5CF4, 0x5CD3,
+	0x64B3, 0x6C92, 0x6C72, 0x7451, 0x7431, 0x7C10, 0x7BCF, 0x83AF,
+	0x8B8E, 0x8B6E, 0x934D, 0x932D, 0x9B0C, 0x9AEC, 0xA2CB, 0xA2AA,
+	0xAA6A, 0xB249, 0xB229, 0xBA08, 0xB9E8, 0xC1C7, 0xC1A7, 0xC986,
+	0xC965, 0xD125, 0xD904, 0xD8E4, 0xE0C3, 0xE0A3, 0xE882, 0xE862,
+	0xE862, 0xE063, 0xE063, 0xD864, 0xD064, 0xD065, 0xC866, 0xC866,
+	0xC067, 0xB868, 0xB868, 0xB069, 0xB069, 0xA86A, 0xA86B, 0xA06B,
+	0x986C, 0x986C, 0x906D, 0x886D, 0x886E, 0x806F, 0x806F, 0x7870,
+	0x7871, 0x7071, 0x6872, 0x6872, 0x6073, 0x6073, 0x5874, 0x5075,
+	0x5075, 0x4876, 0x4876, 0x4077, 0x4078, 0x3878, 0x3079, 0x3079,
+	0x287A, 0x207B, 0x207B, 0x187C, 0x187C, 0x107D, 0x087E, 0x109D,
+	0x10BD, 0x18DC, 0x18FB, 0x211B, 0x213A, 0x295A, 0x2979, 0x3199,
+	0x31B8, 0x39D8, 0x39F8, 0x4217, 0x4237, 0x4A56, 0x4A56, 0x5275,
+	0x5294, 0x5AB4, 0x5AD3, 0x62F3, 0x6312, 0x6B32, 0x6B52, 0x7371,
+	0x7391, 0x7BB0, 0x7BD0, 0x7BEF, 0x840F, 0x842E, 0x8C4D, 0x8C6D,
+	0x948D, 0x94AC, 0x9CCC, 0x9CEB, 0xA50B, 0xA52A, 0xAD2A, 0xAD49,
+	0xB568, 0xB588, 0xBDA7, 0xBDC7, 0xC5E7, 0xC606, 0xCE26, 0xCE45,
+	0xD665, 0xD684, 0xDEA4, 0xDEC3, 0xDEE3, 0xE702, 0xEF22, 0xEF41,
+};
+
+static const uint32_t tcam_wheel2_rgba32[256] = {
+	0xFF110E11, 0xFF101711, 0xFF112011, 0xFF102810, 0xFF103110, 0xFF0F3A10,
+	0xFF0F4110, 0xFF0E4A10, 0xFF0F5210, 0xFF0F5B0F, 0xFF0E640F, 0xFF0F6C0F,
+	0xFF0E750E, 0xFF0F7D10, 0xFF0E860F, 0xFF0E8F0F, 0xFF0F970F, 0xFF0EA00E,
+	0xFF0FA80E, 0xFF0EB10E, 0xFF0EBA0D, 0xFF0DC00E, 0xFF0DC90E, 0xFF0ED10D,
+	0xFF0EDB0E, 0xFF0DE40E, 0xFF0EEC0D, 0xFF16E316, 0xFF1CDB1D, 0xFF25D425,
+	0xFF2ECC2E, 0xFF34C435, 0xFF3DBC3D, 0xFF45B545, 0xFF4CAC4C, 0xFF55A455,
+	0xFF5E9C5F, 0xFF669366, 0xFF6D8C6E, 0xFF758475, 0xFF7E7B7E, 0xFF857486,
+	0xFF8D6C8D, 0xFF956595, 0xFF9D5D9D, 0xFFA554A5, 0xFFAE4CAF, 0xFFB744B7,
+	0xFFBD3CBE, 0xFFC634C6, 0xFFCD2DCD, 0xFFD524D6, 0xFFDE1DDE, 0xFFE415E5,
+	0xFFEE0EEF, 0xFFE911EE, 0xFFE516EE, 0xFFDF1BEF, 0xFFDA1FEE, 0xFFD525EE,
+	0xFFD129EE, 0xFFCC2DEF, 0xFFC733EF, 0xFFC337EE, 0xFFBF3CEE, 0xFFB941ED,
+	0xFFB445EE, 0xFFB14AEF, 0xFFAB4FEE, 0xFFA754EE, 0xFFA159EF, 0xFF9D5DEE,
+	0xFF9962EF, 0xFF9365ED, 0xFF8E6BED, 0xFF8A6FEE, 0xFF8573ED, 0xFF8079EE,
+	0xFF7B7DED, 0xFF7683ED, 0xFF7287EE, 0xFF6D8BED, 0xFF6891ED, 0xFF6495EE,
+	0xFF609AEF, 0xFF5B9FEE, 0xFF55A3ED, 0xFF52A9ED, 0xFF4CADEE, 0xFF47B1EE,
+	0xFF43B6ED, 0xFF3DBBEC, 0xFF39C0EC, 0xFF34C4ED, 0xFF2FC9ED, 0xFF2BCEED,
+	0xFF25D2EE, 0xFF21D7EE, 0xFF1DDCED, 0xFF17E2ED, 0xFF13E6ED, 0xFF0FEBED,
+	0xFF13E5E8, 0xFF18E2E4, 0xFF1CDDE0, 0xFF21D8DA, 0xFF24D4D6, 0xFF2AD0D2,
+	0xFF2ECBCE, 0xFF31C7C9, 0xFF36C2C5, 0xFF3BBFC0, 0xFF40B9BC, 0xFF44B5B7,
+	0xFF49B0B3, 0xFF4CACAF, 0xFF51A8AB, 0xFF56A3A7, 0xFF5B9EA2, 0xFF5F9B9D,
+	0xFF649699, 0xFF689294, 0xFF6C8D90, 0xFF72898B, 0xFF758588, 0xFF798182,
+	0xFF7E7B7E, 0xFF83767B, 0xFF887376, 0xFF8B6F72, 0xFF906A6D, 0xFF946569,
+	0xFF9A6164, 0xFF9D5D61, 0xFFA1595B, 0xFFA75556, 0xFFAC4F53, 0xFFB04B4D,
+	0xFFB34749, 0xFFB84246, 0xFFBD3D40, 0xFFC2393D, 0xFFC53538, 0xFFCA3034,
+	0xFFCF2D2F, 0xFFD4272C, 0xFFD82326, 0xFFDB1F22, 0xFFE11B1E, 0xFFE5161A,
+	0xFFEA1114, 0xFFEF0E12, 0xFFE90E16, 0xFFE60D1A, 0xFFE00E1F, 0xFFDB0E23,
+	0xFFD60E27, 0xFFD20D2D, 0xFFCE0E31, 0xFFC90E37, 0xFFC30E3B, 0xFFBE0E40,
+	0xFFBA0E44, 0xFFB50E48, 0xFFB00E4D, 0xFFAD0E54, 0xFFA80E58, 0xFFA30E5C,
+	0xFF9E0E61, 0xFF980E65, 0xFF930E6B, 0xFF8F0E6F, 0xFF8B0F75, 0xFF850E78,
+	0xFF820E7D, 0xFF7D0E83, 0xFF780E88, 0xFF730E8C, 0xFF6D0E90, 0xFF6A0E95,
+	0xFF640D9B, 0xFF600F9E, 0xFF5B0FA4, 0xFF570EA9, 0xFF520EAD, 0xFF4D0EB1,
+	0xFF480EB6, 0xFF420EBA, 0xFF400EC1, 0xFF3A0FC5, 0xFF350FCA, 0xFF300FCE,
+	0xFF2C0ED2, 0xFF270ED8, 0xFF220EDD, 0xFF1E0DE1, 0xFF180FE6, 0xFF140FEB,
+	0xFF0F0EF1, 0xFF1412ED, 0xFF1715E8, 0xFF1B1AE4, 0xFF1E1DDF, 0xFF2421DC,
+	0xFF2625D7, 0xFF2A29D3, 0xFF2D2DCF, 0xFF3231CB, 0xFF3634C7, 0xFF3A38C3,
+	0xFF3D3CC0, 0xFF4240BC, 0xFF4544B8, 0xFF4948B4, 0xFF4E4BB0, 0xFF524FAC,
+	0xFF5452A7, 0xFF5957A4, 0xFF5B5A9F, 0xFF615F9C, 0xFF646297, 0xFF686793,
+	0xFF6C6990, 0xFF706D8C, 0xFF737188, 0xFF787584, 0xFF7C7980, 0xFF7F7D7C,
+	0xFF838178, 0xFF868574, 0xFF8B896F, 0xFF8F8C6B, 0xFF949069, 0xFF979465,
+	0xFF9B9861, 0xFF9E9C5D, 0xFFA2A059, 0xFFA7A455, 0xFFA9A750, 0xFFADAB4B,
+	0xFFB0AF47, 0xFFB5B343, 0xFFB9B63F, 0xFFBDBA3D, 0xFFC0BE39, 0xFFC5C235,
+	0xFFC8C631, 0xFFCCCA2D, 0xFFD1CD28, 0xFFD5D124, 0xFFD8D520, 0xFFDCD91C,
+	0xFFDFDD18, 0xFFE4E114, 0xFFE8E510, 0xFFEBE90E,
+};
+
+
+static const tcam_palette_t tcam_palettes[TCAM_NUM_PALETTES] = {
+	{"arctic", tcam_arctic_rgb565, tcam_arctic_rgba32},
+	{"black_hot", tcam_black_hot_rgb565, tcam_black_hot_rgba32},
+	{"blue_red", tcam_blue_red_rgb565, tcam_blue_red_rgba32},
+	{"coldest", tcam_coldest_rgb565, tcam_coldest_rgba32},
+	{"contrast", tcam_contrast_rgb565, tcam_contrast_rgba32},
+	{"double_rainbow", tcam_double_rainbow_rgb565, tcam_double_rainbow_rgba32},
+	{"fusion", tcam_fusion_rgb565, tcam_fusion_rgba32},
+	{"glowbow", tcam_glowbow_rgb565, tcam_glowbow_rgba32},
+	{"gray", tcam_gray_rgb565, tcam_gray_rgba32},
+	{"gray_red", tcam_gray_red_rgb565, tcam_gray_red_rgba32},
+	{"hottest", tcam_hottest_rgb565, tcam_hottest_rgba32},
+	{"ironblack", tcam_ironblack_rgb565, tcam_ironblack_rgba32},
+	{"lava", tcam_lava_rgb565, tcam_lava_rgba32},
+	{"medical", tcam_medical_rgb565, tcam_medical_rgba32},
+	{"rainbow", tcam_rainbow_rgb565, tcam_rainbow_rgba32},
+	{"wheel2", tcam_wheel2_rgb565, tcam_wheel2_rgba32},
+};
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TCAM_PALETTES_H */
@@ -0,0 +1,460 @@
+/*
+ * VoSPI segment assembler
+ *
+ * Portable, allocation-free Lepton VoSPI segment state machine shared by the capture
+ * code of each platform.  The sensor geometry is fixed at compile time by
+ * VOSPI_ASM_LEPTON (3 for the 160x120 Lepton 3.x, the default, or 2 for the 80x60
+ * Lepton 2.x which sends each frame as a single segment) so every build only has the
+ * code and loop bounds of its sensor.  Packets are passed in as they are read and the
+ * result of each says where (if anywhere) it should be stored and when the segment
+ * read and the frame are complete.  The platform code keeps its own SPI transfers,
+ * timing and pixel storage, either calling vospi_asm_packet() for each packet (for
+ * example from a DMA complete interrupt) or supplying hooks to
+ * vospi_asm_read_segment() which runs a whole segment read.
+ *
+ *   - Data is stored in the segment 1 location until packet 20 of a segment shows
+ *     it is segment 1 of a frame.  Segments 2-4 must then follow in order or the
+ *     frame is restarted.
+ *   - A repeated line number, a line number past the end of the segment or (with
+ *     VOSPI_ASM_CHECK_CRC) a CRC error ends the segment read.  A segment only counts
+ *     when all of its lines were seen.
+ *   - Telemetry may be included as a header (start of segment 1) or a footer (end of
+ *     segment 4).
+ *
+ * Everything is static inline so this header is the whole implementation.  Put this
+ * directory in your Arduino libraries folder for the teensy code.
+ *
+ */
+#ifndef VOSPI_ASM_H
+#define VOSPI_ASM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// VoSPI geometry
+//
+#ifndef VOSPI_ASM_LEPTON
+#define VOSPI_ASM_LEPTON         3
+#endif
+
+#define VOSPI_ASM_PKT_LEN        164
+#define VOSPI_ASM_PKT_PIXELS     80
+
+// Telemetry rows (Lepton 3.x follows them with a reserved packet)
+#define VOSPI_ASM_TEL_ROWS       3
+
+#if VOSPI_ASM_LEPTON == 3
+#define VOSPI_ASM_WIDTH          160
+#define VOSPI_ASM_HEIGHT         120
+#define VOSPI_ASM_IMG_PKTS       240
+#define VOSPI_ASM_SEGMENTS       4
+
+// Packets per segment without and with telemetry
+#define VOSPI_ASM_SEG_LINES      60
+#define VOSPI_ASM_TEL_SEG_LINES  61
+
+// Telemetry packets in a frame
+#define VOSPI_ASM_TEL_LINES      4
+#elif VOSPI_ASM_LEPTON == 2
+#define VOSPI_ASM_WIDTH          80
+#define VOSPI_ASM_HEIGHT         60
+#define VOSPI_ASM_IMG_PKTS       60
+#define VOSPI_ASM_SEGMENTS       1
+#define VOSPI_ASM_SEG_LINES      60
+#define VOSPI_ASM_TEL_SEG_LINES  63
+#define VOSPI_ASM_TEL_LINES      3
+#else
+#error "VOSPI_ASM_LEPTON must be 2 or 3"
+#endif
+
+// Packet CRC: CCITT polynomial x^16 + x^12 + x^5 + 1 with a 0 seed computed over the
+// entire packet with the 4 MSBs of the ID and the 16-bit CRC field set to 0
+#define VOSPI_ASM_CRC_POLY       0x1021
+
+
+//
+// Configuration flags
+//
+#define VOSPI_ASM_TELEM          0x01    // Telemetry enabled (61 packets per segment)
+#define VOSPI_ASM_TELEM_HEADER   0x02    // Telemetry is a header (otherwise a footer)
+#define VOSPI_ASM_CHECK_CRC      0x04    // Check each packet's CRC
+
+
+//
+// vospi_asm_packet() and vospi_asm_read_segment() results (bitmask)
+//
+#define VOSPI_ASM_VALID          0x01    // Not a discard packet
+#define VOSPI_ASM_STORE_IMAGE    0x02    // Store the packet as image packet dst
+#define VOSPI_ASM_STORE_TELEM    0x04    // Store the packet as telemetry row dst
+#define VOSPI_ASM_DONE           0x08    // The segment read is over
+#define VOSPI_ASM_SEG_END        0x10    // Saw the last line of a segment
+#define VOSPI_ASM_SEGMENT        0x20    // Completed segment seg of a frame
+#define VOSPI_ASM_FRAME          0x40    // Completed a frame
+#define VOSPI_ASM_CRC_ERROR      0x80    // Packet CRC error (the frame is restarted)
+
+#define VOSPI_ASM_NO_LINE        255
+
+
+//
+// Lepton families reported by vospi_asm_part_lepton()
+//
+#define VOSPI_ASM_PART_UNKNOWN   0
+#define VOSPI_ASM_PART_LEPTON2   2       // 80x60 (Lepton 1.x, 2.x)
+#define VOSPI_ASM_PART_LEPTON3   3       // 160x120 (Lepton 3.x)
+
+
+typedef struct {
+	// Configuration (vospi_asm_init)
+	uint8_t flags;
+	uint8_t linesPerSeg;
+	uint8_t telemSeg;
+	uint8_t telemFirstLine;
+	uint8_t imgLineOffset;       // Telemetry header lines preceding the image
+
+	// Frame state
+	uint8_t curSegment;          // Segment location being acquired (1-4)
+	bool validSegmentRegion;     // Segment 1 of the frame has been seen
+
+	// Segment read state (vospi_asm_start_segment)
+	uint8_t prevLine;
+	bool beforeValidData;        // Segment number not known yet
+	uint64_t linesSeen;
+
+	// Location of the last packet (valid with VOSPI_ASM_STORE_xxx, VOSPI_ASM_SEGMENT
+	// and VOSPI_ASM_CRC_ERROR)
+	uint8_t seg;                 // Segment location (1-4)
+	uint8_t line;                // Line in the segment
+	uint16_t dst;                // Image packet (0-239) or telemetry row (0-2)
+} vospi_asm_t;
+
+
+// Platform hooks for vospi_asm_read_segment()
+typedef struct {
+	// Read numPkts (1 - maxPkts) consecutive packets and return a pointer to them
+	const uint8_t* (*transfer)(void* ctx, int numPkts);
+
+	// Return true when the time to read the segment is over
+	bool (*expired)(void* ctx);
+
+	// Store a packet at the location given in the assembler (rsp has
+	// VOSPI_ASM_STORE_IMAGE or VOSPI_ASM_STORE_TELEM set)
+	void (*store)(void* ctx, const vospi_asm_t* a, const uint8_t* pktP, int rsp);
+
+	void* ctx;
+	int maxPkts;
+} vospi_asm_hooks_t;
+
+
+// Byte at a time CRC lookup table
+static const uint16_t vospi_asm_crc_table[256] = {
+	0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+	0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+	0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+	0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+	0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+	0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+	0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+	0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+	0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+	0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+	0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+	0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+	0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+	0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+	0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+	0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+	0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+	0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+	0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+	0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+	0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+	0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+	0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+	0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+	0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+	0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+	0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+	0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+	0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+	0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+	0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+	0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+
+
+
+//
+// VoSPI assembler API
+//
+
+/**
+ * Abandon the frame being acquired and look for the start of a new frame
+ */
+static inline void vospi_asm_resync(vospi_asm_t* a)
+{
+	a->curSegment = 1;
+	
+	// A single segment frame has no segment number to wait for
+	a->validSegmentRegion = (VOSPI_ASM_SEGMENTS == 1);
+}
+
+
+/**
+ * Initialize an assembler with a set of VOSPI_ASM_xxx flags
+ */
+static inline void vospi_asm_init(vospi_asm_t* a, uint8_t flags)
+{
+	a->flags = flags;
+	if (flags & VOSPI_ASM_TELEM) {
+		a->linesPerSeg = VOSPI_ASM_TEL_SEG_LINES;
+		if (flags & VOSPI_ASM_TELEM_HEADER) {
+			a->telemSeg = 1;
+			a->telemFirstLine = 0;
+			a->imgLineOffset = VOSPI_ASM_TEL_LINES;
+		} else {
+			a->telemSeg = VOSPI_ASM_SEGMENTS;
+			a->telemFirstLine = VOSPI_ASM_TEL_SEG_LINES - VOSPI_ASM_TEL_LINES;
+			a->imgLineOffset = 0;
+		}
+	} else {
+		a->linesPerSeg = VOSPI_ASM_SEG_LINES;
+		a->telemSeg = 0;
+		a->telemFirstLine = 0;
+		a->imgLineOffset = 0;
+	}
+
+	vospi_asm_resync(a);
+	a->prevLine = VOSPI_ASM_NO_LINE;
+	a->beforeValidData = true;
+	a->linesSeen = 0;
+}
+
+
+/**
+ * Prepare for the packets following a VSYNC
+ */
+static inline void vospi_asm_start_segment(vospi_asm_t* a)
+{
+	a->prevLine = VOSPI_ASM_NO_LINE;
+	a->beforeValidData = true;
+	a->linesSeen = 0;
+}
+
+
+/**
+ * Compute the CRC of a packet (as received, big-endian)
+ */
+static inline uint16_t vospi_asm_crc(const uint8_t* pktP)
+{
+	const uint8_t* p = pktP + 4;
+	const uint8_t* endP = pktP + VOSPI_ASM_PKT_LEN;
+	uint16_t crc = 0;
+
+	// ID with the TTT bits masked, then the CRC field as 0
+	crc = (crc << 8) ^ vospi_asm_crc_table[(crc >> 8) ^ (*pktP & 0x0F)];
+	crc = (crc << 8) ^ vospi_asm_crc_table[(crc >> 8) ^ *(pktP + 1)];
+	crc = (crc << 8) ^ vospi_asm_crc_table[crc >> 8];
+	crc = (crc << 8) ^ vospi_asm_crc_table[crc >> 8];
+
+	while (p < endP) {
+		crc = (crc << 8) ^ vospi_asm_crc_table[(crc >> 8) ^ *p++];
+	}
+
+	return crc;
+}
+
+
+/**
+ * Returns true if the packet's CRC is correct
+ */
+static inline bool vospi_asm_crc_valid(const uint8_t* pktP)
+{
+	return (vospi_asm_crc(pktP) == ((*(pktP + 2) << 8) | *(pktP + 3)));
+}
+
+
+/**
+ * Process one packet (as received, big-endian) of the segment being read.  Returns a
+ * set of VOSPI_ASM_xxx results.  The packet should be stored at the location in
+ * seg/line/dst when the results include VOSPI_ASM_STORE_IMAGE or
+ * VOSPI_ASM_STORE_TELEM.  No more packets should be read for this segment once they
+ * include VOSPI_ASM_DONE.
+ */
+static inline int vospi_asm_packet(vospi_asm_t* a, const uint8_t* pktP)
+{
+	uint8_t line, segment;
+	int telemRow;
+	int rsp = VOSPI_ASM_VALID;
+
+	if ((*pktP & 0x0F) == 0x0F) {
+		// Discard packet
+		return 0;
+	}
+
+	a->seg = a->curSegment;
+	if ((a->flags & VOSPI_ASM_CHECK_CRC) && !vospi_asm_crc_valid(pktP)) {
+		// Corrupted data - this frame can't be completed so start looking for the next
+		// frame
+		vospi_asm_resync(a);
+		return rsp | VOSPI_ASM_CRC_ERROR | VOSPI_ASM_DONE;
+	}
+
+	line = *(pktP + 1);
+	if ((line == a->prevLine) || (line >= a->linesPerSeg)) {
+		// This is garbage data since line numbers should always increment
+		return rsp | VOSPI_ASM_DONE;
+	}
+	a->prevLine = line;
+	a->line = line;
+
+	if ((VOSPI_ASM_SEGMENTS > 1) && (line == 20)) {
+		// Check segment
+		segment = *pktP >> 4;
+		if (!a->validSegmentRegion) {
+			// Look for start of valid segment data
+			if (segment == 1) {
+				a->beforeValidData = false;
+				a->validSegmentRegion = true;
+			}
+		} else if (segment != a->curSegment) {
+			// Out of sequence (a segment was missed or this is a non-unique frame):
+			// hold/reset in starting position (always collecting in segment 1 buffer
+			// locations)
+			vospi_asm_resync(a);
+		}
+	}
+
+	// Store the data
+	//  - beforeValidData is used to collect data before we know if the current segment (1) is valid
+	//  - then we use validSegmentRegion for remaining data once we know we're seeing valid data
+	if (a->beforeValidData || a->validSegmentRegion) {
+		telemRow = (int) line - a->telemFirstLine;
+		if ((a->flags & VOSPI_ASM_TELEM) && (a->curSegment == a->telemSeg) &&
+		    (telemRow >= 0) && (telemRow < VOSPI_ASM_TEL_LINES)) {
+			if (telemRow < VOSPI_ASM_TEL_ROWS) {
+				a->dst = telemRow;
+				rsp |= VOSPI_ASM_STORE_TELEM;
+			}
+		} else {
+			// Image data starts after any telemetry header lines in segment 1 so they are
+			// skipped over for all segments
+			a->dst = ((a->curSegment - 1) * a->linesPerSeg) + line - a->imgLineOffset;
+			rsp |= VOSPI_ASM_STORE_IMAGE;
+		}
+	}
+	a->linesSeen |= (uint64_t) 1 << line;
+
+	if (line == (a->linesPerSeg - 1)) {
+		// Saw a complete segment, move to next segment or complete frame aquisition if possible
+		rsp |= VOSPI_ASM_SEG_END | VOSPI_ASM_DONE;
+		if (a->validSegmentRegion && (a->linesSeen == (((uint64_t) 1 << a->linesPerSeg) - 1))) {
+			rsp |= VOSPI_ASM_SEGMENT;
+			if (a->curSegment < VOSPI_ASM_SEGMENTS) {
+				// Setup to get next segment
+				a->curSegment++;
+			} else {
+				// Got frame, setup to get the next frame
+				rsp |= VOSPI_ASM_FRAME;
+				vospi_asm_resync(a);
+			}
+		}
+	}
+
+	return rsp;
+}
+
+
+/**
+ * Read a segment following a VSYNC using the platform hooks.  Packets are read one at
+ * a time until the first valid packet of the segment and then the rest of the segment
+ * is read in transfers of up to maxPkts packets.  The read ends when the segment is
+ * done or the time is up without seeing a valid packet.  Returns the VOSPI_ASM_xxx
+ * results of all the packets.
+ */
+static inline int vospi_asm_read_segment(vospi_asm_t* a, const vospi_asm_hooks_t* h)
+{
+	const uint8_t* pktP;
+	int i, numPkts, pktRsp;
+	int rsp = 0;
+	bool sawValidPacket;
+
+	vospi_asm_start_segment(a);
+
+	while (!(rsp & VOSPI_ASM_DONE)) {
+		// Determine how many packets to read in this transaction
+		if (a->prevLine == VOSPI_ASM_NO_LINE) {
+			numPkts = 1;
+		} else {
+			numPkts = a->linesPerSeg - (a->prevLine + 1);
+			if (numPkts > h->maxPkts) numPkts = h->maxPkts;
+			if (numPkts < 1) numPkts = 1;
+		}
+		pktP = h->transfer(h->ctx, numPkts);
+
+		// Process each packet in the transfer
+		sawValidPacket = false;
+		for (i=0; (i<numPkts) && !(rsp & VOSPI_ASM_DONE); i++) {
+			pktRsp = vospi_asm_packet(a, pktP);
+			if (pktRsp & (VOSPI_ASM_STORE_IMAGE | VOSPI_ASM_STORE_TELEM)) {
+				h->store(h->ctx, a, pktP, pktRsp);
+			}
+			if (pktRsp & VOSPI_ASM_VALID) {
+				sawValidPacket = true;
+			}
+			rsp |= pktRsp;
+			pktP += VOSPI_ASM_PKT_LEN;
+		}
+
+		if (!(rsp & VOSPI_ASM_DONE) && !sawValidPacket && h->expired(h->ctx)) {
+			// Did not see a valid packet within this segment interval
+			rsp |= VOSPI_ASM_DONE;
+		}
+	}
+
+	return rsp;
+}
+
+
+/**
+ * Returns the VOSPI_ASM_PART_xxx family of a Lepton from its OEM part number string
+ * ("500-0771-01") so the capture code can check it was built for the sensor fitted
+ */
+static inline int vospi_asm_part_lepton(const char* part)
+{
+	// Lepton 1.5, 1.6, 2.0 and 2.5 then Lepton 3.0, 3.5 and 3.1R
+	static const char* const lep2[] = {"500-0643", "500-0659", "500-0690", "500-0763"};
+	static const char* const lep3[] = {"500-0726", "500-0771", "500-0790"};
+	unsigned int i, j;
+
+	for (i = 0; i < sizeof(lep2) / sizeof(lep2[0]); i++) {
+		for (j = 0; (lep2[i][j] != 0) && (part[j] == lep2[i][j]); j++) ;
+		if (lep2[i][j] == 0) return VOSPI_ASM_PART_LEPTON2;
+	}
+	for (i = 0; i < sizeof(lep3) / sizeof(lep3[0]); i++) {
+		for (j = 0; (lep3[i][j] != 0) && (part[j] == lep3[i][j]); j++) ;
+		if (lep3[i][j] == 0) return VOSPI_ASM_PART_LEPTON3;
+	}
+	return VOSPI_ASM_PART_UNKNOWN;
+}
+
+
+/**
+ * Returns true when the telemetry header of the frame being acquired has been read
+ * (once segment 1 is complete)
+ */
+static inline bool vospi_asm_telem_header_ready(const vospi_asm_t* a)
+{
+	return ((a->flags & VOSPI_ASM_TELEM_HEADER) && a->validSegmentRegion && (a->curSegment > 1));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VOSPI_ASM_H */
@@ -0,0 +1,163 @@
+/*
+ * VoSPI link calibration
+ *
+ * Portable, allocation-free search for the fastest stable SPI clock of a Lepton's
+ * VoSPI link shared by the capture code of each platform.  The platform owns the clock
+ * and the measurements; this header only decides what to try next and what to keep.
+ *
+ *   - Steps are the clock rates the platform can produce in increasing order (the
+ *     Lepton is specified to 20 MHz).  They are measured from the slowest up and the
+ *     search stops at the first step that isn't stable.
+ *   - A step is measured by counting segment reads over many frames after the link
+ *     has settled at the new rate.  It is stable when no packet failed its CRC and at
+ *     most 1/VOSPI_CAL_MISS_DIV of the reads ended without reaching the end of a
+ *     segment (discarded or lost packets).
+ *   - A failing step is measured again (up to VOSPI_CAL_ATTEMPTS times) so a single
+ *     disturbance such as a missed FFC or a busy bus doesn't end the search early.
+ *   - The result keeps a margin: the step two below the first one that failed (the
+ *     slowest step if only it passed).  If every step passed the fastest is used.  If
+ *     the slowest step failed there is no result and the platform keeps its default.
+ *
+ * Everything is static inline so this header is the whole implementation.
+ *
+ */
+#ifndef VOSPI_CAL_H
+#define VOSPI_CAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Calibration constants
+//
+#define VOSPI_CAL_MAX_STEPS     8
+#define VOSPI_CAL_ATTEMPTS      2
+
+// Reads that may end without a segment end (1/VOSPI_CAL_MISS_DIV of them)
+#define VOSPI_CAL_MISS_DIV      64
+
+
+//
+// Link counters measured for a step
+//
+typedef struct {
+	uint32_t reads;         // Segment reads
+	uint32_t seg_ends;      // Reads that reached the end of a segment (valid or discard)
+	uint32_t crc_errors;    // Reads ended by a packet CRC failure
+} vospi_cal_count_t;
+
+//
+// Calibration state
+//
+typedef struct {
+	uint32_t steps[VOSPI_CAL_MAX_STEPS];  // Clock rates (Hz) in increasing order
+	int num_steps;
+	int step;               // Step being measured
+	int attempt;            // Measurements of the step so far
+	int failed;             // First step that wasn't stable (num_steps if none)
+	bool done;
+} vospi_cal_t;
+
+
+
+/**
+ * Start a calibration over num_steps (1 - VOSPI_CAL_MAX_STEPS) clock rates in
+ * increasing order
+ */
+static inline void vospi_cal_init(vospi_cal_t* c, const uint32_t* steps, int num_steps)
+{
+	int i;
+
+	if (num_steps > VOSPI_CAL_MAX_STEPS) num_steps = VOSPI_CAL_MAX_STEPS;
+	for (i=0; i<num_steps; i++) {
+		c->steps[i] = steps[i];
+	}
+	c->num_steps = num_steps;
+	c->step = 0;
+	c->attempt = 0;
+	c->failed = num_steps;
+	c->done = (num_steps <= 0);
+}
+
+
+/**
+ * Clock rate to measure next
+ */
+static inline uint32_t vospi_cal_freq(const vospi_cal_t* c)
+{
+	return c->steps[c->step];
+}
+
+
+/**
+ * True when cnt shows a stable link
+ */
+static inline bool vospi_cal_stable(const vospi_cal_count_t* cnt)
+{
+	return ((cnt->crc_errors == 0) &&
+	        ((cnt->reads - cnt->seg_ends) * VOSPI_CAL_MISS_DIV <= cnt->reads));
+}
+
+
+/**
+ * True when a measurement of target_reads can already no longer be stable so the
+ * platform can end it early
+ */
+static inline bool vospi_cal_failing(const vospi_cal_count_t* cnt, uint32_t target_reads)
+{
+	return ((cnt->crc_errors != 0) ||
+	        ((cnt->reads - cnt->seg_ends) * VOSPI_CAL_MISS_DIV > target_reads));
+}
+
+
+/**
+ * Note the result of measuring the current step.  Returns true when the calibration
+ * is done (vospi_cal_result() has the clock rate), otherwise vospi_cal_freq() has the
+ * next rate to measure.
+ */
+static inline bool vospi_cal_next(vospi_cal_t* c, bool stable)
+{
+	if (c->done) return true;
+
+	if (stable) {
+		c->attempt = 0;
+		if (++c->step == c->num_steps) {
+			c->step--;
+			c->done = true;
+		}
+	} else if (++c->attempt == VOSPI_CAL_ATTEMPTS) {
+		c->failed = c->step;
+		c->done = true;
+	}
+
+	return c->done;
+}
+
+
+/**
+ * Clock rate the calibration chose (0 if even the slowest step wasn't stable)
+ */
+static inline uint32_t vospi_cal_result(const vospi_cal_t* c)
+{
+	if (c->failed == 0) {
+		return 0;
+	} else if (c->failed == c->num_steps) {
+		return c->steps[c->num_steps - 1];
+	} else if (c->failed == 1) {
+		return c->steps[0];
+	} else {
+		return c->steps[c->failed - 2];
+	}
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VOSPI_CAL_H */
@@ -0,0 +1,154 @@
+/*
+ * VoSPI temporal noise filter
+ *
+ * Portable, allocation-free recursive (IIR) filter for the Lepton's frame to frame
+ * (NETD) noise shared by the capture code of each platform.  Pixels are filtered in
+ * place as they are unpacked using one persisted per-pixel accumulator so the filter
+ * costs no frame copies.
+ *
+ *   - Each pixel moves toward the new value by alpha (1/256 units): the level's
+ *     minimum alpha while the difference from the filtered value is within the
+ *     motion threshold, rising linearly to 256 (no filtering) at twice the
+ *     threshold so moving edges don't smear.
+ *   - Levels 1 - 4 set the minimum alpha to 1/2, 1/4, 1/8 and 1/16 (about 1.7x,
+ *     2.6x, 3.9x and 5.6x less noise for still pixels).
+ *   - The accumulator holds each filtered value with VOSPI_TF_FRAC_BITS fraction
+ *     bits so small steps aren't lost to rounding.
+ *   - Pixels aren't blended until vospi_tf_end_frame() marks the accumulator as
+ *     holding a whole frame (the first frame after vospi_tf_init() passes through).
+ *
+ * Everything is static inline so this header is the whole implementation.
+ *
+ */
+#ifndef VOSPI_TF_H
+#define VOSPI_TF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+//
+// Temporal filter constants
+//
+#define VOSPI_TF_MAX_LEVEL      4
+
+// Default motion threshold (pixel counts: 0.16 K for TLinear 0.01 K frames)
+#define VOSPI_TF_DEF_MOTION     16
+
+// Accumulator fraction bits (16-bit pixels and 8-bit alphas fit in an int32_t)
+#define VOSPI_TF_FRAC_BITS      6
+
+
+//
+// Temporal filter state
+//
+typedef struct {
+	uint32_t* acc;          // Per pixel filtered value << VOSPI_TF_FRAC_BITS (caller allocated)
+	uint16_t alpha_min;     // New value weight (1/256) for still pixels
+	uint16_t motion;        // Difference (counts) where alpha starts rising
+	uint16_t slope;         // Weight added per count of difference past motion
+	bool primed;            // Accumulator holds a whole frame
+} vospi_tf_t;
+
+
+
+/**
+ * Initialize a filter for level (1 - VOSPI_TF_MAX_LEVEL) and motion (counts).  acc
+ * must hold one uint32_t per pixel of the frames filtered.
+ */
+static inline void vospi_tf_init(vospi_tf_t* tf, uint32_t* acc, int level, int motion)
+{
+	if (level < 1) level = 1;
+	if (level > VOSPI_TF_MAX_LEVEL) level = VOSPI_TF_MAX_LEVEL;
+	if (motion < 1) motion = 1;
+
+	tf->acc = acc;
+	tf->alpha_min = 256 >> level;
+	tf->motion = motion;
+	tf->slope = (256 - tf->alpha_min + motion - 1) / motion;
+	tf->primed = false;
+}
+
+
+/**
+ * Note a whole frame has been filtered.  Subsequent frames are blended.
+ */
+static inline void vospi_tf_end_frame(vospi_tf_t* tf)
+{
+	tf->primed = true;
+}
+
+
+/**
+ * Filter one pixel at accumulator index i, returning the filtered value
+ */
+static inline uint16_t vospi_tf_pixel(vospi_tf_t* tf, int i, uint16_t v)
+{
+	uint32_t* accP = &tf->acc[i];
+	int32_t d, excess;
+	uint32_t alpha;
+
+	if (!tf->primed) {
+		*accP = (uint32_t) v << VOSPI_TF_FRAC_BITS;
+		return v;
+	}
+
+	d = ((int32_t) v << VOSPI_TF_FRAC_BITS) - (int32_t) *accP;
+	excess = (((d < 0) ? -d : d) >> VOSPI_TF_FRAC_BITS) - tf->motion;
+	alpha = tf->alpha_min;
+	if (excess > 0) alpha += (uint32_t) excess * tf->slope;
+	if (alpha >= 256) {
+		*accP = (uint32_t) v << VOSPI_TF_FRAC_BITS;
+		return v;
+	}
+
+	*accP += (d * (int32_t) alpha) / 256;
+	return (*accP + (1 << (VOSPI_TF_FRAC_BITS - 1))) >> VOSPI_TF_FRAC_BITS;
+}
+
+
+/**
+ * Filter len 16-bit pixels in place starting with accumulator index start.  min and
+ * max are loaded with the range of the filtered pixels.
+ */
+static inline void vospi_tf_filter16(vospi_tf_t* tf, uint16_t* pix, int start, int len, uint16_t* min, uint16_t* max)
+{
+	int i;
+	uint16_t v;
+	uint16_t lo = 0xFFFF;
+	uint16_t hi = 0;
+
+	for (i=0; i<len; i++) {
+		v = vospi_tf_pixel(tf, start + i, pix[i]);
+		pix[i] = v;
+		if (v < lo) lo = v;
+		if (v > hi) hi = v;
+	}
+
+	*min = lo;
+	*max = hi;
+}
+
+
+/**
+ * Filter len 8-bit pixels in place starting with accumulator index start
+ */
+static inline void vospi_tf_filter8(vospi_tf_t* tf, uint8_t* pix, int start, int len)
+{
+	int i;
+
+	for (i=0; i<len; i++) {
+		pix[i] = (uint8_t) vospi_tf_pixel(tf, start + i, pix[i]);
+	}
+}
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VOSPI_TF_H */
@@ -0,0 +1,65 @@
+/*
+ * VoSPI capture benchmark harness
+ *
+ * Runs a platform's capture code (the front-end) against the simulator for a fixed
+ * amount of virtual time and reports the frame rate, the time to synchronize and the
+ * host CPU time spent in the capture code for each frame.  Each front-end is built
+ * into its own program from the platform's unmodified sources and an adapter
+ * (fe_xxx.c) implementing the functions below.
+ *
+ */
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "lepsim.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// File descriptor the adapters hand the capture code for the simulated device
+#define BENCH_SIM_FD 1000
+
+//
+// Front-end adapter interface
+//
+extern const char* fe_name;
+extern const uint16_t fe_pixel_mask;   // Pixel bits the front-end delivers
+
+// Set the platform's SPI clock and latencies (before the command line is applied)
+void fe_default_config(lepsim_config_t* cfg);
+
+// Initialize the capture code.  Returns 0 for success, -1 for failure.
+int fe_init(const lepsim_config_t* cfg);
+
+// Run the capture code for one VSYNC (or one frame read for the PRU).  Returns 1 when
+// a frame was captured, 0 when not and -1 for a fatal error.
+int fe_step();
+
+// Copy the captured frame as native 16-bit pixels and the telemetry rows if the
+// front-end captured them.  Returns true if telem was loaded.
+int fe_get_frame(uint16_t* pix, uint16_t* telem);
+
+// Print front-end specific counters
+void fe_report(FILE* fp);
+
+
+//
+// Harness functions for the adapters
+//
+
+// Bracket simulator work done on behalf of the capture code so it isn't counted as
+// capture CPU time
+void bench_sim_begin();
+void bench_sim_end();
+
+// Returns true when the run's virtual time is over
+int bench_done();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_H */
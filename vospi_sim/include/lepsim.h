@@ -0,0 +1,107 @@
+/*
+ * Lepton VoSPI simulator
+ *
+ * Generates the packet stream a Lepton 3.5 clocks out of its VoSPI interface against
+ * a virtual clock so the capture code of each platform can be run without hardware.
+ *   - A VSYNC edge every LEPSIM_VSYNC_USEC starts a segment.  Each segment may be
+ *     preceded by discard packets and is followed by discard packets until the next
+ *     VSYNC.  Data packets not read before the next VSYNC are lost.
+ *   - One of every LEPSIM_UNIQUE_INTERVAL Lepton frames is unique and carries segment
+ *     numbers 1-4.  The others (and all frames during an FFC) carry segment number 0.
+ *   - Telemetry can be included as a header or a footer (61 packets per segment).
+ *   - Packets carry valid CRCs unless an error is injected.
+ *   - Pixels are synthetic or replayed from tCam .tjsn/.tmjsn files.
+ * Time only advances when the capture code transfers data, sleeps or waits for VSYNC
+ * so the stream (and everything measured against it) is reproducible.
+ *
+ */
+#ifndef LEPSIM_H
+#define LEPSIM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lepton image and packet geometry
+#define LEPSIM_WIDTH           160
+#define LEPSIM_HEIGHT          120
+#define LEPSIM_NUM_PIXELS      (LEPSIM_WIDTH * LEPSIM_HEIGHT)
+#define LEPSIM_PKT_BYTES       164
+#define LEPSIM_PKT_PIXELS      80
+#define LEPSIM_IMG_PKTS        (LEPSIM_NUM_PIXELS / LEPSIM_PKT_PIXELS)
+#define LEPSIM_SEGMENTS        4
+
+// Telemetry: 3 rows of words followed by a reserved packet
+#define LEPSIM_TEL_PKTS        4
+#define LEPSIM_TEL_WORDS       (3 * LEPSIM_PKT_PIXELS)
+
+// Telemetry locations
+#define LEPSIM_TELEM_NONE      0
+#define LEPSIM_TELEM_HEADER    1
+#define LEPSIM_TELEM_FOOTER    2
+
+// Timing: a VSYNC for each segment (4 per Lepton frame, about 26.5 Lepton frames/sec)
+#define LEPSIM_VSYNC_USEC      9450
+#define LEPSIM_UNIQUE_INTERVAL 3
+
+// Lepton frames output with segment number 0 while an FFC is performed
+#define LEPSIM_FFC_FRAMES      23
+
+// Number of recent unique frames captured frames are checked against
+#define LEPSIM_MATCH_FRAMES    4
+
+// Telemetry words (from row A) the simulator fills in
+#define LEPSIM_TEL_UPTIME_LOW  1
+#define LEPSIM_TEL_UPTIME_HIGH 2
+#define LEPSIM_TEL_STATUS_LOW  3
+#define LEPSIM_TEL_FC_LOW      20
+#define LEPSIM_TEL_FC_HIGH     21
+#define LEPSIM_TEL_FPA_T_K100  24
+#define LEPSIM_TEL_HSE_T_K100  26
+
+typedef struct {
+	int telem;               // LEPSIM_TELEM_xxx
+	int agc;                 // Synthetic pixels are 8-bit AGC values instead of TLinear
+	uint32_t spi_hz;         // SPI clock used to compute transfer times
+	uint32_t xfer_usec;      // Overhead for each SPI transaction (driver/DMA setup)
+	uint32_t irq_usec;       // VSYNC edge to capture code latency
+	int max_discards;        // Up to this many discard packets precede each segment
+	double crc_error_rate;   // Probability each data packet is corrupted
+	uint32_t ffc_sec;        // FFC period (0 for none)
+	uint32_t seed;           // Random seed (discard counts, errors, synthetic noise)
+	char* sample_file;       // .tjsn/.tmjsn file to replay (NULL for synthetic pixels)
+} lepsim_config_t;
+
+typedef struct {
+	uint32_t vsyncs;         // VSYNC edges (segments started)
+	uint32_t missed_vsyncs;  // Edges that occurred while the capture code was busy
+	uint32_t frames;         // Unique frames completely output
+	uint32_t ffcs;           // FFCs started
+	uint32_t crc_errors;     // Data packets corrupted
+	uint32_t lost_packets;   // Data packets of valid segments not read before the next VSYNC
+	uint64_t bytes;          // Bytes transferred
+} lepsim_stats_t;
+
+
+void lepsim_default_config(lepsim_config_t* cfg);
+int lepsim_init(const lepsim_config_t* cfg);
+int lepsim_num_samples();
+void lepsim_make_frame(uint16_t* pix, uint16_t* telem);
+int64_t lepsim_now_usec();
+void lepsim_advance_usec(int64_t usec);
+void lepsim_advance_to_usec(int64_t usec);
+int64_t lepsim_wait_vsync();
+void lepsim_begin_transfer();
+void lepsim_transfer(void* buf, int len);
+int lepsim_packet_crc_valid(const uint8_t* pktP);
+int lepsim_match_frame(const uint16_t* pix, uint16_t mask);
+int lepsim_match_telem(int frame, const uint16_t* telem);
+void lepsim_get_stats(lepsim_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LEPSIM_H */
@@ -0,0 +1,19 @@
+/*
+ * Minimal Adafruit_ILI9341 for building the teensy code on the host (nothing is drawn)
+ *
+ */
+#ifndef ADAFRUIT_ILI9341_H
+#define ADAFRUIT_ILI9341_H
+
+#include <Arduino.h>
+
+#define ILI9341_CASET 0x2A
+#define ILI9341_PASET 0x2B
+#define ILI9341_RAMWR 0x2C
+
+class Adafruit_ILI9341 {
+public:
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {}
+};
+
+#endif /* ADAFRUIT_ILI9341_H */
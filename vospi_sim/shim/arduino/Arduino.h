@@ -0,0 +1,34 @@
+/*
+ * Minimal Arduino/Teensyduino API for building the teensy code on the host
+ *
+ */
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HIGH    1
+#define LOW     0
+#define INPUT   0
+#define OUTPUT  1
+#define RISING  3
+
+#define min(a,b) ((a)<(b)?(a):(b))
+#define max(a,b) ((a)>(b)?(a):(b))
+
+typedef enum {
+  IRQ_PORTA = 43
+} IRQ_NUMBER_t;
+
+// Implemented by the bench adapter
+uint32_t micros();
+void attachInterrupt(uint8_t pin, void (*function)(void), int mode);
+void detachInterrupt(uint8_t pin);
+
+static inline void pinMode(uint8_t pin, uint8_t mode) {}
+static inline void digitalWrite(uint8_t pin, uint8_t val) {}
+static inline void digitalWriteFast(uint8_t pin, uint8_t val) {}
+
+#endif /* ARDUINO_H */
@@ -0,0 +1,33 @@
+/*
+ * Minimal SPI library for building the teensy code on the host: transfers of a
+ * buffer read from the simulator, single word transfers (display writes) are dropped
+ *
+ */
+#ifndef SPI_H
+#define SPI_H
+
+#include <Arduino.h>
+
+#define MSBFIRST  1
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+
+class SPISettings {
+public:
+  SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {}
+};
+
+class SPIClass {
+public:
+  void beginTransaction(SPISettings settings) {}
+  void endTransaction() {}
+  void usingInterrupt(uint8_t n) {}
+  void notUsingInterrupt(IRQ_NUMBER_t interruptName) {}
+  uint8_t transfer(uint8_t data) { return 0; }
+  uint16_t transfer16(uint16_t data) { return 0; }
+  void transfer(void* buf, size_t count);     // Implemented by the bench adapter
+};
+
+extern SPIClass SPI;
+
+#endif /* SPI_H */
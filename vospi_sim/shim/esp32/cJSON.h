@@ -0,0 +1,48 @@
+/*
+ * Host shim for the cJSON declarations referenced by json_utilities.c.  The benchmarks
+ * only link the functions that write json text directly so these are never called.
+ */
+#ifndef CJSON_H
+#define CJSON_H
+
+#include <stddef.h>
+
+typedef struct cJSON {
+	struct cJSON* next;
+	struct cJSON* prev;
+	struct cJSON* child;
+	int type;
+	char* valuestring;
+	int valueint;
+	double valuedouble;
+	char* string;
+} cJSON;
+
+typedef struct cJSON_Hooks {
+	void* (*malloc_fn)(size_t sz);
+	void (*free_fn)(void* ptr);
+} cJSON_Hooks;
+
+#define cJSON_ArrayForEach(element, array) \
+	for (element = (array != NULL) ? (array)->child : NULL; element != NULL; element = element->next)
+
+void cJSON_InitHooks(cJSON_Hooks* hooks);
+cJSON* cJSON_Parse(const char* value);
+char* cJSON_Print(const cJSON* item);
+int cJSON_PrintPreallocated(cJSON* item, char* buffer, const int length, const int format);
+void cJSON_Delete(cJSON* item);
+cJSON* cJSON_CreateObject(void);
+cJSON* cJSON_CreateArray(void);
+cJSON* cJSON_CreateNumber(double num);
+void cJSON_AddItemToObject(cJSON* object, const char* string, cJSON* item);
+void cJSON_AddItemToArray(cJSON* array, cJSON* item);
+cJSON* cJSON_AddNumberToObject(cJSON* const object, const char* const name, const double number);
+cJSON* cJSON_AddStringToObject(cJSON* const object, const char* const name, const char* const string);
+cJSON* cJSON_GetObjectItem(const cJSON* const object, const char* const string);
+cJSON* cJSON_GetArrayItem(const cJSON* array, int index);
+int cJSON_GetArraySize(const cJSON* array);
+int cJSON_HasObjectItem(const cJSON* object, const char* string);
+int cJSON_IsArray(const cJSON* const item);
+char* cJSON_GetStringValue(cJSON* item);
+
+#endif /* CJSON_H */
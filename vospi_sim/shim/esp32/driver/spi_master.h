@@ -0,0 +1,51 @@
+/*
+ * Host shim for the ESP-IDF SPI master driver (transactions read from the simulator)
+ */
+#ifndef SPI_MASTER_H
+#define SPI_MASTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+	SPI_HOST,
+	HSPI_HOST,
+	VSPI_HOST
+} spi_host_device_t;
+
+#define SPI_DEVICE_HALFDUPLEX (1 << 4)
+
+typedef struct {
+	uint8_t command_bits;
+	uint8_t address_bits;
+	uint8_t dummy_bits;
+	uint8_t mode;
+	uint16_t duty_cycle_pos;
+	uint16_t cs_ena_pretrans;
+	uint8_t cs_ena_posttrans;
+	int clock_speed_hz;
+	int input_delay_ns;
+	int spics_io_num;
+	uint32_t flags;
+	int queue_size;
+} spi_device_interface_config_t;
+
+typedef struct {
+	uint32_t flags;
+	uint16_t cmd;
+	uint64_t addr;
+	size_t length;
+	size_t rxlength;
+	void* user;
+	const void* tx_buffer;
+	void* rx_buffer;
+} spi_transaction_t;
+
+typedef struct spi_device_t* spi_device_handle_t;
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* dev_config, spi_device_handle_t* handle);
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle);
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t* trans_desc);
+
+#endif /* SPI_MASTER_H */
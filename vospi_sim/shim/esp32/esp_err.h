@@ -0,0 +1,18 @@
+/*
+ * Host shim for the ESP-IDF error codes used by the capture code
+ */
+#ifndef ESP_ERR_H
+#define ESP_ERR_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef int esp_err_t;
+
+#define ESP_OK   0
+#define ESP_FAIL -1
+
+#define ESP_ERROR_CHECK(x) do { esp_err_t rc_ = (x); if (rc_ != ESP_OK) { \
+                                fprintf(stderr, "ESP_ERROR_CHECK failed: %d\n", rc_); abort(); } } while (0)
+
+#endif /* ESP_ERR_H */
@@ -0,0 +1,17 @@
+/*
+ * Host shim for the ESP-IDF heap capabilities functions
+ */
+#ifndef ESP_HEAP_CAPS_H
+#define ESP_HEAP_CAPS_H
+
+#include "esp_system.h"
+
+#define MALLOC_CAP_INTERNAL 0
+#define MALLOC_CAP_8BIT     0
+#define MALLOC_CAP_SPIRAM   0
+
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+#endif /* ESP_HEAP_CAPS_H */
@@ -0,0 +1,14 @@
+/*
+ * Host shim for ESP-IDF logging
+ */
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...)
+#define ESP_LOGD(tag, fmt, ...)
+
+#endif /* ESP_LOG_H */
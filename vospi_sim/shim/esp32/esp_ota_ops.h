@@ -0,0 +1,14 @@
+/*
+ * Host shim for the ESP-IDF application description
+ */
+#ifndef ESP_OTA_OPS_H
+#define ESP_OTA_OPS_H
+
+typedef struct {
+	char version[32];
+	char project_name[32];
+} esp_app_desc_t;
+
+const esp_app_desc_t* esp_ota_get_app_description();
+
+#endif /* ESP_OTA_OPS_H */
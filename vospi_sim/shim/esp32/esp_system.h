@@ -0,0 +1,18 @@
+/*
+ * Host shim for the ESP-IDF system functions used by the capture code
+ */
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "esp_err.h"
+
+#define MALLOC_CAP_DMA 0
+
+static inline void* heap_caps_malloc(size_t size, uint32_t caps)
+{
+	return malloc(size);
+}
+
+#endif /* ESP_SYSTEM_H */
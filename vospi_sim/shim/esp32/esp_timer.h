@@ -0,0 +1,11 @@
+/*
+ * Host shim for the ESP-IDF timer (returns the simulator's virtual time)
+ */
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
+
+#endif /* ESP_TIMER_H */
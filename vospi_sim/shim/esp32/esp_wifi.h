@@ -0,0 +1,29 @@
+/*
+ * Host shim for the ESP-IDF WiFi types referenced by the firmware's headers
+ */
+#ifndef ESP_WIFI_H
+#define ESP_WIFI_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifndef MACSTR
+#define MAC2STR(a) (a)[0], (a)[1], (a)[2], (a)[3], (a)[4], (a)[5]
+#define MACSTR "%02x:%02x:%02x:%02x:%02x:%02x"
+#endif
+
+typedef struct {
+	uint8_t bssid[6];
+	uint8_t ssid[33];
+	uint8_t primary;
+	int8_t rssi;
+	int authmode;
+} wifi_ap_record_t;
+
+typedef enum {
+	WIFI_PS_NONE,
+	WIFI_PS_MIN_MODEM,
+	WIFI_PS_MAX_MODEM
+} wifi_ps_type_t;
+
+#endif /* ESP_WIFI_H */
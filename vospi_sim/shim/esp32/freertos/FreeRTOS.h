@@ -0,0 +1,16 @@
+/*
+ * Host shim for the FreeRTOS types referenced by the capture code's headers
+ */
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void* QueueHandle_t;
+
+#define configMAX_TASK_NAME_LEN 16
+#define portNUM_PROCESSORS      2
+
+#endif /* FREERTOS_H */
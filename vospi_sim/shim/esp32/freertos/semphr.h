@@ -0,0 +1,4 @@
+/*
+ * Host shim (types are in FreeRTOS.h)
+ */
+#include "freertos/FreeRTOS.h"
@@ -0,0 +1,59 @@
+/*
+ * Host shim for the mbedTLS base64 encoder used by json_utilities.c.  It is the same
+ * table driven loop as mbedTLS 2.x (three bytes to four characters, '=' padding and a
+ * terminating null) so the benchmarks time comparable code.
+ */
+#ifndef MBEDTLS_BASE64_H
+#define MBEDTLS_BASE64_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL -0x002A
+
+static inline int mbedtls_base64_encode(unsigned char* dst, size_t dlen, size_t* olen, const unsigned char* src, size_t slen)
+{
+	static const unsigned char enc_map[64] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	size_t i, n;
+	unsigned char* p = dst;
+	int c1, c2, c3;
+
+	if (slen == 0) {
+		*olen = 0;
+		return 0;
+	}
+
+	n = ((slen + 2) / 3) * 4;
+	if ((dst == NULL) || (dlen < n + 1)) {
+		*olen = n + 1;
+		return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+	}
+
+	n = (slen / 3) * 3;
+	for (i = 0; i < n; i += 3) {
+		c1 = *src++;
+		c2 = *src++;
+		c3 = *src++;
+		*p++ = enc_map[(c1 >> 2) & 0x3F];
+		*p++ = enc_map[(((c1 & 3) << 4) + (c2 >> 4)) & 0x3F];
+		*p++ = enc_map[(((c2 & 15) << 2) + (c3 >> 6)) & 0x3F];
+		*p++ = enc_map[c3 & 0x3F];
+	}
+
+	if (i < slen) {
+		c1 = *src++;
+		c2 = ((i + 1) < slen) ? *src++ : 0;
+		*p++ = enc_map[(c1 >> 2) & 0x3F];
+		*p++ = enc_map[(((c1 & 3) << 4) + (c2 >> 4)) & 0x3F];
+		*p++ = ((i + 1) < slen) ? enc_map[((c2 & 15) << 2) & 0x3F] : '=';
+		*p++ = '=';
+	}
+
+	*olen = p - dst;
+	*p = 0;
+
+	return 0;
+}
+
+#endif /* MBEDTLS_BASE64_H */
@@ -0,0 +1,279 @@
+/*
+ * VoSPI capture benchmark harness
+ *
+ * Usage: bench_xxx [options]
+ *   -t <sec>     Virtual time to run (default 30)
+ *   -r <file>    Replay frames from a .tjsn/.tmjsn file instead of synthetic pixels
+ *   -m <loc>     Telemetry: none (default), header or footer
+ *   -a           Synthetic pixels are 8-bit AGC values
+ *   -c <rate>    Probability each data packet has a CRC error (default 0)
+ *   -d <n>       Maximum discard packets before each segment (default 2)
+ *   -f <sec>     FFC period (default 0 for none)
+ *   -s <hz>      SPI clock (default is the platform's)
+ *   -o <usec>    SPI transaction overhead (default is an estimate for the platform)
+ *   -l <usec>    VSYNC interrupt latency (default is an estimate for the platform)
+ *   -S <seed>    Random seed (default 1)
+ *   -q           Print one CSV line instead of the report
+ *   -Q           Print the CSV header and exit
+ *
+ */
+#define _GNU_SOURCE
+#include "bench.h"
+#include "lepsim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// Brackets timed to measure the CPU time they add to the capture code
+#define CALIBRATE_BRACKETS 20000
+
+#define CSV_HEADER "frontend,seconds,output,captured,good,bad,repeated,fps,sync_ms,max_gap_ms," \
+                   "cpu_us_per_frame,cpu_us_per_step,vsyncs,missed_vsyncs,ffcs,crc_errors,lost_packets"
+
+
+//
+// Harness state
+//
+static int64_t run_usec = 30 * 1000000LL;
+
+// Simulator CPU time accounting
+static int sim_depth = 0;
+static int64_t sim_start_nsec;
+static int64_t sim_nsec = 0;
+static uint32_t sim_brackets = 0;
+static int64_t bracket_nsec = 0;
+
+// Captured frame
+static uint16_t pix[LEPSIM_NUM_PIXELS];
+static uint16_t telem[LEPSIM_TEL_WORDS];
+
+
+
+/**
+ * Thread CPU time in nSec
+ */
+static int64_t cpu_nsec()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+void bench_sim_begin()
+{
+	if (sim_depth++ == 0) {
+		sim_start_nsec = cpu_nsec();
+	}
+}
+
+
+void bench_sim_end()
+{
+	if (--sim_depth == 0) {
+		sim_nsec += cpu_nsec() - sim_start_nsec;
+		sim_brackets++;
+	}
+}
+
+
+int bench_done()
+{
+	return (lepsim_now_usec() >= run_usec);
+}
+
+
+/**
+ * Measure the CPU time an empty bracket leaves outside of itself so it can be
+ * subtracted from the capture code's time
+ */
+static void calibrate_brackets()
+{
+	int64_t start;
+	int i;
+
+	start = cpu_nsec();
+	for (i=0; i<CALIBRATE_BRACKETS; i++) {
+		bench_sim_begin();
+		bench_sim_end();
+	}
+	bracket_nsec = (cpu_nsec() - start - sim_nsec) / CALIBRATE_BRACKETS;
+	if (bracket_nsec < 0) bracket_nsec = 0;
+
+	sim_nsec = 0;
+	sim_brackets = 0;
+}
+
+
+static void usage(char* name)
+{
+	fprintf(stderr, "Usage: %s [-t sec] [-r sample_file] [-m none|header|footer] [-a] [-c crc_rate]\n", name);
+	fprintf(stderr, "       [-d discards] [-f ffc_sec] [-s spi_hz] [-o xfer_usec] [-l irq_usec] [-S seed] [-q|-Q]\n");
+}
+
+
+int main(int argc, char** argv)
+{
+	lepsim_config_t cfg;
+	lepsim_stats_t st;
+	int csv = 0;
+	int c, rsp, id;
+	int last_id = -1;
+	int has_telem;
+	uint32_t steps = 0;
+	uint32_t captured = 0;
+	uint32_t good = 0;
+	uint32_t bad = 0;
+	uint32_t repeated = 0;
+	int64_t sync_usec = -1;
+	int64_t last_good_usec = 0;
+	int64_t max_gap_usec = 0;
+	int64_t start, cpu;
+	double secs, fps;
+
+	lepsim_default_config(&cfg);
+	fe_default_config(&cfg);
+
+	while ((c = getopt(argc, argv, "t:r:m:ac:d:f:s:o:l:S:qQ")) != -1) {
+		switch (c) {
+			case 't':
+				run_usec = (int64_t) (atof(optarg) * 1000000);
+				break;
+			case 'r':
+				cfg.sample_file = optarg;
+				break;
+			case 'm':
+				if (strcmp(optarg, "header") == 0) {
+					cfg.telem = LEPSIM_TELEM_HEADER;
+				} else if (strcmp(optarg, "footer") == 0) {
+					cfg.telem = LEPSIM_TELEM_FOOTER;
+				} else if (strcmp(optarg, "none") == 0) {
+					cfg.telem = LEPSIM_TELEM_NONE;
+				} else {
+					usage(argv[0]);
+					return -1;
+				}
+				break;
+			case 'a':
+				cfg.agc = 1;
+				break;
+			case 'c':
+				cfg.crc_error_rate = atof(optarg);
+				break;
+			case 'd':
+				cfg.max_discards = atoi(optarg);
+				break;
+			case 'f':
+				cfg.ffc_sec = atoi(optarg);
+				break;
+			case 's':
+				cfg.spi_hz = atoi(optarg);
+				break;
+			case 'o':
+				cfg.xfer_usec = atoi(optarg);
+				break;
+			case 'l':
+				cfg.irq_usec = atoi(optarg);
+				break;
+			case 'S':
+				cfg.seed = strtoul(optarg, NULL, 0);
+				break;
+			case 'q':
+				csv = 1;
+				break;
+			case 'Q':
+				printf(CSV_HEADER "\n");
+				return 0;
+			default:
+				usage(argv[0]);
+				return -1;
+		}
+	}
+
+	if (lepsim_init(&cfg) < 0) {
+		return -1;
+	}
+	if (fe_init(&cfg) < 0) {
+		fprintf(stderr, "%s: failed to initialize\n", fe_name);
+		return -1;
+	}
+	calibrate_brackets();
+
+	// Run
+	cpu = 0;
+	while (!bench_done()) {
+		start = cpu_nsec();
+		rsp = fe_step();
+		cpu += cpu_nsec() - start;
+		steps++;
+		if (rsp < 0) {
+			fprintf(stderr, "%s: fatal error at %lld uSec\n", fe_name, (long long) lepsim_now_usec());
+			break;
+		}
+		if (rsp == 0) {
+			continue;
+		}
+
+		// Check the frame against what the simulator output
+		captured++;
+		has_telem = fe_get_frame(pix, telem);
+		id = lepsim_match_frame(pix, fe_pixel_mask);
+		if ((id < 0) || (has_telem && !lepsim_match_telem(id, telem))) {
+			bad++;
+		} else if (id == last_id) {
+			repeated++;
+		} else {
+			good++;
+			last_id = id;
+			if (sync_usec < 0) {
+				sync_usec = lepsim_now_usec();
+			} else if ((lepsim_now_usec() - last_good_usec) > max_gap_usec) {
+				max_gap_usec = lepsim_now_usec() - last_good_usec;
+			}
+			last_good_usec = lepsim_now_usec();
+		}
+	}
+	cpu -= sim_nsec + (int64_t) sim_brackets * bracket_nsec;
+	if (cpu < 0) cpu = 0;
+
+	// Report
+	lepsim_get_stats(&st);
+	secs = (double) lepsim_now_usec() / 1000000.0;
+	fps = (double) good / secs;
+	if (csv) {
+		printf("%s,%.1f,%u,%u,%u,%u,%u,%.2f,%.1f,%.1f,%.2f,%.2f,%u,%u,%u,%u,%u\n",
+		       fe_name, secs, st.frames, captured, good, bad, repeated, fps,
+		       (sync_usec >= 0) ? (double) sync_usec / 1000.0 : -1.0, (double) max_gap_usec / 1000.0,
+		       good ? ((double) cpu / 1000.0) / good : 0.0,
+		       steps ? ((double) cpu / 1000.0) / steps : 0.0,
+		       st.vsyncs, st.missed_vsyncs, st.ffcs, st.crc_errors, st.lost_packets);
+		return 0;
+	}
+
+	printf("%s: %.1f sec, %u frames output, %u captured\n", fe_name, secs, st.frames, captured);
+	if (lepsim_num_samples() > 0) {
+		printf("  source       %d frames from %s\n", lepsim_num_samples(), cfg.sample_file);
+	}
+	printf("  good         %u (%u bad, %u repeated)\n", good, bad, repeated);
+	printf("  frame rate   %.2f frames/sec (%.1f%% of frames output)\n", fps,
+	       st.frames ? (100.0 * good) / st.frames : 0.0);
+	if (sync_usec >= 0) {
+		printf("  sync         %.1f mSec to the first frame, %.1f mSec longest gap\n",
+		       (double) sync_usec / 1000.0, (double) max_gap_usec / 1000.0);
+	} else {
+		printf("  sync         never\n");
+	}
+	printf("  cpu          %.2f uSec/frame, %.2f uSec/step (%u steps)\n",
+	       good ? ((double) cpu / 1000.0) / good : 0.0,
+	       steps ? ((double) cpu / 1000.0) / steps : 0.0, steps);
+	printf("  stream       %u VSYNCs (%u missed), %u FFC, %u CRC errors, %u lost packets\n",
+	       st.vsyncs, st.missed_vsyncs, st.ffcs, st.crc_errors, st.lost_packets);
+	fe_report(stdout);
+
+	return 0;
+}
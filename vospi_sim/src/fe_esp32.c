@@ -0,0 +1,150 @@
+/*
+ * ESP32 (tCam-Mini) front-end: vospi_transfer_segment() from the firmware's lepton
+ * component called for each VSYNC as lep_task does.  The ESP-IDF SPI driver and timer
+ * are shims reading from the simulator.
+ *
+ */
+#include "bench.h"
+#include "lepsim.h"
+
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "driver/spi_master.h"
+#include "perf_utilities.h"
+#include "sys_utilities.h"
+#include "vospi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+const char* fe_name = "esp32";
+const uint16_t fe_pixel_mask = 0xFFFF;
+
+// Estimated spi_device_transmit() setup and GPIO ISR to lep_task latency
+#define ESP32_XFER_USEC 15
+#define ESP32_IRQ_USEC  10
+
+static int include_telem;
+static uint16_t lep_buffer[LEP_NUM_PIXELS];
+static uint16_t lep_telem[LEP_TEL_WORDS];
+static lep_buffer_t lep_frame;
+
+static uint32_t perf_counters[PERF_NUM_COUNTERS];
+
+
+
+//
+// ESP-IDF, perf_utilities and sys_utilities shims
+//
+int64_t esp_timer_get_time()
+{
+	return lepsim_now_usec();
+}
+
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* dev_config, spi_device_handle_t* handle)
+{
+	*handle = NULL;
+	return ESP_OK;
+}
+
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+	return ESP_OK;
+}
+
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t* trans_desc)
+{
+	bench_sim_begin();
+	lepsim_begin_transfer();
+	lepsim_transfer(trans_desc->rx_buffer, trans_desc->rxlength / 8);
+	bench_sim_end();
+
+	return ESP_OK;
+}
+
+
+void perf_record(int stage, int64_t start_usec)
+{
+}
+
+
+void perf_count(int counter)
+{
+	if ((counter >= 0) && (counter < PERF_NUM_COUNTERS)) {
+		perf_counters[counter]++;
+	}
+}
+
+
+
+void* system_buffer_alloc(const char* name, int index, uint32_t len, int placement)
+{
+	return malloc(len);
+}
+
+
+
+//
+// Front-end
+//
+void fe_default_config(lepsim_config_t* cfg)
+{
+	cfg->spi_hz = LEP_SPI_FREQ_HZ;
+	cfg->xfer_usec = ESP32_XFER_USEC;
+	cfg->irq_usec = ESP32_IRQ_USEC;
+}
+
+
+int fe_init(const lepsim_config_t* cfg)
+{
+	if (vospi_init(0) != ESP_OK) {
+		return -1;
+	}
+
+	include_telem = (cfg->telem != LEPSIM_TELEM_NONE);
+	vospi_include_telem(0, include_telem, cfg->telem == LEPSIM_TELEM_HEADER);
+
+	lep_frame.lep_bufferP = lep_buffer;
+	lep_frame.lep_telemP = lep_telem;
+	vospi_set_frame_buffer(0, &lep_frame);
+
+	return 0;
+}
+
+
+int fe_step()
+{
+	(void) lepsim_wait_vsync();
+
+	if (vospi_transfer_segment(0, esp_timer_get_time())) {
+		vospi_finish_frame(0, &lep_frame);
+		return 1;
+	}
+
+	return 0;
+}
+
+
+int fe_get_frame(uint16_t* pix, uint16_t* telem)
+{
+	memcpy(pix, lep_buffer, sizeof(lep_buffer));
+	if (lep_frame.telem_valid) {
+		memcpy(telem, lep_telem, sizeof(lep_telem));
+	}
+
+	return lep_frame.telem_valid;
+}
+
+
+void fe_report(FILE* fp)
+{
+	fprintf(fp, "  vospi        %u segment retries, %u/%u/%u/%u CRC failures in segments 1-4\n",
+	        perf_counters[PERF_CNT_SEG_RETRY],
+	        perf_counters[PERF_CNT_CRC_FAIL_SEG1], perf_counters[PERF_CNT_CRC_FAIL_SEG2],
+	        perf_counters[PERF_CNT_CRC_FAIL_SEG3], perf_counters[PERF_CNT_CRC_FAIL_SEG4]);
+}
@@ -0,0 +1,192 @@
+/*
+ * Raspberry Pi (leptonic-vsync) front-end: vospi_vsync() called for each VSYNC
+ * as its capture thread does (built with VOSPI_GPIO_CHARDEV so the segment deadline
+ * is measured from the edge).  The spidev read() and ioctl() calls, the monotonic
+ * clock and the resync sleep are redirected to the simulator with --wrap.
+ *
+ */
+#define _GNU_SOURCE
+#include "bench.h"
+#include "lepsim.h"
+#include "log.h"
+#include "vospi.h"
+#include "vospi_asm.h"
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/spi/spidev.h>
+#include <sys/ioctl.h>
+
+
+const char* fe_name = "pi";
+const uint16_t fe_pixel_mask = 0xFFFF;
+
+// Estimated spidev read()/ioctl() overhead and GPIO edge to capture thread latency
+#define PI_XFER_USEC 20
+#define PI_IRQ_USEC  50
+
+static vospi_dev_t dev;
+static vospi_frame_t frame;
+
+
+//
+// Redirected system calls
+//
+ssize_t __real_read(int fd, void* buf, size_t count);
+int __real_ioctl(int fd, unsigned long request, void* arg);
+int __real_clock_gettime(clockid_t clk_id, struct timespec* tp);
+int __real_nanosleep(const struct timespec* req, struct timespec* rem);
+
+
+ssize_t __wrap_read(int fd, void* buf, size_t count)
+{
+	if (fd != BENCH_SIM_FD) {
+		return __real_read(fd, buf, count);
+	}
+
+	bench_sim_begin();
+	lepsim_begin_transfer();
+	lepsim_transfer(buf, count);
+	bench_sim_end();
+
+	return count;
+}
+
+
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+	struct spi_ioc_transfer* xfer;
+	va_list ap;
+	void* arg;
+	int i, n;
+	int len = 0;
+
+	va_start(ap, request);
+	arg = va_arg(ap, void*);
+	va_end(ap);
+
+	if (fd != BENCH_SIM_FD) {
+		return __real_ioctl(fd, request, arg);
+	}
+
+	if ((_IOC_TYPE(request) != SPI_IOC_MAGIC) || (_IOC_NR(request) != 0)) {
+		// Configuration
+		return 0;
+	}
+
+	// SPI_IOC_MESSAGE(n): one transaction for all of the transfers
+	xfer = (struct spi_ioc_transfer*) arg;
+	n = _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer);
+	bench_sim_begin();
+	lepsim_begin_transfer();
+	for (i=0; i<n; i++) {
+		lepsim_transfer((void*) (uintptr_t) xfer[i].rx_buf, xfer[i].len);
+		len += xfer[i].len;
+	}
+	bench_sim_end();
+
+	return len;
+}
+
+
+int __wrap_clock_gettime(clockid_t clk_id, struct timespec* tp)
+{
+	int64_t usec;
+
+	if (clk_id != CLOCK_MONOTONIC) {
+		return __real_clock_gettime(clk_id, tp);
+	}
+
+	usec = lepsim_now_usec();
+	tp->tv_sec = usec / 1000000;
+	tp->tv_nsec = (usec % 1000000) * 1000;
+	return 0;
+}
+
+
+int __wrap_nanosleep(const struct timespec* req, struct timespec* rem)
+{
+	lepsim_advance_usec((int64_t) req->tv_sec * 1000000 + req->tv_nsec / 1000);
+	return 0;
+}
+
+
+
+//
+// Front-end
+//
+void fe_default_config(lepsim_config_t* cfg)
+{
+	cfg->spi_hz = 33333333;
+	cfg->xfer_usec = PI_XFER_USEC;
+	cfg->irq_usec = PI_IRQ_USEC;
+#ifdef VOSPI_TELEM_FOOTER
+	cfg->telem = LEPSIM_TELEM_FOOTER;
+#endif
+}
+
+
+int fe_init(const lepsim_config_t* cfg)
+{
+	log_set_quiet(1);
+
+	// What vospi_init() does without touching the SPI device or VSYNC gpio
+	return vospi_dev_init(&dev, BENCH_SIM_FD, VOSPI_VSYNC_GPIO, &frame);
+}
+
+
+int fe_step()
+{
+	vospi_vsync(&dev, lepsim_wait_vsync());
+	if (dev.frame_captured) {
+		dev.frame_captured = 0;
+		return 1;
+	}
+
+	return 0;
+}
+
+
+int fe_get_frame(uint16_t* pix, uint16_t* telem)
+{
+	uint8_t* p;
+	int i;
+
+	p = frame.pixels;
+	for (i=0; i<VOSPI_IMAGE_PACKETS*VOSPI_PACKET_SYMBOLS/2; i++) {
+		*pix++ = (p[0] << 8) | p[1];
+		p += 2;
+	}
+
+	p = frame.telem;
+	for (i=0; i<(LEPSIM_TEL_PKTS - 1)*VOSPI_PACKET_SYMBOLS/2; i++) {
+		*telem++ = (p[0] << 8) | p[1];
+		p += 2;
+	}
+
+#ifdef VOSPI_TELEM_FOOTER
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+
+void fe_report(FILE* fp)
+{
+	fprintf(fp, "  build        %s%s\n",
+#ifdef VOSPI_BATCH_SEGMENT
+	        "VOSPI_BATCH_SEGMENT",
+#else
+	        "per-packet read()",
+#endif
+#ifdef VOSPI_TELEM_FOOTER
+	        " VOSPI_TELEM_FOOTER"
+#else
+	        ""
+#endif
+	        );
+}
@@ -0,0 +1,425 @@
+/*
+ * BeagleBone/PocketBeagle (pru_rpmsg_fb) front-end: sync_and_transfer_frame() from
+ * the application reading rpmsg messages as the capture thread in prulepton.c does.
+ *
+ * The rpmsg device is a model of the PRU firmware (the app's read() and write()
+ * calls are redirected to it with --wrap):
+ *   - PRU0 samples a packet from the simulator every sample period, checks its CRC
+ *     and packet/segment sequence, stores it and triggers PRU1 at packet 20 of
+ *     segment 1.  It resynchronizes the Lepton if it doesn't see a frame start for
+ *     200 mSec.
+ *   - PRU1 sends a message every message period once triggered, checking that PRU0
+ *     has stored all of the message's data and hasn't overwritten it in the shared
+ *     memory circular buffer, and sends an abort message when either PRU fails.
+ * Only the host side is timed (the model runs in brackets).  The BeagleBone and
+ * PocketBeagle applications are the same so only the BeagleBone one is built.
+ *
+ */
+#include "bench.h"
+#include "lepsim.h"
+#include "log.h"
+#include "vospi.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#if defined(VOSPI_DDR_RING) || defined(VOSPI_FRAME_STATS)
+#error "The PRU model only supports the default rpmsg frame transport"
+#endif
+
+
+const char* fe_name = "pru";
+#ifdef VOSPI_16BIT
+const uint16_t fe_pixel_mask = 0xFFFF;
+#else
+const uint16_t fe_pixel_mask = 0x00FF;
+#endif
+
+// PRU0 bit-banged SPI clock
+#define PRU_SPI_HZ               16666667
+
+// Shared memory circular buffer length (pru_common.h SMEM_BUF_LEN)
+#define PRU_SMEM_BUF_LEN         ((12 * 1024) - 20)
+
+// PRU0 Lepton resync timeout and delay
+#define PRU_RESYNC_THRESHOLD_USEC 200000
+#define PRU_RESYNC_USEC          190000
+
+// PRU0 get_packet() responses
+#define PKT_DISCARD              0
+#define PKT_GOOD                 1
+#define PKT_TRIGGER              2
+#define PKT_ILLEGAL              3
+
+// PRU0 run state
+#define P0_DATA                  0
+#define P0_DISCARD               1
+
+// PRU1 run state and command from PRU0
+#define P1_WAIT                  0
+#define P1_SEND                  1
+#define P1_CMD_IDLE              0
+#define P1_CMD_IN_FRAME          1
+#define P1_CMD_ABORT             2
+
+
+//
+// PRU model state
+//
+static int telem;
+static int last_packet;
+
+// PRU0
+static int p0_state = P0_DATA;
+static uint8_t cur_segment;
+static uint8_t cur_packet;
+static uint32_t pkts;                        // Packets stored for the current frame
+static uint32_t resync_count;
+static uint32_t resync_threshold;
+static uint32_t sample_usec = VOSPI_SAMPLE_USEC_DEF;
+static int64_t next_sample_usec;
+static uint8_t frame_data[VOSPI_FRAME_BYTES];
+
+// PRU1
+static int p1_state = P1_WAIT;
+static int p1_cmd = P1_CMD_IDLE;
+static int cur_seq;
+static uint32_t xmit_usec = VOSPI_XMIT_USEC_DEF;
+static int64_t next_xmit_usec;
+
+// Counters
+static uint32_t crc_fails;
+static uint32_t resyncs;
+static uint32_t aborts[3];
+
+// Host frame
+static vospi_frame_t frame;
+
+
+
+//
+// PRU0 model
+//
+static void init_capture()
+{
+	cur_segment = 0;
+	cur_packet = last_packet;
+	pkts = 0;
+}
+
+
+/**
+ * Read one packet from the simulator and store it if it is valid (pru0_main.c
+ * get_packet())
+ */
+static int get_packet()
+{
+	uint8_t pkt[LEPSIM_PKT_BYTES];
+	uint8_t* dst;
+	uint8_t hi, lo, seg;
+	int store;
+	int i;
+
+	lepsim_transfer(pkt, LEPSIM_PKT_BYTES);
+	hi = pkt[0];
+	lo = pkt[1];
+
+	if (((hi & 0x0F) == 0x0F) || (p0_state == P0_DISCARD)) {
+		return PKT_DISCARD;
+	}
+
+	// Telemetry packets are checked but not stored
+	if (telem == LEPSIM_TELEM_HEADER) {
+		store = !((cur_segment == 0) && (lo < LEPSIM_TEL_PKTS));
+	} else if (telem == LEPSIM_TELEM_FOOTER) {
+		store = !((cur_segment == 4) && (lo > (last_packet - LEPSIM_TEL_PKTS)));
+	} else {
+		store = 1;
+	}
+
+	if (!lepsim_packet_crc_valid(pkt)) {
+		crc_fails++;
+		return PKT_ILLEGAL;
+	}
+
+	if (store && (pkts < LEPSIM_IMG_PKTS)) {
+		dst = &frame_data[pkts * VOSPI_PKT_NUM_BYTES];
+		for (i=4; i<LEPSIM_PKT_BYTES; i+=2) {
+#ifdef VOSPI_16BIT
+			*dst++ = pkt[i];
+#endif
+			*dst++ = pkt[i+1];
+		}
+		pkts++;
+	}
+
+	if (lo == 20) {
+		seg = (hi & 0x70) >> 4;
+		if ((cur_segment + 1) == seg) {
+			cur_segment = seg;
+			if (cur_packet == 19) {
+				cur_packet = 20;
+				if (cur_segment == 1) {
+					return PKT_TRIGGER;
+				}
+			} else {
+				return PKT_ILLEGAL;
+			}
+		} else {
+			return PKT_ILLEGAL;
+		}
+	} else if (cur_packet == last_packet) {
+		if (lo == 0) {
+			cur_packet = 0;
+		} else {
+			return PKT_ILLEGAL;
+		}
+	} else {
+		if ((cur_packet + 1) == lo) {
+			cur_packet = lo;
+		} else {
+			return PKT_ILLEGAL;
+		}
+	}
+
+	return PKT_GOOD;
+}
+
+
+/**
+ * One PRU0 sample period (pru0_main.c main loop)
+ */
+static void pru0_sample()
+{
+	int rsp;
+
+	lepsim_advance_to_usec(next_sample_usec);
+	next_sample_usec += sample_usec;
+
+	if ((p0_state == P0_DISCARD) && (p1_cmd == P1_CMD_IDLE)) {
+		p0_state = P0_DATA;
+		init_capture();
+		resync_count = 0;
+	}
+
+	rsp = get_packet();
+	resync_count++;
+	if (rsp == PKT_ILLEGAL) {
+		if (p1_cmd == P1_CMD_IN_FRAME) {
+			p1_cmd = P1_CMD_ABORT;
+		}
+		init_capture();
+	} else if (rsp == PKT_TRIGGER) {
+		p1_cmd = P1_CMD_IN_FRAME;
+		resync_count = 0;
+	} else if (rsp == PKT_GOOD) {
+		if ((cur_packet == last_packet) && (cur_segment == 4)) {
+			p0_state = P0_DISCARD;
+		}
+	}
+
+	if (resync_count == resync_threshold) {
+		// CS de-asserted long enough for the Lepton to resync
+		lepsim_advance_usec(PRU_RESYNC_USEC);
+		init_capture();
+		next_sample_usec = lepsim_now_usec();
+		resync_count = 0;
+		resyncs++;
+	}
+}
+
+
+//
+// PRU1 model
+//
+static void set_abort_msg(vospi_rpmsg_t* msg, uint8_t reason)
+{
+	msg->seq = VOSPI_ABORT_MSG;
+	msg->data[0] = reason;
+	aborts[reason]++;
+}
+
+
+/**
+ * Load the next message of the frame.  Returns the abort reason if PRU0 hadn't
+ * stored all of it or overwrote some of it, 0 if the message is good (pru1_main.c
+ * get_lep_msg()).
+ */
+static uint8_t get_lep_msg(vospi_rpmsg_t* msg)
+{
+	uint32_t start = cur_seq * VOSPI_MSG_DATA_BYTES;
+
+	msg->seq = cur_seq;
+	if ((pkts * VOSPI_PKT_NUM_BYTES) < (start + VOSPI_MSG_DATA_BYTES)) {
+		return VOSPI_ABORT_UNDERRUN;
+	}
+	memcpy(msg->data, &frame_data[start], VOSPI_MSG_DATA_BYTES);
+	if (((pkts + 1) * VOSPI_PKT_NUM_BYTES - start) > PRU_SMEM_BUF_LEN) {
+		return VOSPI_ABORT_OVERRUN;
+	}
+
+	return 0;
+}
+
+
+/**
+ * Run the PRUs until PRU1 sends the next message
+ */
+static void next_msg(vospi_rpmsg_t* msg)
+{
+	uint8_t reason;
+
+	while (1) {
+		if ((p1_state == P1_WAIT) && (p1_cmd == P1_CMD_IN_FRAME)) {
+			p1_state = P1_SEND;
+			cur_seq = 0;
+			next_xmit_usec = lepsim_now_usec() + xmit_usec;
+		}
+
+		if (p1_state == P1_SEND) {
+			if (p1_cmd == P1_CMD_ABORT) {
+				p1_cmd = P1_CMD_IDLE;
+				p1_state = P1_WAIT;
+				set_abort_msg(msg, VOSPI_ABORT_PKT);
+				return;
+			}
+
+			if (next_xmit_usec <= next_sample_usec) {
+				lepsim_advance_to_usec(next_xmit_usec);
+				next_xmit_usec = lepsim_now_usec() + xmit_usec;
+				reason = get_lep_msg(msg);
+				if (reason != 0) {
+					p1_cmd = P1_CMD_IDLE;
+					p1_state = P1_WAIT;
+					set_abort_msg(msg, reason);
+				} else if (++cur_seq == VOSPI_FRAME_NUM_MSGS) {
+					p1_cmd = P1_CMD_IDLE;
+					p1_state = P1_WAIT;
+				}
+				return;
+			}
+		}
+
+		if (bench_done()) {
+			// Let the host give up on the frame at the end of the run
+			set_abort_msg(msg, VOSPI_ABORT_PKT);
+			return;
+		}
+		pru0_sample();
+	}
+}
+
+
+
+//
+// Redirected system calls
+//
+ssize_t __real_read(int fd, void* buf, size_t count);
+ssize_t __real_write(int fd, const void* buf, size_t count);
+
+
+ssize_t __wrap_read(int fd, void* buf, size_t count)
+{
+	if (fd != BENCH_SIM_FD) {
+		return __real_read(fd, buf, count);
+	}
+
+	bench_sim_begin();
+	next_msg((vospi_rpmsg_t*) buf);
+	bench_sim_end();
+
+	return VOSPI_MSG_TOTAL_BYTES;
+}
+
+
+ssize_t __wrap_write(int fd, const void* buf, size_t count)
+{
+	const uint8_t* cmd = (const uint8_t*) buf;
+	uint16_t usec;
+
+	if (fd != BENCH_SIM_FD) {
+		return __real_write(fd, buf, count);
+	}
+
+	// Timing command (values outside the firmware's range select its defaults)
+	if ((count >= VOSPI_TIMING_CMD_LEN) && (cmd[0] == VOSPI_TIMING_CMD)) {
+		usec = cmd[1] | (cmd[2] << 8);
+		sample_usec = ((usec >= VOSPI_SAMPLE_USEC_MIN) && (usec <= VOSPI_SAMPLE_USEC_MAX)) ? usec : VOSPI_SAMPLE_USEC_DEF;
+		usec = cmd[3] | (cmd[4] << 8);
+		xmit_usec = ((usec >= VOSPI_XMIT_USEC_MIN) && (usec <= VOSPI_XMIT_USEC_MAX)) ? usec : VOSPI_XMIT_USEC_DEF;
+		resync_threshold = PRU_RESYNC_THRESHOLD_USEC / sample_usec;
+	}
+
+	return count;
+}
+
+
+
+//
+// Front-end
+//
+void fe_default_config(lepsim_config_t* cfg)
+{
+	cfg->spi_hz = PRU_SPI_HZ;
+	cfg->xfer_usec = 0;
+	cfg->irq_usec = 0;
+}
+
+
+int fe_init(const lepsim_config_t* cfg)
+{
+	log_set_quiet(1);
+
+	telem = cfg->telem;
+	last_packet = (telem == LEPSIM_TELEM_NONE) ? 59 : 60;
+	init_capture();
+	resync_threshold = PRU_RESYNC_THRESHOLD_USEC / sample_usec;
+
+	// As prulepton_start() does before enabling the PRUs
+	if (vospi_set_timing(BENCH_SIM_FD, VOSPI_SAMPLE_USEC, VOSPI_XMIT_USEC) < 0) {
+		return -1;
+	}
+	next_sample_usec = lepsim_now_usec();
+
+	return 0;
+}
+
+
+int fe_step()
+{
+	int rsp;
+
+	rsp = sync_and_transfer_frame(BENCH_SIM_FD, &frame);
+	if (rsp < 0) {
+		return -1;
+	}
+
+	return (rsp == 0) ? 1 : 0;
+}
+
+
+int fe_get_frame(uint16_t* pix, uint16_t* telem)
+{
+#ifdef VOSPI_16BIT
+	frame_to_pixel16(&frame, pix);
+#else
+	uint8_t pix8[VOSPI_FRAME_LEN];
+	int i;
+
+	frame_to_pixel(&frame, pix8);
+	for (i=0; i<VOSPI_FRAME_LEN; i++) {
+		pix[i] = pix8[i];
+	}
+#endif
+
+	return 0;
+}
+
+
+void fe_report(FILE* fp)
+{
+	fprintf(fp, "  pru          %u/%u uSec timing, %u CRC failures, %u resyncs\n",
+	        sample_usec, xmit_usec, crc_fails, resyncs);
+	fprintf(fp, "  aborts       %u bad packet, %u underrun, %u overrun\n",
+	        aborts[VOSPI_ABORT_PKT], aborts[VOSPI_ABORT_UNDERRUN], aborts[VOSPI_ABORT_OVERRUN]);
+}
@@ -0,0 +1,117 @@
+/*
+ * Teensy 3.2 (LeptonVoSPI) front-end: the library's VSYNC ISR run for each VSYNC with
+ * frames taken from its ping-pong buffers as lep_test9 does.  The Arduino, SPI and
+ * ILI9341 libraries are shims with SPI buffer transfers reading from the simulator.
+ *
+ * The library stores 8-bit AGC pixels (the low byte of each pixel) and doesn't handle
+ * telemetry so it should be run without telemetry (-m none).
+ *
+ */
+#include "bench.h"
+#include "lepsim.h"
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "LeptonVoSPI.h"
+
+
+const char* fe_name = "teensy";
+const uint16_t fe_pixel_mask = 0x00FF;
+
+// Estimated SPI.transfer() setup and VSYNC edge to ISR latency
+#define TEENSY_XFER_USEC 2
+#define TEENSY_IRQ_USEC  1
+
+// lep_test9 pins
+#define PIN_LEPTON_CS    2
+#define PIN_LEPTON_VSYNC 3
+
+SPIClass SPI;
+
+static void (*vsyncIsr)(void);
+static uint8_t lepFrames[2][LEP_NUM_PIXELS];
+
+
+
+//
+// Arduino and SPI shims
+//
+uint32_t micros()
+{
+  return (uint32_t) lepsim_now_usec();
+}
+
+
+void attachInterrupt(uint8_t pin, void (*function)(void), int mode)
+{
+  vsyncIsr = function;
+}
+
+
+void detachInterrupt(uint8_t pin)
+{
+  vsyncIsr = NULL;
+}
+
+
+void SPIClass::transfer(void* buf, size_t count)
+{
+  bench_sim_begin();
+  lepsim_begin_transfer();
+  lepsim_transfer(buf, count);
+  bench_sim_end();
+}
+
+
+
+//
+// Front-end
+//
+void fe_default_config(lepsim_config_t* cfg)
+{
+  cfg->spi_hz = 20000000;
+  cfg->xfer_usec = TEENSY_XFER_USEC;
+  cfg->irq_usec = TEENSY_IRQ_USEC;
+}
+
+
+int fe_init(const lepsim_config_t* cfg)
+{
+  LepVoSPI.begin(PIN_LEPTON_CS, PIN_LEPTON_VSYNC, LEP_VOSPI_AGC8, lepFrames[0], lepFrames[1]);
+  LepVoSPI.enable();
+
+  return (vsyncIsr != NULL) ? 0 : -1;
+}
+
+
+int fe_step()
+{
+  (void) lepsim_wait_vsync();
+
+  if (vsyncIsr != NULL) {
+    vsyncIsr();
+  }
+
+  return LepVoSPI.frameAvailable() ? 1 : 0;
+}
+
+
+int fe_get_frame(uint16_t* pix, uint16_t* telem)
+{
+  uint8_t* frame = LepVoSPI.getFrame();
+  int i;
+
+  for (i=0; i<LEP_NUM_PIXELS; i++) {
+    pix[i] = frame[i];
+  }
+  LepVoSPI.releaseFrame();
+
+  return 0;
+}
+
+
+void fe_report(FILE* fp)
+{
+  fprintf(fp, "  LeptonVoSPI  %u frames, %u dropped\n",
+          (unsigned int) LepVoSPI.getFrameCount(), (unsigned int) LepVoSPI.getDroppedCount());
+}
@@ -0,0 +1,712 @@
+/*
+ * Lepton VoSPI simulator
+ *
+ * The stream is generated a packet at a time as the capture code clocks it out.  The
+ * segment being output is determined by the virtual time the packet starts so code
+ * that falls behind loses data the same way it would on hardware.
+ *
+ */
+#include "lepsim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+// Virtual clock resolution
+#define NSEC_PER_USEC     1000LL
+#define VSYNC_NSEC        (LEPSIM_VSYNC_USEC * NSEC_PER_USEC)
+
+// Packet CRC: CCITT polynomial x^16 + x^12 + x^5 + 1 with a 0 seed computed over the
+// entire packet with the 4 MSBs of the ID and the 16-bit CRC field set to 0
+#define CRC_POLY          0x1021
+
+// Synthetic scene: a gradient with noise and a hot spot moving across it (TLinear
+// Kelvin * 100 or scaled to 8-bits over SYNTH_RANGE for AGC)
+#define SYNTH_BASE        29315
+#define SYNTH_RANGE       2400
+#define SYNTH_SPOT        1000
+#define SYNTH_SPOT_R2     100
+#define SYNTH_FPA_T_K100  30215
+#define SYNTH_HSE_T_K100  30015
+
+// Sample file keys and lengths
+#define SAMPLE_RAD_KEY    "\"radiometric\":\""
+#define SAMPLE_TEL_KEY    "\"telemetry\":\""
+#define SAMPLE_RAD_BYTES  (LEPSIM_NUM_PIXELS * 2)
+#define SAMPLE_TEL_BYTES  (LEPSIM_TEL_WORDS * 2)
+
+
+// A unique frame as output by the Lepton
+typedef struct {
+	int num;                         // Unique frame number
+	uint16_t pix[LEPSIM_NUM_PIXELS];
+	uint16_t telem[LEPSIM_TEL_WORDS];
+} sim_frame_t;
+
+// A replayed frame
+typedef struct {
+	uint16_t pix[LEPSIM_NUM_PIXELS];
+	uint16_t telem[LEPSIM_TEL_WORDS];
+	int telem_valid;
+} sample_frame_t;
+
+
+//
+// Simulator state
+//
+static lepsim_config_t cfg;
+static lepsim_stats_t stats;
+static int64_t now_nsec;
+static int64_t irq_nsec;
+static int64_t xfer_nsec;
+static uint32_t rand_state;
+static uint16_t crc_table[256];
+
+// Replayed frames
+static sample_frame_t* samples = NULL;
+static int num_samples = 0;
+
+// Recent unique frames (the newest one is also output by non-unique Lepton frames)
+static sim_frame_t frames[LEPSIM_MATCH_FRAMES];
+static int frame_count = 0;
+static uint32_t ffc_interval;        // FFC period in Lepton frames (0 for none)
+
+// Segment currently being output
+static int64_t seg_index;            // Segments since the first VSYNC (-1 before it)
+static int64_t vsync_taken;          // Last VSYNC edge handed to the capture code
+static int seg_num;                  // Position in the Lepton frame (1-4)
+static int seg_ttt;                  // Segment number in the packets (0 for invalid)
+static int seg_pkt;                  // Packets clocked out since the VSYNC
+static int seg_lead;                 // Discard packets before the segment
+static int pkts_per_seg;
+
+// Packet currently being clocked out
+static uint8_t pkt[LEPSIM_PKT_BYTES];
+static int pkt_pos = LEPSIM_PKT_BYTES;
+static uint8_t discard_pkt[LEPSIM_PKT_BYTES];
+static const uint16_t reserved_row[LEPSIM_PKT_PIXELS];
+
+
+
+//
+// Forward declarations for internal functions
+//
+static uint32_t rand_next();
+static void init_crc_table();
+static uint16_t packet_crc(const uint8_t* pktP);
+static int load_samples(char* fname);
+static int decode_base64(const char* src, uint8_t* dst, int max);
+static void make_frame(sim_frame_t* f, int64_t lepFrame);
+static int frame_unique(int64_t lepFrame);
+static void start_segment();
+static void end_segment();
+static void advance_to(int64_t t);
+static const uint16_t* packet_source(int fp);
+static void build_packet();
+
+
+
+//
+// Simulator API
+//
+
+/**
+ * Fill in the default configuration: synthetic TLinear pixels without telemetry at
+ * 16 MHz with a couple of discard packets before each segment and no errors
+ */
+void lepsim_default_config(lepsim_config_t* c)
+{
+	memset(c, 0, sizeof(lepsim_config_t));
+	c->telem = LEPSIM_TELEM_NONE;
+	c->spi_hz = 16000000;
+	c->max_discards = 2;
+	c->seed = 1;
+}
+
+
+/**
+ * Initialize the simulator (and load the sample file if there is one).  The clock
+ * starts at 0 and the first VSYNC is at LEPSIM_VSYNC_USEC.  Returns 0 for success,
+ * -1 for failure.
+ */
+int lepsim_init(const lepsim_config_t* c)
+{
+	int i;
+
+	cfg = *c;
+	if (cfg.spi_hz == 0) {
+		fprintf(stderr, "lepsim: SPI clock must be set\n");
+		return -1;
+	}
+
+	memset(&stats, 0, sizeof(lepsim_stats_t));
+	now_nsec = 0;
+	irq_nsec = cfg.irq_usec * NSEC_PER_USEC;
+	xfer_nsec = cfg.xfer_usec * NSEC_PER_USEC;
+	rand_state = (cfg.seed != 0) ? cfg.seed : 1;
+	init_crc_table();
+
+	if (cfg.sample_file != NULL) {
+		if (load_samples(cfg.sample_file) < 0) {
+			return -1;
+		}
+	}
+
+	frame_count = 0;
+	ffc_interval = (uint32_t) (((uint64_t) cfg.ffc_sec * 1000000) / (LEPSIM_SEGMENTS * LEPSIM_VSYNC_USEC));
+	pkts_per_seg = (cfg.telem == LEPSIM_TELEM_NONE) ? (LEPSIM_IMG_PKTS / LEPSIM_SEGMENTS) :
+	                                                  ((LEPSIM_IMG_PKTS + LEPSIM_TEL_PKTS) / LEPSIM_SEGMENTS);
+	seg_index = -1;
+	vsync_taken = 0;
+	pkt_pos = LEPSIM_PKT_BYTES;
+
+	// Discard packets have the ID xFxx and garbage data
+	for (i=0; i<LEPSIM_PKT_BYTES; i++) {
+		discard_pkt[i] = rand_next();
+	}
+	discard_pkt[0] |= 0x0F;
+
+	return 0;
+}
+
+
+/**
+ * Return the number of frames loaded from the sample file
+ */
+int lepsim_num_samples()
+{
+	return num_samples;
+}
+
+
+/**
+ * Generate the next unique frame (synthetic or the next replayed frame) into pix and
+ * telem without outputting it, for programs that use the simulator's frames but not
+ * its packet stream
+ */
+void lepsim_make_frame(uint16_t* pix, uint16_t* telem)
+{
+	static sim_frame_t f;
+
+	make_frame(&f, (int64_t) frame_count * LEPSIM_UNIQUE_INTERVAL);
+	memcpy(pix, f.pix, sizeof(f.pix));
+	memcpy(telem, f.telem, sizeof(f.telem));
+}
+
+
+/**
+ * Current virtual time
+ */
+int64_t lepsim_now_usec()
+{
+	return now_nsec / NSEC_PER_USEC;
+}
+
+
+/**
+ * Let time pass without transferring anything (e.g. sleeping to resynchronize)
+ */
+void lepsim_advance_usec(int64_t usec)
+{
+	advance_to(now_nsec + usec * NSEC_PER_USEC);
+}
+
+
+/**
+ * Let time pass until usec (does nothing if it has already passed)
+ */
+void lepsim_advance_to_usec(int64_t usec)
+{
+	advance_to(usec * NSEC_PER_USEC);
+}
+
+
+/**
+ * Wait for the next VSYNC edge and the interrupt latency after it.  An edge that
+ * occurred while the capture code was busy is taken immediately (like a pending
+ * interrupt) and any before it are counted as missed.  Returns the time of the edge.
+ */
+int64_t lepsim_wait_vsync()
+{
+	int64_t edge = now_nsec / VSYNC_NSEC;
+
+	if (edge > vsync_taken) {
+		stats.missed_vsyncs += edge - vsync_taken - 1;
+	} else {
+		edge = vsync_taken + 1;
+	}
+	vsync_taken = edge;
+	advance_to(edge * VSYNC_NSEC + irq_nsec);
+
+	return edge * LEPSIM_VSYNC_USEC;
+}
+
+
+/**
+ * Account for the setup time of an SPI transaction
+ */
+void lepsim_begin_transfer()
+{
+	advance_to(now_nsec + xfer_nsec);
+}
+
+
+/**
+ * Clock len bytes of the stream into buf
+ */
+void lepsim_transfer(void* buf, int len)
+{
+	uint8_t* dst = (uint8_t*) buf;
+	int n;
+
+	stats.bytes += len;
+	while (len > 0) {
+		if (pkt_pos == LEPSIM_PKT_BYTES) {
+			build_packet();
+			pkt_pos = 0;
+		}
+		n = LEPSIM_PKT_BYTES - pkt_pos;
+		if (n > len) n = len;
+		memcpy(dst, &pkt[pkt_pos], n);
+		dst += n;
+		len -= n;
+		pkt_pos += n;
+		advance_to(now_nsec + ((int64_t) n * 8 * 1000000000LL) / cfg.spi_hz);
+	}
+}
+
+
+/**
+ * Check the CRC of a packet (for front-ends modelling hardware that checks it)
+ */
+int lepsim_packet_crc_valid(const uint8_t* pktP)
+{
+	return (packet_crc(pktP) == ((pktP[2] << 8) | pktP[3]));
+}
+
+
+/**
+ * Look for a captured frame (in native 16-bit pixels) among the recent unique frames
+ * comparing only the bits in mask.  Returns the unique frame number or -1 if it
+ * doesn't match any of them.
+ */
+int lepsim_match_frame(const uint16_t* pix, uint16_t mask)
+{
+	sim_frame_t* f;
+	int i, j;
+
+	for (i=0; (i<LEPSIM_MATCH_FRAMES) && (i<frame_count); i++) {
+		f = &frames[(frame_count - 1 - i) % LEPSIM_MATCH_FRAMES];
+		for (j=0; j<LEPSIM_NUM_PIXELS; j++) {
+			if ((pix[j] ^ f->pix[j]) & mask) break;
+		}
+		if (j == LEPSIM_NUM_PIXELS) {
+			return f->num;
+		}
+	}
+
+	return -1;
+}
+
+
+/**
+ * Check the telemetry rows captured with a frame matched by lepsim_match_frame().
+ * Returns false if they don't match.
+ */
+int lepsim_match_telem(int frame, const uint16_t* telem)
+{
+	sim_frame_t* f;
+
+	if (frame < 0) {
+		return 0;
+	}
+	f = &frames[frame % LEPSIM_MATCH_FRAMES];
+	if (f->num != frame) {
+		return 0;
+	}
+	return (memcmp(telem, f->telem, sizeof(f->telem)) == 0);
+}
+
+
+void lepsim_get_stats(lepsim_stats_t* s)
+{
+	*s = stats;
+}
+
+
+
+//
+// Internal functions
+//
+
+/**
+ * xorshift32
+ */
+static uint32_t rand_next()
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return rand_state;
+}
+
+
+/**
+ * Build the lookup table for a byte at a time CRC computation
+ */
+static void init_crc_table()
+{
+	int i, j;
+	uint16_t crc;
+
+	for (i=0; i<256; i++) {
+		crc = i << 8;
+		for (j=0; j<8; j++) {
+			crc = (crc & 0x8000) ? ((crc << 1) ^ CRC_POLY) : (crc << 1);
+		}
+		crc_table[i] = crc;
+	}
+}
+
+
+/**
+ * Compute the CRC of a packet (the CRC field is ignored)
+ */
+static uint16_t packet_crc(const uint8_t* pktP)
+{
+	const uint8_t* p = pktP + 4;
+	const uint8_t* endP = pktP + LEPSIM_PKT_BYTES;
+	uint16_t crc = 0;
+
+	crc = (crc << 8) ^ crc_table[(crc >> 8) ^ (*pktP & 0x0F)];
+	crc = (crc << 8) ^ crc_table[(crc >> 8) ^ *(pktP + 1)];
+	crc = (crc << 8) ^ crc_table[crc >> 8];
+	crc = (crc << 8) ^ crc_table[crc >> 8];
+
+	while (p < endP) {
+		crc = (crc << 8) ^ crc_table[(crc >> 8) ^ *p++];
+	}
+
+	return crc;
+}
+
+
+/**
+ * Load the frames from a tCam image (.tjsn) or video (.tmjsn) file.  Each record has
+ * base64 encoded little-endian radiometric pixels and optionally telemetry.  Returns
+ * the number of frames loaded or -1 for failure.
+ */
+static int load_samples(char* fname)
+{
+	FILE* fp;
+	long len;
+	char* text;
+	char* rad;
+	char* tel;
+	char* next;
+	uint8_t* b;
+	int i, n;
+
+	if ((fp = fopen(fname, "rb")) == NULL) {
+		fprintf(stderr, "lepsim: could not open %s\n", fname);
+		return -1;
+	}
+	fseek(fp, 0, SEEK_END);
+	len = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	text = malloc(len + 1);
+	if ((text == NULL) || (fread(text, 1, len, fp) != len)) {
+		fprintf(stderr, "lepsim: could not read %s\n", fname);
+		fclose(fp);
+		free(text);
+		return -1;
+	}
+	fclose(fp);
+	text[len] = 0;
+
+	// Count the records
+	n = 0;
+	for (rad = text; (rad = strstr(rad, SAMPLE_RAD_KEY)) != NULL; rad++) {
+		n++;
+	}
+	samples = malloc(n * sizeof(sample_frame_t));
+	if ((n == 0) || (samples == NULL)) {
+		fprintf(stderr, "lepsim: no frames in %s\n", fname);
+		free(text);
+		return -1;
+	}
+
+	num_samples = 0;
+	rad = strstr(text, SAMPLE_RAD_KEY);
+	while (rad != NULL) {
+		rad += strlen(SAMPLE_RAD_KEY);
+		next = strstr(rad, SAMPLE_RAD_KEY);
+		b = (uint8_t*) samples[num_samples].pix;
+		if (decode_base64(rad, b, SAMPLE_RAD_BYTES) == SAMPLE_RAD_BYTES) {
+			for (i=0; i<LEPSIM_NUM_PIXELS; i++) {
+				samples[num_samples].pix[i] = b[2*i] | (b[2*i + 1] << 8);
+			}
+
+			// Telemetry from the same record
+			samples[num_samples].telem_valid = 0;
+			tel = strstr(rad, SAMPLE_TEL_KEY);
+			if ((tel != NULL) && ((next == NULL) || (tel < next))) {
+				b = (uint8_t*) samples[num_samples].telem;
+				if (decode_base64(tel + strlen(SAMPLE_TEL_KEY), b, SAMPLE_TEL_BYTES) == SAMPLE_TEL_BYTES) {
+					for (i=0; i<LEPSIM_TEL_WORDS; i++) {
+						samples[num_samples].telem[i] = b[2*i] | (b[2*i + 1] << 8);
+					}
+					samples[num_samples].telem_valid = 1;
+				}
+			}
+			num_samples++;
+		}
+		rad = next;
+	}
+	free(text);
+
+	if (num_samples == 0) {
+		fprintf(stderr, "lepsim: no valid frames in %s\n", fname);
+		return -1;
+	}
+	return num_samples;
+}
+
+
+/**
+ * Decode base64 text (ending at a quote) into up to max bytes.  Returns the number
+ * of bytes decoded.
+ */
+static int decode_base64(const char* src, uint8_t* dst, int max)
+{
+	uint32_t acc = 0;
+	int bits = 0;
+	int n = 0;
+	int v;
+	char c;
+
+	while (((c = *src++) != 0) && (c != '"') && (c != '=')) {
+		if ((c >= 'A') && (c <= 'Z')) v = c - 'A';
+		else if ((c >= 'a') && (c <= 'z')) v = c - 'a' + 26;
+		else if ((c >= '0') && (c <= '9')) v = c - '0' + 52;
+		else if (c == '+') v = 62;
+		else if (c == '/') v = 63;
+		else continue;
+
+		acc = (acc << 6) | v;
+		bits += 6;
+		if (bits >= 8) {
+			bits -= 8;
+			if (n == max) return n + 1;
+			dst[n++] = acc >> bits;
+		}
+	}
+
+	return n;
+}
+
+
+/**
+ * Load the next unique frame, starting with Lepton frame lepFrame, into f
+ */
+static void make_frame(sim_frame_t* f, int64_t lepFrame)
+{
+	sample_frame_t* s;
+	uint32_t uptime = (uint32_t) ((lepFrame * LEPSIM_SEGMENTS * LEPSIM_VSYNC_USEC) / 1000);
+	uint32_t v;
+	int cx, cy, dx, dy;
+	int x, y;
+	uint16_t* p;
+
+	f->num = frame_count;
+
+	if (num_samples > 0) {
+		s = &samples[frame_count % num_samples];
+		memcpy(f->pix, s->pix, sizeof(f->pix));
+		if (s->telem_valid) {
+			memcpy(f->telem, s->telem, sizeof(f->telem));
+		} else {
+			memset(f->telem, 0, sizeof(f->telem));
+		}
+	} else {
+		cx = (frame_count * 2) % LEPSIM_WIDTH;
+		cy = LEPSIM_HEIGHT / 2;
+		p = f->pix;
+		for (y=0; y<LEPSIM_HEIGHT; y++) {
+			for (x=0; x<LEPSIM_WIDTH; x++) {
+				v = x*4 + y*6 + (rand_next() & 0x0F);
+				dx = x - cx;
+				dy = y - cy;
+				if ((dx*dx + dy*dy) < SYNTH_SPOT_R2) v += SYNTH_SPOT;
+				if (cfg.agc) {
+					v = (v * 255) / SYNTH_RANGE;
+					if (v > 255) v = 255;
+				} else {
+					v += SYNTH_BASE;
+				}
+				*p++ = v;
+			}
+		}
+		memset(f->telem, 0, sizeof(f->telem));
+		f->telem[LEPSIM_TEL_FPA_T_K100] = SYNTH_FPA_T_K100;
+		f->telem[LEPSIM_TEL_HSE_T_K100] = SYNTH_HSE_T_K100;
+	}
+
+	// Running values (FFC state bits set to complete)
+	f->telem[LEPSIM_TEL_UPTIME_LOW] = uptime & 0xFFFF;
+	f->telem[LEPSIM_TEL_UPTIME_HIGH] = uptime >> 16;
+	f->telem[LEPSIM_TEL_STATUS_LOW] = (f->telem[LEPSIM_TEL_STATUS_LOW] & ~0x0030) | 0x0030;
+	f->telem[LEPSIM_TEL_FC_LOW] = lepFrame & 0xFFFF;
+	f->telem[LEPSIM_TEL_FC_HIGH] = (lepFrame >> 16) & 0xFFFF;
+
+	frame_count++;
+}
+
+
+/**
+ * Returns true if a Lepton frame carries valid segment numbers
+ */
+static int frame_unique(int64_t lepFrame)
+{
+	if ((lepFrame % LEPSIM_UNIQUE_INTERVAL) != 0) {
+		return 0;
+	}
+	if ((ffc_interval != 0) && (lepFrame >= ffc_interval) &&
+	    ((lepFrame % ffc_interval) < LEPSIM_FFC_FRAMES)) {
+		return 0;
+	}
+	return 1;
+}
+
+
+/**
+ * Start outputting the segment at seg_index
+ */
+static void start_segment()
+{
+	int64_t lepFrame = seg_index / LEPSIM_SEGMENTS;
+
+	seg_num = (seg_index % LEPSIM_SEGMENTS) + 1;
+	seg_ttt = frame_unique(lepFrame) ? seg_num : 0;
+	seg_pkt = 0;
+	seg_lead = (cfg.max_discards > 0) ? (rand_next() % (cfg.max_discards + 1)) : 0;
+
+	if ((seg_ttt == 1) && (seg_num == 1)) {
+		make_frame(&frames[frame_count % LEPSIM_MATCH_FRAMES], lepFrame);
+	}
+	if ((ffc_interval != 0) && (seg_num == 1) && (lepFrame > 0) && ((lepFrame % ffc_interval) == 0)) {
+		stats.ffcs++;
+	}
+	stats.vsyncs++;
+}
+
+
+/**
+ * Account for the segment at seg_index when the next VSYNC ends it
+ */
+static void end_segment()
+{
+	int n = seg_pkt - seg_lead;
+
+	if (seg_ttt != 0) {
+		if (n < 0) n = 0;
+		if (n < pkts_per_seg) {
+			stats.lost_packets += pkts_per_seg - n;
+		}
+		if (seg_num == LEPSIM_SEGMENTS) {
+			stats.frames++;
+		}
+	}
+}
+
+
+/**
+ * Move the virtual clock forward to t, starting segments at each VSYNC passed
+ */
+static void advance_to(int64_t t)
+{
+	int64_t s = (t / VSYNC_NSEC) - 1;
+
+	while (seg_index < s) {
+		if (seg_index >= 0) {
+			end_segment();
+		}
+		seg_index++;
+		if (seg_index >= 0) {
+			start_segment();
+		}
+	}
+
+	if (t > now_nsec) {
+		now_nsec = t;
+	}
+}
+
+
+/**
+ * Return the words for packet fp (numbered from the start of the Lepton frame) of
+ * the newest unique frame
+ */
+static const uint16_t* packet_source(int fp)
+{
+	sim_frame_t* f = &frames[(frame_count - 1) % LEPSIM_MATCH_FRAMES];
+
+	if (cfg.telem == LEPSIM_TELEM_HEADER) {
+		if (fp < LEPSIM_TEL_PKTS) {
+			return (fp < (LEPSIM_TEL_PKTS - 1)) ? &f->telem[fp * LEPSIM_PKT_PIXELS] : reserved_row;
+		}
+		fp -= LEPSIM_TEL_PKTS;
+	} else if (cfg.telem == LEPSIM_TELEM_FOOTER) {
+		if (fp >= LEPSIM_IMG_PKTS) {
+			fp -= LEPSIM_IMG_PKTS;
+			return (fp < (LEPSIM_TEL_PKTS - 1)) ? &f->telem[fp * LEPSIM_PKT_PIXELS] : reserved_row;
+		}
+	}
+
+	return &f->pix[fp * LEPSIM_PKT_PIXELS];
+}
+
+
+/**
+ * Build the next packet clocked out at the current time: discard packets before and
+ * after the segment's data packets, big-endian words and a CRC for data packets
+ */
+static void build_packet()
+{
+	const uint16_t* src;
+	uint8_t* p;
+	uint16_t crc;
+	int line;
+	int i;
+
+	advance_to(now_nsec);
+
+	if ((seg_index < 0) || (frame_count == 0) || (seg_pkt < seg_lead) || ((seg_pkt - seg_lead) >= pkts_per_seg)) {
+		memcpy(pkt, discard_pkt, LEPSIM_PKT_BYTES);
+		pkt[1] = rand_next();
+		seg_pkt++;
+		return;
+	}
+
+	line = seg_pkt - seg_lead;
+	seg_pkt++;
+	src = packet_source(((seg_num - 1) * pkts_per_seg) + line);
+
+	pkt[0] = (line == 20) ? (seg_ttt << 4) : 0;
+	pkt[1] = line;
+	p = &pkt[4];
+	for (i=0; i<LEPSIM_PKT_PIXELS; i++) {
+		*p++ = src[i] >> 8;
+		*p++ = src[i] & 0xFF;
+	}
+	crc = packet_crc(pkt);
+	pkt[2] = crc >> 8;
+	pkt[3] = crc & 0xFF;
+
+	// Corrupt a bit after the CRC was computed
+	if ((cfg.crc_error_rate > 0) && (((double) rand_next() / 4294967296.0) < cfg.crc_error_rate)) {
+		pkt[4 + (rand_next() % (LEPSIM_PKT_BYTES - 4))] ^= 1 << (rand_next() & 0x07);
+		stats.crc_errors++;
+	}
+}
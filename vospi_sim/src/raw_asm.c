@@ -0,0 +1,220 @@
+/*
+ * Raw VoSPI stream assembler
+ *
+ * Assembles a capture of a tCam-Mini raw (passthrough) stream with the shared segment
+ * assembler (vospi_asm/vospi_asm.h) on the host.  The capture is the stream as it was
+ * received: packet batches, each a 16-byte header (see RSP_PKT_START in the firmware's
+ * rsp_task.h) followed by the packets exactly as lep_task read them, with the discard
+ * packets left out.  ESP32/python/examples/capture_raw.py records one.
+ *
+ * The camera's VSYNC isn't in the stream so a segment read is taken to end when the
+ * assembler says it is done (its last line, a repeated or out of range line or a CRC
+ * error) or at a gap in the packet numbers (packets the camera dropped).  The counts
+ * show where a stream lost sync and -v prints each event with the camera's read time.
+ *
+ * Usage: raw_asm [options] <capture file>
+ *   -m <loc>     Telemetry in the VoSPI stream: none (default), header or footer
+ *   -c           Check packet CRCs
+ *   -L <n>       Lepton to assemble (default 0)
+ *   -o <file>    Write each frame as 160x120 16-bit little-endian pixels
+ *   -v           Print each gap, abandoned segment read and frame
+ *
+ */
+#include "vospi_asm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+// Packet batch header (rsp_task.h)
+#define PKT_START        0x08
+#define PKT_VERSION      1
+#define PKT_HEADER_LEN   16
+#define PKT_MAX_PKTS     255
+
+
+typedef struct {
+	unsigned long batches;
+	unsigned long packets;
+	unsigned long gaps;
+	unsigned long lost_packets;
+	unsigned long reads;         // Segment reads (assembler done)
+	unsigned long aborted;       // Segment reads ended before their last line
+	unsigned long segments;
+	unsigned long frames;
+	unsigned long crc_errors;
+} raw_stats_t;
+
+
+static uint16_t frame_pixels[VOSPI_ASM_WIDTH * VOSPI_ASM_HEIGHT];
+
+
+static uint32_t get_u16(const uint8_t* p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+
+static uint32_t get_u32(const uint8_t* p)
+{
+	return get_u16(p) | (get_u16(p + 2) << 16);
+}
+
+
+static void usage(const char* name)
+{
+	fprintf(stderr, "Usage: %s [-m none|header|footer] [-c] [-L lepton] [-o file] [-v] <capture file>\n", name);
+	exit(1);
+}
+
+
+/**
+ * Store an image packet's pixels (big-endian on the wire)
+ */
+static void store_packet(const vospi_asm_t* a, const uint8_t* pktP)
+{
+	int i;
+	uint16_t* dstP = &frame_pixels[a->dst * VOSPI_ASM_PKT_PIXELS];
+
+	pktP += 4;
+	for (i=0; i<VOSPI_ASM_PKT_PIXELS; i++, pktP += 2) {
+		*dstP++ = (pktP[0] << 8) | pktP[1];
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	FILE* in;
+	FILE* out = NULL;
+	int c, i, rsp;
+	int lepton = 0;
+	int verbose = 0;
+	uint8_t flags = 0;
+	uint8_t hdr[PKT_HEADER_LEN];
+	uint8_t pkts[PKT_MAX_PKTS * VOSPI_ASM_PKT_LEN];
+	uint32_t hdr_len, pkt_num, num_pkts, pkt_len, read_usec;
+	uint32_t next_pkt = 0;
+	int have_next = 0;
+	int in_read = 0;
+	vospi_asm_t a;
+	raw_stats_t s;
+
+	while ((c = getopt(argc, argv, "m:cL:o:v")) != -1) {
+		switch (c) {
+			case 'm':
+				if (strcmp(optarg, "header") == 0) {
+					flags |= VOSPI_ASM_TELEM | VOSPI_ASM_TELEM_HEADER;
+				} else if (strcmp(optarg, "footer") == 0) {
+					flags |= VOSPI_ASM_TELEM;
+				} else if (strcmp(optarg, "none") != 0) {
+					usage(argv[0]);
+				}
+				break;
+			case 'c':
+				flags |= VOSPI_ASM_CHECK_CRC;
+				break;
+			case 'L':
+				lepton = atoi(optarg);
+				break;
+			case 'o':
+				if ((out = fopen(optarg, "wb")) == NULL) {
+					perror(optarg);
+					return 1;
+				}
+				break;
+			case 'v':
+				verbose = 1;
+				break;
+			default:
+				usage(argv[0]);
+		}
+	}
+	if (optind != argc - 1) usage(argv[0]);
+
+	if ((in = fopen(argv[optind], "rb")) == NULL) {
+		perror(argv[optind]);
+		return 1;
+	}
+
+	memset(&s, 0, sizeof(s));
+	memset(&a, 0, sizeof(a));
+	vospi_asm_init(&a, flags);
+
+	while (fread(hdr, 1, 4, in) == 4) {
+		hdr_len = get_u16(&hdr[2]);
+		if ((hdr[0] != PKT_START) || (hdr[1] != PKT_VERSION) || (hdr_len < PKT_HEADER_LEN) ||
+		    (fread(&hdr[4], 1, PKT_HEADER_LEN - 4, in) != PKT_HEADER_LEN - 4) ||
+		    (fseek(in, hdr_len - PKT_HEADER_LEN, SEEK_CUR) != 0)) {
+			fprintf(stderr, "Bad packet batch header at %ld\n", ftell(in));
+			return 1;
+		}
+		pkt_num = get_u32(&hdr[4]);
+		num_pkts = hdr[9];
+		pkt_len = get_u16(&hdr[10]);
+		read_usec = get_u32(&hdr[12]);
+		if ((pkt_len != VOSPI_ASM_PKT_LEN) || (fread(pkts, pkt_len, num_pkts, in) != num_pkts)) {
+			fprintf(stderr, "Truncated packet batch %u\n", pkt_num);
+			break;
+		}
+		if (hdr[8] != lepton) continue;
+		s.batches++;
+
+		// Packet numbers count every packet read so a gap is packets the camera dropped
+		// (the segment read they were part of can't be completed)
+		if (have_next && (pkt_num != next_pkt)) {
+			s.gaps++;
+			s.lost_packets += pkt_num - next_pkt;
+			if (verbose) printf("%10u gap of %u packets\n", read_usec, pkt_num - next_pkt);
+			if (in_read) {
+				vospi_asm_start_segment(&a);
+				in_read = 0;
+			}
+		}
+		next_pkt = pkt_num + num_pkts;
+		have_next = 1;
+
+		for (i=0; i<(int) num_pkts; i++) {
+			rsp = vospi_asm_packet(&a, &pkts[i * VOSPI_ASM_PKT_LEN]);
+			if (rsp == 0) continue;
+			s.packets++;
+			in_read = 1;
+
+			if (rsp & VOSPI_ASM_STORE_IMAGE) {
+				store_packet(&a, &pkts[i * VOSPI_ASM_PKT_LEN]);
+			}
+			if (rsp & VOSPI_ASM_CRC_ERROR) {
+				s.crc_errors++;
+				if (verbose) printf("%10u CRC error in segment %d line %d\n", read_usec, a.seg, a.line);
+			}
+			if (rsp & VOSPI_ASM_SEGMENT) {
+				s.segments++;
+			}
+			if (rsp & VOSPI_ASM_FRAME) {
+				s.frames++;
+				if (verbose) printf("%10u frame %lu\n", read_usec, s.frames);
+				if (out != NULL) {
+					(void) fwrite(frame_pixels, sizeof(frame_pixels), 1, out);
+				}
+			}
+			if (rsp & VOSPI_ASM_DONE) {
+				s.reads++;
+				if (!(rsp & VOSPI_ASM_SEG_END)) {
+					s.aborted++;
+					if (verbose) printf("%10u segment read abandoned at line %d\n", read_usec, a.line);
+				}
+				vospi_asm_start_segment(&a);
+				in_read = 0;
+			}
+		}
+	}
+
+	printf("batches %lu packets %lu gaps %lu lost_packets %lu reads %lu aborted %lu segments %lu frames %lu crc_errors %lu\n",
+	       s.batches, s.packets, s.gaps, s.lost_packets, s.reads, s.aborted, s.segments, s.frames, s.crc_errors);
+
+	fclose(in);
+	if (out != NULL) fclose(out);
+	return 0;
+}
@@ -0,0 +1,827 @@
+/*
+ * tCam-Mini firmware stage benchmark
+ *
+ * Times the per-frame work of the ESP32 firmware's hot paths on the host: VoSPI packet
+ * unpack (word swap and min/max, with and without the temporal filter), the json image
+ * record and its base64 encoding, Rice compression and the palette mapping PNG and
+ * JPEG encoders.  Each stage is the firmware's unmodified source built against the
+ * ESP-IDF shims (shim/esp32) and the functions below.  Frames come from the simulator
+ * (synthetic or replayed from a file).
+ *
+ * Results are host times so they are only useful for comparing one build or change
+ * against another.  With -o the median of each stage is appended to a CSV file along
+ * with a label and compared with the previous row, so a history of runs shows which
+ * changes moved a stage.
+ *
+ * Before timing anything the json image records (the whole record and the pieces with
+ * every telemetry field in the metadata) are checked to parse as json, with the boolean
+ * metadata both true and false.
+ *
+ * Usage: bench_stages [options]
+ *   -n <frames>  Frames timed per stage (default 500)
+ *   -r <file>    Frames from a .tjsn/.tmjsn file instead of synthetic pixels
+ *   -a           Synthetic pixels are 8-bit AGC values
+ *   -m <loc>     Telemetry in the VoSPI stream: none (default), header or footer
+ *   -s <stages>  Comma separated stages to run (default all)
+ *   -o <file>    Append the results to a CSV history file
+ *   -l <label>   Label for the history row (default the date and time)
+ *
+ */
+#define _GNU_SOURCE
+#include "lepsim.h"
+
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_ota_ops.h"
+#include "driver/spi_master.h"
+#include "json_utilities.h"
+#include "jpeg_codec.h"
+#include "lepton_utilities.h"
+#include "palette_utilities.h"
+#include "perf_utilities.h"
+#include "png_codec.h"
+#include "rice_codec.h"
+#include "sys_utilities.h"
+#include "time_utilities.h"
+#include "vospi.h"
+#include "vospi_asm.h"
+#include "wifi_utilities.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// Distinct frames each stage cycles through
+#define NUM_FRAMES       16
+
+// Lepton 3.5 frame period (8.7 frames/sec) the stage times are compared against
+#define FRAME_USEC       (1000000.0 / 8.7)
+
+// Temporal filter level for the tfilter stage
+#define BENCH_TF_LEVEL   2
+
+// Largest encoded image
+#define MAX_ENC_LEN      (LEP_NUM_PIXELS * 4)
+
+// Longest history file line
+#define MAX_LINE_LEN     1024
+
+// Deepest json nesting the record check accepts
+#define MAX_JSON_DEPTH   8
+
+
+//
+// Stages
+//
+typedef struct {
+	const char* name;
+	const char* desc;
+	uint32_t (*run)(int n);        // Process frame n, returns the bytes output
+	double median_usec;
+	double p90_usec;
+	double avg_bytes;
+	int enabled;
+} stage_t;
+
+static uint32_t run_unpack(int n);
+static uint32_t run_tfilter(int n);
+static uint32_t run_json(int n);
+static uint32_t run_base64(int n);
+static uint32_t run_rice_key(int n);
+static uint32_t run_rice_delta(int n);
+static uint32_t run_png(int n);
+static uint32_t run_jpeg(int n);
+
+static stage_t stages[] = {
+	{"unpack",     "VoSPI segments to frame (word swap, min/max)", run_unpack},
+	{"tfilter",    "VoSPI segments to frame with the temporal filter", run_tfilter},
+	{"json",       "json image record (head, base64, telemetry)", run_json},
+	{"base64",     "base64 radiometric data", run_base64},
+	{"rice_key",   "Rice key frame", run_rice_key},
+	{"rice_delta", "Rice delta frame", run_rice_delta},
+	{"png",        "Palette mapped PNG", run_png},
+	{"jpeg",       "Palette mapped JPEG", run_jpeg}
+};
+
+#define NUM_STAGES (sizeof(stages) / sizeof(stages[0]))
+
+
+//
+// Benchmark state
+//
+
+// Frames and their VoSPI packet streams (4 segments of 60 or 61 packets)
+static uint16_t frame_pix[NUM_FRAMES][LEP_NUM_PIXELS];
+static uint16_t frame_telem[NUM_FRAMES][LEP_TEL_WORDS];
+static lep_buffer_t frames[NUM_FRAMES];
+static uint8_t* frame_pkts[NUM_FRAMES];
+static int pkts_per_seg;
+
+// Segment being read by the SPI shim
+static const uint8_t* seg_pktP;
+static int seg_pkts_left;
+static uint8_t discard_pkt[LEP_PKT_LENGTH];
+
+// vospi output
+static uint16_t lep_pix[LEP_NUM_PIXELS];
+static uint16_t lep_telem[LEP_TEL_WORDS];
+static lep_buffer_t lep_frame;
+
+// Encoder buffers
+static char json_text[JSON_MAX_IMAGE_TEXT_LEN];
+static uint8_t enc_buf[MAX_ENC_LEN];
+static uint8_t png_work[PNG_WORK_LEN(LEP_WIDTH, LEP_HEIGHT)];
+static const uint8_t* palette;
+
+// json metadata
+static char camera_name[] = "tCam-Mini-BE7C";
+static wifi_info_t wifi_info = {.ap_ssid = camera_name};
+static const esp_app_desc_t app_desc = {.version = "3.0", .project_name = "tCam-Mini"};
+
+// Value of the boolean metadata (time sync and telemetry flags)
+static bool meta_bools = true;
+
+
+
+//
+// ESP-IDF, perf_utilities, sys_utilities and firmware shims
+//
+int64_t esp_timer_get_time()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+
+esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t* dev_config, spi_device_handle_t* handle)
+{
+	*handle = NULL;
+	return ESP_OK;
+}
+
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle)
+{
+	return ESP_OK;
+}
+
+
+/**
+ * Copy the next packets of the segment being read (the DMA transfer), then discard
+ * packets
+ */
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t* trans_desc)
+{
+	uint8_t* dst = (uint8_t*) trans_desc->rx_buffer;
+	int n = trans_desc->rxlength / (8 * LEP_PKT_LENGTH);
+	int i;
+
+	i = (n < seg_pkts_left) ? n : seg_pkts_left;
+	memcpy(dst, seg_pktP, i * LEP_PKT_LENGTH);
+	seg_pktP += i * LEP_PKT_LENGTH;
+	seg_pkts_left -= i;
+	for (; i<n; i++) {
+		memcpy(dst + i * LEP_PKT_LENGTH, discard_pkt, LEP_PKT_LENGTH);
+	}
+
+	return ESP_OK;
+}
+
+
+void perf_record(int stage, int64_t start_usec)
+{
+}
+
+
+void perf_count(int counter)
+{
+}
+
+
+void* system_buffer_alloc(const char* name, int index, uint32_t len, int placement)
+{
+	return malloc(len);
+}
+
+
+const esp_app_desc_t* esp_ota_get_app_description()
+{
+	return &app_desc;
+}
+
+
+wifi_info_t* wifi_get_info()
+{
+	return &wifi_info;
+}
+
+
+int64_t time_timer_to_usec(int64_t timer_usec)
+{
+	return 1700000000000000LL + timer_usec;
+}
+
+
+void time_get_at(int64_t usec, tmElements_t* te)
+{
+	time_t t = (time_t) (usec / 1000000);
+	struct tm tm;
+
+	gmtime_r(&t, &tm);
+	te->Millisecond = (usec / 1000) % 1000;
+	te->Second = tm.tm_sec;
+	te->Minute = tm.tm_min;
+	te->Hour = tm.tm_hour;
+	te->Wday = tm.tm_wday + 1;
+	te->Day = tm.tm_mday;
+	te->Month = tm.tm_mon + 1;
+	te->Year = tm.tm_year - 70;
+}
+
+
+bool time_is_synced()
+{
+	return meta_bools;
+}
+
+
+void lepton_get_tel_fields(uint16_t* tel_buf, lep_tel_fields_t* fields)
+{
+	memset(fields, 0, sizeof(lep_tel_fields_t));
+	fields->ffc_desired = meta_bools;
+	fields->tlin_enabled = meta_bools;
+}
+
+
+
+//
+// Frames
+//
+
+/**
+ * Build the VoSPI packets of frame n as the Lepton outputs them: big-endian words, the
+ * segment number in packet 20 and a CRC
+ */
+static void build_packets(int n, int telem)
+{
+	uint8_t* p;
+	const uint16_t* src;
+	uint16_t crc;
+	int seg, line, fp, i;
+
+	frame_pkts[n] = (uint8_t*) malloc(LEPSIM_SEGMENTS * pkts_per_seg * LEP_PKT_LENGTH);
+	p = frame_pkts[n];
+	for (seg=1; seg<=LEPSIM_SEGMENTS; seg++) {
+		for (line=0; line<pkts_per_seg; line++) {
+			fp = (seg - 1) * pkts_per_seg + line;
+			if ((telem == LEPSIM_TELEM_HEADER) && (fp < LEPSIM_TEL_PKTS)) {
+				src = &frame_telem[n][(fp < LEP_TEL_PACKETS) ? fp * LEPSIM_PKT_PIXELS : 0];
+			} else if ((telem == LEPSIM_TELEM_FOOTER) && (fp >= LEPSIM_IMG_PKTS)) {
+				fp -= LEPSIM_IMG_PKTS;
+				src = &frame_telem[n][(fp < LEP_TEL_PACKETS) ? fp * LEPSIM_PKT_PIXELS : 0];
+			} else {
+				if (telem == LEPSIM_TELEM_HEADER) fp -= LEPSIM_TEL_PKTS;
+				src = &frame_pix[n][fp * LEPSIM_PKT_PIXELS];
+			}
+
+			p[0] = (line == 20) ? (seg << 4) : 0;
+			p[1] = line;
+			for (i=0; i<LEPSIM_PKT_PIXELS; i++) {
+				p[4 + 2*i] = src[i] >> 8;
+				p[5 + 2*i] = src[i] & 0xFF;
+			}
+			crc = vospi_asm_crc(p);
+			p[2] = crc >> 8;
+			p[3] = crc & 0xFF;
+			p += LEP_PKT_LENGTH;
+		}
+	}
+}
+
+
+static void load_frames(int telem)
+{
+	lep_buffer_t* f;
+	int n, i;
+
+	pkts_per_seg = (telem == LEPSIM_TELEM_NONE) ? LEP_NOTEL_PKTS_PER_SEG : LEP_TEL_PKTS_PER_SEG;
+	discard_pkt[0] = 0x0F;
+
+	for (n=0; n<NUM_FRAMES; n++) {
+		lepsim_make_frame(frame_pix[n], frame_telem[n]);
+		build_packets(n, telem);
+
+		f = &frames[n];
+		f->lep_bufferP = frame_pix[n];
+		f->lep_telemP = frame_telem[n];
+		f->telem_valid = true;
+		f->seq = n;
+		f->vsync_usec = (int64_t) n * LEPSIM_UNIQUE_INTERVAL * LEPSIM_SEGMENTS * LEPSIM_VSYNC_USEC;
+		f->lep_min_val = 0xFFFF;
+		f->lep_max_val = 0;
+		for (i=0; i<LEP_NUM_PIXELS; i++) {
+			if (frame_pix[n][i] < f->lep_min_val) f->lep_min_val = frame_pix[n][i];
+			if (frame_pix[n][i] > f->lep_max_val) f->lep_max_val = frame_pix[n][i];
+		}
+	}
+}
+
+
+
+//
+// Stage functions
+//
+static uint32_t run_unpack(int n)
+{
+	int seg;
+
+	seg_pktP = frame_pkts[n % NUM_FRAMES];
+	for (seg=0; seg<LEPSIM_SEGMENTS; seg++) {
+		seg_pkts_left = pkts_per_seg;
+		if (vospi_transfer_segment(0, esp_timer_get_time())) {
+			vospi_finish_frame(0, &lep_frame);
+			return sizeof(lep_pix);
+		}
+	}
+
+	// The frame wasn't assembled
+	return 0;
+}
+
+
+static uint32_t run_tfilter(int n)
+{
+	return run_unpack(n);
+}
+
+
+static uint32_t run_json(int n)
+{
+	return json_get_image_file_string(json_text, &frames[n % NUM_FRAMES]);
+}
+
+
+static uint32_t run_base64(int n)
+{
+	return json_get_image_base64(json_text, sizeof(json_text), frame_pix[n % NUM_FRAMES], LEP_NUM_PIXELS*2);
+}
+
+
+static uint32_t run_rice_key(int n)
+{
+	return rice_encode_image(frame_pix[n % NUM_FRAMES], NULL, LEP_WIDTH, LEP_HEIGHT, enc_buf, sizeof(enc_buf));
+}
+
+
+static uint32_t run_rice_delta(int n)
+{
+	return rice_encode_image(frame_pix[n % NUM_FRAMES], frame_pix[(n + NUM_FRAMES - 1) % NUM_FRAMES],
+	                         LEP_WIDTH, LEP_HEIGHT, enc_buf, sizeof(enc_buf));
+}
+
+
+static uint32_t run_png(int n)
+{
+	lep_buffer_t* f = &frames[n % NUM_FRAMES];
+
+	return png_encode_image(f->lep_bufferP, LEP_WIDTH, LEP_HEIGHT, palette, f->lep_min_val, f->lep_max_val,
+	                        png_work, enc_buf, sizeof(enc_buf));
+}
+
+
+static uint32_t run_jpeg(int n)
+{
+	lep_buffer_t* f = &frames[n % NUM_FRAMES];
+	uint32_t scan_offset;
+
+	return jpeg_encode_image(f->lep_bufferP, LEP_WIDTH, LEP_HEIGHT, palette, f->lep_min_val, f->lep_max_val,
+	                         JPEG_DEF_QUALITY, enc_buf, sizeof(enc_buf), &scan_offset);
+}
+
+
+
+//
+// json record check
+//
+static const char* json_skip_ws(const char* p)
+{
+	while ((*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r')) p++;
+	return p;
+}
+
+
+static const char* json_check_string(const char* p)
+{
+	if (*p++ != '"') return NULL;
+	while (*p != '"') {
+		if ((unsigned char) *p < ' ') return NULL;
+		if (*p++ == '\\') {
+			if (*p == 'u') {
+				p += 4;
+			} else if (strchr("\"\\/bfnrt", *p) == NULL) {
+				return NULL;
+			}
+			p++;
+		}
+	}
+	return p + 1;
+}
+
+
+static const char* json_check_number(const char* p)
+{
+	const char* start;
+
+	if (*p == '-') p++;
+	start = p;
+	while ((*p >= '0') && (*p <= '9')) p++;
+	if (p == start) return NULL;
+	if (*p == '.') {
+		start = ++p;
+		while ((*p >= '0') && (*p <= '9')) p++;
+		if (p == start) return NULL;
+	}
+	if ((*p == 'e') || (*p == 'E')) {
+		p++;
+		if ((*p == '+') || (*p == '-')) p++;
+		start = p;
+		while ((*p >= '0') && (*p <= '9')) p++;
+		if (p == start) return NULL;
+	}
+	return p;
+}
+
+
+/**
+ * Check the json value at p, returning the location following it or NULL if it isn't
+ * valid json
+ */
+static const char* json_check_value(const char* p, int depth)
+{
+	char close;
+
+	p = json_skip_ws(p);
+	if ((*p == '{') || (*p == '[')) {
+		if (depth == MAX_JSON_DEPTH) return NULL;
+		close = (*p == '{') ? '}' : ']';
+		p = json_skip_ws(p + 1);
+		if (*p == close) return p + 1;
+		while (1) {
+			if (close == '}') {
+				p = json_check_string(json_skip_ws(p));
+				if ((p == NULL) || (*(p = json_skip_ws(p)) != ':')) return NULL;
+				p++;
+			}
+			if ((p = json_check_value(p, depth + 1)) == NULL) return NULL;
+			p = json_skip_ws(p);
+			if (*p == close) return p + 1;
+			if (*p++ != ',') return NULL;
+		}
+	}
+	if (*p == '"') return json_check_string(p);
+	if (strncmp(p, "true", 4) == 0) return p + 4;
+	if (strncmp(p, "false", 5) == 0) return p + 5;
+	if (strncmp(p, "null", 4) == 0) return p + 4;
+	return json_check_number(p);
+}
+
+
+/**
+ * Check that the null-terminated text holds exactly one json value, reporting where it
+ * stops parsing if it doesn't
+ */
+static int json_check(const char* text, const char* what)
+{
+	const char* p = json_check_value(text, 0);
+
+	if ((p != NULL) && (*json_skip_ws(p) == 0)) {
+		return 1;
+	}
+	fprintf(stderr, "%s with %s booleans isn't valid json\n", what, meta_bools ? "true" : "false");
+	return 0;
+}
+
+
+/**
+ * Check the image json records: the one json_get_image_file_string() writes and one
+ * assembled from the pieces with every telemetry field in the metadata
+ */
+static int check_image_json()
+{
+	uint32_t len;
+	int i;
+
+	for (i=0; i<2; i++) {
+		meta_bools = (i == 0);
+
+		if (json_get_image_file_string(json_text, &frames[0]) == 0) return 0;
+		if (!json_check(json_text, "json_get_image_file_string()")) return 0;
+
+		len = json_get_image_head(json_text, sizeof(json_text), &frames[0], false, LEP_TEL_FLD_ALL);
+		if (len == 0) return 0;
+		len += json_get_image_base64(json_text + len, sizeof(json_text) - len, frame_pix[0], LEP_NUM_PIXELS*2);
+		len += json_get_image_tail(json_text + len, sizeof(json_text) - len - 1, &frames[0], LEP_TEL_FLD_ALL);
+		json_text[len] = 0;
+		if (!json_check(json_text, "json_get_image_head() with telemetry fields")) return 0;
+	}
+	meta_bools = true;
+
+	return 1;
+}
+
+
+
+//
+// Timing
+//
+static int64_t now_nsec()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+
+static int cmp_nsec(const void* a, const void* b)
+{
+	int64_t d = *(const int64_t*) a - *(const int64_t*) b;
+
+	return (d < 0) ? -1 : (d > 0);
+}
+
+
+/**
+ * Time num_frames calls of a stage after a pass over the frames to warm the caches.
+ * Returns false if the stage failed to produce any output.
+ */
+static int time_stage(stage_t* s, int64_t* t, int num_frames)
+{
+	uint64_t bytes = 0;
+	uint32_t len;
+	int64_t start;
+	int i;
+
+	for (i=0; i<NUM_FRAMES; i++) {
+		(void) s->run(i);
+	}
+
+	for (i=0; i<num_frames; i++) {
+		start = now_nsec();
+		len = s->run(i);
+		t[i] = now_nsec() - start;
+		if (len == 0) {
+			return 0;
+		}
+		bytes += len;
+	}
+
+	qsort(t, num_frames, sizeof(int64_t), cmp_nsec);
+	s->median_usec = (double) t[num_frames / 2] / 1000.0;
+	s->p90_usec = (double) t[(num_frames * 9) / 10] / 1000.0;
+	s->avg_bytes = (double) bytes / num_frames;
+
+	return 1;
+}
+
+
+
+//
+// History file
+//
+
+/**
+ * Find the previous median of stage name in the last row of the history file.
+ * Returns a negative value if there isn't one.
+ */
+static double history_value(char* header, char* row, const char* name)
+{
+	char* h = header;
+	char* r = row;
+	char* hn;
+	char* rn;
+	size_t len = strlen(name);
+
+	while ((h != NULL) && (r != NULL)) {
+		hn = strchr(h, ',');
+		rn = strchr(r, ',');
+		if ((((hn != NULL) ? (size_t) (hn - h) : strcspn(h, "\r\n")) == len) && (strncmp(h, name, len) == 0)) {
+			return atof(r);
+		}
+		h = (hn != NULL) ? hn + 1 : NULL;
+		r = (rn != NULL) ? rn + 1 : NULL;
+	}
+
+	return -1.0;
+}
+
+
+/**
+ * Load the header and last row of the history file (empty if it doesn't exist yet)
+ */
+static void history_read(const char* fname, char* header, char* row)
+{
+	char line[MAX_LINE_LEN];
+	FILE* fp;
+
+	header[0] = 0;
+	row[0] = 0;
+	if ((fp = fopen(fname, "r")) == NULL) {
+		return;
+	}
+	if (fgets(header, MAX_LINE_LEN, fp) != NULL) {
+		while (fgets(line, sizeof(line), fp) != NULL) {
+			if (line[0] != '\n') {
+				strcpy(row, line);
+			}
+		}
+	}
+	fclose(fp);
+}
+
+
+/**
+ * Append this run's medians to the history file, writing the header for a new file
+ */
+static int history_append(const char* fname, const char* label, int header_needed)
+{
+	FILE* fp;
+	size_t i;
+
+	if ((fp = fopen(fname, "a")) == NULL) {
+		fprintf(stderr, "Could not open %s\n", fname);
+		return -1;
+	}
+	if (header_needed) {
+		fprintf(fp, "label");
+		for (i=0; i<NUM_STAGES; i++) fprintf(fp, ",%s", stages[i].name);
+		fprintf(fp, "\n");
+	}
+	fprintf(fp, "%s", label);
+	for (i=0; i<NUM_STAGES; i++) {
+		if (stages[i].enabled) {
+			fprintf(fp, ",%.2f", stages[i].median_usec);
+		} else {
+			fprintf(fp, ",");
+		}
+	}
+	fprintf(fp, "\n");
+	fclose(fp);
+
+	return 0;
+}
+
+
+
+static void usage(char* name)
+{
+	fprintf(stderr, "Usage: %s [-n frames] [-r sample_file] [-a] [-m none|header|footer] [-s stage,...]\n", name);
+	fprintf(stderr, "       [-o history_file] [-l label]\n");
+}
+
+
+int main(int argc, char** argv)
+{
+	lepsim_config_t cfg;
+	char* hist_file = NULL;
+	char* label = NULL;
+	char* only = NULL;
+	char* tok;
+	char hist_header[MAX_LINE_LEN];
+	char hist_row[MAX_LINE_LEN];
+	char date[32];
+	int64_t* t;
+	int num_frames = 500;
+	double prev;
+	time_t now;
+	size_t i;
+	int c;
+
+	lepsim_default_config(&cfg);
+
+	while ((c = getopt(argc, argv, "n:r:am:s:o:l:")) != -1) {
+		switch (c) {
+			case 'n':
+				num_frames = atoi(optarg);
+				break;
+			case 'r':
+				cfg.sample_file = optarg;
+				break;
+			case 'a':
+				cfg.agc = 1;
+				break;
+			case 'm':
+				if (strcmp(optarg, "header") == 0) {
+					cfg.telem = LEPSIM_TELEM_HEADER;
+				} else if (strcmp(optarg, "footer") == 0) {
+					cfg.telem = LEPSIM_TELEM_FOOTER;
+				} else if (strcmp(optarg, "none") == 0) {
+					cfg.telem = LEPSIM_TELEM_NONE;
+				} else {
+					usage(argv[0]);
+					return -1;
+				}
+				break;
+			case 's':
+				only = optarg;
+				break;
+			case 'o':
+				hist_file = optarg;
+				break;
+			case 'l':
+				label = optarg;
+				break;
+			default:
+				usage(argv[0]);
+				return -1;
+		}
+	}
+	if (num_frames < 1) {
+		usage(argv[0]);
+		return -1;
+	}
+
+	for (i=0; i<NUM_STAGES; i++) {
+		stages[i].enabled = (only == NULL);
+	}
+	for (tok = (only != NULL) ? strtok(only, ",") : NULL; tok != NULL; tok = strtok(NULL, ",")) {
+		for (i=0; i<NUM_STAGES; i++) {
+			if (strcmp(tok, stages[i].name) == 0) break;
+		}
+		if (i == NUM_STAGES) {
+			fprintf(stderr, "Unknown stage %s\n", tok);
+			return -1;
+		}
+		stages[i].enabled = 1;
+	}
+
+	// Firmware setup
+	if (lepsim_init(&cfg) < 0) {
+		return -1;
+	}
+	load_frames(cfg.telem);
+	if (vospi_init(0) != ESP_OK) {
+		return -1;
+	}
+	vospi_include_telem(0, cfg.telem != LEPSIM_TELEM_NONE, cfg.telem == LEPSIM_TELEM_HEADER);
+	lep_frame.lep_bufferP = lep_pix;
+	lep_frame.lep_telemP = lep_telem;
+	vospi_set_frame_buffer(0, &lep_frame);
+	palette = palette_get(PALETTE_DEFAULT);
+	t = (int64_t*) malloc(num_frames * sizeof(int64_t));
+	if (!check_image_json()) {
+		return -1;
+	}
+
+	hist_header[0] = 0;
+	hist_row[0] = 0;
+	if (hist_file != NULL) {
+		history_read(hist_file, hist_header, hist_row);
+	}
+
+	// Run
+	printf("%d frames per stage (%s)\n", num_frames, (lepsim_num_samples() > 0) ? cfg.sample_file :
+	       (cfg.agc ? "synthetic AGC" : "synthetic TLinear"));
+	printf("  %-11s %9s %9s %9s %7s %8s\n", "stage", "med_us", "p90_us", "bytes", "budget", "change");
+	for (i=0; i<NUM_STAGES; i++) {
+		if (!stages[i].enabled) continue;
+
+		vospi_set_temporal_filter(0, (stages[i].run == run_tfilter) ? BENCH_TF_LEVEL : 0);
+		if (!time_stage(&stages[i], t, num_frames)) {
+			fprintf(stderr, "%s failed\n", stages[i].name);
+			return -1;
+		}
+
+		printf("  %-11s %9.2f %9.2f %9.0f %6.2f%%", stages[i].name, stages[i].median_usec,
+		       stages[i].p90_usec, stages[i].avg_bytes, (100.0 * stages[i].median_usec) / FRAME_USEC);
+		prev = (hist_row[0] != 0) ? history_value(hist_header, hist_row, stages[i].name) : -1.0;
+		if (prev > 0) {
+			printf(" %+7.1f%%", (100.0 * (stages[i].median_usec - prev)) / prev);
+		} else {
+			printf(" %8s", "");
+		}
+		printf("   %s\n", stages[i].desc);
+	}
+
+	if (hist_file != NULL) {
+		if (label == NULL) {
+			now = time(NULL);
+			strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+			label = date;
+		}
+		if (strchr(label, ',') != NULL) {
+			fprintf(stderr, "The label can't contain a comma\n");
+			return -1;
+		}
+		if (history_append(hist_file, label, hist_header[0] == 0) < 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}